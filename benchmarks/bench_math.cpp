@@ -0,0 +1,180 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Benchmarks of the pose math used on every tracking and frame path.
+ */
+
+#include <math/m_api.h>
+#include <math/m_space.h>
+#include <math/m_relation_history.h>
+#include <util/u_time.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+
+
+static xrt_quat
+random_quat(std::mt19937 &rng)
+{
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+	xrt_quat q = {dist(rng), dist(rng), dist(rng), dist(rng)};
+	math_quat_normalize(&q);
+
+	return q;
+}
+
+static xrt_space_relation
+random_relation(std::mt19937 &rng)
+{
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+	xrt_space_relation relation = XRT_SPACE_RELATION_ZERO;
+	relation.relation_flags = (xrt_space_relation_flags)( //
+	    XRT_SPACE_RELATION_POSITION_VALID_BIT |           //
+	    XRT_SPACE_RELATION_POSITION_TRACKED_BIT |         //
+	    XRT_SPACE_RELATION_ORIENTATION_VALID_BIT |        //
+	    XRT_SPACE_RELATION_ORIENTATION_TRACKED_BIT |      //
+	    XRT_SPACE_RELATION_LINEAR_VELOCITY_VALID_BIT |    //
+	    XRT_SPACE_RELATION_ANGULAR_VELOCITY_VALID_BIT);   //
+	relation.pose.orientation = random_quat(rng);
+	relation.pose.position = {dist(rng), dist(rng), dist(rng)};
+	relation.linear_velocity = {dist(rng), dist(rng), dist(rng)};
+	relation.angular_velocity = {dist(rng), dist(rng), dist(rng)};
+
+	return relation;
+}
+
+TEST_CASE("m_relation_history")
+{
+	auto mode = GENERATE(M_RELATION_HISTORY_MODE_MUTEX, M_RELATION_HISTORY_MODE_SEQLOCK);
+	const std::string name = mode == M_RELATION_HISTORY_MODE_SEQLOCK ? " seqlock" : " mutex";
+
+	std::mt19937 rng(1);
+	const xrt_space_relation relation = random_relation(rng);
+
+	m_relation_history *rh = nullptr;
+	m_relation_history_create_with_mode(&rh, mode);
+
+	// A 1kHz tracker, pushes must have increasing timestamps.
+	constexpr int64_t Step = U_TIME_1MS_IN_NS;
+	int64_t ts = 20 * (int64_t)U_TIME_1S_IN_NS;
+
+	BENCHMARK("m_relation_history_push" + name)
+	{
+		ts += Step;
+		return m_relation_history_push(rh, &relation, ts);
+	};
+
+	// The compositor and apps ask for times a bit in the past, the future and in between samples.
+	BENCHMARK("m_relation_history_get interpolated" + name)
+	{
+		xrt_space_relation out;
+		return m_relation_history_get(rh, ts - 10 * Step - Step / 2, &out);
+	};
+
+	BENCHMARK("m_relation_history_get predicted" + name)
+	{
+		xrt_space_relation out;
+		return m_relation_history_get(rh, ts + 20 * Step, &out);
+	};
+
+	m_relation_history_destroy(&rh);
+}
+
+TEST_CASE("m_relation_chain_resolve")
+{
+	std::mt19937 rng(2);
+
+	// Typical depths, a device in a space and the longest chains of offset spaces.
+	for (uint32_t count : {2u, 4u, 8u}) {
+		xrt_relation_chain xrc = {};
+		for (uint32_t i = 0; i < count; i++) {
+			xrt_space_relation relation = random_relation(rng);
+			m_relation_chain_push_relation(&xrc, &relation);
+		}
+
+		BENCHMARK("m_relation_chain_resolve " + std::to_string(count) + " steps")
+		{
+			xrt_space_relation out;
+			m_relation_chain_resolve(&xrc, &out);
+			return out.pose.position.x;
+		};
+	}
+}
+
+TEST_CASE("math_quat")
+{
+	std::mt19937 rng(3);
+
+	// Rotate through a set of inputs so the compiler can't hoist the work out of the loop.
+	constexpr size_t Count = 256;
+	std::vector<xrt_quat> quats(Count);
+	std::vector<xrt_vec3> vecs(Count);
+	for (size_t i = 0; i < Count; i++) {
+		quats[i] = random_quat(rng);
+		vecs[i] = {(float)i / Count, 0.5f, -0.5f};
+	}
+	size_t i = 0;
+
+	BENCHMARK("math_quat_rotate")
+	{
+		xrt_quat out;
+		math_quat_rotate(&quats[i % Count], &quats[(i + 1) % Count], &out);
+		i++;
+		return out.w;
+	};
+
+	BENCHMARK("math_quat_rotate_vec3")
+	{
+		xrt_vec3 out;
+		math_quat_rotate_vec3(&quats[i % Count], &vecs[i % Count], &out);
+		i++;
+		return out.x;
+	};
+
+	BENCHMARK("math_quat_normalize")
+	{
+		xrt_quat q = quats[i++ % Count];
+		q.w *= 2.0f;
+		math_quat_normalize(&q);
+		return q.w;
+	};
+
+	BENCHMARK("math_quat_slerp")
+	{
+		xrt_quat out;
+		math_quat_slerp(&quats[i % Count], &quats[(i + 1) % Count], 0.3f, &out);
+		i++;
+		return out.w;
+	};
+
+	BENCHMARK("math_quat_integrate_velocity")
+	{
+		xrt_quat out;
+		math_quat_integrate_velocity(&quats[i % Count], &vecs[i % Count], 0.011f, &out);
+		i++;
+		return out.w;
+	};
+
+	BENCHMARK("math_quat_finite_difference")
+	{
+		xrt_vec3 out;
+		math_quat_finite_difference(&quats[i % Count], &quats[(i + 1) % Count], 0.011f, &out);
+		i++;
+		return out.x;
+	};
+
+	BENCHMARK("math_quat_ln and math_quat_exp")
+	{
+		xrt_vec3 axis_angle;
+		xrt_quat out;
+		math_quat_ln(&quats[i++ % Count], &axis_angle);
+		math_quat_exp(&axis_angle, &out);
+		return out.w;
+	};
+}
@@ -0,0 +1,94 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Benchmarks of the frame conversion kernels, per format and SIMD level.
+ */
+
+#include <util/u_sink_converter_simd.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+
+
+static std::vector<uint8_t>
+make_random(size_t size, uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> dist(0, 255);
+
+	std::vector<uint8_t> data(size);
+	for (auto &v : data) {
+		v = (uint8_t)dist(rng);
+	}
+
+	return data;
+}
+
+TEST_CASE("u_sink_converter")
+{
+	// One 1280x800 camera frame.
+	const uint32_t w = 1280;
+	const uint32_t h = 800;
+
+	std::vector<uint8_t> src = make_random(w * h * 2, 3);
+	std::vector<uint8_t> dst(w * h * 3);
+
+	std::vector<const u_sink_converter_funcs *> all;
+	for (auto simd : {U_SINK_CONVERTER_SIMD_SCALAR, U_SINK_CONVERTER_SIMD_SSE41, U_SINK_CONVERTER_SIMD_AVX2,
+	                  U_SINK_CONVERTER_SIMD_NEON}) {
+		const u_sink_converter_funcs *funcs = u_sink_converter_simd_get_funcs(simd);
+		if (funcs != nullptr) {
+			all.push_back(funcs);
+		}
+	}
+
+	for (const u_sink_converter_funcs *funcs : all) {
+		const std::string name = std::string(" ") + funcs->name;
+
+		BENCHMARK("yuyv422_to_r8g8b8" + name)
+		{
+			for (uint32_t y = 0; y < h; y++) {
+				funcs->yuyv422_to_r8g8b8(&src[y * w * 2], &dst[y * w * 3], w);
+			}
+			return dst[0];
+		};
+
+		BENCHMARK("uyvy422_to_r8g8b8" + name)
+		{
+			for (uint32_t y = 0; y < h; y++) {
+				funcs->uyvy422_to_r8g8b8(&src[y * w * 2], &dst[y * w * 3], w);
+			}
+			return dst[0];
+		};
+
+		BENCHMARK("yuyv422_to_l8" + name)
+		{
+			for (uint32_t y = 0; y < h; y++) {
+				funcs->yuyv422_to_l8(&src[y * w * 2], &dst[y * w], w);
+			}
+			return dst[0];
+		};
+
+		BENCHMARK("l8_to_r8g8b8" + name)
+		{
+			for (uint32_t y = 0; y < h; y++) {
+				funcs->l8_to_r8g8b8(&src[y * w], &dst[y * w * 3], w);
+			}
+			return dst[0];
+		};
+
+		BENCHMARK("bayer_gr8_to_r8g8b8" + name)
+		{
+			for (uint32_t y = 0; y < h / 2; y++) {
+				const uint8_t *src0 = &src[(y * 2) * w * 2];
+				const uint8_t *src1 = &src[(y * 2 + 1) * w * 2];
+				funcs->bayer_gr8_to_r8g8b8(src0, src1, &dst[y * w * 3], w);
+			}
+			return dst[0];
+		};
+	}
+}
@@ -0,0 +1,173 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Benchmarks of the util containers used for handle and frame lookups,
+ *        and of the box helpers used by detectors.
+ */
+
+#include <util/u_hashmap.h>
+#include <util/u_id_ringbuffer.h>
+#include <util/u_box_iou.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+
+
+static void *
+to_value(uint64_t v)
+{
+	return (void *)(uintptr_t)(v + 1);
+}
+
+TEST_CASE("u_hashmap_int")
+{
+	// Typical handle and path counts, and a big one that doesn't fit in the cache.
+	const size_t Count = GENERATE(64, 4096, 100000);
+	const std::string name = " " + std::to_string(Count) + " keys";
+
+	std::vector<uint64_t> keys(Count);
+	std::mt19937_64 rng(42);
+	for (uint64_t &key : keys) {
+		key = rng();
+	}
+
+	u_hashmap_int *hmi = nullptr;
+	u_hashmap_int_create(&hmi);
+	for (uint64_t key : keys) {
+		u_hashmap_int_insert(hmi, key, to_value(key));
+	}
+
+	// Look up in a different order than inserted, node based maps otherwise get sequential memory access.
+	std::shuffle(keys.begin(), keys.end(), rng);
+	size_t i = 0;
+
+	BENCHMARK("u_hashmap_int_find" + name)
+	{
+		void *out = nullptr;
+		u_hashmap_int_find(hmi, keys[i++ % Count], &out);
+		return out;
+	};
+
+	BENCHMARK("u_hashmap_int_find missing" + name)
+	{
+		void *out = nullptr;
+		return u_hashmap_int_find(hmi, keys[i++ % Count] ^ 1, &out);
+	};
+
+	// Erase and insert the same key so the size stays the same.
+	BENCHMARK("u_hashmap_int_erase and insert" + name)
+	{
+		uint64_t key = keys[i++ % Count];
+		u_hashmap_int_erase(hmi, key);
+		return u_hashmap_int_insert(hmi, key, to_value(key));
+	};
+
+	u_hashmap_int_destroy(&hmi);
+}
+
+TEST_CASE("u_id_ringbuffer")
+{
+	// Sizes used for frame and sample histories.
+	const uint32_t Capacity = GENERATE(16u, 256u);
+	const std::string name = " capacity " + std::to_string(Capacity);
+
+	u_id_ringbuffer *uirb = u_id_ringbuffer_create(Capacity);
+
+	// Ids are increasing, like frame ids or timestamps.
+	uint64_t next_id = 1000;
+	for (uint32_t k = 0; k < Capacity; k++) {
+		u_id_ringbuffer_push_back(uirb, next_id++);
+	}
+
+	BENCHMARK("u_id_ringbuffer_push_back full" + name)
+	{
+		return u_id_ringbuffer_push_back(uirb, next_id++);
+	};
+
+	BENCHMARK("u_id_ringbuffer_get_at_age" + name)
+	{
+		uint64_t out_id = 0;
+		u_id_ringbuffer_get_at_age(uirb, Capacity / 2, &out_id);
+		return out_id;
+	};
+
+	BENCHMARK("u_id_ringbuffer_lower_bound_id" + name)
+	{
+		uint64_t out_id = 0;
+		uint32_t out_index = 0;
+		return u_id_ringbuffer_lower_bound_id(uirb, next_id - Capacity / 3, &out_id, &out_index);
+	};
+
+	BENCHMARK("u_id_ringbuffer_find_id_unordered" + name)
+	{
+		uint64_t out_id = 0;
+		uint32_t out_index = 0;
+		return u_id_ringbuffer_find_id_unordered(uirb, next_id - Capacity / 3, &out_id, &out_index);
+	};
+
+	u_id_ringbuffer_destroy(&uirb);
+}
+
+TEST_CASE("u_box_iou")
+{
+	using namespace xrt::auxiliary::util::box_iou;
+
+	// From a handful of direct model outputs to the candidates decoded from a heatmap.
+	const size_t Count = GENERATE(16, 256, 2048);
+	const std::string name = " " + std::to_string(Count) + " boxes";
+
+	// Clustered around a few centers, like the candidates around each detected hand.
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> center(0.0f, 640.0f);
+	std::normal_distribution<float> jitter(0.0f, 8.0f);
+	std::uniform_real_distribution<float> size(40.0f, 120.0f);
+	std::uniform_real_distribution<float> score(0.0f, 1.0f);
+
+	std::vector<Box> boxes = {};
+	std::vector<float> scores = {};
+	float cx = 0.0f;
+	float cy = 0.0f;
+	for (size_t k = 0; k < Count; k++) {
+		if (k % 16 == 0) {
+			cx = center(rng);
+			cy = center(rng);
+		}
+		boxes.push_back(Box(cx + jitter(rng), cy + jitter(rng), size(rng)));
+		scores.push_back(score(rng));
+	}
+
+	BoxBatch batch = {};
+	for (const Box &box : boxes) {
+		batch.push_back(box);
+	}
+
+	std::vector<float> iou(Count);
+
+	BENCHMARK("boxIOU one against all" + name)
+	{
+		for (size_t k = 0; k < Count; k++) {
+			iou[k] = boxIOU(boxes[0], boxes[k]);
+		}
+		return iou[Count - 1];
+	};
+
+	BENCHMARK("boxIOUBatch one against all" + name)
+	{
+		boxIOUBatch(batch, 0, 0, iou.data());
+		return iou[Count - 1];
+	};
+
+	std::vector<size_t> kept = {};
+
+	BENCHMARK("nonMaximumSuppression" + name)
+	{
+		nonMaximumSuppression(boxes, scores, 0.5f, Count, kept);
+		return kept.size();
+	};
+}
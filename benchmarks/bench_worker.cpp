@@ -0,0 +1,57 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Benchmarks of the u_worker queue overhead.
+ */
+
+#include <util/u_worker.h>
+
+#include <atomic>
+#include <string>
+
+#include "catch_amalgamated.hpp"
+
+
+static void
+count_task(void *ptr)
+{
+	static_cast<std::atomic<uint32_t> *>(ptr)->fetch_add(1, std::memory_order_relaxed);
+}
+
+TEST_CASE("u_worker_group")
+{
+	u_worker_thread_pool *pool = u_worker_thread_pool_create(3, 4, "Bench");
+	REQUIRE(pool != nullptr);
+
+	u_worker_group *group = u_worker_group_create(pool);
+	REQUIRE(group != nullptr);
+
+	// Empty tasks, so only the cost of queueing, waking and waiting is measured.
+	for (uint32_t task_count : {1u, 16u, 256u}) {
+		BENCHMARK("push and wait_all " + std::to_string(task_count) + " tasks")
+		{
+			std::atomic<uint32_t> count{0};
+			for (uint32_t i = 0; i < task_count; i++) {
+				u_worker_group_push(group, count_task, &count);
+			}
+			u_worker_group_wait_all(group);
+			return count.load();
+		};
+	}
+
+	// The high priority queue is checked first by every worker.
+	BENCHMARK("push_with_priority and wait_all 16 mixed tasks")
+	{
+		std::atomic<uint32_t> count{0};
+		for (uint32_t i = 0; i < 16; i++) {
+			enum u_worker_priority prio = (i % 4) == 0 ? U_WORKER_PRIORITY_HIGH : U_WORKER_PRIORITY_NORMAL;
+			u_worker_group_push_with_priority(group, count_task, &count, prio);
+		}
+		u_worker_group_wait_all(group);
+		return count.load();
+	};
+
+	u_worker_group_reference(&group, nullptr);
+	u_worker_thread_pool_reference(&pool, nullptr);
+}
@@ -91,6 +91,7 @@ def get_device_cmds():
         None,
         Cmd("vkCreatePipelineCache"),
         Cmd("vkDestroyPipelineCache"),
+        Cmd("vkGetPipelineCacheData"),
         None,
         Cmd("vkResetDescriptorPool"),
         Cmd("vkCreateDescriptorPool"),
@@ -171,12 +172,18 @@ def get_device_cmds():
         None,
         Cmd("vkGetPastPresentationTimingGOOGLE"),
         None,
+        Cmd("vkGetPastPresentationTimingEXT", requires=("VK_EXT_present_timing",)),
+        Cmd("vkGetSwapchainTimeDomainPropertiesEXT", requires=("VK_EXT_present_timing",)),
+        Cmd("vkSetSwapchainPresentTimingQueueSizeEXT", requires=("VK_EXT_present_timing",)),
+        None,
         Cmd("vkGetSwapchainCounterEXT", requires=("VK_EXT_display_control",)),
         Cmd("vkRegisterDeviceEventEXT", requires=("VK_EXT_display_control",)),
         Cmd("vkRegisterDisplayEventEXT", requires=("VK_EXT_display_control",)),
         None,
         Cmd("vkGetImageDrmFormatModifierPropertiesEXT", requires=("VK_EXT_image_drm_format_modifier",)),
         None,
+        Cmd("vkGetImageSubresourceLayout2EXT", requires=("VK_EXT_image_compression_control",)),
+        None,
         Cmd("vkCmdBeginDebugUtilsLabelEXT", requires=("VK_EXT_debug_utils",)),
         Cmd("vkCmdEndDebugUtilsLabelEXT", requires=("VK_EXT_debug_utils",)),
         Cmd("vkCmdInsertDebugUtilsLabelEXT", requires=("VK_EXT_debug_utils",)),
@@ -187,6 +194,8 @@ def get_device_cmds():
         Cmd("vkSetDebugUtilsObjectTagEXT", requires=("VK_EXT_debug_utils",)),
         None,
         Cmd("vkWaitForPresentKHR", requires=("VK_KHR_present_wait",)),
+        None,
+        Cmd("vkCmdPushDescriptorSetKHR", requires=("VK_KHR_push_descriptor",)),
     ]
 
 
@@ -277,6 +286,7 @@ def get_instance_cmds():
         Cmd("vkCreateWin32SurfaceKHR", requires=("VK_USE_PLATFORM_WIN32_KHR",)),
         None,
         Cmd("vkGetPhysicalDeviceSurfaceCapabilities2EXT", requires=("VK_EXT_display_surface_counter",)),
+        Cmd("vkGetPhysicalDeviceSurfaceCapabilities2KHR", requires=("VK_KHR_get_surface_capabilities2",)),
         None,
         Cmd("vkCreateDebugUtilsMessengerEXT", requires=("VK_EXT_debug_utils",)),
         Cmd("vkSubmitDebugUtilsMessageEXT", requires=("VK_EXT_debug_utils",)),
@@ -287,6 +297,7 @@ def get_instance_cmds():
 # Sorted KHR, EXT, Vendor, interally alphabetically
 INSTANCE_EXTENSIONS_TO_CHECK = [
     "VK_KHR_external_memory_capabilities",
+    "VK_KHR_get_surface_capabilities2",
     "VK_EXT_display_surface_counter",
     "VK_EXT_swapchain_colorspace",
     "VK_EXT_debug_utils",
@@ -305,6 +316,8 @@ DEVICE_EXTENSIONS_TO_CHECK = [
     "VK_KHR_maintenance3",
     "VK_KHR_maintenance4",
     "VK_KHR_present_wait",
+    "VK_KHR_push_descriptor",
+    "VK_KHR_shared_presentable_image",
     "VK_KHR_synchronization2",
     "VK_KHR_timeline_semaphore",
     "VK_KHR_video_maintenance1",
@@ -313,7 +326,9 @@ DEVICE_EXTENSIONS_TO_CHECK = [
     "VK_EXT_external_memory_dma_buf",
     "VK_EXT_external_memory_host",
     "VK_EXT_global_priority",
+    "VK_EXT_image_compression_control",
     "VK_EXT_image_drm_format_modifier",
+    "VK_EXT_present_timing",
     "VK_EXT_robustness2",
     "VK_ANDROID_external_format_resolve",
     "VK_GOOGLE_display_timing",
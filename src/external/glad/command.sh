@@ -44,6 +44,8 @@ GL_EXT_memory_object_fd,\
 GL_EXT_memory_object_win32,\
 GL_EXT_sRGB,\
 GL_EXT_semaphore,\
+GL_EXT_semaphore_fd,\
+GL_NV_timeline_semaphore,\
 GL_OES_EGL_image,\
 GL_OES_EGL_image_external,\
 GL_OES_EGL_image_external_essl3,\
@@ -25,8 +25,8 @@ extern "C" {
 
 //! Compatibility with these values should be checked against @ref vit_api_get_version.
 #define VIT_HEADER_VERSION_MAJOR 2 //!< API Breakages
-#define VIT_HEADER_VERSION_MINOR 0 //!< Backwards compatible API changes
-#define VIT_HEADER_VERSION_PATCH 1 //!< Backw. comp. .h-implemented changes
+#define VIT_HEADER_VERSION_MINOR 2 //!< Backwards compatible API changes
+#define VIT_HEADER_VERSION_PATCH 0 //!< Backw. comp. .h-implemented changes
 
 #define VIT_CAMERA_CALIBRATION_DISTORTION_MAX_COUNT 32
 
@@ -107,6 +107,10 @@ typedef enum vit_tracker_extension {
 	VIT_TRACKER_EXTENSION_POSE_TIMING,
 	//! Optionally provide feature count information with the returned poses
 	VIT_TRACKER_EXTENSION_POSE_FEATURES,
+	//! Allows the tracker to keep image sample data after push, see @ref vit_img_sample::release
+	VIT_TRACKER_EXTENSION_IMG_SAMPLE_RELEASE,
+	//! Allows to save the map and load it back later, see @ref vit_tracker_save_map
+	VIT_TRACKER_EXTENSION_MAP_PERSISTENCE,
 	//! Number of extensions
 	VIT_TRACKER_EXTENSION_COUNT,
 } vit_tracker_extension_t;
@@ -119,6 +123,8 @@ typedef struct vit_tracker_extension_set {
 	bool has_add_imu_calibration;
 	bool has_pose_timing;
 	bool has_pose_features;
+	bool has_img_sample_release;
+	bool has_map_persistence;
 } vit_tracker_extension_set_t;
 
 /*!
@@ -200,6 +206,17 @@ typedef struct vit_img_sample {
 	//! Regions to ignore
 	uint32_t mask_count;
 	vit_mask_t *masks;
+
+	/*!
+	 * Only used with @ref VIT_TRACKER_EXTENSION_IMG_SAMPLE_RELEASE enabled, may be NULL.
+	 *
+	 * The tracker may keep using @ref data after push returns, instead of copying it, and must call this exactly
+	 * once with @ref release_userdata when done with it. Only called if push returned @ref VIT_SUCCESS, the
+	 * caller owns the data otherwise. Everything else in the sample, masks included, is still only valid during
+	 * the push call.
+	 */
+	void (*release)(void *userdata);
+	void *release_userdata;
 } vit_img_sample_t;
 
 /*!
@@ -327,6 +344,8 @@ typedef vit_result_t (*PFN_vit_tracker_add_camera_calibration)(vit_tracker_t *tr
 typedef vit_result_t (*PFN_vit_tracker_pop_pose)(vit_tracker_t *tracker, vit_pose_t **out_pose);
 typedef vit_result_t (*PFN_vit_tracker_get_timing_titles)(const vit_tracker_t *tracker,
 														  vit_tracker_timing_titles *out_titles);
+typedef vit_result_t (*PFN_vit_tracker_save_map)(vit_tracker_t *tracker, const char *path);
+typedef vit_result_t (*PFN_vit_tracker_load_map)(vit_tracker_t *tracker, const char *path);
 typedef void (*PFN_vit_pose_destroy)(vit_pose_t *pose);
 typedef vit_result_t (*PFN_vit_pose_get_data)(const vit_pose_t *pose, vit_pose_data_t *out_data);
 typedef vit_result_t (*PFN_vit_pose_get_timing)(const vit_pose_t *pose, vit_pose_timing_t *out_timing);
@@ -464,6 +483,24 @@ vit_result_t vit_tracker_pop_pose(vit_tracker_t *tracker, vit_pose_t **out_pose)
  */
 vit_result_t vit_tracker_get_timing_titles(const vit_tracker_t *tracker, vit_tracker_timing_titles *out_titles);
 
+/*!
+ * Saves the map the tracker has built to @p path, in a format of its own choosing. Called while the tracker is
+ * running or after it was stopped, may block while writing.
+ *
+ * Returns `VIT_ERROR_NOT_SUPPORTED` if the tracker doesn't offer the map persistence extension. Added in 2.2.0.
+ */
+vit_result_t vit_tracker_save_map(vit_tracker_t *tracker, const char *path);
+
+/*!
+ * Loads a map saved by @ref vit_tracker_save_map from @p path. Called after the tracker was started, from a
+ * thread other than the one pushing samples, while samples keep being pushed; may block for as long as loading
+ * takes. The tracker keeps tracking in the meantime and relocalizes against the map afterwards, from then on the
+ * poses are in the frame of the loaded map.
+ *
+ * Returns `VIT_ERROR_NOT_SUPPORTED` if the tracker doesn't offer the map persistence extension. Added in 2.2.0.
+ */
+vit_result_t vit_tracker_load_map(vit_tracker_t *tracker, const char *path);
+
 /*!
  * Destroys a pose. All of the data, timing and features associated to it will be invalidated.
  */
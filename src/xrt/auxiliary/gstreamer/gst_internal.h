@@ -12,6 +12,7 @@
 #include "xrt/xrt_frame.h"
 
 typedef struct _GstElement GstElement;
+typedef struct _GstAllocator GstAllocator;
 
 
 #ifdef __cplusplus
@@ -72,6 +73,9 @@ struct gstreamer_sink
 	//! Cached appsrc element.
 	GstElement *appsrc;
 
+	//! Used to wrap frames that carry a DMABUF, NULL if not supported.
+	GstAllocator *dmabuf_allocator;
+
 	//! Info about required / configured width/height padding
 	bool need_even_dims;
 	bool have_padded_height;
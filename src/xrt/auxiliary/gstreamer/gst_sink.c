@@ -22,6 +22,10 @@
 #include "gst/app/gstappsink.h"
 #include "gst/app/gstappsrc.h"
 
+#if defined(XRT_GRAPHICS_BUFFER_HANDLE_IS_FD)
+#include "gst/allocators/gstdmabuf.h"
+#endif
+
 #include <assert.h>
 
 
@@ -54,6 +58,37 @@ gst_fmt_from_xf_format(enum xrt_format format_in)
 	}
 }
 
+#if defined(XRT_GRAPHICS_BUFFER_HANDLE_IS_FD)
+/*!
+ * Wraps the DMABUF of the frame without touching the pixels, so elements like
+ * VA-API encoders can import it directly, it is still mappable for the rest.
+ */
+static GstBuffer *
+wrap_dmabuf_frame(struct gstreamer_sink *gs, struct xrt_frame *taken)
+{
+	GstMemory *memory = gst_dmabuf_allocator_alloc_with_flags( //
+	    gs->dmabuf_allocator,                                  // allocator
+	    taken->graphics_buffer.handle,                         // fd
+	    taken->graphics_buffer.size,                           // size
+	    GST_FD_MEMORY_FLAG_DONT_CLOSE);                        // flags
+	if (memory == NULL) {
+		return NULL;
+	}
+
+	// The memory can outlive the buffer, so tie the frame to the memory.
+	gst_mini_object_set_qdata(                   //
+	    GST_MINI_OBJECT(memory),                 // object
+	    g_quark_from_static_string("xrt-frame"), // quark
+	    taken,                                   // data
+	    wrapped_buffer_destroy);                 // destroy
+
+	GstBuffer *buffer = gst_buffer_new();
+	gst_buffer_append_memory(buffer, memory);
+
+	return buffer;
+}
+#endif
+
 static void
 complain_if_wrong_image_size(struct gstreamer_sink *gs, struct xrt_frame *xf)
 {
@@ -103,19 +138,32 @@ push_frame(struct xrt_frame_sink *xfs, struct xrt_frame *xf)
 	struct xrt_frame *taken = NULL;
 	xrt_frame_reference(&taken, xf);
 
+	buffer = NULL;
+	gsize offset = 0;
+
+#if defined(XRT_GRAPHICS_BUFFER_HANDLE_IS_FD)
+	if (gs->dmabuf_allocator != NULL && xf->graphics_buffer.valid) {
+		buffer = wrap_dmabuf_frame(gs, taken);
+		offset = xf->graphics_buffer.offset;
+	}
+#endif
+
 	/* Wrap the frame that we now hold a reference to. */
-	buffer = gst_buffer_new_wrapped_full( //
-	    0,                                // GstMemoryFlags flags
-	    (gpointer)xf->data,               // gpointer data
-	    taken->size,                      // gsize maxsize
-	    0,                                // gsize offset
-	    taken->size,                      // gsize size
-	    taken,                            // gpointer user_data
-	    wrapped_buffer_destroy);          // GDestroyNotify notify
+	if (buffer == NULL) {
+		buffer = gst_buffer_new_wrapped_full( //
+		    0,                                // GstMemoryFlags flags
+		    (gpointer)xf->data,               // gpointer data
+		    taken->size,                      // gsize maxsize
+		    0,                                // gsize offset
+		    taken->size,                      // gsize size
+		    taken,                            // gpointer user_data
+		    wrapped_buffer_destroy);          // GDestroyNotify notify
+		offset = 0;
+	}
 
 	int stride = xf->stride;
 
-	gsize offsets[4] = {0, 0, 0, 0};
+	gsize offsets[4] = {offset, 0, 0, 0};
 	gint strides[4] = {stride, 0, 0, 0};
 	gst_buffer_add_video_meta_full(buffer, GST_VIDEO_FRAME_FLAG_NONE, gst_fmt_from_xf_format(xf->format), xf->width,
 	                               xf->height, 1, offsets, strides);
@@ -175,6 +223,10 @@ destroy(struct xrt_frame_node *node)
 	 * be called, it's now safe to destroy and free ourselves.
 	 */
 
+	if (gs->dmabuf_allocator != NULL) {
+		gst_object_unref(gs->dmabuf_allocator);
+	}
+
 	free(gs);
 }
 
@@ -231,6 +283,9 @@ gstreamer_sink_create_with_pipeline(struct gstreamer_pipeline *gp,
 	gs->gp = gp;
 	gs->appsrc = gst_bin_get_by_name(GST_BIN(gp->pipeline), appsrc_name);
 	gs->need_even_dims = need_even_dims;
+#if defined(XRT_GRAPHICS_BUFFER_HANDLE_IS_FD)
+	gs->dmabuf_allocator = gst_dmabuf_allocator_new();
+#endif
 
 	if (need_even_dims) {
 		/* Pad out height and width to multiple of 2 */
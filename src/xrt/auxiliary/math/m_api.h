@@ -345,6 +345,22 @@ math_quat_ensure_normalized(struct xrt_quat *inout);
 void
 math_quat_rotate_vec3(const struct xrt_quat *left, const struct xrt_vec3 *right, struct xrt_vec3 *result);
 
+/*!
+ * Rotate @p count vectors by the same rotation, same as calling
+ * @ref math_quat_rotate_vec3 on each but only converts @p left once.
+ *
+ * OK if input and output are the same addresses.
+ *
+ * @relates xrt_quat
+ * @see xrt_vec3
+ * @ingroup aux_math
+ */
+void
+math_quat_rotate_vec3_array(const struct xrt_quat *left,
+                            const struct xrt_vec3 *right,
+                            struct xrt_vec3 *result,
+                            uint32_t count);
+
 /*!
  * Rotate a quaternion (compose rotations).
  *
@@ -786,6 +802,21 @@ math_pose_interpolate(const struct xrt_pose *a, const struct xrt_pose *b, float
 void
 math_pose_transform(const struct xrt_pose *transform, const struct xrt_pose *pose, struct xrt_pose *outPose);
 
+/*!
+ * Transform @p count poses by the same transform, same as calling
+ * @ref math_pose_transform on each but only converts @p transform once.
+ *
+ * OK if input and output are the same addresses.
+ *
+ * @relates xrt_pose
+ * @ingroup aux_math
+ */
+void
+math_pose_transform_array(const struct xrt_pose *transform,
+                          const struct xrt_pose *poses,
+                          struct xrt_pose *out_poses,
+                          uint32_t count);
+
 /*!
  * Apply a rigid-body transformation to a point.
  *
@@ -401,6 +401,24 @@ math_quat_rotate_vec3(const struct xrt_quat *left, const struct xrt_vec3 *right,
 	map_vec3(*result) = v;
 }
 
+extern "C" void
+math_quat_rotate_vec3_array(const struct xrt_quat *left,
+                            const struct xrt_vec3 *right,
+                            struct xrt_vec3 *result,
+                            uint32_t count)
+{
+	assert(left != NULL);
+	assert(count == 0 || (right != NULL && result != NULL));
+
+	// A matrix is cheaper than a quaternion per rotated vector.
+	Eigen::Matrix3f rot = copy(left).toRotationMatrix();
+
+	for (uint32_t i = 0; i < count; i++) {
+		Eigen::Vector3f v = rot * copy(right[i]);
+		map_vec3(result[i]) = v;
+	}
+}
+
 extern "C" void
 math_quat_rotate_derivative(const struct xrt_quat *quat, const struct xrt_vec3 *deriv, struct xrt_vec3 *result)
 {
@@ -992,3 +1010,26 @@ math_pose_transform_point(const struct xrt_pose *transform, const struct xrt_vec
 
 	map_vec3(*out_point) = transform_point(*transform, *point);
 }
+
+extern "C" void
+math_pose_transform_array(const struct xrt_pose *transform,
+                          const struct xrt_pose *poses,
+                          struct xrt_pose *out_poses,
+                          uint32_t count)
+{
+	assert(transform != NULL);
+	assert(count == 0 || (poses != NULL && out_poses != NULL));
+
+	// A matrix is cheaper than a quaternion per rotated point.
+	Eigen::Quaternionf q = orientation(*transform);
+	Eigen::Matrix3f rot = q.toRotationMatrix();
+	Eigen::Vector3f t = position(*transform);
+
+	for (uint32_t i = 0; i < count; i++) {
+		Eigen::Vector3f p = rot * position(poses[i]) + t;
+		Eigen::Quaternionf o = q * orientation(poses[i]);
+
+		position(out_poses[i]) = p;
+		orientation(out_poses[i]) = o;
+	}
+}
@@ -6,9 +6,17 @@
  * @author Jan Schmidt <jan@centricular.com>
  * @ingroup aux_math
  */
+#include "xrt/xrt_compiler.h"
+
+#include "os/os_threading.h"
+
 #include "util/u_misc.h"
 #include "m_clock_tracking.h"
 
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
 /* Fixed constants for discontinuity detection and
  * subsequent hold-off. These could be made configurable
  * if that turns out to be desirable */
@@ -206,3 +214,351 @@ m_clock_windowed_skew_tracker_to_remote(struct m_clock_windowed_skew_tracker *t,
 	*remote_ts = local_ts - t->current_skew;
 	return true;
 }
+
+
+/*
+ *
+ * Recursive least squares skew tracker.
+ *
+ */
+
+/* The fit is done relative to an anchor that is moved forward once the
+ * remote time gets this far from it, keeps the doubles well conditioned. */
+const time_duration_ns RLS_REANCHOR_INTERVAL = 1 * U_TIME_1S_IN_NS;
+
+/* Late observations can only pull the fit by this many average residuals,
+ * and are weighted down by this much. */
+const double RLS_LATE_GATE = 3.0;
+const double RLS_LATE_WEIGHT = 0.1;
+
+/* Initial uncertainty of the offset (ns^2) and the rate ((ns/s)^2). */
+const double RLS_INITIAL_VARIANCE = 1e8;
+
+struct m_clock_rls_skew_tracker
+{
+	/* Weight of the previous observations for every new one */
+	double forget;
+
+	bool have_skew_estimate;
+
+	/* What the fit is relative to, skew = skew_anchor + offset + rate * x
+	 * where x is the remote time since remote_anchor in seconds */
+	timepoint_ns remote_anchor;
+	time_duration_ns skew_anchor;
+
+	/* The fitted parameters, in ns and ns per second */
+	double offset;
+	double rate;
+
+	/* Covariance of the parameters */
+	double P[2][2];
+
+	/* Average absolute residual, for gating late observations */
+	double residual;
+};
+
+static double
+rls_skew_at(const struct m_clock_rls_skew_tracker *t, timepoint_ns remote_ts)
+{
+	double x = (double)(remote_ts - t->remote_anchor) / (double)U_TIME_1S_IN_NS;
+	return (double)t->skew_anchor + t->offset + t->rate * x;
+}
+
+static void
+rls_start(struct m_clock_rls_skew_tracker *t, timepoint_ns remote_ts, time_duration_ns skew)
+{
+	t->remote_anchor = remote_ts;
+	t->skew_anchor = skew;
+	t->offset = 0.0;
+	t->rate = 0.0;
+	t->P[0][0] = RLS_INITIAL_VARIANCE;
+	t->P[0][1] = 0.0;
+	t->P[1][0] = 0.0;
+	t->P[1][1] = RLS_INITIAL_VARIANCE;
+	t->residual = 0.0;
+	t->have_skew_estimate = true;
+}
+
+/* Move the anchor to @p remote_ts, a change of variables x' = x - dx. */
+static void
+rls_reanchor(struct m_clock_rls_skew_tracker *t, timepoint_ns remote_ts)
+{
+	double dx = (double)(remote_ts - t->remote_anchor) / (double)U_TIME_1S_IN_NS;
+
+	t->offset += t->rate * dx;
+
+	// P' = T P T^t with T = [1 dx; 0 1]
+	double p00 = t->P[0][0] + dx * (t->P[0][1] + t->P[1][0]) + dx * dx * t->P[1][1];
+	double p01 = t->P[0][1] + dx * t->P[1][1];
+	t->P[0][0] = p00;
+	t->P[0][1] = p01;
+	t->P[1][0] = p01;
+
+	t->remote_anchor = remote_ts;
+}
+
+struct m_clock_rls_skew_tracker *
+m_clock_rls_skew_tracker_alloc(const size_t window_samples)
+{
+	struct m_clock_rls_skew_tracker *t = U_TYPED_CALLOC(struct m_clock_rls_skew_tracker);
+	if (t == NULL) {
+		return NULL;
+	}
+
+	t->forget = 1.0 - 1.0 / (double)(window_samples > 1 ? window_samples : 2);
+
+	return t;
+}
+
+void
+m_clock_rls_skew_tracker_reset(struct m_clock_rls_skew_tracker *t)
+{
+	t->have_skew_estimate = false;
+}
+
+void
+m_clock_rls_skew_tracker_destroy(struct m_clock_rls_skew_tracker *t)
+{
+	free(t);
+}
+
+void
+m_clock_rls_skew_tracker_push(struct m_clock_rls_skew_tracker *t,
+                              const timepoint_ns local_ts,
+                              const timepoint_ns remote_ts)
+{
+	time_duration_ns skew = local_ts - remote_ts;
+
+	if (!t->have_skew_estimate) {
+		rls_start(t, remote_ts, skew);
+		return;
+	}
+
+	double err = (double)skew - rls_skew_at(t, remote_ts);
+
+	// Too large a jump, one of the clocks was reset so start over.
+	if (fabs(err) >= (double)CLOCK_RESET_THRESHOLD) {
+		rls_start(t, remote_ts, skew);
+		return;
+	}
+
+	if (remote_ts - t->remote_anchor >= RLS_REANCHOR_INTERVAL) {
+		rls_reanchor(t, remote_ts);
+	}
+
+	// Update the residual before gating so that the gate can open back up.
+	double abs_err = fabs(err);
+	t->residual = t->residual == 0.0 ? abs_err : t->residual + (abs_err - t->residual) * (1.0 - t->forget);
+
+	/*
+	 * Observations can be delayed in transmission but never arrive early,
+	 * pulling less on late ones makes the fit follow the lower envelope
+	 * which is where the undelayed observations are.
+	 */
+	if (err > 0.0) {
+		err = fmin(err, t->residual * RLS_LATE_GATE) * RLS_LATE_WEIGHT;
+	}
+
+	// Standard RLS update with phi = [1 x].
+	double x = (double)(remote_ts - t->remote_anchor) / (double)U_TIME_1S_IN_NS;
+	double pphi0 = t->P[0][0] + t->P[0][1] * x;
+	double pphi1 = t->P[1][0] + t->P[1][1] * x;
+	double denom = t->forget + pphi0 + pphi1 * x;
+	double k0 = pphi0 / denom;
+	double k1 = pphi1 / denom;
+
+	t->offset += k0 * err;
+	t->rate += k1 * err;
+
+	double p00 = (t->P[0][0] - k0 * pphi0) / t->forget;
+	double p01 = (t->P[0][1] - k0 * pphi1) / t->forget;
+	double p11 = (t->P[1][1] - k1 * pphi1) / t->forget;
+
+	// Without new information the covariance grows without bound, cap it.
+	t->P[0][0] = fmin(p00, RLS_INITIAL_VARIANCE);
+	t->P[0][1] = p01;
+	t->P[1][0] = p01;
+	t->P[1][1] = fmin(p11, RLS_INITIAL_VARIANCE);
+}
+
+bool
+m_clock_rls_skew_tracker_to_local(struct m_clock_rls_skew_tracker *t,
+                                  const timepoint_ns remote_ts,
+                                  timepoint_ns *local_ts)
+{
+	if (!t->have_skew_estimate) {
+		return false;
+	}
+
+	*local_ts = remote_ts + (time_duration_ns)llround(rls_skew_at(t, remote_ts));
+	return true;
+}
+
+bool
+m_clock_rls_skew_tracker_to_remote(struct m_clock_rls_skew_tracker *t,
+                                   const timepoint_ns local_ts,
+                                   timepoint_ns *remote_ts)
+{
+	if (!t->have_skew_estimate) {
+		return false;
+	}
+
+	// The skew is evaluated at remote time, one fixed point step is plenty as the rate is tiny.
+	timepoint_ns guess = local_ts - t->skew_anchor;
+	*remote_ts = local_ts - (time_duration_ns)llround(rls_skew_at(t, guess));
+	return true;
+}
+
+
+/*
+ *
+ * Time domains.
+ *
+ */
+
+#define M_CLOCK_TIME_DOMAIN_MAX 16
+
+struct m_clock_time_domain
+{
+	char name[64];
+
+	//! Protected by the registry lock.
+	int32_t refcount;
+
+	struct os_mutex mutex;
+	struct m_clock_rls_skew_tracker *tracker;
+};
+
+static struct
+{
+	//! Only held while looking up or changing the refcounts, so a spinlock is enough.
+	xrt_atomic_s32_t lock;
+
+	struct m_clock_time_domain *domains[M_CLOCK_TIME_DOMAIN_MAX];
+} registry;
+
+static void
+registry_lock(void)
+{
+	while (xrt_atomic_s32_cmpxchg(&registry.lock, 0, 1) != 0) {
+		// Spin.
+	}
+}
+
+static void
+registry_unlock(void)
+{
+	xrt_atomic_s32_store_release(&registry.lock, 0);
+}
+
+static struct m_clock_time_domain *
+time_domain_create(const char *name, const size_t window_samples)
+{
+	struct m_clock_time_domain *td = U_TYPED_CALLOC(struct m_clock_time_domain);
+	if (td == NULL) {
+		return NULL;
+	}
+
+	td->tracker = m_clock_rls_skew_tracker_alloc(window_samples);
+	if (td->tracker == NULL || os_mutex_init(&td->mutex) != 0) {
+		free(td->tracker);
+		free(td);
+		return NULL;
+	}
+
+	snprintf(td->name, sizeof(td->name), "%s", name);
+	td->refcount = 1;
+
+	return td;
+}
+
+struct m_clock_time_domain *
+m_clock_time_domain_ref(const char *name, const size_t window_samples)
+{
+	struct m_clock_time_domain *found = NULL;
+	struct m_clock_time_domain **free_slot = NULL;
+
+	registry_lock();
+
+	for (size_t i = 0; i < M_CLOCK_TIME_DOMAIN_MAX; i++) {
+		struct m_clock_time_domain *td = registry.domains[i];
+		if (td == NULL) {
+			if (free_slot == NULL) {
+				free_slot = &registry.domains[i];
+			}
+			continue;
+		}
+		if (strncmp(td->name, name, sizeof(td->name) - 1) == 0) {
+			td->refcount++;
+			found = td;
+			break;
+		}
+	}
+
+	// Not shared if there is no room for it, streams still get a working clock.
+	if (found == NULL) {
+		found = time_domain_create(name, window_samples);
+		if (free_slot != NULL) {
+			*free_slot = found;
+		}
+	}
+
+	registry_unlock();
+
+	return found;
+}
+
+void
+m_clock_time_domain_unref(struct m_clock_time_domain **td_ptr)
+{
+	struct m_clock_time_domain *td = *td_ptr;
+	if (td == NULL) {
+		return;
+	}
+	*td_ptr = NULL;
+
+	registry_lock();
+
+	bool last = --td->refcount == 0;
+	for (size_t i = 0; last && i < M_CLOCK_TIME_DOMAIN_MAX; i++) {
+		if (registry.domains[i] == td) {
+			registry.domains[i] = NULL;
+		}
+	}
+
+	registry_unlock();
+
+	if (last) {
+		os_mutex_destroy(&td->mutex);
+		m_clock_rls_skew_tracker_destroy(td->tracker);
+		free(td);
+	}
+}
+
+void
+m_clock_time_domain_push(struct m_clock_time_domain *td, const timepoint_ns local_ts, const timepoint_ns remote_ts)
+{
+	os_mutex_lock(&td->mutex);
+	m_clock_rls_skew_tracker_push(td->tracker, local_ts, remote_ts);
+	os_mutex_unlock(&td->mutex);
+}
+
+bool
+m_clock_time_domain_to_local(struct m_clock_time_domain *td, const timepoint_ns remote_ts, timepoint_ns *local_ts)
+{
+	os_mutex_lock(&td->mutex);
+	bool ret = m_clock_rls_skew_tracker_to_local(td->tracker, remote_ts, local_ts);
+	os_mutex_unlock(&td->mutex);
+
+	return ret;
+}
+
+bool
+m_clock_time_domain_to_remote(struct m_clock_time_domain *td, const timepoint_ns local_ts, timepoint_ns *remote_ts)
+{
+	os_mutex_lock(&td->mutex);
+	bool ret = m_clock_rls_skew_tracker_to_remote(td->tracker, local_ts, remote_ts);
+	os_mutex_unlock(&td->mutex);
+
+	return ret;
+}
@@ -98,6 +98,81 @@ m_clock_windowed_skew_tracker_to_remote(struct m_clock_windowed_skew_tracker *t,
                                         const timepoint_ns local_ts,
                                         timepoint_ns *remote_ts);
 
+
+/*!
+ * Helper to estimate the offset and the rate difference between two clocks
+ * with a recursive least squares fit, using exponential forgetting so that
+ * roughly the last @p window_samples samples are weighted in.
+ *
+ * Every push is O(1) no matter the window size, which makes it suitable for
+ * high rate streams like 1 kHz IMU samples. Because the rate is estimated too,
+ * conversions in between observations are linearly corrected for drift.
+ * Observations that arrive later than the fit predicts pull less on the
+ * estimate, on the theory that they were delayed in transmission, so it
+ * follows the least delayed ones.
+ */
+struct m_clock_rls_skew_tracker;
+
+/*!
+ * Allocate a struct m_clock_rls_skew_tracker that weights in about the last
+ * @p window_samples samples.
+ */
+struct m_clock_rls_skew_tracker *
+m_clock_rls_skew_tracker_alloc(const size_t window_samples);
+void
+m_clock_rls_skew_tracker_reset(struct m_clock_rls_skew_tracker *t);
+void
+m_clock_rls_skew_tracker_destroy(struct m_clock_rls_skew_tracker *t);
+
+void
+m_clock_rls_skew_tracker_push(struct m_clock_rls_skew_tracker *t,
+                              const timepoint_ns local_ts,
+                              const timepoint_ns remote_ts);
+
+bool
+m_clock_rls_skew_tracker_to_local(struct m_clock_rls_skew_tracker *t,
+                                  const timepoint_ns remote_ts,
+                                  timepoint_ns *local_ts);
+bool
+m_clock_rls_skew_tracker_to_remote(struct m_clock_rls_skew_tracker *t,
+                                   const timepoint_ns local_ts,
+                                   timepoint_ns *remote_ts);
+
+
+/*!
+ * A clock of a remote device shared between all of the streams that carry its
+ * timestamps, like the cameras and the IMU of a headset. Any stream can push
+ * observations and all of them convert with the same estimate, so they stay
+ * aligned with each other. Backed by a @ref m_clock_rls_skew_tracker and safe
+ * to use from multiple threads.
+ */
+struct m_clock_time_domain;
+
+/*!
+ * Get the time domain called @p name, creating it if it doesn't exist yet, the
+ * caller gets a reference that must be released with
+ * @ref m_clock_time_domain_unref. The @p window_samples is only used when the
+ * domain is created. If too many domains exist the new one isn't shared.
+ */
+struct m_clock_time_domain *
+m_clock_time_domain_ref(const char *name, const size_t window_samples);
+
+/*!
+ * Release a reference, the domain is destroyed with the last one, sets the
+ * pointer to NULL.
+ */
+void
+m_clock_time_domain_unref(struct m_clock_time_domain **td_ptr);
+
+void
+m_clock_time_domain_push(struct m_clock_time_domain *td, const timepoint_ns local_ts, const timepoint_ns remote_ts);
+
+bool
+m_clock_time_domain_to_local(struct m_clock_time_domain *td, const timepoint_ns remote_ts, timepoint_ns *local_ts);
+
+bool
+m_clock_time_domain_to_remote(struct m_clock_time_domain *td, const timepoint_ns local_ts, timepoint_ns *remote_ts);
+
 #ifdef __cplusplus
 }
 #endif
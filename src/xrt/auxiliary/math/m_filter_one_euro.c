@@ -21,6 +21,14 @@
 
 #include "m_filter_one_euro.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define HAVE_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HAVE_NEON
+#endif
+
 
 static double
 calc_smoothing_alpha(double Fc, double dt)
@@ -258,6 +266,39 @@ m_filter_euro_quat_init(struct m_filter_euro_quat *f, double fc_min, double fc_m
 	filter_one_euro_init(&f->base, fc_min, fc_min_d, beta);
 }
 
+/// The quaternion filter step, shared between the single and array filters.
+static void
+filter_euro_quat_step(const struct m_filter_one_euro_base *base,
+                      double dt,
+                      double alpha_d,
+                      struct xrt_quat *prev_y,
+                      struct xrt_quat *prev_dy,
+                      const struct xrt_quat *in_y,
+                      struct xrt_quat *out_y)
+{
+	struct xrt_quat dy;
+	math_quat_unrotate(prev_y, in_y, &dy);
+
+	// Scale dy with dt through a conversion to angle_axis
+	struct xrt_vec3 dy_aa;
+	math_quat_ln(&dy, &dy_aa);
+	dy_aa = m_vec3_div_scalar(dy_aa, dt);
+	math_quat_exp(&dy_aa, &dy);
+
+	*prev_dy = exp_smooth_quat(alpha_d, dy, *prev_dy);
+
+	// The magnitud of the smoothed dy (prev_dy) is its rotation angle in radians
+	struct xrt_vec3 smooth_dy_aa;
+	math_quat_ln(prev_dy, &smooth_dy_aa);
+	double smooth_dy_mag = m_vec3_len(smooth_dy_aa);
+
+	double alpha = filter_one_euro_compute_alpha(base, dt, smooth_dy_mag);
+
+	/* Smooth the dy values and use them to calculate the frequency cutoff for the main filter */
+	*prev_y = exp_smooth_quat(alpha, *in_y, *prev_y);
+	*out_y = *prev_y;
+}
+
 void
 m_filter_euro_quat_run(struct m_filter_euro_quat *f, uint64_t ts, const struct xrt_quat *in_y, struct xrt_quat *out_y)
 {
@@ -273,25 +314,283 @@ m_filter_euro_quat_run(struct m_filter_euro_quat *f, uint64_t ts, const struct x
 	double dt = 0;
 	double alpha_d = filter_one_euro_compute_alpha_d(&f->base, &dt, ts, true);
 
-	struct xrt_quat dy;
-	math_quat_unrotate(&f->prev_y, in_y, &dy);
+	filter_euro_quat_step(&f->base, dt, alpha_d, &f->prev_y, &f->prev_dy, in_y, out_y);
+}
 
-	// Scale dy with dt through a conversion to angle_axis
-	struct xrt_vec3 dy_aa;
-	math_quat_ln(&dy, &dy_aa);
-	dy_aa = m_vec3_div_scalar(dy_aa, dt);
-	math_quat_exp(&dy_aa, &dy);
+void
+m_filter_euro_vec3_array_init(
+    struct m_filter_euro_vec3_array *f, uint32_t count, double fc_min, double fc_min_d, double beta)
+{
+	filter_one_euro_init(&f->base, fc_min, fc_min_d, beta);
 
-	f->prev_dy = exp_smooth_quat(alpha_d, dy, f->prev_dy);
+	f->count = count;
 
-	// The magnitud of the smoothed dy (f->prev_dy) is its rotation angle in radians
-	struct xrt_vec3 smooth_dy_aa;
-	math_quat_ln(&f->prev_dy, &smooth_dy_aa);
-	double smooth_dy_mag = m_vec3_len(smooth_dy_aa);
+	// One allocation for all of the component arrays.
+	float *data = U_TYPED_ARRAY_CALLOC(float, (size_t)count * 6);
+	for (uint32_t i = 0; i < 3; i++) {
+		f->prev_y[i] = data + (size_t)count * i;
+		f->prev_dy[i] = data + (size_t)count * (3 + i);
+	}
+}
+
+/// Values shared by all elements of a @ref m_filter_euro_vec3_array update.
+struct euro_vec3_array_params
+{
+	float alpha_d;
+	float inv_dt;
+	float r_scale;
+	float fc_min;
+	float beta;
+};
+
+/// Filters elements from @p i to the end, same maths as the SIMD versions.
+static void
+vec3_array_run_scalar(struct m_filter_euro_vec3_array *f,
+                      const struct euro_vec3_array_params *p,
+                      uint32_t i,
+                      const struct xrt_vec3 *in_y,
+                      struct xrt_vec3 *out_y)
+{
+	float *py_x = f->prev_y[0];
+	float *py_y = f->prev_y[1];
+	float *py_z = f->prev_y[2];
+	float *pdy_x = f->prev_dy[0];
+	float *pdy_y = f->prev_dy[1];
+	float *pdy_z = f->prev_dy[2];
+
+	const float alpha_d = p->alpha_d;
+	const float one_minus_alpha_d = 1.0f - p->alpha_d;
+
+	for (; i < f->count; i++) {
+		float x = in_y[i].x;
+		float y = in_y[i].y;
+		float z = in_y[i].z;
+
+		float dx = alpha_d * ((x - py_x[i]) * p->inv_dt) + one_minus_alpha_d * pdy_x[i];
+		float dy = alpha_d * ((y - py_y[i]) * p->inv_dt) + one_minus_alpha_d * pdy_y[i];
+		float dz = alpha_d * ((z - py_z[i]) * p->inv_dt) + one_minus_alpha_d * pdy_z[i];
+		pdy_x[i] = dx;
+		pdy_y[i] = dy;
+		pdy_z[i] = dz;
+
+		// Same as calc_smoothing_alpha.
+		float dy_mag = sqrtf(dx * dx + dy * dy + dz * dz);
+		float r = p->r_scale * (p->fc_min + p->beta * dy_mag);
+		float alpha = r / (r + 1.0f);
+
+		x = alpha * x + (1.0f - alpha) * py_x[i];
+		y = alpha * y + (1.0f - alpha) * py_y[i];
+		z = alpha * z + (1.0f - alpha) * py_z[i];
+		py_x[i] = x;
+		py_y[i] = y;
+		py_z[i] = z;
+
+		out_y[i].x = x;
+		out_y[i].y = y;
+		out_y[i].z = z;
+	}
+}
 
-	double alpha = filter_one_euro_compute_alpha(&f->base, dt, smooth_dy_mag);
+#if defined(HAVE_SSE2)
+/// Filters four elements at a time, returns the index of the first element not filtered.
+static uint32_t
+vec3_array_run_sse2(struct m_filter_euro_vec3_array *f,
+                    const struct euro_vec3_array_params *p,
+                    const struct xrt_vec3 *in_y,
+                    struct xrt_vec3 *out_y)
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 alpha_d = _mm_set1_ps(p->alpha_d);
+	const __m128 one_minus_alpha_d = _mm_set1_ps(1.0f - p->alpha_d);
+	const __m128 inv_dt = _mm_set1_ps(p->inv_dt);
+	const __m128 r_scale = _mm_set1_ps(p->r_scale);
+	const __m128 fc_min = _mm_set1_ps(p->fc_min);
+	const __m128 beta = _mm_set1_ps(p->beta);
+
+	uint32_t i = 0;
+	for (; i + 4 <= f->count; i += 4) {
+		const struct xrt_vec3 *in = &in_y[i];
+		__m128 in_c[3] = {
+		    _mm_set_ps(in[3].x, in[2].x, in[1].x, in[0].x),
+		    _mm_set_ps(in[3].y, in[2].y, in[1].y, in[0].y),
+		    _mm_set_ps(in[3].z, in[2].z, in[1].z, in[0].z),
+		};
+
+		__m128 prev_c[3];
+		__m128 dy_c[3];
+		for (int c = 0; c < 3; c++) {
+			prev_c[c] = _mm_loadu_ps(&f->prev_y[c][i]);
+			__m128 d = _mm_mul_ps(_mm_sub_ps(in_c[c], prev_c[c]), inv_dt);
+			__m128 prev_d = _mm_loadu_ps(&f->prev_dy[c][i]);
+			d = _mm_add_ps(_mm_mul_ps(alpha_d, d), _mm_mul_ps(one_minus_alpha_d, prev_d));
+			_mm_storeu_ps(&f->prev_dy[c][i], d);
+			dy_c[c] = d;
+		}
+		__m128 mag2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dy_c[0], dy_c[0]), _mm_mul_ps(dy_c[1], dy_c[1])),
+		                         _mm_mul_ps(dy_c[2], dy_c[2]));
+
+		__m128 r = _mm_mul_ps(r_scale, _mm_add_ps(fc_min, _mm_mul_ps(beta, _mm_sqrt_ps(mag2))));
+		__m128 alpha = _mm_div_ps(r, _mm_add_ps(r, one));
+		__m128 one_minus_alpha = _mm_sub_ps(one, alpha);
+
+		float out_c[3][4];
+		for (int c = 0; c < 3; c++) {
+			__m128 v = _mm_add_ps(_mm_mul_ps(alpha, in_c[c]), _mm_mul_ps(one_minus_alpha, prev_c[c]));
+			_mm_storeu_ps(&f->prev_y[c][i], v);
+			_mm_storeu_ps(out_c[c], v);
+		}
 
-	/* Smooth the dy values and use them to calculate the frequency cutoff for the main filter */
-	f->prev_y = exp_smooth_quat(alpha, *in_y, f->prev_y);
-	*out_y = f->prev_y;
+		for (int k = 0; k < 4; k++) {
+			out_y[i + k].x = out_c[0][k];
+			out_y[i + k].y = out_c[1][k];
+			out_y[i + k].z = out_c[2][k];
+		}
+	}
+
+	return i;
+}
+#endif
+
+#if defined(HAVE_NEON)
+/// Filters four elements at a time, returns the index of the first element not filtered.
+static uint32_t
+vec3_array_run_neon(struct m_filter_euro_vec3_array *f,
+                    const struct euro_vec3_array_params *p,
+                    const struct xrt_vec3 *in_y,
+                    struct xrt_vec3 *out_y)
+{
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	const float32x4_t alpha_d = vdupq_n_f32(p->alpha_d);
+	const float32x4_t one_minus_alpha_d = vdupq_n_f32(1.0f - p->alpha_d);
+	const float32x4_t inv_dt = vdupq_n_f32(p->inv_dt);
+	const float32x4_t r_scale = vdupq_n_f32(p->r_scale);
+	const float32x4_t fc_min = vdupq_n_f32(p->fc_min);
+	const float32x4_t beta = vdupq_n_f32(p->beta);
+
+	uint32_t i = 0;
+	for (; i + 4 <= f->count; i += 4) {
+		// xrt_vec3 is three packed floats, de-interleave four of them.
+		float32x4x3_t in_c = vld3q_f32(&in_y[i].x);
+
+		float32x4_t prev_c[3];
+		float32x4_t dy_c[3];
+		for (int c = 0; c < 3; c++) {
+			prev_c[c] = vld1q_f32(&f->prev_y[c][i]);
+			float32x4_t d = vmulq_f32(vsubq_f32(in_c.val[c], prev_c[c]), inv_dt);
+			float32x4_t prev_d = vld1q_f32(&f->prev_dy[c][i]);
+			d = vaddq_f32(vmulq_f32(alpha_d, d), vmulq_f32(one_minus_alpha_d, prev_d));
+			vst1q_f32(&f->prev_dy[c][i], d);
+			dy_c[c] = d;
+		}
+		float32x4_t mag2 = vaddq_f32(vaddq_f32(vmulq_f32(dy_c[0], dy_c[0]), vmulq_f32(dy_c[1], dy_c[1])),
+		                             vmulq_f32(dy_c[2], dy_c[2]));
+
+		float32x4_t r = vmulq_f32(r_scale, vaddq_f32(fc_min, vmulq_f32(beta, vsqrtq_f32(mag2))));
+		float32x4_t alpha = vdivq_f32(r, vaddq_f32(r, one));
+		float32x4_t one_minus_alpha = vsubq_f32(one, alpha);
+
+		float32x4x3_t out_c;
+		for (int c = 0; c < 3; c++) {
+			out_c.val[c] = vaddq_f32(vmulq_f32(alpha, in_c.val[c]), vmulq_f32(one_minus_alpha, prev_c[c]));
+			vst1q_f32(&f->prev_y[c][i], out_c.val[c]);
+		}
+		vst3q_f32(&out_y[i].x, out_c);
+	}
+
+	return i;
+}
+#endif
+
+void
+m_filter_euro_vec3_array_run(struct m_filter_euro_vec3_array *f,
+                             uint64_t ts,
+                             const struct xrt_vec3 *in_y,
+                             struct xrt_vec3 *out_y)
+{
+	if (filter_one_euro_handle_first_sample(&f->base, ts, true)) {
+		/* First sample - no filtering yet */
+		for (uint32_t i = 0; i < f->count; i++) {
+			f->prev_y[0][i] = in_y[i].x;
+			f->prev_y[1][i] = in_y[i].y;
+			f->prev_y[2][i] = in_y[i].z;
+			f->prev_dy[0][i] = 0.0f;
+			f->prev_dy[1][i] = 0.0f;
+			f->prev_dy[2][i] = 0.0f;
+			out_y[i] = in_y[i];
+		}
+		return;
+	}
+
+	// Everything that only depends on the timestamp is done once.
+	double dt = 0;
+	double alpha_d = filter_one_euro_compute_alpha_d(&f->base, &dt, ts, true);
+
+	struct euro_vec3_array_params p = {
+	    .alpha_d = (float)alpha_d,
+	    .inv_dt = (float)(1.0 / dt),
+	    .r_scale = (float)(2.0 * M_PI * dt),
+	    .fc_min = f->base.fc_min,
+	    .beta = f->base.beta,
+	};
+
+	uint32_t i = 0;
+#if defined(HAVE_SSE2)
+	i = vec3_array_run_sse2(f, &p, in_y, out_y);
+#elif defined(HAVE_NEON)
+	i = vec3_array_run_neon(f, &p, in_y, out_y);
+#endif
+
+	vec3_array_run_scalar(f, &p, i, in_y, out_y);
+}
+
+void
+m_filter_euro_vec3_array_fini(struct m_filter_euro_vec3_array *f)
+{
+	// All arrays are from the same allocation.
+	free(f->prev_y[0]);
+	U_ZERO(f);
+}
+
+void
+m_filter_euro_quat_array_init(
+    struct m_filter_euro_quat_array *f, uint32_t count, double fc_min, double fc_min_d, double beta)
+{
+	filter_one_euro_init(&f->base, fc_min, fc_min_d, beta);
+
+	f->count = count;
+	f->prev_y = U_TYPED_ARRAY_CALLOC(struct xrt_quat, count);
+	f->prev_dy = U_TYPED_ARRAY_CALLOC(struct xrt_quat, count);
+}
+
+void
+m_filter_euro_quat_array_run(struct m_filter_euro_quat_array *f,
+                             uint64_t ts,
+                             const struct xrt_quat *in_y,
+                             struct xrt_quat *out_y)
+{
+	if (filter_one_euro_handle_first_sample(&f->base, ts, true)) {
+		/* First sample - no filtering yet */
+		for (uint32_t i = 0; i < f->count; i++) {
+			f->prev_dy[i] = (struct xrt_quat)XRT_QUAT_IDENTITY;
+			f->prev_y[i] = in_y[i];
+			out_y[i] = in_y[i];
+		}
+		return;
+	}
+
+	// Only computed once for all elements.
+	double dt = 0;
+	double alpha_d = filter_one_euro_compute_alpha_d(&f->base, &dt, ts, true);
+
+	for (uint32_t i = 0; i < f->count; i++) {
+		filter_euro_quat_step(&f->base, dt, alpha_d, &f->prev_y[i], &f->prev_dy[i], &in_y[i], &out_y[i]);
+	}
+}
+
+void
+m_filter_euro_quat_array_fini(struct m_filter_euro_quat_array *f)
+{
+	free(f->prev_y);
+	free(f->prev_dy);
+	U_ZERO(f);
 }
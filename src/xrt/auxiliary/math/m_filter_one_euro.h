@@ -125,6 +125,51 @@ struct m_filter_euro_quat
 	struct xrt_quat prev_dy;
 };
 
+/*!
+ * @brief One Euro filter for an array of 3D float measurements that are all
+ * sampled at the same time, like the joints of a hand.
+ *
+ * The timestamp handling is shared and the state is stored as separate
+ * component arrays so the per element update is a tight loop.
+ *
+ * @ingroup aux_math
+ */
+struct m_filter_euro_vec3_array
+{
+	/** Base/common data */
+	struct m_filter_one_euro_base base;
+
+	/** Number of elements filtered. */
+	uint32_t count;
+
+	/** The most recent measurements, after filtering, one array per component. */
+	float *prev_y[3];
+
+	/** The most recent sample derivatives, after filtering, one array per component. */
+	float *prev_dy[3];
+};
+
+/*!
+ * @brief One Euro filter for an array of unit quaternions that are all sampled
+ * at the same time, like the joints of a hand.
+ *
+ * @ingroup aux_math
+ */
+struct m_filter_euro_quat_array
+{
+	/** Base/common data */
+	struct m_filter_one_euro_base base;
+
+	/** Number of elements filtered. */
+	uint32_t count;
+
+	/** The most recent measurements, after filtering. */
+	struct xrt_quat *prev_y;
+
+	/** The most recent sample derivatives, after filtering. */
+	struct xrt_quat *prev_dy;
+};
+
 /**
  * @brief Initialize a 1D filter
  *
@@ -247,6 +292,90 @@ m_filter_euro_quat_init(struct m_filter_euro_quat *f, double fc_min, double fc_m
 void
 m_filter_euro_quat_run(struct m_filter_euro_quat *f, uint64_t ts, const struct xrt_quat *in_y, struct xrt_quat *out_y);
 
+/**
+ * @brief Initialize a filter for @p count 3D measurements, allocates the state
+ * and must be finalized with @ref m_filter_euro_vec3_array_fini.
+ *
+ * @param f self pointer
+ * @param count Number of elements in each measurement
+ * @param fc_min Minimum frequency cutoff for filter
+ * @param fc_min_d Minimum frequency cutoff for derivative filter
+ * @param beta Beta value for "responsiveness" of filter
+ *
+ * @public @memberof m_filter_euro_vec3_array
+ */
+void
+m_filter_euro_vec3_array_init(
+    struct m_filter_euro_vec3_array *f, uint32_t count, double fc_min, double fc_min_d, double beta);
+
+/**
+ * @brief Filter @p f->count measurements taken at the same time and commit
+ * changes to filter state, same result as one @ref m_filter_euro_vec3 per
+ * element.
+ *
+ * @param[in,out] f self pointer
+ * @param ts measurement timestamp
+ * @param in_y raw measurements, @p f->count elements
+ * @param[out] out_y filtered measurements, @p f->count elements, may be @p in_y
+ *
+ * @public @memberof m_filter_euro_vec3_array
+ */
+void
+m_filter_euro_vec3_array_run(struct m_filter_euro_vec3_array *f,
+                             uint64_t ts,
+                             const struct xrt_vec3 *in_y,
+                             struct xrt_vec3 *out_y);
+
+/**
+ * @brief Frees the state of the filter.
+ *
+ * @public @memberof m_filter_euro_vec3_array
+ */
+void
+m_filter_euro_vec3_array_fini(struct m_filter_euro_vec3_array *f);
+
+/**
+ * @brief Initialize a filter for @p count unit quaternions, allocates the
+ * state and must be finalized with @ref m_filter_euro_quat_array_fini.
+ *
+ * @param f self pointer
+ * @param count Number of elements in each measurement
+ * @param fc_min Minimum frequency cutoff for filter
+ * @param fc_min_d Minimum frequency cutoff for derivative filter
+ * @param beta Beta value for "responsiveness" of filter
+ *
+ * @public @memberof m_filter_euro_quat_array
+ */
+void
+m_filter_euro_quat_array_init(
+    struct m_filter_euro_quat_array *f, uint32_t count, double fc_min, double fc_min_d, double beta);
+
+/**
+ * @brief Filter @p f->count measurements taken at the same time and commit
+ * changes to filter state, same result as one @ref m_filter_euro_quat per
+ * element.
+ *
+ * @param[in,out] f self pointer
+ * @param ts measurement timestamp
+ * @param in_y raw measurements, @p f->count elements
+ * @param[out] out_y filtered measurements, @p f->count elements, may be @p in_y
+ *
+ * @public @memberof m_filter_euro_quat_array
+ */
+void
+m_filter_euro_quat_array_run(struct m_filter_euro_quat_array *f,
+                             uint64_t ts,
+                             const struct xrt_quat *in_y,
+                             struct xrt_quat *out_y);
+
+/**
+ * @brief Frees the state of the filter.
+ *
+ * @public @memberof m_filter_euro_quat_array
+ */
+void
+m_filter_euro_quat_array_fini(struct m_filter_euro_quat_array *f);
+
 
 #ifdef __cplusplus
 }
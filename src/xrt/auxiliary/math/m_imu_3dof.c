@@ -100,13 +100,12 @@ m_imu_3dof_add_vars(struct m_imu_3dof *f, void *root, const char *prefix)
 	u_var_add_bool(root, &f->gyro_bias.manually_fire, tmp);
 }
 
-static void
-gravity_correction(struct m_imu_3dof *f,
-                   uint64_t timestamp_ns,
-                   const struct xrt_vec3 *accel,
-                   const struct xrt_vec3 *gyro,
-                   double dt,
-                   float gyro_length)
+/*!
+ * Tracks if the device is level and updates the error to correct for, returns
+ * false if gravity correction is disabled.
+ */
+static bool
+gravity_level_check(struct m_imu_3dof *f, uint64_t timestamp_ns, const struct xrt_vec3 *accel, float gyro_length)
 {
 	uint64_t dur_ns = 0;
 	if (f->flags & M_IMU_3DOF_USE_GRAVITY_DUR_20MS) {
@@ -114,12 +113,11 @@ gravity_correction(struct m_imu_3dof *f,
 	} else if (f->flags & M_IMU_3DOF_USE_GRAVITY_DUR_300MS) {
 		dur_ns = DUR_300MS_IN_NS;
 	} else {
-		return;
+		return false;
 	}
 
 	const float gravity_tolerance = .9f;
 	const float gyro_tolerance = .1f;
-	const float min_tilt_error = 0.05f;
 	const float max_tilt_error = 0.01f;
 
 	/*
@@ -177,32 +175,72 @@ gravity_correction(struct m_imu_3dof *f,
 		}
 	}
 
-	if (f->grav.error_angle > min_tilt_error) {
-		// Correct 180° over 5 seconds, when moving.
-		float max_radians = (float)M_PI * (float)dt / 5;
-		// Correct 180° over 60 seconds, when stationary.
-		float min_radians = (float)M_PI * (float)dt / 60;
-
-		/*
-		 * We're treating 0.5 * gyro_length as a unitless scale factor.
-		 * Tested in a headset, 0.5 felt nice.
-		 */
-		float correction_radians = 0.5f * gyro_length * max_radians;
-		// Clamp to the range [min_radians, max_radians]
-		correction_radians = fmaxf(min_radians, correction_radians);
-		correction_radians = fminf(max_radians, correction_radians);
-		// Do not exceed the remaining error to correct for
-		correction_radians = -fminf(correction_radians, f->grav.error_angle);
-
-		// Update how much is left.
-		f->grav.error_angle += correction_radians;
-
-		// Perform the correction.
-		struct xrt_quat corr_quat;
-		struct xrt_quat old_orient;
-		math_quat_from_angle_vector(correction_radians, &f->grav.error_axis, &corr_quat);
-		old_orient = f->rot;
-		math_quat_rotate(&corr_quat, &old_orient, &f->rot);
+	return true;
+}
+
+/*!
+ * How much to correct around the error axis for this sample, also updates how
+ * much error is left. Returns zero if the error is small enough to leave be.
+ */
+static float
+gravity_correction_radians(struct m_imu_3dof *f, double dt, float gyro_length)
+{
+	const float min_tilt_error = 0.05f;
+
+	if (f->grav.error_angle <= min_tilt_error) {
+		return 0.0f;
+	}
+
+	// Correct 180° over 5 seconds, when moving.
+	float max_radians = (float)M_PI * (float)dt / 5;
+	// Correct 180° over 60 seconds, when stationary.
+	float min_radians = (float)M_PI * (float)dt / 60;
+
+	/*
+	 * We're treating 0.5 * gyro_length as a unitless scale factor.
+	 * Tested in a headset, 0.5 felt nice.
+	 */
+	float correction_radians = 0.5f * gyro_length * max_radians;
+	// Clamp to the range [min_radians, max_radians]
+	correction_radians = fmaxf(min_radians, correction_radians);
+	correction_radians = fminf(max_radians, correction_radians);
+	// Do not exceed the remaining error to correct for
+	correction_radians = -fminf(correction_radians, f->grav.error_angle);
+
+	// Update how much is left.
+	f->grav.error_angle += correction_radians;
+
+	return correction_radians;
+}
+
+/*!
+ * The correction is in world space and the gyro integration in device space,
+ * so corrections around the same axis can be gathered and applied at once.
+ */
+static void
+gravity_correction_apply(struct m_imu_3dof *f, float correction_radians, const struct xrt_vec3 *axis)
+{
+	struct xrt_quat corr_quat;
+	struct xrt_quat old_orient;
+	math_quat_from_angle_vector(correction_radians, axis, &corr_quat);
+	old_orient = f->rot;
+	math_quat_rotate(&corr_quat, &old_orient, &f->rot);
+}
+
+static void
+gravity_correction(struct m_imu_3dof *f,
+                   uint64_t timestamp_ns,
+                   const struct xrt_vec3 *accel,
+                   double dt,
+                   float gyro_length)
+{
+	if (!gravity_level_check(f, timestamp_ns, accel, gyro_length)) {
+		return;
+	}
+
+	float correction_radians = gravity_correction_radians(f, dt, gyro_length);
+	if (correction_radians != 0.0f) {
+		gravity_correction_apply(f, correction_radians, &f->grav.error_axis);
 	}
 }
 
@@ -226,17 +264,24 @@ gyro_biasing(struct m_imu_3dof *f, uint64_t timestamp_ns)
 	f->gyro_bias.value = gyro_mean;
 }
 
-void
-m_imu_3dof_update(struct m_imu_3dof *f,
-                  uint64_t timestamp_ns,
-                  const struct xrt_vec3 *accel,
-                  const struct xrt_vec3 *gyro)
+/*!
+ * Integrates the gyro of one sample and pushes it to the filters, everything
+ * but the gravity correction and normalization. Returns false for the first
+ * sample, which is skipped.
+ */
+static bool
+integrate_sample(struct m_imu_3dof *f,
+                 uint64_t timestamp_ns,
+                 const struct xrt_vec3 *accel,
+                 const struct xrt_vec3 *gyro,
+                 double *out_dt,
+                 float *out_gyro_biased_length)
 {
 	//! Skip the first sample.
 	if (f->state == M_IMU_3DOF_STATE_START) {
 		f->state = M_IMU_3DOF_STATE_RUNNING;
 		f->last.timestamp_ns = timestamp_ns;
-		return;
+		return false;
 	}
 
 	// This code assumes all timestamps makes some forward progress.
@@ -286,8 +331,26 @@ m_imu_3dof_update(struct m_imu_3dof *f,
 #endif
 	}
 
+	*out_dt = dt;
+	*out_gyro_biased_length = gyro_biased_length;
+
+	return true;
+}
+
+void
+m_imu_3dof_update(struct m_imu_3dof *f,
+                  uint64_t timestamp_ns,
+                  const struct xrt_vec3 *accel,
+                  const struct xrt_vec3 *gyro)
+{
+	double dt = 0.0;
+	float gyro_biased_length = 0.0f;
+	if (!integrate_sample(f, timestamp_ns, accel, gyro, &dt, &gyro_biased_length)) {
+		return;
+	}
+
 	// Gravity correction.
-	gravity_correction(f, timestamp_ns, accel, &gyro_biased, dt, gyro_biased_length);
+	gravity_correction(f, timestamp_ns, accel, dt, gyro_biased_length);
 
 	// Gyro bias calculations.
 	gyro_biasing(f, timestamp_ns);
@@ -298,3 +361,45 @@ m_imu_3dof_update(struct m_imu_3dof *f,
 	 */
 	math_quat_normalize(&f->rot);
 }
+
+void
+m_imu_3dof_update_batch(struct m_imu_3dof *f,
+                        const uint64_t *timestamps_ns,
+                        const struct xrt_vec3 *accels,
+                        const struct xrt_vec3 *gyros,
+                        uint32_t count)
+{
+	// Gathered corrections around the pending axis.
+	float pending_radians = 0.0f;
+	struct xrt_vec3 pending_axis = f->grav.error_axis;
+
+	for (uint32_t i = 0; i < count; i++) {
+		double dt = 0.0;
+		float gyro_biased_length = 0.0f;
+		if (!integrate_sample(f, timestamps_ns[i], &accels[i], &gyros[i], &dt, &gyro_biased_length)) {
+			continue;
+		}
+
+		if (gravity_level_check(f, timestamps_ns[i], &accels[i], gyro_biased_length)) {
+			// A new error axis, flush what was gathered around the old one.
+			if (!m_vec3_equal_exact(pending_axis, f->grav.error_axis)) {
+				if (pending_radians != 0.0f) {
+					gravity_correction_apply(f, pending_radians, &pending_axis);
+				}
+				pending_radians = 0.0f;
+				pending_axis = f->grav.error_axis;
+			}
+
+			pending_radians += gravity_correction_radians(f, dt, gyro_biased_length);
+		}
+
+		gyro_biasing(f, timestamps_ns[i]);
+	}
+
+	if (pending_radians != 0.0f) {
+		gravity_correction_apply(f, pending_radians, &pending_axis);
+	}
+
+	// Only once per batch, the drift is small over a few samples.
+	math_quat_normalize(&f->rot);
+}
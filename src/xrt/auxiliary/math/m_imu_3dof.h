@@ -90,6 +90,19 @@ m_imu_3dof_update(struct m_imu_3dof *f,
                   const struct xrt_vec3 *accel,
                   const struct xrt_vec3 *gyro);
 
+/*!
+ * Update with a packet of @p count samples at once, for devices that deliver
+ * several samples per report. The gravity correction of the whole packet is
+ * applied in one step and the orientation is normalized once, the world space
+ * accelerations pushed to the filter are rotated before that step.
+ */
+void
+m_imu_3dof_update_batch(struct m_imu_3dof *f,
+                        const uint64_t *timestamps_ns,
+                        const struct xrt_vec3 *accels,
+                        const struct xrt_vec3 *gyros,
+                        uint32_t count);
+
 
 #ifdef __cplusplus
 }
@@ -1,4 +1,4 @@
-// Copyright 2021, Collabora, Ltd.
+// Copyright 2021-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -28,15 +28,20 @@
 #include <memory>
 #include <algorithm>
 #include <cstring>
+#include <cmath>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <assert.h>
 #include <mutex>
+#include <atomic>
 
 using namespace xrt::auxiliary::util;
 namespace os = xrt::auxiliary::os;
 
+/*!
+ * An unpacked entry, what the history hands out no matter how it is stored.
+ */
 struct relation_history_entry
 {
 	struct xrt_space_relation relation;
@@ -45,17 +50,398 @@ struct relation_history_entry
 
 static constexpr size_t BufLen = 4096;
 
+
+/*
+ *
+ * Entry layouts.
+ *
+ */
+
+//! Range of quantized angular velocities in rad/s, a bit over what IMUs report.
+static constexpr float AngularVelocityRange = 64.f;
+
+//! Range of quantized linear velocities in m/s.
+static constexpr float LinearVelocityRange = 32.f;
+
+static constexpr uint32_t OrientationFlags = XRT_SPACE_RELATION_ORIENTATION_VALID_BIT |
+                                             XRT_SPACE_RELATION_ORIENTATION_TRACKED_BIT |
+                                             XRT_SPACE_RELATION_ANGULAR_VELOCITY_VALID_BIT;
+
+/*!
+ * A vec3 quantized to 16 bits per component in the range [-range, range],
+ * values outside of it are clamped.
+ */
+struct quantized_vec3
+{
+	int16_t x, y, z;
+
+	static int16_t
+	quantize(float value, float range) noexcept
+	{
+		float scaled = value / range * (float)INT16_MAX;
+		if (!(scaled == scaled)) {
+			return 0; // NaN
+		}
+		return (int16_t)std::lround(std::clamp(scaled, -(float)INT16_MAX, (float)INT16_MAX));
+	}
+
+	static quantized_vec3
+	pack(const xrt_vec3 &v, float range) noexcept
+	{
+		return {quantize(v.x, range), quantize(v.y, range), quantize(v.z, range)};
+	}
+
+	xrt_vec3
+	unpack(float range) const noexcept
+	{
+		const float scale = range / (float)INT16_MAX;
+		return {(float)x * scale, (float)y * scale, (float)z * scale};
+	}
+};
+
+//! @ref M_RELATION_HISTORY_LAYOUT_FULL
+struct full_entry
+{
+	struct xrt_space_relation relation;
+
+	static full_entry
+	pack(const xrt_space_relation &rel) noexcept
+	{
+		return {rel};
+	}
+
+	void
+	unpack(xrt_space_relation &out) const noexcept
+	{
+		out = relation;
+	}
+};
+
+//! @ref M_RELATION_HISTORY_LAYOUT_COMPACT
+struct compact_entry
+{
+	struct xrt_pose pose;
+	quantized_vec3 linear_velocity;
+	quantized_vec3 angular_velocity;
+	uint16_t flags;
+
+	static compact_entry
+	pack(const xrt_space_relation &rel) noexcept
+	{
+		return {
+		    rel.pose,
+		    quantized_vec3::pack(rel.linear_velocity, LinearVelocityRange),
+		    quantized_vec3::pack(rel.angular_velocity, AngularVelocityRange),
+		    (uint16_t)rel.relation_flags,
+		};
+	}
+
+	void
+	unpack(xrt_space_relation &out) const noexcept
+	{
+		out.relation_flags = (enum xrt_space_relation_flags)flags;
+		out.pose = pose;
+		out.linear_velocity = linear_velocity.unpack(LinearVelocityRange);
+		out.angular_velocity = angular_velocity.unpack(AngularVelocityRange);
+	}
+};
+
+//! @ref M_RELATION_HISTORY_LAYOUT_ORIENTATION
+struct orientation_entry
+{
+	struct xrt_quat orientation;
+	quantized_vec3 angular_velocity;
+	uint16_t flags;
+
+	static orientation_entry
+	pack(const xrt_space_relation &rel) noexcept
+	{
+		return {
+		    rel.pose.orientation,
+		    quantized_vec3::pack(rel.angular_velocity, AngularVelocityRange),
+		    (uint16_t)(rel.relation_flags & OrientationFlags),
+		};
+	}
+
+	void
+	unpack(xrt_space_relation &out) const noexcept
+	{
+		out.relation_flags = (enum xrt_space_relation_flags)flags;
+		out.pose.orientation = orientation;
+		out.pose.position = {};
+		out.linear_velocity = {};
+		out.angular_velocity = angular_velocity.unpack(AngularVelocityRange);
+	}
+};
+
+static_assert(sizeof(compact_entry) == 44, "compact_entry should be packed");
+static_assert(sizeof(orientation_entry) == 24, "orientation_entry should be packed");
+
+
+/*
+ *
+ * Storage.
+ *
+ */
+
+/*!
+ * The buffers of a history, not thread safe, @ref m_relation_history does the
+ * locking. Functions used by readers must not throw since they can be called
+ * on a torn buffer in seqlock mode.
+ */
+class relation_history_storage
+{
+public:
+	virtual ~relation_history_storage() = default;
+
+	virtual size_t
+	size() const noexcept = 0;
+
+	//! Returns false if @p timestamp is not after the latest entry.
+	virtual bool
+	push(const xrt_space_relation &relation, int64_t timestamp) = 0;
+
+	/*!
+	 * Copies out the entries needed to produce a relation at the given
+	 * time, the meaning of @p out_a and @p out_b depends on the result.
+	 */
+	virtual m_relation_history_result
+	lookup(int64_t at_timestamp_ns,
+	       relation_history_entry *out_a,
+	       relation_history_entry *out_b) const noexcept = 0;
+
+	virtual bool
+	latest(relation_history_entry *out_entry) const noexcept = 0;
+
+	virtual void
+	clear() = 0;
+};
+
+/*!
+ * Storage with entries of type @p Entry, which packs and unpacks the relation,
+ * and room for @p Capacity of them.
+ */
+template <typename Entry, size_t Capacity>
+class relation_history_storage_impl final : public relation_history_storage
+{
+public:
+	size_t
+	size() const noexcept override
+	{
+		return timestamps.size();
+	}
+
+	bool
+	push(const xrt_space_relation &relation, int64_t timestamp) override
+	{
+		// Everything explodes if the timestamps in relation_history aren't monotonically increasing.
+		if (!timestamps.empty() && timestamp <= timestamps.back()) {
+			return false;
+		}
+
+		entries.push_back(Entry::pack(relation));
+		timestamps.push_back(timestamp);
+		return true;
+	}
+
+	m_relation_history_result
+	lookup(int64_t at_timestamp_ns,
+	       relation_history_entry *out_a,
+	       relation_history_entry *out_b) const noexcept override
+	{
+		const size_t size = timestamps.size();
+		if (size == 0 || at_timestamp_ns == 0) {
+			// Do nothing. You push nothing to the buffer you get nothing from the buffer.
+			return M_RELATION_HISTORY_RESULT_INVALID;
+		}
+
+		// Find the first element *not less than* our value, a torn read gives garbage but it's bounds checked.
+		size_t lo = timestamps.lower_bound_index(at_timestamp_ns);
+
+		if (lo >= size) {
+			// lower bound is at the end:
+			// The desired timestamp is after what our buffer contains.
+			// (pose-prediction)
+			return copy_out(size - 1, out_a) ? M_RELATION_HISTORY_RESULT_PREDICTED
+			                                 : M_RELATION_HISTORY_RESULT_INVALID;
+		}
+
+		if (!copy_out(lo, out_a)) {
+			return M_RELATION_HISTORY_RESULT_INVALID;
+		}
+
+		if (at_timestamp_ns == out_a->timestamp) {
+			// exact match
+			return M_RELATION_HISTORY_RESULT_EXACT;
+		}
+
+		if (lo == 0) {
+			// lower bound is at the beginning (and it's not an exact match):
+			// The desired timestamp is before what our buffer contains.
+			return M_RELATION_HISTORY_RESULT_REVERSE_PREDICTED;
+		}
+
+		// We precede lo and follow lo - 1 (which we know exists because we already handled the lo == 0 case)
+		*out_b = *out_a;
+		if (!copy_out(lo - 1, out_a)) {
+			return M_RELATION_HISTORY_RESULT_INVALID;
+		}
+
+		return M_RELATION_HISTORY_RESULT_INTERPOLATED;
+	}
+
+	bool
+	latest(relation_history_entry *out_entry) const noexcept override
+	{
+		const size_t size = timestamps.size();
+		return size > 0 && copy_out(size - 1, out_entry);
+	}
+
+	void
+	clear() override
+	{
+		entries.clear();
+		timestamps.clear();
+	}
+
+private:
+	bool
+	copy_out(size_t index, relation_history_entry *out_entry) const noexcept
+	{
+		const Entry *entry = entries.get_at_index(index);
+		const int64_t *timestamp = timestamps.get_at_index(index);
+		if (entry == nullptr || timestamp == nullptr) {
+			return false;
+		}
+
+		entry->unpack(out_entry->relation);
+		out_entry->timestamp = *timestamp;
+		return true;
+	}
+
+	HistoryBuffer<Entry, Capacity> entries;
+
+	/*!
+	 * The timestamps of @ref entries in a separate buffer, pushed and
+	 * cleared together with it, so searching only touches a dense array.
+	 */
+	HistoryBuffer<int64_t, Capacity> timestamps;
+};
+
 struct m_relation_history
 {
-	HistoryBuffer<struct relation_history_entry, BufLen> impl;
-	mutable os::Mutex mutex;
+	std::unique_ptr<relation_history_storage> impl;
+
+	mutable os::Mutex mutex{"m_relation_history"};
+
+	enum m_relation_history_mode mode = M_RELATION_HISTORY_MODE_MUTEX;
+
+	/*!
+	 * Sequence counter used in @ref M_RELATION_HISTORY_MODE_SEQLOCK mode,
+	 * odd while a writer is modifying @ref impl.
+	 */
+	std::atomic<uint32_t> seq{0};
 };
 
 
+/*
+ *
+ * Helpers.
+ *
+ */
+
+/*!
+ * Run a modifying operation on the history, @p func is called with the
+ * writer side held.
+ */
+template <typename Func>
+static inline void
+write_locked(struct m_relation_history *rh, Func &&func)
+{
+	std::unique_lock<os::Mutex> lock(rh->mutex);
+
+	if (rh->mode != M_RELATION_HISTORY_MODE_SEQLOCK) {
+		func();
+		return;
+	}
+
+	// Odd sequence number, readers will retry.
+	rh->seq.store(rh->seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	func();
+
+	// Even sequence number, the new state is now published.
+	rh->seq.store(rh->seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/*!
+ * Run a read-only operation on the history, in seqlock mode @p func may be
+ * called multiple times and must only copy data out, it may observe a torn
+ * state but its result is discarded in that case.
+ */
+template <typename Func>
+static inline auto
+read_consistent(const struct m_relation_history *rh, Func &&func) -> decltype(func())
+{
+	if (rh->mode != M_RELATION_HISTORY_MODE_SEQLOCK) {
+		std::unique_lock<os::Mutex> lock(rh->mutex);
+		return func();
+	}
+
+	while (true) {
+		uint32_t begin = rh->seq.load(std::memory_order_acquire);
+		if ((begin & 1) != 0) {
+			// A writer is active, they only copy a single entry so spin.
+			continue;
+		}
+
+		auto ret = func();
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (rh->seq.load(std::memory_order_relaxed) == begin) {
+			return ret;
+		}
+	}
+}
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
 void
 m_relation_history_create(struct m_relation_history **rh_ptr)
+{
+	m_relation_history_create_with_mode(rh_ptr, M_RELATION_HISTORY_MODE_MUTEX);
+}
+
+void
+m_relation_history_create_with_mode(struct m_relation_history **rh_ptr, enum m_relation_history_mode mode)
+{
+	m_relation_history_create_with_layout(rh_ptr, mode, M_RELATION_HISTORY_LAYOUT_FULL);
+}
+
+void
+m_relation_history_create_with_layout(struct m_relation_history **rh_ptr,
+                                      enum m_relation_history_mode mode,
+                                      enum m_relation_history_layout layout)
 {
 	auto ret = std::make_unique<m_relation_history>();
+	ret->mode = mode;
+
+	switch (layout) {
+	case M_RELATION_HISTORY_LAYOUT_COMPACT:
+		ret->impl = std::make_unique<relation_history_storage_impl<compact_entry, BufLen>>();
+		break;
+	case M_RELATION_HISTORY_LAYOUT_ORIENTATION:
+		ret->impl = std::make_unique<relation_history_storage_impl<orientation_entry, BufLen>>();
+		break;
+	case M_RELATION_HISTORY_LAYOUT_FULL:
+	default: ret->impl = std::make_unique<relation_history_storage_impl<full_entry, BufLen>>(); break;
+	}
+
 	*rh_ptr = ret.release();
 }
 
@@ -63,20 +449,10 @@ bool
 m_relation_history_push(struct m_relation_history *rh, struct xrt_space_relation const *in_relation, int64_t timestamp)
 {
 	XRT_TRACE_MARKER();
-	struct relation_history_entry rhe;
-	rhe.relation = *in_relation;
-	rhe.timestamp = timestamp;
 	bool ret = false;
-	std::unique_lock<os::Mutex> lock(rh->mutex);
 	try {
-		// if we aren't empty, we can compare against the latest timestamp.
-		if (rh->impl.empty() || rhe.timestamp > rh->impl.back().timestamp) {
-			// Everything explodes if the timestamps in relation_history aren't monotonically increasing. If
-			// we get a timestamp that's before the most recent timestamp in the buffer, don't put it
-			// in the history.
-			rh->impl.push_back(rhe);
-			ret = true;
-		}
+		// If we get a timestamp that's before the most recent one, it's not put in the history.
+		write_locked(rh, [&] { ret = rh->impl->push(*in_relation, timestamp); });
 	} catch (std::exception const &e) {
 		U_LOG_E("Caught exception: %s", e.what());
 	}
@@ -89,98 +465,81 @@ m_relation_history_get(const struct m_relation_history *rh,
                        struct xrt_space_relation *out_relation)
 {
 	XRT_TRACE_MARKER();
-	std::unique_lock<os::Mutex> lock(rh->mutex);
-	try {
-		if (rh->impl.empty() || at_timestamp_ns == 0) {
-			// Do nothing. You push nothing to the buffer you get nothing from the buffer.
-			*out_relation = {};
-			return M_RELATION_HISTORY_RESULT_INVALID;
-		}
-		const auto b = rh->impl.begin();
-		const auto e = rh->impl.end();
 
-		// Find the first element *not less than* our value. the lambda we pass is the comparison
-		// function, to compare against timestamps.
-		const auto it =
-		    std::lower_bound(b, e, at_timestamp_ns, [](const relation_history_entry &rhe, int64_t timestamp) {
-			    return rhe.timestamp < timestamp;
-		    });
+	struct relation_history_entry predecessor = {};
+	struct relation_history_entry successor = {};
 
-		if (it == e) {
-			// lower bound is at the end:
-			// The desired timestamp is after what our buffer contains.
-			// (pose-prediction)
-			// Output flags match the most recent buffer entry.
-			int64_t diff_prediction_ns = static_cast<int64_t>(at_timestamp_ns) - rh->impl.back().timestamp;
-			double delta_s = time_ns_to_s(diff_prediction_ns);
+	enum m_relation_history_result res = read_consistent(
+	    rh, [&] { return rh->impl->lookup(at_timestamp_ns, &predecessor, &successor); });
 
-			U_LOG_T("Extrapolating %f s past the back of the buffer!", delta_s);
+	// The math is done outside of the lock, on our own copies.
+	switch (res) {
+	case M_RELATION_HISTORY_RESULT_INVALID: {
+		*out_relation = {};
+		return res;
+	}
+	case M_RELATION_HISTORY_RESULT_PREDICTED: {
+		// Output flags match the most recent buffer entry.
+		int64_t diff_prediction_ns = static_cast<int64_t>(at_timestamp_ns) - predecessor.timestamp;
+		double delta_s = time_ns_to_s(diff_prediction_ns);
 
-			m_predict_relation(&rh->impl.back().relation, delta_s, out_relation);
-			return M_RELATION_HISTORY_RESULT_PREDICTED;
-		}
-		if (at_timestamp_ns == it->timestamp) {
-			// exact match:
-			// Flags copied directly along with everything else.
-			U_LOG_T("Exact match in the buffer!");
-			*out_relation = it->relation;
-			return M_RELATION_HISTORY_RESULT_EXACT;
-		}
-		if (it == b) {
-			// lower bound is at the beginning (and it's not an exact match):
-			// The desired timestamp is before what our buffer contains.
-			// (an edge case where somebody asks for a really old pose and we do our best)
-			// Output flags are the same as the input flags for the history entry we use
-			int64_t diff_prediction_ns = static_cast<int64_t>(at_timestamp_ns) - rh->impl.front().timestamp;
-			double delta_s = time_ns_to_s(diff_prediction_ns);
-			U_LOG_T("Extrapolating %f s before the front of the buffer!", delta_s);
-			m_predict_relation(&rh->impl.front().relation, delta_s, out_relation);
-			return M_RELATION_HISTORY_RESULT_REVERSE_PREDICTED;
-		}
-		U_LOG_T("Interpolating within buffer!");
-
-		// We precede *it and follow *(it - 1) (which we know exists because we already handled
-		// the it = begin() case)
-		const auto &predecessor = *(it - 1);
-		const auto &successor = *it;
-
-		// Do the thing.
-		int64_t diff_before = static_cast<int64_t>(at_timestamp_ns) - predecessor.timestamp;
-		int64_t diff_after = static_cast<int64_t>(successor.timestamp) - at_timestamp_ns;
-
-		float amount_to_lerp = (float)diff_before / (float)(diff_before + diff_after);
-
-		// Copy intersection of relation flags
-		xrt_space_relation result{};
-		result.relation_flags = (enum xrt_space_relation_flags)(predecessor.relation.relation_flags &
-		                                                        successor.relation.relation_flags);
-		// First-order implementation - lerp between the before and after
-		if (0 != (result.relation_flags & XRT_SPACE_RELATION_POSITION_VALID_BIT)) {
-			result.pose.position = m_vec3_lerp(predecessor.relation.pose.position,
-			                                   successor.relation.pose.position, amount_to_lerp);
-		}
-		if (0 != (result.relation_flags & XRT_SPACE_RELATION_ORIENTATION_VALID_BIT)) {
+		U_LOG_T("Extrapolating %f s past the back of the buffer!", delta_s);
 
-			math_quat_slerp(&predecessor.relation.pose.orientation, &successor.relation.pose.orientation,
-			                amount_to_lerp, &result.pose.orientation);
-		}
+		m_predict_relation(&predecessor.relation, delta_s, out_relation);
+		return res;
+	}
+	case M_RELATION_HISTORY_RESULT_EXACT: {
+		// Flags copied directly along with everything else.
+		U_LOG_T("Exact match in the buffer!");
+		*out_relation = predecessor.relation;
+		return res;
+	}
+	case M_RELATION_HISTORY_RESULT_REVERSE_PREDICTED: {
+		// (an edge case where somebody asks for a really old pose and we do our best)
+		// Output flags are the same as the input flags for the history entry we use
+		int64_t diff_prediction_ns = static_cast<int64_t>(at_timestamp_ns) - predecessor.timestamp;
+		double delta_s = time_ns_to_s(diff_prediction_ns);
+		U_LOG_T("Extrapolating %f s before the front of the buffer!", delta_s);
+		m_predict_relation(&predecessor.relation, delta_s, out_relation);
+		return res;
+	}
+	case M_RELATION_HISTORY_RESULT_INTERPOLATED: break;
+	}
 
-		//! @todo Does interpolating the velocities make any sense?
-		if (0 != (result.relation_flags & XRT_SPACE_RELATION_ANGULAR_VELOCITY_VALID_BIT)) {
-			result.angular_velocity = m_vec3_lerp(predecessor.relation.angular_velocity,
-			                                      successor.relation.angular_velocity, amount_to_lerp);
-		}
-		if (0 != (result.relation_flags & XRT_SPACE_RELATION_LINEAR_VELOCITY_VALID_BIT)) {
-			result.linear_velocity = m_vec3_lerp(predecessor.relation.linear_velocity,
-			                                     successor.relation.linear_velocity, amount_to_lerp);
-		}
-		*out_relation = result;
-		return M_RELATION_HISTORY_RESULT_INTERPOLATED;
+	U_LOG_T("Interpolating within buffer!");
 
-	} catch (std::exception const &e) {
-		U_LOG_E("Caught exception: %s", e.what());
-		return M_RELATION_HISTORY_RESULT_INVALID;
+	// Do the thing.
+	int64_t diff_before = static_cast<int64_t>(at_timestamp_ns) - predecessor.timestamp;
+	int64_t diff_after = static_cast<int64_t>(successor.timestamp) - at_timestamp_ns;
+
+	float amount_to_lerp = (float)diff_before / (float)(diff_before + diff_after);
+
+	// Copy intersection of relation flags
+	xrt_space_relation result{};
+	result.relation_flags =
+	    (enum xrt_space_relation_flags)(predecessor.relation.relation_flags & successor.relation.relation_flags);
+	// First-order implementation - lerp between the before and after
+	if (0 != (result.relation_flags & XRT_SPACE_RELATION_POSITION_VALID_BIT)) {
+		result.pose.position =
+		    m_vec3_lerp(predecessor.relation.pose.position, successor.relation.pose.position, amount_to_lerp);
 	}
+	if (0 != (result.relation_flags & XRT_SPACE_RELATION_ORIENTATION_VALID_BIT)) {
+
+		math_quat_slerp(&predecessor.relation.pose.orientation, &successor.relation.pose.orientation,
+		                amount_to_lerp, &result.pose.orientation);
+	}
+
+	//! @todo Does interpolating the velocities make any sense?
+	if (0 != (result.relation_flags & XRT_SPACE_RELATION_ANGULAR_VELOCITY_VALID_BIT)) {
+		result.angular_velocity = m_vec3_lerp(predecessor.relation.angular_velocity,
+		                                      successor.relation.angular_velocity, amount_to_lerp);
+	}
+	if (0 != (result.relation_flags & XRT_SPACE_RELATION_LINEAR_VELOCITY_VALID_BIT)) {
+		result.linear_velocity = m_vec3_lerp(predecessor.relation.linear_velocity,
+		                                     successor.relation.linear_velocity, amount_to_lerp);
+	}
+	*out_relation = result;
+	return M_RELATION_HISTORY_RESULT_INTERPOLATED;
 }
 
 bool
@@ -235,27 +594,29 @@ m_relation_history_get_latest(const struct m_relation_history *rh,
                               int64_t *out_time_ns,
                               struct xrt_space_relation *out_relation)
 {
-	std::unique_lock<os::Mutex> lock(rh->mutex);
-	if (rh->impl.empty()) {
+	struct relation_history_entry latest = {};
+
+	bool ret = read_consistent(rh, [&] { return rh->impl->latest(&latest); });
+
+	if (!ret) {
 		return false;
 	}
-	*out_relation = rh->impl.back().relation;
-	*out_time_ns = rh->impl.back().timestamp;
+
+	*out_relation = latest.relation;
+	*out_time_ns = latest.timestamp;
 	return true;
 }
 
 uint32_t
 m_relation_history_get_size(const struct m_relation_history *rh)
 {
-	std::unique_lock<os::Mutex> lock(rh->mutex);
-	return (uint32_t)rh->impl.size();
+	return read_consistent(rh, [&] { return (uint32_t)rh->impl->size(); });
 }
 
 void
 m_relation_history_clear(struct m_relation_history *rh)
 {
-	std::unique_lock<os::Mutex> lock(rh->mutex);
-	rh->impl.clear();
+	write_locked(rh, [&] { rh->impl->clear(); });
 }
 
 void
@@ -1,4 +1,4 @@
-// Copyright 2021, Collabora, Ltd.
+// Copyright 2021-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -22,7 +22,7 @@ extern "C" {
  *
  * @note Unlike the bare C++ data structure @ref HistoryBuffer this wraps, **this is a thread safe interface**,
  * and is safe for concurrent access from multiple threads.
- * (It is using a simple mutex, not a reader/writer lock, but that is fine until proven to be a bottleneck.)
+ * By default it is using a simple mutex, see @ref m_relation_history_mode for a mode where readers never lock.
  *
  * @ingroup aux_util
  */
@@ -43,13 +43,74 @@ enum m_relation_history_result
 };
 
 /*!
- * Creates an opaque relation_history object.
+ * @brief Selects how concurrent access to the history is synchronized.
+ *
+ * @relates m_relation_history
+ */
+enum m_relation_history_mode
+{
+	//! Every operation takes the same mutex, the default.
+	M_RELATION_HISTORY_MODE_MUTEX = 0,
+
+	/*!
+	 * Writers (push and clear) are serialized with a mutex and publish through a sequence counter, readers
+	 * never take a lock and instead retry if a write happened while they were reading. Suited for the common
+	 * case of one tracking thread pushing and many threads (compositor, IPC, OpenXR) reading.
+	 */
+	M_RELATION_HISTORY_MODE_SEQLOCK,
+};
+
+/*!
+ * @brief Selects how entries are stored, smaller layouts make lookups touch less memory.
+ *
+ * All layouts keep the timestamps in their own array and have room for the same number of entries.
+ *
+ * @relates m_relation_history
+ */
+enum m_relation_history_layout
+{
+	//! The full @ref xrt_space_relation, the default.
+	M_RELATION_HISTORY_LAYOUT_FULL = 0,
+
+	/*!
+	 * Full pose, velocities are quantized to 16 bits per component, in the range of +-64 rad/s for angular and
+	 * +-32 m/s for linear velocity, values outside of it are clamped.
+	 */
+	M_RELATION_HISTORY_LAYOUT_COMPACT,
+
+	/*!
+	 * Only orientation and angular velocity, quantized as in @ref M_RELATION_HISTORY_LAYOUT_COMPACT, for 3DoF
+	 * devices. Position and linear velocity always read back as zero and their flags are dropped.
+	 */
+	M_RELATION_HISTORY_LAYOUT_ORIENTATION,
+};
+
+/*!
+ * Creates an opaque relation_history object, using @ref M_RELATION_HISTORY_MODE_MUTEX.
  *
  * @public @memberof m_relation_history
  */
 void
 m_relation_history_create(struct m_relation_history **rh);
 
+/*!
+ * Creates an opaque relation_history object with the given synchronization mode.
+ *
+ * @public @memberof m_relation_history
+ */
+void
+m_relation_history_create_with_mode(struct m_relation_history **rh, enum m_relation_history_mode mode);
+
+/*!
+ * Creates an opaque relation_history object with the given synchronization mode and entry layout.
+ *
+ * @public @memberof m_relation_history
+ */
+void
+m_relation_history_create_with_layout(struct m_relation_history **rh,
+                                      enum m_relation_history_mode mode,
+                                      enum m_relation_history_layout layout);
+
 /*!
  * Pushes a new pose to the history.
  *
@@ -158,11 +219,28 @@ private:
 
 
 public:
+	/*!
+	 * @copydoc m_relation_history_mode
+	 */
+	typedef m_relation_history_mode Mode;
+
+	/*!
+	 * @copydoc m_relation_history_layout
+	 */
+	typedef m_relation_history_layout Layout;
+
+
 	// clang-format off
 	RelationHistory() noexcept { m_relation_history_create(&mPtr); }
+	explicit RelationHistory(Mode mode) noexcept { m_relation_history_create_with_mode(&mPtr, mode); }
 	~RelationHistory() { m_relation_history_destroy(&mPtr); }
 	// clang-format on
 
+	RelationHistory(Mode mode, Layout layout) noexcept
+	{
+		m_relation_history_create_with_layout(&mPtr, mode, layout);
+	}
+
 	// Special non-copyable reference.
 	RelationHistory(RelationHistory const &) = delete;
 	RelationHistory(RelationHistory &&) = delete;
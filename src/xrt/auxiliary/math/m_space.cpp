@@ -17,6 +17,8 @@
 #include <stdio.h>
 #include <assert.h>
 
+#include <algorithm>
+
 
 /*
  *
@@ -125,32 +127,9 @@ make_valid_pose(flags flags, const struct xrt_pose *in_pose, struct xrt_pose *ou
 	}
 }
 
-static void
-apply_relation(const struct xrt_space_relation *a,
-               const struct xrt_space_relation *b,
-               struct xrt_space_relation *out_relation)
+static flags
+combine_flags(flags af, flags bf)
 {
-	flags af = get_flags(a);
-	flags bf = get_flags(b);
-
-	struct xrt_pose pose = XRT_POSE_IDENTITY;
-	struct xrt_vec3 linear_velocity = XRT_VEC3_ZERO;
-	struct xrt_vec3 angular_velocity = XRT_VEC3_ZERO;
-
-
-	/*
-	 * Pose.
-	 */
-
-	struct xrt_pose body_pose = XRT_POSE_IDENTITY; // aka valid_a_pose
-	struct xrt_pose base_pose = XRT_POSE_IDENTITY; // aka valid_b_pose
-
-	// If either orientation or position component is not valid, make that component identity so that transforms
-	// work. The flags of the result are determined in nf and not taken from the result of the transform.
-	make_valid_pose(af, &a->pose, &body_pose);
-	make_valid_pose(bf, &b->pose, &base_pose);
-
-
 	// This is a band aid to make 3dof devices work until we have a real solution.
 	// A 3dof device may return a relation with only orientation valid/tracked and no position.
 	//
@@ -169,7 +148,6 @@ apply_relation(const struct xrt_space_relation *a,
 		bf.has_position = true;
 	}
 
-
 	// If either of the relations does not have a valid or tracked flag, the entire chain loses that flag.
 	flags nf = {};
 	nf.has_orientation = af.has_orientation && bf.has_orientation;
@@ -179,6 +157,63 @@ apply_relation(const struct xrt_space_relation *a,
 	nf.has_linear_velocity = af.has_linear_velocity && bf.has_linear_velocity;
 	nf.has_angular_velocity = af.has_angular_velocity && bf.has_angular_velocity;
 
+	return nf;
+}
+
+static enum xrt_space_relation_flags
+flags_to_bits(flags nf)
+{
+	int new_flags = 0;
+
+	if (nf.has_orientation) {
+		new_flags |= XRT_SPACE_RELATION_ORIENTATION_VALID_BIT;
+	}
+	if (nf.has_position) {
+		new_flags |= XRT_SPACE_RELATION_POSITION_VALID_BIT;
+	}
+	if (nf.has_tracked_position) {
+		new_flags |= XRT_SPACE_RELATION_POSITION_TRACKED_BIT;
+	}
+	if (nf.has_tracked_orientation) {
+		new_flags |= XRT_SPACE_RELATION_ORIENTATION_TRACKED_BIT;
+	}
+	if (nf.has_linear_velocity) {
+		new_flags |= XRT_SPACE_RELATION_LINEAR_VELOCITY_VALID_BIT;
+	}
+	if (nf.has_angular_velocity) {
+		new_flags |= XRT_SPACE_RELATION_ANGULAR_VELOCITY_VALID_BIT;
+	}
+
+	return (enum xrt_space_relation_flags)new_flags;
+}
+
+static void
+apply_relation(const struct xrt_space_relation *a,
+               const struct xrt_space_relation *b,
+               struct xrt_space_relation *out_relation)
+{
+	flags af = get_flags(a);
+	flags bf = get_flags(b);
+
+	struct xrt_pose pose = XRT_POSE_IDENTITY;
+	struct xrt_vec3 linear_velocity = XRT_VEC3_ZERO;
+	struct xrt_vec3 angular_velocity = XRT_VEC3_ZERO;
+
+
+	/*
+	 * Pose.
+	 */
+
+	struct xrt_pose body_pose = XRT_POSE_IDENTITY; // aka valid_a_pose
+	struct xrt_pose base_pose = XRT_POSE_IDENTITY; // aka valid_b_pose
+
+	// If either orientation or position component is not valid, make that component identity so that transforms
+	// work. The flags of the result are determined in nf and not taken from the result of the transform.
+	make_valid_pose(af, &a->pose, &body_pose);
+	make_valid_pose(bf, &b->pose, &base_pose);
+
+	flags nf = combine_flags(af, bf);
+
 
 	// Not already valid poses needed to be made valid because the transoformed pose would be undefined otherwise
 	// and we still want e.g. valid positions.
@@ -238,38 +273,12 @@ apply_relation(const struct xrt_space_relation *a,
 	}
 
 
-	/*
-	 * Flags.
-	 */
-
-	int new_flags = 0;
-
-	if (nf.has_orientation) {
-		new_flags |= XRT_SPACE_RELATION_ORIENTATION_VALID_BIT;
-	}
-	if (nf.has_position) {
-		new_flags |= XRT_SPACE_RELATION_POSITION_VALID_BIT;
-	}
-	if (nf.has_tracked_position) {
-		new_flags |= XRT_SPACE_RELATION_POSITION_TRACKED_BIT;
-	}
-	if (nf.has_tracked_orientation) {
-		new_flags |= XRT_SPACE_RELATION_ORIENTATION_TRACKED_BIT;
-	}
-	if (nf.has_linear_velocity) {
-		new_flags |= XRT_SPACE_RELATION_LINEAR_VELOCITY_VALID_BIT;
-	}
-	if (nf.has_angular_velocity) {
-		new_flags |= XRT_SPACE_RELATION_ANGULAR_VELOCITY_VALID_BIT;
-	}
-
-
 	/*
 	 * Write everything out.
 	 */
 
 	struct xrt_space_relation tmp = {};
-	tmp.relation_flags = (enum xrt_space_relation_flags)new_flags;
+	tmp.relation_flags = flags_to_bits(nf);
 	tmp.pose = pose;
 	tmp.linear_velocity = linear_velocity;
 	tmp.angular_velocity = angular_velocity;
@@ -311,6 +320,105 @@ m_relation_chain_resolve(const struct xrt_relation_chain *xrc, struct xrt_space_
 	*out_relation = r;
 }
 
+extern "C" void
+m_space_relation_apply_array(const struct xrt_space_relation *base,
+                             const struct xrt_space_relation *relations,
+                             struct xrt_space_relation *out_relations,
+                             uint32_t count)
+{
+	assert(base != NULL);
+	assert(count == 0 || (relations != NULL && out_relations != NULL));
+
+	const enum xrt_space_relation_flags pose_flags = (enum xrt_space_relation_flags)(
+	    XRT_SPACE_RELATION_POSITION_VALID_BIT | XRT_SPACE_RELATION_ORIENTATION_VALID_BIT);
+
+	if ((base->relation_flags & pose_flags) == 0) {
+		for (uint32_t i = 0; i < count; i++) {
+			out_relations[i] = XRT_SPACE_RELATION_ZERO;
+		}
+		return;
+	}
+
+	// Everything that only depends on the base is done once.
+	flags bf = get_flags(base);
+	struct xrt_pose base_pose = XRT_POSE_IDENTITY;
+	make_valid_pose(bf, &base->pose, &base_pose);
+
+	// Done in chunks so the scratch space lives on the stack.
+	enum
+	{
+		CHUNK = 32
+	};
+	struct xrt_pose body_poses[CHUNK];
+	struct xrt_pose poses[CHUNK];
+	struct xrt_vec3 linear_velocities[CHUNK];
+	struct xrt_vec3 angular_velocities[CHUNK];
+	struct xrt_vec3 rotated_positions[CHUNK];
+
+	for (uint32_t start = 0; start < count; start += CHUNK) {
+		const struct xrt_space_relation *in = &relations[start];
+		struct xrt_space_relation *out = &out_relations[start];
+		uint32_t n = std::min(count - start, (uint32_t)CHUNK);
+
+		for (uint32_t i = 0; i < n; i++) {
+			make_valid_pose(get_flags(&in[i]), &in[i].pose, &body_poses[i]);
+			linear_velocities[i] = in[i].linear_velocity;
+			angular_velocities[i] = in[i].angular_velocity;
+		}
+
+		math_pose_transform_array(&base_pose, body_poses, poses, n);
+
+		if (bf.has_linear_velocity) {
+			math_quat_rotate_vec3_array(&base_pose.orientation, linear_velocities, linear_velocities, n);
+		}
+
+		if (bf.has_angular_velocity) {
+			math_quat_rotate_vec3_array(&base_pose.orientation, angular_velocities, angular_velocities, n);
+
+			for (uint32_t i = 0; i < n; i++) {
+				rotated_positions[i] = body_poses[i].position;
+			}
+			math_quat_rotate_vec3_array(&base_pose.orientation, rotated_positions, rotated_positions, n);
+		}
+
+		for (uint32_t i = 0; i < n; i++) {
+			if ((in[i].relation_flags & pose_flags) == 0) {
+				out[i] = XRT_SPACE_RELATION_ZERO;
+				continue;
+			}
+
+			flags nf = combine_flags(get_flags(&in[i]), bf);
+
+			struct xrt_vec3 linear_velocity = XRT_VEC3_ZERO;
+			struct xrt_vec3 angular_velocity = XRT_VEC3_ZERO;
+
+			if (nf.has_linear_velocity) {
+				linear_velocity = linear_velocities[i] + base->linear_velocity;
+			}
+
+			if (nf.has_angular_velocity) {
+				angular_velocity = angular_velocities[i] + base->angular_velocity;
+
+				// Lever arm, see apply_relation.
+				struct xrt_vec3 tangental_velocity = XRT_VEC3_ZERO;
+				math_vec3_cross(&base->angular_velocity, &rotated_positions[i], &tangental_velocity);
+				linear_velocity += tangental_velocity;
+			}
+
+			struct xrt_space_relation tmp = {};
+			tmp.relation_flags = flags_to_bits(nf);
+			tmp.pose = poses[i];
+			tmp.linear_velocity = linear_velocity;
+			tmp.angular_velocity = angular_velocity;
+
+			// Ensure no errors have crept in.
+			math_quat_normalize(&tmp.pose.orientation);
+
+			out[i] = tmp;
+		}
+	}
+}
+
 extern "C" void
 m_space_relation_invert(struct xrt_space_relation *relation, struct xrt_space_relation *out_relation)
 {
@@ -86,6 +86,19 @@ m_space_relation_ident(struct xrt_space_relation *out_relation)
 	m_space_relation_from_pose(&identity, false, out_relation);
 }
 
+/*!
+ * Apply the same @p base relation to @p count relations, gives the same
+ * result as resolving a two step chain of `relations[i]` and @p base for each
+ * element but does the work that only depends on @p base once.
+ *
+ * OK if @p relations and @p out_relations are the same addresses.
+ */
+void
+m_space_relation_apply_array(const struct xrt_space_relation *base,
+                             const struct xrt_space_relation *relations,
+                             struct xrt_space_relation *out_relations,
+                             uint32_t count);
+
 void
 m_space_relation_invert(struct xrt_space_relation *relation, struct xrt_space_relation *out_relation);
 
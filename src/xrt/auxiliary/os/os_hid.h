@@ -38,6 +38,7 @@ struct os_hid_device
 	int (*set_feature)(struct os_hid_device *hid_dev, const uint8_t *data, size_t size);
 
 	int (*get_physical_address)(struct os_hid_device *hid_dev, uint8_t *data, size_t size);
+	int (*get_pollable_fd)(struct os_hid_device *hid_dev);
 
 	void (*destroy)(struct os_hid_device *hid_dev);
 };
@@ -120,6 +121,21 @@ os_hid_get_physical_address(struct os_hid_device *hid_dev, uint8_t *data, size_t
 	return hid_dev->get_physical_address(hid_dev, data, size);
 }
 
+/*!
+ * Get a file descriptor that becomes readable when an input report is
+ * available, used by @ref os_hid_reactor. Returns -1 if not supported.
+ *
+ * @public @memberof os_hid_device
+ */
+static inline int
+os_hid_get_pollable_fd(struct os_hid_device *hid_dev)
+{
+	if (hid_dev->get_pollable_fd == NULL) {
+		return -1;
+	}
+	return hid_dev->get_pollable_fd(hid_dev);
+}
+
 /*!
  * Close and free the given device.
  *
@@ -126,6 +126,14 @@ os_hidraw_set_feature(struct os_hid_device *ohdev, const uint8_t *data, size_t l
 	return ioctl(hrdev->fd, HIDIOCSFEATURE(length), data);
 }
 
+static int
+os_hidraw_get_pollable_fd(struct os_hid_device *ohdev)
+{
+	struct hid_hidraw *hrdev = (struct hid_hidraw *)ohdev;
+
+	return hrdev->fd;
+}
+
 static void
 os_hidraw_destroy(struct os_hid_device *ohdev)
 {
@@ -146,6 +154,7 @@ os_hid_open_hidraw(const char *path, struct os_hid_device **out_hid)
 	hrdev->base.get_feature_timeout = os_hidraw_get_feature_timeout;
 	hrdev->base.set_feature = os_hidraw_set_feature;
 	hrdev->base.get_physical_address = os_hidraw_get_physical_address;
+	hrdev->base.get_pollable_fd = os_hidraw_get_pollable_fd;
 	hrdev->base.destroy = os_hidraw_destroy;
 	hrdev->fd = open(path, O_RDWR);
 	if (hrdev->fd < 0) {
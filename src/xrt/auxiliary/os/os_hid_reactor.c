@@ -0,0 +1,388 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Shared thread that reads input reports from many hid devices.
+ * @ingroup aux_os
+ */
+
+#include "os_hid_reactor.h"
+
+#ifdef XRT_OS_LINUX
+
+#include "os/os_time.h"
+#include "os/os_threading.h"
+
+#include "util/u_misc.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+
+//! How many events we handle per wake up.
+#define MAX_EVENTS 32
+
+/*!
+ * A device added to the reactor.
+ */
+struct os_hid_reactor_source
+{
+	struct os_hid_reactor *r;
+
+	struct os_hid_device *hid_dev;
+	int fd;
+
+	//! Flags of the fd before we made it non-blocking, restored on remove.
+	int old_flags;
+
+	os_hid_reactor_report_func_t report_func;
+	os_hid_reactor_error_func_t error_func;
+	void *ptr;
+
+	//! Removed but the thread might still have a pending event for it.
+	bool removed;
+
+	//! Got an error, no longer in the epoll set.
+	bool failed;
+
+	//! Next on the list of removed sources to be freed by the thread.
+	struct os_hid_reactor_source *next_removed;
+
+	size_t buffer_size;
+	uint8_t buffer[];
+};
+
+/*!
+ * The reactor, there is only one per process.
+ */
+struct os_hid_reactor
+{
+	int epoll_fd;
+
+	//! Used to wake up the thread when stopping.
+	int wake_fd;
+
+	struct os_thread thread;
+
+	//! Held while dispatching and while adding or removing sources.
+	struct os_mutex lock;
+
+	//! Protected by lock.
+	bool running;
+
+	//! Protected by lock, freed by the thread after dispatching.
+	struct os_hid_reactor_source *removed;
+
+	//! Protected by global_lock.
+	uint32_t source_count;
+};
+
+//! Protects creating and destroying @ref global_reactor.
+static pthread_mutex_t global_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static struct os_hid_reactor *global_reactor = NULL;
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+static void
+free_removed_locked(struct os_hid_reactor *r)
+{
+	while (r->removed != NULL) {
+		struct os_hid_reactor_source *src = r->removed;
+		r->removed = src->next_removed;
+		free(src);
+	}
+}
+
+static void
+handle_readable_locked(struct os_hid_reactor_source *src)
+{
+	// Read everything that is available, one report per read.
+	while (true) {
+		ssize_t ret = read(src->fd, src->buffer, src->buffer_size);
+		if (ret > 0) {
+			src->report_func(src->ptr, src->buffer, (size_t)ret, os_monotonic_get_ns());
+			continue;
+		}
+
+		if (ret < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			return;
+		}
+
+		// Zero means the device is gone.
+		int error = ret == 0 ? -ENODEV : -errno;
+
+		epoll_ctl(src->r->epoll_fd, EPOLL_CTL_DEL, src->fd, NULL);
+		src->failed = true;
+
+		if (src->error_func != NULL) {
+			src->error_func(src->ptr, error);
+		}
+		return;
+	}
+}
+
+static void *
+reactor_run(void *ptr)
+{
+	struct os_hid_reactor *r = (struct os_hid_reactor *)ptr;
+	struct epoll_event events[MAX_EVENTS];
+
+	while (true) {
+		int count = epoll_wait(r->epoll_fd, events, MAX_EVENTS, -1);
+		if (count < 0 && errno != EINTR) {
+			break;
+		}
+
+		os_mutex_lock(&r->lock);
+
+		if (!r->running) {
+			os_mutex_unlock(&r->lock);
+			break;
+		}
+
+		for (int i = 0; i < count; i++) {
+			struct os_hid_reactor_source *src = (struct os_hid_reactor_source *)events[i].data.ptr;
+
+			if (src == NULL) {
+				uint64_t value;
+				XRT_MAYBE_UNUSED ssize_t ret = read(r->wake_fd, &value, sizeof(value));
+				continue;
+			}
+
+			// The event might have been returned before the source was removed.
+			if (src->removed || src->failed) {
+				continue;
+			}
+
+			if ((events[i].events & EPOLLIN) != 0) {
+				handle_readable_locked(src);
+			} else if ((events[i].events & (EPOLLERR | EPOLLHUP)) != 0) {
+				epoll_ctl(r->epoll_fd, EPOLL_CTL_DEL, src->fd, NULL);
+				src->failed = true;
+
+				if (src->error_func != NULL) {
+					src->error_func(src->ptr, -ENODEV);
+				}
+			}
+		}
+
+		// No pending events can reference these anymore.
+		free_removed_locked(r);
+
+		os_mutex_unlock(&r->lock);
+	}
+
+	return NULL;
+}
+
+static void
+reactor_destroy(struct os_hid_reactor *r)
+{
+	os_mutex_lock(&r->lock);
+	r->running = false;
+	os_mutex_unlock(&r->lock);
+
+	uint64_t value = 1;
+	XRT_MAYBE_UNUSED ssize_t ret = write(r->wake_fd, &value, sizeof(value));
+
+	os_thread_join(&r->thread);
+	os_thread_destroy(&r->thread);
+
+	free_removed_locked(r);
+
+	os_mutex_destroy(&r->lock);
+	close(r->wake_fd);
+	close(r->epoll_fd);
+	free(r);
+}
+
+static int
+reactor_create(struct os_hid_reactor **out_r)
+{
+	struct os_hid_reactor *r = U_TYPED_CALLOC(struct os_hid_reactor);
+	if (r == NULL) {
+		return -ENOMEM;
+	}
+
+	r->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (r->epoll_fd < 0) {
+		int error = -errno;
+		free(r);
+		return error;
+	}
+
+	r->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (r->wake_fd < 0) {
+		int error = -errno;
+		close(r->epoll_fd);
+		free(r);
+		return error;
+	}
+
+	struct epoll_event ev = {.events = EPOLLIN, .data.ptr = NULL};
+	if (epoll_ctl(r->epoll_fd, EPOLL_CTL_ADD, r->wake_fd, &ev) < 0) {
+		int error = -errno;
+		close(r->wake_fd);
+		close(r->epoll_fd);
+		free(r);
+		return error;
+	}
+
+	os_mutex_init(&r->lock);
+	os_thread_init(&r->thread);
+	r->running = true;
+
+	int ret = os_thread_start(&r->thread, reactor_run, r);
+	if (ret != 0) {
+		os_thread_destroy(&r->thread);
+		os_mutex_destroy(&r->lock);
+		close(r->wake_fd);
+		close(r->epoll_fd);
+		free(r);
+		return -ret;
+	}
+
+	os_thread_name(&r->thread, "HID Reactor");
+
+	*out_r = r;
+
+	return 0;
+}
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+int
+os_hid_reactor_add(struct os_hid_device *hid_dev,
+                   size_t max_report_size,
+                   os_hid_reactor_report_func_t report_func,
+                   os_hid_reactor_error_func_t error_func,
+                   void *ptr,
+                   struct os_hid_reactor_source **out_source)
+{
+	int fd = os_hid_get_pollable_fd(hid_dev);
+	if (fd < 0 || max_report_size == 0 || report_func == NULL) {
+		return -EINVAL;
+	}
+
+	int old_flags = fcntl(fd, F_GETFL);
+	if (old_flags < 0) {
+		return -errno;
+	}
+
+	struct os_hid_reactor_source *src = calloc(1, sizeof(*src) + max_report_size);
+	if (src == NULL) {
+		return -ENOMEM;
+	}
+
+	src->hid_dev = hid_dev;
+	src->fd = fd;
+	src->old_flags = old_flags;
+	src->report_func = report_func;
+	src->error_func = error_func;
+	src->ptr = ptr;
+	src->buffer_size = max_report_size;
+
+	pthread_mutex_lock(&global_lock);
+
+	if (global_reactor == NULL) {
+		int ret = reactor_create(&global_reactor);
+		if (ret != 0) {
+			pthread_mutex_unlock(&global_lock);
+			free(src);
+			return ret;
+		}
+	}
+
+	struct os_hid_reactor *r = global_reactor;
+	src->r = r;
+
+	// So we can drain all pending reports without blocking.
+	fcntl(fd, F_SETFL, old_flags | O_NONBLOCK);
+
+	struct epoll_event ev = {.events = EPOLLIN, .data.ptr = src};
+
+	os_mutex_lock(&r->lock);
+	int ret = epoll_ctl(r->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+	int error = ret < 0 ? -errno : 0;
+	os_mutex_unlock(&r->lock);
+
+	if (error != 0) {
+		fcntl(fd, F_SETFL, old_flags);
+		free(src);
+
+		if (r->source_count == 0) {
+			reactor_destroy(r);
+			global_reactor = NULL;
+		}
+
+		pthread_mutex_unlock(&global_lock);
+		return error;
+	}
+
+	r->source_count++;
+
+	pthread_mutex_unlock(&global_lock);
+
+	*out_source = src;
+
+	return 0;
+}
+
+void
+os_hid_reactor_remove(struct os_hid_reactor_source **source_ptr)
+{
+	struct os_hid_reactor_source *src = *source_ptr;
+	if (src == NULL) {
+		return;
+	}
+
+	pthread_mutex_lock(&global_lock);
+
+	struct os_hid_reactor *r = src->r;
+
+	// Waits for any callback to finish.
+	os_mutex_lock(&r->lock);
+
+	if (!src->failed) {
+		epoll_ctl(r->epoll_fd, EPOLL_CTL_DEL, src->fd, NULL);
+	}
+	fcntl(src->fd, F_SETFL, src->old_flags);
+
+	src->removed = true;
+	src->next_removed = r->removed;
+	r->removed = src;
+
+	os_mutex_unlock(&r->lock);
+
+	if (--r->source_count == 0) {
+		reactor_destroy(r);
+		global_reactor = NULL;
+	}
+
+	pthread_mutex_unlock(&global_lock);
+
+	*source_ptr = NULL;
+}
+
+#endif
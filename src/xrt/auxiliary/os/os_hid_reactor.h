@@ -0,0 +1,100 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Shared thread that reads input reports from many hid devices.
+ * @ingroup aux_os
+ */
+
+#pragma once
+
+#include "xrt/xrt_config_os.h"
+
+#include "os/os_hid.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*!
+ * Called on the reactor thread for every input report read from a device.
+ *
+ * @param ptr          User pointer given to @ref os_hid_reactor_add.
+ * @param data         The report, only valid during the call.
+ * @param size         Size of the report in bytes.
+ * @param timestamp_ns Monotonic time when the report was read.
+ *
+ * @ingroup aux_os
+ */
+typedef void (*os_hid_reactor_report_func_t)(void *ptr, const uint8_t *data, size_t size, int64_t timestamp_ns);
+
+/*!
+ * Called on the reactor thread when a device fails or is disconnected, no
+ * more reports will be delivered for it.
+ *
+ * @ingroup aux_os
+ */
+typedef void (*os_hid_reactor_error_func_t)(void *ptr, int error);
+
+/*!
+ * A device added to the reactor, see @ref os_hid_reactor_add.
+ *
+ * @ingroup aux_os
+ */
+struct os_hid_reactor_source;
+
+#ifdef XRT_OS_LINUX
+
+/*!
+ * Add a hid device to the process wide reactor, its input reports are then
+ * read on a single thread shared by all devices, using epoll so the thread
+ * only wakes up when any device has data. All reports that are available are
+ * read in one go and delivered in order.
+ *
+ * The thread is started when the first device is added and stopped when the
+ * last one is removed. The device must not be read from other threads while
+ * it is added, writing and feature reports are fine.
+ *
+ * The callbacks are called with the reactor lock held, they must not call
+ * @ref os_hid_reactor_add or @ref os_hid_reactor_remove.
+ *
+ * @param hid_dev         The device, must support @ref os_hid_get_pollable_fd.
+ * @param max_report_size Largest report that the device sends.
+ * @param report_func     Called for every input report.
+ * @param error_func      Called on failure or disconnect, may be NULL.
+ * @param ptr             User pointer passed to the callbacks.
+ * @param out_source      Handle used to remove the device.
+ *
+ * @return 0 on success, negative errno value on failure.
+ *
+ * @ingroup aux_os
+ */
+int
+os_hid_reactor_add(struct os_hid_device *hid_dev,
+                   size_t max_report_size,
+                   os_hid_reactor_report_func_t report_func,
+                   os_hid_reactor_error_func_t error_func,
+                   void *ptr,
+                   struct os_hid_reactor_source **out_source);
+
+/*!
+ * Remove a device from the reactor, after this returns the callbacks will
+ * not be called again for it. Sets the pointer to NULL, does nothing if it
+ * already is NULL.
+ *
+ * @ingroup aux_os
+ */
+void
+os_hid_reactor_remove(struct os_hid_reactor_source **source_ptr);
+
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,197 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Per name lock wait and hold statistics.
+ * @ingroup aux_os
+ */
+
+#include "os/os_threading.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+
+/*!
+ * How many different lock names can be tracked, the names are expected to be
+ * static so there are only a handful per module.
+ */
+#define MAX_LOCK_STATS (128)
+
+static struct
+{
+	//! Protects everything but the counters, not a @ref os_mutex so it can't profile itself.
+	pthread_mutex_t mutex;
+
+	struct os_lock_stats stats[MAX_LOCK_STATS];
+	uint32_t count;
+
+	os_lock_stats_added_func_t added_func;
+	void *added_ptr;
+} gLockStats = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+static inline void
+add_u64(uint64_t *p, uint64_t value)
+{
+#if defined(__GNUC__)
+	__atomic_fetch_add(p, value, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+	_InterlockedExchangeAdd64((volatile int64_t *)p, (int64_t)value);
+#else
+#error "compiler not supported"
+#endif
+}
+
+static inline uint64_t
+load_u64(const uint64_t *p)
+{
+#if defined(__GNUC__)
+	return __atomic_load_n(p, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+	return *(const volatile uint64_t *)p;
+#else
+#error "compiler not supported"
+#endif
+}
+
+static inline void
+max_u64(uint64_t *p, uint64_t value)
+{
+	uint64_t old = load_u64(p);
+	while (old < value) {
+#if defined(__GNUC__)
+		if (__atomic_compare_exchange_n(p, &old, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			return;
+		}
+#elif defined(_MSC_VER)
+		volatile int64_t *dst = (volatile int64_t *)p;
+		uint64_t prev = (uint64_t)_InterlockedCompareExchange64(dst, (int64_t)value, (int64_t)old);
+		if (prev == old) {
+			return;
+		}
+		old = prev;
+#else
+#error "compiler not supported"
+#endif
+	}
+}
+
+#ifdef OS_THREAD_TRACE_CONTENTION
+static inline void
+plot_wait(struct os_lock_stats *stats, int64_t wait_ns)
+{
+	// The name lives as long as the process, as Tracy requires.
+	TracyCPlot(stats->name, (double)wait_ns / 1000000.0);
+}
+#endif
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+struct os_lock_stats *
+os_lock_stats_get_or_add(const char *name)
+{
+	struct os_lock_stats *ret = NULL;
+
+	pthread_mutex_lock(&gLockStats.mutex);
+
+	for (uint32_t i = 0; i < gLockStats.count; i++) {
+		if (strncmp(gLockStats.stats[i].name, name, OS_LOCK_STATS_NAME_LEN - 1) == 0) {
+			ret = &gLockStats.stats[i];
+			break;
+		}
+	}
+
+	if (ret == NULL && gLockStats.count < MAX_LOCK_STATS) {
+		ret = &gLockStats.stats[gLockStats.count++];
+		snprintf(ret->name, sizeof(ret->name), "%s", name);
+
+		if (gLockStats.added_func != NULL) {
+			gLockStats.added_func(ret, gLockStats.added_ptr);
+		}
+	}
+
+	pthread_mutex_unlock(&gLockStats.mutex);
+
+	return ret;
+}
+
+void
+os_lock_stats_record_lock(struct os_lock_stats *stats, bool contended, int64_t wait_ns)
+{
+	add_u64(&stats->lock_count, 1);
+
+	if (!contended) {
+		return;
+	}
+
+	add_u64(&stats->contended_count, 1);
+	add_u64(&stats->wait_total_ns, (uint64_t)wait_ns);
+	max_u64(&stats->wait_max_ns, (uint64_t)wait_ns);
+
+#ifdef OS_THREAD_TRACE_CONTENTION
+	plot_wait(stats, wait_ns);
+#endif
+}
+
+void
+os_lock_stats_record_hold(struct os_lock_stats *stats, int64_t hold_ns)
+{
+	add_u64(&stats->hold_total_ns, (uint64_t)hold_ns);
+	max_u64(&stats->hold_max_ns, (uint64_t)hold_ns);
+}
+
+uint32_t
+os_lock_stats_get(uint32_t index, struct os_lock_stats *out_stats)
+{
+	pthread_mutex_lock(&gLockStats.mutex);
+
+	uint32_t count = gLockStats.count;
+	if (index < count) {
+		const struct os_lock_stats *stats = &gLockStats.stats[index];
+
+		memcpy(out_stats->name, stats->name, sizeof(out_stats->name));
+		out_stats->lock_count = load_u64(&stats->lock_count);
+		out_stats->contended_count = load_u64(&stats->contended_count);
+		out_stats->wait_total_ns = load_u64(&stats->wait_total_ns);
+		out_stats->wait_max_ns = load_u64(&stats->wait_max_ns);
+		out_stats->hold_total_ns = load_u64(&stats->hold_total_ns);
+		out_stats->hold_max_ns = load_u64(&stats->hold_max_ns);
+	}
+
+	pthread_mutex_unlock(&gLockStats.mutex);
+
+	return count;
+}
+
+void
+os_lock_stats_set_added_callback(os_lock_stats_added_func_t func, void *ptr)
+{
+	pthread_mutex_lock(&gLockStats.mutex);
+
+	gLockStats.added_func = func;
+	gLockStats.added_ptr = ptr;
+
+	for (uint32_t i = 0; func != NULL && i < gLockStats.count; i++) {
+		func(&gLockStats.stats[i], ptr);
+	}
+
+	pthread_mutex_unlock(&gLockStats.mutex);
+}
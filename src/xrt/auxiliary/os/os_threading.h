@@ -1,4 +1,4 @@
-// Copyright 2019-2022, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -12,6 +12,8 @@
 
 #include "xrt/xrt_compiler.h"
 #include "xrt/xrt_config_os.h"
+#include "xrt/xrt_config_have.h"
+#include "xrt/xrt_config_build.h" // IWYU pragma: keep
 
 #include "util/u_misc.h"
 
@@ -32,6 +34,18 @@
 #error "OS not supported"
 #endif
 
+/*
+ * Can't use u_trace_marker.h here, it would pull Percetto into everything
+ * that uses threads, Tracy is a static library so it's fine.
+ */
+#if defined(XRT_FEATURE_TRACING) && defined(XRT_HAVE_TRACY)
+#ifndef TRACY_ENABLE
+#define TRACY_ENABLE
+#endif // TRACY_ENABLE
+#include "tracy/TracyC.h"
+#define OS_THREAD_TRACE_CONTENTION
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -42,6 +56,75 @@ extern "C" {
  * @{
  */
 
+/*
+ *
+ * Lock statistics.
+ *
+ */
+
+//! Max length of the name of a @ref os_lock_stats, including the terminating zero.
+#define OS_LOCK_STATS_NAME_LEN (64)
+
+/*!
+ * Wait and hold times of all the locks sharing a name, only collected in builds
+ * with XRT_FEATURE_LOCK_PROFILING, see @ref os_mutex_set_name. All counters
+ * are totals since the first lock with the name was taken.
+ */
+struct os_lock_stats
+{
+	char name[OS_LOCK_STATS_NAME_LEN];
+
+	//! Number of times a lock with this name was taken.
+	uint64_t lock_count;
+
+	//! How many of those had to wait for another thread to release it.
+	uint64_t contended_count;
+
+	uint64_t wait_total_ns;
+	uint64_t wait_max_ns;
+	uint64_t hold_total_ns;
+	uint64_t hold_max_ns;
+};
+
+/*!
+ * Called once for every @ref os_lock_stats that is added.
+ */
+typedef void (*os_lock_stats_added_func_t)(struct os_lock_stats *stats, void *ptr);
+
+/*!
+ * Get the stats for the given name, adding them if this is the first lock with
+ * it. Returns NULL if there is no room left for more names.
+ */
+struct os_lock_stats *
+os_lock_stats_get_or_add(const char *name);
+
+/*!
+ * Record that a lock was taken, @p wait_ns is how long it was waited on.
+ */
+void
+os_lock_stats_record_lock(struct os_lock_stats *stats, bool contended, int64_t wait_ns);
+
+/*!
+ * Record that a lock was released after being held for @p hold_ns.
+ */
+void
+os_lock_stats_record_hold(struct os_lock_stats *stats, int64_t hold_ns);
+
+/*!
+ * Copy out the stats at @p index if it is valid, returns how many there are.
+ */
+uint32_t
+os_lock_stats_get(uint32_t index, struct os_lock_stats *out_stats);
+
+/*!
+ * Set the function to be called for every @ref os_lock_stats, it is called
+ * straight away for those that already exist and then whenever a new name
+ * is added. Only one function can be set.
+ */
+void
+os_lock_stats_set_added_callback(os_lock_stats_added_func_t func, void *ptr);
+
+
 /*
  *
  * Mutex
@@ -55,12 +138,73 @@ struct os_mutex
 {
 	pthread_mutex_t mutex;
 
+#ifdef XRT_FEATURE_LOCK_PROFILING
+	//! Shared with all locks with the same name, NULL if not named.
+	struct os_lock_stats *stats;
+
+	//! When the current owner took the lock, only touched by the owner.
+	int64_t locked_at_ns;
+
+	//! How many times the current owner has taken the lock, for recursive mutexes.
+	uint32_t depth;
+#endif
+
 #ifndef NDEBUG
 	bool initialized;
 	bool recursive;
 #endif
 };
 
+//! Start of a wait on the lock, zero if the lock isn't being profiled.
+static inline int64_t
+os_mutex_profile_now(struct os_mutex *om)
+{
+#ifdef XRT_FEATURE_LOCK_PROFILING
+	return om->stats != NULL ? os_monotonic_get_ns() : 0;
+#else
+	(void)om;
+	return 0;
+#endif
+}
+
+//! Called after the lock has been taken, @p wait_start_ns from @ref os_mutex_profile_now.
+static inline void
+os_mutex_profile_taken(struct os_mutex *om, bool contended, int64_t wait_start_ns)
+{
+#ifdef XRT_FEATURE_LOCK_PROFILING
+	if (om->stats == NULL) {
+		return;
+	}
+
+	int64_t now_ns = os_monotonic_get_ns();
+	if (om->depth++ == 0) {
+		om->locked_at_ns = now_ns;
+	}
+	os_lock_stats_record_lock(om->stats, contended, contended ? now_ns - wait_start_ns : 0);
+#else
+	(void)om;
+	(void)contended;
+	(void)wait_start_ns;
+#endif
+}
+
+//! Called before the lock is released.
+static inline void
+os_mutex_profile_release(struct os_mutex *om)
+{
+#ifdef XRT_FEATURE_LOCK_PROFILING
+	if (om->stats == NULL || om->depth == 0) {
+		return;
+	}
+
+	if (--om->depth == 0) {
+		os_lock_stats_record_hold(om->stats, os_monotonic_get_ns() - om->locked_at_ns);
+	}
+#else
+	(void)om;
+#endif
+}
+
 /*!
  * Init.
  *
@@ -86,7 +230,25 @@ static inline void
 os_mutex_lock(struct os_mutex *om)
 {
 	assert(om->initialized);
+#if defined(OS_THREAD_TRACE_CONTENTION) || defined(XRT_FEATURE_LOCK_PROFILING)
+	// Only contended locks get a zone and are timed, the uncontended path is too hot and too boring.
+	if (pthread_mutex_trylock(&om->mutex) == 0) {
+		os_mutex_profile_taken(om, false, 0);
+		return;
+	}
+
+	int64_t wait_start_ns = os_mutex_profile_now(om);
+#ifdef OS_THREAD_TRACE_CONTENTION
+	TracyCZoneNC(contended, "os_mutex contended", 0xff0000, true);
+#endif
 	pthread_mutex_lock(&om->mutex);
+#ifdef OS_THREAD_TRACE_CONTENTION
+	TracyCZoneEnd(contended);
+#endif
+	os_mutex_profile_taken(om, true, wait_start_ns);
+#else
+	pthread_mutex_lock(&om->mutex);
+#endif
 }
 
 /*!
@@ -98,7 +260,11 @@ static inline int
 os_mutex_trylock(struct os_mutex *om)
 {
 	assert(om->initialized);
-	return pthread_mutex_trylock(&om->mutex);
+	int ret = pthread_mutex_trylock(&om->mutex);
+	if (ret == 0) {
+		os_mutex_profile_taken(om, false, 0);
+	}
+	return ret;
 }
 
 /*!
@@ -110,6 +276,7 @@ static inline void
 os_mutex_unlock(struct os_mutex *om)
 {
 	assert(om->initialized);
+	os_mutex_profile_release(om);
 	pthread_mutex_unlock(&om->mutex);
 }
 
@@ -132,6 +299,28 @@ os_mutex_destroy(struct os_mutex *om)
 #endif
 }
 
+/*!
+ * Give the mutex a name that its wait and hold times are collected under, all
+ * mutexes with the same name share their @ref os_lock_stats. Does nothing in
+ * builds without XRT_FEATURE_LOCK_PROFILING. The name is copied.
+ *
+ * Must not be called while the mutex is locked.
+ *
+ * @public @memberof os_mutex
+ */
+static inline void
+os_mutex_set_name(struct os_mutex *om, const char *name)
+{
+	assert(om->initialized);
+#ifdef XRT_FEATURE_LOCK_PROFILING
+	om->stats = os_lock_stats_get_or_add(name);
+	om->depth = 0;
+#else
+	(void)om;
+	(void)name;
+#endif
+}
+
 /*!
  * Init.
  *
@@ -251,7 +440,10 @@ static inline void
 os_cond_wait(struct os_cond *oc, struct os_mutex *om)
 {
 	assert(oc->initialized);
+	// The mutex is released while waiting, don't count that as it being held.
+	os_mutex_profile_release(om);
 	pthread_cond_wait(&oc->cond, &om->mutex);
+	os_mutex_profile_taken(om, false, 0);
 }
 
 /*!
@@ -292,6 +484,49 @@ struct os_thread
  */
 typedef void *(*os_run_func_t)(void *);
 
+/*!
+ * What a thread is used for, selects the scheduling class and CPU cores the
+ * thread gets, see @ref u_thread_policy_apply for how they get applied and
+ * configured.
+ */
+enum os_thread_role
+{
+	//! Not given any special treatment.
+	OS_THREAD_ROLE_DEFAULT = 0,
+	//! Compositor threads that need to hit every display refresh.
+	OS_THREAD_ROLE_COMPOSITOR,
+	//! Threads reading IMU and other high rate sensor data from devices.
+	OS_THREAD_ROLE_IMU,
+	//! Threads receiving frames from cameras.
+	OS_THREAD_ROLE_CAMERA,
+	//! Threads doing optical, hand and other tracking work.
+	OS_THREAD_ROLE_TRACKING,
+	//! Threads serving IPC clients.
+	OS_THREAD_ROLE_IPC,
+	//! Everything that can wait, debug UIs and similar.
+	OS_THREAD_ROLE_BACKGROUND,
+
+	OS_THREAD_ROLE_COUNT,
+};
+
+/*!
+ * Name of the role as used in configuration.
+ */
+static inline const char *
+os_thread_role_str(enum os_thread_role role)
+{
+	switch (role) {
+	case OS_THREAD_ROLE_DEFAULT: return "default";
+	case OS_THREAD_ROLE_COMPOSITOR: return "compositor";
+	case OS_THREAD_ROLE_IMU: return "imu";
+	case OS_THREAD_ROLE_CAMERA: return "camera";
+	case OS_THREAD_ROLE_TRACKING: return "tracking";
+	case OS_THREAD_ROLE_IPC: return "ipc";
+	case OS_THREAD_ROLE_BACKGROUND: return "background";
+	default: return "unknown";
+	}
+}
+
 /*!
  * Init.
  *
@@ -736,6 +971,13 @@ public:
 	{
 		os_mutex_init(&inner_);
 	}
+
+	//! Construct a mutex with a name, see @ref os_mutex_set_name
+	explicit Mutex(const char *name) noexcept
+	{
+		os_mutex_init(&inner_);
+		os_mutex_set_name(&inner_, name);
+	}
 	//! Destroy a mutex when it goes out of scope
 	~Mutex()
 	{
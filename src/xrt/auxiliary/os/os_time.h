@@ -24,6 +24,7 @@
 
 #ifdef XRT_OS_LINUX
 #include <time.h>
+#include <sched.h>
 #include <sys/time.h>
 #define XRT_HAVE_TIMESPEC
 #define XRT_HAVE_TIMEVAL
@@ -125,6 +126,18 @@ os_precise_sleeper_deinit(struct os_precise_sleeper *ops);
 static inline void
 os_precise_sleeper_nanosleep(struct os_precise_sleeper *ops, int32_t nsec);
 
+/*!
+ * Sleep until the monotonic time @p until_ns, waking up within tens of
+ * microseconds of it. Sleeps until the learned wake up slop before the target
+ * and then spins, yielding, for the remainder. The slop is learned from how
+ * late previous sleeps on this sleeper woke up, so each thread should have its
+ * own sleeper.
+ *
+ * @public @memberof os_precise_sleeper
+ */
+static inline void
+os_precise_sleeper_sleep_until(struct os_precise_sleeper *ops, int64_t until_ns);
+
 #if defined(XRT_HAVE_TIMESPEC) || defined(XRT_DOXYGEN)
 /*!
  * Convert a timespec struct to nanoseconds.
@@ -204,13 +217,23 @@ os_nanosleep(int64_t nsec)
 #endif
 }
 
+//! Starting guess of how late sleeps wake up, before anything has been measured.
+#define OS_PRECISE_SLEEPER_INITIAL_SLOP_NS (100 * 1000)
+
+//! Cap on the learned slop so a single preemption doesn't make us spin for long.
+#define OS_PRECISE_SLEEPER_MAX_SLOP_NS (2 * 1000 * 1000)
+
 struct os_precise_sleeper
 {
 #if defined(XRT_OS_WINDOWS)
 	HANDLE timer;
-#else
-	int unused_;
 #endif
+
+	/*!
+	 * How late sleeps wake up, jumps up to any later wake up and slowly
+	 * decays towards the typical one, approximating a high percentile.
+	 */
+	int64_t wake_slop_ns;
 };
 
 static inline void
@@ -219,6 +242,7 @@ os_precise_sleeper_init(struct os_precise_sleeper *ops)
 #if defined(XRT_OS_WINDOWS)
 	ops->timer = CreateWaitableTimer(NULL, TRUE, NULL);
 #endif
+	ops->wake_slop_ns = OS_PRECISE_SLEEPER_INITIAL_SLOP_NS;
 }
 
 static inline void
@@ -324,6 +348,50 @@ os_monotonic_get_ns(void)
 #endif
 }
 
+static inline void
+os_precise_sleeper_sleep_until(struct os_precise_sleeper *ops, int64_t until_ns)
+{
+	int64_t now_ns = os_monotonic_get_ns();
+	int64_t sleep_until_ns = until_ns - ops->wake_slop_ns;
+
+	if (sleep_until_ns > now_ns) {
+		int64_t sleep_ns = sleep_until_ns - now_ns;
+		if (sleep_ns > INT32_MAX) {
+			sleep_ns = INT32_MAX;
+		}
+
+		os_precise_sleeper_nanosleep(ops, (int32_t)sleep_ns);
+		now_ns = os_monotonic_get_ns();
+
+		// A clamped sleep says nothing about how late we wake up.
+		if (sleep_ns < INT32_MAX) {
+			int64_t late_ns = now_ns - sleep_until_ns;
+			if (late_ns < 0) {
+				late_ns = 0;
+			} else if (late_ns > OS_PRECISE_SLEEPER_MAX_SLOP_NS) {
+				late_ns = OS_PRECISE_SLEEPER_MAX_SLOP_NS;
+			}
+
+			if (late_ns > ops->wake_slop_ns) {
+				ops->wake_slop_ns = late_ns;
+			} else {
+				// Decay by 1/64th of the difference.
+				ops->wake_slop_ns -= (ops->wake_slop_ns - late_ns) / 64;
+			}
+		}
+	}
+
+	// Spin for the remainder, yielding to not starve other threads on this core.
+	while (now_ns < until_ns) {
+#if defined(XRT_OS_LINUX)
+		sched_yield();
+#elif defined(XRT_OS_WINDOWS)
+		SwitchToThread();
+#endif
+		now_ns = os_monotonic_get_ns();
+	}
+}
+
 #ifdef XRT_OS_LINUX
 static inline int64_t
 os_realtime_get_ns(void)
@@ -15,6 +15,7 @@
 #include "util/u_frame.h"
 #include "util/u_format.h"
 #include "util/u_logging.h"
+#include "util/u_worker.h"
 
 #include "tracking/t_tracking.h"
 #include "tracking/t_calibration_opencv.hpp"
@@ -35,6 +36,7 @@
 DEBUG_GET_ONCE_BOOL_OPTION(hsv_filter, "T_DEBUG_HSV_FILTER", false)
 DEBUG_GET_ONCE_BOOL_OPTION(hsv_picker, "T_DEBUG_HSV_PICKER", false)
 DEBUG_GET_ONCE_BOOL_OPTION(hsv_viewer, "T_DEBUG_HSV_VIEWER", false)
+DEBUG_GET_ONCE_NUM_OPTION(coarse_max_width, "T_CALIBRATION_COARSE_MAX_WIDTH", 640)
 
 namespace xrt::auxiliary::tracking {
 /*
@@ -84,6 +86,9 @@ struct ViewState
 	bool maps_valid = false;
 	cv::Mat map1 = {};
 	cv::Mat map2 = {};
+
+	//! Downscaled image for the coarse board search.
+	cv::Mat coarse = {};
 };
 
 /*!
@@ -93,6 +98,7 @@ class Calibration
 {
 public:
 	struct xrt_frame_sink base = {};
+	struct xrt_frame_node node = {};
 
 	struct
 	{
@@ -165,6 +171,27 @@ public:
 	//! Should we mirror the rgb images.
 	bool mirror_rgb_image = false;
 
+	/*!
+	 * The board is searched for in views downscaled to at most this wide,
+	 * then refined on the full resolution view, zero disables it.
+	 */
+	int coarse_max_width = 640;
+
+	//! Runs the right view of stereo frames while we do the left one.
+	struct u_worker_thread_pool *pool = NULL;
+	struct u_worker_group *group = NULL;
+
+	/*!
+	 * The queue in front of us drops frames while we are busy, the
+	 * sequence numbers are used to count them.
+	 */
+	struct
+	{
+		bool valid = false;
+		uint64_t last_sequence = 0;
+		uint32_t count = 0;
+	} dropped;
+
 	cv::Mat gray = {};
 
 	char text[512] = {};
@@ -293,6 +320,54 @@ do_view_coverage(class Calibration &c, struct ViewState &view, cv::Mat &gray, cv
 	cv::drawChessboardCorners(rgb, c.board.dims, view.current_f32, found);
 }
 
+/*!
+ * Returns the image to search for the board in, downscaled into the view's
+ * scratch image if @p gray is wider than @ref Calibration::coarse_max_width.
+ */
+static const cv::Mat &
+get_coarse_image(class Calibration &c, struct ViewState &view, const cv::Mat &gray, double &out_scale)
+{
+	out_scale = 1.0;
+	if (c.coarse_max_width <= 0 || gray.cols <= c.coarse_max_width) {
+		return gray;
+	}
+
+	out_scale = (double)c.coarse_max_width / (double)gray.cols;
+	cv::resize(gray, view.coarse, cv::Size(), out_scale, out_scale, cv::INTER_AREA);
+
+	return view.coarse;
+}
+
+//! Move points found in the coarse image to full resolution, pixel centers are at half pixels.
+template <typename Point>
+static void
+scale_up_points(std::vector<Point> &points, double scale)
+{
+	for (Point &p : points) {
+		p.x = (p.x + 0.5) / scale - 0.5;
+		p.y = (p.y + 0.5) / scale - 0.5;
+	}
+}
+
+/*!
+ * Refine corners on the full resolution image, the search window must be large
+ * enough to cover the error of a coarse search.
+ */
+static void
+refine_corners(class Calibration &c, const cv::Mat &gray, MeasurementF32 &corners, double scale)
+{
+	int crit_flag = 0;
+	crit_flag |= cv::TermCriteria::EPS;
+	crit_flag |= cv::TermCriteria::COUNT;
+	cv::TermCriteria term_criteria = {crit_flag, 30, 0.1};
+
+	int win = std::max(c.subpixel_size, (int)std::ceil(2.0 / scale));
+	cv::Size size(win, win);
+	cv::Size zero(-1, -1);
+
+	cv::cornerSubPix(gray, corners, size, zero, term_criteria);
+}
+
 static bool
 do_view_chess(class Calibration &c, struct ViewState &view, cv::Mat &gray, cv::Mat &rgb)
 {
@@ -307,22 +382,21 @@ do_view_chess(class Calibration &c, struct ViewState &view, cv::Mat &gray, cv::M
 	flags += cv::CALIB_CB_ADAPTIVE_THRESH;
 	flags += cv::CALIB_CB_NORMALIZE_IMAGE;
 
-	bool found = cv::findChessboardCorners(gray,             // Image
+	double scale = 1.0;
+	const cv::Mat &search = get_coarse_image(c, view, gray, scale);
+
+	bool found = cv::findChessboardCorners(search,           // Image
 	                                       c.board.dims,     // patternSize
 	                                       view.current_f32, // corners
 	                                       flags);           // flags
 
-	// Improve the corner positions.
-	if (found && c.subpixel_enable) {
-		int crit_flag = 0;
-		crit_flag |= cv::TermCriteria::EPS;
-		crit_flag |= cv::TermCriteria::COUNT;
-		cv::TermCriteria term_criteria = {crit_flag, 30, 0.1};
-
-		cv::Size size(c.subpixel_size, c.subpixel_size);
-		cv::Size zero(-1, -1);
+	if (scale < 1.0) {
+		scale_up_points(view.current_f32, scale);
+	}
 
-		cv::cornerSubPix(gray, view.current_f32, size, zero, term_criteria);
+	// Improve the corner positions, always needed after a coarse search.
+	if (found && (c.subpixel_enable || scale < 1.0)) {
+		refine_corners(c, gray, view.current_f32, scale);
 	}
 
 	// Do the conversion here.
@@ -358,11 +432,22 @@ do_view_sb_checkers(class Calibration &c, struct ViewState &view, cv::Mat &gray,
 	}
 #endif
 
-	bool found = cv::findChessboardCornersSB(gray,             // Image
+	double scale = 1.0;
+	const cv::Mat &search = get_coarse_image(c, view, gray, scale);
+
+	bool found = cv::findChessboardCornersSB(search,           // Image
 	                                         c.board.dims,     // patternSize
 	                                         view.current_f32, // corners
 	                                         flags);           // flags
 
+	// The SB detector is sub-pixel accurate, but only on the image it searched.
+	if (scale < 1.0) {
+		scale_up_points(view.current_f32, scale);
+		if (found) {
+			refine_corners(c, gray, view.current_f32, scale);
+		}
+	}
+
 	// Do the conversion here.
 	view.current_f64.clear(); // Doesn't effect capacity.
 	for (const cv::Point2f &p : view.current_f32) {
@@ -389,11 +474,50 @@ do_view_circles(class Calibration &c, struct ViewState &view, cv::Mat &gray, cv:
 		flags |= cv::CALIB_CB_ASYMMETRIC_GRID;
 	}
 
-	bool found = cv::findCirclesGrid(gray,             // Image
+	double scale = 1.0;
+	const cv::Mat &search = get_coarse_image(c, view, gray, scale);
+
+	bool found = cv::findCirclesGrid(search,           // Image
 	                                 c.board.dims,     // patternSize
 	                                 view.current_f64, // corners
 	                                 flags);           // flags
 
+	if (scale < 1.0) {
+		scale_up_points(view.current_f64, scale);
+	}
+
+	/*
+	 * Circle centers can't be refined like corners, search again at full
+	 * resolution but only around the grid found in the coarse image.
+	 */
+	if (found && scale < 1.0) {
+		cv::Point2d min = view.current_f64[0];
+		cv::Point2d max = view.current_f64[0];
+		for (const cv::Point2d &p : view.current_f64) {
+			min.x = std::min(min.x, p.x);
+			min.y = std::min(min.y, p.y);
+			max.x = std::max(max.x, p.x);
+			max.y = std::max(max.y, p.y);
+		}
+
+		// Pad by about one grid spacing so the outer circles are whole.
+		int dims = std::max(1, std::min(c.board.dims.width, c.board.dims.height));
+		int margin = (int)std::max(max.x - min.x, max.y - min.y) / dims + 1;
+		cv::Rect rect(cv::Point((int)min.x - margin, (int)min.y - margin),
+		              cv::Point((int)max.x + margin + 1, (int)max.y + margin + 1));
+		rect &= cv::Rect(0, 0, gray.cols, gray.rows);
+
+		found = cv::findCirclesGrid(gray(rect),       // Image
+		                            c.board.dims,     // patternSize
+		                            view.current_f64, // corners
+		                            flags);           // flags
+
+		for (cv::Point2d &p : view.current_f64) {
+			p.x += rect.x;
+			p.y += rect.y;
+		}
+	}
+
 	// Convert here so that displaying also works.
 	view.current_f32.clear(); // Doesn't effect capacity.
 	for (const cv::Point2d &p : view.current_f64) {
@@ -435,6 +559,23 @@ do_view(class Calibration &c, struct ViewState &view, cv::Mat &gray, cv::Mat &rg
 	return found;
 }
 
+//! Arguments for running @ref do_view on the worker pool.
+struct ViewTask
+{
+	class Calibration *c;
+	struct ViewState *view;
+	cv::Mat *gray;
+	cv::Mat *rgb;
+	bool found;
+};
+
+static void
+do_view_task(void *ptr)
+{
+	auto &task = *(ViewTask *)ptr;
+	task.found = do_view(*task.c, *task.view, *task.gray, *task.rgb);
+}
+
 static void
 remap_view(class Calibration &c, struct ViewState &view, cv::Mat &rgb)
 {
@@ -805,6 +946,7 @@ update_public_status(class Calibration &c, bool found)
 		c.status->cooldown = c.state.cooldown;
 		c.status->waits_remaining = c.state.waited_for;
 		c.status->found = found;
+		c.status->num_dropped = (int)c.dropped.count;
 	}
 }
 
@@ -997,8 +1139,12 @@ make_calibration_frame_sbs(class Calibration &c)
 	cv::Mat l_rgb(rows, cols, CV_8UC3, c.gui.frame->data, c.gui.frame->stride);
 	cv::Mat r_rgb(rows, cols, CV_8UC3, c.gui.frame->data + 3 * cols, c.gui.frame->stride);
 
+	// The views are independent, do the right one on the worker while we do the left one here.
+	ViewTask right = {&c, &c.state.view[1], &r_gray, &r_rgb, false};
+	u_worker_group_push(c.group, do_view_task, &right);
 	bool found_left = do_view(c, c.state.view[0], l_gray, l_rgb);
-	bool found_right = do_view(c, c.state.view[1], r_gray, r_rgb);
+	u_worker_group_wait_all(c.group);
+	bool found_right = right.found;
 
 	do_capture_logic_stereo(c, gray, rgb, found_left, c.state.view[0], l_gray, l_rgb, found_right, c.state.view[1],
 	                        r_gray, r_rgb);
@@ -1212,6 +1358,13 @@ t_calibration_frame(struct xrt_frame_sink *xsink, struct xrt_frame *xf)
 {
 	auto &c = *(class Calibration *)xsink;
 
+	// Frames are never queued up, count the ones that didn't make it so that it's visible.
+	if (c.dropped.valid && xf->source_sequence > c.dropped.last_sequence + 1) {
+		c.dropped.count += (uint32_t)(xf->source_sequence - c.dropped.last_sequence - 1);
+	}
+	c.dropped.last_sequence = xf->source_sequence;
+	c.dropped.valid = true;
+
 	if (c.load.enabled) {
 		process_load_image(c, xf);
 	}
@@ -1249,6 +1402,25 @@ t_calibration_frame(struct xrt_frame_sink *xsink, struct xrt_frame *xf)
 }
 
 
+extern "C" void
+t_calibration_node_break_apart(struct xrt_frame_node *node)
+{
+	// Noop
+}
+
+extern "C" void
+t_calibration_node_destroy(struct xrt_frame_node *node)
+{
+	auto *c_ptr = container_of(node, Calibration, node);
+
+	u_worker_group_reference(&c_ptr->group, NULL);
+	u_worker_thread_pool_reference(&c_ptr->pool, NULL);
+	xrt_frame_reference(&c_ptr->gui.frame, NULL);
+
+	delete c_ptr;
+}
+
+
 /*
  *
  * Exported functions.
@@ -1280,8 +1452,17 @@ t_calibration_stereo_create(struct xrt_frame_context *xfctx,
 	// Basic setup.
 	c.gui.sink = gui;
 	c.base.push_frame = t_calibration_frame;
+	c.node.break_apart = t_calibration_node_break_apart;
+	c.node.destroy = t_calibration_node_destroy;
 	*out_sink = &c.base;
 
+	// One worker for the right view of stereo frames.
+	c.pool = u_worker_thread_pool_create(1, 1, "Calibration");
+	c.group = u_worker_group_create(c.pool);
+	c.coarse_max_width = (int)debug_get_num_option_coarse_max_width();
+
+	xrt_frame_context_add(xfctx, &c.node);
+
 	// Copy the parameters.
 	c.stereo_sbs = params->stereo_sbs;
 	c.board.pattern = params->pattern;
@@ -14,10 +14,13 @@
 #include "util/u_sink.h"
 #include "util/u_var.h"
 #include "util/u_debug.h"
+#include "util/u_worker.h"
 #include "xrt/xrt_defines.h"
 #include "xrt/xrt_tracking.h"
 
+#include <algorithm>
 #include <cassert>
+#include <condition_variable>
 #include <ctime>
 #include <filesystem>
 #include <fstream>
@@ -29,13 +32,18 @@
 #include <opencv2/imgcodecs.hpp>
 
 DEBUG_GET_ONCE_BOOL_OPTION(euroc_recorder_use_jpg, "EUROC_RECORDER_USE_JPG", false)
+DEBUG_GET_ONCE_BOOL_OPTION(euroc_recorder_use_pnm, "EUROC_RECORDER_USE_PNM", false)
+DEBUG_GET_ONCE_NUM_OPTION(euroc_recorder_threads, "EUROC_RECORDER_THREADS", 2)
+DEBUG_GET_ONCE_NUM_OPTION(euroc_recorder_max_pending, "EUROC_RECORDER_MAX_PENDING", 16)
 
+using std::condition_variable;
 using std::lock_guard;
 using std::mutex;
 using std::ofstream;
 using std::queue;
 using std::string;
 using std::to_string;
+using std::unique_lock;
 using std::vector;
 using std::filesystem::create_directories;
 
@@ -50,6 +58,16 @@ struct euroc_recorder
 	struct u_var_button recording_btn; //!< UI button to start/stop `recording`
 
 	bool use_jpg; //! Whether or not we should save images as .jpg files
+	bool use_pnm; //! Save images as uncompressed .pgm/.ppm files, takes precedence over use_jpg
+
+	// Images are encoded and written on a worker pool so that a slow encoder
+	// doesn't hold up the writer queues, at most max_pending_images at once.
+	struct u_worker_thread_pool *pool = nullptr;
+	struct u_worker_group *group = nullptr;
+	int max_pending_images = 0;
+	int pending_images = 0; //!< Images pushed to the pool but not written yet, protected by pending_lock
+	mutex pending_lock{};
+	condition_variable pending_cv{}; //!< Signalled when an image has been written
 
 	// Cloner sinks: copy frame to heap for quick release of the original
 	struct xrt_slam_sinks cloner_queues; //!< Queue sinks that write into cloner sinks
@@ -181,6 +199,35 @@ euroc_recorder_save_gt(xrt_pose_sink *sink, struct xrt_pose_sample *sample)
 	*er->gt_csv << o.w << "," << o.x << "," << o.y << "," << o.z << CSV_EOL;
 }
 
+//! An image waiting on the pool to be encoded and written to disk.
+struct euroc_recorder_image_task
+{
+	euroc_recorder *er;
+	struct xrt_frame *frame;
+	string img_path;
+};
+
+static void
+euroc_recorder_write_image(void *ptr)
+{
+	euroc_recorder_image_task *task = (euroc_recorder_image_task *)ptr;
+	euroc_recorder *er = task->er;
+	xrt_frame *frame = task->frame;
+
+	auto img_type = frame->format == XRT_FORMAT_L8 ? CV_8UC1 : CV_8UC3;
+	cv::Mat img{(int)frame->height, (int)frame->width, img_type, frame->data, frame->stride};
+	cv::imwrite(task->img_path, img);
+
+	xrt_frame_reference(&task->frame, NULL);
+	delete task;
+
+	{
+		lock_guard lock{er->pending_lock};
+		er->pending_images--;
+	}
+	er->pending_cv.notify_one();
+}
+
 static void
 euroc_recorder_save_frame(euroc_recorder *er, struct xrt_frame *frame, int cam_index)
 {
@@ -188,12 +235,22 @@ euroc_recorder_save_frame(euroc_recorder *er, struct xrt_frame *frame, int cam_i
 	uint64_t ts = frame->timestamp;
 
 	assert(frame->format == XRT_FORMAT_L8 || frame->format == XRT_FORMAT_R8G8B8); // Only formats supported
-	auto img_type = frame->format == XRT_FORMAT_L8 ? CV_8UC1 : CV_8UC3;
 	string file_extension = er->use_jpg ? ".jpg" : ".png";
+	if (er->use_pnm) {
+		file_extension = frame->format == XRT_FORMAT_L8 ? ".pgm" : ".ppm";
+	}
 	string filename = std::to_string(ts) + file_extension;
 	string img_path = er->path + "/mav0/" + cam_name + "/data/" + filename;
-	cv::Mat img{(int)frame->height, (int)frame->width, img_type, frame->data, frame->stride};
-	cv::imwrite(img_path, img);
+
+	{ // Bound the amount of frames held by the pool, blocks this writer queue.
+		unique_lock lock{er->pending_lock};
+		er->pending_cv.wait(lock, [er] { return er->pending_images < er->max_pending_images; });
+		er->pending_images++;
+	}
+
+	euroc_recorder_image_task *task = new euroc_recorder_image_task{er, nullptr, img_path};
+	xrt_frame_reference(&task->frame, frame);
+	u_worker_group_push(er->group, euroc_recorder_write_image, task);
 
 	*er->cams_csv[cam_index] << ts << "," << filename << CSV_EOL;
 }
@@ -322,6 +379,12 @@ extern "C" void
 euroc_recorder_node_destroy(struct xrt_frame_node *node)
 {
 	struct euroc_recorder *er = container_of(node, struct euroc_recorder, node);
+
+	// The image tasks reference the recorder.
+	u_worker_group_wait_all(er->group);
+	u_worker_group_reference(&er->group, NULL);
+	u_worker_thread_pool_reference(&er->pool, NULL);
+
 	delete er->imu_csv;
 	delete er->gt_csv;
 	for (int i = 0; i < er->cam_count; i++) {
@@ -352,6 +415,12 @@ euroc_recorder_create(struct xrt_frame_context *xfctx, const char *record_path,
 	xrt_frame_context_add(xfctx, xfn);
 
 	er->use_jpg = debug_get_bool_option_euroc_recorder_use_jpg();
+	er->use_pnm = debug_get_bool_option_euroc_recorder_use_pnm();
+
+	int thread_count = std::max((int)debug_get_num_option_euroc_recorder_threads(), 1);
+	er->max_pending_images = std::max((int)debug_get_num_option_euroc_recorder_max_pending(), 1);
+	er->pool = u_worker_thread_pool_create(thread_count, thread_count, "EuRoC Recorder");
+	er->group = u_worker_group_create(er->pool);
 
 	// Setup sink pipeline
 
@@ -360,7 +429,7 @@ euroc_recorder_create(struct xrt_frame_context *xfctx, const char *record_path,
 	// frame queues from the user being filled up. After that we write to disk. We
 	// also put queues between these to support sensors streaming on different
 	// threads.
-	// cloner_queue -> cloner_sink (clone ) -> writer_queue -> writer_sink (write to disk)
+	// cloner_queue -> cloner_sink (clone ) -> writer_queue -> writer_sink -> pool (encode and write to disk)
 
 	er->cloner_queues.cam_count = er->cam_count;
 	er->writer_queues.cam_count = er->cam_count;
@@ -1,4 +1,4 @@
-// Copyright 2019-2020, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -9,11 +9,14 @@
  * @ingroup aux_tracking
  */
 
+#include "xrt/xrt_config_os.h"
 #include "tracking/t_calibration_opencv.hpp"
 #include "tracking/t_tracking.h"
+#include "math/m_api.h"
 #include "util/u_misc.h"
 #include "util/u_logging.h"
 #include "util/u_json.hpp"
+#include "util/u_device_cache.h"
 #include "os/os_time.h"
 
 
@@ -48,6 +51,9 @@ DEBUG_GET_ONCE_LOG_OPTION(calib_log, "CALIB_LOG", U_LOGGING_INFO)
 		FROM.copyTo(TO);                                                                                       \
 	} while (false)
 
+//! Name of the on disk cache entries of the remap tables.
+#define REMAP_CACHE_NAME "undistort_map"
+
 
 /*
  *
@@ -68,6 +74,93 @@ write_cv_mat(FILE *f, cv::Mat *m);
  *
  */
 namespace xrt::auxiliary::tracking {
+
+// The device cache only has a cache dir to store things in on Linux.
+#ifdef XRT_OS_LINUX
+/*!
+ * Key of the cached remap tables, from everything that goes into generating
+ * them, so the cache is only used while the calibration stays the same.
+ */
+static bool
+get_undistort_map_cache_key(CameraCalibrationWrapper &wrap,
+                            const cv::Size &image_size,
+                            const cv::Mat &rectify,
+                            const cv::Mat &new_camera_matrix,
+                            uint64_t *out_key)
+{
+	std::vector<uint8_t> data;
+	auto append = [&data](const void *ptr, size_t size) {
+		const uint8_t *bytes = (const uint8_t *)ptr;
+		data.insert(data.end(), bytes, bytes + size);
+	};
+	auto append_mat = [&append](const cv::Mat &mat) {
+		// As doubles, so the type the matrices happen to have doesn't matter.
+		cv::Mat m;
+		if (!mat.empty()) {
+			mat.convertTo(m, CV_64F);
+		}
+
+		int32_t dims[2] = {m.rows, m.cols};
+		append(dims, sizeof(dims));
+		for (int r = 0; r < m.rows; r++) {
+			append(m.ptr<double>(r), sizeof(double) * m.cols);
+		}
+	};
+
+	int32_t header[3] = {image_size.width, image_size.height, (int32_t)wrap.distortion_model};
+	append(header, sizeof(header));
+	append_mat(wrap.intrinsics_mat);
+	append_mat(wrap.distortion_mat);
+	append_mat(rectify);
+	append_mat(new_camera_matrix);
+
+	uint64_t hash = math_hash_string((const char *)data.data(), data.size());
+
+	return u_device_cache_make_key(NULL, &hash, sizeof(hash), out_key);
+}
+
+static bool
+load_undistort_map(uint64_t key, const cv::Size &image_size, RemapPair &out)
+{
+	void *data = NULL;
+	size_t data_size = 0;
+	if (!u_device_cache_load(key, REMAP_CACHE_NAME, &data, &data_size)) {
+		return false;
+	}
+
+	// Both maps one after the other.
+	size_t map_size = sizeof(float) * image_size.area();
+	bool valid = data_size == map_size * 2;
+	if (valid) {
+		out.remap_x.create(image_size, CV_32FC1);
+		out.remap_y.create(image_size, CV_32FC1);
+		memcpy(out.remap_x.data, data, map_size);
+		memcpy(out.remap_y.data, (uint8_t *)data + map_size, map_size);
+	}
+
+	free(data);
+
+	return valid;
+}
+
+static void
+store_undistort_map(uint64_t key, const cv::Size &image_size, const RemapPair &maps)
+{
+	for (const cv::Mat *m : {&maps.remap_x, &maps.remap_y}) {
+		if (m->type() != CV_32FC1 || m->size() != image_size || !m->isContinuous()) {
+			return;
+		}
+	}
+
+	size_t map_size = sizeof(float) * image_size.area();
+	std::vector<uint8_t> data(map_size * 2);
+	memcpy(data.data(), maps.remap_x.data, map_size);
+	memcpy(data.data() + map_size, maps.remap_y.data, map_size);
+
+	u_device_cache_store(key, REMAP_CACHE_NAME, data.data(), data.size());
+}
+#endif
+
 RemapPair
 calibration_get_undistort_map(t_camera_calibration &calib,
                               cv::InputArray rectify_transform_optional,
@@ -79,14 +172,28 @@ calibration_get_undistort_map(t_camera_calibration &calib,
 		new_camera_matrix_optional = wrap.intrinsics_mat;
 	}
 
+	// Empty if no transform was given.
+	cv::Mat rectify_transform = rectify_transform_optional.getMat();
+
 	//! @todo Scale Our intrinsics if the frame size we request
 	//              calibration for does not match what was saved
 	cv::Size image_size(calib.image_size_pixels.w, calib.image_size_pixels.h);
 
+#ifdef XRT_OS_LINUX
+	// Generating the maps takes a while for larger cameras, reuse them from earlier runs.
+	uint64_t cache_key = 0;
+	bool use_cache =
+	    get_undistort_map_cache_key(wrap, image_size, rectify_transform, new_camera_matrix_optional, &cache_key);
+	if (use_cache && load_undistort_map(cache_key, image_size, ret)) {
+		CALIB_DEBUG("Loaded undistort map from cache.");
+		return ret;
+	}
+#endif
+
 	if (t_camera_distortion_model_is_opencv_fisheye(wrap.distortion_model)) {
 		cv::fisheye::initUndistortRectifyMap(wrap.intrinsics_mat,        // cameraMatrix
 		                                     wrap.distortion_mat,        // distCoeffs
-		                                     rectify_transform_optional, // R
+		                                     rectify_transform,          // R
 		                                     new_camera_matrix_optional, // newCameraMatrix
 		                                     image_size,                 // size
 		                                     CV_32FC1,                   // m1type
@@ -95,7 +202,7 @@ calibration_get_undistort_map(t_camera_calibration &calib,
 	} else if (t_camera_distortion_model_is_opencv_non_fisheye(wrap.distortion_model)) {
 		cv::initUndistortRectifyMap(wrap.intrinsics_mat,        // cameraMatrix
 		                            wrap.distortion_mat,        // distCoeffs
-		                            rectify_transform_optional, // R
+		                            rectify_transform,          // R
 		                            new_camera_matrix_optional, // newCameraMatrix
 		                            image_size,                 // size
 		                            CV_32FC1,                   // m1type
@@ -103,8 +210,15 @@ calibration_get_undistort_map(t_camera_calibration &calib,
 		                            ret.remap_y);               // map2
 	} else {
 		assert(!"Unsupported distortion model");
+		return ret;
 	}
 
+#ifdef XRT_OS_LINUX
+	if (use_cache) {
+		store_undistort_map(cache_key, image_size, ret);
+	}
+#endif
+
 	return ret;
 }
 
@@ -17,9 +17,26 @@
 
 #include "tracking/t_tracking.h"
 
+#include <math.h>
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD
+#include <immintrin.h>
+#define TARGET_SSE41 __attribute__((target("ssse3,sse4.1")))
+#endif
+
+// Needs the A64 only float divide and round to nearest instructions.
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define HAVE_NEON
+#include <arm_neon.h>
+#endif
+
+
+DEBUG_GET_ONCE_BOOL_OPTION(hsv_filter_direct, "T_HSV_FILTER_DIRECT", false)
+
 
 #define MOD_180(v) ((uint32_t)(v) % 180)
 
@@ -115,15 +132,389 @@ t_hsv_build_optimized_table(struct t_hsv_filter_params *params, struct t_hsv_fil
 	free(temp);
 }
 
+void
+t_hsv_build_packed_table(struct t_hsv_filter_params *params, struct t_hsv_filter_packed_table *t)
+{
+	struct t_hsv_filter_optimized_table *temp = U_TYPED_CALLOC(struct t_hsv_filter_optimized_table);
+	t_hsv_build_optimized_table(params, temp);
+
+	for (int y = 0; y < T_HSV_SIZE; y++) {
+		for (int u = 0; u < T_HSV_SIZE; u++) {
+			for (int v = 0; v < T_HSV_SIZE / 2; v++) {
+				uint8_t lo = temp->v[y][u][v * 2 + 0];
+				uint8_t hi = temp->v[y][u][v * 2 + 1];
+				t->v[y][u][v] = (uint8_t)(lo | hi << 4);
+			}
+		}
+	}
+
+	free(temp);
+}
+
 
 /*
  *
- * Sink filter
+ * Direct classification, computes HSV for each pixel instead of using a table.
+ * This avoids the quantization of the table but costs more per pixel than the
+ * lookup, so it is only used when asked for with T_HSV_FILTER_DIRECT.
  *
  */
 
 #define NUM_CHANNELS 4
 
+/*!
+ * The filter params in a form that is quick to test against, the hue offset
+ * is pre-wrapped so that a single conditional subtract replaces MOD_180.
+ */
+struct hsv_direct_params
+{
+	int32_t hue_offset[3];
+	int32_t hue_range[3];
+	int32_t s_min[3];
+	int32_t v_min[3];
+	int32_t white_s_max;
+	int32_t white_v_min;
+};
+
+//! Classify the pixels [x, w) of one row, @p src points at the start of the row.
+typedef void (*hsv_row_func)(
+    const struct hsv_direct_params *p, const uint8_t *src, uint8_t *dst[4], uint32_t x, uint32_t w);
+
+static void
+make_direct_params(const struct t_hsv_filter_params *params, struct hsv_direct_params *p)
+{
+	for (int i = 0; i < 3; i++) {
+		p->hue_offset[i] = MOD_180(360 - params->color[i].hue_min);
+		p->hue_range[i] = params->color[i].hue_range;
+		p->s_min[i] = params->color[i].s_min;
+		p->v_min[i] = params->color[i].v_min;
+	}
+	p->white_s_max = params->white.s_max;
+	p->white_v_min = params->white.v_min;
+}
+
+static inline int32_t
+round_to_byte(float f)
+{
+	int32_t i = (int32_t)lrintf(f);
+	return i < 0 ? 0 : (i > 255 ? 255 : i);
+}
+
+/*!
+ * Does the same YUV -> RGB -> HSV conversion as the 8-bit OpenCV code used by
+ * @ref t_convert_make_y8u8v8_to_h8s8v8 followed by the same checks as when
+ * building the tables, returns the same bits as the table lookup. The SIMD
+ * versions below do the exact same operations in the same order.
+ */
+static inline uint8_t
+direct_sample(const struct hsv_direct_params *p, uint32_t y, uint32_t u, uint32_t v)
+{
+	float d = (float)u - 128.0f;
+	float e = (float)v - 128.0f;
+
+	int32_t r = round_to_byte((float)y + 1.140f * e);
+	int32_t g = round_to_byte((float)y - 0.395f * d - 0.581f * e);
+	int32_t b = round_to_byte((float)y + 2.032f * d);
+
+	int32_t max = r > g ? r : g;
+	max = max > b ? max : b;
+	int32_t min = r < g ? r : g;
+	min = min < b ? min : b;
+	int32_t diff = max - min;
+
+	// Red wins over green which wins over blue if they are equal.
+	int32_t num;
+	if (max == r) {
+		num = g - b;
+	} else if (max == g) {
+		num = b - r + diff * 2;
+	} else {
+		num = r - g + diff * 4;
+	}
+
+	int32_t h = (int32_t)lrintf((float)num * (30.0f / (float)(diff > 0 ? diff : 1)));
+	h += h < 0 ? 180 : 0;
+	int32_t s = (int32_t)lrintf((float)diff * 255.0f / (float)(max > 0 ? max : 1));
+
+	uint8_t bits = 0;
+	for (int i = 0; i < 3; i++) {
+		int32_t hh = h + p->hue_offset[i];
+		hh -= hh >= 180 ? 180 : 0;
+
+		bool good = hh < p->hue_range[i] && s >= p->s_min[i] && max >= p->v_min[i];
+		bits |= (uint8_t)(good << i);
+	}
+
+	bool white = s <= p->white_s_max && max >= p->white_v_min;
+	bits |= (uint8_t)(white << 3);
+
+	return bits;
+}
+
+static inline void
+write_sample(uint8_t bits, uint8_t *dst[4], uint32_t x)
+{
+	for (int i = 0; i < NUM_CHANNELS; i++) {
+		dst[i][x] = (bits & (1 << i)) ? 0xff : 0x00;
+	}
+}
+
+static void
+scalar_yuv_row(const struct hsv_direct_params *p, const uint8_t *src, uint8_t *dst[4], uint32_t x, uint32_t w)
+{
+	for (; x < w; x++) {
+		const uint8_t *s = src + x * 3;
+		write_sample(direct_sample(p, s[0], s[1], s[2]), dst, x);
+	}
+}
+
+static void
+scalar_yuyv_row(const struct hsv_direct_params *p, const uint8_t *src, uint8_t *dst[4], uint32_t x, uint32_t w)
+{
+	for (; x + 2 <= w; x += 2) {
+		const uint8_t *s = src + x * 2;
+		write_sample(direct_sample(p, s[0], s[1], s[3]), dst, x + 0);
+		write_sample(direct_sample(p, s[2], s[1], s[3]), dst, x + 1);
+	}
+}
+
+
+#ifdef HAVE_X86_SIMD
+
+TARGET_SSE41 static inline __m128i
+sse41_round_to_byte(__m128 f)
+{
+	__m128i i = _mm_cvtps_epi32(f);
+	return _mm_min_epi32(_mm_max_epi32(i, _mm_setzero_si128()), _mm_set1_epi32(255));
+}
+
+//! Classify 4 pixels given as 32-bit lanes and write one byte per pixel to each channel.
+TARGET_SSE41 static inline void
+sse41_classify4(const struct hsv_direct_params *p, __m128i yi, __m128i ui, __m128i vi, uint8_t *dst[4], uint32_t x)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i c180 = _mm_set1_epi32(180);
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	__m128 y = _mm_cvtepi32_ps(yi);
+	__m128 d = _mm_cvtepi32_ps(_mm_sub_epi32(ui, _mm_set1_epi32(128)));
+	__m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(vi, _mm_set1_epi32(128)));
+
+	__m128 fr = _mm_add_ps(y, _mm_mul_ps(_mm_set1_ps(1.140f), e));
+	__m128 fg = _mm_sub_ps(_mm_sub_ps(y, _mm_mul_ps(_mm_set1_ps(0.395f), d)), _mm_mul_ps(_mm_set1_ps(0.581f), e));
+	__m128 fb = _mm_add_ps(y, _mm_mul_ps(_mm_set1_ps(2.032f), d));
+	__m128i r = sse41_round_to_byte(fr);
+	__m128i g = sse41_round_to_byte(fg);
+	__m128i b = sse41_round_to_byte(fb);
+
+	__m128i max = _mm_max_epi32(_mm_max_epi32(r, g), b);
+	__m128i min = _mm_min_epi32(_mm_min_epi32(r, g), b);
+	__m128i diff = _mm_sub_epi32(max, min);
+
+	__m128i num_r = _mm_sub_epi32(g, b);
+	__m128i num_g = _mm_add_epi32(_mm_sub_epi32(b, r), _mm_slli_epi32(diff, 1));
+	__m128i num_b = _mm_add_epi32(_mm_sub_epi32(r, g), _mm_slli_epi32(diff, 2));
+	__m128i num = _mm_blendv_epi8(num_b, num_g, _mm_cmpeq_epi32(max, g));
+	num = _mm_blendv_epi8(num, num_r, _mm_cmpeq_epi32(max, r));
+
+	__m128 fdiff = _mm_cvtepi32_ps(diff);
+	__m128 inv = _mm_div_ps(_mm_set1_ps(30.0f), _mm_max_ps(fdiff, one));
+	__m128i h = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(num), inv));
+	h = _mm_add_epi32(h, _mm_and_si128(_mm_cmplt_epi32(h, zero), c180));
+	__m128 fs = _mm_div_ps(_mm_mul_ps(fdiff, _mm_set1_ps(255.0f)), _mm_max_ps(_mm_cvtepi32_ps(max), one));
+	__m128i s = _mm_cvtps_epi32(fs);
+
+	__m128i mask[NUM_CHANNELS];
+	for (int i = 0; i < 3; i++) {
+		__m128i hh = _mm_add_epi32(h, _mm_set1_epi32(p->hue_offset[i]));
+		hh = _mm_sub_epi32(hh, _mm_andnot_si128(_mm_cmplt_epi32(hh, c180), c180));
+
+		__m128i bad = _mm_cmplt_epi32(s, _mm_set1_epi32(p->s_min[i]));
+		bad = _mm_or_si128(bad, _mm_cmplt_epi32(max, _mm_set1_epi32(p->v_min[i])));
+		mask[i] = _mm_andnot_si128(bad, _mm_cmplt_epi32(hh, _mm_set1_epi32(p->hue_range[i])));
+	}
+
+	__m128i bad = _mm_cmpgt_epi32(s, _mm_set1_epi32(p->white_s_max));
+	bad = _mm_or_si128(bad, _mm_cmplt_epi32(max, _mm_set1_epi32(p->white_v_min)));
+	mask[3] = _mm_andnot_si128(bad, _mm_cmpeq_epi32(zero, zero));
+
+	for (int i = 0; i < NUM_CHANNELS; i++) {
+		// All bits set or clear in each lane, so saturating keeps it that way.
+		__m128i packed = _mm_packs_epi16(_mm_packs_epi32(mask[i], zero), zero);
+		int32_t out = _mm_cvtsi128_si32(packed);
+		memcpy(dst[i] + x, &out, sizeof(out));
+	}
+}
+
+TARGET_SSE41 static void
+sse41_yuv_row(const struct hsv_direct_params *params, const uint8_t *src, uint8_t *dst[4], uint32_t x, uint32_t w)
+{
+	// Local copy so the stores to dst can't alias it.
+	const struct hsv_direct_params p = *params;
+	const __m128i shuf_y = _mm_setr_epi8(0, -1, -1, -1, 3, -1, -1, -1, 6, -1, -1, -1, 9, -1, -1, -1);
+	const __m128i shuf_u = _mm_setr_epi8(1, -1, -1, -1, 4, -1, -1, -1, 7, -1, -1, -1, 10, -1, -1, -1);
+	const __m128i shuf_v = _mm_setr_epi8(2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1);
+
+	// Each load reads 16 bytes for the 12 we use, stay inside of the row.
+	for (; x + 6 <= w; x += 4) {
+		__m128i in = _mm_loadu_si128((const __m128i *)(src + x * 3));
+		__m128i y = _mm_shuffle_epi8(in, shuf_y);
+		__m128i u = _mm_shuffle_epi8(in, shuf_u);
+		__m128i v = _mm_shuffle_epi8(in, shuf_v);
+		sse41_classify4(&p, y, u, v, dst, x);
+	}
+
+	scalar_yuv_row(&p, src, dst, x, w);
+}
+
+TARGET_SSE41 static void
+sse41_yuyv_row(const struct hsv_direct_params *params, const uint8_t *src, uint8_t *dst[4], uint32_t x, uint32_t w)
+{
+	// Local copy so the stores to dst can't alias it.
+	const struct hsv_direct_params p = *params;
+	const __m128i shuf_y = _mm_setr_epi8(0, -1, -1, -1, 2, -1, -1, -1, 4, -1, -1, -1, 6, -1, -1, -1);
+	const __m128i shuf_u = _mm_setr_epi8(1, -1, -1, -1, 1, -1, -1, -1, 5, -1, -1, -1, 5, -1, -1, -1);
+	const __m128i shuf_v = _mm_setr_epi8(3, -1, -1, -1, 3, -1, -1, -1, 7, -1, -1, -1, 7, -1, -1, -1);
+
+	for (; x + 4 <= w; x += 4) {
+		__m128i in = _mm_loadl_epi64((const __m128i *)(src + x * 2));
+		__m128i y = _mm_shuffle_epi8(in, shuf_y);
+		__m128i u = _mm_shuffle_epi8(in, shuf_u);
+		__m128i v = _mm_shuffle_epi8(in, shuf_v);
+		sse41_classify4(&p, y, u, v, dst, x);
+	}
+
+	scalar_yuyv_row(&p, src, dst, x, w);
+}
+
+#endif // HAVE_X86_SIMD
+
+
+#ifdef HAVE_NEON
+
+static inline int32x4_t
+neon_round_to_byte(float32x4_t f)
+{
+	int32x4_t i = vcvtnq_s32_f32(f);
+	return vminq_s32(vmaxq_s32(i, vdupq_n_s32(0)), vdupq_n_s32(255));
+}
+
+//! Classify 4 pixels given as 32-bit lanes, gives a full lane mask per channel.
+static inline void
+neon_classify4(const struct hsv_direct_params *p, uint32x4_t yi, uint32x4_t ui, uint32x4_t vi, uint32x4_t out[4])
+{
+	const int32x4_t c180 = vdupq_n_s32(180);
+	const float32x4_t one = vdupq_n_f32(1.0f);
+
+	float32x4_t y = vcvtq_f32_u32(yi);
+	float32x4_t d = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(ui), vdupq_n_s32(128)));
+	float32x4_t e = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vi), vdupq_n_s32(128)));
+
+	int32x4_t r = neon_round_to_byte(vaddq_f32(y, vmulq_n_f32(e, 1.140f)));
+	int32x4_t g = neon_round_to_byte(vsubq_f32(vsubq_f32(y, vmulq_n_f32(d, 0.395f)), vmulq_n_f32(e, 0.581f)));
+	int32x4_t b = neon_round_to_byte(vaddq_f32(y, vmulq_n_f32(d, 2.032f)));
+
+	int32x4_t max = vmaxq_s32(vmaxq_s32(r, g), b);
+	int32x4_t min = vminq_s32(vminq_s32(r, g), b);
+	int32x4_t diff = vsubq_s32(max, min);
+
+	int32x4_t num_r = vsubq_s32(g, b);
+	int32x4_t num_g = vaddq_s32(vsubq_s32(b, r), vshlq_n_s32(diff, 1));
+	int32x4_t num_b = vaddq_s32(vsubq_s32(r, g), vshlq_n_s32(diff, 2));
+	int32x4_t num = vbslq_s32(vceqq_s32(max, g), num_g, num_b);
+	num = vbslq_s32(vceqq_s32(max, r), num_r, num);
+
+	float32x4_t fdiff = vcvtq_f32_s32(diff);
+	float32x4_t inv = vdivq_f32(vdupq_n_f32(30.0f), vmaxq_f32(fdiff, one));
+	int32x4_t h = vcvtnq_s32_f32(vmulq_f32(vcvtq_f32_s32(num), inv));
+	h = vaddq_s32(h, vandq_s32(vreinterpretq_s32_u32(vcltq_s32(h, vdupq_n_s32(0))), c180));
+	float32x4_t fs = vdivq_f32(vmulq_n_f32(fdiff, 255.0f), vmaxq_f32(vcvtq_f32_s32(max), one));
+	int32x4_t s = vcvtnq_s32_f32(fs);
+
+	for (int i = 0; i < 3; i++) {
+		int32x4_t hh = vaddq_s32(h, vdupq_n_s32(p->hue_offset[i]));
+		hh = vsubq_s32(hh, vandq_s32(vreinterpretq_s32_u32(vcgeq_s32(hh, c180)), c180));
+
+		uint32x4_t good = vcltq_s32(hh, vdupq_n_s32(p->hue_range[i]));
+		good = vandq_u32(good, vcgeq_s32(s, vdupq_n_s32(p->s_min[i])));
+		good = vandq_u32(good, vcgeq_s32(max, vdupq_n_s32(p->v_min[i])));
+		out[i] = good;
+	}
+
+	out[3] = vandq_u32(vcleq_s32(s, vdupq_n_s32(p->white_s_max)), vcgeq_s32(max, vdupq_n_s32(p->white_v_min)));
+}
+
+//! Classify 8 pixels, gives one byte per pixel for each channel.
+static inline void
+neon_classify8(const struct hsv_direct_params *p, uint8x8_t y, uint8x8_t u, uint8x8_t v, uint8x8_t out[4])
+{
+	uint16x8_t y16 = vmovl_u8(y);
+	uint16x8_t u16 = vmovl_u8(u);
+	uint16x8_t v16 = vmovl_u8(v);
+
+	uint32x4_t lo[NUM_CHANNELS];
+	uint32x4_t hi[NUM_CHANNELS];
+	neon_classify4(p, vmovl_u16(vget_low_u16(y16)), vmovl_u16(vget_low_u16(u16)), vmovl_u16(vget_low_u16(v16)), lo);
+	neon_classify4(p, vmovl_u16(vget_high_u16(y16)), vmovl_u16(vget_high_u16(u16)), vmovl_u16(vget_high_u16(v16)),
+	               hi);
+
+	for (int i = 0; i < NUM_CHANNELS; i++) {
+		out[i] = vmovn_u16(vcombine_u16(vmovn_u32(lo[i]), vmovn_u32(hi[i])));
+	}
+}
+
+static void
+neon_yuv_row(const struct hsv_direct_params *params, const uint8_t *src, uint8_t *dst[4], uint32_t x, uint32_t w)
+{
+	// Local copy so the stores to dst can't alias it.
+	const struct hsv_direct_params p = *params;
+
+	for (; x + 8 <= w; x += 8) {
+		uint8x8x3_t in = vld3_u8(src + x * 3);
+
+		uint8x8_t m[NUM_CHANNELS];
+		neon_classify8(&p, in.val[0], in.val[1], in.val[2], m);
+
+		for (int i = 0; i < NUM_CHANNELS; i++) {
+			vst1_u8(dst[i] + x, m[i]);
+		}
+	}
+
+	scalar_yuv_row(&p, src, dst, x, w);
+}
+
+static void
+neon_yuyv_row(const struct hsv_direct_params *params, const uint8_t *src, uint8_t *dst[4], uint32_t x, uint32_t w)
+{
+	// Local copy so the stores to dst can't alias it.
+	const struct hsv_direct_params p = *params;
+
+	for (; x + 16 <= w; x += 16) {
+		uint8x8x4_t in = vld4_u8(src + x * 2);
+
+		uint8x8_t even[NUM_CHANNELS];
+		uint8x8_t odd[NUM_CHANNELS];
+		neon_classify8(&p, in.val[0], in.val[1], in.val[3], even);
+		neon_classify8(&p, in.val[2], in.val[1], in.val[3], odd);
+
+		for (int i = 0; i < NUM_CHANNELS; i++) {
+			uint8x8x2_t both = {{even[i], odd[i]}};
+			vst2_u8(dst[i] + x, both);
+		}
+	}
+
+	scalar_yuyv_row(&p, src, dst, x, w);
+}
+
+#endif // HAVE_NEON
+
+
+/*
+ *
+ * Sink filter
+ *
+ */
+
 /*!
  * An @ref xrt_frame_sink that splits the input based on hue.
  * @implements xrt_frame_sink
@@ -143,29 +534,59 @@ struct t_hsv_filter
 
 	struct u_sink_debug usds[NUM_CHANNELS];
 
-	struct t_hsv_filter_optimized_table table;
+	//! Compute HSV for each pixel instead of sampling @ref table, needs SIMD row functions.
+	bool use_direct;
+
+	struct hsv_direct_params direct;
+
+	//! SIMD row functions for the direct path, NULL if not supported.
+	hsv_row_func yuv_row;
+	hsv_row_func yuyv_row;
+
+	//! Channel bits for one row, sampled from @ref table and then expanded.
+	uint8_t *row_bits;
+	uint32_t row_bits_size;
+
+	struct t_hsv_filter_packed_table table;
 };
 
 static void
-process_sample(struct t_hsv_filter *f,
-               uint8_t y,
-               uint8_t cb,
-               uint8_t cr,
-               uint8_t *dst0,
-               uint8_t *dst1,
-               uint8_t *dst2,
-               uint8_t *dst3)
-{
-	uint8_t bits = t_hsv_filter_sample(&f->table, y, cb, cr);
-	uint8_t v0 = (bits & (1 << 0)) ? 0xff : 0x00;
-	uint8_t v1 = (bits & (1 << 1)) ? 0xff : 0x00;
-	uint8_t v2 = (bits & (1 << 2)) ? 0xff : 0x00;
-	uint8_t v3 = (bits & (1 << 3)) ? 0xff : 0x00;
-
-	*dst0 = v0;
-	*dst1 = v1;
-	*dst2 = v2;
-	*dst3 = v3;
+get_row_dst(struct t_hsv_filter *f, uint32_t y, uint8_t *dst[4])
+{
+	for (int i = 0; i < NUM_CHANNELS; i++) {
+		dst[i] = f->frames[i]->data + y * f->frames[i]->stride;
+	}
+}
+
+/*!
+ * Expands the channel bits of a row into one 0x00 or 0xff byte per pixel in
+ * each channel, done a pixel at a time this costs more than the table lookup.
+ */
+static void
+expand_row_bits(const uint8_t *bits, uint8_t *dst[4], uint32_t w)
+{
+	uint32_t x = 0;
+
+#if defined(HAVE_X86_SIMD) && defined(__SSE2__)
+	for (; x + 16 <= w; x += 16) {
+		__m128i b = _mm_loadu_si128((const __m128i *)(bits + x));
+		for (int i = 0; i < NUM_CHANNELS; i++) {
+			__m128i m = _mm_set1_epi8((char)(1 << i));
+			_mm_storeu_si128((__m128i *)(dst[i] + x), _mm_cmpeq_epi8(_mm_and_si128(b, m), m));
+		}
+	}
+#elif defined(HAVE_NEON)
+	for (; x + 16 <= w; x += 16) {
+		uint8x16_t b = vld1q_u8(bits + x);
+		for (int i = 0; i < NUM_CHANNELS; i++) {
+			vst1q_u8(dst[i] + x, vtstq_u8(b, vdupq_n_u8((uint8_t)(1 << i))));
+		}
+	}
+#endif
+
+	for (; x < w; x++) {
+		write_sample(bits[x], dst, x);
+	}
 }
 
 XRT_NO_INLINE static void
@@ -173,30 +594,19 @@ hsv_process_frame_yuv(struct t_hsv_filter *f, struct xrt_frame *xf)
 {
 	SINK_TRACE_MARKER();
 
-	struct xrt_frame *f0 = f->frames[0];
-	struct xrt_frame *f1 = f->frames[1];
-	struct xrt_frame *f2 = f->frames[2];
-	struct xrt_frame *f3 = f->frames[3];
+	uint8_t *bits = f->row_bits;
 
 	for (uint32_t y = 0; y < xf->height; y++) {
-		uint8_t *src = (uint8_t *)xf->data + y * xf->stride;
-		uint8_t *dst0 = f0->data + y * f0->stride;
-		uint8_t *dst1 = f1->data + y * f1->stride;
-		uint8_t *dst2 = f2->data + y * f2->stride;
-		uint8_t *dst3 = f3->data + y * f3->stride;
+		const uint8_t *src = (const uint8_t *)xf->data + y * xf->stride;
 
 		for (uint32_t x = 0; x < xf->width; x += 1) {
-			uint8_t y = src[0];
-			uint8_t cb = src[1];
-			uint8_t cr = src[2];
+			bits[x] = t_hsv_filter_packed_sample(&f->table, src[0], src[1], src[2]);
 			src += 3;
-
-			process_sample(f, y, cb, cr, dst0, dst1, dst2, dst3);
-			dst0 += 1;
-			dst1 += 1;
-			dst2 += 1;
-			dst3 += 1;
 		}
+
+		uint8_t *dst[NUM_CHANNELS];
+		get_row_dst(f, y, dst);
+		expand_row_bits(bits, dst, xf->width);
 	}
 }
 
@@ -205,17 +615,10 @@ hsv_process_frame_yuyv(struct t_hsv_filter *f, struct xrt_frame *xf)
 {
 	SINK_TRACE_MARKER();
 
-	struct xrt_frame *f0 = f->frames[0];
-	struct xrt_frame *f1 = f->frames[1];
-	struct xrt_frame *f2 = f->frames[2];
-	struct xrt_frame *f3 = f->frames[3];
+	uint8_t *bits = f->row_bits;
 
 	for (uint32_t y = 0; y < xf->height; y++) {
-		uint8_t *src = (uint8_t *)xf->data + y * xf->stride;
-		uint8_t *dst0 = f0->data + y * f0->stride;
-		uint8_t *dst1 = f1->data + y * f1->stride;
-		uint8_t *dst2 = f2->data + y * f2->stride;
-		uint8_t *dst3 = f3->data + y * f3->stride;
+		const uint8_t *src = (const uint8_t *)xf->data + y * xf->stride;
 
 		for (uint32_t x = 0; x < xf->width; x += 2) {
 			uint8_t y1 = src[0];
@@ -224,31 +627,51 @@ hsv_process_frame_yuyv(struct t_hsv_filter *f, struct xrt_frame *xf)
 			uint8_t cr = src[3];
 			src += 4;
 
-			uint8_t bits0 = t_hsv_filter_sample(&f->table, y1, cb, cr);
-			uint8_t bits1 = t_hsv_filter_sample(&f->table, y2, cb, cr);
-
-			uint8_t v0 = (bits0 & (1 << 0)) ? 0xff : 0x00;
-			uint8_t v1 = (bits0 & (1 << 1)) ? 0xff : 0x00;
-			uint8_t v2 = (bits0 & (1 << 2)) ? 0xff : 0x00;
-			uint8_t v3 = (bits0 & (1 << 3)) ? 0xff : 0x00;
-			uint8_t v4 = (bits1 & (1 << 0)) ? 0xff : 0x00;
-			uint8_t v5 = (bits1 & (1 << 1)) ? 0xff : 0x00;
-			uint8_t v6 = (bits1 & (1 << 2)) ? 0xff : 0x00;
-			uint8_t v7 = (bits1 & (1 << 3)) ? 0xff : 0x00;
-
-			*(uint16_t *)dst0 = v0 | v4 << 8;
-			*(uint16_t *)dst1 = v1 | v5 << 8;
-			*(uint16_t *)dst2 = v2 | v6 << 8;
-			*(uint16_t *)dst3 = v3 | v7 << 8;
-
-			dst0 += 2;
-			dst1 += 2;
-			dst2 += 2;
-			dst3 += 2;
+			bits[x + 0] = t_hsv_filter_packed_sample(&f->table, y1, cb, cr);
+			bits[x + 1] = t_hsv_filter_packed_sample(&f->table, y2, cb, cr);
 		}
+
+		uint8_t *dst[NUM_CHANNELS];
+		get_row_dst(f, y, dst);
+		expand_row_bits(bits, dst, xf->width);
+	}
+}
+
+XRT_NO_INLINE static void
+hsv_process_frame_direct(struct t_hsv_filter *f, struct xrt_frame *xf, hsv_row_func row)
+{
+	SINK_TRACE_MARKER();
+
+	for (uint32_t y = 0; y < xf->height; y++) {
+		const uint8_t *src = (const uint8_t *)xf->data + y * xf->stride;
+
+		uint8_t *dst[NUM_CHANNELS];
+		get_row_dst(f, y, dst);
+		row(&f->direct, src, dst, 0, xf->width);
 	}
 }
 
+static void
+select_row_funcs(struct t_hsv_filter *f)
+{
+	f->yuv_row = NULL;
+	f->yuyv_row = NULL;
+
+#ifdef HAVE_X86_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse4.1")) {
+		f->yuv_row = sse41_yuv_row;
+		f->yuyv_row = sse41_yuyv_row;
+	}
+#endif
+#ifdef HAVE_NEON
+	f->yuv_row = neon_yuv_row;
+	f->yuyv_row = neon_yuyv_row;
+#endif
+
+	f->use_direct = debug_get_bool_option_hsv_filter_direct() && f->yuv_row != NULL;
+}
+
 static void
 ensure_buf_allocated(struct t_hsv_filter *f, struct xrt_frame *xf)
 {
@@ -258,6 +681,13 @@ ensure_buf_allocated(struct t_hsv_filter *f, struct xrt_frame *xf)
 	for (size_t i = 0; i < NUM_CHANNELS; i++) {
 		u_frame_create_one_off(XRT_FORMAT_L8, w, h, &f->frames[i]);
 	}
+
+	// YUYV writes pixels in pairs.
+	uint32_t size = (w + 1) & ~1u;
+	if (f->row_bits_size < size) {
+		U_ARRAY_REALLOC_OR_FREE(f->row_bits, uint8_t, size);
+		f->row_bits_size = size;
+	}
 }
 
 static void
@@ -291,11 +721,19 @@ hsv_frame(struct xrt_frame_sink *xsink, struct xrt_frame *xf)
 	switch (xf->format) {
 	case XRT_FORMAT_YUV888:
 		ensure_buf_allocated(f, xf);
-		hsv_process_frame_yuv(f, xf);
+		if (f->use_direct) {
+			hsv_process_frame_direct(f, xf, f->yuv_row);
+		} else {
+			hsv_process_frame_yuv(f, xf);
+		}
 		break;
 	case XRT_FORMAT_YUYV422:
 		ensure_buf_allocated(f, xf);
-		hsv_process_frame_yuyv(f, xf);
+		if (f->use_direct) {
+			hsv_process_frame_direct(f, xf, f->yuyv_row);
+		} else {
+			hsv_process_frame_yuyv(f, xf);
+		}
 		break;
 	default: U_LOG_E("Bad format '%s'", u_format_str(xf->format)); return;
 	}
@@ -321,6 +759,7 @@ hsv_destroy(struct xrt_frame_node *node)
 		u_sink_debug_destroy(&f->usds[i]);
 	}
 
+	free(f->row_bits);
 	free(f);
 }
 
@@ -340,7 +779,9 @@ t_hsv_filter_create(struct xrt_frame_context *xfctx,
 	f->sinks[2] = sinks[2];
 	f->sinks[3] = sinks[3];
 
-	t_hsv_build_optimized_table(&f->params, &f->table);
+	t_hsv_build_packed_table(&f->params, &f->table);
+	make_direct_params(&f->params, &f->direct);
+	select_row_funcs(f);
 
 	xrt_frame_context_add(xfctx, &f->node);
 
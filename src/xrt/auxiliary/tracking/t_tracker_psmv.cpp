@@ -21,6 +21,7 @@
 #include "util/u_debug.h"
 #include "util/u_frame.h"
 #include "util/u_format.h"
+#include "util/u_worker.h"
 #include "util/u_trace_marker.h"
 
 #include "math/m_api.h"
@@ -57,6 +58,9 @@ public:
 
 	cv::Mat frame_undist_rectified;
 
+	//! One per view, detecting isn't safe to do on the same detector from two threads.
+	cv::Ptr<cv::SimpleBlobDetector> sbd;
+
 	void
 	populate_from_calib(t_camera_calibration &calib, const RemapPair &rectification)
 	{
@@ -114,7 +118,9 @@ public:
 	cv::Vec3d r_cam_translation;
 	cv::Matx33d r_cam_rotation;
 
-	cv::Ptr<cv::SimpleBlobDetector> sbd;
+	//! Used to process the right view at the same time as the left one.
+	struct u_worker_thread_pool *pool;
+	struct u_worker_group *group;
 
 	std::shared_ptr<PSMVFusionInterface> filter;
 
@@ -131,7 +137,7 @@ static_assert(std::is_standard_layout<TrackerPSMV>::value);
  * Right now, this is mainly finding blobs/keypoints.
  */
 static void
-do_view(TrackerPSMV &t, View &view, cv::Mat &grey, cv::Mat &rgb)
+do_view(View &view, cv::Mat &grey, cv::Mat &rgb)
 {
 	XRT_TRACE_MARKER();
 
@@ -163,9 +169,9 @@ do_view(TrackerPSMV &t, View &view, cv::Mat &grey, cv::Mat &rgb)
 
 		// Do blob detection with our masks.
 		//! @todo Re-enable masks.
-		t.sbd->detect(view.frame_undist_rectified, // image
-		              view.keypoints,              // keypoints
-		              cv::noArray());              // mask
+		view.sbd->detect(view.frame_undist_rectified, // image
+		                 view.keypoints,              // keypoints
+		                 cv::noArray());              // mask
 	}
 
 
@@ -179,6 +185,21 @@ do_view(TrackerPSMV &t, View &view, cv::Mat &grey, cv::Mat &rgb)
 	}
 }
 
+//! Arguments for running @ref do_view on the worker pool.
+struct ViewTask
+{
+	View *view;
+	cv::Mat *grey;
+	cv::Mat *rgb;
+};
+
+static void
+do_view_task(void *ptr)
+{
+	auto &task = *(ViewTask *)ptr;
+	do_view(*task.view, *task.grey, *task.rgb);
+}
+
 /*!
  * @brief Helper struct that keeps the value that produces the lowest "score" as
  * computed by your functor.
@@ -287,8 +308,11 @@ process(TrackerPSMV &t, struct xrt_frame *xf)
 	cv::Mat l_grey(rows, cols, CV_8UC1, xf->data, stride);
 	cv::Mat r_grey(rows, cols, CV_8UC1, xf->data + cols, stride);
 
-	do_view(t, t.view[0], l_grey, t.debug.rgb[0]);
-	do_view(t, t.view[1], r_grey, t.debug.rgb[1]);
+	// The views are independent, do the right one on the worker while we do the left one here.
+	ViewTask right = {&t.view[1], &r_grey, &t.debug.rgb[1]};
+	u_worker_group_push(t.group, do_view_task, &right);
+	do_view(t.view[0], l_grey, t.debug.rgb[0]);
+	u_worker_group_wait_all(t.group);
 
 	cv::Point3f last_point(t.tracked_object_position.x, t.tracked_object_position.y, t.tracked_object_position.z);
 	auto nearest_world = make_lowest_score_finder<cv::Point3f>([&](const cv::Point3f &world_point) {
@@ -529,6 +553,9 @@ t_psmv_node_destroy(struct xrt_frame_node *node)
 	auto *t_ptr = container_of(node, TrackerPSMV, node);
 	os_thread_helper_destroy(&t_ptr->oth);
 
+	u_worker_group_reference(&t_ptr->group, NULL);
+	u_worker_thread_pool_reference(&t_ptr->pool, NULL);
+
 	// Tidy variable setup.
 	u_var_remove_root(t_ptr);
 
@@ -635,7 +662,12 @@ t_psmv_create(struct xrt_frame_context *xfctx,
 	blob_params.minRepeatability = 1; // need this to avoid error?
 	// clang-format on
 
-	t.sbd = cv::SimpleBlobDetector::create(blob_params);
+	t.view[0].sbd = cv::SimpleBlobDetector::create(blob_params);
+	t.view[1].sbd = cv::SimpleBlobDetector::create(blob_params);
+
+	t.pool = u_worker_thread_pool_create(1, 1, "PSMV");
+	t.group = u_worker_group_create(t.pool);
+
 	xrt_frame_context_add(xfctx, &t.node);
 
 	// Everything is safe, now setup the variable tracking.
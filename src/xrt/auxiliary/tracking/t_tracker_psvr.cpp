@@ -20,10 +20,10 @@
 #include "util/u_format.h"
 #include "util/u_var.h"
 #include "util/u_logging.h"
+#include "util/u_worker.h"
 
 #include "math/m_mathinclude.h"
 #include "math/m_api.h"
-#include "math/m_permutation.h"
 #include "math/m_imu_3dof.h"
 
 #include "os/os_threading.h"
@@ -143,6 +143,9 @@ struct View
 
 	cv::Mat frame_undist_rectified;
 
+	//! One per view, detecting isn't safe to do on the same detector from two threads.
+	cv::Ptr<cv::SimpleBlobDetector> sbd;
+
 	void
 	populate_from_calib(t_camera_calibration &calib, const RemapPair &rectification)
 	{
@@ -206,6 +209,17 @@ typedef struct match_model
 	std::vector<match_data_t> measurements;
 } match_model_t;
 
+/*!
+ * Distance and angle of a model vertex relative to the reference vector
+ * between two other vertices, the model side of what @ref
+ * verts_to_measurement computes for the measured points.
+ */
+typedef struct match_descriptor
+{
+	float angle = {};
+	float distance = {};
+} match_descriptor_t;
+
 /*!
  * Main PSVR tracking class.
  */
@@ -254,7 +268,7 @@ public:
 	                                              // measurements against
 	std::vector<match_data_t> last_vertices;      // the last solved position of the HMD
 
-	uint32_t last_optical_model;
+	std::vector<int32_t> last_optical_match; // vertex indices of the last optical match
 
 	cv::KalmanFilter track_filters[PSVR_NUM_LEDS];
 
@@ -271,9 +285,13 @@ public:
 	cv::Vec3d r_cam_translation;
 	cv::Matx33d r_cam_rotation;
 
-	cv::Ptr<cv::SimpleBlobDetector> sbd;
+	//! Used to process the right view at the same time as the left one.
+	struct u_worker_thread_pool *pool;
+	struct u_worker_group *group;
+
 	std::vector<cv::KeyPoint> l_blobs, r_blobs;
-	std::vector<match_model_t> matches;
+	//! Model descriptors, indexed by reference vertex a, reference vertex b and vertex.
+	match_descriptor_t match_descriptors[PSVR_NUM_LEDS][PSVR_NUM_LEDS][PSVR_NUM_LEDS];
 
 	// we refine our measurement by rejecting outliers and merging 'too
 	// close' points
@@ -407,19 +425,6 @@ pose_filter_update(Eigen::Vector4f *position, cv::KalmanFilter *filter, float dt
 	filter->correct(measurement);
 }
 
-static bool
-match_possible(match_model_t *match)
-{
-	//@todo - this is currently unimplemented
-	// check if this match makes sense - we can remove
-	// unobservable combinations without checking them.
-
-
-	// we cannot see SR,SL at the same time so remove any matches that
-	// contain them both in the first 5 slots
-	return true;
-}
-
 static void
 verts_to_measurement(std::vector<blob_point_t> *meas_data, std::vector<match_data_t> *match_vertices)
 {
@@ -880,6 +885,43 @@ solve_with_imu(TrackerPSVR &t,
 }
 
 
+static float
+match_cost(const match_data_t &measured, int32_t vertex_index, const match_descriptor_t &desc)
+{
+	float cost = 0.0f;
+
+	// use the information we gathered on blob shapes to
+	// reject matches that would not fit
+
+	//@todo: use tags instead  of numeric vertex indices
+
+	if (measured.src_blob.btype == BLOB_TYPE_FRONT && vertex_index > 4) {
+		cost += 50.0f;
+	}
+
+	if (measured.src_blob.btype == BLOB_TYPE_SIDE && vertex_index < 5) {
+		cost += 50.0f;
+	}
+
+	// if the distance is significantly different, discard this
+	float dist = fabs(measured.distance - desc.distance);
+	if (dist > PSVR_DISAMBIG_REJECT_DIST) {
+		cost += 50.0f;
+	} else {
+		cost += dist;
+	}
+
+	// if the angle is significantly different, discard this
+	float angdiff = fabs(measured.angle - desc.angle);
+	if (angdiff > PSVR_DISAMBIG_REJECT_ANG) {
+		cost += 50.0f;
+	} else {
+		cost += angdiff;
+	}
+
+	return cost;
+}
+
 static Eigen::Matrix4f
 disambiguate(TrackerPSVR &t,
              std::vector<match_data_t> *measured_points,
@@ -909,17 +951,16 @@ disambiguate(TrackerPSVR &t,
 	// optical matching.
 
 	float lowest_error = 65535.0f;
-	int32_t best_model = -1;
-	uint32_t matched_vertex_indices[PSVR_NUM_LEDS];
+	bool matched = false;
+	int32_t matched_vertex_indices[PSVR_NUM_LEDS];
 
-	// we can early-out if we are 'close enough' to our last match model.
+	// we can early-out if we are 'close enough' to our last match.
 	// if we hold the previous led configuration, this increases
 	// performance and should cut down on jitter.
-	if (t.last_optical_model > 0 && t.done_correction) {
+	if (!t.last_optical_match.empty() && t.done_correction) {
 
-		match_model_t m = t.matches[t.last_optical_model];
 		for (uint32_t i = 0; i < measured_points->size(); i++) {
-			measured_points->at(i).vertex_index = m.measurements.at(i).vertex_index;
+			measured_points->at(i).vertex_index = t.last_optical_match.at(i);
 		}
 		Eigen::Matrix4f res = solve_for_measurement(&t, measured_points, solved);
 		float diff = last_diff(t, solved, &t.last_vertices);
@@ -930,65 +971,75 @@ disambiguate(TrackerPSVR &t,
 		}
 	}
 
-
-
-	for (uint32_t i = 0; i < t.matches.size(); i++) {
-		match_model_t m = t.matches[i];
-		float error_sum = 0.0f;
-		float sign_diff = 0.0f;
-		(void)sign_diff;
-
-		// we have 2 measurements per vertex (distance and
-		// angle) and we are comparing only the 'non-basis
-		// vector' elements
-
-		// fill in our 'proposed' vertex indices from the model
-		// data (this will be overwritten once our best model is
-		// selected
-		for (uint32_t j = 0; j < measured_points->size(); j++) {
-			measured_points->at(j).vertex_index = m.measurements.at(j).vertex_index;
+	HungarianAlgorithm HungAlgo;
+	vector<int> assignment;
+	uint32_t measured_count = measured_points->size();
+
+	// the first two measured points span the reference vector, so for
+	// every ordered pair of vertices they could be we assign the rest of
+	// the measured points to the remaining vertices, rather than trying
+	// every permutation of the model.
+	for (int32_t pair = 0; pair < PSVR_NUM_LEDS * PSVR_NUM_LEDS; pair++) {
+		int32_t ref_a = pair / PSVR_NUM_LEDS;
+		int32_t ref_b = pair % PSVR_NUM_LEDS;
+		if (ref_a == ref_b) {
+			continue;
 		}
 
-		bool ignore = false;
-
-		// use the information we gathered on blob shapes to
-		// reject matches that would not fit
+		const match_descriptor_t *desc = t.match_descriptors[ref_a][ref_b];
 
-		//@todo: use tags instead  of numeric vertex indices
+		int32_t candidate[PSVR_NUM_LEDS];
+		candidate[0] = ref_a;
+		candidate[1] = ref_b;
 
-		for (uint32_t j = 0; j < measured_points->size(); j++) {
-
-			if (measured_points->at(j).src_blob.btype == BLOB_TYPE_FRONT &&
-			    measured_points->at(j).vertex_index > 4) {
-				error_sum += 50.0f;
+		std::vector<int32_t> free_vertices;
+		for (int32_t v = 0; v < PSVR_NUM_LEDS; v++) {
+			if (v != ref_a && v != ref_b) {
+				free_vertices.push_back(v);
 			}
+		}
 
-			if (measured_points->at(j).src_blob.btype == BLOB_TYPE_SIDE &&
-			    measured_points->at(j).vertex_index < 5) {
-				error_sum += 50.0f;
+		std::vector<vector<double> > costMatrix(measured_count - 2,
+		                                         vector<double>(free_vertices.size(), 0.0));
+		for (uint32_t j = 2; j < measured_count; j++) {
+			for (uint32_t k = 0; k < free_vertices.size(); k++) {
+				int32_t v = free_vertices[k];
+				double cost = match_cost(measured_points->at(j), v, desc[v]);
+
+				// once we have a lock, prefer the vertices that the
+				// imu-solved pose puts close to the measured point.
+				if (t.done_correction && solved->size() == PSVR_NUM_LEDS) {
+					cost += dist_3d(measured_points->at(j).position, solved->at(v).position);
+				}
+				costMatrix[j - 2][k] = cost;
 			}
+		}
 
-			// if the distance is between a measured point
-			// and its last-known position is significantly
-			// different, discard this
-			float dist = fabs(measured_points->at(j).distance - m.measurements.at(j).distance);
-			if (dist > PSVR_DISAMBIG_REJECT_DIST) {
-				error_sum += 50.0f;
-			} else {
-				error_sum += fabs(measured_points->at(j).distance - m.measurements.at(j).distance);
-			}
+		HungAlgo.Solve(costMatrix, assignment);
 
-			// if the angle is significantly different,
-			// discard this
-			float angdiff = fabs(measured_points->at(j).angle - m.measurements.at(j).angle);
-			if (angdiff > PSVR_DISAMBIG_REJECT_ANG) {
-				error_sum += 50.0f;
-			} else {
+		bool used[PSVR_NUM_LEDS] = {};
+		for (uint32_t j = 2; j < measured_count; j++) {
+			candidate[j] = free_vertices[assignment[j - 2]];
+			used[assignment[j - 2]] = true;
+		}
 
-				error_sum += fabs(measured_points->at(j).angle - m.measurements.at(j).angle);
+		// the vertices we did not see fill up the rest, so we can hold
+		// this match even if more points show up next frame.
+		uint32_t next = measured_count;
+		for (uint32_t k = 0; k < free_vertices.size(); k++) {
+			if (!used[k]) {
+				candidate[next++] = free_vertices[k];
 			}
 		}
 
+		float error_sum = 0.0f;
+		for (uint32_t j = 0; j < measured_count; j++) {
+			measured_points->at(j).vertex_index = candidate[j];
+			error_sum += match_cost(measured_points->at(j), candidate[j], desc[candidate[j]]);
+		}
+
+		bool ignore = false;
+
 		float avg_error = (error_sum / measured_points->size());
 		if (error_sum < 50) {
 			std::vector<match_data_t> meas_solved;
@@ -1059,20 +1110,20 @@ disambiguate(TrackerPSVR &t,
 		}
 		if (avg_error <= lowest_error && !ignore) {
 			lowest_error = avg_error;
-			best_model = i;
-			for (uint32_t i = 0; i < measured_points->size(); i++) {
-				matched_vertex_indices[i] = measured_points->at(i).vertex_index;
+			matched = true;
+			for (uint32_t j = 0; j < PSVR_NUM_LEDS; j++) {
+				matched_vertex_indices[j] = candidate[j];
 			}
 		}
 	}
 
 	// U_LOG_D("lowest_error %f", lowest_error);
-	if (best_model == -1) {
+	if (!matched) {
 		PSVR_INFO("COULD NOT MATCH MODEL!");
 		return Eigen::Matrix4f().Identity();
 	}
 
-	t.last_optical_model = best_model;
+	t.last_optical_match.assign(matched_vertex_indices, matched_vertex_indices + PSVR_NUM_LEDS);
 	for (uint32_t i = 0; i < measured_points->size(); i++) {
 		measured_points->at(i).vertex_index = matched_vertex_indices[i];
 		cv::putText(
@@ -1140,92 +1191,58 @@ create_model(TrackerPSVR &t)
 	};
 }
 
-struct Helper
-{
-public:
-	m_permutator mp = {};
-	model_vertex_t vec[PSVR_NUM_LEDS] = {};
-	uint32_t indices[PSVR_NUM_LEDS];
-
-
-	~Helper()
-	{
-		m_permutator_reset(&mp);
-	}
-
-	bool
-	step(TrackerPSVR &t)
-	{
-		bool ret = m_permutator_step(&mp, &indices[0], PSVR_NUM_LEDS);
-		if (!ret) {
-			return false;
-		}
-
-		for (size_t i = 0; i < PSVR_NUM_LEDS; i++) {
-			vec[i] = t.model_vertices[indices[i]];
-		}
-
-		return true;
-	}
-};
-
 static void
 create_match_list(TrackerPSVR &t)
 {
-	// create our permutation list for matching
-	// compute the distance and angles between a reference
-	// vector, constructed from the first two vertices in
-	// the permutation.
-
-	Helper mp = {};
-	while (mp.step(t)) {
-		match_model_t m;
+	// compute the distance and angle of every vertex relative to the
+	// reference vector between each ordered pair of vertices, the
+	// measured points are compared against these when matching.
+
+	for (int32_t a = 0; a < PSVR_NUM_LEDS; a++) {
+		for (int32_t b = 0; b < PSVR_NUM_LEDS; b++) {
+			if (a == b) {
+				continue;
+			}
 
-		model_vertex_t ref_pt_a = mp.vec[0];
-		model_vertex_t ref_pt_b = mp.vec[1];
-		Eigen::Vector3f ref_vec3 = (ref_pt_b.position - ref_pt_a.position).head<3>();
+			model_vertex_t ref_pt_a = t.model_vertices[a];
+			model_vertex_t ref_pt_b = t.model_vertices[b];
+			Eigen::Vector3f ref_vec3 = (ref_pt_b.position - ref_pt_a.position).head<3>();
 
-		float normScale = dist_3d(ref_pt_a.position, ref_pt_b.position);
+			float normScale = dist_3d(ref_pt_a.position, ref_pt_b.position);
 
-		match_data_t md;
-		for (auto &&i : mp.vec) {
-			Eigen::Vector3f point_vec3 = (i.position - ref_pt_a.position).head<3>();
-			md.vertex_index = i.vertex_index;
-			md.distance = dist_3d(i.position, ref_pt_a.position) / normScale;
-			if (i.position.head<3>().dot(Eigen::Vector3f(0.0, 0.0, 1.0f)) < 0) {
-				md.distance *= -1;
-			}
+			for (int32_t v = 0; v < PSVR_NUM_LEDS; v++) {
+				model_vertex_t i = t.model_vertices[v];
+				match_descriptor_t md;
 
-			Eigen::Vector3f plane_norm = ref_vec3.cross(point_vec3).normalized();
-			if (ref_pt_a.position != i.position) {
+				Eigen::Vector3f point_vec3 = (i.position - ref_pt_a.position).head<3>();
+				md.distance = dist_3d(i.position, ref_pt_a.position) / normScale;
+				if (i.position.head<3>().dot(Eigen::Vector3f(0.0, 0.0, 1.0f)) < 0) {
+					md.distance *= -1;
+				}
 
-				if (plane_norm.normalized().z() > 0) {
-					md.angle = -1 * acos((point_vec3).normalized().dot(ref_vec3.normalized()));
+				Eigen::Vector3f plane_norm = ref_vec3.cross(point_vec3).normalized();
+				if (ref_pt_a.position != i.position) {
+					float angle = acos(point_vec3.normalized().dot(ref_vec3.normalized()));
+					md.angle = plane_norm.normalized().z() > 0 ? -angle : angle;
 				} else {
-					md.angle = acos(point_vec3.normalized().dot(ref_vec3.normalized()));
+					md.angle = 0.0f;
+				}
+				// fix up any NaNs
+				if (md.angle != md.angle) {
+					md.angle = 0.0f;
+				}
+				if (md.distance != md.distance) {
+					md.distance = 0.0f;
 				}
-			} else {
-				md.angle = 0.0f;
-			}
-			// fix up any NaNs
-			if (md.angle != md.angle) {
-				md.angle = 0.0f;
-			}
-			if (md.distance != md.distance) {
-				md.distance = 0.0f;
-			}
-
-			m.measurements.push_back(md);
-		}
 
-		if (match_possible(&m)) {
-			t.matches.push_back(m);
+				t.match_descriptors[a][b][v] = md;
+			}
 		}
 	}
 }
 
 static void
-do_view(TrackerPSVR &t, View &view, cv::Mat &grey, cv::Mat &rgb)
+do_view(View &view, cv::Mat &grey, cv::Mat &rgb)
 {
 	// Undistort and rectify the whole image.
 	cv::remap(grey,                         // src
@@ -1242,9 +1259,9 @@ do_view(TrackerPSVR &t, View &view, cv::Mat &grey, cv::Mat &rgb)
 	              32.0,                        // thresh
 	              255.0,                       // maxval
 	              0);
-	t.sbd->detect(view.frame_undist_rectified, // image
-	              view.keypoints,              // keypoints
-	              cv::noArray());              // mask
+	view.sbd->detect(view.frame_undist_rectified, // image
+	                 view.keypoints,              // keypoints
+	                 cv::noArray());              // mask
 
 	// Debug is wanted, draw the keypoints.
 	if (rgb.cols > 0) {
@@ -1256,6 +1273,21 @@ do_view(TrackerPSVR &t, View &view, cv::Mat &grey, cv::Mat &rgb)
 	}
 }
 
+//! Arguments for running @ref do_view on the worker pool.
+struct ViewTask
+{
+	View *view;
+	cv::Mat *grey;
+	cv::Mat *rgb;
+};
+
+static void
+do_view_task(void *ptr)
+{
+	auto &task = *(ViewTask *)ptr;
+	do_view(*task.view, *task.grey, *task.rgb);
+}
+
 typedef struct blob_data
 {
 	int tc_to_bc; // top center to bottom center
@@ -1544,8 +1576,11 @@ process(TrackerPSVR &t, struct xrt_frame *xf)
 	cv::Mat l_grey(rows, cols, CV_8UC1, xf->data, stride);
 	cv::Mat r_grey(rows, cols, CV_8UC1, xf->data + cols, stride);
 
-	do_view(t, t.view[0], l_grey, t.debug.rgb[0]);
-	do_view(t, t.view[1], r_grey, t.debug.rgb[1]);
+	// The views are independent, do the right one on the worker while we do the left one here.
+	ViewTask right = {&t.view[1], &r_grey, &t.debug.rgb[1]};
+	u_worker_group_push(t.group, do_view_task, &right);
+	do_view(t.view[0], l_grey, t.debug.rgb[0]);
+	u_worker_group_wait_all(t.group);
 
 	// if we wish to confirm our camera input contents, dump frames
 	// to disk
@@ -2006,6 +2041,9 @@ t_psvr_node_destroy(struct xrt_frame_node *node)
 
 	os_thread_helper_destroy(&t_ptr->oth);
 
+	u_worker_group_reference(&t_ptr->group, NULL);
+	u_worker_thread_pool_reference(&t_ptr->pool, NULL);
+
 	m_imu_3dof_close(&t_ptr->fusion.imu_3dof);
 
 	delete t_ptr;
@@ -2088,7 +2126,11 @@ t_psvr_create(struct xrt_frame_context *xfctx,
 	blob_params.minRepeatability = 1; // need this to avoid error?
 	// clang-format on
 
-	t.sbd = cv::SimpleBlobDetector::create(blob_params);
+	t.view[0].sbd = cv::SimpleBlobDetector::create(blob_params);
+	t.view[1].sbd = cv::SimpleBlobDetector::create(blob_params);
+
+	t.pool = u_worker_thread_pool_create(1, 1, "PSVR");
+	t.group = u_worker_group_create(t.pool);
 
 	t.target_optical_rotation_correction = Eigen::Quaternionf(1.0f, 0.0f, 0.0f, 0.0f);
 	t.optical_rotation_correction = Eigen::Quaternionf(1.0f, 0.0f, 0.0f, 0.0f);
@@ -2104,7 +2146,6 @@ t_psvr_create(struct xrt_frame_context *xfctx,
 
 	t.axis_align_rot = align2; // * align;
 
-	t.last_optical_model = 0;
 
 	// offset our models center of rotation
 	create_model(t);
@@ -2119,6 +2160,8 @@ t_psvr_create(struct xrt_frame_context *xfctx,
 
 	ret = os_thread_helper_init(&t.oth);
 	if (ret != 0) {
+		u_worker_group_reference(&t.group, NULL);
+		u_worker_thread_pool_reference(&t.pool, NULL);
 		delete (&t);
 		return ret;
 	}
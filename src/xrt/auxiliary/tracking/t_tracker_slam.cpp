@@ -1,4 +1,4 @@
-// Copyright 2021-2024, Collabora, Ltd.
+// Copyright 2021-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -17,6 +17,9 @@
 #include "util/u_sink.h"
 #include "util/u_var.h"
 #include "util/u_trace_marker.h"
+#include "util/u_live_stats.h"
+#include "util/u_pretty_print.h"
+#include "util/u_time.h"
 #include "os/os_threading.h"
 #include "math/m_api.h"
 #include "math/m_filter_fifo.h"
@@ -35,13 +38,15 @@
 #include <opencv2/core/mat.hpp>
 #include <opencv2/core/version.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <deque>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
-#include <map>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 //! @todo Get preferred system from systems found at build time
@@ -83,8 +88,18 @@ DEBUG_GET_ONCE_NUM_OPTION(slam_prediction_type, "SLAM_PREDICTION_TYPE", long(SLA
 DEBUG_GET_ONCE_BOOL_OPTION(slam_write_csvs, "SLAM_WRITE_CSVS", false)
 DEBUG_GET_ONCE_OPTION(slam_csv_path, "SLAM_CSV_PATH", "evaluation/")
 DEBUG_GET_ONCE_BOOL_OPTION(slam_timing_stat, "SLAM_TIMING_STAT", true)
+DEBUG_GET_ONCE_BOOL_OPTION(slam_live_stats, "SLAM_LIVE_STATS", false)
 DEBUG_GET_ONCE_BOOL_OPTION(slam_features_stat, "SLAM_FEATURES_STAT", true)
 DEBUG_GET_ONCE_NUM_OPTION(slam_cam_count, "SLAM_CAM_COUNT", 2)
+DEBUG_GET_ONCE_OPTION(slam_map_path, "SLAM_MAP_PATH", nullptr)
+DEBUG_GET_ONCE_BOOL_OPTION(slam_backpressure, "SLAM_BACKPRESSURE", true)
+DEBUG_GET_ONCE_NUM_OPTION(slam_backpressure_latency_ms, "SLAM_BACKPRESSURE_LATENCY_MS", 80)
+
+//! Highest decimation of camera frames under backpressure, one in this many frame sets are kept
+#define SLAM_BACKPRESSURE_MAX_DECIMATION 8
+
+//! Time to let the tracker queues settle after changing the decimation
+#define SLAM_BACKPRESSURE_SETTLE_NS (500 * U_TIME_1MS_IN_NS)
 
 //! Namespace for the interface to the external SLAM tracking system
 namespace xrt::auxiliary::tracking::slam {
@@ -96,7 +111,6 @@ using os::Mutex;
 using std::deque;
 using std::ifstream;
 using std::make_shared;
-using std::map;
 using std::ofstream;
 using std::ostream;
 using std::pair;
@@ -106,11 +120,46 @@ using std::to_string;
 using std::unique_lock;
 using std::vector;
 using std::filesystem::create_directories;
-using Trajectory = map<timepoint_ns, xrt_pose>;
 using timing_sample = vector<timepoint_ns>;
 
 using xrt::auxiliary::math::RelationHistory;
 
+/*!
+ * Poses sorted by timestamp, the timestamps are kept in their own array so
+ * that lookups binary search a dense array. Samples usually arrive in order
+ * and are then just appended.
+ */
+struct Trajectory
+{
+	vector<timepoint_ns> timestamps;
+	vector<xrt_pose> poses;
+
+	bool
+	empty() const
+	{
+		return timestamps.empty();
+	}
+
+	void
+	insert_or_assign(timepoint_ns ts, const xrt_pose &pose)
+	{
+		if (timestamps.empty() || ts > timestamps.back()) {
+			timestamps.push_back(ts);
+			poses.push_back(pose);
+			return;
+		}
+
+		auto it = std::lower_bound(timestamps.begin(), timestamps.end(), ts);
+		size_t i = it - timestamps.begin();
+		if (*it == ts) {
+			poses[i] = pose;
+		} else {
+			timestamps.insert(it, ts);
+			poses.insert(poses.begin() + i, pose);
+		}
+	}
+};
+
 
 /*
  *
@@ -157,6 +206,19 @@ operator<<(ostream &os, const feature_count_sample &s)
 	return os;
 }
 
+struct gt_error_sample
+{
+	timepoint_ns ts;
+	float error_mm;
+};
+
+ostream &
+operator<<(ostream &os, const gt_error_sample &s)
+{
+	os << s.ts << "," << s.error_mm << CSV_EOL;
+	return os;
+}
+
 //! Writes a CSV file for a particular row type
 template <typename RowType> class CSVWriter
 {
@@ -242,6 +304,15 @@ struct FeaturesWriter : public CSVWriter<feature_count_sample>
 	}
 };
 
+//! Writes the positional error of each estimated pose wrt ground truth
+struct GtErrorWriter : public CSVWriter<gt_error_sample>
+{
+	GtErrorWriter(const string &dir, const string &fn, bool e) : CSVWriter<gt_error_sample>(dir, fn, e)
+	{
+		column_names = {"timestamp [ns]", "error [mm]"};
+	}
+};
+
 /*!
  * Main implementation of @ref xrt_tracked_slam. This is an adapter class for
  * SLAM tracking that wraps an external SLAM implementation.
@@ -255,10 +326,13 @@ struct FeaturesWriter : public CSVWriter<feature_count_sample>
 struct TrackerSlam
 {
 	struct xrt_tracked_slam base = {};
-	struct xrt_frame_node node = {};       //!< Will be called on destruction
-	struct t_vit_bundle vit;               //!< VIT system function pointers
-	struct vit_tracker_extension_set exts; //!< VIT tracker supported extensions
-	struct vit_tracker *tracker;           //!< Pointer to the tracker created by the loaded VIT system;
+	struct xrt_frame_node node = {};            //!< Will be called on destruction
+	struct t_vit_bundle vit;                    //!< VIT system function pointers
+	struct vit_tracker_extension_set exts = {}; //!< VIT tracker supported extensions
+	struct vit_tracker *tracker;                //!< Pointer to the tracker created by the loaded VIT system;
+	bool zero_copy_images = false;              //!< Tracker keeps references to our frames instead of copying them
+	string map_path = {};                       //!< Map loaded on start and saved on stop, empty if not persisted
+	std::thread map_loader = {};                //!< Loads the map after start while tracking already runs
 
 	struct xrt_slam_sinks sinks = {};                            //!< Pointers to the sinks below
 	struct xrt_frame_sink cam_sinks[XRT_TRACKING_MAX_SLAM_CAMS]; //!< Sends camera frames to the SLAM system
@@ -295,6 +369,16 @@ struct TrackerSlam
 	struct m_ff_vec3_f32 *accel_ff; //!< Last accelerometer samples
 	vector<u_sink_debug> ui_sink;   //!< Sink to display frames in UI of each camera
 
+	//! IMU integration on top of the latest SLAM pose, kept by @ref predict_pose_from_imu. Protected by lock_ff.
+	struct
+	{
+		bool valid = false;                               //!< Whether the fields below hold anything
+		timepoint_ns base_ts = 0;                         //!< Timestamp of the SLAM pose integrated on top of
+		timepoint_ns ts = 0;                              //!< Time @ref rel has been integrated up to
+		timepoint_ns last_sample_ts = INT64_MIN;          //!< Last integrated IMU sample, INT64_MIN for none
+		xrt_space_relation rel = XRT_SPACE_RELATION_ZERO; //!< Base pose with samples up to @ref ts integrated
+	} imu_integ;
+
 	//! Used to correct accelerometer measurements when integrating into the prediction.
 	//! @todo Should be automatically computed instead of required to be filled manually through the UI.
 	xrt_vec3 gravity_correction{0, 0, -MATH_GRAVITY_M_S2};
@@ -334,6 +418,7 @@ struct TrackerSlam
 	// CSV writers for offline analysis (using pointers because of container_of)
 	TimingWriter *slam_times_writer;      //!< Timestamps of the pipeline for performance analysis
 	FeaturesWriter *slam_features_writer; //!< Feature tracking information for analysis
+	GtErrorWriter *gt_error_writer;       //!< Positional error of the estimated poses wrt ground truth
 	TrajectoryWriter *slam_traj_writer;   //!< Estimated poses from the SLAM system
 	TrajectoryWriter *pred_traj_writer;   //!< Predicted poses
 	TrajectoryWriter *filt_traj_writer;   //!< Predicted and filtered poses
@@ -352,8 +437,30 @@ struct TrackerSlam
 		vector<string> columns;             //!< Column names of the measured timestamps
 		string joined_columns;              //!< Column names as a null separated string
 		struct u_var_button enable_btn;     //!< Toggle tracker timing reports
+		bool live_stats = false;            //!< Whether to log the percentiles below
+		u_live_stats_ns latency{};          //!< Sampled to received by Monado
+		u_live_stats_ns duration{};         //!< Between the timestamps selected in the UI
 	} timing;
 
+	/*!
+	 * Drops whole sets of camera frames, IMU samples are still all pushed,
+	 * when the latency of the poses coming out of the tracker goes above
+	 * @ref latency_ms so that the queues inside the tracker don't grow
+	 * without bound. The latency is the same one shown by the timing UI.
+	 */
+	struct
+	{
+		bool enabled = false;                  //!< Whether to drop frames at all
+		int latency_ms = 80;                   //!< Target pose latency, sampled to received by Monado
+		std::atomic<timepoint_ns> latency{0};  //!< Latency of the last pose popped from the tracker
+		int decimation = 1;                    //!< Keep one out of this many frame sets
+		timepoint_ns last_change_ts = 0;       //!< When @ref decimation was last changed
+		uint64_t frame_set_count = 0;          //!< Frame sets received while submitting
+		uint64_t dropped_count = 0;            //!< Frame sets dropped
+		float drop_rate = 0;                   //!< Moving average of the fraction of dropped frame sets
+		std::atomic<bool> dropping{false};     //!< Whether the current frame set, started by cam0, is dropped
+	} backpressure;
+
 	//! Tracker feature tracking info
 	struct Features
 	{
@@ -406,6 +513,9 @@ static void
 timing_ui_setup(TrackerSlam &t)
 {
 	t.timing.enabled = false;
+	t.timing.live_stats = debug_get_bool_option_slam_live_stats();
+	snprintf(t.timing.latency.name, sizeof(t.timing.latency.name), "latency");
+	snprintf(t.timing.duration.name, sizeof(t.timing.duration.name), "selected");
 
 	u_var_add_ro_ftext(&t, "\n%s", "Tracker timing");
 
@@ -477,6 +587,34 @@ timing_ui_setup(TrackerSlam &t)
 	u_var_add_f32_timing(&t, &t.timing.ui, "External tracker times");
 }
 
+//! Accumulates the pose timing percentiles, prints them every @ref U_LIVE_STATS_VALUE_COUNT poses
+static void
+timing_live_stats_push(TrackerSlam &t, timepoint_ns latency, timepoint_ns duration)
+{
+	bool full = u_ls_ns_add(&t.timing.latency, latency);
+	if (duration >= 0) {
+		full |= u_ls_ns_add(&t.timing.duration, duration);
+	}
+
+	if (!full) {
+		return;
+	}
+
+	struct u_pp_sink_stack_only sink;
+	u_pp_delegate_t dg = u_pp_sink_stack_only_init(&sink);
+
+	u_pp(dg, "Tracker pose timing:\n");
+	u_ls_ns_print_header(dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_and_reset(&t.timing.latency, dg);
+	if (t.timing.duration.value_count > 0) {
+		u_pp(dg, "\n");
+		u_ls_ns_print_and_reset(&t.timing.duration, dg);
+	}
+
+	SLAM_INFO("%s", sink.buffer);
+}
+
 //! Updates timing UI with info from a computed pose and returns that info
 static vector<timepoint_ns>
 timing_ui_push(TrackerSlam &t, const vit_pose_t *pose, int64_t ts)
@@ -484,6 +622,11 @@ timing_ui_push(TrackerSlam &t, const vit_pose_t *pose, int64_t ts)
 	timepoint_ns now = os_monotonic_get_ns();
 	vector<timepoint_ns> tss = {ts, now};
 
+	// Without the timing extension there is only the sampled to received latency.
+	if (t.timing.live_stats && !t.timing.enabled) {
+		timing_live_stats_push(t, now - ts, -1);
+	}
+
 	// Add extra timestamps if the SLAM tracker provides them
 	if (t.timing.enabled) {
 		vit_pose_timing timing;
@@ -510,6 +653,10 @@ timing_ui_push(TrackerSlam &t, const vit_pose_t *pose, int64_t ts)
 		t.timing.dur_ms[t.timing.idx] = tss_ms;
 		constexpr float a = 1.0f / UI_TIMING_POSE_COUNT; // Exponential moving average
 		t.timing.ui.reference_timing = (1 - a) * t.timing.ui.reference_timing + a * tss_ms;
+
+		if (t.timing.live_stats) {
+			timing_live_stats_push(t, now - ts, end - start);
+		}
 	}
 
 	return tss;
@@ -629,20 +776,23 @@ get_gt_pose_at(const Trajectory &gt, timepoint_ns ts)
 		return XRT_POSE_IDENTITY;
 	}
 
-	Trajectory::const_iterator rit = gt.upper_bound(ts);
+	auto rit = std::upper_bound(gt.timestamps.begin(), gt.timestamps.end(), ts);
+	size_t r = rit - gt.timestamps.begin();
 
-	if (rit == gt.begin()) { // Too far in the past, return first gt pose
-		return gt.begin()->second;
+	if (r == 0) { // Too far in the past, return first gt pose
+		return gt.poses.front();
 	}
 
-	if (rit == gt.end()) { // Too far in the future, return last gt pose
-		return std::prev(gt.end())->second;
+	if (r == gt.timestamps.size()) { // Too far in the future, return last gt pose
+		return gt.poses.back();
 	}
 
-	Trajectory::const_iterator lit = std::prev(rit);
+	size_t l = r - 1;
 
-	const auto &[lts, lpose] = *lit;
-	const auto &[rts, rpose] = *rit;
+	timepoint_ns lts = gt.timestamps[l];
+	timepoint_ns rts = gt.timestamps[r];
+	const xrt_pose &lpose = gt.poses[l];
+	const xrt_pose &rpose = gt.poses[r];
 
 	float t = double(ts - lts) / double(rts - lts);
 	SLAM_DASSERT_(0 <= t && t <= 1);
@@ -722,6 +872,8 @@ gt_ui_push(TrackerSlam &t, timepoint_ns ts, xrt_pose tracked_pose)
 	t.gt.diffs_mm[t.gt.diff_idx] = len_mm;
 	constexpr float a = 1.0f / UI_GTDIFF_POSE_COUNT; // Exponential moving average
 	t.gt.diff_ui.reference_timing = (1 - a) * t.gt.diff_ui.reference_timing + a * len_mm;
+
+	t.gt_error_writer->push({ts, len_mm});
 }
 
 /*
@@ -791,6 +943,8 @@ flush_poses(TrackerSlam &t)
 		xrt_pose_sample pose_sample = {nts, rel.pose};
 		xrt_sink_push_pose(t.euroc_recorder->gt, &pose_sample);
 
+		t.backpressure.latency = os_monotonic_get_ns() - nts;
+
 		auto tss = timing_ui_push(t, pose, nts);
 		t.slam_times_writer->push(tss);
 
@@ -805,7 +959,47 @@ flush_poses(TrackerSlam &t)
 	return true;
 }
 
-//! Integrates IMU samples on top of a base pose and predicts from that
+//! Integrate one IMU sample, taken at @p ts, on top of @p rel which is at @p rel_ts
+static void
+integrate_imu_sample(TrackerSlam &t,
+                     xrt_vec3 g,
+                     xrt_vec3 a,
+                     timepoint_ns ts,
+                     xrt_space_relation &rel,
+                     timepoint_ns &rel_ts)
+{
+	xrt_quat &o = rel.pose.orientation;
+	xrt_vec3 &p = rel.pose.position;
+	xrt_vec3 &w = rel.angular_velocity;
+	xrt_vec3 &v = rel.linear_velocity;
+
+	// Update time
+	float dt = (float)time_ns_to_s(ts - rel_ts);
+	rel_ts = ts;
+
+	// Integrate gyroscope
+	xrt_quat angvel_delta{};
+	xrt_vec3 scaled_half_g = g * dt * 0.5f;
+	math_quat_exp(&scaled_half_g, &angvel_delta); // Same as using math_quat_from_angle_vector(g/dt)
+	math_quat_rotate(&o, &angvel_delta, &o);      // Orientation
+	math_quat_rotate_derivative(&o, &g, &w);      // Angular velocity
+
+	// Integrate accelerometer
+	xrt_vec3 world_accel{};
+	math_quat_rotate_vec3(&o, &a, &world_accel);
+	world_accel += t.gravity_correction;
+	v += world_accel * dt;                        // Linear velocity
+	p += v * dt + world_accel * (dt * dt * 0.5f); // Position
+}
+
+/*!
+ * Integrates IMU samples on top of a base pose and predicts from that
+ *
+ * The integration is kept in @ref TrackerSlam::imu_integ between calls, so each
+ * call only integrates the IMU samples that arrived since the previous one. It
+ * starts over from @p base_rel when a new SLAM pose arrives or when asked for a
+ * time older than what has already been integrated.
+ */
 static void
 predict_pose_from_imu(TrackerSlam &t,
                       timepoint_ns when_ns,
@@ -815,29 +1009,35 @@ predict_pose_from_imu(TrackerSlam &t,
 {
 	os_mutex_lock(&t.lock_ff);
 
-	// Find oldest imu index i that is newer than latest SLAM pose (or -1)
+	auto &integ = t.imu_integ;
+	bool reuse = integ.valid && integ.base_ts == base_rel_ts && integ.ts <= when_ns;
+
+	if (!reuse) {
+		integ.valid = true;
+		integ.base_ts = base_rel_ts;
+		integ.rel = base_rel;
+		integ.ts = base_rel_ts;
+		integ.last_sample_ts = INT64_MIN;
+	}
+
+	// Find oldest imu index i that is newer than latest SLAM pose and not yet integrated (or -1)
 	int i = 0;
 	uint64_t imu_ts = UINT64_MAX;
 	xrt_vec3 _;
 	while (m_ff_vec3_f32_get(t.gyro_ff, i, &_, &imu_ts)) {
-		if ((int64_t)imu_ts < base_rel_ts) {
-			i--; // Back to the oldest newer-than-SLAM IMU index (or -1)
+		if ((int64_t)imu_ts < base_rel_ts || (int64_t)imu_ts <= integ.last_sample_ts) {
 			break;
 		}
 		i++;
 	}
+	i--; // Back to the oldest newer-than-SLAM IMU index (or -1)
 
-	if (i == -1) {
+	if (i == -1 && integ.last_sample_ts == INT64_MIN) {
 		SLAM_WARN("No IMU samples received after latest SLAM pose (and frame)");
 	}
 
-	xrt_space_relation integ_rel = base_rel;
-	timepoint_ns integ_rel_ts = base_rel_ts;
-	xrt_quat &o = integ_rel.pose.orientation;
-	xrt_vec3 &p = integ_rel.pose.position;
-	xrt_vec3 &w = integ_rel.angular_velocity;
-	xrt_vec3 &v = integ_rel.linear_velocity;
-	bool clamped = false; // If when_ns is older than the latest IMU ts
+	xrt_space_relation integ_rel = integ.rel;
+	timepoint_ns integ_rel_ts = integ.ts;
 
 	while (i >= 0) { // Decreasing i increases timestamp
 		// Get samples
@@ -850,39 +1050,23 @@ predict_pose_from_imu(TrackerSlam &t,
 		got &= m_ff_vec3_f32_get(t.accel_ff, i, &a, &a_ts);
 		timepoint_ns ts = g_ts;
 
-
 		// Checks
+		SLAM_DASSERT(got && g_ts == a_ts, "Failure getting synced gyro and accel samples");
+		SLAM_DASSERT(ts >= base_rel_ts, "Accessing imu sample that is older than latest SLAM pose");
+
 		if (ts > when_ns) {
-			clamped = true;
+			// Only the part up to when_ns, and not kept for the next call.
 			//! @todo Instead of using same a and g values, do an interpolated sample like this:
 			// a = prev_a + ((when_ns - prev_ts) / (ts - prev_ts)) * (a - prev_a);
 			// g = prev_g + ((when_ns - prev_ts) / (ts - prev_ts)) * (g - prev_g);
-			ts = when_ns; // clamp ts to when_ns
-		}
-		SLAM_DASSERT(got && g_ts == a_ts, "Failure getting synced gyro and accel samples");
-		SLAM_DASSERT(ts >= base_rel_ts, "Accessing imu sample that is older than latest SLAM pose");
-
-		// Update time
-		float dt = (float)time_ns_to_s(ts - integ_rel_ts);
-		integ_rel_ts = ts;
-
-		// Integrate gyroscope
-		xrt_quat angvel_delta{};
-		xrt_vec3 scaled_half_g = g * dt * 0.5f;
-		math_quat_exp(&scaled_half_g, &angvel_delta); // Same as using math_quat_from_angle_vector(g/dt)
-		math_quat_rotate(&o, &angvel_delta, &o);      // Orientation
-		math_quat_rotate_derivative(&o, &g, &w);      // Angular velocity
-
-		// Integrate accelerometer
-		xrt_vec3 world_accel{};
-		math_quat_rotate_vec3(&o, &a, &world_accel);
-		world_accel += t.gravity_correction;
-		v += world_accel * dt;                        // Linear velocity
-		p += v * dt + world_accel * (dt * dt * 0.5f); // Position
-
-		if (clamped) {
+			integrate_imu_sample(t, g, a, when_ns, integ_rel, integ_rel_ts);
 			break;
 		}
+
+		integrate_imu_sample(t, g, a, ts, integ_rel, integ_rel_ts);
+		integ.rel = integ_rel;
+		integ.ts = integ_rel_ts;
+		integ.last_sample_ts = ts;
 		i--;
 	}
 
@@ -1055,6 +1239,13 @@ setup_ui(TrackerSlam &t)
 	u_var_add_bool(&t, &t.gt.override_tracking, "Track with ground truth (if available)");
 	euroc_recorder_add_ui(t.euroc_recorder, &t, "");
 
+	u_var_add_gui_header(&t, NULL, "Backpressure");
+	u_var_add_bool(&t, &t.backpressure.enabled, "Drop frames when behind");
+	u_var_add_i32(&t, &t.backpressure.latency_ms, "Target pose latency (ms)");
+	u_var_add_ro_i32(&t, &t.backpressure.decimation, "Keep one in");
+	u_var_add_ro_f32(&t, &t.backpressure.drop_rate, "Drop rate");
+	u_var_add_ro_u64(&t, &t.backpressure.dropped_count, "Dropped frame sets");
+
 	u_var_add_gui_header(&t, NULL, "Trajectory Filter");
 	u_var_add_bool(&t, &t.filter.use_moving_average_filter, "Enable moving average filter");
 	u_var_add_f64(&t, &t.filter.window, "Window size (ms)");
@@ -1087,6 +1278,7 @@ setup_ui(TrackerSlam &t)
 	u_var_add_bool(&t, &t.filt_traj_writer->enabled, "Record filtered trajectory");
 	u_var_add_bool(&t, &t.slam_times_writer->enabled, "Record tracker times");
 	u_var_add_bool(&t, &t.slam_features_writer->enabled, "Record feature count");
+	u_var_add_bool(&t, &t.gt_error_writer->enabled, "Record ground truth error");
 	timing_ui_setup(t);
 	features_ui_setup(t);
 	// Later, gt_ui_setup will setup the tracking error UI if ground truth becomes available
@@ -1279,14 +1471,10 @@ t_slam_hand_mask_sink_push(struct xrt_hand_masks_sink *sink, struct xrt_hand_mas
 	t.last_hand_masks = *hand_masks;
 }
 
-//! Receive and send IMU samples to the external SLAM system
-extern "C" void
-t_slam_receive_imu(struct xrt_imu_sink *sink, struct xrt_imu_sample *s)
+//! Check and submit a sample to the SLAM system, returns false if it was dropped.
+static bool
+submit_imu_sample(TrackerSlam &t, const struct xrt_imu_sample *s)
 {
-	XRT_TRACE_MARKER();
-
-	auto &t = *container_of(sink, TrackerSlam, imu_sink);
-
 	timepoint_ns ts = s->timestamp_ns;
 	xrt_vec3_f64 a = s->accel_m_s2;
 	xrt_vec3_f64 w = s->gyro_rad_secs;
@@ -1297,7 +1485,7 @@ t_slam_receive_imu(struct xrt_imu_sink *sink, struct xrt_imu_sample *s)
 	if (ts <= t.last_imu_ts) {
 		SLAM_WARN("Sample (%" PRId64 ") is older than last (%" PRId64 ") by %" PRId64 " ns", ts, t.last_imu_ts,
 		          t.last_imu_ts - ts);
-		return;
+		return false;
 	}
 	t.last_imu_ts = ts;
 
@@ -1316,17 +1504,115 @@ t_slam_receive_imu(struct xrt_imu_sink *sink, struct xrt_imu_sample *s)
 		t.vit.tracker_push_imu_sample(t.tracker, &sample);
 	}
 
-	xrt_sink_push_imu(t.euroc_recorder->imu, s);
+	return true;
+}
 
-	struct xrt_vec3 gyro = {(float)w.x, (float)w.y, (float)w.z};
-	struct xrt_vec3 accel = {(float)a.x, (float)a.y, (float)a.z};
+//! Push the samples to the UI filter fifos, @ref TrackerSlam::lock_ff is taken once for all of them.
+static void
+push_imu_to_ff(TrackerSlam &t, const struct xrt_imu_sample *samples, uint32_t count)
+{
 	os_mutex_lock(&t.lock_ff);
-	m_ff_vec3_f32_push(t.gyro_ff, &gyro, ts);
-	m_ff_vec3_f32_push(t.accel_ff, &accel, ts);
+	for (uint32_t i = 0; i < count; i++) {
+		const xrt_vec3_f64 &a = samples[i].accel_m_s2;
+		const xrt_vec3_f64 &w = samples[i].gyro_rad_secs;
+		struct xrt_vec3 gyro = {(float)w.x, (float)w.y, (float)w.z};
+		struct xrt_vec3 accel = {(float)a.x, (float)a.y, (float)a.z};
+		m_ff_vec3_f32_push(t.gyro_ff, &gyro, samples[i].timestamp_ns);
+		m_ff_vec3_f32_push(t.accel_ff, &accel, samples[i].timestamp_ns);
+	}
 	os_mutex_unlock(&t.lock_ff);
 }
 
+//! Receive and send IMU samples to the external SLAM system
+extern "C" void
+t_slam_receive_imu(struct xrt_imu_sink *sink, struct xrt_imu_sample *s)
+{
+	XRT_TRACE_MARKER();
+
+	auto &t = *container_of(sink, TrackerSlam, imu_sink);
+
+	if (!submit_imu_sample(t, s)) {
+		return;
+	}
+
+	xrt_sink_push_imu(t.euroc_recorder->imu, s);
+	push_imu_to_ff(t, s, 1);
+}
+
+//! Batched version of @ref t_slam_receive_imu
+extern "C" void
+t_slam_receive_imu_batch(struct xrt_imu_sink *sink, struct xrt_imu_sample *samples, uint32_t count)
+{
+	XRT_TRACE_MARKER();
+
+	auto &t = *container_of(sink, TrackerSlam, imu_sink);
+
+	// Compact the accepted samples in place so they can be forwarded as one batch.
+	uint32_t kept = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		if (!submit_imu_sample(t, &samples[i])) {
+			continue;
+		}
+		if (kept != i) {
+			samples[kept] = samples[i];
+		}
+		kept++;
+	}
+
+	if (kept == 0) {
+		return;
+	}
+
+	xrt_sink_push_imu_batch(t.euroc_recorder->imu, samples, kept);
+	push_imu_to_ff(t, samples, kept);
+}
+
 //! Push the frame to the external SLAM system
+/*!
+ * Decides if the frame set started by a cam0 frame should be dropped, the
+ * decimation is stepped up while the pose latency is above the target and
+ * back down once it is well below it.
+ */
+static bool
+backpressure_should_drop(TrackerSlam &t)
+{
+	auto &bp = t.backpressure;
+
+	if (!bp.enabled) {
+		bp.decimation = 1;
+		return false;
+	}
+
+	timepoint_ns now = os_monotonic_get_ns();
+	timepoint_ns target = timepoint_ns(bp.latency_ms) * U_TIME_1MS_IN_NS;
+	timepoint_ns latency = bp.latency;
+
+	if (now - bp.last_change_ts >= SLAM_BACKPRESSURE_SETTLE_NS) {
+		int old_decimation = bp.decimation;
+		if (latency > target && bp.decimation < SLAM_BACKPRESSURE_MAX_DECIMATION) {
+			bp.decimation++;
+		} else if (latency < target / 2 && bp.decimation > 1) {
+			bp.decimation--;
+		}
+
+		if (bp.decimation != old_decimation) {
+			bp.last_change_ts = now;
+			SLAM_DEBUG("Pose latency %.1fms, keeping one in %d frame sets", time_ns_to_ms_f(latency),
+			           bp.decimation);
+		}
+	}
+
+	bool drop = bp.frame_set_count++ % bp.decimation != 0;
+	if (drop) {
+		bp.dropped_count++;
+	}
+
+	constexpr float a = 1.0f / 32; // Exponential moving average
+	bp.drop_rate = (1 - a) * bp.drop_rate + a * (drop ? 1.0f : 0.0f);
+
+	return drop;
+}
+
 static void
 receive_frame(TrackerSlam &t, struct xrt_frame *frame, uint32_t cam_index)
 {
@@ -1355,12 +1641,20 @@ receive_frame(TrackerSlam &t, struct xrt_frame *frame, uint32_t cam_index)
 	}
 	last_ts = ts;
 
+	// Frames of all cameras are kept or dropped together, decided on cam0.
+	if (cam_index == 0) {
+		t.backpressure.dropping = backpressure_should_drop(t);
+	}
+	if (t.backpressure.dropping) {
+		SLAM_TRACE("Dropping cam%d frame t=%" PRId64 " because of backpressure", cam_index, ts);
+		return;
+	}
+
 	// Construct and send the image sample
 	vit_img_sample sample = {};
 	sample.cam_index = cam_index;
 	sample.timestamp = ts;
 
-	sample.data = frame->data;
 	sample.width = frame->width;
 	sample.height = frame->height;
 	sample.stride = frame->stride;
@@ -1398,9 +1692,19 @@ receive_frame(TrackerSlam &t, struct xrt_frame *frame, uint32_t cam_index)
 		sample.masks = masks.empty() ? nullptr : masks.data();
 	}
 
+	// Hand out the frame itself if the tracker will let us know when it is done with it.
+	if (t.zero_copy_images) {
+		t_vit_img_sample_hold_frame(&sample, frame);
+	} else {
+		sample.data = frame->data;
+	}
+
 	{
 		XRT_TRACE_IDENT(slam_push);
-		t.vit.tracker_push_img_sample(t.tracker, &sample);
+		vit_result_t vres = t.vit.tracker_push_img_sample(t.tracker, &sample);
+		if (vres != VIT_SUCCESS) {
+			t_vit_img_sample_release(&sample);
+		}
 	}
 }
 
@@ -1429,6 +1733,43 @@ void (*t_slam_receive_cam[XRT_TRACKING_MAX_SLAM_CAMS])(xrt_frame_sink *, xrt_fra
 };
 
 
+//! Runs on @ref TrackerSlam::map_loader, the tracker relocalizes against the map once loaded.
+static void
+load_map(TrackerSlam &t)
+{
+	U_TRACE_SET_THREAD_NAME("SLAM: Map loader");
+
+	int64_t start_ns = os_monotonic_get_ns();
+	vit_result_t vres = t.vit.tracker_load_map(t.tracker, t.map_path.c_str());
+	if (vres != VIT_SUCCESS) {
+		SLAM_WARN("Failed to load SLAM map from '%s' (%d), building a new one", t.map_path.c_str(), vres);
+		return;
+	}
+
+	SLAM_INFO("Loaded SLAM map from '%s' in %.1fms", t.map_path.c_str(),
+	          time_ns_to_ms_f(os_monotonic_get_ns() - start_ns));
+}
+
+//! Save the map for the next start, only if the tracker got to track anything so a good map isn't overwritten.
+static void
+save_map(TrackerSlam &t)
+{
+	xrt_space_relation rel{};
+	int64_t rel_ts = 0;
+	if (!t.slam_rels.get_latest(&rel_ts, &rel)) {
+		SLAM_INFO("Tracker produced no poses, not saving SLAM map");
+		return;
+	}
+
+	vit_result_t vres = t.vit.tracker_save_map(t.tracker, t.map_path.c_str());
+	if (vres != VIT_SUCCESS) {
+		SLAM_WARN("Failed to save SLAM map to '%s' (%d)", t.map_path.c_str(), vres);
+		return;
+	}
+
+	SLAM_INFO("Saved SLAM map to '%s'", t.map_path.c_str());
+}
+
 extern "C" void
 t_slam_node_break_apart(struct xrt_frame_node *node)
 {
@@ -1437,12 +1778,21 @@ t_slam_node_break_apart(struct xrt_frame_node *node)
 		t_openvr_tracker_stop(t.ovr_tracker);
 	}
 
+	// The tracker must not be stopped while loading.
+	if (t.map_loader.joinable()) {
+		t.map_loader.join();
+	}
+
 	vit_result_t vres = t.vit.tracker_stop(t.tracker);
 	if (vres != VIT_SUCCESS) {
 		SLAM_ERROR("Failed to stop VIT tracker");
 		return;
 	}
 
+	if (!t.map_path.empty()) {
+		save_map(t);
+	}
+
 	SLAM_DEBUG("SLAM tracker dismantled");
 }
 
@@ -1458,6 +1808,7 @@ t_slam_node_destroy(struct xrt_frame_node *node)
 	delete t.gt.trajectory;
 	delete t.slam_times_writer;
 	delete t.slam_features_writer;
+	delete t.gt_error_writer;
 	delete t.slam_traj_writer;
 	delete t.pred_traj_writer;
 	delete t.filt_traj_writer;
@@ -1487,6 +1838,11 @@ t_slam_start(struct xrt_tracked_slam *xts)
 		return -1;
 	}
 
+	// Track from scratch right away and relocalize once the map is in, IMU prediction covers the gap.
+	if (!t.map_path.empty() && std::filesystem::exists(t.map_path) && !t.map_loader.joinable()) {
+		t.map_loader = std::thread(load_map, std::ref(t));
+	}
+
 	SLAM_DEBUG("SLAM tracker started");
 	return 0;
 }
@@ -1506,6 +1862,9 @@ t_slam_fill_default_config(struct t_slam_tracker_config *config)
 	config->timing_stat = debug_get_bool_option_slam_timing_stat();
 	config->features_stat = debug_get_bool_option_slam_features_stat();
 	config->cam_count = int(debug_get_num_option_slam_cam_count());
+	config->map_path = debug_get_option_slam_map_path();
+	config->backpressure = debug_get_bool_option_slam_backpressure();
+	config->backpressure_latency_ms = int(debug_get_num_option_slam_backpressure_latency_ms());
 	config->slam_calib = NULL;
 }
 
@@ -1560,6 +1919,29 @@ t_slam_create(struct xrt_frame_context *xfctx,
 		return -1;
 	}
 
+	// Trackers older than 2.1 don't know about this extension and leave the field as we initialized it.
+	if (t.exts.has_img_sample_release && t.vit.version.minor >= 1) {
+		vres = t.vit.tracker_enable_extension(t.tracker, VIT_TRACKER_EXTENSION_IMG_SAMPLE_RELEASE, true);
+		if (vres != VIT_SUCCESS) {
+			SLAM_WARN("Failed to enable VIT image sample release extension (%d), copying images", vres);
+		} else {
+			t.zero_copy_images = true;
+		}
+	}
+
+	// Also needs the 2.2 entry points.
+	bool has_map_functions = t.vit.tracker_save_map != nullptr && t.vit.tracker_load_map != nullptr;
+	if (config->map_path != nullptr && t.exts.has_map_persistence && has_map_functions) {
+		vres = t.vit.tracker_enable_extension(t.tracker, VIT_TRACKER_EXTENSION_MAP_PERSISTENCE, true);
+		if (vres != VIT_SUCCESS) {
+			SLAM_WARN("Failed to enable VIT map persistence extension (%d), not persisting the map", vres);
+		} else {
+			t.map_path = config->map_path;
+		}
+	} else if (config->map_path != nullptr) {
+		SLAM_WARN("A SLAM map path is set but the VIT tracker can't save and load maps");
+	}
+
 	t.base.get_tracked_pose = t_slam_get_tracked_pose;
 
 	if (!config_file) {
@@ -1577,6 +1959,7 @@ t_slam_create(struct xrt_frame_context *xfctx,
 	}
 
 	t.imu_sink.push_imu = t_slam_receive_imu;
+	t.imu_sink.push_imu_batch = t_slam_receive_imu_batch;
 	t.sinks.imu = &t.imu_sink;
 
 	t.gt_sink.push_pose = t_slam_gt_sink_push;
@@ -1601,6 +1984,9 @@ t_slam_create(struct xrt_frame_context *xfctx,
 
 	t.pred_type = config->prediction;
 
+	t.backpressure.enabled = config->backpressure;
+	t.backpressure.latency_ms = config->backpressure_latency_ms;
+
 	m_filter_euro_vec3_init(&t.filter.pos_oe, t.filter.min_cutoff, t.filter.min_dcutoff, t.filter.beta);
 	m_filter_euro_quat_init(&t.filter.rot_oe, t.filter.min_cutoff, t.filter.min_dcutoff, t.filter.beta);
 
@@ -1611,6 +1997,7 @@ t_slam_create(struct xrt_frame_context *xfctx,
 	string dir = config->csv_path;
 	t.slam_times_writer = new TimingWriter(dir, "timing.csv", write_csvs, t.timing.columns);
 	t.slam_features_writer = new FeaturesWriter(dir, "features.csv", write_csvs, t.cam_count);
+	t.gt_error_writer = new GtErrorWriter(dir, "gt_error.csv", write_csvs);
 	t.slam_traj_writer = new TrajectoryWriter(dir, "tracking.csv", write_csvs);
 	t.pred_traj_writer = new TrajectoryWriter(dir, "prediction.csv", write_csvs);
 	t.filt_traj_writer = new TrajectoryWriter(dir, "filtering.csv", write_csvs);
@@ -1,4 +1,4 @@
-// Copyright 2019-2023, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -532,6 +532,16 @@ struct t_hsv_filter_optimized_table
 	uint8_t v[T_HSV_SIZE][T_HSV_SIZE][T_HSV_SIZE];
 };
 
+/*!
+ * Same sampling as @ref t_hsv_filter_optimized_table but with two 4-bit
+ * entries per byte, the even v index in the low nibble, which halves the
+ * size of the table to 16KiB.
+ */
+struct t_hsv_filter_packed_table
+{
+	uint8_t v[T_HSV_SIZE][T_HSV_SIZE][T_HSV_SIZE / 2];
+};
+
 void
 t_hsv_build_convert_table(struct t_hsv_filter_params *params, struct t_convert_table *t);
 
@@ -541,12 +551,23 @@ t_hsv_build_large_table(struct t_hsv_filter_params *params, struct t_hsv_filter_
 void
 t_hsv_build_optimized_table(struct t_hsv_filter_params *params, struct t_hsv_filter_optimized_table *t);
 
+void
+t_hsv_build_packed_table(struct t_hsv_filter_params *params, struct t_hsv_filter_packed_table *t);
+
 static inline uint8_t
 t_hsv_filter_sample(struct t_hsv_filter_optimized_table *t, uint32_t y, uint32_t u, uint32_t v)
 {
 	return t->v[y / T_HSV_STEP][u / T_HSV_STEP][v / T_HSV_STEP];
 }
 
+static inline uint8_t
+t_hsv_filter_packed_sample(struct t_hsv_filter_packed_table *t, uint32_t y, uint32_t u, uint32_t v)
+{
+	uint32_t i = v / T_HSV_STEP;
+	uint8_t bits = t->v[y / T_HSV_STEP][u / T_HSV_STEP][i / 2];
+	return (bits >> ((i & 1) * 4)) & 0xf;
+}
+
 /*!
  * Construct an HSV filter sink.
  * @public @memberof t_hsv_filter
@@ -671,6 +692,9 @@ struct t_slam_tracker_config
 	const char *csv_path;                   //!< Path to write CSVs to
 	bool timing_stat;                       //!< Enable timing metric in external system
 	bool features_stat;                     //!< Enable feature metric in external system
+	const char *map_path;                   //!< If set, the map is loaded from here on start and saved on stop
+	bool backpressure;                      //!< Drop camera frames when the tracker can't keep up
+	int backpressure_latency_ms;            //!< Pose latency above which camera frames start being dropped
 
 	//!< Instead of a slam_config file you can set custom calibration data
 	const struct t_slam_calibration *slam_calib;
@@ -729,6 +753,8 @@ struct t_calibration_status
 	int cooldown;
 	//! Number of non-moving frames before capture.
 	int waits_remaining;
+	//! Number of camera frames dropped while processing earlier frames.
+	int num_dropped;
 	//! Stereo calibration data that was produced.
 	struct t_stereo_camera_calibration *stereo_data;
 };
@@ -1,4 +1,4 @@
-// Copyright 2023-2024, Collabora, Ltd.
+// Copyright 2023-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -9,6 +9,7 @@
  */
 
 #include "xrt/xrt_config_os.h"
+#include "xrt/xrt_frame.h"
 #include "tracking/t_vit_loader.h"
 #include "util/u_logging.h"
 #include "vit/vit_interface.h"
@@ -37,6 +38,13 @@ vit_get_proc(void *handle, const char *name, void *proc_ptr)
 #endif
 }
 
+static void
+release_frame(void *userdata)
+{
+	struct xrt_frame *frame = (struct xrt_frame *)userdata;
+	xrt_frame_reference(&frame, NULL);
+}
+
 bool
 t_vit_bundle_load(struct t_vit_bundle *vit, const char *path)
 {
@@ -90,6 +98,14 @@ t_vit_bundle_load(struct t_vit_bundle *vit, const char *path)
 	GET_PROC(pose_get_data);
 	GET_PROC(pose_get_timing);
 	GET_PROC(pose_get_features);
+
+	// Added in 2.2.
+	vit->tracker_save_map = NULL;
+	vit->tracker_load_map = NULL;
+	if (vit->version.minor >= 2) {
+		GET_PROC(tracker_save_map);
+		GET_PROC(tracker_load_map);
+	}
 #undef GET_PROC
 
 	return true;
@@ -104,3 +120,26 @@ t_vit_bundle_unload(struct t_vit_bundle *vit)
 #error "Unknown platform"
 #endif
 }
+
+void
+t_vit_img_sample_hold_frame(struct vit_img_sample *sample, struct xrt_frame *frame)
+{
+	struct xrt_frame *held = NULL;
+	xrt_frame_reference(&held, frame);
+
+	sample->data = frame->data;
+	sample->release = release_frame;
+	sample->release_userdata = held;
+}
+
+void
+t_vit_img_sample_release(struct vit_img_sample *sample)
+{
+	if (sample->release == NULL) {
+		return;
+	}
+
+	sample->release(sample->release_userdata);
+	sample->release = NULL;
+	sample->release_userdata = NULL;
+}
@@ -16,6 +16,8 @@
 extern "C" {
 #endif
 
+struct xrt_frame;
+
 /*!
  * A bundle of VIT interface functions, used by the tracking interface loader.
  *
@@ -49,6 +51,10 @@ struct t_vit_bundle
 	PFN_vit_tracker_add_camera_calibration tracker_add_camera_calibration;
 	PFN_vit_tracker_pop_pose tracker_pop_pose;
 	PFN_vit_tracker_get_timing_titles tracker_get_timing_titles;
+	//! NULL for trackers older than 2.2.
+	PFN_vit_tracker_save_map tracker_save_map;
+	//! NULL for trackers older than 2.2.
+	PFN_vit_tracker_load_map tracker_load_map;
 	PFN_vit_pose_destroy pose_destroy;
 	PFN_vit_pose_get_data pose_get_data;
 	PFN_vit_pose_get_timing pose_get_timing;
@@ -71,6 +77,28 @@ t_vit_bundle_load(struct t_vit_bundle *vit, const char *path);
 void
 t_vit_bundle_unload(struct t_vit_bundle *vit);
 
+/*!
+ * Point @p sample at the pixels of @p frame without copying them, and take a
+ * reference on @p frame that the tracker drops through the sample's
+ * @ref vit_img_sample::release callback once it is done with the image.
+ *
+ * Only for trackers with @ref VIT_TRACKER_EXTENSION_IMG_SAMPLE_RELEASE enabled,
+ * if pushing the sample fails call @ref t_vit_img_sample_release instead.
+ *
+ * @ingroup aux_tracking
+ */
+void
+t_vit_img_sample_hold_frame(struct vit_img_sample *sample, struct xrt_frame *frame);
+
+/*!
+ * Drop whatever @ref t_vit_img_sample_hold_frame took on @p sample, for when
+ * the tracker never got it.
+ *
+ * @ingroup aux_tracking
+ */
+void
+t_vit_img_sample_release(struct vit_img_sample *sample);
+
 
 #ifdef __cplusplus
 }
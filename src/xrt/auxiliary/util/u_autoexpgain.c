@@ -21,6 +21,8 @@
 #include <stdio.h>
 
 DEBUG_GET_ONCE_LOG_OPTION(aeg_log, "AEG_LOG", U_LOGGING_WARN)
+DEBUG_GET_ONCE_NUM_OPTION(aeg_grid_cols, "AEG_GRID_COLS", 32)
+DEBUG_GET_ONCE_NUM_OPTION(aeg_update_interval, "AEG_UPDATE_INTERVAL", 1)
 
 #define AEG_TRACE(...) U_LOG_IFL_T(aeg->log_level, __VA_ARGS__)
 #define AEG_DEBUG(...) U_LOG_IFL_D(aeg->log_level, __VA_ARGS__)
@@ -42,7 +44,10 @@ DEBUG_GET_ONCE_LOG_OPTION(aeg_log, "AEG_LOG", U_LOGGING_WARN)
 #define INITIAL_BRIGHTNESS 0.5
 #define INITIAL_MAX_BRIGHTNESS_STEP 0.1
 #define INITIAL_THRESHOLD 0.1
-#define GRID_COLS 32 //!< Amount of columns for the histogram sample grid
+#define MAX_GRID_COLS 1024     //!< Upper bound for the columns of the histogram sample grid
+#define MAX_ROI_BORDER 0.45f   //!< Keep at least a tenth of the image in the region of interest
+#define HISTOGRAM_LANES 4      //!< Independent sub-histograms, see @ref compute_histogram
+#define MAX_UPDATE_INTERVAL 30 //!< At most skip this many frames between updates
 
 //! AEG State machine states
 enum u_aeg_state
@@ -88,6 +93,18 @@ struct u_autoexpgain
 	float histogram[LEVELS];                 //!< Pixel intensity histogram
 	struct u_var_histogram_f32 histogram_ui; //!< UI for `histogram`
 
+	//! The histogram is built from a grid of this many columns, with square cells.
+	int grid_cols;
+
+	//! Fraction of the width and height ignored on each side of the image when
+	//! sampling, lets the corners of fisheye cameras be skipped.
+	float roi_border;
+
+	//! Only run the algorithm every this many frames, the other frames are
+	//! ignored, `frame_delay` is still counted in frames.
+	int update_interval;
+	int frames_until_update; //!< Counts down to the next update
+
 	//! This is a made up scalar that lives in the [0, 1] range. 0 maps to minimum
 	//! exp/gain values while 1 to their maximums. An autoexposure strategy limits
 	//! itself to modify this value. The mapping between the scalar and the
@@ -191,8 +208,8 @@ set_state(struct u_autoexpgain *aeg, enum u_aeg_action action)
 			aeg->overshoots++;
 			new_state = DARKEN;
 		} else if (action == GOOD) {
-			aeg->wait--;
-			new_state = aeg->wait == 0 ? IDLE : STOP_BRIGHTEN;
+			aeg->wait -= aeg->update_interval;
+			new_state = aeg->wait <= 0 ? IDLE : STOP_BRIGHTEN;
 		} else {
 			AEG_ASSERT_(false);
 		}
@@ -218,8 +235,8 @@ set_state(struct u_autoexpgain *aeg, enum u_aeg_action action)
 		} else if (action == BRIGHT) {
 			new_state = DARKEN;
 		} else if (action == GOOD) {
-			aeg->wait--;
-			new_state = aeg->wait == 0 ? IDLE : STOP_DARKEN;
+			aeg->wait -= aeg->update_interval;
+			new_state = aeg->wait <= 0 ? IDLE : STOP_DARKEN;
 		} else {
 			AEG_ASSERT_(false);
 		}
@@ -318,27 +335,63 @@ update_expgain(struct u_autoexpgain *aeg)
 	brightness_to_expgain(aeg, brightness, &aeg->exposure, &aeg->gain);
 }
 
+/*!
+ * Histogram of the first channel of @p count pixels starting at @p row, each
+ * @p step bytes apart, added to @p out.
+ *
+ * Consecutive samples of a camera image often have the same intensity, which
+ * with a single histogram makes every increment wait on the store of the
+ * previous one. Spreading the samples over @ref HISTOGRAM_LANES independent
+ * histograms lets those increments run in parallel, a gather based SIMD kernel
+ * doesn't help here as the samples are too sparse for wide loads.
+ */
+static void
+compute_histogram(const uint8_t *row, size_t step, uint32_t count, uint32_t out[HISTOGRAM_LANES][LEVELS])
+{
+	uint32_t i = 0;
+	for (; i + HISTOGRAM_LANES <= count; i += HISTOGRAM_LANES) {
+		const uint8_t *p = row + i * step;
+		out[0][p[0]]++;
+		out[1][p[step]]++;
+		out[2][p[2 * step]]++;
+		out[3][p[3 * step]]++;
+	}
+	for (; i < count; i++) {
+		out[0][row[i * step]]++;
+	}
+}
+
 //! Returns a value in the range [-1, 1] describing how dark-bright the image
 //! is, 0 means it's alright.
 static float
 get_score(struct u_autoexpgain *aeg, struct xrt_frame *xf)
 {
-	uint32_t w = xf->width;
-	uint32_t h = xf->height;
-	uint32_t s = w / GRID_COLS; // Grid cell size
+	// Region of interest.
+	float border = CLAMP(aeg->roi_border, 0, MAX_ROI_BORDER);
+	uint32_t x0 = (uint32_t)(xf->width * border);
+	uint32_t y0 = (uint32_t)(xf->height * border);
+	uint32_t w = xf->width - 2 * x0;
+	uint32_t h = xf->height - 2 * y0;
+
+	int cols = CLAMP(aeg->grid_cols, 1, MAX_GRID_COLS);
+	uint32_t s = MAX(w / (uint32_t)cols, 1u); // Grid cell size
 
 	// Compute histogram (PDF)
-	int histogram[LEVELS] = {0};
-	int samples_count = 0;
+	uint32_t lanes[HISTOGRAM_LANES][LEVELS] = {0};
 	size_t pixel_size = u_format_block_size(xf->format);
-	for (uint32_t y = 0; y < h; y += s) {
-		for (uint32_t x = 0; x < w; x += s) {
-			// Note that for multichannel images only the first channel is in use.
-			uint8_t intensity = xf->data[y * xf->stride + x * pixel_size];
-			histogram[intensity]++;
-			samples_count++;
-		}
+	uint32_t samples_per_row = (w + s - 1) / s;
+	uint32_t rows = (h + s - 1) / s;
+	for (uint32_t y = y0; y < y0 + h; y += s) {
+		// Note that for multichannel images only the first channel is in use.
+		const uint8_t *row = xf->data + y * xf->stride + x0 * pixel_size;
+		compute_histogram(row, s * pixel_size, samples_per_row, lanes);
+	}
+
+	int histogram[LEVELS];
+	for (int i = 0; i < LEVELS; i++) {
+		histogram[i] = (int)(lanes[0][i] + lanes[1][i] + lanes[2][i] + lanes[3][i]);
 	}
+	int samples_count = (int)(samples_per_row * rows);
 
 	// Draw histogram
 	for (int i = 0; i < LEVELS; i++) {
@@ -438,6 +491,11 @@ u_autoexpgain_create(enum u_aeg_strategy strategy, bool enabled_from_start, int
 	aeg->histogram_ui.values = aeg->histogram;
 	aeg->histogram_ui.count = LEVELS;
 
+	aeg->grid_cols = CLAMP((int)debug_get_num_option_aeg_grid_cols(), 1, MAX_GRID_COLS);
+	aeg->roi_border = 0;
+	aeg->update_interval = CLAMP((int)debug_get_num_option_aeg_update_interval(), 1, MAX_UPDATE_INTERVAL);
+	aeg->frames_until_update = 0;
+
 	aeg->brightness.max = 1;
 	aeg->brightness.min = 0;
 	aeg->brightness.step = 0.002;
@@ -479,6 +537,15 @@ u_autoexpgain_add_vars(struct u_autoexpgain *aeg, void *root, char *prefix)
 	(void)snprintf(tmp, sizeof(tmp), "%sMax brightness step", prefix);
 	u_var_add_f32(root, &aeg->max_brightness_step, tmp);
 
+	(void)snprintf(tmp, sizeof(tmp), "%sSample grid columns", prefix);
+	u_var_add_i32(root, &aeg->grid_cols, tmp);
+
+	(void)snprintf(tmp, sizeof(tmp), "%sIgnored border fraction", prefix);
+	u_var_add_f32(root, &aeg->roi_border, tmp);
+
+	(void)snprintf(tmp, sizeof(tmp), "%sUpdate every N frames", prefix);
+	u_var_add_i32(root, &aeg->update_interval, tmp);
+
 	(void)snprintf(tmp, sizeof(tmp), "%sImage score", prefix);
 	u_var_add_ro_f32(root, &aeg->current_score, tmp);
 
@@ -494,6 +561,15 @@ u_autoexpgain_add_vars(struct u_autoexpgain *aeg, void *root, char *prefix)
 void
 u_autoexpgain_update(struct u_autoexpgain *aeg, struct xrt_frame *xf)
 {
+	// Might have been changed from the UI.
+	aeg->update_interval = CLAMP(aeg->update_interval, 1, MAX_UPDATE_INTERVAL);
+
+	if (aeg->frames_until_update > 0) {
+		aeg->frames_until_update--;
+		return;
+	}
+	aeg->frames_until_update = aeg->update_interval - 1;
+
 	update_brightness(aeg, xf);
 	update_expgain(aeg);
 }
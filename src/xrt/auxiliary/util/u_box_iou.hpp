@@ -13,6 +13,10 @@
 #include <math.h>
 #include "xrt/xrt_defines.h"
 
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
 namespace xrt::auxiliary::util::box_iou {
 struct Box
 {
@@ -65,4 +69,142 @@ boxIOU(const Box &a, const Box &b)
 {
 	return boxIntersection(a, b) / boxUnion(a, b);
 }
+
+
+/*!
+ * Many boxes stored as separate arrays of their edges and areas, the loops
+ * over them have no branches so the compiler vectorizes them.
+ */
+struct BoxBatch
+{
+	std::vector<float> left;
+	std::vector<float> top;
+	std::vector<float> right;
+	std::vector<float> bottom;
+	std::vector<float> area;
+
+	void
+	clear()
+	{
+		left.clear();
+		top.clear();
+		right.clear();
+		bottom.clear();
+		area.clear();
+	}
+
+	void
+	push_back(const Box &box)
+	{
+		left.push_back(box.cx - box.w / 2);
+		top.push_back(box.cy - box.h / 2);
+		right.push_back(box.cx + box.w / 2);
+		bottom.push_back(box.cy + box.h / 2);
+		area.push_back(box.w * box.h);
+	}
+
+	size_t
+	size() const
+	{
+		return area.size();
+	}
+};
+
+/*!
+ * IoU of box @p index of @p batch against all boxes in @p batch from
+ * @p first and onwards, written to @p out_iou starting at index @p first.
+ * Same as @ref boxIOU for each pair.
+ */
+static inline void
+boxIOUBatch(const BoxBatch &batch, size_t index, size_t first, float *out_iou)
+{
+	const float *left = batch.left.data();
+	const float *top = batch.top.data();
+	const float *right = batch.right.data();
+	const float *bottom = batch.bottom.data();
+	const float *area = batch.area.data();
+
+	const float l = left[index];
+	const float t = top[index];
+	const float r = right[index];
+	const float b = bottom[index];
+	const float a = area[index];
+
+	auto iou = [&](size_t i) {
+		float w = std::max(std::min(r, right[i]) - std::max(l, left[i]), 0.0f);
+		float h = std::max(std::min(b, bottom[i]) - std::max(t, top[i]), 0.0f);
+		float intersection = w * h;
+		return intersection / (a + area[i] - intersection);
+	};
+
+	/*
+	 * Fixed size chunks into a local array, the compiler vectorizes those
+	 * even with the cheap cost model of -O2, as it needs neither a remainder
+	 * loop nor an aliasing check against the output.
+	 */
+	constexpr size_t kChunk = 8;
+
+	const size_t count = batch.size();
+	size_t i = first;
+	for (; i + kChunk <= count; i += kChunk) {
+		float chunk[kChunk];
+		for (size_t k = 0; k < kChunk; k++) {
+			chunk[k] = iou(i + k);
+		}
+		std::copy(chunk, chunk + kChunk, out_iou + i);
+	}
+	for (; i < count; i++) {
+		out_iou[i] = iou(i);
+	}
+}
+
+/*!
+ * Greedy non-maximum suppression, keeps the highest scoring boxes and drops
+ * every box that overlaps an already kept box by more than @p iou_threshold.
+ *
+ * @param boxes         Candidate boxes.
+ * @param scores        Score of each box in @p boxes.
+ * @param iou_threshold Boxes with a higher IoU than this with a kept box are dropped.
+ * @param max_kept      Stop after keeping this many boxes.
+ * @param[out] out_kept Indices into @p boxes of the kept boxes, highest score first.
+ */
+static inline void
+nonMaximumSuppression(const std::vector<Box> &boxes,
+                      const std::vector<float> &scores,
+                      float iou_threshold,
+                      size_t max_kept,
+                      std::vector<size_t> &out_kept)
+{
+	out_kept.clear();
+
+	const size_t count = boxes.size();
+	if (count == 0 || max_kept == 0) {
+		return;
+	}
+
+	std::vector<size_t> order(count);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](size_t x, size_t y) { return scores[x] > scores[y]; });
+
+	// Sorted by score, so each box is only compared against the ones after it.
+	BoxBatch batch = {};
+	for (size_t i : order) {
+		batch.push_back(boxes[i]);
+	}
+
+	std::vector<float> iou(count);
+	std::vector<uint8_t> suppressed(count, 0);
+
+	for (size_t i = 0; i < count && out_kept.size() < max_kept; i++) {
+		if (suppressed[i]) {
+			continue;
+		}
+		out_kept.push_back(order[i]);
+
+		boxIOUBatch(batch, i, i + 1, iou.data());
+		for (size_t k = i + 1; k < count; k++) {
+			suppressed[k] |= (uint8_t)(iou[k] > iou_threshold);
+		}
+	}
+}
 } // namespace xrt::auxiliary::util::box_iou
@@ -10,6 +10,7 @@
 #include <xrt/xrt_device.h>
 #include "xrt/xrt_settings.h"
 #include "xrt/xrt_config.h"
+#include "xrt/xrt_compiler.h"
 
 #include "util/u_file.h"
 #include "util/u_json.h"
@@ -30,6 +31,103 @@ DEBUG_GET_ONCE_OPTION(active_config, "P_OVERRIDE_ACTIVE_CONFIG", NULL)
 #define CONFIG_FILE_NAME "config_v0.json"
 #define GUI_STATE_FILE_NAME "gui_state_v0.json"
 
+
+/*
+ *
+ * Parse cache.
+ *
+ */
+
+/*!
+ * Last parsed tree of one of the files, the config is opened by the prober
+ * and then again by several drivers and builders. Every user still gets its
+ * own copy to own and modify, but copying a tree is much cheaper than reading
+ * and parsing the file, which is only done again once it changes on disk.
+ */
+struct config_cache_entry
+{
+	const char *filename;
+	time_t mtime;
+	int64_t size;
+	cJSON *root;
+};
+
+static struct config_cache_entry config_cache[] = {
+    {.filename = CONFIG_FILE_NAME},
+    {.filename = GUI_STATE_FILE_NAME},
+};
+
+//! Only held for the duration of a lookup or store, so a spinlock is enough.
+static xrt_atomic_s32_t config_cache_lock;
+
+static struct config_cache_entry *
+config_cache_lock_entry(const char *filename)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(config_cache); i++) {
+		if (strcmp(config_cache[i].filename, filename) != 0) {
+			continue;
+		}
+
+		while (xrt_atomic_s32_cmpxchg(&config_cache_lock, 0, 1) != 0) {
+			// Spin.
+		}
+		return &config_cache[i];
+	}
+
+	return NULL;
+}
+
+static void
+config_cache_unlock(void)
+{
+	xrt_atomic_s32_store_release(&config_cache_lock, 0);
+}
+
+//! Returns a copy of the cached tree if the file hasn't changed since it was parsed.
+XRT_MAYBE_UNUSED static cJSON *
+config_cache_get(const char *filename, const struct stat *st)
+{
+	struct config_cache_entry *e = config_cache_lock_entry(filename);
+	if (e == NULL) {
+		return NULL;
+	}
+
+	cJSON *root = NULL;
+	if (e->root != NULL && e->mtime == st->st_mtime && e->size == (int64_t)st->st_size) {
+		root = cJSON_Duplicate(e->root, true);
+	}
+
+	config_cache_unlock();
+
+	return root;
+}
+
+//! Pass NULL as @p root to drop the cached tree.
+static void
+config_cache_store(const char *filename, const struct stat *st, const cJSON *root)
+{
+	struct config_cache_entry *e = config_cache_lock_entry(filename);
+	if (e == NULL) {
+		return;
+	}
+
+	cJSON_Delete(e->root);
+	e->root = root != NULL ? cJSON_Duplicate(root, true) : NULL;
+	if (st != NULL) {
+		e->mtime = st->st_mtime;
+		e->size = (int64_t)st->st_size;
+	}
+
+	config_cache_unlock();
+}
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
 void
 u_config_json_close(struct u_config_json *json)
 {
@@ -54,6 +152,16 @@ u_config_json_open_or_create_file(struct u_config_json *json, const char *filena
 		return;
 	}
 
+	struct stat st;
+	bool have_stat = stat(tmp, &st) == 0;
+	if (have_stat) {
+		json->root = config_cache_get(filename, &st);
+		if (json->root != NULL) {
+			json->file_loaded = true;
+			return;
+		}
+	}
+
 	FILE *file = u_file_open_file_in_config_dir(filename, "rb");
 	if (file == NULL) {
 		return;
@@ -78,6 +186,8 @@ u_config_json_open_or_create_file(struct u_config_json *json, const char *filena
 	if (json->root == NULL) {
 		U_LOG_E("Failed to parse JSON in '%s':\n%s\n#######", tmp, str);
 		U_LOG_E("'%s'", cJSON_GetErrorPtr());
+	} else if (have_stat) {
+		config_cache_store(filename, &st, json->root);
 	}
 
 	free(str);
@@ -404,6 +514,9 @@ u_config_write(struct u_config_json *json, const char *filename)
 	char *str = cJSON_Print(json->root);
 	U_LOG_D("%s", str);
 
+	// The next open parses the new contents, the mtime might not have changed.
+	config_cache_store(filename, NULL, NULL);
+
 	FILE *config_file = u_file_open_file_in_config_dir(filename, "w");
 	fprintf(config_file, "%s\n", str);
 	fflush(config_file);
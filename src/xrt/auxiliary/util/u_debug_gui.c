@@ -47,6 +47,7 @@ u_debug_gui_stop(struct u_debug_gui **debug_ui)
 #include "util/u_debug.h"
 #include "util/u_debug_gui.h"
 #include "util/u_trace_marker.h"
+#include "util/u_thread_policy.h"
 
 #include "ogl/ogl_api.h"
 
@@ -331,6 +332,7 @@ static void *
 u_debug_gui_run_thread(void *ptr)
 {
 	U_TRACE_SET_THREAD_NAME("Debug GUI");
+	u_thread_policy_apply(U_LOGGING_INFO, OS_THREAD_ROLE_BACKGROUND, "Debug GUI");
 
 	struct u_debug_gui *debug_gui = (struct u_debug_gui *)ptr;
 	sdl2_window_init(debug_gui);
@@ -0,0 +1,169 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  On disk cache for calibration and config data read from devices.
+ * @ingroup aux_util
+ */
+
+#include "math/m_api.h"
+
+#include "util/u_misc.h"
+#include "util/u_file.h"
+#include "util/u_debug.h"
+#include "util/u_logging.h"
+#include "util/u_device_cache.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+
+DEBUG_GET_ONCE_BOOL_OPTION(device_cache, "XRT_DEVICE_CACHE", true)
+
+//! Bump when the layout of the file changes.
+#define CACHE_VERSION 1
+
+//! Magic at the start of every cache file, "MDVC".
+#define CACHE_MAGIC 0x4356444d
+
+//! Calibration data is a few hundred KiB, camera remap tables tens of MiB, anything bigger is corrupt.
+#define MAX_DATA_SIZE (64 * 1024 * 1024)
+
+//! Max size of the caller supplied serial and fingerprint.
+#define MAX_FINGERPRINT_SIZE 256
+
+#define SUBPATH "device_cache"
+
+struct file_header
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t key;
+	uint64_t size;
+	uint64_t hash;
+};
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+static bool
+get_filename(uint64_t key, const char *name, char *out_filename, size_t out_filename_size)
+{
+	int ret = snprintf(out_filename, out_filename_size, "%s_%016" PRIx64 ".bin", name, key);
+	return ret > 0 && ret < (int)out_filename_size;
+}
+
+static uint64_t
+hash_data(const void *data, size_t size)
+{
+	return (uint64_t)math_hash_string((const char *)data, size);
+}
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+bool
+u_device_cache_make_key(const char *serial, const void *fingerprint, size_t fingerprint_size, uint64_t *out_key)
+{
+	if (!debug_get_bool_option_device_cache()) {
+		return false;
+	}
+
+	if (serial == NULL) {
+		serial = "";
+	}
+
+	size_t serial_size = strlen(serial);
+	if (serial_size + 1 + fingerprint_size > MAX_FINGERPRINT_SIZE) {
+		return false;
+	}
+
+	// Serial and fingerprint separated by a zero byte, so the split can't be ambiguous.
+	uint8_t data[MAX_FINGERPRINT_SIZE] = {0};
+	memcpy(data, serial, serial_size);
+	memcpy(data + serial_size + 1, fingerprint, fingerprint_size);
+
+	*out_key = hash_data(data, serial_size + 1 + fingerprint_size);
+
+	return true;
+}
+
+bool
+u_device_cache_load(uint64_t key, const char *name, void **out_data, size_t *out_size)
+{
+	char filename[256];
+	if (!get_filename(key, name, filename, sizeof(filename))) {
+		return false;
+	}
+
+	size_t file_size = 0;
+	char *file = u_file_read_file_in_cache_dir_subpath(SUBPATH, filename, &file_size);
+	if (file == NULL) {
+		return false;
+	}
+
+	struct file_header header = {0};
+	if (file_size >= sizeof(header)) {
+		memcpy(&header, file, sizeof(header));
+	}
+
+	bool valid = header.magic == CACHE_MAGIC &&   //
+	             header.version == CACHE_VERSION && //
+	             header.key == key &&               //
+	             header.size <= MAX_DATA_SIZE;
+	if (!valid) {
+		free(file);
+		return false;
+	}
+
+	// Catches truncated and otherwise damaged files.
+	size_t size = (size_t)header.size;
+	if (file_size - sizeof(header) != size || hash_data(file + sizeof(header), size) != header.hash) {
+		U_LOG_W("Ignoring corrupt device cache entry '%s'.", filename);
+		free(file);
+		return false;
+	}
+
+	// The buffer has a zero byte after the file, so it also ends up after the data.
+	memmove(file, file + sizeof(header), size + 1);
+
+	U_LOG_D("Loaded '%s' from device cache.", filename);
+
+	*out_data = file;
+	*out_size = size;
+
+	return true;
+}
+
+void
+u_device_cache_store(uint64_t key, const char *name, const void *data, size_t size)
+{
+	char filename[256];
+
+	if (size > MAX_DATA_SIZE || !get_filename(key, name, filename, sizeof(filename))) {
+		return;
+	}
+
+	struct file_header header = {
+	    .magic = CACHE_MAGIC,
+	    .version = CACHE_VERSION,
+	    .key = key,
+	    .size = size,
+	    .hash = hash_data(data, size),
+	};
+
+	if (!u_file_write_file_in_cache_dir_subpath(SUBPATH, filename, &header, sizeof(header), data, size)) {
+		return;
+	}
+
+	U_LOG_D("Stored '%s' in device cache.", filename);
+}
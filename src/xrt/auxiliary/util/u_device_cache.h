@@ -0,0 +1,52 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  On disk cache for calibration and config data read from devices.
+ * @ingroup aux_util
+ */
+
+#pragma once
+
+#include "xrt/xrt_compiler.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*!
+ * Create a cache key from a fingerprint of the data on the device, usually a
+ * checksum or header that is cheap to read and changes whenever the data
+ * changes, together with the serial of the device if known.
+ *
+ * Returns false if the cache is disabled with `XRT_DEVICE_CACHE=false`.
+ *
+ * @ingroup aux_util
+ */
+bool
+u_device_cache_make_key(const char *serial, const void *fingerprint, size_t fingerprint_size, uint64_t *out_key);
+
+/*!
+ * Load a cache entry, on success @p out_data is allocated and must be freed
+ * by the caller, it has an extra zero byte after the data so text can be used
+ * as a string directly. Returns false on any miss or corrupt entry.
+ *
+ * @ingroup aux_util
+ */
+bool
+u_device_cache_load(uint64_t key, const char *name, void **out_data, size_t *out_size);
+
+/*!
+ * Store a cache entry, silently does nothing on failure.
+ *
+ * @ingroup aux_util
+ */
+void
+u_device_cache_store(uint64_t key, const char *name, const void *data, size_t size);
+
+
+#ifdef __cplusplus
+}
+#endif
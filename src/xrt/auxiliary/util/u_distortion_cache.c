@@ -0,0 +1,177 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  On disk cache for generated distortion meshes and images.
+ * @ingroup aux_distortion
+ */
+
+#include "xrt/xrt_config_os.h"
+
+#include "math/m_api.h"
+
+#include "util/u_misc.h"
+#include "util/u_debug.h"
+#include "util/u_device_cache.h"
+#include "util/u_distortion_cache.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+DEBUG_GET_ONCE_BOOL_OPTION(distortion_cache, "XRT_DISTORTION_CACHE", true)
+
+//! Bump when the layout of @ref key_data or the generated data changes.
+#define CACHE_VERSION 1
+
+//! Sample grid per view used to fingerprint the calibration.
+#define PROBE_DIM 9
+
+//! Max size of the caller supplied params.
+#define MAX_PARAMS_SIZE 64
+
+//! Entries are stored in the device cache, prefixed to keep them apart.
+#define NAME_PREFIX "distortion_"
+
+/*!
+ * All of the data that is hashed into a key, zeroed before being filled in so
+ * that padding doesn't change the hash.
+ */
+struct key_data
+{
+	uint32_t version;
+	uint32_t view_count;
+	char str[XRT_DEVICE_NAME_LEN];
+	char serial[XRT_DEVICE_NAME_LEN];
+	struct xrt_fov fov[XRT_MAX_VIEWS];
+	struct xrt_matrix_2x2 rot[XRT_MAX_VIEWS];
+	struct xrt_uv_triplet probes[XRT_MAX_VIEWS][PROBE_DIM][PROBE_DIM];
+	uint8_t params[MAX_PARAMS_SIZE];
+};
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+#ifdef XRT_OS_LINUX
+static bool
+get_name(const char *name, char *out_name, size_t out_name_size)
+{
+	int ret = snprintf(out_name, out_name_size, NAME_PREFIX "%s", name);
+	return ret > 0 && ret < (int)out_name_size;
+}
+#endif
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+bool
+u_distortion_cache_make_key(struct xrt_device *xdev, const void *params, size_t params_size, uint64_t *out_key)
+{
+	if (!debug_get_bool_option_distortion_cache()) {
+		return false;
+	}
+
+	if (xdev->hmd == NULL || xdev->compute_distortion == NULL || params_size > MAX_PARAMS_SIZE) {
+		return false;
+	}
+
+	struct key_data *data = U_TYPED_CALLOC(struct key_data);
+	if (data == NULL) {
+		return false;
+	}
+
+	uint32_t view_count = xdev->hmd->view_count;
+	if (view_count > XRT_MAX_VIEWS) {
+		view_count = XRT_MAX_VIEWS;
+	}
+
+	data->version = CACHE_VERSION;
+	data->view_count = view_count;
+	memcpy(data->str, xdev->str, sizeof(data->str));
+	memcpy(data->serial, xdev->serial, sizeof(data->serial));
+	memcpy(data->params, params, params_size);
+
+	for (uint32_t view = 0; view < view_count; view++) {
+		data->fov[view] = xdev->hmd->distortion.fov[view];
+		data->rot[view] = xdev->hmd->views[view].rot;
+
+		for (uint32_t row = 0; row < PROBE_DIM; row++) {
+			float v = (float)row / (float)(PROBE_DIM - 1);
+
+			for (uint32_t col = 0; col < PROBE_DIM; col++) {
+				float u = (float)col / (float)(PROBE_DIM - 1);
+
+				struct xrt_uv_triplet *result = &data->probes[view][row][col];
+				xrt_result_t xret = xrt_device_compute_distortion(xdev, view, u, v, result);
+				if (xret != XRT_SUCCESS) {
+					free(data);
+					return false;
+				}
+			}
+		}
+	}
+
+	*out_key = (uint64_t)math_hash_string((const char *)data, sizeof(*data));
+
+	free(data);
+
+	return true;
+}
+
+bool
+u_distortion_cache_load(uint64_t key, const char *name, void *out_data, size_t size)
+{
+#ifdef XRT_OS_LINUX
+	char cache_name[128];
+	if (!get_name(name, cache_name, sizeof(cache_name))) {
+		return false;
+	}
+
+	void *data = NULL;
+	size_t data_size = 0;
+	if (!u_device_cache_load(key, cache_name, &data, &data_size)) {
+		return false;
+	}
+
+	bool valid = data_size == size;
+	if (valid) {
+		memcpy(out_data, data, size);
+	}
+
+	free(data);
+
+	return valid;
+#else
+	(void)key;
+	(void)name;
+	(void)out_data;
+	(void)size;
+	return false;
+#endif
+}
+
+void
+u_distortion_cache_store(uint64_t key, const char *name, const void *data, size_t size)
+{
+#ifdef XRT_OS_LINUX
+	char cache_name[128];
+	if (!get_name(name, cache_name, sizeof(cache_name))) {
+		return;
+	}
+
+	u_device_cache_store(key, cache_name, data, size);
+#else
+	(void)key;
+	(void)name;
+	(void)data;
+	(void)size;
+#endif
+}
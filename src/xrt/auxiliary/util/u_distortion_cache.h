@@ -0,0 +1,56 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  On disk cache for generated distortion meshes and images.
+ * @ingroup aux_distortion
+ */
+
+#pragma once
+
+#include "xrt/xrt_device.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*!
+ * Create a cache key for data generated with @ref xrt_device_compute_distortion.
+ *
+ * The key is a hash of the device name and serial, its view setup and the
+ * result of a small grid of distortion samples per view, so any change in the
+ * calibration of the device gives a new key. The @p params are extra bytes
+ * describing how the data is generated (size, rotation, etc), make sure they
+ * do not contain any uninitialised padding.
+ *
+ * Returns false if the cache is disabled or the device could not be sampled.
+ *
+ * @ingroup aux_distortion
+ */
+bool
+u_distortion_cache_make_key(struct xrt_device *xdev, const void *params, size_t params_size, uint64_t *out_key);
+
+/*!
+ * Load a cache entry into @p out_data, the entry must be exactly @p size bytes
+ * large. Returns false on any miss, leaving @p out_data in an undefined state.
+ *
+ * @ingroup aux_distortion
+ */
+bool
+u_distortion_cache_load(uint64_t key, const char *name, void *out_data, size_t size);
+
+/*!
+ * Store a cache entry, it goes into the @ref u_device_cache_store cache so
+ * shares its file format and checksum. Silently does nothing on failure.
+ *
+ * @ingroup aux_distortion
+ */
+void
+u_distortion_cache_store(uint64_t key, const char *name, const void *data, size_t size);
+
+
+#ifdef __cplusplus
+}
+#endif
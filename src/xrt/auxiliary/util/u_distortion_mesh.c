@@ -12,6 +12,9 @@
 #include "util/u_frame.h"
 #include "util/u_debug.h"
 #include "util/u_format.h"
+#include "util/u_logging.h"
+#include "util/u_worker.h"
+#include "util/u_distortion_cache.h"
 #include "util/u_distortion_mesh.h"
 
 #include "math/m_vec2.h"
@@ -19,85 +22,447 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 
 
 DEBUG_GET_ONCE_NUM_OPTION(mesh_size, "XRT_MESH_SIZE", 64)
+DEBUG_GET_ONCE_FLOAT_OPTION(mesh_tolerance, "XRT_MESH_TOLERANCE", 0.0005f)
+
+/*!
+ * Cells per axis the adaptive grid starts from before refining, a single
+ * bisection of the whole range would be fooled by any symmetric distortion.
+ */
+#define MESH_START_CELLS 8
+
+/*!
+ * How many points across the other axis a column or row is probed at when
+ * deciding if it needs to be split, includes both edges.
+ */
+#define MESH_PROBE_COUNT 9
 
 
 typedef xrt_result_t (*func_calc)(
     struct xrt_device *xdev, uint32_t view, float u, float v, struct xrt_uv_triplet *result);
 
+/*!
+ * Generates the grid and vertices of one view, the grid is a tensor product
+ * of column and row lines so the triangle strip layout of a uniform grid can
+ * be kept, lines are only added where the distortion isn't linear.
+ */
+struct mesh_view_task
+{
+	struct xrt_device *xdev;
+	func_calc calc;
+	uint32_t view;
+
+	//! Max cells per axis, also the capacity of the lines minus one.
+	uint32_t max_cells;
+	//! Max error in UV of linear interpolation, zero or less for a uniform grid.
+	float tolerance;
+	uint32_t stride_in_floats;
+
+	float *u_lines;
+	uint32_t u_cells;
+	float *v_lines;
+	uint32_t v_cells;
+
+	float *verts;
+	bool ok;
+};
+
 static int
 index_for(int row, int col, uint32_t stride, uint32_t offset)
 {
 	return row * stride + col + offset;
 }
 
-static void
-run_func(struct xrt_device *xdev, func_calc calc, struct xrt_hmd_parts *target, uint32_t num)
+static bool
+calc_at(struct mesh_view_task *t, bool along_u, float x, float other, struct xrt_uv_triplet *result)
 {
-	assert(calc != NULL);
+	float u = along_u ? x : other;
+	float v = along_u ? other : x;
 
-	uint32_t view_count = target->view_count;
+	return t->calc(t->xdev, t->view, u, v, result) == XRT_SUCCESS;
+}
 
-	uint32_t vertex_offsets[XRT_MAX_VIEWS] = {0};
-	uint32_t index_offsets[XRT_MAX_VIEWS] = {0};
+static bool
+calc_probes(struct mesh_view_task *t, bool along_u, float x, struct xrt_uv_triplet *out_probes)
+{
+	for (uint32_t p = 0; p < MESH_PROBE_COUNT; p++) {
+		float other = (float)p / (float)(MESH_PROBE_COUNT - 1);
+		if (!calc_at(t, along_u, x, other, &out_probes[p])) {
+			return false;
+		}
+	}
 
-	uint32_t cells_cols = num;
-	uint32_t cells_rows = num;
-	uint32_t vert_cols = cells_cols + 1;
-	uint32_t vert_rows = cells_rows + 1;
+	return true;
+}
 
-	uint32_t vertex_count_per_view = vert_rows * vert_cols;
-	uint32_t vertex_count = vertex_count_per_view * view_count;
+//! Worst error of any channel at the middle of a linear interpolation.
+static float
+lerp_error(const struct xrt_uv_triplet *a, const struct xrt_uv_triplet *b, const struct xrt_uv_triplet *mid)
+{
+	const struct xrt_vec2 *ca[3] = {&a->r, &a->g, &a->b};
+	const struct xrt_vec2 *cb[3] = {&b->r, &b->g, &b->b};
+	const struct xrt_vec2 *cm[3] = {&mid->r, &mid->g, &mid->b};
 
-	uint32_t uv_channels_count = 3;
-	uint32_t stride_in_floats = 2 + uv_channels_count * 2;
-	uint32_t float_count = vertex_count * stride_in_floats;
+	float error = 0.0f;
+	for (int i = 0; i < 3; i++) {
+		error = fmaxf(error, fabsf(cm[i]->x - (ca[i]->x + cb[i]->x) * 0.5f));
+		error = fmaxf(error, fabsf(cm[i]->y - (ca[i]->y + cb[i]->y) * 0.5f));
+	}
+
+	return error;
+}
+
+/*!
+ * Adds the lines inside of and at the end of the interval [a, b] whose width
+ * is 1 / @p div, the samples of the ends are passed in so they are only ever
+ * computed once.
+ */
+static bool
+refine_interval(struct mesh_view_task *t,
+                bool along_u,
+                float a,
+                const struct xrt_uv_triplet *a_probes,
+                float b,
+                const struct xrt_uv_triplet *b_probes,
+                uint32_t div,
+                float *lines,
+                uint32_t *count)
+{
+	if (div * 2 <= t->max_cells) {
+		float mid = (a + b) * 0.5f;
+
+		struct xrt_uv_triplet mid_probes[MESH_PROBE_COUNT];
+		if (!calc_probes(t, along_u, mid, mid_probes)) {
+			return false;
+		}
 
-	float *verts = U_TYPED_ARRAY_CALLOC(float, float_count);
+		float error = 0.0f;
+		for (uint32_t p = 0; p < MESH_PROBE_COUNT; p++) {
+			error = fmaxf(error, lerp_error(&a_probes[p], &b_probes[p], &mid_probes[p]));
+		}
+
+		if (error > t->tolerance) {
+			return refine_interval(t, along_u, a, a_probes, mid, mid_probes, div * 2, lines, count) &&
+			       refine_interval(t, along_u, mid, mid_probes, b, b_probes, div * 2, lines, count);
+		}
+	}
+
+	lines[(*count)++] = b;
+
+	return true;
+}
+
+/*!
+ * Picks the lines of one axis, returns the number of cells in @p out_cells.
+ */
+static bool
+calc_lines(struct mesh_view_task *t, bool along_u, float *lines, uint32_t *out_cells)
+{
+	if (t->tolerance <= 0.0f || t->max_cells <= 1) {
+		for (uint32_t i = 0; i <= t->max_cells; i++) {
+			lines[i] = (float)i / (float)t->max_cells;
+		}
+		*out_cells = t->max_cells;
+		return true;
+	}
+
+	uint32_t start_cells = t->max_cells < MESH_START_CELLS ? t->max_cells : MESH_START_CELLS;
+
+	struct xrt_uv_triplet probes[2][MESH_PROBE_COUNT];
+	if (!calc_probes(t, along_u, 0.0f, probes[0])) {
+		return false;
+	}
+
+	uint32_t count = 0;
+	lines[count++] = 0.0f;
+
+	for (uint32_t i = 1; i <= start_cells; i++) {
+		float a = (float)(i - 1) / (float)start_cells;
+		float b = (float)i / (float)start_cells;
+		struct xrt_uv_triplet *a_probes = probes[(i - 1) & 1];
+		struct xrt_uv_triplet *b_probes = probes[i & 1];
+
+		if (!calc_probes(t, along_u, b, b_probes) ||
+		    !refine_interval(t, along_u, a, a_probes, b, b_probes, start_cells, lines, &count)) {
+			return false;
+		}
+	}
+
+	*out_cells = count - 1;
+
+	return true;
+}
+
+static bool
+calc_verts(struct mesh_view_task *t)
+{
+	uint32_t vert_cols = t->u_cells + 1;
+	uint32_t vert_rows = t->v_cells + 1;
+
+	t->verts = U_TYPED_ARRAY_CALLOC(float, vert_cols * vert_rows * t->stride_in_floats);
 
-	// Setup the vertices for all views.
 	uint32_t i = 0;
-	for (uint32_t view = 0; view < view_count; view++) {
-		vertex_offsets[view] = i / stride_in_floats;
+	for (uint32_t r = 0; r < vert_rows; r++) {
+		// This goes from 0 to 1.0 inclusive.
+		float v = t->v_lines[r];
 
-		for (uint32_t r = 0; r < vert_rows; r++) {
+		for (uint32_t c = 0; c < vert_cols; c++) {
 			// This goes from 0 to 1.0 inclusive.
-			float v = (float)r / (float)cells_rows;
+			float u = t->u_lines[c];
 
-			for (uint32_t c = 0; c < vert_cols; c++) {
-				// This goes from 0 to 1.0 inclusive.
-				float u = (float)c / (float)cells_cols;
+			// Make the position in the range of [-1, 1]
+			t->verts[i + 0] = u * 2.0f - 1.0f;
+			t->verts[i + 1] = v * 2.0f - 1.0f;
+
+			if (t->calc(t->xdev, t->view, u, v, (struct xrt_uv_triplet *)&t->verts[i + 2]) != XRT_SUCCESS) {
+				return false;
+			}
 
-				// Make the position in the range of [-1, 1]
-				verts[i + 0] = u * 2.0f - 1.0f;
-				verts[i + 1] = v * 2.0f - 1.0f;
+			i += t->stride_in_floats;
+		}
+	}
 
-				if (calc(xdev, view, u, v, (struct xrt_uv_triplet *)&verts[i + 2]) != XRT_SUCCESS) {
-					// bail on error, without updating
-					// distortion.preferred
-					return;
-				}
+	return true;
+}
 
-				i += stride_in_floats;
-			}
+static void
+mesh_view_task_func(void *ptr)
+{
+	struct mesh_view_task *t = (struct mesh_view_task *)ptr;
+
+	t->ok = calc_lines(t, true, t->u_lines, &t->u_cells) && //
+	        calc_lines(t, false, t->v_lines, &t->v_cells) && //
+	        calc_verts(t);
+}
+
+static uint32_t
+vertex_count_for(const struct mesh_view_task *t)
+{
+	return (t->u_cells + 1) * (t->v_cells + 1);
+}
+
+/*!
+ * Run the views in parallel, compute_distortion is a pure function of the
+ * device's calibration so it is fine to call for different views at once.
+ */
+static bool
+generate_views(struct mesh_view_task *tasks, uint32_t view_count)
+{
+	if (view_count == 1) {
+		mesh_view_task_func(&tasks[0]);
+		return tasks[0].ok;
+	}
+
+	struct u_worker_thread_pool *pool = u_worker_thread_pool_create(view_count - 1, view_count, "Distortion");
+	struct u_worker_group *group = u_worker_group_create(pool);
+
+	for (uint32_t view = 0; view < view_count; view++) {
+		u_worker_group_push(group, mesh_view_task_func, &tasks[view]);
+	}
+
+	u_worker_group_wait_all(group);
+	u_worker_group_reference(&group, NULL);
+	u_worker_thread_pool_reference(&pool, NULL);
+
+	bool ok = true;
+	for (uint32_t view = 0; view < view_count; view++) {
+		ok = ok && tasks[view].ok;
+	}
+
+	return ok;
+}
+
+
+/*
+ *
+ * Cache, the grid of each view is stored first as it decides the size of
+ * the vertices.
+ *
+ */
+
+static size_t
+grid_floats_per_view(uint32_t max_cells)
+{
+	// Cell counts followed by the lines of both axis.
+	return 2 + (max_cells + 1) * 2;
+}
+
+static void
+grid_pack(const struct mesh_view_task *t, float *out)
+{
+	out[0] = (float)t->u_cells;
+	out[1] = (float)t->v_cells;
+	memcpy(&out[2], t->u_lines, (t->u_cells + 1) * sizeof(float));
+	memcpy(&out[2 + t->max_cells + 1], t->v_lines, (t->v_cells + 1) * sizeof(float));
+}
+
+static bool
+grid_unpack(struct mesh_view_task *t, const float *in)
+{
+	if (in[0] < 1.0f || in[0] > (float)t->max_cells || in[1] < 1.0f || in[1] > (float)t->max_cells) {
+		return false;
+	}
+
+	t->u_cells = (uint32_t)in[0];
+	t->v_cells = (uint32_t)in[1];
+	memcpy(t->u_lines, &in[2], (t->u_cells + 1) * sizeof(float));
+	memcpy(t->v_lines, &in[2 + t->max_cells + 1], (t->v_cells + 1) * sizeof(float));
+
+	return true;
+}
+
+static bool
+cache_load(uint64_t key, struct mesh_view_task *tasks, uint32_t view_count, float *grid, size_t grid_size)
+{
+	if (!u_distortion_cache_load(key, "mesh_grid", grid, grid_size)) {
+		return false;
+	}
+
+	size_t per_view = grid_floats_per_view(tasks[0].max_cells);
+	for (uint32_t view = 0; view < view_count; view++) {
+		if (!grid_unpack(&tasks[view], &grid[view * per_view])) {
+			return false;
+		}
+	}
+
+	for (uint32_t view = 0; view < view_count; view++) {
+		struct mesh_view_task *t = &tasks[view];
+		size_t size = vertex_count_for(t) * t->stride_in_floats * sizeof(float);
+
+		t->verts = U_TYPED_ARRAY_CALLOC(float, vertex_count_for(t) * t->stride_in_floats);
+
+		char name[32];
+		snprintf(name, sizeof(name), "mesh_%u", view);
+		if (!u_distortion_cache_load(key, name, t->verts, size)) {
+			return false;
 		}
 	}
 
-	uint32_t index_count_per_view = cells_rows * (vert_cols * 2 + 2);
-	uint32_t index_count_total = index_count_per_view * view_count;
-	int *indices = U_TYPED_ARRAY_CALLOC(int, index_count_total);
+	return true;
+}
 
-	// Set up indices for all views.
-	i = 0;
+static void
+cache_store(uint64_t key, struct mesh_view_task *tasks, uint32_t view_count, float *grid, size_t grid_size)
+{
+	size_t per_view = grid_floats_per_view(tasks[0].max_cells);
 	for (uint32_t view = 0; view < view_count; view++) {
-		index_offsets[view] = i;
+		grid_pack(&tasks[view], &grid[view * per_view]);
+	}
+
+	// Store the vertices first so a stored grid always has its vertices.
+	for (uint32_t view = 0; view < view_count; view++) {
+		struct mesh_view_task *t = &tasks[view];
+		size_t size = vertex_count_for(t) * t->stride_in_floats * sizeof(float);
+
+		char name[32];
+		snprintf(name, sizeof(name), "mesh_%u", view);
+		u_distortion_cache_store(key, name, t->verts, size);
+	}
+
+	u_distortion_cache_store(key, "mesh_grid", grid, grid_size);
+}
 
+
+/*
+ *
+ * Mesh generation.
+ *
+ */
+
+static void
+run_func(struct xrt_device *xdev,
+         func_calc calc,
+         struct xrt_hmd_parts *target,
+         uint32_t num,
+         float tolerance,
+         bool use_cache)
+{
+	assert(calc != NULL);
+
+	uint32_t view_count = target->view_count;
+
+	uint32_t uv_channels_count = 3;
+	uint32_t stride_in_floats = 2 + uv_channels_count * 2;
+
+	struct mesh_view_task tasks[XRT_MAX_VIEWS] = {0};
+	for (uint32_t view = 0; view < view_count; view++) {
+		tasks[view].xdev = xdev;
+		tasks[view].calc = calc;
+		tasks[view].view = view;
+		tasks[view].max_cells = num;
+		tasks[view].tolerance = tolerance;
+		tasks[view].stride_in_floats = stride_in_floats;
+		tasks[view].u_lines = U_TYPED_ARRAY_CALLOC(float, num + 1);
+		tasks[view].v_lines = U_TYPED_ARRAY_CALLOC(float, num + 1);
+	}
+
+	// The vertices are the expensive part, try the cache first.
+	uint32_t tolerance_bits = 0;
+	memcpy(&tolerance_bits, &tolerance, sizeof(tolerance_bits));
+	uint32_t key_params[4] = {num, stride_in_floats, tolerance_bits, MESH_PROBE_COUNT};
+	uint64_t key = 0;
+	bool have_key = use_cache && u_distortion_cache_make_key(xdev, key_params, sizeof(key_params), &key);
+
+	size_t grid_float_count = grid_floats_per_view(num) * view_count;
+	float *grid = U_TYPED_ARRAY_CALLOC(float, grid_float_count);
+	size_t grid_size = grid_float_count * sizeof(float);
+
+	bool ok = true;
+	if (!have_key || !cache_load(key, tasks, view_count, grid, grid_size)) {
+		for (uint32_t view = 0; view < view_count; view++) {
+			free(tasks[view].verts);
+			tasks[view].verts = NULL;
+		}
+
+		// Setup the vertices for all views.
+		ok = generate_views(tasks, view_count);
+
+		if (ok && have_key) {
+			cache_store(key, tasks, view_count, grid, grid_size);
+		}
+	}
+
+	free(grid);
+
+	uint32_t vertex_offsets[XRT_MAX_VIEWS] = {0};
+	uint32_t index_offsets[XRT_MAX_VIEWS] = {0};
+	uint32_t index_counts[XRT_MAX_VIEWS] = {0};
+	uint32_t vertex_count = 0;
+	uint32_t index_count_total = 0;
+
+	for (uint32_t view = 0; view < view_count; view++) {
+		vertex_offsets[view] = vertex_count;
+		vertex_count += vertex_count_for(&tasks[view]);
+
+		uint32_t vert_cols = tasks[view].u_cells + 1;
+		index_counts[view] = tasks[view].v_cells * (vert_cols * 2 + 2);
+		index_offsets[view] = index_count_total;
+		index_count_total += index_counts[view];
+	}
+
+	float *verts = NULL;
+	int *indices = NULL;
+
+	if (ok) {
+		verts = U_TYPED_ARRAY_CALLOC(float, vertex_count * stride_in_floats);
+		indices = U_TYPED_ARRAY_CALLOC(int, index_count_total);
+	}
+
+	for (uint32_t view = 0; ok && view < view_count; view++) {
+		struct mesh_view_task *t = &tasks[view];
+
+		memcpy(&verts[vertex_offsets[view] * stride_in_floats], t->verts,
+		       vertex_count_for(t) * stride_in_floats * sizeof(float));
+
+		uint32_t i = index_offsets[view];
 		uint32_t off = vertex_offsets[view];
+		uint32_t vert_cols = t->u_cells + 1;
 
-		for (uint32_t r = 0; r < cells_rows; r++) {
+		for (uint32_t r = 0; r < t->v_cells; r++) {
 			// Top vertex row for this cell row, left most vertex.
 			indices[i++] = index_for(r, 0, vert_cols, off);
 
@@ -112,6 +477,21 @@ run_func(struct xrt_device *xdev, func_calc calc, struct xrt_hmd_parts *target,
 		}
 	}
 
+	for (uint32_t view = 0; view < view_count; view++) {
+		free(tasks[view].u_lines);
+		free(tasks[view].v_lines);
+		free(tasks[view].verts);
+	}
+
+	if (!ok) {
+		// bail on error, without updating
+		// distortion.preferred
+		return;
+	}
+
+	U_LOG_D("Distortion mesh: %u vertices, %u indices (max %u cells per axis, tolerance %f)", vertex_count,
+	        index_count_total, num, tolerance);
+
 	target->distortion.models |= XRT_DISTORTION_MODEL_MESHUV;
 	target->distortion.mesh.vertices = verts;
 	target->distortion.mesh.stride = stride_in_floats * sizeof(float);
@@ -120,7 +500,7 @@ run_func(struct xrt_device *xdev, func_calc calc, struct xrt_hmd_parts *target,
 	target->distortion.mesh.indices = indices;
 	target->distortion.mesh.index_count_total = index_count_total;
 	for (uint32_t view = 0; view < view_count; ++view) {
-		target->distortion.mesh.index_counts[view] = index_count_per_view;
+		target->distortion.mesh.index_counts[view] = index_counts[view];
 		target->distortion.mesh.index_offsets[view] = index_offsets[view];
 	}
 }
@@ -423,7 +803,7 @@ u_distortion_mesh_fill_in_none(struct xrt_device *xdev)
 	struct xrt_hmd_parts *target = xdev->hmd;
 
 	// Do the generation.
-	run_func(xdev, u_distortion_mesh_none, target, 1);
+	run_func(xdev, u_distortion_mesh_none, target, 1, 0.0f, false);
 
 	// Make the target mostly usable.
 	target->distortion.models |= XRT_DISTORTION_MODEL_NONE;
@@ -467,6 +847,7 @@ u_distortion_mesh_fill_in_compute(struct xrt_device *xdev)
 	struct xrt_hmd_parts *target = xdev->hmd;
 
 	uint32_t num = (uint32_t)debug_get_num_option_mesh_size();
+	float tolerance = debug_get_float_option_mesh_tolerance();
 
-	run_func(xdev, calc, target, num);
+	run_func(xdev, calc, target, num, tolerance, true);
 }
@@ -120,17 +120,11 @@ u_file_open_file_in_config_dir(const char *filename, const char *mode)
 	return fopen(file_str, mode);
 }
 
-FILE *
-u_file_open_file_in_config_dir_subpath(const char *subpath, const char *filename, const char *mode)
+static FILE *
+open_file_in_dir_subpath(const char *dir, const char *subpath, const char *filename, const char *mode)
 {
-	char tmp[PATH_MAX];
-	int i = u_file_get_config_dir(tmp, sizeof(tmp));
-	if (i < 0 || i >= (int)sizeof(tmp)) {
-		return NULL;
-	}
-
 	char fullpath[PATH_MAX];
-	i = snprintf(fullpath, sizeof(fullpath), "%s/%s", tmp, subpath);
+	int i = snprintf(fullpath, sizeof(fullpath), "%s/%s", dir, subpath);
 	if (i < 0 || i >= (int)sizeof(fullpath)) {
 		return NULL;
 	}
@@ -153,6 +147,120 @@ u_file_open_file_in_config_dir_subpath(const char *subpath, const char *filename
 	return fopen(file_str, mode);
 }
 
+FILE *
+u_file_open_file_in_config_dir_subpath(const char *subpath, const char *filename, const char *mode)
+{
+	char tmp[PATH_MAX];
+	int i = u_file_get_config_dir(tmp, sizeof(tmp));
+	if (i < 0 || i >= (int)sizeof(tmp)) {
+		return NULL;
+	}
+
+	return open_file_in_dir_subpath(tmp, subpath, filename, mode);
+}
+
+int
+u_file_get_cache_dir(char *out_path, size_t out_path_size)
+{
+	const char *xdg_cache = getenv("XDG_CACHE_HOME");
+	const char *home = getenv("HOME");
+	if (xdg_cache != NULL) {
+		return snprintf(out_path, out_path_size, "%s/monado", xdg_cache);
+	}
+	if (home != NULL) {
+		return snprintf(out_path, out_path_size, "%s/.cache/monado", home);
+	}
+	return -1;
+}
+
+int
+u_file_get_path_in_cache_dir(const char *suffix, char *out_path, size_t out_path_size)
+{
+	char tmp[PATH_MAX];
+	int i = u_file_get_cache_dir(tmp, sizeof(tmp));
+	if (i <= 0) {
+		return i;
+	}
+
+	return snprintf(out_path, out_path_size, "%s/%s", tmp, suffix);
+}
+
+FILE *
+u_file_open_file_in_cache_dir_subpath(const char *subpath, const char *filename, const char *mode)
+{
+	char tmp[PATH_MAX];
+	int i = u_file_get_cache_dir(tmp, sizeof(tmp));
+	if (i < 0 || i >= (int)sizeof(tmp)) {
+		return NULL;
+	}
+
+	return open_file_in_dir_subpath(tmp, subpath, filename, mode);
+}
+
+static bool
+get_path_in_cache_dir_subpath(const char *subpath, const char *filename, char *out_path, size_t out_path_size)
+{
+	char suffix[PATH_MAX];
+	int i = snprintf(suffix, sizeof(suffix), "%s/%s", subpath, filename);
+	if (i < 0 || i >= (int)sizeof(suffix)) {
+		return false;
+	}
+
+	i = u_file_get_path_in_cache_dir(suffix, out_path, out_path_size);
+	return i > 0 && i < (int)out_path_size;
+}
+
+char *
+u_file_read_file_in_cache_dir_subpath(const char *subpath, const char *filename, size_t *out_file_size)
+{
+	char path[PATH_MAX];
+	if (!get_path_in_cache_dir_subpath(subpath, filename, path, sizeof(path))) {
+		return NULL;
+	}
+
+	return u_file_read_content_from_path(path, out_file_size);
+}
+
+bool
+u_file_write_file_in_cache_dir_subpath(const char *subpath,
+                                       const char *filename,
+                                       const void *header,
+                                       size_t header_size,
+                                       const void *data,
+                                       size_t data_size)
+{
+	char tmp_filename[PATH_MAX];
+	int i = snprintf(tmp_filename, sizeof(tmp_filename), "%s.tmp", filename);
+	if (i < 0 || i >= (int)sizeof(tmp_filename)) {
+		return false;
+	}
+
+	char path[PATH_MAX];
+	char tmp_path[PATH_MAX];
+	if (!get_path_in_cache_dir_subpath(subpath, filename, path, sizeof(path)) ||
+	    !get_path_in_cache_dir_subpath(subpath, tmp_filename, tmp_path, sizeof(tmp_path))) {
+		return false;
+	}
+
+	// Creates the directory if needed.
+	FILE *file = u_file_open_file_in_cache_dir_subpath(subpath, tmp_filename, "wb");
+	if (file == NULL) {
+		return false;
+	}
+
+	bool written = (header_size == 0 || fwrite(header, header_size, 1, file) == 1) && //
+	               (data_size == 0 || fwrite(data, data_size, 1, file) == 1);
+	written = fclose(file) == 0 && written;
+
+	// Rename is atomic, readers never see a half written file.
+	if (!written || rename(tmp_path, path) != 0) {
+		remove(tmp_path);
+		return false;
+	}
+
+	return true;
+}
+
 int
 u_file_get_hand_tracking_models_dir(char *out_path, size_t out_path_size)
 {
@@ -192,6 +300,36 @@ u_file_get_hand_tracking_models_dir(char *out_path, size_t out_path_size)
 	return ret;
 }
 
+#else /* XRT_OS_LINUX */
+
+// No cache dir on other platforms yet, the caches just always miss.
+
+char *
+u_file_read_file_in_cache_dir_subpath(const char *subpath, const char *filename, size_t *out_file_size)
+{
+	(void)subpath;
+	(void)filename;
+	(void)out_file_size;
+	return NULL;
+}
+
+bool
+u_file_write_file_in_cache_dir_subpath(const char *subpath,
+                                       const char *filename,
+                                       const void *header,
+                                       size_t header_size,
+                                       const void *data,
+                                       size_t data_size)
+{
+	(void)subpath;
+	(void)filename;
+	(void)header;
+	(void)header_size;
+	(void)data;
+	(void)data_size;
+	return false;
+}
+
 #endif /* XRT_OS_LINUX */
 
 int
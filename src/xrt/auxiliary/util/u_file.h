@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdio.h>
 
 #ifdef __cplusplus
@@ -27,6 +28,38 @@ u_file_open_file_in_config_dir(const char *filename, const char *mode);
 FILE *
 u_file_open_file_in_config_dir_subpath(const char *subpath, const char *filename, const char *mode);
 
+int
+u_file_get_cache_dir(char *out_path, size_t out_path_size);
+
+int
+u_file_get_path_in_cache_dir(const char *suffix, char *out_path, size_t out_path_size);
+
+FILE *
+u_file_open_file_in_cache_dir_subpath(const char *subpath, const char *filename, const char *mode);
+
+/*!
+ * Read all of @p filename in @p subpath of the cache dir, see
+ * @ref u_file_read_content for the returned buffer. Returns NULL if missing
+ * and always on platforms without a cache dir.
+ */
+char *
+u_file_read_file_in_cache_dir_subpath(const char *subpath, const char *filename, size_t *out_file_size);
+
+/*!
+ * Write @p header followed by @p data to @p filename in @p subpath of the
+ * cache dir, creating the directory if needed. The file is written under a
+ * temporary name and renamed into place, so readers only ever see the old or
+ * the complete new file. @p header may be NULL if @p header_size is zero.
+ * Always fails on platforms without a cache dir.
+ */
+bool
+u_file_write_file_in_cache_dir_subpath(const char *subpath,
+                                       const char *filename,
+                                       const void *header,
+                                       size_t header_size,
+                                       const void *data,
+                                       size_t data_size);
+
 int
 u_file_get_hand_tracking_models_dir(char *out_path, size_t out_path_size);
 
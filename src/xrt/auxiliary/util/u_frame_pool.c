@@ -0,0 +1,274 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Pool of reusable @ref xrt_frame with allocated pixel data.
+ * @ingroup aux_util
+ */
+
+#include "os/os_threading.h"
+
+#include "util/u_var.h"
+#include "util/u_misc.h"
+#include "util/u_frame.h"
+#include "util/u_format.h"
+#include "util/u_frame_pool.h"
+
+#include <assert.h>
+
+
+/*!
+ * A frame that belongs to a @ref u_frame_pool.
+ *
+ * @implements xrt_frame
+ */
+struct u_pool_frame
+{
+	struct xrt_frame base;
+
+	//! Pool that this frame returns to, holds a reference while in use.
+	struct u_frame_pool *pool;
+
+	//! Next unused frame, only valid while on the free list.
+	struct u_pool_frame *next;
+};
+
+struct u_frame_pool
+{
+	//! One for the owner and one for every frame in use.
+	struct xrt_reference reference;
+
+	//! Protects all fields below.
+	struct os_mutex mutex;
+
+	//! Unused frames, most recently returned first.
+	struct u_pool_frame *free_list;
+
+	uint32_t free_count;
+	uint32_t max_free;
+
+	//! Set when the owner has destroyed the pool, frames are freed on return.
+	bool destroyed;
+
+	struct
+	{
+		uint64_t reused;
+		uint64_t allocated;
+		uint64_t freed;
+		uint64_t bytes_reused;
+		uint32_t in_use;
+		uint32_t free;
+	} stats;
+};
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+static void
+free_pool_frame(struct u_pool_frame *pf)
+{
+	free(pf->base.data);
+	free(pf);
+}
+
+static void
+pool_unref(struct u_frame_pool *pool)
+{
+	if (!xrt_reference_dec_and_is_zero(&pool->reference)) {
+		return;
+	}
+
+	assert(pool->free_list == NULL);
+
+	os_mutex_destroy(&pool->mutex);
+	free(pool);
+}
+
+static void
+pool_frame_destroy(struct xrt_frame *xf)
+{
+	struct u_pool_frame *pf = container_of(xf, struct u_pool_frame, base);
+	struct u_frame_pool *pool = pf->pool;
+	struct u_pool_frame *to_free = NULL;
+
+	assert(xf->reference.count == 0);
+
+	os_mutex_lock(&pool->mutex);
+
+	pool->stats.in_use--;
+
+	if (pool->destroyed || pool->max_free == 0) {
+		to_free = pf;
+	} else {
+		if (pool->free_count >= pool->max_free) {
+			// Evict the oldest frame, it has gone unused the longest.
+			struct u_pool_frame **it = &pool->free_list;
+			while ((*it)->next != NULL) {
+				it = &(*it)->next;
+			}
+			to_free = *it;
+			*it = NULL;
+			pool->free_count--;
+		}
+
+		pf->next = pool->free_list;
+		pool->free_list = pf;
+		pool->free_count++;
+	}
+
+	if (to_free != NULL) {
+		pool->stats.freed++;
+	}
+	pool->stats.free = pool->free_count;
+
+	os_mutex_unlock(&pool->mutex);
+
+	if (to_free != NULL) {
+		free_pool_frame(to_free);
+	}
+
+	pool_unref(pool);
+}
+
+static struct u_pool_frame *
+take_matching_locked(struct u_frame_pool *pool, enum xrt_format f, uint32_t width, uint32_t height)
+{
+	for (struct u_pool_frame **it = &pool->free_list; *it != NULL; it = &(*it)->next) {
+		struct u_pool_frame *pf = *it;
+		if (pf->base.format != f || pf->base.width != width || pf->base.height != height) {
+			continue;
+		}
+
+		*it = pf->next;
+		pf->next = NULL;
+		pool->free_count--;
+		return pf;
+	}
+
+	return NULL;
+}
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+void
+u_frame_pool_create(const char *name, uint32_t max_free, struct u_frame_pool **out_pool)
+{
+	struct u_frame_pool *pool = U_TYPED_CALLOC(struct u_frame_pool);
+
+	int ret = os_mutex_init(&pool->mutex);
+	if (ret != 0) {
+		free(pool);
+		*out_pool = NULL;
+		return;
+	}
+
+	pool->reference.count = 1;
+	pool->max_free = max_free;
+
+	u_var_add_root(pool, name, true);
+	u_var_add_ro_u64(pool, &pool->stats.reused, "Reused");
+	u_var_add_ro_u64(pool, &pool->stats.allocated, "Allocated");
+	u_var_add_ro_u64(pool, &pool->stats.freed, "Freed");
+	u_var_add_ro_u64(pool, &pool->stats.bytes_reused, "Bytes reused");
+	u_var_add_ro_u32(pool, &pool->stats.in_use, "In use");
+	u_var_add_ro_u32(pool, &pool->stats.free, "Free");
+
+	*out_pool = pool;
+}
+
+void
+u_frame_pool_destroy(struct u_frame_pool **pool_ptr)
+{
+	struct u_frame_pool *pool = *pool_ptr;
+	if (pool == NULL) {
+		return;
+	}
+
+	u_var_remove_root(pool);
+
+	os_mutex_lock(&pool->mutex);
+	pool->destroyed = true;
+	struct u_pool_frame *list = pool->free_list;
+	pool->free_list = NULL;
+	pool->free_count = 0;
+	os_mutex_unlock(&pool->mutex);
+
+	while (list != NULL) {
+		struct u_pool_frame *next = list->next;
+		free_pool_frame(list);
+		list = next;
+	}
+
+	pool_unref(pool);
+
+	*pool_ptr = NULL;
+}
+
+void
+u_frame_pool_create_frame(struct u_frame_pool *pool,
+                          enum xrt_format f,
+                          uint32_t width,
+                          uint32_t height,
+                          struct xrt_frame **out_frame)
+{
+	if (pool == NULL) {
+		u_frame_create_one_off(f, width, height, out_frame);
+		return;
+	}
+
+	assert(width > 0);
+	assert(height > 0);
+	assert(u_format_is_blocks(f));
+
+	os_mutex_lock(&pool->mutex);
+	struct u_pool_frame *pf = take_matching_locked(pool, f, width, height);
+	if (pf != NULL) {
+		pool->stats.reused++;
+		pool->stats.bytes_reused += pf->base.size;
+	} else {
+		pool->stats.allocated++;
+	}
+	pool->stats.in_use++;
+	pool->stats.free = pool->free_count;
+	os_mutex_unlock(&pool->mutex);
+
+	if (pf == NULL) {
+		pf = U_TYPED_CALLOC(struct u_pool_frame);
+		pf->base.format = f;
+		pf->base.width = width;
+		pf->base.height = height;
+
+		u_format_size_for_dimensions(f, width, height, &pf->base.stride, &pf->base.size);
+
+		pf->base.data = (uint8_t *)malloc(pf->base.size);
+	}
+
+	// Reset everything but the allocation.
+	struct xrt_frame *xf = &pf->base;
+	uint8_t *data = xf->data;
+	size_t stride = xf->stride;
+	size_t size = xf->size;
+
+	U_ZERO(xf);
+	xf->format = f;
+	xf->width = width;
+	xf->height = height;
+	xf->stride = stride;
+	xf->size = size;
+	xf->data = data;
+	xf->destroy = pool_frame_destroy;
+
+	pf->pool = pool;
+	xrt_reference_inc(&pool->reference);
+
+	xrt_frame_reference(out_frame, xf);
+}
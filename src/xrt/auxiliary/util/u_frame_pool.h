@@ -0,0 +1,65 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Pool of reusable @ref xrt_frame with allocated pixel data.
+ * @ingroup aux_util
+ */
+
+#pragma once
+
+#include "xrt/xrt_frame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*!
+ * A pool of frames, when the last reference to a frame from the pool is
+ * dropped the frame and its pixel data is returned to the pool instead of
+ * being freed. Frames are reused when format, width and height match.
+ *
+ * Every frame handed out holds a reference to the pool, so it is safe to
+ * destroy the pool while frames are still being held downstream.
+ *
+ * @ingroup aux_util
+ */
+struct u_frame_pool;
+
+/*!
+ * Create a frame pool, keeping at most @p max_free unused frames around.
+ * @p name is used for the @ref u_var root holding the pool's statistics.
+ *
+ * @public @memberof u_frame_pool
+ */
+void
+u_frame_pool_create(const char *name, uint32_t max_free, struct u_frame_pool **out_pool);
+
+/*!
+ * Drop the owners reference to the pool and free all unused frames, frames
+ * still in use are freed when their last reference is dropped.
+ *
+ * @public @memberof u_frame_pool
+ */
+void
+u_frame_pool_destroy(struct u_frame_pool **pool_ptr);
+
+/*!
+ * Get a frame of the given format and size, the contents of the pixel data
+ * is undefined just like with @ref u_frame_create_one_off. If @p pool is NULL
+ * this falls back to @ref u_frame_create_one_off.
+ *
+ * @public @memberof u_frame_pool
+ */
+void
+u_frame_pool_create_frame(struct u_frame_pool *pool,
+                          enum xrt_format f,
+                          uint32_t width,
+                          uint32_t height,
+                          struct xrt_frame **out_frame);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,4 +1,4 @@
-// Copyright 2019-2020, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -286,16 +286,14 @@ zldtt(const struct xrt_vec3 *trans, const struct xrt_quat *orientation, bool is_
 
 
 static void
-our_eval_to_viz_hand(struct u_hand_sim_hand *opt,
-                     struct translations55 *translations_absolute,
-                     struct orientations54 *orientations_absolute,
+our_eval_to_viz_hand(const struct u_hand_sim_hand *opt,
+                     const struct translations55 *translations_absolute,
+                     const struct orientations54 *orientations_absolute,
                      bool is_right,
                      struct xrt_hand_joint_set *out_viz_hand)
 {
 	XRT_TRACE_MARKER();
 
-	eval_hand_with_orientation(opt, is_right, translations_absolute, orientations_absolute);
-
 	struct xrt_quat final_wrist_orientation = XRT_QUAT_IDENTITY;
 
 	int joint_acc_idx = 0;
@@ -306,7 +304,7 @@ our_eval_to_viz_hand(struct u_hand_sim_hand *opt,
 	palm_position.y = (translations_absolute->t[2][0].y + translations_absolute->t[2][1].y) / 2;
 	palm_position.z = (translations_absolute->t[2][0].z + translations_absolute->t[2][1].z) / 2;
 
-	struct xrt_quat *palm_orientation = &orientations_absolute->q[2][0];
+	const struct xrt_quat *palm_orientation = &orientations_absolute->q[2][0];
 
 	zldtt(&palm_position, palm_orientation, is_right,
 	      &out_viz_hand->values.hand_joint_set_default[joint_acc_idx++].relation);
@@ -321,7 +319,7 @@ our_eval_to_viz_hand(struct u_hand_sim_hand *opt,
 			if (finger == 0 && joint == 0) {
 				continue;
 			}
-			struct xrt_quat *orientation;
+			const struct xrt_quat *orientation;
 			if (joint != 4) {
 				orientation = &orientations_absolute->q[finger][joint];
 			} else {
@@ -335,12 +333,14 @@ our_eval_to_viz_hand(struct u_hand_sim_hand *opt,
 }
 
 static void
-hand_sim_hand_init(struct u_hand_sim_hand *out_opt, enum xrt_hand xhand, const struct xrt_space_relation *root_pose)
+hand_sim_hand_init(struct u_hand_sim_hand *out_opt, enum xrt_hand xhand)
 {
+	// Fully zeroed, padding included, so the cache can compare it with memcmp.
+	U_ZERO(out_opt);
+
 	out_opt->hand_size = 0.095f;
 
 	out_opt->is_right = xhand == XRT_HAND_RIGHT;
-	out_opt->hand_pose = *root_pose;
 
 	for (int i = 0; i < 4; i++) {
 		//!@todo needed?
@@ -370,6 +370,48 @@ hand_sim_hand_init(struct u_hand_sim_hand *out_opt, enum xrt_hand xhand, const s
 	out_opt->finger[3].proximal_swing.y = 0.02f;
 }
 
+static void
+set_hand_pose(struct xrt_hand_joint_set *out_set, const struct xrt_space_relation *hand_pose)
+{
+	out_set->hand_pose = *hand_pose;
+
+	out_set->hand_pose.relation_flags = (enum xrt_space_relation_flags)(
+	    XRT_SPACE_RELATION_ORIENTATION_VALID_BIT | XRT_SPACE_RELATION_ORIENTATION_TRACKED_BIT |
+	    XRT_SPACE_RELATION_POSITION_VALID_BIT | XRT_SPACE_RELATION_POSITION_TRACKED_BIT);
+
+	out_set->is_active = true;
+}
+
+/*!
+ * The joints only depend on @p params and are relative to the hand pose, so
+ * only the hand pose is set from @p root_pose on a cache hit.
+ */
+static void
+simulate_cached(struct u_hand_sim_cache *cache,
+                const struct u_hand_sim_hand *params,
+                const struct xrt_space_relation *root_pose,
+                struct xrt_hand_joint_set *out_set)
+{
+	XRT_TRACE_MARKER();
+
+	size_t index = params->is_right ? 1 : 0;
+
+	os_mutex_lock(&cache->mutex);
+
+	if (!cache->hands[index].valid || memcmp(&cache->hands[index].params, params, sizeof(*params)) != 0) {
+		// Copy with memcpy to keep the padding for the compare.
+		memcpy(&cache->hands[index].params, params, sizeof(*params));
+		u_hand_sim_simulate(&cache->hands[index].params, &cache->hands[index].joints);
+		cache->hands[index].valid = true;
+	}
+
+	*out_set = cache->hands[index].joints;
+
+	os_mutex_unlock(&cache->mutex);
+
+	set_hand_pose(out_set, root_pose);
+}
+
 
 void
 u_hand_sim_simulate(struct u_hand_sim_hand *hand_ptr, struct xrt_hand_joint_set *out_set)
@@ -383,36 +425,25 @@ u_hand_sim_simulate(struct u_hand_sim_hand *hand_ptr, struct xrt_hand_joint_set
 
 	u_hand_joints_apply_joint_width(out_set);
 
-	out_set->hand_pose = hand_ptr->hand_pose;
-
-	out_set->hand_pose.relation_flags = (enum xrt_space_relation_flags)(
-	    XRT_SPACE_RELATION_ORIENTATION_VALID_BIT | XRT_SPACE_RELATION_ORIENTATION_TRACKED_BIT |
-	    XRT_SPACE_RELATION_POSITION_VALID_BIT | XRT_SPACE_RELATION_POSITION_TRACKED_BIT);
-
-	out_set->is_active = true;
+	set_hand_pose(out_set, &hand_ptr->hand_pose);
 }
 
-void
-u_hand_sim_simulate_for_valve_index_knuckles(const struct u_hand_tracking_curl_values *values,
-                                             enum xrt_hand xhand,
-                                             const struct xrt_space_relation *root_pose,
-                                             struct xrt_hand_joint_set *out_set)
+static void
+knuckles_params(const struct u_hand_tracking_curl_values *values, enum xrt_hand xhand, struct u_hand_sim_hand *out_hand)
 {
-	struct u_hand_sim_hand hand;
+	hand_sim_hand_init(out_hand, xhand);
+	out_hand->wrist_pose.pose.position.x = 0.f;
+	out_hand->wrist_pose.pose.position.y = 0.f;
+	out_hand->wrist_pose.pose.position.z = 0.f;
 
-	hand_sim_hand_init(&hand, xhand, root_pose);
-	hand.wrist_pose.pose.position.x = 0.f;
-	hand.wrist_pose.pose.position.y = 0.f;
-	hand.wrist_pose.pose.position.z = 0.f;
-
-	hand.hand_size = 0.095;
+	out_hand->hand_size = 0.095;
 
 	// Thumb
-	hand.thumb.metacarpal.swing.x += values->thumb * 0.08f;
-	hand.thumb.metacarpal.swing.y += -0.35f;
-	hand.thumb.metacarpal.twist = 0;
-	hand.thumb.rotations[0] += values->thumb * -1.57f;
-	hand.thumb.rotations[1] += values->thumb * -1.4f;
+	out_hand->thumb.metacarpal.swing.x += values->thumb * 0.08f;
+	out_hand->thumb.metacarpal.swing.y += -0.35f;
+	out_hand->thumb.metacarpal.twist = 0;
+	out_hand->thumb.rotations[0] += values->thumb * -1.57f;
+	out_hand->thumb.rotations[1] += values->thumb * -1.4f;
 
 	// Index finger - this is treated differently on Valve Knuckles controllers so the pinch gesture feels good
 	float finger_values[4] = {values->index, values->middle, values->ring, values->little};
@@ -420,17 +451,28 @@ u_hand_sim_simulate_for_valve_index_knuckles(const struct u_hand_tracking_curl_v
 	{
 		int finger = 0;
 		float val_turn = finger_values[finger] * -1.1f;
-		hand.finger[finger].proximal_swing.x = val_turn * 1.3f;
-		hand.finger[finger].rotations[0] = val_turn;
-		hand.finger[finger].rotations[1] = val_turn;
+		out_hand->finger[finger].proximal_swing.x = val_turn * 1.3f;
+		out_hand->finger[finger].rotations[0] = val_turn;
+		out_hand->finger[finger].rotations[1] = val_turn;
 	}
 
 	for (int finger = 1; finger < 4; finger++) {
 		float val_turn = finger_values[finger] * -1.1f * 1.3f;
-		hand.finger[finger].proximal_swing.x = val_turn * 1.3f;
-		hand.finger[finger].rotations[0] = val_turn * 1.0f;
-		hand.finger[finger].rotations[1] = val_turn * 0.4f;
+		out_hand->finger[finger].proximal_swing.x = val_turn * 1.3f;
+		out_hand->finger[finger].rotations[0] = val_turn * 1.0f;
+		out_hand->finger[finger].rotations[1] = val_turn * 0.4f;
 	}
+}
+
+void
+u_hand_sim_simulate_for_valve_index_knuckles(const struct u_hand_tracking_curl_values *values,
+                                             enum xrt_hand xhand,
+                                             const struct xrt_space_relation *root_pose,
+                                             struct xrt_hand_joint_set *out_set)
+{
+	struct u_hand_sim_hand hand;
+	knuckles_params(values, xhand, &hand);
+	hand.hand_pose = *root_pose;
 
 	u_hand_sim_simulate(&hand, out_set);
 }
@@ -448,6 +490,30 @@ u_hand_sim_apply_generic_finger_transform(const struct u_hand_tracking_finger_va
 	out_finger->rotations[1] = finger_value->joint_curls[3] * -1.f;
 }
 
+static void
+generic_params(const struct u_hand_tracking_values *values, enum xrt_hand xhand, struct u_hand_sim_hand *out_hand)
+{
+	hand_sim_hand_init(out_hand, xhand);
+	out_hand->wrist_pose.pose.position.x = 0.f;
+	out_hand->wrist_pose.pose.position.y = 0.f;
+	out_hand->wrist_pose.pose.position.z = 0.f;
+
+	out_hand->hand_size = 0.095;
+
+	// Thumb
+	out_hand->thumb.metacarpal.swing.x += values->thumb.joint_curls[0] * 0.08f; // curl
+
+	out_hand->thumb.metacarpal.swing.y += values->thumb.splay; // splay
+	out_hand->thumb.metacarpal.twist = 0;
+	out_hand->thumb.rotations[0] += values->thumb.joint_curls[1] * -1.f;
+	out_hand->thumb.rotations[1] += values->thumb.joint_curls[2] * -1.f;
+
+	u_hand_sim_apply_generic_finger_transform(&values->little, &out_hand->finger[3]);
+	u_hand_sim_apply_generic_finger_transform(&values->ring, &out_hand->finger[2]);
+	u_hand_sim_apply_generic_finger_transform(&values->middle, &out_hand->finger[1]);
+	u_hand_sim_apply_generic_finger_transform(&values->index, &out_hand->finger[0]);
+}
+
 void
 u_hand_sim_simulate_generic(const struct u_hand_tracking_values *values,
                             enum xrt_hand xhand,
@@ -455,26 +521,55 @@ u_hand_sim_simulate_generic(const struct u_hand_tracking_values *values,
                             struct xrt_hand_joint_set *out_set)
 {
 	struct u_hand_sim_hand hand;
+	generic_params(values, xhand, &hand);
+	hand.hand_pose = *root_pose;
 
-	hand_sim_hand_init(&hand, xhand, root_pose);
-	hand.wrist_pose.pose.position.x = 0.f;
-	hand.wrist_pose.pose.position.y = 0.f;
-	hand.wrist_pose.pose.position.z = 0.f;
+	u_hand_sim_simulate(&hand, out_set);
+}
 
-	hand.hand_size = 0.095;
 
-	// Thumb
-	hand.thumb.metacarpal.swing.x += values->thumb.joint_curls[0] * 0.08f; // curl
+/*
+ *
+ * Cache.
+ *
+ */
 
-	hand.thumb.metacarpal.swing.y += values->thumb.splay; // splay
-	hand.thumb.metacarpal.twist = 0;
-	hand.thumb.rotations[0] += values->thumb.joint_curls[1] * -1.f;
-	hand.thumb.rotations[1] += values->thumb.joint_curls[2] * -1.f;
+int
+u_hand_sim_cache_init(struct u_hand_sim_cache *cache)
+{
+	U_ZERO(&cache->hands);
 
-	u_hand_sim_apply_generic_finger_transform(&values->little, &hand.finger[3]);
-	u_hand_sim_apply_generic_finger_transform(&values->ring, &hand.finger[2]);
-	u_hand_sim_apply_generic_finger_transform(&values->middle, &hand.finger[1]);
-	u_hand_sim_apply_generic_finger_transform(&values->index, &hand.finger[0]);
+	return os_mutex_init(&cache->mutex);
+}
 
-	u_hand_sim_simulate(&hand, out_set);
+void
+u_hand_sim_cache_fini(struct u_hand_sim_cache *cache)
+{
+	os_mutex_destroy(&cache->mutex);
+}
+
+void
+u_hand_sim_simulate_for_valve_index_knuckles_cached(struct u_hand_sim_cache *cache,
+                                                    const struct u_hand_tracking_curl_values *values,
+                                                    enum xrt_hand xhand,
+                                                    const struct xrt_space_relation *root_pose,
+                                                    struct xrt_hand_joint_set *out_set)
+{
+	struct u_hand_sim_hand params;
+	knuckles_params(values, xhand, &params);
+
+	simulate_cached(cache, &params, root_pose, out_set);
+}
+
+void
+u_hand_sim_simulate_generic_cached(struct u_hand_sim_cache *cache,
+                                   const struct u_hand_tracking_values *values,
+                                   enum xrt_hand xhand,
+                                   const struct xrt_space_relation *root_pose,
+                                   struct xrt_hand_joint_set *out_set)
+{
+	struct u_hand_sim_hand params;
+	generic_params(values, xhand, &params);
+
+	simulate_cached(cache, &params, root_pose, out_set);
 }
@@ -1,4 +1,4 @@
-// Copyright 2019-2020, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -11,6 +11,8 @@
 
 #include "xrt/xrt_defines.h"
 
+#include "os/os_threading.h"
+
 #include "util/u_misc.h"
 #include "util/u_hand_tracking.h"
 
@@ -51,6 +53,31 @@ struct u_hand_sim_hand
 	struct u_hand_sim_finger finger[4];
 };
 
+/*!
+ * Remembers the last simulated joints of each hand, the joints only depend on
+ * the finger values and are relative to the hand pose. So when the same finger
+ * values are simulated again, say by another client in the same frame, only
+ * the hand pose needs to be updated. Embed in the device and init/fini it with
+ * the device, safe to use from multiple threads.
+ *
+ * @ingroup aux_util
+ */
+struct u_hand_sim_cache
+{
+	struct os_mutex mutex;
+
+	struct
+	{
+		//! Has @p joints been simulated from @p params.
+		bool valid;
+
+		//! Parameters the joints were simulated from, hand_pose is always zeroed.
+		struct u_hand_sim_hand params;
+
+		struct xrt_hand_joint_set joints;
+	} hands[2];
+};
+
 
 void
 u_hand_sim_simulate(struct u_hand_sim_hand *hand, struct xrt_hand_joint_set *out_set);
@@ -67,6 +94,44 @@ u_hand_sim_simulate_generic(const struct u_hand_tracking_values *values,
                             const struct xrt_space_relation *root_pose,
                             struct xrt_hand_joint_set *out_set);
 
+/*!
+ * @public @memberof u_hand_sim_cache
+ */
+int
+u_hand_sim_cache_init(struct u_hand_sim_cache *cache);
+
+/*!
+ * @public @memberof u_hand_sim_cache
+ */
+void
+u_hand_sim_cache_fini(struct u_hand_sim_cache *cache);
+
+/*!
+ * Same as @ref u_hand_sim_simulate_for_valve_index_knuckles but reuses the
+ * joints in @p cache if the curl values are unchanged.
+ *
+ * @public @memberof u_hand_sim_cache
+ */
+void
+u_hand_sim_simulate_for_valve_index_knuckles_cached(struct u_hand_sim_cache *cache,
+                                                    const struct u_hand_tracking_curl_values *values,
+                                                    enum xrt_hand xhand,
+                                                    const struct xrt_space_relation *root_pose,
+                                                    struct xrt_hand_joint_set *out_set);
+
+/*!
+ * Same as @ref u_hand_sim_simulate_generic but reuses the joints in @p cache
+ * if the finger values are unchanged.
+ *
+ * @public @memberof u_hand_sim_cache
+ */
+void
+u_hand_sim_simulate_generic_cached(struct u_hand_sim_cache *cache,
+                                   const struct u_hand_tracking_values *values,
+                                   enum xrt_hand xhand,
+                                   const struct xrt_space_relation *root_pose,
+                                   struct xrt_hand_joint_set *out_set);
+
 #ifdef __cplusplus
 }
 #endif
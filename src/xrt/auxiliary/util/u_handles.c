@@ -9,6 +9,8 @@
  *
  */
 
+#include "xrt/xrt_config_os.h"
+
 #include "u_handles.h"
 
 /*
@@ -34,9 +36,21 @@ ref_graphics_handle(xrt_graphics_buffer_handle_t handle)
 	return handle;
 }
 
+static inline bool
+is_same_graphics_handle(xrt_graphics_buffer_handle_t a, xrt_graphics_buffer_handle_t b)
+{
+	// Buffers received over a socket are new objects, so this only catches our own references.
+	return a == b;
+}
+
 #elif defined(XRT_GRAPHICS_BUFFER_HANDLE_IS_FD)
 #include <unistd.h>
 
+#ifdef XRT_OS_LINUX
+#include <linux/kcmp.h>
+#include <sys/syscall.h>
+#endif
+
 static inline void
 release_graphics_handle(xrt_graphics_buffer_handle_t handle)
 {
@@ -49,6 +63,22 @@ ref_graphics_handle(xrt_graphics_buffer_handle_t handle)
 	return dup(handle);
 }
 
+static inline bool
+is_same_graphics_handle(xrt_graphics_buffer_handle_t a, xrt_graphics_buffer_handle_t b)
+{
+#ifdef XRT_OS_LINUX
+	/*
+	 * File descriptors passed over a socket or dup'ed share the open file
+	 * description, that is what kcmp compares. Fails if the kernel is built
+	 * without it, then we just don't know.
+	 */
+	pid_t pid = getpid();
+	return syscall(SYS_kcmp, pid, pid, KCMP_FILE, a, b) == 0;
+#else
+	return a == b;
+#endif
+}
+
 #elif defined(XRT_GRAPHICS_BUFFER_HANDLE_IS_WIN32_HANDLE)
 
 static inline void
@@ -68,6 +98,16 @@ ref_graphics_handle(xrt_graphics_buffer_handle_t handle)
 	return NULL;
 }
 
+static inline bool
+is_same_graphics_handle(xrt_graphics_buffer_handle_t a, xrt_graphics_buffer_handle_t b)
+{
+#if defined(_WIN32_WINNT_WIN10) && _WIN32_WINNT >= _WIN32_WINNT_WIN10
+	return a == b || CompareObjectHandles(a, b);
+#else
+	return a == b;
+#endif
+}
+
 #else
 #error "need port"
 #endif
@@ -96,6 +136,16 @@ u_graphics_buffer_unref(xrt_graphics_buffer_handle_t *handle_ptr)
 	*handle_ptr = XRT_GRAPHICS_BUFFER_HANDLE_INVALID;
 }
 
+bool
+u_graphics_buffer_is_same(xrt_graphics_buffer_handle_t a, xrt_graphics_buffer_handle_t b)
+{
+	if (!xrt_graphics_buffer_is_valid(a) || !xrt_graphics_buffer_is_valid(b)) {
+		return false;
+	}
+
+	return is_same_graphics_handle(a, b);
+}
+
 /*
  *
  * Graphics Sync Handles
@@ -44,6 +44,16 @@ u_graphics_buffer_ref(xrt_graphics_buffer_handle_t handle);
 void
 u_graphics_buffer_unref(xrt_graphics_buffer_handle_t *handle);
 
+/*!
+ * Do the two handles refer to the same underlying buffer. Returns false if it
+ * can't be told, so might miss that they are the same but never claims they
+ * are when they are not.
+ *
+ * @public @memberof xrt_graphics_buffer_handle_t
+ */
+bool
+u_graphics_buffer_is_same(xrt_graphics_buffer_handle_t a, xrt_graphics_buffer_handle_t b);
+
 /*!
  * Increase the reference count on the sync handle, returning the new
  * reference.
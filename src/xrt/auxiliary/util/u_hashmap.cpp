@@ -9,23 +9,54 @@
  */
 
 #include "util/u_hashmap.h"
+#include "util/u_hashtable_impl_helpers.hpp"
 
-#include <unordered_map>
 #include <vector>
 
 
+using xrt::auxiliary::util::detail::RobinHoodTable;
+
+
 /*
  *
  * Private structs and defines.
  *
  */
 
+struct hashmap_entry
+{
+	uint64_t key;
+	void *value;
+};
+
 struct u_hashmap_int
 {
-	std::unordered_map<uint64_t, void *> map = {};
+	RobinHoodTable<hashmap_entry> map = {};
 };
 
 
+/*
+ *
+ * Helpers.
+ *
+ */
+
+/*!
+ * The keys are often small consecutive ids or pointers, mix all bits so they
+ * spread over the low bits used to pick the ideal slot (splitmix64 finalizer).
+ */
+static inline size_t
+hash_key(uint64_t key)
+{
+	key ^= key >> 30;
+	key *= 0xbf58476d1ce4e5b9ULL;
+	key ^= key >> 27;
+	key *= 0x94d049bb133111ebULL;
+	key ^= key >> 31;
+	return (size_t)key;
+}
+
+
 /*
  *
  * "Exported" functions.
@@ -51,10 +82,10 @@ u_hashmap_int_destroy(struct u_hashmap_int **hmi)
 int
 u_hashmap_int_find(struct u_hashmap_int *hmi, uint64_t key, void **out_item)
 {
-	auto search = hmi->map.find(key);
+	hashmap_entry *entry = hmi->map.find(hash_key(key), [key](const hashmap_entry &e) { return e.key == key; });
 
-	if (search != hmi->map.end()) {
-		*out_item = search->second;
+	if (entry != nullptr) {
+		*out_item = entry->value;
 		return 0;
 	}
 	return -1;
@@ -63,14 +94,22 @@ u_hashmap_int_find(struct u_hashmap_int *hmi, uint64_t key, void **out_item)
 extern "C" int
 u_hashmap_int_insert(struct u_hashmap_int *hmi, uint64_t key, void *value)
 {
-	hmi->map[key] = value;
+	size_t hash = hash_key(key);
+
+	hashmap_entry *entry = hmi->map.find(hash, [key](const hashmap_entry &e) { return e.key == key; });
+	if (entry != nullptr) {
+		entry->value = value;
+		return 0;
+	}
+
+	hmi->map.insert_new(hash, hashmap_entry{key, value});
 	return 0;
 }
 
 extern "C" int
 u_hashmap_int_erase(struct u_hashmap_int *hmi, uint64_t key)
 {
-	hmi->map.erase(key);
+	hmi->map.erase(hash_key(key), [key](const hashmap_entry &e) { return e.key == key; });
 	return 0;
 }
 
@@ -85,9 +124,7 @@ u_hashmap_int_for_each(const struct u_hashmap_int *hmi, u_hashmap_int_foreach_ca
 {
 	if (hmi == NULL || cb == NULL)
 		return;
-	for (const auto &keyval : hmi->map) {
-		cb(keyval.first, keyval.second, priv_ctx);
-	}
+	hmi->map.for_each([&](const hashmap_entry &e) { cb(e.key, e.value, priv_ctx); });
 }
 
 extern "C" void
@@ -96,9 +133,7 @@ u_hashmap_int_clear_and_call_for_each(struct u_hashmap_int *hmi, u_hashmap_int_c
 	std::vector<void *> tmp;
 	tmp.reserve(hmi->map.size());
 
-	for (auto &n : hmi->map) {
-		tmp.push_back(n.second);
-	}
+	hmi->map.for_each([&](const hashmap_entry &e) { tmp.push_back(e.value); });
 
 	hmi->map.clear();
 
@@ -9,13 +9,17 @@
 
 #include "util/u_misc.h"
 #include "util/u_hashset.h"
+#include "util/u_hashtable_impl_helpers.hpp"
 
 #include <cstring>
-#include <string>
-#include <unordered_map>
+#include <functional>
+#include <string_view>
 #include <vector>
 
 
+using xrt::auxiliary::util::detail::RobinHoodTable;
+
+
 /*
  *
  * Private structs and defines.
@@ -24,10 +28,48 @@
 
 struct u_hashset
 {
-	std::unordered_map<std::string, struct u_hashset_item *> map = {};
+	RobinHoodTable<struct u_hashset_item *> map = {};
 };
 
 
+/*
+ *
+ * Helpers.
+ *
+ */
+
+static inline size_t
+hash_str(const char *str, size_t length)
+{
+	return std::hash<std::string_view>{}(std::string_view(str, length));
+}
+
+/*!
+ * Matches items by string, the hash has already been compared by the table.
+ */
+static inline auto
+match_str(const char *str, size_t length)
+{
+	return [str, length](struct u_hashset_item *const &item) {
+		return item->length == length && memcmp(item->c_str(), str, length) == 0;
+	};
+}
+
+static void
+insert_or_replace(struct u_hashset *hs, struct u_hashset_item *item)
+{
+	item->hash = hash_str(item->c_str(), item->length);
+
+	struct u_hashset_item **found = hs->map.find(item->hash, match_str(item->c_str(), item->length));
+	if (found != nullptr) {
+		*found = item;
+		return;
+	}
+
+	hs->map.insert_new(item->hash, item);
+}
+
+
 /*
  *
  * "Exported" functions.
@@ -53,11 +95,10 @@ u_hashset_destroy(struct u_hashset **hs)
 extern "C" int
 u_hashset_find_str(struct u_hashset *hs, const char *str, size_t length, struct u_hashset_item **out_item)
 {
-	std::string key = std::string(str, length);
-	auto search = hs->map.find(key);
+	struct u_hashset_item **found = hs->map.find(hash_str(str, length), match_str(str, length));
 
-	if (search != hs->map.end()) {
-		*out_item = search->second;
+	if (found != nullptr) {
+		*out_item = *found;
 		return 0;
 	}
 	return -1;
@@ -73,8 +114,7 @@ u_hashset_find_c_str(struct u_hashset *hs, const char *c_str, struct u_hashset_i
 extern "C" int
 u_hashset_insert_item(struct u_hashset *hs, struct u_hashset_item *item)
 {
-	std::string key = std::string(item->c_str(), item->length);
-	hs->map[key] = item;
+	insert_or_replace(hs, item);
 	return 0;
 }
 
@@ -109,8 +149,8 @@ u_hashset_create_and_insert_str(struct u_hashset *hs, const char *str, size_t le
 	}
 	store[length] = '\0';
 
-	std::string key = std::string(item->c_str(), item->length);
-	hs->map[key] = item;
+	item->hash = hash_str(item->c_str(), item->length);
+	hs->map.insert_new(item->hash, item);
 
 	*out_item = item;
 
@@ -127,16 +167,14 @@ u_hashset_create_and_insert_str_c(struct u_hashset *hs, const char *c_str, struc
 extern "C" int
 u_hashset_erase_item(struct u_hashset *hs, struct u_hashset_item *item)
 {
-	std::string key = std::string(item->c_str(), item->length);
-	hs->map.erase(key);
+	hs->map.erase(hash_str(item->c_str(), item->length), match_str(item->c_str(), item->length));
 	return 0;
 }
 
 extern "C" int
 u_hashset_erase_str(struct u_hashset *hs, const char *str, size_t length)
 {
-	std::string key = std::string(str, length);
-	hs->map.erase(key);
+	hs->map.erase(hash_str(str, length), match_str(str, length));
 	return 0;
 }
 
@@ -153,9 +191,7 @@ u_hashset_clear_and_call_for_each(struct u_hashset *hs, u_hashset_callback cb, v
 	std::vector<struct u_hashset_item *> tmp;
 	tmp.reserve(hs->map.size());
 
-	for (auto &n : hs->map) {
-		tmp.push_back(n.second);
-	}
+	hs->map.for_each([&](struct u_hashset_item *const &item) { tmp.push_back(item); });
 
 	hs->map.clear();
 
@@ -0,0 +1,232 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Open addressing hash table used to implement @ref u_hashmap_int and
+ *         @ref u_hashset.
+ * @ingroup aux_util
+ */
+
+#pragma once
+
+// IWYU pragma: private, include "util/u_hashmap.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+
+namespace xrt::auxiliary::util::detail {
+
+/*!
+ * Open addressing hash table using Robin Hood linear probing and backward
+ * shift deletion. The entries are stored inline in one array together with
+ * their hash, avoiding a node allocation per entry.
+ *
+ * The table doesn't know how to hash or compare the entries, the caller
+ * provides the hash and an equality predicate for every operation.
+ *
+ * @tparam Entry A trivially copyable value type.
+ */
+template <typename Entry> class RobinHoodTable
+{
+public:
+	//! Number of entries in the table.
+	size_t
+	size() const noexcept
+	{
+		return count_;
+	}
+
+	//! Is the table empty?
+	bool
+	empty() const noexcept
+	{
+		return count_ == 0;
+	}
+
+	//! Number of slots allocated, for memory usage statistics.
+	size_t
+	capacity() const noexcept
+	{
+		return slots_.size();
+	}
+
+	/*!
+	 * Find the entry with the given @p hash for which @p equal returns
+	 * true, returns nullptr if there is none.
+	 */
+	template <typename Pred>
+	Entry *
+	find(size_t hash, Pred &&equal) noexcept
+	{
+		size_t index = 0;
+		if (!find_index(hash, equal, index)) {
+			return nullptr;
+		}
+		return &slots_[index].entry;
+	}
+
+	/*!
+	 * Insert an entry, the caller must make sure that it isn't already in
+	 * the table.
+	 */
+	void
+	insert_new(size_t hash, const Entry &entry)
+	{
+		// Keep the load factor at or below 7/8.
+		if ((count_ + 1) * 8 > slots_.size() * 7) {
+			grow();
+		}
+
+		insert_no_grow((uint32_t)hash, entry);
+		count_++;
+	}
+
+	/*!
+	 * Erase the entry with the given @p hash for which @p equal returns
+	 * true, returns false if there is none.
+	 */
+	template <typename Pred>
+	bool
+	erase(size_t hash, Pred &&equal) noexcept
+	{
+		size_t index = 0;
+		if (!find_index(hash, equal, index)) {
+			return false;
+		}
+
+		// Backward shift, pull following entries that are not in their ideal slot one step closer.
+		size_t next = (index + 1) & mask_;
+		while (slots_[next].dist > 1) {
+			slots_[index] = slots_[next];
+			slots_[index].dist--;
+			index = next;
+			next = (next + 1) & mask_;
+		}
+
+		slots_[index] = Slot{};
+		count_--;
+
+		return true;
+	}
+
+	//! Call @p func with a reference to every entry.
+	template <typename Func>
+	void
+	for_each(Func &&func) const
+	{
+		for (const Slot &slot : slots_) {
+			if (slot.dist != 0) {
+				func(slot.entry);
+			}
+		}
+	}
+
+	//! Remove all entries, keeps the allocation.
+	void
+	clear() noexcept
+	{
+		for (Slot &slot : slots_) {
+			slot = Slot{};
+		}
+		count_ = 0;
+	}
+
+private:
+	struct Slot
+	{
+		/*!
+		 * Low bits of the hash, enough to pick the ideal slot and to
+		 * skip most comparisons, keeps the slot header to 8 bytes.
+		 */
+		uint32_t hash;
+
+		//! Distance from the ideal slot plus one, zero means the slot is empty.
+		uint32_t dist;
+
+		Entry entry;
+	};
+
+	static constexpr size_t kMinCapacity = 16;
+
+	template <typename Pred>
+	bool
+	find_index(size_t hash, Pred &equal, size_t &out_index) const noexcept
+	{
+		if (slots_.empty()) {
+			return false;
+		}
+
+		uint32_t hash32 = (uint32_t)hash;
+		size_t index = hash32 & mask_;
+		for (uint32_t dist = 1;; dist++) {
+			const Slot &slot = slots_[index];
+
+			// An entry would have displaced any entry closer to its own ideal slot.
+			if (slot.dist < dist) {
+				return false;
+			}
+
+			if (slot.hash == hash32 && equal(slot.entry)) {
+				out_index = index;
+				return true;
+			}
+
+			index = (index + 1) & mask_;
+		}
+	}
+
+	void
+	insert_no_grow(uint32_t hash32, const Entry &entry) noexcept
+	{
+		Slot carry = {hash32, 1, entry};
+
+		size_t index = hash32 & mask_;
+		while (true) {
+			Slot &slot = slots_[index];
+
+			if (slot.dist == 0) {
+				slot = carry;
+				return;
+			}
+
+			// Take from the rich, the entry closer to its ideal slot moves on.
+			if (slot.dist < carry.dist) {
+				std::swap(slot, carry);
+			}
+
+			index = (index + 1) & mask_;
+			carry.dist++;
+		}
+	}
+
+	void
+	grow()
+	{
+		size_t new_capacity = slots_.empty() ? kMinCapacity : slots_.size() * 2;
+		assert((new_capacity & (new_capacity - 1)) == 0);
+		assert(new_capacity <= ((size_t)1 << 32)); // Only the low 32 bits of the hash are stored.
+
+		std::vector<Slot> old;
+		old.swap(slots_);
+
+		slots_.resize(new_capacity);
+		mask_ = new_capacity - 1;
+
+		for (const Slot &slot : old) {
+			if (slot.dist != 0) {
+				insert_no_grow(slot.hash, slot.entry);
+			}
+		}
+	}
+
+	std::vector<Slot> slots_;
+	size_t count_ = 0;
+	size_t mask_ = 0;
+};
+
+} // namespace xrt::auxiliary::util::detail
@@ -26,30 +26,64 @@ struct u_imu_sink_force_monotonic
 	struct xrt_imu_sink *downstream;
 };
 
-static void
-split_sample(struct xrt_imu_sink *xfs, struct xrt_imu_sample *sample)
+static bool
+check_monotonic(struct u_imu_sink_force_monotonic *s, const struct xrt_imu_sample *sample)
 {
-	SINK_TRACE_MARKER();
-
-	struct u_imu_sink_force_monotonic *s = (struct u_imu_sink_force_monotonic *)xfs;
-
 	if (sample->timestamp_ns == s->last_ts) {
 		U_LOG_W("Got an IMU sample with a duplicate timestamp! Old: %" PRId64 "; New: %" PRId64 "", s->last_ts,
 		        sample->timestamp_ns);
-		return;
+		return false;
 	}
 	if (sample->timestamp_ns < s->last_ts) {
 		U_LOG_W("Got an IMU sample with a non-monotonically-increasing timestamp! Old: %" PRId64
 		        "; New: %" PRId64 "",
 		        s->last_ts, sample->timestamp_ns);
-		return;
+		return false;
 	}
 
 	s->last_ts = sample->timestamp_ns;
 
+	return true;
+}
+
+static void
+split_sample(struct xrt_imu_sink *xfs, struct xrt_imu_sample *sample)
+{
+	SINK_TRACE_MARKER();
+
+	struct u_imu_sink_force_monotonic *s = (struct u_imu_sink_force_monotonic *)xfs;
+
+	if (!check_monotonic(s, sample)) {
+		return;
+	}
+
 	xrt_sink_push_imu(s->downstream, sample);
 }
 
+static void
+split_samples(struct xrt_imu_sink *xfs, struct xrt_imu_sample *samples, uint32_t count)
+{
+	SINK_TRACE_MARKER();
+
+	struct u_imu_sink_force_monotonic *s = (struct u_imu_sink_force_monotonic *)xfs;
+
+	// Drop bad samples by compacting the batch in place, the common case moves nothing.
+	uint32_t kept = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		if (!check_monotonic(s, &samples[i])) {
+			continue;
+		}
+		if (kept != i) {
+			samples[kept] = samples[i];
+		}
+		kept++;
+	}
+
+	if (kept > 0) {
+		xrt_sink_push_imu_batch(s->downstream, samples, kept);
+	}
+}
+
 static void
 split_break_apart(struct xrt_frame_node *node)
 {
@@ -78,6 +112,7 @@ u_imu_sink_force_monotonic_create(struct xrt_frame_context *xfctx,
 
 	struct u_imu_sink_force_monotonic *s = U_TYPED_CALLOC(struct u_imu_sink_force_monotonic);
 	s->base.push_imu = split_sample;
+	s->base.push_imu_batch = split_samples;
 	s->node.break_apart = split_break_apart;
 	s->node.destroy = split_destroy;
 	s->downstream = downstream;
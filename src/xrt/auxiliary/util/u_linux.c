@@ -16,6 +16,11 @@
 #include <unistd.h>
 #include <sched.h>
 #include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
 
 #define LOG_D(...) U_LOG_IFL_D(log_level, __VA_ARGS__)
 #define LOG_I(...) U_LOG_IFL_I(log_level, __VA_ARGS__)
@@ -24,6 +29,32 @@
 
 #define NAME_LENGTH 32
 
+#ifndef SCHED_FLAG_UTIL_CLAMP_MIN
+#define SCHED_FLAG_UTIL_CLAMP_MIN 0x20
+#endif
+
+#ifndef SCHED_FLAG_RESET_ON_FORK
+#define SCHED_FLAG_RESET_ON_FORK 0x01
+#endif
+
+/*!
+ * Mirror of the kernel's struct sched_attr, glibc only recently got a wrapper
+ * for sched_setattr so the syscall is used directly.
+ */
+struct linux_sched_attr
+{
+	uint32_t size;
+	uint32_t sched_policy;
+	uint64_t sched_flags;
+	int32_t sched_nice;
+	uint32_t sched_priority;
+	uint64_t sched_runtime;
+	uint64_t sched_deadline;
+	uint64_t sched_period;
+	uint32_t sched_util_min;
+	uint32_t sched_util_max;
+};
+
 
 /*
  *
@@ -79,6 +110,30 @@ print_thread_info(struct u_pp_delegate dg, enum u_logging_level log_level, pthre
 	u_pp(dg, "policy: '%s', priority: '%i'", policy_to_string(policy), params.sched_priority);
 }
 
+static int
+set_sched_attr(pid_t tid, int rt_priority, int nice, uint32_t util_min)
+{
+	struct linux_sched_attr attr = {
+	    .size = sizeof(attr),
+	    .sched_policy = rt_priority > 0 ? SCHED_RR : SCHED_OTHER,
+	    // Don't let threads the app spawns from this one inherit it.
+	    .sched_flags = SCHED_FLAG_RESET_ON_FORK,
+	    .sched_nice = rt_priority > 0 ? 0 : nice,
+	    .sched_priority = rt_priority > 0 ? (uint32_t)rt_priority : 0,
+	};
+
+	if (util_min > 0) {
+		attr.sched_flags |= SCHED_FLAG_UTIL_CLAMP_MIN;
+		attr.sched_util_min = util_min > 1024 ? 1024 : util_min;
+	}
+
+	if (syscall(SYS_sched_setattr, tid, &attr, 0) != 0) {
+		return errno;
+	}
+
+	return 0;
+}
+
 
 /*
  *
@@ -137,3 +192,57 @@ u_linux_try_to_set_realtime_priority_on_thread(enum u_logging_level log_level, c
 		LOG_I("%s", sink.buffer);
 	}
 }
+
+bool
+u_linux_try_to_set_thread_scheduling(enum u_logging_level log_level,
+                                     pid_t tid,
+                                     const struct u_linux_thread_scheduling *sched)
+{
+	int rt_priority = sched->rt_priority;
+	int nice = sched->nice;
+	uint32_t util_min = sched->util_min;
+	int ret;
+
+	while (true) {
+		ret = set_sched_attr(tid, rt_priority, nice, util_min);
+		if (ret == 0) {
+			break;
+		}
+
+		if (ret == EPERM && rt_priority > 0) {
+			// Not allowed realtime, use the nice value instead.
+			LOG_D("tid(%i): Not permitted realtime priority %i, trying nice %i", tid, rt_priority, nice);
+			rt_priority = 0;
+		} else if (ret == EPERM && nice < 0) {
+			// Not allowed to raise the priority at all, still try the clamp.
+			LOG_D("tid(%i): Not permitted nice %i", tid, nice);
+			nice = 0;
+		} else if ((ret == EINVAL || ret == EOPNOTSUPP) && util_min > 0) {
+			// Kernel built without CONFIG_UCLAMP_TASK.
+			LOG_D("tid(%i): Utilization clamping not supported", tid);
+			util_min = 0;
+		} else {
+			LOG_W("tid(%i): Could not set scheduling: %s", tid, strerror(ret));
+			return false;
+		}
+	}
+
+	if (rt_priority > 0) {
+		LOG_I("tid(%i): Set 'SCHED_RR' priority %i, util_min %u", tid, rt_priority, util_min);
+	} else {
+		LOG_I("tid(%i): Set 'SCHED_OTHER' nice %i, util_min %u", tid, nice, util_min);
+	}
+
+	return true;
+}
+
+bool
+u_linux_is_thread_of_process(pid_t pid, pid_t tid)
+{
+	char path[64];
+	struct stat st;
+
+	snprintf(path, sizeof(path), "/proc/%i/task/%i", pid, tid);
+
+	return stat(path, &st) == 0;
+}
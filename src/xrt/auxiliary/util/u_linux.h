@@ -14,6 +14,8 @@
 #include "xrt/xrt_windows.h"
 #include "util/u_logging.h"
 
+#include <sys/types.h>
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,6 +35,53 @@ extern "C" {
 void
 u_linux_try_to_set_realtime_priority_on_thread(enum u_logging_level log_level, const char *name);
 
+/*!
+ * Scheduling to apply to a thread with @ref u_linux_try_to_set_thread_scheduling.
+ *
+ * @ingroup aux_util
+ */
+struct u_linux_thread_scheduling
+{
+	//! Use SCHED_RR at this priority, zero for a normal thread.
+	int rt_priority;
+
+	//! Nice value of a normal thread, also used if realtime isn't permitted.
+	int nice;
+
+	/*!
+	 * Minimum utilization clamp, 0 to 1024, makes the kernel pick higher
+	 * CPU frequencies and bigger cores for the thread.
+	 */
+	uint32_t util_min;
+};
+
+/*!
+ * Try to set the scheduling of any thread, including threads of other
+ * processes, by its kernel thread id. Steps down to a normal thread with nice
+ * value if realtime isn't permitted, and drops the utilization clamp if the
+ * kernel doesn't support it.
+ *
+ * @param log_level Logging level to control chattiness.
+ * @param tid       Kernel thread id, as returned by gettid.
+ * @param sched     Scheduling to apply.
+ *
+ * @return True if any scheduling was applied.
+ *
+ * @ingroup aux_util
+ */
+bool
+u_linux_try_to_set_thread_scheduling(enum u_logging_level log_level,
+                                     pid_t tid,
+                                     const struct u_linux_thread_scheduling *sched);
+
+/*!
+ * Is the thread @p tid a thread of process @p pid.
+ *
+ * @ingroup aux_util
+ */
+bool
+u_linux_is_thread_of_process(pid_t pid, pid_t tid);
+
 
 #ifdef __cplusplus
 }
@@ -10,6 +10,54 @@
 #include "u_live_stats.h"
 
 #include <algorithm>
+#include <bit>
+#include <cstring>
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+static constexpr uint64_t kSubBucketCount = uint64_t(1) << U_LIVE_STATS_SUB_BUCKET_BITS;
+
+static uint32_t
+value_to_bucket(uint64_t value)
+{
+	// Small values get a bucket each.
+	if (value < kSubBucketCount) {
+		return (uint32_t)value;
+	}
+
+	uint32_t exponent = (uint32_t)std::bit_width(value) - 1;
+	if (exponent >= U_LIVE_STATS_MAX_VALUE_BITS) {
+		return U_LIVE_STATS_BUCKET_COUNT - 1;
+	}
+
+	// Keep the top bits of the value, the leading one selects the group.
+	uint32_t shift = exponent - U_LIVE_STATS_SUB_BUCKET_BITS;
+	uint64_t sub = (value >> shift) - kSubBucketCount;
+
+	return ((shift + 1) << U_LIVE_STATS_SUB_BUCKET_BITS) + (uint32_t)sub;
+}
+
+//! Middle of the range of values that go into the bucket.
+static uint64_t
+bucket_to_value(uint32_t bucket)
+{
+	uint32_t group = bucket >> U_LIVE_STATS_SUB_BUCKET_BITS;
+	if (group == 0) {
+		return bucket;
+	}
+
+	uint32_t shift = group - 1;
+	uint64_t sub = kSubBucketCount + (bucket & (kSubBucketCount - 1));
+	uint64_t lower = sub << shift;
+	uint64_t width = uint64_t(1) << shift;
+
+	return lower + width / 2;
+}
 
 
 /*
@@ -18,6 +66,62 @@
  *
  */
 
+extern "C" bool
+u_ls_ns_add(struct u_live_stats_ns *uls, uint64_t value)
+{
+	if (uls->value_count == 0 || value < uls->min) {
+		uls->min = value;
+	}
+	if (uls->value_count == 0 || value > uls->max) {
+		uls->max = value;
+	}
+
+	uls->buckets[value_to_bucket(value)]++;
+	uls->sum += value;
+	uls->value_count++;
+
+	return uls->value_count >= U_LIVE_STATS_VALUE_COUNT;
+}
+
+extern "C" uint64_t
+u_ls_ns_get_percentile(const struct u_live_stats_ns *uls, double percentile)
+{
+	uint32_t count = uls->value_count;
+	if (count == 0) {
+		return 0;
+	}
+
+	// Rank of the value when sorted, starting at one, same as picking index percentile * count.
+	double fraction = std::clamp(percentile / 100.0, 0.0, 1.0);
+	uint64_t rank = std::min<uint64_t>((uint64_t)(fraction * count) + 1, count);
+
+	uint64_t seen = 0;
+	uint32_t i = 0;
+	for (; i < U_LIVE_STATS_BUCKET_COUNT; i++) {
+		seen += uls->buckets[i];
+		if (seen >= rank) {
+			break;
+		}
+	}
+
+	// The last bucket also holds all the too large values, it has no meaningful middle.
+	if (i >= U_LIVE_STATS_BUCKET_COUNT - 1) {
+		return uls->max;
+	}
+
+	return std::clamp(bucket_to_value(i), uls->min, uls->max);
+}
+
+extern "C" void
+u_ls_ns_reset(struct u_live_stats_ns *uls)
+{
+	uls->value_count = 0;
+	uls->sum = 0;
+	uls->min = 0;
+	uls->max = 0;
+	memset(uls->buckets, 0, sizeof(uls->buckets));
+}
+
 extern "C" void
 u_ls_ns_get_and_reset(struct u_live_stats_ns *uls, uint64_t *out_median, uint64_t *out_mean, uint64_t *out_worst)
 {
@@ -30,37 +134,32 @@ u_ls_ns_get_and_reset(struct u_live_stats_ns *uls, uint64_t *out_median, uint64_
 		return;
 	}
 
-	std::sort(&uls->values[0], &uls->values[count]);
-
-	uint64_t worst = uls->values[count - 1]; // Always greater then 0.
-	uint64_t median = uls->values[count / 2];
-
-	uint64_t mean = 0;
-	for (uint32_t i = 0; i < count; ++i) {
-		mean += uls->values[i] / count;
-	}
+	*out_median = u_ls_ns_get_percentile(uls, 50.0);
+	*out_mean = uls->sum / count;
+	*out_worst = uls->max;
 
-	uls->value_count = 0;
-	*out_median = median;
-	*out_mean = mean;
-	*out_worst = worst;
+	u_ls_ns_reset(uls);
 }
 
 extern "C" void
 u_ls_ns_print_header(u_pp_delegate_t dg)
 {
-	//       "xxxxYYYYzzzzWWWW M'TTT'###.FFFms M'TTT'###.FFFms M'TTT'###.FFFms"
-	u_pp(dg, "            name          median            mean           worst");
+	//       "xxxxYYYYzzzzWWWW M'TTT'###.FFFms M'TTT'###.FFFms M'TTT'###.FFFms M'TTT'###.FFFms"
+	u_pp(dg, "            name          median            mean             p99           worst");
 }
 
 extern "C" void
 u_ls_ns_print_and_reset(struct u_live_stats_ns *uls, u_pp_delegate_t dg)
 {
+	// Before it's reset.
+	uint64_t p99 = u_ls_ns_get_percentile(uls, 99.0);
+
 	uint64_t median, mean, worst;
 	u_ls_ns_get_and_reset(uls, &median, &mean, &worst);
 
 	u_pp(dg, "%16s", uls->name);
 	u_pp_padded_pretty_ms(dg, median);
 	u_pp_padded_pretty_ms(dg, mean);
+	u_pp_padded_pretty_ms(dg, p99);
 	u_pp_padded_pretty_ms(dg, worst);
 }
@@ -25,16 +25,46 @@ extern "C" {
 #define U_LIVE_STATS_NAME_COUNT (16)
 
 /*!
- * Max number of values that can be put into the trackers.
+ * Number of values after which @ref u_ls_ns_add reports the struct as full,
+ * the struct itself has no upper limit on the number of values.
  *
  * @ingroup aux_util
  */
 #define U_LIVE_STATS_VALUE_COUNT (1024)
 
+/*!
+ * Each power of two range of values is split into this many linear buckets,
+ * giving a relative error of less then 1% for percentiles.
+ *
+ * @ingroup aux_util
+ */
+#define U_LIVE_STATS_SUB_BUCKET_BITS (6)
+
+/*!
+ * Values at or above 2^this are counted in the last bucket, 2^40ns is over 18
+ * minutes. The worst value is still tracked exactly.
+ *
+ * @ingroup aux_util
+ */
+#define U_LIVE_STATS_MAX_VALUE_BITS (40)
+
+/*!
+ * Number of histogram buckets in @ref u_live_stats_ns.
+ *
+ * @ingroup aux_util
+ */
+#define U_LIVE_STATS_BUCKET_COUNT                                                                                     \
+	((U_LIVE_STATS_MAX_VALUE_BITS - U_LIVE_STATS_SUB_BUCKET_BITS + 1) << U_LIVE_STATS_SUB_BUCKET_BITS)
+
 /*!
  * Struct to do live statistic tracking and printing of nano-seconds values,
  * used by amongst other the compositor pacing code.
  *
+ * Values are accumulated into a log-linear histogram (in the style of HDR
+ * histograms), so adding a value is O(1) and the memory is bounded no matter
+ * how many values are added. The mean and worst values are exact, the median
+ * and other percentiles are within the bucket precision.
+ *
  * @ingroup aux_util
  */
 struct u_live_stats_ns
@@ -45,32 +75,42 @@ struct u_live_stats_ns
 	//! Number of values currently in struct.
 	uint32_t value_count;
 
-	//! The values that will be used to calculate statistics.
-	uint64_t values[U_LIVE_STATS_VALUE_COUNT];
+	//! Sum of all values, used for the mean.
+	uint64_t sum;
+
+	//! Smallest and largest value, used to clamp percentiles.
+	uint64_t min, max;
+
+	//! Histogram of the values.
+	uint32_t buckets[U_LIVE_STATS_BUCKET_COUNT];
 };
 
 /*!
- * Add a value to the live stats struct, returns true if the struct is full
- * either before or after adding the value.
+ * Add a value to the live stats struct, returns true if the struct holds at
+ * least @ref U_LIVE_STATS_VALUE_COUNT values after adding the value.
  *
  * @public @memberof u_live_stats_ns
  * @ingroup aux_util
  */
-static inline bool
-u_ls_ns_add(struct u_live_stats_ns *uls, uint64_t value)
-{
-	if (uls->value_count >= ARRAY_SIZE(uls->values)) {
-		return true;
-	}
+bool
+u_ls_ns_add(struct u_live_stats_ns *uls, uint64_t value);
 
-	uls->values[uls->value_count++] = value;
-
-	if (uls->value_count >= ARRAY_SIZE(uls->values)) {
-		return true;
-	}
+/*!
+ * Get the given percentile, in the range [0, 100], of the current set of
+ * values, returns 0 if there are no values. Does not reset the struct.
+ *
+ * @public @memberof u_live_stats_ns
+ */
+uint64_t
+u_ls_ns_get_percentile(const struct u_live_stats_ns *uls, double percentile);
 
-	return false;
-}
+/*!
+ * Remove all values, keeps the name.
+ *
+ * @public @memberof u_live_stats_ns
+ */
+void
+u_ls_ns_reset(struct u_live_stats_ns *uls);
 
 /*!
  * Get the median, mean and worst of the current set of values,
@@ -0,0 +1,35 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Debug variables for the lock statistics of named locks.
+ * @ingroup aux_util
+ */
+
+#include "os/os_threading.h"
+
+#include "util/u_var.h"
+#include "util/u_lock_stats.h"
+
+
+//! Only used as the key of the root.
+static int gLockStatsRoot;
+
+static void
+add_vars(struct os_lock_stats *stats, void *ptr)
+{
+	u_var_add_gui_header(ptr, NULL, stats->name);
+	u_var_add_ro_u64(ptr, &stats->lock_count, "Locked");
+	u_var_add_ro_u64(ptr, &stats->contended_count, "Contended");
+	u_var_add_ro_i64_ns(ptr, (int64_t *)&stats->wait_total_ns, "Wait total");
+	u_var_add_ro_i64_ns(ptr, (int64_t *)&stats->wait_max_ns, "Wait max");
+	u_var_add_ro_i64_ns(ptr, (int64_t *)&stats->hold_total_ns, "Hold total");
+	u_var_add_ro_i64_ns(ptr, (int64_t *)&stats->hold_max_ns, "Hold max");
+}
+
+void
+u_lock_stats_add_vars(void)
+{
+	u_var_add_root(&gLockStatsRoot, "Lock stats", false);
+	os_lock_stats_set_added_callback(add_vars, &gLockStatsRoot);
+}
@@ -0,0 +1,32 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Debug variables for the lock statistics of named locks.
+ * @ingroup aux_util
+ */
+
+#pragma once
+
+#include "xrt/xrt_compiler.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*!
+ * Adds a debug variable root that shows the @ref os_lock_stats of every named
+ * lock, names that are added later show up as they are added. Only has
+ * anything to show in builds with XRT_FEATURE_LOCK_PROFILING.
+ *
+ * @ingroup aux_util
+ */
+void
+u_lock_stats_add_vars(void);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -11,6 +11,9 @@
 #include "xrt/xrt_config_os.h"
 #include "xrt/xrt_config_build.h"
 
+#include "os/os_time.h"
+#include "os/os_threading.h"
+
 #include "util/u_debug.h"
 #include "util/u_pretty_print.h"
 #include "u_json.h"
@@ -19,6 +22,7 @@
 #include <assert.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdarg.h>
 
 
@@ -56,6 +60,27 @@
 #define LOG_ANDROID_TAG_PREFIX "monado"
 #endif
 
+/*
+ * Size of the message in the async ring, longer messages are truncated.
+ */
+#define LOG_ASYNC_MESSAGE_SIZE (1024)
+
+/*
+ * Number of messages that can be queued up for the async writer thread,
+ * must be a power of two.
+ */
+#define LOG_ASYNC_RING_COUNT (256)
+
+/*
+ * How often the async writer checks for messages if not woken up.
+ */
+#define LOG_ASYNC_PERIOD_NS (100 * U_TIME_1MS_IN_NS)
+
+/*
+ * Number of call sites tracked for rate limiting, collisions just share state.
+ */
+#define LOG_RATE_LIMIT_SITE_COUNT (256)
+
 /*
  *
  * Global log level functions.
@@ -64,6 +89,8 @@
 
 DEBUG_GET_ONCE_LOG_OPTION(global_log, "XRT_LOG", U_LOGGING_WARN)
 DEBUG_GET_ONCE_BOOL_OPTION(json_log, "XRT_JSON_LOG", false)
+DEBUG_GET_ONCE_BOOL_OPTION(async_log, "XRT_LOG_ASYNC", false)
+DEBUG_GET_ONCE_NUM_OPTION(rate_limit, "XRT_LOG_RATE_LIMIT", 0)
 
 enum u_logging_level
 u_log_get_global_level(void)
@@ -319,7 +346,7 @@ print_prefix(const char *func, enum u_logging_level level, char *buf, int remain
 }
 
 static int
-log_as_json(const char *file, const char *func, enum u_logging_level level, const char *format, va_list args)
+log_as_json(const char *file, const char *func, enum u_logging_level level, int64_t timestamp_ns, const char *msg)
 {
 	cJSON *root = cJSON_CreateObject();
 
@@ -337,11 +364,10 @@ log_as_json(const char *file, const char *func, enum u_logging_level level, cons
 	cJSON_AddItemToObject(root, "level", cJSON_CreateString(level_s));
 	cJSON_AddItemToObject(root, "file", cJSON_CreateString(file));
 	cJSON_AddItemToObject(root, "func", cJSON_CreateString(func));
+	cJSON_AddItemToObject(root, "timestamp_ns", cJSON_CreateNumber((double)timestamp_ns));
 
 	// Add message.
-	char msg_buf[LOG_BUFFER_SIZE];
-	u_truncate_vsnprintf(msg_buf, LOG_BUFFER_SIZE, format, args);
-	cJSON_AddItemToObject(root, "message", cJSON_CreateString(msg_buf));
+	cJSON_AddItemToObject(root, "message", cJSON_CreateString(msg));
 
 	// Get string and print to stderr.
 	char *out = cJSON_PrintUnformatted(root);
@@ -354,11 +380,15 @@ log_as_json(const char *file, const char *func, enum u_logging_level level, cons
 	return printed;
 }
 
+/*!
+ * Outputs an already formatted message, adding the prefix, to the platform
+ * specific output. Called either directly or from the async writer thread.
+ */
 static int
-do_print(const char *file, int line, const char *func, enum u_logging_level level, const char *format, va_list args)
+print_message(const char *file, const char *func, enum u_logging_level level, int64_t timestamp_ns, const char *msg)
 {
 	if (debug_get_bool_option_json_log()) {
-		return log_as_json(file, func, level, format, args);
+		return log_as_json(file, func, level, timestamp_ns, msg);
 	}
 
 	char storage[LOG_BUFFER_SIZE];
@@ -374,7 +404,7 @@ do_print(const char *file, int line, const char *func, enum u_logging_level leve
 	// Does what it says.
 	CHECK_RET_AND_UPDATE_STATE();
 
-	ret = u_truncate_vsnprintf(buf, remaining, format, args);
+	ret = u_truncate_snprintf(buf, remaining, "%s", msg);
 
 	// Does what it says.
 	CHECK_RET_AND_UPDATE_STATE();
@@ -417,6 +447,345 @@ do_print(const char *file, int line, const char *func, enum u_logging_level leve
 }
 
 
+/*
+ *
+ * Async writer.
+ *
+ */
+
+/*!
+ * A queued up message, the sequence number tells if the slot is free to be
+ * written to by a logging thread or ready to be printed by the writer thread.
+ */
+struct log_slot
+{
+	xrt_atomic_s32_t sequence;
+	enum u_logging_level level;
+	const char *file; //!< From __FILE__ so has static storage.
+	const char *func; //!< From __func__ so has static storage.
+	int64_t timestamp_ns;
+	char msg[LOG_ASYNC_MESSAGE_SIZE];
+};
+
+enum log_async_state
+{
+	LOG_ASYNC_STATE_UNINIT = 0,
+	LOG_ASYNC_STATE_STARTING = 1,
+	LOG_ASYNC_STATE_RUNNING = 2,
+	LOG_ASYNC_STATE_FAILED = 3,
+};
+
+/*!
+ * Bounded lock-free ring with any number of logging threads and one writer
+ * thread, messages are dropped and counted when full so logging never blocks.
+ */
+static struct
+{
+	xrt_atomic_s32_t state;
+
+	struct log_slot slots[LOG_ASYNC_RING_COUNT];
+
+	//! Next position that logging threads claim.
+	xrt_atomic_s32_t head;
+
+	//! Next position the writer thread prints, only touched by it.
+	uint32_t tail;
+
+	//! Messages dropped because the ring was full.
+	xrt_atomic_s32_t dropped_count;
+	int32_t reported_dropped_count;
+
+	struct os_thread thread;
+	struct os_semaphore wake;
+	xrt_atomic_s32_t stop;
+} g_async;
+
+//! Wrap safe difference of two ring positions.
+static inline int32_t
+ring_diff(int32_t a, int32_t b)
+{
+	return (int32_t)((uint32_t)a - (uint32_t)b);
+}
+
+//! Only called from the writer thread, or after it has been joined.
+static void
+async_drain(void)
+{
+	while (true) {
+		struct log_slot *slot = &g_async.slots[g_async.tail & (LOG_ASYNC_RING_COUNT - 1)];
+		int32_t seq = xrt_atomic_s32_load_acquire(&slot->sequence);
+
+		if (ring_diff(seq, (int32_t)(g_async.tail + 1)) != 0) {
+			break; // Empty, or not yet published.
+		}
+
+		print_message(slot->file, slot->func, slot->level, slot->timestamp_ns, slot->msg);
+
+		// Hand it back to the logging threads.
+		xrt_atomic_s32_store_release(&slot->sequence, (int32_t)(g_async.tail + LOG_ASYNC_RING_COUNT));
+		g_async.tail++;
+	}
+
+	int32_t dropped = xrt_atomic_s32_load_acquire(&g_async.dropped_count);
+	if (dropped != g_async.reported_dropped_count) {
+		char msg[128];
+		u_truncate_snprintf(msg, sizeof(msg), "Dropped %i log messages, the log writer couldn't keep up!",
+		                    ring_diff(dropped, g_async.reported_dropped_count));
+		print_message(__FILE__, __func__, U_LOGGING_WARN, os_monotonic_get_ns(), msg);
+		g_async.reported_dropped_count = dropped;
+	}
+}
+
+static void *
+async_writer_thread(void *ptr)
+{
+	(void)ptr;
+
+	while (xrt_atomic_s32_load_acquire(&g_async.stop) == 0) {
+		os_semaphore_wait(&g_async.wake, LOG_ASYNC_PERIOD_NS);
+		async_drain();
+	}
+
+	return NULL;
+}
+
+static void
+async_stop_and_drain(void)
+{
+	xrt_atomic_s32_store_release(&g_async.stop, 1);
+	os_semaphore_release(&g_async.wake);
+	os_thread_join(&g_async.thread);
+
+	// Messages still in the ring are printed to the end, new are printed directly.
+	xrt_atomic_s32_store_release(&g_async.state, LOG_ASYNC_STATE_FAILED);
+	async_drain();
+}
+
+/*!
+ * Returns true if the async writer is running, starts it on the first call.
+ * Only one thread gets to start it, others log directly meanwhile.
+ */
+static bool
+async_ensure_started(void)
+{
+	int32_t state = xrt_atomic_s32_load_acquire(&g_async.state);
+	if (state == LOG_ASYNC_STATE_RUNNING) {
+		return true;
+	}
+	if (state != LOG_ASYNC_STATE_UNINIT) {
+		return false;
+	}
+	if (xrt_atomic_s32_cmpxchg(&g_async.state, LOG_ASYNC_STATE_UNINIT, LOG_ASYNC_STATE_STARTING) !=
+	    LOG_ASYNC_STATE_UNINIT) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < LOG_ASYNC_RING_COUNT; i++) {
+		g_async.slots[i].sequence = (int32_t)i;
+	}
+
+	os_semaphore_init(&g_async.wake, 0);
+	os_thread_init(&g_async.thread);
+
+	if (os_thread_start(&g_async.thread, async_writer_thread, NULL) != 0) {
+		xrt_atomic_s32_store_release(&g_async.state, LOG_ASYNC_STATE_FAILED);
+		return false;
+	}
+
+	os_thread_name(&g_async.thread, "Log Writer");
+
+	// Print anything still queued up when the process exits normally.
+	atexit(async_stop_and_drain);
+
+	xrt_atomic_s32_store_release(&g_async.state, LOG_ASYNC_STATE_RUNNING);
+
+	return true;
+}
+
+/*!
+ * Formats the message on the calling thread, the arguments can't outlive this
+ * call, and queues it up for the writer thread. Returns false if the message
+ * needs to be printed directly instead.
+ */
+static bool
+async_push(const char *file, const char *func, enum u_logging_level level, const char *format, va_list args)
+{
+	if (!debug_get_bool_option_async_log() || !async_ensure_started()) {
+		return false;
+	}
+
+	struct log_slot *slot = NULL;
+	int32_t pos = xrt_atomic_s32_load_acquire(&g_async.head);
+
+	while (true) {
+		slot = &g_async.slots[(uint32_t)pos & (LOG_ASYNC_RING_COUNT - 1)];
+		int32_t diff = ring_diff(xrt_atomic_s32_load_acquire(&slot->sequence), pos);
+
+		if (diff == 0) {
+			int32_t old = xrt_atomic_s32_cmpxchg(&g_async.head, pos, (int32_t)((uint32_t)pos + 1));
+			if (old == pos) {
+				break;
+			}
+			pos = old;
+		} else if (diff < 0) {
+			// Full, errors are too important to lose so print those directly.
+			if (level >= U_LOGGING_ERROR) {
+				return false;
+			}
+
+			// Never block the logging thread.
+			xrt_atomic_s32_inc_return(&g_async.dropped_count);
+			return true;
+		} else {
+			pos = xrt_atomic_s32_load_acquire(&g_async.head);
+		}
+	}
+
+	slot->level = level;
+	slot->file = file;
+	slot->func = func;
+	slot->timestamp_ns = os_monotonic_get_ns();
+	u_truncate_vsnprintf(slot->msg, sizeof(slot->msg), format, args);
+
+	xrt_atomic_s32_store_release(&slot->sequence, (int32_t)((uint32_t)pos + 1));
+
+	// Wake the writer up right away for errors, or when the ring starts to fill up.
+	if (level >= U_LOGGING_ERROR || ((uint32_t)pos & (LOG_ASYNC_RING_COUNT / 4 - 1)) == 0) {
+		os_semaphore_release(&g_async.wake);
+	}
+
+	return true;
+}
+
+
+/*
+ *
+ * Rate limiting.
+ *
+ */
+
+struct log_rate_site
+{
+	const char *file;
+	int line;
+
+	//! Start of the current one second window.
+	int64_t window_start_ns;
+
+	//! Messages printed in the current window.
+	uint32_t count;
+
+	//! Messages suppressed since the last printed one.
+	uint32_t suppressed;
+};
+
+static struct
+{
+	struct os_mutex mutex;
+	xrt_atomic_s32_t initialized;
+	struct log_rate_site sites[LOG_RATE_LIMIT_SITE_COUNT];
+} g_rate;
+
+/*!
+ * Returns false if the message should be suppressed, @p out_suppressed is set
+ * to the number of messages suppressed from this call site before this one.
+ */
+static bool
+rate_limit_check(const char *file, int line, uint32_t *out_suppressed)
+{
+	*out_suppressed = 0;
+
+	int64_t limit = debug_get_num_option_rate_limit();
+	if (limit <= 0) {
+		return true;
+	}
+
+	// Only one thread initializes the mutex, any others skip rate limiting until it's done.
+	if (xrt_atomic_s32_load_acquire(&g_rate.initialized) == 0 &&
+	    xrt_atomic_s32_cmpxchg(&g_rate.initialized, 0, 1) == 0) {
+		os_mutex_init(&g_rate.mutex);
+		xrt_atomic_s32_store_release(&g_rate.initialized, 2);
+	}
+	if (xrt_atomic_s32_load_acquire(&g_rate.initialized) != 2) {
+		return true; // Still being setup by another thread.
+	}
+
+	uint64_t hash = ((uint64_t)(uintptr_t)file >> 3) * 31 + (uint64_t)line;
+	struct log_rate_site *site = &g_rate.sites[hash % LOG_RATE_LIMIT_SITE_COUNT];
+	int64_t now_ns = os_monotonic_get_ns();
+	bool allowed = false;
+
+	os_mutex_lock(&g_rate.mutex);
+
+	if (site->file != file || site->line != line || now_ns - site->window_start_ns >= U_TIME_1S_IN_NS) {
+		if (site->file != file || site->line != line) {
+			site->suppressed = 0; // Taken over by a colliding call site.
+		}
+		site->file = file;
+		site->line = line;
+		site->window_start_ns = now_ns;
+		site->count = 0;
+	}
+
+	if (site->count < (uint64_t)limit) {
+		site->count++;
+		*out_suppressed = site->suppressed;
+		site->suppressed = 0;
+		allowed = true;
+	} else {
+		site->suppressed++;
+	}
+
+	os_mutex_unlock(&g_rate.mutex);
+
+	return allowed;
+}
+
+
+/*
+ *
+ * Printing.
+ *
+ */
+
+static void
+output_v(const char *file, const char *func, enum u_logging_level level, const char *format, va_list args)
+{
+	if (async_push(file, func, level, format, args)) {
+		return;
+	}
+
+	char msg[LOG_BUFFER_SIZE];
+	u_truncate_vsnprintf(msg, sizeof(msg), format, args);
+	print_message(file, func, level, os_monotonic_get_ns(), msg);
+}
+
+XRT_PRINTF_FORMAT(4, 5)
+static void
+output_f(const char *file, const char *func, enum u_logging_level level, const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	output_v(file, func, level, format, args);
+	va_end(args);
+}
+
+static void
+do_print(const char *file, int line, const char *func, enum u_logging_level level, const char *format, va_list args)
+{
+	uint32_t suppressed = 0;
+	if (level != U_LOGGING_RAW && !rate_limit_check(file, line, &suppressed)) {
+		return;
+	}
+
+	if (suppressed > 0) {
+		output_f(file, func, level, "Suppressed %u messages from %s:%i", suppressed, file, line);
+	}
+
+	output_v(file, func, level, format, args);
+}
+
+
 /*
  *
  * 'Exported' functions.
@@ -9,19 +9,70 @@
 
 #include "os/os_threading.h"
 
-#include "util/u_metrics.h"
+#include "util/u_time.h"
 #include "util/u_debug.h"
+#include "util/u_metrics.h"
 
 #include "monado_metrics.pb.h"
 #include "pb_encode.h"
 
 #include <stdio.h>
+#include <string.h>
 
 #define VERSION_MAJOR 1
-#define VERSION_MINOR 1
+#define VERSION_MINOR 3
+
+//! Encoded size of a record, including the submessage length.
+#define RECORD_MAX_SIZE (monado_metrics_Record_size + 10)
+
+//! Number of records that can be queued up for the writer thread, must be a power of two.
+#define RING_COUNT (1024)
+
+//! Size of the writes that the writer thread does to the file.
+#define WRITE_BUFFER_SIZE (64 * 1024)
+
+//! How often the writer thread drains the ring when not woken up earlier.
+#define WRITER_PERIOD_NS (50 * U_TIME_1MS_IN_NS)
+
+/*!
+ * A slot in the record ring, the sequence number tells if the slot is free to
+ * be written to by a producer or ready to be read by the writer thread.
+ */
+struct record_slot
+{
+	xrt_atomic_s32_t sequence;
+	uint32_t size;
+	uint8_t data[RECORD_MAX_SIZE];
+};
+
+/*!
+ * Bounded lock-free ring with multiple producers, the compositor, session and
+ * GPU timing threads, and a single consumer that is the writer thread. Records
+ * are dropped, and counted, when the ring is full so producers never block.
+ */
+static struct
+{
+	struct record_slot slots[RING_COUNT];
+
+	//! Next position that producers claim, shared between producers.
+	xrt_atomic_s32_t head;
+
+	//! Next position that the writer reads, only touched by the writer.
+	uint32_t tail;
+
+	//! Number of records dropped because the ring was full.
+	xrt_atomic_s32_t dropped_count;
+
+	//! Records are batched in here before being written.
+	uint8_t buffer[WRITE_BUFFER_SIZE];
+	size_t buffer_used;
+
+	struct os_thread thread;
+	struct os_semaphore wake;
+	xrt_atomic_s32_t stop;
+} g_ring;
 
 static FILE *g_file = NULL;
-static struct os_mutex g_file_mutex;
 static bool g_metrics_initialized = false;
 static bool g_metrics_early_flush = false;
 
@@ -30,6 +81,132 @@ DEBUG_GET_ONCE_BOOL_OPTION(metrics_early_flush, "XRT_METRICS_EARLY_FLUSH", false
 
 
 
+/*
+ *
+ * Ring functions.
+ *
+ */
+
+//! Wrap safe difference of two ring positions.
+static inline int32_t
+ring_diff(int32_t a, int32_t b)
+{
+	return (int32_t)((uint32_t)a - (uint32_t)b);
+}
+
+static void
+ring_init(void)
+{
+	for (uint32_t i = 0; i < RING_COUNT; i++) {
+		g_ring.slots[i].sequence = (int32_t)i;
+	}
+
+	g_ring.head = 0;
+	g_ring.tail = 0;
+	g_ring.dropped_count = 0;
+	g_ring.buffer_used = 0;
+	g_ring.stop = 0;
+}
+
+static void
+ring_push(const uint8_t *data, uint32_t size)
+{
+	struct record_slot *slot = NULL;
+	int32_t pos = xrt_atomic_s32_load_acquire(&g_ring.head);
+
+	while (true) {
+		slot = &g_ring.slots[(uint32_t)pos & (RING_COUNT - 1)];
+		int32_t diff = ring_diff(xrt_atomic_s32_load_acquire(&slot->sequence), pos);
+
+		if (diff == 0) {
+			// Free, try to claim it.
+			int32_t old = xrt_atomic_s32_cmpxchg(&g_ring.head, pos, (int32_t)((uint32_t)pos + 1));
+			if (old == pos) {
+				break;
+			}
+			pos = old;
+		} else if (diff < 0) {
+			// The writer hasn't gotten to it yet, the ring is full.
+			xrt_atomic_s32_inc_return(&g_ring.dropped_count);
+			return;
+		} else {
+			// Another producer claimed it, try again.
+			pos = xrt_atomic_s32_load_acquire(&g_ring.head);
+		}
+	}
+
+	memcpy(slot->data, data, size);
+	slot->size = size;
+
+	// Publish to the writer.
+	xrt_atomic_s32_store_release(&slot->sequence, (int32_t)((uint32_t)pos + 1));
+
+	// Only wake the writer up when there is a good chunk of work to do.
+	if (g_metrics_early_flush || ((uint32_t)pos & (RING_COUNT / 4 - 1)) == 0) {
+		os_semaphore_release(&g_ring.wake);
+	}
+}
+
+static void
+flush_buffer(void)
+{
+	if (g_ring.buffer_used == 0) {
+		return;
+	}
+
+	fwrite(g_ring.buffer, g_ring.buffer_used, 1, g_file);
+	g_ring.buffer_used = 0;
+}
+
+//! Only called from the writer thread, or after it has been joined.
+static void
+drain_ring(void)
+{
+	bool wrote = false;
+
+	while (true) {
+		struct record_slot *slot = &g_ring.slots[g_ring.tail & (RING_COUNT - 1)];
+		int32_t seq = xrt_atomic_s32_load_acquire(&slot->sequence);
+
+		if (ring_diff(seq, (int32_t)(g_ring.tail + 1)) != 0) {
+			break; // Empty, or not yet published.
+		}
+
+		if (g_ring.buffer_used + slot->size > sizeof(g_ring.buffer)) {
+			flush_buffer();
+		}
+
+		memcpy(&g_ring.buffer[g_ring.buffer_used], slot->data, slot->size);
+		g_ring.buffer_used += slot->size;
+		wrote = true;
+
+		// Hand it back to the producers, for the next time around the ring.
+		xrt_atomic_s32_store_release(&slot->sequence, (int32_t)(g_ring.tail + RING_COUNT));
+		g_ring.tail++;
+	}
+
+	// Always write out what we have, the ring is the buffering.
+	flush_buffer();
+
+	if (wrote && g_metrics_early_flush) {
+		fflush(g_file);
+	}
+}
+
+static void *
+writer_thread(void *ptr)
+{
+	(void)ptr;
+
+	while (xrt_atomic_s32_load_acquire(&g_ring.stop) == 0) {
+		os_semaphore_wait(&g_ring.wake, WRITER_PERIOD_NS);
+		drain_ring();
+	}
+
+	return NULL;
+}
+
+
 /*
  *
  * Helper functions.
@@ -39,7 +216,7 @@ DEBUG_GET_ONCE_BOOL_OPTION(metrics_early_flush, "XRT_METRICS_EARLY_FLUSH", false
 static void
 write_record(monado_metrics_Record *r)
 {
-	uint8_t buffer[monado_metrics_Record_size + 10]; // Including submessage
+	uint8_t buffer[RECORD_MAX_SIZE]; // Including submessage
 
 
 	pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
@@ -49,15 +226,7 @@ write_record(monado_metrics_Record *r)
 		return;
 	}
 
-	os_mutex_lock(&g_file_mutex);
-
-	fwrite(buffer, stream.bytes_written, 1, g_file);
-
-	if (g_metrics_early_flush) {
-		fflush(g_file);
-	}
-
-	os_mutex_unlock(&g_file_mutex);
+	ring_push(buffer, (uint32_t)stream.bytes_written);
 }
 
 static void
@@ -99,13 +268,28 @@ u_metrics_init(void)
 		return;
 	}
 
-	os_mutex_init(&g_file_mutex);
+	ring_init();
+	os_semaphore_init(&g_ring.wake, 0);
+	os_thread_init(&g_ring.thread);
 
 	g_metrics_initialized = true;
 	g_metrics_early_flush = debug_get_bool_option_metrics_early_flush();
 
 	write_version(VERSION_MAJOR, VERSION_MINOR);
 
+	int ret = os_thread_start(&g_ring.thread, writer_thread, NULL);
+	if (ret != 0) {
+		U_LOG_E("Failed to start metrics writer thread!");
+		g_metrics_initialized = false;
+		os_thread_destroy(&g_ring.thread);
+		os_semaphore_destroy(&g_ring.wake);
+		fclose(g_file);
+		g_file = NULL;
+		return;
+	}
+
+	os_thread_name(&g_ring.thread, "Metrics Writer");
+
 	U_LOG_I("Opened metrics file: '%s'", str);
 }
 
@@ -118,16 +302,32 @@ u_metrics_close(void)
 
 	U_LOG_I("Closing metrics file: '%s'", debug_get_option_metrics_file());
 
-	// At least try to avoid races.
-	os_mutex_lock(&g_file_mutex);
+	// At least try to avoid races, stop new records and then stop the writer.
+	g_metrics_initialized = false;
+
+	xrt_atomic_s32_store_release(&g_ring.stop, 1);
+	os_semaphore_release(&g_ring.wake);
+	os_thread_join(&g_ring.thread);
+	os_thread_destroy(&g_ring.thread);
+	os_semaphore_destroy(&g_ring.wake);
+
+	// Anything that was pushed while the writer was shutting down.
+	drain_ring();
+
+	int32_t dropped = xrt_atomic_s32_load_acquire(&g_ring.dropped_count);
+	if (dropped > 0) {
+		U_LOG_W("Dropped %i metrics records, the writer couldn't keep up!", dropped);
+	}
+
 	fflush(g_file);
 	fclose(g_file);
 	g_file = NULL;
-	os_mutex_unlock(&g_file_mutex);
-
-	os_mutex_destroy(&g_file_mutex);
+}
 
-	g_metrics_initialized = false;
+uint32_t
+u_metrics_get_dropped_count(void)
+{
+	return (uint32_t)xrt_atomic_s32_load_acquire(&g_ring.dropped_count);
 }
 
 bool
@@ -233,5 +433,28 @@ u_metrics_write_system_present_info(struct u_metrics_system_present_info *umpi)
 #undef COPY
 
 
+	write_record(&record);
+}
+
+void
+u_metrics_write_system_gpu_pass(struct u_metrics_system_gpu_pass *umgp)
+{
+	if (!g_metrics_initialized) {
+		return;
+	}
+
+	monado_metrics_Record record = monado_metrics_Record_init_default;
+
+	// Select which filed is used.
+	record.which_record = monado_metrics_Record_system_gpu_pass_tag;
+
+	// Not a scalar so can't use the field list, truncated if too long.
+	record.record.system_gpu_pass.frame_id = umgp->frame_id;
+	snprintf(record.record.system_gpu_pass.name, sizeof(record.record.system_gpu_pass.name), "%s", umgp->name);
+	record.record.system_gpu_pass.gpu_start_ns = umgp->gpu_start_ns;
+	record.record.system_gpu_pass.gpu_end_ns = umgp->gpu_end_ns;
+	record.record.system_gpu_pass.when_ns = umgp->when_ns;
+
+
 	write_record(&record);
 }
@@ -40,6 +40,8 @@ struct u_metrics_used
 	int64_t session_frame_id;
 	int64_t system_frame_id;
 	uint64_t when_ns;
+	uint64_t display_time_ns;
+	uint64_t pose_sample_time_ns;
 };
 
 struct u_metrics_system_frame
@@ -79,6 +81,15 @@ struct u_metrics_system_present_info
 	uint64_t earliest_present_time_ns;
 };
 
+struct u_metrics_system_gpu_pass
+{
+	int64_t frame_id;
+	const char *name;
+	uint64_t gpu_start_ns;
+	uint64_t gpu_end_ns;
+	uint64_t when_ns;
+};
+
 
 void
 u_metrics_init(void);
@@ -89,6 +100,13 @@ u_metrics_close(void);
 bool
 u_metrics_is_active(void);
 
+/*!
+ * Number of records that have been dropped, records are queued up for a
+ * writer thread and dropped instead of blocking when it can't keep up.
+ */
+uint32_t
+u_metrics_get_dropped_count(void);
+
 void
 u_metrics_write_session_frame(struct u_metrics_session_frame *umsf);
 
@@ -104,6 +122,9 @@ u_metrics_write_system_gpu_info(struct u_metrics_system_gpu_info *umgi);
 void
 u_metrics_write_system_present_info(struct u_metrics_system_present_info *umpi);
 
+void
+u_metrics_write_system_gpu_pass(struct u_metrics_system_gpu_pass *umgp);
+
 
 #ifdef __cplusplus
 }
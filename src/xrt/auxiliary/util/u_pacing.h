@@ -334,6 +334,30 @@ u_pc_destroy(struct u_pacing_compositor **upc_ptr)
  *
  */
 
+/*!
+ * Statistics about the frames of an app, see @ref u_pacing_app::get_stats.
+ *
+ * @ingroup aux_pacing
+ */
+struct u_pacing_app_stats
+{
+	//! Filtered time between wait returning and begin being called.
+	int64_t cpu_time_ns;
+	//! Filtered time between begin and the frame being delivered.
+	int64_t draw_time_ns;
+	//! Filtered time between the frame being delivered and the GPU completing it.
+	int64_t gpu_time_ns;
+	//! Filtered time between the app waking up and the frame being displayed.
+	int64_t latency_ns;
+
+	//! Number of frames the GPU has completed.
+	uint64_t completed_frame_count;
+	//! Number of completed frames that were done after the predicted GPU done time.
+	uint64_t missed_frame_count;
+	//! Number of frames discarded by the app.
+	uint64_t discarded_frame_count;
+};
+
 /*!
  * This application pacing helper is designed to schedule the rendering time of
  * clients that submit frames to a compositor, which runs its own render loop
@@ -414,13 +438,23 @@ struct u_pacing_app
 	 * may be called multiple times for the same frame should the app be on
 	 * a frame cadence that is lower then the native compositor.
 	 *
-	 * @param     upa             App pacer struct.
-	 * @param[in] frame_id        The frame ID of the latched frame.
-	 * @param[in] when_ns         Time when the latching happened.
-	 * @param[in] system_frame_id The ID of the system frame that is
-	 *                            latching the app's frame.
+	 * @param     upa                 App pacer struct.
+	 * @param[in] frame_id            The frame ID of the latched frame.
+	 * @param[in] when_ns             Time when the latching happened.
+	 * @param[in] system_frame_id     The ID of the system frame that is
+	 *                                latching the app's frame.
+	 * @param[in] display_time_ns     When the system frame is predicted to
+	 *                                be displayed.
+	 * @param[in] pose_sample_time_ns When the app's frame sampled the head
+	 *                                pose, 0 if unknown, see
+	 *                                @ref xrt_layer_frame_data.
 	 */
-	void (*latched)(struct u_pacing_app *upa, int64_t frame_id, int64_t when_ns, int64_t system_frame_id);
+	void (*latched)(struct u_pacing_app *upa,
+	                int64_t frame_id,
+	                int64_t when_ns,
+	                int64_t system_frame_id,
+	                int64_t display_time_ns,
+	                int64_t pose_sample_time_ns);
 
 	/*!
 	 * Mark a frame as completely retired, will never be latched (used by
@@ -456,6 +490,14 @@ struct u_pacing_app
 	             int64_t predicted_display_period_ns,
 	             int64_t extra_ns);
 
+	/*!
+	 * Get the current statistics about the app's frames, optional.
+	 *
+	 * @param      upa       App pacer struct.
+	 * @param[out] out_stats The statistics.
+	 */
+	void (*get_stats)(struct u_pacing_app *upa, struct u_pacing_app_stats *out_stats);
+
 	/*!
 	 * Destroy this u_pacing_app.
 	 */
@@ -564,9 +606,14 @@ u_pa_info(struct u_pacing_app *upa,
  * @ingroup aux_pacing
  */
 static inline void
-u_pa_latched(struct u_pacing_app *upa, int64_t frame_id, int64_t when_ns, int64_t system_frame_id)
+u_pa_latched(struct u_pacing_app *upa,
+             int64_t frame_id,
+             int64_t when_ns,
+             int64_t system_frame_id,
+             int64_t display_time_ns,
+             int64_t pose_sample_time_ns)
 {
-	upa->latched(upa, frame_id, when_ns, system_frame_id);
+	upa->latched(upa, frame_id, when_ns, system_frame_id, display_time_ns, pose_sample_time_ns);
 }
 
 /*!
@@ -583,6 +630,27 @@ u_pa_retired(struct u_pacing_app *upa, int64_t frame_id, int64_t when_ns)
 	upa->retired(upa, frame_id, when_ns);
 }
 
+/*!
+ * @copydoc u_pacing_app::get_stats
+ *
+ * Helper for calling through the function pointer, returns false if the pacer
+ * doesn't keep statistics.
+ *
+ * @public @memberof u_pacing_app
+ * @ingroup aux_pacing
+ */
+static inline bool
+u_pa_get_stats(struct u_pacing_app *upa, struct u_pacing_app_stats *out_stats)
+{
+	if (upa->get_stats == NULL) {
+		return false;
+	}
+
+	upa->get_stats(upa, out_stats);
+
+	return true;
+}
+
 /*!
  * @copydoc u_pacing_app::destroy
  *
@@ -16,16 +16,21 @@
 #include "util/u_pacing.h"
 #include "util/u_metrics.h"
 #include "util/u_logging.h"
+#include "util/u_live_stats.h"
+#include "util/u_pretty_print.h"
 #include "util/u_trace_marker.h"
 
+#include <math.h>
 #include <stdio.h>
 #include <assert.h>
 
 DEBUG_GET_ONCE_LOG_OPTION(log_level, "U_PACING_APP_LOG", U_LOGGING_WARN)
 DEBUG_GET_ONCE_FLOAT_OPTION(min_app_time_ms, "U_PACING_APP_MIN_TIME_MS", 1.0f)
 DEBUG_GET_ONCE_FLOAT_OPTION(min_margin_ms, "U_PACING_APP_MIN_MARGIN_MS", 2.0f)
+DEBUG_GET_ONCE_FLOAT_OPTION(target_miss_percent, "U_PACING_APP_TARGET_MISS_PERCENT", 2.0f)
 DEBUG_GET_ONCE_BOOL_OPTION(use_min_frame_period, "U_PACING_APP_USE_MIN_FRAME_PERIOD", false)
 DEBUG_GET_ONCE_BOOL_OPTION(immediate_wait_frame_return, "U_PACING_APP_IMMEDIATE_WAIT_FRAME_RETURN", false)
+DEBUG_GET_ONCE_BOOL_OPTION(live_stats, "U_PACING_LIVE_STATS", false)
 
 #define UPA_LOG_T(...) U_LOG_IFL_T(debug_get_log_option_log_level(), __VA_ARGS__)
 #define UPA_LOG_D(...) U_LOG_IFL_D(debug_get_log_option_log_level(), __VA_ARGS__)
@@ -138,6 +143,14 @@ struct pacing_app
 	 */
 	struct u_var_draggable_f32 min_margin_ms;
 
+	/*!
+	 * How often, in percent, the app may miss the predicted GPU done time.
+	 * The variance of the app's frame times is turned into extra app time
+	 * based on this, a lower value gives jittery apps more time while stable
+	 * apps with next to no variance are not affected.
+	 */
+	struct u_var_draggable_f32 target_miss_percent;
+
 	struct
 	{
 		//! App time between wait returning and begin being called.
@@ -146,8 +159,30 @@ struct pacing_app
 		int64_t draw_time_ns;
 		//! Time between the frame data being delivered and GPU completing.
 		int64_t gpu_time_ns;
+
+		//! Variance of the above in ns squared, filtered the same way.
+		double cpu_variance;
+		double draw_variance;
+		double gpu_variance;
+
+		//! Time between the app waking up and the frame being displayed.
+		int64_t latency_ns;
+
+		uint64_t completed_frame_count;
+		uint64_t missed_frame_count;
+		uint64_t discarded_frame_count;
 	} app; //!< App statistics.
 
+	//! Live stats of the app's frames, printed every @ref U_LIVE_STATS_VALUE_COUNT frames.
+	struct u_live_stats_ns cpu, draw, gpu, total_frame;
+
+	/*!
+	 * Estimated motion-to-photon latency of every latched frame, from the
+	 * head pose being sampled to the system frame being displayed. Only
+	 * touched by the compositor thread that latches frames.
+	 */
+	struct u_live_stats_ns motion_to_photon;
+
 	struct
 	{
 		//! The last display time that the thing driving this helper got.
@@ -159,6 +194,18 @@ struct pacing_app
 	} last_input;
 
 	int64_t last_returned_ns;
+
+	struct
+	{
+		/*!
+		 * The app is paced at this integer multiple of the display
+		 * period, the compositor reprojects the last frame in between.
+		 */
+		int64_t multiple;
+
+		//! Frames in a row that would have fitted in a lower multiple.
+		int64_t fits_lower_count;
+	} period;
 };
 
 
@@ -210,6 +257,21 @@ point_to_str(enum u_timing_point point)
 #define IIR_ALPHA_LT 0.8
 #define IIR_ALPHA_GT 0.8
 
+//! Slower than the mean, a single spike should not double the app time.
+#define IIR_ALPHA_VARIANCE 0.95
+
+/*!
+ * How much of the lower frame period the app may use before we consider going
+ * back to it, the gap stops the app from bouncing between the two rates.
+ */
+#define PERIOD_DOWN_HEADROOM 0.85
+
+/*!
+ * Number of predicted frames in a row that has to fit in the lower period
+ * before switching to it.
+ */
+#define PERIOD_DOWN_FRAME_COUNT 45
+
 static void
 do_iir_filter(int64_t *target, double alpha_lt, double alpha_gt, int64_t sample)
 {
@@ -220,6 +282,40 @@ do_iir_filter(int64_t *target, double alpha_lt, double alpha_gt, int64_t sample)
 	*target = time_s_to_ns(a + b);
 }
 
+/*!
+ * Keeps an exponentially weighted variance, needs to be called with the mean
+ * from before it is updated with the same sample.
+ */
+static void
+do_variance_filter(double *variance, double alpha, int64_t mean_ns, int64_t sample_ns)
+{
+	double diff = (double)(sample_ns - mean_ns);
+	*variance = alpha * (*variance + (1.0 - alpha) * diff * diff);
+}
+
+/*!
+ * How many standard deviations above the mean a normal distribution needs to
+ * go to only be exceeded @p miss_fraction of the time, uses the rational
+ * approximation from Abramowitz and Stegun 26.2.23.
+ */
+static double
+calc_upper_quantile(double miss_fraction)
+{
+	// Never give less than the mean, and don't go to infinity.
+	if (miss_fraction >= 0.5) {
+		return 0.0;
+	}
+	if (miss_fraction < 0.0001) {
+		miss_fraction = 0.0001;
+	}
+
+	double t = sqrt(-2.0 * log(miss_fraction));
+	double num = 2.515517 + t * (0.802853 + t * 0.010328);
+	double den = 1.0 + t * (1.432788 + t * (0.189269 + t * 0.001308));
+
+	return t - num / den;
+}
+
 static int64_t
 min_period(const struct pacing_app *pa)
 {
@@ -250,10 +346,20 @@ last_return_predicted_display(const struct pacing_app *pa)
 	return pa->last_returned_ns;
 }
 
+static int64_t
+variance_time_ns(const struct pacing_app *pa)
+{
+	// Treat the stages as independent, so the variances can be added.
+	double variance = pa->app.cpu_variance + pa->app.draw_variance + pa->app.gpu_variance;
+	double k = calc_upper_quantile(pa->target_miss_percent.val / 100.0);
+
+	return (int64_t)(k * sqrt(variance));
+}
+
 static int64_t
 total_app_time_ns(const struct pacing_app *pa)
 {
-	int64_t total_ns = pa->app.cpu_time_ns + pa->app.draw_time_ns + pa->app.gpu_time_ns;
+	int64_t total_ns = pa->app.cpu_time_ns + pa->app.draw_time_ns + pa->app.gpu_time_ns + variance_time_ns(pa);
 	int64_t min_ns = min_app_time(pa);
 
 	if (total_ns < min_ns) {
@@ -276,7 +382,27 @@ total_app_and_compositor_time_ns(const struct pacing_app *pa)
 }
 
 static int64_t
-calc_period(const struct pacing_app *pa)
+calc_required_multiple(const struct pacing_app *pa, int64_t period_ns)
+{
+	// Check all values separately, the stages of different frames overlap.
+	int64_t multiple = 1;
+	while (pa->app.cpu_time_ns > period_ns * multiple) {
+		multiple++;
+	}
+
+	while (pa->app.draw_time_ns > period_ns * multiple) {
+		multiple++;
+	}
+
+	while (pa->app.gpu_time_ns > period_ns * multiple) {
+		multiple++;
+	}
+
+	return multiple;
+}
+
+static int64_t
+calc_period(struct pacing_app *pa)
 {
 	// Error checking.
 	int64_t base_period_ns = min_period(pa);
@@ -285,21 +411,38 @@ calc_period(const struct pacing_app *pa)
 		base_period_ns = U_TIME_1MS_IN_NS * 16; // Sure
 	}
 
-	// Calculate the using both values separately.
-	int64_t period_ns = base_period_ns;
-	while (pa->app.cpu_time_ns > period_ns) {
-		period_ns += base_period_ns;
-	}
+	int64_t current = pa->period.multiple;
+	int64_t required = calc_required_multiple(pa, base_period_ns);
 
-	while (pa->app.draw_time_ns > period_ns) {
-		period_ns += base_period_ns;
+	/*
+	 * Going up is done straight away, otherwise the app will miss frames.
+	 * Going down needs the app to comfortably fit in the lower period for
+	 * a while, an app that is right on the edge will otherwise be paced
+	 * at a different rate every few frames and miss frames at random.
+	 */
+	if (required >= current) {
+		pa->period.fits_lower_count = 0;
+	} else {
+		int64_t lower_ns = (int64_t)((double)(base_period_ns * (current - 1)) * PERIOD_DOWN_HEADROOM);
+		bool fits_lower = pa->app.cpu_time_ns <= lower_ns &&  //
+		                  pa->app.draw_time_ns <= lower_ns && //
+		                  pa->app.gpu_time_ns <= lower_ns;
+
+		pa->period.fits_lower_count = fits_lower ? pa->period.fits_lower_count + 1 : 0;
+		required = current;
+
+		if (pa->period.fits_lower_count >= PERIOD_DOWN_FRAME_COUNT) {
+			pa->period.fits_lower_count = 0;
+			required = current - 1;
+		}
 	}
 
-	while (pa->app.gpu_time_ns > period_ns) {
-		period_ns += base_period_ns;
+	if (required != current) {
+		UPA_LOG_I("Pacing app at 1/%" PRIi64 " of the display rate (was 1/%" PRIi64 ")", required, current);
+		pa->period.multiple = required;
 	}
 
-	return period_ns;
+	return base_period_ns * pa->period.multiple;
 }
 
 static int64_t
@@ -361,6 +504,41 @@ do_metrics(struct pacing_app *pa, struct u_pa_frame *f, bool discarded)
 	u_metrics_write_session_frame(&umsf);
 }
 
+static void
+do_live_stats(struct pacing_app *pa, int64_t cpu_ns, int64_t draw_ns, int64_t gpu_ns, int64_t frame_ns)
+{
+	if (!debug_get_bool_option_live_stats()) {
+		return;
+	}
+
+	bool full = false;
+	full |= u_ls_ns_add(&pa->cpu, cpu_ns);
+	full |= u_ls_ns_add(&pa->draw, draw_ns);
+	full |= u_ls_ns_add(&pa->gpu, gpu_ns);
+	full |= u_ls_ns_add(&pa->total_frame, frame_ns);
+
+	if (!full) {
+		return;
+	}
+
+	struct u_pp_sink_stack_only sink;
+	u_pp_delegate_t dg = u_pp_sink_stack_only_init(&sink);
+
+	u_pp(dg, "App %" PRIi64 " frame timing:\n", pa->session_id);
+	u_ls_ns_print_header(dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_and_reset(&pa->cpu, dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_and_reset(&pa->draw, dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_and_reset(&pa->gpu, dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_and_reset(&pa->total_frame, dg);
+
+	// The user asked for these with U_PACING_LIVE_STATS, don't hide them behind the log level.
+	U_LOG(U_LOGGING_INFO, "%s", sink.buffer);
+}
+
 static void
 do_tracing(struct pacing_app *pa, struct u_pa_frame *f)
 {
@@ -551,6 +729,7 @@ pa_mark_discarded(struct u_pacing_app *upa, int64_t frame_id, int64_t when_ns)
 
 	// Update all data.
 	f->when.delivered_ns = when_ns;
+	pa->app.discarded_frame_count++;
 
 	// Write out metrics data.
 	do_metrics(pa, f, true);
@@ -625,12 +804,23 @@ pa_mark_gpu_done(struct u_pacing_app *upa, int64_t frame_id, int64_t when_ns)
 	    time_ns_to_ms_f(pa->app.draw_time_ns), time_ns_to_ms_f(diff_draw_ns), //
 	    time_ns_to_ms_f(pa->app.gpu_time_ns), time_ns_to_ms_f(diff_gpu_ns));  //
 
+	do_variance_filter(&pa->app.cpu_variance, IIR_ALPHA_VARIANCE, pa->app.cpu_time_ns, diff_cpu_ns);
+	do_variance_filter(&pa->app.draw_variance, IIR_ALPHA_VARIANCE, pa->app.draw_time_ns, diff_draw_ns);
+	do_variance_filter(&pa->app.gpu_variance, IIR_ALPHA_VARIANCE, pa->app.gpu_time_ns, diff_gpu_ns);
+
 	do_iir_filter(&pa->app.cpu_time_ns, IIR_ALPHA_LT, IIR_ALPHA_GT, diff_cpu_ns);
 	do_iir_filter(&pa->app.draw_time_ns, IIR_ALPHA_LT, IIR_ALPHA_GT, diff_draw_ns);
 	do_iir_filter(&pa->app.gpu_time_ns, IIR_ALPHA_LT, IIR_ALPHA_GT, diff_gpu_ns);
+	do_iir_filter(&pa->app.latency_ns, IIR_ALPHA_LT, IIR_ALPHA_GT, f->display_time_ns - f->when.wait_woke_ns);
+
+	pa->app.completed_frame_count++;
+	if (late) {
+		pa->app.missed_frame_count++;
+	}
 
-	// Write out metrics and tracing data.
+	// Write out metrics, stats and tracing data.
 	do_metrics(pa, f, false);
+	do_live_stats(pa, diff_cpu_ns, diff_draw_ns, diff_gpu_ns, f->when.gpu_done_ns - f->when.wait_woke_ns);
 	do_tracing(pa, f);
 
 #ifndef VALIDATE_LATCHED_AND_RETIRED
@@ -642,7 +832,43 @@ pa_mark_gpu_done(struct u_pacing_app *upa, int64_t frame_id, int64_t when_ns)
 }
 
 static void
-pa_latched(struct u_pacing_app *upa, int64_t frame_id, int64_t when_ns, int64_t system_frame_id)
+do_motion_to_photon(struct pacing_app *pa, int64_t frame_id, int64_t display_time_ns, int64_t pose_sample_time_ns)
+{
+	int64_t m2p_ns = display_time_ns - pose_sample_time_ns;
+
+	if (debug_get_bool_option_live_stats() && u_ls_ns_add(&pa->motion_to_photon, m2p_ns)) {
+		struct u_pp_sink_stack_only sink;
+		u_pp_delegate_t dg = u_pp_sink_stack_only_init(&sink);
+
+		u_pp(dg, "App %" PRIi64 " motion-to-photon estimate:\n", pa->session_id);
+		u_ls_ns_print_header(dg);
+		u_pp(dg, "\n");
+		u_ls_ns_print_and_reset(&pa->motion_to_photon, dg);
+
+		U_LOG(U_LOGGING_INFO, "%s", sink.buffer);
+	}
+
+	if (!U_TRACE_CATEGORY_IS_ENABLED(timing)) {
+		return;
+	}
+
+#ifdef U_TRACE_TRACY // Uses Tracy specific things.
+	TracyCPlot("App Motion to photon(ms)", time_ns_to_ms_f(m2p_ns));
+#endif
+
+#ifdef U_TRACE_PERCETTO // Uses Percetto specific things.
+	U_TRACE_EVENT_BEGIN_ON_TRACK_DATA(timing, pa_m2p, pose_sample_time_ns, "m2p", PERCETTO_I(frame_id));
+	U_TRACE_EVENT_END_ON_TRACK(timing, pa_m2p, display_time_ns);
+#endif
+}
+
+static void
+pa_latched(struct u_pacing_app *upa,
+           int64_t frame_id,
+           int64_t when_ns,
+           int64_t system_frame_id,
+           int64_t display_time_ns,
+           int64_t pose_sample_time_ns)
 {
 	struct pacing_app *pa = pacing_app(upa);
 
@@ -660,9 +886,16 @@ pa_latched(struct u_pacing_app *upa, int64_t frame_id, int64_t when_ns, int64_t
 	    .session_frame_id = frame_id,
 	    .system_frame_id = system_frame_id,
 	    .when_ns = when_ns,
+	    .display_time_ns = display_time_ns,
+	    .pose_sample_time_ns = pose_sample_time_ns,
 	};
 
 	u_metrics_write_used(&umu);
+
+	// Apps that don't locate their views, or older clients, don't tell us.
+	if (pose_sample_time_ns > 0) {
+		do_motion_to_photon(pa, frame_id, display_time_ns, pose_sample_time_ns);
+	}
 }
 
 static void
@@ -698,6 +931,20 @@ pa_info(struct u_pacing_app *upa,
 	pa->last_input.extra_ns = extra_ns;
 }
 
+static void
+pa_get_stats(struct u_pacing_app *upa, struct u_pacing_app_stats *out_stats)
+{
+	struct pacing_app *pa = pacing_app(upa);
+
+	out_stats->cpu_time_ns = pa->app.cpu_time_ns;
+	out_stats->draw_time_ns = pa->app.draw_time_ns;
+	out_stats->gpu_time_ns = pa->app.gpu_time_ns;
+	out_stats->latency_ns = pa->app.latency_ns;
+	out_stats->completed_frame_count = pa->app.completed_frame_count;
+	out_stats->missed_frame_count = pa->app.missed_frame_count;
+	out_stats->discarded_frame_count = pa->app.discarded_frame_count;
+}
+
 static void
 pa_destroy(struct u_pacing_app *upa)
 {
@@ -718,10 +965,12 @@ pa_create(int64_t session_id, struct u_pacing_app **out_upa)
 	pa->base.latched = pa_latched;
 	pa->base.retired = pa_retired;
 	pa->base.info = pa_info;
+	pa->base.get_stats = pa_get_stats;
 	pa->base.destroy = pa_destroy;
 	pa->session_id = session_id;
 	pa->app.cpu_time_ns = U_TIME_1MS_IN_NS * 2;
 	pa->app.draw_time_ns = U_TIME_1MS_IN_NS * 2;
+	pa->period.multiple = 1;
 
 	pa->min_margin_ms = (struct u_var_draggable_f32){
 	    .val = debug_get_float_option_min_margin_ms(),
@@ -730,6 +979,13 @@ pa_create(int64_t session_id, struct u_pacing_app **out_upa)
 	    .max = +120.0, // There are some really slow applications out there.
 	};
 
+	pa->target_miss_percent = (struct u_var_draggable_f32){
+	    .val = debug_get_float_option_target_miss_percent(),
+	    .min = 0.1,
+	    .step = 0.5,
+	    .max = 50.0, // At 50% the variance is not used.
+	};
+
 	pa->min_app_time_ms = (struct u_var_draggable_f32){
 	    .val = (float)debug_get_float_option_min_app_time_ms(),
 	    .min = 1.0, // This can never be negative.
@@ -737,6 +993,12 @@ pa_create(int64_t session_id, struct u_pacing_app **out_upa)
 	    .max = +120.0, // There are some really slow applications out there.
 	};
 
+	snprintf(pa->cpu.name, ARRAY_SIZE(pa->cpu.name), "cpu");
+	snprintf(pa->draw.name, ARRAY_SIZE(pa->draw.name), "draw");
+	snprintf(pa->gpu.name, ARRAY_SIZE(pa->gpu.name), "gpu");
+	snprintf(pa->total_frame.name, ARRAY_SIZE(pa->total_frame.name), "total_frame");
+	snprintf(pa->motion_to_photon.name, ARRAY_SIZE(pa->motion_to_photon.name), "motion2photon");
+
 	for (size_t i = 0; i < ARRAY_SIZE(pa->frames); i++) {
 		pa->frames[i].state = U_PA_READY;
 		pa->frames[i].frame_id = -1;
@@ -746,9 +1008,11 @@ pa_create(int64_t session_id, struct u_pacing_app **out_upa)
 	u_var_add_root(pa, "App timing info", true);
 	u_var_add_draggable_f32(pa, &pa->min_margin_ms, "Minimum margin(ms)");
 	u_var_add_draggable_f32(pa, &pa->min_app_time_ms, "Minimum app time(ms)");
+	u_var_add_draggable_f32(pa, &pa->target_miss_percent, "Target miss rate(%)");
 	u_var_add_ro_i64_ns(pa, &pa->app.cpu_time_ns, "CPU time");
 	u_var_add_ro_i64_ns(pa, &pa->app.draw_time_ns, "Draw time");
 	u_var_add_ro_i64_ns(pa, &pa->app.gpu_time_ns, "GPU time");
+	u_var_add_ro_i64(pa, &pa->period.multiple, "Display periods per frame");
 
 	*out_upa = &pa->base;
 
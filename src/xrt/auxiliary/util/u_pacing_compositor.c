@@ -15,12 +15,15 @@
 #include "util/u_pacing.h"
 #include "util/u_metrics.h"
 #include "util/u_logging.h"
+#include "util/u_live_stats.h"
+#include "util/u_pretty_print.h"
 #include "util/u_trace_marker.h"
 
 #include <stdio.h>
 #include <assert.h>
 
 DEBUG_GET_ONCE_LOG_OPTION(log_level, "U_PACING_COMPOSITOR_LOG", U_LOGGING_WARN)
+DEBUG_GET_ONCE_BOOL_OPTION(live_stats, "U_PACING_LIVE_STATS", false)
 
 #define UPC_LOG_T(...) U_LOG_IFL_T(debug_get_log_option_log_level(), __VA_ARGS__)
 #define UPC_LOG_D(...) U_LOG_IFL_D(debug_get_log_option_log_level(), __VA_ARGS__)
@@ -134,10 +137,20 @@ struct pacing_compositor
 	 */
 	int64_t margin_ns;
 
+	/*!
+	 * How late the compositor wakes up compared to the wake up time we
+	 * give it, jumps to late wake ups and decays slowly. Added to the
+	 * margin so the measured scheduling slop is accounted for.
+	 */
+	int64_t wake_slop_ns;
+
 	/*!
 	 * Frame store.
 	 */
 	struct frame frames[NUM_FRAMES];
+
+	//! Live stats we keep track off, printed every @ref U_LIVE_STATS_VALUE_COUNT frames.
+	struct u_live_stats_ns cpu, draw, gpu, margin, slippage, total_frame;
 };
 
 
@@ -169,7 +182,27 @@ get_percent_of_time(int64_t time_ns, uint32_t fraction_percent)
 static int64_t
 calc_total_comp_time(struct pacing_compositor *pc)
 {
-	return pc->comp_time_ns + pc->margin_ns;
+	return pc->comp_time_ns + pc->margin_ns + pc->wake_slop_ns;
+}
+
+static void
+update_wake_slop(struct pacing_compositor *pc, int64_t late_ns)
+{
+	// Don't let one long preemption eat the compositor's time for long.
+	int64_t max_ns = pc->margin_ns;
+
+	if (late_ns < 0) {
+		late_ns = 0;
+	} else if (late_ns > max_ns) {
+		late_ns = max_ns;
+	}
+
+	if (late_ns > pc->wake_slop_ns) {
+		pc->wake_slop_ns = late_ns;
+	} else {
+		// Decay by 1/64th of the difference.
+		pc->wake_slop_ns -= (pc->wake_slop_ns - late_ns) / 64;
+	}
 }
 
 static int64_t
@@ -427,9 +460,81 @@ do_metrics(struct pacing_compositor *pc, struct frame *f)
 	u_metrics_write_system_present_info(&umpi);
 }
 
+static void
+print_and_reset_live_stats(struct pacing_compositor *pc)
+{
+	struct u_pp_sink_stack_only sink;
+	u_pp_delegate_t dg = u_pp_sink_stack_only_init(&sink);
+
+	u_pp(dg, "Compositor frame timing:\n");
+	u_ls_ns_print_header(dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_and_reset(&pc->cpu, dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_and_reset(&pc->draw, dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_and_reset(&pc->gpu, dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_and_reset(&pc->margin, dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_and_reset(&pc->slippage, dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_and_reset(&pc->total_frame, dg);
+
+	// The user asked for these with U_PACING_LIVE_STATS, don't hide them behind the log level.
+	U_LOG(U_LOGGING_INFO, "%s", sink.buffer);
+}
+
+static void
+do_live_stats(struct pacing_compositor *pc, struct frame *f)
+{
+	if (!debug_get_bool_option_live_stats()) {
+		return;
+	}
+
+	int64_t gpu_end_ns = f->actual_present_time_ns - f->present_margin_ns;
+	int64_t slippage_ns = f->actual_present_time_ns - f->desired_present_time_ns;
+
+	int64_t cpu_ns = f->when_began_ns - f->when_woke_ns;
+	int64_t draw_ns = f->when_submitted_ns - f->when_began_ns;
+	int64_t gpu_ns = gpu_end_ns > f->when_submitted_ns ? gpu_end_ns - f->when_submitted_ns : 0;
+	int64_t margin_ns = f->present_margin_ns > 0 ? f->present_margin_ns : 0;
+	int64_t frame_ns = f->actual_present_time_ns - f->when_woke_ns;
+
+	bool full = false;
+	full |= u_ls_ns_add(&pc->cpu, cpu_ns);
+	full |= u_ls_ns_add(&pc->draw, draw_ns);
+	full |= u_ls_ns_add(&pc->gpu, gpu_ns);
+	full |= u_ls_ns_add(&pc->margin, margin_ns);
+	full |= u_ls_ns_add(&pc->slippage, slippage_ns > 0 ? slippage_ns : 0);
+	full |= u_ls_ns_add(&pc->total_frame, frame_ns);
+
+	if (full) {
+		print_and_reset_live_stats(pc);
+	}
+}
+
 static void
 do_tracing(struct pacing_compositor *pc, struct frame *f)
 {
+#ifdef U_TRACE_TRACY // Uses Tracy specific things.
+	int64_t cpu_ns = f->when_submitted_ns - f->when_woke_ns;
+	TracyCPlot("Compositor CPU(ms)", time_ns_to_ms_f(cpu_ns));
+
+	int64_t allotted_ns = f->current_comp_time_ns;
+	TracyCPlot("Compositor Allotted(ms)", time_ns_to_ms_f(allotted_ns));
+
+	int64_t margin_ns = f->present_margin_ns;
+	TracyCPlot("Compositor Margin(ms)", time_ns_to_ms_f(margin_ns));
+
+	int64_t oversleep_ns = f->when_woke_ns - f->wake_up_time_ns;
+	TracyCPlot("Compositor Oversleep(ms)", time_ns_to_ms_f(oversleep_ns));
+	TracyCPlot("Compositor Wake Slop(ms)", time_ns_to_ms_f(pc->wake_slop_ns));
+
+	int64_t present_error_ns = f->actual_present_time_ns - f->desired_present_time_ns;
+	TracyCPlot("Compositor Present Error(ms)", time_ns_to_ms_f(present_error_ns));
+#endif
+
 #ifdef U_TRACE_PERCETTO // Uses Percetto specific things.
 	if (!U_TRACE_CATEGORY_IS_ENABLED(timing)) {
 		return;
@@ -601,6 +706,7 @@ pc_mark_point(struct u_pacing_compositor *upc, enum u_timing_point point, int64_
 		assert(f->state == STATE_PREDICTED);
 		f->state = STATE_WOKE;
 		f->when_woke_ns = when_ns;
+		update_wake_slop(pc, when_ns - f->wake_up_time_ns);
 		break;
 	case U_TIMING_POINT_BEGIN:
 		assert(f->state == STATE_WOKE);
@@ -688,8 +794,9 @@ pc_info(struct u_pacing_compositor *upc,
 	    f->present_margin_ns,                        //
 	    present_margin_ms);                          //
 
-	// Write out metrics and tracing data.
+	// Write out metrics, stats and tracing data.
 	do_metrics(pc, f);
+	do_live_stats(pc, f);
 	do_tracing(pc, f);
 }
 
@@ -779,6 +886,13 @@ u_pc_display_timing_create(int64_t estimated_frame_period_ns,
 	// Extra margin that is added to compositor time.
 	pc->margin_ns = config->margin_ns;
 
+	snprintf(pc->cpu.name, ARRAY_SIZE(pc->cpu.name), "cpu");
+	snprintf(pc->draw.name, ARRAY_SIZE(pc->draw.name), "draw");
+	snprintf(pc->gpu.name, ARRAY_SIZE(pc->gpu.name), "gpu");
+	snprintf(pc->margin.name, ARRAY_SIZE(pc->margin.name), "margin");
+	snprintf(pc->slippage.name, ARRAY_SIZE(pc->slippage.name), "slippage");
+	snprintf(pc->total_frame.name, ARRAY_SIZE(pc->total_frame.name), "total_frame");
+
 	*out_upc = &pc->base;
 
 	double estimated_frame_period_ms = ns_to_ms(estimated_frame_period_ns);
@@ -1,4 +1,4 @@
-// Copyright 2023, Collabora, Ltd.
+// Copyright 2023-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -23,6 +23,84 @@ u_session(struct xrt_session *xs)
 	return (struct u_session *)xs;
 }
 
+static inline int32_t
+seq_diff(int32_t a, uint32_t b)
+{
+	return (int32_t)((uint32_t)a - b);
+}
+
+static bool
+ring_try_push(struct u_session *us, const union xrt_session_event *xse)
+{
+	uint32_t pos = (uint32_t)xrt_atomic_s32_load_acquire(&us->events.push_pos);
+
+	while (true) {
+		struct u_session_event_slot *slot = &us->events.slots[pos & (U_SESSION_EVENT_RING_SIZE - 1)];
+		int32_t diff = seq_diff(xrt_atomic_s32_load_acquire(&slot->seq), pos);
+
+		if (diff == 0) {
+			// Slot is free, try to claim it.
+			int32_t old = xrt_atomic_s32_cmpxchg(&us->events.push_pos, (int32_t)pos, (int32_t)(pos + 1));
+			if (old == (int32_t)pos) {
+				slot->xse = *xse;
+				xrt_atomic_s32_store_release(&slot->seq, (int32_t)(pos + 1));
+				return true;
+			}
+			pos = (uint32_t)old;
+		} else if (diff < 0) {
+			// Full.
+			return false;
+		} else {
+			// Another producer got here first.
+			pos = (uint32_t)xrt_atomic_s32_load_acquire(&us->events.push_pos);
+		}
+	}
+}
+
+static bool
+ring_try_pop(struct u_session *us, union xrt_session_event *out_xse)
+{
+	uint32_t pos = (uint32_t)xrt_atomic_s32_load_acquire(&us->events.pop_pos);
+
+	while (true) {
+		struct u_session_event_slot *slot = &us->events.slots[pos & (U_SESSION_EVENT_RING_SIZE - 1)];
+		int32_t diff = seq_diff(xrt_atomic_s32_load_acquire(&slot->seq), pos + 1);
+
+		if (diff == 0) {
+			// Slot is filled, try to claim it.
+			int32_t old = xrt_atomic_s32_cmpxchg(&us->events.pop_pos, (int32_t)pos, (int32_t)(pos + 1));
+			if (old == (int32_t)pos) {
+				*out_xse = slot->xse;
+				xrt_atomic_s32_store_release(&slot->seq, (int32_t)(pos + U_SESSION_EVENT_RING_SIZE));
+				return true;
+			}
+			pos = (uint32_t)old;
+		} else if (diff < 0) {
+			// Empty.
+			return false;
+		} else {
+			// Somebody else popped it.
+			pos = (uint32_t)xrt_atomic_s32_load_acquire(&us->events.pop_pos);
+		}
+	}
+}
+
+//! Only called when the ring was full, or is still overflowing.
+static void
+overflow_push_locked(struct u_session *us, const union xrt_session_event *xse)
+{
+	struct u_session_event *use = U_TYPED_CALLOC(struct u_session_event);
+	use->xse = *xse;
+
+	// Find the last slot.
+	struct u_session_event **slot = &us->events.ptr;
+	while (*slot != NULL) {
+		slot = &(*slot)->next;
+	}
+
+	*slot = use;
+}
+
 
 /*
  *
@@ -68,6 +146,8 @@ destroy(struct xrt_session *xs)
 		u_system_remove_session(us->usys, &us->base, &us->sink);
 	}
 
+	os_mutex_destroy(&us->events.mutex);
+
 	free(xs);
 }
 
@@ -95,6 +175,10 @@ u_session_create(struct u_system *usys)
 	assert(ret == 0);
 	us->usys = usys;
 
+	for (uint32_t i = 0; i < U_SESSION_EVENT_RING_SIZE; i++) {
+		xrt_atomic_s32_store_release(&us->events.slots[i].seq, (int32_t)i);
+	}
+
 	// If we got a u_system.
 	if (usys != NULL) {
 		u_system_add_session(usys, &us->base, &us->sink);
@@ -106,19 +190,14 @@ u_session_create(struct u_system *usys)
 void
 u_session_event_push(struct u_session *us, const union xrt_session_event *xse)
 {
-	struct u_session_event *use = U_TYPED_CALLOC(struct u_session_event);
-	use->xse = *xse;
-
-	os_mutex_lock(&us->events.mutex);
-
-	// Find the last slot.
-	struct u_session_event **slot = &us->events.ptr;
-	while (*slot != NULL) {
-		slot = &(*slot)->next;
+	// Fast path, never blocks the sender.
+	if (xrt_atomic_s32_load_acquire(&us->events.overflowing) == 0 && ring_try_push(us, xse)) {
+		return;
 	}
 
-	*slot = use;
-
+	os_mutex_lock(&us->events.mutex);
+	xrt_atomic_s32_store_release(&us->events.overflowing, 1);
+	overflow_push_locked(us, xse);
 	os_mutex_unlock(&us->events.mutex);
 }
 
@@ -128,6 +207,15 @@ u_session_event_pop(struct u_session *us, union xrt_session_event *out_xse)
 	U_ZERO(out_xse);
 	out_xse->type = XRT_SESSION_EVENT_NONE;
 
+	// Events in the ring are always older than the ones in the overflow list.
+	if (ring_try_pop(us, out_xse)) {
+		return;
+	}
+
+	if (xrt_atomic_s32_load_acquire(&us->events.overflowing) == 0) {
+		return;
+	}
+
 	os_mutex_lock(&us->events.mutex);
 
 	if (us->events.ptr != NULL) {
@@ -138,5 +226,10 @@ u_session_event_pop(struct u_session *us, union xrt_session_event *out_xse)
 		free(use);
 	}
 
+	// Back to the ring once the overflow is drained.
+	if (us->events.ptr == NULL) {
+		xrt_atomic_s32_store_release(&us->events.overflowing, 0);
+	}
+
 	os_mutex_unlock(&us->events.mutex);
 }
@@ -1,4 +1,4 @@
-// Copyright 2023, Collabora, Ltd.
+// Copyright 2023-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -8,6 +8,7 @@
  */
 
 #include "xrt/xrt_session.h"
+#include "xrt/xrt_compiler.h"
 #include "os/os_threading.h"
 
 
@@ -17,7 +18,15 @@ extern "C" {
 
 
 /*!
- * Struct used by @ref u_session to queue up events.
+ * Number of events that can be queued on a @ref u_session without allocating,
+ * must be a power of two.
+ *
+ * @ingroup aux_util
+ */
+#define U_SESSION_EVENT_RING_SIZE (64)
+
+/*!
+ * Struct used by @ref u_session to queue up events once the ring is full.
  *
  * @ingroup aux_util
  */
@@ -27,6 +36,20 @@ struct u_session_event
 	struct u_session_event *next;
 };
 
+/*!
+ * A slot in the event ring of @ref u_session.
+ *
+ * @ingroup aux_util
+ */
+struct u_session_event_slot
+{
+	//! Sequence number of the slot, tells whether it is free or filled.
+	xrt_atomic_s32_t seq;
+
+	//! Only touched by whoever owns the slot according to @ref seq.
+	union xrt_session_event xse;
+};
+
 /*!
  * This is a helper struct that fully implements @ref xrt_session object.
  *
@@ -46,9 +69,28 @@ struct u_session
 	//! Owning system, optional.
 	struct u_system *usys;
 
+	/*!
+	 * Events are pushed to a preallocated bounded multi-producer ring, so
+	 * pushing never blocks or allocates. Only if the ring is full do they
+	 * go to the mutex protected overflow list.
+	 */
 	struct
 	{
+		struct u_session_event_slot slots[U_SESSION_EVENT_RING_SIZE];
+
+		//! Position of the next slot to push to.
+		xrt_atomic_s32_t push_pos;
+
+		//! Position of the next slot to pop from.
+		xrt_atomic_s32_t pop_pos;
+
+		//! Set while @p ptr has events, new events go there as well to keep them in order.
+		xrt_atomic_s32_t overflowing;
+
+		//! Protects @p ptr.
 		struct os_mutex mutex;
+
+		//! Overflow list.
 		struct u_session_event *ptr;
 	} events;
 };
@@ -65,9 +107,8 @@ struct u_session *
 u_session_create(struct u_system *usys);
 
 /*!
- * Push an event to this session. This function is exposed so that code can
- * reuse @ref u_session as a base class.
- *
+ * Push an event to this session, lock-free unless the ring is full. This
+ * function is exposed so that code can reuse @ref u_session as a base class.
  *
  * @public @memberof u_session
  * @ingroup aux_util
@@ -136,6 +136,40 @@ u_sink_simple_queue_create(struct xrt_frame_context *xfctx,
                            struct xrt_frame_sink *downstream,
                            struct xrt_frame_sink **out_xfs);
 
+/*!
+ * What a @ref u_sink_ring_queue_create queue drops when it is full.
+ */
+enum u_sink_ring_queue_policy
+{
+	//! Drop the oldest queued frame to make room, keeps latency low.
+	U_SINK_RING_QUEUE_DROP_OLDEST,
+	//! Drop the frame being pushed, keeps the queued frames in order.
+	U_SINK_RING_QUEUE_DROP_NEWEST,
+};
+
+/*!
+ * A fixed capacity queue that never blocks or allocates when pushing, safe to
+ * push to from multiple threads. The capacity is rounded up to a power of two.
+ *
+ * @public @memberof xrt_frame_sink
+ * @see xrt_frame_context
+ */
+bool
+u_sink_ring_queue_create(struct xrt_frame_context *xfctx,
+                         uint32_t capacity,
+                         enum u_sink_ring_queue_policy policy,
+                         struct xrt_frame_sink *downstream,
+                         struct xrt_frame_sink **out_xfs);
+
+/*!
+ * Number of frames dropped so far by a queue made with
+ * @ref u_sink_ring_queue_create, @p xfs must be the sink it returned.
+ *
+ * @public @memberof xrt_frame_sink
+ */
+uint32_t
+u_sink_ring_queue_get_dropped(struct xrt_frame_sink *xfs);
+
 /*!
  * @public @memberof xrt_frame_sink
  * @see xrt_frame_context
@@ -168,6 +202,39 @@ u_sink_split_create(struct xrt_frame_context *xfctx,
                     struct xrt_frame_sink *right,
                     struct xrt_frame_sink **out_xfs);
 
+/*!
+ * One downstream of a @ref u_sink_fanout_create sink.
+ */
+struct u_sink_fanout_branch
+{
+	struct xrt_frame_sink *sink;
+
+	/*!
+	 * Capacity of the branch's own queue and thread, zero pushes to the sink
+	 * directly on the pushing thread.
+	 */
+	uint32_t queue_capacity;
+
+	//! What the branch's queue drops when full, unused without a queue.
+	enum u_sink_ring_queue_policy policy;
+};
+
+/*!
+ * Like @ref u_sink_split_multi_create but each branch can get its own bounded
+ * @ref u_sink_ring_queue_create queue, so a slow consumer like the debug UI or
+ * a recorder can't hold up a tracker on the same frames. Frames are only ever
+ * referenced, never copied. The queued branches are pushed to before the
+ * direct ones so those can't delay them either.
+ *
+ * @public @memberof xrt_frame_sink
+ * @see xrt_frame_context
+ */
+bool
+u_sink_fanout_create(struct xrt_frame_context *xfctx,
+                     const struct u_sink_fanout_branch *branches,
+                     size_t branch_count,
+                     struct xrt_frame_sink **out_xfs);
+
 /*!
  * Splits Stereo SBS frames into two independent frames
  */
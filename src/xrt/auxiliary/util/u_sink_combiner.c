@@ -11,6 +11,7 @@
 #include "util/u_misc.h"
 #include "util/u_sink.h"
 #include "util/u_frame.h"
+#include "util/u_frame_pool.h"
 #include "util/u_logging.h"
 #include "util/u_trace_marker.h"
 
@@ -42,6 +43,9 @@ struct u_sink_combiner
 	//! The current queued frame.
 	struct xrt_frame *frames[2];
 
+	//! Combined frames are taken from here.
+	struct u_frame_pool *pool;
+
 	pthread_t thread;
 	pthread_mutex_t mutex;
 	pthread_cond_t cond;
@@ -121,7 +125,7 @@ combine_frames_yuyv422(struct xrt_frame *l, struct xrt_frame *r, struct xrt_fram
 }
 
 static void
-combine_frames(struct xrt_frame *l, struct xrt_frame *r, struct xrt_frame **out_frame)
+combine_frames(struct u_frame_pool *pool, struct xrt_frame *l, struct xrt_frame *r, struct xrt_frame **out_frame)
 {
 	SINK_TRACE_MARKER();
 
@@ -135,7 +139,7 @@ combine_frames(struct xrt_frame *l, struct xrt_frame *r, struct xrt_frame **out_
 	uint32_t width = l->width + r->width;
 	enum xrt_format format = l->format;
 
-	u_frame_create_one_off(format, width, height, out_frame);
+	u_frame_pool_create_frame(pool, format, width, height, out_frame);
 
 	struct xrt_frame *f = *out_frame;
 	f->timestamp = l->timestamp - (diff_ns / 2); // Middle of both frames.
@@ -219,7 +223,7 @@ combiner_right_frame(struct xrt_frame_sink *xfs, struct xrt_frame *xf)
 		assert(!(diff_ns < -U_TIME_1MS_IN_NS || diff_ns > U_TIME_1MS_IN_NS));
 
 		struct xrt_frame *frame = NULL;
-		combine_frames(frames[0], frames[1], &frame);
+		combine_frames(q->pool, frames[0], frames[1], &frame);
 
 		// Send to the consumer that does the work.
 		xrt_sink_push_frame(q->consumer, frame);
@@ -264,6 +268,7 @@ combiner_destroy(struct xrt_frame_node *node)
 	struct u_sink_combiner *q = container_of(node, struct u_sink_combiner, node);
 
 	// Destroy resources.
+	u_frame_pool_destroy(&q->pool);
 	pthread_mutex_destroy(&q->mutex);
 	pthread_cond_destroy(&q->cond);
 	free(q);
@@ -302,6 +307,8 @@ u_sink_combiner_create(struct xrt_frame_context *xfctx,
 		return false;
 	}
 
+	u_frame_pool_create("Frame pool: combiner", 4, &q->pool);
+
 	xrt_frame_context_add(xfctx, &q->node);
 
 
@@ -13,7 +13,9 @@
 #include "util/u_misc.h"
 #include "util/u_sink.h"
 #include "util/u_frame.h"
+#include "util/u_frame_pool.h"
 #include "util/u_format.h"
+#include "util/u_sink_converter_simd.h"
 #include "util/u_trace_marker.h"
 
 #include <stdio.h>
@@ -44,6 +46,9 @@ struct u_sink_converter
 
 	struct xrt_frame_sink *downstream;
 
+	//! Converted frames are taken from here, returned when released downstream.
+	struct u_frame_pool *pool;
+
 	enum xrt_format format;
 };
 
@@ -59,15 +64,13 @@ from_L8_to_R8G8B8(struct xrt_frame *dst_frame, uint32_t w, uint32_t h, size_t st
 {
 	SINK_TRACE_MARKER();
 
+	const struct u_sink_converter_funcs *funcs = u_sink_converter_simd_get_best_funcs();
+
 	for (uint32_t y = 0; y < h; y++) {
-		for (uint32_t x = 0; x < w; x += 1) {
-			const uint8_t *src = data;
-			uint8_t *dst = dst_frame->data;
+		const uint8_t *src = data + (y * stride);
+		uint8_t *dst = dst_frame->data + (y * dst_frame->stride);
 
-			src = src + (y * stride) + x;
-			dst = dst + (y * dst_frame->stride) + (x * 3);
-			dst[2] = dst[1] = dst[0] = src[0];
-		}
+		funcs->l8_to_r8g8b8(src, dst, w);
 	}
 }
 
@@ -104,100 +107,6 @@ YUV444_to_RGBX8888(int y, int u, int v)
 	return B << 16 | G << 8 | R;
 }
 
-#undef USE_TABLE
-#ifdef USE_TABLE
-static uint32_t lookup_YUV_to_RGBX[256][256][256] = {0};
-
-static void
-generate_lookup_YUV_to_RGBX()
-{
-	if (lookup_YUV_to_RGBX[255][255][255] != 0) {
-		return;
-	}
-
-	int y;
-	int u;
-	int v;
-
-	for (y = 0; y < 256; y++) {
-		for (u = 0; u < 256; u++) {
-			for (v = 0; v < 256; v++) {
-				lookup_YUV_to_RGBX[y][u][v] = YUV444_to_RGBX8888(y, u, v);
-			}
-		}
-	}
-}
-#endif
-
-XRT_MAYBE_UNUSED inline static void
-YUYV422_to_R8G8B8X8(const uint8_t *input, uint32_t *rgb1, uint32_t *rgb2)
-{
-	uint8_t y0 = input[0];
-	uint8_t u = input[1];
-	uint8_t y1 = input[2];
-	uint8_t v = input[3];
-
-#ifdef USE_TABLE
-	*rgb1 = lookup_YUV_to_RGBX[y0][u][v];
-	*rgb2 = lookup_YUV_to_RGBX[y1][u][v];
-#else
-	*rgb1 = YUV444_to_RGBX8888(y0, u, v);
-	*rgb2 = YUV444_to_RGBX8888(y1, u, v);
-#endif
-}
-
-inline static void
-YUYV422_to_R8G8B8(const uint8_t *input, uint8_t *dst)
-{
-	uint8_t y0 = input[0];
-	uint8_t u = input[1];
-	uint8_t y1 = input[2];
-	uint8_t v = input[3];
-
-#ifdef USE_TABLE
-	uint8_t *rgb1 = (uint8_t *)&lookup_YUV_to_RGBX[y0][u][v];
-	uint8_t *rgb2 = (uint8_t *)&lookup_YUV_to_RGBX[y1][u][v];
-#else
-	uint32_t rgb1v = YUV444_to_RGBX8888(y0, u, v);
-	uint32_t rgb2v = YUV444_to_RGBX8888(y1, u, v);
-	uint8_t *rgb1 = (uint8_t *)&rgb1v;
-	uint8_t *rgb2 = (uint8_t *)&rgb2v;
-#endif
-
-	dst[0] = rgb1[0];
-	dst[1] = rgb1[1];
-	dst[2] = rgb1[2];
-	dst[3] = rgb2[0];
-	dst[4] = rgb2[1];
-	dst[5] = rgb2[2];
-}
-
-inline static void
-UYVY422_to_R8G8B8(const uint8_t *input, uint8_t *dst)
-{
-	uint8_t u = input[0];
-	uint8_t y0 = input[1];
-	uint8_t v = input[2];
-	uint8_t y1 = input[3];
-
-#ifdef USE_TABLE
-	uint8_t *rgb1 = (uint8_t *)&lookup_YUV_to_RGBX[y0][u][v];
-	uint8_t *rgb2 = (uint8_t *)&lookup_YUV_to_RGBX[y1][u][v];
-#else
-	uint32_t rgb1v = YUV444_to_RGBX8888(y0, u, v);
-	uint32_t rgb2v = YUV444_to_RGBX8888(y1, u, v);
-	uint8_t *rgb1 = (uint8_t *)&rgb1v;
-	uint8_t *rgb2 = (uint8_t *)&rgb2v;
-#endif
-
-	dst[0] = rgb1[0];
-	dst[1] = rgb1[1];
-	dst[2] = rgb1[2];
-	dst[3] = rgb2[0];
-	dst[4] = rgb2[1];
-	dst[5] = rgb2[2];
-}
-
 inline static void
 YUV444_to_R8G8B8(const uint8_t *input, uint8_t *dst)
 {
@@ -205,12 +114,8 @@ YUV444_to_R8G8B8(const uint8_t *input, uint8_t *dst)
 	uint8_t u = input[1];
 	uint8_t v = input[2];
 
-#ifdef USE_TABLE
-	uint8_t *rgb = (uint8_t *)&lookup_YUV_to_RGBX[y][u][v];
-#else
 	uint32_t rgbv = YUV444_to_RGBX8888(y, u, v);
 	uint8_t *rgb = (uint8_t *)&rgbv;
-#endif
 
 	dst[0] = rgb[0];
 	dst[1] = rgb[1];
@@ -222,15 +127,13 @@ from_YUYV422_to_R8G8B8(struct xrt_frame *dst_frame, uint32_t w, uint32_t h, size
 {
 	SINK_TRACE_MARKER();
 
+	const struct u_sink_converter_funcs *funcs = u_sink_converter_simd_get_best_funcs();
+
 	for (uint32_t y = 0; y < h; y++) {
-		for (uint32_t x = 0; x < w; x += 2) {
-			const uint8_t *src = data;
-			uint8_t *dst = dst_frame->data;
+		const uint8_t *src = data + (y * stride);
+		uint8_t *dst = dst_frame->data + (y * dst_frame->stride);
 
-			src = src + (y * stride) + (x * 2);
-			dst = dst + (y * dst_frame->stride) + (x * 3);
-			YUYV422_to_R8G8B8(src, dst);
-		}
+		funcs->yuyv422_to_r8g8b8(src, dst, w);
 	}
 }
 
@@ -239,13 +142,13 @@ from_YUYV422_to_L8(struct xrt_frame *dst_frame, uint32_t w, uint32_t h, size_t s
 {
 	SINK_TRACE_MARKER();
 
+	const struct u_sink_converter_funcs *funcs = u_sink_converter_simd_get_best_funcs();
+
 	for (uint32_t y = 0; y < h; y++) {
 		const uint8_t *src = data + (y * stride);
 		uint8_t *dst = dst_frame->data + (y * dst_frame->stride);
 
-		for (uint32_t x = 0; x < w; x++) {
-			dst[x] = src[x * 2];
-		}
+		funcs->yuyv422_to_l8(src, dst, w);
 	}
 }
 
@@ -254,15 +157,13 @@ from_UYVY422_to_R8G8B8(struct xrt_frame *dst_frame, uint32_t w, uint32_t h, size
 {
 	SINK_TRACE_MARKER();
 
+	const struct u_sink_converter_funcs *funcs = u_sink_converter_simd_get_best_funcs();
+
 	for (uint32_t y = 0; y < h; y++) {
-		for (uint32_t x = 0; x < w; x += 2) {
-			const uint8_t *src = data;
-			uint8_t *dst = dst_frame->data;
+		const uint8_t *src = data + (y * stride);
+		uint8_t *dst = dst_frame->data + (y * dst_frame->stride);
 
-			src = src + (y * stride) + (x * 2);
-			dst = dst + (y * dst_frame->stride) + (x * 3);
-			UYVY422_to_R8G8B8(src, dst);
-		}
+		funcs->uyvy422_to_r8g8b8(src, dst, w);
 	}
 }
 
@@ -429,6 +330,8 @@ from_BAYER_GR8_to_R8G8B8(struct xrt_frame *dst_frame, uint32_t w, uint32_t h, si
 {
 	SINK_TRACE_MARKER();
 
+	const struct u_sink_converter_funcs *funcs = u_sink_converter_simd_get_best_funcs();
+
 	const uint8_t *src_data = data;
 	size_t src_stride = stride;
 
@@ -440,20 +343,7 @@ from_BAYER_GR8_to_R8G8B8(struct xrt_frame *dst_frame, uint32_t w, uint32_t h, si
 		const uint8_t *src1 = src_data + (y * 2 + 1) * src_stride;
 		uint8_t *dst = dst_data + (y * dst_stride);
 
-		for (uint32_t x = 0; x < w; x++) {
-			uint8_t g0 = src0[0];
-			uint8_t r = src0[1];
-			uint8_t b = src1[0];
-			uint8_t g1 = src1[1];
-
-			dst[0] = r;
-			dst[1] = (g0 + g1) / 2;
-			dst[2] = b;
-
-			src0 += 2;
-			src1 += 2;
-			dst += 3;
-		}
+		funcs->bayer_gr8_to_r8g8b8(src0, src1, dst, w);
 	}
 }
 
@@ -467,15 +357,17 @@ from_BAYER_GR8_to_R8G8B8(struct xrt_frame *dst_frame, uint32_t w, uint32_t h, si
 
 /*!
  * Creates a frame that the conversion should happen to, allows to set the size.
- *
- * @todo Allocate from a pool of frames.
  */
 static bool
-create_frame_with_format_of_size(
-    struct xrt_frame *xf, uint32_t w, uint32_t h, enum xrt_format format, struct xrt_frame **out_frame)
+create_frame_with_format_of_size(struct u_sink_converter *s,
+                                 struct xrt_frame *xf,
+                                 uint32_t w,
+                                 uint32_t h,
+                                 enum xrt_format format,
+                                 struct xrt_frame **out_frame)
 {
 	struct xrt_frame *frame = NULL;
-	u_frame_create_one_off(format, w, h, &frame);
+	u_frame_pool_create_frame(s->pool, format, w, h, &frame);
 	if (frame == NULL) {
 		U_LOG_E("Failed to create target frame!");
 		*out_frame = NULL;
@@ -497,9 +389,12 @@ create_frame_with_format_of_size(
  * Creates a frame that the conversion should happen to.
  */
 static bool
-create_frame_with_format(struct xrt_frame *xf, enum xrt_format format, struct xrt_frame **out_frame)
+create_frame_with_format(struct u_sink_converter *s,
+                         struct xrt_frame *xf,
+                         enum xrt_format format,
+                         struct xrt_frame **out_frame)
 {
-	return create_frame_with_format_of_size(xf, xf->width, xf->height, format, out_frame);
+	return create_frame_with_format_of_size(s, xf, xf->width, xf->height, format, out_frame);
 }
 
 static void
@@ -513,21 +408,21 @@ convert_frame_l8(struct xrt_frame_sink *xs, struct xrt_frame *xf)
 
 	switch (xf->format) {
 	case XRT_FORMAT_BC4:
-		if (!create_frame_with_format(xf, XRT_FORMAT_L8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_L8, &converted)) {
 			return;
 		}
 		from_BC4_to_L8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_L8: s->downstream->push_frame(s->downstream, xf); return;
 	case XRT_FORMAT_YUYV422:
-		if (!create_frame_with_format(xf, XRT_FORMAT_L8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_L8, &converted)) {
 			return;
 		}
 		from_YUYV422_to_L8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 #ifdef XRT_HAVE_JPEG
 	case XRT_FORMAT_MJPEG:
-		if (!create_frame_with_format(xf, XRT_FORMAT_L8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_L8, &converted)) {
 			return;
 		}
 
@@ -562,38 +457,38 @@ convert_frame_r8g8b8_or_l8(struct xrt_frame_sink *xs, struct xrt_frame *xf)
 	case XRT_FORMAT_BAYER_GR8:;
 		uint32_t w = xf->width / 2;
 		uint32_t h = xf->height / 2;
-		if (!create_frame_with_format_of_size(xf, w, h, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format_of_size(s, xf, w, h, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_BAYER_GR8_to_R8G8B8(converted, w, h, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_BC4:
-		if (!create_frame_with_format(xf, XRT_FORMAT_L8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_L8, &converted)) {
 			return;
 		}
 		from_BC4_to_L8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_YUYV422:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_YUYV422_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_UYVY422:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_UYVY422_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_YUV888:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_YUV888_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 #ifdef XRT_HAVE_JPEG
 	case XRT_FORMAT_MJPEG:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		if (!from_MJPEG_to_frame(converted, xf->size, xf->data)) {
@@ -642,26 +537,26 @@ convert_frame_r8g8b8_bayer_or_l8(struct xrt_frame_sink *xs, struct xrt_frame *xf
 	case XRT_FORMAT_R8G8B8:
 	case XRT_FORMAT_BAYER_GR8:; s->downstream->push_frame(s->downstream, xf); return;
 	case XRT_FORMAT_YUYV422:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_YUYV422_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_UYVY422:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_UYVY422_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_YUV888:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_YUV888_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 #ifdef XRT_HAVE_JPEG
 	case XRT_FORMAT_MJPEG:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		if (!from_MJPEG_to_frame(converted, xf->size, xf->data)) {
@@ -692,7 +587,7 @@ convert_frame_r8g8b8(struct xrt_frame_sink *xs, struct xrt_frame *xf)
 	switch (xf->format) {
 	case XRT_FORMAT_R8G8B8: s->downstream->push_frame(s->downstream, xf); return;
 	case XRT_FORMAT_L8:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_L8_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
@@ -700,32 +595,32 @@ convert_frame_r8g8b8(struct xrt_frame_sink *xs, struct xrt_frame *xf)
 	case XRT_FORMAT_BAYER_GR8:;
 		uint32_t w = xf->width / 2;
 		uint32_t h = xf->height / 2;
-		if (!create_frame_with_format_of_size(xf, w, h, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format_of_size(s, xf, w, h, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_BAYER_GR8_to_R8G8B8(converted, w, h, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_YUYV422:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_YUYV422_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_UYVY422:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_UYVY422_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 	case XRT_FORMAT_YUV888:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		from_YUV888_to_R8G8B8(converted, xf->width, xf->height, xf->stride, xf->data);
 		break;
 #ifdef XRT_HAVE_JPEG
 	case XRT_FORMAT_MJPEG:
-		if (!create_frame_with_format(xf, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 		if (!from_MJPEG_to_frame(converted, xf->size, xf->data)) {
@@ -758,7 +653,7 @@ convert_frame_rgb_yuv_yuyv_uyvy_or_l8(struct xrt_frame_sink *xs, struct xrt_fram
 		uint32_t w = xf->width / 2;
 		uint32_t h = xf->height / 2;
 
-		if (!create_frame_with_format_of_size(xf, w, h, XRT_FORMAT_R8G8B8, &converted)) {
+		if (!create_frame_with_format_of_size(s, xf, w, h, XRT_FORMAT_R8G8B8, &converted)) {
 			return;
 		}
 
@@ -773,7 +668,7 @@ convert_frame_rgb_yuv_yuyv_uyvy_or_l8(struct xrt_frame_sink *xs, struct xrt_fram
 	case XRT_FORMAT_YUV888: s->downstream->push_frame(s->downstream, xf); return;
 #ifdef XRT_HAVE_JPEG
 	case XRT_FORMAT_MJPEG:
-		if (!create_frame_with_format(xf, XRT_FORMAT_YUV888, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_YUV888, &converted)) {
 			return;
 		}
 		if (!from_MJPEG_to_frame(converted, xf->size, xf->data)) {
@@ -808,7 +703,7 @@ convert_frame_yuv_yuyv_uyvy_or_l8(struct xrt_frame_sink *xs, struct xrt_frame *x
 	case XRT_FORMAT_YUV888: s->downstream->push_frame(s->downstream, xf); return;
 #ifdef XRT_HAVE_JPEG
 	case XRT_FORMAT_MJPEG:
-		if (!create_frame_with_format(xf, XRT_FORMAT_YUV888, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_YUV888, &converted)) {
 			return;
 		}
 		if (!from_MJPEG_to_frame(converted, xf->size, xf->data)) {
@@ -844,7 +739,7 @@ convert_frame_yuv_or_yuyv(struct xrt_frame_sink *xs, struct xrt_frame *xf)
 	case XRT_FORMAT_YUV888: s->downstream->push_frame(s->downstream, xf); return;
 #ifdef XRT_HAVE_JPEG
 	case XRT_FORMAT_MJPEG:
-		if (!create_frame_with_format(xf, XRT_FORMAT_YUV888, &converted)) {
+		if (!create_frame_with_format(s, xf, XRT_FORMAT_YUV888, &converted)) {
 			return;
 		}
 		if (!from_MJPEG_to_frame(converted, xf->size, xf->data)) {
@@ -872,7 +767,7 @@ convert_frame_bayer(struct xrt_frame_sink *xs, struct xrt_frame *xf)
 	uint32_t h = xf->height / 2;
 	struct xrt_frame *converted = NULL;
 
-	if (!create_frame_with_format_of_size(xf, w, h, XRT_FORMAT_R8G8B8, &converted)) {
+	if (!create_frame_with_format_of_size(s, xf, w, h, XRT_FORMAT_R8G8B8, &converted)) {
 		return;
 	}
 
@@ -893,9 +788,32 @@ destroy(struct xrt_frame_node *node)
 {
 	struct u_sink_converter *s = container_of(node, struct u_sink_converter, node);
 
+	// Frames still held downstream keep the pool alive.
+	u_frame_pool_destroy(&s->pool);
+
 	free(s);
 }
 
+static void
+create_converter(struct xrt_frame_context *xfctx,
+                 void (*func)(struct xrt_frame_sink *, struct xrt_frame *),
+                 struct xrt_frame_sink *downstream,
+                 struct xrt_frame_sink **out_xfs)
+{
+	struct u_sink_converter *s = U_TYPED_CALLOC(struct u_sink_converter);
+	s->base.push_frame = func;
+	s->node.break_apart = break_apart;
+	s->node.destroy = destroy;
+	s->downstream = downstream;
+
+	// A few frames covers the ones in flight downstream.
+	u_frame_pool_create("Frame pool: converter", 4, &s->pool);
+
+	xrt_frame_context_add(xfctx, &s->node);
+
+	*out_xfs = &s->base;
+}
+
 
 /*
  *
@@ -919,19 +837,7 @@ u_sink_create_format_converter(struct xrt_frame_context *xfctx,
 	default: U_LOG_E("Format '%s' not supported", u_format_str(format)); return;
 	}
 
-#ifdef USE_TABLE
-	generate_lookup_YUV_to_RGBX();
-#endif
-
-	struct u_sink_converter *s = U_TYPED_CALLOC(struct u_sink_converter);
-	s->base.push_frame = func;
-	s->node.break_apart = break_apart;
-	s->node.destroy = destroy;
-	s->downstream = downstream;
-
-	xrt_frame_context_add(xfctx, &s->node);
-
-	*out_xfs = &s->base;
+	create_converter(xfctx, func, downstream, out_xfs);
 }
 
 void
@@ -941,19 +847,7 @@ u_sink_create_to_r8g8b8_or_l8(struct xrt_frame_context *xfctx,
 {
 	assert(downstream != NULL);
 
-	struct u_sink_converter *s = U_TYPED_CALLOC(struct u_sink_converter);
-	s->base.push_frame = convert_frame_r8g8b8_or_l8;
-	s->node.break_apart = break_apart;
-	s->node.destroy = destroy;
-	s->downstream = downstream;
-
-#ifdef USE_TABLE
-	generate_lookup_YUV_to_RGBX();
-#endif
-
-	xrt_frame_context_add(xfctx, &s->node);
-
-	*out_xfs = &s->base;
+	create_converter(xfctx, convert_frame_r8g8b8_or_l8, downstream, out_xfs);
 }
 
 void
@@ -963,19 +857,7 @@ u_sink_create_to_r8g8b8_r8g8b8a8_r8g8b8x8_or_l8(struct xrt_frame_context *xfctx,
 {
 	assert(downstream != NULL);
 
-	struct u_sink_converter *s = U_TYPED_CALLOC(struct u_sink_converter);
-	s->base.push_frame = convert_frame_r8g8b8_r8g8b8a8_r8g8b8x8_or_l8;
-	s->node.break_apart = break_apart;
-	s->node.destroy = destroy;
-	s->downstream = downstream;
-
-#ifdef USE_TABLE
-	generate_lookup_YUV_to_RGBX();
-#endif
-
-	xrt_frame_context_add(xfctx, &s->node);
-
-	*out_xfs = &s->base;
+	create_converter(xfctx, convert_frame_r8g8b8_r8g8b8a8_r8g8b8x8_or_l8, downstream, out_xfs);
 }
 
 void
@@ -985,15 +867,7 @@ u_sink_create_to_r8g8b8_bayer_or_l8(struct xrt_frame_context *xfctx,
 {
 	assert(downstream != NULL);
 
-	struct u_sink_converter *s = U_TYPED_CALLOC(struct u_sink_converter);
-	s->base.push_frame = convert_frame_r8g8b8_bayer_or_l8;
-	s->node.break_apart = break_apart;
-	s->node.destroy = destroy;
-	s->downstream = downstream;
-
-	xrt_frame_context_add(xfctx, &s->node);
-
-	*out_xfs = &s->base;
+	create_converter(xfctx, convert_frame_r8g8b8_bayer_or_l8, downstream, out_xfs);
 }
 
 void
@@ -1003,15 +877,7 @@ u_sink_create_to_rgb_yuv_yuyv_uyvy_or_l8(struct xrt_frame_context *xfctx,
 {
 	assert(downstream != NULL);
 
-	struct u_sink_converter *s = U_TYPED_CALLOC(struct u_sink_converter);
-	s->base.push_frame = convert_frame_rgb_yuv_yuyv_uyvy_or_l8;
-	s->node.break_apart = break_apart;
-	s->node.destroy = destroy;
-	s->downstream = downstream;
-
-	xrt_frame_context_add(xfctx, &s->node);
-
-	*out_xfs = &s->base;
+	create_converter(xfctx, convert_frame_rgb_yuv_yuyv_uyvy_or_l8, downstream, out_xfs);
 }
 
 void
@@ -1021,15 +887,7 @@ u_sink_create_to_yuv_yuyv_uyvy_or_l8(struct xrt_frame_context *xfctx,
 {
 	assert(downstream != NULL);
 
-	struct u_sink_converter *s = U_TYPED_CALLOC(struct u_sink_converter);
-	s->base.push_frame = convert_frame_yuv_yuyv_uyvy_or_l8;
-	s->node.break_apart = break_apart;
-	s->node.destroy = destroy;
-	s->downstream = downstream;
-
-	xrt_frame_context_add(xfctx, &s->node);
-
-	*out_xfs = &s->base;
+	create_converter(xfctx, convert_frame_yuv_yuyv_uyvy_or_l8, downstream, out_xfs);
 }
 
 void
@@ -1039,15 +897,7 @@ u_sink_create_to_yuv_or_yuyv(struct xrt_frame_context *xfctx,
 {
 	assert(downstream != NULL);
 
-	struct u_sink_converter *s = U_TYPED_CALLOC(struct u_sink_converter);
-	s->base.push_frame = convert_frame_yuv_or_yuyv;
-	s->node.break_apart = break_apart;
-	s->node.destroy = destroy;
-	s->downstream = downstream;
-
-	xrt_frame_context_add(xfctx, &s->node);
-
-	*out_xfs = &s->base;
+	create_converter(xfctx, convert_frame_yuv_or_yuyv, downstream, out_xfs);
 }
 
 static void
@@ -1059,7 +909,7 @@ convert_half_scale(struct xrt_frame_sink *xs, struct xrt_frame *xf)
 	uint32_t h = xf->height / 2;
 	struct xrt_frame *converted = NULL;
 
-	if (!create_frame_with_format_of_size(xf, w, h, XRT_FORMAT_L8, &converted)) {
+	if (!create_frame_with_format_of_size(s, xf, w, h, XRT_FORMAT_L8, &converted)) {
 		return;
 	}
 
@@ -1088,13 +938,5 @@ u_sink_create_half_scale(struct xrt_frame_context *xfctx,
 {
 	assert(downstream != NULL);
 
-	struct u_sink_converter *s = U_TYPED_CALLOC(struct u_sink_converter);
-	s->base.push_frame = convert_half_scale;
-	s->node.break_apart = break_apart;
-	s->node.destroy = destroy;
-	s->downstream = downstream;
-
-	xrt_frame_context_add(xfctx, &s->node);
-
-	*out_xfs = &s->base;
+	create_converter(xfctx, convert_half_scale, downstream, out_xfs);
 }
@@ -0,0 +1,618 @@
+// Copyright 2019-2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Row conversion kernels used by the @ref xrt_frame_sink converters.
+ * @ingroup aux_util
+ */
+
+#include "util/u_debug.h"
+#include "util/u_logging.h"
+#include "util/u_sink_converter_simd.h"
+
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD
+#include <immintrin.h>
+#define TARGET_SSE41 __attribute__((target("ssse3,sse4.1")))
+#define TARGET_AVX2 __attribute__((target("ssse3,sse4.1,avx,avx2")))
+#endif
+
+#if defined(__ARM_NEON)
+#define HAVE_NEON
+#include <arm_neon.h>
+#endif
+
+
+DEBUG_GET_ONCE_BOOL_OPTION(sink_converter_simd, "XRT_SINK_CONVERTER_SIMD", true)
+
+
+/*
+ *
+ * Scalar functions.
+ *
+ */
+
+static inline int
+clamp_to_byte(int v)
+{
+	if (v < 0) {
+		return 0;
+	}
+	if (v >= 255) {
+		return 255;
+	}
+	return v;
+}
+
+static inline void
+YUV444_to_R8G8B8(int y, int u, int v, uint8_t *dst)
+{
+	int C = y - 16;
+	int D = u - 128;
+	int E = v - 128;
+
+	dst[0] = (uint8_t)clamp_to_byte((298 * C + 409 * E + 128) >> 8);
+	dst[1] = (uint8_t)clamp_to_byte((298 * C - 100 * D - 209 * E + 128) >> 8);
+	dst[2] = (uint8_t)clamp_to_byte((298 * C + 516 * D + 128) >> 8);
+}
+
+static void
+scalar_yuyv422_to_r8g8b8(const uint8_t *src, uint8_t *dst, uint32_t w)
+{
+	for (uint32_t x = 0; x < w; x += 2) {
+		YUV444_to_R8G8B8(src[0], src[1], src[3], dst + 0);
+		YUV444_to_R8G8B8(src[2], src[1], src[3], dst + 3);
+		src += 4;
+		dst += 6;
+	}
+}
+
+static void
+scalar_uyvy422_to_r8g8b8(const uint8_t *src, uint8_t *dst, uint32_t w)
+{
+	for (uint32_t x = 0; x < w; x += 2) {
+		YUV444_to_R8G8B8(src[1], src[0], src[2], dst + 0);
+		YUV444_to_R8G8B8(src[3], src[0], src[2], dst + 3);
+		src += 4;
+		dst += 6;
+	}
+}
+
+static void
+scalar_yuyv422_to_l8(const uint8_t *src, uint8_t *dst, uint32_t w)
+{
+	for (uint32_t x = 0; x < w; x++) {
+		dst[x] = src[x * 2];
+	}
+}
+
+static void
+scalar_l8_to_r8g8b8(const uint8_t *src, uint8_t *dst, uint32_t w)
+{
+	for (uint32_t x = 0; x < w; x++) {
+		dst[x * 3 + 2] = dst[x * 3 + 1] = dst[x * 3 + 0] = src[x];
+	}
+}
+
+static void
+scalar_bayer_gr8_to_r8g8b8(const uint8_t *src0, const uint8_t *src1, uint8_t *dst, uint32_t w)
+{
+	for (uint32_t x = 0; x < w; x++) {
+		uint8_t g0 = src0[0];
+		uint8_t r = src0[1];
+		uint8_t b = src1[0];
+		uint8_t g1 = src1[1];
+
+		dst[0] = r;
+		dst[1] = (g0 + g1) / 2;
+		dst[2] = b;
+
+		src0 += 2;
+		src1 += 2;
+		dst += 3;
+	}
+}
+
+static const struct u_sink_converter_funcs scalar_funcs = {
+    .name = "scalar",
+    .yuyv422_to_r8g8b8 = scalar_yuyv422_to_r8g8b8,
+    .uyvy422_to_r8g8b8 = scalar_uyvy422_to_r8g8b8,
+    .yuyv422_to_l8 = scalar_yuyv422_to_l8,
+    .l8_to_r8g8b8 = scalar_l8_to_r8g8b8,
+    .bayer_gr8_to_r8g8b8 = scalar_bayer_gr8_to_r8g8b8,
+};
+
+
+/*
+ *
+ * SSE4.1 and AVX2 functions.
+ *
+ * All of them work on 16 pixels at a time, the tail of a row is done with the
+ * scalar functions. The YUV math is done in 32-bit lanes so that the results
+ * are identical to the scalar version.
+ *
+ */
+
+#ifdef HAVE_X86_SIMD
+
+/*!
+ * Interleave 16 bytes of each channel into 48 bytes of R8G8B8.
+ */
+TARGET_SSE41 static inline void
+sse_store_r8g8b8(__m128i r, __m128i g, __m128i b, uint8_t *dst)
+{
+	const char Z = (char)0x80;
+
+	const __m128i r0 = _mm_setr_epi8(0, Z, Z, 1, Z, Z, 2, Z, Z, 3, Z, Z, 4, Z, Z, 5);
+	const __m128i g0 = _mm_setr_epi8(Z, 0, Z, Z, 1, Z, Z, 2, Z, Z, 3, Z, Z, 4, Z, Z);
+	const __m128i b0 = _mm_setr_epi8(Z, Z, 0, Z, Z, 1, Z, Z, 2, Z, Z, 3, Z, Z, 4, Z);
+	const __m128i r1 = _mm_setr_epi8(Z, Z, 6, Z, Z, 7, Z, Z, 8, Z, Z, 9, Z, Z, 10, Z);
+	const __m128i g1 = _mm_setr_epi8(5, Z, Z, 6, Z, Z, 7, Z, Z, 8, Z, Z, 9, Z, Z, 10);
+	const __m128i b1 = _mm_setr_epi8(Z, 5, Z, Z, 6, Z, Z, 7, Z, Z, 8, Z, Z, 9, Z, Z);
+	const __m128i r2 = _mm_setr_epi8(Z, 11, Z, Z, 12, Z, Z, 13, Z, Z, 14, Z, Z, 15, Z, Z);
+	const __m128i g2 = _mm_setr_epi8(Z, Z, 11, Z, Z, 12, Z, Z, 13, Z, Z, 14, Z, Z, 15, Z);
+	const __m128i b2 = _mm_setr_epi8(10, Z, Z, 11, Z, Z, 12, Z, Z, 13, Z, Z, 14, Z, Z, 15);
+
+	__m128i out0 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r0), _mm_shuffle_epi8(g, g0)),
+	                            _mm_shuffle_epi8(b, b0));
+	__m128i out1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r1), _mm_shuffle_epi8(g, g1)),
+	                            _mm_shuffle_epi8(b, b1));
+	__m128i out2 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r2), _mm_shuffle_epi8(g, g2)),
+	                            _mm_shuffle_epi8(b, b2));
+
+	_mm_storeu_si128((__m128i *)(dst + 0), out0);
+	_mm_storeu_si128((__m128i *)(dst + 16), out1);
+	_mm_storeu_si128((__m128i *)(dst + 32), out2);
+}
+
+/*!
+ * Split 16 pixels of packed 4:2:2 into 16 bytes of Y, U and V each, the
+ * chroma is duplicated for both pixels sharing it.
+ */
+TARGET_SSE41 static inline void
+sse_load_422(const uint8_t *src, bool uyvy, __m128i *out_y, __m128i *out_u, __m128i *out_v)
+{
+	const char Z = (char)0x80;
+
+	__m128i in0 = _mm_loadu_si128((const __m128i *)(src + 0));
+	__m128i in1 = _mm_loadu_si128((const __m128i *)(src + 16));
+
+	__m128i ym, um, vm;
+	if (uyvy) {
+		ym = _mm_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15, Z, Z, Z, Z, Z, Z, Z, Z);
+		um = _mm_setr_epi8(0, 0, 4, 4, 8, 8, 12, 12, Z, Z, Z, Z, Z, Z, Z, Z);
+		vm = _mm_setr_epi8(2, 2, 6, 6, 10, 10, 14, 14, Z, Z, Z, Z, Z, Z, Z, Z);
+	} else {
+		ym = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, Z, Z, Z, Z, Z, Z, Z, Z);
+		um = _mm_setr_epi8(1, 1, 5, 5, 9, 9, 13, 13, Z, Z, Z, Z, Z, Z, Z, Z);
+		vm = _mm_setr_epi8(3, 3, 7, 7, 11, 11, 15, 15, Z, Z, Z, Z, Z, Z, Z, Z);
+	}
+
+	*out_y = _mm_unpacklo_epi64(_mm_shuffle_epi8(in0, ym), _mm_shuffle_epi8(in1, ym));
+	*out_u = _mm_unpacklo_epi64(_mm_shuffle_epi8(in0, um), _mm_shuffle_epi8(in1, um));
+	*out_v = _mm_unpacklo_epi64(_mm_shuffle_epi8(in0, vm), _mm_shuffle_epi8(in1, vm));
+}
+
+//! Convert 4 pixels held in the low bytes of @p y, @p u and @p v.
+TARGET_SSE41 static inline void
+sse41_yuv4_to_rgb(__m128i y, __m128i u, __m128i v, __m128i *out_r, __m128i *out_g, __m128i *out_b)
+{
+	__m128i C = _mm_sub_epi32(_mm_cvtepu8_epi32(y), _mm_set1_epi32(16));
+	__m128i D = _mm_sub_epi32(_mm_cvtepu8_epi32(u), _mm_set1_epi32(128));
+	__m128i E = _mm_sub_epi32(_mm_cvtepu8_epi32(v), _mm_set1_epi32(128));
+
+	__m128i C298 = _mm_add_epi32(_mm_mullo_epi32(C, _mm_set1_epi32(298)), _mm_set1_epi32(128));
+
+	__m128i R = _mm_add_epi32(C298, _mm_mullo_epi32(E, _mm_set1_epi32(409)));
+	__m128i G = _mm_sub_epi32(C298, _mm_add_epi32(_mm_mullo_epi32(D, _mm_set1_epi32(100)),
+	                                              _mm_mullo_epi32(E, _mm_set1_epi32(209))));
+	__m128i B = _mm_add_epi32(C298, _mm_mullo_epi32(D, _mm_set1_epi32(516)));
+
+	*out_r = _mm_srai_epi32(R, 8);
+	*out_g = _mm_srai_epi32(G, 8);
+	*out_b = _mm_srai_epi32(B, 8);
+}
+
+//! Saturating pack of 16 32-bit values to bytes, same as @ref clamp_to_byte.
+TARGET_SSE41 static inline __m128i
+sse_pack_clamp(__m128i a, __m128i b, __m128i c, __m128i d)
+{
+	return _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+}
+
+TARGET_SSE41 static inline void
+sse41_yuv16_to_r8g8b8(__m128i y, __m128i u, __m128i v, uint8_t *dst)
+{
+	__m128i r[4], g[4], b[4];
+
+	sse41_yuv4_to_rgb(y, u, v, &r[0], &g[0], &b[0]);
+	sse41_yuv4_to_rgb(_mm_srli_si128(y, 4), _mm_srli_si128(u, 4), _mm_srli_si128(v, 4), &r[1], &g[1], &b[1]);
+	sse41_yuv4_to_rgb(_mm_srli_si128(y, 8), _mm_srli_si128(u, 8), _mm_srli_si128(v, 8), &r[2], &g[2], &b[2]);
+	sse41_yuv4_to_rgb(_mm_srli_si128(y, 12), _mm_srli_si128(u, 12), _mm_srli_si128(v, 12), &r[3], &g[3], &b[3]);
+
+	sse_store_r8g8b8(                              //
+	    sse_pack_clamp(r[0], r[1], r[2], r[3]),    //
+	    sse_pack_clamp(g[0], g[1], g[2], g[3]),    //
+	    sse_pack_clamp(b[0], b[1], b[2], b[3]),    //
+	    dst);                                      //
+}
+
+TARGET_SSE41 static void
+sse41_yuyv422_to_r8g8b8(const uint8_t *src, uint8_t *dst, uint32_t w)
+{
+	uint32_t x = 0;
+	for (; x + 16 <= w; x += 16) {
+		__m128i y, u, v;
+		sse_load_422(src + x * 2, false, &y, &u, &v);
+		sse41_yuv16_to_r8g8b8(y, u, v, dst + x * 3);
+	}
+
+	scalar_yuyv422_to_r8g8b8(src + x * 2, dst + x * 3, w - x);
+}
+
+TARGET_SSE41 static void
+sse41_uyvy422_to_r8g8b8(const uint8_t *src, uint8_t *dst, uint32_t w)
+{
+	uint32_t x = 0;
+	for (; x + 16 <= w; x += 16) {
+		__m128i y, u, v;
+		sse_load_422(src + x * 2, true, &y, &u, &v);
+		sse41_yuv16_to_r8g8b8(y, u, v, dst + x * 3);
+	}
+
+	scalar_uyvy422_to_r8g8b8(src + x * 2, dst + x * 3, w - x);
+}
+
+TARGET_SSE41 static void
+sse41_yuyv422_to_l8(const uint8_t *src, uint8_t *dst, uint32_t w)
+{
+	const __m128i mask = _mm_set1_epi16(0x00ff);
+
+	uint32_t x = 0;
+	for (; x + 16 <= w; x += 16) {
+		__m128i in0 = _mm_loadu_si128((const __m128i *)(src + x * 2 + 0));
+		__m128i in1 = _mm_loadu_si128((const __m128i *)(src + x * 2 + 16));
+		__m128i y = _mm_packus_epi16(_mm_and_si128(in0, mask), _mm_and_si128(in1, mask));
+		_mm_storeu_si128((__m128i *)(dst + x), y);
+	}
+
+	scalar_yuyv422_to_l8(src + x * 2, dst + x, w - x);
+}
+
+TARGET_SSE41 static void
+sse41_l8_to_r8g8b8(const uint8_t *src, uint8_t *dst, uint32_t w)
+{
+	uint32_t x = 0;
+	for (; x + 16 <= w; x += 16) {
+		__m128i l = _mm_loadu_si128((const __m128i *)(src + x));
+		sse_store_r8g8b8(l, l, l, dst + x * 3);
+	}
+
+	scalar_l8_to_r8g8b8(src + x, dst + x * 3, w - x);
+}
+
+TARGET_SSE41 static void
+sse41_bayer_gr8_to_r8g8b8(const uint8_t *src0, const uint8_t *src1, uint8_t *dst, uint32_t w)
+{
+	const __m128i mask = _mm_set1_epi16(0x00ff);
+
+	uint32_t x = 0;
+	for (; x + 16 <= w; x += 16) {
+		__m128i a0 = _mm_loadu_si128((const __m128i *)(src0 + x * 2 + 0));
+		__m128i a1 = _mm_loadu_si128((const __m128i *)(src0 + x * 2 + 16));
+		__m128i b0 = _mm_loadu_si128((const __m128i *)(src1 + x * 2 + 0));
+		__m128i b1 = _mm_loadu_si128((const __m128i *)(src1 + x * 2 + 16));
+
+		// Even bytes are G0 and B, odd bytes are R and G1, as 16-bit values.
+		__m128i g0_lo = _mm_and_si128(a0, mask);
+		__m128i g0_hi = _mm_and_si128(a1, mask);
+		__m128i g1_lo = _mm_srli_epi16(b0, 8);
+		__m128i g1_hi = _mm_srli_epi16(b1, 8);
+
+		// Truncating average, _mm_avg_epu8 rounds up so can't be used.
+		__m128i g_lo = _mm_srli_epi16(_mm_add_epi16(g0_lo, g1_lo), 1);
+		__m128i g_hi = _mm_srli_epi16(_mm_add_epi16(g0_hi, g1_hi), 1);
+
+		__m128i r = _mm_packus_epi16(_mm_srli_epi16(a0, 8), _mm_srli_epi16(a1, 8));
+		__m128i g = _mm_packus_epi16(g_lo, g_hi);
+		__m128i b = _mm_packus_epi16(_mm_and_si128(b0, mask), _mm_and_si128(b1, mask));
+
+		sse_store_r8g8b8(r, g, b, dst + x * 3);
+	}
+
+	scalar_bayer_gr8_to_r8g8b8(src0 + x * 2, src1 + x * 2, dst + x * 3, w - x);
+}
+
+static const struct u_sink_converter_funcs sse41_funcs = {
+    .name = "sse4.1",
+    .yuyv422_to_r8g8b8 = sse41_yuyv422_to_r8g8b8,
+    .uyvy422_to_r8g8b8 = sse41_uyvy422_to_r8g8b8,
+    .yuyv422_to_l8 = sse41_yuyv422_to_l8,
+    .l8_to_r8g8b8 = sse41_l8_to_r8g8b8,
+    .bayer_gr8_to_r8g8b8 = sse41_bayer_gr8_to_r8g8b8,
+};
+
+//! Convert 8 pixels held in the low bytes of @p y, @p u and @p v.
+TARGET_AVX2 static inline void
+avx2_yuv8_to_rgb(__m128i y, __m128i u, __m128i v, __m256i *out_r, __m256i *out_g, __m256i *out_b)
+{
+	__m256i C = _mm256_sub_epi32(_mm256_cvtepu8_epi32(y), _mm256_set1_epi32(16));
+	__m256i D = _mm256_sub_epi32(_mm256_cvtepu8_epi32(u), _mm256_set1_epi32(128));
+	__m256i E = _mm256_sub_epi32(_mm256_cvtepu8_epi32(v), _mm256_set1_epi32(128));
+
+	__m256i C298 = _mm256_add_epi32(_mm256_mullo_epi32(C, _mm256_set1_epi32(298)), _mm256_set1_epi32(128));
+
+	__m256i R = _mm256_add_epi32(C298, _mm256_mullo_epi32(E, _mm256_set1_epi32(409)));
+	__m256i G = _mm256_sub_epi32(C298, _mm256_add_epi32(_mm256_mullo_epi32(D, _mm256_set1_epi32(100)),
+	                                                    _mm256_mullo_epi32(E, _mm256_set1_epi32(209))));
+	__m256i B = _mm256_add_epi32(C298, _mm256_mullo_epi32(D, _mm256_set1_epi32(516)));
+
+	*out_r = _mm256_srai_epi32(R, 8);
+	*out_g = _mm256_srai_epi32(G, 8);
+	*out_b = _mm256_srai_epi32(B, 8);
+}
+
+//! Saturating pack of 16 32-bit values to bytes, same as @ref clamp_to_byte.
+TARGET_AVX2 static inline __m128i
+avx2_pack_clamp(__m256i a, __m256i b)
+{
+	// The pack works per 128-bit lane, put the 64-bit blocks back in order.
+	__m256i p = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xd8);
+	return _mm_packus_epi16(_mm256_castsi256_si128(p), _mm256_extracti128_si256(p, 1));
+}
+
+TARGET_AVX2 static inline void
+avx2_yuv16_to_r8g8b8(__m128i y, __m128i u, __m128i v, uint8_t *dst)
+{
+	__m256i r[2], g[2], b[2];
+
+	avx2_yuv8_to_rgb(y, u, v, &r[0], &g[0], &b[0]);
+	avx2_yuv8_to_rgb(_mm_srli_si128(y, 8), _mm_srli_si128(u, 8), _mm_srli_si128(v, 8), &r[1], &g[1], &b[1]);
+
+	sse_store_r8g8b8(                  //
+	    avx2_pack_clamp(r[0], r[1]),   //
+	    avx2_pack_clamp(g[0], g[1]),   //
+	    avx2_pack_clamp(b[0], b[1]),   //
+	    dst);                          //
+}
+
+TARGET_AVX2 static void
+avx2_yuyv422_to_r8g8b8(const uint8_t *src, uint8_t *dst, uint32_t w)
+{
+	uint32_t x = 0;
+	for (; x + 16 <= w; x += 16) {
+		__m128i y, u, v;
+		sse_load_422(src + x * 2, false, &y, &u, &v);
+		avx2_yuv16_to_r8g8b8(y, u, v, dst + x * 3);
+	}
+
+	scalar_yuyv422_to_r8g8b8(src + x * 2, dst + x * 3, w - x);
+}
+
+TARGET_AVX2 static void
+avx2_uyvy422_to_r8g8b8(const uint8_t *src, uint8_t *dst, uint32_t w)
+{
+	uint32_t x = 0;
+	for (; x + 16 <= w; x += 16) {
+		__m128i y, u, v;
+		sse_load_422(src + x * 2, true, &y, &u, &v);
+		avx2_yuv16_to_r8g8b8(y, u, v, dst + x * 3);
+	}
+
+	scalar_uyvy422_to_r8g8b8(src + x * 2, dst + x * 3, w - x);
+}
+
+/*!
+ * Only the YUV math benefits from the wider lanes, the shuffle bound kernels
+ * are shared with SSE4.1.
+ */
+static const struct u_sink_converter_funcs avx2_funcs = {
+    .name = "avx2",
+    .yuyv422_to_r8g8b8 = avx2_yuyv422_to_r8g8b8,
+    .uyvy422_to_r8g8b8 = avx2_uyvy422_to_r8g8b8,
+    .yuyv422_to_l8 = sse41_yuyv422_to_l8,
+    .l8_to_r8g8b8 = sse41_l8_to_r8g8b8,
+    .bayer_gr8_to_r8g8b8 = sse41_bayer_gr8_to_r8g8b8,
+};
+
+#endif // HAVE_X86_SIMD
+
+
+/*
+ *
+ * NEON functions.
+ *
+ */
+
+#ifdef HAVE_NEON
+
+//! Convert 8 pixels, @p d and @p e are the already offset chroma values.
+static inline void
+neon_yuv8_to_rgb(uint8x8_t y, int16x8_t d, int16x8_t e, uint8x8_t *out_r, uint8x8_t *out_g, uint8x8_t *out_b)
+{
+	int16x8_t c = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(y)), vdupq_n_s16(16));
+
+	int32x4_t c298_lo = vaddq_s32(vmull_n_s16(vget_low_s16(c), 298), vdupq_n_s32(128));
+	int32x4_t c298_hi = vaddq_s32(vmull_n_s16(vget_high_s16(c), 298), vdupq_n_s32(128));
+
+	int32x4_t r_lo = vmlal_n_s16(c298_lo, vget_low_s16(e), 409);
+	int32x4_t r_hi = vmlal_n_s16(c298_hi, vget_high_s16(e), 409);
+
+	int32x4_t g_lo = vmlsl_n_s16(vmlsl_n_s16(c298_lo, vget_low_s16(d), 100), vget_low_s16(e), 209);
+	int32x4_t g_hi = vmlsl_n_s16(vmlsl_n_s16(c298_hi, vget_high_s16(d), 100), vget_high_s16(e), 209);
+
+	int32x4_t b_lo = vmlal_n_s16(c298_lo, vget_low_s16(d), 516);
+	int32x4_t b_hi = vmlal_n_s16(c298_hi, vget_high_s16(d), 516);
+
+	// Shift, then saturate to int16 and uint8, same as clamp_to_byte.
+	*out_r = vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(r_lo, 8)), vqmovn_s32(vshrq_n_s32(r_hi, 8))));
+	*out_g = vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(g_lo, 8)), vqmovn_s32(vshrq_n_s32(g_hi, 8))));
+	*out_b = vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(b_lo, 8)), vqmovn_s32(vshrq_n_s32(b_hi, 8))));
+}
+
+//! Convert 16 pixels from 8 pairs of luma samples sharing chroma.
+static inline void
+neon_422_to_r8g8b8(uint8x8_t y0, uint8x8_t y1, uint8x8_t u, uint8x8_t v, uint8_t *dst)
+{
+	int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u)), vdupq_n_s16(128));
+	int16x8_t e = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v)), vdupq_n_s16(128));
+
+	uint8x8_t r0, g0, b0, r1, g1, b1;
+	neon_yuv8_to_rgb(y0, d, e, &r0, &g0, &b0);
+	neon_yuv8_to_rgb(y1, d, e, &r1, &g1, &b1);
+
+	// Put the even and odd pixels back together.
+	uint8x8x2_t r = vzip_u8(r0, r1);
+	uint8x8x2_t g = vzip_u8(g0, g1);
+	uint8x8x2_t b = vzip_u8(b0, b1);
+
+	uint8x16x3_t rgb;
+	rgb.val[0] = vcombine_u8(r.val[0], r.val[1]);
+	rgb.val[1] = vcombine_u8(g.val[0], g.val[1]);
+	rgb.val[2] = vcombine_u8(b.val[0], b.val[1]);
+	vst3q_u8(dst, rgb);
+}
+
+static void
+neon_yuyv422_to_r8g8b8(const uint8_t *src, uint8_t *dst, uint32_t w)
+{
+	uint32_t x = 0;
+	for (; x + 16 <= w; x += 16) {
+		uint8x8x4_t in = vld4_u8(src + x * 2);
+		neon_422_to_r8g8b8(in.val[0], in.val[2], in.val[1], in.val[3], dst + x * 3);
+	}
+
+	scalar_yuyv422_to_r8g8b8(src + x * 2, dst + x * 3, w - x);
+}
+
+static void
+neon_uyvy422_to_r8g8b8(const uint8_t *src, uint8_t *dst, uint32_t w)
+{
+	uint32_t x = 0;
+	for (; x + 16 <= w; x += 16) {
+		uint8x8x4_t in = vld4_u8(src + x * 2);
+		neon_422_to_r8g8b8(in.val[1], in.val[3], in.val[0], in.val[2], dst + x * 3);
+	}
+
+	scalar_uyvy422_to_r8g8b8(src + x * 2, dst + x * 3, w - x);
+}
+
+static void
+neon_yuyv422_to_l8(const uint8_t *src, uint8_t *dst, uint32_t w)
+{
+	uint32_t x = 0;
+	for (; x + 16 <= w; x += 16) {
+		uint8x16x2_t in = vld2q_u8(src + x * 2);
+		vst1q_u8(dst + x, in.val[0]);
+	}
+
+	scalar_yuyv422_to_l8(src + x * 2, dst + x, w - x);
+}
+
+static void
+neon_l8_to_r8g8b8(const uint8_t *src, uint8_t *dst, uint32_t w)
+{
+	uint32_t x = 0;
+	for (; x + 16 <= w; x += 16) {
+		uint8x16_t l = vld1q_u8(src + x);
+		uint8x16x3_t rgb;
+		rgb.val[0] = l;
+		rgb.val[1] = l;
+		rgb.val[2] = l;
+		vst3q_u8(dst + x * 3, rgb);
+	}
+
+	scalar_l8_to_r8g8b8(src + x, dst + x * 3, w - x);
+}
+
+static void
+neon_bayer_gr8_to_r8g8b8(const uint8_t *src0, const uint8_t *src1, uint8_t *dst, uint32_t w)
+{
+	uint32_t x = 0;
+	for (; x + 16 <= w; x += 16) {
+		uint8x16x2_t gr = vld2q_u8(src0 + x * 2);
+		uint8x16x2_t bg = vld2q_u8(src1 + x * 2);
+
+		uint8x16x3_t rgb;
+		rgb.val[0] = gr.val[1];
+		rgb.val[1] = vhaddq_u8(gr.val[0], bg.val[1]); // Truncating like the scalar version.
+		rgb.val[2] = bg.val[0];
+		vst3q_u8(dst + x * 3, rgb);
+	}
+
+	scalar_bayer_gr8_to_r8g8b8(src0 + x * 2, src1 + x * 2, dst + x * 3, w - x);
+}
+
+static const struct u_sink_converter_funcs neon_funcs = {
+    .name = "neon",
+    .yuyv422_to_r8g8b8 = neon_yuyv422_to_r8g8b8,
+    .uyvy422_to_r8g8b8 = neon_uyvy422_to_r8g8b8,
+    .yuyv422_to_l8 = neon_yuyv422_to_l8,
+    .l8_to_r8g8b8 = neon_l8_to_r8g8b8,
+    .bayer_gr8_to_r8g8b8 = neon_bayer_gr8_to_r8g8b8,
+};
+
+#endif // HAVE_NEON
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+const struct u_sink_converter_funcs *
+u_sink_converter_simd_get_funcs(enum u_sink_converter_simd simd)
+{
+	switch (simd) {
+	case U_SINK_CONVERTER_SIMD_SCALAR: return &scalar_funcs;
+#ifdef HAVE_X86_SIMD
+	case U_SINK_CONVERTER_SIMD_SSE41:
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("sse4.1") ? &sse41_funcs : NULL;
+	case U_SINK_CONVERTER_SIMD_AVX2:
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") ? &avx2_funcs : NULL;
+#endif
+#ifdef HAVE_NEON
+	case U_SINK_CONVERTER_SIMD_NEON: return &neon_funcs;
+#endif
+	default: return NULL;
+	}
+}
+
+const struct u_sink_converter_funcs *
+u_sink_converter_simd_get_best_funcs(void)
+{
+	// Benign race, all threads will pick the same value.
+	static const struct u_sink_converter_funcs *best = NULL;
+	if (best != NULL) {
+		return best;
+	}
+
+	const struct u_sink_converter_funcs *funcs = &scalar_funcs;
+
+	if (debug_get_bool_option_sink_converter_simd()) {
+		const enum u_sink_converter_simd order[] = {
+		    U_SINK_CONVERTER_SIMD_AVX2,
+		    U_SINK_CONVERTER_SIMD_SSE41,
+		    U_SINK_CONVERTER_SIMD_NEON,
+		};
+
+		for (size_t i = 0; i < ARRAY_SIZE(order); i++) {
+			const struct u_sink_converter_funcs *f = u_sink_converter_simd_get_funcs(order[i]);
+			if (f != NULL) {
+				funcs = f;
+				break;
+			}
+		}
+	}
+
+	U_LOG_D("Using '%s' frame conversion functions.", funcs->name);
+
+	best = funcs;
+
+	return best;
+}
@@ -0,0 +1,80 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Row conversion kernels used by the @ref xrt_frame_sink converters.
+ * @ingroup aux_util
+ */
+
+#pragma once
+
+#include "xrt/xrt_compiler.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*!
+ * Which implementation of the row kernels to use.
+ *
+ * @ingroup aux_util
+ */
+enum u_sink_converter_simd
+{
+	U_SINK_CONVERTER_SIMD_SCALAR,
+	U_SINK_CONVERTER_SIMD_SSE41,
+	U_SINK_CONVERTER_SIMD_AVX2,
+	U_SINK_CONVERTER_SIMD_NEON,
+};
+
+/*!
+ * A set of row conversion kernels, all of them write exactly @p w pixels and
+ * give bit identical results regardless of implementation.
+ *
+ * @ingroup aux_util
+ */
+struct u_sink_converter_funcs
+{
+	//! Name of the implementation, for logging and benchmarks.
+	const char *name;
+
+	//! @p w must be even, reads `w * 2` bytes and writes `w * 3` bytes.
+	void (*yuyv422_to_r8g8b8)(const uint8_t *src, uint8_t *dst, uint32_t w);
+
+	//! @p w must be even, reads `w * 2` bytes and writes `w * 3` bytes.
+	void (*uyvy422_to_r8g8b8)(const uint8_t *src, uint8_t *dst, uint32_t w);
+
+	//! Reads `w * 2` bytes and writes `w` bytes.
+	void (*yuyv422_to_l8)(const uint8_t *src, uint8_t *dst, uint32_t w);
+
+	//! Reads `w` bytes and writes `w * 3` bytes.
+	void (*l8_to_r8g8b8)(const uint8_t *src, uint8_t *dst, uint32_t w);
+
+	//! Reads `w * 2` bytes from each source row and writes `w * 3` bytes.
+	void (*bayer_gr8_to_r8g8b8)(const uint8_t *src0, const uint8_t *src1, uint8_t *dst, uint32_t w);
+};
+
+/*!
+ * Get the kernels for the given implementation, returns NULL if it is not
+ * compiled in or not supported by the CPU we are running on.
+ *
+ * @ingroup aux_util
+ */
+const struct u_sink_converter_funcs *
+u_sink_converter_simd_get_funcs(enum u_sink_converter_simd simd);
+
+/*!
+ * Get the fastest kernels supported by the CPU, picked once at first call.
+ * Setting `XRT_SINK_CONVERTER_SIMD=false` forces the scalar implementation.
+ *
+ * @ingroup aux_util
+ */
+const struct u_sink_converter_funcs *
+u_sink_converter_simd_get_best_funcs(void);
+
+
+#ifdef __cplusplus
+}
+#endif
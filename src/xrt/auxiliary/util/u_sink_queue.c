@@ -1,4 +1,4 @@
-// Copyright 2019-2021, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -7,6 +7,8 @@
  * @ingroup aux_util
  */
 
+#include "os/os_threading.h"
+
 #include "util/u_misc.h"
 #include "util/u_sink.h"
 #include "util/u_trace_marker.h"
@@ -51,10 +53,10 @@ struct u_sink_queue
 	uint64_t max_size;
 
 	pthread_t thread;
-	pthread_mutex_t mutex;
+	struct os_mutex mutex;
 
 	//! So we can wake the mainloop up
-	pthread_cond_t cond;
+	struct os_cond cond;
 
 	//! Should we keep running.
 	bool running;
@@ -138,13 +140,13 @@ queue_mainloop(void *ptr)
 	struct u_sink_queue *q = (struct u_sink_queue *)ptr;
 	struct xrt_frame *frame = NULL;
 
-	pthread_mutex_lock(&q->mutex);
+	os_mutex_lock(&q->mutex);
 
 	while (q->running) {
 
 		// No new frame, wait.
 		if (queue_is_empty(q)) {
-			pthread_cond_wait(&q->cond, &q->mutex);
+			os_cond_wait(&q->cond, &q->mutex);
 		}
 
 		// In this case, queue_break_apart woke us up to turn us off.
@@ -171,7 +173,7 @@ queue_mainloop(void *ptr)
 		 * Unlock the mutex when we do the work, so a new frame can be
 		 * queued.
 		 */
-		pthread_mutex_unlock(&q->mutex);
+		os_mutex_unlock(&q->mutex);
 
 		// Send to the consumer that does the work.
 		q->consumer->push_frame(q->consumer, frame);
@@ -183,10 +185,10 @@ queue_mainloop(void *ptr)
 		xrt_frame_reference(&frame, NULL);
 
 		// Have to lock it again.
-		pthread_mutex_lock(&q->mutex);
+		os_mutex_lock(&q->mutex);
 	}
 
-	pthread_mutex_unlock(&q->mutex);
+	os_mutex_unlock(&q->mutex);
 
 	return NULL;
 }
@@ -198,7 +200,7 @@ queue_frame(struct xrt_frame_sink *xfs, struct xrt_frame *xf)
 
 	struct u_sink_queue *q = (struct u_sink_queue *)xfs;
 
-	pthread_mutex_lock(&q->mutex);
+	os_mutex_lock(&q->mutex);
 
 	// Only schedule new frames if we are running.
 	if (q->running) {
@@ -206,9 +208,9 @@ queue_frame(struct xrt_frame_sink *xfs, struct xrt_frame *xf)
 	}
 
 	// Wake up the thread.
-	pthread_cond_signal(&q->cond);
+	os_cond_signal(&q->cond);
 
-	pthread_mutex_unlock(&q->mutex);
+	os_mutex_unlock(&q->mutex);
 }
 
 static void
@@ -218,7 +220,7 @@ queue_break_apart(struct xrt_frame_node *node)
 	void *retval = NULL;
 
 	// The fields are protected.
-	pthread_mutex_lock(&q->mutex);
+	os_mutex_lock(&q->mutex);
 
 	// Stop the thread and inhibit any new frames to be added to the queue.
 	q->running = false;
@@ -227,10 +229,10 @@ queue_break_apart(struct xrt_frame_node *node)
 	queue_refclear(q);
 
 	// Wake up the thread.
-	pthread_cond_signal(&q->cond);
+	os_cond_signal(&q->cond);
 
 	// No longer need to protect fields.
-	pthread_mutex_unlock(&q->mutex);
+	os_mutex_unlock(&q->mutex);
 
 	// Wait for thread to finish.
 	pthread_join(q->thread, &retval);
@@ -242,8 +244,8 @@ queue_destroy(struct xrt_frame_node *node)
 	struct u_sink_queue *q = container_of(node, struct u_sink_queue, node);
 
 	// Destroy resources.
-	pthread_mutex_destroy(&q->mutex);
-	pthread_cond_destroy(&q->cond);
+	os_mutex_destroy(&q->mutex);
+	os_cond_destroy(&q->cond);
 	free(q);
 }
 
@@ -272,23 +274,24 @@ u_sink_queue_create(struct xrt_frame_context *xfctx,
 	q->size = 0;
 	q->max_size = max_size;
 
-	ret = pthread_mutex_init(&q->mutex, NULL);
+	ret = os_mutex_init(&q->mutex);
 	if (ret != 0) {
 		free(q);
 		return false;
 	}
+	os_mutex_set_name(&q->mutex, "u_sink_queue");
 
-	ret = pthread_cond_init(&q->cond, NULL);
+	ret = os_cond_init(&q->cond);
 	if (ret) {
-		pthread_mutex_destroy(&q->mutex);
+		os_mutex_destroy(&q->mutex);
 		free(q);
 		return false;
 	}
 
 	ret = pthread_create(&q->thread, NULL, queue_mainloop, q);
 	if (ret != 0) {
-		pthread_cond_destroy(&q->cond);
-		pthread_mutex_destroy(&q->mutex);
+		os_cond_destroy(&q->cond);
+		os_mutex_destroy(&q->mutex);
 		free(q);
 		return false;
 	}
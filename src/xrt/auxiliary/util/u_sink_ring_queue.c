@@ -0,0 +1,365 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  A bounded lock-free @ref xrt_frame_sink queue.
+ * @ingroup aux_util
+ */
+
+#include "os/os_threading.h"
+
+#include "util/u_var.h"
+#include "util/u_misc.h"
+#include "util/u_sink.h"
+#include "util/u_trace_marker.h"
+
+#include <assert.h>
+
+
+/*!
+ * How many times a producer tries to make room for a new frame before it gives
+ * up and drops it instead, only hit when other producers keep filling the ring.
+ */
+#define RING_PUSH_TRIES 4
+
+struct ring_slot
+{
+	//! Sequence number of the slot, tells whether it is free or filled.
+	xrt_atomic_s32_t seq;
+
+	//! Only touched by whoever owns the slot according to @ref seq.
+	struct xrt_frame *frame;
+};
+
+/*!
+ * An @ref xrt_frame_sink queue, any frames received will be pushed to the
+ * downstream consumer on the queue thread. Pushing never blocks or allocates,
+ * it is a bounded multi-producer queue with a sequence number per slot, what
+ * to drop when full is decided by @ref u_sink_ring_queue_policy.
+ *
+ * @implements xrt_frame_sink
+ * @implements xrt_frame_node
+ */
+struct u_sink_ring_queue
+{
+	//! Base sink.
+	struct xrt_frame_sink base;
+	//! For tracking on the frame context.
+	struct xrt_frame_node node;
+
+	//! The consumer of the frames that are queued.
+	struct xrt_frame_sink *consumer;
+
+	enum u_sink_ring_queue_policy policy;
+
+	//! Always a power of two.
+	uint32_t capacity;
+	uint32_t mask;
+	struct ring_slot *slots;
+
+	//! Position of the next slot to push to.
+	xrt_atomic_s32_t push_pos;
+
+	//! Position of the next slot to pop from.
+	xrt_atomic_s32_t pop_pos;
+
+	//! Released once per pushed frame, the queue thread waits on it.
+	struct os_semaphore sem;
+
+	struct os_thread thread;
+
+	//! Should we keep running.
+	xrt_atomic_s32_t running;
+
+	struct
+	{
+		xrt_atomic_s32_t pushed;
+		xrt_atomic_s32_t dropped;
+	} stats;
+};
+
+
+/*
+ *
+ * Ring functions.
+ *
+ */
+
+static inline int32_t
+seq_diff(int32_t a, uint32_t b)
+{
+	return (int32_t)((uint32_t)a - b);
+}
+
+//! Takes ownership of the reference in @p xf on success.
+static bool
+ring_try_push(struct u_sink_ring_queue *q, struct xrt_frame *xf)
+{
+	uint32_t pos = (uint32_t)xrt_atomic_s32_load_acquire(&q->push_pos);
+
+	while (true) {
+		struct ring_slot *slot = &q->slots[pos & q->mask];
+		int32_t diff = seq_diff(xrt_atomic_s32_load_acquire(&slot->seq), pos);
+
+		if (diff == 0) {
+			// Slot is free, try to claim it.
+			int32_t old = xrt_atomic_s32_cmpxchg(&q->push_pos, (int32_t)pos, (int32_t)(pos + 1));
+			if (old == (int32_t)pos) {
+				slot->frame = xf;
+				xrt_atomic_s32_store_release(&slot->seq, (int32_t)(pos + 1));
+				return true;
+			}
+			pos = (uint32_t)old;
+		} else if (diff < 0) {
+			// Full.
+			return false;
+		} else {
+			// Another producer got here first.
+			pos = (uint32_t)xrt_atomic_s32_load_acquire(&q->push_pos);
+		}
+	}
+}
+
+//! Returns the frame with the reference the ring held, or NULL if empty.
+static struct xrt_frame *
+ring_try_pop(struct u_sink_ring_queue *q)
+{
+	uint32_t pos = (uint32_t)xrt_atomic_s32_load_acquire(&q->pop_pos);
+
+	while (true) {
+		struct ring_slot *slot = &q->slots[pos & q->mask];
+		int32_t diff = seq_diff(xrt_atomic_s32_load_acquire(&slot->seq), pos + 1);
+
+		if (diff == 0) {
+			// Slot is filled, try to claim it.
+			int32_t old = xrt_atomic_s32_cmpxchg(&q->pop_pos, (int32_t)pos, (int32_t)(pos + 1));
+			if (old == (int32_t)pos) {
+				struct xrt_frame *xf = slot->frame;
+				slot->frame = NULL;
+				xrt_atomic_s32_store_release(&slot->seq, (int32_t)(pos + q->capacity));
+				return xf;
+			}
+			pos = (uint32_t)old;
+		} else if (diff < 0) {
+			// Empty.
+			return NULL;
+		} else {
+			// Somebody else popped it.
+			pos = (uint32_t)xrt_atomic_s32_load_acquire(&q->pop_pos);
+		}
+	}
+}
+
+static void
+ring_drop(struct u_sink_ring_queue *q, struct xrt_frame **xf_ptr)
+{
+	xrt_atomic_s32_inc_return(&q->stats.dropped);
+	xrt_frame_reference(xf_ptr, NULL);
+}
+
+static void
+ring_refclear(struct u_sink_ring_queue *q)
+{
+	struct xrt_frame *xf = NULL;
+	while ((xf = ring_try_pop(q)) != NULL) {
+		xrt_frame_reference(&xf, NULL);
+	}
+}
+
+
+/*
+ *
+ * Sink functions.
+ *
+ */
+
+static void *
+queue_mainloop(void *ptr)
+{
+	U_TRACE_SET_THREAD_NAME("Sink Ring Queue");
+
+	struct u_sink_ring_queue *q = (struct u_sink_ring_queue *)ptr;
+
+	while (true) {
+		os_semaphore_wait(&q->sem, 0);
+
+		// In this case, queue_break_apart woke us up to turn us off.
+		if (xrt_atomic_s32_load_acquire(&q->running) == 0) {
+			break;
+		}
+
+		// Might be empty if a producer dropped the oldest frame.
+		struct xrt_frame *frame = ring_try_pop(q);
+		if (frame == NULL) {
+			continue;
+		}
+
+		SINK_TRACE_IDENT(queue_frame);
+
+		// Send to the consumer that does the work.
+		q->consumer->push_frame(q->consumer, frame);
+
+		/*
+		 * Drop our reference we don't need it anymore, or it's held by
+		 * the consumer.
+		 */
+		xrt_frame_reference(&frame, NULL);
+	}
+
+	return NULL;
+}
+
+static void
+queue_frame(struct xrt_frame_sink *xfs, struct xrt_frame *xf)
+{
+	SINK_TRACE_MARKER();
+
+	struct u_sink_ring_queue *q = (struct u_sink_ring_queue *)xfs;
+
+	// Only schedule new frames if we are running.
+	if (xrt_atomic_s32_load_acquire(&q->running) == 0) {
+		return;
+	}
+
+	struct xrt_frame *ref = NULL;
+	xrt_frame_reference(&ref, xf);
+
+	xrt_atomic_s32_inc_return(&q->stats.pushed);
+
+	for (uint32_t i = 0; i < RING_PUSH_TRIES; i++) {
+		if (ring_try_push(q, ref)) {
+			// Wake up the thread.
+			os_semaphore_release(&q->sem);
+			return;
+		}
+
+		if (q->policy == U_SINK_RING_QUEUE_DROP_NEWEST) {
+			break;
+		}
+
+		// Make room by dropping the oldest frame, it's a multi consumer ring.
+		struct xrt_frame *old = ring_try_pop(q);
+		if (old != NULL) {
+			ring_drop(q, &old);
+		}
+	}
+
+	ring_drop(q, &ref);
+}
+
+static void
+queue_break_apart(struct xrt_frame_node *node)
+{
+	struct u_sink_ring_queue *q = container_of(node, struct u_sink_ring_queue, node);
+
+	// Stop the thread and inhibit any new frames to be added to the queue.
+	xrt_atomic_s32_store_release(&q->running, 0);
+
+	// Wake up the thread.
+	os_semaphore_release(&q->sem);
+
+	// Wait for thread to finish.
+	os_thread_join(&q->thread);
+
+	// Release any frame waiting for submission.
+	ring_refclear(q);
+}
+
+static void
+queue_destroy(struct xrt_frame_node *node)
+{
+	struct u_sink_ring_queue *q = container_of(node, struct u_sink_ring_queue, node);
+
+	// A producer might have raced with break apart.
+	ring_refclear(q);
+
+	u_var_remove_root(q);
+
+	// Destroy resources.
+	os_thread_destroy(&q->thread);
+	os_semaphore_destroy(&q->sem);
+	free(q->slots);
+	free(q);
+}
+
+
+/*
+ *
+ * Exported functions.
+ *
+ */
+
+bool
+u_sink_ring_queue_create(struct xrt_frame_context *xfctx,
+                         uint32_t capacity,
+                         enum u_sink_ring_queue_policy policy,
+                         struct xrt_frame_sink *downstream,
+                         struct xrt_frame_sink **out_xfs)
+{
+	assert(capacity > 0 && capacity <= (1u << 16));
+
+	// Round up to a power of two so positions can be masked.
+	uint32_t pow2 = 1;
+	while (pow2 < capacity) {
+		pow2 <<= 1;
+	}
+
+	struct u_sink_ring_queue *q = U_TYPED_CALLOC(struct u_sink_ring_queue);
+	int ret = 0;
+
+	q->base.push_frame = queue_frame;
+	q->node.break_apart = queue_break_apart;
+	q->node.destroy = queue_destroy;
+	q->consumer = downstream;
+	q->policy = policy;
+	q->capacity = pow2;
+	q->mask = pow2 - 1;
+	q->running = 1;
+
+	q->slots = U_TYPED_ARRAY_CALLOC(struct ring_slot, pow2);
+	for (uint32_t i = 0; i < pow2; i++) {
+		q->slots[i].seq = (int32_t)i;
+	}
+
+	ret = os_semaphore_init(&q->sem, 0);
+	if (ret != 0) {
+		free(q->slots);
+		free(q);
+		return false;
+	}
+
+	ret = os_thread_init(&q->thread);
+	if (ret != 0) {
+		os_semaphore_destroy(&q->sem);
+		free(q->slots);
+		free(q);
+		return false;
+	}
+
+	ret = os_thread_start(&q->thread, queue_mainloop, q);
+	if (ret != 0) {
+		os_thread_destroy(&q->thread);
+		os_semaphore_destroy(&q->sem);
+		free(q->slots);
+		free(q);
+		return false;
+	}
+
+	u_var_add_root(q, "Sink ring queue", true);
+	u_var_add_ro_i32(q, (int32_t *)&q->stats.pushed, "Pushed");
+	u_var_add_ro_i32(q, (int32_t *)&q->stats.dropped, "Dropped");
+
+	xrt_frame_context_add(xfctx, &q->node);
+
+	*out_xfs = &q->base;
+
+	return true;
+}
+
+uint32_t
+u_sink_ring_queue_get_dropped(struct xrt_frame_sink *xfs)
+{
+	struct u_sink_ring_queue *q = (struct u_sink_ring_queue *)xfs;
+
+	return (uint32_t)xrt_atomic_s32_load_acquire(&q->stats.dropped);
+}
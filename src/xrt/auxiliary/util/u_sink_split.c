@@ -93,3 +93,43 @@ u_sink_split_create(struct xrt_frame_context *xfctx,
 
 	u_sink_split_multi_create(xfctx, downstreams, 2, out_xfs);
 }
+
+bool
+u_sink_fanout_create(struct xrt_frame_context *xfctx,
+                     const struct u_sink_fanout_branch *branches,
+                     size_t branch_count,
+                     struct xrt_frame_sink **out_xfs)
+{
+	assert(branch_count <= U_SINK_MAX_SPLIT_DOWNSTREAMS);
+
+	struct xrt_frame_sink *downstreams[U_SINK_MAX_SPLIT_DOWNSTREAMS] = {0};
+	size_t count = 0;
+
+	// Queued branches first, pushing to them only takes a reference.
+	for (size_t i = 0; i < branch_count; i++) {
+		if (branches[i].queue_capacity == 0) {
+			continue;
+		}
+
+		// On failure the queues already made are cleaned up with the context.
+		bool bret = u_sink_ring_queue_create( //
+		    xfctx,                            //
+		    branches[i].queue_capacity,       //
+		    branches[i].policy,               //
+		    branches[i].sink,                 //
+		    &downstreams[count++]);           //
+		if (!bret) {
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < branch_count; i++) {
+		if (branches[i].queue_capacity == 0) {
+			downstreams[count++] = branches[i].sink;
+		}
+	}
+
+	u_sink_split_multi_create(xfctx, downstreams, count, out_xfs);
+
+	return true;
+}
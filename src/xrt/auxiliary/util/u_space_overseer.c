@@ -18,6 +18,8 @@
 #include "math/m_space.h"
 
 #include "util/u_misc.h"
+#include "util/u_time.h"
+#include "util/u_debug.h"
 #include "util/u_hashmap.h"
 #include "util/u_logging.h"
 #include "util/u_space_overseer.h"
@@ -33,6 +35,11 @@
  *
  */
 
+DEBUG_GET_ONCE_NUM_OPTION(device_cache_us, "U_SPACE_OVERSEER_DEVICE_CACHE_US", 1000)
+
+//! Number of device relations kept in @ref u_space_overseer::device_cache.
+#define U_SPACE_DEVICE_CACHE_SIZE 16
+
 /*!
  * Keeps track of what kind of space it is.
  */
@@ -44,6 +51,52 @@ enum u_space_type
 	U_SPACE_TYPE_ROOT,
 };
 
+/*!
+ * A single step of a @ref u_space_chain, either a device pose that is queried
+ * every time the chain is evaluated or a fixed offset.
+ */
+struct u_space_chain_step
+{
+	//! Pose space to query, NULL for a fixed offset step.
+	struct u_space *space;
+
+	//! Should the relation of @p space be inverted.
+	bool invert;
+
+	//! Consecutive fixed offsets pre-multiplied into one, used if @p space is NULL.
+	struct xrt_pose pose;
+};
+
+/*!
+ * A relation chain between two spaces with all of the fixed offsets between
+ * the device steps already pre-multiplied. Only valid for the graph it was
+ * compiled from, see @ref u_space_overseer::generation.
+ */
+struct u_space_chain
+{
+	struct u_space_chain_step steps[XRT_RELATION_CHAIN_CAPACITY];
+	uint32_t step_count;
+};
+
+/*!
+ * A device relation queried at a given timestamp, shared between all spaces
+ * that have the device in their chain.
+ */
+struct u_space_device_cache_entry
+{
+	struct xrt_device *xdev;
+	enum xrt_input_name name;
+	int64_t at_timestamp_ns;
+
+	//! When the device was queried, limits how long the entry is used.
+	int64_t queried_ns;
+
+	//! Generation of the graph when queried.
+	int32_t generation;
+
+	struct xrt_space_relation relation;
+};
+
 /*!
  * Representing a single space, can be several ones. There should only be one
  * root space per overseer.
@@ -52,6 +105,9 @@ struct u_space
 {
 	struct xrt_space base;
 
+	//! Unique id, used to key the chain cache without holding a reference.
+	int32_t id;
+
 	/*!
 	 * The space this space is in.
 	 */
@@ -74,6 +130,21 @@ struct u_space
 			struct xrt_pose pose;
 		} offset;
 	};
+
+	/*!
+	 * The last compiled chain with this space as the target, protected by
+	 * its own mutex as it is filled in while only holding the read lock.
+	 */
+	struct
+	{
+		pthread_mutex_t mutex;
+
+		bool valid;
+		int32_t base_id;
+		int32_t generation;
+
+		struct u_space_chain chain;
+	} cache;
 };
 
 /*!
@@ -86,6 +157,26 @@ struct u_space_overseer
 	//! Main graph lock.
 	pthread_rwlock_t lock;
 
+	//! Bumped every time the graph or any offset changes, invalidates compiled chains.
+	xrt_atomic_s32_t generation;
+
+	/*!
+	 * Device relations recently queried, so that locating many spaces for
+	 * the same frame queries each device only once.
+	 */
+	struct
+	{
+		pthread_mutex_t mutex;
+
+		//! How long an entry is used for, zero disables the cache.
+		int64_t max_age_ns;
+
+		struct u_space_device_cache_entry entries[U_SPACE_DEVICE_CACHE_SIZE];
+
+		//! Entry to replace next.
+		uint32_t next;
+	} device_cache;
+
 	//! Map from xdev to space, each entry holds a reference.
 	struct u_hashmap_int *xdev_map;
 
@@ -139,6 +230,19 @@ u_space_overseer(struct xrt_space_overseer *xso)
 	return (struct u_space_overseer *)xso;
 }
 
+//! Source of @ref u_space::id, shared between all overseers.
+static xrt_atomic_s32_t space_id_counter;
+
+/*!
+ * Must be called after any change that changes the relation chain between two
+ * spaces, after the change has been written.
+ */
+static inline void
+bump_generation(struct u_space_overseer *uso)
+{
+	xrt_atomic_s32_inc_return(&uso->generation);
+}
+
 static const char *
 type_to_small_string(enum xrt_reference_space_type type)
 {
@@ -243,7 +347,7 @@ space_is_offset_compatible(struct u_space *us)
  * Updates the offset of a NULL or OFFSET space.
  */
 static void
-update_offset_write_locked(struct u_space *us, const struct xrt_pose *new_offset)
+update_offset_write_locked(struct u_space_overseer *uso, struct u_space *us, const struct xrt_pose *new_offset)
 {
 	assert(us->type == U_SPACE_TYPE_NULL || us->type == U_SPACE_TYPE_OFFSET);
 
@@ -254,6 +358,8 @@ update_offset_write_locked(struct u_space *us, const struct xrt_pose *new_offset
 		us->type = U_SPACE_TYPE_OFFSET;
 		us->offset.pose = *new_offset;
 	}
+
+	bump_generation(uso);
 }
 
 /*!
@@ -310,67 +416,225 @@ notify_ref_space_usage_device(struct u_space_overseer *uso, enum xrt_reference_s
  *
  */
 
+static void
+chain_push_fixed(struct u_space_chain *chain, const struct xrt_pose *pose)
+{
+	if (m_pose_is_identity(pose)) {
+		return;
+	}
+
+	// Fold into the previous step if that is a fixed offset too.
+	if (chain->step_count > 0 && chain->steps[chain->step_count - 1].space == NULL) {
+		struct u_space_chain_step *last = &chain->steps[chain->step_count - 1];
+		struct xrt_pose tmp;
+		math_pose_transform(pose, &last->pose, &tmp);
+		last->pose = tmp;
+		return;
+	}
+
+	// Same behaviour as m_relation_chain_push_relation.
+	if (chain->step_count >= XRT_RELATION_CHAIN_CAPACITY) {
+		return;
+	}
+
+	struct u_space_chain_step *step = &chain->steps[chain->step_count++];
+	step->space = NULL;
+	step->invert = false;
+	step->pose = *pose;
+}
+
+static void
+chain_push_inverted_fixed(struct u_space_chain *chain, const struct xrt_pose *pose)
+{
+	if (m_pose_is_identity(pose)) {
+		return;
+	}
+
+	struct xrt_pose invert;
+	math_pose_invert(pose, &invert);
+	chain_push_fixed(chain, &invert);
+}
+
+static void
+chain_push_device(struct u_space_chain *chain, struct u_space *space, bool invert)
+{
+	assert(space->pose.xdev != NULL);
+	assert(space->pose.xname != 0);
+
+	if (chain->step_count >= XRT_RELATION_CHAIN_CAPACITY) {
+		return;
+	}
+
+	struct u_space_chain_step *step = &chain->steps[chain->step_count++];
+	step->space = space;
+	step->invert = invert;
+	step->pose = (struct xrt_pose)XRT_POSE_IDENTITY;
+}
+
 /*!
- * For each space, push the relation of that space and then traverse by calling
- * @p push_then_traverse again with the parent space. That means traverse goes
- * from a leaf space to a the root space, relations are pushed in the same
- * order.
+ * For each space, push the relation of that space and then traverse to the
+ * parent space. That means traverse goes from a leaf space to a the root
+ * space, relations are pushed in the same order.
  */
 static void
-push_then_traverse(struct xrt_relation_chain *xrc, struct u_space *space, int64_t at_timestamp_ns)
+compile_push_then_traverse(struct u_space_chain *chain, struct u_space *space)
 {
-	switch (space->type) {
-	case U_SPACE_TYPE_NULL: break; // No-op
-	case U_SPACE_TYPE_POSE: {
-		assert(space->pose.xdev != NULL);
-		assert(space->pose.xname != 0);
+	while (space->type != U_SPACE_TYPE_ROOT) {
+		switch (space->type) {
+		case U_SPACE_TYPE_NULL: break; // No-op
+		case U_SPACE_TYPE_POSE: chain_push_device(chain, space, false); break;
+		case U_SPACE_TYPE_OFFSET: chain_push_fixed(chain, &space->offset.pose); break;
+		case U_SPACE_TYPE_ROOT: assert(false); // Should not get here.
+		}
 
-		struct xrt_space_relation xsr;
-		xrt_device_get_tracked_pose(space->pose.xdev, space->pose.xname, at_timestamp_ns, &xsr);
-		m_relation_chain_push_relation(xrc, &xsr);
-	} break;
-	case U_SPACE_TYPE_OFFSET: m_relation_chain_push_pose_if_not_identity(xrc, &space->offset.pose); break;
-	case U_SPACE_TYPE_ROOT: return; // Stops the traversing.
+		assert(space->next != NULL);
+		space = space->next;
 	}
-
-	// Please tail-call optimise this miss compiler.
-	assert(space->next != NULL);
-	push_then_traverse(xrc, space->next, at_timestamp_ns);
 }
 
 /*!
- * For each space, traverse by calling @p traverse_then_push_inverse again with
- * the parent space then push the inverse of the relation of that. That means
- * traverse goes from a leaf space to a the root space, relations are pushed in
- * the reversed order.
+ * For each space, traverse by calling @p compile_traverse_then_push_inverse
+ * again with the parent space then push the inverse of the relation of that.
+ * That means traverse goes from a leaf space to a the root space, relations
+ * are pushed in the reversed order.
  */
 static void
-traverse_then_push_inverse(struct xrt_relation_chain *xrc, struct u_space *space, int64_t at_timestamp_ns)
+compile_traverse_then_push_inverse(struct u_space_chain *chain, struct u_space *space)
 {
 	// Done traversing.
-	switch (space->type) {
-	case U_SPACE_TYPE_NULL: break;
-	case U_SPACE_TYPE_POSE: break;
-	case U_SPACE_TYPE_OFFSET: break;
-	case U_SPACE_TYPE_ROOT: return; // Stops the traversing.
+	if (space->type == U_SPACE_TYPE_ROOT) {
+		return;
 	}
 
 	// Can't tail-call optimise this one :(
 	assert(space->next != NULL);
-	traverse_then_push_inverse(xrc, space->next, at_timestamp_ns);
+	compile_traverse_then_push_inverse(chain, space->next);
 
 	switch (space->type) {
 	case U_SPACE_TYPE_NULL: break; // No-op
-	case U_SPACE_TYPE_POSE: {
-		assert(space->pose.xdev != NULL);
-		assert(space->pose.xname != 0);
+	case U_SPACE_TYPE_POSE: chain_push_device(chain, space, true); break;
+	case U_SPACE_TYPE_OFFSET: chain_push_inverted_fixed(chain, &space->offset.pose); break;
+	case U_SPACE_TYPE_ROOT: assert(false); // Should not get here.
+	}
+}
+
+/*!
+ * Gets the compiled chain from @p target to @p base, only recompiles it if the
+ * graph has changed or a different base is used since it was last compiled.
+ */
+static void
+get_compiled_chain_read_locked(struct u_space_overseer *uso,
+                               struct u_space *base,
+                               struct u_space *target,
+                               struct u_space_chain *out_chain)
+{
+	// Read before the graph, a concurrent change then at worst stores a stale generation.
+	int32_t generation = xrt_atomic_s32_load_acquire(&uso->generation);
+
+	pthread_mutex_lock(&target->cache.mutex);
+
+	if (!target->cache.valid ||                   //
+	    target->cache.base_id != base->id ||      //
+	    target->cache.generation != generation) { //
+		U_ZERO(&target->cache.chain);
+		compile_push_then_traverse(&target->cache.chain, target);
+		compile_traverse_then_push_inverse(&target->cache.chain, base);
+
+		target->cache.valid = true;
+		target->cache.base_id = base->id;
+		target->cache.generation = generation;
+	}
+
+	*out_chain = target->cache.chain;
+
+	pthread_mutex_unlock(&target->cache.mutex);
+}
+
+/*!
+ * Gets the relation of a pose space, uses the device cache if the same device
+ * was recently queried at the same timestamp. The device is called outside of
+ * the cache mutex, two threads might both query it but that is harmless.
+ */
+static void
+get_device_relation(struct u_space_overseer *uso,
+                    struct u_space *space,
+                    int64_t at_timestamp_ns,
+                    struct xrt_space_relation *out_relation)
+{
+	struct xrt_device *xdev = space->pose.xdev;
+	enum xrt_input_name name = space->pose.xname;
+	int64_t max_age_ns = uso->device_cache.max_age_ns;
+
+	if (max_age_ns <= 0) {
+		xrt_device_get_tracked_pose(xdev, name, at_timestamp_ns, out_relation);
+		return;
+	}
+
+	int32_t generation = xrt_atomic_s32_load_acquire(&uso->generation);
+	int64_t now_ns = (int64_t)os_monotonic_get_ns();
+
+	pthread_mutex_lock(&uso->device_cache.mutex);
+	for (uint32_t i = 0; i < U_SPACE_DEVICE_CACHE_SIZE; i++) {
+		const struct u_space_device_cache_entry *e = &uso->device_cache.entries[i];
+
+		if (e->xdev != xdev ||                       //
+		    e->name != name ||                       //
+		    e->at_timestamp_ns != at_timestamp_ns || //
+		    e->generation != generation ||           //
+		    now_ns - e->queried_ns > max_age_ns) {   //
+			continue;
+		}
+
+		*out_relation = e->relation;
+		pthread_mutex_unlock(&uso->device_cache.mutex);
+		return;
+	}
+	pthread_mutex_unlock(&uso->device_cache.mutex);
+
+	xrt_result_t xret = xrt_device_get_tracked_pose(xdev, name, at_timestamp_ns, out_relation);
+	if (xret != XRT_SUCCESS) {
+		return; // Don't cache failures.
+	}
+
+	pthread_mutex_lock(&uso->device_cache.mutex);
+	struct u_space_device_cache_entry *e = &uso->device_cache.entries[uso->device_cache.next];
+	uso->device_cache.next = (uso->device_cache.next + 1) % U_SPACE_DEVICE_CACHE_SIZE;
+
+	e->xdev = xdev;
+	e->name = name;
+	e->at_timestamp_ns = at_timestamp_ns;
+	e->queried_ns = now_ns;
+	e->generation = generation;
+	e->relation = *out_relation;
+	pthread_mutex_unlock(&uso->device_cache.mutex);
+}
+
+/*!
+ * Only the device steps are queried, the lock must be held so that the spaces
+ * in the chain stays alive.
+ */
+static void
+push_compiled_chain_read_locked(struct u_space_overseer *uso,
+                                struct xrt_relation_chain *xrc,
+                                const struct u_space_chain *chain,
+                                int64_t at_timestamp_ns)
+{
+	for (uint32_t i = 0; i < chain->step_count; i++) {
+		const struct u_space_chain_step *step = &chain->steps[i];
+
+		if (step->space == NULL) {
+			m_relation_chain_push_pose_if_not_identity(xrc, &step->pose);
+			continue;
+		}
 
 		struct xrt_space_relation xsr;
-		xrt_device_get_tracked_pose(space->pose.xdev, space->pose.xname, at_timestamp_ns, &xsr);
-		m_relation_chain_push_inverted_relation(xrc, &xsr);
-	} break;
-	case U_SPACE_TYPE_OFFSET: m_relation_chain_push_inverted_pose_if_not_identity(xrc, &space->offset.pose); break;
-	case U_SPACE_TYPE_ROOT: assert(false); // Should not get here.
+		get_device_relation(uso, step->space, at_timestamp_ns, &xsr);
+
+		if (step->invert) {
+			m_relation_chain_push_inverted_relation(xrc, &xsr);
+		} else {
+			m_relation_chain_push_relation(xrc, &xsr);
+		}
 	}
 }
 
@@ -385,8 +649,9 @@ build_relation_chain_read_locked(struct u_space_overseer *uso,
 	assert(base != NULL);
 	assert(target != NULL);
 
-	push_then_traverse(xrc, target, at_timestamp_ns);
-	traverse_then_push_inverse(xrc, base, at_timestamp_ns);
+	struct u_space_chain chain;
+	get_compiled_chain_read_locked(uso, base, target, &chain);
+	push_compiled_chain_read_locked(uso, xrc, &chain, at_timestamp_ns);
 }
 
 static void
@@ -437,6 +702,8 @@ space_destroy(struct xrt_space *xs)
 
 	u_space_reference(&us->next, NULL);
 
+	pthread_mutex_destroy(&us->cache.mutex);
+
 	free(us);
 }
 
@@ -454,6 +721,10 @@ create_space(enum u_space_type type, struct u_space *parent)
 	us->base.reference.count = 1;
 	us->base.destroy = space_destroy;
 	us->type = type;
+	us->id = xrt_atomic_s32_inc_return(&space_id_counter);
+
+	XRT_MAYBE_UNUSED int ret = pthread_mutex_init(&us->cache.mutex, NULL);
+	assert(ret == 0);
 
 	u_space_reference(&us->next, parent);
 
@@ -795,8 +1066,8 @@ recenter_local_spaces(struct xrt_space_overseer *xso)
 	local_floor_offset.position.z = rel.pose.position.z;
 
 	// Update the offsets.
-	update_offset_write_locked(ulocal, &local_offset);
-	update_offset_write_locked(ulocal_floor, &local_floor_offset);
+	update_offset_write_locked(uso, ulocal, &local_offset);
+	update_offset_write_locked(uso, ulocal_floor, &local_floor_offset);
 
 	// Push the events.
 	union xrt_session_event xse = XRT_STRUCT_INIT;
@@ -924,7 +1195,7 @@ set_tracking_origin_offset(struct xrt_space_overseer *xso,
 		goto unlock;
 	}
 
-	update_offset_write_locked(us, offset);
+	update_offset_write_locked(uso, us, offset);
 
 unlock:
 	pthread_rwlock_unlock(&uso->lock);
@@ -993,8 +1264,8 @@ set_reference_space_offset(struct xrt_space_overseer *xso,
 		floor.position.z = offset->position.z;
 	}
 
-	update_offset_write_locked(us, offset);
-	update_offset_write_locked(ufloor, &floor);
+	update_offset_write_locked(uso, us, offset);
+	update_offset_write_locked(uso, ufloor, &floor);
 
 	// Push the events.
 	union xrt_session_event xse = XRT_STRUCT_INIT;
@@ -1060,6 +1331,7 @@ destroy(struct xrt_space_overseer *xso)
 		xrt_space_reference(xslocalfloor_ptr, NULL);
 	}
 
+	pthread_mutex_destroy(&uso->device_cache.mutex);
 	pthread_rwlock_destroy(&uso->lock);
 
 	free(uso);
@@ -1097,6 +1369,10 @@ u_space_overseer_create(struct xrt_session_event_sink *broadcast)
 	ret = pthread_rwlock_init(&uso->lock, NULL);
 	assert(ret == 0);
 
+	ret = pthread_mutex_init(&uso->device_cache.mutex, NULL);
+	assert(ret == 0);
+	uso->device_cache.max_age_ns = (int64_t)debug_get_num_option_device_cache_us() * 1000;
+
 	ret = u_hashmap_int_create(&uso->xdev_map);
 	assert(ret == 0);
 
@@ -1215,6 +1491,8 @@ u_space_overseer_link_space_to_device(struct u_space_overseer *uso, struct xrt_s
 
 	u_hashmap_int_insert(uso->xdev_map, (uint64_t)(intptr_t)xdev, new_space);
 
+	bump_generation(uso);
+
 	pthread_rwlock_unlock(&uso->lock);
 
 	// Dereferrence old space outside of lock.
@@ -122,7 +122,9 @@ void
 u_system_remove_session(struct u_system *usys, struct xrt_session *xs, struct xrt_session_event_sink *xses);
 
 /*!
- * Broadcast event to all sessions under this system.
+ * Broadcast event to all sessions under this system. The session list lock is
+ * only contended by sessions being added or removed, and pushing to a
+ * @ref u_session never blocks, so this doesn't wait on any consumer.
  *
  * @public @memberof u_system
  * @ingroup aux_util
@@ -16,6 +16,7 @@
 
 #include <limits>
 #include <array>
+#include <functional>
 
 namespace xrt::auxiliary::util {
 
@@ -132,6 +133,26 @@ public:
 	const T *
 	get_at_index(size_t index) const noexcept;
 
+	/*!
+	 * @brief Find the index of the first element, in chronological order,
+	 * for which `comp(element, value)` is false, or size() if there is none.
+	 *
+	 * Like `std::lower_bound` the buffer must be sorted with respect to
+	 * @p comp, but the search is done directly on the indices so it is
+	 * O(log n) instead of iterating through the buffer.
+	 */
+	template <typename U, typename Compare>
+	size_t
+	lower_bound_index(const U &value, Compare comp) const noexcept;
+
+	//! @overload
+	template <typename U>
+	size_t
+	lower_bound_index(const U &value) const noexcept
+	{
+		return lower_bound_index(value, std::less<>{});
+	}
+
 	using iterator = detail::HistoryBufIterator<T, MaxSize>;
 	using const_iterator = detail::HistoryBufConstIterator<T, MaxSize>;
 
@@ -266,6 +287,29 @@ HistoryBuffer<T, MaxSize>::get_at_index(size_t index) const noexcept
 	return nullptr;
 }
 
+template <typename T, size_t MaxSize>
+template <typename U, typename Compare>
+inline size_t
+HistoryBuffer<T, MaxSize>::lower_bound_index(const U &value, Compare comp) const noexcept
+{
+	const size_t count = size();
+	size_t lo = 0;
+	size_t hi = count;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		size_t inner_index = 0;
+		if (!helper_.index_to_inner_index(mid, inner_index)) {
+			return count;
+		}
+		if (comp(internalBuffer[inner_index], value)) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
 template <typename T, size_t MaxSize>
 inline T &
 HistoryBuffer<T, MaxSize>::front()
@@ -0,0 +1,380 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Applies scheduling class and CPU affinity to threads by role.
+ * @ingroup aux_util
+ */
+
+#include "xrt/xrt_config_os.h"
+
+#include "util/u_debug.h"
+#include "util/u_thread_policy.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#if defined(XRT_OS_LINUX)
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#elif defined(XRT_OS_WINDOWS)
+#include "xrt/xrt_windows.h"
+#endif
+
+#define LOG_D(...) U_LOG_IFL_D(log_level, __VA_ARGS__)
+#define LOG_I(...) U_LOG_IFL_I(log_level, __VA_ARGS__)
+#define LOG_W(...) U_LOG_IFL_W(log_level, __VA_ARGS__)
+
+//! Realtime priority meaning the max the platform supports.
+#define PRIORITY_MAX -1
+
+DEBUG_GET_ONCE_OPTION(thread_policy, "XRT_THREAD_POLICY", NULL)
+
+
+/*
+ *
+ * Structs and defines.
+ *
+ */
+
+enum sched_class
+{
+	CLASS_INHERIT = 0,
+	CLASS_FIFO,
+	CLASS_RR,
+	CLASS_NORMAL,
+	CLASS_BATCH,
+	CLASS_IDLE,
+};
+
+struct rule
+{
+	enum sched_class sched;
+
+	//! Realtime priority for fifo and rr, nice value for normal and batch.
+	int value;
+
+	//! Cores the thread may run on, zero to leave as is.
+	uint64_t cpus;
+};
+
+//! What the threads did before the roles existed, only Linux raised priority.
+static const struct rule default_rules[OS_THREAD_ROLE_COUNT] = {
+#ifdef XRT_OS_LINUX
+    [OS_THREAD_ROLE_COMPOSITOR] = {CLASS_FIFO, PRIORITY_MAX, 0},
+    [OS_THREAD_ROLE_IMU] = {CLASS_FIFO, PRIORITY_MAX, 0},
+#else
+    [OS_THREAD_ROLE_DEFAULT] = {CLASS_INHERIT, 0, 0},
+#endif
+};
+
+
+/*
+ *
+ * Parsing.
+ *
+ */
+
+static const char *
+class_to_str(enum sched_class sched)
+{
+	switch (sched) {
+	case CLASS_INHERIT: return "inherit";
+	case CLASS_FIFO: return "fifo";
+	case CLASS_RR: return "rr";
+	case CLASS_NORMAL: return "normal";
+	case CLASS_BATCH: return "batch";
+	case CLASS_IDLE: return "idle";
+	default: return "unknown";
+	}
+}
+
+static bool
+parse_cpus(const char *str, size_t len, uint64_t *out_cpus)
+{
+	uint64_t cpus = 0;
+	const char *end = str + len;
+
+	while (str < end) {
+		char *next = NULL;
+		long first = strtol(str, &next, 10);
+		long last = first;
+		if (next == str) {
+			return false;
+		}
+
+		if (next < end && *next == '-') {
+			str = next + 1;
+			last = strtol(str, &next, 10);
+			if (next == str) {
+				return false;
+			}
+		}
+
+		if (first < 0 || last < first || last >= 64) {
+			return false;
+		}
+
+		for (long i = first; i <= last; i++) {
+			cpus |= UINT64_C(1) << i;
+		}
+
+		str = next;
+		if (str < end && *str == ',') {
+			str++;
+		} else if (str != end) {
+			return false;
+		}
+	}
+
+	*out_cpus = cpus;
+
+	return cpus != 0;
+}
+
+static bool
+parse_rule(const char *str, size_t len, struct rule *out_rule)
+{
+	struct rule rule = {CLASS_INHERIT, PRIORITY_MAX, 0};
+	const char *end = str + len;
+
+	const char *at = memchr(str, '@', len);
+	const char *class_end = at != NULL ? at : end;
+
+	const char *colon = memchr(str, ':', (size_t)(class_end - str));
+	const char *name_end = colon != NULL ? colon : class_end;
+	size_t name_len = (size_t)(name_end - str);
+
+	static const enum sched_class classes[] = {CLASS_INHERIT, CLASS_FIFO,  CLASS_RR,
+	                                           CLASS_NORMAL,  CLASS_BATCH, CLASS_IDLE};
+	bool found = false;
+	for (size_t i = 0; i < ARRAY_SIZE(classes); i++) {
+		const char *class_str = class_to_str(classes[i]);
+		if (strlen(class_str) == name_len && strncmp(str, class_str, name_len) == 0) {
+			rule.sched = classes[i];
+			found = true;
+			break;
+		}
+	}
+	if (!found) {
+		return false;
+	}
+
+	if (rule.sched == CLASS_NORMAL || rule.sched == CLASS_BATCH) {
+		rule.value = 0;
+	}
+
+	if (colon != NULL) {
+		char *next = NULL;
+		rule.value = (int)strtol(colon + 1, &next, 10);
+		if (next != class_end) {
+			return false;
+		}
+	}
+
+	if (at != NULL && !parse_cpus(at + 1, (size_t)(end - at - 1), &rule.cpus)) {
+		return false;
+	}
+
+	*out_rule = rule;
+
+	return true;
+}
+
+/*!
+ * Find the rule for @p role in the config string, the last rule for a role
+ * wins. Returns false if there is none.
+ */
+static bool
+find_rule(enum u_logging_level log_level, const char *config, enum os_thread_role role, struct rule *out_rule)
+{
+	const char *role_str = os_thread_role_str(role);
+	size_t role_len = strlen(role_str);
+	bool found = false;
+
+	while (*config != '\0') {
+		const char *end = strchr(config, ';');
+		if (end == NULL) {
+			end = config + strlen(config);
+		}
+
+		const char *eq = memchr(config, '=', (size_t)(end - config));
+		if (eq != NULL && (size_t)(eq - config) == role_len && strncmp(config, role_str, role_len) == 0) {
+			if (parse_rule(eq + 1, (size_t)(end - eq - 1), out_rule)) {
+				found = true;
+			} else {
+				LOG_W("Invalid thread policy rule '%.*s'", (int)(end - config), config);
+			}
+		}
+
+		config = *end == ';' ? end + 1 : end;
+	}
+
+	return found;
+}
+
+
+/*
+ *
+ * Platform.
+ *
+ */
+
+#if defined(XRT_OS_LINUX)
+
+static bool
+apply_sched(enum u_logging_level log_level, const struct rule *rule, const char *name)
+{
+	struct sched_param params = {0};
+	int policy = SCHED_OTHER;
+
+	switch (rule->sched) {
+	case CLASS_FIFO: policy = SCHED_FIFO; break;
+	case CLASS_RR: policy = SCHED_RR; break;
+	case CLASS_NORMAL: policy = SCHED_OTHER; break;
+	case CLASS_BATCH: policy = SCHED_BATCH; break;
+	case CLASS_IDLE: policy = SCHED_IDLE; break;
+	case CLASS_INHERIT:
+	default: return true;
+	}
+
+	if (policy == SCHED_FIFO || policy == SCHED_RR) {
+		int max = sched_get_priority_max(policy);
+		int min = sched_get_priority_min(policy);
+		int priority = rule->value == PRIORITY_MAX ? max : rule->value;
+		params.sched_priority = priority < min ? min : priority > max ? max : priority;
+	}
+
+	// On Linux zero means the calling thread.
+	if (sched_setscheduler(0, policy, &params) != 0) {
+		LOG_W("Thread '%s': Could not set '%s' scheduling: %s", name, class_to_str(rule->sched),
+		      strerror(errno));
+		return false;
+	}
+
+	// The nice value is per thread on Linux.
+	if ((policy == SCHED_OTHER || policy == SCHED_BATCH) &&
+	    setpriority(PRIO_PROCESS, (id_t)gettid(), rule->value) != 0) {
+		LOG_W("Thread '%s': Could not set nice %i: %s", name, rule->value, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+static bool
+apply_cpus(enum u_logging_level log_level, uint64_t cpus, const char *name)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (int i = 0; i < 64; i++) {
+		if ((cpus & (UINT64_C(1) << i)) != 0) {
+			CPU_SET(i, &set);
+		}
+	}
+
+	if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+		LOG_W("Thread '%s': Could not set CPU affinity 0x%" PRIx64 ": %s", name, cpus, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+#elif defined(XRT_OS_WINDOWS)
+
+static bool
+apply_sched(enum u_logging_level log_level, const struct rule *rule, const char *name)
+{
+	int priority = THREAD_PRIORITY_NORMAL;
+
+	switch (rule->sched) {
+	case CLASS_FIFO:
+	case CLASS_RR: priority = THREAD_PRIORITY_TIME_CRITICAL; break;
+	case CLASS_NORMAL:
+		priority = rule->value < 0   ? THREAD_PRIORITY_ABOVE_NORMAL
+		           : rule->value > 0 ? THREAD_PRIORITY_BELOW_NORMAL
+		                             : THREAD_PRIORITY_NORMAL;
+		break;
+	case CLASS_BATCH: priority = THREAD_PRIORITY_BELOW_NORMAL; break;
+	case CLASS_IDLE: priority = THREAD_PRIORITY_IDLE; break;
+	case CLASS_INHERIT:
+	default: return true;
+	}
+
+	if (!SetThreadPriority(GetCurrentThread(), priority)) {
+		LOG_W("Thread '%s': Could not set priority %i: %lu", name, priority, GetLastError());
+		return false;
+	}
+
+	return true;
+}
+
+static bool
+apply_cpus(enum u_logging_level log_level, uint64_t cpus, const char *name)
+{
+	if (SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)cpus) == 0) {
+		LOG_W("Thread '%s': Could not set CPU affinity 0x%" PRIx64 ": %lu", name, cpus, GetLastError());
+		return false;
+	}
+
+	return true;
+}
+
+#else
+
+static bool
+apply_sched(enum u_logging_level log_level, const struct rule *rule, const char *name)
+{
+	return rule->sched == CLASS_INHERIT;
+}
+
+static bool
+apply_cpus(enum u_logging_level log_level, uint64_t cpus, const char *name)
+{
+	return false;
+}
+
+#endif
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+void
+u_thread_policy_apply(enum u_logging_level log_level, enum os_thread_role role, const char *name)
+{
+	if (role < 0 || role >= OS_THREAD_ROLE_COUNT) {
+		return;
+	}
+
+	if (name == NULL) {
+		name = os_thread_role_str(role);
+	}
+
+	struct rule rule = default_rules[role];
+
+	const char *config = debug_get_option_thread_policy();
+	if (config != NULL) {
+		find_rule(log_level, config, role, &rule);
+	}
+
+	if (rule.sched == CLASS_INHERIT && rule.cpus == 0) {
+		return;
+	}
+
+	bool sched_ok = apply_sched(log_level, &rule, name);
+	bool cpus_ok = rule.cpus == 0 || apply_cpus(log_level, rule.cpus, name);
+
+	if (sched_ok && cpus_ok) {
+		LOG_I("Thread '%s': Applied '%s' policy, class '%s' (%i), cpus 0x%" PRIx64, name,
+		      os_thread_role_str(role), class_to_str(rule.sched), rule.value, rule.cpus);
+	}
+}
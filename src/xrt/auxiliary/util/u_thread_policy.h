@@ -0,0 +1,50 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Applies scheduling class and CPU affinity to threads by role.
+ * @ingroup aux_util
+ */
+
+#pragma once
+
+#include "xrt/xrt_compiler.h"
+#include "util/u_logging.h"
+#include "os/os_threading.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*!
+ * Apply the scheduling class and CPU affinity of @p role to the calling
+ * thread, meant to be called first thing in a thread's run function.
+ *
+ * By default compositor and IMU threads get realtime priority on Linux, all
+ * other roles and platforms are left alone. The `XRT_THREAD_POLICY` environment variable
+ * overrides this per role, with rules separated by `;`:
+ *
+ * @code
+ * XRT_THREAD_POLICY="compositor=fifo:90@4-7;imu=fifo@4-7;tracking=batch@0-3"
+ * @endcode
+ *
+ * Each rule is `<role>=<class>[:<value>][@<cpus>]`, where class is one of
+ * `fifo` and `rr` with a realtime priority (defaults to max), `normal` and
+ * `batch` with a nice value, `idle` or `inherit` to leave the class as is.
+ * The cpus are a list of cores and ranges like `0-3,6`, at most 64 cores.
+ *
+ * @param log_level Logging level to control chattiness.
+ * @param role      What the thread is used for.
+ * @param name      Thread name to be used in logging.
+ *
+ * @ingroup aux_util
+ */
+void
+u_thread_policy_apply(enum u_logging_level log_level, enum os_thread_role role, const char *name);
+
+
+#ifdef __cplusplus
+}
+#endif
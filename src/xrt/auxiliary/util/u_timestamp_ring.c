@@ -0,0 +1,100 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Lock-free ring associating frame counters with hardware timestamps.
+ * @ingroup aux_util
+ */
+
+#include "util/u_timestamp_ring.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+
+#define RING_MASK (U_TIMESTAMP_RING_SIZE - 1)
+
+static_assert((U_TIMESTAMP_RING_SIZE & RING_MASK) == 0, "U_TIMESTAMP_RING_SIZE must be a power of two");
+
+static inline int64_t
+get_at(struct u_timestamp_ring *tr, uint32_t counter)
+{
+	return tr->timestamps_ns[counter & RING_MASK];
+}
+
+static inline int64_t
+distance_to(struct u_timestamp_ring *tr, uint32_t counter, int64_t timestamp_ns)
+{
+	return llabs(get_at(tr, counter) - timestamp_ns);
+}
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+bool
+u_timestamp_ring_push(struct u_timestamp_ring *tr, int64_t timestamp_ns)
+{
+	uint32_t w = (uint32_t)tr->write_pos; // Only written by us.
+	uint32_t r = (uint32_t)xrt_atomic_s32_load_acquire(&tr->read_pos);
+
+	if (w - r >= U_TIMESTAMP_RING_SIZE) {
+		return false;
+	}
+
+	tr->timestamps_ns[w & RING_MASK] = timestamp_ns;
+
+	// Publishes the timestamp to the consumer.
+	xrt_atomic_s32_store_release(&tr->write_pos, (int32_t)(w + 1));
+
+	return true;
+}
+
+bool
+u_timestamp_ring_take_closest(struct u_timestamp_ring *tr,
+                              int64_t timestamp_ns,
+                              int64_t period_ns,
+                              int64_t *out_timestamp_ns,
+                              uint32_t *out_frame_counter)
+{
+	assert(period_ns > 0);
+
+	uint32_t r = (uint32_t)tr->read_pos; // Only written by us.
+	uint32_t w = (uint32_t)xrt_atomic_s32_load_acquire(&tr->write_pos);
+	uint32_t count = w - r;
+
+	if (count == 0) {
+		return false;
+	}
+
+	// Predict how many frames back from the newest one this frame is.
+	uint32_t newest = w - 1;
+	int64_t back = (get_at(tr, newest) - timestamp_ns + period_ns / 2) / period_ns;
+	if (back < 0) {
+		back = 0;
+	} else if (back > count - 1) {
+		back = count - 1;
+	}
+
+	// Frames can jitter around their nominal period, so check the neighbours too.
+	uint32_t best = newest - (uint32_t)back;
+	int64_t best_distance = distance_to(tr, best, timestamp_ns);
+	if (best != r && distance_to(tr, best - 1, timestamp_ns) < best_distance) {
+		best = best - 1;
+	} else if (best != newest && distance_to(tr, best + 1, timestamp_ns) < best_distance) {
+		best = best + 1;
+	}
+
+	*out_timestamp_ns = get_at(tr, best);
+	if (out_frame_counter != NULL) {
+		*out_frame_counter = best;
+	}
+
+	// Done reading the slot, gives it and all older ones back to the producer.
+	xrt_atomic_s32_store_release(&tr->read_pos, (int32_t)(best + 1));
+
+	return true;
+}
@@ -0,0 +1,89 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Lock-free ring associating frame counters with hardware timestamps.
+ * @ingroup aux_util
+ */
+
+#pragma once
+
+#include "xrt/xrt_compiler.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*!
+ * Number of timestamps that can be waiting in a @ref u_timestamp_ring, must be
+ * a power of two.
+ *
+ * @ingroup aux_util
+ */
+#define U_TIMESTAMP_RING_SIZE (64)
+
+/*!
+ * Single producer single consumer ring of hardware timestamps, one per frame.
+ *
+ * Meant for devices that report the hardware timestamp of a camera frame on a
+ * different channel than the image itself, like over HID while the image comes
+ * from V4L2. The producer pushes the timestamp for each frame as it arrives,
+ * the position of a timestamp in the ring is the frame counter. The consumer
+ * then takes the timestamp that best matches a frame, this is done by
+ * predicting the frame counter from the newest timestamp and the frame period,
+ * so the cost does not depend on how many timestamps are waiting.
+ *
+ * Zero initialized is a valid empty ring.
+ *
+ * @ingroup aux_util
+ */
+struct u_timestamp_ring
+{
+	//! Hardware timestamps, indexed by frame counter.
+	int64_t timestamps_ns[U_TIMESTAMP_RING_SIZE];
+
+	//! Frame counter of the next timestamp to be pushed, only written by the producer.
+	xrt_atomic_s32_t write_pos;
+
+	//! Frame counter of the oldest unused timestamp, only written by the consumer.
+	xrt_atomic_s32_t read_pos;
+};
+
+/*!
+ * Push the hardware timestamp of the next frame, returns false and drops it if
+ * the consumer has fallen a whole ring behind.
+ *
+ * @public @memberof u_timestamp_ring
+ */
+bool
+u_timestamp_ring_push(struct u_timestamp_ring *tr, int64_t timestamp_ns);
+
+/*!
+ * Find the waiting timestamp closest to @p timestamp_ns, given that the frames
+ * are @p period_ns apart, it and all older timestamps are removed from the ring.
+ * Returns false if there are no timestamps waiting.
+ *
+ * @param tr              The ring.
+ * @param timestamp_ns    Estimate of the frame timestamp in the hardware clock.
+ * @param period_ns       Nominal time between two frames.
+ * @param[out] out_timestamp_ns The matched hardware timestamp.
+ * @param[out] out_frame_counter The frame counter of the matched timestamp, can be NULL.
+ *
+ * @public @memberof u_timestamp_ring
+ */
+bool
+u_timestamp_ring_take_closest(struct u_timestamp_ring *tr,
+                              int64_t timestamp_ns,
+                              int64_t period_ns,
+                              int64_t *out_timestamp_ns,
+                              uint32_t *out_frame_counter);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -31,9 +31,11 @@ PERCETTO_TRACK_DEFINE(pc_margin, PERCETTO_TRACK_EVENTS);
 PERCETTO_TRACK_DEFINE(pc_error, PERCETTO_TRACK_EVENTS);
 PERCETTO_TRACK_DEFINE(pc_info, PERCETTO_TRACK_EVENTS);
 PERCETTO_TRACK_DEFINE(pc_present, PERCETTO_TRACK_EVENTS);
+PERCETTO_TRACK_DEFINE(pc_gpu_passes, PERCETTO_TRACK_EVENTS);
 PERCETTO_TRACK_DEFINE(pa_cpu, PERCETTO_TRACK_EVENTS);
 PERCETTO_TRACK_DEFINE(pa_draw, PERCETTO_TRACK_EVENTS);
 PERCETTO_TRACK_DEFINE(pa_wait, PERCETTO_TRACK_EVENTS);
+PERCETTO_TRACK_DEFINE(pa_m2p, PERCETTO_TRACK_EVENTS);
 
 static enum u_trace_which static_which;
 static bool static_inited = false;
@@ -51,10 +53,12 @@ u_trace_marker_setup(enum u_trace_which which)
 	I_PERCETTO_TRACK_PTR(pc_error)->name = "PC 5 Error";
 	I_PERCETTO_TRACK_PTR(pc_info)->name = "PC 6 Info";
 	I_PERCETTO_TRACK_PTR(pc_present)->name = "PC 7 Present";
+	I_PERCETTO_TRACK_PTR(pc_gpu_passes)->name = "PC 8 GPU passes";
 
 	I_PERCETTO_TRACK_PTR(pa_cpu)->name = "PA 1 App";
 	I_PERCETTO_TRACK_PTR(pa_draw)->name = "PA 2 Draw";
 	I_PERCETTO_TRACK_PTR(pa_wait)->name = "PA 3 Wait";
+	I_PERCETTO_TRACK_PTR(pa_m2p)->name = "PA 4 Motion to photon";
 }
 
 void
@@ -82,10 +86,12 @@ u_trace_marker_init(void)
 		PERCETTO_REGISTER_TRACK(pc_error);
 		PERCETTO_REGISTER_TRACK(pc_info);
 		PERCETTO_REGISTER_TRACK(pc_present);
+		PERCETTO_REGISTER_TRACK(pc_gpu_passes);
 
 		PERCETTO_REGISTER_TRACK(pa_cpu);
 		PERCETTO_REGISTER_TRACK(pa_draw);
 		PERCETTO_REGISTER_TRACK(pa_wait);
+		PERCETTO_REGISTER_TRACK(pa_m2p);
 	}
 }
 
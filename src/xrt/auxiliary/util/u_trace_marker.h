@@ -225,6 +225,16 @@ u_trace_marker_init(void);
 		(void)STRING;                                                                                          \
 	} while (false)
 
+/*!
+ * Marks the end of a displayed frame, called once per frame by the main loop
+ * of the compositor. Only Tracy has a concept of frames.
+ *
+ * @ingroup aux_util
+ */
+#define U_TRACE_FRAME_MARK()                                                                                           \
+	do {                                                                                                           \
+	} while (false)
+
 /*!
  * Add to target c file to enable tracing, see @ref tracing.
  *
@@ -342,6 +352,8 @@ u_trace_scope_cleanup(TracyCZoneCtx *ctx_ptr)
 		TracyCZoneEnd(created);                                                                                \
 	} while (false)
 
+#define U_TRACE_FRAME_MARK() TracyCFrameMark
+
 #define U_TRACE_TARGET_SETUP(WHICH)
 
 
@@ -379,9 +391,11 @@ PERCETTO_TRACK_DECLARE(pc_margin);
 PERCETTO_TRACK_DECLARE(pc_error);
 PERCETTO_TRACK_DECLARE(pc_info);
 PERCETTO_TRACK_DECLARE(pc_present);
+PERCETTO_TRACK_DECLARE(pc_gpu_passes);
 PERCETTO_TRACK_DECLARE(pa_cpu);
 PERCETTO_TRACK_DECLARE(pa_draw);
 PERCETTO_TRACK_DECLARE(pa_wait);
+PERCETTO_TRACK_DECLARE(pa_m2p);
 
 #define U_TRACE_FUNC(CATEGORY) TRACE_EVENT(CATEGORY, __func__)
 #define U_TRACE_IDENT(CATEGORY, IDENT) TRACE_EVENT(CATEGORY, #IDENT)
@@ -402,6 +416,10 @@ PERCETTO_TRACK_DECLARE(pa_wait);
 		(void)STRING;                                                                                          \
 	} while (false)
 
+#define U_TRACE_FRAME_MARK()                                                                                           \
+	do {                                                                                                           \
+	} while (false)
+
 #define U_TRACE_TARGET_SETUP(WHICH)                                                                                    \
 	void __attribute__((constructor(101))) u_trace_marker_constructor(void);                                       \
                                                                                                                        \
@@ -1,4 +1,4 @@
-// Copyright 2019-2022, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -57,7 +57,9 @@ u_tracked_imu_3dof_create(struct xrt_frame_context *xfctx, struct u_tracked_imu_
 {
 	struct u_tracked_imu_3dof *dof3 = U_TYPED_CALLOC(struct u_tracked_imu_3dof);
 
-	m_relation_history_create(&dof3->rh);
+	// Only ever has orientation.
+	m_relation_history_create_with_layout(&dof3->rh, M_RELATION_HISTORY_MODE_MUTEX,
+	                                      M_RELATION_HISTORY_LAYOUT_ORIENTATION);
 
 	m_imu_3dof_init(&dof3->fusion, M_IMU_3DOF_USE_GRAVITY_DUR_300MS);
 	m_imu_3dof_add_vars(&dof3->fusion, debug_var_root, "");
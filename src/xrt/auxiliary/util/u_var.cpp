@@ -1,4 +1,4 @@
-// Copyright 2019-2022, Collabora, Ltd.
+// Copyright 2019-2024, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -10,6 +10,7 @@
 #include "util/u_var.h"
 #include "util/u_debug.h"
 
+#include <atomic>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -17,6 +18,29 @@
 #include <mutex>
 
 
+/*!
+ * Snapshot of numeric variables, the pointers and kinds are kept in their
+ * own arrays so that sampling walks tightly packed memory.
+ */
+struct u_var_snapshot
+{
+	//! Root and variable names, only used for @ref u_var_snapshot_get_info.
+	std::vector<std::string> root_names = {};
+	std::vector<std::string> names = {};
+
+	std::vector<void *> ptrs = {};
+	std::vector<u_var_kind> kinds = {};
+	std::vector<u_var_snapshot_value> values = {};
+
+	//! Tracker generation when the snapshot was created.
+	uint64_t generation = 0;
+
+	int64_t period_ns = 0;
+	int64_t last_ns = 0;
+	bool sampled = false;
+};
+
+
 namespace xrt::auxiliary::util {
 
 
@@ -56,6 +80,13 @@ public:
 	std::unordered_map<std::string, uint32_t> counters = {};
 	std::unordered_map<ptrdiff_t, Obj> map = {};
 	std::mutex mutex = {};
+
+	/*!
+	 * Incremented under the mutex on every root or variable change, read
+	 * without the lock by snapshots to detect that they are stale.
+	 */
+	std::atomic<uint64_t> generation = {0};
+
 	bool on = false;
 	bool tested = false;
 
@@ -95,9 +126,77 @@ get_on()
 	return gTracker.on;
 }
 
+static void
+bump_generation()
+{
+	gTracker.generation.fetch_add(1, std::memory_order_release);
+}
+
+static bool
+is_numeric(u_var_kind kind)
+{
+	switch (kind) {
+	case U_VAR_KIND_BOOL:
+	case U_VAR_KIND_U8:
+	case U_VAR_KIND_U16:
+	case U_VAR_KIND_U64:
+	case U_VAR_KIND_I32:
+	case U_VAR_KIND_I64:
+	case U_VAR_KIND_F32:
+	case U_VAR_KIND_F64:
+	case U_VAR_KIND_DRAGGABLE_F32:
+	case U_VAR_KIND_DRAGGABLE_U16:
+	case U_VAR_KIND_LOG_LEVEL:
+	case U_VAR_KIND_COMBO:
+	case U_VAR_KIND_RO_I16:
+	case U_VAR_KIND_RO_I32:
+	case U_VAR_KIND_RO_U32:
+	case U_VAR_KIND_RO_F32:
+	case U_VAR_KIND_RO_I64:
+	case U_VAR_KIND_RO_U64:
+	case U_VAR_KIND_RO_F64:
+	case U_VAR_KIND_RO_I64_NS: return true;
+	default: return false;
+	}
+}
+
+static u_var_snapshot_value
+read_value(void *ptr, u_var_kind kind)
+{
+	u_var_snapshot_value v = {};
+
+	switch (kind) {
+	case U_VAR_KIND_BOOL: v.u = *(bool *)ptr ? 1 : 0; break;
+	case U_VAR_KIND_U8: v.u = *(uint8_t *)ptr; break;
+	case U_VAR_KIND_U16: v.u = *(uint16_t *)ptr; break;
+	case U_VAR_KIND_RO_U32: v.u = *(uint32_t *)ptr; break;
+	case U_VAR_KIND_U64:
+	case U_VAR_KIND_RO_U64: v.u = *(uint64_t *)ptr; break;
+	case U_VAR_KIND_RO_I16: v.i = *(int16_t *)ptr; break;
+	case U_VAR_KIND_I32:
+	case U_VAR_KIND_RO_I32: v.i = *(int32_t *)ptr; break;
+	case U_VAR_KIND_I64:
+	case U_VAR_KIND_RO_I64:
+	case U_VAR_KIND_RO_I64_NS: v.i = *(int64_t *)ptr; break;
+	case U_VAR_KIND_F32:
+	case U_VAR_KIND_RO_F32: v.f = *(float *)ptr; break;
+	case U_VAR_KIND_F64:
+	case U_VAR_KIND_RO_F64: v.f = *(double *)ptr; break;
+	case U_VAR_KIND_DRAGGABLE_F32: v.f = ((struct u_var_draggable_f32 *)ptr)->val; break;
+	case U_VAR_KIND_DRAGGABLE_U16: v.u = *((struct u_var_draggable_u16 *)ptr)->val; break;
+	case U_VAR_KIND_LOG_LEVEL: v.i = *(enum u_logging_level *)ptr; break;
+	case U_VAR_KIND_COMBO: v.i = *((struct u_var_combo *)ptr)->value; break;
+	default: break;
+	}
+
+	return v;
+}
+
 static void
 add_var(void *root, void *ptr, u_var_kind kind, const char *c_name)
 {
+	std::unique_lock<std::mutex> lock(gTracker.mutex);
+
 	auto s = gTracker.map.find((ptrdiff_t)root);
 	if (s == gTracker.map.end()) {
 		return;
@@ -109,6 +208,8 @@ add_var(void *root, void *ptr, u_var_kind kind, const char *c_name)
 	var.info.ptr = ptr;
 
 	s->second.vars.push_back(var);
+
+	bump_generation();
 }
 
 
@@ -152,6 +253,8 @@ u_var_add_root(void *root, const char *c_name, bool suffix_with_number)
 	obj.info.name = obj.name.c_str();
 	obj.info.raw_name = obj.raw_name.c_str();
 	obj.info.number = count;
+
+	bump_generation();
 }
 
 extern "C" void
@@ -169,6 +272,8 @@ u_var_remove_root(void *root)
 	}
 
 	gTracker.map.erase(s);
+
+	bump_generation();
 }
 
 extern "C" void
@@ -198,6 +303,126 @@ u_var_visit(u_var_root_cb enter_cb, u_var_root_cb exit_cb, u_var_elm_cb elem_cb,
 	}
 }
 
+extern "C" uint64_t
+u_var_get_generation(void)
+{
+	return gTracker.generation.load(std::memory_order_acquire);
+}
+
+extern "C" int
+u_var_snapshot_create(int64_t period_ns, struct u_var_snapshot **out_snapshot)
+{
+	if (!get_on()) {
+		return -1;
+	}
+
+	auto snapshot = new u_var_snapshot();
+	snapshot->period_ns = period_ns;
+
+	std::unique_lock<std::mutex> lock(gTracker.mutex);
+
+	snapshot->generation = gTracker.generation.load(std::memory_order_relaxed);
+
+	for (auto &n : gTracker.map) {
+		Obj &obj = n.second;
+		for (auto &var : obj.vars) {
+			if (!is_numeric(var.info.kind)) {
+				continue;
+			}
+			snapshot->root_names.push_back(obj.name);
+			snapshot->names.push_back(var.info.name);
+			snapshot->ptrs.push_back(var.info.ptr);
+			snapshot->kinds.push_back(var.info.kind);
+		}
+	}
+
+	lock.unlock();
+
+	snapshot->values.resize(snapshot->ptrs.size());
+
+	*out_snapshot = snapshot;
+
+	return 0;
+}
+
+extern "C" uint32_t
+u_var_snapshot_get_count(const struct u_var_snapshot *snapshot)
+{
+	return (uint32_t)snapshot->values.size();
+}
+
+extern "C" bool
+u_var_snapshot_get_info(const struct u_var_snapshot *snapshot,
+                        uint32_t index,
+                        const char **out_root_name,
+                        const char **out_name,
+                        enum u_var_kind *out_kind)
+{
+	if (index >= snapshot->values.size()) {
+		return false;
+	}
+
+	*out_root_name = snapshot->root_names[index].c_str();
+	*out_name = snapshot->names[index].c_str();
+	*out_kind = snapshot->kinds[index];
+
+	return true;
+}
+
+extern "C" enum u_var_snapshot_result
+u_var_snapshot_sample(struct u_var_snapshot *snapshot, int64_t now_ns)
+{
+	if (snapshot->sampled && now_ns - snapshot->last_ns < snapshot->period_ns) {
+		return U_VAR_SNAPSHOT_NOT_DUE;
+	}
+
+	// Cheap check first, so a stale snapshot never touches the lock.
+	if (u_var_get_generation() != snapshot->generation) {
+		return U_VAR_SNAPSHOT_STALE;
+	}
+
+	std::unique_lock<std::mutex> lock(gTracker.mutex);
+
+	// Roots are removed under the lock, so after this check all pointers are valid until we unlock.
+	if (gTracker.generation.load(std::memory_order_relaxed) != snapshot->generation) {
+		return U_VAR_SNAPSHOT_STALE;
+	}
+
+	size_t count = snapshot->values.size();
+	for (size_t i = 0; i < count; i++) {
+		snapshot->values[i] = read_value(snapshot->ptrs[i], snapshot->kinds[i]);
+	}
+
+	lock.unlock();
+
+	snapshot->last_ns = now_ns;
+	snapshot->sampled = true;
+
+	return U_VAR_SNAPSHOT_SAMPLED;
+}
+
+extern "C" const union u_var_snapshot_value *
+u_var_snapshot_get_values(const struct u_var_snapshot *snapshot, int64_t *out_timestamp_ns)
+{
+	if (out_timestamp_ns != NULL) {
+		*out_timestamp_ns = snapshot->last_ns;
+	}
+
+	return snapshot->values.data();
+}
+
+extern "C" void
+u_var_snapshot_destroy(struct u_var_snapshot **snapshot_ptr)
+{
+	struct u_var_snapshot *snapshot = *snapshot_ptr;
+	if (snapshot == NULL) {
+		return;
+	}
+
+	delete snapshot;
+	*snapshot_ptr = NULL;
+}
+
 #define ADD_FUNC(SUFFIX, TYPE, ENUM)                                                                                   \
 	extern "C" void u_var_add_##SUFFIX(void *obj, TYPE *ptr, const char *c_name)                                   \
 	{                                                                                                              \
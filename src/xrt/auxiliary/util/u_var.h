@@ -368,6 +368,125 @@ u_var_visit(u_var_root_cb enter_cb, u_var_root_cb exit_cb, u_var_elm_cb elem_cb,
 void
 u_var_force_on(void);
 
+
+/*
+ *
+ * Snapshot API.
+ *
+ */
+
+/*!
+ * Opaque snapshot of all numeric variables, see @ref u_var_snapshot_create.
+ *
+ * @ingroup aux_util
+ */
+struct u_var_snapshot;
+
+/*!
+ * One sampled value, which member is valid depends on the kind of the
+ * variable, see @ref u_var_snapshot_get_info.
+ *
+ * @ingroup aux_util
+ */
+union u_var_snapshot_value {
+	int64_t i;
+	uint64_t u;
+	double f;
+};
+
+/*!
+ * Result of @ref u_var_snapshot_sample.
+ *
+ * @ingroup aux_util
+ */
+enum u_var_snapshot_result
+{
+	//! The values have been updated.
+	U_VAR_SNAPSHOT_SAMPLED,
+	//! Less than the sample period has passed since the last sample, nothing done.
+	U_VAR_SNAPSHOT_NOT_DUE,
+	//! Roots or variables have been added or removed, the snapshot must be recreated.
+	U_VAR_SNAPSHOT_STALE,
+};
+
+/*!
+ * Returns a counter that is incremented every time a root or variable is
+ * added or removed, does not take any lock.
+ *
+ * @ingroup aux_util
+ */
+uint64_t
+u_var_get_generation(void);
+
+/*!
+ * Create a snapshot of all variables with a numeric kind, the names and
+ * pointers are collected once so that sampling only has to copy the values
+ * into a compact buffer. Non numeric kinds (text, images, buttons, poses and
+ * so on) are not included.
+ *
+ * @param period_ns    Minimum time between two samples, zero to sample on every call.
+ * @param out_snapshot Returned snapshot, destroy with @ref u_var_snapshot_destroy.
+ *
+ * @return 0 on success, -1 if variable tracking is off.
+ *
+ * @ingroup aux_util
+ */
+int
+u_var_snapshot_create(int64_t period_ns, struct u_var_snapshot **out_snapshot);
+
+/*!
+ * Number of values in the snapshot.
+ *
+ * @ingroup aux_util
+ */
+uint32_t
+u_var_snapshot_get_count(const struct u_var_snapshot *snapshot);
+
+/*!
+ * Get the root name, variable name and kind of value at @p index, the strings
+ * are owned by the snapshot.
+ *
+ * @return false if @p index is out of range.
+ *
+ * @ingroup aux_util
+ */
+bool
+u_var_snapshot_get_info(const struct u_var_snapshot *snapshot,
+                        uint32_t index,
+                        const char **out_root_name,
+                        const char **out_name,
+                        enum u_var_kind *out_kind);
+
+/*!
+ * Copy the current value of all variables into the snapshot buffer, unless
+ * less than the period has passed since the last sample. Does not call any
+ * callbacks and holds the tracker lock only for the copy, so it is cheap
+ * enough to call at a high rate from a streaming thread.
+ *
+ * @ingroup aux_util
+ */
+enum u_var_snapshot_result
+u_var_snapshot_sample(struct u_var_snapshot *snapshot, int64_t now_ns);
+
+/*!
+ * The buffer of sampled values, @ref u_var_snapshot_get_count entries long,
+ * valid until the snapshot is destroyed.
+ *
+ * @param out_timestamp_ns Optional, time of the last sample.
+ *
+ * @ingroup aux_util
+ */
+const union u_var_snapshot_value *
+u_var_snapshot_get_values(const struct u_var_snapshot *snapshot, int64_t *out_timestamp_ns);
+
+/*!
+ * Destroy a snapshot, sets the pointer to NULL.
+ *
+ * @ingroup aux_util
+ */
+void
+u_var_snapshot_destroy(struct u_var_snapshot **snapshot_ptr);
+
 #define U_VAR_ADD_FUNCS()                                                                                              \
 	ADD_FUNC(bool, bool, BOOL)                                                                                     \
 	ADD_FUNC(rgb_u8, struct xrt_colour_rgb_u8, RGB_U8)                                                             \
@@ -15,7 +15,8 @@
 #if defined(XRT_DOXYGEN)
 
 /*!
- * OS specific tweak to wait time.
+ * OS specific tweak to wait time, for waits that can't spin at the end like
+ * @ref u_wait_until does.
  *
  * @todo Measure on Windows.
  * @ingroup aux_util
@@ -32,7 +33,8 @@
 
 
 /*!
- * Waits until the given time using the @ref os_precise_sleeper.
+ * Waits until the given time using the @ref os_precise_sleeper, it sleeps for
+ * most of the time and spins for the learned wake up slop at the end.
  *
  * @ingroup aux_util
  */
@@ -41,15 +43,10 @@ u_wait_until(struct os_precise_sleeper *sleeper, uint64_t until_ns)
 {
 	uint64_t now_ns = os_monotonic_get_ns();
 
-	// Lets hope its not to late.
-	bool fuzzy_in_the_past = time_is_less_then_or_within_range(until_ns, now_ns, U_TIME_1MS_IN_NS);
-
-	// When we should wake up is in the past:ish.
-	if (fuzzy_in_the_past) {
+	// When we should wake up is in the past.
+	if (until_ns <= now_ns) {
 		return;
 	}
 
-	// Sufficiently in the future.
-	uint32_t delay = (uint32_t)(until_ns - now_ns - U_WAIT_MEASURED_SCHEDULER_LATENCY_NS);
-	os_precise_sleeper_nanosleep(sleeper, delay);
+	os_precise_sleeper_sleep_until(sleeper, (int64_t)until_ns);
 }
@@ -281,6 +281,29 @@ u_win_raise_cpu_priority(enum u_logging_level log_level)
 	return try_to_raise_priority(log_level, hProcess);
 }
 
+bool
+u_win_try_to_set_thread_priority(enum u_logging_level log_level, DWORD thread_id, int priority)
+{
+	char buf[512];
+
+	HANDLE hThread = OpenThread(THREAD_SET_LIMITED_INFORMATION, FALSE, thread_id);
+	if (hThread == NULL) {
+		LOG_W("OpenThread(%lu): %s", thread_id, GET_LAST_ERROR_STR(buf));
+		return false;
+	}
+
+	BOOL bRet = SetThreadPriority(hThread, priority);
+	if (bRet == FALSE) {
+		LOG_W("SetThreadPriority(%lu, %i): %s", thread_id, priority, GET_LAST_ERROR_STR(buf));
+	} else {
+		LOG_I("Set priority of thread %lu to %i", thread_id, priority);
+	}
+
+	CloseHandle(hThread);
+
+	return bRet == TRUE;
+}
+
 void
 u_win_try_privilege_or_priority_from_args(enum u_logging_level log_level, int argc, char *argv[])
 {
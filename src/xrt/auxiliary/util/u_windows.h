@@ -52,6 +52,17 @@ u_win_grant_inc_base_priorty_base_privileges(enum u_logging_level log_level);
 bool
 u_win_raise_cpu_priority(enum u_logging_level log_level);
 
+/*!
+ * Tries to set the priority of any thread, including threads of other
+ * processes, see `SetThreadPriority` for @p priority values.
+ *
+ * @param log_level Control the amount of logging this function does.
+ * @param thread_id Thread id, as returned by `GetCurrentThreadId`.
+ * @param priority  Priority to set, relative to the priority class.
+ */
+bool
+u_win_try_to_set_thread_priority(enum u_logging_level log_level, DWORD thread_id, int priority);
+
 /*!
  * Small helper function that checks process arguments for which to try.
  *
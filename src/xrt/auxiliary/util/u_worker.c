@@ -13,10 +13,13 @@
 #include "util/u_logging.h"
 #include "util/u_worker.h"
 #include "util/u_trace_marker.h"
+#include "util/u_thread_policy.h"
 
 
+//! Number of tasks each deque of each worker can hold, per priority.
 #define MAX_TASK_COUNT (64)
 #define MAX_THREAD_COUNT (16)
+#define PRIORITY_COUNT (U_WORKER_PRIORITY_HIGH + 1)
 
 struct group;
 struct pool;
@@ -33,6 +36,25 @@ struct task
 	void *data;
 };
 
+/*!
+ * Bounded double ended queue of tasks, the owning worker pops from the front
+ * while other workers steal from the back. Has its own small lock so workers
+ * only contend when pushing to or stealing from the same deque.
+ */
+struct deque
+{
+	struct os_mutex mutex;
+
+	//! Ring buffer of tasks.
+	struct task tasks[MAX_TASK_COUNT];
+
+	//! Index of the front task.
+	uint32_t head;
+
+	//! Number of tasks in the ring buffer.
+	uint32_t count;
+};
+
 struct thread
 {
 	//! Pool this thread belongs to.
@@ -41,6 +63,9 @@ struct thread
 	// Native thread.
 	struct os_thread thread;
 
+	//! Tasks given to this thread, indexed by priority.
+	struct deque deques[PRIORITY_COUNT];
+
 	//! Thread name.
 	char name[64];
 };
@@ -49,18 +74,19 @@ struct pool
 {
 	struct u_worker_thread_pool base;
 
-	//! Big contenious mutex.
+	//! Protects the worker limit and sleeping and waking of threads.
 	struct os_mutex mutex;
 
-	//! Array of tasks.
-	struct task tasks[MAX_TASK_COUNT];
+	//! Number of tasks in all deques, may briefly be off by the tasks being pushed.
+	xrt_atomic_s32_t queued_count;
 
-	//! Number of tasks in array.
-	size_t tasks_in_array_count;
+	//! Used to spread pushed tasks over the workers' deques.
+	xrt_atomic_s32_t next_deque;
 
 	struct
 	{
-		size_t count;
+		//! Also read without the lock when pushing.
+		xrt_atomic_s32_t count;
 		struct os_cond cond;
 	} available; //!< For worker threads.
 
@@ -68,10 +94,10 @@ struct pool
 	uint32_t initial_worker_limit;
 
 	//! Currently the number of works that can work, waiting increases this.
-	uint32_t worker_limit;
+	xrt_atomic_s32_t worker_limit;
 
-	//! Number of threads working on tasks.
-	size_t working_count;
+	//! Number of threads working on tasks, only changed with the mutex held.
+	xrt_atomic_s32_t working_count;
 
 	//! Number of created threads.
 	size_t thread_count;
@@ -94,8 +120,11 @@ struct group
 	//! Pointer to poll of threads.
 	struct u_worker_thread_pool *uwtp;
 
-	//! Number of tasks that is pending or being worked on in this group.
-	size_t current_submitted_tasks_count;
+	/*!
+	 * Number of tasks that is pending or being worked on in this group,
+	 * only ever reaches zero with the pool mutex held.
+	 */
+	xrt_atomic_s32_t current_submitted_tasks_count;
 
 	//! Number of threads that have been released or newly entered wait.
 	size_t released_count;
@@ -127,55 +156,118 @@ pool(struct u_worker_thread_pool *uwtp)
 }
 
 
+/*
+ *
+ * Deque functions.
+ *
+ */
+
+static bool
+deque_push_back(struct deque *d, const struct task *task)
+{
+	bool ret = false;
+
+	os_mutex_lock(&d->mutex);
+	if (d->count < MAX_TASK_COUNT) {
+		d->tasks[(d->head + d->count) % MAX_TASK_COUNT] = *task;
+		d->count++;
+		ret = true;
+	}
+	os_mutex_unlock(&d->mutex);
+
+	return ret;
+}
+
+static bool
+deque_pop_front(struct deque *d, struct task *out_task)
+{
+	bool ret = false;
+
+	os_mutex_lock(&d->mutex);
+	if (d->count > 0) {
+		*out_task = d->tasks[d->head];
+		d->head = (d->head + 1) % MAX_TASK_COUNT;
+		d->count--;
+		ret = true;
+	}
+	os_mutex_unlock(&d->mutex);
+
+	return ret;
+}
+
+static bool
+deque_steal_back(struct deque *d, struct task *out_task)
+{
+	bool ret = false;
+
+	os_mutex_lock(&d->mutex);
+	if (d->count > 0) {
+		d->count--;
+		*out_task = d->tasks[(d->head + d->count) % MAX_TASK_COUNT];
+		ret = true;
+	}
+	os_mutex_unlock(&d->mutex);
+
+	return ret;
+}
+
+
 /*
  *
  * Internal pool functions.
  *
  */
 
-static void
-locked_pool_pop_task(struct pool *p, struct task *out_task)
+static bool
+pool_push_task(struct pool *p, const struct task *task, enum u_worker_priority priority)
 {
-	assert(p->tasks_in_array_count > 0);
+	uint32_t start = (uint32_t)xrt_atomic_s32_inc_return(&p->next_deque);
 
-	for (size_t i = 0; i < MAX_TASK_COUNT; i++) {
-		if (p->tasks[i].func == NULL) {
-			continue;
-		}
+	for (size_t i = 0; i < p->thread_count; i++) {
+		struct thread *t = &p->threads[(start + i) % p->thread_count];
 
-		*out_task = p->tasks[i];
-		p->tasks[i] = (struct task){NULL, NULL, NULL};
-		p->tasks_in_array_count--;
-		return;
+		if (deque_push_back(&t->deques[priority], task)) {
+			// Full barrier, pairs with locked_thread_wait_for_work.
+			xrt_atomic_s32_inc_return(&p->queued_count);
+			return true;
+		}
 	}
 
-	assert(false);
+	return false;
 }
 
-static void
-locked_pool_push_task(struct pool *p, struct group *g, u_worker_group_func_t func, void *data)
+static bool
+thread_get_task(struct thread *t, struct task *out_task)
 {
-	assert(p->tasks_in_array_count < MAX_TASK_COUNT);
+	struct pool *p = t->p;
+	size_t index = t - p->threads;
 
-	for (size_t i = 0; i < MAX_TASK_COUNT; i++) {
-		if (p->tasks[i].func != NULL) {
-			continue;
+	for (int priority = PRIORITY_COUNT - 1; priority >= 0; priority--) {
+		// Own tasks first, in the order they were pushed.
+		if (deque_pop_front(&t->deques[priority], out_task)) {
+			xrt_atomic_s32_dec_return(&p->queued_count);
+			return true;
 		}
 
-		p->tasks[i] = (struct task){g, func, data};
-		p->tasks_in_array_count++;
-		g->current_submitted_tasks_count++;
-		return;
+		// Then steal from the other workers, starting with our neighbour.
+		for (size_t i = 1; i < p->thread_count; i++) {
+			struct thread *other = &p->threads[(index + i) % p->thread_count];
+
+			if (deque_steal_back(&other->deques[priority], out_task)) {
+				xrt_atomic_s32_dec_return(&p->queued_count);
+				return true;
+			}
+		}
 	}
 
-	assert(false);
+	return false;
 }
 
 static void
 locked_pool_wake_worker_if_allowed(struct pool *p)
 {
-	// No tasks in array, don't wake any thread.
-	if (p->tasks_in_array_count == 0) {
+	// No tasks in deques, don't wake any thread.
+	if (xrt_atomic_s32_load_acquire(&p->queued_count) <= 0) {
 		return;
 	}
 
@@ -203,7 +295,7 @@ locked_pool_wake_worker_if_allowed(struct pool *p)
 static bool
 locked_group_should_enter_wait_loop(struct pool *p, struct group *g)
 {
-	if (g->current_submitted_tasks_count == 0) {
+	if (xrt_atomic_s32_load_acquire(&g->current_submitted_tasks_count) == 0) {
 		return false;
 	}
 
@@ -237,12 +329,12 @@ locked_group_should_wait(struct pool *p, struct group *g)
 	 */
 
 	// Tasks available.
-	if (g->current_submitted_tasks_count > 0) {
+	if (xrt_atomic_s32_load_acquire(&g->current_submitted_tasks_count) > 0) {
 
 		// We have been released or newly entered the loop.
 		if (g->released_count > 0) {
 			g->released_count--;
-			p->worker_limit++;
+			xrt_atomic_s32_inc_return(&p->worker_limit);
 
 			// Wake a worker with the new worker limit.
 			locked_pool_wake_worker_if_allowed(p);
@@ -265,7 +357,7 @@ static void
 locked_group_wake_waiter_if_allowed(struct pool *p, struct group *g)
 {
 	// Are there still outstanding tasks?
-	if (g->current_submitted_tasks_count > 0) {
+	if (xrt_atomic_s32_load_acquire(&g->current_submitted_tasks_count) > 0) {
 		return;
 	}
 
@@ -277,10 +369,10 @@ locked_group_wake_waiter_if_allowed(struct pool *p, struct group *g)
 	// Wake one waiting thread.
 	os_cond_signal(&g->waiting.cond);
 
-	assert(p->worker_limit > p->initial_worker_limit);
+	assert(p->worker_limit > (int32_t)p->initial_worker_limit);
 
 	// Remove one waiting threads.
-	p->worker_limit--;
+	xrt_atomic_s32_dec_return(&p->worker_limit);
 
 	// We have released one thread.
 	g->released_count++;
@@ -299,6 +391,33 @@ locked_group_wait(struct pool *p, struct group *g)
 	g->waiting.count--;
 }
 
+/*!
+ * Called when a task of the group is done, or was never pushed. The count is
+ * only allowed to reach zero with the pool mutex held, as a waiter seeing zero
+ * may destroy the group as soon as it is unlocked.
+ */
+static void
+group_task_done(struct pool *p, struct group *g)
+{
+	int32_t count = xrt_atomic_s32_load_acquire(&g->current_submitted_tasks_count);
+	while (count > 1) {
+		int32_t old = xrt_atomic_s32_cmpxchg(&g->current_submitted_tasks_count, count, count - 1);
+		if (old == count) {
+			return;
+		}
+		count = old;
+	}
+
+	os_mutex_lock(&p->mutex);
+
+	xrt_atomic_s32_dec_return(&g->current_submitted_tasks_count);
+
+	// Wake up any waiter.
+	locked_group_wake_waiter_if_allowed(p, g);
+
+	os_mutex_unlock(&p->mutex);
+}
+
 
 /*
  *
@@ -310,7 +429,7 @@ static bool
 locked_thread_allowed_to_work(struct pool *p)
 {
 	// No work for you!
-	if (p->tasks_in_array_count == 0) {
+	if (xrt_atomic_s32_load_acquire(&p->queued_count) <= 0) {
 		return false;
 	}
 
@@ -325,14 +444,17 @@ locked_thread_allowed_to_work(struct pool *p)
 static void
 locked_thread_wait_for_work(struct pool *p)
 {
-	// Update tracking.
-	p->available.count++;
+	// Update tracking, full barrier pairs with pool_push_task.
+	xrt_atomic_s32_inc_return(&p->available.count);
 
-	// The wait, also unlocks the mutex.
-	os_cond_wait(&p->available.cond, &p->mutex);
+	// A push that didn't see us as available must be visible now.
+	if (!locked_thread_allowed_to_work(p)) {
+		// The wait, also unlocks the mutex.
+		os_cond_wait(&p->available.cond, &p->mutex);
+	}
 
 	// Update tracking.
-	p->available.count--;
+	xrt_atomic_s32_dec_return(&p->available.count);
 }
 
 static void *
@@ -344,6 +466,9 @@ run_func(void *ptr)
 	snprintf(t->name, sizeof(t->name), "%s: Worker", p->prefix);
 	U_TRACE_SET_THREAD_NAME(t->name);
 
+	// The pools are used by trackers, keeps them off the compositor's cores.
+	u_thread_policy_apply(U_LOGGING_INFO, OS_THREAD_ROLE_TRACKING, t->name);
+
 	os_mutex_lock(&p->mutex);
 
 	while (p->running) {
@@ -355,29 +480,36 @@ run_func(void *ptr)
 			continue;
 		}
 
-		// Pop a task from the pool.
-		struct task task = {NULL, NULL, NULL};
-		locked_pool_pop_task(p, &task);
-
 		// We are now counting as working, needed for wake below.
-		p->working_count++;
+		xrt_atomic_s32_inc_return(&p->working_count);
 
 		// Signal another thread if conditions are met.
 		locked_pool_wake_worker_if_allowed(p);
 
-		// Do the actual work here.
 		os_mutex_unlock(&p->mutex);
-		task.func(task.data);
-		os_mutex_lock(&p->mutex);
 
-		// No longer working.
-		p->working_count--;
+		/*
+		 * Keep working without the pool mutex for as long as there are
+		 * tasks, stop if a waiter was released and lowered the limit.
+		 */
+		struct task task = {NULL, NULL, NULL};
+		while (thread_get_task(t, &task)) {
+			// Do the actual work here.
+			task.func(task.data);
+
+			// Only now decrement the task count on the owning group.
+			group_task_done(p, task.g);
 
-		// Only now decrement the task count on the owning group.
-		task.g->current_submitted_tasks_count--;
+			if (xrt_atomic_s32_load_acquire(&p->working_count) >
+			    xrt_atomic_s32_load_acquire(&p->worker_limit)) {
+				break;
+			}
+		}
+
+		os_mutex_lock(&p->mutex);
 
-		// Wake up any waiter.
-		locked_group_wake_waiter_if_allowed(p, task.g);
+		// No longer working.
+		xrt_atomic_s32_dec_return(&p->working_count);
 	}
 
 	// Make sure all threads are woken up.
@@ -429,6 +561,15 @@ u_worker_thread_pool_create(uint32_t starting_worker_count, uint32_t thread_coun
 		goto err_mutex;
 	}
 
+	size_t deque_count = 0;
+	for (; deque_count < thread_count * PRIORITY_COUNT; deque_count++) {
+		struct thread *t = &p->threads[deque_count / PRIORITY_COUNT];
+		ret = os_mutex_init(&t->deques[deque_count % PRIORITY_COUNT].mutex);
+		if (ret != 0) {
+			goto err_deques;
+		}
+	}
+
 	for (size_t i = 0; i < thread_count; i++) {
 		p->threads[i].p = p;
 		os_thread_init(&p->threads[i].thread);
@@ -438,6 +579,12 @@ u_worker_thread_pool_create(uint32_t starting_worker_count, uint32_t thread_coun
 	return (struct u_worker_thread_pool *)p;
 
 
+err_deques:
+	for (size_t i = 0; i < deque_count; i++) {
+		os_mutex_destroy(&p->threads[i / PRIORITY_COUNT].deques[i % PRIORITY_COUNT].mutex);
+	}
+	os_cond_destroy(&p->available.cond);
+
 err_mutex:
 	os_mutex_destroy(&p->mutex);
 
@@ -466,6 +613,14 @@ u_worker_thread_pool_destroy(struct u_worker_thread_pool *uwtp)
 		os_thread_destroy(&p->threads[i].thread);
 	}
 
+	// Only once all threads are gone, they steal from each other.
+	for (size_t i = 0; i < p->thread_count; i++) {
+		for (size_t k = 0; k < PRIORITY_COUNT; k++) {
+			assert(p->threads[i].deques[k].count == 0);
+			os_mutex_destroy(&p->threads[i].deques[k].mutex);
+		}
+	}
+
 	os_mutex_destroy(&p->mutex);
 	os_cond_destroy(&p->available.cond);
 
@@ -495,30 +650,43 @@ u_worker_group_create(struct u_worker_thread_pool *uwtp)
 
 void
 u_worker_group_push(struct u_worker_group *uwg, u_worker_group_func_t f, void *data)
+{
+	u_worker_group_push_with_priority(uwg, f, data, U_WORKER_PRIORITY_NORMAL);
+}
+
+void
+u_worker_group_push_with_priority(struct u_worker_group *uwg,
+                                  u_worker_group_func_t f,
+                                  void *data,
+                                  enum u_worker_priority priority)
 {
 	XRT_TRACE_MARKER();
 
 	struct group *g = group(uwg);
 	struct pool *p = pool(g->uwtp);
+	struct task task = {g, f, data};
 
-	os_mutex_lock(&p->mutex);
-	while (p->tasks_in_array_count >= MAX_TASK_COUNT) {
-		os_mutex_unlock(&p->mutex);
+	assert(priority >= U_WORKER_PRIORITY_NORMAL && priority < PRIORITY_COUNT);
+
+	// Counted before it can be popped, so it can't drop below zero.
+	xrt_atomic_s32_inc_return(&g->current_submitted_tasks_count);
+
+	while (!pool_push_task(p, &task, priority)) {
+		// The task was never pushed, wakes any waiter if it was the last.
+		group_task_done(p, g);
 
 		//! @todo Don't wait all, wait one.
 		u_worker_group_wait_all(uwg);
 
-		os_mutex_lock(&p->mutex);
+		xrt_atomic_s32_inc_return(&g->current_submitted_tasks_count);
 	}
 
-	locked_pool_push_task(p, g, f, data);
-
 	// There are worker threads available, wake one up.
-	if (p->available.count > 0) {
-		os_cond_signal(&p->available.cond);
+	if (xrt_atomic_s32_load_acquire(&p->available.count) > 0) {
+		os_mutex_lock(&p->mutex);
+		locked_pool_wake_worker_if_allowed(p);
+		os_mutex_unlock(&p->mutex);
 	}
-
-	os_mutex_unlock(&p->mutex);
 }
 
 void
@@ -119,13 +119,36 @@ struct u_worker_group *
 u_worker_group_create(struct u_worker_thread_pool *uwtp);
 
 /*!
- * Push a new task to worker group.
+ * Priority of a task, higher priority tasks are picked up by workers before
+ * any lower priority ones, across all groups sharing the thread pool.
+ *
+ * @ingroup aux_util
+ */
+enum u_worker_priority
+{
+	U_WORKER_PRIORITY_NORMAL = 0,
+	U_WORKER_PRIORITY_HIGH = 1,
+};
+
+/*!
+ * Push a new task to worker group, with @ref U_WORKER_PRIORITY_NORMAL.
  *
  * @ingroup aux_util
  */
 void
 u_worker_group_push(struct u_worker_group *uwg, u_worker_group_func_t f, void *data);
 
+/*!
+ * Push a new task to worker group with the given priority.
+ *
+ * @ingroup aux_util
+ */
+void
+u_worker_group_push_with_priority(struct u_worker_group *uwg,
+                                  u_worker_group_func_t f,
+                                  void *data,
+                                  enum u_worker_priority priority);
+
 /*!
  * Wait for all pushed tasks to be completed, "donates" this thread to the
  * shared thread pool.
@@ -181,6 +181,7 @@ vk_fill_in_has_instance_extensions(struct vk_bundle *vk, struct u_string_list *e
 	// beginning of GENERATED instance extension code - do not modify - used by scripts
 	// Reset before filling out.
 	vk->has_KHR_external_memory_capabilities = false;
+	vk->has_KHR_get_surface_capabilities2 = false;
 	vk->has_EXT_display_surface_counter = false;
 	vk->has_EXT_swapchain_colorspace = false;
 	vk->has_EXT_debug_utils = false;
@@ -198,6 +199,13 @@ vk_fill_in_has_instance_extensions(struct vk_bundle *vk, struct u_string_list *e
 		}
 #endif // defined(VK_KHR_external_memory_capabilities)
 
+#if defined(VK_KHR_get_surface_capabilities2)
+		if (strcmp(ext, VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME) == 0) {
+			vk->has_KHR_get_surface_capabilities2 = true;
+			continue;
+		}
+#endif // defined(VK_KHR_get_surface_capabilities2)
+
 #if defined(VK_EXT_display_surface_counter)
 		if (strcmp(ext, VK_EXT_DISPLAY_SURFACE_COUNTER_EXTENSION_NAME) == 0) {
 			vk->has_EXT_display_surface_counter = true;
@@ -670,6 +678,26 @@ err_free:
 	return VK_ERROR_INITIALIZATION_FAILED;
 }
 
+static uint32_t
+get_queue_family_queue_count(struct vk_bundle *vk, uint32_t queue_family_index)
+{
+	uint32_t queue_family_count = 0;
+	vk->vkGetPhysicalDeviceQueueFamilyProperties(vk->physical_device, &queue_family_count, NULL);
+
+	if (queue_family_index >= queue_family_count) {
+		return 0;
+	}
+
+	VkQueueFamilyProperties *queue_family_props = U_TYPED_ARRAY_CALLOC(VkQueueFamilyProperties, queue_family_count);
+	vk->vkGetPhysicalDeviceQueueFamilyProperties(vk->physical_device, &queue_family_count, queue_family_props);
+
+	uint32_t queue_count = queue_family_props[queue_family_index].queueCount;
+
+	free(queue_family_props);
+
+	return queue_count;
+}
+
 static VkResult
 find_queue_family(struct vk_bundle *vk, VkQueueFlags required_flags, uint32_t *out_queue_family)
 {
@@ -752,6 +780,8 @@ fill_in_has_device_extensions(struct vk_bundle *vk, struct u_string_list *ext_li
 	vk->has_KHR_maintenance3 = false;
 	vk->has_KHR_maintenance4 = false;
 	vk->has_KHR_present_wait = false;
+	vk->has_KHR_push_descriptor = false;
+	vk->has_KHR_shared_presentable_image = false;
 	vk->has_KHR_synchronization2 = false;
 	vk->has_KHR_timeline_semaphore = false;
 	vk->has_KHR_video_maintenance1 = false;
@@ -760,7 +790,9 @@ fill_in_has_device_extensions(struct vk_bundle *vk, struct u_string_list *ext_li
 	vk->has_EXT_external_memory_dma_buf = false;
 	vk->has_EXT_external_memory_host = false;
 	vk->has_EXT_global_priority = false;
+	vk->has_EXT_image_compression_control = false;
 	vk->has_EXT_image_drm_format_modifier = false;
+	vk->has_EXT_present_timing = false;
 	vk->has_EXT_robustness2 = false;
 	vk->has_ANDROID_external_format_resolve = false;
 	vk->has_GOOGLE_display_timing = false;
@@ -855,6 +887,20 @@ fill_in_has_device_extensions(struct vk_bundle *vk, struct u_string_list *ext_li
 		}
 #endif // defined(VK_KHR_present_wait)
 
+#if defined(VK_KHR_push_descriptor)
+		if (strcmp(ext, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME) == 0) {
+			vk->has_KHR_push_descriptor = true;
+			continue;
+		}
+#endif // defined(VK_KHR_push_descriptor)
+
+#if defined(VK_KHR_shared_presentable_image)
+		if (strcmp(ext, VK_KHR_SHARED_PRESENTABLE_IMAGE_EXTENSION_NAME) == 0) {
+			vk->has_KHR_shared_presentable_image = true;
+			continue;
+		}
+#endif // defined(VK_KHR_shared_presentable_image)
+
 #if defined(VK_KHR_synchronization2)
 		if (strcmp(ext, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME) == 0) {
 			vk->has_KHR_synchronization2 = true;
@@ -911,6 +957,13 @@ fill_in_has_device_extensions(struct vk_bundle *vk, struct u_string_list *ext_li
 		}
 #endif // defined(VK_EXT_global_priority)
 
+#if defined(VK_EXT_image_compression_control)
+		if (strcmp(ext, VK_EXT_IMAGE_COMPRESSION_CONTROL_EXTENSION_NAME) == 0) {
+			vk->has_EXT_image_compression_control = true;
+			continue;
+		}
+#endif // defined(VK_EXT_image_compression_control)
+
 #if defined(VK_EXT_image_drm_format_modifier)
 		if (strcmp(ext, VK_EXT_IMAGE_DRM_FORMAT_MODIFIER_EXTENSION_NAME) == 0) {
 			vk->has_EXT_image_drm_format_modifier = true;
@@ -918,6 +971,13 @@ fill_in_has_device_extensions(struct vk_bundle *vk, struct u_string_list *ext_li
 		}
 #endif // defined(VK_EXT_image_drm_format_modifier)
 
+#if defined(VK_EXT_present_timing)
+		if (strcmp(ext, VK_EXT_PRESENT_TIMING_EXTENSION_NAME) == 0) {
+			vk->has_EXT_present_timing = true;
+			continue;
+		}
+#endif // defined(VK_EXT_present_timing)
+
 #if defined(VK_EXT_robustness2)
 		if (strcmp(ext, VK_EXT_ROBUSTNESS_2_EXTENSION_NAME) == 0) {
 			vk->has_EXT_robustness2 = true;
@@ -1112,6 +1172,20 @@ filter_device_features(struct vk_bundle *vk,
 	};
 #endif
 
+#ifdef VK_EXT_image_compression_control
+	VkPhysicalDeviceImageCompressionControlFeaturesEXT image_compression_control_info = {
+	    .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_COMPRESSION_CONTROL_FEATURES_EXT,
+	    .pNext = NULL,
+	};
+#endif
+
+#ifdef VK_EXT_present_timing
+	VkPhysicalDevicePresentTimingFeaturesEXT present_timing_info = {
+	    .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_TIMING_FEATURES_EXT,
+	    .pNext = NULL,
+	};
+#endif
+
 	VkPhysicalDeviceFeatures2 physical_device_features = {
 	    .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
 	    .pNext = NULL,
@@ -1169,6 +1243,20 @@ filter_device_features(struct vk_bundle *vk,
 	}
 #endif
 
+#ifdef VK_EXT_image_compression_control
+	if (vk->has_EXT_image_compression_control) {
+		vk_append_to_pnext_chain((VkBaseInStructure *)&physical_device_features,
+		                         (VkBaseInStructure *)&image_compression_control_info);
+	}
+#endif
+
+#ifdef VK_EXT_present_timing
+	if (vk->has_EXT_present_timing) {
+		vk_append_to_pnext_chain((VkBaseInStructure *)&physical_device_features,
+		                         (VkBaseInStructure *)&present_timing_info);
+	}
+#endif
+
 	vk->vkGetPhysicalDeviceFeatures2( //
 	    physical_device,              // physicalDevice
 	    &physical_device_features);   // pFeatures
@@ -1209,6 +1297,15 @@ filter_device_features(struct vk_bundle *vk,
 	CHECK(ext_fmt_resolve, ext_fmt_resolve_info.externalFormatResolve);
 #endif
 
+#ifdef VK_EXT_image_compression_control
+	CHECK(image_compression_control, image_compression_control_info.imageCompressionControl);
+#endif
+
+#ifdef VK_EXT_present_timing
+	// We only use absolute target times.
+	CHECK(present_timing, present_timing_info.presentTiming && present_timing_info.presentAtAbsoluteTime);
+#endif
+
 	CHECK(shader_image_gather_extended, physical_device_features.features.shaderImageGatherExtended);
 
 	CHECK(shader_storage_image_write_without_format,
@@ -1220,7 +1317,9 @@ filter_device_features(struct vk_bundle *vk,
 	VK_DEBUG(vk,
 	         "Features:"
 	         "\n\text_fmt_resolve: %i"
+	         "\n\timage_compression_control: %i"
 	         "\n\tnull_descriptor: %i"
+	         "\n\tpresent_timing: %i"
 	         "\n\tshader_image_gather_extended: %i"
 	         "\n\tshader_storage_image_write_without_format: %i"
 	         "\n\tstorage_buffer_8bit_access: %i"
@@ -1228,7 +1327,9 @@ filter_device_features(struct vk_bundle *vk,
 	         "\n\ttimeline_semaphore: %i"
 	         "\n\tvideo_maintenance_1: %i",                              //
 	         device_features->ext_fmt_resolve,                           //
+	         device_features->image_compression_control,                 //
 	         device_features->null_descriptor,                           //
+	         device_features->present_timing,                            //
 	         device_features->shader_image_gather_extended,              //
 	         device_features->shader_storage_image_write_without_format, //
 	         device_features->storage_buffer_8bit_access,                //
@@ -1254,6 +1355,7 @@ XRT_CHECK_RESULT VkResult
 vk_create_device(struct vk_bundle *vk,
                  int forced_index,
                  bool only_compute,
+                 bool want_compute_queue,
                  VkQueueGlobalPriorityEXT global_priority,
                  struct u_string_list *required_device_ext_list,
                  struct u_string_list *optional_device_ext_list,
@@ -1283,6 +1385,8 @@ vk_create_device(struct vk_bundle *vk,
 	vk->features.synchronization_2 = device_features.synchronization_2;
 	vk->features.present_wait = device_features.present_wait;
 	vk->features.video_maintenance_1 = device_features.video_maintenance_1;
+	vk->features.image_compression_control = device_features.image_compression_control;
+	vk->features.present_timing = device_features.present_timing;
 
 
 	/*
@@ -1312,16 +1416,29 @@ vk_create_device(struct vk_bundle *vk,
 	    .globalPriority = global_priority,
 	};
 
+	// The compute queue is the second queue of the main queue family.
+	vk->compute_queue = VK_BUNDLE_NULL_QUEUE;
+	if (want_compute_queue) {
+		if (get_queue_family_queue_count(vk, vk->main_queue.family_index) >= 2) {
+			vk->compute_queue.family_index = vk->main_queue.family_index;
+			vk->compute_queue.index = 1;
+			VK_DEBUG(vk, "Creating compute queue, family index %d", vk->compute_queue.family_index);
+		} else {
+			VK_DEBUG(vk, "Only one queue in main queue family, not creating compute queue");
+		}
+	}
+
+	float queue_priorities[2] = {0.0f, 0.0f};
 	float queue_priority = 0.0f;
 	VkDeviceQueueCreateInfo queue_create_info[2] = {0};
 	uint32_t queue_create_info_count = 1;
 
-	// Compute or Graphics queue
+	// Compute or Graphics queue, plus the optional compute queue.
 	queue_create_info[0].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
 	queue_create_info[0].pNext = NULL;
-	queue_create_info[0].queueCount = 1;
+	queue_create_info[0].queueCount = vk->compute_queue.index == 1 ? 2 : 1;
 	queue_create_info[0].queueFamilyIndex = vk->main_queue.family_index;
-	queue_create_info[0].pQueuePriorities = &queue_priority;
+	queue_create_info[0].pQueuePriorities = queue_priorities;
 
 #ifdef VK_KHR_video_encode_queue
 	// Video encode queue
@@ -1421,6 +1538,23 @@ vk_create_device(struct vk_bundle *vk,
 	};
 #endif
 
+#ifdef VK_EXT_image_compression_control
+	VkPhysicalDeviceImageCompressionControlFeaturesEXT image_compression_control_info = {
+	    .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_COMPRESSION_CONTROL_FEATURES_EXT,
+	    .pNext = NULL,
+	    .imageCompressionControl = device_features.image_compression_control,
+	};
+#endif
+
+#ifdef VK_EXT_present_timing
+	VkPhysicalDevicePresentTimingFeaturesEXT present_timing_info = {
+	    .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_TIMING_FEATURES_EXT,
+	    .pNext = NULL,
+	    .presentTiming = device_features.present_timing,
+	    .presentAtAbsoluteTime = device_features.present_timing,
+	};
+#endif
+
 	VkPhysicalDeviceFeatures enabled_features = {
 	    .shaderImageGatherExtended = device_features.shader_image_gather_extended,
 	    .shaderStorageImageWriteWithoutFormat = device_features.shader_storage_image_write_without_format,
@@ -1487,6 +1621,20 @@ vk_create_device(struct vk_bundle *vk,
 	}
 #endif
 
+#ifdef VK_EXT_image_compression_control
+	if (vk->has_EXT_image_compression_control) {
+		vk_append_to_pnext_chain((VkBaseInStructure *)&device_create_info,
+		                         (VkBaseInStructure *)&image_compression_control_info);
+	}
+#endif
+
+#ifdef VK_EXT_present_timing
+	if (vk->has_EXT_present_timing) {
+		vk_append_to_pnext_chain((VkBaseInStructure *)&device_create_info,
+		                         (VkBaseInStructure *)&present_timing_info);
+	}
+#endif
+
 	ret = vk->vkCreateDevice(vk->physical_device, &device_create_info, NULL, &vk->device);
 
 	u_string_list_destroy(&device_ext_list);
@@ -1511,6 +1659,10 @@ vk_create_device(struct vk_bundle *vk,
 		goto err_destroy;
 	}
 	vk->vkGetDeviceQueue(vk->device, vk->main_queue.family_index, 0, &vk->main_queue.queue);
+	if (vk->compute_queue.family_index != VK_QUEUE_FAMILY_IGNORED) {
+		vk->vkGetDeviceQueue(vk->device, vk->compute_queue.family_index, vk->compute_queue.index,
+		                     &vk->compute_queue.queue);
+	}
 #if defined(VK_KHR_video_encode_queue)
 	if (vk->encode_queue.family_index != VK_QUEUE_FAMILY_IGNORED) {
 		vk->vkGetDeviceQueue(vk->device, vk->encode_queue.family_index, 0, &vk->encode_queue.queue);
@@ -1584,6 +1736,7 @@ vk_init_from_given(struct vk_bundle *vk,
 	vk->device = device;
 	vk->main_queue.family_index = queue_family_index;
 	vk->main_queue.index = queue_index;
+	vk->compute_queue = VK_BUNDLE_NULL_QUEUE;
 #ifdef VK_KHR_video_encode_queue
 	vk->encode_queue = VK_BUNDLE_NULL_QUEUE;
 #endif
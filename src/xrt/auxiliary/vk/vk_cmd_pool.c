@@ -148,6 +148,83 @@ vk_cmd_pool_submit_cmd_buffer_locked(struct vk_bundle *vk, struct vk_cmd_pool *p
 	return ret;
 }
 
+XRT_CHECK_RESULT VkResult
+vk_cmd_pool_end_submit_wait_and_free_cmd_buffer_locked(struct vk_bundle *vk,
+                                                       struct vk_cmd_pool *pool,
+                                                       VkCommandBuffer cmd_buffer)
+{
+	VkFence fence;
+	VkResult ret;
+	int wait_attempts = 0;
+	int max_wait_attempts = 10;
+
+	// Finish the command buffer first, the command buffer pool lock is held.
+	ret = vk->vkEndCommandBuffer(cmd_buffer);
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vkEndCommandBuffer: %s", vk_result_string(ret));
+		goto out;
+	}
+
+	// Create the fence.
+	VkFenceCreateInfo fence_info = {
+	    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+	};
+
+	ret = vk->vkCreateFence(vk->device, &fence_info, NULL, &fence);
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vkCreateFence: %s", vk_result_string(ret));
+		goto out;
+	}
+
+	// Shortlived, but name for debugging.
+	VK_NAME_FENCE(vk, fence, "VK Pool Submit And Wait");
+
+	// Do the submit.
+	VkSubmitInfo submitInfo = {
+	    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+	    .commandBufferCount = 1,
+	    .pCommandBuffers = &cmd_buffer,
+	};
+
+	ret = vk_cmd_submit_locked(vk, pool->queue, 1, &submitInfo, fence);
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vk_cmd_submit_locked: %s", vk_result_string(ret));
+		goto out_fence;
+	}
+
+	/*
+	 * The command buffer is pending and nothing else touches it, so let
+	 * other threads use the pool while we wait on the GPU.
+	 */
+	vk_cmd_pool_unlock(pool);
+
+	do {
+		wait_attempts++;
+		ret = vk->vkWaitForFences(vk->device, 1, &fence, VK_TRUE, 1000000000);
+		if (ret != VK_TIMEOUT) {
+			break;
+		}
+		VK_WARN(vk, "vkWaitForFences not finished after %i attempt(s)...", wait_attempts);
+	} while (wait_attempts < max_wait_attempts);
+
+	vk_cmd_pool_lock(pool);
+
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vkWaitForFences: %s", vk_result_string(ret));
+		goto out_fence;
+	}
+
+	// Yes fall through.
+
+out_fence:
+	vk->vkDestroyFence(vk->device, fence, NULL);
+out:
+	// Destroy the command buffer, the command buffer pool lock is held again.
+	vk->vkFreeCommandBuffers(vk->device, pool->pool, 1, &cmd_buffer);
+
+	return ret;
+}
+
 #ifdef VK_EXT_debug_utils
 XRT_CHECK_RESULT VkResult
 vk_cmd_pool_create_begin_insert_label_and_end_cmd_buffer_locked(struct vk_bundle *vk,
@@ -122,6 +122,10 @@ vk_cmd_pool_submit_cmd_buffer_locked(struct vk_bundle *vk, struct vk_cmd_pool *p
  * fence and wait on the commands to complete. Will also end and destroy the
  * passed in command buffer.
  *
+ * The pool lock is released while waiting on the fence, so other threads can
+ * create, record and submit command buffers from the pool in the meantime. It
+ * is held again when this function returns.
+ *
  * @pre Command pool lock must be held, see @ref vk_cmd_pool_lock.
  *
  * Calls:
@@ -133,13 +137,10 @@ vk_cmd_pool_submit_cmd_buffer_locked(struct vk_bundle *vk, struct vk_cmd_pool *p
  *
  * @public @memberof vk_cmd_pool
  */
-XRT_CHECK_RESULT static inline VkResult
+XRT_CHECK_RESULT VkResult
 vk_cmd_pool_end_submit_wait_and_free_cmd_buffer_locked(struct vk_bundle *vk,
                                                        struct vk_cmd_pool *pool,
-                                                       VkCommandBuffer cmd_buffer)
-{
-	return vk_cmd_end_submit_wait_and_free_cmd_buffer_locked(vk, pool->queue, pool->pool, cmd_buffer);
-}
+                                                       VkCommandBuffer cmd_buffer);
 
 /*!
  * Lock the command pool, needed for creating command buffers, filling out
@@ -134,9 +134,13 @@ vk_get_instance_functions(struct vk_bundle *vk)
 
 #if defined(VK_EXT_display_surface_counter)
 	vk->vkGetPhysicalDeviceSurfaceCapabilities2EXT        = GET_INS_PROC(vk, vkGetPhysicalDeviceSurfaceCapabilities2EXT);
-
 #endif // defined(VK_EXT_display_surface_counter)
 
+#if defined(VK_KHR_get_surface_capabilities2)
+	vk->vkGetPhysicalDeviceSurfaceCapabilities2KHR        = GET_INS_PROC(vk, vkGetPhysicalDeviceSurfaceCapabilities2KHR);
+
+#endif // defined(VK_KHR_get_surface_capabilities2)
+
 #if defined(VK_EXT_debug_utils)
 	vk->vkCreateDebugUtilsMessengerEXT                    = GET_INS_PROC(vk, vkCreateDebugUtilsMessengerEXT);
 	vk->vkSubmitDebugUtilsMessageEXT                      = GET_INS_PROC(vk, vkSubmitDebugUtilsMessageEXT);
@@ -229,6 +233,7 @@ vk_get_device_functions(struct vk_bundle *vk)
 
 	vk->vkCreatePipelineCache                       = GET_DEV_PROC(vk, vkCreatePipelineCache);
 	vk->vkDestroyPipelineCache                      = GET_DEV_PROC(vk, vkDestroyPipelineCache);
+	vk->vkGetPipelineCacheData                      = GET_DEV_PROC(vk, vkGetPipelineCacheData);
 
 	vk->vkResetDescriptorPool                       = GET_DEV_PROC(vk, vkResetDescriptorPool);
 	vk->vkCreateDescriptorPool                      = GET_DEV_PROC(vk, vkCreateDescriptorPool);
@@ -309,6 +314,13 @@ vk_get_device_functions(struct vk_bundle *vk)
 
 	vk->vkGetPastPresentationTimingGOOGLE           = GET_DEV_PROC(vk, vkGetPastPresentationTimingGOOGLE);
 
+#if defined(VK_EXT_present_timing)
+	vk->vkGetPastPresentationTimingEXT              = GET_DEV_PROC(vk, vkGetPastPresentationTimingEXT);
+	vk->vkGetSwapchainTimeDomainPropertiesEXT       = GET_DEV_PROC(vk, vkGetSwapchainTimeDomainPropertiesEXT);
+	vk->vkSetSwapchainPresentTimingQueueSizeEXT     = GET_DEV_PROC(vk, vkSetSwapchainPresentTimingQueueSizeEXT);
+
+#endif // defined(VK_EXT_present_timing)
+
 #if defined(VK_EXT_display_control)
 	vk->vkGetSwapchainCounterEXT                    = GET_DEV_PROC(vk, vkGetSwapchainCounterEXT);
 	vk->vkRegisterDeviceEventEXT                    = GET_DEV_PROC(vk, vkRegisterDeviceEventEXT);
@@ -321,6 +333,11 @@ vk_get_device_functions(struct vk_bundle *vk)
 
 #endif // defined(VK_EXT_image_drm_format_modifier)
 
+#if defined(VK_EXT_image_compression_control)
+	vk->vkGetImageSubresourceLayout2EXT             = GET_DEV_PROC(vk, vkGetImageSubresourceLayout2EXT);
+
+#endif // defined(VK_EXT_image_compression_control)
+
 #if defined(VK_EXT_debug_utils)
 	vk->vkCmdBeginDebugUtilsLabelEXT                = GET_DEV_PROC(vk, vkCmdBeginDebugUtilsLabelEXT);
 	vk->vkCmdEndDebugUtilsLabelEXT                  = GET_DEV_PROC(vk, vkCmdEndDebugUtilsLabelEXT);
@@ -335,7 +352,12 @@ vk_get_device_functions(struct vk_bundle *vk)
 
 #if defined(VK_KHR_present_wait)
 	vk->vkWaitForPresentKHR                         = GET_DEV_PROC(vk, vkWaitForPresentKHR);
+
 #endif // defined(VK_KHR_present_wait)
+
+#if defined(VK_KHR_push_descriptor)
+	vk->vkCmdPushDescriptorSetKHR                   = GET_DEV_PROC(vk, vkCmdPushDescriptorSetKHR);
+#endif // defined(VK_KHR_push_descriptor)
 	// end of GENERATED device loader code - do not modify - used by scripts
 
 	// clang-format on
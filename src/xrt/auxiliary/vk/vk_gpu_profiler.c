@@ -0,0 +1,239 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Timestamp query based profiler for GPU passes.
+ * @ingroup aux_vk
+ */
+
+#include "util/u_misc.h"
+#include "util/u_debug.h"
+
+#include "vk/vk_gpu_profiler.h"
+
+
+DEBUG_GET_ONCE_BOOL_OPTION(vk_gpu_profiler, "XRT_VK_GPU_PROFILER", false)
+
+#define QUERIES_PER_FRAME (VK_GPU_PROFILER_MAX_SCOPES * 2)
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+static uint32_t
+get_first_query(uint32_t frame_index, uint32_t scope)
+{
+	return frame_index * QUERIES_PER_FRAME + scope * 2;
+}
+
+#ifdef VK_EXT_calibrated_timestamps
+static bool
+try_read_frame(struct vk_bundle *vk,
+               struct vk_gpu_profiler *prof,
+               uint32_t frame_index,
+               struct vk_gpu_profiler_result out_results[VK_GPU_PROFILER_MAX_SCOPES])
+{
+	struct vk_gpu_profiler_frame *frame = &prof->frames[frame_index];
+	uint64_t timestamps[QUERIES_PER_FRAME];
+	uint32_t count = frame->scope_count * 2;
+
+	// No wait bit, returns VK_NOT_READY if the GPU hasn't gotten to all of them.
+	VkResult ret = vk->vkGetQueryPoolResults( //
+	    vk->device,                           // device
+	    prof->query_pool,                     // queryPool
+	    get_first_query(frame_index, 0),      // firstQuery
+	    count,                                // queryCount
+	    sizeof(uint64_t) * count,             // dataSize
+	    timestamps,                           // pData
+	    sizeof(uint64_t),                     // stride
+	    VK_QUERY_RESULT_64_BIT);              // flags
+	if (ret == VK_NOT_READY) {
+		return false;
+	}
+
+	// Either read or broken, don't try again.
+	frame->pending = false;
+
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vkGetQueryPoolResults: %s", vk_result_string(ret));
+		return false;
+	}
+
+	// Done straight after reading, the GPU ticks wrap around fairly quickly.
+	ret = vk_convert_timestamps_to_host_ns(vk, count, timestamps);
+	if (ret != VK_SUCCESS) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < frame->scope_count; i++) {
+		out_results[i].name = frame->names[i];
+		out_results[i].gpu_start_ns = timestamps[i * 2];
+		out_results[i].gpu_end_ns = timestamps[i * 2 + 1];
+	}
+
+	return true;
+}
+#endif
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+VkResult
+vk_gpu_profiler_init(struct vk_bundle *vk, struct vk_gpu_profiler *prof)
+{
+	U_ZERO(prof);
+
+	if (!debug_get_bool_option_vk_gpu_profiler()) {
+		return VK_SUCCESS;
+	}
+
+#ifdef VK_EXT_calibrated_timestamps
+	if (!vk->has_EXT_calibrated_timestamps || !vk->features.timestamp_compute_and_graphics) {
+		VK_WARN(vk, "GPU profiler needs VK_EXT_calibrated_timestamps and timestamps on all queues, disabled");
+		return VK_SUCCESS;
+	}
+
+	VkQueryPoolCreateInfo pool_info = {
+	    .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+	    .queryType = VK_QUERY_TYPE_TIMESTAMP,
+	    .queryCount = QUERIES_PER_FRAME * VK_GPU_PROFILER_FRAME_COUNT,
+	};
+
+	VkResult ret = vk->vkCreateQueryPool( //
+	    vk->device,                       // device
+	    &pool_info,                       // pCreateInfo
+	    NULL,                             // pAllocator
+	    &prof->query_pool);               // pQueryPool
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vkCreateQueryPool: %s", vk_result_string(ret));
+		prof->query_pool = VK_NULL_HANDLE;
+		return ret;
+	}
+
+	VK_NAME_QUERY_POOL(vk, prof->query_pool, "vk_gpu_profiler query pool");
+
+	VK_INFO(vk, "GPU profiler enabled");
+#else
+	VK_WARN(vk, "GPU profiler needs VK_EXT_calibrated_timestamps, disabled");
+#endif
+
+	return VK_SUCCESS;
+}
+
+void
+vk_gpu_profiler_fini(struct vk_bundle *vk, struct vk_gpu_profiler *prof)
+{
+	if (prof->query_pool != VK_NULL_HANDLE) {
+		vk->vkDestroyQueryPool(vk->device, prof->query_pool, NULL);
+	}
+
+	U_ZERO(prof);
+}
+
+void
+vk_gpu_profiler_begin_frame(struct vk_gpu_profiler *prof, int64_t frame_id)
+{
+	if (!vk_gpu_profiler_is_enabled(prof)) {
+		return;
+	}
+
+	prof->current = (prof->current + 1) % VK_GPU_PROFILER_FRAME_COUNT;
+
+	// Drops the results if still pending, its queries are reset when reused.
+	struct vk_gpu_profiler_frame *frame = &prof->frames[prof->current];
+	frame->frame_id = frame_id;
+	frame->scope_count = 0;
+	frame->pending = false;
+}
+
+uint32_t
+vk_gpu_profiler_begin_scope(struct vk_bundle *vk,
+                            struct vk_gpu_profiler *prof,
+                            VkCommandBuffer cmd,
+                            const char *name)
+{
+	if (!vk_gpu_profiler_is_enabled(prof)) {
+		return VK_GPU_PROFILER_NO_SCOPE;
+	}
+
+	struct vk_gpu_profiler_frame *frame = &prof->frames[prof->current];
+	if (frame->scope_count >= VK_GPU_PROFILER_MAX_SCOPES) {
+		return VK_GPU_PROFILER_NO_SCOPE;
+	}
+
+	uint32_t scope = frame->scope_count++;
+	uint32_t query = get_first_query(prof->current, scope);
+
+	// Reset in the same command buffer, makes it ordered whatever the queue.
+	vk->vkCmdResetQueryPool( //
+	    cmd,                 // commandBuffer
+	    prof->query_pool,    // queryPool
+	    query,               // firstQuery
+	    2);                  // queryCount
+
+	vk->vkCmdWriteTimestamp(               //
+	    cmd,                               // commandBuffer
+	    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, // pipelineStage
+	    prof->query_pool,                  // queryPool
+	    query);                            // query
+
+	frame->names[scope] = name;
+	frame->pending = true;
+
+	return scope;
+}
+
+void
+vk_gpu_profiler_end_scope(struct vk_bundle *vk, struct vk_gpu_profiler *prof, VkCommandBuffer cmd, uint32_t scope)
+{
+	if (!vk_gpu_profiler_is_enabled(prof) || scope == VK_GPU_PROFILER_NO_SCOPE) {
+		return;
+	}
+
+	vk->vkCmdWriteTimestamp(                        //
+	    cmd,                                        // commandBuffer
+	    VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,       // pipelineStage
+	    prof->query_pool,                           // queryPool
+	    get_first_query(prof->current, scope) + 1); // query
+}
+
+uint32_t
+vk_gpu_profiler_read_results(struct vk_bundle *vk,
+                             struct vk_gpu_profiler *prof,
+                             int64_t *out_frame_id,
+                             struct vk_gpu_profiler_result out_results[VK_GPU_PROFILER_MAX_SCOPES])
+{
+#ifdef VK_EXT_calibrated_timestamps
+	if (!vk_gpu_profiler_is_enabled(prof)) {
+		return 0;
+	}
+
+	// Oldest first, skipping the frame being recorded.
+	for (uint32_t i = 1; i < VK_GPU_PROFILER_FRAME_COUNT; i++) {
+		uint32_t frame_index = (prof->current + i) % VK_GPU_PROFILER_FRAME_COUNT;
+		struct vk_gpu_profiler_frame *frame = &prof->frames[frame_index];
+
+		if (!frame->pending || !try_read_frame(vk, prof, frame_index, out_results)) {
+			continue;
+		}
+
+		*out_frame_id = frame->frame_id;
+
+		return frame->scope_count;
+	}
+#else
+	(void)vk;
+	(void)prof;
+	(void)out_frame_id;
+	(void)out_results;
+#endif
+
+	return 0;
+}
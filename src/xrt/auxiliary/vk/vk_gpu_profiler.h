@@ -0,0 +1,165 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Timestamp query based profiler for GPU passes.
+ * @ingroup aux_vk
+ */
+
+#pragma once
+
+#include "vk/vk_helpers.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//! Max number of scopes that can be recorded in a single frame.
+#define VK_GPU_PROFILER_MAX_SCOPES 16
+
+//! Number of frames that can be in flight before their results are lost.
+#define VK_GPU_PROFILER_FRAME_COUNT 3
+
+//! Returned by @ref vk_gpu_profiler_begin_scope when nothing was recorded.
+#define VK_GPU_PROFILER_NO_SCOPE UINT32_MAX
+
+/*!
+ * When a single scope ran on the GPU.
+ *
+ * @ingroup aux_vk
+ */
+struct vk_gpu_profiler_result
+{
+	//! Static string given to @ref vk_gpu_profiler_begin_scope.
+	const char *name;
+
+	//! Same time domain as @ref os_monotonic_get_ns.
+	uint64_t gpu_start_ns;
+
+	//! Same time domain as @ref os_monotonic_get_ns.
+	uint64_t gpu_end_ns;
+};
+
+/*!
+ * The scopes recorded for one frame.
+ *
+ * @ingroup aux_vk
+ */
+struct vk_gpu_profiler_frame
+{
+	int64_t frame_id;
+
+	//! Number of scopes begun this frame.
+	uint32_t scope_count;
+
+	const char *names[VK_GPU_PROFILER_MAX_SCOPES];
+
+	//! Scopes have been recorded but not yet read back.
+	bool pending;
+};
+
+/*!
+ * Writes a timestamp at the start and end of each scope, the results are read
+ * back without waiting once the GPU is done, normally a frame later. Each frame
+ * uses its own range of the query pool so a frame can be recorded while the
+ * previous one is still running. Scopes may be recorded into command buffers
+ * submitted to different queues, each scope resets its own queries.
+ *
+ * Needs VK_EXT_calibrated_timestamps and is only enabled with the
+ * `XRT_VK_GPU_PROFILER` environment variable, all functions are safe to call
+ * when disabled. Not thread safe, externally synchronise like the command
+ * buffers it records into.
+ *
+ * @ingroup aux_vk
+ */
+struct vk_gpu_profiler
+{
+	//! Two timestamps per scope per frame, VK_NULL_HANDLE when disabled.
+	VkQueryPool query_pool;
+
+	struct vk_gpu_profiler_frame frames[VK_GPU_PROFILER_FRAME_COUNT];
+
+	//! Index of the frame being recorded.
+	uint32_t current;
+};
+
+/*!
+ * Creates the query pool if the profiler is enabled and supported, leaves it
+ * disabled otherwise.
+ *
+ * @public @memberof vk_gpu_profiler
+ */
+VkResult
+vk_gpu_profiler_init(struct vk_bundle *vk, struct vk_gpu_profiler *prof);
+
+/*!
+ * Always safe to call, even if init failed or was never called on a zeroed
+ * struct.
+ *
+ * @public @memberof vk_gpu_profiler
+ */
+void
+vk_gpu_profiler_fini(struct vk_bundle *vk, struct vk_gpu_profiler *prof);
+
+/*!
+ * @public @memberof vk_gpu_profiler
+ */
+static inline bool
+vk_gpu_profiler_is_enabled(const struct vk_gpu_profiler *prof)
+{
+	return prof->query_pool != VK_NULL_HANDLE;
+}
+
+/*!
+ * Start a new frame, following scopes belong to it. Any results of the frame
+ * using the same range that haven't been read back are dropped.
+ *
+ * @public @memberof vk_gpu_profiler
+ */
+void
+vk_gpu_profiler_begin_frame(struct vk_gpu_profiler *prof, int64_t frame_id);
+
+/*!
+ * Write the start timestamp of a scope into @p cmd, must not be called inside
+ * of a render pass as the queries are reset here. The @p name must be a static
+ * string as it is kept until the results are read.
+ *
+ * @return Scope to hand to @ref vk_gpu_profiler_end_scope.
+ *
+ * @public @memberof vk_gpu_profiler
+ */
+uint32_t
+vk_gpu_profiler_begin_scope(struct vk_bundle *vk,
+                            struct vk_gpu_profiler *prof,
+                            VkCommandBuffer cmd,
+                            const char *name);
+
+/*!
+ * Write the end timestamp of a scope into @p cmd, needs to be recorded in the
+ * same frame as the begin, but may be in a different command buffer.
+ *
+ * @public @memberof vk_gpu_profiler
+ */
+void
+vk_gpu_profiler_end_scope(struct vk_bundle *vk, struct vk_gpu_profiler *prof, VkCommandBuffer cmd, uint32_t scope);
+
+/*!
+ * Read the results of the oldest frame that the GPU has completed, never waits
+ * and never returns the frame being recorded. Call until it returns zero.
+ *
+ * @return Number of results written, zero if no frame is ready.
+ *
+ * @public @memberof vk_gpu_profiler
+ */
+uint32_t
+vk_gpu_profiler_read_results(struct vk_bundle *vk,
+                             struct vk_gpu_profiler *prof,
+                             int64_t *out_frame_id,
+                             struct vk_gpu_profiler_result out_results[VK_GPU_PROFILER_MAX_SCOPES]);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -1370,6 +1370,54 @@ vk_get_native_handle_from_device_memory(struct vk_bundle *vk,
 	return get_device_memory_handle(vk, device_memory, out_handle);
 }
 
+const char *
+vk_get_image_compression_string(struct vk_bundle *vk, VkImage image)
+{
+#ifdef VK_EXT_image_compression_control
+	if (!vk->features.image_compression_control) {
+		return "UNKNOWN";
+	}
+
+	VkImageCompressionPropertiesEXT compression_properties = {
+	    .sType = VK_STRUCTURE_TYPE_IMAGE_COMPRESSION_PROPERTIES_EXT,
+	};
+
+	VkSubresourceLayout2EXT layout = {
+	    .sType = VK_STRUCTURE_TYPE_SUBRESOURCE_LAYOUT_2_EXT,
+	    .pNext = &compression_properties,
+	};
+
+	VkImageSubresource2EXT subresource = {
+	    .sType = VK_STRUCTURE_TYPE_IMAGE_SUBRESOURCE_2_EXT,
+	    .imageSubresource =
+	        {
+	            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+	            .mipLevel = 0,
+	            .arrayLayer = 0,
+	        },
+	};
+
+	vk->vkGetImageSubresourceLayout2EXT( //
+	    vk->device,                      // device
+	    image,                           // image
+	    &subresource,                    // pSubresource
+	    &layout);                        // pLayout
+
+	// The spec says only one of these three values will be returned.
+	switch (compression_properties.imageCompressionFlags) {
+	case VK_IMAGE_COMPRESSION_DEFAULT_EXT: return "DEFAULT (LOSSLESS)";
+	case VK_IMAGE_COMPRESSION_FIXED_RATE_EXPLICIT_EXT: return "FIXED RATE";
+	case VK_IMAGE_COMPRESSION_DISABLED_EXT: return "DISABLED";
+	default: break;
+	}
+#else
+	(void)vk;
+	(void)image;
+#endif
+
+	return "UNKNOWN";
+}
+
 VkResult
 vk_create_sampler(struct vk_bundle *vk, VkSamplerAddressMode clamp_mode, VkSampler *out_sampler)
 {
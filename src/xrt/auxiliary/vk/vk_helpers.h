@@ -73,6 +73,15 @@ struct vk_bundle
 	int physical_device_index;
 	VkDevice device;
 	struct vk_bundle_queue main_queue;
+
+	/*!
+	 * Optional second queue from the same family as @ref main_queue, lets
+	 * latency sensitive compute work be submitted without queueing behind
+	 * other work. Being from the same family means no queue family
+	 * ownership transfers are needed, @ref queue_mutex protects it too.
+	 */
+	struct vk_bundle_queue compute_queue;
+
 #if defined(VK_KHR_video_encode_queue)
 	struct vk_bundle_queue encode_queue;
 #endif
@@ -134,6 +143,7 @@ struct vk_bundle
 
 	// beginning of GENERATED instance extension code - do not modify - used by scripts
 	bool has_KHR_external_memory_capabilities;
+	bool has_KHR_get_surface_capabilities2;
 	bool has_EXT_display_surface_counter;
 	bool has_EXT_swapchain_colorspace;
 	bool has_EXT_debug_utils;
@@ -152,6 +162,8 @@ struct vk_bundle
 	bool has_KHR_maintenance3;
 	bool has_KHR_maintenance4;
 	bool has_KHR_present_wait;
+	bool has_KHR_push_descriptor;
+	bool has_KHR_shared_presentable_image;
 	bool has_KHR_synchronization2;
 	bool has_KHR_timeline_semaphore;
 	bool has_KHR_video_maintenance1;
@@ -160,7 +172,9 @@ struct vk_bundle
 	bool has_EXT_external_memory_dma_buf;
 	bool has_EXT_external_memory_host;
 	bool has_EXT_global_priority;
+	bool has_EXT_image_compression_control;
 	bool has_EXT_image_drm_format_modifier;
+	bool has_EXT_present_timing;
 	bool has_EXT_robustness2;
 	bool has_ANDROID_external_format_resolve;
 	bool has_GOOGLE_display_timing;
@@ -194,6 +208,12 @@ struct vk_bundle
 
 		//! Was KHR_video_maintenance1 requested, available, and enabled?
 		bool video_maintenance_1;
+
+		//! Was EXT_image_compression_control requested, available, and enabled?
+		bool image_compression_control;
+
+		//! Was EXT_present_timing with absolute times requested, available, and enabled?
+		bool present_timing;
 	} features;
 
 	//! Is the GPU a tegra device.
@@ -286,9 +306,13 @@ struct vk_bundle
 
 #if defined(VK_EXT_display_surface_counter)
 	PFN_vkGetPhysicalDeviceSurfaceCapabilities2EXT vkGetPhysicalDeviceSurfaceCapabilities2EXT;
-
 #endif // defined(VK_EXT_display_surface_counter)
 
+#if defined(VK_KHR_get_surface_capabilities2)
+	PFN_vkGetPhysicalDeviceSurfaceCapabilities2KHR vkGetPhysicalDeviceSurfaceCapabilities2KHR;
+
+#endif // defined(VK_KHR_get_surface_capabilities2)
+
 #if defined(VK_EXT_debug_utils)
 	PFN_vkCreateDebugUtilsMessengerEXT vkCreateDebugUtilsMessengerEXT;
 	PFN_vkSubmitDebugUtilsMessageEXT vkSubmitDebugUtilsMessageEXT;
@@ -373,6 +397,7 @@ struct vk_bundle
 
 	PFN_vkCreatePipelineCache vkCreatePipelineCache;
 	PFN_vkDestroyPipelineCache vkDestroyPipelineCache;
+	PFN_vkGetPipelineCacheData vkGetPipelineCacheData;
 
 	PFN_vkResetDescriptorPool vkResetDescriptorPool;
 	PFN_vkCreateDescriptorPool vkCreateDescriptorPool;
@@ -453,6 +478,13 @@ struct vk_bundle
 
 	PFN_vkGetPastPresentationTimingGOOGLE vkGetPastPresentationTimingGOOGLE;
 
+#if defined(VK_EXT_present_timing)
+	PFN_vkGetPastPresentationTimingEXT vkGetPastPresentationTimingEXT;
+	PFN_vkGetSwapchainTimeDomainPropertiesEXT vkGetSwapchainTimeDomainPropertiesEXT;
+	PFN_vkSetSwapchainPresentTimingQueueSizeEXT vkSetSwapchainPresentTimingQueueSizeEXT;
+
+#endif // defined(VK_EXT_present_timing)
+
 #if defined(VK_EXT_display_control)
 	PFN_vkGetSwapchainCounterEXT vkGetSwapchainCounterEXT;
 	PFN_vkRegisterDeviceEventEXT vkRegisterDeviceEventEXT;
@@ -465,6 +497,11 @@ struct vk_bundle
 
 #endif // defined(VK_EXT_image_drm_format_modifier)
 
+#if defined(VK_EXT_image_compression_control)
+	PFN_vkGetImageSubresourceLayout2EXT vkGetImageSubresourceLayout2EXT;
+
+#endif // defined(VK_EXT_image_compression_control)
+
 #if defined(VK_EXT_debug_utils)
 	PFN_vkCmdBeginDebugUtilsLabelEXT vkCmdBeginDebugUtilsLabelEXT;
 	PFN_vkCmdEndDebugUtilsLabelEXT vkCmdEndDebugUtilsLabelEXT;
@@ -479,8 +516,13 @@ struct vk_bundle
 
 #if defined(VK_KHR_present_wait)
 	PFN_vkWaitForPresentKHR vkWaitForPresentKHR;
+
 #endif // defined(VK_KHR_present_wait)
 
+#if defined(VK_KHR_push_descriptor)
+	PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR;
+#endif // defined(VK_KHR_push_descriptor)
+
 	// end of GENERATED device loader code - do not modify - used by scripts
 };
 
@@ -1053,6 +1095,8 @@ struct vk_device_features
 	bool storage_buffer_8bit_access;
 	bool present_wait;
 	bool video_maintenance_1;
+	bool image_compression_control;
+	bool present_timing;
 };
 
 /*!
@@ -1064,6 +1108,7 @@ XRT_CHECK_RESULT VkResult
 vk_create_device(struct vk_bundle *vk,
                  int forced_index,
                  bool only_compute,
+                 bool want_compute_queue,
                  VkQueueGlobalPriorityEXT global_priority,
                  struct u_string_list *required_device_ext_list,
                  struct u_string_list *optional_device_ext_list,
@@ -1245,6 +1290,16 @@ vk_create_image_advanced(struct vk_bundle *vk,
                          VkDeviceMemory *out_mem,
                          VkImage *out_image);
 
+/*!
+ * Returns a short string describing the framebuffer compression the driver
+ * picked for @p image, queried with VK_EXT_image_compression_control. Returns
+ * "UNKNOWN" if the extension and feature is not available.
+ *
+ * @ingroup aux_vk
+ */
+XRT_CHECK_RESULT const char *
+vk_get_image_compression_string(struct vk_bundle *vk, VkImage image);
+
 /*!
  * @ingroup aux_vk
  */
@@ -1456,6 +1511,26 @@ vk_create_pipeline_layout(struct vk_bundle *vk,
 VkResult
 vk_create_pipeline_cache(struct vk_bundle *vk, VkPipelineCache *out_pipeline_cache);
 
+/*!
+ * Creates a pipeline cache, filled with the data stored for this device and
+ * driver by @ref vk_store_pipeline_cache_to_disk if there is any, falls back
+ * to an empty pipeline cache otherwise. In the vk_pipeline_cache.c file.
+ *
+ * Does error logging.
+ */
+VkResult
+vk_create_pipeline_cache_from_disk(struct vk_bundle *vk, VkPipelineCache *out_pipeline_cache);
+
+/*!
+ * Writes the contents of the pipeline cache to the user's cache directory, it
+ * is keyed on the pipeline cache UUID and driver version of the device. The
+ * cache must not be used by other threads while this is called.
+ *
+ * Failures are not fatal, at most a warning is logged.
+ */
+void
+vk_store_pipeline_cache_to_disk(struct vk_bundle *vk, VkPipelineCache pipeline_cache);
+
 /*!
  * Creates a compute pipeline, assumes entry function is called 'main'.
  *
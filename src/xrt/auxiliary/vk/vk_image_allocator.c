@@ -10,6 +10,7 @@
 #include "util/u_misc.h"
 #include "util/u_logging.h"
 #include "util/u_handles.h"
+#include "util/u_var.h"
 
 #include "vk/vk_image_allocator.h"
 
@@ -44,6 +45,24 @@ struct format_list_helper
 	uint32_t format_count;
 };
 
+/*
+ * Process wide counters of the memory allocated by @ref vk_ic_allocate, shown
+ * in the debug UI. Imported images are not counted, their memory is owned by
+ * whoever allocated it. Swapchains can be created from several threads so
+ * everything is updated atomically.
+ */
+struct image_allocator_stats
+{
+	xrt_atomic_s32_t registered;
+
+	int32_t image_count;
+	int32_t dedicated_count;
+	int32_t memory_kib;
+	int32_t peak_memory_kib;
+};
+
+static struct image_allocator_stats stats;
+
 
 /*
  *
@@ -51,6 +70,54 @@ struct format_list_helper
  *
  */
 
+static void
+atomic_add(int32_t *p, int32_t value)
+{
+	int32_t old = *(volatile int32_t *)p;
+	int32_t seen;
+	while ((seen = xrt_atomic_s32_cmpxchg(p, old, old + value)) != old) {
+		old = seen;
+	}
+}
+
+static void
+stats_image_allocated(const struct vk_image *image)
+{
+	if (xrt_atomic_s32_cmpxchg(&stats.registered, 0, 1) == 0) {
+		u_var_add_root(&stats, "Vulkan image allocator", false);
+		u_var_add_ro_i32(&stats, &stats.image_count, "Images");
+		u_var_add_ro_i32(&stats, &stats.dedicated_count, "Dedicated allocations");
+		u_var_add_ro_i32(&stats, &stats.memory_kib, "Memory (KiB)");
+		u_var_add_ro_i32(&stats, &stats.peak_memory_kib, "Peak memory (KiB)");
+	}
+
+	int32_t kib = (int32_t)((image->size + 1023) / 1024);
+
+	xrt_atomic_s32_inc_return(&stats.image_count);
+	if (image->use_dedicated_allocation) {
+		xrt_atomic_s32_inc_return(&stats.dedicated_count);
+	}
+	atomic_add(&stats.memory_kib, kib);
+
+	// Racy but only used for display, worst case a peak is missed.
+	int32_t current = xrt_atomic_s32_load_acquire(&stats.memory_kib);
+	if (current > stats.peak_memory_kib) {
+		stats.peak_memory_kib = current;
+	}
+}
+
+static void
+stats_image_freed(const struct vk_image *image)
+{
+	int32_t kib = (int32_t)((image->size + 1023) / 1024);
+
+	xrt_atomic_s32_dec_return(&stats.image_count);
+	if (image->use_dedicated_allocation) {
+		xrt_atomic_s32_dec_return(&stats.dedicated_count);
+	}
+	atomic_add(&stats.memory_kib, -kib);
+}
+
 static VkExternalMemoryHandleTypeFlags
 get_image_memory_handle_type(void)
 {
@@ -233,6 +300,21 @@ create_image(struct vk_bundle *vk, const struct xrt_swapchain_create_info *info,
 	}
 #endif
 
+#ifdef VK_EXT_image_compression_control
+	/*
+	 * Explicitly ask for the default, lossless, framebuffer compression;
+	 * never ask for fixed-rate as that is lossy.
+	 */
+	VkImageCompressionControlEXT image_compression_control = {
+	    .sType = VK_STRUCTURE_TYPE_IMAGE_COMPRESSION_CONTROL_EXT,
+	    .flags = VK_IMAGE_COMPRESSION_DEFAULT_EXT,
+	};
+
+	if (vk->features.image_compression_control) {
+		CHAIN(image_compression_control);
+	}
+#endif
+
 	if (info->face_count == 6) {
 		image_create_flags |= VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
 	}
@@ -353,6 +435,8 @@ create_image(struct vk_bundle *vk, const struct xrt_swapchain_create_info *info,
 	out_image->size = memory_requirements.memoryRequirements.size;
 	out_image->use_dedicated_allocation = use_dedicated_allocation;
 
+	stats_image_allocated(out_image);
+
 	return ret;
 }
 
@@ -367,6 +451,11 @@ destroy_image(struct vk_bundle *vk, struct vk_image *image)
 		vk->vkFreeMemory(vk->device, image->memory, NULL);
 		image->memory = VK_NULL_HANDLE;
 	}
+	// Only images from create_image have a size, imported ones aren't counted.
+	if (image->size != 0) {
+		stats_image_freed(image);
+		image->size = 0;
+	}
 }
 
 
@@ -457,6 +546,10 @@ vk_ic_from_natives(struct vk_bundle *vk,
 		    &native_images[i],             // image_native
 		    &out_vkic->images[i].handle,   // out_image
 		    &out_vkic->images[i].memory);  // out_mem
+
+		// Not allocated by us, keeps it out of the stats in destroy_image.
+		out_vkic->images[i].size = 0;
+
 		if (ret != VK_SUCCESS) {
 			if (!native_images[i].is_dxgi_handle) {
 				u_graphics_buffer_unref(&buf);
@@ -1,4 +1,4 @@
-// Copyright 2022, Collabora, Ltd.
+// Copyright 2022-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -12,6 +12,11 @@
 #include "os/os_threading.h"
 #include "util/u_trace_marker.h"
 #include "vk/vk_image_readback_to_xf_pool.h"
+#include "vk/vk_cmd.h"
+
+#if defined(XRT_GRAPHICS_BUFFER_HANDLE_IS_FD)
+#include <unistd.h>
+#endif
 
 
 struct vk_image_readback_to_xf_pool
@@ -23,6 +28,29 @@ struct vk_image_readback_to_xf_pool
 	VkExtent2D extent;
 	VkFormat vk_format;
 	enum xrt_format xrt_format;
+
+	//! Try to export the memory of the images as DMABUFs.
+	bool export_dmabuf;
+
+	//! Completes submitted readbacks, see @ref vk_image_readback_to_xf_pool_start_async.
+	struct
+	{
+		struct vk_bundle *vk;
+
+		struct os_thread_helper oth;
+		bool started;
+
+		vk_image_readback_to_xf_done_func_t done_func;
+		void *user_data;
+
+		/*!
+		 * Readbacks in submission order, protected by the thread lock,
+		 * can't overflow as every frame is in here at most once.
+		 */
+		struct vk_image_readback_to_xf *queue[READBACK_POOL_NUM_FRAMES];
+		uint32_t head;
+		uint32_t count;
+	} async;
 };
 
 static void
@@ -36,6 +64,125 @@ vk_xf_readback_release(struct xrt_frame *xf)
 	os_mutex_unlock(&w->pool->mutex);
 }
 
+#if defined(XRT_GRAPHICS_BUFFER_HANDLE_IS_FD) && defined(VK_EXT_external_memory_dma_buf)
+/*!
+ * Same as @ref vk_create_image_advanced but with memory that can be exported
+ * as a DMABUF, so encoders can import the pixels without a CPU copy.
+ */
+static VkResult
+create_exportable_image(struct vk_bundle *vk,
+                        VkExtent3D extent,
+                        VkFormat format,
+                        VkImageUsageFlags usage,
+                        VkMemoryPropertyFlags memory_property_flags,
+                        VkDeviceMemory *out_mem,
+                        VkImage *out_image,
+                        VkDeviceSize *out_size)
+{
+	VkDeviceMemory device_memory = VK_NULL_HANDLE;
+	VkImage image = VK_NULL_HANDLE;
+	VkResult ret;
+
+	VkExternalMemoryImageCreateInfo external_memory_image_create_info = {
+	    .sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO,
+	    .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT,
+	};
+
+	VkImageCreateInfo image_info = {
+	    .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+	    .pNext = &external_memory_image_create_info,
+	    .imageType = VK_IMAGE_TYPE_2D,
+	    .format = format,
+	    .extent = extent,
+	    .mipLevels = 1,
+	    .arrayLayers = 1,
+	    .samples = VK_SAMPLE_COUNT_1_BIT,
+	    .tiling = VK_IMAGE_TILING_LINEAR,
+	    .usage = usage,
+	    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+	    .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+	};
+
+	ret = vk->vkCreateImage(vk->device, &image_info, NULL, &image);
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vkCreateImage: %s", vk_result_string(ret));
+		return ret;
+	}
+
+	VkMemoryRequirements memory_requirements;
+	vk->vkGetImageMemoryRequirements(vk->device, image, &memory_requirements);
+
+	uint32_t memory_type_index = UINT32_MAX;
+	if (!vk_get_memory_type(vk, memory_requirements.memoryTypeBits, memory_property_flags, &memory_type_index)) {
+		VK_ERROR(vk, "vk_get_memory_type: false\n\tFailed to find a matching memory type.");
+		vk->vkDestroyImage(vk->device, image, NULL);
+		return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+
+	// In->pNext->pNext
+	VkMemoryDedicatedAllocateInfoKHR dedicated_memory_info = {
+	    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO_KHR,
+	    .image = image,
+	};
+
+	// In->pNext
+	VkExportMemoryAllocateInfo export_alloc_info = {
+	    .sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO_KHR,
+	    .pNext = &dedicated_memory_info,
+	    .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT,
+	};
+
+	VkMemoryAllocateInfo memory_allocate_info = {
+	    .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+	    .pNext = &export_alloc_info,
+	    .allocationSize = memory_requirements.size,
+	    .memoryTypeIndex = memory_type_index,
+	};
+
+	ret = vk->vkAllocateMemory(vk->device, &memory_allocate_info, NULL, &device_memory);
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vkAllocateMemory: %s", vk_result_string(ret));
+		vk->vkDestroyImage(vk->device, image, NULL);
+		return ret;
+	}
+
+	ret = vk->vkBindImageMemory(vk->device, image, device_memory, 0);
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vkBindImageMemory: %s", vk_result_string(ret));
+		vk->vkFreeMemory(vk->device, device_memory, NULL);
+		vk->vkDestroyImage(vk->device, image, NULL);
+		return ret;
+	}
+
+	*out_mem = device_memory;
+	*out_image = image;
+	*out_size = memory_requirements.size;
+
+	return VK_SUCCESS;
+}
+
+static bool
+export_dmabuf(struct vk_bundle *vk, VkDeviceMemory memory, int *out_fd)
+{
+	VkMemoryGetFdInfoKHR fd_info = {
+	    .sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR,
+	    .memory = memory,
+	    .handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT,
+	};
+
+	int fd = -1;
+	VkResult ret = vk->vkGetMemoryFdKHR(vk->device, &fd_info, &fd);
+	if (ret != VK_SUCCESS) {
+		VK_DEBUG(vk, "vkGetMemoryFdKHR: %s", vk_result_string(ret));
+		return false;
+	}
+
+	*out_fd = fd;
+
+	return true;
+}
+#endif
+
 // Creates a new frame, if there's room for one.
 static void
 vk_xf_readback_pool_try_create_new_frame(struct vk_bundle *vk, struct vk_image_readback_to_xf_pool *pool)
@@ -59,15 +206,47 @@ vk_xf_readback_pool_try_create_new_frame(struct vk_bundle *vk, struct vk_image_r
 	    VK_MEMORY_PROPERTY_HOST_CACHED_BIT |            //
 	    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;            //
 
-	VkResult res = vk_create_image_advanced( //
-	    vk,                                  //
-	    extent,                              //
-	    pool->vk_format,                     //
-	    VK_IMAGE_TILING_LINEAR,              //
-	    usage,                               //
-	    memory_property_flags,               //
-	    &memory,                             //
-	    &image);                             //
+	VkResult res = VK_ERROR_FEATURE_NOT_PRESENT;
+
+#if defined(XRT_GRAPHICS_BUFFER_HANDLE_IS_FD) && defined(VK_EXT_external_memory_dma_buf)
+	bool exported = false;
+	int dmabuf_fd = -1;
+	VkDeviceSize memory_size = 0;
+
+	if (pool->export_dmabuf) {
+		res = create_exportable_image( //
+		    vk,                        //
+		    extent,                    //
+		    pool->vk_format,           //
+		    usage,                     //
+		    memory_property_flags,     //
+		    &memory,                   //
+		    &image,                    //
+		    &memory_size);             //
+
+		if (res == VK_SUCCESS) {
+			exported = export_dmabuf(vk, memory, &dmabuf_fd);
+		}
+
+		// Only try once, the readback still works without it.
+		if (!exported) {
+			VK_WARN(vk, "Failed to export readback image as DMABUF, falling back to CPU only frames.");
+			pool->export_dmabuf = false;
+		}
+	}
+#endif
+
+	if (res != VK_SUCCESS) {
+		res = vk_create_image_advanced( //
+		    vk,                         //
+		    extent,                     //
+		    pool->vk_format,            //
+		    VK_IMAGE_TILING_LINEAR,     //
+		    usage,                      //
+		    memory_property_flags,      //
+		    &memory,                    //
+		    &image);                    //
+	}
 
 	VK_NAME_DEVICE_MEMORY(vk, memory, "vk_image_readback_to_xf_pool device memory");
 	VK_NAME_IMAGE(vk, image, "vk_image_readback_to_xf_pool image");
@@ -104,10 +283,23 @@ vk_xf_readback_pool_try_create_new_frame(struct vk_bundle *vk, struct vk_image_r
 
 
 
+	VkFence fence = VK_NULL_HANDLE;
+	VkFenceCreateInfo fence_info = {
+	    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+	};
+	res = vk->vkCreateFence(vk->device, &fence_info, NULL, &fence);
+	if (res != VK_SUCCESS) {
+		VK_ERROR(vk, "vkCreateFence: %s", vk_result_string(res));
+	}
+
+	VK_NAME_FENCE(vk, fence, "vk_image_readback_to_xf_pool fence");
+
 	int i = pool->num_images++;
 
 	struct vk_image_readback_to_xf *im = &pool->images[i];
 	im->pool = pool;
+	im->index = (uint32_t)i;
+	im->fence = fence;
 	im->image = image;
 	im->memory = memory;
 	im->image_extent = pool->extent;
@@ -120,6 +312,15 @@ vk_xf_readback_pool_try_create_new_frame(struct vk_bundle *vk, struct vk_image_r
 	im->base_frame.height = extent.height;
 	im->base_frame.size = stride * extent.height;
 	im->base_frame.format = pool->xrt_format;
+
+#if defined(XRT_GRAPHICS_BUFFER_HANDLE_IS_FD) && defined(VK_EXT_external_memory_dma_buf)
+	if (exported) {
+		im->base_frame.graphics_buffer.valid = true;
+		im->base_frame.graphics_buffer.handle = dmabuf_fd;
+		im->base_frame.graphics_buffer.offset = offset;
+		im->base_frame.graphics_buffer.size = memory_size;
+	}
+#endif
 }
 
 /*
@@ -145,6 +346,71 @@ find_created_not_used_wrap_locked(struct vk_image_readback_to_xf_pool *pool, str
 	return false;
 }
 
+/*!
+ * Waits for the readback of @p wrap, frees its command buffer and resets the
+ * fence so the frame can be reused, returns false if the wait failed.
+ */
+static bool
+finish_readback(struct vk_bundle *vk, struct vk_image_readback_to_xf *wrap)
+{
+	VkResult ret = vk->vkWaitForFences(vk->device, 1, &wrap->fence, VK_TRUE, UINT64_MAX);
+	if (ret != VK_SUCCESS) {
+		// Most likely a lost device, don't push anything that might be garbage.
+		VK_ERROR(vk, "vkWaitForFences: %s", vk_result_string(ret));
+	}
+
+	vk->vkResetFences(vk->device, 1, &wrap->fence);
+
+	vk_cmd_pool_lock(wrap->cmd_pool);
+	vk->vkFreeCommandBuffers(vk->device, wrap->cmd_pool->pool, 1, &wrap->cmd);
+	vk_cmd_pool_unlock(wrap->cmd_pool);
+
+	wrap->cmd = VK_NULL_HANDLE;
+	wrap->cmd_pool = NULL;
+
+	return ret == VK_SUCCESS;
+}
+
+static void *
+run_async_thread(void *ptr)
+{
+	struct vk_image_readback_to_xf_pool *pool = (struct vk_image_readback_to_xf_pool *)ptr;
+	struct vk_bundle *vk = pool->async.vk;
+
+	os_thread_helper_name(&pool->async.oth, "Readback");
+	U_TRACE_SET_THREAD_NAME("Readback");
+
+	os_thread_helper_lock(&pool->async.oth);
+
+	while (os_thread_helper_is_running_locked(&pool->async.oth)) {
+		if (pool->async.count == 0) {
+			os_thread_helper_wait_locked(&pool->async.oth);
+			continue;
+		}
+
+		struct vk_image_readback_to_xf *wrap = pool->async.queue[pool->async.head];
+		pool->async.head = (pool->async.head + 1) % READBACK_POOL_NUM_FRAMES;
+		pool->async.count--;
+
+		// Destroy joins the thread, so this readback is always finished.
+		os_thread_helper_unlock(&pool->async.oth);
+
+		bool success = finish_readback(vk, wrap);
+		if (success) {
+			pool->async.done_func(wrap, pool->async.user_data);
+		}
+
+		struct xrt_frame *xf = &wrap->base_frame;
+		xrt_frame_reference(&xf, NULL);
+
+		os_thread_helper_lock(&pool->async.oth);
+	}
+
+	os_thread_helper_unlock(&pool->async.oth);
+
+	return NULL;
+}
+
 bool
 vk_image_readback_to_xf_pool_get_unused_frame(struct vk_bundle *vk,
                                               struct vk_image_readback_to_xf_pool *pool,
@@ -176,12 +442,76 @@ vk_image_readback_to_xf_pool_get_unused_frame(struct vk_bundle *vk,
 	return found;
 }
 
+bool
+vk_image_readback_to_xf_pool_start_async(struct vk_bundle *vk,
+                                         struct vk_image_readback_to_xf_pool *pool,
+                                         vk_image_readback_to_xf_done_func_t done_func,
+                                         void *user_data)
+{
+	assert(!pool->async.started);
+
+	pool->async.vk = vk;
+	pool->async.done_func = done_func;
+	pool->async.user_data = user_data;
+
+	int ret = os_thread_helper_start(&pool->async.oth, run_async_thread, pool);
+	if (ret != 0) {
+		VK_ERROR(vk, "Failed to start readback thread!");
+		return false;
+	}
+
+	pool->async.started = true;
+
+	return true;
+}
+
+VkResult
+vk_image_readback_to_xf_pool_submit_locked(struct vk_bundle *vk,
+                                           struct vk_image_readback_to_xf_pool *pool,
+                                           struct vk_cmd_pool *cmd_pool,
+                                           VkCommandBuffer cmd,
+                                           struct vk_image_readback_to_xf *wrap)
+{
+	XRT_TRACE_MARKER();
+
+	assert(pool->async.started);
+	assert(wrap->pool == pool);
+
+	VkSubmitInfo submit_info = {
+	    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+	    .commandBufferCount = 1,
+	    .pCommandBuffers = &cmd,
+	};
+
+	VkResult ret = vk_cmd_submit_locked(vk, cmd_pool->queue, 1, &submit_info, wrap->fence);
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vk_cmd_submit_locked: %s", vk_result_string(ret));
+		return ret;
+	}
+
+	wrap->cmd = cmd;
+	wrap->cmd_pool = cmd_pool;
+
+	os_thread_helper_lock(&pool->async.oth);
+
+	uint32_t tail = (pool->async.head + pool->async.count) % READBACK_POOL_NUM_FRAMES;
+	assert(pool->async.count < READBACK_POOL_NUM_FRAMES);
+	pool->async.queue[tail] = wrap;
+	pool->async.count++;
+
+	os_thread_helper_signal_locked(&pool->async.oth);
+	os_thread_helper_unlock(&pool->async.oth);
+
+	return VK_SUCCESS;
+}
+
 void
 vk_image_readback_to_xf_pool_create(struct vk_bundle *vk,
                                     VkExtent2D extent,
                                     struct vk_image_readback_to_xf_pool **out_pool,
                                     enum xrt_format xrt_format,
-                                    VkFormat vk_format)
+                                    VkFormat vk_format,
+                                    bool export_dmabuf)
 {
 	struct vk_image_readback_to_xf_pool *pool = U_TYPED_CALLOC(struct vk_image_readback_to_xf_pool);
 	assert(xrt_format == XRT_FORMAT_R8G8B8X8 || xrt_format == XRT_FORMAT_R8G8B8A8);
@@ -193,6 +523,12 @@ vk_image_readback_to_xf_pool_create(struct vk_bundle *vk,
 	pool->num_images = 0;
 	pool->xrt_format = xrt_format;
 	pool->vk_format = vk_format;
+	pool->export_dmabuf = export_dmabuf && vk->has_EXT_external_memory_dma_buf;
+
+	ret = os_thread_helper_init(&pool->async.oth);
+	if (ret != 0) {
+		assert(false);
+	}
 
 	*out_pool = pool;
 }
@@ -208,18 +544,43 @@ vk_image_readback_to_xf_pool_destroy(struct vk_bundle *vk, struct vk_image_readb
 	struct vk_image_readback_to_xf_pool *pool = *pool_ptr;
 	*pool_ptr = NULL;
 
+	// Stops the thread, it finishes the readback it is waiting on first.
+	os_thread_helper_destroy(&pool->async.oth);
+
+	// The GPU must be done with the images before they are freed.
+	while (pool->async.count > 0) {
+		struct vk_image_readback_to_xf *wrap = pool->async.queue[pool->async.head];
+		pool->async.head = (pool->async.head + 1) % READBACK_POOL_NUM_FRAMES;
+		pool->async.count--;
+
+		finish_readback(vk, wrap);
+
+		struct xrt_frame *xf = &wrap->base_frame;
+		xrt_frame_reference(&xf, NULL);
+	}
+
 	for (int i = 0; i < pool->num_images; i++) {
 		struct vk_image_readback_to_xf *im = &pool->images[i];
 		if (!im->created) {
 			continue;
 		}
 
+#if defined(XRT_GRAPHICS_BUFFER_HANDLE_IS_FD)
+		if (im->base_frame.graphics_buffer.valid) {
+			close(im->base_frame.graphics_buffer.handle);
+		}
+#endif
+
 		vk->vkUnmapMemory( //
 		    vk->device,    //
 		    im->memory     //
 		);
 		vk->vkFreeMemory(vk->device, im->memory, NULL);
 		vk->vkDestroyImage(vk->device, im->image, NULL);
+
+		if (im->fence != VK_NULL_HANDLE) {
+			vk->vkDestroyFence(vk->device, im->fence, NULL);
+		}
 	}
 
 	os_mutex_destroy(&pool->mutex);
@@ -1,4 +1,4 @@
-// Copyright 2022, Collabora, Ltd.
+// Copyright 2022-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -22,6 +22,7 @@
 #include "util/u_string_list.h"
 
 #include "vk/vk_helpers.h"
+#include "vk/vk_cmd_pool.h"
 
 
 #define READBACK_POOL_NUM_FRAMES 16
@@ -40,29 +41,82 @@ struct vk_image_readback_to_xf
 
 	struct vk_image_readback_to_xf_pool *pool;
 
+	//! Index of this frame in the pool, stable for the lifetime of the pool.
+	uint32_t index;
+
 	VkImageLayout layout;
 
 	VkExtent2D image_extent;
 	VkImage image;
 	VkDeviceMemory memory;
 
+	//! Signalled when a readback submitted with @ref vk_image_readback_to_xf_pool_submit_locked is done.
+	VkFence fence;
+
+	//! Command buffer of the readback in flight, freed once it is done.
+	VkCommandBuffer cmd;
+	struct vk_cmd_pool *cmd_pool;
+
 	bool in_use;
 	bool created;
 };
 
+/*!
+ * Called on the pool's thread when a readback is done, the frame can be pushed
+ * to sinks, which take their own references. The pool drops the reference it
+ * was given after the callback returns. Not called for readbacks that are still
+ * in flight when the pool is destroyed.
+ */
+typedef void (*vk_image_readback_to_xf_done_func_t)(struct vk_image_readback_to_xf *wrap, void *user_data);
+
 
 bool
 vk_image_readback_to_xf_pool_get_unused_frame(struct vk_bundle *vk,
                                               struct vk_image_readback_to_xf_pool *pool,
                                               struct vk_image_readback_to_xf **out);
 
+/*!
+ * Create a readback pool, if @p export_dmabuf is set and supported the memory
+ * of the images is also exported as DMABUFs and set as the
+ * xrt_frame::graphics_buffer on the frames, the frames are still mapped so
+ * CPU consumers keep working.
+ */
 void
 vk_image_readback_to_xf_pool_create(struct vk_bundle *vk,
                                     VkExtent2D extent,
                                     struct vk_image_readback_to_xf_pool **out_pool,
                                     enum xrt_format xrt_format,
-                                    VkFormat vk_format);
+                                    VkFormat vk_format,
+                                    bool export_dmabuf);
 
+/*!
+ * Start the thread that waits for readbacks submitted with
+ * @ref vk_image_readback_to_xf_pool_submit_locked and calls @p done_func,
+ * so the caller never has to wait on the GPU itself.
+ */
+XRT_CHECK_RESULT bool
+vk_image_readback_to_xf_pool_start_async(struct vk_bundle *vk,
+                                         struct vk_image_readback_to_xf_pool *pool,
+                                         vk_image_readback_to_xf_done_func_t done_func,
+                                         void *user_data);
+
+/*!
+ * Submit the command buffer that fills @p wrap, takes ownership of the
+ * reference to @p wrap and of @p cmd on success. @p cmd_pool must be locked,
+ * @p cmd is freed from the pool's thread when the readback is done, taking the
+ * lock of @p cmd_pool. Requires @ref vk_image_readback_to_xf_pool_start_async.
+ */
+XRT_CHECK_RESULT VkResult
+vk_image_readback_to_xf_pool_submit_locked(struct vk_bundle *vk,
+                                           struct vk_image_readback_to_xf_pool *pool,
+                                           struct vk_cmd_pool *cmd_pool,
+                                           VkCommandBuffer cmd,
+                                           struct vk_image_readback_to_xf *wrap);
+
+/*!
+ * Waits for all readbacks in flight without calling the done function, the
+ * images are released and the resources freed.
+ */
 void
 vk_image_readback_to_xf_pool_destroy(struct vk_bundle *vk, struct vk_image_readback_to_xf_pool **pool_ptr);
 
@@ -0,0 +1,183 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Persistent on disk Vulkan pipeline cache.
+ * @ingroup aux_vk
+ */
+
+#include "xrt/xrt_config_os.h"
+
+#include "util/u_file.h"
+#include "util/u_debug.h"
+
+#include "vk/vk_helpers.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+DEBUG_GET_ONCE_BOOL_OPTION(vk_pipeline_cache, "XRT_VK_PIPELINE_CACHE", true)
+
+#define SUBPATH "vk_pipeline_cache"
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+#ifdef XRT_OS_LINUX
+static bool
+get_filename(struct vk_bundle *vk, char *out_name, size_t out_name_size)
+{
+	VkPhysicalDeviceProperties pdp;
+	vk->vkGetPhysicalDeviceProperties(vk->physical_device, &pdp);
+
+	char uuid[VK_UUID_SIZE * 2 + 1];
+	for (uint32_t i = 0; i < VK_UUID_SIZE; i++) {
+		snprintf(&uuid[i * 2], 3, "%02x", pdp.pipelineCacheUUID[i]);
+	}
+
+	int ret = snprintf(out_name, out_name_size, "%04x_%04x_%s_%08x.bin", pdp.vendorID, pdp.deviceID, uuid,
+	                   pdp.driverVersion);
+
+	return ret > 0 && ret < (int)out_name_size;
+}
+
+/*!
+ * The driver is supposed to reject data that it doesn't like, but not all do,
+ * so check the header against the device before handing it over.
+ */
+static bool
+is_data_valid(struct vk_bundle *vk, const void *data, size_t size)
+{
+	VkPipelineCacheHeaderVersionOne header;
+	if (size < sizeof(header)) {
+		return false;
+	}
+
+	memcpy(&header, data, sizeof(header));
+
+	VkPhysicalDeviceProperties pdp;
+	vk->vkGetPhysicalDeviceProperties(vk->physical_device, &pdp);
+
+	return header.headerSize >= sizeof(header) &&                          //
+	       header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && //
+	       header.vendorID == pdp.vendorID &&                              //
+	       header.deviceID == pdp.deviceID &&                              //
+	       memcmp(header.pipelineCacheUUID, pdp.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+#endif
+
+static VkResult
+create_pipeline_cache(struct vk_bundle *vk, const void *data, size_t size, VkPipelineCache *out_pipeline_cache)
+{
+	VkResult ret;
+
+	VkPipelineCacheCreateInfo pipeline_cache_info = {
+	    .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+	    .initialDataSize = size,
+	    .pInitialData = data,
+	};
+
+	VkPipelineCache pipeline_cache;
+	ret = vk->vkCreatePipelineCache( //
+	    vk->device,                  // device
+	    &pipeline_cache_info,        // pCreateInfo
+	    NULL,                        // pAllocator
+	    &pipeline_cache);            // pPipelineCache
+	if (ret != VK_SUCCESS) {
+		return ret;
+	}
+
+	*out_pipeline_cache = pipeline_cache;
+
+	return VK_SUCCESS;
+}
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+VkResult
+vk_create_pipeline_cache_from_disk(struct vk_bundle *vk, VkPipelineCache *out_pipeline_cache)
+{
+#ifdef XRT_OS_LINUX
+	char name[128];
+
+	if (debug_get_bool_option_vk_pipeline_cache() && get_filename(vk, name, sizeof(name))) {
+		size_t size = 0;
+		char *data = u_file_read_file_in_cache_dir_subpath(SUBPATH, name, &size);
+
+		if (data != NULL && is_data_valid(vk, data, size)) {
+			VkResult ret = create_pipeline_cache(vk, data, size, out_pipeline_cache);
+			free(data);
+
+			if (ret == VK_SUCCESS) {
+				VK_DEBUG(vk, "Loaded pipeline cache '%s' (%zu bytes)", name, size);
+				return VK_SUCCESS;
+			}
+
+			VK_WARN(vk, "Driver rejected pipeline cache '%s': %s", name, vk_result_string(ret));
+		} else {
+			free(data);
+		}
+	}
+#endif
+
+	return vk_create_pipeline_cache(vk, out_pipeline_cache);
+}
+
+void
+vk_store_pipeline_cache_to_disk(struct vk_bundle *vk, VkPipelineCache pipeline_cache)
+{
+#ifdef XRT_OS_LINUX
+	char name[128];
+	VkResult ret;
+
+	if (!debug_get_bool_option_vk_pipeline_cache() || pipeline_cache == VK_NULL_HANDLE) {
+		return;
+	}
+
+	if (!get_filename(vk, name, sizeof(name))) {
+		return;
+	}
+
+	size_t size = 0;
+	ret = vk->vkGetPipelineCacheData(vk->device, pipeline_cache, &size, NULL);
+	if (ret != VK_SUCCESS || size == 0) {
+		return;
+	}
+
+	void *data = malloc(size);
+	if (data == NULL) {
+		return;
+	}
+
+	// Returns VK_INCOMPLETE if the cache grew in between, just skip storing then.
+	ret = vk->vkGetPipelineCacheData(vk->device, pipeline_cache, &size, data);
+	if (ret != VK_SUCCESS) {
+		VK_WARN(vk, "vkGetPipelineCacheData: %s", vk_result_string(ret));
+		free(data);
+		return;
+	}
+
+	bool written = u_file_write_file_in_cache_dir_subpath(SUBPATH, name, NULL, 0, data, size);
+	free(data);
+
+	if (!written) {
+		return;
+	}
+
+	VK_DEBUG(vk, "Stored pipeline cache '%s' (%zu bytes)", name, size);
+#else
+	(void)vk;
+	(void)pipeline_cache;
+#endif
+}
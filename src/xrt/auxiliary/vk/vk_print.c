@@ -298,6 +298,7 @@ vk_print_queues_info(const struct vk_bundle *vk, enum u_logging_level log_level)
 
 	P("Selected Queues/Families:");
 	print_queue(dg, "main_", &vk->main_queue);
+	print_queue(dg, "compute_", &vk->compute_queue);
 	print_queue(dg, "encode_", &encode_queue);
 
 	U_LOG_IFL(log_level, vk->log_level, "%s", sink.buffer);
@@ -164,6 +164,12 @@ struct client_d3d11_compositor
 	 * The value most recently signaled on the timeline semaphore
 	 */
 	uint64_t timeline_semaphore_value = 0;
+
+	/*!
+	 * How swapchain image ownership is synchronized, keyed mutexes are
+	 * only used when there is no fence shared with the native compositor.
+	 */
+	xrt::compositor::client::SwapchainSyncMode sync_mode = xrt::compositor::client::SwapchainSyncMode::KeyedMutex;
 };
 
 static_assert(std::is_standard_layout<client_d3d11_compositor>::value);
@@ -282,7 +288,7 @@ client_d3d11_swapchain_wait_image(struct xrt_swapchain *xsc, int64_t timeout_ns,
 	// Pipe down call into imported swapchain in native compositor.
 	xrt_result_t xret = xrt_swapchain_wait_image(sc->xsc.get(), timeout_ns, index);
 
-	if (xret == XRT_SUCCESS) {
+	if (xret == XRT_SUCCESS && sc->c->sync_mode == xrt::compositor::client::SwapchainSyncMode::KeyedMutex) {
 		// OK, we got the image in the native compositor, now need the keyed mutex in d3d11.
 		xret = sc->data->keyed_mutex_collection.waitKeyedMutex(index, timeout_ns);
 	}
@@ -305,7 +311,7 @@ client_d3d11_swapchain_release_image(struct xrt_swapchain *xsc, uint32_t index)
 	// Pipe down call into imported swapchain in native compositor.
 	xrt_result_t xret = xrt_swapchain_release_image(sc->xsc.get(), index);
 
-	if (xret == XRT_SUCCESS) {
+	if (xret == XRT_SUCCESS && sc->c->sync_mode == xrt::compositor::client::SwapchainSyncMode::KeyedMutex) {
 		// Release the keyed mutex
 		xret = sc->data->keyed_mutex_collection.releaseKeyedMutex(index);
 	}
@@ -403,7 +409,8 @@ try {
 	std::unique_ptr<struct client_d3d11_swapchain> sc = std::make_unique<struct client_d3d11_swapchain>();
 	sc->data = std::make_unique<client_d3d11_swapchain_data>(c->log_level);
 	auto &data = sc->data;
-	xret = xrt::auxiliary::d3d::d3d11::allocateSharedImages(*(c->comp_device), xinfo, image_count, true,
+	bool keyed_mutex = c->sync_mode == xrt::compositor::client::SwapchainSyncMode::KeyedMutex;
+	xret = xrt::auxiliary::d3d::d3d11::allocateSharedImages(*(c->comp_device), xinfo, image_count, keyed_mutex,
 	                                                        data->comp_images, data->dxgi_handles);
 	if (xret != XRT_SUCCESS) {
 		return xret;
@@ -423,10 +430,12 @@ try {
 	}
 
 	// Cache the keyed mutex interface
-	xret = data->keyed_mutex_collection.init(data->app_images);
-	if (xret != XRT_SUCCESS) {
-		D3D_ERROR(c, "Error retrieving keyex mutex interfaces");
-		return xret;
+	if (keyed_mutex) {
+		xret = data->keyed_mutex_collection.init(data->app_images);
+		if (xret != XRT_SUCCESS) {
+			D3D_ERROR(c, "Error retrieving keyex mutex interfaces");
+			return xret;
+		}
 	}
 
 	// Import into the native compositor, to create the corresponding swapchain which we wrap.
@@ -867,6 +876,10 @@ try {
 	if (!c->fence) {
 		D3D_WARN(c, "No sync mechanism for D3D11 was successful!");
 	}
+
+	// Only drop the keyed mutexes when the native compositor waits on our fence.
+	c->sync_mode = xrt::compositor::client::chooseSwapchainSyncMode(!!c->timeline_semaphore, c->log_level);
+
 	c->base.base.get_swapchain_create_properties = client_d3d11_compositor_get_swapchain_create_properties;
 	c->base.base.create_swapchain = client_d3d11_create_swapchain;
 	c->base.base.create_passthrough = client_d3d11_compositor_passthrough_create;
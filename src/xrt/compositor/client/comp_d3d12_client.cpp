@@ -24,6 +24,7 @@
 #include "d3d/d3d_d3d12_fence.hpp"
 #include "d3d/d3d_d3d12_bits.h"
 #include "d3d/d3d_d3d12_allocator.hpp"
+#include "d3d/d3d_dxgi_helpers.hpp"
 #include "util/u_misc.h"
 #include "util/u_pretty_print.h"
 #include "util/u_time.h"
@@ -51,7 +52,7 @@ using namespace std::chrono;
 DEBUG_GET_ONCE_LOG_OPTION(log, "D3D_COMPOSITOR_LOG", U_LOGGING_INFO)
 
 DEBUG_GET_ONCE_BOOL_OPTION(barriers, "D3D12_COMPOSITOR_BARRIERS", false);
-DEBUG_GET_ONCE_BOOL_OPTION(compositor_copy, "D3D12_COMPOSITOR_COPY", true);
+DEBUG_GET_ONCE_TRISTATE_OPTION(compositor_copy, "D3D12_COMPOSITOR_COPY");
 
 /*!
  * Spew level logging.
@@ -157,6 +158,12 @@ struct client_d3d12_compositor
 	 * The value most recently signaled on the timeline semaphore
 	 */
 	uint64_t timeline_semaphore_value = 0;
+
+	/*!
+	 * The driver might lay out small images differently in D3D12 and
+	 * Vulkan, those swapchains are then copied to compositor images.
+	 */
+	bool copy_small_images = true;
 };
 
 static_assert(std::is_standard_layout<client_d3d12_compositor>::value);
@@ -304,6 +311,63 @@ formatMessage(DWORD err, char (&buf)[N])
  *
  */
 
+/*!
+ * Vendors whose drivers agree on the memory layout of all images between D3D12
+ * and Vulkan, their app images are always handed directly to the native
+ * compositor. NVIDIA is known to need the copy, unknown vendors get it too.
+ */
+static const struct
+{
+	uint32_t vendor_id;
+	const char *name;
+} kDirectSharingVendors[] = {
+    {0x1002, "AMD"},
+    {0x8086, "Intel"},
+    {0x1414, "Microsoft"},
+};
+
+/*!
+ * Decide if swapchains with small non power of two images need the copy
+ * workaround, going by the vendor of the adapter the app's device is on unless
+ * forced with the D3D12_COMPOSITOR_COPY option.
+ */
+static bool
+client_d3d12_needs_copy_small_images(struct client_d3d12_compositor *c)
+{
+	switch (debug_get_tristate_option_compositor_copy()) {
+	case DEBUG_TRISTATE_ON: return true;
+	case DEBUG_TRISTATE_OFF: return false;
+	default: break;
+	}
+
+	static_assert(sizeof(LUID) == sizeof(xrt_luid_t), "LUID size mismatch");
+	LUID luid = c->device->GetAdapterLuid();
+	xrt_luid_t xluid{};
+	memcpy(xluid.data, &luid, sizeof(xluid.data));
+
+	DXGI_ADAPTER_DESC desc{};
+	try {
+		wil::com_ptr<IDXGIAdapter> adapter = xrt::auxiliary::d3d::getAdapterByLUID(xluid, c->log_level);
+		if (!adapter || FAILED(adapter->GetDesc(&desc))) {
+			D3D_WARN(c, "Could not get the adapter of the device, copying small images");
+			return true;
+		}
+	} catch (wil::ResultException const &e) {
+		D3D_WARN(c, "Could not get the adapter of the device, copying small images: %s", e.what());
+		return true;
+	}
+
+	for (const auto &vendor : kDirectSharingVendors) {
+		if (vendor.vendor_id == desc.VendorId) {
+			D3D_INFO(c, "%s adapter, sharing all images directly with the compositor", vendor.name);
+			return false;
+		}
+	}
+
+	D3D_INFO(c, "Adapter vendor 0x%04x, copying small images to the compositor", desc.VendorId);
+	return true;
+}
+
 static xrt_result_t
 client_d3d12_swapchain_barrier_to_app(client_d3d12_swapchain *sc, uint32_t index)
 {
@@ -532,7 +596,25 @@ try {
 
 	data->state.resize(image_count, appResourceState);
 
-	if (debug_get_bool_option_barriers()) {
+	/*
+	 * There is a bug in nvidia systems where D3D12 and Vulkan disagree on the memory layout
+	 * of smaller images, this causes the native compositor to not display these swapchains
+	 * correctly.
+	 *
+	 * The workaround for this is to create a second set of images for use in the native
+	 * compositor and copy the contents from the app image into the compositor image every
+	 * time the swapchain is released by the app. Drivers known not to have this issue use the
+	 * app images directly, see @ref client_d3d12_needs_copy_small_images.
+	 */
+	bool fixWidth = info->width < 256 && !isPowerOfTwo(info->width);
+	bool fixHeight = info->height < 256 && !isPowerOfTwo(info->height);
+	bool compositorNeedsCopy = c->copy_small_images && (fixWidth || fixHeight);
+
+	/*
+	 * The copy command lists already transition the app images to and from the copy source state
+	 * and the native compositor never sees them, so no separate barriers are needed.
+	 */
+	if (debug_get_bool_option_barriers() && !compositorNeedsCopy) {
 		D3D_INFO(c, "Will use barriers at runtime");
 		data->commandsToApp.reserve(image_count);
 		data->commandsToCompositor.reserve(image_count);
@@ -562,22 +644,6 @@ try {
 		}
 	}
 
-
-	/*
-	 * There is a bug in nvidia systems where D3D12 and Vulkan disagree on the memory layout
-	 * of smaller images, this causes the native compositor to not display these swapchains
-	 * correctly.
-	 *
-	 * The workaround for this is to create a second set of images for use in the native
-	 * compositor and copy the contents from the app image into the compositor image every
-	 * time the swapchain is released by the app.
-	 *
-	 * @todo: check if AMD and Intel platforms have this issue as well.
-	 */
-	bool fixWidth = info->width < 256 && !isPowerOfTwo(info->width);
-	bool fixHeight = info->height < 256 && !isPowerOfTwo(info->height);
-	bool compositorNeedsCopy = debug_get_bool_option_compositor_copy() && (fixWidth || fixHeight);
-
 	if (compositorNeedsCopy) {
 		// These bits doesn't matter for D3D12, just set it to something.
 		xinfo.bits = XRT_SWAPCHAIN_USAGE_SAMPLED;
@@ -1019,6 +1085,8 @@ client_d3d12_compositor_init_try_timeline_semaphores(struct client_d3d12_composi
 {
 	c->timeline_semaphore_value = 1;
 
+	c->copy_small_images = client_d3d12_needs_copy_small_images(c.get());
+
 	// See if we can make a "timeline semaphore", also known as ID3D12Fence
 	if (!c->xcn->base.create_semaphore || !c->xcn->base.layer_commit_with_semaphore) {
 		return;
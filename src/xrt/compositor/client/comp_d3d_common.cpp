@@ -10,6 +10,7 @@
 
 #include "comp_d3d_common.hpp"
 
+#include "util/u_debug.h"
 #include "util/u_logging.h"
 #include "util/u_time.h"
 
@@ -25,6 +26,8 @@
 
 #define D3D_COMMON_ERROR(log_level, ...) U_LOG_IFL_E(log_level, __VA_ARGS__);
 
+DEBUG_GET_ONCE_BOOL_OPTION(force_keyed_mutex, "D3D_FORCE_KEYED_MUTEX", false)
+
 namespace xrt::compositor::client {
 
 static inline DWORD
@@ -33,6 +36,23 @@ convertTimeoutToWindowsMilliseconds(uint64_t timeout_ns)
 	return (timeout_ns == XRT_INFINITE_DURATION) ? INFINITE : (DWORD)(timeout_ns / (uint64_t)U_TIME_1MS_IN_NS);
 }
 
+SwapchainSyncMode
+chooseSwapchainSyncMode(bool have_shared_fence, u_logging_level log_level) noexcept
+{
+	if (debug_get_bool_option_force_keyed_mutex()) {
+		D3D_COMMON_INFO(log_level, "Forced to use keyed mutexes for swapchain images.");
+		return SwapchainSyncMode::KeyedMutex;
+	}
+
+	if (!have_shared_fence) {
+		D3D_COMMON_INFO(log_level, "No fence shared with the native compositor, using keyed mutexes.");
+		return SwapchainSyncMode::KeyedMutex;
+	}
+
+	D3D_COMMON_INFO(log_level, "Using the shared fence for swapchain images, no keyed mutexes.");
+	return SwapchainSyncMode::SharedFence;
+}
+
 KeyedMutexCollection::KeyedMutexCollection(u_logging_level log_level) noexcept : log_level(log_level) {}
 
 xrt_result_t
@@ -136,6 +136,32 @@ importFromDxgiHandles(xrt_compositor_native &xcn,
 	return XRT_SUCCESS;
 }
 
+/**
+ * How ownership of swapchain images is handed between the app and the native compositor.
+ */
+enum class SwapchainSyncMode
+{
+	//! Acquire and release a DXGI keyed mutex per image, serializes CPU and GPU.
+	KeyedMutex,
+
+	/**
+	 * Rely on the timeline fence shared with the native compositor: it waits on the fence value signalled at
+	 * commit before reading the images, and only hands images back when it is done with them.
+	 */
+	SharedFence,
+};
+
+/**
+ * Pick the swapchain synchronization mode, prefers @ref SwapchainSyncMode::SharedFence.
+ *
+ * Can be forced to keyed mutexes with the `D3D_FORCE_KEYED_MUTEX` environment variable.
+ *
+ * @param have_shared_fence True if the native compositor waits for our commits on a fence we signal.
+ * @param log_level The compositor log level to use
+ */
+SwapchainSyncMode
+chooseSwapchainSyncMode(bool have_shared_fence, u_logging_level log_level) noexcept;
+
 /**
  * A collection of DXGIKeyedMutex objects, one for each swapchain image in a swapchain.
  *
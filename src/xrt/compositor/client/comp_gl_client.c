@@ -27,6 +27,7 @@
 
 #include "client/comp_gl_client.h"
 
+#include "util/u_handles.h"
 #include "util/u_logging.h"
 #include "util/u_trace_marker.h"
 
@@ -109,11 +110,90 @@ vk_format_to_gl(int64_t format)
 	}
 }
 
+/*!
+ * Imports a timeline semaphore from the native compositor, so that commits can
+ * be signalled from the GPU instead of waiting on it with glFinish.
+ *
+ * Called with the right context made current.
+ */
+static void
+setup_semaphore(struct client_gl_compositor *c)
+{
+#if defined(XRT_GRAPHICS_SYNC_HANDLE_IS_FD)
+	xrt_graphics_sync_handle_t handle = XRT_GRAPHICS_SYNC_HANDLE_INVALID;
+	struct xrt_compositor_semaphore *xcsem = NULL;
+	xrt_result_t xret;
+
+	if (!GLAD_GL_EXT_semaphore || !GLAD_GL_EXT_semaphore_fd || !GLAD_GL_NV_timeline_semaphore) {
+		return;
+	}
+
+	if (c->xcn->base.create_semaphore == NULL) {
+		return;
+	}
+
+	xret = xrt_comp_create_semaphore(&c->xcn->base, &handle, &xcsem);
+	if (xret != XRT_SUCCESS) {
+		U_LOG_W("Failed to create semaphore, falling back to glFinish!");
+		return;
+	}
+
+	GLuint semaphore = 0;
+	GLint type = GL_SEMAPHORE_TYPE_TIMELINE_NV;
+	glCreateSemaphoresNV(1, &semaphore);
+	glSemaphoreParameterivNV(semaphore, GL_SEMAPHORE_TYPE_NV, &type);
+
+	// The import takes ownership of the fd on success.
+	glImportSemaphoreFdEXT(semaphore, GL_HANDLE_TYPE_OPAQUE_FD_EXT, handle);
+
+	GLenum err = glGetError();
+	if (err != GL_NO_ERROR || !glIsSemaphoreEXT(semaphore)) {
+		U_LOG_W("Failed to import semaphore (0x%04x), falling back to glFinish!", err);
+		glDeleteSemaphoresEXT(1, &semaphore);
+		u_graphics_sync_unref(&handle);
+		xrt_compositor_semaphore_reference(&xcsem, NULL);
+		return;
+	}
+
+	c->sync.semaphore = semaphore;
+	c->sync.xcsem = xcsem; // No need to reference.
+	c->sync.value = 0;
+#endif
+}
+
+/*!
+ * Signals the next value of the timeline semaphore, returns false if there is
+ * no semaphore to signal.
+ *
+ * Called with the right context made current.
+ */
+static bool
+handle_semaphore(struct client_gl_compositor *c, uint64_t *out_value)
+{
+	if (c->sync.xcsem == NULL) {
+		return false;
+	}
+
+	COMP_TRACE_IDENT(semaphore);
+
+	GLuint64 value = ++(c->sync.value);
+	glSemaphoreParameterui64vEXT(c->sync.semaphore, GL_TIMELINE_SEMAPHORE_VALUE_NV, &value);
+	// No barriers, the images are handled the same way as with the fence path.
+	glSignalSemaphoreEXT(c->sync.semaphore, 0, NULL, 0, NULL, NULL);
+
+	// Make sure the signal operation reaches the GPU.
+	glFlush();
+
+	*out_value = value;
+
+	return true;
+}
+
 /*!
  * Called with the right context made current.
  */
 static xrt_graphics_sync_handle_t
-handle_fencing_or_finish(struct client_gl_compositor *c)
+handle_fencing_or_finish(struct client_gl_compositor *c, uint64_t *out_semaphore_value)
 {
 	xrt_graphics_sync_handle_t sync_handle = XRT_GRAPHICS_SYNC_HANDLE_INVALID;
 	xrt_result_t xret = XRT_SUCCESS;
@@ -127,7 +207,12 @@ handle_fencing_or_finish(struct client_gl_compositor *c)
 		}
 	}
 
-	// Fallback to glFinish if we haven't inserted a fence.
+	// Then try the semaphore, the native compositor waits on it.
+	if (sync_handle == XRT_GRAPHICS_SYNC_HANDLE_INVALID && handle_semaphore(c, out_semaphore_value)) {
+		return sync_handle;
+	}
+
+	// Fallback to glFinish if we haven't inserted a fence or signalled a semaphore.
 	if (sync_handle == XRT_GRAPHICS_SYNC_HANDLE_INVALID) {
 		COMP_TRACE_IDENT(glFinish);
 
@@ -403,15 +488,21 @@ client_gl_compositor_layer_commit(struct xrt_compositor *xc, xrt_graphics_sync_h
 	assert(!xrt_graphics_sync_handle_is_valid(sync_handle));
 
 	sync_handle = XRT_GRAPHICS_SYNC_HANDLE_INVALID;
+	uint64_t semaphore_value = 0;
 
 	xrt_result_t xret = client_gl_compositor_context_begin(xc, CLIENT_GL_CONTEXT_REASON_SYNCHRONIZE);
 	if (xret == XRT_SUCCESS) {
-		sync_handle = handle_fencing_or_finish(c);
+		sync_handle = handle_fencing_or_finish(c, &semaphore_value);
 		client_gl_compositor_context_end(xc, CLIENT_GL_CONTEXT_REASON_SYNCHRONIZE);
 	}
 
 	COMP_TRACE_IDENT(layer_commit);
 
+	// Semaphore values start at one, zero means no semaphore was signalled.
+	if (semaphore_value != 0) {
+		return xrt_comp_layer_commit_with_semaphore(&c->xcn->base, c->sync.xcsem, semaphore_value);
+	}
+
 	return xrt_comp_layer_commit(&c->xcn->base, sync_handle);
 }
 
@@ -580,6 +671,10 @@ client_gl_compositor_destroy(struct xrt_compositor *xc)
 void
 client_gl_compositor_fini(struct client_gl_compositor *c)
 {
+	// The GL semaphore object is destroyed along with the context.
+	c->sync.semaphore = 0;
+	xrt_compositor_semaphore_reference(&c->sync.xcsem, NULL);
+
 	os_mutex_destroy(&c->context_mutex);
 }
 
@@ -644,6 +739,8 @@ client_gl_compositor_init(struct client_gl_compositor *c,
 		c->base.base.info.max_texture_size = (uint32_t)max_texture_size;
 	}
 
+	setup_semaphore(c);
+
 	os_mutex_init(&c->context_mutex);
 
 	return true;
@@ -165,6 +165,18 @@ struct client_gl_compositor
 	 */
 	client_gl_insert_fence_func_t insert_fence;
 
+	/*!
+	 * Timeline semaphore imported from the native compositor, used
+	 * instead of glFinish when no fence could be inserted.
+	 */
+	struct
+	{
+		//! GL semaphore object name, zero if not used.
+		uint32_t semaphore;
+		struct xrt_compositor_semaphore *xcsem;
+		uint64_t value;
+	} sync;
+
 	/*!
 	 * @ref client_gl_xlib_compositor::app_context can only be current on one thread; block other threads while we
 	 * know it is bound to a thread.
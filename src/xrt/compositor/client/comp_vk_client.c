@@ -88,6 +88,76 @@ submit_image_barrier(struct client_vk_swapchain *sc, VkCommandBuffer cmd_buffer)
 	return XRT_SUCCESS;
 }
 
+/*!
+ * Submits all pending release barriers in one submit.
+ *
+ * @pre The lock for the command pool must be held.
+ */
+static VkResult
+flush_pending_releases_locked(struct client_vk_compositor *c)
+{
+	struct vk_bundle *vk = &c->vk;
+	VkResult ret;
+
+	if (c->pending_releases.count == 0) {
+		return VK_SUCCESS;
+	}
+
+	COMP_TRACE_MARKER();
+
+	VkSubmitInfo submit_info = {
+	    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+	    .commandBufferCount = c->pending_releases.count,
+	    .pCommandBuffers = c->pending_releases.cmds,
+	};
+
+	ret = vk_cmd_submit_locked(vk, c->pool.queue, 1, &submit_info, VK_NULL_HANDLE);
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vk_cmd_submit_locked: %s %u", vk_result_string(ret), ret);
+	}
+
+	// Even on failure, don't submit them again.
+	c->pending_releases.count = 0;
+
+	return ret;
+}
+
+static VkResult
+flush_pending_releases(struct client_vk_compositor *c)
+{
+	vk_cmd_pool_lock(&c->pool);
+	VkResult ret = flush_pending_releases_locked(c);
+	vk_cmd_pool_unlock(&c->pool);
+
+	return ret;
+}
+
+/*!
+ * Queues up a release barrier, it is submitted at the latest in layer_commit.
+ */
+static xrt_result_t
+queue_release_barrier(struct client_vk_swapchain *sc, VkCommandBuffer cmd_buffer)
+{
+	struct client_vk_compositor *c = sc->c;
+	VkResult ret = VK_SUCCESS;
+
+	vk_cmd_pool_lock(&c->pool);
+
+	if (c->pending_releases.count >= ARRAY_SIZE(c->pending_releases.cmds)) {
+		ret = flush_pending_releases_locked(c);
+	}
+
+	c->pending_releases.cmds[c->pending_releases.count++] = cmd_buffer;
+
+	vk_cmd_pool_unlock(&c->pool);
+
+	if (ret != VK_SUCCESS) {
+		return XRT_ERROR_FAILED_TO_SUBMIT_VULKAN_COMMANDS;
+	}
+
+	return XRT_SUCCESS;
+}
+
 
 /*
  *
@@ -144,6 +214,9 @@ submit_handle(struct client_vk_compositor *c, xrt_graphics_sync_handle_t sync_ha
 		return false;
 	}
 
+	// The release barriers still need to be done, errors are logged.
+	(void)flush_pending_releases(c);
+
 	// Commit consumes the sync_handle.
 	*out_xret = xrt_comp_layer_commit(&c->xcn->base, sync_handle);
 	return true;
@@ -174,20 +247,26 @@ submit_semaphore(struct client_vk_compositor *c, xrt_result_t *out_xret)
 	    .signalSemaphoreValueCount = ARRAY_SIZE(values),
 	    .pSignalSemaphoreValues = values,
 	};
+
+	vk_cmd_pool_lock(&c->pool);
+
+	// The release barriers go in the same submit as the semaphore signal.
 	VkSubmitInfo submit_info = {
 	    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
 	    .pNext = &semaphore_submit_info,
+	    .commandBufferCount = c->pending_releases.count,
+	    .pCommandBuffers = c->pending_releases.cmds,
 	    .signalSemaphoreCount = ARRAY_SIZE(semaphores),
 	    .pSignalSemaphores = semaphores,
 	};
 
-	ret = vk->vkQueueSubmit(  //
-	    vk->main_queue.queue, // queue
-	    1,                    // submitCount
-	    &submit_info,         // pSubmits
-	    VK_NULL_HANDLE);      // fence
+	ret = vk_cmd_submit_locked(vk, c->pool.queue, 1, &submit_info, VK_NULL_HANDLE);
+	c->pending_releases.count = 0;
+
+	vk_cmd_pool_unlock(&c->pool);
+
 	if (ret != VK_SUCCESS) {
-		VK_ERROR(vk, "vkQueueSubmit: %s", vk_result_string(ret));
+		VK_ERROR(vk, "vk_cmd_submit_locked: %s", vk_result_string(ret));
 		*out_xret = XRT_ERROR_VULKAN;
 		return true;
 	}
@@ -223,6 +302,9 @@ submit_fence(struct client_vk_compositor *c, xrt_result_t *out_xret)
 		return false;
 	}
 
+	// Flush the release barriers before the fence, errors are logged.
+	(void)flush_pending_releases(c);
+
 	{
 		COMP_TRACE_IDENT(create_and_submit_fence);
 
@@ -244,6 +326,9 @@ submit_fallback(struct client_vk_compositor *c, xrt_result_t *out_xret)
 {
 	struct vk_bundle *vk = &c->vk;
 
+	// Submit the release barriers before waiting, errors are logged.
+	(void)flush_pending_releases(c);
+
 	{
 		COMP_TRACE_IDENT(device_wait_idle);
 
@@ -273,6 +358,22 @@ client_vk_swapchain_destroy(struct xrt_swapchain *xsc)
 	struct client_vk_compositor *c = sc->c;
 	struct vk_bundle *vk = &c->vk;
 
+	// Drop any release barriers not yet submitted for this swapchain.
+	vk_cmd_pool_lock(&c->pool);
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < c->pending_releases.count; i++) {
+		VkCommandBuffer cmd_buffer = c->pending_releases.cmds[i];
+		bool ours = false;
+		for (uint32_t k = 0; k < sc->base.base.image_count; k++) {
+			ours = ours || sc->release[k] == cmd_buffer;
+		}
+		if (!ours) {
+			c->pending_releases.cmds[count++] = cmd_buffer;
+		}
+	}
+	c->pending_releases.count = count;
+	vk_cmd_pool_unlock(&c->pool);
+
 	// Make sure images are not used anymore.
 	if (BREAK_OPENXR_SPEC_IN_DESTROY_SWAPCHAIN) {
 		os_mutex_lock(&vk->queue_mutex);
@@ -338,7 +439,9 @@ client_vk_swapchain_barrier_image(struct xrt_swapchain *xsc, enum xrt_barrier_di
 
 	switch (direction) {
 	case XRT_BARRIER_TO_APP: cmd_buffer = sc->acquire[index]; break;
-	case XRT_BARRIER_TO_COMP: cmd_buffer = sc->release[index]; break;
+	case XRT_BARRIER_TO_COMP:
+		// Batched with the other releases of this frame.
+		return queue_release_barrier(sc, sc->release[index]);
 	default: assert(false);
 	}
 
@@ -20,6 +20,19 @@ extern "C" {
 #endif
 
 
+/*
+ *
+ * Defines
+ *
+ */
+
+/*!
+ * Max number of swapchain image release barriers that are batched up before
+ * @ref xrt_compositor::layer_commit, flushed early if more are released.
+ */
+#define CLIENT_VK_MAX_PENDING_RELEASES (64)
+
+
 /*
  *
  * Structs
@@ -80,6 +93,17 @@ struct client_vk_compositor
 
 	struct vk_cmd_pool pool;
 
+	/*!
+	 * Prerecorded release barriers of swapchain images released this
+	 * frame, submitted together with the commit. Protected by the lock of
+	 * @ref pool.
+	 */
+	struct
+	{
+		VkCommandBuffer cmds[CLIENT_VK_MAX_PENDING_RELEASES];
+		uint32_t count;
+	} pending_releases;
+
 	bool renderdoc_enabled;
 	VkCommandBuffer dcb;
 };
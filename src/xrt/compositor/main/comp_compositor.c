@@ -268,13 +268,36 @@ compositor_discard_frame(struct xrt_compositor *xc, int64_t frame_id)
 static bool
 can_do_one_projection_layer_fast_path(struct comp_compositor *c)
 {
-	if (c->base.layer_accum.layer_count != 1) {
+	uint32_t layer_count = c->base.layer_accum.layer_count;
+	if (layer_count < 1) {
 		return false;
 	}
 
+	/*
+	 * The compute distortion shader can blend a few quads on top of the
+	 * projection layer, as long as they are seen by both eyes.
+	 */
+	if (layer_count > 1) {
+		if (!c->settings.use_compute || layer_count - 1 > RENDER_DISTORTION_MAX_QUADS) {
+			return false;
+		}
+
+		for (uint32_t i = 1; i < layer_count; i++) {
+			const struct xrt_layer_data *data = &c->base.layer_accum.layers[i].data;
+			if (data->type != XRT_LAYER_QUAD || data->quad.visibility != XRT_LAYER_EYE_VISIBILITY_BOTH) {
+				return false;
+			}
+		}
+	}
+
 	struct comp_layer *layer = &c->base.layer_accum.layers[0];
 	enum xrt_layer_type type = layer->data.type;
 
+	// The distortion shader can only do rotational timewarp.
+	if (type == XRT_LAYER_PROJECTION_DEPTH && c->settings.use_depth_reprojection && !c->debug.atw_off) {
+		return false;
+	}
+
 	// Handled by the distortion shader.
 	return type == XRT_LAYER_PROJECTION || //
 	       type == XRT_LAYER_PROJECTION_DEPTH;
@@ -290,8 +313,24 @@ compositor_layer_commit(struct xrt_compositor *xc, xrt_graphics_sync_handle_t sy
 	COMP_SPEW(c, "LAYER_COMMIT at %8.3fms", ts_ms());
 
 	/*
-	 * We have a fast path for single projection layer that goes directly
-	 * to the distortion shader, so no need to use the layer renderer.
+	 * Drop layers that would not be seen, done before checking for the fast
+	 * path as a fully covered layer below a projection layer may be all that
+	 * is keeping us from taking it. The renderer uses the distortion fovs.
+	 */
+	if (!c->debug.disable_layer_cull) {
+		uint32_t culled = comp_layer_accum_cull( //
+		    &c->base.layer_accum,                //
+		    c->xdev->hmd->distortion.fov,        // fovs
+		    (uint32_t)c->xdev->hmd->view_count); // view_count
+		if (culled > 0) {
+			COMP_SPEW(c, "LAYER_COMMIT culled %u layers", culled);
+		}
+	}
+
+	/*
+	 * We have a fast path for single projection layer, optionally with a
+	 * few quads on top, that goes directly to the distortion shader, so no
+	 * need to use the layer renderer.
 	 */
 	bool fast_path =                              //
 	    !c->peek &&                               //
@@ -506,6 +545,9 @@ static const char *optional_instance_extensions[] = {
 #ifdef VK_EXT_display_surface_counter
     VK_EXT_DISPLAY_SURFACE_COUNTER_EXTENSION_NAME,
 #endif
+#ifdef VK_KHR_get_surface_capabilities2
+    VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME,
+#endif
 #if defined VK_EXT_debug_utils && !defined NDEBUG
     VK_EXT_DEBUG_UTILS_EXTENSION_NAME,
 #endif
@@ -576,6 +618,9 @@ static const char *optional_device_extensions[] = {
 #ifdef VK_KHR_present_wait
     VK_KHR_PRESENT_WAIT_EXTENSION_NAME,
 #endif
+#ifdef VK_KHR_shared_presentable_image
+    VK_KHR_SHARED_PRESENTABLE_IMAGE_EXTENSION_NAME,
+#endif
 #ifdef VK_KHR_format_feature_flags2
     VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME,
 #endif
@@ -591,6 +636,9 @@ static const char *optional_device_extensions[] = {
 #ifdef VK_KHR_maintenance2
     VK_KHR_MAINTENANCE_2_EXTENSION_NAME,
 #endif
+#ifdef VK_KHR_push_descriptor
+    VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME,
+#endif
 #ifdef VK_KHR_timeline_semaphore
     VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME,
 #endif
@@ -600,12 +648,21 @@ static const char *optional_device_extensions[] = {
 #ifdef VK_EXT_robustness2
     VK_EXT_ROBUSTNESS_2_EXTENSION_NAME,
 #endif
+#ifdef VK_EXT_image_compression_control
+    VK_EXT_IMAGE_COMPRESSION_CONTROL_EXTENSION_NAME,
+#endif
 #ifdef VK_EXT_display_control
     VK_EXT_DISPLAY_CONTROL_EXTENSION_NAME,
 #endif
+#ifdef VK_EXT_present_timing
+    VK_EXT_PRESENT_TIMING_EXTENSION_NAME,
+#endif
 #ifdef VK_KHR_synchronization2
     VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME,
 #endif
+#if defined(XRT_GRAPHICS_BUFFER_HANDLE_IS_FD) && defined(VK_EXT_external_memory_dma_buf)
+    VK_EXT_EXTERNAL_MEMORY_DMA_BUF_EXTENSION_NAME,
+#endif
 };
 
 static bool
@@ -703,8 +760,10 @@ compositor_init_vulkan(struct comp_compositor *c)
 	    .optional_device_extensions = optional_device_extension_list,
 	    .log_level = c->settings.log_level,
 	    .only_compute_queue = c->settings.use_compute,
+	    .compute_queue = c->settings.use_async_compute,
 	    .selected_gpu_index = c->settings.selected_gpu_index,
 	    .client_gpu_index = c->settings.client_gpu_index,
+	    .use_display_gpu = c->settings.use_display_gpu,
 	    .timeline_semaphore = true, // Flag is optional, not a hard requirement.
 	};
 
@@ -1166,6 +1225,10 @@ comp_main_create_system_compositor(struct xrt_device *xdev,
 	u_var_add_ro_f32(c, &c->compositor_frame_times.fps, "FPS (Compositor)");
 	u_var_add_bool(c, &c->debug.atw_off, "Debug: ATW OFF");
 	u_var_add_bool(c, &c->debug.disable_fast_path, "Debug: Disable fast path");
+	u_var_add_bool(c, &c->settings.use_depth_reprojection, "Depth reprojection (compute only)");
+	u_var_add_f32(c, &c->settings.foveation_degrees, "Foveation degrees (compute only, 0 is off)");
+	u_var_add_bool(c, &c->debug.disable_layer_cull, "Debug: Disable layer culling");
+	u_var_add_bool(c, &c->scratch.cache.disabled, "Debug: Disable squash cache");
 	u_var_add_f32_timing(c, c->compositor_frame_times.debug_var, "Frame Times (Compositor)");
 
 	// Only add active views.
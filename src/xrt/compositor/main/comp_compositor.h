@@ -156,6 +156,9 @@ struct comp_compositor
 		//! Should the fast path be disabled.
 		bool disable_fast_path;
 
+		//! Should culling of layers that can't be seen be disabled.
+		bool disable_layer_cull;
+
 		struct u_swapchain_debug sc;
 	} debug;
 
@@ -1,4 +1,4 @@
-// Copyright 2019-2023, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -10,9 +10,20 @@
 
 #include "xrt/xrt_results.h"
 #include "math/m_mathinclude.h"
+#include "util/u_debug.h"
 #include "main/comp_mirror_to_debug_gui.h"
 
 
+/*!
+ * Export the readback images as DMABUFs, lets recording and streaming
+ * pipelines hand them to hardware encoders without a CPU copy.
+ */
+DEBUG_GET_ONCE_BOOL_OPTION(mirror_dmabuf, "XRT_COMPOSITOR_MIRROR_DMABUF", false)
+
+//! Height of the readback images, the compute blit scales to this on the GPU.
+DEBUG_GET_ONCE_NUM_OPTION(mirror_height, "XRT_COMPOSITOR_MIRROR_HEIGHT", 1080)
+
+
 /*
  *
  * Helper functions.
@@ -252,6 +263,56 @@ calc_dispatch_dims(const VkExtent2D extent, uint32_t *out_w, uint32_t *out_h)
 }
 
 
+static void
+release_wrap(struct vk_image_readback_to_xf *wrap)
+{
+	struct xrt_frame *frame = &wrap->base_frame;
+	xrt_frame_reference(&frame, NULL);
+}
+
+/*!
+ * Called on the readback pool's thread as soon as the GPU is done, so the
+ * compositor thread never waits for it.
+ */
+static void
+readback_done(struct vk_image_readback_to_xf *wrap, void *user_data)
+{
+	struct comp_mirror_to_debug_gui *m = (struct comp_mirror_to_debug_gui *)user_data;
+
+	u_sink_debug_push_frame(&m->debug_sink, &wrap->base_frame);
+	u_frame_times_widget_push_sample(&m->push_frame_times, wrap->base_frame.timestamp);
+}
+
+static VkResult
+get_descriptor_set(struct comp_mirror_to_debug_gui *m, struct vk_bundle *vk, uint32_t index, VkDescriptorSet *out_set)
+{
+	VkResult ret;
+
+	if (m->blit.descriptor_sets[index] != VK_NULL_HANDLE) {
+		*out_set = m->blit.descriptor_sets[index];
+		return VK_SUCCESS;
+	}
+
+	VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+	ret = vk_create_descriptor_set(    //
+	    vk,                            //
+	    m->blit.descriptor_pool,       // descriptor_pool
+	    m->blit.descriptor_set_layout, // descriptor_set_layout
+	    &descriptor_set);              // descriptor_set
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vk_create_descriptor_set: %s", vk_result_string(ret));
+		return ret;
+	}
+
+	VK_NAME_DESCRIPTOR_SET(vk, descriptor_set, "comp_mirror_to_debug_ui blit descriptor set");
+
+	m->blit.descriptor_sets[index] = descriptor_set;
+	*out_set = descriptor_set;
+
+	return VK_SUCCESS;
+}
+
+
 /*
  *
  * 'Exported' functions.
@@ -272,7 +333,11 @@ comp_mirror_init(struct comp_mirror_to_debug_gui *m,
 	double orig_width = extent.width;
 	double orig_height = extent.height;
 
-	double target_height = 1080;
+	// Smaller images are cheaper to read back and to encode, never scale up.
+	double target_height = (double)debug_get_num_option_mirror_height();
+	if (target_height < 2 || target_height > orig_height) {
+		target_height = orig_height;
+	}
 
 	double mul = target_height / orig_height;
 
@@ -285,13 +350,25 @@ comp_mirror_init(struct comp_mirror_to_debug_gui *m,
 	if (m->image_extent.width % 2 == 1) {
 		m->image_extent.width += 1;
 	}
+	if (m->image_extent.height % 2 == 1) {
+		m->image_extent.height += 1;
+	}
+
+	bool export_dmabuf = debug_get_bool_option_mirror_dmabuf();
 
 	vk_image_readback_to_xf_pool_create( //
 	    vk,                              // vk_bundle
 	    m->image_extent,                 // extent
 	    &m->pool,                        // out_pool
 	    XRT_FORMAT_R8G8B8X8,             // xrt_format
-	    VK_FORMAT_R8G8B8A8_UNORM);       // vk_format
+	    VK_FORMAT_R8G8B8A8_UNORM,        // vk_format
+	    export_dmabuf);                  // export_dmabuf
+
+	// Pushes the frames to the debug sink as soon as they are read back.
+	if (!vk_image_readback_to_xf_pool_start_async(vk, m->pool, readback_done, m)) {
+		comp_mirror_fini(m, vk);
+		return VK_ERROR_INITIALIZATION_FAILED;
+	}
 
 	ret = vk_cmd_pool_init(vk, &m->cmd_pool, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
 	if (ret != VK_SUCCESS) {
@@ -307,7 +384,7 @@ comp_mirror_init(struct comp_mirror_to_debug_gui *m,
 	    .sampler_per_descriptor_count = 1,
 	    .storage_image_per_descriptor_count = 1,
 	    .storage_buffer_per_descriptor_count = 0,
-	    .descriptor_count = 1,
+	    .descriptor_count = READBACK_POOL_NUM_FRAMES,
 	    .freeable = false,
 	};
 
@@ -365,6 +442,7 @@ comp_mirror_add_debug_vars(struct comp_mirror_to_debug_gui *m, struct comp_compo
 
 	u_var_add_ro_f32(m, &m->push_frame_times.fps, "FPS (Readback)");
 	u_var_add_f32_timing(m, m->push_frame_times.debug_var, "Frame Times (Readback)");
+	u_var_add_ro_u64(m, &m->skipped_frames, "Skipped frames");
 
 	u_var_add_sink_debug(m, &m->debug_sink, "Left view!");
 }
@@ -428,27 +506,22 @@ comp_mirror_do_blit(struct comp_mirror_to_debug_gui *m,
 
 	struct vk_image_readback_to_xf *wrap = NULL;
 
+	// The consumer is holding on to all of the frames, skip this one.
 	if (!vk_image_readback_to_xf_pool_get_unused_frame(vk, m->pool, &wrap)) {
-		return XRT_ERROR_VULKAN;
+		m->skipped_frames++;
+		return XRT_SUCCESS;
 	}
 
 	if (!ensure_scratch(m, vk)) {
-		return XRT_ERROR_VULKAN;
+		goto err_frame;
 	}
 
 	VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
-	ret = vk_create_descriptor_set(    //
-	    vk,                            //
-	    m->blit.descriptor_pool,       // descriptor_pool
-	    m->blit.descriptor_set_layout, // descriptor_set_layout
-	    &descriptor_set);              // descriptor_set
+	ret = get_descriptor_set(m, vk, wrap->index, &descriptor_set);
 	if (ret != VK_SUCCESS) {
-		VK_ERROR(vk, "vk_create_descriptor_set: %s", vk_result_string(ret));
-		return XRT_ERROR_VULKAN;
+		goto err_frame;
 	}
 
-	VK_NAME_DESCRIPTOR_SET(vk, descriptor_set, "comp_mirror_to_debug_ui blit descriptor set");
-
 	struct vk_cmd_pool *pool = &m->cmd_pool;
 
 	// For writing and submitting commands.
@@ -457,13 +530,17 @@ comp_mirror_do_blit(struct comp_mirror_to_debug_gui *m,
 	VkCommandBuffer cmd;
 	ret = vk_cmd_pool_create_and_begin_cmd_buffer_locked(vk, pool, 0, &cmd);
 	if (ret != VK_SUCCESS) {
-		vk->vkResetDescriptorPool(vk->device, m->blit.descriptor_pool, 0);
 		vk_cmd_pool_unlock(pool);
-		return XRT_ERROR_VULKAN;
+		goto err_frame;
 	}
 
 	VK_NAME_COMMAND_BUFFER(vk, cmd, "comp_mirror_to_debug_ui command buffer");
 
+	uint32_t scope = VK_GPU_PROFILER_NO_SCOPE;
+	if (m->profiler != NULL) {
+		scope = vk_gpu_profiler_begin_scope(vk, m->profiler, cmd, "mirror blit");
+	}
+
 	// Barrier arguments.
 	VkImageSubresourceRange first_color_level_subresource_range = {
 	    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
@@ -622,39 +699,38 @@ comp_mirror_do_blit(struct comp_mirror_to_debug_gui *m,
 	    VK_PIPELINE_STAGE_HOST_BIT,           // dstStageMask
 	    first_color_level_subresource_range); // subresourceRange
 
-	// This takes a long time so make sure to trace it.
-	COMP_TRACE_BEGIN(submit_and_wait);
-
-	// Done writing commands, submit to queue, waits for command to finish.
-	ret = vk_cmd_pool_end_submit_wait_and_free_cmd_buffer_locked(vk, pool, cmd);
-
-	// Stop this block.
-	COMP_TRACE_END(submit_and_wait);
-
-	// Done with everything, can unlock the pool now.
-	vk_cmd_pool_unlock(pool);
+	if (m->profiler != NULL) {
+		vk_gpu_profiler_end_scope(vk, m->profiler, cmd, scope);
+	}
 
-	// Check results from submit.
+	// Done writing commands.
+	ret = vk->vkEndCommandBuffer(cmd);
 	if (ret != VK_SUCCESS) {
-		//! @todo Better handling of error?
-		VK_ERROR(vk, "vk_cmd_pool_end_submit_wait_and_free_cmd_buffer_locked: %s", vk_result_string(ret));
-		return XRT_ERROR_VULKAN;
+		VK_ERROR(vk, "vkEndCommandBuffer: %s", vk_result_string(ret));
+		goto err_cmd;
 	}
 
 	wrap->base_frame.source_timestamp = wrap->base_frame.timestamp = predicted_display_time_ns;
 	wrap->base_frame.source_sequence = frame_id;
 
-	struct xrt_frame *frame = &wrap->base_frame;
-	wrap = NULL;
+	// Don't wait on the GPU, the pool's thread pushes the frame when it is done.
+	ret = vk_image_readback_to_xf_pool_submit_locked(vk, m->pool, pool, cmd, wrap);
+	if (ret != VK_SUCCESS) {
+		goto err_cmd;
+	}
 
-	u_sink_debug_push_frame(&m->debug_sink, frame);
+	// Done with everything, can unlock the pool now.
+	vk_cmd_pool_unlock(pool);
 
-	u_frame_times_widget_push_sample(&m->push_frame_times, predicted_display_time_ns);
+	return XRT_SUCCESS;
 
-	xrt_frame_reference(&frame, NULL);
+err_cmd:
+	vk->vkFreeCommandBuffers(vk->device, pool->pool, 1, &cmd);
+	vk_cmd_pool_unlock(pool);
+
+err_frame:
+	release_wrap(wrap);
 
-	// Tidies the descriptor we created.
-	vk->vkResetDescriptorPool(vk->device, m->blit.descriptor_pool, 0);
 	return XRT_ERROR_VULKAN;
 }
 
@@ -664,7 +740,7 @@ comp_mirror_fini(struct comp_mirror_to_debug_gui *m, struct vk_bundle *vk)
 	// Remove u_var root as early as possible.
 	u_var_remove_root(m);
 
-	// Left eye readback
+	// Left eye readback, waits for any readback in flight without pushing it.
 	vk_image_readback_to_xf_pool_destroy(vk, &m->pool);
 
 	// Bounce image resources.
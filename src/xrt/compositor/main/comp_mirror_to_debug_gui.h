@@ -1,4 +1,4 @@
-// Copyright 2019-2023, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -13,6 +13,7 @@
 #include "xrt/xrt_results.h"
 #include "util/u_sink.h"
 #include "vk/vk_image_readback_to_xf_pool.h"
+#include "vk/vk_gpu_profiler.h"
 
 #include "main/comp_compositor.h"
 
@@ -70,9 +71,21 @@ struct comp_mirror_to_debug_gui
 
 		//! Doesn't depend on target so is static.
 		VkPipeline pipeline;
+
+		/*!
+		 * One per readback frame, so a set is never updated while a
+		 * readback using it is still in flight, lazily allocated.
+		 */
+		VkDescriptorSet descriptor_sets[READBACK_POOL_NUM_FRAMES];
 	} blit;
 
 	struct vk_cmd_pool cmd_pool;
+
+	//! Frames skipped because the consumer was holding on to all of them.
+	uint64_t skipped_frames;
+
+	//! Optional, times the blit, not owned.
+	struct vk_gpu_profiler *profiler;
 };
 
 /*!
@@ -0,0 +1,759 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Camera passthrough images for the passthrough layer.
+ * @ingroup comp_main
+ */
+
+#include "math/m_api.h"
+#include "math/m_mathinclude.h"
+
+#include "util/u_misc.h"
+#include "util/u_format.h"
+#include "util/u_logging.h"
+#include "util/u_trace_marker.h"
+
+#include "vk/vk_mini_helpers.h"
+
+#include "main/comp_passthrough.h"
+
+#include <string.h>
+
+
+/*
+ *
+ * Helper functions.
+ *
+ */
+
+/*!
+ * If `COND` is not VK_SUCCESS returns the error.
+ */
+#define C(c)                                                                                                           \
+	do {                                                                                                           \
+		VkResult ret = c;                                                                                      \
+		if (ret != VK_SUCCESS) {                                                                               \
+			comp_passthrough_fini(cp, vk);                                                                 \
+			return ret;                                                                                    \
+		}                                                                                                      \
+	} while (false)
+
+static const VkImageSubresourceRange first_color_level_subresource_range = {
+    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+    .baseMipLevel = 0,
+    .levelCount = 1,
+    .baseArrayLayer = 0,
+    .layerCount = 1,
+};
+
+static bool
+has_passthrough_layer(const struct comp_layer *layers, uint32_t layer_count)
+{
+	for (uint32_t i = 0; i < layer_count; i++) {
+		if (layers[i].data.type == XRT_LAYER_PASSTHROUGH) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool
+get_vk_format(enum xrt_format format, VkFormat *out_format, VkComponentMapping *out_components)
+{
+	switch (format) {
+	case XRT_FORMAT_L8:
+		*out_format = VK_FORMAT_R8_UNORM;
+		*out_components = (VkComponentMapping){
+		    .r = VK_COMPONENT_SWIZZLE_R,
+		    .g = VK_COMPONENT_SWIZZLE_R,
+		    .b = VK_COMPONENT_SWIZZLE_R,
+		    .a = VK_COMPONENT_SWIZZLE_ONE,
+		};
+		return true;
+	case XRT_FORMAT_R8G8B8X8:
+	case XRT_FORMAT_R8G8B8A8:
+		*out_format = VK_FORMAT_R8G8B8A8_UNORM;
+		*out_components = (VkComponentMapping){
+		    .r = VK_COMPONENT_SWIZZLE_R,
+		    .g = VK_COMPONENT_SWIZZLE_G,
+		    .b = VK_COMPONENT_SWIZZLE_B,
+		    .a = VK_COMPONENT_SWIZZLE_ONE,
+		};
+		return true;
+	default: return false;
+	}
+}
+
+static void
+camera_push_frame(struct xrt_frame_sink *sink, struct xrt_frame *xf)
+{
+	struct comp_passthrough_camera *cam = container_of(sink, struct comp_passthrough_camera, sink);
+
+	// Only keep the latest, older frames are released here.
+	os_mutex_lock(&cam->cp->frame_lock);
+	xrt_frame_reference(&cam->latest, xf);
+	os_mutex_unlock(&cam->cp->frame_lock);
+}
+
+static void
+set_started(struct comp_passthrough *cp, bool started)
+{
+	for (uint32_t i = 0; i < cp->camera_count; i++) {
+		struct comp_passthrough_camera *cam = &cp->cameras[i];
+
+		xrt_result_t xret = xrt_device_set_passthrough_camera_sink( //
+		    cp->xdev,                                               //
+		    i,                                                      // camera_index
+		    started ? &cam->sink : NULL);                           // sink
+		if (xret != XRT_SUCCESS) {
+			U_LOG_E("Failed to %s passthrough camera %u: %d", started ? "start" : "stop", i, xret);
+		}
+	}
+
+	if (!started) {
+		os_mutex_lock(&cp->frame_lock);
+		for (uint32_t i = 0; i < cp->camera_count; i++) {
+			xrt_frame_reference(&cp->cameras[i].latest, NULL);
+			cp->cameras[i].valid = false;
+			cp->cameras[i].uploaded_timestamp_ns = 0;
+		}
+		os_mutex_unlock(&cp->frame_lock);
+	}
+
+	cp->started = started;
+}
+
+/*!
+ * Frees the command buffer of the slot once the GPU is done with it, returns
+ * false if it is still in flight and @p wait is false.
+ */
+static bool
+retire_slot(struct comp_passthrough *cp, struct vk_bundle *vk, uint32_t index, bool wait)
+{
+	VkResult ret;
+
+	if (cp->slots[index].cmd == VK_NULL_HANDLE) {
+		return true;
+	}
+
+	if (wait) {
+		ret = vk->vkWaitForFences(vk->device, 1, &cp->slots[index].fence, VK_TRUE, UINT64_MAX);
+	} else {
+		ret = vk->vkGetFenceStatus(vk->device, cp->slots[index].fence);
+	}
+
+	if (ret == VK_NOT_READY || ret == VK_TIMEOUT) {
+		return false;
+	}
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "Failed to wait for the passthrough upload fence: %s", vk_result_string(ret));
+	}
+
+	vk->vkResetFences(vk->device, 1, &cp->slots[index].fence);
+
+	vk_cmd_pool_lock(&cp->cmd_pool);
+	vk->vkFreeCommandBuffers(vk->device, cp->cmd_pool.pool, 1, &cp->slots[index].cmd);
+	vk_cmd_pool_unlock(&cp->cmd_pool);
+
+	cp->slots[index].cmd = VK_NULL_HANDLE;
+
+	return true;
+}
+
+static void
+destroy_camera_image(struct comp_passthrough_camera *cam, struct vk_bundle *vk)
+{
+	if (cam->image.view != VK_NULL_HANDLE) {
+		cam->cp->image_generation++;
+	}
+
+	D(ImageView, cam->image.view);
+	D(Image, cam->image.image);
+	DF(Memory, cam->image.mem);
+
+	cam->image.width = 0;
+	cam->image.height = 0;
+	cam->valid = false;
+}
+
+/*!
+ * Makes sure the camera image matches the frame, recreating it waits for the
+ * queue to be idle but only happens on the first frame or a mode change.
+ */
+static bool
+ensure_camera_image(struct comp_passthrough *cp,
+                    struct vk_bundle *vk,
+                    struct comp_passthrough_camera *cam,
+                    const struct xrt_frame *xf)
+{
+	if (cam->image.image != VK_NULL_HANDLE && cam->image.width == xf->width && cam->image.height == xf->height &&
+	    cam->image.format == xf->format) {
+		return true;
+	}
+
+	VkFormat format = VK_FORMAT_UNDEFINED;
+	VkComponentMapping components = {0};
+	if (!get_vk_format(xf->format, &format, &components)) {
+		U_LOG_E("Unsupported passthrough camera format %s", u_format_str(xf->format));
+		return false;
+	}
+
+	if (cam->image.image != VK_NULL_HANDLE) {
+		// Earlier frames might still be sampling from it.
+		os_mutex_lock(&vk->queue_mutex);
+		vk->vkQueueWaitIdle(cp->cmd_pool.queue->queue);
+		os_mutex_unlock(&vk->queue_mutex);
+
+		destroy_camera_image(cam, vk);
+	}
+
+	VkExtent2D extent = {xf->width, xf->height};
+	VkResult ret = vk_create_image_simple(                            //
+	    vk,                                                           // vk_bundle
+	    extent,                                                       // extent
+	    format,                                                       // format
+	    VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, // usage
+	    &cam->image.mem,                                              // out_device_memory
+	    &cam->image.image);                                           // out_image
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vk_create_image_simple: %s", vk_result_string(ret));
+		return false;
+	}
+
+	VK_NAME_DEVICE_MEMORY(vk, cam->image.mem, "comp_passthrough camera memory");
+	VK_NAME_IMAGE(vk, cam->image.image, "comp_passthrough camera image");
+
+	ret = vk_create_view_swizzle(            //
+	    vk,                                  // vk_bundle
+	    cam->image.image,                    // image
+	    VK_IMAGE_VIEW_TYPE_2D,               // type
+	    format,                              // format
+	    first_color_level_subresource_range, // subresource_range
+	    components,                          // components
+	    &cam->image.view);                   // out_view
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vk_create_view_swizzle: %s", vk_result_string(ret));
+		destroy_camera_image(cam, vk);
+		return false;
+	}
+
+	VK_NAME_IMAGE_VIEW(vk, cam->image.view, "comp_passthrough camera image view");
+
+	cam->image.width = xf->width;
+	cam->image.height = xf->height;
+	cam->image.format = xf->format;
+
+	return true;
+}
+
+static VkResult
+ensure_staging(struct vk_bundle *vk, struct render_buffer *staging, VkDeviceSize size)
+{
+	if (staging->buffer != VK_NULL_HANDLE && staging->size >= size) {
+		return VK_SUCCESS;
+	}
+
+	// Only called once the slot has been retired.
+	render_buffer_fini(vk, staging);
+
+	VkBufferUsageFlags usage_flags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+	VkResult ret = render_buffer_init(vk, staging, usage_flags, properties, size);
+	VK_CHK_AND_RET(ret, "render_buffer_init");
+	VK_NAME_BUFFER(vk, staging->buffer, "comp_passthrough staging buffer");
+
+	ret = render_buffer_map(vk, staging);
+	VK_CHK_AND_RET(ret, "render_buffer_map");
+
+	return VK_SUCCESS;
+}
+
+static void
+record_copy_to_image(struct vk_bundle *vk,
+                     VkCommandBuffer cmd,
+                     VkBuffer src,
+                     VkDeviceSize offset,
+                     uint32_t row_length,
+                     VkImage image,
+                     VkExtent2D extent,
+                     VkPipelineStageFlags dst_stage_mask)
+{
+	// Everything is overwritten, so the old contents can be discarded.
+	vk_cmd_image_barrier_locked(              //
+	    vk,                                   // vk_bundle
+	    cmd,                                  // cmdbuffer
+	    image,                                // image
+	    0,                                    // srcAccessMask
+	    VK_ACCESS_TRANSFER_WRITE_BIT,         // dstAccessMask
+	    VK_IMAGE_LAYOUT_UNDEFINED,            // oldImageLayout
+	    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // newImageLayout
+	    dst_stage_mask,                       // srcStageMask
+	    VK_PIPELINE_STAGE_TRANSFER_BIT,       // dstStageMask
+	    first_color_level_subresource_range); // subresourceRange
+
+	VkBufferImageCopy region = {
+	    .bufferOffset = offset,
+	    .bufferRowLength = row_length,
+	    .bufferImageHeight = 0,
+	    .imageSubresource =
+	        {
+	            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+	            .mipLevel = 0,
+	            .baseArrayLayer = 0,
+	            .layerCount = 1,
+	        },
+	    .imageOffset = {0, 0, 0},
+	    .imageExtent = {extent.width, extent.height, 1},
+	};
+
+	vk->vkCmdCopyBufferToImage(               //
+	    cmd,                                  // commandBuffer
+	    src,                                  // srcBuffer
+	    image,                                // dstImage
+	    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // dstImageLayout
+	    1,                                    // regionCount
+	    &region);                             // pRegions
+
+	vk_cmd_image_barrier_locked(                  //
+	    vk,                                       // vk_bundle
+	    cmd,                                      // cmdbuffer
+	    image,                                    // image
+	    VK_ACCESS_TRANSFER_WRITE_BIT,             // srcAccessMask
+	    VK_ACCESS_SHADER_READ_BIT,                // dstAccessMask
+	    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,     // oldImageLayout
+	    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, // newImageLayout
+	    VK_PIPELINE_STAGE_TRANSFER_BIT,           // srcStageMask
+	    dst_stage_mask,                           // dstStageMask
+	    first_color_level_subresource_range);     // subresourceRange
+}
+
+/*!
+ * Fills in the camera uv for each tangent angle in the fov of the camera,
+ * projected by the device so all of its distortion models are supported.
+ */
+static void
+build_map(struct comp_passthrough *cp, uint32_t camera_index, struct xrt_vec2 *out_texels)
+{
+	const struct xrt_fov *fov = &cp->cameras[camera_index].map_fov;
+	const uint32_t dim = COMP_PASSTHROUGH_MAP_DIMENSIONS;
+
+	const float tan_left = tanf(fov->angle_left);
+	const float tan_right = tanf(fov->angle_right);
+	const float tan_up = tanf(fov->angle_up);
+	const float tan_down = tanf(fov->angle_down);
+
+	for (uint32_t row = 0; row < dim; row++) {
+		float v = ((float)row + 0.5f) / (float)dim;
+
+		for (uint32_t col = 0; col < dim; col++) {
+			float u = ((float)col + 0.5f) / (float)dim;
+
+			// Same layout as images, top row is up.
+			struct xrt_vec3 direction = {
+			    tan_left + u * (tan_right - tan_left),
+			    tan_up - v * (tan_up - tan_down),
+			    -1.0f,
+			};
+
+			struct xrt_vec2 uv;
+			if (!xrt_device_project_passthrough_camera(cp->xdev, camera_index, &direction, &uv)) {
+				uv = (struct xrt_vec2){-1.0f, -1.0f};
+			}
+
+			out_texels[row * dim + col] = uv;
+		}
+	}
+}
+
+static VkResult
+create_and_upload_maps(struct comp_passthrough *cp, struct vk_bundle *vk)
+{
+	const uint32_t dim = COMP_PASSTHROUGH_MAP_DIMENSIONS;
+	const VkExtent2D extent = {dim, dim};
+	const VkDeviceSize map_size = sizeof(struct xrt_vec2) * dim * dim;
+	VkResult ret;
+
+	for (uint32_t i = 0; i < cp->camera_count; i++) {
+		struct comp_passthrough_camera *cam = &cp->cameras[i];
+
+		ret = vk_create_image_simple(                                     //
+		    vk,                                                           // vk_bundle
+		    extent,                                                       // extent
+		    VK_FORMAT_R32G32_SFLOAT,                                      // format
+		    VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, // usage
+		    &cam->map.mem,                                                // out_device_memory
+		    &cam->map.image);                                             // out_image
+		VK_CHK_AND_RET(ret, "vk_create_image_simple");
+
+		VK_NAME_DEVICE_MEMORY(vk, cam->map.mem, "comp_passthrough map memory");
+		VK_NAME_IMAGE(vk, cam->map.image, "comp_passthrough map image");
+
+		ret = vk_create_view(                    //
+		    vk,                                  // vk_bundle
+		    cam->map.image,                      // image
+		    VK_IMAGE_VIEW_TYPE_2D,               // type
+		    VK_FORMAT_R32G32_SFLOAT,             // format
+		    first_color_level_subresource_range, // subresource_range
+		    &cam->map.view);                     // out_view
+		VK_CHK_AND_RET(ret, "vk_create_view");
+
+		VK_NAME_IMAGE_VIEW(vk, cam->map.view, "comp_passthrough map image view");
+	}
+
+	struct render_buffer staging = {0};
+	ret = ensure_staging(vk, &staging, map_size * cp->camera_count);
+	if (ret != VK_SUCCESS) {
+		render_buffer_fini(vk, &staging);
+		return ret;
+	}
+
+	for (uint32_t i = 0; i < cp->camera_count; i++) {
+		build_map(cp, i, (struct xrt_vec2 *)((uint8_t *)staging.mapped + map_size * i));
+	}
+
+	struct vk_cmd_pool *pool = &cp->cmd_pool;
+
+	vk_cmd_pool_lock(pool);
+
+	VkCommandBuffer cmd;
+	ret = vk_cmd_pool_create_and_begin_cmd_buffer_locked(vk, pool, 0, &cmd);
+	if (ret != VK_SUCCESS) {
+		vk_cmd_pool_unlock(pool);
+		render_buffer_fini(vk, &staging);
+		return ret;
+	}
+
+	VK_NAME_COMMAND_BUFFER(vk, cmd, "comp_passthrough map upload command buffer");
+
+	for (uint32_t i = 0; i < cp->camera_count; i++) {
+		record_copy_to_image(                    //
+		    vk,                                  // vk_bundle
+		    cmd,                                 // cmd
+		    staging.buffer,                      // src
+		    map_size * i,                        // offset
+		    0,                                   // row_length
+		    cp->cameras[i].map.image,            // image
+		    extent,                              // extent
+		    VK_PIPELINE_STAGE_ALL_COMMANDS_BIT); // dst_stage_mask
+	}
+
+	// Done once at startup, fine to wait.
+	ret = vk_cmd_pool_end_submit_wait_and_free_cmd_buffer_locked(vk, pool, cmd);
+	vk_cmd_pool_unlock(pool);
+
+	render_buffer_fini(vk, &staging);
+
+	VK_CHK_AND_RET(ret, "vk_cmd_pool_end_submit_wait_and_free_cmd_buffer_locked");
+
+	return VK_SUCCESS;
+}
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+VkResult
+comp_passthrough_init(struct comp_passthrough *cp,
+                      struct vk_bundle *vk,
+                      struct vk_bundle_queue *queue,
+                      struct xrt_device *xdev)
+{
+	U_ZERO(cp);
+
+	if (!xdev->supported.passthrough_camera) {
+		return VK_SUCCESS;
+	}
+
+	struct xrt_passthrough_camera_info info = {0};
+	xrt_result_t xret = xrt_device_get_passthrough_camera_info(xdev, &info);
+	if (xret != XRT_SUCCESS || info.camera_count == 0) {
+		U_LOG_W("Device has no usable passthrough cameras, passthrough layers will be skipped");
+		return VK_SUCCESS;
+	}
+
+	if (os_mutex_init(&cp->frame_lock) != 0) {
+		U_LOG_E("Failed to init passthrough frame lock");
+		return VK_ERROR_INITIALIZATION_FAILED;
+	}
+
+	// From here the fini function cleans up.
+	cp->xdev = xdev;
+	cp->camera_count = MIN(info.camera_count, XRT_MAX_VIEWS);
+
+	for (uint32_t i = 0; i < cp->camera_count; i++) {
+		cp->cameras[i].sink.push_frame = camera_push_frame;
+		cp->cameras[i].cp = cp;
+		cp->cameras[i].pose_in_head = info.cameras[i].pose_in_head;
+		cp->cameras[i].map_fov = info.cameras[i].fov;
+	}
+
+	C(vk_cmd_pool_init_for_queue(vk, &cp->cmd_pool, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, queue));
+
+	VK_NAME_COMMAND_POOL(vk, cp->cmd_pool.pool, "comp_passthrough command pool");
+
+	VkFenceCreateInfo fence_info = {
+	    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+	};
+
+	for (uint32_t i = 0; i < COMP_PASSTHROUGH_SLOT_COUNT; i++) {
+		C(vk->vkCreateFence(vk->device, &fence_info, NULL, &cp->slots[i].fence));
+
+		VK_NAME_FENCE(vk, cp->slots[i].fence, "comp_passthrough upload fence");
+	}
+
+	C(create_and_upload_maps(cp, vk));
+
+	return VK_SUCCESS;
+}
+
+void
+comp_passthrough_fini(struct comp_passthrough *cp, struct vk_bundle *vk)
+{
+	if (cp->xdev == NULL) {
+		return;
+	}
+
+	// No more frames after this.
+	if (cp->started) {
+		set_started(cp, false);
+	}
+
+	for (uint32_t i = 0; i < COMP_PASSTHROUGH_SLOT_COUNT; i++) {
+		if (cp->slots[i].fence == VK_NULL_HANDLE) {
+			continue;
+		}
+
+		retire_slot(cp, vk, i, true);
+		render_buffer_fini(vk, &cp->slots[i].staging);
+		D(Fence, cp->slots[i].fence);
+	}
+
+	for (uint32_t i = 0; i < cp->camera_count; i++) {
+		struct comp_passthrough_camera *cam = &cp->cameras[i];
+
+		destroy_camera_image(cam, vk);
+
+		D(ImageView, cam->map.view);
+		D(Image, cam->map.image);
+		DF(Memory, cam->map.mem);
+	}
+
+	if (cp->cmd_pool.pool != VK_NULL_HANDLE) {
+		vk_cmd_pool_destroy(vk, &cp->cmd_pool);
+	}
+
+	os_mutex_destroy(&cp->frame_lock);
+
+	cp->xdev = NULL;
+}
+
+XRT_CHECK_RESULT xrt_result_t
+comp_passthrough_upload(struct comp_passthrough *cp,
+                        struct vk_bundle *vk,
+                        const struct comp_layer *layers,
+                        uint32_t layer_count)
+{
+	COMP_TRACE_MARKER();
+
+	if (cp->xdev == NULL) {
+		return XRT_SUCCESS;
+	}
+
+	// The cameras are only streamed to us while they are seen.
+	bool want = has_passthrough_layer(layers, layer_count);
+	if (want != cp->started) {
+		set_started(cp, want);
+	}
+	if (!cp->started) {
+		return XRT_SUCCESS;
+	}
+
+	struct xrt_frame *frames[XRT_MAX_VIEWS] = {0};
+	bool any = false;
+
+	os_mutex_lock(&cp->frame_lock);
+	for (uint32_t i = 0; i < cp->camera_count; i++) {
+		struct comp_passthrough_camera *cam = &cp->cameras[i];
+		if (cam->latest != NULL && cam->latest->timestamp != cam->uploaded_timestamp_ns) {
+			xrt_frame_reference(&frames[i], cam->latest);
+			any = true;
+		}
+	}
+	os_mutex_unlock(&cp->frame_lock);
+
+	// Cameras run slower than the display, most frames have nothing new.
+	if (!any) {
+		return XRT_SUCCESS;
+	}
+
+	xrt_result_t xret = XRT_SUCCESS;
+	uint32_t slot_index = cp->next_slot;
+
+	// Keep showing the previous image instead of stalling the compositor.
+	if (!retire_slot(cp, vk, slot_index, false)) {
+		goto out;
+	}
+
+	VkDeviceSize offsets[XRT_MAX_VIEWS] = {0};
+	uint32_t row_lengths[XRT_MAX_VIEWS] = {0};
+	VkDeviceSize total_size = 0;
+
+	for (uint32_t i = 0; i < cp->camera_count; i++) {
+		struct xrt_frame *xf = frames[i];
+		if (xf == NULL) {
+			continue;
+		}
+
+		uint32_t block_size = u_format_block_size(xf->format);
+		if (!ensure_camera_image(cp, vk, &cp->cameras[i], xf) || xf->stride % block_size != 0) {
+			xrt_frame_reference(&frames[i], NULL);
+			continue;
+		}
+
+		// Keeps every copy aligned to the texel size.
+		offsets[i] = total_size;
+		row_lengths[i] = (uint32_t)(xf->stride / block_size);
+		total_size += ((VkDeviceSize)xf->stride * xf->height + 15) & ~(VkDeviceSize)15;
+	}
+
+	if (total_size == 0) {
+		goto out;
+	}
+
+	struct render_buffer *staging = &cp->slots[slot_index].staging;
+	VkResult ret = ensure_staging(vk, staging, total_size);
+	if (ret != VK_SUCCESS) {
+		xret = XRT_ERROR_VULKAN;
+		goto out;
+	}
+
+	for (uint32_t i = 0; i < cp->camera_count; i++) {
+		struct xrt_frame *xf = frames[i];
+		if (xf != NULL) {
+			memcpy((uint8_t *)staging->mapped + offsets[i], xf->data, xf->stride * xf->height);
+		}
+	}
+
+	struct vk_cmd_pool *pool = &cp->cmd_pool;
+
+	vk_cmd_pool_lock(pool);
+
+	VkCommandBuffer cmd;
+	ret = vk_cmd_pool_create_and_begin_cmd_buffer_locked(vk, pool, 0, &cmd);
+	if (ret != VK_SUCCESS) {
+		vk_cmd_pool_unlock(pool);
+		xret = XRT_ERROR_VULKAN;
+		goto out;
+	}
+
+	VK_NAME_COMMAND_BUFFER(vk, cmd, "comp_passthrough upload command buffer");
+
+	for (uint32_t i = 0; i < cp->camera_count; i++) {
+		struct comp_passthrough_camera *cam = &cp->cameras[i];
+		if (frames[i] == NULL) {
+			continue;
+		}
+
+		VkExtent2D extent = {cam->image.width, cam->image.height};
+
+		record_copy_to_image(                      //
+		    vk,                                    // vk_bundle
+		    cmd,                                   // cmd
+		    staging->buffer,                       // src
+		    offsets[i],                            // offset
+		    row_lengths[i],                        // row_length
+		    cam->image.image,                      // image
+		    extent,                                // extent
+		    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT); // dst_stage_mask
+	}
+
+	ret = vk->vkEndCommandBuffer(cmd);
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vkEndCommandBuffer: %s", vk_result_string(ret));
+		goto err_cmd;
+	}
+
+	VkSubmitInfo submit_info = {
+	    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+	    .commandBufferCount = 1,
+	    .pCommandBuffers = &cmd,
+	};
+
+	// Same queue as the squasher, so it is ordered before it without a semaphore.
+	ret = vk_cmd_submit_locked(vk, pool->queue, 1, &submit_info, cp->slots[slot_index].fence);
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "vk_cmd_submit_locked: %s", vk_result_string(ret));
+		goto err_cmd;
+	}
+
+	vk_cmd_pool_unlock(pool);
+
+	cp->slots[slot_index].cmd = cmd;
+	cp->next_slot = (slot_index + 1) % COMP_PASSTHROUGH_SLOT_COUNT;
+
+	for (uint32_t i = 0; i < cp->camera_count; i++) {
+		struct comp_passthrough_camera *cam = &cp->cameras[i];
+		struct xrt_frame *xf = frames[i];
+		if (xf == NULL) {
+			continue;
+		}
+
+		// Where the head was when the frame was captured, not when it is shown.
+		struct xrt_space_relation head_relation = XRT_SPACE_RELATION_ZERO;
+		xrt_result_t pose_xret = xrt_device_get_tracked_pose( //
+		    cp->xdev,                                         //
+		    XRT_INPUT_GENERIC_HEAD_POSE,                      //
+		    xf->timestamp,                                    //
+		    &head_relation);                                  //
+		if (pose_xret != XRT_SUCCESS) {
+			continue;
+		}
+
+		math_pose_transform(&head_relation.pose, &cam->pose_in_head, &cam->world_pose);
+		cam->uploaded_timestamp_ns = xf->timestamp;
+		cam->valid = true;
+	}
+
+	goto out;
+
+err_cmd:
+	vk->vkFreeCommandBuffers(vk->device, pool->pool, 1, &cmd);
+	vk_cmd_pool_unlock(pool);
+	xret = XRT_ERROR_VULKAN;
+
+out:
+	for (uint32_t i = 0; i < cp->camera_count; i++) {
+		xrt_frame_reference(&frames[i], NULL);
+	}
+
+	return xret;
+}
+
+void
+comp_passthrough_get_view(struct comp_passthrough *cp,
+                          uint32_t view_index,
+                          struct comp_render_passthrough_data *out_data)
+{
+	U_ZERO(out_data);
+
+	if (cp->xdev == NULL || !cp->started) {
+		return;
+	}
+
+	const struct comp_passthrough_camera *cam = &cp->cameras[MIN(view_index, cp->camera_count - 1)];
+	if (!cam->valid) {
+		return;
+	}
+
+	out_data->valid = true;
+	out_data->camera_view = cam->image.view;
+	out_data->map_view = cam->map.view;
+	out_data->map_fov = cam->map_fov;
+	out_data->world_pose = cam->world_pose;
+}
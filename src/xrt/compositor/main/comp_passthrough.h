@@ -0,0 +1,176 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Camera passthrough images for the passthrough layer.
+ * @ingroup comp_main
+ */
+
+#pragma once
+
+#include "xrt/xrt_compiler.h"
+#include "xrt/xrt_results.h"
+#include "xrt/xrt_frame.h"
+#include "xrt/xrt_device.h"
+#include "os/os_threading.h"
+#include "vk/vk_helpers.h"
+#include "vk/vk_cmd_pool.h"
+
+#include "render/render_interface.h"
+#include "util/comp_layer_accum.h"
+#include "util/comp_render.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//! Width and height of the undistortion map of each camera.
+#define COMP_PASSTHROUGH_MAP_DIMENSIONS (256)
+
+//! Number of uploads that can be in flight on the GPU.
+#define COMP_PASSTHROUGH_SLOT_COUNT (3)
+
+struct comp_passthrough;
+
+/*!
+ * A single camera, receives the frames from the device and holds the GPU
+ * copy of the latest one.
+ *
+ * @ingroup comp_main
+ */
+struct comp_passthrough_camera
+{
+	//! Pushed to by the device, on its own thread.
+	struct xrt_frame_sink sink;
+
+	//! Owning struct.
+	struct comp_passthrough *cp;
+
+	//! Latest frame pushed by the device, protected by @ref comp_passthrough::frame_lock.
+	struct xrt_frame *latest;
+
+	//! Has a frame been uploaded to @p image.
+	bool valid;
+
+	//! Timestamp of the frame in @p image.
+	int64_t uploaded_timestamp_ns;
+
+	//! World pose of the camera when the frame in @p image was captured.
+	struct xrt_pose world_pose;
+
+	//! Tangent angles covered by the undistortion map.
+	struct xrt_fov map_fov;
+
+	//! Device view of the camera, copied from @ref xrt_passthrough_camera_info.
+	struct xrt_pose pose_in_head;
+
+	//! Undistortion map, camera uv for each tangent angle.
+	struct
+	{
+		VkImage image;
+		VkImageView view;
+		VkDeviceMemory mem;
+	} map;
+
+	//! The latest camera frame, recreated when the size or format changes.
+	struct
+	{
+		VkImage image;
+		VkImageView view;
+		VkDeviceMemory mem;
+		uint32_t width;
+		uint32_t height;
+		enum xrt_format format;
+	} image;
+};
+
+/*!
+ * Takes the frames from the passthrough cameras of the device and keeps the
+ * latest one of each uploaded to the GPU for the compute layer squasher.
+ * Currently embedded in @ref comp_renderer.
+ *
+ * @ingroup comp_main
+ */
+struct comp_passthrough
+{
+	//! Device with the cameras, NULL if it has none and everything is a no-op.
+	struct xrt_device *xdev;
+
+	//! Are the sinks attached to the device.
+	bool started;
+
+	uint32_t camera_count;
+	struct comp_passthrough_camera cameras[XRT_MAX_VIEWS];
+
+	//! Protects @ref comp_passthrough_camera::latest.
+	struct os_mutex frame_lock;
+
+	//! On the same queue as the layer squasher.
+	struct vk_cmd_pool cmd_pool;
+
+	//! Uploads in flight, reused round robin.
+	struct
+	{
+		VkFence fence;
+		VkCommandBuffer cmd;
+
+		//! Host visible, persistently mapped, camera images packed one after the other.
+		struct render_buffer staging;
+	} slots[COMP_PASSTHROUGH_SLOT_COUNT];
+
+	uint32_t next_slot;
+
+	//! Bumped when a camera image view is destroyed, the views are cached in descriptor sets.
+	uint64_t image_generation;
+};
+
+/*!
+ * Init the struct, does nothing if @p xdev doesn't support passthrough
+ * cameras. The undistortion maps are built and uploaded here.
+ *
+ * @public @memberof comp_passthrough
+ */
+VkResult
+comp_passthrough_init(struct comp_passthrough *cp,
+                      struct vk_bundle *vk,
+                      struct vk_bundle_queue *queue,
+                      struct xrt_device *xdev);
+
+/*!
+ * Detaches from the device and frees all resources, the GPU must be idle.
+ *
+ * @public @memberof comp_passthrough
+ */
+void
+comp_passthrough_fini(struct comp_passthrough *cp, struct vk_bundle *vk);
+
+/*!
+ * Starts or stops the cameras depending on if there are any passthrough layers
+ * and uploads any new frames, the upload is submitted to the queue before
+ * returning so must be called before the layer squasher is submitted.
+ *
+ * @public @memberof comp_passthrough
+ */
+XRT_CHECK_RESULT xrt_result_t
+comp_passthrough_upload(struct comp_passthrough *cp,
+                        struct vk_bundle *vk,
+                        const struct comp_layer *layers,
+                        uint32_t layer_count);
+
+/*!
+ * Camera image for the view, each view uses the camera with the same index or
+ * the last camera if there are fewer cameras than views.
+ *
+ * @public @memberof comp_passthrough
+ */
+void
+comp_passthrough_get_view(struct comp_passthrough *cp,
+                          uint32_t view_index,
+                          struct comp_render_passthrough_data *out_data);
+
+
+#ifdef __cplusplus
+}
+#endif
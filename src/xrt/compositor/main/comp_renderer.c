@@ -1,4 +1,4 @@
-// Copyright 2019-2024, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // Copyright 2024-2025, NVIDIA CORPORATION.
 // SPDX-License-Identifier: BSL-1.0
 /*!
@@ -20,6 +20,7 @@
 #include "os/os_time.h"
 
 #include "math/m_api.h"
+#include "math/m_mathinclude.h"
 #include "math/m_matrix_2x2.h"
 #include "math/m_space.h"
 
@@ -30,12 +31,14 @@
 #include "util/u_var.h"
 #include "util/u_frame_times_widget.h"
 #include "util/u_debug.h"
+#include "util/u_metrics.h"
 
 #include "util/comp_render.h"
 #include "util/comp_high_level_render.h"
 
 #include "main/comp_frame.h"
 #include "main/comp_mirror_to_debug_gui.h"
+#include "main/comp_passthrough.h"
 
 #ifdef XRT_FEATURE_WINDOW_PEEK
 #include "main/comp_window_peek.h"
@@ -60,6 +63,12 @@ DEBUG_GET_ONCE_LOG_OPTION(comp_frame_lag_level, "XRT_COMP_FRAME_LAG_LOG_AS_LEVEL
  *
  */
 
+/*!
+ * Number of frames in a row that did not use the scratch images before they
+ * are released, long enough to not thrash when an app toggles layers.
+ */
+#define COMP_RENDERER_SCRATCH_IDLE_FRAMES (300)
+
 #define CHAIN(STRUCT, NEXT)                                                                                            \
 	do {                                                                                                           \
 		(STRUCT).pNext = NEXT;                                                                                 \
@@ -92,6 +101,25 @@ enum comp_target_fov_source
 	COMP_TARGET_FOV_SOURCE_DEVICE_VIEWS,
 };
 
+/*!
+ * The renderer state of a single frame in flight, indexed the same as
+ * @ref render_resources::frames.
+ *
+ * @ingroup comp_main
+ */
+struct comp_renderer_frame
+{
+	//! Signalled when the GPU has completed the work last submitted with these resources.
+	VkFence fence;
+
+	//! Frame last submitted with these resources, -1 if there is no work pending.
+	int64_t frame_id;
+
+	//! Only one of these is used, finalized once the GPU work recorded with it is done.
+	struct render_gfx render_g;
+	struct render_compute render_c;
+};
+
 /*!
  * Holds associated vulkan objects and state to render with a distortion.
  *
@@ -109,6 +137,61 @@ struct comp_renderer
 
 	struct comp_mirror_to_debug_gui mirror_to_debug_gui;
 
+	//! Camera images for passthrough layers, only used by the compute path.
+	struct comp_passthrough passthrough;
+
+	/*!
+	 * Generations of the swapchain and passthrough image views that the
+	 * cached layer descriptor sets were last checked against, see
+	 * @ref renderer_check_layer_descriptors.
+	 */
+	struct
+	{
+		uint64_t swapchain;
+		uint64_t passthrough;
+	} descriptor_generation;
+
+	/*!
+	 * Used when the compute work is submitted to @ref vk_bundle::compute_queue,
+	 * signalled there with an increasing value and waited on by the main
+	 * queue, see @ref renderer_join_main_queue.
+	 */
+	struct
+	{
+		VkSemaphore semaphore;
+		uint64_t value;
+	} async_compute;
+
+	/*!
+	 * The CPU records a frame while the GPU may still be working on the
+	 * previous one, see @ref renderer_next_frame_resources.
+	 */
+	struct comp_renderer_frame frames[RENDER_MAX_FRAMES_IN_FLIGHT];
+
+	/*!
+	 * The scratch images are only allocated when a frame needs them, and
+	 * released after @ref COMP_RENDERER_SCRATCH_IDLE_FRAMES frames in a
+	 * row that didn't, the fast path never touches them.
+	 */
+	struct
+	{
+		//! Extent to allocate the scratch images with.
+		VkExtent2D extent;
+
+		//! Number of frames in a row that didn't use the scratch images.
+		uint32_t idle_frames;
+	} scratch;
+
+	/*!
+	 * Framebuffer compression the driver picked for the scratch and target
+	 * images, exposed in the debug UI, see @ref vk_get_image_compression_string.
+	 */
+	struct
+	{
+		char scratch[32];
+		char target[32];
+	} compression;
+
 	//! @}
 
 	//! @name Image-dependent members
@@ -117,9 +200,6 @@ struct comp_renderer
 	//! Index of the current buffer/image
 	int32_t acquired_buffer;
 
-	//! Which buffer was last submitted and has a fence pending.
-	int32_t fenced_buffer;
-
 	/*!
 	 * The render pass used to render to the target, it depends on the
 	 * target's format so will be recreated each time the target changes.
@@ -134,12 +214,7 @@ struct comp_renderer
 	struct render_gfx_target_resources *rtr_array;
 
 	/*!
-	 * Array of fences equal in size to the number of comp_target images.
-	 */
-	VkFence *fences;
-
-	/*!
-	 * The number of renderings/fences we've created: set from comp_target when we use that data.
+	 * The number of renderings we've created: set from comp_target when we use that data.
 	 */
 	uint32_t buffer_count;
 
@@ -164,6 +239,55 @@ renderer_wait_queue_idle(struct comp_renderer *r)
 	os_mutex_unlock(&vk->queue_mutex);
 }
 
+/*!
+ * Start profiling a new frame and report the passes of any earlier frame that
+ * the GPU has completed, never waits on the GPU.
+ */
+static void
+renderer_profiler_begin_frame(struct comp_renderer *r, int64_t frame_id)
+{
+	struct vk_bundle *vk = &r->c->base.vk;
+	struct vk_gpu_profiler *prof = &r->c->nr.profiler;
+
+	if (!vk_gpu_profiler_is_enabled(prof)) {
+		return;
+	}
+
+	vk_gpu_profiler_begin_frame(prof, frame_id);
+
+	struct vk_gpu_profiler_result results[VK_GPU_PROFILER_MAX_SCOPES];
+	int64_t done_frame_id = -1;
+	uint32_t count;
+
+	while ((count = vk_gpu_profiler_read_results(vk, prof, &done_frame_id, results)) > 0) {
+		uint64_t now_ns = os_monotonic_get_ns();
+
+		for (uint32_t i = 0; i < count; i++) {
+#ifdef U_TRACE_PERCETTO // Uses Percetto specific things.
+			if (U_TRACE_CATEGORY_IS_ENABLED(timing)) {
+				U_TRACE_EVENT_BEGIN_ON_TRACK_DATA(timing, pc_gpu_passes, results[i].gpu_start_ns,
+				                                  results[i].name, PERCETTO_I(done_frame_id));
+				U_TRACE_EVENT_END_ON_TRACK(timing, pc_gpu_passes, results[i].gpu_end_ns);
+			}
+#endif
+
+			if (!u_metrics_is_active()) {
+				continue;
+			}
+
+			struct u_metrics_system_gpu_pass umgp = {
+			    .frame_id = done_frame_id,
+			    .name = results[i].name,
+			    .gpu_start_ns = results[i].gpu_start_ns,
+			    .gpu_end_ns = results[i].gpu_end_ns,
+			    .when_ns = now_ns,
+			};
+
+			u_metrics_write_system_gpu_pass(&umgp);
+		}
+	}
+}
+
 static void
 calc_viewport_data(struct comp_renderer *r,
                    struct render_viewport_data out_viewport_data[XRT_MAX_VIEWS],
@@ -307,6 +431,98 @@ calc_pose_data(struct comp_renderer *r,
 	}
 }
 
+/*!
+ * Tangent of the gaze in the view, or false if the device has no eye tracking
+ * or the gaze is not in front of the view.
+ */
+static bool
+calc_gaze_tan(const struct xrt_space_relation *gaze, const struct xrt_pose *world_pose, struct xrt_vec2 *out_tan)
+{
+	if ((gaze->relation_flags & XRT_SPACE_RELATION_ORIENTATION_VALID_BIT) == 0) {
+		return false;
+	}
+
+	// The gaze direction in the view, the gaze origin is close enough to the eye.
+	struct xrt_vec3 forward = {0.0f, 0.0f, -1.0f};
+	struct xrt_vec3 world_dir, dir;
+	struct xrt_quat inv_view;
+	math_quat_rotate_vec3(&gaze->pose.orientation, &forward, &world_dir);
+	math_quat_invert(&world_pose->orientation, &inv_view);
+	math_quat_rotate_vec3(&inv_view, &world_dir, &dir);
+
+	if (dir.z > -0.1f) {
+		return false;
+	}
+
+	out_tan->x = dir.x / -dir.z;
+	out_tan->y = dir.y / -dir.z;
+
+	return true;
+}
+
+/*!
+ * The part of each view around the gaze that is squashed at full rate, fixed
+ * to the middle of the view without eye tracking.
+ */
+static void
+calc_foveal_rects(struct comp_renderer *r,
+                  const struct xrt_pose world_poses[XRT_MAX_VIEWS],
+                  const struct xrt_fov fovs[XRT_MAX_VIEWS],
+                  struct comp_render_view_data views[XRT_MAX_VIEWS],
+                  uint32_t view_count)
+{
+	COMP_TRACE_MARKER();
+
+	struct xrt_device *xdev = r->c->xdev;
+	float radius = r->settings->foveation_degrees * (float)M_PI / 180.0f;
+	const float max_angle = 1.5f; // Just short of 90 degrees.
+
+	struct xrt_space_relation gaze = XRT_SPACE_RELATION_ZERO;
+	if (xdev->supported.eye_gaze) {
+		xrt_result_t xret = xrt_device_get_tracked_pose(     //
+		    xdev,                                            //
+		    XRT_INPUT_GENERIC_EYE_GAZE_POSE,                 //
+		    r->c->frame.rendering.predicted_display_time_ns, //
+		    &gaze);                                          //
+		if (xret != XRT_SUCCESS) {
+			gaze.relation_flags = XRT_SPACE_RELATION_BITMASK_NONE;
+		}
+	}
+
+	for (uint32_t i = 0; i < view_count; i++) {
+		const struct xrt_fov *fov = &fovs[i];
+
+		struct xrt_vec2 center = {0.0f, 0.0f};
+		if (!calc_gaze_tan(&gaze, &world_poses[i], &center)) {
+			center = (struct xrt_vec2){0.0f, 0.0f};
+		}
+
+		// Around the center in angles, then back to tangents.
+		float tan_min_x = tanf(fmaxf(atanf(center.x) - radius, -max_angle));
+		float tan_max_x = tanf(fminf(atanf(center.x) + radius, max_angle));
+		float tan_min_y = tanf(fmaxf(atanf(center.y) - radius, -max_angle));
+		float tan_max_y = tanf(fminf(atanf(center.y) + radius, max_angle));
+
+		float tan_left = tanf(fov->angle_left);
+		float tan_right = tanf(fov->angle_right);
+		float tan_up = tanf(fov->angle_up);
+		float tan_down = tanf(fov->angle_down);
+
+		// View uv has y going down.
+		float u_min = (tan_min_x - tan_left) / (tan_right - tan_left);
+		float u_max = (tan_max_x - tan_left) / (tan_right - tan_left);
+		float v_min = (tan_up - tan_max_y) / (tan_up - tan_down);
+		float v_max = (tan_up - tan_min_y) / (tan_up - tan_down);
+
+		views[i].foveal_rect = (struct xrt_normalized_rect){
+		    .x = u_min,
+		    .y = v_min,
+		    .w = u_max - u_min,
+		    .h = v_max - v_min,
+		};
+	}
+}
+
 //! @pre comp_target_has_images(r->c->target)
 static void
 renderer_build_rendering_target_resources(struct comp_renderer *r,
@@ -333,17 +549,15 @@ renderer_build_rendering_target_resources(struct comp_renderer *r,
  * Update r->buffer_count before calling.
  */
 static void
-renderer_create_renderings_and_fences(struct comp_renderer *r)
+renderer_create_renderings(struct comp_renderer *r)
 {
-	assert(r->fences == NULL);
+	assert(r->rtr_array == NULL);
 	if (r->buffer_count == 0) {
-		COMP_ERROR(r->c, "Requested 0 command buffers.");
+		COMP_ERROR(r->c, "Requested 0 renderings.");
 		return;
 	}
 
-	COMP_DEBUG(r->c, "Allocating %d Command Buffers.", r->buffer_count);
-
-	struct vk_bundle *vk = &r->c->base.vk;
+	COMP_DEBUG(r->c, "Allocating %d renderings.", r->buffer_count);
 
 	bool use_compute = r->settings->use_compute;
 	if (!use_compute) {
@@ -360,34 +574,12 @@ renderer_create_renderings_and_fences(struct comp_renderer *r)
 			renderer_build_rendering_target_resources(r, &r->rtr_array[i], i);
 		}
 	}
-
-	r->fences = U_TYPED_ARRAY_CALLOC(VkFence, r->buffer_count);
-
-	for (uint32_t i = 0; i < r->buffer_count; i++) {
-		VkFenceCreateInfo fence_info = {
-		    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-		    .flags = VK_FENCE_CREATE_SIGNALED_BIT,
-		};
-
-		VkResult ret = vk->vkCreateFence( //
-		    vk->device,                   //
-		    &fence_info,                  //
-		    NULL,                         //
-		    &r->fences[i]);               //
-		if (ret != VK_SUCCESS) {
-			COMP_ERROR(r->c, "vkCreateFence: %s", vk_result_string(ret));
-		}
-
-		char buf[] = "Comp Renderer X_XXXX_XXXX";
-		snprintf(buf, ARRAY_SIZE(buf), "Comp Renderer %u", i);
-		VK_NAME_FENCE(vk, r->fences[i], buf);
-	}
 }
 
+//! @pre The GPU is done with all frames, like after @ref renderer_wait_queue_idle.
 static void
-renderer_close_renderings_and_fences(struct comp_renderer *r)
+renderer_close_renderings(struct comp_renderer *r)
 {
-	struct vk_bundle *vk = &r->c->base.vk;
 	// Renderings
 	if (r->buffer_count > 0 && r->rtr_array != NULL) {
 		for (uint32_t i = 0; i < r->buffer_count; i++) {
@@ -401,19 +593,11 @@ renderer_close_renderings_and_fences(struct comp_renderer *r)
 		r->rtr_array = NULL;
 	}
 
-	// Fences
-	if (r->buffer_count > 0 && r->fences != NULL) {
-		for (uint32_t i = 0; i < r->buffer_count; i++) {
-			vk->vkDestroyFence(vk->device, r->fences[i], NULL);
-			r->fences[i] = VK_NULL_HANDLE;
-		}
-		free(r->fences);
-		r->fences = NULL;
-	}
-
 	r->buffer_count = 0;
 	r->acquired_buffer = -1;
-	r->fenced_buffer = -1;
+
+	// The target views are cached in the layer descriptor sets.
+	render_resources_invalidate_layer_descriptors(&r->c->nr);
 }
 
 /*!
@@ -455,7 +639,7 @@ renderer_ensure_images_and_renderings(struct comp_renderer *r, bool force_recrea
 	renderer_wait_queue_idle(r);
 
 	// Make we sure we destroy all dependent things before creating new images.
-	renderer_close_renderings_and_fences(r);
+	renderer_close_renderings(r);
 
 	VkImageUsageFlags image_usage = 0;
 	if (r->settings->use_compute) {
@@ -486,6 +670,11 @@ renderer_ensure_images_and_renderings(struct comp_renderer *r, bool force_recrea
 
 	comp_target_create_images(r->c->target, &info);
 
+	if (r->c->target->image_count > 0) {
+		const char *str = vk_get_image_compression_string(&r->c->base.vk, r->c->target->images[0].handle);
+		snprintf(r->compression.target, sizeof(r->compression.target), "%s", str);
+	}
+
 	bool pre_rotate = false;
 	if (r->c->target->surface_transform & VK_SURFACE_TRANSFORM_ROTATE_90_BIT_KHR ||
 	    r->c->target->surface_transform & VK_SURFACE_TRANSFORM_ROTATE_270_BIT_KHR) {
@@ -493,18 +682,129 @@ renderer_ensure_images_and_renderings(struct comp_renderer *r, bool force_recrea
 	}
 
 	// @todo: is it safe to fail here?
-	if (!render_distortion_images_ensure(&r->c->nr, &r->c->base.vk, r->c->xdev, pre_rotate))
+	bool compact = r->c->settings.use_compact_distortion;
+	if (!render_distortion_images_ensure(&r->c->nr, &r->c->base.vk, r->c->xdev, pre_rotate, compact))
 		return false;
 
 	r->buffer_count = r->c->target->image_count;
 
-	renderer_create_renderings_and_fences(r);
+	renderer_create_renderings(r);
 
 	assert(r->buffer_count != 0);
 
 	return true;
 }
 
+static void
+renderer_init_async_compute(struct comp_renderer *r)
+{
+	struct vk_bundle *vk = &r->c->base.vk;
+
+	if (!r->settings->use_async_compute) {
+		return;
+	}
+
+	if (vk->compute_queue.queue == VK_NULL_HANDLE) {
+		COMP_WARN(r->c, "No compute queue available, submitting compute work on the main queue.");
+		return;
+	}
+
+#ifdef VK_KHR_timeline_semaphore
+	if (!vk->features.timeline_semaphore) {
+		COMP_WARN(r->c, "No timeline semaphore support, submitting compute work on the main queue.");
+		return;
+	}
+
+	VkSemaphoreTypeCreateInfoKHR type_info = {
+	    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+	    .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+	    .initialValue = 0,
+	};
+
+	VkSemaphoreCreateInfo info = {
+	    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+	    .pNext = &type_info,
+	};
+
+	VkResult ret = vk->vkCreateSemaphore(vk->device, &info, NULL, &r->async_compute.semaphore);
+	if (ret != VK_SUCCESS) {
+		COMP_ERROR(r->c, "vkCreateSemaphore: %s", vk_result_string(ret));
+		r->async_compute.semaphore = VK_NULL_HANDLE;
+		return;
+	}
+
+	VK_NAME_SEMAPHORE(vk, r->async_compute.semaphore, "comp_renderer async compute");
+
+	r->async_compute.value = 0;
+
+	COMP_INFO(r->c, "Submitting compute work on the compute queue.");
+#else
+	COMP_WARN(r->c, "No compile time timeline semaphore support, submitting compute work on the main queue.");
+#endif
+}
+
+//! Frees the resources of the render builder used by the frame, if any.
+static void
+renderer_frame_fini_render(struct comp_renderer_frame *frame)
+{
+	if (frame->render_c.r != NULL) {
+		render_compute_fini(&frame->render_c);
+	}
+	if (frame->render_g.r != NULL) {
+		render_gfx_fini(&frame->render_g);
+	}
+}
+
+static void
+renderer_init_frames(struct comp_renderer *r)
+{
+	struct vk_bundle *vk = &r->c->base.vk;
+
+	for (uint32_t i = 0; i < ARRAY_SIZE(r->frames); i++) {
+		struct comp_renderer_frame *frame = &r->frames[i];
+
+		VkFenceCreateInfo fence_info = {
+		    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+		    .flags = VK_FENCE_CREATE_SIGNALED_BIT,
+		};
+
+		VkResult ret = vk->vkCreateFence( //
+		    vk->device,                   //
+		    &fence_info,                  //
+		    NULL,                         //
+		    &frame->fence);               //
+		if (ret != VK_SUCCESS) {
+			COMP_ERROR(r->c, "vkCreateFence: %s", vk_result_string(ret));
+		}
+
+		char buf[] = "Comp Renderer X_XXXX_XXXX";
+		snprintf(buf, ARRAY_SIZE(buf), "Comp Renderer %u", i);
+		VK_NAME_FENCE(vk, frame->fence, buf);
+
+		frame->frame_id = -1;
+	}
+}
+
+//! @pre The GPU is done with all frames, like after @ref renderer_wait_queue_idle.
+static void
+renderer_fini_frames(struct comp_renderer *r)
+{
+	struct vk_bundle *vk = &r->c->base.vk;
+
+	for (uint32_t i = 0; i < ARRAY_SIZE(r->frames); i++) {
+		struct comp_renderer_frame *frame = &r->frames[i];
+
+		renderer_frame_fini_render(frame);
+
+		if (frame->fence != VK_NULL_HANDLE) {
+			vk->vkDestroyFence(vk->device, frame->fence, NULL);
+			frame->fence = VK_NULL_HANDLE;
+		}
+
+		frame->frame_id = -1;
+	}
+}
+
 //! Create renderer and initialize non-image-dependent members
 static void
 renderer_init(struct comp_renderer *r, struct comp_compositor *c, VkExtent2D scratch_extent)
@@ -515,20 +815,13 @@ renderer_init(struct comp_renderer *r, struct comp_compositor *c, VkExtent2D scr
 	r->settings = &c->settings;
 
 	r->acquired_buffer = -1;
-	r->fenced_buffer = -1;
 	r->rtr_array = NULL;
 
-	// Setup the scratch images.
-	bool bret = chl_scratch_ensure( //
-	    &c->scratch,                // scratch
-	    &c->nr,                     // struct render_resources
-	    c->nr.view_count,           // view_count
-	    scratch_extent,             // extent
-	    VK_FORMAT_R8G8B8A8_SRGB);   // format
-	if (!bret) {
-		COMP_ERROR(c, "chl_scratch_ensure: false");
-		assert(bret && "Whelp, can't return a error. But should never really fail.");
-	}
+	renderer_init_frames(r);
+
+	// The scratch images are allocated on first use.
+	r->scratch.extent = scratch_extent;
+	snprintf(r->compression.scratch, sizeof(r->compression.scratch), "NOT ALLOCATED");
 
 	// Try to early-allocate these, in case we can.
 	renderer_ensure_images_and_renderings(r, false);
@@ -544,30 +837,184 @@ renderer_init(struct comp_renderer *r, struct comp_compositor *c, VkExtent2D scr
 		COMP_ERROR(c, "comp_mirror_init: %s", vk_result_string(ret));
 		assert(false && "Whelp, can't return a error. But should never really fail.");
 	}
+
+	// Also times the mirror blit.
+	r->mirror_to_debug_gui.profiler = &c->nr.profiler;
+
+	// Optional, falls back to the main queue.
+	renderer_init_async_compute(r);
+
+	// Uploads on the queue the compute work is submitted to.
+	struct vk_bundle_queue *queue = &vk->main_queue;
+	if (r->async_compute.semaphore != VK_NULL_HANDLE) {
+		queue = &vk->compute_queue;
+	}
+
+	ret = comp_passthrough_init(&r->passthrough, vk, queue, c->xdev);
+	if (ret != VK_SUCCESS) {
+		COMP_ERROR(c, "comp_passthrough_init: %s", vk_result_string(ret));
+	}
 }
 
+/*!
+ * Allocates the scratch images if they are not already, resets the idle count.
+ */
+static bool
+renderer_ensure_scratch(struct comp_renderer *r)
+{
+	struct comp_compositor *c = r->c;
+
+	r->scratch.idle_frames = 0;
+
+	// Nothing to do if they are already allocated.
+	if (c->scratch.view_count != 0) {
+		return true;
+	}
+
+	bool bret = chl_scratch_ensure( //
+	    &c->scratch,                // scratch
+	    &c->nr,                     // struct render_resources
+	    c->nr.view_count,           // view_count
+	    r->scratch.extent,          // extent
+	    VK_FORMAT_R8G8B8A8_SRGB);   // format
+	if (!bret) {
+		COMP_ERROR(c, "chl_scratch_ensure: false");
+		return false;
+	}
+
+	VkImage image = c->scratch.views[0].cssi.images[0].image;
+	const char *str = vk_get_image_compression_string(&c->base.vk, image);
+	snprintf(r->compression.scratch, sizeof(r->compression.scratch), "%s", str);
+
+	return true;
+}
+
+/*!
+ * Called on frames that don't use the scratch images, releases them once they
+ * have been idle for @ref COMP_RENDERER_SCRATCH_IDLE_FRAMES frames.
+ */
 static void
-renderer_wait_for_last_fence(struct comp_renderer *r)
+renderer_release_scratch_if_idle(struct comp_renderer *r)
 {
-	COMP_TRACE_MARKER();
+	struct comp_compositor *c = r->c;
 
-	if (r->fenced_buffer < 0) {
+	if (c->scratch.view_count == 0) {
 		return;
 	}
 
-	struct vk_bundle *vk = &r->c->base.vk;
-	VkResult ret;
+	if (++r->scratch.idle_frames < COMP_RENDERER_SCRATCH_IDLE_FRAMES) {
+		return;
+	}
 
-	ret = vk->vkWaitForFences(vk->device, 1, &r->fences[r->fenced_buffer], VK_TRUE, UINT64_MAX);
-	if (ret != VK_SUCCESS) {
-		COMP_ERROR(r->c, "vkWaitForFences: %s", vk_result_string(ret));
+	COMP_DEBUG(c, "Releasing scratch images after %u idle frames.", r->scratch.idle_frames);
+
+	// Rarely happens, so just idle in case an earlier frame still uses them.
+	renderer_wait_queue_idle(r);
+
+	chl_scratch_free_resources(&c->scratch, &c->nr);
+
+	snprintf(r->compression.scratch, sizeof(r->compression.scratch), "NOT ALLOCATED");
+	r->scratch.idle_frames = 0;
+}
+
+static struct comp_renderer_frame *
+renderer_get_frame(struct comp_renderer *r)
+{
+	return &r->frames[r->c->nr.frame_index];
+}
+
+/*!
+ * Waits for the GPU to complete the frame last submitted with the frame
+ * resources at @p frame_index, reports its GPU timestamps to the target and
+ * reclaims the descriptor sets it used.
+ */
+static void
+renderer_retire_frame(struct comp_renderer *r, uint32_t frame_index)
+{
+	COMP_TRACE_MARKER();
+
+	struct comp_compositor *c = r->c;
+	struct vk_bundle *vk = &c->base.vk;
+	struct comp_renderer_frame *frame = &r->frames[frame_index];
+
+	if (frame->frame_id >= 0) {
+		VkResult ret = vk->vkWaitForFences(vk->device, 1, &frame->fence, VK_TRUE, UINT64_MAX);
+		if (ret != VK_SUCCESS) {
+			COMP_ERROR(c, "vkWaitForFences: %s", vk_result_string(ret));
+		}
+
+		// Get timestamps of GPU work (if available).
+		uint64_t gpu_start_ns, gpu_end_ns;
+		if (ret == VK_SUCCESS &&
+		    render_resources_get_timestamps(&c->nr, frame_index, &gpu_start_ns, &gpu_end_ns)) {
+			uint64_t now_ns = os_monotonic_get_ns();
+			comp_target_info_gpu(c->target, frame->frame_id, gpu_start_ns, gpu_end_ns, now_ns);
+		}
+
+		frame->frame_id = -1;
 	}
 
-	r->fenced_buffer = -1;
+	// The GPU is done with them, free any resources.
+	renderer_frame_fini_render(frame);
+}
+
+/*!
+ * Moves on to the next frame resources, both ours and those of the
+ * @ref render_resources, and retires the frame that was last submitted with
+ * them. So the CPU only waits on the frame before the previous one, and can
+ * record while the GPU is still working on the previous frame.
+ *
+ * Called before acquiring the target image, as the target's acquire
+ * semaphores are also rotated per frame.
+ */
+static void
+renderer_next_frame_resources(struct comp_renderer *r)
+{
+	uint32_t frame_index = render_resources_next_frame(&r->c->nr);
+
+	renderer_retire_frame(r, frame_index);
+}
+
+/*!
+ * Makes the main queue wait for the latest work submitted to the compute
+ * queue, everything else (present, mirroring, peek) and the existing queue
+ * idle waits stay on the main queue so this keeps them correctly ordered.
+ */
+static XRT_CHECK_RESULT VkResult
+renderer_join_main_queue(struct comp_renderer *r)
+{
+	struct vk_bundle *vk = &r->c->base.vk;
+
+#ifdef VK_KHR_timeline_semaphore
+	VkPipelineStageFlags stage_flags = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	uint64_t wait_value = r->async_compute.value;
+
+	VkTimelineSemaphoreSubmitInfoKHR timeline_info = {
+	    .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+	    .waitSemaphoreValueCount = 1,
+	    .pWaitSemaphoreValues = &wait_value,
+	};
+
+	VkSubmitInfo join_submit_info = {
+	    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+	    .pNext = &timeline_info,
+	    .waitSemaphoreCount = 1,
+	    .pWaitSemaphores = &r->async_compute.semaphore,
+	    .pWaitDstStageMask = &stage_flags,
+	};
+
+	return vk_cmd_submit_locked(vk, &vk->main_queue, 1, &join_submit_info, VK_NULL_HANDLE);
+#else
+	(void)vk;
+	return VK_ERROR_FEATURE_NOT_PRESENT;
+#endif
 }
 
 static XRT_CHECK_RESULT VkResult
-renderer_submit_queue(struct comp_renderer *r, VkCommandBuffer cmd, VkPipelineStageFlags pipeline_stage_flag)
+renderer_submit_queue(struct comp_renderer *r,
+                      struct vk_bundle_queue *queue,
+                      VkCommandBuffer cmd,
+                      VkPipelineStageFlags pipeline_stage_flag)
 {
 	COMP_TRACE_MARKER();
 
@@ -579,15 +1026,14 @@ renderer_submit_queue(struct comp_renderer *r, VkCommandBuffer cmd, VkPipelineSt
 
 
 	/*
-	 * Wait for previous frame's work to complete.
+	 * The frame resources' previous work was waited on before acquiring.
 	 */
 
-	// Wait for the last fence, if any.
-	renderer_wait_for_last_fence(r);
-	assert(r->fenced_buffer < 0);
+	struct comp_renderer_frame *frame = renderer_get_frame(r);
+	assert(frame->frame_id < 0);
 
 	assert(r->acquired_buffer >= 0);
-	ret = vk->vkResetFences(vk->device, 1, &r->fences[r->acquired_buffer]);
+	ret = vk->vkResetFences(vk->device, 1, &frame->fence);
 	VK_CHK_AND_RET(ret, "vkResetFences");
 
 
@@ -611,36 +1057,54 @@ renderer_submit_queue(struct comp_renderer *r, VkCommandBuffer cmd, VkPipelineSt
 		wait_sem_count = WAIT_SEMAPHORE_COUNT;
 	}
 
-#define SIGNAL_SEMAPHRE_COUNT 1
-	VkSemaphore signal_sems[SIGNAL_SEMAPHRE_COUNT] = {ct->semaphores.render_complete};
-
+#define SIGNAL_SEMAPHRE_COUNT 2
+	VkSemaphore signal_sems[SIGNAL_SEMAPHRE_COUNT];
+	uint64_t signal_values[SIGNAL_SEMAPHRE_COUNT];
 	uint32_t signal_sem_count = 0;
-	VkSemaphore *signal_sems_ptr = NULL;
-	if (signal_sems[0] != VK_NULL_HANDLE) {
-		signal_sems_ptr = signal_sems;
-		signal_sem_count = SIGNAL_SEMAPHRE_COUNT;
+	bool any_timeline = false;
+
+	assert(!comp_frame_is_invalid_locked(&r->c->frame.rendering));
+
+	// The target's semaphore for the acquired buffer, which present waits on.
+	if (ct->semaphores.render_complete != VK_NULL_HANDLE) {
+		signal_sems[signal_sem_count] = ct->semaphores.render_complete;
+		signal_values[signal_sem_count] = (uint64_t)frame_id; // Ignored if not a timeline semaphore.
+		any_timeline |= ct->semaphores.render_complete_is_timeline;
+		signal_sem_count++;
+	}
+
+	// Not on the main queue, let it know when we are done.
+	bool async = queue != &vk->main_queue;
+	if (async) {
+		assert(r->async_compute.semaphore != VK_NULL_HANDLE);
+		signal_sems[signal_sem_count] = r->async_compute.semaphore;
+		signal_values[signal_sem_count] = ++r->async_compute.value;
+		any_timeline = true;
+		signal_sem_count++;
 	}
 
+	VkSemaphore *signal_sems_ptr = signal_sem_count > 0 ? signal_sems : NULL;
+
 	// Next pointer for VkSubmitInfo
 	const void *next = NULL;
 
 #ifdef VK_KHR_timeline_semaphore
-	assert(!comp_frame_is_invalid_locked(&r->c->frame.rendering));
-	uint64_t render_complete_signal_values[SIGNAL_SEMAPHRE_COUNT] = {(uint64_t)frame_id};
-
 	VkTimelineSemaphoreSubmitInfoKHR timeline_info = {
 	    .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
 	};
 
-	if (ct->semaphores.render_complete_is_timeline) {
+	if (any_timeline) {
 		timeline_info = (VkTimelineSemaphoreSubmitInfoKHR){
 		    .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
 		    .signalSemaphoreValueCount = signal_sem_count,
-		    .pSignalSemaphoreValues = render_complete_signal_values,
+		    .pSignalSemaphoreValues = signal_values,
 		};
 
 		CHAIN(timeline_info, next);
 	}
+#else
+	(void)any_timeline;
+	(void)signal_values;
 #endif
 
 
@@ -665,7 +1129,17 @@ renderer_submit_queue(struct comp_renderer *r, VkCommandBuffer cmd, VkPipelineSt
 	 * us avoid taking a lot of locks. The queue lock will be taken by
 	 * @ref vk_cmd_submit_locked tho.
 	 */
-	ret = vk_cmd_submit_locked(vk, &vk->main_queue, 1, &comp_submit_info, r->fences[r->acquired_buffer]);
+	ret = vk_cmd_submit_locked(vk, queue, 1, &comp_submit_info, frame->fence);
+
+	// These frame resources now have a pending fence.
+	if (ret == VK_SUCCESS) {
+		frame->frame_id = frame_id;
+	}
+
+	// Order everything submitted later to the main queue after our work.
+	if (ret == VK_SUCCESS && async) {
+		ret = renderer_join_main_queue(r);
+	}
 
 	// We have now completed the submit, even if we failed.
 	comp_target_mark_submit_end(ct, frame_id, os_monotonic_get_ns());
@@ -673,9 +1147,6 @@ renderer_submit_queue(struct comp_renderer *r, VkCommandBuffer cmd, VkPipelineSt
 	// Check after marking as submit complete.
 	VK_CHK_AND_RET(ret, "vk_cmd_submit_locked");
 
-	// This buffer now have a pending fence.
-	r->fenced_buffer = r->acquired_buffer;
-
 	return ret;
 }
 
@@ -693,6 +1164,10 @@ renderer_acquire_swapchain_image(struct comp_renderer *r)
 		// Not ready yet.
 		return;
 	}
+
+	// Makes sure the acquire semaphore is no longer used.
+	renderer_next_frame_resources(r);
+
 	ret = comp_target_acquire(r->c->target, &buffer_index);
 
 	if ((ret == VK_ERROR_OUT_OF_DATE_KHR) || (ret == VK_SUBOPTIMAL_KHR)) {
@@ -723,8 +1198,9 @@ renderer_resize(struct comp_renderer *r)
 {
 	if (!comp_target_check_ready(r->c->target)) {
 		// Can't create images right now.
-		// Just close any existing renderings.
-		renderer_close_renderings_and_fences(r);
+		// Just close any existing renderings, once the GPU is done with them.
+		renderer_wait_queue_idle(r);
+		renderer_close_renderings(r);
 		return;
 	}
 	// Force recreate.
@@ -817,14 +1293,30 @@ renderer_fini(struct comp_renderer *r)
 {
 	struct vk_bundle *vk = &r->c->base.vk;
 
+	// Frames might still be in flight, this is teardown so isn't time critical.
+	renderer_wait_queue_idle(r);
+
 	// Command buffers
-	renderer_close_renderings_and_fences(r);
+	renderer_close_renderings(r);
+
+	renderer_fini_frames(r);
+
+	u_var_remove_root(&r->compression);
 
 	// Do before layer render just in case it holds any references.
 	comp_mirror_fini(&r->mirror_to_debug_gui, vk);
 
+	// Holds references to frames from the device.
+	comp_passthrough_fini(&r->passthrough, vk);
+
 	// Do this after the layer renderer.
 	chl_scratch_free_resources(&r->c->scratch, &r->c->nr);
+
+	if (r->async_compute.semaphore != VK_NULL_HANDLE) {
+		// The main queue waits on it, so idle above means it is no longer in use.
+		vk->vkDestroySemaphore(vk->device, r->async_compute.semaphore, NULL);
+		r->async_compute.semaphore = VK_NULL_HANDLE;
+	}
 }
 
 
@@ -890,7 +1382,8 @@ dispatch_graphics(struct comp_renderer *r,
 	    vertex_rots);                     //
 
 	// Everything is ready, submit to the queue.
-	ret = renderer_submit_queue(r, render->r->cmd, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+	VkPipelineStageFlags stage_flags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	ret = renderer_submit_queue(r, &vk->main_queue, render->frame->cmd, stage_flags);
 	VK_CHK_AND_RET(ret, "renderer_submit_queue");
 
 	return ret;
@@ -903,6 +1396,28 @@ dispatch_graphics(struct comp_renderer *r,
  *
  */
 
+/*!
+ * The layer squasher reuses descriptor sets that refer to the same image
+ * views, forget them if any swapchain or camera views have been destroyed
+ * since the last frame as the handles might have been reused.
+ */
+static void
+renderer_check_layer_descriptors(struct comp_renderer *r)
+{
+	struct comp_compositor *c = r->c;
+
+	uint64_t swapchain = c->base.cscs.destroy_generation;
+	uint64_t passthrough = r->passthrough.image_generation;
+	if (r->descriptor_generation.swapchain == swapchain && r->descriptor_generation.passthrough == passthrough) {
+		return;
+	}
+
+	render_resources_invalidate_layer_descriptors(&c->nr);
+
+	r->descriptor_generation.swapchain = swapchain;
+	r->descriptor_generation.passthrough = passthrough;
+}
+
 /*!
  * @pre render_compute_init(render, &c->nr)
  */
@@ -942,6 +1457,24 @@ dispatch_compute(struct comp_renderer *r,
 	struct render_viewport_data target_viewport_datas[XRT_MAX_VIEWS];
 	calc_viewport_data(r, target_viewport_datas, render->r->view_count);
 
+	// Submitted before the squasher below, on the same queue.
+	xrt_result_t xret = comp_passthrough_upload(&r->passthrough, vk, layers, layer_count);
+	if (xret != XRT_SUCCESS) {
+		COMP_ERROR(c, "comp_passthrough_upload failed, showing the previous camera images");
+	}
+
+	// After the upload, it can recreate the camera images.
+	renderer_check_layer_descriptors(r);
+
+	// Not touched when the views are added.
+	for (uint32_t i = 0; i < render->r->view_count; i++) {
+		comp_passthrough_get_view(&r->passthrough, i, &frame_state->data.views[i].passthrough);
+	}
+
+	if (frame_state->data.do_foveation) {
+		calc_foveal_rects(r, world_poses, fovs, frame_state->data.views, render->r->view_count);
+	}
+
 	// Does everything.
 	chl_frame_state_cs_default_pipeline( //
 	    frame_state,                     //
@@ -955,8 +1488,13 @@ dispatch_compute(struct comp_renderer *r,
 	    target_storage_view,             //
 	    target_viewport_datas);          //
 
-	// Everything is ready, submit to the queue.
-	ret = renderer_submit_queue(r, render->r->cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+	// Everything is ready, submit to the compute queue if we have one.
+	struct vk_bundle_queue *queue = &vk->main_queue;
+	if (r->async_compute.semaphore != VK_NULL_HANDLE) {
+		queue = &vk->compute_queue;
+	}
+
+	ret = renderer_submit_queue(r, queue, render->frame->cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
 	VK_CHK_AND_RET(ret, "renderer_submit_queue");
 
 	return ret;
@@ -999,6 +1537,21 @@ comp_renderer_draw(struct comp_renderer *r)
 		return XRT_SUCCESS;
 	}
 
+	/*
+	 * The fast path goes straight from the app's images to the distortion,
+	 * the peek window and readback to the debug UI blit from the scratch
+	 * images so they disable the fast path, but check them here too.
+	 */
+	bool needs_scratch =                                        //
+	    !c->base.frame_params.one_projection_layer_fast_path || //
+	    c->peek != NULL ||                                      //
+	    c->mirroring_to_debug_gui;                              //
+	if (!needs_scratch) {
+		renderer_release_scratch_if_idle(r);
+	} else if (!renderer_ensure_scratch(r)) {
+		return XRT_ERROR_VULKAN;
+	}
+
 	comp_target_flush(ct);
 
 	comp_target_update_timings(ct);
@@ -1010,6 +1563,8 @@ comp_renderer_draw(struct comp_renderer *r)
 
 	comp_target_update_timings(ct);
 
+	renderer_profiler_begin_frame(r, c->frame.rendering.id);
+
 	// Hardcoded for now.
 	const uint32_t view_count = c->nr.view_count;
 	enum comp_target_fov_source fov_source = COMP_TARGET_FOV_SOURCE_DISTORTION;
@@ -1030,17 +1585,26 @@ comp_renderer_draw(struct comp_renderer *r)
 	    fast_path,        //
 	    &c->scratch);     //
 
+	// Only used by the compute layer squasher.
+	frame_state.data.do_depth_reprojection = do_timewarp && c->settings.use_depth_reprojection;
+	frame_state.data.do_foveation = c->settings.foveation_degrees > 0.0f;
+
 	bool use_compute = r->settings->use_compute;
-	struct render_gfx render_g = {0};
-	struct render_compute render_c = {0};
+
+	/*
+	 * Already retired when the image was acquired, unless the last frame
+	 * failed before presenting and its image and resources are reused.
+	 */
+	renderer_retire_frame(r, c->nr.frame_index);
+	struct comp_renderer_frame *frame = renderer_get_frame(r);
 
 	VkResult res = VK_SUCCESS;
 	if (use_compute) {
-		render_compute_init(&render_c, &c->nr);
-		res = dispatch_compute(r, &render_c, &frame_state, fov_source);
+		render_compute_init(&frame->render_c, &c->nr);
+		res = dispatch_compute(r, &frame->render_c, &frame_state, fov_source);
 	} else {
-		render_gfx_init(&render_g, &c->nr);
-		res = dispatch_graphics(r, &render_g, &frame_state, fov_source);
+		render_gfx_init(&frame->render_g, &c->nr);
+		res = dispatch_graphics(r, &frame->render_g, &frame_state, fov_source);
 	}
 	if (res != VK_SUCCESS) {
 		return XRT_ERROR_VULKAN;
@@ -1075,6 +1639,9 @@ comp_renderer_draw(struct comp_renderer *r)
 			                      c->target->height);
 			break;
 		}
+
+		// The blit leaves the scratch images in another layout.
+		chl_scratch_invalidate_cache(&c->scratch);
 	}
 #endif
 
@@ -1117,44 +1684,13 @@ comp_renderer_draw(struct comp_renderer *r)
 	}
 
 	/*
-	 * This fixes a lot of validation issues as it makes sure that the
-	 * command buffer has completed and all resources referred by it can
-	 * now be manipulated.
-	 *
-	 * This is done after a swap so isn't time critical.
-	 */
-	renderer_wait_queue_idle(r);
-
-	/*
-	 * Free any resources and finalize the scratch images,
-	 * which sends them send to debug UI if it is active.
+	 * Finalize the scratch images, which sends them send to debug UI if it
+	 * is active. There is no waiting on the GPU here, the frame resources
+	 * are freed and the timestamps reported when they are next reused, so
+	 * the next frame can be recorded while the GPU works on this one.
 	 */
 	chl_frame_state_fini(&frame_state);
 
-	// Check timestamps.
-	if (xret == XRT_SUCCESS) {
-		/*
-		 * Get timestamps of GPU work (if available).
-		 */
-
-		uint64_t gpu_start_ns, gpu_end_ns;
-		if (render_resources_get_timestamps(&c->nr, &gpu_start_ns, &gpu_end_ns)) {
-			uint64_t now_ns = os_monotonic_get_ns();
-			comp_target_info_gpu(ct, frame_id, gpu_start_ns, gpu_end_ns, now_ns);
-		}
-	}
-
-
-	/*
-	 * Free resources.
-	 */
-
-	if (use_compute) {
-		render_compute_fini(&render_c);
-	} else {
-		render_gfx_fini(&render_g);
-	}
-
 	renderer_wait_for_present(r, desired_present_time_ns);
 
 	comp_target_update_timings(ct);
@@ -1196,4 +1732,8 @@ comp_renderer_add_debug_vars(struct comp_renderer *self)
 	struct comp_renderer *r = self;
 
 	comp_mirror_add_debug_vars(&r->mirror_to_debug_gui, r->c);
+
+	u_var_add_root(&r->compression, "Framebuffer compression", true);
+	u_var_add_ro_text(&r->compression, r->compression.scratch, "Scratch images");
+	u_var_add_ro_text(&r->compression, r->compression.target, "Target images");
 }
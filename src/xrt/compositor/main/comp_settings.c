@@ -24,12 +24,18 @@ DEBUG_GET_ONCE_BOOL_OPTION(force_xcb, "XRT_COMPOSITOR_FORCE_XCB", false)
 DEBUG_GET_ONCE_BOOL_OPTION(force_wayland, "XRT_COMPOSITOR_FORCE_WAYLAND", false)
 DEBUG_GET_ONCE_NUM_OPTION(force_gpu_index, "XRT_COMPOSITOR_FORCE_GPU_INDEX", -1)
 DEBUG_GET_ONCE_NUM_OPTION(force_client_gpu_index, "XRT_COMPOSITOR_FORCE_CLIENT_GPU_INDEX", -1)
+DEBUG_GET_ONCE_BOOL_OPTION(use_display_gpu, "XRT_COMPOSITOR_USE_DISPLAY_GPU", false)
 DEBUG_GET_ONCE_NUM_OPTION(desired_mode, "XRT_COMPOSITOR_DESIRED_MODE", -1)
 DEBUG_GET_ONCE_NUM_OPTION(scale_percentage, "XRT_COMPOSITOR_SCALE_PERCENTAGE", 140)
 DEBUG_GET_ONCE_BOOL_OPTION(xcb_fullscreen, "XRT_COMPOSITOR_XCB_FULLSCREEN", false)
 DEBUG_GET_ONCE_NUM_OPTION(xcb_display, "XRT_COMPOSITOR_XCB_DISPLAY", -1)
 DEBUG_GET_ONCE_NUM_OPTION(default_framerate, "XRT_COMPOSITOR_DEFAULT_FRAMERATE", 60)
 DEBUG_GET_ONCE_BOOL_OPTION(compute, "XRT_COMPOSITOR_COMPUTE", USE_COMPUTE_DEFAULT)
+DEBUG_GET_ONCE_BOOL_OPTION(compute_async, "XRT_COMPOSITOR_COMPUTE_ASYNC", false)
+DEBUG_GET_ONCE_BOOL_OPTION(depth_reprojection, "XRT_COMPOSITOR_DEPTH_REPROJECTION", false)
+DEBUG_GET_ONCE_FLOAT_OPTION(foveation_degrees, "XRT_COMPOSITOR_FOVEATION_DEGREES", 0.0f)
+DEBUG_GET_ONCE_BOOL_OPTION(front_buffer, "XRT_COMPOSITOR_FRONT_BUFFER", false)
+DEBUG_GET_ONCE_BOOL_OPTION(compact_distortion, "XRT_COMPOSITOR_COMPACT_DISTORTION", true)
 // clang-format on
 
 static inline void
@@ -65,6 +71,10 @@ comp_settings_init(struct comp_settings *s, struct xrt_device *xdev)
 	}
 
 	s->use_compute = debug_get_bool_option_compute();
+	s->use_async_compute = s->use_compute && debug_get_bool_option_compute_async();
+	s->use_depth_reprojection = s->use_compute && debug_get_bool_option_depth_reprojection();
+	s->foveation_degrees = s->use_compute ? debug_get_float_option_foveation_degrees() : 0.0f;
+	s->use_compact_distortion = debug_get_bool_option_compact_distortion();
 
 	if (s->use_compute) {
 		// Tested working with a PSVR2 and a patched Mesa. Native format of the PSVR2. 10-bit formats should be
@@ -119,6 +129,7 @@ comp_settings_init(struct comp_settings *s, struct xrt_device *xdev)
 	s->display = debug_get_num_option_xcb_display();
 	s->color_space = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
 	s->present_mode = VK_PRESENT_MODE_FIFO_KHR;
+	s->use_front_buffer = debug_get_bool_option_front_buffer();
 	s->fullscreen = debug_get_bool_option_xcb_fullscreen();
 	s->preferred.width = xdev->hmd->screens[0].w_pixels;
 	s->preferred.height = xdev->hmd->screens[0].h_pixels;
@@ -127,6 +138,7 @@ comp_settings_init(struct comp_settings *s, struct xrt_device *xdev)
 	s->print_modes = debug_get_bool_option_print_modes();
 	s->selected_gpu_index = debug_get_num_option_force_gpu_index();
 	s->client_gpu_index = debug_get_num_option_force_client_gpu_index();
+	s->use_display_gpu = debug_get_bool_option_use_display_gpu();
 	s->desired_mode = debug_get_num_option_desired_mode();
 	s->viewport_scale = debug_get_num_option_scale_percentage() / 100.0;
 
@@ -50,12 +50,34 @@ struct comp_settings
 
 	bool use_compute;
 
+	//! Submit the compute work on @ref vk_bundle::compute_queue, if available.
+	bool use_async_compute;
+
+	//! Reproject projection layers with depth for position too, compute only.
+	bool use_depth_reprojection;
+
+	/*!
+	 * Half angle around the gaze, or the middle of the views without eye
+	 * tracking, that is squashed at full rate. The rest is squashed at a
+	 * quarter of the rate, zero turns it off, compute only.
+	 */
+	float foveation_degrees;
+
+	//! Store the compute distortion lookups as 16 bit images, if accurate enough.
+	bool use_compact_distortion;
+
 	VkFormat formats[XRT_MAX_SWAPCHAIN_FORMATS];
 	uint32_t format_count;
 
 	VkColorSpaceKHR color_space;
 	VkPresentModeKHR present_mode;
 
+	/*!
+	 * Render into a single shared presentable front buffer that is
+	 * continuously scanned out, if the target supports it.
+	 */
+	bool use_front_buffer;
+
 	//! Preferred window type to use, not actual used.
 	const char *target_identifier;
 
@@ -93,6 +115,13 @@ struct comp_settings
 	//! Vulkan physical device index for clients to use, forced by user
 	int client_gpu_index;
 
+	/*!
+	 * Composite and scan out on the GPU that the displays are connected
+	 * to, while suggesting the preferred (discrete) GPU to clients for
+	 * rendering. Only applies to indices not forced by the user.
+	 */
+	bool use_display_gpu;
+
 
 	//! Vulkan device UUID selected by comp_settings_check_vulkan_caps, valid across Vulkan instances
 	xrt_uuid_t selected_gpu_deviceUUID;
@@ -1,4 +1,4 @@
-// Copyright 2020, Collabora, Ltd.
+// Copyright 2020-2025, Collabora, Ltd.
 // Copyright 2024-2025, NVIDIA CORPORATION.
 // SPDX-License-Identifier: BSL-1.0
 /*!
@@ -100,13 +100,15 @@ struct comp_target_create_images_info
 struct comp_target_semaphores
 {
 	/*!
-	 * Optional semaphore the target should signal when present is complete.
+	 * Optional semaphore the target should signal when present is complete,
+	 * may be a different one after each acquire.
 	 */
 	VkSemaphore present_complete;
 
 	/*!
 	 * Semaphore the renderer (consuming this target)
-	 * should signal when rendering is complete.
+	 * should signal when rendering is complete,
+	 * may be a different one after each acquire.
 	 */
 	VkSemaphore render_complete;
 
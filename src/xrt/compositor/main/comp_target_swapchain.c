@@ -1,4 +1,4 @@
-// Copyright 2019-2021, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // Copyright 2024-2025, NVIDIA CORPORATION.
 // SPDX-License-Identifier: BSL-1.0
 /*!
@@ -9,6 +9,8 @@
  * @ingroup comp_main
  */
 
+#include "xrt/xrt_config_os.h"
+
 #include "os/os_threading.h"
 
 #include "util/u_misc.h"
@@ -48,6 +50,21 @@
 DEBUG_GET_ONCE_NUM_OPTION(preferred_at_least_image_count, "XRT_COMPOSITOR_PREFERRED_IMAGE_COUNT", 2)
 DEBUG_GET_ONCE_BOOL_OPTION(use_present_wait, "XRT_COMPOSITOR_USE_PRESENT_WAIT", false)
 
+/*
+ * Present timing times are only directly comparable with os_monotonic_get_ns
+ * in the CLOCK_MONOTONIC domain, the Windows domain is in QPC ticks.
+ */
+#if defined(VK_EXT_present_timing) && defined(XRT_OS_LINUX)
+#define USE_PRESENT_TIMING
+
+//! How many past presentation timings the swapchain keeps for us.
+#define PRESENT_TIMING_QUEUE_SIZE (16)
+
+//! The stages we ask for, first pixel out is also the stage that target times are for.
+#define PRESENT_TIMING_STAGES                                                                                          \
+	(VK_PRESENT_STAGE_QUEUE_OPERATIONS_END_BIT_EXT | VK_PRESENT_STAGE_IMAGE_FIRST_PIXEL_OUT_BIT_EXT)
+#endif
+
 static inline struct vk_bundle *
 get_vk(struct comp_target_swapchain *cts)
 {
@@ -74,6 +91,11 @@ destroy_image_views(struct comp_target_swapchain *cts)
 	struct vk_bundle *vk = get_vk(cts);
 
 	for (uint32_t i = 0; i < cts->base.image_count; i++) {
+		if (cts->acquire.render_completes[i] != VK_NULL_HANDLE) {
+			vk->vkDestroySemaphore(vk->device, cts->acquire.render_completes[i], NULL);
+			cts->acquire.render_completes[i] = VK_NULL_HANDLE;
+		}
+
 		if (cts->base.images[i].view == VK_NULL_HANDLE) {
 			continue;
 		}
@@ -82,6 +104,10 @@ destroy_image_views(struct comp_target_swapchain *cts)
 		cts->base.images[i].view = VK_NULL_HANDLE;
 	}
 
+	free(cts->acquire.render_completes);
+	cts->acquire.render_completes = NULL;
+	cts->base.semaphores.render_complete = VK_NULL_HANDLE;
+
 	free(cts->base.images);
 	cts->base.images = NULL;
 }
@@ -111,6 +137,7 @@ create_image_views(struct comp_target_swapchain *cts)
 
 	cts->base.image_count = image_count;
 	cts->base.images = U_TYPED_ARRAY_CALLOC(struct comp_target_image, cts->base.image_count);
+	cts->acquire.render_completes = U_TYPED_ARRAY_CALLOC(VkSemaphore, cts->base.image_count);
 
 	VkImageSubresourceRange subresource_range = {
 	    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
@@ -134,6 +161,28 @@ create_image_views(struct comp_target_swapchain *cts)
 		VK_NAME_IMAGE_VIEW(vk, cts->base.images[i].view, "comp_target_swapchain image view");
 	}
 
+
+	/*
+	 * Create render complete semaphores.
+	 */
+
+	VkSemaphoreCreateInfo semaphore_info = {
+	    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+	};
+
+	for (uint32_t i = 0; i < cts->base.image_count; i++) {
+		ret = vk->vkCreateSemaphore(vk->device, &semaphore_info, NULL, &cts->acquire.render_completes[i]);
+		if (ret != VK_SUCCESS) {
+			COMP_ERROR(cts->base.c, "vkCreateSemaphore: %s", vk_result_string(ret));
+		}
+
+		VK_NAME_SEMAPHORE(vk, cts->acquire.render_completes[i],
+		                  "comp_target_swapchain semaphore render complete");
+	}
+
+	// Set on each acquire, but have a valid one before the first.
+	cts->base.semaphores.render_complete = cts->acquire.render_completes[0];
+
 	free(images);
 
 	return;
@@ -203,6 +252,52 @@ select_image_count(struct comp_target_swapchain *cts,
 	return preferred_at_least_image_count;
 }
 
+/*!
+ * Switches to the shared continuous refresh present mode if front buffer
+ * rendering was asked for and is supported, leaves the present mode alone if not.
+ */
+static void
+select_front_buffer_present_mode(struct comp_target_swapchain *cts, const struct vk_surface_info *info)
+{
+	struct comp_compositor *c = cts->base.c;
+
+	if (!c->settings.use_front_buffer) {
+		return;
+	}
+
+#ifdef VK_KHR_shared_presentable_image
+	struct vk_bundle *vk = get_vk(cts);
+
+	// The compute path always transitions the target to VK_IMAGE_LAYOUT_PRESENT_SRC_KHR.
+	if (c->settings.use_compute) {
+		COMP_WARN(c, "Front buffer rendering is only supported with the graphics pipeline.");
+		return;
+	}
+
+	if (!vk->has_KHR_shared_presentable_image) {
+		COMP_WARN(c, "Front buffer rendering wanted, but VK_KHR_shared_presentable_image is not available.");
+		return;
+	}
+
+	const VkPresentModeKHR present_mode = VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR;
+	for (uint32_t i = 0; i < info->present_mode_count; i++) {
+		if (info->present_modes[i] != present_mode) {
+			continue;
+		}
+
+		COMP_INFO(c, "Using front buffer rendering (%s).", vk_present_mode_string(present_mode));
+		cts->present_mode = present_mode;
+		cts->front_buffer.active = true;
+		return;
+	}
+
+	COMP_WARN(c, "Front buffer rendering wanted, but the surface doesn't support %s.",
+	          vk_present_mode_string(present_mode));
+#else
+	COMP_WARN(c, "Front buffer rendering wanted, but built without VK_KHR_shared_presentable_image.");
+#endif
+}
+
 static bool
 check_surface_present_mode(struct comp_target_swapchain *cts,
                            const struct vk_surface_info *info,
@@ -365,6 +460,178 @@ do_update_timings_google_display_timing(struct comp_target_swapchain *cts)
 	free(timings);
 }
 
+#ifdef USE_PRESENT_TIMING
+static void
+do_update_timings_present_timing(struct comp_target_swapchain *cts)
+{
+	struct vk_bundle *vk = get_vk(cts);
+	VkResult ret;
+
+	if (!cts->present_timing.active || cts->swapchain.handle == VK_NULL_HANDLE) {
+		return;
+	}
+
+	VkPresentStageTimeEXT stages[PRESENT_TIMING_QUEUE_SIZE][2];
+	VkPastPresentationTimingEXT timings[PRESENT_TIMING_QUEUE_SIZE];
+	for (uint32_t i = 0; i < ARRAY_SIZE(timings); i++) {
+		timings[i] = (VkPastPresentationTimingEXT){
+		    .sType = VK_STRUCTURE_TYPE_PAST_PRESENTATION_TIMING_EXT,
+		    .presentStageCount = ARRAY_SIZE(stages[i]),
+		    .pPresentStages = stages[i],
+		};
+	}
+
+	VkPastPresentationTimingInfoEXT timing_info = {
+	    .sType = VK_STRUCTURE_TYPE_PAST_PRESENTATION_TIMING_INFO_EXT,
+	    .swapchain = cts->swapchain.handle,
+	};
+
+	VkPastPresentationTimingPropertiesEXT timing_props = {
+	    .sType = VK_STRUCTURE_TYPE_PAST_PRESENTATION_TIMING_PROPERTIES_EXT,
+	    .presentationTimingCount = ARRAY_SIZE(timings),
+	    .pPresentationTimings = timings,
+	};
+
+	// Incomplete just means there are more left for the next call.
+	ret = vk->vkGetPastPresentationTimingEXT(vk->device, &timing_info, &timing_props);
+	if (ret != VK_SUCCESS && ret != VK_INCOMPLETE) {
+		COMP_ERROR(cts->base.c, "vkGetPastPresentationTimingEXT: %s", vk_result_string(ret));
+		return;
+	}
+
+	int64_t now_ns = os_monotonic_get_ns();
+	for (uint32_t i = 0; i < timing_props.presentationTimingCount; i++) {
+		const VkPastPresentationTimingEXT *timing = &timings[i];
+		if (!timing->reportComplete) {
+			continue;
+		}
+
+		int64_t queue_done_ns = 0;
+		int64_t first_pixel_out_ns = 0;
+		for (uint32_t k = 0; k < timing->presentStageCount; k++) {
+			const VkPresentStageTimeEXT *stage = &timing->pPresentStages[k];
+			if (stage->stage == VK_PRESENT_STAGE_QUEUE_OPERATIONS_END_BIT_EXT) {
+				queue_done_ns = (int64_t)stage->time;
+			} else if (stage->stage == VK_PRESENT_STAGE_IMAGE_FIRST_PIXEL_OUT_BIT_EXT) {
+				first_pixel_out_ns = (int64_t)stage->time;
+			}
+		}
+
+		// Never displayed, nothing to learn from it.
+		if (first_pixel_out_ns == 0) {
+			continue;
+		}
+
+		/*
+		 * There is no earliest present time in this extension, so treat
+		 * the actual time as the earliest and use the time between the
+		 * queue being done and first pixel out as the margin.
+		 */
+		int64_t margin_ns = queue_done_ns != 0 ? first_pixel_out_ns - queue_done_ns : 0;
+
+		u_pc_info(cts->upc,                    //
+		          (int64_t)timing->presentId,  //
+		          (int64_t)timing->targetTime, //
+		          first_pixel_out_ns,          //
+		          first_pixel_out_ns,          //
+		          margin_ns,                   //
+		          now_ns);                     //
+	}
+}
+
+static bool
+check_present_timing_support(struct comp_target_swapchain *cts)
+{
+	struct vk_bundle *vk = get_vk(cts);
+	VkResult ret;
+
+	// Present ids come from VK_KHR_present_id, which is enabled together with present wait.
+	if (!vk->features.present_timing || !vk->features.present_wait || !vk->has_KHR_get_surface_capabilities2) {
+		return false;
+	}
+
+	VkPresentTimingSurfaceCapabilitiesEXT timing_caps = {
+	    .sType = VK_STRUCTURE_TYPE_PRESENT_TIMING_SURFACE_CAPABILITIES_EXT,
+	};
+
+	VkSurfaceCapabilities2KHR caps = {
+	    .sType = VK_STRUCTURE_TYPE_SURFACE_CAPABILITIES_2_KHR,
+	    .pNext = &timing_caps,
+	};
+
+	VkPhysicalDeviceSurfaceInfo2KHR surface_info = {
+	    .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SURFACE_INFO_2_KHR,
+	    .surface = cts->surface.handle,
+	};
+
+	ret = vk->vkGetPhysicalDeviceSurfaceCapabilities2KHR(vk->physical_device, &surface_info, &caps);
+	if (ret != VK_SUCCESS) {
+		COMP_ERROR(cts->base.c, "vkGetPhysicalDeviceSurfaceCapabilities2KHR: %s", vk_result_string(ret));
+		return false;
+	}
+
+	return timing_caps.presentTimingSupported &&         //
+	       timing_caps.presentAtAbsoluteTimeSupported && //
+	       (timing_caps.presentStageQueries & PRESENT_TIMING_STAGES) == PRESENT_TIMING_STAGES;
+}
+
+static void
+setup_present_timing(struct comp_target_swapchain *cts)
+{
+	struct vk_bundle *vk = get_vk(cts);
+	uint64_t *ids = NULL;
+	VkTimeDomainKHR *domains = NULL;
+	VkResult ret;
+
+	ret = vk->vkSetSwapchainPresentTimingQueueSizeEXT(vk->device, cts->swapchain.handle, PRESENT_TIMING_QUEUE_SIZE);
+	if (ret != VK_SUCCESS) {
+		COMP_ERROR(cts->base.c, "vkSetSwapchainPresentTimingQueueSizeEXT: %s", vk_result_string(ret));
+		return;
+	}
+
+	VkSwapchainTimeDomainPropertiesEXT domain_props = {
+	    .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_TIME_DOMAIN_PROPERTIES_EXT,
+	};
+
+	ret = vk->vkGetSwapchainTimeDomainPropertiesEXT(vk->device, cts->swapchain.handle, &domain_props, NULL);
+	if (ret != VK_SUCCESS || domain_props.timeDomainCount == 0) {
+		COMP_ERROR(cts->base.c, "vkGetSwapchainTimeDomainPropertiesEXT: %s", vk_result_string(ret));
+		return;
+	}
+
+	domains = U_TYPED_ARRAY_CALLOC(VkTimeDomainKHR, domain_props.timeDomainCount);
+	ids = U_TYPED_ARRAY_CALLOC(uint64_t, domain_props.timeDomainCount);
+	domain_props.pTimeDomains = domains;
+	domain_props.pTimeDomainIds = ids;
+
+	ret = vk->vkGetSwapchainTimeDomainPropertiesEXT(vk->device, cts->swapchain.handle, &domain_props, NULL);
+	if (ret != VK_SUCCESS && ret != VK_INCOMPLETE) {
+		COMP_ERROR(cts->base.c, "vkGetSwapchainTimeDomainPropertiesEXT: %s", vk_result_string(ret));
+		goto out;
+	}
+
+	for (uint32_t i = 0; i < domain_props.timeDomainCount; i++) {
+		if (domains[i] != VK_TIME_DOMAIN_CLOCK_MONOTONIC_KHR) {
+			continue;
+		}
+
+		cts->present_timing.time_domain_id = ids[i];
+		cts->present_timing.active = true;
+		break;
+	}
+
+	if (cts->present_timing.active) {
+		COMP_INFO(cts->base.c, "Using VK_EXT_present_timing for present times.");
+	} else {
+		COMP_WARN(cts->base.c, "VK_EXT_present_timing: No CLOCK_MONOTONIC time domain on the swapchain.");
+	}
+
+out:
+	free(domains);
+	free(ids);
+}
+#endif
+
 static void
 do_update_timings_vblank_thread(struct comp_target_swapchain *cts)
 {
@@ -508,6 +775,7 @@ vblank_event_func(struct comp_target *ct, int64_t *out_timestamp_ns)
 
 	return valid;
 }
+#endif
 
 static void *
 run_vblank_event_thread(void *ptr)
@@ -543,7 +811,12 @@ run_vblank_event_thread(void *ptr)
 		os_thread_helper_unlock(&cts->vblank.event_thread);
 
 		int64_t when_ns = 0;
-		bool valid = vblank_event_func(ct, &when_ns);
+#if defined(VK_EXT_display_surface_counter) && defined(VK_EXT_display_control)
+		bool valid = cts->vblank.wait_func != NULL ? cts->vblank.wait_func(cts, &when_ns) //
+		                                           : vblank_event_func(ct, &when_ns);
+#else
+		bool valid = cts->vblank.wait_func(cts, &when_ns);
+#endif
 
 		// Just keep swimming.
 		os_thread_helper_lock(&cts->vblank.event_thread);
@@ -562,7 +835,7 @@ static bool
 create_vblank_event_thread(struct comp_target *ct)
 {
 	struct comp_target_swapchain *cts = (struct comp_target_swapchain *)ct;
-	if (cts->display == VK_NULL_HANDLE) {
+	if (cts->display == VK_NULL_HANDLE && cts->vblank.wait_func == NULL) {
 		return true;
 	}
 
@@ -579,22 +852,20 @@ create_vblank_event_thread(struct comp_target *ct)
 
 	return true;
 }
-#endif
 
 static void
 target_fini_semaphores(struct comp_target_swapchain *cts)
 {
 	struct vk_bundle *vk = get_vk(cts);
 
-	if (cts->base.semaphores.present_complete != VK_NULL_HANDLE) {
-		vk->vkDestroySemaphore(vk->device, cts->base.semaphores.present_complete, NULL);
-		cts->base.semaphores.present_complete = VK_NULL_HANDLE;
-	}
-
-	if (cts->base.semaphores.render_complete != VK_NULL_HANDLE) {
-		vk->vkDestroySemaphore(vk->device, cts->base.semaphores.render_complete, NULL);
-		cts->base.semaphores.render_complete = VK_NULL_HANDLE;
+	for (uint32_t i = 0; i < ARRAY_SIZE(cts->acquire.present_completes); i++) {
+		if (cts->acquire.present_completes[i] != VK_NULL_HANDLE) {
+			vk->vkDestroySemaphore(vk->device, cts->acquire.present_completes[i], NULL);
+			cts->acquire.present_completes[i] = VK_NULL_HANDLE;
+		}
 	}
+	cts->acquire.next = 0;
+	cts->base.semaphores.present_complete = VK_NULL_HANDLE;
 }
 
 static void
@@ -609,21 +880,21 @@ target_init_semaphores(struct comp_target_swapchain *cts)
 	    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
 	};
 
-	ret = vk->vkCreateSemaphore(vk->device, &info, NULL, &cts->base.semaphores.present_complete);
-	if (ret != VK_SUCCESS) {
-		COMP_ERROR(cts->base.c, "vkCreateSemaphore: %s", vk_result_string(ret));
+	for (uint32_t i = 0; i < ARRAY_SIZE(cts->acquire.present_completes); i++) {
+		ret = vk->vkCreateSemaphore(vk->device, &info, NULL, &cts->acquire.present_completes[i]);
+		if (ret != VK_SUCCESS) {
+			COMP_ERROR(cts->base.c, "vkCreateSemaphore: %s", vk_result_string(ret));
+		}
+
+		VK_NAME_SEMAPHORE(vk, cts->acquire.present_completes[i],
+		                  "comp_target_swapchain semaphore present complete");
 	}
 
-	VK_NAME_SEMAPHORE(vk, cts->base.semaphores.present_complete,
-	                  "comp_target_swapchain semaphore present complete");
+	// Set on each acquire, but have a valid one before the first.
+	cts->base.semaphores.present_complete = cts->acquire.present_completes[0];
 
+	// The render complete semaphores are per image, created with the image views.
 	cts->base.semaphores.render_complete_is_timeline = false;
-	ret = vk->vkCreateSemaphore(vk->device, &info, NULL, &cts->base.semaphores.render_complete);
-	if (ret != VK_SUCCESS) {
-		COMP_ERROR(cts->base.c, "vkCreateSemaphore: %s", vk_result_string(ret));
-	}
-
-	VK_NAME_SEMAPHORE(vk, cts->base.semaphores.render_complete, "comp_target_swapchain semaphore render complete");
 }
 
 
@@ -641,10 +912,16 @@ comp_target_swapchain_create_images(struct comp_target *ct, const struct comp_ta
 	VkBool32 supported;
 	VkResult ret;
 
+#ifdef USE_PRESENT_TIMING
+	cts->present_timing.supported = check_present_timing_support(cts);
+#endif
+	cts->present_timing.active = false;
+
 	int64_t now_ns = os_monotonic_get_ns();
 	// Some platforms really don't like the pacing_compositor code.
 	bool use_display_timing_if_available = cts->timing_usage == COMP_TARGET_USE_DISPLAY_IF_AVAILABLE;
-	if (cts->upc == NULL && use_display_timing_if_available && vk->has_GOOGLE_display_timing) {
+	bool has_display_timing = vk->has_GOOGLE_display_timing || cts->present_timing.supported;
+	if (cts->upc == NULL && use_display_timing_if_available && has_display_timing) {
 		u_pc_display_timing_create(ct->c->frame_interval_ns, &U_PC_DISPLAY_TIMING_CONFIG_DEFAULT, &cts->upc);
 	} else if (cts->upc == NULL) {
 		u_pc_fake_create(ct->c->frame_interval_ns, now_ns, &cts->upc);
@@ -664,6 +941,8 @@ comp_target_swapchain_create_images(struct comp_target *ct, const struct comp_ta
 	cts->swapchain.handle = VK_NULL_HANDLE;
 	cts->present_mode = create_info->present_mode;
 	cts->preferred.color_space = create_info->color_space;
+	cts->front_buffer.active = false;
+	cts->front_buffer.acquired = false;
 
 
 	/*
@@ -693,6 +972,9 @@ comp_target_swapchain_create_images(struct comp_target *ct, const struct comp_ta
 		goto error_print_and_free;
 	}
 
+	// Might change the present mode.
+	select_front_buffer_present_mode(cts, &info);
+
 	// Check that the present mode is supported.
 	if (!check_surface_present_mode(cts, &info, cts->present_mode)) {
 		goto error_print_and_free;
@@ -741,6 +1023,14 @@ comp_target_swapchain_create_images(struct comp_target *ct, const struct comp_ta
 	// Get the image count.
 	uint32_t image_count = select_image_count(cts, surface_caps, preferred_at_least_image_count);
 
+	// VUID-VkSwapchainCreateInfoKHR-minImageCount-01383
+	if (cts->front_buffer.active) {
+		image_count = 1;
+
+		// Next present won't mean the image is on screen.
+		ct->wait_for_present_supported = false;
+	}
+
 	/*
 	 * VUID-VkSwapchainCreateInfoKHR-compositeAlpha-01280
 	 * compositeAlpha must be one of the bits present in the supportedCompositeAlpha member of the
@@ -783,6 +1073,14 @@ comp_target_swapchain_create_images(struct comp_target *ct, const struct comp_ta
 	    .oldSwapchain = old_swapchain_handle,
 	};
 
+#ifdef USE_PRESENT_TIMING
+	// Only use it if the pacer is actually going to consume the feedback.
+	bool use_present_timing = cts->present_timing.supported && use_display_timing_if_available;
+	if (use_present_timing) {
+		swapchain_info.flags |= VK_SWAPCHAIN_CREATE_PRESENT_TIMING_BIT_EXT;
+	}
+#endif
+
 	// Print what we are creating.
 	vk_print_swapchain_create_info(vk, &swapchain_info, print_log_level);
 
@@ -799,6 +1097,12 @@ comp_target_swapchain_create_images(struct comp_target *ct, const struct comp_ta
 
 	VK_NAME_SWAPCHAIN(vk, cts->swapchain.handle, "comp_target_swapchain swapchain");
 
+#ifdef USE_PRESENT_TIMING
+	if (use_present_timing) {
+		setup_present_timing(cts);
+	}
+#endif
+
 
 	/*
 	 * Set target info.
@@ -808,16 +1112,26 @@ comp_target_swapchain_create_images(struct comp_target *ct, const struct comp_ta
 	cts->base.height = extent.height;
 	cts->base.format = cts->surface.format.format;
 	cts->base.final_layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+#ifdef VK_KHR_shared_presentable_image
+	if (cts->front_buffer.active) {
+		cts->base.final_layout = VK_IMAGE_LAYOUT_SHARED_PRESENT_KHR;
+	}
+#endif
 	cts->base.surface_transform = surface_caps.currentTransform;
 
 	create_image_views(cts);
 
+	bool use_vblank_thread = cts->vblank.wait_func != NULL;
+
 #ifdef VK_EXT_display_control
 	if (!check_surface_counter_caps(ct, vk, cts)) {
 		COMP_ERROR(ct->c, "Failed to query surface counter capabilities");
 	}
 
-	if (vk->has_EXT_display_control && cts->display != VK_NULL_HANDLE) {
+	use_vblank_thread |= vk->has_EXT_display_control && cts->display != VK_NULL_HANDLE;
+#endif
+
+	if (use_vblank_thread) {
 		if (cts->vblank.has_started) {
 			// Already running.
 		} else if (create_vblank_event_thread(ct)) {
@@ -828,7 +1142,6 @@ comp_target_swapchain_create_images(struct comp_target *ct, const struct comp_ta
 	} else {
 		COMP_INFO(ct->c, "Not using vblank event thread!");
 	}
-#endif
 
 	// Done now.
 	return;
@@ -857,13 +1170,40 @@ comp_target_swapchain_acquire_next_image(struct comp_target *ct, uint32_t *out_i
 		return VK_ERROR_INITIALIZATION_FAILED;
 	}
 
-	return vk->vkAcquireNextImageKHR(          //
+	// The front buffer is only acquired once, after that it's always ours.
+	if (cts->front_buffer.active && cts->front_buffer.acquired) {
+		cts->base.semaphores.present_complete = VK_NULL_HANDLE;
+		cts->base.semaphores.render_complete = cts->acquire.render_completes[0];
+		*out_index = 0;
+		return VK_SUCCESS;
+	}
+
+	// The previous frame might still be waiting on the last one.
+	cts->base.semaphores.present_complete = cts->acquire.present_completes[cts->acquire.next];
+	cts->acquire.next = (cts->acquire.next + 1) % ARRAY_SIZE(cts->acquire.present_completes);
+
+	VkResult ret = vk->vkAcquireNextImageKHR(  //
 	    vk->device,                            // device
 	    cts->swapchain.handle,                 // swapchain
 	    UINT64_MAX,                            // timeout
 	    cts->base.semaphores.present_complete, // semaphore
 	    VK_NULL_HANDLE,                        // fence
 	    out_index);                            // pImageIndex
+
+	/*
+	 * Frames overlap, so a single binary semaphore could be signalled again
+	 * before the present engine has waited on it. The image's own one has
+	 * been waited on by its previous present, as it has been acquired again.
+	 */
+	if (ret == VK_SUCCESS || ret == VK_SUBOPTIMAL_KHR) {
+		cts->base.semaphores.render_complete = cts->acquire.render_completes[*out_index];
+	}
+
+	if (ret == VK_SUCCESS && cts->front_buffer.active) {
+		cts->front_buffer.acquired = true;
+	}
+
+	return ret;
 }
 
 static VkResult
@@ -879,12 +1219,13 @@ comp_target_swapchain_present(struct comp_target *ct,
 
 	assert(cts->current_frame_id > 0);
 	assert(cts->current_frame_id <= UINT32_MAX);
+	assert(index < cts->base.image_count);
 
 	VkPresentInfoKHR present_info = {
 	    .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
 	    .pNext = NULL,
 	    .waitSemaphoreCount = 1,
-	    .pWaitSemaphores = &cts->base.semaphores.render_complete,
+	    .pWaitSemaphores = &cts->acquire.render_completes[index],
 	    .swapchainCount = 1,
 	    .pSwapchains = &cts->swapchain.handle,
 	    .pImageIndices = &index,
@@ -902,11 +1243,31 @@ comp_target_swapchain_present(struct comp_target *ct,
 	    .pTimes = &times,
 	};
 
-	if (vk->has_GOOGLE_display_timing) {
+	if (vk->has_GOOGLE_display_timing && !cts->present_timing.active) {
 		vk_append_to_pnext_chain((VkBaseInStructure *)&present_info, (VkBaseInStructure *)&timings);
 	}
 #endif
 
+#ifdef USE_PRESENT_TIMING
+	VkPresentTimingInfoEXT present_timing = {
+	    .sType = VK_STRUCTURE_TYPE_PRESENT_TIMING_INFO_EXT,
+	    .targetTime = (uint64_t)(desired_present_time_ns - present_slop_ns),
+	    .timeDomainId = cts->present_timing.time_domain_id,
+	    .presentStageQueries = PRESENT_TIMING_STAGES,
+	    .targetTimeDomainPresentStage = VK_PRESENT_STAGE_IMAGE_FIRST_PIXEL_OUT_BIT_EXT,
+	};
+
+	VkPresentTimingsInfoEXT present_timings = {
+	    .sType = VK_STRUCTURE_TYPE_PRESENT_TIMINGS_INFO_EXT,
+	    .swapchainCount = 1,
+	    .pTimingInfos = &present_timing,
+	};
+
+	if (cts->present_timing.active) {
+		vk_append_to_pnext_chain((VkBaseInStructure *)&present_info, (VkBaseInStructure *)&present_timings);
+	}
+#endif
+
 #ifdef VK_KHR_present_id
 	uint64_t present_id = (uint64_t)cts->current_frame_id;
 
@@ -928,7 +1289,6 @@ comp_target_swapchain_present(struct comp_target *ct,
 	os_mutex_unlock(&vk->queue_mutex);
 
 
-#ifdef VK_EXT_display_control
 	if (cts->vblank.has_started) {
 		os_thread_helper_lock(&cts->vblank.event_thread);
 		if (!cts->vblank.should_wait) {
@@ -937,7 +1297,6 @@ comp_target_swapchain_present(struct comp_target *ct,
 		}
 		os_thread_helper_unlock(&cts->vblank.event_thread);
 	}
-#endif
 
 	return ret;
 }
@@ -1045,7 +1404,12 @@ comp_target_swapchain_update_timings(struct comp_target *ct)
 
 	struct comp_target_swapchain *cts = (struct comp_target_swapchain *)ct;
 
-	do_update_timings_google_display_timing(cts);
+#ifdef USE_PRESENT_TIMING
+	do_update_timings_present_timing(cts);
+#endif
+	if (!cts->present_timing.active) {
+		do_update_timings_google_display_timing(cts);
+	}
 	do_update_timings_vblank_thread(cts);
 
 	return VK_SUCCESS;
@@ -1,4 +1,4 @@
-// Copyright 2019-2020, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -12,6 +12,8 @@
 
 #include "vk/vk_helpers.h"
 
+#include "render/render_interface.h"
+
 #include "main/comp_target.h"
 
 
@@ -68,6 +70,57 @@ struct comp_target_swapchain
 		VkSwapchainKHR handle;
 	} swapchain;
 
+	/*!
+	 * The renderer can have more than one frame in flight, so each acquire
+	 * uses the next semaphore and sets it as the base's present complete
+	 * semaphore. A semaphore is reused once the frame that waited on it
+	 * has completed.
+	 */
+	struct
+	{
+		VkSemaphore present_completes[RENDER_MAX_FRAMES_IN_FLIGHT];
+
+		//! Index of the semaphore the next acquire uses.
+		uint32_t next;
+
+		/*!
+		 * One per swapchain image, set as the base's render complete
+		 * semaphore when that image is acquired. The present of an
+		 * image has waited on its semaphore once it can be acquired again.
+		 */
+		VkSemaphore *render_completes;
+	} acquire;
+
+	/*!
+	 * Front buffer rendering with VK_KHR_shared_presentable_image, the
+	 * single image is acquired once and then rendered to and presented
+	 * every frame while the display continuously scans it out.
+	 */
+	struct
+	{
+		//! Was the swapchain created with a shared present mode.
+		bool active;
+
+		//! Has the single image been acquired.
+		bool acquired;
+	} front_buffer;
+
+	/*!
+	 * Absolute present times and present feedback with VK_EXT_present_timing,
+	 * used instead of VK_GOOGLE_display_timing when available.
+	 */
+	struct
+	{
+		//! Does the device and surface support everything we need.
+		bool supported;
+
+		//! Was the current swapchain setup for present timing.
+		bool active;
+
+		//! The swapchain time domain that matches @ref os_monotonic_get_ns.
+		uint64_t time_domain_id;
+	} present_timing;
+
 	struct
 	{
 		VkSurfaceKHR handle;
@@ -102,6 +155,13 @@ struct comp_target_swapchain
 
 		//! Thread waiting on vblank_event_fence (first pixel out).
 		struct os_thread_helper event_thread;
+
+		/*!
+		 * Optional, waits for the next vblank for targets that don't
+		 * have VK_EXT_display_control, called on the event thread.
+		 * Set before the swapchain is created to start the thread.
+		 */
+		bool (*wait_func)(struct comp_target_swapchain *cts, int64_t *out_timestamp_ns);
 	} vblank;
 
 	/*!
@@ -1,4 +1,4 @@
-// Copyright 2019-2020, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -20,6 +20,11 @@
 
 #include <android/native_window.h>
 
+#if __ANDROID_API__ >= 29
+#include <android/choreographer.h>
+#include <android/looper.h>
+#endif
+
 #include <poll.h>
 #include <errno.h>
 #include <stdlib.h>
@@ -44,6 +49,21 @@ struct comp_window_android
 	struct comp_target_swapchain base;
 
 	struct android_custom_surface *custom_surface;
+
+#if __ANDROID_API__ >= 29
+	//! Vsync source, only touched from the vblank event thread.
+	struct
+	{
+		AChoreographer *choreographer;
+
+		//! Failed to get the choreographer, don't try again.
+		bool failed;
+
+		//! Set by the frame callback.
+		bool got_frame;
+		int64_t frame_time_ns;
+	} vsync;
+#endif
 };
 
 
@@ -137,6 +157,61 @@ comp_window_android_create_surface(struct comp_window_android *cwa,
 	return VK_SUCCESS;
 }
 
+#if __ANDROID_API__ >= 29
+static void
+comp_window_android_frame_callback(int64_t frame_time_ns, void *data)
+{
+	struct comp_window_android *cwa = (struct comp_window_android *)data;
+
+	cwa->vsync.frame_time_ns = frame_time_ns;
+	cwa->vsync.got_frame = true;
+}
+
+/*!
+ * Waits for the next vsync using the choreographer, the frame time it gives
+ * is the vsync timestamp on CLOCK_MONOTONIC, so more accurate than reading
+ * the time after waking up.
+ */
+static bool
+comp_window_android_wait_vblank(struct comp_target_swapchain *cts, int64_t *out_timestamp_ns)
+{
+	struct comp_window_android *cwa = (struct comp_window_android *)cts;
+
+	if (cwa->vsync.failed) {
+		return false;
+	}
+
+	// The choreographer is per thread, this is always called on the vblank event thread.
+	if (cwa->vsync.choreographer == NULL) {
+		if (ALooper_forThread() == NULL) {
+			ALooper_prepare(0);
+		}
+
+		cwa->vsync.choreographer = AChoreographer_getInstance();
+		if (cwa->vsync.choreographer == NULL) {
+			COMP_ERROR(cts->base.c, "Failed to get AChoreographer, not waiting for vsync");
+			cwa->vsync.failed = true;
+			return false;
+		}
+	}
+
+	cwa->vsync.got_frame = false;
+	AChoreographer_postFrameCallback64(cwa->vsync.choreographer, comp_window_android_frame_callback, cwa);
+
+	// Dispatches the callback, times out if the display is off.
+	while (!cwa->vsync.got_frame) {
+		int ret = ALooper_pollOnce(100, NULL, NULL, NULL);
+		if (ret == ALOOPER_POLL_TIMEOUT || ret == ALOOPER_POLL_ERROR) {
+			return false;
+		}
+	}
+
+	*out_timestamp_ns = cwa->vsync.frame_time_ns;
+
+	return true;
+}
+#endif
+
 static bool
 comp_window_android_init_swapchain(struct comp_target *ct, uint32_t width, uint32_t height)
 {
@@ -195,6 +270,11 @@ comp_window_android_create(struct comp_compositor *c)
 	// The display timing code hasn't been tested on Android and may be broken.
 	comp_target_swapchain_init_and_set_fnptrs(&w->base, COMP_TARGET_FORCE_FAKE_DISPLAY_TIMING);
 
+#if __ANDROID_API__ >= 29
+	// Lines the fake timing up with the display's vsync.
+	w->base.vblank.wait_func = comp_window_android_wait_vblank;
+#endif
+
 	w->base.base.name = "Android";
 	w->base.base.destroy = comp_window_android_destroy;
 	w->base.base.flush = comp_window_android_flush;
@@ -9,13 +9,19 @@
  * @ingroup comp_main
  */
 
+// Before anything can pull in the DXGI header, for the C COM macros.
+#define COBJMACROS
+
 #include <stdlib.h>
 #include <string.h>
 #include "xrt/xrt_compiler.h"
 #include "main/comp_window.h"
 #include "util/u_misc.h"
+#include "os/os_time.h"
 #include "os/os_threading.h"
 
+#include <dxgi.h>
+
 
 #undef ALLOW_CLOSING_WINDOW
 
@@ -39,6 +45,20 @@ struct comp_window_mswin
 	HINSTANCE instance;
 	HWND window;
 
+	//! Only touched from the vblank event thread, and from destroy once it has stopped.
+	struct
+	{
+		IDXGIFactory1 *factory;
+
+		//! Output for @ref monitor, NULL if not found.
+		IDXGIOutput *output;
+
+		//! Monitor the window was on last time we looked.
+		HMONITOR monitor;
+
+		//! Does the window cover the whole output, needed for independent flip.
+		bool covers_output;
+	} dxgi;
 
 	bool fullscreen_requested;
 	bool should_exit;
@@ -124,9 +144,15 @@ comp_window_mswin_destroy(struct comp_target *ct)
 	// Stop the Windows thread first, destroy also stops the thread.
 	os_thread_helper_destroy(&cwm->oth);
 
+	// Also stops the vblank event thread.
 	comp_target_swapchain_cleanup(&cwm->base);
 
-	//! @todo
+	if (cwm->dxgi.output != NULL) {
+		IDXGIOutput_Release(cwm->dxgi.output);
+	}
+	if (cwm->dxgi.factory != NULL) {
+		IDXGIFactory1_Release(cwm->dxgi.factory);
+	}
 
 	free(ct);
 }
@@ -141,7 +167,125 @@ comp_window_mswin_update_window_title(struct comp_target *ct, const char *title)
 static void
 comp_window_mswin_fullscreen(struct comp_window_mswin *w)
 {
-	//! @todo
+	MONITORINFO info = {.cbSize = sizeof(info)};
+	if (!GetMonitorInfoW(MonitorFromWindow(w->window, MONITOR_DEFAULTTONEAREST), &info)) {
+		COMP_ERROR_GETLASTERROR(w->base.base.c, "GetMonitorInfoW failed: %s", "GetMonitorInfoW failed");
+		return;
+	}
+
+	/*
+	 * A borderless window covering the whole output, that DWM can hand
+	 * over to independent flip instead of composing it with the desktop.
+	 */
+	RECT rc = info.rcMonitor;
+	SetWindowLongPtrW(w->window, GWL_STYLE, WS_POPUP | WS_VISIBLE);
+	SetWindowPos(w->window, HWND_TOP, rc.left, rc.top, rc.right - rc.left, rc.bottom - rc.top,
+	             SWP_FRAMECHANGED | SWP_SHOWWINDOW);
+}
+
+static IDXGIOutput *
+find_dxgi_output(struct comp_window_mswin *cwm, HMONITOR monitor)
+{
+	if (cwm->dxgi.factory == NULL) {
+		HRESULT hr = CreateDXGIFactory1(&IID_IDXGIFactory1, (void **)&cwm->dxgi.factory);
+		if (FAILED(hr)) {
+			COMP_ERROR(cwm->base.base.c, "CreateDXGIFactory1 failed: 0x%08lx", (unsigned long)hr);
+			cwm->dxgi.factory = NULL;
+			return NULL;
+		}
+	}
+
+	IDXGIAdapter1 *adapter = NULL;
+	for (UINT i = 0; IDXGIFactory1_EnumAdapters1(cwm->dxgi.factory, i, &adapter) == S_OK; i++) {
+		IDXGIOutput *output = NULL;
+		for (UINT k = 0; IDXGIAdapter1_EnumOutputs(adapter, k, &output) == S_OK; k++) {
+			DXGI_OUTPUT_DESC desc = {0};
+			if (SUCCEEDED(IDXGIOutput_GetDesc(output, &desc)) && desc.Monitor == monitor) {
+				IDXGIAdapter1_Release(adapter);
+				return output;
+			}
+			IDXGIOutput_Release(output);
+		}
+		IDXGIAdapter1_Release(adapter);
+	}
+
+	return NULL;
+}
+
+static void
+check_covers_output(struct comp_window_mswin *cwm, HMONITOR monitor)
+{
+	MONITORINFO info = {.cbSize = sizeof(info)};
+	RECT rc = {0};
+	if (!GetMonitorInfoW(monitor, &info) || !GetWindowRect(cwm->window, &rc)) {
+		return;
+	}
+
+	bool covers_output = EqualRect(&rc, &info.rcMonitor);
+	if (covers_output == cwm->dxgi.covers_output) {
+		return;
+	}
+
+	cwm->dxgi.covers_output = covers_output;
+	if (covers_output) {
+		COMP_INFO(cwm->base.base.c, "Window covers the output, DWM can use independent flip");
+	} else {
+		COMP_INFO(cwm->base.base.c, "Window doesn't cover the output, DWM will compose it");
+	}
+}
+
+/*!
+ * Waits for the vblank of the output the window is on, which the compositor
+ * uses to line its frames up with the display instead of free running.
+ */
+static bool
+comp_window_mswin_wait_vblank(struct comp_target_swapchain *cts, int64_t *out_timestamp_ns)
+{
+	struct comp_window_mswin *cwm = (struct comp_window_mswin *)cts;
+
+	HMONITOR monitor = MonitorFromWindow(cwm->window, MONITOR_DEFAULTTOPRIMARY);
+	if (monitor != cwm->dxgi.monitor) {
+		if (cwm->dxgi.output != NULL) {
+			IDXGIOutput_Release(cwm->dxgi.output);
+		}
+
+		cwm->dxgi.output = find_dxgi_output(cwm, monitor);
+		cwm->dxgi.monitor = monitor;
+
+		if (cwm->dxgi.output == NULL) {
+			COMP_WARN(cwm->base.base.c, "No DXGI output for the window's monitor, not waiting for vblank");
+		}
+	}
+
+	check_covers_output(cwm, monitor);
+
+	if (cwm->dxgi.output == NULL) {
+		return false;
+	}
+
+	HRESULT hr = IDXGIOutput_WaitForVBlank(cwm->dxgi.output);
+
+	// As quickly as possible after the vblank.
+	int64_t now_ns = os_monotonic_get_ns();
+
+	if (FAILED(hr)) {
+		COMP_ERROR(cwm->base.base.c, "IDXGIOutput::WaitForVBlank failed: 0x%08lx", (unsigned long)hr);
+		return false;
+	}
+
+	*out_timestamp_ns = now_ns;
+
+	return true;
+}
+
+static void
+comp_window_mswin_configure(struct comp_window_mswin *w, int32_t width, int32_t height)
+{
+	if (w->base.base.c->settings.fullscreen && !w->fullscreen_requested) {
+		COMP_DEBUG(w->base.base.c, "Setting full screen");
+		comp_window_mswin_fullscreen(w);
+		w->fullscreen_requested = true;
+	}
 }
 
 static VkResult
@@ -217,6 +361,7 @@ comp_window_mswin_window_loop(struct comp_window_mswin *cwm)
 	SetPropW(cwm->window, szWindowData, cwm);
 	SetWindowLongPtr(cwm->window, GWLP_USERDATA, (LONG_PTR)(cwm));
 	ShowWindow(cwm->window, SW_SHOWDEFAULT);
+	comp_window_mswin_configure(cwm, ct->width, ct->height);
 	UpdateWindow(cwm->window);
 
 	COMP_INFO(ct->c, "Unblocking parent thread");
@@ -354,16 +499,6 @@ comp_window_mswin_init(struct comp_target *ct)
 	return ret;
 }
 
-static void
-comp_window_mswin_configure(struct comp_window_mswin *w, int32_t width, int32_t height)
-{
-	if (w->base.base.c->settings.fullscreen && !w->fullscreen_requested) {
-		COMP_DEBUG(w->base.base.c, "Setting full screen");
-		comp_window_mswin_fullscreen(w);
-		w->fullscreen_requested = true;
-	}
-}
-
 #ifdef ALLOW_CLOSING_WINDOW
 /// @todo This is somehow triggering crashes in the multi-compositor, which is trying to run without things it needs,
 /// even though it didn't do this when we called the parent impl instead of inlining it.
@@ -388,6 +523,9 @@ comp_window_mswin_create(struct comp_compositor *c)
 	// The display timing code hasn't been tested on Windows and may be broken.
 	comp_target_swapchain_init_and_set_fnptrs(&w->base, COMP_TARGET_FORCE_FAKE_DISPLAY_TIMING);
 
+	// Lines the fake timing up with the output's vblanks.
+	w->base.vblank.wait_func = comp_window_mswin_wait_vblank;
+
 	w->base.base.name = "MS Windows";
 	w->base.display = VK_NULL_HANDLE;
 	w->base.base.destroy = comp_window_mswin_destroy;
@@ -1,5 +1,5 @@
 // Copyright 2022, Simon Zeni <simon@bl4ckb0ne.ca>
-// Copyright 2022-2023, Collabora, Ltd.
+// Copyright 2022-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -12,6 +12,11 @@
 #include "main/comp_target_swapchain.h"
 #include "main/comp_window_peek.h"
 
+#include "os/os_time.h"
+
+#include "vk/vk_mini_helpers.h"
+
+#include "util/u_time.h"
 #include "util/u_debug.h"
 #include "util/u_string_list.h"
 
@@ -24,8 +29,10 @@
 
 
 DEBUG_GET_ONCE_OPTION(window_peek, "XRT_WINDOW_PEEK", NULL)
+DEBUG_GET_ONCE_NUM_OPTION(window_peek_fps, "XRT_WINDOW_PEEK_FPS", 30)
 
 #define PEEK_IMAGE_USAGE (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+#define PEEK_INTERMEDIATE_USAGE (VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT)
 
 struct comp_window_peek
 {
@@ -39,7 +46,38 @@ struct comp_window_peek
 	bool hidden;
 
 	struct vk_cmd_pool pool;
-	VkCommandBuffer cmd;
+
+	//! Copies to the intermediate image, recorded on the compositor thread.
+	VkCommandBuffer copy_cmd;
+
+	//! Blits the intermediate image to the swapchain, recorded on the peek thread.
+	VkCommandBuffer present_cmd;
+
+	/*!
+	 * The compositor copies its image here and the peek thread presents it
+	 * on its own time, so the frames never wait on the desktop compositor.
+	 */
+	struct
+	{
+		VkImage image;
+		VkDeviceMemory mem;
+		VkFormat format;
+		uint32_t width, height;
+
+		//! Signalled when the copy is done.
+		VkFence copy_fence;
+
+		//! Signalled when the peek thread is done reading the image.
+		VkFence present_fence;
+
+		//! A copy was submitted and not yet presented, protected by the @ref oth lock.
+		bool pending;
+
+		int64_t last_copy_ns;
+
+		//! From XRT_WINDOW_PEEK_FPS, zero copies every frame.
+		int64_t min_interval_ns;
+	} intermediate;
 
 	struct os_thread_helper oth;
 };
@@ -69,49 +107,296 @@ create_images(struct comp_window_peek *w)
 	comp_target_create_images(&w->base.base, &info);
 }
 
+static void
+destroy_intermediate(struct comp_window_peek *w)
+{
+	struct vk_bundle *vk = get_vk(w);
+
+	D(Image, w->intermediate.image);
+	DF(Memory, w->intermediate.mem);
+	w->intermediate.width = 0;
+	w->intermediate.height = 0;
+}
+
+static VkResult
+ensure_intermediate(struct comp_window_peek *w, uint32_t width, uint32_t height)
+{
+	struct vk_bundle *vk = get_vk(w);
+
+	if (w->intermediate.width == width && w->intermediate.height == height) {
+		return VK_SUCCESS;
+	}
+
+	// Not pending, so neither thread is using it.
+	destroy_intermediate(w);
+
+	VkExtent2D extent = {width, height};
+	VkResult ret = vk_create_image_simple( //
+	    vk,                                // vk_bundle
+	    extent,                            // extent
+	    w->intermediate.format,            // format
+	    PEEK_INTERMEDIATE_USAGE,           // usage
+	    &w->intermediate.mem,              // out_mem
+	    &w->intermediate.image);           // out_image
+	if (ret != VK_SUCCESS) {
+		COMP_ERROR(w->c, "vk_create_image_simple: %s", vk_result_string(ret));
+		return ret;
+	}
+
+	VK_NAME_IMAGE(vk, w->intermediate.image, "comp_window_peek intermediate image");
+
+	w->intermediate.width = width;
+	w->intermediate.height = height;
+
+	return VK_SUCCESS;
+}
+
+/*!
+ * Waits for the copy from the compositor and presents it, on the peek thread
+ * so the acquire and present waiting on the desktop compositor only block it.
+ */
+static void
+present_intermediate(struct comp_window_peek *w)
+{
+	struct vk_bundle *vk = get_vk(w);
+	VkResult ret;
+
+	ret = vk->vkWaitForFences(vk->device, 1, &w->intermediate.copy_fence, VK_TRUE, UINT64_MAX);
+	if (ret != VK_SUCCESS) {
+		COMP_ERROR(w->c, "vkWaitForFences: %s", vk_result_string(ret));
+		return;
+	}
+	vk->vkResetFences(vk->device, 1, &w->intermediate.copy_fence);
+
+	if (w->hidden) {
+		return;
+	}
+
+	if (w->width != w->base.base.width || w->height != w->base.base.height) {
+		COMP_DEBUG(w->c, "Resizing swapchain");
+		create_images(w);
+	}
+
+	while (!comp_target_check_ready(&w->base.base))
+		;
+
+	uint32_t current;
+	ret = comp_target_acquire(&w->base.base, &current);
+	if (ret != VK_SUCCESS) {
+		COMP_ERROR(w->c, "comp_target_acquire: %s", vk_result_string(ret));
+		return;
+	}
+
+	VkImage dst = w->base.base.images[current].handle;
+
+	VkCommandBufferBeginInfo begin_info = {
+	    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+	};
+
+	// For writing and submitting commands.
+	vk_cmd_pool_lock(&w->pool);
+
+	ret = vk->vkBeginCommandBuffer(w->present_cmd, &begin_info);
+
+	VkImageSubresourceRange range = {
+	    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+	    .baseMipLevel = 0,
+	    .levelCount = 1,
+	    .baseArrayLayer = 0,
+	    .layerCount = 1,
+	};
+
+	// Barrier to make destination a destination
+	vk_cmd_image_barrier_locked(              //
+	    vk,                                   // vk_bundle
+	    w->present_cmd,                       // cmdbuffer
+	    dst,                                  // image
+	    0,                                    // srcAccessMask
+	    VK_ACCESS_TRANSFER_WRITE_BIT,         // dstAccessMask
+	    VK_IMAGE_LAYOUT_UNDEFINED,            // oldImageLayout
+	    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // newImageLayout
+	    VK_PIPELINE_STAGE_TRANSFER_BIT,       // srcStageMask
+	    VK_PIPELINE_STAGE_TRANSFER_BIT,       // dstStageMask
+	    range);                               // subresourceRange
+
+	VkImageBlit blit = {
+	    .srcSubresource =
+	        {
+	            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+	            .layerCount = 1,
+	        },
+	    .dstSubresource =
+	        {
+	            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+	            .layerCount = 1,
+	        },
+	};
+
+	blit.srcOffsets[1].x = w->intermediate.width;
+	blit.srcOffsets[1].y = w->intermediate.height;
+	blit.srcOffsets[1].z = 1;
+
+	blit.dstOffsets[1].x = w->base.base.width;
+	blit.dstOffsets[1].y = w->base.base.height;
+	blit.dstOffsets[1].z = 1;
+
+	// The copy left the intermediate image as a transfer source.
+	vk->vkCmdBlitImage(                       //
+	    w->present_cmd,                       // commandBuffer
+	    w->intermediate.image,                // srcImage
+	    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, // srcImageLayout
+	    dst,                                  // dstImage
+	    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // dstImageLayout
+	    1,                                    // regionCount
+	    &blit,                                // pRegions
+	    VK_FILTER_LINEAR                      // filter
+	);
+
+	// Reset destination
+	vk_cmd_image_barrier_locked(              //
+	    vk,                                   // vk_bundle
+	    w->present_cmd,                       // cmdbuffer
+	    dst,                                  // image
+	    VK_ACCESS_TRANSFER_WRITE_BIT,         // srcAccessMask
+	    0,                                    // dstAccessMask
+	    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // oldImageLayout
+	    VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,      // newImageLayout
+	    VK_PIPELINE_STAGE_TRANSFER_BIT,       // srcStageMask
+	    VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, // dstStageMask
+	    range);                               // subresourceRange
+
+	ret = vk->vkEndCommandBuffer(w->present_cmd);
+	if (ret != VK_SUCCESS) {
+		vk_cmd_pool_unlock(&w->pool);
+		VK_ERROR(vk, "Error: Could not end command buffer.\n");
+		return;
+	}
+
+	VkPipelineStageFlags submit_flags = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+	// Waits for command to finish.
+	VkSubmitInfo submit = {
+	    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+	    .pNext = NULL,
+	    .waitSemaphoreCount = 1,
+	    .pWaitSemaphores = &w->base.base.semaphores.present_complete,
+	    .pWaitDstStageMask = &submit_flags,
+	    .commandBufferCount = 1,
+	    .pCommandBuffers = &w->present_cmd,
+	    .signalSemaphoreCount = 1,
+	    .pSignalSemaphores = &w->base.base.semaphores.render_complete,
+	};
+
+	// Done writing commands, submit to queue.
+	ret = vk_cmd_submit_locked(vk, &vk->main_queue, 1, &submit, w->intermediate.present_fence);
+
+	// Done submitting commands, unlock pool.
+	vk_cmd_pool_unlock(&w->pool);
+
+	// Check results from submit.
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "Error: Could not submit to queue.\n");
+		return;
+	}
+
+	VkPresentInfoKHR present = {
+	    .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+	    .pNext = NULL,
+	    .waitSemaphoreCount = 1,
+	    .pWaitSemaphores = &w->base.base.semaphores.render_complete,
+	    .swapchainCount = 1,
+	    .pSwapchains = &w->base.swapchain.handle,
+	    .pImageIndices = &current,
+	    .pResults = NULL,
+	};
+
+	os_mutex_lock(&vk->queue_mutex);
+	ret = vk->vkQueuePresentKHR(vk->main_queue.queue, &present);
+	os_mutex_unlock(&vk->queue_mutex);
+
+	if (ret != VK_SUCCESS) {
+		VK_ERROR(vk, "Error: could not present to queue.\n");
+	}
+
+	// The compositor may only copy again once we are done reading.
+	vk->vkWaitForFences(vk->device, 1, &w->intermediate.present_fence, VK_TRUE, UINT64_MAX);
+	vk->vkResetFences(vk->device, 1, &w->intermediate.present_fence);
+}
+
+static void
+poll_events(struct comp_window_peek *w)
+{
+	SDL_Event event;
+	while (SDL_PollEvent(&event)) {
+		switch (event.type) {
+		case SDL_QUIT: w->running = false; break;
+		case SDL_WINDOWEVENT:
+			switch (event.window.event) {
+			case SDL_WINDOWEVENT_HIDDEN: w->hidden = true; break;
+			case SDL_WINDOWEVENT_SHOWN: w->hidden = false; break;
+			case SDL_WINDOWEVENT_SIZE_CHANGED:
+				w->width = event.window.data1;
+				w->height = event.window.data2;
+				break;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+			case SDL_WINDOWEVENT_DISPLAY_CHANGED:
+#endif
+			case SDL_WINDOWEVENT_MOVED:
+				SDL_GetWindowSize(w->window, (int *)&w->width, (int *)&w->height);
+				break;
+			default: break;
+			}
+			break;
+		case SDL_KEYDOWN:
+			switch (event.key.keysym.sym) {
+			case SDLK_ESCAPE: w->running = false; break;
+			default: break;
+			}
+			break;
+		default: break;
+		}
+
+		if (event.type == SDL_QUIT) {
+			w->running = false;
+		}
+	}
+}
+
 static void *
 window_peek_run_thread(void *ptr)
 {
 	struct comp_window_peek *w = ptr;
 
+	os_thread_helper_name(&w->oth, "Peek Window");
+
 	w->running = true;
 	w->hidden = false;
 	while (w->running) {
-		SDL_Event event;
-		while (SDL_PollEvent(&event)) {
-			switch (event.type) {
-			case SDL_QUIT: w->running = false; break;
-			case SDL_WINDOWEVENT:
-				switch (event.window.event) {
-				case SDL_WINDOWEVENT_HIDDEN: w->hidden = true; break;
-				case SDL_WINDOWEVENT_SHOWN: w->hidden = false; break;
-				case SDL_WINDOWEVENT_SIZE_CHANGED:
-					w->width = event.window.data1;
-					w->height = event.window.data2;
-					break;
-#if SDL_VERSION_ATLEAST(2, 0, 18)
-				case SDL_WINDOWEVENT_DISPLAY_CHANGED:
-#endif
-				case SDL_WINDOWEVENT_MOVED:
-					SDL_GetWindowSize(w->window, (int *)&w->width, (int *)&w->height);
-					break;
-				default: break;
-				}
-				break;
-			case SDL_KEYDOWN:
-				switch (event.key.keysym.sym) {
-				case SDLK_ESCAPE: w->running = false; break;
-				default: break;
-				}
-				break;
-			default: break;
-			}
+		poll_events(w);
 
-			if (event.type == SDL_QUIT) {
-				w->running = false;
-			}
+		os_thread_helper_lock(&w->oth);
+		bool pending = w->intermediate.pending;
+		os_thread_helper_unlock(&w->oth);
+
+		if (!pending) {
+			os_nanosleep(U_TIME_1MS_IN_NS);
+			continue;
 		}
+
+		present_intermediate(w);
+
+		os_thread_helper_lock(&w->oth);
+		w->intermediate.pending = false;
+		os_thread_helper_unlock(&w->oth);
+	}
+
+	// Make sure a copy in flight is done before anything is destroyed.
+	os_thread_helper_lock(&w->oth);
+	if (w->intermediate.pending) {
+		struct vk_bundle *vk = get_vk(w);
+		vk->vkWaitForFences(vk->device, 1, &w->intermediate.copy_fence, VK_TRUE, UINT64_MAX);
 	}
+	os_thread_helper_unlock(&w->oth);
 
 	return NULL;
 }
@@ -173,13 +458,44 @@ comp_window_peek_create(struct comp_compositor *c)
 
 	VK_NAME_COMMAND_POOL(vk, w->pool.pool, "comp_window_peek command pool");
 
-	ret = vk_cmd_pool_create_cmd_buffer(vk, &w->pool, &w->cmd);
+	ret = vk_cmd_pool_create_cmd_buffer(vk, &w->pool, &w->copy_cmd);
+	if (ret != VK_SUCCESS) {
+		COMP_ERROR(c, "vk_cmd_pool_create_cmd_buffer: %s", vk_result_string(ret));
+		goto err_pool;
+	}
+
+	VK_NAME_COMMAND_BUFFER(vk, w->copy_cmd, "comp_window_peek copy command buffer");
+
+	ret = vk_cmd_pool_create_cmd_buffer(vk, &w->pool, &w->present_cmd);
 	if (ret != VK_SUCCESS) {
 		COMP_ERROR(c, "vk_cmd_pool_create_cmd_buffer: %s", vk_result_string(ret));
 		goto err_pool;
 	}
 
-	VK_NAME_COMMAND_BUFFER(vk, w->cmd, "comp_window_peek command buffer");
+	VK_NAME_COMMAND_BUFFER(vk, w->present_cmd, "comp_window_peek present command buffer");
+
+	VkFenceCreateInfo fence_info = {
+	    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+	};
+
+	ret = vk->vkCreateFence(vk->device, &fence_info, NULL, &w->intermediate.copy_fence);
+	if (ret != VK_SUCCESS) {
+		COMP_ERROR(c, "vkCreateFence: %s", vk_result_string(ret));
+		goto err_pool;
+	}
+
+	VK_NAME_FENCE(vk, w->intermediate.copy_fence, "comp_window_peek copy fence");
+
+	ret = vk->vkCreateFence(vk->device, &fence_info, NULL, &w->intermediate.present_fence);
+	if (ret != VK_SUCCESS) {
+		COMP_ERROR(c, "vkCreateFence: %s", vk_result_string(ret));
+		goto err_pool;
+	}
+
+	VK_NAME_FENCE(vk, w->intermediate.present_fence, "comp_window_peek present fence");
+
+	int64_t fps = debug_get_num_option_window_peek_fps();
+	w->intermediate.min_interval_ns = fps > 0 ? (int64_t)U_TIME_1S_IN_NS / fps : 0;
 
 
 	/*
@@ -229,6 +545,12 @@ comp_window_peek_create(struct comp_compositor *c)
 
 	create_images(w);
 
+	// Same format as the swapchain so presenting doesn't convert.
+	w->intermediate.format = w->base.base.format;
+	if (w->intermediate.format == VK_FORMAT_UNDEFINED) {
+		w->intermediate.format = c->settings.formats[0];
+	}
+
 	/*
 	 * Thread
 	 */
@@ -243,6 +565,8 @@ err_window:
 	SDL_DestroyWindow(w->window);
 
 err_pool:
+	D(Fence, w->intermediate.present_fence);
+	D(Fence, w->intermediate.copy_fence);
 	vk_cmd_pool_destroy(vk, &w->pool);
 
 err_free:
@@ -271,11 +595,16 @@ comp_window_peek_destroy(struct comp_window_peek **w_ptr)
 	os_mutex_unlock(&vk->queue_mutex);
 
 	vk_cmd_pool_lock(&w->pool);
-	vk->vkFreeCommandBuffers(vk->device, w->pool.pool, 1, &w->cmd);
+	vk->vkFreeCommandBuffers(vk->device, w->pool.pool, 1, &w->copy_cmd);
+	vk->vkFreeCommandBuffers(vk->device, w->pool.pool, 1, &w->present_cmd);
 	vk_cmd_pool_unlock(&w->pool);
 
 	vk_cmd_pool_destroy(vk, &w->pool);
 
+	destroy_intermediate(w);
+	D(Fence, w->intermediate.present_fence);
+	D(Fence, w->intermediate.copy_fence);
+
 	comp_target_swapchain_cleanup(&w->base);
 
 	SDL_DestroyWindow(w->window);
@@ -292,21 +621,25 @@ comp_window_peek_blit(struct comp_window_peek *w, VkImage src, int32_t width, in
 		return;
 	}
 
-	if (w->width != w->base.base.width || w->height != w->base.base.height) {
-		COMP_DEBUG(w->c, "Resizing swapchain");
-		create_images(w);
+	int64_t now_ns = os_monotonic_get_ns();
+	if (now_ns - w->intermediate.last_copy_ns < w->intermediate.min_interval_ns) {
+		return;
 	}
 
-	while (!comp_target_check_ready(&w->base.base))
-		;
+	// Skip this frame if the peek thread is still busy with the last one.
+	os_thread_helper_lock(&w->oth);
+	bool pending = w->intermediate.pending;
+	os_thread_helper_unlock(&w->oth);
+	if (pending) {
+		return;
+	}
 
-	uint32_t current;
-	VkResult ret = comp_target_acquire(&w->base.base, &current);
+	VkResult ret = ensure_intermediate(w, (uint32_t)width, (uint32_t)height);
 	if (ret != VK_SUCCESS) {
-		COMP_ERROR(w->c, "comp_target_acquire: %s", vk_result_string(ret));
+		return;
 	}
 
-	VkImage dst = w->base.base.images[current].handle;
+	VkImage dst = w->intermediate.image;
 
 	struct vk_bundle *vk = get_vk(w);
 
@@ -317,7 +650,7 @@ comp_window_peek_blit(struct comp_window_peek *w, VkImage src, int32_t width, in
 	// For writing and submitting commands.
 	vk_cmd_pool_lock(&w->pool);
 
-	ret = vk->vkBeginCommandBuffer(w->cmd, &begin_info);
+	ret = vk->vkBeginCommandBuffer(w->copy_cmd, &begin_info);
 
 	VkImageSubresourceRange range = {
 	    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
@@ -330,7 +663,7 @@ comp_window_peek_blit(struct comp_window_peek *w, VkImage src, int32_t width, in
 	// Barrier to make source a source
 	vk_cmd_image_barrier_locked(                       //
 	    vk,                                            // vk_bundle
-	    w->cmd,                                        // cmdbuffer
+	    w->copy_cmd,                                   // cmdbuffer
 	    src,                                           // image
 	    VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,          // srcAccessMask
 	    VK_ACCESS_TRANSFER_READ_BIT,                   // dstAccessMask
@@ -340,10 +673,10 @@ comp_window_peek_blit(struct comp_window_peek *w, VkImage src, int32_t width, in
 	    VK_PIPELINE_STAGE_TRANSFER_BIT,                // dstStageMask
 	    range);                                        // subresourceRange
 
-	// Barrier to make destination a destination
+	// Barrier to make destination a destination, the whole image is overwritten.
 	vk_cmd_image_barrier_locked(              //
 	    vk,                                   // vk_bundle
-	    w->cmd,                               // cmdbuffer
+	    w->copy_cmd,                          // cmdbuffer
 	    dst,                                  // image
 	    0,                                    // srcAccessMask
 	    VK_ACCESS_TRANSFER_WRITE_BIT,         // dstAccessMask
@@ -370,38 +703,38 @@ comp_window_peek_blit(struct comp_window_peek *w, VkImage src, int32_t width, in
 	blit.srcOffsets[1].y = height;
 	blit.srcOffsets[1].z = 1;
 
-	blit.dstOffsets[1].x = w->width;
-	blit.dstOffsets[1].y = w->height;
+	blit.dstOffsets[1].x = width;
+	blit.dstOffsets[1].y = height;
 	blit.dstOffsets[1].z = 1;
 
 	vk->vkCmdBlitImage(                       //
-	    w->cmd,                               // commandBuffer
+	    w->copy_cmd,                          // commandBuffer
 	    src,                                  // srcImage
 	    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, // srcImageLayout
 	    dst,                                  // dstImage
 	    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // dstImageLayout
 	    1,                                    // regionCount
 	    &blit,                                // pRegions
-	    VK_FILTER_LINEAR                      // filter
+	    VK_FILTER_NEAREST                     // filter
 	);
 
-	// Reset destination
+	// Make destination a source for the peek thread
 	vk_cmd_image_barrier_locked(              //
 	    vk,                                   // vk_bundle
-	    w->cmd,                               // cmdbuffer
+	    w->copy_cmd,                          // cmdbuffer
 	    dst,                                  // image
 	    VK_ACCESS_TRANSFER_WRITE_BIT,         // srcAccessMask
-	    0,                                    // dstAccessMask
+	    VK_ACCESS_TRANSFER_READ_BIT,          // dstAccessMask
 	    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // oldImageLayout
-	    VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,      // newImageLayout
+	    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, // newImageLayout
 	    VK_PIPELINE_STAGE_TRANSFER_BIT,       // srcStageMask
-	    VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, // dstStageMask
+	    VK_PIPELINE_STAGE_TRANSFER_BIT,       // dstStageMask
 	    range);                               // subresourceRange
 
 	// Reset src
 	vk_cmd_image_barrier_locked(                  //
 	    vk,                                       // vk_bundle
-	    w->cmd,                                   // cmdbuffer
+	    w->copy_cmd,                              // cmdbuffer
 	    src,                                      // image
 	    VK_ACCESS_TRANSFER_READ_BIT,              // srcAccessMask
 	    0,                                        // dstAccessMask
@@ -411,30 +744,21 @@ comp_window_peek_blit(struct comp_window_peek *w, VkImage src, int32_t width, in
 	    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,        // dstStageMask
 	    range);                                   // subresourceRange
 
-	ret = vk->vkEndCommandBuffer(w->cmd);
+	ret = vk->vkEndCommandBuffer(w->copy_cmd);
 	if (ret != VK_SUCCESS) {
 		vk_cmd_pool_unlock(&w->pool);
 		VK_ERROR(vk, "Error: Could not end command buffer.\n");
 		return;
 	}
 
-	VkPipelineStageFlags submit_flags = VK_PIPELINE_STAGE_TRANSFER_BIT;
-
-	// Waits for command to finish.
 	VkSubmitInfo submit = {
 	    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-	    .pNext = NULL,
-	    .waitSemaphoreCount = 1,
-	    .pWaitSemaphores = &w->base.base.semaphores.present_complete,
-	    .pWaitDstStageMask = &submit_flags,
 	    .commandBufferCount = 1,
-	    .pCommandBuffers = &w->cmd,
-	    .signalSemaphoreCount = 1,
-	    .pSignalSemaphores = &w->base.base.semaphores.render_complete,
+	    .pCommandBuffers = &w->copy_cmd,
 	};
 
-	// Done writing commands, submit to queue.
-	ret = vk_cmd_submit_locked(vk, &vk->main_queue, 1, &submit, VK_NULL_HANDLE);
+	// Done writing commands, submit to queue, nothing waits on the peek swapchain.
+	ret = vk_cmd_submit_locked(vk, &vk->main_queue, 1, &submit, w->intermediate.copy_fence);
 
 	// Done submitting commands, unlock pool.
 	vk_cmd_pool_unlock(&w->pool);
@@ -445,25 +769,12 @@ comp_window_peek_blit(struct comp_window_peek *w, VkImage src, int32_t width, in
 		return;
 	}
 
-	VkPresentInfoKHR present = {
-	    .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-	    .pNext = NULL,
-	    .waitSemaphoreCount = 1,
-	    .pWaitSemaphores = &w->base.base.semaphores.render_complete,
-	    .swapchainCount = 1,
-	    .pSwapchains = &w->base.swapchain.handle,
-	    .pImageIndices = &current,
-	    .pResults = NULL,
-	};
-
-	os_mutex_lock(&vk->queue_mutex);
-	ret = vk->vkQueuePresentKHR(vk->main_queue.queue, &present);
-	os_mutex_unlock(&vk->queue_mutex);
+	w->intermediate.last_copy_ns = now_ns;
 
-	if (ret != VK_SUCCESS) {
-		VK_ERROR(vk, "Error: could not present to queue.\n");
-		return;
-	}
+	// Hand it over to the peek thread.
+	os_thread_helper_lock(&w->oth);
+	w->intermediate.pending = true;
+	os_thread_helper_unlock(&w->oth);
 }
 
 enum comp_window_peek_eye
@@ -38,6 +38,11 @@ comp_window_peek_create(struct comp_compositor *c);
 void
 comp_window_peek_destroy(struct comp_window_peek **w_ptr);
 
+/*!
+ * Copies @p src to an intermediate image at most at XRT_WINDOW_PEEK_FPS, the
+ * peek thread then presents it to the window on its own. Never waits on the
+ * window so it can be called from the compositor's frame.
+ */
 void
 comp_window_peek_blit(struct comp_window_peek *w, VkImage src, int32_t width, int32_t height);
 
@@ -36,6 +36,14 @@
 #include <unistd.h>
 #endif
 
+#ifdef XRT_OS_LINUX
+#include "util/u_linux.h"
+#endif
+
+#ifdef XRT_OS_WINDOWS
+#include "util/u_windows.h"
+#endif
+
 #ifdef XRT_OS_ANDROID
 #include "android/android_custom_surface.h"
 #include "android/android_globals.h"
@@ -44,6 +52,14 @@
 DEBUG_GET_ONCE_LOG_OPTION(app_frame_lag_level, "XRT_APP_FRAME_LAG_LOG_AS_LEVEL", U_LOGGING_DEBUG)
 #define LOG_FRAME_LAG(...) U_LOG_IFL(debug_get_log_option_app_frame_lag_level(), u_log_get_global_level(), __VA_ARGS__)
 
+DEBUG_GET_ONCE_FLOAT_OPTION(min_resolution_scale, "XRT_COMPOSITOR_MIN_RESOLUTION_SCALE", 0.5f)
+
+/*!
+ * Fraction of the frame period that is kept free, the GPU time of the app is
+ * measured from xrEndFrame so it misses the work submitted before that.
+ */
+#define RESOLUTION_HEADROOM (0.1)
+
 /*
  *
  * Slot management functions.
@@ -113,6 +129,107 @@ multi_compositor_push_event(struct multi_compositor *mc, const union xrt_session
 }
 
 
+/*
+ *
+ * Resolution scale functions.
+ *
+ */
+
+static enum xrt_perf_notify_level
+resolution_scale_to_level(float scale)
+{
+	if (scale > 0.95f) {
+		return XRT_PERF_NOTIFY_LEVEL_NORMAL;
+	}
+	if (scale > 0.75f) {
+		return XRT_PERF_NOTIFY_LEVEL_WARNING;
+	}
+	return XRT_PERF_NOTIFY_LEVEL_IMPAIRED;
+}
+
+/*!
+ * Update the advised resolution scale after a frame of the app is done on the
+ * GPU, returns true if the notification level changed. Need to have the
+ * list_and_timing_lock held.
+ */
+static bool
+update_resolution_scale_locked(struct multi_compositor *mc,
+                               enum xrt_perf_notify_level *out_from_level,
+                               enum xrt_perf_notify_level *out_to_level)
+{
+	struct multi_system_compositor *msc = mc->msc;
+	struct u_pacing_app_stats stats = {0};
+
+	int64_t period_ns = msc->last_timings.predicted_display_period_ns;
+	if (period_ns <= 0 || !u_pa_get_stats(mc->upa, &stats) || stats.gpu_time_ns <= 0) {
+		return false;
+	}
+
+	double min_scale = fmin(fmax(debug_get_float_option_min_resolution_scale(), 0.1), 1.0);
+	double comp_gpu_time_ns = (double)msc->last_timings.predicted_gpu_time_ns;
+	double budget_ns = (double)period_ns * (1.0 - RESOLUTION_HEADROOM) - comp_gpu_time_ns;
+
+	/*
+	 * The GPU time goes with the pixel count, so the square of the scale.
+	 * It was measured at the current scale, assuming the app follows it,
+	 * if it doesn't the scale keeps going down to the minimum.
+	 */
+	double target = min_scale;
+	if (budget_ns > 0.0) {
+		target = mc->resolution.scale * sqrt(budget_ns / (double)stats.gpu_time_ns);
+	}
+	target = fmin(fmax(target, min_scale), 1.0);
+
+	// Go down quickly when over budget, but come back up slowly to not oscillate.
+	double alpha = target < mc->resolution.scale ? 0.1 : 0.02;
+	mc->resolution.scale += (float)((target - mc->resolution.scale) * alpha);
+
+	enum xrt_perf_notify_level level = resolution_scale_to_level(mc->resolution.scale);
+	if (level == mc->resolution.level) {
+		return false;
+	}
+
+	*out_from_level = mc->resolution.level;
+	*out_to_level = level;
+	mc->resolution.level = level;
+
+	return true;
+}
+
+/*!
+ * Marks the app's frame as done on the GPU and tells the app if it should
+ * change its render resolution, see @ref multi_compositor::resolution.
+ */
+static void
+mark_gpu_done(struct multi_compositor *mc, int64_t frame_id, int64_t now_ns)
+{
+	enum xrt_perf_notify_level from_level = XRT_PERF_NOTIFY_LEVEL_NORMAL;
+	enum xrt_perf_notify_level to_level = XRT_PERF_NOTIFY_LEVEL_NORMAL;
+
+	os_mutex_lock(&mc->msc->list_and_timing_lock);
+	u_pa_mark_gpu_done(mc->upa, frame_id, now_ns);
+	bool changed = update_resolution_scale_locked(mc, &from_level, &to_level);
+	os_mutex_unlock(&mc->msc->list_and_timing_lock);
+
+	if (!changed) {
+		return;
+	}
+
+	// Picked up by XR_EXT_performance_settings, the scale is in the frame stats.
+	union xrt_session_event xse = XRT_STRUCT_INIT;
+	xse.type = XRT_SESSION_EVENT_PERFORMANCE_CHANGE;
+	xse.performance.domain = XRT_PERF_DOMAIN_GPU;
+	xse.performance.sub_domain = XRT_PERF_SUB_DOMAIN_RENDERING;
+	xse.performance.from_level = from_level;
+	xse.performance.to_level = to_level;
+
+	xrt_result_t xret = multi_compositor_push_event(mc, &xse);
+	if (xret != XRT_SUCCESS) {
+		U_LOG_W("Failed to push performance change event: %d", xret);
+	}
+}
+
+
 /*
  *
  * Wait helper thread.
@@ -218,11 +335,26 @@ wait_for_scheduled_free(struct multi_compositor *mc)
 		    time_ns_to_ms_f((int64_t)v_mc->scheduled.data.display_time_ns - now_ns), //
 		    v_mc->scheduled.data.display_time_ns);                                   //
 
+		/*
+		 * Sleep until the render thread picks up the scheduled frame or
+		 * moves the next display time, or at the latest until the
+		 * scheduled frame is in the past, instead of polling.
+		 */
+		int64_t timeout_ns = v_mc->scheduled.data.display_time_ns - now_ns;
+		if (timeout_ns < (int64_t)U_TIME_1MS_IN_NS) {
+			timeout_ns = U_TIME_1MS_IN_NS;
+		}
+
+		mc->scheduled_waiting = true;
+
 		os_mutex_unlock(&mc->slot_lock);
 
-		os_precise_sleeper_nanosleep(&mc->scheduled_sleeper, U_TIME_1MS_IN_NS);
+		COMP_TRACE_IDENT(scheduled_wait);
+		os_semaphore_wait(&mc->scheduled_sem, (uint64_t)timeout_ns);
 
 		os_mutex_lock(&mc->slot_lock);
+
+		mc->scheduled_waiting = false;
 	}
 
 	os_mutex_unlock(&mc->slot_lock);
@@ -302,9 +434,7 @@ run_func(void *ptr)
 		// Sample time outside of lock.
 		int64_t now_ns = os_monotonic_get_ns();
 
-		os_mutex_lock(&mc->msc->list_and_timing_lock);
-		u_pa_mark_gpu_done(mc->upa, frame_id, now_ns);
-		os_mutex_unlock(&mc->msc->list_and_timing_lock);
+		mark_gpu_done(mc, frame_id, now_ns);
 
 		// Wait for the delivery slot.
 		wait_for_scheduled_free(mc);
@@ -772,6 +902,44 @@ multi_compositor_layer_equirect2(struct xrt_compositor *xc,
 	return XRT_SUCCESS;
 }
 
+/*
+ * The camera stream is started and stopped by the native compositor depending
+ * on if any client submits a passthrough layer, nothing to track per client.
+ */
+
+static xrt_result_t
+multi_compositor_create_passthrough(struct xrt_compositor *xc, const struct xrt_passthrough_create_info *info)
+{
+	return XRT_SUCCESS;
+}
+
+static xrt_result_t
+multi_compositor_create_passthrough_layer(struct xrt_compositor *xc,
+                                          const struct xrt_passthrough_layer_create_info *info)
+{
+	return XRT_SUCCESS;
+}
+
+static xrt_result_t
+multi_compositor_destroy_passthrough(struct xrt_compositor *xc)
+{
+	return XRT_SUCCESS;
+}
+
+static xrt_result_t
+multi_compositor_layer_passthrough(struct xrt_compositor *xc,
+                                   struct xrt_device *xdev,
+                                   const struct xrt_layer_data *data)
+{
+	struct multi_compositor *mc = multi_compositor(xc);
+
+	size_t index = mc->progress.layer_count++;
+	mc->progress.layers[index].xdev = xdev;
+	mc->progress.layers[index].data = *data;
+
+	return XRT_SUCCESS;
+}
+
 static xrt_result_t
 multi_compositor_layer_commit(struct xrt_compositor *xc, xrt_graphics_sync_handle_t sync_handle)
 {
@@ -808,9 +976,7 @@ multi_compositor_layer_commit(struct xrt_compositor *xc, xrt_graphics_sync_handl
 		// Assume that the app side compositor waited.
 		int64_t now_ns = os_monotonic_get_ns();
 
-		os_mutex_lock(&mc->msc->list_and_timing_lock);
-		u_pa_mark_gpu_done(mc->upa, frame_id, now_ns);
-		os_mutex_unlock(&mc->msc->list_and_timing_lock);
+		mark_gpu_done(mc, frame_id, now_ns);
 
 		wait_for_scheduled_free(mc);
 	}
@@ -833,10 +999,122 @@ multi_compositor_layer_commit_with_semaphore(struct xrt_compositor *xc,
 	return XRT_SUCCESS;
 }
 
+/*!
+ * Minimum CPU utilization, out of 1024, to ask the kernel for on the main and
+ * render threads of an app, makes it choose higher frequencies and cores.
+ */
+static uint32_t
+cpu_level_to_util_min(enum xrt_perf_set_level level)
+{
+	switch (level) {
+	case XRT_PERF_SET_LEVEL_POWER_SAVINGS: return 0;
+	case XRT_PERF_SET_LEVEL_SUSTAINED_LOW: return 256;
+	case XRT_PERF_SET_LEVEL_SUSTAINED_HIGH: return 512;
+	case XRT_PERF_SET_LEVEL_BOOST: return 768;
+	default: return 0;
+	}
+}
+
+static void
+apply_thread_hint(struct multi_compositor *mc, enum xrt_thread_hint hint, uint32_t thread_id)
+{
+#if defined(XRT_OS_LINUX)
+	/*
+	 * The render thread is the one that most directly decides if the app
+	 * makes its frames, give it a realtime priority below that of our own
+	 * threads. Needs CAP_SYS_NICE/RLIMIT_RTPRIO, falls back to nice values.
+	 */
+	struct u_linux_thread_scheduling sched = {0};
+	uint32_t util_min = cpu_level_to_util_min(mc->threads.cpu_level);
+
+	switch (hint) {
+	case XRT_THREAD_HINT_RENDERER_MAIN:
+		sched.rt_priority = 1;
+		sched.nice = -10;
+		sched.util_min = util_min;
+		break;
+	case XRT_THREAD_HINT_APPLICATION_MAIN:
+		sched.nice = -5;
+		sched.util_min = util_min;
+		break;
+	case XRT_THREAD_HINT_RENDERER_WORKER: sched.nice = -5; break;
+	case XRT_THREAD_HINT_APPLICATION_WORKER:
+	default: sched.nice = 0; break;
+	}
+
+	u_linux_try_to_set_thread_scheduling(u_log_get_global_level(), (pid_t)thread_id, &sched);
+#elif defined(XRT_OS_WINDOWS)
+	int priority = THREAD_PRIORITY_NORMAL;
+
+	switch (hint) {
+	case XRT_THREAD_HINT_RENDERER_MAIN: priority = THREAD_PRIORITY_HIGHEST; break;
+	case XRT_THREAD_HINT_APPLICATION_MAIN:
+	case XRT_THREAD_HINT_RENDERER_WORKER: priority = THREAD_PRIORITY_ABOVE_NORMAL; break;
+	case XRT_THREAD_HINT_APPLICATION_WORKER:
+	default: priority = THREAD_PRIORITY_NORMAL; break;
+	}
+
+	u_win_try_to_set_thread_priority(u_log_get_global_level(), (DWORD)thread_id, priority);
+#else
+	(void)mc;
+	(void)hint;
+	(void)thread_id;
+#endif
+}
+
 static xrt_result_t
 multi_compositor_set_thread_hint(struct xrt_compositor *xc, enum xrt_thread_hint hint, uint32_t thread_id)
 {
-	// No-op
+	COMP_TRACE_MARKER();
+
+	struct multi_compositor *mc = multi_compositor(xc);
+
+	// Remember the thread so a later performance level change can re-apply.
+	uint32_t i = 0;
+	for (; i < mc->threads.count; i++) {
+		if (mc->threads.ids[i] == thread_id) {
+			break;
+		}
+	}
+
+	if (i < ARRAY_SIZE(mc->threads.ids)) {
+		mc->threads.ids[i] = thread_id;
+		mc->threads.hints[i] = hint;
+		if (i == mc->threads.count) {
+			mc->threads.count++;
+		}
+	}
+
+	apply_thread_hint(mc, hint, thread_id);
+
+	return XRT_SUCCESS;
+}
+
+static xrt_result_t
+multi_compositor_set_performance_level(struct xrt_compositor *xc,
+                                       enum xrt_perf_domain domain,
+                                       enum xrt_perf_set_level level)
+{
+	COMP_TRACE_MARKER();
+
+	struct multi_compositor *mc = multi_compositor(xc);
+
+	if (domain != XRT_PERF_DOMAIN_CPU) {
+		// There is no vendor neutral way to ask for GPU clocks.
+		U_LOG_D("Ignoring performance level %u for GPU domain", level);
+		return XRT_SUCCESS;
+	}
+
+	if (mc->threads.cpu_level == level) {
+		return XRT_SUCCESS;
+	}
+
+	mc->threads.cpu_level = level;
+
+	for (uint32_t i = 0; i < mc->threads.count; i++) {
+		apply_thread_hint(mc, mc->threads.hints[i], mc->threads.ids[i]);
+	}
+
 	return XRT_SUCCESS;
 }
 
@@ -900,6 +1178,10 @@ multi_compositor_destroy(struct xrt_compositor *xc)
 	// Destroy the wait thread, destroy also stops the thread.
 	os_thread_helper_destroy(&mc->wait_thread.oth);
 
+	// We are off the rendering list, but the render thread might still be transferring our layers.
+	os_mutex_lock(&mc->msc->transfer_lock);
+	os_mutex_unlock(&mc->msc->transfer_lock);
+
 	// We are now off the rendering list, clear slots for any swapchains.
 	os_mutex_lock(&mc->msc->list_and_timing_lock);
 	slot_clear_locked(mc, &mc->progress);
@@ -911,7 +1193,7 @@ multi_compositor_destroy(struct xrt_compositor *xc)
 	u_pa_destroy(&mc->upa);
 
 	os_precise_sleeper_deinit(&mc->frame_sleeper);
-	os_precise_sleeper_deinit(&mc->scheduled_sleeper);
+	os_semaphore_destroy(&mc->scheduled_sem);
 
 	os_mutex_destroy(&mc->slot_lock);
 
@@ -931,6 +1213,29 @@ log_frame_time_diff(int64_t frame_time_ns, int64_t display_time_ns)
 	LOG_FRAME_LAG("Frame %s by %.2fms!", late ? "late" : "early", time_ns_to_ms_f(diff_ns));
 }
 
+static void
+wake_scheduled_waiter_locked(struct multi_compositor *mc)
+{
+	if (!mc->scheduled_waiting) {
+		return;
+	}
+
+	// Only release once per wait, the waiter clears the flag.
+	mc->scheduled_waiting = false;
+	os_semaphore_release(&mc->scheduled_sem);
+}
+
+void
+multi_compositor_set_next_frame_display(struct multi_compositor *mc, int64_t display_time_ns)
+{
+	os_mutex_lock(&mc->slot_lock);
+
+	mc->slot_next_frame_display = display_time_ns;
+	wake_scheduled_waiter_locked(mc);
+
+	os_mutex_unlock(&mc->slot_lock);
+}
+
 void
 multi_compositor_deliver_any_frames(struct multi_compositor *mc, int64_t display_time_ns)
 {
@@ -948,15 +1253,26 @@ multi_compositor_deliver_any_frames(struct multi_compositor *mc, int64_t display
 		if (!time_is_within_half_ms(frame_time_ns, display_time_ns)) {
 			log_frame_time_diff(frame_time_ns, display_time_ns);
 		}
+
+		wake_scheduled_waiter_locked(mc);
 	}
 
 	os_mutex_unlock(&mc->slot_lock);
 }
 
 void
-multi_compositor_latch_frame_locked(struct multi_compositor *mc, int64_t when_ns, int64_t system_frame_id)
+multi_compositor_latch_frame_locked(struct multi_compositor *mc,
+                                    int64_t when_ns,
+                                    int64_t system_frame_id,
+                                    int64_t display_time_ns)
 {
-	u_pa_latched(mc->upa, mc->delivered.data.frame_id, when_ns, system_frame_id);
+	u_pa_latched(                                //
+	    mc->upa,                                 //
+	    mc->delivered.data.frame_id,             //
+	    when_ns,                                 //
+	    system_frame_id,                         //
+	    display_time_ns,                         //
+	    mc->delivered.data.pose_sample_time_ns); //
 }
 
 void
@@ -995,17 +1311,30 @@ multi_compositor_create(struct multi_system_compositor *msc,
 	mc->base.base.layer_cylinder = multi_compositor_layer_cylinder;
 	mc->base.base.layer_equirect1 = multi_compositor_layer_equirect1;
 	mc->base.base.layer_equirect2 = multi_compositor_layer_equirect2;
+	mc->base.base.layer_passthrough = multi_compositor_layer_passthrough;
 	mc->base.base.layer_commit = multi_compositor_layer_commit;
+	mc->base.base.create_passthrough = multi_compositor_create_passthrough;
+	mc->base.base.create_passthrough_layer = multi_compositor_create_passthrough_layer;
+	mc->base.base.destroy_passthrough = multi_compositor_destroy_passthrough;
 	mc->base.base.layer_commit_with_semaphore = multi_compositor_layer_commit_with_semaphore;
 	mc->base.base.destroy = multi_compositor_destroy;
 	mc->base.base.set_thread_hint = multi_compositor_set_thread_hint;
+	mc->base.base.set_performance_level = multi_compositor_set_performance_level;
 	mc->base.base.get_display_refresh_rate = multi_compositor_get_display_refresh_rate;
 	mc->base.base.request_display_refresh_rate = multi_compositor_request_display_refresh_rate;
 	mc->msc = msc;
 	mc->xses = xses;
 	mc->xsi = *xsi;
 
+	// The default level of XR_EXT_performance_settings.
+	mc->threads.cpu_level = XRT_PERF_SET_LEVEL_SUSTAINED_HIGH;
+
+	// Full resolution until the GPU runs out of headroom.
+	mc->resolution.scale = 1.0f;
+	mc->resolution.level = XRT_PERF_NOTIFY_LEVEL_NORMAL;
+
 	os_mutex_init(&mc->slot_lock);
+	os_mutex_set_name(&mc->slot_lock, "comp_multi_compositor::slot_lock");
 	os_thread_helper_init(&mc->wait_thread.oth);
 
 	// Passthrough our formats from the native compositor to the client.
@@ -1015,7 +1344,7 @@ multi_compositor_create(struct multi_system_compositor *msc,
 	os_precise_sleeper_init(&mc->frame_sleeper);
 
 	// Used in scheduled waiting function.
-	os_precise_sleeper_init(&mc->scheduled_sleeper);
+	os_semaphore_init(&mc->scheduled_sem, 0);
 
 	// This is safe to do without a lock since we are not on the list yet.
 	u_paf_create(msc->upaf, &mc->upa);
@@ -40,6 +40,14 @@ extern "C" {
  */
 #define MULTI_MAX_LAYERS XRT_MAX_LAYERS
 
+/*!
+ * Number of max threads per @ref multi_compositor that an app can give hints
+ * about, further hints for new threads are ignored.
+ *
+ * @ingroup comp_multi
+ */
+#define MULTI_MAX_HINTED_THREADS 16
+
 
 /*
  *
@@ -115,8 +123,12 @@ struct multi_compositor
 	//! Used to implement wait frame, only used for in process.
 	struct os_precise_sleeper frame_sleeper;
 
-	//! Used when waiting for the scheduled frame to complete.
-	struct os_precise_sleeper scheduled_sleeper;
+	/*!
+	 * Released by the render thread when the scheduled slot is cleared or
+	 * the next display time has moved on, used when waiting for the
+	 * scheduled slot to be free, see @ref scheduled_waiting.
+	 */
+	struct os_semaphore scheduled_sem;
 
 	struct
 	{
@@ -177,6 +189,9 @@ struct multi_compositor
 	//! Scheduled frames for a future timepoint.
 	struct multi_layer_slot scheduled;
 
+	//! Is the wait thread waiting on @ref scheduled_sem, protected by the slot lock.
+	bool scheduled_waiting;
+
 	/*!
 	 * Fully ready to be used.
 	 * Not protected by the slot lock as it is only touched by the main render loop thread.
@@ -185,7 +200,36 @@ struct multi_compositor
 
 	struct u_pacing_app *upa;
 
+	/*!
+	 * Advised scale of the app's render resolution, worked out from how much
+	 * of the frame the app's GPU work and the compositor's leave over.
+	 * Protected by the list_and_timing_lock.
+	 */
+	struct
+	{
+		//! Filtered scale, between the minimum and 1.
+		float scale;
+
+		//! Last level sent with @ref XRT_SESSION_EVENT_PERFORMANCE_CHANGE.
+		enum xrt_perf_notify_level level;
+	} resolution;
+
 	float current_refresh_rate_hz;
+
+	/*!
+	 * Threads the app has given hints about and the performance level it
+	 * asked for, used to schedule those threads.
+	 * Not protected by any lock as it is only touched by the client thread.
+	 */
+	struct
+	{
+		uint32_t ids[MULTI_MAX_HINTED_THREADS];
+		enum xrt_thread_hint hints[MULTI_MAX_HINTED_THREADS];
+		uint32_t count;
+
+		//! Last level set for @ref XRT_PERF_DOMAIN_CPU.
+		enum xrt_perf_set_level cpu_level;
+	} threads;
 };
 
 /*!
@@ -220,6 +264,17 @@ multi_compositor_create(struct multi_system_compositor *msc,
 XRT_CHECK_RESULT xrt_result_t
 multi_compositor_push_event(struct multi_compositor *mc, const union xrt_session_event *xse);
 
+/*!
+ * Set the display time at which the next frames to be picked up will be
+ * displayed, wakes up anybody waiting for the scheduled slot. Called by the
+ * render thread.
+ *
+ * @ingroup comp_multi
+ * @private @memberof multi_compositor
+ */
+void
+multi_compositor_set_next_frame_display(struct multi_compositor *mc, int64_t display_time_ns);
+
 /*!
  * Deliver any scheduled frames at that is to be display at or after the given @p display_time_ns. Called by the render
  * thread and copies data from multi_compositor::scheduled to multi_compositor::delivered while holding the slot_lock.
@@ -234,11 +289,17 @@ multi_compositor_deliver_any_frames(struct multi_compositor *mc, int64_t display
  * Makes the current delivered frame as latched, called by the render thread.
  * The list_and_timing_lock is held when this function is called.
  *
+ * @param display_time_ns When the system frame latching it is predicted to be
+ *                        displayed, used for the motion-to-photon estimate.
+ *
  * @ingroup comp_multi
  * @private @memberof multi_compositor
  */
 void
-multi_compositor_latch_frame_locked(struct multi_compositor *mc, int64_t when_ns, int64_t system_frame_id);
+multi_compositor_latch_frame_locked(struct multi_compositor *mc,
+                                    int64_t when_ns,
+                                    int64_t system_frame_id,
+                                    int64_t display_time_ns);
 
 /*!
  * Clears and retires the delivered frame, called by the render thread.
@@ -304,6 +365,14 @@ enum multi_system_state
 	 * on its @ref xrt_compositor_native.
 	 */
 	MULTI_SYSTEM_STATE_STOPPING,
+
+	/*!
+	 * There are no active sessions, but warm standby is enabled so the
+	 * multi-client system compositor has not called @ref xrt_comp_end_session
+	 * on its @ref xrt_compositor_native. No frames are submitted, the next
+	 * app session goes straight to running.
+	 */
+	MULTI_SYSTEM_STATE_STANDBY,
 };
 
 /*!
@@ -351,6 +420,9 @@ struct multi_system_compositor
 
 		//! Number of active sessions, protected by oth.
 		uint64_t active_count;
+
+		//! Keep the native session begun when there are no active sessions, protected by oth.
+		bool warm_standby;
 	} sessions;
 
 	/*!
@@ -359,10 +431,18 @@ struct multi_system_compositor
 	 */
 	struct os_mutex list_and_timing_lock;
 
+	/*!
+	 * Held by the render thread while it pushes the layers of the clients
+	 * it collected, after it has let go of @ref list_and_timing_lock. A
+	 * client being destroyed takes it to wait until it is no longer used.
+	 */
+	struct os_mutex transfer_lock;
+
 	struct
 	{
 		int64_t predicted_display_time_ns;
 		int64_t predicted_display_period_ns;
+		int64_t predicted_gpu_time_ns;
 		int64_t diff_ns;
 	} last_timings;
 
@@ -1,4 +1,4 @@
-// Copyright 2019-2024, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -23,9 +23,7 @@
 #include "util/u_trace_marker.h"
 #include "util/u_distortion_mesh.h"
 
-#ifdef XRT_OS_LINUX
-#include "util/u_linux.h"
-#endif
+#include "util/u_thread_policy.h"
 
 #include "multi/comp_multi_private.h"
 #include "multi/comp_multi_interface.h"
@@ -207,6 +205,25 @@ do_equirect2_layer(struct xrt_compositor *xc, struct multi_compositor *mc, struc
 	xrt_comp_layer_equirect2(xc, xdev, xcs, data);
 }
 
+static void
+do_passthrough_layer(struct xrt_compositor *xc,
+                     struct multi_compositor *mc,
+                     struct multi_layer_entry *layer,
+                     uint32_t i)
+{
+	struct xrt_device *xdev = layer->xdev;
+
+	if (xdev == NULL) {
+		U_LOG_E("Invalid xdev for passthrough layer #%u!", i);
+		return;
+	}
+
+	// Cast away
+	struct xrt_layer_data *data = (struct xrt_layer_data *)&layer->data;
+
+	xrt_comp_layer_passthrough(xc, xdev, data);
+}
+
 static int
 overlay_sort_func(const void *a, const void *b)
 {
@@ -250,20 +267,23 @@ find_active_blend_mode(struct multi_compositor **overlay_sorted_clients, size_t
 	return XRT_BLEND_MODE_OPAQUE;
 }
 
-static void
-transfer_layers_locked(struct multi_system_compositor *msc, int64_t display_time_ns, int64_t system_frame_id)
+/*!
+ * Delivers frames and picks the clients whose layers should be shown, this is
+ * the part that needs the list_and_timing_lock.
+ */
+static size_t
+collect_clients_locked(struct multi_system_compositor *msc,
+                       int64_t display_time_ns,
+                       int64_t system_frame_id,
+                       struct multi_compositor *array[MULTI_MAX_CLIENTS])
 {
 	COMP_TRACE_MARKER();
 
-	struct xrt_compositor *xc = &msc->xcn->base;
-
-	struct multi_compositor *array[MULTI_MAX_CLIENTS] = {0};
-
 	// To mark latching.
 	int64_t now_ns = os_monotonic_get_ns();
 
 	size_t count = 0;
-	for (size_t k = 0; k < ARRAY_SIZE(array); k++) {
+	for (size_t k = 0; k < MULTI_MAX_CLIENTS; k++) {
 		struct multi_compositor *mc = msc->clients[k];
 
 		// Array can be empty
@@ -296,11 +316,30 @@ transfer_layers_locked(struct multi_system_compositor *msc, int64_t display_time
 		}
 
 		// The list_and_timing_lock is held when callign this function.
-		multi_compositor_latch_frame_locked(mc, now_ns, system_frame_id);
+		multi_compositor_latch_frame_locked(mc, now_ns, system_frame_id, display_time_ns);
 
 		array[count++] = msc->clients[k];
 	}
 
+	return count;
+}
+
+/*!
+ * Pushes the layers of the collected clients to the native compositor. Only
+ * needs the transfer_lock, the delivered slots are only touched by the render
+ * thread so client frame calls can go on in parallel.
+ */
+static void
+transfer_layers(struct multi_system_compositor *msc,
+                struct multi_compositor *array[MULTI_MAX_CLIENTS],
+                size_t count,
+                int64_t display_time_ns,
+                int64_t system_frame_id)
+{
+	COMP_TRACE_MARKER();
+
+	struct xrt_compositor *xc = &msc->xcn->base;
+
 	// Sort the stack array
 	qsort(array, count, sizeof(struct multi_compositor *), overlay_sort_func);
 
@@ -330,6 +369,7 @@ transfer_layers_locked(struct multi_system_compositor *msc, int64_t display_time
 			case XRT_LAYER_CYLINDER: do_cylinder_layer(xc, mc, layer, i); break;
 			case XRT_LAYER_EQUIRECT1: do_equirect1_layer(xc, mc, layer, i); break;
 			case XRT_LAYER_EQUIRECT2: do_equirect2_layer(xc, mc, layer, i); break;
+			case XRT_LAYER_PASSTHROUGH: do_passthrough_layer(xc, mc, layer, i); break;
 			default: U_LOG_E("Unhandled layer type '%i'!", layer->data.type); break;
 			}
 		}
@@ -349,9 +389,7 @@ broadcast_timings_to_clients(struct multi_system_compositor *msc, int64_t predic
 			continue;
 		}
 
-		os_mutex_lock(&mc->slot_lock);
-		mc->slot_next_frame_display = predicted_display_time_ns;
-		os_mutex_unlock(&mc->slot_lock);
+		multi_compositor_set_next_frame_display(mc, predicted_display_time_ns);
 	}
 
 	os_mutex_unlock(&msc->list_and_timing_lock);
@@ -361,6 +399,7 @@ static void
 broadcast_timings_to_pacers(struct multi_system_compositor *msc,
                             int64_t predicted_display_time_ns,
                             int64_t predicted_display_period_ns,
+                            int64_t predicted_gpu_time_ns,
                             int64_t diff_ns)
 {
 	COMP_TRACE_MARKER();
@@ -379,13 +418,12 @@ broadcast_timings_to_pacers(struct multi_system_compositor *msc,
 		    predicted_display_period_ns, //
 		    diff_ns);                    //
 
-		os_mutex_lock(&mc->slot_lock);
-		mc->slot_next_frame_display = predicted_display_time_ns;
-		os_mutex_unlock(&mc->slot_lock);
+		multi_compositor_set_next_frame_display(mc, predicted_display_time_ns);
 	}
 
 	msc->last_timings.predicted_display_time_ns = predicted_display_time_ns;
 	msc->last_timings.predicted_display_period_ns = predicted_display_period_ns;
+	msc->last_timings.predicted_gpu_time_ns = predicted_gpu_time_ns;
 	msc->last_timings.diff_ns = diff_ns;
 
 	os_mutex_unlock(&msc->list_and_timing_lock);
@@ -460,11 +498,36 @@ update_session_state_locked(struct multi_system_compositor *msc)
 			break;
 		}
 
+		if (msc->sessions.warm_standby) {
+			msc->sessions.state = MULTI_SYSTEM_STATE_STANDBY;
+			U_LOG_I("Native session on standby, %u active app session(s).",
+			        (uint32_t)msc->sessions.active_count);
+			break;
+		}
+
 		msc->sessions.state = MULTI_SYSTEM_STATE_STOPPED;
 		xrt_comp_end_session(xc);
 		U_LOG_I("Stopped native session, %u active app session(s).", (uint32_t)msc->sessions.active_count);
 		break;
 
+	case MULTI_SYSTEM_STATE_STANDBY:
+		if (msc->sessions.active_count > 0) {
+			// Already begun, so no need to call xrt_comp_begin_session.
+			msc->sessions.state = MULTI_SYSTEM_STATE_RUNNING;
+			U_LOG_I("Resumed native session from standby, %u active app session(s).",
+			        (uint32_t)msc->sessions.active_count);
+			break;
+		}
+
+		if (msc->sessions.warm_standby) {
+			break;
+		}
+
+		msc->sessions.state = MULTI_SYSTEM_STATE_STOPPED;
+		xrt_comp_end_session(xc);
+		U_LOG_I("Stopped native session from standby.");
+		break;
+
 	case MULTI_SYSTEM_STATE_INVALID:
 	default:
 		U_LOG_E("Got invalid state %u", msc->sessions.state);
@@ -479,10 +542,8 @@ multi_main_loop(struct multi_system_compositor *msc)
 	U_TRACE_SET_THREAD_NAME("Multi Client Module");
 	os_thread_helper_name(&msc->oth, "Multi Client Module");
 
-#ifdef XRT_OS_LINUX
 	// Try to raise priority of this thread.
-	u_linux_try_to_set_realtime_priority_on_thread(U_LOGGING_INFO, "Multi Client Module");
-#endif
+	u_thread_policy_apply(U_LOGGING_INFO, OS_THREAD_ROLE_COMPOSITOR, "Multi Client Module");
 
 	struct xrt_compositor *xc = &msc->xcn->base;
 
@@ -498,7 +559,8 @@ multi_main_loop(struct multi_system_compositor *msc)
 		// Updates msc->sessions.active depending on active client sessions.
 		update_session_state_locked(msc);
 
-		if (msc->sessions.state == MULTI_SYSTEM_STATE_STOPPED) {
+		if (msc->sessions.state == MULTI_SYSTEM_STATE_STOPPED ||
+		    msc->sessions.state == MULTI_SYSTEM_STATE_STANDBY) {
 			// Sleep and wait to be signaled.
 			os_thread_helper_wait_locked(&msc->oth);
 
@@ -534,17 +596,32 @@ multi_main_loop(struct multi_system_compositor *msc)
 		int64_t diff_ns = predicted_display_time_ns - now_ns;
 
 		// Now we know the diff, broadcast to pacers.
-		broadcast_timings_to_pacers(msc, predicted_display_time_ns, predicted_display_period_ns, diff_ns);
+		broadcast_timings_to_pacers(     //
+		    msc,                         //
+		    predicted_display_time_ns,   //
+		    predicted_display_period_ns, //
+		    predicted_gpu_time_ns,       //
+		    diff_ns);                    //
 
 		xrt_comp_begin_frame(xc, frame_id);
 
-		// Make sure that the clients doesn't go away while we transfer layers.
+		struct multi_compositor *array[MULTI_MAX_CLIENTS] = {0};
+
 		os_mutex_lock(&msc->list_and_timing_lock);
-		transfer_layers_locked(msc, predicted_display_time_ns, frame_id);
+		size_t count = collect_clients_locked(msc, predicted_display_time_ns, frame_id, array);
+
+		// Make sure that the clients doesn't go away while we transfer layers.
+		os_mutex_lock(&msc->transfer_lock);
 		os_mutex_unlock(&msc->list_and_timing_lock);
 
+		transfer_layers(msc, array, count, predicted_display_time_ns, frame_id);
+		os_mutex_unlock(&msc->transfer_lock);
+
 		xrt_comp_layer_commit(xc, XRT_GRAPHICS_SYNC_HANDLE_INVALID);
 
+		// One system frame done, gives Tracy its frame boundaries.
+		U_TRACE_FRAME_MARK();
+
 		// Re-lock the thread for check in while statement.
 		os_thread_helper_lock(&msc->oth);
 	}
@@ -553,6 +630,7 @@ multi_main_loop(struct multi_system_compositor *msc)
 	switch (msc->sessions.state) {
 	case MULTI_SYSTEM_STATE_RUNNING:
 	case MULTI_SYSTEM_STATE_STOPPING:
+	case MULTI_SYSTEM_STATE_STANDBY:
 		U_LOG_I("Stopped native session, shutting down.");
 		xrt_comp_end_session(xc);
 		break;
@@ -580,6 +658,21 @@ thread_func(void *ptr)
  *
  */
 
+static xrt_result_t
+system_compositor_set_warm_standby(struct xrt_system_compositor *xsc, bool enabled)
+{
+	struct multi_system_compositor *msc = multi_system_compositor(xsc);
+
+	os_thread_helper_lock(&msc->oth);
+	msc->sessions.warm_standby = enabled;
+
+	// Wake up the thread so it can end the session if on standby.
+	os_thread_helper_signal_locked(&msc->oth);
+	os_thread_helper_unlock(&msc->oth);
+
+	return XRT_SUCCESS;
+}
+
 static xrt_result_t
 system_compositor_set_state(struct xrt_system_compositor *xsc, struct xrt_compositor *xc, bool visible, bool focused)
 {
@@ -677,6 +770,38 @@ system_compositor_notify_display_refresh_changed(struct xrt_system_compositor *x
 	return multi_compositor_push_event(mc, &xse);
 }
 
+static xrt_result_t
+system_compositor_get_frame_stats(struct xrt_system_compositor *xsc,
+                                  struct xrt_compositor *xc,
+                                  struct xrt_compositor_frame_stats *out_stats)
+{
+	struct multi_system_compositor *msc = multi_system_compositor(xsc);
+	struct multi_compositor *mc = multi_compositor(xc);
+
+	struct u_pacing_app_stats stats = {0};
+
+	// The pacer is only touched with this lock held.
+	os_mutex_lock(&msc->list_and_timing_lock);
+	bool got = u_pa_get_stats(mc->upa, &stats);
+	float resolution_scale = mc->resolution.scale;
+	os_mutex_unlock(&msc->list_and_timing_lock);
+
+	if (!got) {
+		return XRT_ERROR_MULTI_SESSION_NOT_IMPLEMENTED;
+	}
+
+	out_stats->cpu_time_ns = stats.cpu_time_ns;
+	out_stats->draw_time_ns = stats.draw_time_ns;
+	out_stats->gpu_time_ns = stats.gpu_time_ns;
+	out_stats->latency_ns = stats.latency_ns;
+	out_stats->completed_frame_count = stats.completed_frame_count;
+	out_stats->missed_frame_count = stats.missed_frame_count;
+	out_stats->discarded_frame_count = stats.discarded_frame_count;
+	out_stats->resolution_scale = resolution_scale;
+
+	return XRT_SUCCESS;
+}
+
 
 /*
  *
@@ -707,6 +832,7 @@ system_compositor_destroy(struct xrt_system_compositor *xsc)
 
 	xrt_comp_native_destroy(&msc->xcn);
 
+	os_mutex_destroy(&msc->transfer_lock);
 	os_mutex_destroy(&msc->list_and_timing_lock);
 
 	free(msc);
@@ -754,6 +880,8 @@ comp_multi_create_system_compositor(struct xrt_compositor_native *xcn,
 	msc->xmcc.notify_loss_pending = system_compositor_notify_loss_pending;
 	msc->xmcc.notify_lost = system_compositor_notify_lost;
 	msc->xmcc.notify_display_refresh_changed = system_compositor_notify_display_refresh_changed;
+	msc->xmcc.get_frame_stats = system_compositor_get_frame_stats;
+	msc->xmcc.set_warm_standby = system_compositor_set_warm_standby;
 	msc->base.xmcc = &msc->xmcc;
 	msc->base.info = *xsci;
 	msc->upaf = upaf;
@@ -762,6 +890,9 @@ comp_multi_create_system_compositor(struct xrt_compositor_native *xcn,
 	msc->sessions.state = do_warm_start ? MULTI_SYSTEM_STATE_INIT_WARM_START : MULTI_SYSTEM_STATE_STOPPED;
 
 	os_mutex_init(&msc->list_and_timing_lock);
+	os_mutex_init(&msc->transfer_lock);
+	os_mutex_set_name(&msc->list_and_timing_lock, "multi_system_compositor::list_and_timing_lock");
+	os_mutex_set_name(&msc->transfer_lock, "multi_system_compositor::transfer_lock");
 
 	//! @todo Make the clients not go from IDLE to READY before we have completed a first frame.
 	// Make sure there is at least some sort of valid frame data here.
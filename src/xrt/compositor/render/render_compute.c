@@ -1,4 +1,4 @@
-// Copyright 2019-2023, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -14,6 +14,8 @@
 
 #include "render/render_interface.h"
 
+#include <string.h>
+
 
 /*
  *
@@ -146,6 +148,94 @@ update_compute_layer_descriptor_set(struct vk_bundle *vk,
 	    NULL);                             // pDescriptorCopies
 }
 
+static bool
+layer_descriptor_matches(const struct render_compute_layer_descriptor *desc,
+                         VkSampler src_samplers[RENDER_MAX_IMAGES_SIZE],
+                         VkImageView src_image_views[RENDER_MAX_IMAGES_SIZE],
+                         uint32_t image_count,
+                         VkImageView target_image_view,
+                         VkBuffer ubo)
+{
+	if (!desc->valid || desc->ubo != ubo || desc->target_image_view != target_image_view ||
+	    desc->image_count != image_count) {
+		return false;
+	}
+
+	return memcmp(desc->src_samplers, src_samplers, sizeof(VkSampler) * image_count) == 0 &&
+	       memcmp(desc->src_image_views, src_image_views, sizeof(VkImageView) * image_count) == 0;
+}
+
+/*!
+ * Returns a descriptor set of the current frame that refers to the given
+ * images, only writing one if none of them already does. Sets used earlier
+ * in the same frame are never evicted, as they are already bound.
+ */
+static VkDescriptorSet
+get_layer_descriptor_set(struct render_compute *render,
+                         VkSampler src_samplers[RENDER_MAX_IMAGES_SIZE],
+                         VkImageView src_image_views[RENDER_MAX_IMAGES_SIZE],
+                         uint32_t image_count,
+                         VkImageView target_image_view,
+                         VkBuffer ubo)
+{
+	static_assert(RENDER_LAYER_DESCRIPTOR_CACHE_SIZE >= RENDER_MAX_LAYER_RUNS_SIZE, "Too small layer cache");
+
+	struct render_resources *r = render->r;
+	struct render_frame_resources *frame = render->frame;
+	const uint64_t now = r->frame_counter;
+
+	struct render_compute_layer_descriptor *evict = NULL;
+	for (uint32_t i = 0; i < RENDER_LAYER_DESCRIPTOR_CACHE_SIZE; i++) {
+		struct render_compute_layer_descriptor *desc = &frame->layer_descriptors[i];
+
+		bool matches = layer_descriptor_matches( //
+		    desc,                                //
+		    src_samplers,                        //
+		    src_image_views,                     //
+		    image_count,                         //
+		    target_image_view,                   //
+		    ubo);                                //
+		if (matches) {
+			desc->last_used = now;
+			return desc->descriptor_set;
+		}
+
+		if (desc->valid && desc->last_used == now) {
+			continue;
+		}
+
+		// Prefer unused sets, then the least recently used one.
+		if (evict == NULL || (evict->valid && (!desc->valid || desc->last_used < evict->last_used))) {
+			evict = desc;
+		}
+	}
+
+	assert(evict != NULL);
+
+	update_compute_layer_descriptor_set( //
+	    r->vk,                           //
+	    r->compute.src_binding,          //
+	    src_samplers,                    //
+	    src_image_views,                 //
+	    image_count,                     //
+	    r->compute.target_binding,       //
+	    target_image_view,               //
+	    r->compute.ubo_binding,          //
+	    ubo,                             //
+	    VK_WHOLE_SIZE,                   //
+	    evict->descriptor_set);          //
+
+	evict->valid = true;
+	evict->last_used = now;
+	evict->ubo = ubo;
+	evict->target_image_view = target_image_view;
+	evict->image_count = image_count;
+	memcpy(evict->src_samplers, src_samplers, sizeof(VkSampler) * image_count);
+	memcpy(evict->src_image_views, src_image_views, sizeof(VkImageView) * image_count);
+
+	return evict->descriptor_set;
+}
+
 XRT_MAYBE_UNUSED static void
 update_compute_shared_descriptor_set(struct vk_bundle *vk,
                                      uint32_t src_binding,
@@ -159,6 +249,9 @@ update_compute_shared_descriptor_set(struct vk_bundle *vk,
                                      uint32_t ubo_binding,
                                      VkBuffer ubo_buffer,
                                      VkDeviceSize ubo_size,
+                                     uint32_t quad_binding,
+                                     VkSampler quad_samplers[RENDER_DISTORTION_MAX_QUADS],
+                                     VkImageView quad_image_views[RENDER_DISTORTION_MAX_QUADS],
                                      VkDescriptorSet descriptor_set,
                                      uint32_t view_count)
 {
@@ -187,7 +280,14 @@ update_compute_shared_descriptor_set(struct vk_bundle *vk,
 	    .range = ubo_size,
 	};
 
-	VkWriteDescriptorSet write_descriptor_sets[4] = {
+	VkDescriptorImageInfo quad_image_info[RENDER_DISTORTION_MAX_QUADS];
+	for (uint32_t i = 0; i < RENDER_DISTORTION_MAX_QUADS; ++i) {
+		quad_image_info[i].sampler = quad_samplers[i];
+		quad_image_info[i].imageView = quad_image_views[i];
+		quad_image_info[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	}
+
+	VkWriteDescriptorSet write_descriptor_sets[5] = {
 	    {
 	        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
 	        .dstSet = descriptor_set,
@@ -220,6 +320,14 @@ update_compute_shared_descriptor_set(struct vk_bundle *vk,
 	        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
 	        .pBufferInfo = &buffer_info,
 	    },
+	    {
+	        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+	        .dstSet = descriptor_set,
+	        .dstBinding = quad_binding,
+	        .descriptorCount = RENDER_DISTORTION_MAX_QUADS,
+	        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+	        .pImageInfo = quad_image_info,
+	    },
 	};
 
 	vk->vkUpdateDescriptorSets(            //
@@ -230,6 +338,42 @@ update_compute_shared_descriptor_set(struct vk_bundle *vk,
 	    NULL);                             // pDescriptorCopies
 }
 
+/*!
+ * Writes the quads to the distortion UBO and gets the images to bind, unused
+ * image slots are filled with the mock image as all of them need to be valid.
+ */
+static void
+setup_distortion_quads(struct render_resources *r,
+                       const struct render_compute_distortion_quads *quads,
+                       struct render_compute_distortion_ubo_data *data,
+                       VkSampler out_samplers[RENDER_DISTORTION_MAX_QUADS],
+                       VkImageView out_image_views[RENDER_DISTORTION_MAX_QUADS])
+{
+	uint32_t count = quads != NULL ? MIN(quads->count, RENDER_DISTORTION_MAX_QUADS) : 0;
+
+	data->quad_count.value = count;
+
+	for (uint32_t i = 0; i < count; i++) {
+		out_samplers[i] = quads->samplers[i];
+		out_image_views[i] = quads->image_views[i];
+
+		data->quad_flags[i].unpremultiplied = quads->unpremultiplied[i];
+		data->quad_post_transforms[i] = quads->post_transforms[i];
+		data->quad_extents[i].val = quads->extents[i];
+
+		for (uint32_t view = 0; view < r->view_count; view++) {
+			data->quad_positions[view][i].val = quads->positions[view][i];
+			data->quad_normals[view][i].val = quads->normals[view][i];
+			data->inverse_quad_transforms[view][i] = quads->inverse_transforms[view][i];
+		}
+	}
+
+	for (uint32_t i = count; i < RENDER_DISTORTION_MAX_QUADS; i++) {
+		out_samplers[i] = r->samplers.mock;
+		out_image_views[i] = r->mock.color.image_view;
+	}
+}
+
 XRT_MAYBE_UNUSED static void
 update_compute_descriptor_set_target(struct vk_bundle *vk,
                                      uint32_t target_binding,
@@ -294,21 +438,11 @@ render_compute_init(struct render_compute *render, struct render_resources *r)
 
 	struct vk_bundle *vk = r->vk;
 	render->r = r;
-
-	for (uint32_t i = 0; i < RENDER_MAX_LAYER_RUNS_COUNT(r); i++) {
-		ret = vk_create_descriptor_set(             //
-		    vk,                                     // vk_bundle
-		    r->compute.descriptor_pool,             // descriptor_pool
-		    r->compute.layer.descriptor_set_layout, // descriptor_set_layout
-		    &render->layer_descriptor_sets[i]);     // descriptor_set
-		VK_CHK_WITH_RET(ret, "vk_create_descriptor_set", false);
-
-		VK_NAME_DESCRIPTOR_SET(vk, render->layer_descriptor_sets[i], "render_compute layer descriptor set");
-	}
+	render->frame = &r->frames[r->frame_index];
 
 	ret = vk_create_descriptor_set(                  //
 	    vk,                                          // vk_bundle
-	    r->compute.descriptor_pool,                  // descriptor_pool
+	    render->frame->compute_descriptor_pool,      // descriptor_pool
 	    r->compute.distortion.descriptor_set_layout, // descriptor_set_layout
 	    &render->shared_descriptor_set);             // descriptor_set
 	VK_CHK_WITH_RET(ret, "vk_create_descriptor_set", false);
@@ -324,7 +458,7 @@ render_compute_begin(struct render_compute *render)
 	VkResult ret;
 	struct vk_bundle *vk = vk_from_render(render);
 
-	ret = vk->vkResetCommandPool(vk->device, render->r->cmd_pool, 0);
+	ret = vk->vkResetCommandPool(vk->device, render->frame->cmd_pool, 0);
 	VK_CHK_WITH_RET(ret, "vkResetCommandPool", false);
 
 	VkCommandBufferBeginInfo begin_info = {
@@ -333,20 +467,20 @@ render_compute_begin(struct render_compute *render)
 	};
 
 	ret = vk->vkBeginCommandBuffer( //
-	    render->r->cmd,             //
+	    render->frame->cmd,         //
 	    &begin_info);               //
 	VK_CHK_WITH_RET(ret, "vkBeginCommandBuffer", false);
 
-	vk->vkCmdResetQueryPool(   //
-	    render->r->cmd,        //
-	    render->r->query_pool, //
-	    0,                     // firstQuery
-	    2);                    // queryCount
+	vk->vkCmdResetQueryPool(       //
+	    render->frame->cmd,        //
+	    render->frame->query_pool, //
+	    0,                         // firstQuery
+	    2);                        // queryCount
 
 	vk->vkCmdWriteTimestamp(               //
-	    render->r->cmd,                    //
+	    render->frame->cmd,                //
 	    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, // pipelineStage
-	    render->r->query_pool,             //
+	    render->frame->query_pool,         //
 	    0);                                // query
 
 	return true;
@@ -359,12 +493,12 @@ render_compute_end(struct render_compute *render)
 	VkResult ret;
 
 	vk->vkCmdWriteTimestamp(                  //
-	    render->r->cmd,                       //
+	    render->frame->cmd,                   //
 	    VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, // pipelineStage
-	    render->r->query_pool,                //
+	    render->frame->query_pool,            //
 	    1);                                   // query
 
-	ret = vk->vkEndCommandBuffer(render->r->cmd);
+	ret = vk->vkEndCommandBuffer(render->frame->cmd);
 	VK_CHK_WITH_RET(ret, "vkEndCommandBuffer", false);
 
 	return true;
@@ -379,57 +513,61 @@ render_compute_fini(struct render_compute *render)
 
 	// Reclaimed by vkResetDescriptorPool.
 	render->shared_descriptor_set = VK_NULL_HANDLE;
-	for (uint32_t i = 0; i < ARRAY_SIZE(render->layer_descriptor_sets); i++) {
-		render->layer_descriptor_sets[i] = VK_NULL_HANDLE;
-	}
 
-	vk->vkResetDescriptorPool(vk->device, render->r->compute.descriptor_pool, 0);
+	vk->vkResetDescriptorPool(vk->device, render->frame->compute_descriptor_pool, 0);
 
 	render->r = NULL;
+	render->frame = NULL;
 }
 
 void
 render_compute_layers(struct render_compute *render,
-                      VkDescriptorSet descriptor_set,
                       VkBuffer ubo,
                       VkSampler src_samplers[RENDER_MAX_IMAGES_SIZE],
                       VkImageView src_image_views[RENDER_MAX_IMAGES_SIZE],
                       uint32_t num_srcs,
                       VkImageView target_image_view,
                       const struct render_viewport_data *view,
-                      bool do_timewarp)
+                      bool do_timewarp,
+                      bool projection_only,
+                      bool foveated)
 {
 	assert(render->r != NULL);
 
 	struct vk_bundle *vk = vk_from_render(render);
 	struct render_resources *r = render->r;
 
+	// Times just this pass, the barriers around it are done by the caller.
+	uint32_t scope = vk_gpu_profiler_begin_scope(vk, &r->profiler, render->frame->cmd, "cs layers");
+
 
 	/*
 	 * Source, target and distortion images.
 	 */
 
-	update_compute_layer_descriptor_set( //
-	    vk,                              //
-	    r->compute.src_binding,          //
-	    src_samplers,                    //
-	    src_image_views,                 //
-	    num_srcs,                        //
-	    r->compute.target_binding,       //
-	    target_image_view,               //
-	    r->compute.ubo_binding,          //
-	    ubo,                             //
-	    VK_WHOLE_SIZE,                   //
-	    descriptor_set);                 //
-
-	VkPipeline pipeline = do_timewarp ? r->compute.layer.timewarp_pipeline : r->compute.layer.non_timewarp_pipeline;
+	VkDescriptorSet descriptor_set = get_layer_descriptor_set( //
+	    render,                                                //
+	    src_samplers,                                          //
+	    src_image_views,                                       //
+	    num_srcs,                                              //
+	    target_image_view,                                     //
+	    ubo);                                                  //
+
+	VkPipeline pipeline;
+	if (projection_only) {
+		pipeline = do_timewarp ? r->compute.layer.projection_timewarp_pipeline //
+		                       : r->compute.layer.projection_pipeline;
+	} else {
+		pipeline = do_timewarp ? r->compute.layer.timewarp_pipeline //
+		                       : r->compute.layer.non_timewarp_pipeline;
+	}
 	vk->vkCmdBindPipeline(              //
-	    render->r->cmd,                 //
+	    render->frame->cmd,             //
 	    VK_PIPELINE_BIND_POINT_COMPUTE, // pipelineBindPoint
 	    pipeline);                      // pipeline
 
 	vk->vkCmdBindDescriptorSets(          //
-	    r->cmd,                           //
+	    render->frame->cmd,               //
 	    VK_PIPELINE_BIND_POINT_COMPUTE,   // pipelineBindPoint
 	    r->compute.layer.pipeline_layout, // layout
 	    0,                                // firstSet
@@ -439,15 +577,24 @@ render_compute_layers(struct render_compute *render,
 	    NULL);                            // pDynamicOffsets
 
 
+	// Each invocation covers a 2x2 block of pixels.
+	struct render_viewport_data dispatch_view = *view;
+	if (foveated) {
+		dispatch_view.w = (view->w + 1) / 2;
+		dispatch_view.h = (view->h + 1) / 2;
+	}
+
 	uint32_t w = 0, h = 0;
-	calc_dispatch_dims_1_view(*view, &w, &h);
+	calc_dispatch_dims_1_view(dispatch_view, &w, &h);
 	assert(w != 0 && h != 0);
 
-	vk->vkCmdDispatch( //
-	    r->cmd,        //
-	    w,             // groupCountX
-	    h,             // groupCountY
-	    1);            // groupCountZ
+	vk->vkCmdDispatch(      //
+	    render->frame->cmd, //
+	    w,                  // groupCountX
+	    h,                  // groupCountY
+	    1);                 // groupCountZ
+
+	vk_gpu_profiler_end_scope(vk, &r->profiler, render->frame->cmd, scope);
 }
 
 void
@@ -458,6 +605,7 @@ render_compute_projection_timewarp(struct render_compute *render,
                                    const struct xrt_pose src_poses[XRT_MAX_VIEWS],
                                    const struct xrt_fov src_fovs[XRT_MAX_VIEWS],
                                    const struct xrt_pose new_poses[XRT_MAX_VIEWS],
+                                   const struct render_compute_distortion_quads *quads,
                                    VkImage target_image,
                                    VkImageView target_image_view,
                                    const struct render_viewport_data views[XRT_MAX_VIEWS])
@@ -467,6 +615,8 @@ render_compute_projection_timewarp(struct render_compute *render,
 	struct vk_bundle *vk = vk_from_render(render);
 	struct render_resources *r = render->r;
 
+	uint32_t scope = vk_gpu_profiler_begin_scope(vk, &r->profiler, render->frame->cmd, "cs distortion timewarp");
+
 
 	/*
 	 * UBO
@@ -482,14 +632,20 @@ render_compute_projection_timewarp(struct render_compute *render,
 	}
 
 	struct render_compute_distortion_ubo_data *data =
-	    (struct render_compute_distortion_ubo_data *)r->compute.distortion.ubo.mapped;
+	    (struct render_compute_distortion_ubo_data *)render->frame->compute_distortion_ubo.mapped;
 	for (uint32_t i = 0; i < render->r->view_count; ++i) {
 		data->views[i] = views[i];
 		data->pre_transforms[i] = r->distortion.uv_to_tanangle[i];
 		data->transforms[i] = time_warp_matrix[i];
 		data->post_transforms[i] = src_norm_rects[i];
+		data->distortion_ranges[i] = r->distortion.ranges[i];
+		memcpy(data->hidden_tiles[i], r->distortion.hidden_tiles[i], sizeof(data->hidden_tiles[i]));
 	}
 
+	VkSampler quad_samplers[RENDER_DISTORTION_MAX_QUADS];
+	VkImageView quad_image_views[RENDER_DISTORTION_MAX_QUADS];
+	setup_distortion_quads(r, quads, data, quad_samplers, quad_image_views);
+
 	/*
 	 * Source, target and distortion images.
 	 */
@@ -504,7 +660,7 @@ render_compute_projection_timewarp(struct render_compute *render,
 
 	vk_cmd_image_barrier_gpu_locked( //
 	    vk,                          //
-	    r->cmd,                      //
+	    render->frame->cmd,          //
 	    target_image,                //
 	    0,                           //
 	    VK_ACCESS_SHADER_WRITE_BIT,  //
@@ -520,29 +676,36 @@ render_compute_projection_timewarp(struct render_compute *render,
 		distortion_samplers[3 * i + 2] = sampler;
 	}
 
-	update_compute_shared_descriptor_set( //
-	    vk,                               //
-	    r->compute.src_binding,           //
-	    src_samplers,                     //
-	    src_image_views,                  //
-	    r->compute.distortion_binding,    //
-	    distortion_samplers,              //
-	    r->distortion.image_views,        //
-	    r->compute.target_binding,        //
-	    target_image_view,                //
-	    r->compute.ubo_binding,           //
-	    r->compute.distortion.ubo.buffer, //
-	    VK_WHOLE_SIZE,                    //
-	    render->shared_descriptor_set,    //
-	    render->r->view_count);           //
-
-	vk->vkCmdBindPipeline(                        //
-	    r->cmd,                                   //
-	    VK_PIPELINE_BIND_POINT_COMPUTE,           // pipelineBindPoint
-	    r->compute.distortion.timewarp_pipeline); // pipeline
+	update_compute_shared_descriptor_set(             //
+	    vk,                                           //
+	    r->compute.src_binding,                       //
+	    src_samplers,                                 //
+	    src_image_views,                              //
+	    r->compute.distortion_binding,                //
+	    distortion_samplers,                          //
+	    r->distortion.image_views,                    //
+	    r->compute.target_binding,                    //
+	    target_image_view,                            //
+	    r->compute.ubo_binding,                       //
+	    render->frame->compute_distortion_ubo.buffer, //
+	    VK_WHOLE_SIZE,                                //
+	    r->compute.quad_binding,                      //
+	    quad_samplers,                                //
+	    quad_image_views,                             //
+	    render->shared_descriptor_set,                //
+	    render->r->view_count);                       //
+
+	// Only pay for the quads when there are any.
+	VkPipeline pipeline = data->quad_count.value > 0 ? r->compute.distortion.quads_timewarp_pipeline //
+	                                                 : r->compute.distortion.timewarp_pipeline;
+
+	vk->vkCmdBindPipeline(              //
+	    render->frame->cmd,             //
+	    VK_PIPELINE_BIND_POINT_COMPUTE, // pipelineBindPoint
+	    pipeline);                      // pipeline
 
 	vk->vkCmdBindDescriptorSets(               //
-	    r->cmd,                                //
+	    render->frame->cmd,                    //
 	    VK_PIPELINE_BIND_POINT_COMPUTE,        // pipelineBindPoint
 	    r->compute.distortion.pipeline_layout, // layout
 	    0,                                     // firstSet
@@ -556,11 +719,11 @@ render_compute_projection_timewarp(struct render_compute *render,
 	calc_dispatch_dims_views(views, render->r->view_count, &w, &h);
 	assert(w != 0 && h != 0);
 
-	vk->vkCmdDispatch( //
-	    r->cmd,        //
-	    w,             // groupCountX
-	    h,             // groupCountY
-	    2);            // groupCountZ
+	vk->vkCmdDispatch(      //
+	    render->frame->cmd, //
+	    w,                  // groupCountX
+	    h,                  // groupCountY
+	    2);                 // groupCountZ
 
 	VkImageMemoryBarrier memoryBarrier = {
 	    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
@@ -575,7 +738,7 @@ render_compute_projection_timewarp(struct render_compute *render,
 	};
 
 	vk->vkCmdPipelineBarrier(                 //
-	    r->cmd,                               //
+	    render->frame->cmd,                   //
 	    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, //
 	    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,    //
 	    0,                                    //
@@ -585,6 +748,8 @@ render_compute_projection_timewarp(struct render_compute *render,
 	    NULL,                                 //
 	    1,                                    //
 	    &memoryBarrier);                      //
+
+	vk_gpu_profiler_end_scope(vk, &r->profiler, render->frame->cmd, scope);
 }
 
 void
@@ -592,6 +757,7 @@ render_compute_projection(struct render_compute *render,
                           VkSampler src_samplers[XRT_MAX_VIEWS],
                           VkImageView src_image_views[XRT_MAX_VIEWS],
                           const struct xrt_normalized_rect src_norm_rects[XRT_MAX_VIEWS],
+                          const struct render_compute_distortion_quads *quads,
                           VkImage target_image,
                           VkImageView target_image_view,
                           const struct render_viewport_data views[XRT_MAX_VIEWS])
@@ -601,18 +767,27 @@ render_compute_projection(struct render_compute *render,
 	struct vk_bundle *vk = vk_from_render(render);
 	struct render_resources *r = render->r;
 
+	uint32_t scope = vk_gpu_profiler_begin_scope(vk, &r->profiler, render->frame->cmd, "cs distortion");
+
 
 	/*
 	 * UBO
 	 */
 
 	struct render_compute_distortion_ubo_data *data =
-	    (struct render_compute_distortion_ubo_data *)r->compute.distortion.ubo.mapped;
+	    (struct render_compute_distortion_ubo_data *)render->frame->compute_distortion_ubo.mapped;
 	for (uint32_t i = 0; i < render->r->view_count; ++i) {
 		data->views[i] = views[i];
+		data->pre_transforms[i] = r->distortion.uv_to_tanangle[i];
 		data->post_transforms[i] = src_norm_rects[i];
+		data->distortion_ranges[i] = r->distortion.ranges[i];
+		memcpy(data->hidden_tiles[i], r->distortion.hidden_tiles[i], sizeof(data->hidden_tiles[i]));
 	}
 
+	VkSampler quad_samplers[RENDER_DISTORTION_MAX_QUADS];
+	VkImageView quad_image_views[RENDER_DISTORTION_MAX_QUADS];
+	setup_distortion_quads(r, quads, data, quad_samplers, quad_image_views);
+
 
 	/*
 	 * Source, target and distortion images.
@@ -628,7 +803,7 @@ render_compute_projection(struct render_compute *render,
 
 	vk_cmd_image_barrier_gpu_locked( //
 	    vk,                          //
-	    r->cmd,                      //
+	    render->frame->cmd,          //
 	    target_image,                //
 	    0,                           //
 	    VK_ACCESS_SHADER_WRITE_BIT,  //
@@ -644,29 +819,36 @@ render_compute_projection(struct render_compute *render,
 		distortion_samplers[3 * i + 2] = sampler;
 	}
 
-	update_compute_shared_descriptor_set( //
-	    vk,                               //
-	    r->compute.src_binding,           //
-	    src_samplers,                     //
-	    src_image_views,                  //
-	    r->compute.distortion_binding,    //
-	    distortion_samplers,              //
-	    r->distortion.image_views,        //
-	    r->compute.target_binding,        //
-	    target_image_view,                //
-	    r->compute.ubo_binding,           //
-	    r->compute.distortion.ubo.buffer, //
-	    VK_WHOLE_SIZE,                    //
-	    render->shared_descriptor_set,    //
-	    render->r->view_count);           //
-
-	vk->vkCmdBindPipeline(               //
-	    r->cmd,                          //
-	    VK_PIPELINE_BIND_POINT_COMPUTE,  // pipelineBindPoint
-	    r->compute.distortion.pipeline); // pipeline
+	update_compute_shared_descriptor_set(             //
+	    vk,                                           //
+	    r->compute.src_binding,                       //
+	    src_samplers,                                 //
+	    src_image_views,                              //
+	    r->compute.distortion_binding,                //
+	    distortion_samplers,                          //
+	    r->distortion.image_views,                    //
+	    r->compute.target_binding,                    //
+	    target_image_view,                            //
+	    r->compute.ubo_binding,                       //
+	    render->frame->compute_distortion_ubo.buffer, //
+	    VK_WHOLE_SIZE,                                //
+	    r->compute.quad_binding,                      //
+	    quad_samplers,                                //
+	    quad_image_views,                             //
+	    render->shared_descriptor_set,                //
+	    render->r->view_count);                       //
+
+	// Only pay for the quads when there are any.
+	VkPipeline pipeline = data->quad_count.value > 0 ? r->compute.distortion.quads_pipeline //
+	                                                 : r->compute.distortion.pipeline;
+
+	vk->vkCmdBindPipeline(              //
+	    render->frame->cmd,             //
+	    VK_PIPELINE_BIND_POINT_COMPUTE, // pipelineBindPoint
+	    pipeline);                      // pipeline
 
 	vk->vkCmdBindDescriptorSets(               //
-	    r->cmd,                                //
+	    render->frame->cmd,                    //
 	    VK_PIPELINE_BIND_POINT_COMPUTE,        // pipelineBindPoint
 	    r->compute.distortion.pipeline_layout, // layout
 	    0,                                     // firstSet
@@ -680,11 +862,11 @@ render_compute_projection(struct render_compute *render,
 	calc_dispatch_dims_views(views, render->r->view_count, &w, &h);
 	assert(w != 0 && h != 0);
 
-	vk->vkCmdDispatch( //
-	    r->cmd,        //
-	    w,             // groupCountX
-	    h,             // groupCountY
-	    2);            // groupCountZ
+	vk->vkCmdDispatch(      //
+	    render->frame->cmd, //
+	    w,                  // groupCountX
+	    h,                  // groupCountY
+	    2);                 // groupCountZ
 
 	VkImageMemoryBarrier memoryBarrier = {
 	    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
@@ -699,7 +881,7 @@ render_compute_projection(struct render_compute *render,
 	};
 
 	vk->vkCmdPipelineBarrier(                 //
-	    r->cmd,                               //
+	    render->frame->cmd,                   //
 	    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, //
 	    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,    //
 	    0,                                    //
@@ -709,6 +891,8 @@ render_compute_projection(struct render_compute *render,
 	    NULL,                                 //
 	    1,                                    //
 	    &memoryBarrier);                      //
+
+	vk_gpu_profiler_end_scope(vk, &r->profiler, render->frame->cmd, scope);
 }
 
 void
@@ -722,6 +906,8 @@ render_compute_clear(struct render_compute *render,
 	struct vk_bundle *vk = vk_from_render(render);
 	struct render_resources *r = render->r;
 
+	uint32_t scope = vk_gpu_profiler_begin_scope(vk, &r->profiler, render->frame->cmd, "cs clear");
+
 
 	/*
 	 * UBO
@@ -734,7 +920,7 @@ render_compute_clear(struct render_compute *render,
 	}
 
 	struct render_compute_distortion_ubo_data *data =
-	    (struct render_compute_distortion_ubo_data *)r->compute.clear.ubo.mapped;
+	    (struct render_compute_distortion_ubo_data *)render->frame->compute_clear_ubo.mapped;
 	for (uint32_t i = 0; i < render->r->view_count; ++i) {
 		data->views[i] = views[i];
 	}
@@ -753,7 +939,7 @@ render_compute_clear(struct render_compute *render,
 
 	vk_cmd_image_barrier_gpu_locked( //
 	    vk,                          //
-	    r->cmd,                      //
+	    render->frame->cmd,          //
 	    target_image,                //
 	    0,                           //
 	    VK_ACCESS_SHADER_WRITE_BIT,  //
@@ -773,29 +959,36 @@ render_compute_clear(struct render_compute *render,
 		distortion_samplers[3 * i + 2] = sampler;
 	}
 
-	update_compute_shared_descriptor_set( //
-	    vk,                               //
-	    r->compute.src_binding,           //
-	    src_samplers,                     //
-	    src_image_views,                  //
-	    r->compute.distortion_binding,    //
-	    distortion_samplers,              //
-	    r->distortion.image_views,        //
-	    r->compute.target_binding,        //
-	    target_image_view,                //
-	    r->compute.ubo_binding,           //
-	    r->compute.clear.ubo.buffer,      //
-	    VK_WHOLE_SIZE,                    // ubo_size
-	    render->shared_descriptor_set,    // descriptor_set
-	    render->r->view_count);           //
+	VkSampler quad_samplers[RENDER_DISTORTION_MAX_QUADS];
+	VkImageView quad_image_views[RENDER_DISTORTION_MAX_QUADS];
+	setup_distortion_quads(r, NULL, data, quad_samplers, quad_image_views);
+
+	update_compute_shared_descriptor_set(        //
+	    vk,                                      //
+	    r->compute.src_binding,                  //
+	    src_samplers,                            //
+	    src_image_views,                         //
+	    r->compute.distortion_binding,           //
+	    distortion_samplers,                     //
+	    r->distortion.image_views,               //
+	    r->compute.target_binding,               //
+	    target_image_view,                       //
+	    r->compute.ubo_binding,                  //
+	    render->frame->compute_clear_ubo.buffer, //
+	    VK_WHOLE_SIZE,                           // ubo_size
+	    r->compute.quad_binding,                 // quad_binding
+	    quad_samplers,                           // quad_samplers
+	    quad_image_views,                        // quad_image_views
+	    render->shared_descriptor_set,           // descriptor_set
+	    render->r->view_count);                  //
 
 	vk->vkCmdBindPipeline(              //
-	    r->cmd,                         //
+	    render->frame->cmd,             //
 	    VK_PIPELINE_BIND_POINT_COMPUTE, // pipelineBindPoint
 	    r->compute.clear.pipeline);     // pipeline
 
 	vk->vkCmdBindDescriptorSets(               //
-	    r->cmd,                                //
+	    render->frame->cmd,                    //
 	    VK_PIPELINE_BIND_POINT_COMPUTE,        // pipelineBindPoint
 	    r->compute.distortion.pipeline_layout, // layout
 	    0,                                     // firstSet
@@ -809,11 +1002,11 @@ render_compute_clear(struct render_compute *render,
 	calc_dispatch_dims_views(views, render->r->view_count, &w, &h);
 	assert(w != 0 && h != 0);
 
-	vk->vkCmdDispatch( //
-	    r->cmd,        //
-	    w,             // groupCountX
-	    h,             // groupCountY
-	    2);            // groupCountZ
+	vk->vkCmdDispatch(      //
+	    render->frame->cmd, //
+	    w,                  // groupCountX
+	    h,                  // groupCountY
+	    2);                 // groupCountZ
 
 	VkImageMemoryBarrier memoryBarrier = {
 	    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
@@ -828,7 +1021,7 @@ render_compute_clear(struct render_compute *render,
 	};
 
 	vk->vkCmdPipelineBarrier(                 //
-	    r->cmd,                               //
+	    render->frame->cmd,                   //
 	    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, //
 	    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,    //
 	    0,                                    //
@@ -838,4 +1031,6 @@ render_compute_clear(struct render_compute *render,
 	    NULL,                                 //
 	    1,                                    //
 	    &memoryBarrier);                      //
+
+	vk_gpu_profiler_end_scope(vk, &r->profiler, render->frame->cmd, scope);
 }
@@ -10,9 +10,14 @@
 #include "xrt/xrt_device.h"
 
 #include "math/m_api.h"
+#include "math/m_mathinclude.h"
 #include "math/m_matrix_2x2.h"
 #include "math/m_vec2.h"
 
+#include "util/u_misc.h"
+#include "util/u_logging.h"
+#include "util/u_distortion_cache.h"
+
 #include "vk/vk_mini_helpers.h"
 
 #include "render/render_interface.h"
@@ -27,11 +32,11 @@
 XRT_CHECK_RESULT static VkResult
 create_distortion_image_and_view(struct vk_bundle *vk,
                                  VkExtent2D extent,
+                                 VkFormat format,
                                  VkDeviceMemory *out_device_memory,
                                  VkImage *out_image,
                                  VkImageView *out_image_view)
 {
-	VkFormat format = VK_FORMAT_R32G32_SFLOAT;
 	VkImage image = VK_NULL_HANDLE;
 	VkDeviceMemory device_memory = VK_NULL_HANDLE;
 	VkImageView image_view = VK_NULL_HANDLE;
@@ -83,8 +88,13 @@ err_free:
 }
 
 static void
-queue_upload_for_first_level_and_layer_locked(
-    struct vk_bundle *vk, VkCommandBuffer cmd, VkBuffer src, VkImage dst, VkExtent2D extent)
+image_barriers(VkImage images[RENDER_DISTORTION_IMAGES_SIZE],
+               uint32_t image_count,
+               VkAccessFlags src_access_mask,
+               VkAccessFlags dst_access_mask,
+               VkImageLayout old_layout,
+               VkImageLayout new_layout,
+               VkImageMemoryBarrier out_barriers[RENDER_DISTORTION_IMAGES_SIZE])
 {
 	VkImageSubresourceRange subresource_range = {
 	    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
@@ -94,15 +104,56 @@ queue_upload_for_first_level_and_layer_locked(
 	    .layerCount = VK_REMAINING_ARRAY_LAYERS,
 	};
 
-	vk_cmd_image_barrier_gpu_locked(          //
-	    vk,                                   //
-	    cmd,                                  //
-	    dst,                                  //
-	    0,                                    //
-	    VK_ACCESS_TRANSFER_WRITE_BIT,         //
-	    VK_IMAGE_LAYOUT_UNDEFINED,            //
-	    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, //
-	    subresource_range);                   //
+	for (uint32_t i = 0; i < image_count; i++) {
+		out_barriers[i] = (VkImageMemoryBarrier){
+		    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+		    .srcAccessMask = src_access_mask,
+		    .dstAccessMask = dst_access_mask,
+		    .oldLayout = old_layout,
+		    .newLayout = new_layout,
+		    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		    .image = images[i],
+		    .subresourceRange = subresource_range,
+		};
+	}
+}
+
+/*!
+ * Uploads all of the images from one staging buffer, where they are tightly
+ * packed one after the other, with a single barrier before and after.
+ */
+static void
+queue_upload_all_locked(struct vk_bundle *vk,
+                        VkCommandBuffer cmd,
+                        VkBuffer src,
+                        VkDeviceSize image_size,
+                        VkImage images[RENDER_DISTORTION_IMAGES_SIZE],
+                        uint32_t image_count,
+                        VkExtent2D extent)
+{
+	VkImageMemoryBarrier barriers[RENDER_DISTORTION_IMAGES_SIZE];
+
+	image_barriers(                           //
+	    images,                               // images
+	    image_count,                          // image_count
+	    0,                                    // src_access_mask
+	    VK_ACCESS_TRANSFER_WRITE_BIT,         // dst_access_mask
+	    VK_IMAGE_LAYOUT_UNDEFINED,            // old_layout
+	    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // new_layout
+	    barriers);                            // out_barriers
+
+	vk->vkCmdPipelineBarrier(              //
+	    cmd,                               // commandBuffer
+	    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, // srcStageMask
+	    VK_PIPELINE_STAGE_TRANSFER_BIT,    // dstStageMask
+	    0,                                 // dependencyFlags
+	    0,                                 // memoryBarrierCount
+	    NULL,                              // pMemoryBarriers
+	    0,                                 // bufferMemoryBarrierCount
+	    NULL,                              // pBufferMemoryBarriers
+	    image_count,                       // imageMemoryBarrierCount
+	    barriers);                         // pImageMemoryBarriers
 
 	VkImageSubresourceLayers subresource_layers = {
 	    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
@@ -111,71 +162,58 @@ queue_upload_for_first_level_and_layer_locked(
 	    .layerCount = 1,
 	};
 
-	VkBufferImageCopy region = {
-	    .bufferOffset = 0,
-	    .bufferRowLength = 0,
-	    .bufferImageHeight = 0,
-	    .imageSubresource = subresource_layers,
-	    .imageOffset = {0, 0, 0},
-	    .imageExtent = {extent.width, extent.height, 1},
-	};
+	for (uint32_t i = 0; i < image_count; i++) {
+		VkBufferImageCopy region = {
+		    .bufferOffset = i * image_size,
+		    .bufferRowLength = 0,
+		    .bufferImageHeight = 0,
+		    .imageSubresource = subresource_layers,
+		    .imageOffset = {0, 0, 0},
+		    .imageExtent = {extent.width, extent.height, 1},
+		};
+
+		vk->vkCmdCopyBufferToImage(               //
+		    cmd,                                  // commandBuffer
+		    src,                                  // srcBuffer
+		    images[i],                            // dstImage
+		    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // dstImageLayout
+		    1,                                    // regionCount
+		    &region);                             // pRegions
+	}
 
-	vk->vkCmdCopyBufferToImage(               //
-	    cmd,                                  // commandBuffer
-	    src,                                  // srcBuffer
-	    dst,                                  // dstImage
-	    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // dstImageLayout
-	    1,                                    // regionCount
-	    &region);                             // pRegions
-
-	vk_cmd_image_barrier_gpu_locked(              //
-	    vk,                                       //
-	    cmd,                                      //
-	    dst,                                      //
-	    VK_ACCESS_TRANSFER_WRITE_BIT,             //
-	    VK_ACCESS_SHADER_READ_BIT,                //
-	    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,     //
-	    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, //
-	    subresource_range);                       //
+	image_barriers(                               //
+	    images,                                   // images
+	    image_count,                              // image_count
+	    VK_ACCESS_TRANSFER_WRITE_BIT,             // src_access_mask
+	    VK_ACCESS_SHADER_READ_BIT,                // dst_access_mask
+	    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,     // old_layout
+	    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, // new_layout
+	    barriers);                                // out_barriers
+
+	vk->vkCmdPipelineBarrier(               //
+	    cmd,                                // commandBuffer
+	    VK_PIPELINE_STAGE_TRANSFER_BIT,     // srcStageMask
+	    VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, // dstStageMask
+	    0,                                  // dependencyFlags
+	    0,                                  // memoryBarrierCount
+	    NULL,                               // pMemoryBarriers
+	    0,                                  // bufferMemoryBarrierCount
+	    NULL,                               // pBufferMemoryBarriers
+	    image_count,                        // imageMemoryBarrierCount
+	    barriers);                          // pImageMemoryBarriers
 }
 
-XRT_CHECK_RESULT static VkResult
-create_and_queue_upload_locked(struct vk_bundle *vk,
-                               struct vk_cmd_pool *pool,
-                               VkCommandBuffer cmd,
-                               VkBuffer src_buffer,
-                               VkDeviceMemory *out_image_device_memory,
-                               VkImage *out_image,
-                               VkImageView *out_image_view)
+static bool
+is_format_supported(struct vk_bundle *vk, VkFormat format)
 {
-	VkExtent2D extent = {RENDER_DISTORTION_IMAGE_DIMENSIONS, RENDER_DISTORTION_IMAGE_DIMENSIONS};
-	VkDeviceMemory device_memory = VK_NULL_HANDLE;
-	VkImage image = VK_NULL_HANDLE;
-	VkImageView image_view = VK_NULL_HANDLE;
-	VkResult ret;
+	VkFormatProperties prop;
+	vk->vkGetPhysicalDeviceFormatProperties(vk->physical_device, format, &prop);
 
-	ret = create_distortion_image_and_view( //
-	    vk,                                 // vk_bundle
-	    extent,                             // extent
-	    &device_memory,                     // out_device_memory
-	    &image,                             // out_image
-	    &image_view);                       // out_image_view
-	VK_CHK_AND_RET(ret, "create_distortion_image_and_view");
-
-	queue_upload_for_first_level_and_layer_locked( //
-	    vk,                                        // vk_bundle
-	    cmd,                                       // cmd
-	    src_buffer,                                // src
-	    image,                                     // dst
-	    extent);                                   // extent
-
-	*out_image_device_memory = device_memory;
-	*out_image = image;
-	*out_image_view = image_view;
+	VkFormatFeatureFlags needed = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | //
+	                              VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
 
-	return VK_SUCCESS;
+	return (prop.optimalTilingFeatures & needed) == needed;
 }
-
 /*!
  * Helper struct to make code easier to read.
  */
@@ -184,25 +222,192 @@ struct texture
 	struct xrt_vec2 pixels[RENDER_DISTORTION_IMAGE_DIMENSIONS][RENDER_DISTORTION_IMAGE_DIMENSIONS];
 };
 
+/*!
+ * The 16 bit version of @ref texture, stored with a per view scale and bias.
+ */
+struct texture_unorm16
+{
+	uint16_t pixels[RENDER_DISTORTION_IMAGE_DIMENSIONS][RENDER_DISTORTION_IMAGE_DIMENSIONS][2];
+};
+
 struct tan_angles_transforms
 {
 	struct xrt_vec2 offset;
 	struct xrt_vec2 scale;
 };
 
-XRT_CHECK_RESULT static VkResult
-create_and_fill_in_distortion_buffer_for_view(struct vk_bundle *vk,
-                                              struct xrt_device *xdev,
-                                              struct render_buffer *r_buffer,
-                                              struct render_buffer *g_buffer,
-                                              struct render_buffer *b_buffer,
-                                              uint32_t view,
-                                              bool pre_rotate)
+/*!
+ * How far outside of the source, in UV, a sample needs to be before it is
+ * treated as hidden, leaves room for timewarp pulling in content from outside.
+ */
+#define HIDDEN_SOURCE_MARGIN_UV (0.1f)
+
+/*!
+ * Largest error in UV the 16 bit images may have compared to the float ones,
+ * about a fifth of a pixel on a 2k wide source.
+ */
+#define UNORM16_MAX_ERROR_UV (0.0001f)
+
+static float
+edge_function(const struct xrt_vec2 *a, const struct xrt_vec2 *b, const struct xrt_vec2 *p)
 {
-	VkBufferUsageFlags usage_flags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-	VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
-	VkResult ret;
+	return (b->x - a->x) * (p->y - a->y) - (b->y - a->y) * (p->x - a->x);
+}
+
+static bool
+is_point_in_triangle(const struct xrt_vec2 *p,
+                     const struct xrt_vec2 *a,
+                     const struct xrt_vec2 *b,
+                     const struct xrt_vec2 *c)
+{
+	float e0 = edge_function(a, b, p);
+	float e1 = edge_function(b, c, p);
+	float e2 = edge_function(c, a, p);
+
+	bool has_neg = e0 < 0.0f || e1 < 0.0f || e2 < 0.0f;
+	bool has_pos = e0 > 0.0f || e1 > 0.0f || e2 > 0.0f;
+
+	// Works for both windings.
+	return !(has_neg && has_pos);
+}
+
+static bool
+is_source_uv_hidden(const struct xrt_visibility_mask *mask,
+                    const struct xrt_normalized_rect *uv_to_tanangle,
+                    const struct xrt_vec2 *uv)
+{
+	const float min = -HIDDEN_SOURCE_MARGIN_UV;
+	const float max = 1.0f + HIDDEN_SOURCE_MARGIN_UV;
+
+	// The sampler clamps to black border so these are never seen.
+	if (uv->x < min || uv->x > max || uv->y < min || uv->y > max) {
+		return true;
+	}
+
+	if (mask == NULL) {
+		return false;
+	}
+
+	// Same space as the mask vertices.
+	struct xrt_vec2 p = {
+	    uv->x * uv_to_tanangle->w + uv_to_tanangle->x,
+	    uv->y * uv_to_tanangle->h + uv_to_tanangle->y,
+	};
+
+	const uint32_t *indices = xrt_visibility_mask_get_indices(mask);
+	const struct xrt_vec2 *vertices = xrt_visibility_mask_get_vertices(mask);
+
+	for (uint32_t i = 0; i + 2 < mask->index_count; i += 3) {
+		if (is_point_in_triangle(&p, &vertices[indices[i]], &vertices[indices[i + 1]],
+		                         &vertices[indices[i + 2]])) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool
+is_texel_hidden(const struct xrt_visibility_mask *mask,
+                const struct xrt_normalized_rect *uv_to_tanangle,
+                const struct texture *r,
+                const struct texture *g,
+                const struct texture *b,
+                int row,
+                int col)
+{
+	return is_source_uv_hidden(mask, uv_to_tanangle, &r->pixels[row][col]) &&
+	       is_source_uv_hidden(mask, uv_to_tanangle, &g->pixels[row][col]) &&
+	       is_source_uv_hidden(mask, uv_to_tanangle, &b->pixels[row][col]);
+}
+
+static int
+clamp_texel(int value)
+{
+	if (value < 0) {
+		return 0;
+	}
+	if (value >= RENDER_DISTORTION_IMAGE_DIMENSIONS) {
+		return RENDER_DISTORTION_IMAGE_DIMENSIONS - 1;
+	}
+	return value;
+}
+
+/*!
+ * A tile is hidden if every texel that the shader can sample for the pixels in
+ * it, plus a one texel margin for filtering, only maps to hidden parts of the
+ * source. Tiles are in the same space as the distortion images, so this works
+ * the same for pre-rotated images.
+ */
+static void
+calc_hidden_tiles(struct xrt_device *xdev,
+                  uint32_t view,
+                  const struct xrt_normalized_rect *uv_to_tanangle,
+                  const struct texture *r,
+                  const struct texture *g,
+                  const struct texture *b,
+                  uint32_t out_hidden_tiles[RENDER_DISTORTION_TILE_WORDS])
+{
+	for (uint32_t i = 0; i < RENDER_DISTORTION_TILE_WORDS; i++) {
+		out_hidden_tiles[i] = 0;
+	}
+
+	struct xrt_visibility_mask *mask = NULL;
+	xrt_result_t xret = xrt_device_get_visibility_mask( //
+	    xdev,                                           // xdev
+	    XRT_VISIBILITY_MASK_TYPE_HIDDEN_TRIANGLE_MESH,  // type
+	    view,                                           // view_index
+	    &mask);                                         // out_mask
+
+	// No mask is fine, still skip the parts that are outside of the source.
+	if (xret != XRT_SUCCESS) {
+		mask = NULL;
+	}
+
+	const double dim_minus_one_f64 = RENDER_DISTORTION_IMAGE_DIMENSIONS - 1;
+	const double texels_per_tile = dim_minus_one_f64 / RENDER_DISTORTION_TILE_DIMENSIONS;
+	uint32_t hidden_count = 0;
+
+	for (uint32_t ty = 0; ty < RENDER_DISTORTION_TILE_DIMENSIONS; ty++) {
+		int row_start = clamp_texel((int)floor(ty * texels_per_tile) - 1);
+		int row_end = clamp_texel((int)ceil((ty + 1) * texels_per_tile) + 1);
+
+		for (uint32_t tx = 0; tx < RENDER_DISTORTION_TILE_DIMENSIONS; tx++) {
+			int col_start = clamp_texel((int)floor(tx * texels_per_tile) - 1);
+			int col_end = clamp_texel((int)ceil((tx + 1) * texels_per_tile) + 1);
+
+			bool hidden = true;
+			for (int row = row_start; row <= row_end && hidden; row++) {
+				for (int col = col_start; col <= col_end && hidden; col++) {
+					hidden = is_texel_hidden(mask, uv_to_tanangle, r, g, b, row, col);
+				}
+			}
+
+			if (!hidden) {
+				continue;
+			}
+
+			uint32_t bit = ty * RENDER_DISTORTION_TILE_DIMENSIONS + tx;
+			out_hidden_tiles[bit / 32] |= 1u << (bit % 32);
+			hidden_count++;
+		}
+	}
+
+	free(mask);
+
+	U_LOG_D("View %u: %u of %u distortion tiles hidden", view, hidden_count,
+	        RENDER_DISTORTION_TILE_DIMENSIONS * RENDER_DISTORTION_TILE_DIMENSIONS);
+}
+
 
+XRT_CHECK_RESULT static VkResult
+calc_distortion_for_view(struct xrt_device *xdev,
+                         uint32_t view,
+                         bool pre_rotate,
+                         struct texture *r,
+                         struct texture *g,
+                         struct texture *b)
+{
 	struct xrt_matrix_2x2 rot = xdev->hmd->views[view].rot;
 
 	const struct xrt_matrix_2x2 rotation_90_cw = {{
@@ -217,28 +422,19 @@ create_and_fill_in_distortion_buffer_for_view(struct vk_bundle *vk,
 		m_mat2x2_multiply(&rot, &rotation_90_cw, &rot);
 	}
 
-	VkDeviceSize size = sizeof(struct texture);
-
-	ret = render_buffer_init(vk, r_buffer, usage_flags, properties, size);
-	VK_CHK_WITH_GOTO(ret, "render_buffer_init", err_buffers);
-	VK_NAME_BUFFER(vk, r_buffer->buffer, "distortion r_buffer");
-	ret = render_buffer_init(vk, g_buffer, usage_flags, properties, size);
-	VK_CHK_WITH_GOTO(ret, "render_buffer_init", err_buffers);
-	VK_NAME_BUFFER(vk, g_buffer->buffer, "distortion g_buffer");
-	ret = render_buffer_init(vk, b_buffer, usage_flags, properties, size);
-	VK_CHK_WITH_GOTO(ret, "render_buffer_init", err_buffers);
-	VK_NAME_BUFFER(vk, b_buffer->buffer, "distortion b_buffer");
-
-	ret = render_buffer_map(vk, r_buffer);
-	VK_CHK_WITH_GOTO(ret, "render_buffer_map", err_buffers);
-	ret = render_buffer_map(vk, g_buffer);
-	VK_CHK_WITH_GOTO(ret, "render_buffer_map", err_buffers);
-	ret = render_buffer_map(vk, b_buffer);
-	VK_CHK_WITH_GOTO(ret, "render_buffer_map", err_buffers);
-
-	struct texture *r = r_buffer->mapped;
-	struct texture *g = g_buffer->mapped;
-	struct texture *b = b_buffer->mapped;
+	// Sampling the device is slow on some devices, see if we have it cached.
+	uint32_t key_params[3] = {RENDER_DISTORTION_IMAGE_DIMENSIONS, view, pre_rotate ? 1u : 0u};
+	uint64_t key = 0;
+	bool have_key = u_distortion_cache_make_key(xdev, key_params, sizeof(key_params), &key);
+
+	bool loaded = have_key &&                                               //
+	              u_distortion_cache_load(key, "image_r", r, sizeof(*r)) && //
+	              u_distortion_cache_load(key, "image_g", g, sizeof(*g)) && //
+	              u_distortion_cache_load(key, "image_b", b, sizeof(*b));
+
+	if (loaded) {
+		return VK_SUCCESS;
+	}
 
 	const double dim_minus_one_f64 = RENDER_DISTORTION_IMAGE_DIMENSIONS - 1;
 
@@ -259,7 +455,7 @@ create_and_fill_in_distortion_buffer_for_view(struct vk_bundle *vk,
 			struct xrt_uv_triplet result;
 			xrt_result_t xret = xrt_device_compute_distortion(xdev, view, uv.x, uv.y, &result);
 			if (xret != XRT_SUCCESS) {
-				VK_CHK_WITH_GOTO(VK_ERROR_UNKNOWN, "xrt_device_compute_distortion", err_buffers);
+				VK_CHK_AND_RET(VK_ERROR_UNKNOWN, "xrt_device_compute_distortion");
 			}
 
 			r->pixels[row][col] = result.r;
@@ -268,16 +464,184 @@ create_and_fill_in_distortion_buffer_for_view(struct vk_bundle *vk,
 		}
 	}
 
-	render_buffer_unmap(vk, r_buffer);
-	render_buffer_unmap(vk, g_buffer);
-	render_buffer_unmap(vk, b_buffer);
+	if (have_key) {
+		u_distortion_cache_store(key, "image_r", r, sizeof(*r));
+		u_distortion_cache_store(key, "image_g", g, sizeof(*g));
+		u_distortion_cache_store(key, "image_b", b, sizeof(*b));
+	}
+
+	return VK_SUCCESS;
+}
+
+/*!
+ * The range that the 16 bit images are stored in for one view, shared by all
+ * three channels so the shader only needs one scale and bias per view.
+ */
+static bool
+calc_unorm16_range(const struct texture *r,
+                   const struct texture *g,
+                   const struct texture *b,
+                   struct xrt_normalized_rect *out_range)
+{
+	const struct texture *textures[3] = {r, g, b};
+	struct xrt_vec2 min = {INFINITY, INFINITY};
+	struct xrt_vec2 max = {-INFINITY, -INFINITY};
+
+	for (uint32_t i = 0; i < ARRAY_SIZE(textures); i++) {
+		for (int row = 0; row < RENDER_DISTORTION_IMAGE_DIMENSIONS; row++) {
+			for (int col = 0; col < RENDER_DISTORTION_IMAGE_DIMENSIONS; col++) {
+				struct xrt_vec2 p = textures[i]->pixels[row][col];
+
+				// Can't be represented, use the float images.
+				if (!isfinite(p.x) || !isfinite(p.y)) {
+					return false;
+				}
+
+				min.x = fminf(min.x, p.x);
+				min.y = fminf(min.y, p.y);
+				max.x = fmaxf(max.x, p.x);
+				max.y = fmaxf(max.y, p.y);
+			}
+		}
+	}
+
+	out_range->x = min.x;
+	out_range->y = min.y;
+	out_range->w = max.x - min.x;
+	out_range->h = max.y - min.y;
+
+	return true;
+}
+
+static uint16_t
+encode_unorm16(float value, float min, float size)
+{
+	if (size <= 0.0f) {
+		return 0;
+	}
+
+	float normalized = (value - min) / size;
+	return (uint16_t)lroundf(CLAMP(normalized, 0.0f, 1.0f) * (float)UINT16_MAX);
+}
+
+static float
+decode_unorm16(uint16_t value, float min, float size)
+{
+	return (float)value / (float)UINT16_MAX * size + min;
+}
+
+/*!
+ * Packs the texture into the 16 bit format, returns the largest error in UV
+ * compared to the float values, this is what the shader will see.
+ */
+static float
+encode_texture_unorm16(const struct texture *src,
+                       const struct xrt_normalized_rect *range,
+                       struct texture_unorm16 *dst)
+{
+	float max_error = 0.0f;
+
+	for (int row = 0; row < RENDER_DISTORTION_IMAGE_DIMENSIONS; row++) {
+		for (int col = 0; col < RENDER_DISTORTION_IMAGE_DIMENSIONS; col++) {
+			struct xrt_vec2 p = src->pixels[row][col];
+			uint16_t *out = dst->pixels[row][col];
+
+			out[0] = encode_unorm16(p.x, range->x, range->w);
+			out[1] = encode_unorm16(p.y, range->y, range->h);
+
+			float error_x = fabsf(decode_unorm16(out[0], range->x, range->w) - p.x);
+			float error_y = fabsf(decode_unorm16(out[1], range->y, range->h) - p.y);
+			max_error = fmaxf(max_error, fmaxf(error_x, error_y));
+		}
+	}
+
+	return max_error;
+}
+
+/*!
+ * Fills in the staging buffer with either the 16 bit or the float images,
+ * falling back to floats if the 16 bit ones are not accurate enough.
+ */
+XRT_CHECK_RESULT static VkResult
+create_and_fill_in_staging_buffer(struct render_resources *r,
+                                  struct vk_bundle *vk,
+                                  bool compact,
+                                  const struct texture *textures,
+                                  struct render_buffer *out_buffer,
+                                  VkFormat *out_format,
+                                  VkDeviceSize *out_image_size)
+{
+	VkBufferUsageFlags usage_flags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+	const uint32_t image_count = RENDER_DISTORTION_IMAGES_COUNT(r);
+	const uint32_t view_count = r->view_count;
+	struct texture_unorm16 *packed = NULL;
+	struct xrt_normalized_rect ranges[XRT_MAX_VIEWS];
+	VkResult ret;
+
+	bool use_unorm16 = compact && is_format_supported(vk, VK_FORMAT_R16G16_UNORM);
+	if (compact && !use_unorm16) {
+		U_LOG_I("VK_FORMAT_R16G16_UNORM not supported for distortion images, using floats");
+	}
+
+	for (uint32_t i = 0; i < view_count && use_unorm16; i++) {
+		use_unorm16 = calc_unorm16_range(  //
+		    &textures[i],                  // r
+		    &textures[view_count + i],     // g
+		    &textures[2 * view_count + i], // b
+		    &ranges[i]);                   // out_range
+	}
+
+	if (use_unorm16) {
+		packed = U_TYPED_ARRAY_CALLOC(struct texture_unorm16, image_count);
+
+		// Images are laid out the same as the textures, RRGGBB for two views.
+		float max_error = 0.0f;
+		for (uint32_t i = 0; i < image_count; i++) {
+			float error = encode_texture_unorm16(&textures[i], &ranges[i % view_count], &packed[i]);
+			max_error = fmaxf(max_error, error);
+		}
+
+		if (max_error > UNORM16_MAX_ERROR_UV) {
+			U_LOG_W("Distortion too large for 16 bit images (error %f UV), using floats", max_error);
+			use_unorm16 = false;
+		} else {
+			U_LOG_D("Distortion images packed as 16 bit, max error %f UV", max_error);
+		}
+	}
+
+	VkDeviceSize image_size = use_unorm16 ? sizeof(struct texture_unorm16) : sizeof(struct texture);
+	const void *src = use_unorm16 ? (const void *)packed : (const void *)textures;
+
+	ret = render_buffer_init(vk, out_buffer, usage_flags, properties, image_size * image_count);
+	VK_CHK_WITH_GOTO(ret, "render_buffer_init", err_free);
+	VK_NAME_BUFFER(vk, out_buffer->buffer, "distortion staging buffer");
+
+	ret = render_buffer_map(vk, out_buffer);
+	VK_CHK_WITH_GOTO(ret, "render_buffer_map", err_buffer);
+
+	memcpy(out_buffer->mapped, src, image_size * image_count);
+
+	render_buffer_unmap(vk, out_buffer);
+
+	// The shader always decodes with scale and bias, identity for floats.
+	const struct xrt_normalized_rect identity = {.x = 0.0f, .y = 0.0f, .w = 1.0f, .h = 1.0f};
+	for (uint32_t i = 0; i < view_count; i++) {
+		r->distortion.ranges[i] = use_unorm16 ? ranges[i] : identity;
+	}
+
+	free(packed);
+
+	*out_format = use_unorm16 ? VK_FORMAT_R16G16_UNORM : VK_FORMAT_R32G32_SFLOAT;
+	*out_image_size = image_size;
 
 	return VK_SUCCESS;
 
-err_buffers:
-	render_buffer_fini(vk, r_buffer);
-	render_buffer_fini(vk, g_buffer);
-	render_buffer_fini(vk, b_buffer);
+err_buffer:
+	render_buffer_fini(vk, out_buffer);
+
+err_free:
+	free(packed);
 
 	return ret;
 }
@@ -286,13 +650,18 @@ static bool
 render_distortion_buffer_init(struct render_resources *r,
                               struct vk_bundle *vk,
                               struct xrt_device *xdev,
-                              bool pre_rotate)
+                              bool pre_rotate,
+                              bool compact)
 {
-	struct render_buffer bufs[RENDER_DISTORTION_IMAGES_SIZE];
-	VkDeviceMemory device_memories[RENDER_DISTORTION_IMAGES_SIZE];
-	VkImage images[RENDER_DISTORTION_IMAGES_SIZE];
-	VkImageView image_views[RENDER_DISTORTION_IMAGES_SIZE];
+	struct render_buffer staging = {0};
+	struct texture *textures = NULL;
+	VkDeviceMemory device_memories[RENDER_DISTORTION_IMAGES_SIZE] = {0};
+	VkImage images[RENDER_DISTORTION_IMAGES_SIZE] = {0};
+	VkImageView image_views[RENDER_DISTORTION_IMAGES_SIZE] = {0};
+	VkExtent2D extent = {RENDER_DISTORTION_IMAGE_DIMENSIONS, RENDER_DISTORTION_IMAGE_DIMENSIONS};
 	VkCommandBuffer upload_buffer = VK_NULL_HANDLE;
+	VkFormat format = VK_FORMAT_UNDEFINED;
+	VkDeviceSize image_size = 0;
 	VkResult ret;
 
 
@@ -305,14 +674,47 @@ render_distortion_buffer_init(struct render_resources *r,
 	}
 
 	/*
-	 * Buffers with data to upload.
+	 * Distortion for all views.
 	 * view_count=2,RRGGBB
 	 * view_count=3,RRRGGGBBB
 	 */
-	for (uint32_t i = 0; i < r->view_count; ++i) {
-		ret = create_and_fill_in_distortion_buffer_for_view(vk, xdev, &bufs[i], &bufs[r->view_count + i],
-		                                                    &bufs[2 * r->view_count + i], i, pre_rotate);
-		VK_CHK_WITH_GOTO(ret, "create_and_fill_in_distortion_buffer_for_view", err_resources);
+	const uint32_t view_count = r->view_count;
+	textures = U_TYPED_ARRAY_CALLOC(struct texture, RENDER_DISTORTION_IMAGES_COUNT(r));
+
+	for (uint32_t i = 0; i < view_count; ++i) {
+		struct texture *tr = &textures[i];
+		struct texture *tg = &textures[view_count + i];
+		struct texture *tb = &textures[2 * view_count + i];
+
+		ret = calc_distortion_for_view(xdev, i, pre_rotate, tr, tg, tb);
+		VK_CHK_WITH_GOTO(ret, "calc_distortion_for_view", err_resources);
+
+		calc_hidden_tiles(xdev, i, &r->distortion.uv_to_tanangle[i], tr, tg, tb, r->distortion.hidden_tiles[i]);
+	}
+
+	/*
+	 * One buffer with all of the data to upload.
+	 */
+
+	ret = create_and_fill_in_staging_buffer( //
+	    r,                                   // r
+	    vk,                                  // vk
+	    compact,                             // compact
+	    textures,                            // textures
+	    &staging,                            // out_buffer
+	    &format,                             // out_format
+	    &image_size);                        // out_image_size
+	VK_CHK_WITH_GOTO(ret, "create_and_fill_in_staging_buffer", err_resources);
+
+	for (uint32_t i = 0; i < RENDER_DISTORTION_IMAGES_COUNT(r); i++) {
+		ret = create_distortion_image_and_view( //
+		    vk,                                 // vk_bundle
+		    extent,                             // extent
+		    format,                             // format
+		    &device_memories[i],                // out_device_memory
+		    &images[i],                         // out_image
+		    &image_views[i]);                   // out_image_view
+		VK_CHK_WITH_GOTO(ret, "create_distortion_image_and_view", err_resources);
 	}
 
 	/*
@@ -327,17 +729,14 @@ render_distortion_buffer_init(struct render_resources *r,
 	VK_CHK_WITH_GOTO(ret, "vk_cmd_pool_create_and_begin_cmd_buffer_locked", err_unlock);
 	VK_NAME_COMMAND_BUFFER(vk, upload_buffer, "render_resources distortion command buffer");
 
-	for (uint32_t i = 0; i < RENDER_DISTORTION_IMAGES_COUNT(r); i++) {
-		ret = create_and_queue_upload_locked( //
-		    vk,                               // vk_bundle
-		    pool,                             // pool
-		    upload_buffer,                    // cmd
-		    bufs[i].buffer,                   // src_buffer
-		    &device_memories[i],              // out_image_device_memory
-		    &images[i],                       // out_image
-		    &image_views[i]);                 // out_image_view
-		VK_CHK_WITH_GOTO(ret, "create_and_queue_upload_locked", err_cmd);
-	}
+	queue_upload_all_locked(               //
+	    vk,                                // vk_bundle
+	    upload_buffer,                     // cmd
+	    staging.buffer,                    // src
+	    image_size,                        // image_size
+	    images,                            // images
+	    RENDER_DISTORTION_IMAGES_COUNT(r), // image_count
+	    extent);                           // extent
 
 	ret = vk_cmd_pool_end_submit_wait_and_free_cmd_buffer_locked(vk, pool, upload_buffer);
 	VK_CHK_WITH_GOTO(ret, "vk_cmd_pool_end_submit_wait_and_free_cmd_buffer_locked", err_cmd);
@@ -349,6 +748,7 @@ render_distortion_buffer_init(struct render_resources *r,
 	 */
 
 	r->distortion.pre_rotated = pre_rotate;
+	r->distortion.compact = compact;
 
 	for (uint32_t i = 0; i < RENDER_DISTORTION_IMAGES_COUNT(r); i++) {
 		r->distortion.device_memories[i] = device_memories[i];
@@ -361,9 +761,8 @@ render_distortion_buffer_init(struct render_resources *r,
 	 * Tidy
 	 */
 
-	for (uint32_t i = 0; i < RENDER_DISTORTION_IMAGES_COUNT(r); i++) {
-		render_buffer_fini(vk, &bufs[i]);
-	}
+	render_buffer_fini(vk, &staging);
+	free(textures);
 
 	return true;
 
@@ -379,13 +778,13 @@ err_resources:
 		D(ImageView, image_views[i]);
 		D(Image, images[i]);
 		DF(Memory, device_memories[i]);
-		render_buffer_fini(vk, &bufs[i]);
 	}
+	render_buffer_fini(vk, &staging);
+	free(textures);
 
 	return false;
 }
 
-
 /*
  *
  * 'Exported' functions.
@@ -408,11 +807,13 @@ bool
 render_distortion_images_ensure(struct render_resources *r,
                                 struct vk_bundle *vk,
                                 struct xrt_device *xdev,
-                                bool pre_rotate)
+                                bool pre_rotate,
+                                bool compact)
 {
-	if (r->distortion.image_views[0] == VK_NULL_HANDLE || pre_rotate != r->distortion.pre_rotated) {
+	if (r->distortion.image_views[0] == VK_NULL_HANDLE || pre_rotate != r->distortion.pre_rotated ||
+	    compact != r->distortion.compact) {
 		render_distortion_images_fini(r);
-		return render_distortion_buffer_init(r, vk, xdev, pre_rotate);
+		return render_distortion_buffer_init(r, vk, xdev, pre_rotate, compact);
 	}
 
 	return true;
@@ -181,7 +181,12 @@ begin_render_pass(struct vk_bundle *vk,
 	vk->vkCmdBeginRenderPass(command_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
 }
 
-/// Update descriptor set for a layer to reference the parameter UBO and the source (layer) image.
+/*!
+ * Update descriptor set for a layer to reference the parameter UBO and the
+ * source (layer) image. If @p descriptor_set is VK_NULL_HANDLE they are instead
+ * pushed into @p cmd, for that @p pipeline_layout must use a push descriptor
+ * set layout.
+ */
 static void
 update_ubo_and_src_descriptor_set(struct vk_bundle *vk,
                                   uint32_t ubo_binding,
@@ -191,7 +196,9 @@ update_ubo_and_src_descriptor_set(struct vk_bundle *vk,
                                   uint32_t src_binding,
                                   VkSampler sampler,
                                   VkImageView image_view,
-                                  VkDescriptorSet descriptor_set)
+                                  VkDescriptorSet descriptor_set,
+                                  VkCommandBuffer cmd,
+                                  VkPipelineLayout pipeline_layout)
 {
 	VkDescriptorImageInfo image_info = {
 	    .sampler = sampler,
@@ -224,6 +231,19 @@ update_ubo_and_src_descriptor_set(struct vk_bundle *vk,
 	    },
 	};
 
+#ifdef VK_KHR_push_descriptor
+	if (descriptor_set == VK_NULL_HANDLE) {
+		vk->vkCmdPushDescriptorSetKHR(         //
+		    cmd,                               // commandBuffer
+		    VK_PIPELINE_BIND_POINT_GRAPHICS,   // pipelineBindPoint
+		    pipeline_layout,                   // layout
+		    0,                                 // set
+		    ARRAY_SIZE(write_descriptor_sets), // descriptorWriteCount
+		    write_descriptor_sets);            // pDescriptorWrites
+		return;
+	}
+#endif
+
 	vk->vkUpdateDescriptorSets(            //
 	    vk->device,                        //
 	    ARRAY_SIZE(write_descriptor_sets), // descriptorWriteCount
@@ -285,44 +305,139 @@ do_ubo_and_src_alloc_and_write(struct render_gfx *render,
 	    src_binding,                   //
 	    src_sampler,                   //
 	    src_image_view,                //
-	    descriptor_set);               //
+	    descriptor_set,                //
+	    VK_NULL_HANDLE,                // cmd
+	    VK_NULL_HANDLE);               // pipeline_layout
 
 	*out_descriptor_set = descriptor_set;
 
 	return VK_SUCCESS;
 }
 
-static inline void
-dispatch_no_vbo(struct render_gfx *render, uint32_t vertex_count, VkPipeline pipeline, VkDescriptorSet descriptor_set)
+/*!
+ * Sub-allocate a UBO for a layer and fill out @p out_descriptor. Without push
+ * descriptors this also allocates and writes a descriptor set.
+ */
+XRT_CHECK_RESULT static VkResult
+do_layer_alloc_and_write(struct render_gfx *render,
+                         const void *ubo_ptr,
+                         VkDeviceSize ubo_size,
+                         VkSampler src_sampler,
+                         VkImageView src_image_view,
+                         struct render_gfx_layer_descriptor *out_descriptor)
 {
-	struct vk_bundle *vk = vk_from_render(render);
 	struct render_resources *r = render->r;
+	struct vk_bundle *vk = vk_from_render(render);
 
+	VkResult ret;
 
-	VkDescriptorSet descriptor_sets[1] = {descriptor_set};
-	vk->vkCmdBindDescriptorSets(             //
-	    r->cmd,                              //
-	    VK_PIPELINE_BIND_POINT_GRAPHICS,     // pipelineBindPoint
-	    r->gfx.layer.shared.pipeline_layout, // layout
-	    0,                                   // firstSet
-	    ARRAY_SIZE(descriptor_sets),         // descriptorSetCount
-	    descriptor_sets,                     // pDescriptorSets
-	    0,                                   // dynamicOffsetCount
-	    NULL);                               // pDynamicOffsets
+	if (!r->gfx.layer.shared.push_descriptors) {
+		VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+
+		ret = do_ubo_and_src_alloc_and_write(          //
+		    render,                                    //
+		    RENDER_BINDING_LAYER_SHARED_UBO,           // ubo_binding
+		    ubo_ptr,                                   //
+		    ubo_size,                                  //
+		    RENDER_BINDING_LAYER_SHARED_SRC,           // src_binding
+		    src_sampler,                               //
+		    src_image_view,                            //
+		    render->frame->gfx_descriptor_pool,        //
+		    r->gfx.layer.shared.descriptor_set_layout, //
+		    &descriptor_set);                          //
+		VK_CHK_AND_RET(ret, "do_ubo_and_src_alloc_and_write");
+
+		*out_descriptor = (struct render_gfx_layer_descriptor){
+		    .descriptor_set = descriptor_set,
+		};
+
+		return VK_SUCCESS;
+	}
+
+	// Pushed into the command buffer when drawn, nothing to allocate.
+	struct render_sub_alloc ubo = XRT_STRUCT_INIT;
+	ret = render_sub_alloc_ubo_alloc_and_write( //
+	    vk,                                     //
+	    &render->ubo_tracker,                   // rsat
+	    ubo_ptr,                                //
+	    ubo_size,                               //
+	    &ubo);                                  // out_rsa
+	VK_CHK_AND_RET(ret, "render_sub_alloc_ubo_alloc_and_write");
+
+	*out_descriptor = (struct render_gfx_layer_descriptor){
+	    .ubo_buffer = ubo.buffer,
+	    .ubo_offset = ubo.offset,
+	    .ubo_size = ubo.size,
+	    .src_sampler = src_sampler,
+	    .src_image_view = src_image_view,
+	};
+
+	return VK_SUCCESS;
+}
+
+static inline void
+bind_pipeline(struct render_gfx *render, VkPipeline pipeline)
+{
+	struct vk_bundle *vk = vk_from_render(render);
+
+	// All views and layers are drawn with a handful of pipelines.
+	if (render->bound_pipeline == pipeline) {
+		return;
+	}
 
 	vk->vkCmdBindPipeline(               //
-	    r->cmd,                          //
+	    render->frame->cmd,              //
 	    VK_PIPELINE_BIND_POINT_GRAPHICS, // pipelineBindPoint
-	    pipeline);                       //
+	    pipeline);                       // pipeline
+
+	render->bound_pipeline = pipeline;
+}
+
+static inline void
+dispatch_no_vbo(struct render_gfx *render,
+                uint32_t vertex_count,
+                VkPipeline pipeline,
+                const struct render_gfx_layer_descriptor *descriptor)
+{
+	struct vk_bundle *vk = vk_from_render(render);
+	struct render_resources *r = render->r;
+
+	if (r->gfx.layer.shared.push_descriptors) {
+		update_ubo_and_src_descriptor_set(        //
+		    vk,                                   //
+		    RENDER_BINDING_LAYER_SHARED_UBO,      // ubo_binding
+		    descriptor->ubo_buffer,               //
+		    descriptor->ubo_offset,               //
+		    descriptor->ubo_size,                 //
+		    RENDER_BINDING_LAYER_SHARED_SRC,      // src_binding
+		    descriptor->src_sampler,              //
+		    descriptor->src_image_view,           //
+		    VK_NULL_HANDLE,                       // descriptor_set
+		    render->frame->cmd,                   // cmd
+		    r->gfx.layer.shared.pipeline_layout); // pipeline_layout
+	} else {
+		VkDescriptorSet descriptor_sets[1] = {descriptor->descriptor_set};
+		vk->vkCmdBindDescriptorSets(             //
+		    render->frame->cmd,                  //
+		    VK_PIPELINE_BIND_POINT_GRAPHICS,     // pipelineBindPoint
+		    r->gfx.layer.shared.pipeline_layout, // layout
+		    0,                                   // firstSet
+		    ARRAY_SIZE(descriptor_sets),         // descriptorSetCount
+		    descriptor_sets,                     // pDescriptorSets
+		    0,                                   // dynamicOffsetCount
+		    NULL);                               // pDynamicOffsets
+	}
+
+	bind_pipeline(render, pipeline);
 
 	// This pipeline doesn't have any VBO input or indices.
 
-	vk->vkCmdDraw(    //
-	    r->cmd,       //
-	    vertex_count, // vertexCount
-	    1,            // instanceCount
-	    0,            // firstVertex
-	    0);           // firstInstance
+	vk->vkCmdDraw(          //
+	    render->frame->cmd, //
+	    vertex_count,       // vertexCount
+	    1,                  // instanceCount
+	    0,                  // firstVertex
+	    0);                 // firstInstance
 }
 
 
@@ -700,6 +815,45 @@ create_mesh_pipeline(struct vk_bundle *vk,
 }
 
 
+/*!
+ * The cylinder and equirect2 pipelines are only used by few apps, so they are
+ * created the first time they are used instead of delaying start up. Using the
+ * pipeline cache this is fast after the first run.
+ */
+static VkPipeline
+get_rare_layer_pipeline(struct render_gfx_render_pass *rgrp,
+                        VkPipeline *pipeline_ptr,
+                        bool premultiplied_alpha,
+                        VkShaderModule module_vert,
+                        VkShaderModule module_frag,
+                        const char *name)
+{
+	if (*pipeline_ptr != VK_NULL_HANDLE) {
+		return *pipeline_ptr;
+	}
+
+	struct render_resources *r = rgrp->r;
+	struct vk_bundle *vk = r->vk;
+	VkResult ret;
+
+	const VkBlendFactor src_blend_factor = premultiplied_alpha ? VK_BLEND_FACTOR_ONE : VK_BLEND_FACTOR_SRC_ALPHA;
+
+	ret = create_layer_pipeline(             //
+	    vk,                                  //
+	    rgrp->render_pass,                   //
+	    r->gfx.layer.shared.pipeline_layout, //
+	    r->pipeline_cache,                   //
+	    src_blend_factor,                    // src_blend_factor
+	    module_vert,                         // module_vert
+	    module_frag,                         // module_frag
+	    pipeline_ptr);                       // out_pipeline
+	VK_CHK_WITH_RET(ret, "create_layer_pipeline", VK_NULL_HANDLE);
+	VK_NAME_PIPELINE(vk, *pipeline_ptr, name);
+
+	return *pipeline_ptr;
+}
+
+
 /*
  *
  * 'Exported' render pass functions.
@@ -766,59 +920,7 @@ render_gfx_render_pass_init(struct render_gfx_render_pass *rgrp,
 	const VkBlendFactor blend_factor_premultiplied_alpha = VK_BLEND_FACTOR_ONE;
 	const VkBlendFactor blend_factor_unpremultiplied_alpha = VK_BLEND_FACTOR_SRC_ALPHA;
 
-	// Cylinder
-	ret = create_layer_pipeline(                    //
-	    vk,                                         //
-	    rgrp->render_pass,                          //
-	    r->gfx.layer.shared.pipeline_layout,        //
-	    r->pipeline_cache,                          //
-	    blend_factor_premultiplied_alpha,           // src_blend_factor
-	    r->shaders->layer_cylinder_vert,            //
-	    r->shaders->layer_cylinder_frag,            //
-	    &rgrp->layer.cylinder_premultiplied_alpha); // out_pipeline
-	VK_CHK_WITH_RET(ret, "create_layer_pipeline", false);
-	VK_NAME_PIPELINE(vk, rgrp->layer.cylinder_premultiplied_alpha,
-	                 "render_gfx_render_pass cylinder premultiplied alpha");
-
-	ret = create_layer_pipeline(                      //
-	    vk,                                           //
-	    rgrp->render_pass,                            //
-	    r->gfx.layer.shared.pipeline_layout,          //
-	    r->pipeline_cache,                            //
-	    blend_factor_unpremultiplied_alpha,           // src_blend_factor
-	    r->shaders->layer_cylinder_vert,              // module_vert
-	    r->shaders->layer_cylinder_frag,              // module_frag
-	    &rgrp->layer.cylinder_unpremultiplied_alpha); // out_pipeline
-	VK_CHK_WITH_RET(ret, "create_layer_pipeline", false);
-	VK_NAME_PIPELINE(vk, rgrp->layer.cylinder_unpremultiplied_alpha,
-	                 "render_gfx_render_pass cylinder unpremultiplied alpha");
-
-	// Equirect2
-	ret = create_layer_pipeline(                     //
-	    vk,                                          //
-	    rgrp->render_pass,                           //
-	    r->gfx.layer.shared.pipeline_layout,         //
-	    r->pipeline_cache,                           //
-	    blend_factor_premultiplied_alpha,            // src_blend_factor
-	    r->shaders->layer_equirect2_vert,            // module_vert
-	    r->shaders->layer_equirect2_frag,            // module_frag
-	    &rgrp->layer.equirect2_premultiplied_alpha); // out_pipeline
-	VK_CHK_WITH_RET(ret, "create_layer_pipeline", false);
-	VK_NAME_PIPELINE(vk, rgrp->layer.equirect2_premultiplied_alpha,
-	                 "render_gfx_render_pass equirect2 premultiplied alpha");
-
-	ret = create_layer_pipeline(                       //
-	    vk,                                            //
-	    rgrp->render_pass,                             //
-	    r->gfx.layer.shared.pipeline_layout,           //
-	    r->pipeline_cache,                             //
-	    blend_factor_unpremultiplied_alpha,            // src_blend_factor
-	    r->shaders->layer_equirect2_vert,              // module_vert
-	    r->shaders->layer_equirect2_frag,              // module_frag
-	    &rgrp->layer.equirect2_unpremultiplied_alpha); // out_pipeline
-	VK_CHK_WITH_RET(ret, "create_layer_pipeline", false);
-	VK_NAME_PIPELINE(vk, rgrp->layer.equirect2_unpremultiplied_alpha,
-	                 "render_gfx_render_pass equirect2 unpremultiplied alpha");
+	// Cylinder and equirect2 are rarely used, created on first use, see get_rare_layer_pipeline.
 
 	// Projection.
 	ret = create_layer_pipeline(                //
@@ -962,8 +1064,18 @@ render_gfx_init(struct render_gfx *render, struct render_resources *r)
 	// Init fields.
 	render->r = r;
 
-	// Used to sub-allocate UBOs from, restart from scratch each frame.
-	render_sub_alloc_tracker_init(&render->ubo_tracker, &r->gfx.shared_ubo);
+	/*
+	 * Each frame in flight has its own resources and region of the shared
+	 * buffer to sub-allocate UBOs from, restart that from scratch.
+	 */
+	uint32_t index = r->frame_index;
+	render->frame = &r->frames[index];
+
+	render_sub_alloc_tracker_init_region(     //
+	    &render->ubo_tracker,                 // rsat
+	    &r->gfx.shared_ubo,                   // buffer
+	    r->gfx.shared_ubo_frame_size * index, // offset
+	    r->gfx.shared_ubo_frame_size);        // size
 
 	return true;
 }
@@ -974,7 +1086,7 @@ render_gfx_begin(struct render_gfx *render)
 	struct vk_bundle *vk = vk_from_render(render);
 	VkResult ret;
 
-	ret = vk->vkResetCommandPool(vk->device, render->r->cmd_pool, 0);
+	ret = vk->vkResetCommandPool(vk->device, render->frame->cmd_pool, 0);
 	VK_CHK_WITH_RET(ret, "vkResetCommandPool", false);
 
 
@@ -984,20 +1096,20 @@ render_gfx_begin(struct render_gfx *render)
 	};
 
 	ret = vk->vkBeginCommandBuffer( //
-	    render->r->cmd,             //
+	    render->frame->cmd,         //
 	    &begin_info);               //
 	VK_CHK_WITH_RET(ret, "vkResetCommandPool", false);
 
-	vk->vkCmdResetQueryPool(   //
-	    render->r->cmd,        //
-	    render->r->query_pool, //
-	    0,                     // firstQuery
-	    2);                    // queryCount
+	vk->vkCmdResetQueryPool(       //
+	    render->frame->cmd,        //
+	    render->frame->query_pool, //
+	    0,                         // firstQuery
+	    2);                        // queryCount
 
 	vk->vkCmdWriteTimestamp(               //
-	    render->r->cmd,                    //
+	    render->frame->cmd,                //
 	    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, // pipelineStage
-	    render->r->query_pool,             //
+	    render->frame->query_pool,         //
 	    0);                                // query
 
 	return true;
@@ -1010,12 +1122,12 @@ render_gfx_end(struct render_gfx *render)
 	VkResult ret;
 
 	vk->vkCmdWriteTimestamp(                  //
-	    render->r->cmd,                       //
+	    render->frame->cmd,                   //
 	    VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, // pipelineStage
-	    render->r->query_pool,                //
+	    render->frame->query_pool,            //
 	    1);                                   // query
 
-	ret = vk->vkEndCommandBuffer(render->r->cmd);
+	ret = vk->vkEndCommandBuffer(render->frame->cmd);
 	VK_CHK_WITH_RET(ret, "vkEndCommandBuffer", false);
 
 	return true;
@@ -1025,12 +1137,11 @@ void
 render_gfx_fini(struct render_gfx *render)
 {
 	struct vk_bundle *vk = vk_from_render(render);
-	struct render_resources *r = render->r;
 
 	// Reclaim all descriptor sets.
 	vk->vkResetDescriptorPool(              //
 	    vk->device,                         //
-	    r->gfx.ubo_and_src_descriptor_pool, //
+	    render->frame->gfx_descriptor_pool, //
 	    0);                                 //
 
 	// This "reclaims" the allocated UBOs.
@@ -1044,6 +1155,26 @@ render_gfx_fini(struct render_gfx *render)
  *
  */
 
+uint32_t
+render_gfx_begin_scope(struct render_gfx *render, const char *name)
+{
+	struct vk_bundle *vk = vk_from_render(render);
+
+	assert(render->rtr == NULL);
+
+	return vk_gpu_profiler_begin_scope(vk, &render->r->profiler, render->frame->cmd, name);
+}
+
+void
+render_gfx_end_scope(struct render_gfx *render, uint32_t scope)
+{
+	struct vk_bundle *vk = vk_from_render(render);
+
+	assert(render->rtr == NULL);
+
+	vk_gpu_profiler_end_scope(vk, &render->r->profiler, render->frame->cmd, scope);
+}
+
 bool
 render_gfx_begin_target(struct render_gfx *render,
                         struct render_gfx_target_resources *rtr,
@@ -1054,18 +1185,22 @@ render_gfx_begin_target(struct render_gfx *render,
 	assert(render->rtr == NULL);
 	render->rtr = rtr;
 
+	// New render pass, nothing is known to be bound for it.
+	render->bound_pipeline = VK_NULL_HANDLE;
+	render->mesh_buffers_bound = false;
+
 	VkRenderPass render_pass = rtr->rgrp->render_pass;
 	VkFramebuffer framebuffer = rtr->framebuffer;
 	VkExtent2D extent = rtr->extent;
 
-	begin_render_pass(  //
-	    vk,             //
-	    render->r->cmd, //
-	    render_pass,    //
-	    framebuffer,    //
-	    extent.width,   //
-	    extent.height,  //
-	    color);         //
+	begin_render_pass(      //
+	    vk,                 //
+	    render->frame->cmd, //
+	    render_pass,        //
+	    framebuffer,        //
+	    extent.width,       //
+	    extent.height,      //
+	    color);             //
 
 	return true;
 }
@@ -1079,7 +1214,7 @@ render_gfx_end_target(struct render_gfx *render)
 	render->rtr = NULL;
 
 	// Stop the [shared] render pass.
-	vk->vkCmdEndRenderPass(render->r->cmd);
+	vk->vkCmdEndRenderPass(render->frame->cmd);
 }
 
 void
@@ -1105,7 +1240,7 @@ render_gfx_begin_view(struct render_gfx *render, uint32_t view, const struct ren
 	    .maxDepth = 1.0f,
 	};
 
-	vk->vkCmdSetViewport(render->r->cmd, //
+	vk->vkCmdSetViewport(render->frame->cmd, //
 	                     0,              // firstViewport
 	                     1,              // viewportCount
 	                     &viewport);     //
@@ -1127,7 +1262,7 @@ render_gfx_begin_view(struct render_gfx *render, uint32_t view, const struct ren
 	        },
 	};
 
-	vk->vkCmdSetScissor(render->r->cmd, //
+	vk->vkCmdSetScissor(render->frame->cmd, //
 	                    0,              // firstScissor
 	                    1,              // scissorCount
 	                    &scissor);      //
@@ -1157,7 +1292,7 @@ render_gfx_mesh_alloc_and_write(struct render_gfx *render,
 	    r->mesh.src_binding,                //
 	    src_sampler,                        //
 	    src_image_view,                     //
-	    r->gfx.ubo_and_src_descriptor_pool, //
+	    render->frame->gfx_descriptor_pool, //
 	    r->mesh.descriptor_set_layout,      //
 	    out_descriptor_set);                //
 }
@@ -1175,7 +1310,7 @@ render_gfx_mesh_draw(struct render_gfx *render, uint32_t mesh_index, VkDescripto
 
 	VkDescriptorSet descriptor_sets[1] = {descriptor_set};
 	vk->vkCmdBindDescriptorSets(         //
-	    r->cmd,                          //
+	    render->frame->cmd,              //
 	    VK_PIPELINE_BIND_POINT_GRAPHICS, // pipelineBindPoint
 	    r->mesh.pipeline_layout,         // layout
 	    0,                               // firstSet
@@ -1188,26 +1323,35 @@ render_gfx_mesh_draw(struct render_gfx *render, uint32_t mesh_index, VkDescripto
 	VkPipeline pipeline =
 	    do_timewarp ? render->rtr->rgrp->mesh.pipeline_timewarp : render->rtr->rgrp->mesh.pipeline;
 
-	vk->vkCmdBindPipeline(               //
-	    r->cmd,                          //
-	    VK_PIPELINE_BIND_POINT_GRAPHICS, // pipelineBindPoint
-	    pipeline);                       // pipeline
+	bind_pipeline(render, pipeline);
 
 
 	/*
-	 * Vertex buffer.
+	 * Vertex and index buffers, all views are in the same buffers.
 	 */
 
-	VkBuffer buffers[1] = {r->mesh.vbo.buffer};
-	VkDeviceSize offsets[1] = {0};
-	assert(ARRAY_SIZE(buffers) == ARRAY_SIZE(offsets));
-
-	vk->vkCmdBindVertexBuffers( //
-	    r->cmd,                 //
-	    0,                      // firstBinding
-	    ARRAY_SIZE(buffers),    // bindingCount
-	    buffers,                // pBuffers
-	    offsets);               // pOffsets
+	if (!render->mesh_buffers_bound) {
+		VkBuffer buffers[1] = {r->mesh.vbo.buffer};
+		VkDeviceSize offsets[1] = {0};
+		assert(ARRAY_SIZE(buffers) == ARRAY_SIZE(offsets));
+
+		vk->vkCmdBindVertexBuffers( //
+		    render->frame->cmd,     //
+		    0,                      // firstBinding
+		    ARRAY_SIZE(buffers),    // bindingCount
+		    buffers,                // pBuffers
+		    offsets);               // pOffsets
+
+		if (r->mesh.index_count_total > 0) {
+			vk->vkCmdBindIndexBuffer(  //
+			    render->frame->cmd,    //
+			    r->mesh.ibo.buffer,    // buffer
+			    0,                     // offset
+			    VK_INDEX_TYPE_UINT32); // indexType
+		}
+
+		render->mesh_buffers_bound = true;
+	}
 
 
 	/*
@@ -1215,14 +1359,8 @@ render_gfx_mesh_draw(struct render_gfx *render, uint32_t mesh_index, VkDescripto
 	 */
 
 	if (r->mesh.index_count_total > 0) {
-		vk->vkCmdBindIndexBuffer(  //
-		    r->cmd,                //
-		    r->mesh.ibo.buffer,    // buffer
-		    0,                     // offset
-		    VK_INDEX_TYPE_UINT32); // indexType
-
 		vk->vkCmdDrawIndexed(                  //
-		    r->cmd,                            //
+		    render->frame->cmd,                //
 		    r->mesh.index_counts[mesh_index],  // indexCount
 		    1,                                 // instanceCount
 		    r->mesh.index_offsets[mesh_index], // firstIndex
@@ -1230,7 +1368,7 @@ render_gfx_mesh_draw(struct render_gfx *render, uint32_t mesh_index, VkDescripto
 		    0);                                // firstInstance
 	} else {
 		vk->vkCmdDraw(            //
-		    r->cmd,               //
+		    render->frame->cmd,   //
 		    r->mesh.vertex_count, // vertexCount
 		    1,                    // instanceCount
 		    0,                    // firstVertex
@@ -1250,21 +1388,15 @@ render_gfx_layer_cylinder_alloc_and_write(struct render_gfx *render,
                                           const struct render_gfx_layer_cylinder_data *data,
                                           VkSampler src_sampler,
                                           VkImageView src_image_view,
-                                          VkDescriptorSet *out_descriptor_set)
+                                          struct render_gfx_layer_descriptor *out_descriptor)
 {
-	struct render_resources *r = render->r;
-
-	return do_ubo_and_src_alloc_and_write(         //
-	    render,                                    //
-	    RENDER_BINDING_LAYER_SHARED_UBO,           // ubo_binding
-	    data,                                      // ubo_ptr
-	    sizeof(*data),                             // ubo_size
-	    RENDER_BINDING_LAYER_SHARED_SRC,           // src_binding
-	    src_sampler,                               //
-	    src_image_view,                            //
-	    r->gfx.ubo_and_src_descriptor_pool,        //
-	    r->gfx.layer.shared.descriptor_set_layout, //
-	    out_descriptor_set);                       //
+	return do_layer_alloc_and_write( //
+	    render,                      //
+	    data,                        // ubo_ptr
+	    sizeof(*data),               // ubo_size
+	    src_sampler,                 //
+	    src_image_view,              //
+	    out_descriptor);             //
 }
 
 XRT_CHECK_RESULT VkResult
@@ -1272,21 +1404,15 @@ render_gfx_layer_equirect2_alloc_and_write(struct render_gfx *render,
                                            const struct render_gfx_layer_equirect2_data *data,
                                            VkSampler src_sampler,
                                            VkImageView src_image_view,
-                                           VkDescriptorSet *out_descriptor_set)
+                                           struct render_gfx_layer_descriptor *out_descriptor)
 {
-	struct render_resources *r = render->r;
-
-	return do_ubo_and_src_alloc_and_write(         //
-	    render,                                    //
-	    RENDER_BINDING_LAYER_SHARED_UBO,           // ubo_binding
-	    data,                                      // ubo_ptr
-	    sizeof(*data),                             // ubo_size
-	    RENDER_BINDING_LAYER_SHARED_SRC,           // src_binding
-	    src_sampler,                               //
-	    src_image_view,                            //
-	    r->gfx.ubo_and_src_descriptor_pool,        //
-	    r->gfx.layer.shared.descriptor_set_layout, //
-	    out_descriptor_set);                       //
+	return do_layer_alloc_and_write( //
+	    render,                      //
+	    data,                        // ubo_ptr
+	    sizeof(*data),               // ubo_size
+	    src_sampler,                 //
+	    src_image_view,              //
+	    out_descriptor);             //
 }
 
 XRT_CHECK_RESULT VkResult
@@ -1294,21 +1420,15 @@ render_gfx_layer_projection_alloc_and_write(struct render_gfx *render,
                                             const struct render_gfx_layer_projection_data *data,
                                             VkSampler src_sampler,
                                             VkImageView src_image_view,
-                                            VkDescriptorSet *out_descriptor_set)
+                                            struct render_gfx_layer_descriptor *out_descriptor)
 {
-	struct render_resources *r = render->r;
-
-	return do_ubo_and_src_alloc_and_write(         //
-	    render,                                    //
-	    RENDER_BINDING_LAYER_SHARED_UBO,           // ubo_binding
-	    data,                                      // ubo_ptr
-	    sizeof(*data),                             // ubo_size
-	    RENDER_BINDING_LAYER_SHARED_SRC,           // src_binding
-	    src_sampler,                               //
-	    src_image_view,                            //
-	    r->gfx.ubo_and_src_descriptor_pool,        //
-	    r->gfx.layer.shared.descriptor_set_layout, //
-	    out_descriptor_set);                       //
+	return do_layer_alloc_and_write( //
+	    render,                      //
+	    data,                        // ubo_ptr
+	    sizeof(*data),               // ubo_size
+	    src_sampler,                 //
+	    src_image_view,              //
+	    out_descriptor);             //
 }
 
 XRT_CHECK_RESULT VkResult
@@ -1316,30 +1436,40 @@ render_gfx_layer_quad_alloc_and_write(struct render_gfx *render,
                                       const struct render_gfx_layer_quad_data *data,
                                       VkSampler src_sampler,
                                       VkImageView src_image_view,
-                                      VkDescriptorSet *out_descriptor_set)
+                                      struct render_gfx_layer_descriptor *out_descriptor)
 {
-	struct render_resources *r = render->r;
-
-	return do_ubo_and_src_alloc_and_write(         //
-	    render,                                    //
-	    RENDER_BINDING_LAYER_SHARED_UBO,           // ubo_binding
-	    data,                                      // ubo_ptr
-	    sizeof(*data),                             // ubo_size
-	    RENDER_BINDING_LAYER_SHARED_SRC,           // src_binding
-	    src_sampler,                               //
-	    src_image_view,                            //
-	    r->gfx.ubo_and_src_descriptor_pool,        //
-	    r->gfx.layer.shared.descriptor_set_layout, //
-	    out_descriptor_set);                       //
+	return do_layer_alloc_and_write( //
+	    render,                      //
+	    data,                        // ubo_ptr
+	    sizeof(*data),               // ubo_size
+	    src_sampler,                 //
+	    src_image_view,              //
+	    out_descriptor);             //
 }
 
 void
-render_gfx_layer_cylinder(struct render_gfx *render, bool premultiplied_alpha, VkDescriptorSet descriptor_set)
+render_gfx_layer_cylinder(struct render_gfx *render,
+                          bool premultiplied_alpha,
+                          const struct render_gfx_layer_descriptor *descriptor)
 {
-	VkPipeline pipeline =                                              //
-	    premultiplied_alpha                                            //
-	        ? render->rtr->rgrp->layer.cylinder_premultiplied_alpha    //
-	        : render->rtr->rgrp->layer.cylinder_unpremultiplied_alpha; //
+	struct render_gfx_render_pass *rgrp = render->rtr->rgrp;
+	struct render_shaders *shaders = render->r->shaders;
+
+	VkPipeline *pipeline_ptr = premultiplied_alpha ? &rgrp->layer.cylinder_premultiplied_alpha //
+	                                               : &rgrp->layer.cylinder_unpremultiplied_alpha;
+	const char *name = premultiplied_alpha ? "render_gfx_render_pass cylinder premultiplied alpha" //
+	                                       : "render_gfx_render_pass cylinder unpremultiplied alpha";
+
+	VkPipeline pipeline = get_rare_layer_pipeline( //
+	    rgrp,                                      //
+	    pipeline_ptr,                              //
+	    premultiplied_alpha,                       //
+	    shaders->layer_cylinder_vert,              // module_vert
+	    shaders->layer_cylinder_frag,              // module_frag
+	    name);                                     //
+	if (pipeline == VK_NULL_HANDLE) {
+		return;
+	}
 
 	// One per degree.
 	uint32_t subdivisions = 360;
@@ -1350,31 +1480,49 @@ render_gfx_layer_cylinder(struct render_gfx *render, bool premultiplied_alpha, V
 	// With triangle strip we get 2 vertices per edge.
 	uint32_t vertex_count = edges * 2;
 
-	dispatch_no_vbo(     //
-	    render,          //
-	    vertex_count,    // vertex_count
-	    pipeline,        //
-	    descriptor_set); //
+	dispatch_no_vbo(  //
+	    render,       //
+	    vertex_count, // vertex_count
+	    pipeline,     //
+	    descriptor);  //
 }
 
 void
-render_gfx_layer_equirect2(struct render_gfx *render, bool premultiplied_alpha, VkDescriptorSet descriptor_set)
+render_gfx_layer_equirect2(struct render_gfx *render,
+                           bool premultiplied_alpha,
+                           const struct render_gfx_layer_descriptor *descriptor)
 {
-	VkPipeline pipeline =                                               //
-	    premultiplied_alpha                                             //
-	        ? render->rtr->rgrp->layer.equirect2_premultiplied_alpha    //
-	        : render->rtr->rgrp->layer.equirect2_unpremultiplied_alpha; //
+	struct render_gfx_render_pass *rgrp = render->rtr->rgrp;
+	struct render_shaders *shaders = render->r->shaders;
+
+	VkPipeline *pipeline_ptr = premultiplied_alpha ? &rgrp->layer.equirect2_premultiplied_alpha //
+	                                               : &rgrp->layer.equirect2_unpremultiplied_alpha;
+	const char *name = premultiplied_alpha ? "render_gfx_render_pass equirect2 premultiplied alpha" //
+	                                       : "render_gfx_render_pass equirect2 unpremultiplied alpha";
+
+	VkPipeline pipeline = get_rare_layer_pipeline( //
+	    rgrp,                                      //
+	    pipeline_ptr,                              //
+	    premultiplied_alpha,                       //
+	    shaders->layer_equirect2_vert,             // module_vert
+	    shaders->layer_equirect2_frag,             // module_frag
+	    name);                                     //
+	if (pipeline == VK_NULL_HANDLE) {
+		return;
+	}
 
 	// Hardcoded to 4 vertices.
-	dispatch_no_vbo(     //
-	    render,          //
-	    4,               // vertex_count
-	    pipeline,        //
-	    descriptor_set); //
+	dispatch_no_vbo( //
+	    render,      //
+	    4,           // vertex_count
+	    pipeline,    //
+	    descriptor); //
 }
 
 void
-render_gfx_layer_projection(struct render_gfx *render, bool premultiplied_alpha, VkDescriptorSet descriptor_set)
+render_gfx_layer_projection(struct render_gfx *render,
+                            bool premultiplied_alpha,
+                            const struct render_gfx_layer_descriptor *descriptor)
 {
 	VkPipeline pipeline =                                          //
 	    premultiplied_alpha                                        //
@@ -1382,15 +1530,17 @@ render_gfx_layer_projection(struct render_gfx *render, bool premultiplied_alpha,
 	        : render->rtr->rgrp->layer.proj_unpremultiplied_alpha; //
 
 	// Hardcoded to 4 vertices.
-	dispatch_no_vbo(     //
-	    render,          //
-	    4,               // vertex_count
-	    pipeline,        //
-	    descriptor_set); //
+	dispatch_no_vbo( //
+	    render,      //
+	    4,           // vertex_count
+	    pipeline,    //
+	    descriptor); //
 }
 
 void
-render_gfx_layer_quad(struct render_gfx *render, bool premultiplied_alpha, VkDescriptorSet descriptor_set)
+render_gfx_layer_quad(struct render_gfx *render,
+                      bool premultiplied_alpha,
+                      const struct render_gfx_layer_descriptor *descriptor)
 {
 	VkPipeline pipeline =                                          //
 	    premultiplied_alpha                                        //
@@ -1398,9 +1548,9 @@ render_gfx_layer_quad(struct render_gfx *render, bool premultiplied_alpha, VkDes
 	        : render->rtr->rgrp->layer.quad_unpremultiplied_alpha; //
 
 	// Hardcoded to 4 vertices.
-	dispatch_no_vbo(     //
-	    render,          //
-	    4,               // vertex_count
-	    pipeline,        //
-	    descriptor_set); //
+	dispatch_no_vbo( //
+	    render,      //
+	    4,           // vertex_count
+	    pipeline,    //
+	    descriptor); //
 }
@@ -1,4 +1,4 @@
-// Copyright 2019-2023, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -15,6 +15,7 @@
 
 #include "vk/vk_helpers.h"
 #include "vk/vk_cmd_pool.h"
+#include "vk/vk_gpu_profiler.h"
 
 
 #ifdef __cplusplus
@@ -57,6 +58,18 @@ extern "C" {
  */
 #define RENDER_MAX_LAYERS (XRT_MAX_LAYERS)
 
+/*!
+ * The layer squasher splits each view into this many bins on each axis, a
+ * pixel only evaluates the layers that may touch its bin.
+ */
+#define RENDER_LAYER_BINS (8)
+
+/*!
+ * Number of 32 bit words in the layer mask of a bin, the mask is a std140
+ * uvec4 so this caps @ref RENDER_MAX_LAYERS at 128.
+ */
+#define RENDER_LAYER_BIN_WORDS (4)
+
 /*!
  * Max number of images that can be given at a single time to the layer
  * squasher in a single dispatch.
@@ -74,6 +87,13 @@ extern "C" {
 #define RENDER_MAX_LAYER_RUNS_SIZE (XRT_MAX_VIEWS)
 #define RENDER_MAX_LAYER_RUNS_COUNT(RENDER_RESOURCES) (RENDER_RESOURCES->view_count)
 
+/*!
+ * Number of layer squasher descriptor sets kept written per frame in flight,
+ * see @ref render_compute_layer_descriptor. Needs to be at least one per layer
+ * run, more lets a few swapchain images cycle through without rewriting sets.
+ */
+#define RENDER_LAYER_DESCRIPTOR_CACHE_SIZE (16)
+
 //! Distortion image dimension in pixels
 #define RENDER_DISTORTION_IMAGE_DIMENSIONS (128)
 
@@ -81,6 +101,22 @@ extern "C" {
 #define RENDER_DISTORTION_IMAGES_SIZE (3 * XRT_MAX_VIEWS)
 #define RENDER_DISTORTION_IMAGES_COUNT(RENDER_RESOURCES) (3 * RENDER_RESOURCES->view_count)
 
+//! Tiles per dimension that each view is split into for the hidden tile mask.
+#define RENDER_DISTORTION_TILE_DIMENSIONS (16)
+
+//! Number of 32 bit words in the hidden tile mask of one view.
+#define RENDER_DISTORTION_TILE_WORDS (RENDER_DISTORTION_TILE_DIMENSIONS * RENDER_DISTORTION_TILE_DIMENSIONS / 32)
+
+//! Max quad layers the compute distortion shader blends on top of the projection layer.
+#define RENDER_DISTORTION_MAX_QUADS (2)
+
+/*!
+ * Max number of frames that are being recorded or are in flight on the GPU at
+ * the same time, each has its own @ref render_frame_resources. With two the
+ * CPU can record the next frame while the GPU is working on the previous one.
+ */
+#define RENDER_MAX_FRAMES_IN_FLIGHT (2)
+
 //! The binding that the layer projection and quad shader have their UBO on.
 #define RENDER_BINDING_LAYER_SHARED_UBO 0
 
@@ -104,6 +140,21 @@ render_calc_time_warp_matrix(const struct xrt_pose *src_pose,
                              const struct xrt_pose *new_pose,
                              struct xrt_matrix_4x4 *matrix);
 
+/*!
+ * Calculates the matrices needed for positional, depth based, reprojection.
+ * The @p out_projection matrix is the projection part of the timewarp matrix,
+ * taking points in the source view space to [-1, 1] space that needs a
+ * perspective divide. The @p out_new_to_src matrix takes points in the view
+ * space of @p new_pose into the view space of @p src_pose, including the
+ * translation between them.
+ */
+void
+render_calc_depth_reprojection_matrices(const struct xrt_pose *src_pose,
+                                        const struct xrt_fov *src_fov,
+                                        const struct xrt_pose *new_pose,
+                                        struct xrt_matrix_4x4 *out_projection,
+                                        struct xrt_matrix_4x4 *out_new_to_src);
+
 /*!
  * This function constructs a transformation in the form of a normalized rect
  * that lets you go from a UV coordinate on a projection plane to the a point on
@@ -316,6 +367,18 @@ struct render_sub_alloc_tracker
 void
 render_sub_alloc_tracker_init(struct render_sub_alloc_tracker *rsat, struct render_buffer *buffer);
 
+/*!
+ * Same as @ref render_sub_alloc_tracker_init but only sub-allocates from the
+ * region given by @p offset and @p size, the returned offsets are still from
+ * the start of @p buffer. The @p offset needs to be aligned to
+ * @ref RENDER_ALWAYS_SAFE_UBO_ALIGNMENT.
+ */
+void
+render_sub_alloc_tracker_init_region(struct render_sub_alloc_tracker *rsat,
+                                     struct render_buffer *buffer,
+                                     VkDeviceSize offset,
+                                     VkDeviceSize size);
+
 /*!
  * Allocate enough memory (with constraints of UBOs) of @p size, return the
  * pointer to the mapped memory or null if the buffer wasn't allocated.
@@ -345,6 +408,68 @@ render_sub_alloc_ubo_alloc_and_write(struct vk_bundle *vk,
  *
  */
 
+/*!
+ * A layer squasher descriptor set and what it was last written with, reused
+ * without calling vkUpdateDescriptorSets when the same images, target and UBO
+ * are used again. Handles can be recycled by the driver once destroyed, so
+ * users must call @ref render_resources_invalidate_layer_descriptors when any
+ * image view that might be in the cache is destroyed.
+ */
+struct render_compute_layer_descriptor
+{
+	VkDescriptorSet descriptor_set;
+
+	//! Has @p descriptor_set been written with the values below.
+	bool valid;
+
+	//! Value of @ref render_resources::frame_counter when last used.
+	uint64_t last_used;
+
+	VkBuffer ubo;
+	VkImageView target_image_view;
+	uint32_t image_count;
+	VkSampler src_samplers[RENDER_MAX_IMAGES_SIZE];
+	VkImageView src_image_views[RENDER_MAX_IMAGES_SIZE];
+};
+
+/*!
+ * The resources that are reset or written to when recording a frame, there is
+ * one per frame in flight. The GPU must be done with the work last recorded
+ * with them before they are reused, see @ref render_resources_next_frame.
+ */
+struct render_frame_resources
+{
+	//! Pool for @ref cmd, reset at the start of each frame.
+	VkCommandPool cmd_pool;
+
+	//! Command buffer for recording everything.
+	VkCommandBuffer cmd;
+
+	//! Start and end timestamps of the frame.
+	VkQueryPool query_pool;
+
+	//! Pool for gfx shaders that uses one ubo and sampler.
+	VkDescriptorPool gfx_descriptor_pool;
+
+	//! Descriptor pool for compute work.
+	VkDescriptorPool compute_descriptor_pool;
+
+	//! Pool for @ref layer_descriptors, never reset.
+	VkDescriptorPool compute_layer_descriptor_pool;
+
+	//! Layer squasher descriptor sets, kept across frames.
+	struct render_compute_layer_descriptor layer_descriptors[RENDER_LAYER_DESCRIPTOR_CACHE_SIZE];
+
+	//! Compute layer target info.
+	struct render_buffer compute_layer_ubos[RENDER_MAX_LAYER_RUNS_SIZE];
+
+	//! Compute distortion target info.
+	struct render_buffer compute_distortion_ubo;
+
+	//! Compute clear target info.
+	struct render_buffer compute_clear_ubo;
+};
+
 /*!
  * Holds all pools and static resources for rendering.
  */
@@ -374,18 +499,28 @@ struct render_resources
 	//! Shared for all rendering.
 	VkPipelineCache pipeline_cache;
 
-	VkCommandPool cmd_pool;
+	//! Per pass timestamps, only enabled with XRT_VK_GPU_PROFILER.
+	struct vk_gpu_profiler profiler;
 
-	VkQueryPool query_pool;
+
+	/*
+	 * Per frame.
+	 */
+
+	//! Written to when recording a frame, see @ref render_resources_next_frame.
+	struct render_frame_resources frames[RENDER_MAX_FRAMES_IN_FLIGHT];
+
+	//! Index into @ref frames of the frame being recorded.
+	uint32_t frame_index;
+
+	//! Incremented by @ref render_resources_next_frame, never wraps.
+	uint64_t frame_counter;
 
 
 	/*
 	 * Static
 	 */
 
-	//! Command buffer for recording everything.
-	VkCommandBuffer cmd;
-
 	struct
 	{
 		//! Sampler for mock/null images.
@@ -403,9 +538,6 @@ struct render_resources
 
 	struct
 	{
-		//! Pool for shaders that uses one ubo and sampler.
-		VkDescriptorPool ubo_and_src_descriptor_pool;
-
 		/*!
 		 * Shared UBO buffer that we sub-allocate out of, this is to
 		 * have fewer buffers that the kernel needs to validate on
@@ -415,6 +547,13 @@ struct render_resources
 		 */
 		struct render_buffer shared_ubo;
 
+		/*!
+		 * Size of each frame's region in @ref shared_ubo, there are
+		 * @ref RENDER_MAX_FRAMES_IN_FLIGHT regions, indexed the same as
+		 * @ref frames.
+		 */
+		VkDeviceSize shared_ubo_frame_size;
+
 		struct
 		{
 			struct
@@ -424,6 +563,13 @@ struct render_resources
 
 				//! For projection and quad layer.
 				VkPipelineLayout pipeline_layout;
+
+				/*!
+				 * Is VK_KHR_push_descriptor used, then the set
+				 * layout above is a push descriptor layout and
+				 * no descriptor sets are allocated for layers.
+				 */
+				bool push_descriptors;
 			} shared;
 		} layer;
 	} gfx;
@@ -471,9 +617,6 @@ struct render_resources
 
 	struct
 	{
-		//! Descriptor pool for compute work.
-		VkDescriptorPool descriptor_pool;
-
 		//! The source projection view binding point.
 		uint32_t src_binding;
 
@@ -486,6 +629,9 @@ struct render_resources
 		//! Uniform data binding.
 		uint32_t ubo_binding;
 
+		//! Quad layers blended on top by the distortion shader.
+		uint32_t quad_binding;
+
 		struct
 		{
 			//! Descriptor set layout for compute.
@@ -500,11 +646,14 @@ struct render_resources
 			//! Doesn't depend on target so is static.
 			VkPipeline timewarp_pipeline;
 
+			//! Specialized for only projection layers without depth reprojection.
+			VkPipeline projection_pipeline;
+
+			//! Specialized for only projection layers without depth reprojection.
+			VkPipeline projection_timewarp_pipeline;
+
 			//! Size of combined image sampler array
 			uint32_t image_array_size;
-
-			//! Target info.
-			struct render_buffer ubos[RENDER_MAX_LAYER_RUNS_SIZE];
 		} layer;
 
 		struct
@@ -521,8 +670,11 @@ struct render_resources
 			//! Doesn't depend on target so is static.
 			VkPipeline timewarp_pipeline;
 
-			//! Target info.
-			struct render_buffer ubo;
+			//! Also blends quads, only used when there are any.
+			VkPipeline quads_pipeline;
+
+			//! Also blends quads, only used when there are any.
+			VkPipeline quads_timewarp_pipeline;
 		} distortion;
 
 		struct
@@ -530,9 +682,6 @@ struct render_resources
 			//! Doesn't depend on target so is static.
 			VkPipeline pipeline;
 
-			//! Target info.
-			struct render_buffer ubo;
-
 			//! @todo other resources
 		} clear;
 	} compute;
@@ -553,6 +702,21 @@ struct render_resources
 
 		//! Whether distortion images have been pre-rotated 90 degrees.
 		bool pre_rotated;
+
+		//! Whether 16 bit distortion images were asked for, see @ref ranges.
+		bool compact;
+
+		/*!
+		 * Scale (w, h) and bias (x, y) to get the UV out of the values in
+		 * the distortion images of each view, identity for float images.
+		 */
+		struct xrt_normalized_rect ranges[XRT_MAX_VIEWS];
+
+		/*!
+		 * One bit per tile, row major, set if the tile only shows parts of
+		 * the source that are covered by the hidden area visibility mask.
+		 */
+		uint32_t hidden_tiles[XRT_MAX_VIEWS][RENDER_DISTORTION_TILE_WORDS];
 	} distortion;
 };
 
@@ -577,9 +741,37 @@ render_resources_init(struct render_resources *r,
 void
 render_resources_fini(struct render_resources *r);
 
+/*!
+ * Moves on to the next @ref render_frame_resources, used by the following
+ * @ref render_gfx_init or @ref render_compute_init calls. The caller must
+ * make sure that the GPU has completed the work last recorded with them, the
+ * same index is returned every @ref RENDER_MAX_FRAMES_IN_FLIGHT frames.
+ *
+ * @return Index of the frame resources now being recorded.
+ *
+ * @public @memberof render_resources
+ */
+uint32_t
+render_resources_next_frame(struct render_resources *r);
+
+/*!
+ * Forgets what all of the layer squasher descriptor sets were written with,
+ * must be called when any image view that may have been given to
+ * @ref render_compute_layers is destroyed. The sets themselves are only
+ * rewritten when next used, so in flight frames are not affected.
+ *
+ * @public @memberof render_resources
+ */
+void
+render_resources_invalidate_layer_descriptors(struct render_resources *r);
+
 /*!
  * Creates or recreates the compute distortion textures if necessary.
  *
+ * @param compact Store the lookups as 16 bit values, uses half the memory
+ *                bandwidth, falls back to floats if it isn't supported or
+ *                accurate enough for the device's distortion.
+ *
  * @see render_distortion_images_fini
  * @public @memberof render_resources
  */
@@ -587,7 +779,8 @@ bool
 render_distortion_images_ensure(struct render_resources *r,
                                 struct vk_bundle *vk,
                                 struct xrt_device *xdev,
-                                bool pre_rotate);
+                                bool pre_rotate,
+                                bool compact);
 
 /*!
  * Free distortion images.
@@ -599,8 +792,9 @@ void
 render_distortion_images_fini(struct render_resources *r);
 
 /*!
- * Returns the timestamps for when the latest GPU work started and stopped that
- * was submitted using @ref render_gfx or @ref render_compute cmd buf builders.
+ * Returns the timestamps for when the GPU work started and stopped that was
+ * last submitted with the frame resources at @p frame_index, using
+ * @ref render_gfx or @ref render_compute cmd buf builders.
  *
  * Returned in the same time domain as returned by @ref os_monotonic_get_ns .
  * Behaviour for this function is undefined if the GPU has not completed before
@@ -613,11 +807,15 @@ render_distortion_images_fini(struct render_resources *r);
  * @public @memberof render_resources
  */
 bool
-render_resources_get_timestamps(struct render_resources *r, uint64_t *out_gpu_start_ns, uint64_t *out_gpu_end_ns);
+render_resources_get_timestamps(struct render_resources *r,
+                                uint32_t frame_index,
+                                uint64_t *out_gpu_start_ns,
+                                uint64_t *out_gpu_end_ns);
 
 /*!
- * Returns the duration for the latest GPU work that was submitted using
- * @ref render_gfx or @ref render_compute cmd buf builders.
+ * Returns the duration for the GPU work that was last submitted with the frame
+ * resources at @p frame_index, using @ref render_gfx or @ref render_compute
+ * cmd buf builders.
  *
  * Behaviour for this function is undefined if the GPU has not completed before
  * calling this function, so make sure to call vkQueueWaitIdle or wait on the
@@ -626,7 +824,7 @@ render_resources_get_timestamps(struct render_resources *r, uint64_t *out_gpu_st
  * @public @memberof render_resources
  */
 bool
-render_resources_get_duration(struct render_resources *r, uint64_t *out_gpu_duration_ns);
+render_resources_get_duration(struct render_resources *r, uint32_t frame_index, uint64_t *out_gpu_duration_ns);
 
 
 /*
@@ -730,6 +928,10 @@ struct render_gfx_render_pass
 		VkPipeline pipeline_timewarp;
 	} mesh;
 
+	/*!
+	 * Layer pipelines, the cylinder and equirect2 ones are rarely used and
+	 * are created on first use, so they may be @p VK_NULL_HANDLE.
+	 */
 	struct
 	{
 		VkPipeline cylinder_premultiplied_alpha;
@@ -849,11 +1051,23 @@ struct render_gfx
 	//! Resources that we are based on.
 	struct render_resources *r;
 
+	//! Resources of the frame being recorded, from @p r.
+	struct render_frame_resources *frame;
+
 	//! Shared buffer that we sub-allocate UBOs from.
 	struct render_sub_alloc_tracker ubo_tracker;
 
 	//! The current target we are rendering to, can change during command building.
 	struct render_gfx_target_resources *rtr;
+
+	/*!
+	 * Pipeline last bound in the current target, used to skip binding the
+	 * same pipeline again for each view and layer. Reset on begin target.
+	 */
+	VkPipeline bound_pipeline;
+
+	//! Have the mesh vertex and index buffers been bound in the current target.
+	bool mesh_buffers_bound;
 };
 
 /*!
@@ -968,6 +1182,29 @@ struct render_gfx_layer_quad_data
 	struct xrt_matrix_4x4 mvp;
 };
 
+/*!
+ * What a layer draw binds, written by the layer alloc and write functions.
+ * Either a descriptor set allocated from the frame's pool, or with
+ * VK_KHR_push_descriptor the UBO and source that are pushed into the command
+ * buffer when the layer is drawn.
+ *
+ * @see render_resources::gfx::layer::shared::push_descriptors
+ */
+struct render_gfx_layer_descriptor
+{
+	//! Only used when not pushing descriptors.
+	VkDescriptorSet descriptor_set;
+
+	//! The UBO sub-allocation, only used when pushing.
+	VkBuffer ubo_buffer;
+	VkDeviceSize ubo_offset;
+	VkDeviceSize ubo_size;
+
+	//! The source image, only used when pushing.
+	VkSampler src_sampler;
+	VkImageView src_image_view;
+};
+
 /*!
  * @name Preparation functions - first stage
  * @{
@@ -991,7 +1228,7 @@ render_gfx_mesh_alloc_and_write(struct render_gfx *render,
                                 VkDescriptorSet *out_descriptor_set);
 
 /*!
- * Allocate and write a UBO and descriptor_set to be used for cylinder layer
+ * Allocate and write a UBO and descriptor to be used for cylinder layer
  * rendering, the content of @p data need to be valid at the time of the call.
  *
  * @public @memberof render_gfx
@@ -1001,10 +1238,10 @@ render_gfx_layer_cylinder_alloc_and_write(struct render_gfx *render,
                                           const struct render_gfx_layer_cylinder_data *data,
                                           VkSampler src_sampler,
                                           VkImageView src_image_view,
-                                          VkDescriptorSet *out_descriptor_set);
+                                          struct render_gfx_layer_descriptor *out_descriptor);
 
 /*!
- * Allocate and write a UBO and descriptor_set to be used for equirect2 layer
+ * Allocate and write a UBO and descriptor to be used for equirect2 layer
  * rendering, the content of @p data need to be valid at the time of the call.
  *
  * @public @memberof render_gfx
@@ -1014,10 +1251,10 @@ render_gfx_layer_equirect2_alloc_and_write(struct render_gfx *render,
                                            const struct render_gfx_layer_equirect2_data *data,
                                            VkSampler src_sampler,
                                            VkImageView src_image_view,
-                                           VkDescriptorSet *out_descriptor_set);
+                                           struct render_gfx_layer_descriptor *out_descriptor);
 
 /*!
- * Allocate and write a UBO and descriptor_set to be used for projection layer
+ * Allocate and write a UBO and descriptor to be used for projection layer
  * rendering, the content of @p data need to be valid at the time of the call.
  *
  * @public @memberof render_gfx
@@ -1027,10 +1264,10 @@ render_gfx_layer_projection_alloc_and_write(struct render_gfx *render,
                                             const struct render_gfx_layer_projection_data *data,
                                             VkSampler src_sampler,
                                             VkImageView src_image_view,
-                                            VkDescriptorSet *out_descriptor_set);
+                                            struct render_gfx_layer_descriptor *out_descriptor);
 
 /*!
- * Allocate and write a UBO and descriptor_set to be used for quad layer
+ * Allocate and write a UBO and descriptor to be used for quad layer
  * rendering, the content of @p data need to be valid at the time of the call.
  *
  * @public @memberof render_gfx
@@ -1040,7 +1277,7 @@ render_gfx_layer_quad_alloc_and_write(struct render_gfx *render,
                                       const struct render_gfx_layer_quad_data *data,
                                       VkSampler src_sampler,
                                       VkImageView src_image_view,
-                                      VkDescriptorSet *out_descriptor_set);
+                                      struct render_gfx_layer_descriptor *out_descriptor);
 
 
 /*!
@@ -1052,6 +1289,23 @@ render_gfx_layer_quad_alloc_and_write(struct render_gfx *render,
  * @{
  */
 
+/*!
+ * Start timing a pass with the GPU profiler, must be called outside of
+ * a target. The @p name must be a static string.
+ *
+ * @see vk_gpu_profiler_begin_scope
+ * @public @memberof render_gfx
+ */
+uint32_t
+render_gfx_begin_scope(struct render_gfx *render, const char *name);
+
+/*!
+ * @pre matching @ref render_gfx_begin_scope, outside of a target.
+ * @public @memberof render_gfx
+ */
+void
+render_gfx_end_scope(struct render_gfx *render, uint32_t scope);
+
 /*!
  * This function allocates everything to start a single rendering. This is the
  * first function you call when you start the drawiing stage, you follow up with a call
@@ -1091,7 +1345,7 @@ render_gfx_end_view(struct render_gfx *render);
  * mesh geometry, timewarp selectable via @p do_timewarp.
  *
  * Must have successfully called @ref render_gfx_mesh_alloc_and_write
- * before @ref render_gfx_begin_target to allocate @p descriptor_set and UBO.
+ * before @ref render_gfx_begin_target to allocate @p descriptor and UBO.
  *
  * @pre successful @ref render_gfx_mesh_alloc_and_write call, successful @ref render_gfx_begin_view call
  * @public @memberof render_gfx
@@ -1103,45 +1357,53 @@ render_gfx_mesh_draw(struct render_gfx *render, uint32_t mesh_index, VkDescripto
  * Dispatch a cylinder layer shader into the current target and view.
  *
  * Must have successfully called @ref render_gfx_layer_cylinder_alloc_and_write
- * before @ref render_gfx_begin_target to allocate @p descriptor_set and UBO.
+ * before @ref render_gfx_begin_target to allocate @p descriptor and UBO.
  *
  * @public @memberof render_gfx
  */
 void
-render_gfx_layer_cylinder(struct render_gfx *render, bool premultiplied_alpha, VkDescriptorSet descriptor_set);
+render_gfx_layer_cylinder(struct render_gfx *render,
+                          bool premultiplied_alpha,
+                          const struct render_gfx_layer_descriptor *descriptor);
 
 /*!
  * Dispatch a equirect2 layer shader into the current target and view.
  *
  * Must have successfully called @ref render_gfx_layer_equirect2_alloc_and_write
- * before @ref render_gfx_begin_target to allocate @p descriptor_set and UBO.
+ * before @ref render_gfx_begin_target to allocate @p descriptor and UBO.
  *
  * @public @memberof render_gfx
  */
 void
-render_gfx_layer_equirect2(struct render_gfx *render, bool premultiplied_alpha, VkDescriptorSet descriptor_set);
+render_gfx_layer_equirect2(struct render_gfx *render,
+                           bool premultiplied_alpha,
+                           const struct render_gfx_layer_descriptor *descriptor);
 
 /*!
  * Dispatch a projection layer shader into the current target and view.
  *
  * Must have successfully called @ref render_gfx_layer_projection_alloc_and_write
- * before @ref render_gfx_begin_target to allocate @p descriptor_set and UBO.
+ * before @ref render_gfx_begin_target to allocate @p descriptor and UBO.
  *
  * @public @memberof render_gfx
  */
 void
-render_gfx_layer_projection(struct render_gfx *render, bool premultiplied_alpha, VkDescriptorSet descriptor_set);
+render_gfx_layer_projection(struct render_gfx *render,
+                            bool premultiplied_alpha,
+                            const struct render_gfx_layer_descriptor *descriptor);
 
 /*!
  * Dispatch a quad layer shader into the current target and view.
  *
  * Must have successfully called @ref render_gfx_layer_quad_alloc_and_write
- * before @ref render_gfx_begin_target to allocate @p descriptor_set and UBO.
+ * before @ref render_gfx_begin_target to allocate @p descriptor and UBO.
  *
  * @public @memberof render_gfx
  */
 void
-render_gfx_layer_quad(struct render_gfx *render, bool premultiplied_alpha, VkDescriptorSet descriptor_set);
+render_gfx_layer_quad(struct render_gfx *render,
+                      bool premultiplied_alpha,
+                      const struct render_gfx_layer_descriptor *descriptor);
 
 /*!
  * @}
@@ -1167,8 +1429,8 @@ struct render_compute
 	//! Shared resources.
 	struct render_resources *r;
 
-	//! Layer descriptor set.
-	VkDescriptorSet layer_descriptor_sets[RENDER_MAX_LAYER_RUNS_SIZE];
+	//! Resources of the frame being recorded, from @p r.
+	struct render_frame_resources *frame;
 
 	/*!
 	 * Shared descriptor set, used for the clear and distortion shaders. It
@@ -1204,15 +1466,33 @@ struct render_compute_layer_ubo_data
 		uint32_t padding[3];
 	} layer_count;
 
+	/*!
+	 * std140 uvec4, if enabled each invocation covers 2x2 pixels, only
+	 * the ones touching @p foveal_rect are squashed at full rate. Must
+	 * match the foveated argument to @ref render_compute_layers.
+	 */
+	struct
+	{
+		uint32_t enabled;
+		uint32_t padding[3];
+	} foveation;
+
+	//! std140 ivec4, full rate part of the view, in pixels relative to the view.
+	struct render_viewport_data foveal_rect;
+
 	struct xrt_normalized_rect pre_transform;
 	struct xrt_normalized_rect post_transforms[RENDER_MAX_LAYERS];
 
-	//! std140 uvec2, corresponds to enum xrt_layer_type and unpremultiplied alpha.
+	/*!
+	 * std140 uvec4, corresponds to enum xrt_layer_type, unpremultiplied
+	 * alpha and if depth reprojection is done for the layer.
+	 */
 	struct
 	{
 		uint32_t val;
 		uint32_t unpremultiplied;
-		uint32_t padding[XRT_MAX_VIEWS];
+		uint32_t depth_reprojection;
+		uint32_t padding;
 	} layer_type[RENDER_MAX_LAYERS];
 
 	//! Which image/sampler(s) correspond to each layer.
@@ -1223,7 +1503,7 @@ struct render_compute_layer_ubo_data
 		uint32_t padding[XRT_MAX_VIEWS];
 	} images_samplers[RENDER_MAX_LAYERS];
 
-	//! Shared between cylinder and equirect2.
+	//! Shared between cylinder and equirect2, new to source view for depth reprojection.
 	struct xrt_matrix_4x4 mv_inverse[RENDER_MAX_LAYERS];
 
 
@@ -1255,9 +1535,18 @@ struct render_compute_layer_ubo_data
 	 * For projection layers
 	 */
 
-	//! Timewarp matrices
+	//! Timewarp matrices, only the source projection for depth reprojection.
 	struct xrt_matrix_4x4 transforms[RENDER_MAX_LAYERS];
 
+	//! For depth reprojection, turns depth values into distances.
+	struct
+	{
+		float min_depth;
+		float max_depth;
+		float inv_near_z;
+		float inv_far_z;
+	} depth_data[RENDER_MAX_LAYERS];
+
 
 	/*!
 	 * For quad layers
@@ -1282,6 +1571,12 @@ struct render_compute_layer_ubo_data
 		struct xrt_vec2 val;
 		float padding[XRT_MAX_VIEWS];
 	} quad_extent[RENDER_MAX_LAYERS];
+
+	/*!
+	 * std140 uvec4 array, one bit per packed layer for each bin that the
+	 * layer may touch, bins are stored row by row.
+	 */
+	uint32_t layer_bins[RENDER_LAYER_BINS * RENDER_LAYER_BINS][RENDER_LAYER_BIN_WORDS];
 };
 
 /*!
@@ -1295,6 +1590,71 @@ struct render_compute_distortion_ubo_data
 	struct xrt_normalized_rect pre_transforms[XRT_MAX_VIEWS];
 	struct xrt_normalized_rect post_transforms[XRT_MAX_VIEWS];
 	struct xrt_matrix_4x4 transforms[XRT_MAX_VIEWS];
+
+	//! Copy of @ref render_resources::distortion::ranges.
+	struct xrt_normalized_rect distortion_ranges[XRT_MAX_VIEWS];
+
+	//! std140 uvec4 array, copy of @ref render_resources::distortion::hidden_tiles.
+	uint32_t hidden_tiles[XRT_MAX_VIEWS][RENDER_DISTORTION_TILE_WORDS];
+
+	//! Number of quads in use, see @ref render_compute_distortion_quads.
+	struct
+	{
+		uint32_t value;
+		uint32_t padding[3];
+	} quad_count;
+
+	struct
+	{
+		uint32_t unpremultiplied;
+		uint32_t padding[3];
+	} quad_flags[RENDER_DISTORTION_MAX_QUADS];
+
+	struct xrt_normalized_rect quad_post_transforms[RENDER_DISTORTION_MAX_QUADS];
+
+	struct
+	{
+		struct xrt_vec2 val;
+		float padding[2];
+	} quad_extents[RENDER_DISTORTION_MAX_QUADS];
+
+	struct
+	{
+		struct xrt_vec3 val;
+		float padding;
+	} quad_positions[XRT_MAX_VIEWS][RENDER_DISTORTION_MAX_QUADS];
+
+	struct
+	{
+		struct xrt_vec3 val;
+		float padding;
+	} quad_normals[XRT_MAX_VIEWS][RENDER_DISTORTION_MAX_QUADS];
+
+	struct xrt_matrix_4x4 inverse_quad_transforms[XRT_MAX_VIEWS][RENDER_DISTORTION_MAX_QUADS];
+};
+
+/*!
+ * Quad layers that the compute distortion shaders sample and blend on top of
+ * the projection layer, lets the fast path be used with small overlays such
+ * as keyboards and notifications. Positions, normals and transforms are in
+ * the view space of each view.
+ *
+ * @relates render_compute
+ */
+struct render_compute_distortion_quads
+{
+	uint32_t count;
+
+	VkSampler samplers[RENDER_DISTORTION_MAX_QUADS];
+	VkImageView image_views[RENDER_DISTORTION_MAX_QUADS];
+
+	bool unpremultiplied[RENDER_DISTORTION_MAX_QUADS];
+	struct xrt_normalized_rect post_transforms[RENDER_DISTORTION_MAX_QUADS];
+	struct xrt_vec2 extents[RENDER_DISTORTION_MAX_QUADS];
+
+	struct xrt_vec3 positions[XRT_MAX_VIEWS][RENDER_DISTORTION_MAX_QUADS];
+	struct xrt_vec3 normals[XRT_MAX_VIEWS][RENDER_DISTORTION_MAX_QUADS];
+	struct xrt_matrix_4x4 inverse_transforms[XRT_MAX_VIEWS][RENDER_DISTORTION_MAX_QUADS];
 };
 
 /*!
@@ -1332,11 +1692,19 @@ bool
 render_compute_end(struct render_compute *render);
 
 /*!
- * Updates the given @p descriptor_set and dispatches the layer shader. Unlike
+ * Dispatches the layer shader, the descriptor set is taken from
+ * @ref render_frame_resources::layer_descriptors and only written if none
+ * of them already refers to the given images, target and @p ubo. Unlike
  * other dispatch functions below this function doesn't do any layer barriers
  * before or after dispatching, this is to allow the callee to batch any such
  * image transitions.
  *
+ * Set @p projection_only if all layers are projection layers without depth
+ * reprojection, a pipeline specialized for that is used then.
+ *
+ * Set @p foveated if foveation is enabled in the UBO, a quarter of the
+ * invocations are dispatched then.
+ *
  * Expected layouts:
  * * Source images: VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
  * * Target image: VK_IMAGE_LAYOUT_GENERAL
@@ -1345,16 +1713,20 @@ render_compute_end(struct render_compute *render);
  */
 void
 render_compute_layers(struct render_compute *render,
-                      VkDescriptorSet descriptor_set,
                       VkBuffer ubo,
                       VkSampler src_samplers[RENDER_MAX_IMAGES_SIZE],
                       VkImageView src_image_views[RENDER_MAX_IMAGES_SIZE],
                       uint32_t num_srcs,
                       VkImageView target_image_view,
                       const struct render_viewport_data *view,
-                      bool timewarp);
+                      bool timewarp,
+                      bool projection_only,
+                      bool foveated);
 
 /*!
+ * Distorts the projection views to the target, blending any @p quads on top,
+ * which may be NULL.
+ *
  * @public @memberof render_compute
  */
 void
@@ -1365,11 +1737,15 @@ render_compute_projection_timewarp(struct render_compute *render,
                                    const struct xrt_pose src_poses[XRT_MAX_VIEWS],
                                    const struct xrt_fov src_fovs[XRT_MAX_VIEWS],
                                    const struct xrt_pose new_poses[XRT_MAX_VIEWS],
+                                   const struct render_compute_distortion_quads *quads,
                                    VkImage target_image,
                                    VkImageView target_image_view,
                                    const struct render_viewport_data views[XRT_MAX_VIEWS]);
 
 /*!
+ * Distorts the projection views to the target, blending any @p quads on top,
+ * which may be NULL.
+ *
  * @public @memberof render_compute
  */
 void
@@ -1377,6 +1753,7 @@ render_compute_projection(struct render_compute *render,
                           VkSampler src_samplers[XRT_MAX_VIEWS],
                           VkImageView src_image_views[XRT_MAX_VIEWS],
                           const struct xrt_normalized_rect src_rects[XRT_MAX_VIEWS],
+                          const struct render_compute_distortion_quads *quads,
                           VkImage target_image,
                           VkImageView target_image_view,
                           const struct render_viewport_data views[XRT_MAX_VIEWS]);
@@ -1,4 +1,4 @@
-// Copyright 2019-2023, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -32,6 +32,7 @@ XRT_CHECK_RESULT static VkResult
 create_gfx_ubo_and_src_descriptor_set_layout(struct vk_bundle *vk,
                                              uint32_t ubo_binding,
                                              uint32_t src_binding,
+                                             VkDescriptorSetLayoutCreateFlags flags,
                                              VkDescriptorSetLayout *out_descriptor_set_layout)
 {
 	VkResult ret;
@@ -53,6 +54,7 @@ create_gfx_ubo_and_src_descriptor_set_layout(struct vk_bundle *vk,
 
 	VkDescriptorSetLayoutCreateInfo set_layout_info = {
 	    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+	    .flags = flags,
 	    .bindingCount = ARRAY_SIZE(set_layout_bindings),
 	    .pBindings = set_layout_bindings,
 	};
@@ -237,11 +239,12 @@ create_compute_distortion_descriptor_set_layout(struct vk_bundle *vk,
                                                 uint32_t distortion_binding,
                                                 uint32_t target_binding,
                                                 uint32_t ubo_binding,
+                                                uint32_t quad_binding,
                                                 VkDescriptorSetLayout *out_descriptor_set_layout)
 {
 	VkResult ret;
 
-	VkDescriptorSetLayoutBinding set_layout_bindings[4] = {
+	VkDescriptorSetLayoutBinding set_layout_bindings[5] = {
 	    {
 	        .binding = src_binding,
 	        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
@@ -266,6 +269,12 @@ create_compute_distortion_descriptor_set_layout(struct vk_bundle *vk,
 	        .descriptorCount = 1,
 	        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
 	    },
+	    {
+	        .binding = quad_binding,
+	        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+	        .descriptorCount = RENDER_DISTORTION_MAX_QUADS,
+	        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+	    },
 	};
 
 	VkDescriptorSetLayoutCreateInfo set_layout_info = {
@@ -293,12 +302,14 @@ struct compute_layer_params
 	VkBool32 do_color_correction;
 	uint32_t max_layers;
 	uint32_t image_array_size;
+	VkBool32 projection_only;
 };
 
 struct compute_distortion_params
 {
 	uint32_t distortion_texel_count;
 	VkBool32 do_timewarp;
+	VkBool32 do_quads;
 };
 
 XRT_CHECK_RESULT static VkResult
@@ -321,6 +332,7 @@ create_compute_layer_pipeline(struct vk_bundle *vk,
 	    ENTRY(2, do_color_correction), //
 	    ENTRY(3, max_layers),          //
 	    ENTRY(4, image_array_size),    //
+	    ENTRY(5, projection_only),     //
 	};
 #undef ENTRY
 
@@ -355,9 +367,10 @@ create_compute_distortion_pipeline(struct vk_bundle *vk,
 	    sizeof(params->FIELD),                                                                                     \
 	}
 
-	VkSpecializationMapEntry entries[2] = {
+	VkSpecializationMapEntry entries[3] = {
 	    ENTRY(0, distortion_texel_count),
 	    ENTRY(1, do_timewarp),
+	    ENTRY(2, do_quads),
 	};
 #undef ENTRY
 
@@ -541,6 +554,7 @@ render_resources_init(struct render_resources *r,
 	r->compute.distortion_binding = 1;
 	r->compute.target_binding = 2;
 	r->compute.ubo_binding = 3;
+	r->compute.quad_binding = 4;
 
 	r->compute.layer.image_array_size =
 	    MIN(vk->features.max_per_stage_descriptor_sampled_images, RENDER_MAX_IMAGES_COUNT(r));
@@ -598,10 +612,14 @@ render_resources_init(struct render_resources *r,
 	    .queueFamilyIndex = vk->main_queue.family_index,
 	};
 
-	ret = vk->vkCreateCommandPool(vk->device, &command_pool_info, NULL, &r->cmd_pool);
-	VK_CHK_WITH_RET(ret, "vkCreateCommandPool", false);
+	for (uint32_t i = 0; i < RENDER_MAX_FRAMES_IN_FLIGHT; i++) {
+		struct render_frame_resources *frame = &r->frames[i];
 
-	VK_NAME_COMMAND_POOL(vk, r->cmd_pool, "render_resources command pool");
+		ret = vk->vkCreateCommandPool(vk->device, &command_pool_info, NULL, &frame->cmd_pool);
+		VK_CHK_WITH_RET(ret, "vkCreateCommandPool", false);
+
+		VK_NAME_COMMAND_POOL(vk, frame->cmd_pool, "render_resources command pool");
+	}
 
 
 	/*
@@ -645,8 +663,11 @@ render_resources_init(struct render_resources *r,
 		VK_NAME_IMAGE_VIEW(vk, r->mock.color.image_view, "render_resources mock color image view");
 
 
+		// Only done once at init, any of the frames' pools will do.
+		VkCommandPool cmd_pool = r->frames[0].cmd_pool;
+
 		VkCommandBuffer cmd = VK_NULL_HANDLE;
-		ret = vk_cmd_create_and_begin_cmd_buffer_locked(vk, r->cmd_pool, 0, &cmd);
+		ret = vk_cmd_create_and_begin_cmd_buffer_locked(vk, cmd_pool, 0, &cmd);
 		VK_CHK_WITH_RET(ret, "vk_cmd_create_and_begin_cmd_buffer_locked", false);
 
 		VK_NAME_COMMAND_BUFFER(vk, cmd, "render_resources mock command buffer");
@@ -657,7 +678,7 @@ render_resources_init(struct render_resources *r,
 		    r->mock.color.image);        // dst
 		VK_CHK_WITH_RET(ret, "prepare_mock_image_locked", false);
 
-		ret = vk_cmd_end_submit_wait_and_free_cmd_buffer_locked(vk, &vk->main_queue, r->cmd_pool, cmd);
+		ret = vk_cmd_end_submit_wait_and_free_cmd_buffer_locked(vk, &vk->main_queue, cmd_pool, cmd);
 		VK_CHK_WITH_RET(ret, "vk_cmd_end_submit_wait_and_free_cmd_buffer_locked", false);
 
 		// No need to wait, submit waits on the fence.
@@ -668,25 +689,32 @@ render_resources_init(struct render_resources *r,
 	 * Shared
 	 */
 
-	ret = vk_create_pipeline_cache(vk, &r->pipeline_cache);
-	VK_CHK_WITH_RET(ret, "vk_create_pipeline_cache", false);
+	ret = vk_create_pipeline_cache_from_disk(vk, &r->pipeline_cache);
+	VK_CHK_WITH_RET(ret, "vk_create_pipeline_cache_from_disk", false);
 
 	VK_NAME_PIPELINE_CACHE(vk, r->pipeline_cache, "render_resources pipeline cache");
 
-	VkCommandBufferAllocateInfo cmd_buffer_info = {
-	    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-	    .commandPool = r->cmd_pool,
-	    .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-	    .commandBufferCount = 1,
-	};
+	for (uint32_t i = 0; i < RENDER_MAX_FRAMES_IN_FLIGHT; i++) {
+		struct render_frame_resources *frame = &r->frames[i];
+
+		VkCommandBufferAllocateInfo cmd_buffer_info = {
+		    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+		    .commandPool = frame->cmd_pool,
+		    .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+		    .commandBufferCount = 1,
+		};
 
-	ret = vk->vkAllocateCommandBuffers( //
-	    vk->device,                     // device
-	    &cmd_buffer_info,               // pAllocateInfo
-	    &r->cmd);                       // pCommandBuffers
-	VK_CHK_WITH_RET(ret, "vkAllocateCommandBuffers", false);
+		ret = vk->vkAllocateCommandBuffers( //
+		    vk->device,                     // device
+		    &cmd_buffer_info,               // pAllocateInfo
+		    &frame->cmd);                   // pCommandBuffers
+		VK_CHK_WITH_RET(ret, "vkAllocateCommandBuffers", false);
 
-	VK_NAME_COMMAND_BUFFER(vk, r->cmd, "render_resources command buffer");
+		VK_NAME_COMMAND_BUFFER(vk, frame->cmd, "render_resources command buffer");
+	}
+
+	// The first call to render_resources_next_frame starts at zero.
+	r->frame_index = RENDER_MAX_FRAMES_IN_FLIGHT - 1;
 
 
 	/*
@@ -709,14 +737,18 @@ render_resources_init(struct render_resources *r,
 		    .freeable = false,
 		};
 
-		ret = vk_create_descriptor_pool(          //
-		    vk,                                   // vk_bundle
-		    &mesh_pool_info,                      // info
-		    &r->gfx.ubo_and_src_descriptor_pool); // out_descriptor_pool
-		VK_CHK_WITH_RET(ret, "vk_create_descriptor_pool", false);
+		for (uint32_t i = 0; i < RENDER_MAX_FRAMES_IN_FLIGHT; i++) {
+			struct render_frame_resources *frame = &r->frames[i];
+
+			ret = vk_create_descriptor_pool(  //
+			    vk,                           // vk_bundle
+			    &mesh_pool_info,              // info
+			    &frame->gfx_descriptor_pool); // out_descriptor_pool
+			VK_CHK_WITH_RET(ret, "vk_create_descriptor_pool", false);
 
-		VK_NAME_DESCRIPTOR_POOL(vk, r->gfx.ubo_and_src_descriptor_pool,
-		                        "render_resources ubo and src descriptor pool");
+			VK_NAME_DESCRIPTOR_POOL(vk, frame->gfx_descriptor_pool,
+			                        "render_resources ubo and src descriptor pool");
+		}
 
 		VkBufferUsageFlags usage_flags = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 		VkMemoryPropertyFlags memory_property_flags = //
@@ -734,8 +766,9 @@ render_resources_init(struct render_resources *r,
 		// We currently use the aligmnent as max UBO size.
 		static_assert(sizeof(struct render_gfx_mesh_ubo_data) <= RENDER_ALWAYS_SAFE_UBO_ALIGNMENT, "MAX");
 
-		// Calculate size.
-		VkDeviceSize size = buffer_count * RENDER_ALWAYS_SAFE_UBO_ALIGNMENT;
+		// Calculate size, one region per frame.
+		r->gfx.shared_ubo_frame_size = buffer_count * RENDER_ALWAYS_SAFE_UBO_ALIGNMENT;
+		VkDeviceSize size = r->gfx.shared_ubo_frame_size * RENDER_MAX_FRAMES_IN_FLIGHT;
 
 		ret = render_buffer_init(  //
 		    vk,                    // vk_bundle
@@ -757,10 +790,20 @@ render_resources_init(struct render_resources *r,
 	 * Gfx layer.
 	 */
 
+	// Layers are pushed straight into the command buffer when possible.
+	VkDescriptorSetLayoutCreateFlags layer_set_layout_flags = 0;
+#ifdef VK_KHR_push_descriptor
+	if (vk->has_KHR_push_descriptor) {
+		layer_set_layout_flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+		r->gfx.layer.shared.push_descriptors = true;
+	}
+#endif
+
 	ret = create_gfx_ubo_and_src_descriptor_set_layout( //
 	    vk,                                             // vk_bundle
 	    RENDER_BINDING_LAYER_SHARED_UBO,                // ubo_binding
 	    RENDER_BINDING_LAYER_SHARED_SRC,                // src_binding
+	    layer_set_layout_flags,                         // flags
 	    &r->gfx.layer.shared.descriptor_set_layout);    // out_descriptor_set_layout
 	VK_CHK_WITH_RET(ret, "create_gfx_ubo_and_src_descriptor_set_layout", false);
 
@@ -785,6 +828,7 @@ render_resources_init(struct render_resources *r,
 	    vk,                                             // vk_bundle
 	    r->mesh.ubo_binding,                            // ubo_binding
 	    r->mesh.src_binding,                            // src_binding
+	    0,                                              // flags
 	    &r->mesh.descriptor_set_layout);                // out_mesh_descriptor_set_layout
 	VK_CHK_WITH_RET(ret, "create_gfx_ubo_and_src_descriptor_set_layout", false);
 
@@ -827,27 +871,31 @@ render_resources_init(struct render_resources *r,
 	VkMemoryPropertyFlags memory_property_flags =
 	    VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
 
-	const uint32_t compute_descriptor_count = //
-	    1 +                                   // Shared/distortion run(s).
-	    RENDER_MAX_LAYER_RUNS_COUNT(r);       // Layer shader run(s).
+	// Shared/distortion run(s), layer runs use the cached sets below.
+	const uint32_t compute_descriptor_count = 1;
 
 	struct vk_descriptor_pool_info compute_pool_info = {
 	    .uniform_per_descriptor_count = 1,
 	    // layer images
-	    .sampler_per_descriptor_count = r->compute.layer.image_array_size + RENDER_DISTORTION_IMAGES_COUNT(r),
+	    .sampler_per_descriptor_count =
+	        r->compute.layer.image_array_size + RENDER_DISTORTION_IMAGES_COUNT(r) + RENDER_DISTORTION_MAX_QUADS,
 	    .storage_image_per_descriptor_count = 1,
 	    .storage_buffer_per_descriptor_count = 0,
 	    .descriptor_count = compute_descriptor_count,
 	    .freeable = false,
 	};
 
-	ret = vk_create_descriptor_pool(  //
-	    vk,                           // vk_bundle
-	    &compute_pool_info,           // info
-	    &r->compute.descriptor_pool); // out_descriptor_pool
-	VK_CHK_WITH_RET(ret, "vk_create_descriptor_pool", false);
+	for (uint32_t i = 0; i < RENDER_MAX_FRAMES_IN_FLIGHT; i++) {
+		struct render_frame_resources *frame = &r->frames[i];
 
-	VK_NAME_DESCRIPTOR_POOL(vk, r->compute.descriptor_pool, "render_resources compute descriptor pool");
+		ret = vk_create_descriptor_pool(      //
+		    vk,                               // vk_bundle
+		    &compute_pool_info,               // info
+		    &frame->compute_descriptor_pool); // out_descriptor_pool
+		VK_CHK_WITH_RET(ret, "vk_create_descriptor_pool", false);
+
+		VK_NAME_DESCRIPTOR_POOL(vk, frame->compute_descriptor_pool, "render_resources compute descriptor pool");
+	}
 
 	/*
 	 * Layer pipeline
@@ -865,6 +913,44 @@ render_resources_init(struct render_resources *r,
 	VK_NAME_DESCRIPTOR_SET_LAYOUT(vk, r->compute.layer.descriptor_set_layout,
 	                              "render_resources compute layer descriptor set layout");
 
+	struct vk_descriptor_pool_info layer_pool_info = {
+	    .uniform_per_descriptor_count = 1,
+	    .sampler_per_descriptor_count = r->compute.layer.image_array_size,
+	    .storage_image_per_descriptor_count = 1,
+	    .storage_buffer_per_descriptor_count = 0,
+	    .descriptor_count = RENDER_LAYER_DESCRIPTOR_CACHE_SIZE,
+	    .freeable = false,
+	};
+
+	for (uint32_t i = 0; i < RENDER_MAX_FRAMES_IN_FLIGHT; i++) {
+		struct render_frame_resources *frame = &r->frames[i];
+
+		ret = vk_create_descriptor_pool(            //
+		    vk,                                     // vk_bundle
+		    &layer_pool_info,                       // info
+		    &frame->compute_layer_descriptor_pool); // out_descriptor_pool
+		VK_CHK_WITH_RET(ret, "vk_create_descriptor_pool", false);
+
+		VK_NAME_DESCRIPTOR_POOL(vk, frame->compute_layer_descriptor_pool,
+		                        "render_resources compute layer descriptor pool");
+
+		for (uint32_t k = 0; k < RENDER_LAYER_DESCRIPTOR_CACHE_SIZE; k++) {
+			struct render_compute_layer_descriptor *desc = &frame->layer_descriptors[k];
+
+			ret = vk_create_descriptor_set(             //
+			    vk,                                     // vk_bundle
+			    frame->compute_layer_descriptor_pool,   // descriptor_pool
+			    r->compute.layer.descriptor_set_layout, // descriptor_set_layout
+			    &desc->descriptor_set);                 // descriptor_set
+			VK_CHK_WITH_RET(ret, "vk_create_descriptor_set", false);
+
+			VK_NAME_DESCRIPTOR_SET(vk, desc->descriptor_set,
+			                       "render_resources compute layer descriptor set");
+
+			desc->valid = false;
+		}
+	}
+
 	ret = vk_create_pipeline_layout(            //
 	    vk,                                     // vk_bundle
 	    r->compute.layer.descriptor_set_layout, // descriptor_set_layout
@@ -910,22 +996,60 @@ render_resources_init(struct render_resources *r,
 
 	VK_NAME_PIPELINE(vk, r->compute.layer.timewarp_pipeline, "render_resources compute layer timewarp pipeline");
 
-	size_t layer_ubo_size = sizeof(struct render_compute_layer_ubo_data);
+	/*
+	 * The most common case for the layer squasher, only projection layers,
+	 * gets its own variants without the branching on the layer type.
+	 */
+	struct compute_layer_params layer_projection_params = layer_params;
+	layer_projection_params.projection_only = true;
 
-	for (uint32_t i = 0; i < r->view_count; i++) {
-		ret = render_buffer_init(      //
-		    vk,                        // vk_bundle
-		    &r->compute.layer.ubos[i], // buffer
-		    ubo_usage_flags,           // usage_flags
-		    memory_property_flags,     // memory_property_flags
-		    layer_ubo_size);           // size
-		VK_CHK_WITH_RET(ret, "render_buffer_init", false);
-		VK_NAME_BUFFER(vk, r->compute.layer.ubos[i].buffer, "render_resources compute layer ubo");
+	ret = create_compute_layer_pipeline(        //
+	    vk,                                     // vk_bundle
+	    r->pipeline_cache,                      // pipeline_cache
+	    r->shaders->layer_comp,                 // shader
+	    r->compute.layer.pipeline_layout,       // pipeline_layout
+	    &layer_projection_params,               // params
+	    &r->compute.layer.projection_pipeline); // out_compute_pipeline
+	VK_CHK_WITH_RET(ret, "create_compute_layer_pipeline", false);
 
-		ret = render_buffer_map(        //
-		    vk,                         // vk_bundle
-		    &r->compute.layer.ubos[i]); // buffer
-		VK_CHK_WITH_RET(ret, "render_buffer_map", false);
+	VK_NAME_PIPELINE(vk, r->compute.layer.projection_pipeline,
+	                 "render_resources compute layer projection pipeline");
+
+	struct compute_layer_params layer_projection_timewarp_params = layer_timewarp_params;
+	layer_projection_timewarp_params.projection_only = true;
+
+	ret = create_compute_layer_pipeline(                 //
+	    vk,                                              // vk_bundle
+	    r->pipeline_cache,                               // pipeline_cache
+	    r->shaders->layer_comp,                          // shader
+	    r->compute.layer.pipeline_layout,                // pipeline_layout
+	    &layer_projection_timewarp_params,               // params
+	    &r->compute.layer.projection_timewarp_pipeline); // out_compute_pipeline
+	VK_CHK_WITH_RET(ret, "create_compute_layer_pipeline", false);
+
+	VK_NAME_PIPELINE(vk, r->compute.layer.projection_timewarp_pipeline,
+	                 "render_resources compute layer projection timewarp pipeline");
+
+	size_t layer_ubo_size = sizeof(struct render_compute_layer_ubo_data);
+
+	for (uint32_t f = 0; f < RENDER_MAX_FRAMES_IN_FLIGHT; f++) {
+		struct render_frame_resources *frame = &r->frames[f];
+
+		for (uint32_t i = 0; i < r->view_count; i++) {
+			ret = render_buffer_init(          //
+			    vk,                            // vk_bundle
+			    &frame->compute_layer_ubos[i], // buffer
+			    ubo_usage_flags,               // usage_flags
+			    memory_property_flags,         // memory_property_flags
+			    layer_ubo_size);               // size
+			VK_CHK_WITH_RET(ret, "render_buffer_init", false);
+			VK_NAME_BUFFER(vk, frame->compute_layer_ubos[i].buffer, "render_resources compute layer ubo");
+
+			ret = render_buffer_map(            //
+			    vk,                             // vk_bundle
+			    &frame->compute_layer_ubos[i]); // buffer
+			VK_CHK_WITH_RET(ret, "render_buffer_map", false);
+		}
 	}
 
 
@@ -939,6 +1063,7 @@ render_resources_init(struct render_resources *r,
 	    r->compute.distortion_binding,                     // distortion_binding,
 	    r->compute.target_binding,                         // target_binding,
 	    r->compute.ubo_binding,                            // ubo_binding,
+	    r->compute.quad_binding,                           // quad_binding,
 	    &r->compute.distortion.descriptor_set_layout);     // out_descriptor_set_layout
 	VK_CHK_WITH_RET(ret, "create_compute_distortion_descriptor_set_layout", false);
 
@@ -987,20 +1112,55 @@ render_resources_init(struct render_resources *r,
 	VK_NAME_PIPELINE(vk, r->compute.distortion.timewarp_pipeline,
 	                 "render_resources compute distortion timewarp pipeline");
 
+	// Quads on the fast path are less common, keep them out of the above.
+	struct compute_distortion_params distortion_quads_params = distortion_params;
+	distortion_quads_params.do_quads = true;
+
+	ret = create_compute_distortion_pipeline(   //
+	    vk,                                     // vk_bundle
+	    r->pipeline_cache,                      // pipeline_cache
+	    r->shaders->distortion_comp,            // shader
+	    r->compute.distortion.pipeline_layout,  // pipeline_layout
+	    &distortion_quads_params,               // params
+	    &r->compute.distortion.quads_pipeline); // out_compute_pipeline
+	VK_CHK_WITH_RET(ret, "create_compute_distortion_pipeline", false);
+
+	VK_NAME_PIPELINE(vk, r->compute.distortion.quads_pipeline,
+	                 "render_resources compute distortion quads pipeline");
+
+	struct compute_distortion_params distortion_quads_timewarp_params = distortion_timewarp_params;
+	distortion_quads_timewarp_params.do_quads = true;
+
+	ret = create_compute_distortion_pipeline(            //
+	    vk,                                              // vk_bundle
+	    r->pipeline_cache,                               // pipeline_cache
+	    r->shaders->distortion_comp,                     // shader
+	    r->compute.distortion.pipeline_layout,           // pipeline_layout
+	    &distortion_quads_timewarp_params,               // params
+	    &r->compute.distortion.quads_timewarp_pipeline); // out_compute_pipeline
+	VK_CHK_WITH_RET(ret, "create_compute_distortion_pipeline", false);
+
+	VK_NAME_PIPELINE(vk, r->compute.distortion.quads_timewarp_pipeline,
+	                 "render_resources compute distortion quads timewarp pipeline");
+
 	size_t distortion_ubo_size = sizeof(struct render_compute_distortion_ubo_data);
 
-	ret = render_buffer_init(       //
-	    vk,                         // vk_bundle
-	    &r->compute.distortion.ubo, // buffer
-	    ubo_usage_flags,            // usage_flags
-	    memory_property_flags,      // memory_property_flags
-	    distortion_ubo_size);       // size
-	VK_CHK_WITH_RET(ret, "render_buffer_init", false);
-	VK_NAME_BUFFER(vk, r->compute.distortion.ubo.buffer, "render_resources compute distortion ubo");
-	ret = render_buffer_map(         //
-	    vk,                          // vk_bundle
-	    &r->compute.distortion.ubo); // buffer
-	VK_CHK_WITH_RET(ret, "render_buffer_map", false);
+	for (uint32_t i = 0; i < RENDER_MAX_FRAMES_IN_FLIGHT; i++) {
+		struct render_frame_resources *frame = &r->frames[i];
+
+		ret = render_buffer_init(           //
+		    vk,                             // vk_bundle
+		    &frame->compute_distortion_ubo, // buffer
+		    ubo_usage_flags,                // usage_flags
+		    memory_property_flags,          // memory_property_flags
+		    distortion_ubo_size);           // size
+		VK_CHK_WITH_RET(ret, "render_buffer_init", false);
+		VK_NAME_BUFFER(vk, frame->compute_distortion_ubo.buffer, "render_resources compute distortion ubo");
+		ret = render_buffer_map(             //
+		    vk,                              // vk_bundle
+		    &frame->compute_distortion_ubo); // buffer
+		VK_CHK_WITH_RET(ret, "render_buffer_map", false);
+	}
 
 
 	/*
@@ -1020,19 +1180,23 @@ render_resources_init(struct render_resources *r,
 
 	size_t clear_ubo_size = sizeof(struct render_compute_distortion_ubo_data);
 
-	ret = render_buffer_init(  //
-	    vk,                    // vk_bundle
-	    &r->compute.clear.ubo, // buffer
-	    ubo_usage_flags,       // usage_flags
-	    memory_property_flags, // memory_property_flags
-	    clear_ubo_size);       // size
-	VK_CHK_WITH_RET(ret, "render_buffer_init", false);
-	VK_NAME_BUFFER(vk, r->compute.clear.ubo.buffer, "render_resources compute clear ubo");
+	for (uint32_t i = 0; i < RENDER_MAX_FRAMES_IN_FLIGHT; i++) {
+		struct render_frame_resources *frame = &r->frames[i];
 
-	ret = render_buffer_map(    //
-	    vk,                     // vk_bundle
-	    &r->compute.clear.ubo); // buffer
-	VK_CHK_WITH_RET(ret, "render_buffer_map", false);
+		ret = render_buffer_init(      //
+		    vk,                        // vk_bundle
+		    &frame->compute_clear_ubo, // buffer
+		    ubo_usage_flags,           // usage_flags
+		    memory_property_flags,     // memory_property_flags
+		    clear_ubo_size);           // size
+		VK_CHK_WITH_RET(ret, "render_buffer_init", false);
+		VK_NAME_BUFFER(vk, frame->compute_clear_ubo.buffer, "render_resources compute clear ubo");
+
+		ret = render_buffer_map(        //
+		    vk,                         // vk_bundle
+		    &frame->compute_clear_ubo); // buffer
+		VK_CHK_WITH_RET(ret, "render_buffer_map", false);
+	}
 
 
 	/*
@@ -1063,13 +1227,21 @@ render_resources_init(struct render_resources *r,
 	    .pipelineStatistics = 0, // Not used.
 	};
 
-	vk->vkCreateQueryPool( //
-	    vk->device,        // device
-	    &poolInfo,         // pCreateInfo
-	    NULL,              // pAllocator
-	    &r->query_pool);   // pQueryPool
+	for (uint32_t i = 0; i < RENDER_MAX_FRAMES_IN_FLIGHT; i++) {
+		struct render_frame_resources *frame = &r->frames[i];
 
-	VK_NAME_QUERY_POOL(vk, r->query_pool, "render_resources query pool");
+		vk->vkCreateQueryPool(   //
+		    vk->device,          // device
+		    &poolInfo,           // pCreateInfo
+		    NULL,                // pAllocator
+		    &frame->query_pool); // pQueryPool
+
+		VK_NAME_QUERY_POOL(vk, frame->query_pool, "render_resources query pool");
+	}
+
+	// Optional, disabled unless asked for.
+	ret = vk_gpu_profiler_init(vk, &r->profiler);
+	VK_CHK_WITH_RET(ret, "vk_gpu_profiler_init", false);
 
 	/*
 	 * Done
@@ -1100,55 +1272,100 @@ render_resources_fini(struct render_resources *r)
 	DF(Memory, r->mock.color.memory);
 
 	render_buffer_fini(vk, &r->gfx.shared_ubo);
-	D(DescriptorPool, r->gfx.ubo_and_src_descriptor_pool);
 
 	D(DescriptorSetLayout, r->gfx.layer.shared.descriptor_set_layout);
 	D(PipelineLayout, r->gfx.layer.shared.pipeline_layout);
 
 	D(DescriptorSetLayout, r->mesh.descriptor_set_layout);
 	D(PipelineLayout, r->mesh.pipeline_layout);
+
+	// All pipelines have been created by now, warm up the next start.
+	vk_store_pipeline_cache_to_disk(vk, r->pipeline_cache);
 	D(PipelineCache, r->pipeline_cache);
-	D(QueryPool, r->query_pool);
+	vk_gpu_profiler_fini(vk, &r->profiler);
 	render_buffer_fini(vk, &r->mesh.vbo);
 	render_buffer_fini(vk, &r->mesh.ibo);
 	for (uint32_t i = 0; i < r->view_count; ++i) {
 		render_buffer_fini(vk, &r->mesh.ubos[i]);
 	}
 
-	D(DescriptorPool, r->compute.descriptor_pool);
-
 	D(DescriptorSetLayout, r->compute.layer.descriptor_set_layout);
 	D(Pipeline, r->compute.layer.non_timewarp_pipeline);
 	D(Pipeline, r->compute.layer.timewarp_pipeline);
+	D(Pipeline, r->compute.layer.projection_pipeline);
+	D(Pipeline, r->compute.layer.projection_timewarp_pipeline);
 	D(PipelineLayout, r->compute.layer.pipeline_layout);
 
 	D(DescriptorSetLayout, r->compute.distortion.descriptor_set_layout);
 	D(Pipeline, r->compute.distortion.pipeline);
 	D(Pipeline, r->compute.distortion.timewarp_pipeline);
+	D(Pipeline, r->compute.distortion.quads_pipeline);
+	D(Pipeline, r->compute.distortion.quads_timewarp_pipeline);
 	D(PipelineLayout, r->compute.distortion.pipeline_layout);
 
 	D(Pipeline, r->compute.clear.pipeline);
 
 	render_distortion_images_fini(r);
-	render_buffer_fini(vk, &r->compute.clear.ubo);
-	for (uint32_t i = 0; i < r->view_count; i++) {
-		render_buffer_fini(vk, &r->compute.layer.ubos[i]);
+
+	for (uint32_t f = 0; f < RENDER_MAX_FRAMES_IN_FLIGHT; f++) {
+		struct render_frame_resources *frame = &r->frames[f];
+
+		render_buffer_fini(vk, &frame->compute_clear_ubo);
+		for (uint32_t i = 0; i < r->view_count; i++) {
+			render_buffer_fini(vk, &frame->compute_layer_ubos[i]);
+		}
+		render_buffer_fini(vk, &frame->compute_distortion_ubo);
+
+		D(DescriptorPool, frame->gfx_descriptor_pool);
+		D(DescriptorPool, frame->compute_descriptor_pool);
+
+		// Sets are reclaimed with the pool.
+		for (uint32_t k = 0; k < RENDER_LAYER_DESCRIPTOR_CACHE_SIZE; k++) {
+			U_ZERO(&frame->layer_descriptors[k]);
+		}
+		D(DescriptorPool, frame->compute_layer_descriptor_pool);
+		D(QueryPool, frame->query_pool);
+		D(CommandPool, frame->cmd_pool);
 	}
-	render_buffer_fini(vk, &r->compute.distortion.ubo);
 
 	vk_cmd_pool_destroy(vk, &r->distortion_pool);
-	D(CommandPool, r->cmd_pool);
 
 	// Finally forget about the vk bundle. We do not own it!
 	r->vk = NULL;
 }
 
+uint32_t
+render_resources_next_frame(struct render_resources *r)
+{
+	r->frame_index = (r->frame_index + 1) % RENDER_MAX_FRAMES_IN_FLIGHT;
+	r->frame_counter++;
+
+	return r->frame_index;
+}
+
+void
+render_resources_invalidate_layer_descriptors(struct render_resources *r)
+{
+	for (uint32_t f = 0; f < RENDER_MAX_FRAMES_IN_FLIGHT; f++) {
+		struct render_frame_resources *frame = &r->frames[f];
+
+		for (uint32_t k = 0; k < RENDER_LAYER_DESCRIPTOR_CACHE_SIZE; k++) {
+			frame->layer_descriptors[k].valid = false;
+		}
+	}
+}
+
 bool
-render_resources_get_timestamps(struct render_resources *r, uint64_t *out_gpu_start_ns, uint64_t *out_gpu_end_ns)
+render_resources_get_timestamps(struct render_resources *r,
+                                uint32_t frame_index,
+                                uint64_t *out_gpu_start_ns,
+                                uint64_t *out_gpu_end_ns)
 {
 	struct vk_bundle *vk = r->vk;
 	VkResult ret = VK_SUCCESS;
 
+	assert(frame_index < RENDER_MAX_FRAMES_IN_FLIGHT);
+
 	// Simple pre-check, needed by vk_convert_timestamps_to_host_ns.
 	if (!vk->has_EXT_calibrated_timestamps) {
 		return false;
@@ -1162,15 +1379,15 @@ render_resources_get_timestamps(struct render_resources *r, uint64_t *out_gpu_st
 	VkQueryResultFlags flags = VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT;
 	uint64_t timestamps[2] = {0};
 
-	vk->vkGetQueryPoolResults( //
-	    vk->device,            // device
-	    r->query_pool,         // queryPool
-	    0,                     // firstQuery
-	    2,                     // queryCount
-	    sizeof(uint64_t) * 2,  // dataSize
-	    timestamps,            // pData
-	    sizeof(uint64_t),      // stride
-	    flags);                // flags
+	vk->vkGetQueryPoolResults(             // //
+	    vk->device,                        // device
+	    r->frames[frame_index].query_pool, // queryPool
+	    0,                                 // firstQuery
+	    2,                                 // queryCount
+	    sizeof(uint64_t) * 2,              // dataSize
+	    timestamps,                        // pData
+	    sizeof(uint64_t),                  // stride
+	    flags);                            // flags
 
 
 	/*
@@ -1197,11 +1414,13 @@ render_resources_get_timestamps(struct render_resources *r, uint64_t *out_gpu_st
 }
 
 bool
-render_resources_get_duration(struct render_resources *r, uint64_t *out_gpu_duration_ns)
+render_resources_get_duration(struct render_resources *r, uint32_t frame_index, uint64_t *out_gpu_duration_ns)
 {
 	struct vk_bundle *vk = r->vk;
 	VkResult ret = VK_SUCCESS;
 
+	assert(frame_index < RENDER_MAX_FRAMES_IN_FLIGHT);
+
 	/*
 	 * Query how long things took.
 	 */
@@ -1209,15 +1428,15 @@ render_resources_get_duration(struct render_resources *r, uint64_t *out_gpu_dura
 	VkQueryResultFlags flags = VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT;
 	uint64_t timestamps[2] = {0};
 
-	ret = vk->vkGetQueryPoolResults( //
-	    vk->device,                  // device
-	    r->query_pool,               // queryPool
-	    0,                           // firstQuery
-	    2,                           // queryCount
-	    sizeof(uint64_t) * 2,        // dataSize
-	    timestamps,                  // pData
-	    sizeof(uint64_t),            // stride
-	    flags);                      // flags
+	ret = vk->vkGetQueryPoolResults(       //
+	    vk->device,                        // device
+	    r->frames[frame_index].query_pool, // queryPool
+	    0,                                 // firstQuery
+	    2,                                 // queryCount
+	    sizeof(uint64_t) * 2,              // dataSize
+	    timestamps,                        // pData
+	    sizeof(uint64_t),                  // stride
+	    flags);                            // flags
 
 	if (ret != VK_SUCCESS) {
 		return false;
@@ -34,6 +34,22 @@ render_sub_alloc_tracker_init(struct render_sub_alloc_tracker *rsat, struct rend
 	rsat->mapped = buffer->mapped;
 }
 
+void
+render_sub_alloc_tracker_init_region(struct render_sub_alloc_tracker *rsat,
+                                     struct render_buffer *buffer,
+                                     VkDeviceSize offset,
+                                     VkDeviceSize size)
+{
+	assert(offset + size <= buffer->size);
+	assert(align_padding_pot(offset, RENDER_ALWAYS_SAFE_UBO_ALIGNMENT) == offset);
+
+	// Offsets are from the start of the buffer, so start used at the region.
+	rsat->buffer = buffer->buffer;
+	rsat->used = offset;
+	rsat->total_size = offset + size;
+	rsat->mapped = buffer->mapped;
+}
+
 XRT_CHECK_RESULT VkResult
 render_sub_alloc_ubo_alloc_and_get_ptr(struct vk_bundle *vk,
                                        struct render_sub_alloc_tracker *rsat,
@@ -123,6 +123,35 @@ render_calc_time_warp_matrix(const struct xrt_pose *src_pose,
 	}
 }
 
+void
+render_calc_depth_reprojection_matrices(const struct xrt_pose *src_pose,
+                                        const struct xrt_fov *src_fov,
+                                        const struct xrt_pose *new_pose,
+                                        struct xrt_matrix_4x4 *out_projection,
+                                        struct xrt_matrix_4x4 *out_new_to_src)
+{
+	const struct xrt_vec3 one = {1, 1, 1};
+
+	// Src projection matrix.
+	struct xrt_matrix_4x4_f64 src_proj;
+	calc_projection(src_fov, &src_proj);
+
+	// Full poses this time, the translation is what gives the parallax.
+	struct xrt_matrix_4x4_f64 src_model, src_view, new_model;
+	m_mat4_f64_model(src_pose, &one, &src_model);
+	m_mat4_f64_invert(&src_model, &src_view); // Invert to make it a view matrix.
+	m_mat4_f64_model(new_pose, &one, &new_model);
+
+	struct xrt_matrix_4x4_f64 new_to_src;
+	m_mat4_f64_multiply(&src_view, &new_model, &new_to_src);
+
+	// Convert from f64 to f32.
+	for (int i = 0; i < 16; i++) {
+		out_projection->v[i] = (float)src_proj.v[i];
+		out_new_to_src->v[i] = (float)new_to_src.v[i];
+	}
+}
+
 void
 render_calc_uv_to_tangent_lengths_rect(const struct xrt_fov *fov, struct xrt_normalized_rect *out_rect)
 {
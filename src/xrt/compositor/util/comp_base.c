@@ -170,6 +170,13 @@ base_layer_equirect2(struct xrt_compositor *xc,
 	return comp_layer_accum_equirect2(&cb->layer_accum, xsc, data);
 }
 
+static xrt_result_t
+base_layer_passthrough(struct xrt_compositor *xc, struct xrt_device *xdev, const struct xrt_layer_data *data)
+{
+	struct comp_base *cb = comp_base(xc);
+	return comp_layer_accum_passthrough(&cb->layer_accum, data);
+}
+
 static xrt_result_t
 base_wait_frame(struct xrt_compositor *xc,
                 int64_t *out_frame_id,
@@ -229,6 +236,7 @@ comp_base_init(struct comp_base *cb)
 	iface->layer_cylinder = base_layer_cylinder;
 	iface->layer_equirect1 = base_layer_equirect1;
 	iface->layer_equirect2 = base_layer_equirect2;
+	iface->layer_passthrough = base_layer_passthrough;
 	iface->wait_frame = base_wait_frame;
 
 	u_threading_stack_init(&cb->cscs.destroy_swapchains);
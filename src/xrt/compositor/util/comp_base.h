@@ -28,7 +28,7 @@ extern "C" {
  */
 struct comp_frame_params
 {
-	//! Special case one layer projection/projection-depth fast-path.
+	//! Special case one layer projection/projection-depth fast-path, may have quads on top on compute.
 	bool one_projection_layer_fast_path;
 
 	//! fov as reported by device for the current submit.
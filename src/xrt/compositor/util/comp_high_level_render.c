@@ -12,6 +12,160 @@
  */
 
 #include "comp_high_level_render.h"
+#include "comp_swapchain.h"
+
+#include "math/m_mathinclude.h"
+
+#include <string.h>
+
+
+/*!
+ * How far the views may have moved since the layers were squashed for the
+ * result to still be reused, about a tenth of a degree and a millimeter.
+ */
+#define CACHE_MAX_ANGLE_RAD (0.00175f)
+#define CACHE_MAX_DISTANCE_M (0.001f)
+
+
+/*
+ *
+ * Cache helpers.
+ *
+ */
+
+static void
+snapshot_layer(const struct comp_layer *layer, struct chl_squash_cache_layer *out)
+{
+	// Zeroes padding too, the snapshots are compared with memcmp.
+	U_ZERO(out);
+
+	for (uint32_t i = 0; i < ARRAY_SIZE(layer->sc_array); i++) {
+		struct xrt_swapchain *xsc = layer->sc_array[i];
+		if (xsc == NULL) {
+			continue;
+		}
+
+		struct comp_swapchain *sc = comp_swapchain(xsc);
+
+		out->sc_array[i] = xsc;
+		out->ids[i] = sc->base.limited_unique_id;
+		out->release_counts[i] = xrt_atomic_s32_load_acquire(&sc->release_count);
+	}
+
+	memcpy(&out->data, &layer->data, sizeof(out->data));
+	out->data.timestamp = 0;
+}
+
+static bool
+pose_is_close(const struct xrt_pose *a, const struct xrt_pose *b)
+{
+	float dx = a->position.x - b->position.x;
+	float dy = a->position.y - b->position.y;
+	float dz = a->position.z - b->position.z;
+	if ((dx * dx + dy * dy + dz * dz) > (CACHE_MAX_DISTANCE_M * CACHE_MAX_DISTANCE_M)) {
+		return false;
+	}
+
+	const struct xrt_quat *qa = &a->orientation;
+	const struct xrt_quat *qb = &b->orientation;
+	float dot = fabsf(qa->x * qb->x + qa->y * qb->y + qa->z * qb->z + qa->w * qb->w);
+
+	// The angle between them is 2 * acos(dot).
+	return dot >= cosf(CACHE_MAX_ANGLE_RAD / 2.0f);
+}
+
+static bool
+cache_matches(const struct chl_frame_state *frame_state,
+              const struct comp_layer *layers,
+              uint32_t layer_count,
+              const struct xrt_pose world_poses[XRT_MAX_VIEWS],
+              const struct xrt_pose eye_poses[XRT_MAX_VIEWS],
+              const struct xrt_fov fovs[XRT_MAX_VIEWS])
+{
+	const struct chl_scratch *scratch = frame_state->scratch;
+	const struct chl_squash_cache *cache = &scratch->cache;
+
+	if (!cache->valid ||                                         //
+	    cache->view_count != frame_state->view_count ||          //
+	    cache->do_timewarp != frame_state->data.do_timewarp ||   //
+	    cache->do_foveation != frame_state->data.do_foveation || //
+	    cache->layer_count != layer_count) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < frame_state->view_count; i++) {
+		// Has anything been rendered to the images since.
+		if (scratch->views[i].cssi.indices.last != cache->views[i].index) {
+			return false;
+		}
+
+		if (memcmp(&cache->views[i].fov, &fovs[i], sizeof(fovs[i])) != 0 ||
+		    !pose_is_close(&cache->views[i].world_pose, &world_poses[i]) ||
+		    !pose_is_close(&cache->views[i].eye_pose, &eye_poses[i])) {
+			return false;
+		}
+
+		// Follows the eyes, so the sharp part of the image moves.
+		const struct xrt_normalized_rect *foveal_rect = &frame_state->data.views[i].foveal_rect;
+		if (frame_state->data.do_foveation &&
+		    memcmp(&cache->views[i].foveal_rect, foveal_rect, sizeof(*foveal_rect)) != 0) {
+			return false;
+		}
+	}
+
+	for (uint32_t i = 0; i < layer_count; i++) {
+		struct chl_squash_cache_layer snapshot;
+		snapshot_layer(&layers[i], &snapshot);
+
+		if (memcmp(&snapshot, &cache->layers[i], sizeof(snapshot)) != 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// The camera images change every frame without the layer data changing.
+static bool
+has_passthrough_layer(const struct comp_layer *layers, uint32_t layer_count)
+{
+	for (uint32_t i = 0; i < layer_count; i++) {
+		if (layers[i].data.type == XRT_LAYER_PASSTHROUGH) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void
+cache_record(struct chl_frame_state *frame_state,
+             const struct comp_layer *layers,
+             uint32_t layer_count,
+             const struct xrt_pose world_poses[XRT_MAX_VIEWS],
+             const struct xrt_pose eye_poses[XRT_MAX_VIEWS],
+             const struct xrt_fov fovs[XRT_MAX_VIEWS])
+{
+	struct chl_squash_cache *cache = &frame_state->scratch->cache;
+
+	for (uint32_t i = 0; i < frame_state->view_count; i++) {
+		cache->views[i].world_pose = world_poses[i];
+		cache->views[i].eye_pose = eye_poses[i];
+		cache->views[i].fov = fovs[i];
+		cache->views[i].foveal_rect = frame_state->data.views[i].foveal_rect;
+		cache->views[i].index = frame_state->scratch_state.views[i].index;
+	}
+
+	for (uint32_t i = 0; i < layer_count; i++) {
+		snapshot_layer(&layers[i], &cache->layers[i]);
+	}
+
+	cache->layer_count = layer_count;
+	cache->view_count = frame_state->view_count;
+	cache->do_timewarp = frame_state->data.do_timewarp;
+	cache->do_foveation = frame_state->data.do_foveation;
+	cache->valid = true;
+}
 
 
 /*
@@ -44,6 +198,44 @@ chl_frame_state_init(struct chl_frame_state *frame_state,
 	chl_scratch_state_init_and_get(&frame_state->scratch_state, scratch);
 }
 
+void
+chl_frame_state_use_cache(struct chl_frame_state *frame_state,
+                          const struct comp_layer *layers,
+                          uint32_t layer_count,
+                          const struct xrt_pose world_poses[XRT_MAX_VIEWS],
+                          const struct xrt_pose eye_poses[XRT_MAX_VIEWS],
+                          const struct xrt_fov fovs[XRT_MAX_VIEWS])
+{
+	struct chl_scratch *scratch = frame_state->scratch;
+	struct chl_squash_cache *cache = &scratch->cache;
+
+	// Nothing is squashed into the images this frame.
+	if (cache->disabled || frame_state->data.fast_path || layer_count == 0 || layer_count > XRT_MAX_LAYERS ||
+	    has_passthrough_layer(layers, layer_count)) {
+		cache->valid = false;
+		return;
+	}
+
+	if (!cache_matches(frame_state, layers, layer_count, world_poses, eye_poses, fovs)) {
+		// Will be squashed into the images gotten this frame.
+		cache_record(frame_state, layers, layer_count, world_poses, eye_poses, fovs);
+		return;
+	}
+
+	// Swap the newly gotten images for the ones already holding the layers.
+	for (uint32_t i = 0; i < frame_state->view_count; i++) {
+		struct comp_scratch_single_images *cssi = &scratch->views[i].cssi;
+
+		comp_scratch_single_images_discard(cssi);
+
+		XRT_MAYBE_UNUSED bool bret =
+		    comp_scratch_single_images_get_last(cssi, &frame_state->scratch_state.views[i].index);
+		assert(bret);
+	}
+
+	frame_state->data.squash_is_cached = true;
+}
+
 void
 chl_frame_state_fini(struct chl_frame_state *frame_state)
 {
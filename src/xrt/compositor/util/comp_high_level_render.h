@@ -70,6 +70,23 @@ chl_frame_state_init(struct chl_frame_state *frame_state,
                      bool fast_path,
                      struct chl_scratch *scratch);
 
+/*!
+ * Checks if the layers, views and scratch images are the same as when the
+ * layers were last squashed, and if so swaps in those scratch images and skips
+ * the squashing. The views may have moved slightly which is not corrected for.
+ * Otherwise records the layers and views, the layers will be squashed into the
+ * images gotten for this frame. Must be called before any _set_views call.
+ *
+ * @memberof chl_frame_state
+ */
+void
+chl_frame_state_use_cache(struct chl_frame_state *frame_state,
+                          const struct comp_layer *layers,
+                          uint32_t layer_count,
+                          const struct xrt_pose world_poses[XRT_MAX_VIEWS],
+                          const struct xrt_pose eye_poses[XRT_MAX_VIEWS],
+                          const struct xrt_fov fovs[XRT_MAX_VIEWS]);
+
 /*!
  * Frees all resources that this frame state tracks and manages the scratch
  * images state. Must be called after the GPU work has finished and has been
@@ -130,6 +147,14 @@ chl_frame_state_gfx_default_pipeline(struct chl_frame_state *frame_state,
                                      const struct render_viewport_data target_viewport_datas[XRT_MAX_VIEWS],
                                      const struct xrt_matrix_2x2 vertex_rots[XRT_MAX_VIEWS])
 {
+	chl_frame_state_use_cache( //
+	    frame_state,           //
+	    layers,                //
+	    layer_count,           //
+	    world_poses,           //
+	    eye_poses,             //
+	    fovs);                 //
+
 	chl_frame_state_gfx_set_views( //
 	    frame_state,               //
 	    world_poses,               //
@@ -207,6 +232,14 @@ chl_frame_state_cs_default_pipeline(struct chl_frame_state *frame_state,
                                     VkImageView target_storage_view,
                                     const struct render_viewport_data target_viewport_datas[XRT_MAX_VIEWS])
 {
+	chl_frame_state_use_cache( //
+	    frame_state,           //
+	    layers,                //
+	    layer_count,           //
+	    world_poses,           //
+	    eye_poses,             //
+	    fovs);                 //
+
 	chl_frame_state_cs_set_views( //
 	    frame_state,              //
 	    world_poses,              //
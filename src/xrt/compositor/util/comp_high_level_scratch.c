@@ -1,4 +1,4 @@
-// Copyright 2019-2024, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // Copyright 2024-2025, NVIDIA CORPORATION.
 // SPDX-License-Identifier: BSL-1.0
 /*!
@@ -130,6 +130,10 @@ chl_scratch_free_resources(struct chl_scratch *scratch, struct render_resources
 		comp_scratch_single_images_free(&scratch->views[i].cssi, vk);
 	}
 
+	// The images are gone, and their views might be in the layer descriptor sets.
+	chl_scratch_invalidate_cache(scratch);
+	render_resources_invalidate_layer_descriptors(rr);
+
 	// Nothing allocated.
 	scratch->view_count = 0;
 	scratch->extent.width = 0;
@@ -20,6 +20,64 @@
 extern "C" {
 #endif
 
+/*!
+ * A single layer as it was when squashed into the scratch images.
+ *
+ * @ingroup comp_util
+ */
+struct chl_squash_cache_layer
+{
+	//! Only compared, no reference is held.
+	struct xrt_swapchain *sc_array[XRT_MAX_VIEWS * 2];
+
+	//! In case a new swapchain ends up at the same address.
+	xrt_limited_unique_id_t ids[XRT_MAX_VIEWS * 2];
+
+	//! See @ref comp_swapchain::release_count.
+	int32_t release_counts[XRT_MAX_VIEWS * 2];
+
+	//! With the timestamp cleared, it changes every frame.
+	struct xrt_layer_data data;
+};
+
+/*!
+ * Tracks what was last squashed into the scratch images, so the squashing can
+ * be skipped when the layers are unchanged and the views have barely moved.
+ *
+ * @ingroup comp_util
+ */
+struct chl_squash_cache
+{
+	struct chl_squash_cache_layer layers[XRT_MAX_LAYERS];
+
+	uint32_t layer_count;
+
+	struct
+	{
+		struct xrt_pose world_pose;
+		struct xrt_pose eye_pose;
+		struct xrt_fov fov;
+
+		//! Only compared if @p do_foveation is set.
+		struct xrt_normalized_rect foveal_rect;
+
+		//! Scratch image index the layers were squashed into.
+		uint32_t index;
+	} views[XRT_MAX_VIEWS];
+
+	uint32_t view_count;
+
+	bool do_timewarp;
+
+	bool do_foveation;
+
+	//! Does this hold anything.
+	bool valid;
+
+	//! Toggled from the debug UI.
+	bool disabled;
+};
+
 /*!
  * Scratch images that can be used for staging buffers.
  *
@@ -53,6 +111,9 @@ struct chl_scratch
 
 	//! Has the render pass been initialized.
 	bool render_pass_initialized;
+
+	//! What the last done images hold, see @ref chl_frame_state_use_cache.
+	struct chl_squash_cache cache;
 };
 
 /*!
@@ -93,6 +154,18 @@ chl_scratch_ensure(struct chl_scratch *scratch,
 void
 chl_scratch_free_resources(struct chl_scratch *scratch, struct render_resources *rr);
 
+/*!
+ * Forget what has been squashed into the scratch images, must be called by
+ * anything other than the renderer that writes to them or changes their layout.
+ *
+ * @memberof chl_scratch
+ */
+static inline void
+chl_scratch_invalidate_cache(struct chl_scratch *scratch)
+{
+	scratch->cache.valid = false;
+}
+
 /*!
  * Get the image, see @ref comp_scratch_single_images_get_image.
  *
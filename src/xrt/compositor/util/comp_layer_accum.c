@@ -11,10 +11,18 @@
  */
 
 #include "comp_layer_accum.h"
+#include "math/m_api.h"
+#include "math/m_mathinclude.h"
 #include "util/u_misc.h"
 #include "xrt/xrt_compositor.h"
 #include "xrt/xrt_limits.h"
 
+/*!
+ * Slack in meters for the frustum test, the view-space origin is between the
+ * eyes while the views sit roughly half an IPD to either side of it.
+ */
+#define CULL_FRUSTUM_MARGIN_M (0.05f)
+
 // Shared implementation of accumulating a layer with only a single swapchain image.
 static xrt_result_t
 push_single_swapchain_layer(struct comp_layer_accum *cla, struct xrt_swapchain *xsc, const struct xrt_layer_data *data)
@@ -127,3 +135,235 @@ comp_layer_accum_equirect2(struct comp_layer_accum *cla, struct xrt_swapchain *x
 {
 	return push_single_swapchain_layer(cla, xsc, data);
 }
+
+xrt_result_t
+comp_layer_accum_passthrough(struct comp_layer_accum *cla, const struct xrt_layer_data *data)
+{
+	return push_single_swapchain_layer(cla, NULL, data);
+}
+
+
+/*
+ *
+ * Culling helpers.
+ *
+ */
+
+static bool
+fov_covers(const struct xrt_fov *layer_fov, const struct xrt_fov *target_fov)
+{
+	return layer_fov->angle_left <= target_fov->angle_left &&   //
+	       layer_fov->angle_right >= target_fov->angle_right && //
+	       layer_fov->angle_up >= target_fov->angle_up &&       //
+	       layer_fov->angle_down <= target_fov->angle_down;     //
+}
+
+// Does this layer replace everything below it in all of the target views.
+static bool
+is_opaque_full_view(const struct xrt_layer_data *data, const struct xrt_fov *fovs, uint32_t view_count)
+{
+	if (data->type != XRT_LAYER_PROJECTION && data->type != XRT_LAYER_PROJECTION_DEPTH) {
+		return false;
+	}
+
+	const enum xrt_layer_composition_flags not_opaque = XRT_LAYER_COMPOSITION_BLEND_TEXTURE_SOURCE_ALPHA_BIT | //
+	                                                    XRT_LAYER_COMPOSITION_ADVANCED_BLENDING_BIT;
+	if ((data->flags & not_opaque) != 0) {
+		return false;
+	}
+
+	// Alpha is one before scale and bias are applied.
+	if ((data->flags & XRT_LAYER_COMPOSITION_COLOR_BIAS_SCALE) != 0 &&
+	    (data->color_scale.a + data->color_bias.a) < 1.0f) {
+		return false;
+	}
+
+	if (data->view_count < view_count) {
+		return false;
+	}
+
+	// Same layout for both projection types.
+	const struct xrt_layer_projection_view_data *v =
+	    data->type == XRT_LAYER_PROJECTION ? data->proj.v : data->depth.v;
+
+	for (uint32_t i = 0; i < view_count; i++) {
+		if (!fov_covers(&v[i].fov, &fovs[i])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static float
+max_biased(float scale, float bias)
+{
+	// Largest value of `x * scale + bias` for x in [0, 1].
+	return fmaxf(bias, scale + bias);
+}
+
+// Scaled to zero alpha, and blended so that it doesn't add anything.
+static bool
+is_transparent(const struct xrt_layer_data *data)
+{
+	const enum xrt_layer_composition_flags needed = XRT_LAYER_COMPOSITION_BLEND_TEXTURE_SOURCE_ALPHA_BIT | //
+	                                                XRT_LAYER_COMPOSITION_COLOR_BIAS_SCALE;
+	if ((data->flags & needed) != needed || (data->flags & XRT_LAYER_COMPOSITION_ADVANCED_BLENDING_BIT) != 0) {
+		return false;
+	}
+
+	const struct xrt_colour_rgba_f32 *s = &data->color_scale;
+	const struct xrt_colour_rgba_f32 *b = &data->color_bias;
+
+	if (max_biased(s->a, b->a) > 0.0f) {
+		return false;
+	}
+
+	if ((data->flags & XRT_LAYER_COMPOSITION_UNPREMULTIPLIED_ALPHA_BIT) != 0) {
+		return true;
+	}
+
+	// Premultiplied colour is added even with zero alpha.
+	return max_biased(s->r, b->r) <= 0.0f && //
+	       max_biased(s->g, b->g) <= 0.0f && //
+	       max_biased(s->b, b->b) <= 0.0f;   //
+}
+
+static bool
+is_not_visible(const struct xrt_layer_data *data)
+{
+	enum xrt_layer_eye_visibility visibility = XRT_LAYER_EYE_VISIBILITY_BOTH;
+
+	switch (data->type) {
+	case XRT_LAYER_QUAD:
+		if (data->quad.size.x <= 0.0f || data->quad.size.y <= 0.0f) {
+			return true;
+		}
+		visibility = data->quad.visibility;
+		break;
+	case XRT_LAYER_CUBE: visibility = data->cube.visibility; break;
+	case XRT_LAYER_CYLINDER: visibility = data->cylinder.visibility; break;
+	case XRT_LAYER_EQUIRECT1: visibility = data->equirect1.visibility; break;
+	case XRT_LAYER_EQUIRECT2: visibility = data->equirect2.visibility; break;
+	case XRT_LAYER_PASSTHROUGH: return data->passthrough.xrt_pt.paused || data->passthrough.xrt_pl.paused;
+	default: break;
+	}
+
+	return visibility == XRT_LAYER_EYE_VISIBILITY_NONE;
+}
+
+// Are all of the points on the outside of the plane through the origin.
+static bool
+all_outside_plane(const struct xrt_vec3 corners[4], struct xrt_vec3 normal)
+{
+	float len = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+
+	for (uint32_t i = 0; i < 4; i++) {
+		float d = (corners[i].x * normal.x + corners[i].y * normal.y + corners[i].z * normal.z) / len;
+		if (d > -CULL_FRUSTUM_MARGIN_M) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*!
+ * Only view-space quads are tested, everything else would need the predicted
+ * head pose which is not known until the renderer runs.
+ */
+static bool
+is_outside_frustum(const struct xrt_layer_data *data, const struct xrt_fov *fovs, uint32_t view_count)
+{
+	if (data->type != XRT_LAYER_QUAD || (data->flags & XRT_LAYER_COMPOSITION_VIEW_SPACE_BIT) == 0) {
+		return false;
+	}
+
+	float hw = data->quad.size.x / 2.0f;
+	float hh = data->quad.size.y / 2.0f;
+	struct xrt_vec3 corners[4] = {
+	    {-hw, -hh, 0.0f},
+	    {hw, -hh, 0.0f},
+	    {-hw, hh, 0.0f},
+	    {hw, hh, 0.0f},
+	};
+
+	for (uint32_t i = 0; i < 4; i++) {
+		struct xrt_vec3 local = corners[i];
+		math_pose_transform_point(&data->quad.pose, &local, &corners[i]);
+	}
+
+	// Behind the viewer.
+	if (all_outside_plane(corners, (struct xrt_vec3){0.0f, 0.0f, -1.0f})) {
+		return true;
+	}
+
+	for (uint32_t i = 0; i < view_count; i++) {
+		const struct xrt_fov *fov = &fovs[i];
+
+		// Inward facing normals of the four side planes, -Z is forward.
+		const struct xrt_vec3 normals[4] = {
+		    {1.0f, 0.0f, tanf(fov->angle_left)},
+		    {-1.0f, 0.0f, -tanf(fov->angle_right)},
+		    {0.0f, 1.0f, tanf(fov->angle_down)},
+		    {0.0f, -1.0f, -tanf(fov->angle_up)},
+		};
+
+		bool outside = false;
+		for (uint32_t k = 0; k < 4 && !outside; k++) {
+			outside = all_outside_plane(corners, normals[k]);
+		}
+
+		// Visible in at least one view.
+		if (!outside) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/*
+ *
+ * Culling.
+ *
+ */
+
+uint32_t
+comp_layer_accum_cull(struct comp_layer_accum *cla, const struct xrt_fov fovs[XRT_MAX_VIEWS], uint32_t view_count)
+{
+	uint32_t first = 0;
+	bool depth_test = false;
+
+	for (uint32_t i = 0; i < cla->layer_count; i++) {
+		depth_test |= (cla->layers[i].data.flags & XRT_LAYER_COMPOSITION_DEPTH_TEST) != 0;
+	}
+
+	// Depth tested layers may depend on depth written by the layers below.
+	for (uint32_t i = cla->layer_count; i > 0 && !depth_test; i--) {
+		if (is_opaque_full_view(&cla->layers[i - 1].data, fovs, view_count)) {
+			first = i - 1;
+			break;
+		}
+	}
+
+	uint32_t count = 0;
+	for (uint32_t i = first; i < cla->layer_count; i++) {
+		const struct xrt_layer_data *data = &cla->layers[i].data;
+
+		if (is_not_visible(data) || is_transparent(data) || is_outside_frustum(data, fovs, view_count)) {
+			continue;
+		}
+
+		if (count != i) {
+			cla->layers[count] = cla->layers[i];
+		}
+		count++;
+	}
+
+	uint32_t culled = cla->layer_count - count;
+	cla->layer_count = count;
+
+	return culled;
+}
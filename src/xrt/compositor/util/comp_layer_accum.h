@@ -170,6 +170,37 @@ comp_layer_accum_equirect1(struct comp_layer_accum *cla, struct xrt_swapchain *x
 xrt_result_t
 comp_layer_accum_equirect2(struct comp_layer_accum *cla, struct xrt_swapchain *xsc, const struct xrt_layer_data *data);
 
+/*!
+ * Accumulate data for a passthrough layer for a frame, it has no swapchains.
+ *
+ * @public @memberof comp_layer_accum
+ */
+xrt_result_t
+comp_layer_accum_passthrough(struct comp_layer_accum *cla, const struct xrt_layer_data *data);
+
+
+/*!
+ * Remove layers that can not contribute to the final image, call after the
+ * last layer has been accumulated and before the layers are rendered.
+ *
+ * - Everything below the top-most projection layer that is opaque and whose
+ *   field of view covers all of @p fovs, it replaces what is below it.
+ * - Layers scaled to zero alpha, and layers not visible in any eye.
+ * - View-space quads fully outside of the frusta given by @p fovs.
+ *
+ * Nothing is removed due to occlusion if any layer uses depth testing. The
+ * order of the remaining layers is kept.
+ *
+ * @param cla        self
+ * @param fovs       The field of view of each view that is rendered.
+ * @param view_count Number of views in @p fovs.
+ *
+ * @return Number of layers removed.
+ *
+ * @public @memberof comp_layer_accum
+ */
+uint32_t
+comp_layer_accum_cull(struct comp_layer_accum *cla, const struct xrt_fov fovs[XRT_MAX_VIEWS], uint32_t view_count);
 
 /*!
  * Get a (color) swapchain associated with a layer.
@@ -57,6 +57,30 @@ struct render_gfx_target_resources;
  * @{
  */
 
+/*!
+ * The camera image used by passthrough layers for a single view, only used by
+ * the CS path.
+ *
+ * @ingroup comp_render
+ */
+struct comp_render_passthrough_data
+{
+	//! Is there a camera image, passthrough layers are skipped if not.
+	bool valid;
+
+	//! Camera image for sampling, the colour is in the rgb channels.
+	VkImageView camera_view;
+
+	//! Undistortion map, rg is camera image uv and negative where invalid.
+	VkImageView map_view;
+
+	//! Tangent angles covered by @p map_view, as seen from the camera.
+	struct xrt_fov map_fov;
+
+	//! World pose of the camera when the image was captured.
+	struct xrt_pose world_pose;
+};
+
 /*!
  * The input data needed for a single view, shared between both GFX and CS
  * paths.
@@ -152,6 +176,16 @@ struct comp_render_view_data
 			struct xrt_matrix_2x2 vertex_rot;
 		} gfx;
 	} target; // When used as a destination.
+
+	//! Camera image for passthrough layers, not touched when adding the view.
+	struct comp_render_passthrough_data passthrough;
+
+	/*!
+	 * Part of the view squashed at full rate when
+	 * @ref comp_render_dispatch_data::do_foveation is set, in view uv.
+	 * Not touched when adding the view.
+	 */
+	struct xrt_normalized_rect foveal_rect;
 };
 
 /*!
@@ -176,6 +210,26 @@ struct comp_render_dispatch_data
 	//! Very often true, can be disabled for debugging.
 	bool do_timewarp;
 
+	/*!
+	 * Use the depth of projection layers to also reproject for the change
+	 * in position, only done by the compute layer squasher and needs
+	 * @ref do_timewarp. The fast path only does rotational timewarp.
+	 */
+	bool do_depth_reprojection;
+
+	/*!
+	 * Squash the views at a quarter of the rate outside of
+	 * @ref comp_render_view_data::foveal_rect, only done by the compute
+	 * layer squasher.
+	 */
+	bool do_foveation;
+
+	/*!
+	 * The squash images already holds the layers from an earlier frame,
+	 * only the distortion step is done. Ignored on the fast path.
+	 */
+	bool squash_is_cached;
+
 	struct
 	{
 		//! Has this struct been setup to use the target.
@@ -597,6 +651,12 @@ comp_render_cs_add_target_view(struct comp_render_dispatch_data *data,
  * @param target_image_view
  * @param target_view
  * @param do_timewarp
+ * @param do_depth_reprojection Reproject projection layers with depth using the
+ *                              position as well, needs @p do_timewarp.
+ * @param passthrough Camera image for passthrough layers, may be NULL.
+ * @param foveal_rect Part of the view squashed at full rate, in view uv, the
+ *                    rest is squashed at a quarter of the rate. NULL for all
+ *                    of it at full rate.
  */
 void
 comp_render_cs_layer(struct render_compute *render,
@@ -609,7 +669,10 @@ comp_render_cs_layer(struct render_compute *render,
                      const VkImage target_image,
                      const VkImageView target_image_view,
                      const struct render_viewport_data *target_view,
-                     bool do_timewarp);
+                     bool do_timewarp,
+                     bool do_depth_reprojection,
+                     const struct comp_render_passthrough_data *passthrough,
+                     const struct xrt_normalized_rect *foveal_rect);
 
 /*!
  * Dispatch the layer squasher, on any number of views.
@@ -1,4 +1,4 @@
-// Copyright 2019-2024, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // Copyright 2025, NVIDIA CORPORATION.
 // SPDX-License-Identifier: BSL-1.0
 /*!
@@ -195,6 +195,7 @@ do_cs_projection_layer(const struct comp_layer *layer,
                        VkImageView src_image_views[RENDER_MAX_IMAGES_SIZE],
                        struct render_compute_layer_ubo_data *ubo_data,
                        bool do_timewarp,
+                       bool do_depth_reprojection,
                        uint32_t *out_cur_image)
 {
 	const struct xrt_layer_data *layer_data = &layer->data;
@@ -233,8 +234,25 @@ do_cs_projection_layer(const struct comp_layer *layer,
 	    false,                                  // invert_flip
 	    &ubo_data->post_transforms[cur_layer]); // out_norm_rect
 
+	// Needs timewarp on and depth to work with.
+	bool depth_reprojection = do_timewarp && do_depth_reprojection && dvd != NULL;
+	ubo_data->layer_type[cur_layer].depth_reprojection = depth_reprojection;
+
 	// unused if timewarp is off
-	if (do_timewarp) {
+	if (depth_reprojection) {
+		render_calc_depth_reprojection_matrices( //
+		    &vd->pose,                           // src_pose
+		    &vd->fov,                            // src_fov
+		    world_pose,                          // new_pose
+		    &ubo_data->transforms[cur_layer],    // out_projection
+		    &ubo_data->mv_inverse[cur_layer]);   // out_new_to_src
+
+		// 1 / z is linear in depth, infinite near or far planes become zero.
+		ubo_data->depth_data[cur_layer].min_depth = dvd->min_depth;
+		ubo_data->depth_data[cur_layer].max_depth = dvd->max_depth;
+		ubo_data->depth_data[cur_layer].inv_near_z = 1.0f / dvd->near_z;
+		ubo_data->depth_data[cur_layer].inv_far_z = 1.0f / dvd->far_z;
+	} else if (do_timewarp) {
 		render_calc_time_warp_matrix(          //
 		    &vd->pose,                         //
 		    &vd->fov,                          //
@@ -245,6 +263,177 @@ do_cs_projection_layer(const struct comp_layer *layer,
 	*out_cur_image = cur_image;
 }
 
+/// Position, normal and inverse transform of a quad in view space.
+static inline void
+calc_quad_view_space(const struct xrt_layer_data *layer_data,
+                     const struct xrt_matrix_4x4 *view_mat,
+                     struct xrt_vec3 *out_position,
+                     struct xrt_vec3 *out_normal,
+                     struct xrt_matrix_4x4 *out_inverse_quad_transform)
+{
+	// Transform quad pose into view space.
+	struct xrt_vec3 quad_position = XRT_STRUCT_INIT;
+	math_matrix_4x4_transform_vec3(view_mat, &layer_data->quad.pose.position, &quad_position);
+
+	// neutral quad layer faces +z, towards the user
+	struct xrt_vec3 normal = (struct xrt_vec3){.x = 0, .y = 0, .z = 1};
+
+	// rotation of the quad normal in world space
+	struct xrt_quat rotation = layer_data->quad.pose.orientation;
+	math_quat_rotate_vec3(&rotation, &normal, &normal);
+
+	/*
+	 * normal is a vector that originates on the plane, not on the origin.
+	 * Instead of using the inverse quad transform to transform it into view space we can
+	 * simply add up vectors:
+	 *
+	 * combined_normal [in world space] = plane_origin [in world space] + normal [in plane
+	 * space] [with plane in world space]
+	 *
+	 * Then combined_normal can be transformed to view space via view matrix and a new
+	 * normal_view_space retrieved:
+	 *
+	 * normal_view_space = combined_normal [in view space] - plane_origin [in view space]
+	 */
+	struct xrt_vec3 normal_view_space = normal;
+	math_vec3_accum(&layer_data->quad.pose.position, &normal_view_space);
+	math_matrix_4x4_transform_vec3(view_mat, &normal_view_space, &normal_view_space);
+	math_vec3_subtract(&quad_position, &normal_view_space);
+
+	struct xrt_vec3 scale = {1.f, 1.f, 1.f};
+	struct xrt_matrix_4x4 plane_transform_view_space;
+	math_matrix_4x4_model(&layer_data->quad.pose, &scale, &plane_transform_view_space);
+	math_matrix_4x4_multiply(view_mat, &plane_transform_view_space, &plane_transform_view_space);
+	math_matrix_4x4_inverse(&plane_transform_view_space, out_inverse_quad_transform);
+
+	*out_position = quad_position;
+	*out_normal = normal_view_space;
+}
+
+/*!
+ * Get the bins that a quad may touch by projecting its corners into the view,
+ * returns false if it is fully behind the eye and touches none.
+ */
+static bool
+get_quad_bins(const struct xrt_layer_data *layer_data,
+              const struct xrt_matrix_4x4 *view_mat,
+              const struct xrt_normalized_rect *pre_transform,
+              uint32_t out_min[2],
+              uint32_t out_max[2])
+{
+	const struct xrt_vec2 half = {layer_data->quad.size.x / 2.f, layer_data->quad.size.y / 2.f};
+	const struct xrt_vec2 corners[4] = {{-half.x, -half.y}, {half.x, -half.y}, {-half.x, half.y}, {half.x, half.y}};
+
+	struct xrt_vec3 scale = {1.f, 1.f, 1.f};
+	struct xrt_matrix_4x4 model, model_view;
+	math_matrix_4x4_model(&layer_data->quad.pose, &scale, &model);
+	math_matrix_4x4_multiply(view_mat, &model, &model_view);
+
+	float min_uv[2] = {INFINITY, INFINITY};
+	float max_uv[2] = {-INFINITY, -INFINITY};
+	uint32_t behind = 0;
+
+	for (uint32_t i = 0; i < ARRAY_SIZE(corners); i++) {
+		struct xrt_vec3 corner = {corners[i].x, corners[i].y, 0.f};
+		math_matrix_4x4_transform_vec3(&model_view, &corner, &corner);
+
+		// Crosses the eye plane, could cover anything.
+		if (corner.z >= -0.0001f) {
+			behind++;
+			continue;
+		}
+
+		// Inverse of the uv to tangent transform in the shader, y is flipped.
+		float uv[2] = {
+		    (corner.x / -corner.z - pre_transform->x) / pre_transform->w,
+		    (corner.y / corner.z - pre_transform->y) / pre_transform->h,
+		};
+
+		for (uint32_t a = 0; a < 2; a++) {
+			min_uv[a] = fminf(min_uv[a], uv[a]);
+			max_uv[a] = fmaxf(max_uv[a], uv[a]);
+		}
+	}
+
+	if (behind == ARRAY_SIZE(corners)) {
+		return false;
+	}
+
+	for (uint32_t a = 0; a < 2; a++) {
+		if (behind > 0) {
+			min_uv[a] = 0.f;
+			max_uv[a] = 1.f;
+		}
+
+		// Outside of the view.
+		if (max_uv[a] < 0.f || min_uv[a] > 1.f) {
+			return false;
+		}
+
+		// Small margin so pixels right on a bin edge are never missed.
+		float min_bin = floorf((min_uv[a] - 0.001f) * RENDER_LAYER_BINS);
+		float max_bin = floorf((max_uv[a] + 0.001f) * RENDER_LAYER_BINS);
+		out_min[a] = (uint32_t)CLAMP(min_bin, 0.f, RENDER_LAYER_BINS - 1);
+		out_max[a] = (uint32_t)CLAMP(max_bin, 0.f, RENDER_LAYER_BINS - 1);
+	}
+
+	return true;
+}
+
+/*!
+ * Mark the bins of the view that the layer may touch, everything but quads is
+ * assumed to touch the whole view.
+ */
+static void
+bin_cs_layer(const struct xrt_layer_data *layer_data,
+             const struct xrt_matrix_4x4 *eye_view_mat,
+             const struct xrt_matrix_4x4 *world_view_mat,
+             uint32_t cur_layer,
+             struct render_compute_layer_ubo_data *ubo_data)
+{
+	uint32_t min[2] = {0, 0};
+	uint32_t max[2] = {RENDER_LAYER_BINS - 1, RENDER_LAYER_BINS - 1};
+
+	if (layer_data->type == XRT_LAYER_QUAD) {
+		// Is this layer viewspace or not.
+		const struct xrt_matrix_4x4 *view_mat = is_layer_view_space(layer_data) ? eye_view_mat : world_view_mat;
+
+		if (!get_quad_bins(layer_data, view_mat, &ubo_data->pre_transform, min, max)) {
+			return;
+		}
+	}
+
+	static_assert(RENDER_MAX_LAYERS <= RENDER_LAYER_BIN_WORDS * 32, "Layer bin mask too small");
+
+	uint32_t word = cur_layer / 32;
+	uint32_t bit = 1u << (cur_layer % 32);
+
+	for (uint32_t y = min[1]; y <= max[1]; y++) {
+		for (uint32_t x = min[0]; x <= max[0]; x++) {
+			ubo_data->layer_bins[y * RENDER_LAYER_BINS + x][word] |= bit;
+		}
+	}
+}
+
+/*!
+ * From view uv to pixels relative to the view, rounded out to whole pixels.
+ */
+static void
+calc_foveal_rect(const struct xrt_normalized_rect *foveal_rect,
+                 const struct render_viewport_data *view,
+                 struct render_viewport_data *out_rect)
+{
+	float min_x = CLAMP(foveal_rect->x, 0.f, 1.f) * (float)view->w;
+	float min_y = CLAMP(foveal_rect->y, 0.f, 1.f) * (float)view->h;
+	float max_x = CLAMP(foveal_rect->x + foveal_rect->w, 0.f, 1.f) * (float)view->w;
+	float max_y = CLAMP(foveal_rect->y + foveal_rect->h, 0.f, 1.f) * (float)view->h;
+
+	out_rect->x = (uint32_t)floorf(min_x);
+	out_rect->y = (uint32_t)floorf(min_y);
+	out_rect->w = (uint32_t)ceilf(max_x) - out_rect->x;
+	out_rect->h = (uint32_t)ceilf(max_y) - out_rect->y;
+}
+
 /// Data setup for a quad layer
 static inline void
 do_cs_quad_layer(const struct comp_layer *layer,
@@ -282,40 +471,9 @@ do_cs_quad_layer(const struct comp_layer *layer,
 	// Is this layer viewspace or not.
 	const struct xrt_matrix_4x4 *view_mat = is_layer_view_space(layer_data) ? eye_view_mat : world_view_mat;
 
-	// Transform quad pose into view space.
-	struct xrt_vec3 quad_position = XRT_STRUCT_INIT;
-	math_matrix_4x4_transform_vec3(view_mat, &layer_data->quad.pose.position, &quad_position);
-
-	// neutral quad layer faces +z, towards the user
-	struct xrt_vec3 normal = (struct xrt_vec3){.x = 0, .y = 0, .z = 1};
-
-	// rotation of the quad normal in world space
-	struct xrt_quat rotation = layer_data->quad.pose.orientation;
-	math_quat_rotate_vec3(&rotation, &normal, &normal);
-
-	/*
-	 * normal is a vector that originates on the plane, not on the origin.
-	 * Instead of using the inverse quad transform to transform it into view space we can
-	 * simply add up vectors:
-	 *
-	 * combined_normal [in world space] = plane_origin [in world space] + normal [in plane
-	 * space] [with plane in world space]
-	 *
-	 * Then combined_normal can be transformed to view space via view matrix and a new
-	 * normal_view_space retrieved:
-	 *
-	 * normal_view_space = combined_normal [in view space] - plane_origin [in view space]
-	 */
-	struct xrt_vec3 normal_view_space = normal;
-	math_vec3_accum(&layer_data->quad.pose.position, &normal_view_space);
-	math_matrix_4x4_transform_vec3(view_mat, &normal_view_space, &normal_view_space);
-	math_vec3_subtract(&quad_position, &normal_view_space);
-
-	struct xrt_vec3 scale = {1.f, 1.f, 1.f};
-	struct xrt_matrix_4x4 plane_transform_view_space, inverse_quad_transform;
-	math_matrix_4x4_model(&layer_data->quad.pose, &scale, &plane_transform_view_space);
-	math_matrix_4x4_multiply(view_mat, &plane_transform_view_space, &plane_transform_view_space);
-	math_matrix_4x4_inverse(&plane_transform_view_space, &inverse_quad_transform);
+	struct xrt_vec3 quad_position, normal_view_space;
+	struct xrt_matrix_4x4 inverse_quad_transform;
+	calc_quad_view_space(layer_data, view_mat, &quad_position, &normal_view_space, &inverse_quad_transform);
 
 	// Write all of the UBO data.
 	ubo_data->post_transforms[cur_layer] = post_transform;
@@ -329,6 +487,45 @@ do_cs_quad_layer(const struct comp_layer *layer,
 	*out_cur_image = cur_image;
 }
 
+/// Data setup for a passthrough layer
+static inline void
+do_cs_passthrough_layer(const struct comp_render_passthrough_data *passthrough,
+                        const struct xrt_pose *world_pose,
+                        uint32_t cur_layer,
+                        uint32_t cur_image,
+                        VkSampler clamp_to_edge,
+                        VkSampler clamp_to_border_black,
+                        VkSampler src_samplers[RENDER_MAX_IMAGES_SIZE],
+                        VkImageView src_image_views[RENDER_MAX_IMAGES_SIZE],
+                        struct render_compute_layer_ubo_data *ubo_data,
+                        uint32_t *out_cur_image)
+{
+	// Camera
+	src_samplers[cur_image] = clamp_to_border_black;
+	src_image_views[cur_image] = passthrough->camera_view;
+	ubo_data->images_samplers[cur_layer].images[0] = cur_image++;
+
+	// Undistortion map
+	src_samplers[cur_image] = clamp_to_edge;
+	src_image_views[cur_image] = passthrough->map_view;
+	ubo_data->images_samplers[cur_layer].images[1] = cur_image++;
+
+	ubo_data->post_transforms[cur_layer] = (struct xrt_normalized_rect){0.f, 0.f, 1.f, 1.f};
+
+	/*
+	 * Only the rotation between the camera and the view is corrected for,
+	 * treating everything as infinitely far away, so close objects are off
+	 * by the offset between the camera and the eyes.
+	 */
+	render_calc_time_warp_matrix(          //
+	    &passthrough->world_pose,          // src_pose
+	    &passthrough->map_fov,             // src_fov
+	    world_pose,                        // new_pose
+	    &ubo_data->transforms[cur_layer]); // matrix
+
+	*out_cur_image = cur_image;
+}
+
 static void
 crc_clear_output(struct render_compute *render, const struct comp_render_dispatch_data *d)
 {
@@ -397,16 +594,74 @@ crc_distortion_after_squash(struct render_compute *render, const struct comp_ren
 	    src_samplers,              //
 	    src_image_views,           //
 	    src_norm_rects,            //
+	    NULL,                      // quads
 	    d->target.cs.image,        //
 	    d->target.cs.storage_view, // target_image_view
 	    target_viewport_datas);    // views
 }
 
+/// The quad layers on top of the projection layer for the fast path
+static void
+crc_distortion_fast_path_quads(struct render_compute *render,
+                               const struct comp_render_dispatch_data *d,
+                               const struct comp_layer *layers,
+                               uint32_t layer_count,
+                               struct render_compute_distortion_quads *out_quads)
+{
+	VkSampler clamp_to_edge = render->r->samplers.clamp_to_edge;
+
+	// Not the transform of the views, but the inverse: actual view matrices.
+	struct xrt_matrix_4x4 world_view_mats[XRT_MAX_VIEWS], eye_view_mats[XRT_MAX_VIEWS];
+	for (uint32_t view = 0; view < d->target.view_count; view++) {
+		math_matrix_4x4_view_from_pose(&d->views[view].world_pose, &world_view_mats[view]);
+		math_matrix_4x4_view_from_pose(&d->views[view].eye_pose, &eye_view_mats[view]);
+	}
+
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < layer_count && count < RENDER_DISTORTION_MAX_QUADS; i++) {
+		const struct xrt_layer_data *data = &layers[i].data;
+		if (data->type != XRT_LAYER_QUAD) {
+			assert(false && "Only quads can be blended on the fast path");
+			continue;
+		}
+
+		const struct xrt_layer_quad_data *q = &data->quad;
+		const struct comp_swapchain_image *image = get_layer_image(&layers[i], 0, q->sub.image_index);
+
+		out_quads->samplers[count] = clamp_to_edge;
+		out_quads->image_views[count] = get_image_view(image, data->flags, q->sub.array_index);
+		out_quads->unpremultiplied[count] = is_layer_unpremultiplied(data);
+		out_quads->extents[count] = q->size;
+
+		// Used for Subimage and OpenGL flip.
+		set_post_transform_rect(                 //
+		    data,                                // data
+		    &q->sub.norm_rect,                   // src_norm_rect
+		    true,                                // invert_flip
+		    &out_quads->post_transforms[count]); // out_norm_rect
+
+		bool view_space = is_layer_view_space(data);
+		for (uint32_t view = 0; view < d->target.view_count; view++) {
+			calc_quad_view_space(                                           //
+			    data,                                                       //
+			    view_space ? &eye_view_mats[view] : &world_view_mats[view], //
+			    &out_quads->positions[view][count],                         //
+			    &out_quads->normals[view][count],                           //
+			    &out_quads->inverse_transforms[view][count]);               //
+		}
+
+		count++;
+	}
+
+	out_quads->count = count;
+}
+
 /// Fast path
 static void
 crc_distortion_fast_path(struct render_compute *render,
                          const struct comp_render_dispatch_data *d,
-                         const struct comp_layer *layer,
+                         const struct comp_layer *layers,
+                         uint32_t layer_count,
                          const struct xrt_layer_projection_view_data *vds[XRT_MAX_VIEWS])
 {
 	if (d->target.view_count > XRT_MAX_VIEWS) {
@@ -415,7 +670,8 @@ crc_distortion_fast_path(struct render_compute *render,
 		return;
 	}
 
-	// Fetch from this data.
+	// The projection layer is first, any quads on top follow it.
+	const struct comp_layer *layer = &layers[0];
 	const struct xrt_layer_data *data = &layer->data;
 
 	VkSampler clamp_to_border_black = render->r->samplers.clamp_to_border_black;
@@ -464,12 +720,17 @@ crc_distortion_fast_path(struct render_compute *render,
 		world_poses[i] = world_pose;
 	}
 
+	// Blended in the same dispatch instead of going through the squasher.
+	struct render_compute_distortion_quads quads = {0};
+	crc_distortion_fast_path_quads(render, d, layers + 1, layer_count - 1, &quads);
+
 	if (!d->do_timewarp) {
 		render_compute_projection(     //
 		    render,                    //
 		    src_samplers,              //
 		    src_image_views,           //
 		    src_norm_rects,            //
+		    &quads,                    //
 		    d->target.cs.image,        //
 		    d->target.cs.storage_view, //
 		    target_viewport_datas);    //
@@ -482,6 +743,7 @@ crc_distortion_fast_path(struct render_compute *render,
 		    src_poses,                      //
 		    src_fovs,                       //
 		    world_poses,                    //
+		    &quads,                         //
 		    d->target.cs.image,             //
 		    d->target.cs.storage_view,      //
 		    target_viewport_datas);         //
@@ -506,7 +768,10 @@ comp_render_cs_layer(struct render_compute *render,
                      const VkImage target_image,
                      const VkImageView target_image_view,
                      const struct render_viewport_data *target_view,
-                     bool do_timewarp)
+                     bool do_timewarp,
+                     bool do_depth_reprojection,
+                     const struct comp_render_passthrough_data *passthrough,
+                     const struct xrt_normalized_rect *foveal_rect)
 {
 	VkSampler clamp_to_edge = render->r->samplers.clamp_to_edge;
 	VkSampler clamp_to_border_black = render->r->samplers.clamp_to_border_black;
@@ -516,7 +781,7 @@ comp_render_cs_layer(struct render_compute *render,
 	math_matrix_4x4_view_from_pose(world_pose, &world_view_mat);
 	math_matrix_4x4_view_from_pose(eye_pose, &eye_view_mat);
 
-	struct render_buffer *ubo = &render->r->compute.layer.ubos[view_index];
+	struct render_buffer *ubo = &render->frame->compute_layer_ubos[view_index];
 	struct render_compute_layer_ubo_data *ubo_data = ubo->mapped;
 
 	// Tightly pack layers in data struct.
@@ -527,8 +792,18 @@ comp_render_cs_layer(struct render_compute *render,
 	VkSampler src_samplers[RENDER_MAX_IMAGES_SIZE];
 	VkImageView src_image_views[RENDER_MAX_IMAGES_SIZE];
 
+	// Selects the specialized pipeline for the common case.
+	bool projection_only = true;
+
 	ubo_data->view = *target_view;
 	ubo_data->pre_transform = *pre_transform;
+	U_ZERO_ARRAY(ubo_data->layer_bins);
+
+	bool foveated = foveal_rect != NULL;
+	ubo_data->foveation.enabled = foveated;
+	if (foveated) {
+		calc_foveal_rect(foveal_rect, target_view, &ubo_data->foveal_rect);
+	}
 
 	for (uint32_t c_layer_i = 0; c_layer_i < layer_count; c_layer_i++) {
 		const struct comp_layer *layer = &layers[c_layer_i];
@@ -552,6 +827,12 @@ comp_render_cs_layer(struct render_compute *render,
 		case XRT_LAYER_PROJECTION: required_image_samplers = 1; break;
 		case XRT_LAYER_PROJECTION_DEPTH: required_image_samplers = 2; break;
 		case XRT_LAYER_QUAD: required_image_samplers = 1; break;
+		case XRT_LAYER_PASSTHROUGH:
+			if (passthrough == NULL || !passthrough->valid) {
+				continue; // No camera image yet, nothing to show.
+			}
+			required_image_samplers = 2;
+			break;
 		default:
 			VK_ERROR(render->r->vk, "Skipping layer #%u, unknown type: %u", c_layer_i, data->type);
 			continue; // Skip this layer if don't know about it.
@@ -562,6 +843,9 @@ comp_render_cs_layer(struct render_compute *render,
 			break;
 		}
 
+		// Only turned on by projection layers with depth.
+		ubo_data->layer_type[cur_layer].depth_reprojection = false;
+
 		switch (data->type) {
 		case XRT_LAYER_CYLINDER:
 			do_cs_cylinder_layer(      //
@@ -607,6 +891,7 @@ comp_render_cs_layer(struct render_compute *render,
 			    src_image_views,       // src_image_views
 			    ubo_data,              // ubo_data
 			    do_timewarp,           // do_timewarp
+			    do_depth_reprojection, // do_depth_reprojection
 			    &cur_image);           // out_cur_image
 		} break;
 		case XRT_LAYER_QUAD: {
@@ -624,6 +909,19 @@ comp_render_cs_layer(struct render_compute *render,
 			    ubo_data,              // ubo_data
 			    &cur_image);           // out_cur_image
 		} break;
+		case XRT_LAYER_PASSTHROUGH:
+			do_cs_passthrough_layer(   //
+			    passthrough,           // passthrough
+			    world_pose,            // world_pose
+			    cur_layer,             // cur_layer
+			    cur_image,             // cur_image
+			    clamp_to_edge,         // clamp_to_edge
+			    clamp_to_border_black, // clamp_to_border_black
+			    src_samplers,          // src_samplers
+			    src_image_views,       // src_image_views
+			    ubo_data,              // ubo_data
+			    &cur_image);           // out_cur_image
+			break;
 		default:
 			// Should not get here!
 			assert(false);
@@ -634,6 +932,14 @@ comp_render_cs_layer(struct render_compute *render,
 		ubo_data->layer_type[cur_layer].val = data->type;
 		ubo_data->layer_type[cur_layer].unpremultiplied = is_layer_unpremultiplied(data);
 
+		bool is_projection = data->type == XRT_LAYER_PROJECTION || data->type == XRT_LAYER_PROJECTION_DEPTH;
+		if (!is_projection || ubo_data->layer_type[cur_layer].depth_reprojection) {
+			projection_only = false;
+		}
+
+		// So the shader can skip the layer where it can't contribute.
+		bin_cs_layer(data, &eye_view_mat, &world_view_mat, cur_layer, ubo_data);
+
 		// Finally okay to increment the current layer.
 		cur_layer++;
 	}
@@ -652,18 +958,17 @@ comp_render_cs_layer(struct render_compute *render,
 		cur_image++;
 	}
 
-	VkDescriptorSet descriptor_set = render->layer_descriptor_sets[view_index];
-
 	render_compute_layers( //
 	    render,            //
-	    descriptor_set,    //
 	    ubo->buffer,       //
 	    src_samplers,      //
 	    src_image_views,   //
 	    cur_image,         //
 	    target_image_view, //
 	    target_view,       //
-	    do_timewarp);      //
+	    do_timewarp,       //
+	    projection_only,   //
+	    foveated);         //
 }
 
 void
@@ -676,7 +981,7 @@ comp_render_cs_layers(struct render_compute *render,
 	cmd_barrier_view_squash_images(            //
 	    render->r->vk,                         //
 	    d,                                     //
-	    render->r->cmd,                        // cmd
+	    render->frame->cmd,                    // cmd
 	    0,                                     // src_access_mask
 	    VK_ACCESS_SHADER_WRITE_BIT,            // dst_access_mask
 	    VK_IMAGE_LAYOUT_UNDEFINED,             // transition_from
@@ -686,6 +991,7 @@ comp_render_cs_layers(struct render_compute *render,
 
 	for (uint32_t view_index = 0; view_index < d->squash_view_count; view_index++) {
 		const struct comp_render_view_data *view = &d->views[view_index];
+		const struct xrt_normalized_rect *foveal_rect = d->do_foveation ? &view->foveal_rect : NULL;
 
 		comp_render_cs_layer(             //
 		    render,                       //
@@ -698,13 +1004,16 @@ comp_render_cs_layers(struct render_compute *render,
 		    view->squash.image,           //
 		    view->squash.cs.storage_view, //
 		    &view->squash.viewport_data,  //
-		    d->do_timewarp);              //
+		    d->do_timewarp,               //
+		    d->do_depth_reprojection,     //
+		    &view->passthrough,           //
+		    foveal_rect);                 //
 	}
 
 	cmd_barrier_view_squash_images(            //
 	    render->r->vk,                         //
 	    d,                                     //
-	    render->r->cmd,                        // cmd
+	    render->frame->cmd,                    // cmd
 	    VK_ACCESS_SHADER_WRITE_BIT,            // src_access_mask
 	    VK_ACCESS_MEMORY_READ_BIT,             // dst_access_mask
 	    VK_IMAGE_LAYOUT_GENERAL,               // transition_from
@@ -747,7 +1056,8 @@ comp_render_cs_dispatch(struct render_compute *render,
 		crc_distortion_fast_path( //
 		    render,               //
 		    d,                    //
-		    layer,                //
+		    layers,               //
+		    layer_count,          //
 		    vds);                 //
 
 	} else if (fast_path && layer->data.type == XRT_LAYER_PROJECTION_DEPTH) {
@@ -760,7 +1070,8 @@ comp_render_cs_dispatch(struct render_compute *render,
 		crc_distortion_fast_path( //
 		    render,               //
 		    d,                    //
-		    layer,                //
+		    layers,               //
+		    layer_count,          //
 		    vds);                 //
 
 	} else if (layer_count > 0) {
@@ -770,14 +1081,17 @@ comp_render_cs_dispatch(struct render_compute *render,
 		}
 
 		/*
-		 * Layer squashing.
+		 * Layer squashing, unless already in the squash images from
+		 * an earlier frame, they are left in the transition_to layout.
 		 */
-		comp_render_cs_layers( //
-		    render,            //
-		    layers,            //
-		    layer_count,       //
-		    d,                 //
-		    transition_to);    //
+		if (!d->squash_is_cached) {
+			comp_render_cs_layers( //
+			    render,            //
+			    layers,            //
+			    layer_count,       //
+			    d,                 //
+			    transition_to);    //
+		}
 
 		/*
 		 * Distortion.
@@ -36,8 +36,8 @@
  */
 struct gfx_layer_view_state
 {
-	/// Filled out descriptor sets.
-	VkDescriptorSet descriptor_sets[RENDER_MAX_LAYERS];
+	/// Filled out descriptors.
+	struct render_gfx_layer_descriptor descriptors[RENDER_MAX_LAYERS];
 
 	/// The type of layer.
 	enum xrt_layer_type types[RENDER_MAX_LAYERS];
@@ -228,10 +228,12 @@ get_layer_image(const struct comp_layer *layer, uint32_t swapchain_index, uint32
 }
 
 static inline void
-add_layer(struct gfx_layer_view_state *state, const struct xrt_layer_data *data, VkDescriptorSet descriptor_set)
+add_layer(struct gfx_layer_view_state *state,
+          const struct xrt_layer_data *data,
+          const struct render_gfx_layer_descriptor *descriptor)
 {
 	uint32_t cur_layer = state->layer_count++;
-	state->descriptor_sets[cur_layer] = descriptor_set;
+	state->descriptors[cur_layer] = *descriptor;
 	state->types[cur_layer] = data->type;
 	state->premultiplied_alphas[cur_layer] = !is_layer_unpremultiplied(data);
 }
@@ -286,18 +288,18 @@ do_cylinder_layer(struct render_gfx *render,
 	}
 
 	// Can fail if we have too many layers.
-	VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+	struct render_gfx_layer_descriptor descriptor = {0};
 	ret = render_gfx_layer_cylinder_alloc_and_write( //
 	    render,                                      //
 	    &data,                                       //
 	    src_sampler,                                 //
 	    src_image_view,                              //
-	    &descriptor_set);                            // out_descriptor_set
+	    &descriptor);                                // out_descriptor
 	VK_CHK_AND_RET(ret, "render_gfx_layer_quad_alloc_and_write");
 
-	VK_NAME_DESCRIPTOR_SET(vk, descriptor_set, "render_gfx layer quad descriptor set");
+	VK_NAME_DESCRIPTOR_SET(vk, descriptor.descriptor_set, "render_gfx layer quad descriptor set");
 
-	add_layer(state, layer_data, descriptor_set);
+	add_layer(state, layer_data, &descriptor);
 
 	return VK_SUCCESS;
 }
@@ -352,18 +354,18 @@ do_equirect2_layer(struct render_gfx *render,
 	data.lower_vertical_angle = eq2->lower_vertical_angle;
 
 	// Can fail if we have too many layers.
-	VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+	struct render_gfx_layer_descriptor descriptor = {0};
 	ret = render_gfx_layer_equirect2_alloc_and_write( //
 	    render,                                       //
 	    &data,                                        //
 	    src_sampler,                                  //
 	    src_image_view,                               //
-	    &descriptor_set);                             // out_descriptor_set
+	    &descriptor);                                 // out_descriptor
 	VK_CHK_AND_RET(ret, "render_gfx_layer_quad_alloc_and_write");
 
-	VK_NAME_DESCRIPTOR_SET(vk, descriptor_set, "render_gfx layer quad descriptor set");
+	VK_NAME_DESCRIPTOR_SET(vk, descriptor.descriptor_set, "render_gfx layer quad descriptor set");
 
-	add_layer(state, layer_data, descriptor_set);
+	add_layer(state, layer_data, &descriptor);
 
 	return VK_SUCCESS;
 }
@@ -416,18 +418,18 @@ do_projection_layer(struct render_gfx *render,
 	calc_mvp_rot_only(state, layer_data, &vd->pose, &scale, &data.mvp);
 
 	// Can fail if we have too many layers.
-	VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+	struct render_gfx_layer_descriptor descriptor = {0};
 	ret = render_gfx_layer_projection_alloc_and_write( //
 	    render,                                        //
 	    &data,                                         //
 	    src_sampler,                                   //
 	    src_image_view,                                //
-	    &descriptor_set);                              // out_descriptor_set
+	    &descriptor);                                  // out_descriptor
 	VK_CHK_AND_RET(ret, "render_gfx_layer_projection_alloc_and_write");
 
-	VK_NAME_DESCRIPTOR_SET(vk, descriptor_set, "render_gfx layer proj descriptor set");
+	VK_NAME_DESCRIPTOR_SET(vk, descriptor.descriptor_set, "render_gfx layer proj descriptor set");
 
-	add_layer(state, layer_data, descriptor_set);
+	add_layer(state, layer_data, &descriptor);
 
 	return VK_SUCCESS;
 }
@@ -469,18 +471,18 @@ do_quad_layer(struct render_gfx *render,
 	calc_mvp_full(state, layer_data, &q->pose, &scale, &data.mvp);
 
 	// Can fail if we have too many layers.
-	VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+	struct render_gfx_layer_descriptor descriptor = {0};
 	ret = render_gfx_layer_quad_alloc_and_write( //
 	    render,                                  //
 	    &data,                                   //
 	    src_sampler,                             //
 	    src_image_view,                          //
-	    &descriptor_set);                        // out_descriptor_set
+	    &descriptor);                            // out_descriptor
 	VK_CHK_AND_RET(ret, "render_gfx_layer_quad_alloc_and_write");
 
-	VK_NAME_DESCRIPTOR_SET(vk, descriptor_set, "render_gfx layer quad descriptor set");
+	VK_NAME_DESCRIPTOR_SET(vk, descriptor.descriptor_set, "render_gfx layer quad descriptor set");
 
-	add_layer(state, layer_data, descriptor_set);
+	add_layer(state, layer_data, &descriptor);
 
 	return VK_SUCCESS;
 }
@@ -488,12 +490,16 @@ do_quad_layer(struct render_gfx *render,
 static void
 crg_clear_output(struct render_gfx *render, const struct comp_render_dispatch_data *d)
 {
+	uint32_t scope = render_gfx_begin_scope(render, "gfx clear");
+
 	render_gfx_begin_target(     //
 	    render,                  //
 	    d->target.gfx.rtr,       //
 	    &background_color_idle); //
 
 	render_gfx_end_target(render);
+
+	render_gfx_end_scope(render, scope);
 }
 
 /*
@@ -554,6 +560,8 @@ crg_distortion_common(struct render_gfx *render,
 	 * Do command writing here.
 	 */
 
+	uint32_t scope = render_gfx_begin_scope(render, "gfx distortion");
+
 	render_gfx_begin_target(       //
 	    render,                    //
 	    d->target.gfx.rtr,         //
@@ -579,6 +587,8 @@ crg_distortion_common(struct render_gfx *render,
 
 	render_gfx_end_target(render);
 
+	render_gfx_end_scope(render, scope);
+
 	return;
 
 err_no_memory:
@@ -805,6 +815,8 @@ comp_render_gfx_layers(struct render_gfx *render,
 
 	const VkClearColorValue *color = layer_count == 0 ? &background_color_idle : &background_color_active;
 
+	uint32_t scope = render_gfx_begin_scope(render, "gfx layers");
+
 	for (uint32_t view = 0; view < d->squash_view_count; view++) {
 
 		// Convenience.
@@ -829,26 +841,26 @@ comp_render_gfx_layers(struct render_gfx *render,
 				render_gfx_layer_cylinder(          //
 				    render,                         //
 				    state->premultiplied_alphas[i], //
-				    state->descriptor_sets[i]);     //
+				    &state->descriptors[i]);        //
 				break;
 			case XRT_LAYER_EQUIRECT2:
 				render_gfx_layer_equirect2(         //
 				    render,                         //
 				    state->premultiplied_alphas[i], //
-				    state->descriptor_sets[i]);     //
+				    &state->descriptors[i]);        //
 				break;
 			case XRT_LAYER_PROJECTION:
 			case XRT_LAYER_PROJECTION_DEPTH:
 				render_gfx_layer_projection(        //
 				    render,                         //
 				    state->premultiplied_alphas[i], //
-				    state->descriptor_sets[i]);     //
+				    &state->descriptors[i]);        //
 				break;
 			case XRT_LAYER_QUAD:
 				render_gfx_layer_quad(              //
 				    render,                         //
 				    state->premultiplied_alphas[i], //
-				    state->descriptor_sets[i]);     //
+				    &state->descriptors[i]);        //
 				break;
 			default: break;
 			}
@@ -859,11 +871,13 @@ comp_render_gfx_layers(struct render_gfx *render,
 		render_gfx_end_target(render);
 	}
 
+	render_gfx_end_scope(render, scope);
+
 
 	cmd_barrier_view_squash_images(                    //
 	    render->r->vk,                                 //
 	    d,                                             //
-	    render->r->cmd,                                // cmd
+	    render->frame->cmd,                            // cmd
 	    VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,          // src_access_mask
 	    VK_ACCESS_SHADER_READ_BIT,                     // dst_access_mask
 	    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,      // transition_from
@@ -937,14 +951,17 @@ comp_render_gfx_dispatch(struct render_gfx *render,
 		}
 
 		/*
-		 * Layer squashing.
+		 * Layer squashing, unless already in the squash images from
+		 * an earlier frame, they are left in the transition_to layout.
 		 */
-		comp_render_gfx_layers( //
-		    render,             //
-		    layers,             //
-		    layer_count,        //
-		    d,                  //
-		    transition_to);     //
+		if (!d->squash_is_cached) {
+			comp_render_gfx_layers( //
+			    render,             //
+			    layers,             //
+			    layer_count,        //
+			    d,                  //
+			    transition_to);     //
+		}
 
 		/*
 		 * Distortion.
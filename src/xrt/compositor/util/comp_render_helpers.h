@@ -89,7 +89,8 @@ is_layer_view_visible(const struct xrt_layer_data *data, uint32_t view_index)
 	case XRT_LAYER_EQUIRECT2: visibility = data->equirect2.visibility; break;
 	case XRT_LAYER_QUAD: visibility = data->quad.visibility; break;
 	case XRT_LAYER_PROJECTION:
-	case XRT_LAYER_PROJECTION_DEPTH: return true;
+	case XRT_LAYER_PROJECTION_DEPTH:
+	case XRT_LAYER_PASSTHROUGH: return true;
 	default: return false;
 	};
 
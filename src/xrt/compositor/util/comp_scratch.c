@@ -98,6 +98,21 @@ indices_get(struct comp_scratch_indices *i, uint32_t *out_index)
 	*out_index = current;
 }
 
+static inline bool
+indices_get_last(struct comp_scratch_indices *i, uint32_t *out_index)
+{
+	assert(i->current == INVALID_INDEX);
+
+	if (i->last == INVALID_INDEX) {
+		return false;
+	}
+
+	i->current = i->last;
+	*out_index = i->current;
+
+	return true;
+}
+
 static inline uint32_t
 indices_done(struct comp_scratch_indices *i)
 {
@@ -386,6 +401,12 @@ comp_scratch_single_images_get(struct comp_scratch_single_images *cssi, uint32_t
 	indices_get(&cssi->indices, out_index);
 }
 
+bool
+comp_scratch_single_images_get_last(struct comp_scratch_single_images *cssi, uint32_t *out_index)
+{
+	return indices_get_last(&cssi->indices, out_index);
+}
+
 void
 comp_scratch_single_images_done(struct comp_scratch_single_images *cssi)
 {
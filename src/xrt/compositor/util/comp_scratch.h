@@ -148,6 +148,21 @@ comp_scratch_single_images_free(struct comp_scratch_single_images *cssi, struct
 void
 comp_scratch_single_images_get(struct comp_scratch_single_images *cssi, uint32_t *out_index);
 
+/*!
+ * Get the image that was last marked as done again, without touching its
+ * content, used when what was rendered to it last time can be reused. Follows
+ * the same rules as @p get, must be followed by @p done or @p discard.
+ *
+ * @return False if no image has been marked as done since the images where
+ *         last allocated.
+ *
+ * @public @memberof comp_scratch_single_images
+ *
+ * @ingroup comp_util
+ */
+bool
+comp_scratch_single_images_get_last(struct comp_scratch_single_images *cssi, uint32_t *out_index);
+
 /*!
  * Get the image for the given index.
  *
@@ -1,4 +1,4 @@
-// Copyright 2019-2023, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -12,9 +12,11 @@
 #include "xrt/xrt_config_os.h"
 #include "xrt/xrt_results.h"
 
+#include "util/u_var.h"
 #include "util/u_misc.h"
 #include "util/u_handles.h"
 #include "util/u_trace_marker.h"
+#include "util/u_thread_policy.h"
 #include "util/u_limited_unique_id.h"
 
 #include "vk/vk_helpers.h"
@@ -205,6 +207,8 @@ swapchain_release_image(struct xrt_swapchain *xsc, uint32_t index)
 
 	VK_TRACE(sc->vk, "RELEASE_IMAGE");
 
+	xrt_atomic_s32_inc_return(&sc->release_count);
+
 	int res = u_index_fifo_push(&sc->fifo, index);
 
 	if (res >= 0) {
@@ -275,17 +279,19 @@ image_view_array_cleanup(struct vk_bundle *vk, size_t array_size, VkImageView **
  * images that has one or all fields set to NULL.
  */
 static void
-image_cleanup(struct vk_bundle *vk, struct comp_swapchain_image *image)
+image_cleanup(struct vk_bundle *vk, struct comp_swapchain_image *image, bool gpu_done)
 {
 	/*
 	 * This makes sure that any pending command buffer has completed and all
 	 * resources referred by it can now be manipulated. This make sure that
-	 * validation doesn't complain. This is done during image destruction so
-	 * isn't time critical.
+	 * validation doesn't complain. Not needed if the garbage collection
+	 * thread has already waited for the work.
 	 */
-	os_mutex_lock(&vk->queue_mutex);
-	vk->vkDeviceWaitIdle(vk->device);
-	os_mutex_unlock(&vk->queue_mutex);
+	if (!gpu_done) {
+		os_mutex_lock(&vk->queue_mutex);
+		vk->vkDeviceWaitIdle(vk->device);
+		os_mutex_unlock(&vk->queue_mutex);
+	}
 
 	// The field array_size is shared, only reset once both are freed.
 	image_view_array_cleanup(vk, image->array_size, &image->views.alpha);
@@ -300,7 +306,7 @@ cleanup_post_create_vulkan_setup(struct vk_bundle *vk, struct comp_swapchain *sc
 	uint32_t image_count = sc->vkic.image_count;
 
 	for (uint32_t i = 0; i < image_count; i++) {
-		image_cleanup(vk, &(sc->images[i]));
+		image_cleanup(vk, &(sc->images[i]), false);
 	}
 }
 
@@ -466,10 +472,279 @@ error:
 	return XRT_ERROR_VULKAN;
 }
 
+
+/*
+ *
+ * Import cache functions.
+ *
+ */
+
+static bool
+create_info_matches(const struct xrt_swapchain_create_info *a, const struct xrt_swapchain_create_info *b)
+{
+	if (a->create != b->create ||             //
+	    a->bits != b->bits ||                 //
+	    a->format != b->format ||             //
+	    a->sample_count != b->sample_count || //
+	    a->width != b->width ||               //
+	    a->height != b->height ||             //
+	    a->face_count != b->face_count ||     //
+	    a->array_size != b->array_size ||     //
+	    a->mip_count != b->mip_count ||       //
+	    a->format_count != b->format_count) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < a->format_count && i < ARRAY_SIZE(a->formats); i++) {
+		if (a->formats[i] != b->formats[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//! Must be called with the cache mutex held, or when no other thread can use the cache.
+static void
+cache_entry_destroy(struct vk_bundle *vk, struct comp_swapchain_cache_entry *entry)
+{
+	for (uint32_t i = 0; i < entry->vkic.image_count; i++) {
+		u_graphics_buffer_unref(&entry->handles[i]);
+	}
+
+	vk_ic_destroy(vk, &entry->vkic);
+	entry->allocated = false;
+}
+
+/*!
+ * Look for the images of the very same buffers as @p handles imported with the
+ * same info, on success the images and our references to the buffers are moved
+ * out of the cache.
+ */
+static bool
+cache_take(struct comp_swapchain_shared *cscs,
+           const struct xrt_swapchain_create_info *info,
+           const xrt_graphics_buffer_handle_t *handles,
+           uint32_t image_count,
+           struct vk_image_collection *out_vkic,
+           xrt_graphics_buffer_handle_t *out_handles)
+{
+	bool found = false;
+
+	os_mutex_lock(&cscs->cache.mutex);
+
+	for (uint32_t i = 0; i < ARRAY_SIZE(cscs->cache.entries) && !found; i++) {
+		struct comp_swapchain_cache_entry *entry = &cscs->cache.entries[i];
+
+		if (entry->allocated || entry->vkic.image_count != image_count ||
+		    !create_info_matches(&entry->vkic.info, info)) {
+			continue;
+		}
+
+		bool same = true;
+		for (uint32_t k = 0; k < image_count && same; k++) {
+			same = u_graphics_buffer_is_same(entry->handles[k], handles[k]);
+		}
+
+		if (!same) {
+			continue;
+		}
+
+		*out_vkic = entry->vkic;
+		for (uint32_t k = 0; k < image_count; k++) {
+			out_handles[k] = entry->handles[k];
+			entry->handles[k] = XRT_GRAPHICS_BUFFER_HANDLE_INVALID;
+		}
+		U_ZERO(&entry->vkic);
+
+		found = true;
+	}
+
+	os_mutex_unlock(&cscs->cache.mutex);
+
+	return found;
+}
+
+/*!
+ * Images allocated with a superset of the requested usage bits can back the
+ * swapchain just as well, everything else has to be the same.
+ */
+static bool
+create_info_compatible(const struct xrt_swapchain_create_info *allocated, const struct xrt_swapchain_create_info *info)
+{
+	if ((allocated->bits & info->bits) != info->bits) {
+		return false;
+	}
+
+	struct xrt_swapchain_create_info tmp = *info;
+	tmp.bits = allocated->bits;
+
+	return create_info_matches(allocated, &tmp);
+}
+
+/*!
+ * Look for images allocated for a destroyed swapchain that are compatible with
+ * @p info, an exact match is preferred. On success the images are moved out of
+ * the cache, their content is undefined just like newly allocated images.
+ */
+static bool
+cache_take_allocated(struct comp_swapchain_shared *cscs,
+                     const struct xrt_swapchain_create_info *info,
+                     uint32_t image_count,
+                     struct vk_image_collection *out_vkic)
+{
+	struct comp_swapchain_cache_entry *found = NULL;
+
+	os_mutex_lock(&cscs->cache.mutex);
+
+	for (uint32_t i = 0; i < ARRAY_SIZE(cscs->cache.entries); i++) {
+		struct comp_swapchain_cache_entry *entry = &cscs->cache.entries[i];
+
+		if (!entry->allocated || entry->vkic.image_count != image_count ||
+		    !create_info_compatible(&entry->vkic.info, info)) {
+			continue;
+		}
+
+		found = entry;
+		if (entry->vkic.info.bits == info->bits) {
+			break;
+		}
+	}
+
+	if (found != NULL) {
+		*out_vkic = found->vkic;
+		U_ZERO(&found->vkic);
+		found->allocated = false;
+	}
+
+	os_mutex_unlock(&cscs->cache.mutex);
+
+	return found != NULL;
+}
+
+/*!
+ * Move the images of a destroyed swapchain and, for imported ones, our
+ * references to its buffers into the cache, the least recently used entry is
+ * destroyed if it is full.
+ */
+static void
+cache_put(struct comp_swapchain_shared *cscs, struct vk_bundle *vk, struct comp_swapchain *sc)
+{
+	os_mutex_lock(&cscs->cache.mutex);
+
+	struct comp_swapchain_cache_entry *entry = &cscs->cache.entries[0];
+	for (uint32_t i = 0; i < ARRAY_SIZE(cscs->cache.entries); i++) {
+		struct comp_swapchain_cache_entry *e = &cscs->cache.entries[i];
+		if (e->vkic.image_count == 0) {
+			entry = e;
+			break;
+		}
+		if (e->last_used < entry->last_used) {
+			entry = e;
+		}
+	}
+
+	if (entry->vkic.image_count > 0) {
+		VK_DEBUG(vk, "Swapchain cache full, evicting %p", (void *)entry);
+		cache_entry_destroy(vk, entry);
+	}
+
+	entry->vkic = sc->vkic;
+	entry->allocated = sc->allocated;
+	for (uint32_t i = 0; i < sc->vkic.image_count && !sc->allocated; i++) {
+		entry->handles[i] = sc->base.images[i].handle;
+		sc->base.images[i].handle = XRT_GRAPHICS_BUFFER_HANDLE_INVALID;
+	}
+	entry->last_used = cscs->cache.generation;
+
+	os_mutex_unlock(&cscs->cache.mutex);
+
+	U_ZERO(&sc->vkic);
+	sc->cacheable = false;
+}
+
+static void
+cache_evict_old(struct comp_swapchain_shared *cscs, struct vk_bundle *vk, bool all)
+{
+	os_mutex_lock(&cscs->cache.mutex);
+
+	uint64_t generation = cscs->cache.generation;
+
+	for (uint32_t i = 0; i < ARRAY_SIZE(cscs->cache.entries); i++) {
+		struct comp_swapchain_cache_entry *entry = &cscs->cache.entries[i];
+		if (entry->vkic.image_count == 0) {
+			continue;
+		}
+
+		if (all || generation - entry->last_used > COMP_SWAPCHAIN_CACHE_MAX_AGE) {
+			cache_entry_destroy(vk, entry);
+		}
+	}
+
+	os_mutex_unlock(&cscs->cache.mutex);
+}
+
+//! Bumps the generation, returns true if any entry is now old enough to be evicted.
+static bool
+cache_age(struct comp_swapchain_shared *cscs)
+{
+	bool any_old = false;
+
+	os_mutex_lock(&cscs->cache.mutex);
+
+	uint64_t generation = ++cscs->cache.generation;
+
+	for (uint32_t i = 0; i < ARRAY_SIZE(cscs->cache.entries); i++) {
+		struct comp_swapchain_cache_entry *entry = &cscs->cache.entries[i];
+		if (entry->vkic.image_count > 0 && generation - entry->last_used > COMP_SWAPCHAIN_CACHE_MAX_AGE) {
+			any_old = true;
+		}
+	}
+
+	os_mutex_unlock(&cscs->cache.mutex);
+
+	return any_old;
+}
+
+/*!
+ * Take our own reference to each buffer to import, returns false if the
+ * images can't be cached, then no references are held.
+ */
+static bool
+ref_import_handles(struct xrt_image_native *native_images,
+                   uint32_t native_image_count,
+                   xrt_graphics_buffer_handle_t out_handles[XRT_MAX_SWAPCHAIN_IMAGES])
+{
+	if (native_image_count > XRT_MAX_SWAPCHAIN_IMAGES) {
+		return false;
+	}
+
+	// Not reference counted, can't tell if they are the same.
+	for (uint32_t i = 0; i < native_image_count; i++) {
+		if (native_images[i].is_dxgi_handle) {
+			return false;
+		}
+	}
+
+	for (uint32_t i = 0; i < native_image_count; i++) {
+		out_handles[i] = u_graphics_buffer_ref(native_images[i].handle);
+		if (xrt_graphics_buffer_is_valid(out_handles[i])) {
+			continue;
+		}
+
+		while (i > 0) {
+			u_graphics_buffer_unref(&out_handles[--i]);
+		}
+		return false;
+	}
+
+	return true;
+}
+
 /*!
  * Swapchain destruct is delayed until it is safe to destroy them, this function
- * does the actual destruction and is called from @ref
- * comp_swapchain_shared_garbage_collect.
+ * does the actual destruction and is called from the garbage collection thread,
+ * see @ref comp_swapchain_shared_garbage_collect.
  *
  * @ingroup comp_util
  */
@@ -513,16 +788,25 @@ comp_swapchain_create_init(struct comp_swapchain *sc,
 
 	set_common_fields(sc, destroy_func, vk, cscs, xsccp->image_count);
 
-	// Use the image helper to allocate the images.
-	ret = vk_ic_allocate(vk, info, xsccp->image_count, &sc->vkic);
-	if (ret == VK_ERROR_FEATURE_NOT_PRESENT) {
-		return XRT_ERROR_SWAPCHAIN_FLAG_VALID_BUT_UNSUPPORTED;
-	}
-	if (ret == VK_ERROR_FORMAT_NOT_SUPPORTED) {
-		return XRT_ERROR_SWAPCHAIN_FORMAT_UNSUPPORTED;
-	}
-	if (ret != VK_SUCCESS) {
-		return XRT_ERROR_VULKAN;
+	/*
+	 * Apps recreate swapchains on resize and session restarts, reusing
+	 * the buffers avoids allocation stalls and gralloc pressure. The
+	 * buffers are exported again below so the client gets new handles.
+	 */
+	if (cache_take_allocated(cscs, info, xsccp->image_count, &sc->vkic)) {
+		VK_DEBUG(vk, "Reusing the images of a destroyed swapchain, compatible info");
+	} else {
+		// Use the image helper to allocate the images.
+		ret = vk_ic_allocate(vk, info, xsccp->image_count, &sc->vkic);
+		if (ret == VK_ERROR_FEATURE_NOT_PRESENT) {
+			return XRT_ERROR_SWAPCHAIN_FLAG_VALID_BUT_UNSUPPORTED;
+		}
+		if (ret == VK_ERROR_FORMAT_NOT_SUPPORTED) {
+			return XRT_ERROR_SWAPCHAIN_FORMAT_UNSUPPORTED;
+		}
+		if (ret != VK_SUCCESS) {
+			return XRT_ERROR_VULKAN;
+		}
 	}
 
 	xrt_graphics_buffer_handle_t handles[ARRAY_SIZE(sc->vkic.images)];
@@ -545,6 +829,10 @@ comp_swapchain_create_init(struct comp_swapchain *sc,
 		return res;
 	}
 
+	// Moved to the cache when the swapchain is destroyed.
+	sc->cacheable = true;
+	sc->allocated = true;
+
 	return XRT_SUCCESS;
 }
 
@@ -566,24 +854,54 @@ comp_swapchain_import_init(struct comp_swapchain *sc,
 
 	set_common_fields(sc, destroy_func, vk, cscs, native_image_count);
 
-	// Use the image helper to get the images.
-	ret = vk_ic_from_natives(vk, info, native_images, native_image_count, &sc->vkic);
-	if (ret == VK_ERROR_FEATURE_NOT_PRESENT) {
-		return XRT_ERROR_SWAPCHAIN_FLAG_VALID_BUT_UNSUPPORTED;
-	}
-	if (ret == VK_ERROR_FORMAT_NOT_SUPPORTED) {
-		return XRT_ERROR_SWAPCHAIN_FORMAT_UNSUPPORTED;
-	}
-	if (ret != VK_SUCCESS) {
-		return XRT_ERROR_VULKAN;
+	xrt_graphics_buffer_handle_t refs[XRT_MAX_SWAPCHAIN_IMAGES];
+	xrt_graphics_buffer_handle_t cached_refs[XRT_MAX_SWAPCHAIN_IMAGES];
+	bool cacheable = ref_import_handles(native_images, native_image_count, refs);
+
+	if (cacheable && cache_take(cscs, info, refs, native_image_count, &sc->vkic, cached_refs)) {
+		VK_DEBUG(vk, "Reusing the images of a destroyed swapchain, same buffers");
+
+		// Consume the handles like the import would.
+		for (uint32_t i = 0; i < native_image_count; i++) {
+			u_graphics_buffer_unref(&native_images[i].handle);
+			native_images[i].size = 0;
+			u_graphics_buffer_unref(&refs[i]);
+			refs[i] = cached_refs[i];
+		}
+	} else {
+		// Use the image helper to get the images.
+		ret = vk_ic_from_natives(vk, info, native_images, native_image_count, &sc->vkic);
+		if (ret != VK_SUCCESS) {
+			for (uint32_t i = 0; cacheable && i < native_image_count; i++) {
+				u_graphics_buffer_unref(&refs[i]);
+			}
+		}
+		if (ret == VK_ERROR_FEATURE_NOT_PRESENT) {
+			return XRT_ERROR_SWAPCHAIN_FLAG_VALID_BUT_UNSUPPORTED;
+		}
+		if (ret == VK_ERROR_FORMAT_NOT_SUPPORTED) {
+			return XRT_ERROR_SWAPCHAIN_FORMAT_UNSUPPORTED;
+		}
+		if (ret != VK_SUCCESS) {
+			return XRT_ERROR_VULKAN;
+		}
 	}
 
 	xrt_result_t res = do_post_create_vulkan_setup(vk, info, sc);
 	if (res != XRT_SUCCESS) {
+		for (uint32_t i = 0; cacheable && i < native_image_count; i++) {
+			u_graphics_buffer_unref(&refs[i]);
+		}
 		vk_ic_destroy(vk, &sc->vkic);
 		return res;
 	}
 
+	// Held until the swapchain is destroyed, then moved to the cache.
+	for (uint32_t i = 0; cacheable && i < native_image_count; i++) {
+		sc->base.images[i].handle = refs[i];
+	}
+	sc->cacheable = cacheable;
+
 	return XRT_SUCCESS;
 }
 
@@ -607,7 +925,12 @@ comp_swapchain_teardown(struct comp_swapchain *sc)
 	}
 
 	for (uint32_t i = 0; i < sc->base.base.image_count; i++) {
-		image_cleanup(vk, &sc->images[i]);
+		image_cleanup(vk, &sc->images[i], sc->gpu_done);
+	}
+
+	// The GPU is done with the images, moves them and the buffer references.
+	if (sc->cacheable) {
+		cache_put(sc->cscs, vk, sc);
 	}
 
 	for (uint32_t i = 0; i < sc->base.base.image_count; i++) {
@@ -618,6 +941,179 @@ comp_swapchain_teardown(struct comp_swapchain *sc)
 }
 
 
+/*
+ *
+ * Garbage collection thread.
+ *
+ */
+
+/*!
+ * Submits fences that signal once all work submitted so far to the main and
+ * compute queue is done, an empty submit only waits for the earlier work.
+ */
+static bool
+gc_submit_fences(struct vk_bundle *vk, struct comp_swapchain_gc_batch *batch)
+{
+	struct vk_bundle_queue *queues[2] = {&vk->main_queue, &vk->compute_queue};
+
+	VkFenceCreateInfo create_info = {
+	    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+	};
+
+	for (uint32_t i = 0; i < ARRAY_SIZE(queues); i++) {
+		if (queues[i]->queue == VK_NULL_HANDLE) {
+			continue;
+		}
+
+		VkFence fence = VK_NULL_HANDLE;
+		VkResult ret = vk->vkCreateFence(vk->device, &create_info, NULL, &fence);
+		if (ret != VK_SUCCESS) {
+			VK_ERROR(vk, "vkCreateFence: %s", vk_result_string(ret));
+			goto err_fences;
+		}
+
+		VK_NAME_FENCE(vk, fence, "comp_swapchain_shared gc fence");
+
+		// Takes the queue lock.
+		ret = vk_cmd_submit_locked(vk, queues[i], 0, NULL, fence);
+		if (ret != VK_SUCCESS) {
+			vk->vkDestroyFence(vk->device, fence, NULL);
+			goto err_fences;
+		}
+
+		batch->fences[batch->fence_count++] = fence;
+	}
+
+	return true;
+
+err_fences:
+	for (uint32_t i = 0; i < batch->fence_count; i++) {
+		vk->vkDestroyFence(vk->device, batch->fences[i], NULL);
+	}
+	batch->fence_count = 0;
+
+	return false;
+}
+
+static void
+gc_destroy_batch(struct vk_bundle *vk, struct comp_swapchain_gc_batch *batch)
+{
+	COMP_TRACE_MARKER();
+
+	bool gpu_done = false;
+	if (batch->fence_count > 0) {
+		VkResult ret = vk->vkWaitForFences(vk->device, batch->fence_count, batch->fences, VK_TRUE, UINT64_MAX);
+		if (ret != VK_SUCCESS) {
+			VK_ERROR(vk, "vkWaitForFences: %s", vk_result_string(ret));
+		}
+		gpu_done = ret == VK_SUCCESS;
+	}
+
+	for (uint32_t i = 0; i < batch->fence_count; i++) {
+		vk->vkDestroyFence(vk->device, batch->fences[i], NULL);
+	}
+
+	for (uint32_t i = 0; i < batch->swapchain_count; i++) {
+		struct comp_swapchain *sc = batch->swapchains[i];
+		sc->gpu_done = gpu_done;
+		sc->real_destroy(sc);
+	}
+}
+
+static void *
+gc_thread_func(void *ptr)
+{
+	struct comp_swapchain_shared *cscs = (struct comp_swapchain_shared *)ptr;
+	struct vk_bundle *vk = cscs->cache.vk;
+
+	U_TRACE_SET_THREAD_NAME("Swapchain GC");
+	os_thread_helper_name(&cscs->gc.oth, "Swapchain GC");
+
+	// Nothing here is time critical, stay out of the way of the compositor.
+	u_thread_policy_apply(vk->log_level, OS_THREAD_ROLE_BACKGROUND, "Swapchain GC");
+
+	os_thread_helper_lock(&cscs->gc.oth);
+
+	while (os_thread_helper_is_running_locked(&cscs->gc.oth)) {
+		if (cscs->gc.batch_count == 0 && !cscs->gc.evict) {
+			os_thread_helper_wait_locked(&cscs->gc.oth);
+			continue;
+		}
+
+		struct comp_swapchain_gc_batch batch = {0};
+		if (cscs->gc.batch_count > 0) {
+			batch = cscs->gc.batches[cscs->gc.first];
+			cscs->gc.first = (cscs->gc.first + 1) % COMP_SWAPCHAIN_GC_MAX_BATCHES;
+			cscs->gc.batch_count--;
+		}
+
+		bool evict = cscs->gc.evict;
+		cscs->gc.evict = false;
+
+		os_thread_helper_unlock(&cscs->gc.oth);
+
+		gc_destroy_batch(vk, &batch);
+
+		if (evict) {
+			cache_evict_old(cscs, vk, false);
+		}
+
+		os_thread_helper_lock(&cscs->gc.oth);
+
+		cscs->gc.pending_swapchains -= batch.swapchain_count;
+		cscs->gc.destroyed_swapchains += batch.swapchain_count;
+	}
+
+	os_thread_helper_unlock(&cscs->gc.oth);
+
+	return NULL;
+}
+
+/*!
+ * Queue a batch for the thread, returns false if there is no room or no fences
+ * could be submitted, the caller then destroys the swapchains itself.
+ */
+static bool
+gc_push_batch(struct comp_swapchain_shared *cscs, struct vk_bundle *vk, struct comp_swapchain_gc_batch *batch)
+{
+	os_thread_helper_lock(&cscs->gc.oth);
+	bool have_room = os_thread_helper_is_running_locked(&cscs->gc.oth) &&
+	                 cscs->gc.batch_count < COMP_SWAPCHAIN_GC_MAX_BATCHES;
+	os_thread_helper_unlock(&cscs->gc.oth);
+
+	// Only this function adds batches, so the room can't go away.
+	if (!have_room || !gc_submit_fences(vk, batch)) {
+		return false;
+	}
+
+	os_thread_helper_lock(&cscs->gc.oth);
+
+	uint32_t index = (cscs->gc.first + cscs->gc.batch_count) % COMP_SWAPCHAIN_GC_MAX_BATCHES;
+	cscs->gc.batches[index] = *batch;
+	cscs->gc.batch_count++;
+	cscs->gc.pending_swapchains += batch->swapchain_count;
+
+	os_thread_helper_signal_locked(&cscs->gc.oth);
+	os_thread_helper_unlock(&cscs->gc.oth);
+
+	return true;
+}
+
+static void
+gc_hand_over(struct comp_swapchain_shared *cscs, struct vk_bundle *vk, struct comp_swapchain_gc_batch *batch)
+{
+	// The views are destroyed after this, either here or on the thread.
+	cscs->destroy_generation++;
+
+	if (gc_push_batch(cscs, vk, batch)) {
+		return;
+	}
+
+	// Fall back to destroying them here, waits for the device to be idle.
+	gc_destroy_batch(vk, batch);
+}
+
+
 /*
  *
  * 'Exported' shared functions.
@@ -633,22 +1129,93 @@ comp_swapchain_shared_init(struct comp_swapchain_shared *cscs, struct vk_bundle
 		return XRT_ERROR_VULKAN;
 	}
 
+	int iret = os_mutex_init(&cscs->cache.mutex);
+	if (iret != 0) {
+		VK_ERROR(vk, "os_mutex_init: %d", iret);
+		vk_cmd_pool_destroy(vk, &cscs->pool);
+		return XRT_ERROR_THREADING_INIT_FAILURE;
+	}
+
+	cscs->cache.vk = vk;
+
+	// Make sure the handles are invalid.
+	for (uint32_t i = 0; i < ARRAY_SIZE(cscs->cache.entries); i++) {
+		for (uint32_t k = 0; k < ARRAY_SIZE(cscs->cache.entries[i].handles); k++) {
+			cscs->cache.entries[i].handles[k] = XRT_GRAPHICS_BUFFER_HANDLE_INVALID;
+		}
+	}
+
+	iret = os_thread_helper_init(&cscs->gc.oth);
+	if (iret != 0) {
+		VK_ERROR(vk, "os_thread_helper_init: %d", iret);
+		os_mutex_destroy(&cscs->cache.mutex);
+		vk_cmd_pool_destroy(vk, &cscs->pool);
+		return XRT_ERROR_THREADING_INIT_FAILURE;
+	}
+
+	iret = os_thread_helper_start(&cscs->gc.oth, gc_thread_func, cscs);
+	if (iret != 0) {
+		VK_ERROR(vk, "os_thread_helper_start: %d", iret);
+		os_thread_helper_destroy(&cscs->gc.oth);
+		os_mutex_destroy(&cscs->cache.mutex);
+		vk_cmd_pool_destroy(vk, &cscs->pool);
+		return XRT_ERROR_THREADING_INIT_FAILURE;
+	}
+
+	u_var_add_root(cscs, "Swapchain garbage collection", true);
+	u_var_add_ro_u32(cscs, &cscs->gc.pending_swapchains, "Pending swapchains");
+	u_var_add_ro_u32(cscs, &cscs->gc.destroyed_swapchains, "Destroyed swapchains");
+
 	return XRT_SUCCESS;
 }
 
 void
 comp_swapchain_shared_destroy(struct comp_swapchain_shared *cscs, struct vk_bundle *vk)
 {
+	u_var_remove_root(cscs);
+
+	// Stops the thread, then finish any batches it didn't get to.
+	os_thread_helper_destroy(&cscs->gc.oth);
+
+	while (cscs->gc.batch_count > 0) {
+		gc_destroy_batch(vk, &cscs->gc.batches[cscs->gc.first]);
+		cscs->gc.first = (cscs->gc.first + 1) % COMP_SWAPCHAIN_GC_MAX_BATCHES;
+		cscs->gc.batch_count--;
+	}
+
+	cache_evict_old(cscs, vk, true);
+	os_mutex_destroy(&cscs->cache.mutex);
+
 	vk_cmd_pool_destroy(vk, &cscs->pool);
 }
 
 void
 comp_swapchain_shared_garbage_collect(struct comp_swapchain_shared *cscs)
 {
+	COMP_TRACE_MARKER();
+
+	struct vk_bundle *vk = cscs->cache.vk;
+	struct comp_swapchain_gc_batch batch = {0};
 	struct comp_swapchain *sc;
 
 	while ((sc = u_threading_stack_pop(&cscs->destroy_swapchains))) {
-		sc->real_destroy(sc);
+		batch.swapchains[batch.swapchain_count++] = sc;
+
+		if (batch.swapchain_count == COMP_SWAPCHAIN_GC_BATCH_SIZE) {
+			gc_hand_over(cscs, vk, &batch);
+			U_ZERO(&batch);
+		}
+	}
+
+	if (batch.swapchain_count > 0) {
+		gc_hand_over(cscs, vk, &batch);
+	}
+
+	if (cache_age(cscs)) {
+		os_thread_helper_lock(&cscs->gc.oth);
+		cscs->gc.evict = true;
+		os_thread_helper_signal_locked(&cscs->gc.oth);
+		os_thread_helper_unlock(&cscs->gc.oth);
 	}
 }
 
@@ -1,4 +1,4 @@
-// Copyright 2019-2023, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -32,6 +32,59 @@ struct comp_swapchain;
  */
 typedef void (*comp_swapchain_destroy_func_t)(struct comp_swapchain *sc);
 
+//! How many destroyed swapchains have their images kept for reuse.
+#define COMP_SWAPCHAIN_CACHE_SIZE 8
+
+/*!
+ * How many garbage collections an unused cache entry survives, the compositors
+ * collect once per frame so this is a few seconds.
+ */
+#define COMP_SWAPCHAIN_CACHE_MAX_AGE 300
+
+//! How many batches of destroyed swapchains can wait for the garbage collection thread.
+#define COMP_SWAPCHAIN_GC_MAX_BATCHES 8
+
+//! Swapchains in one batch, a garbage collection with more makes more batches.
+#define COMP_SWAPCHAIN_GC_BATCH_SIZE 16
+
+/*!
+ * The images of a swapchain that has been destroyed, kept so that importing
+ * the very same buffers again doesn't have to import the memory, and so that
+ * creating a compatible swapchain doesn't have to allocate new buffers.
+ *
+ * @ingroup comp_util
+ */
+struct comp_swapchain_cache_entry
+{
+	//! The imported images, a zero image count means the entry is free.
+	struct vk_image_collection vkic;
+
+	//! Our own references to the imported buffers, to compare identity with.
+	xrt_graphics_buffer_handle_t handles[XRT_MAX_SWAPCHAIN_IMAGES];
+
+	//! The images were allocated by us, @p handles are then not used.
+	bool allocated;
+
+	//! Value of @ref comp_swapchain_shared::cache generation when last used.
+	uint64_t last_used;
+};
+
+/*!
+ * Swapchains handed over to the garbage collection thread by one garbage
+ * collection, they are destroyed once the fences have signalled.
+ *
+ * @ingroup comp_util
+ */
+struct comp_swapchain_gc_batch
+{
+	//! Signalled when the work submitted to the main and compute queue before the hand over is done.
+	VkFence fences[2];
+	uint32_t fence_count;
+
+	struct comp_swapchain *swapchains[COMP_SWAPCHAIN_GC_BATCH_SIZE];
+	uint32_t swapchain_count;
+};
+
 /*!
  * Shared resource(s) and garbage collector for swapchains. The garbage
  * collector allows to delay the destruction until it's safe to destroy them.
@@ -45,7 +98,58 @@ struct comp_swapchain_shared
 	//! Thread object for safely destroying swapchain.
 	struct u_threading_stack destroy_swapchains;
 
+	/*!
+	 * Bumped when swapchains are handed over for destruction by
+	 * @ref comp_swapchain_shared_garbage_collect, anything holding on to
+	 * image view handles compares it to know when they may be stale.
+	 */
+	uint64_t destroy_generation;
+
 	struct vk_cmd_pool pool;
+
+	/*!
+	 * Images of destroyed swapchains, entries are evicted least
+	 * recently used first and when they get too old in
+	 * @ref comp_swapchain_shared_garbage_collect.
+	 */
+	struct
+	{
+		//! Protects the entries, imports happen on other threads.
+		struct os_mutex mutex;
+
+		//! Used to destroy evicted entries from the garbage collection.
+		struct vk_bundle *vk;
+
+		//! Bumped on each garbage collection.
+		uint64_t generation;
+
+		struct comp_swapchain_cache_entry entries[COMP_SWAPCHAIN_CACHE_SIZE];
+	} cache;
+
+	/*!
+	 * Low priority thread doing the actual destruction, freeing the
+	 * images and memory of large swapchains takes several milliseconds
+	 * which would stall the thread calling the garbage collection.
+	 */
+	struct
+	{
+		//! Also protects all of the fields below.
+		struct os_thread_helper oth;
+
+		//! Ring of batches waiting to be destroyed.
+		struct comp_swapchain_gc_batch batches[COMP_SWAPCHAIN_GC_MAX_BATCHES];
+		uint32_t first;
+		uint32_t batch_count;
+
+		//! The cache has entries old enough to be evicted.
+		bool evict;
+
+		//! Swapchains in @p batches, for the debug UI.
+		uint32_t pending_swapchains;
+
+		//! Swapchains destroyed by the thread, for the debug UI.
+		uint32_t destroyed_swapchains;
+	} gc;
 };
 
 /*!
@@ -106,6 +210,33 @@ struct comp_swapchain
 
 	//! Virtual real destroy function.
 	comp_swapchain_destroy_func_t real_destroy;
+
+	/*!
+	 * Bumped on every release, the same image index being used again does
+	 * not mean that the content of the image is unchanged.
+	 */
+	xrt_atomic_s32_t release_count;
+
+	/*!
+	 * Set for imported swapchains where @ref xrt_swapchain_native::images
+	 * holds our own reference to each imported buffer, and for allocated
+	 * swapchains. The images are then put in the cache on destruction
+	 * instead of being destroyed.
+	 */
+	bool cacheable;
+
+	/*!
+	 * The images were allocated by us and @ref xrt_swapchain_native::images
+	 * holds the exported buffers, which are not kept in the cache.
+	 */
+	bool allocated;
+
+	/*!
+	 * Set by the garbage collection thread once the GPU is known to be
+	 * done with the images, then teardown doesn't wait for the device to
+	 * be idle, which would stall all other submissions.
+	 */
+	bool gpu_done;
 };
 
 
@@ -189,7 +320,8 @@ XRT_CHECK_RESULT xrt_result_t
 comp_swapchain_shared_init(struct comp_swapchain_shared *cscs, struct vk_bundle *vk);
 
 /*!
- * Destroy the shared struct.
+ * Destroy the shared struct, any swapchains still waiting for the garbage
+ * collection thread are destroyed before this returns.
  *
  * @ingroup comp_util
  */
@@ -197,8 +329,10 @@ void
 comp_swapchain_shared_destroy(struct comp_swapchain_shared *cscs, struct vk_bundle *vk);
 
 /*!
- * Do garbage collection, destroying any resources that has been scheduled for
- * destruction from other threads.
+ * Do garbage collection, hands any resources that has been scheduled for
+ * destruction from other threads to the garbage collection thread, which
+ * destroys them once the GPU work submitted before this call is done. Also
+ * ages the cache of swapchain images, old entries are evicted on that thread.
  *
  * @ingroup comp_util
  */
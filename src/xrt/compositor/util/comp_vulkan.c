@@ -120,6 +120,83 @@ get_device_luid(struct vk_bundle *vk, int gpu_index, xrt_luid_t *luid)
 	return true;
 }
 
+#ifdef VK_USE_PLATFORM_DISPLAY_KHR
+/*!
+ * Returns the index of the first GPU that has displays connected to it,
+ * that is the GPU that can scan out to the HMD in direct mode, or -1.
+ */
+static int
+find_display_gpu_index(struct vk_bundle *vk)
+{
+	VkPhysicalDevice *physical_devices = NULL;
+	uint32_t gpu_count = 0;
+	int display_gpu_index = -1;
+	VkResult ret;
+
+	// Only loaded if VK_KHR_display was enabled on the instance.
+	if (vk->vkGetPhysicalDeviceDisplayPropertiesKHR == NULL) {
+		return -1;
+	}
+
+	ret = vk_enumerate_physical_devices( //
+	    vk,                              // vk_bundle
+	    &gpu_count,                      // out_physical_device_count
+	    &physical_devices);              // out_physical_devices
+	if (ret != VK_SUCCESS || gpu_count == 0) {
+		return -1;
+	}
+
+	for (uint32_t i = 0; i < gpu_count; i++) {
+		VkDisplayPropertiesKHR *props = NULL;
+		uint32_t prop_count = 0;
+
+		ret = vk_enumerate_physical_device_display_properties( //
+		    vk,                                                // vk_bundle
+		    physical_devices[i],                               // physical_device
+		    &prop_count,                                       // out_prop_count
+		    &props);                                           // out_props
+		free(props);
+
+		if (ret == VK_SUCCESS && prop_count > 0) {
+			display_gpu_index = (int)i;
+			break;
+		}
+	}
+
+	free(physical_devices);
+
+	return display_gpu_index;
+}
+#endif
+
+/*!
+ * Picks the GPU the displays are connected to for the compositor and the
+ * preferred GPU for the clients, only touches indices that are on auto.
+ */
+static void
+select_display_and_client_gpus(struct vk_bundle *vk, struct comp_vulkan_arguments *vk_args)
+{
+#ifdef VK_USE_PLATFORM_DISPLAY_KHR
+	int display_gpu_index = find_display_gpu_index(vk);
+	if (display_gpu_index < 0) {
+		VK_WARN(vk, "No GPU with displays found, using the same GPU for compositor and clients.");
+		return;
+	}
+
+	// Selects the preferred GPU, the device creation selects again with the final index.
+	if (vk_args->client_gpu_index < 0 && vk_select_physical_device(vk, -1) == VK_SUCCESS) {
+		vk_args->client_gpu_index = vk->physical_device_index;
+	}
+
+	if (vk_args->selected_gpu_index < 0) {
+		vk_args->selected_gpu_index = display_gpu_index;
+	}
+#else
+	(void)vk_args;
+	VK_WARN(vk, "Built without VK_KHR_display, can not find the GPU with displays.");
+#endif
+}
+
 VkResult
 fill_in_results(struct vk_bundle *vk, const struct comp_vulkan_arguments *vk_args, struct comp_vulkan_results *vk_res)
 {
@@ -165,6 +242,9 @@ fill_in_results(struct vk_bundle *vk, const struct comp_vulkan_arguments *vk_arg
 		}
 	}
 
+	VK_INFO(vk, "GPU %d composites and presents, GPU %d is suggested to clients for rendering.",
+	        vk_res->selected_gpu_index, vk_res->client_gpu_index);
+
 	return VK_SUCCESS;
 }
 
@@ -283,6 +363,8 @@ create_device(struct vk_bundle *vk, const struct comp_vulkan_arguments *vk_args)
 	    .synchronization_2 = true,
 	    .present_wait = true,
 	    .video_maintenance_1 = true,
+	    .image_compression_control = true,
+	    .present_timing = true,
 	};
 
 	ret = vk_init_mutex(vk);
@@ -297,6 +379,7 @@ create_device(struct vk_bundle *vk, const struct comp_vulkan_arguments *vk_args)
 		    vk,                                  //
 		    vk_args->selected_gpu_index,         //
 		    only_compute_queue,                  // compute_only
+		    vk_args->compute_queue,              // want_compute_queue
 		    prios[i],                            // global_priority
 		    vk_args->required_device_extensions, //
 		    vk_args->optional_device_extensions, //
@@ -368,13 +451,19 @@ comp_vulkan_init_bundle(struct vk_bundle *vk,
 		return false;
 	}
 
-	ret = create_device(vk, vk_args);
+	// Local copy, the GPU indices might be changed below.
+	struct comp_vulkan_arguments args = *vk_args;
+	if (args.use_display_gpu) {
+		select_display_and_client_gpus(vk, &args);
+	}
+
+	ret = create_device(vk, &args);
 	if (ret != VK_SUCCESS) {
 		// Error already reported.
 		return false;
 	}
 
-	ret = fill_in_results(vk, vk_args, vk_res);
+	ret = fill_in_results(vk, &args, vk_res);
 	if (ret != VK_SUCCESS) {
 		// Error already reported.
 		return false;
@@ -49,6 +49,9 @@ struct comp_vulkan_arguments
 	//! Should we look for a queue with no graphics, only compute.
 	bool only_compute_queue;
 
+	//! Should we try to create @ref vk_bundle::compute_queue as well.
+	bool compute_queue;
+
 	//! Should we try to enable timeline semaphores if available
 	bool timeline_semaphore;
 
@@ -57,6 +60,9 @@ struct comp_vulkan_arguments
 
 	//! Vulkan physical device index for clients to use, -1 for auto.
 	int client_gpu_index;
+
+	//! Auto select the GPU with displays for the compositor and the preferred GPU for clients.
+	bool use_display_gpu;
 };
 
 /*!
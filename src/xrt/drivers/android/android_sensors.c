@@ -1,7 +1,7 @@
 // Copyright 2013, Fredrik Hultin.
 // Copyright 2013, Jakob Bornecrantz.
 // Copyright 2015, Joey Ferwerda.
-// Copyright 2020-2023, Collabora, Ltd.
+// Copyright 2020-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -12,6 +12,8 @@
 
 #include "android_sensors.h"
 
+#include "os/os_time.h"
+
 #include "util/u_debug.h"
 #include "util/u_device.h"
 #include "util/u_distortion_mesh.h"
@@ -23,6 +25,12 @@
 
 #include <xrt/xrt_config_android.h>
 
+#if __ANDROID_API__ >= 26
+#include <android/sharedmem.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 // Workaround to avoid the inclusion of "android_native_app_glue.h.
 #ifndef LOOPER_ID_USER
 #define LOOPER_ID_USER 3
@@ -31,8 +39,15 @@
 // 60 events per second (in us).
 #define POLL_RATE_USEC (1000L / 60) * 1000
 
+// Events read from the event queue at once.
+#define EVENT_QUEUE_BATCH_SIZE 16
+
+// Events in the direct channel ring, room for a few frames at the highest rates.
+#define DIRECT_CHANNEL_EVENT_COUNT 512
+
 
 DEBUG_GET_ONCE_LOG_OPTION(android_log, "ANDROID_SENSORS_LOG", U_LOGGING_WARN)
+DEBUG_GET_ONCE_BOOL_OPTION(android_direct_channel, "ANDROID_SENSORS_DIRECT_CHANNEL", true)
 
 static inline struct android_device *
 android_device(struct xrt_device *xdev)
@@ -40,9 +55,9 @@ android_device(struct xrt_device *xdev)
 	return (struct android_device *)xdev;
 }
 
-// Callback for the Android sensor event queue
-static int
-android_sensor_callback(ASensorEvent *event, struct android_device *d)
+// Handles a single sensor event, must be called with the lock held.
+static void
+android_sensor_handle_event_locked(const ASensorEvent *event, struct android_device *d)
 {
 	struct xrt_vec3 gyro;
 	struct xrt_vec3 accel;
@@ -66,18 +81,11 @@ android_sensor_callback(ASensorEvent *event, struct android_device *d)
 		// TODO: Make filter handle accelerometer
 		struct xrt_vec3 null_accel;
 
-		// Lock last and the fusion.
-		os_mutex_lock(&d->lock);
-
 		m_imu_3dof_update(&d->fusion, event->timestamp, &null_accel, &gyro);
-
-		// Now done.
-		os_mutex_unlock(&d->lock);
+		break;
 	}
 	default: ANDROID_TRACE(d, "Unhandled event type %d", event->type);
 	}
-
-	return 1;
 }
 
 static inline int32_t
@@ -88,6 +96,197 @@ android_get_sensor_poll_rate(const struct android_device *d)
 	                   : (int32_t)(d->base.hmd->screens[0].nominal_frame_interval_ns * freq_multiplier * 0.001f);
 }
 
+#if __ANDROID_API__ >= 26
+/*!
+ * Sensors writing straight into a shared memory ring, no looper wake ups are
+ * involved so the ring is polled and drained in batches.
+ */
+struct android_direct_channel
+{
+	ASensorManager *sensor_manager;
+	const ASensor *sensors[2];
+	uint32_t sensor_count;
+
+	int fd;
+	int32_t channel_id;
+	ASensorEvent *ring;
+	size_t size;
+
+	//! Index of the next event to read in the ring.
+	uint32_t read_index;
+
+	//! Counter of the next event to read, the sensor service starts at one.
+	int32_t next_counter;
+};
+
+static void
+android_direct_channel_destroy(struct android_device *d, struct android_direct_channel *adc)
+{
+	for (uint32_t i = 0; i < adc->sensor_count; i++) {
+		ASensorManager_configureDirectReport(adc->sensor_manager, adc->sensors[i], adc->channel_id,
+		                                     ASENSOR_DIRECT_RATE_STOP);
+	}
+	adc->sensor_count = 0;
+
+	if (adc->channel_id > 0) {
+		ASensorManager_destroyDirectChannel(adc->sensor_manager, adc->channel_id);
+		adc->channel_id = 0;
+	}
+	if (adc->ring != NULL) {
+		munmap(adc->ring, adc->size);
+		adc->ring = NULL;
+	}
+	if (adc->fd >= 0) {
+		close(adc->fd);
+		adc->fd = -1;
+	}
+}
+
+static bool
+android_direct_channel_supported(const ASensor *sensor)
+{
+	return sensor != NULL &&
+	       ASensor_isDirectChannelTypeSupported(sensor, ASENSOR_DIRECT_CHANNEL_TYPE_SHARED_MEMORY) &&
+	       ASensor_getHighestDirectReportRateLevel(sensor) > ASENSOR_DIRECT_RATE_STOP;
+}
+
+static bool
+android_direct_channel_add_sensor(struct android_device *d, struct android_direct_channel *adc, const ASensor *sensor)
+{
+	if (sensor == NULL) {
+		return true;
+	}
+
+	int rate = ASensor_getHighestDirectReportRateLevel(sensor);
+	int token = ASensorManager_configureDirectReport(adc->sensor_manager, sensor, adc->channel_id, rate);
+	if (token <= 0) {
+		ANDROID_WARN(d, "Failed to configure direct report for '%s': %d", ASensor_getName(sensor), token);
+		return false;
+	}
+
+	adc->sensors[adc->sensor_count++] = sensor;
+	ANDROID_INFO(d, "Direct report for '%s' at rate level %d", ASensor_getName(sensor), rate);
+
+	return true;
+}
+
+static bool
+android_direct_channel_create(struct android_device *d,
+                              ASensorManager *sensor_manager,
+                              const ASensor *accelerometer,
+                              const ASensor *gyroscope,
+                              struct android_direct_channel *adc)
+{
+	*adc = (struct android_direct_channel){
+	    .sensor_manager = sensor_manager,
+	    .fd = -1,
+	    .size = sizeof(ASensorEvent) * DIRECT_CHANNEL_EVENT_COUNT,
+	    .next_counter = 1,
+	};
+
+	if (!debug_get_bool_option_android_direct_channel()) {
+		return false;
+	}
+
+	// The fusion is driven by the gyroscope, so that is the one that must be supported.
+	if (!android_direct_channel_supported(gyroscope)) {
+		ANDROID_INFO(d, "Direct channel not supported, using the event queue.");
+		return false;
+	}
+	if (!android_direct_channel_supported(accelerometer)) {
+		accelerometer = NULL;
+	}
+
+	adc->fd = ASharedMemory_create("monado_sensors", adc->size);
+	if (adc->fd < 0) {
+		ANDROID_WARN(d, "Failed to create shared memory for the direct channel.");
+		return false;
+	}
+
+	void *ptr = mmap(NULL, adc->size, PROT_READ, MAP_SHARED, adc->fd, 0);
+	if (ptr == MAP_FAILED) {
+		ANDROID_WARN(d, "Failed to map the direct channel memory.");
+		android_direct_channel_destroy(d, adc);
+		return false;
+	}
+	adc->ring = (ASensorEvent *)ptr;
+
+	adc->channel_id = ASensorManager_createSharedMemoryDirectChannel(sensor_manager, adc->fd, adc->size);
+	if (adc->channel_id <= 0) {
+		ANDROID_WARN(d, "Failed to create the direct channel: %d", adc->channel_id);
+		adc->channel_id = 0;
+		android_direct_channel_destroy(d, adc);
+		return false;
+	}
+
+	if (!android_direct_channel_add_sensor(d, adc, gyroscope) ||
+	    !android_direct_channel_add_sensor(d, adc, accelerometer)) {
+		android_direct_channel_destroy(d, adc);
+		return false;
+	}
+
+	return true;
+}
+
+/*!
+ * Reads all new events from the ring, each slot carries an increasing counter
+ * in reserved0 that is checked again after the copy to catch a slot that was
+ * overwritten while being read.
+ */
+static void
+android_direct_channel_drain(struct android_device *d, struct android_direct_channel *adc)
+{
+	ASensorEvent event;
+	bool locked = false;
+
+	while (true) {
+		const ASensorEvent *slot = &adc->ring[adc->read_index];
+
+		int32_t counter = __atomic_load_n(&slot->reserved0, __ATOMIC_ACQUIRE);
+		if (counter - adc->next_counter < 0) {
+			// Not written yet.
+			break;
+		}
+
+		event = *slot;
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&slot->reserved0, __ATOMIC_RELAXED) != counter) {
+			// Overwritten during the copy, we have been lapped so retry.
+			continue;
+		}
+
+		if (counter != adc->next_counter) {
+			ANDROID_DEBUG(d, "Dropped %d sensor events", counter - adc->next_counter);
+		}
+
+		// The event with counter n is written to slot (n - 1) modulo the ring size.
+		adc->next_counter = counter + 1;
+		adc->read_index = (uint32_t)counter % DIRECT_CHANNEL_EVENT_COUNT;
+
+		// Only take the lock if we have anything to give the fusion.
+		if (!locked) {
+			os_mutex_lock(&d->lock);
+			locked = true;
+		}
+
+		android_sensor_handle_event_locked(&event, d);
+	}
+
+	if (locked) {
+		os_mutex_unlock(&d->lock);
+	}
+}
+
+static void
+android_direct_channel_run(struct android_device *d, struct android_direct_channel *adc, int32_t poll_rate_usec)
+{
+	while (os_thread_helper_is_running(&d->oth)) {
+		android_direct_channel_drain(d, adc);
+		os_nanosleep((int64_t)poll_rate_usec * 1000);
+	}
+}
+#endif
+
 static void *
 android_run_thread(void *ptr)
 {
@@ -108,6 +307,16 @@ android_run_thread(void *ptr)
 	accelerometer = ASensorManager_getDefaultSensor(sensor_manager, ASENSOR_TYPE_ACCELEROMETER);
 	gyroscope = ASensorManager_getDefaultSensor(sensor_manager, ASENSOR_TYPE_GYROSCOPE);
 
+#if __ANDROID_API__ >= 26
+	struct android_direct_channel adc;
+	if (android_direct_channel_create(d, sensor_manager, accelerometer, gyroscope, &adc)) {
+		android_direct_channel_run(d, &adc, poll_rate_usec);
+		android_direct_channel_destroy(d, &adc);
+		ANDROID_INFO(d, "android_run_thread exit");
+		return NULL;
+	}
+#endif
+
 	ALooper *event_looper = ALooper_forThread();
 	if (event_looper == NULL) {
 		event_looper = ALooper_prepare(ALOOPER_PREPARE_ALLOW_NON_CALLBACKS);
@@ -156,10 +365,15 @@ android_run_thread(void *ptr)
 			ANDROID_ERROR(d, "ALooper_pollAll returned zero events");
 			continue;
 		}
-		// read event
-		ASensorEvent event;
-		while (ASensorEventQueue_getEvents(event_queue, &event, 1) > 0) {
-			android_sensor_callback(&event, d);
+		// read events, a batch at a time
+		ASensorEvent events[EVENT_QUEUE_BATCH_SIZE];
+		ssize_t count;
+		while ((count = ASensorEventQueue_getEvents(event_queue, events, EVENT_QUEUE_BATCH_SIZE)) > 0) {
+			os_mutex_lock(&d->lock);
+			for (ssize_t i = 0; i < count; i++) {
+				android_sensor_handle_event_locked(&events[i], d);
+			}
+			os_mutex_unlock(&d->lock);
 		}
 	}
 	// Disable sensors.
@@ -25,9 +25,7 @@
 #include "util/u_logging.h"
 #include "util/u_trace_marker.h"
 
-#ifdef XRT_OS_LINUX
-#include "util/u_linux.h"
-#endif
+#include "util/u_thread_policy.h"
 
 #include "tracking/t_tracking.h"
 
@@ -61,6 +59,7 @@ DEBUG_GET_ONCE_NUM_OPTION(depthai_startup_wait_frames, "DEPTHAI_STARTUP_WAIT_FRA
 DEBUG_GET_ONCE_NUM_OPTION(depthai_imu_hz, "DEPTHAI_IMU_HZ", 500)
 DEBUG_GET_ONCE_NUM_OPTION(depthai_imu_batch_size, "DEPTHAI_IMU_BATCH_SIZE", 2)
 DEBUG_GET_ONCE_NUM_OPTION(depthai_imu_max_batch_size, "DEPTHAI_IMU_MAX_BATCH_SIZE", 2)
+DEBUG_GET_ONCE_BOOL_OPTION(depthai_gray_on_device, "DEPTHAI_GRAY_ON_DEVICE", false)
 
 
 
@@ -622,10 +621,8 @@ depthai_imu_mainloop(void *ptr)
 	U_TRACE_SET_THREAD_NAME("DepthAI: IMU");
 	os_thread_helper_name(&depthai->imu_thread, "DepthAI: IMU");
 
-#ifdef XRT_OS_LINUX
 	// Try to raise priority of this thread.
-	u_linux_try_to_set_realtime_priority_on_thread(depthai->log_level, "DepthAI: IMU");
-#endif
+	u_thread_policy_apply(depthai->log_level, OS_THREAD_ROLE_IMU, "DepthAI: IMU");
 
 	DEPTHAI_DEBUG(depthai, "DepthAI: IMU thread called");
 
@@ -670,6 +667,34 @@ depthai_destroy(struct depthai_fs *depthai)
 	return true;
 }
 
+/*!
+ * Links a color camera output to the XLink output, optionally through an
+ * ImageManip node that converts the frames to grayscale on the device. The
+ * trackers only use grayscale, this saves converting every frame on the host
+ * and sends a third of the data over USB.
+ */
+static void
+depthai_link_color_output(struct depthai_fs *depthai,
+                          dai::Pipeline &p,
+                          dai::Node::Output &camera_out,
+                          dai::Node::Input &xlink_in)
+{
+	if (!debug_get_bool_option_depthai_gray_on_device()) {
+		camera_out.link(xlink_in);
+		return;
+	}
+
+	auto manip = p.create<dai::node::ImageManip>();
+	manip->initialConfig.setFrameType(dai::ImgFrame::Type::GRAY8);
+	manip->setMaxOutputFrameSize(depthai->width * depthai->height);
+
+	// Link plugins CAM -> MANIP -> XLINK
+	camera_out.link(manip->inputImage);
+	manip->out.link(xlink_in);
+
+	depthai->format = XRT_FORMAT_L8;
+}
+
 static void
 depthai_setup_monocular_pipeline(struct depthai_fs *depthai, enum depthai_camera_type camera_type)
 {
@@ -750,11 +775,9 @@ depthai_setup_monocular_pipeline(struct depthai_fs *depthai, enum depthai_camera
 		colorCam->setFps(depthai->fps);
 		colorCam->setColorOrder(depthai->color_order);
 
-		// Link plugins CAM -> XLINK
-		colorCam->preview.link(xlinkOut->input);
-	}
-
-	if (depthai->format == XRT_FORMAT_L8) {
+		// Link plugins CAM -> XLINK, might change the format.
+		depthai_link_color_output(depthai, p, colorCam->preview, xlinkOut->input);
+	} else if (depthai->format == XRT_FORMAT_L8) {
 		grayCam = p.create<dai::node::MonoCamera>();
 		grayCam->setBoardSocket(depthai->camera_board_socket);
 		grayCam->setResolution(depthai->grayscale_sensor_resolution);
@@ -954,8 +977,8 @@ depthai_setup_stereo_rgb_pipeline(struct depthai_fs *depthai)
 		grayCam->setFps(depthai->fps);
 		grayCam->setColorOrder(dai::ColorCameraProperties::ColorOrder::RGB);
 
-		// Link plugins CAM -> XLINK
-		grayCam->preview.link(xlinkOut->input);
+		// Link plugins CAM -> XLINK, might change the format.
+		depthai_link_color_output(depthai, p, grayCam->preview, xlinkOut->input);
 	}
 
 	p.setXLinkChunkSize(0);
@@ -47,6 +47,8 @@ struct euroc_player_playback_config
 	bool use_source_ts;       //!< If true, use the original timestamps from the dataset
 	bool play_from_start;     //!< If set, the euroc player does not wait for user input to start
 	bool print_progress;      //!< Whether to print progress to stdout (useful for CLI runs)
+	int prefetch;             //!< Number of frames to decode ahead on worker threads, 0 decodes on demand
+	bool lockstep;            //!< Push IMU and frames from one thread in timestamp order without sleeping
 };
 
 /*!
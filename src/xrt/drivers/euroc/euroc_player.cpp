@@ -16,6 +16,7 @@
 #include "util/u_time.h"
 #include "util/u_var.h"
 #include "util/u_sink.h"
+#include "util/u_worker.h"
 #include "tracking/t_frame_cv_mat_wrapper.hpp"
 #include "math/m_api.h"
 #include "math/m_filter_fifo.h"
@@ -25,11 +26,13 @@
 
 #include <algorithm>
 #include <chrono>
+#include <condition_variable>
 #include <cstring>
 #include <stdint.h>
 #include <stdio.h>
 #include <fstream>
 #include <future>
+#include <mutex>
 #include <thread>
 
 //! @see euroc_player_playback_config
@@ -47,6 +50,8 @@ DEBUG_GET_ONCE_BOOL_OPTION(send_all_imus_first, "EUROC_SEND_ALL_IMUS_FIRST", fal
 DEBUG_GET_ONCE_BOOL_OPTION(use_source_ts, "EUROC_USE_SOURCE_TS", false)
 DEBUG_GET_ONCE_BOOL_OPTION(play_from_start, "EUROC_PLAY_FROM_START", false)
 DEBUG_GET_ONCE_BOOL_OPTION(print_progress, "EUROC_PRINT_PROGRESS", false)
+DEBUG_GET_ONCE_NUM_OPTION(prefetch, "EUROC_PREFETCH", 0)
+DEBUG_GET_ONCE_BOOL_OPTION(lockstep, "EUROC_LOCKSTEP", false)
 
 #define EUROC_PLAYER_STR "Euroc Player"
 
@@ -58,11 +63,13 @@ using std::find_if;
 using std::ifstream;
 using std::is_same_v;
 using std::launch;
+using std::lock_guard;
 using std::max_element;
 using std::pair;
 using std::stof;
 using std::string;
 using std::to_string;
+using std::unique_lock;
 using std::vector;
 
 using img_sample = pair<timepoint_ns, string>;
@@ -80,6 +87,32 @@ enum euroc_player_ui_state
 	STREAM_ENDED
 };
 
+struct euroc_player;
+
+/*!
+ * Decodes the frames of the next few sequence numbers on a worker pool, so
+ * that the player only has to wait on disk reads and decoding when the pool
+ * can't keep ahead. Slot `seq % slots.size()` holds the frames for `seq`.
+ */
+struct euroc_player_prefetcher
+{
+	struct slot
+	{
+		euroc_player_prefetcher *pf;
+		uint64_t seq;
+		bool ready; //!< Protected by @ref mutex
+		vector<cv::Mat> imgs;
+	};
+
+	struct euroc_player *ep;
+	int cam_count;
+	struct u_worker_thread_pool *pool;
+	struct u_worker_group *group;
+	std::mutex mutex;
+	std::condition_variable ready_cv; //!< Signalled when a slot becomes ready
+	vector<slot> slots;
+};
+
 /*!
  * Euroc player is in charge of the playback of a particular dataset.
  *
@@ -114,6 +147,9 @@ struct euroc_player
 	vector<img_samples> *imgs; //!< List of all image names to read from the dataset per camera
 	gt_trajectory *gt;         //!< List of all groundtruth poses read from the dataset
 
+	//! Only while streaming with @ref euroc_player_playback_config::prefetch set.
+	euroc_player_prefetcher *prefetcher;
+
 	// Timestamp correction fields (can be disabled through `use_source_ts`)
 	timepoint_ns base_ts;   //!< First sample timestamp, stream timestamps are relative to this
 	timepoint_ns start_ts;  //!< When did the dataset started to be played
@@ -421,21 +457,19 @@ euroc_player_mapped_playback_ts(struct euroc_player *ep, timepoint_ns ts)
 	return euroc_player_mapped_ts(ep, ts);
 }
 
-static void
-euroc_player_load_next_frame(struct euroc_player *ep, int cam_index, struct xrt_frame *&xf)
+//! Read and decode frame @p seq of a camera, can be called from the prefetch workers.
+static cv::Mat
+euroc_player_decode_img(struct euroc_player *ep, int cam_index, uint64_t seq)
 {
-	using xrt::auxiliary::tracking::FrameMat;
-	img_sample sample = ep->imgs->at(cam_index).at(ep->img_seq);
-	ep->playback.scale = CLAMP(ep->playback.scale, 1.0 / 16, 4);
+	const img_sample &sample = ep->imgs->at(cam_index).at(seq);
 
 	// Load will be influenced by these playback options
 	bool allow_color = ep->playback.color;
-	float scale = ep->playback.scale;
+	float scale = CLAMP(ep->playback.scale, 1.0 / 16, 4);
 
 	// Load image from disk
-	timepoint_ns timestamp = euroc_player_mapped_playback_ts(ep, sample.first);
-	string img_name = sample.second;
-	EUROC_TRACE(ep, "cam%d img t = %ld filename = %s", cam_index, timestamp, img_name.c_str());
+	const string &img_name = sample.second;
+	EUROC_TRACE(ep, "cam%d img seq = %" PRIu64 " filename = %s", cam_index, seq, img_name.c_str());
 	cv::ImreadModes read_mode = allow_color ? cv::IMREAD_ANYCOLOR : cv::IMREAD_GRAYSCALE;
 	cv::Mat img = cv::imread(img_name, read_mode); // If colored, reads in BGR order
 
@@ -445,6 +479,119 @@ euroc_player_load_next_frame(struct euroc_player *ep, int cam_index, struct xrt_
 		img = tmp;
 	}
 
+	return img;
+}
+
+static void
+euroc_player_prefetch_task(void *ptr)
+{
+	auto *s = (euroc_player_prefetcher::slot *)ptr;
+	euroc_player_prefetcher *pf = s->pf;
+
+	vector<cv::Mat> imgs(pf->cam_count);
+	for (int i = 0; i < pf->cam_count; i++) {
+		imgs[i] = euroc_player_decode_img(pf->ep, i, s->seq);
+	}
+
+	{
+		lock_guard lock{pf->mutex};
+		s->imgs = std::move(imgs);
+		s->ready = true;
+	}
+	pf->ready_cv.notify_all();
+}
+
+//! Start decoding the frames for @p seq, its slot must not be in use.
+static void
+euroc_player_prefetch_push(euroc_player_prefetcher *pf, uint64_t seq)
+{
+	if (seq >= pf->ep->imgs->at(0).size()) {
+		return;
+	}
+
+	euroc_player_prefetcher::slot &s = pf->slots[seq % pf->slots.size()];
+	{
+		lock_guard lock{pf->mutex};
+		s.seq = seq;
+		s.ready = false;
+	}
+	u_worker_group_push(pf->group, euroc_player_prefetch_task, &s);
+}
+
+//! Wait for the frames of @p seq and reuse their slot for the next sequence number.
+static vector<cv::Mat>
+euroc_player_prefetch_take(euroc_player_prefetcher *pf, uint64_t seq)
+{
+	euroc_player_prefetcher::slot &s = pf->slots[seq % pf->slots.size()];
+
+	vector<cv::Mat> imgs;
+	{
+		unique_lock lock{pf->mutex};
+		pf->ready_cv.wait(lock, [&s] { return s.ready; });
+		EUROC_ASSERT(s.seq == seq, "Prefetched frame %" PRIu64 " but wanted %" PRIu64, s.seq, seq);
+		imgs = std::move(s.imgs);
+		s.ready = false;
+	}
+
+	euroc_player_prefetch_push(pf, seq + pf->slots.size());
+
+	return imgs;
+}
+
+static void
+euroc_player_prefetch_start(struct euroc_player *ep)
+{
+	if (ep->playback.prefetch <= 0) {
+		return;
+	}
+
+	euroc_player_prefetcher *pf = new euroc_player_prefetcher{};
+	pf->ep = ep;
+	pf->cam_count = ep->playback.cam_count;
+	pf->slots.resize(ep->playback.prefetch);
+	for (euroc_player_prefetcher::slot &s : pf->slots) {
+		s.pf = pf;
+	}
+
+	// Decoding is mostly independent per frame, but don't use more threads than slots.
+	uint32_t thread_count = MIN((uint32_t)ep->playback.prefetch, std::thread::hardware_concurrency());
+	thread_count = MAX(thread_count, 1u);
+	pf->pool = u_worker_thread_pool_create(thread_count, thread_count, "EuRoC Prefetch");
+	pf->group = u_worker_group_create(pf->pool);
+
+	for (uint64_t i = 0; i < pf->slots.size(); i++) {
+		euroc_player_prefetch_push(pf, ep->img_seq + i);
+	}
+
+	ep->prefetcher = pf;
+}
+
+static void
+euroc_player_prefetch_stop(struct euroc_player *ep)
+{
+	euroc_player_prefetcher *pf = ep->prefetcher;
+	if (pf == nullptr) {
+		return;
+	}
+
+	// Tasks reference the slots.
+	u_worker_group_wait_all(pf->group);
+	u_worker_group_reference(&pf->group, NULL);
+	u_worker_thread_pool_reference(&pf->pool, NULL);
+
+	delete pf;
+	ep->prefetcher = nullptr;
+}
+
+static void
+euroc_player_load_next_frame(struct euroc_player *ep, int cam_index, cv::Mat img, struct xrt_frame *&xf)
+{
+	using xrt::auxiliary::tracking::FrameMat;
+	img_sample sample = ep->imgs->at(cam_index).at(ep->img_seq);
+	ep->playback.scale = CLAMP(ep->playback.scale, 1.0 / 16, 4);
+
+	timepoint_ns timestamp = euroc_player_mapped_playback_ts(ep, sample.first);
+
 	// Create xrt_frame, it will be freed by FrameMat destructor
 	EUROC_ASSERT(xf == NULL || xf->reference.count > 0, "Must be given a valid or NULL frame ptr");
 	EUROC_ASSERT(timestamp >= 0, "Unexpected negative timestamp");
@@ -466,9 +613,19 @@ euroc_player_push_next_frame(struct euroc_player *ep)
 {
 	int cam_count = ep->playback.cam_count;
 
+	vector<cv::Mat> imgs;
+	if (ep->prefetcher != nullptr) {
+		imgs = euroc_player_prefetch_take(ep->prefetcher, ep->img_seq);
+		EUROC_ASSERT((int)imgs.size() == cam_count, "Camera count changed while streaming");
+	} else {
+		for (int i = 0; i < cam_count; i++) {
+			imgs.push_back(euroc_player_decode_img(ep, i, ep->img_seq));
+		}
+	}
+
 	vector<xrt_frame *> xfs(cam_count, nullptr);
 	for (int i = 0; i < cam_count; i++) {
-		euroc_player_load_next_frame(ep, i, xfs[i]);
+		euroc_player_load_next_frame(ep, i, imgs[i], xfs[i]);
 	}
 
 	// TODO: Some SLAM systems expect synced frames, but that's not an
@@ -597,6 +754,37 @@ euroc_player_stream_samples(struct euroc_player *ep)
 	}
 }
 
+/*!
+ * Push both IMU and frame samples from this thread in dataset timestamp order
+ * and without sleeping, so samples go out as fast as the sinks take them and
+ * always in the same order, unlike the two threads used for max speed.
+ */
+static void
+euroc_player_stream_lockstep(struct euroc_player *ep)
+{
+	while (ep->is_running) {
+		while (ep->playback.paused) {
+			constexpr int64_t PAUSE_POLL_INTERVAL_NS = 15L * U_TIME_1MS_IN_NS;
+			os_nanosleep(PAUSE_POLL_INTERVAL_NS);
+		}
+
+		bool imus_left = ep->imu_seq < ep->imus->size();
+		bool imgs_left = ep->img_seq < ep->imgs->at(0).size();
+		if (!imus_left && !imgs_left) {
+			break;
+		}
+
+		// On ties the IMU goes first, so the sample is there when the frame arrives.
+		bool imu_next = imus_left && (!imgs_left || euroc_player_get_next_euroc_ts<imu_samples>(ep) <=
+		                                                euroc_player_get_next_euroc_ts<img_samples>(ep));
+		if (imu_next) {
+			euroc_player_push_next_imu(ep);
+		} else {
+			euroc_player_push_next_frame(ep);
+		}
+	}
+}
+
 static void *
 euroc_player_stream(void *ptr)
 {
@@ -621,15 +809,23 @@ euroc_player_stream(void *ptr)
 		euroc_player_push_all_gt(ep);
 	}
 
-	// Launch image and IMU producers
-	auto serve_imus = async(launch::async, [ep] { euroc_player_stream_samples<imu_samples>(ep); });
-	auto serve_imgs = async(launch::async, [ep] { euroc_player_stream_samples<img_samples>(ep); });
-	// Note that the only fields of `ep` being modified in the threads are: img_seq, imu_seq and
-	// progress_text in single locations, thus no race conditions should occur.
+	euroc_player_prefetch_start(ep);
+
+	if (ep->playback.lockstep) {
+		euroc_player_stream_lockstep(ep);
+	} else {
+		// Launch image and IMU producers
+		auto serve_imus = async(launch::async, [ep] { euroc_player_stream_samples<imu_samples>(ep); });
+		auto serve_imgs = async(launch::async, [ep] { euroc_player_stream_samples<img_samples>(ep); });
+		// Note that the only fields of `ep` being modified in the threads are: img_seq, imu_seq and
+		// progress_text in single locations, thus no race conditions should occur.
+
+		// Wait for the end of both streams
+		serve_imgs.get();
+		serve_imus.get();
+	}
 
-	// Wait for the end of both streams
-	serve_imgs.get();
-	serve_imus.get();
+	euroc_player_prefetch_stop(ep);
 
 	ep->is_running = false;
 
@@ -909,6 +1105,8 @@ euroc_player_setup_gui(struct euroc_player *ep)
 	u_var_add_f64(ep, &ep->playback.speed, "Speed");
 	u_var_add_bool(ep, &ep->playback.send_all_imus_first, "Send all IMU samples first");
 	u_var_add_bool(ep, &ep->playback.use_source_ts, "Use original timestamps");
+	u_var_add_i32(ep, &ep->playback.prefetch, "Frames to decode ahead");
+	u_var_add_bool(ep, &ep->playback.lockstep, "Lockstep, ordered max speed");
 
 	u_var_add_gui_header(ep, NULL, "Streams");
 	u_var_add_ro_ff_vec3_f32(ep, ep->gyro_ff, "Gyroscope");
@@ -945,6 +1143,8 @@ euroc_player_fill_default_config_for(struct euroc_player_config *config, const c
 	playback.use_source_ts = debug_get_bool_option_use_source_ts();
 	playback.play_from_start = debug_get_bool_option_play_from_start();
 	playback.print_progress = debug_get_bool_option_print_progress();
+	playback.prefetch = (int)debug_get_num_option_prefetch();
+	playback.lockstep = debug_get_bool_option_lockstep();
 
 	config->log_level = debug_get_log_option_euroc_log();
 	config->dataset = dataset;
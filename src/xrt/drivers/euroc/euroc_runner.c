@@ -1,4 +1,4 @@
-// Copyright 2022, Collabora, Ltd.
+// Copyright 2022-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -54,6 +54,12 @@ make_euroc_player_config(const char *euroc_path)
 	if (getenv("EUROC_MAX_SPEED") == NULL) {
 		ep_config->playback.max_speed = true;
 	}
+	if (getenv("EUROC_PREFETCH") == NULL) {
+		ep_config->playback.prefetch = 16;
+	}
+	if (getenv("EUROC_LOCKSTEP") == NULL) {
+		ep_config->playback.lockstep = true;
+	}
 
 	return ep_config;
 }
@@ -77,6 +83,9 @@ make_slam_tracker_config(const char *slam_config, const char *output_path)
 	if (getenv("SLAM_WRITE_CSVS") == NULL) {
 		st_config->write_csvs = true;
 	}
+	if (getenv("SLAM_BACKPRESSURE") == NULL) {
+		st_config->backpressure = false; // Evaluation wants every frame
+	}
 
 	st_config->slam_config = slam_config;
 	st_config->csv_path = output_path;
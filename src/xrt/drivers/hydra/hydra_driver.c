@@ -34,7 +34,7 @@
 #include "util/u_misc.h"
 #include "util/u_time.h"
 #include "util/u_logging.h"
-#include "util/u_linux.h"
+#include "util/u_thread_policy.h"
 #include "util/u_trace_marker.h"
 #include "util/u_var.h"
 
@@ -517,10 +517,8 @@ hydra_usb_thread_run(void *user_data)
 	U_TRACE_SET_THREAD_NAME(thread_name);
 	os_thread_helper_name(&hs->usb_thread, thread_name);
 
-#ifdef XRT_OS_LINUX
 	// Try to raise priority of this thread.
-	u_linux_try_to_set_realtime_priority_on_thread(hs->log_level, thread_name);
-#endif
+	u_thread_policy_apply(hs->log_level, OS_THREAD_ROLE_IMU, thread_name);
 
 	os_thread_helper_lock(&hs->usb_thread);
 
@@ -1,4 +1,4 @@
-// Copyright 2021, Collabora, Ltd.
+// Copyright 2021-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -10,7 +10,11 @@
 #include "math/m_api.h"
 #include "math/m_space.h"
 
+#include "os/os_time.h"
+#include "os/os_threading.h"
+
 #include "util/u_misc.h"
+#include "util/u_time.h"
 #include "util/u_debug.h"
 #include "util/u_device.h"
 
@@ -24,6 +28,26 @@ DEBUG_GET_ONCE_LOG_OPTION(multi_log, "MULTI_LOG", U_LOGGING_WARN)
 #define MULTI_WARN(d, ...) U_LOG_XDEV_IFL_W(&d->base, d->log_level, __VA_ARGS__)
 #define MULTI_ERROR(d, ...) U_LOG_XDEV_IFL_E(&d->base, d->log_level, __VA_ARGS__)
 
+//! Number of recent results kept, several callers usually ask for the same few timestamps.
+#define MULTI_POSE_CACHE_SIZE (4)
+
+//! Results older than this are recomputed, the devices might have gotten new samples since.
+#define MULTI_POSE_CACHE_MAX_AGE_NS (U_TIME_1MS_IN_NS)
+
+/*!
+ * A resolved relation of the wrapped device.
+ */
+struct multi_pose_cache_entry
+{
+	enum xrt_input_name name;
+	int64_t at_timestamp_ns;
+
+	//! When the relation was computed, zero if the entry is unused.
+	int64_t computed_ns;
+
+	struct xrt_space_relation relation;
+};
+
 struct multi_device
 {
 	struct xrt_device base;
@@ -38,6 +62,17 @@ struct multi_device
 	} tracking_override;
 
 	enum xrt_tracking_override_type override_type;
+
+	/*!
+	 * Results of @ref get_tracked_pose, so that asking for the same
+	 * timestamp again doesn't query both devices and resolve the chain.
+	 */
+	struct
+	{
+		struct os_mutex mutex;
+		struct multi_pose_cache_entry entries[MULTI_POSE_CACHE_SIZE];
+		uint32_t next;
+	} pose_cache;
 };
 
 static void
@@ -78,13 +113,59 @@ attached_override(struct multi_device *d,
 	m_relation_chain_resolve(&xrc, out_relation);
 }
 
+static bool
+pose_cache_get(struct multi_device *d,
+               enum xrt_input_name name,
+               int64_t at_timestamp_ns,
+               int64_t now_ns,
+               struct xrt_space_relation *out_relation)
+{
+	bool found = false;
+
+	os_mutex_lock(&d->pose_cache.mutex);
+	for (uint32_t i = 0; i < MULTI_POSE_CACHE_SIZE; i++) {
+		const struct multi_pose_cache_entry *entry = &d->pose_cache.entries[i];
+
+		if (entry->computed_ns == 0 || entry->name != name || entry->at_timestamp_ns != at_timestamp_ns ||
+		    now_ns - entry->computed_ns > MULTI_POSE_CACHE_MAX_AGE_NS) {
+			continue;
+		}
+
+		*out_relation = entry->relation;
+		found = true;
+		break;
+	}
+	os_mutex_unlock(&d->pose_cache.mutex);
+
+	return found;
+}
+
+static void
+pose_cache_put(struct multi_device *d,
+               enum xrt_input_name name,
+               int64_t at_timestamp_ns,
+               int64_t now_ns,
+               const struct xrt_space_relation *relation)
+{
+	os_mutex_lock(&d->pose_cache.mutex);
+
+	struct multi_pose_cache_entry *entry = &d->pose_cache.entries[d->pose_cache.next];
+	d->pose_cache.next = (d->pose_cache.next + 1) % MULTI_POSE_CACHE_SIZE;
+
+	entry->name = name;
+	entry->at_timestamp_ns = at_timestamp_ns;
+	entry->computed_ns = now_ns;
+	entry->relation = *relation;
+
+	os_mutex_unlock(&d->pose_cache.mutex);
+}
+
 static xrt_result_t
-get_tracked_pose(struct xrt_device *xdev,
-                 enum xrt_input_name name,
-                 int64_t at_timestamp_ns,
-                 struct xrt_space_relation *out_relation)
+resolve_tracked_pose(struct multi_device *d,
+                     enum xrt_input_name name,
+                     int64_t at_timestamp_ns,
+                     struct xrt_space_relation *out_relation)
 {
-	struct multi_device *d = (struct multi_device *)xdev;
 	struct xrt_device *tracker = d->tracking_override.tracker;
 	enum xrt_input_name tracker_input_name = d->tracking_override.input_name;
 
@@ -125,6 +206,30 @@ get_tracked_pose(struct xrt_device *xdev,
 	return xret;
 }
 
+static xrt_result_t
+get_tracked_pose(struct xrt_device *xdev,
+                 enum xrt_input_name name,
+                 int64_t at_timestamp_ns,
+                 struct xrt_space_relation *out_relation)
+{
+	struct multi_device *d = (struct multi_device *)xdev;
+	int64_t now_ns = os_monotonic_get_ns();
+
+	if (pose_cache_get(d, name, at_timestamp_ns, now_ns, out_relation)) {
+		return XRT_SUCCESS;
+	}
+
+	// Not holding the lock here, the devices might take their own.
+	xrt_result_t xret = resolve_tracked_pose(d, name, at_timestamp_ns, out_relation);
+	if (xret != XRT_SUCCESS) {
+		return xret;
+	}
+
+	pose_cache_put(d, name, at_timestamp_ns, now_ns, out_relation);
+
+	return XRT_SUCCESS;
+}
+
 static void
 destroy(struct xrt_device *xdev)
 {
@@ -135,6 +240,8 @@ destroy(struct xrt_device *xdev)
 	// we replaced the target device with us, but no the tracker
 	// xrt_device_destroy(&d->tracking_override.tracker);
 
+	os_mutex_destroy(&d->pose_cache.mutex);
+
 	free(d);
 }
 
@@ -246,6 +353,11 @@ multi_create_tracking_override(enum xrt_tracking_override_type override_type,
 		return NULL;
 	}
 
+	if (os_mutex_init(&d->pose_cache.mutex) != 0) {
+		free(d);
+		return NULL;
+	}
+
 	d->log_level = debug_get_log_option_multi_log();
 	d->override_type = override_type;
 
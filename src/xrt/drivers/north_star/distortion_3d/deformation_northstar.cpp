@@ -4,6 +4,11 @@
 
 #include "deformation_northstar.h"
 
+#include <vector>
+#include <algorithm>
+
+
+
 
 OpticalSystem::OpticalSystem(const OpticalSystem &_in)
 {
@@ -207,6 +212,182 @@ OpticalSystem::SolveDisplayUVToRenderUV(const Vector2 &inputUV, Vector2 const &i
 	return curCameraUV;
 }
 
+void
+OpticalSystem::RenderUVsToDisplayUVs(RaytraceBatch &batch)
+{
+	// The parts of RenderUVToDisplayUV that are the same for every UV, copied
+	// so the compiler knows the output stores can't change them.
+	const Vector3 e = eyePosition;
+	const Vector3 o = worldToSphereSpace.MultiplyPoint(eyePosition);
+	const Vector3 sf = screenForward;
+	const Vector3 sp = screenPosition;
+	const Matrix4x4 c2w = clipToWorld;
+	const Matrix4x4 w2s = worldToSphereSpace;
+	const Matrix4x4 s2w = sphereToWorldSpace;
+	const Matrix4x4 scr = worldToScreenSpace;
+	const float minorSqrd = powf(ellipseMinorAxis / 2.f, 2.f);
+	const float majorSqrd = powf(ellipseMajorAxis / 2.f, 2.f);
+
+	// Branch free so the compiler can vectorize, misses are selected at the end.
+	for (size_t i = 0; i < kRaytraceBatch; i++) {
+		// ViewportPointToRayDirection
+		float tx = (batch.u[i] - 0.5f) * 2.f;
+		float ty = (batch.v[i] - 0.5f) * 2.f;
+		float cw = 1.f / (c2w.m30 * tx + c2w.m31 * ty + c2w.m33);
+		float rx = (c2w.m00 * tx + c2w.m01 * ty + c2w.m03) * cw - e.x;
+		float ry = (c2w.m10 * tx + c2w.m11 * ty + c2w.m13) * cw - e.y;
+		float rz = (c2w.m20 * tx + c2w.m21 * ty + c2w.m23) * cw - e.z;
+		float rmag = sqrtf(rx * rx + ry * ry + rz * rz);
+		rx /= rmag;
+		ry /= rmag;
+		rz /= rmag;
+
+		// Ray direction in sphere space.
+		float qx = e.x + rx;
+		float qy = e.y + ry;
+		float qz = e.z + rz;
+		float qw = 1.f / (w2s.m30 * qx + w2s.m31 * qy + w2s.m32 * qz + w2s.m33);
+		float dx = (w2s.m00 * qx + w2s.m01 * qy + w2s.m02 * qz + w2s.m03) * qw - o.x;
+		float dy = (w2s.m10 * qx + w2s.m11 * qy + w2s.m12 * qz + w2s.m13) * qw - o.y;
+		float dz = (w2s.m20 * qx + w2s.m21 * qy + w2s.m22 * qz + w2s.m23) * qw - o.z;
+		float dmag = sqrtf(dx * dx + dy * dy + dz * dz);
+		dx /= dmag;
+		dy /= dmag;
+		dz /= dmag;
+
+		// intersectLineSphere with the back side of the sphere.
+		float ld = -o.x * dx + -o.y * dy + -o.z * dz;
+		float ox = dx * ld + o.x;
+		float oy = dy * ld + o.y;
+		float oz = dz * ld + o.z;
+		float offSqrd = ox * ox + oy * oy + oz * oz;
+		// Misses are thrown away, the abs only keeps them from making NaNs.
+		float sphereT = ld + sqrtf(fabsf(0.25f - offSqrd));
+		bool hit = (offSqrd <= 0.25f) & (sphereT >= 0.f);
+
+		float ix = o.x + dx * sphereT;
+		float iy = o.y + dy * sphereT;
+		float iz = o.z + dz * sphereT;
+
+		// Ellipsoid normal.
+		float imag = sqrtf(ix * ix + iy * iy + iz * iz);
+		float nx = -ix / imag / minorSqrd;
+		float ny = -iy / imag / minorSqrd;
+		float nz = -iz / imag / majorSqrd;
+		float nmag = sqrtf(nx * nx + ny * ny + nz * nz);
+		nx /= nmag;
+		ny /= nmag;
+		nz /= nmag;
+
+		// The last row of sphereToWorldSpace is always 0, 0, 0, 1.
+		float wx = s2w.m00 * ix + s2w.m01 * iy + s2w.m02 * iz + s2w.m03;
+		float wy = s2w.m10 * ix + s2w.m11 * iy + s2w.m12 * iz + s2w.m13;
+		float wz = s2w.m20 * ix + s2w.m21 * iy + s2w.m22 * iz + s2w.m23;
+		float wnx = s2w.m00 * nx + s2w.m01 * ny + s2w.m02 * nz;
+		float wny = s2w.m10 * nx + s2w.m11 * ny + s2w.m12 * nz;
+		float wnz = s2w.m20 * nx + s2w.m21 * ny + s2w.m22 * nz;
+		float wnmag = sqrtf(wnx * wnx + wny * wny + wnz * wnz);
+		wnx /= wnmag;
+		wny /= wnmag;
+		wnz /= wnmag;
+
+		// Vector3::Reflect followed by the normalize done by Ray.
+		float dn = wnx * rx + wny * ry + wnz * rz;
+		float fx = wnx * -2.f * dn + rx;
+		float fy = wny * -2.f * dn + ry;
+		float fz = wnz * -2.f * dn + rz;
+		float fmag = sqrtf(fx * fx + fy * fy + fz * fz);
+		float finv = (fmag > kEpsilon ? 1.f : 0.f) / std::max(fmag, kEpsilon);
+		fx *= finv;
+		fy *= finv;
+		fz *= finv;
+
+		// intersectPlane
+		float denom = -sf.x * fx + -sf.y * fy + -sf.z * fz;
+		float planeT = ((sp.x - wx) * -sf.x + (sp.y - wy) * -sf.y + (sp.z - wz) * -sf.z) / denom;
+		hit = hit & (denom > 1.4e-45f) & (planeT >= 0.f);
+
+		float px = wx + fx * planeT;
+		float py = wy + fy * planeT;
+		float pz = wz + fz * planeT;
+
+		float sx = scr.m00 * px + scr.m01 * py + scr.m02 * pz + scr.m03;
+		float sy = scr.m10 * px + scr.m11 * py + scr.m12 * pz + scr.m13;
+
+		batch.x[i] = hit ? 1.f - (sy + 0.5f) : 0.f;
+		batch.y[i] = hit ? 1.f - (sx + 0.5f) : 0.f;
+	}
+}
+
+void
+OpticalSystem::SolveDisplayUVsToRenderUVs(const Vector2 *inputUVs, Vector2 *outUVs, size_t count, int iterations)
+{
+	static const float epsilon = 0.0001f;
+	const size_t k = kSolveBatch;
+
+	for (size_t start = 0; start < count; start += k) {
+		size_t n = std::min(k, count - start);
+
+		// Unused lanes solve for the centre, simpler than masking them out.
+		float inX[kSolveBatch];
+		float inY[kSolveBatch];
+		float curX[kSolveBatch];
+		float curY[kSolveBatch];
+		for (size_t i = 0; i < k; i++) {
+			inX[i] = i < n ? inputUVs[start + i].x : 0.5f;
+			inY[i] = i < n ? inputUVs[start + i].y : 0.5f;
+			curX[i] = 0.5f;
+			curY[i] = 0.5f;
+		}
+
+		RaytraceBatch batch;
+
+		for (int iter = 0; iter < iterations; iter++) {
+			// The current guess and the two points for its gradient.
+			for (size_t i = 0; i < k; i++) {
+				batch.u[i] = curX[i];
+				batch.v[i] = curY[i];
+				batch.u[i + k] = curX[i] + epsilon;
+				batch.v[i + k] = curY[i];
+				batch.u[i + k * 2] = curX[i];
+				batch.v[i + k * 2] = curY[i] + epsilon;
+			}
+
+			RenderUVsToDisplayUVs(batch);
+
+			const float *dispX = batch.x;
+			const float *dispY = batch.y;
+
+			for (size_t i = 0; i < k; i++) {
+				float gradXX = (dispX[i + k] - dispX[i]) / epsilon;
+				float gradXY = (dispY[i + k] - dispY[i]) / epsilon;
+				float gradYX = (dispX[i + k * 2] - dispX[i]) / epsilon;
+				float gradYY = (dispY[i + k * 2] - dispY[i]) / epsilon;
+
+				float errorX = dispX[i] - inX[i];
+				float errorY = dispY[i] - inY[i];
+
+				float stepX = 0.f;
+				float stepY = 0.f;
+				if (gradXX != 0.f || gradXY != 0.f) {
+					stepX += gradXX * errorX;
+					stepY += gradXY * errorX;
+				}
+				if (gradYX != 0.f || gradYY != 0.f) {
+					stepX += gradYX * errorY;
+					stepY += gradYY * errorY;
+				}
+
+				curX[i] -= stepX / 7.f;
+				curY[i] -= stepY / 7.f;
+			}
+		}
+
+		for (size_t i = 0; i < n; i++) {
+			outUVs[start + i] = Vector2(curX[i], curY[i]);
+		}
+	}
+}
 
 Vector2
 OpticalSystem::DisplayUVToRenderUVPreviousSeed(const Vector2 &inputUV)
@@ -284,3 +465,22 @@ ns_3d_display_uv_to_render_uv(struct xrt_vec2 in, struct xrt_vec2 *out, struct n
 	out->x = outUV.x;
 	out->y = outUV.y;
 }
+
+extern "C" void
+ns_3d_display_uvs_to_render_uvs(const struct xrt_vec2 *in, struct xrt_vec2 *out, uint32_t count, struct ns_3d_eye *eye)
+{
+	OpticalSystem *opticalSystem = (OpticalSystem *)eye->optical_system;
+
+	std::vector<Vector2> inUVs(count);
+	std::vector<Vector2> outUVs(count);
+	for (uint32_t i = 0; i < count; i++) {
+		inUVs[i] = Vector2(in[i].x, 1.f - in[i].y);
+	}
+
+	opticalSystem->DisplayUVsToRenderUVs(inUVs.data(), outUVs.data(), count);
+
+	for (uint32_t i = 0; i < count; i++) {
+		out[i].x = outUVs[i].x;
+		out[i].y = outUVs[i].y;
+	}
+}
@@ -9,6 +9,19 @@
 #include <map>
 
 
+// UVs solved at the same time, each needs three raytraces per iteration.
+static constexpr size_t kSolveBatch = 8;
+static constexpr size_t kRaytraceBatch = kSolveBatch * 3;
+
+// Render UVs in and display UVs out, one struct so they can't alias.
+struct RaytraceBatch
+{
+	float u[kRaytraceBatch];
+	float v[kRaytraceBatch];
+	float x[kRaytraceBatch];
+	float y[kRaytraceBatch];
+};
+
 class OpticalSystem
 {
 public:
@@ -37,6 +50,17 @@ public:
 	Vector2
 	DisplayUVToRenderUVPreviousSeed(const Vector2 &inputUV);
 
+	// Same as SolveDisplayUVToRenderUV started from the centre, but solves
+	// several UVs at once laid out so the raytrace vectorizes across them.
+	void
+	SolveDisplayUVsToRenderUVs(const Vector2 *inputUVs, Vector2 *outUVs, size_t count, int iterations);
+
+	void
+	DisplayUVsToRenderUVs(const Vector2 *inputUVs, Vector2 *outUVs, size_t count)
+	{
+		SolveDisplayUVsToRenderUVs(inputUVs, outUVs, count, m_iniSolverIters);
+	}
+
 	void
 	RegenerateMesh();
 
@@ -90,6 +114,10 @@ public:
 	}
 
 private:
+	// RenderUVToDisplayUV on a fixed size batch of render UVs.
+	void
+	RenderUVsToDisplayUVs(RaytraceBatch &batch);
+
 	float ellipseMinorAxis;
 	float ellipseMajorAxis;
 	Vector3 screenForward;
@@ -27,6 +27,7 @@
 #include "util/u_debug.h"
 #include "util/u_device.h"
 #include "util/u_time.h"
+#include "util/u_distortion_cache.h"
 
 #include "math/m_space.h"
 
@@ -359,6 +360,8 @@ ns_hmd_destroy(struct xrt_device *xdev)
 	if (ns->config.distortion_type == NS_DISTORTION_TYPE_GEOMETRIC_3D) {
 		ns_3d_free_optical_system(&ns->config.dist_3d.eyes[0].optical_system);
 		ns_3d_free_optical_system(&ns->config.dist_3d.eyes[1].optical_system);
+		// Both tables are in one allocation.
+		free(ns->config.dist_3d.eyes[0].lut);
 	} else if (ns->config.distortion_type == NS_DISTORTION_TYPE_MOSHI_MESHGRID) {
 		free(ns->config.dist_meshgrid.grid[0]);
 		free(ns->config.dist_meshgrid.grid[1]);
@@ -418,6 +421,74 @@ ns_hmd_get_view_poses(struct xrt_device *xdev,
 	return XRT_SUCCESS;
 }
 
+/*
+ *
+ * 3D distortion lookup table.
+ *
+ */
+
+static void
+ns_3d_lut_sample(const struct xrt_vec2 *lut, float u, float v, struct xrt_vec2 *out)
+{
+	const int last = NS_3D_LUT_DIM - 1;
+
+	float x = CLAMP(u, 0.0f, 1.0f) * (float)last;
+	float y = CLAMP(v, 0.0f, 1.0f) * (float)last;
+	int x0 = MIN((int)x, last - 1);
+	int y0 = MIN((int)y, last - 1);
+	float fx = x - (float)x0;
+	float fy = y - (float)y0;
+
+	const struct xrt_vec2 *row0 = &lut[y0 * NS_3D_LUT_DIM + x0];
+	const struct xrt_vec2 *row1 = row0 + NS_3D_LUT_DIM;
+
+	out->x = (row0[0].x * (1.0f - fx) + row0[1].x * fx) * (1.0f - fy) + //
+	         (row1[0].x * (1.0f - fx) + row1[1].x * fx) * fy;
+	out->y = (row0[0].y * (1.0f - fx) + row0[1].y * fx) * (1.0f - fy) + //
+	         (row1[0].y * (1.0f - fx) + row1[1].y * fx) * fy;
+}
+
+/*!
+ * Solving the optics is slow, so solve a grid per eye once, batched, and
+ * sample that instead. The grid is kept in the distortion cache so later
+ * starts skip the solving completely.
+ */
+static void
+ns_3d_build_luts(struct ns_hmd *ns)
+{
+	struct ns_3d_values *values = &ns->config.dist_3d;
+
+	uint32_t lut_count = NS_3D_LUT_DIM * NS_3D_LUT_DIM;
+	size_t size = sizeof(struct xrt_vec2) * lut_count * 2;
+	struct xrt_vec2 *luts = U_TYPED_ARRAY_CALLOC(struct xrt_vec2, lut_count * 2);
+
+	// Made while the tables aren't set, so the key's probes are solved directly.
+	uint32_t key_params[1] = {NS_3D_LUT_DIM};
+	uint64_t key = 0;
+	bool have_key = u_distortion_cache_make_key(&ns->base, key_params, sizeof(key_params), &key);
+
+	if (!have_key || !u_distortion_cache_load(key, "ns_3d_lut", luts, size)) {
+		struct xrt_vec2 *uvs = U_TYPED_ARRAY_CALLOC(struct xrt_vec2, lut_count);
+		for (uint32_t row = 0; row < NS_3D_LUT_DIM; row++) {
+			for (uint32_t col = 0; col < NS_3D_LUT_DIM; col++) {
+				uvs[row * NS_3D_LUT_DIM + col].x = (float)col / (float)(NS_3D_LUT_DIM - 1);
+				uvs[row * NS_3D_LUT_DIM + col].y = (float)row / (float)(NS_3D_LUT_DIM - 1);
+			}
+		}
+
+		ns_3d_display_uvs_to_render_uvs(uvs, &luts[0], lut_count, &values->eyes[0]);
+		ns_3d_display_uvs_to_render_uvs(uvs, &luts[lut_count], lut_count, &values->eyes[1]);
+		free(uvs);
+
+		if (have_key) {
+			u_distortion_cache_store(key, "ns_3d_lut", luts, size);
+		}
+	}
+
+	values->eyes[0].lut = &luts[0];
+	values->eyes[1].lut = &luts[lut_count];
+}
+
 static xrt_result_t
 ns_mesh_calc(struct xrt_device *xdev, uint32_t view, float u, float v, struct xrt_uv_triplet *result)
 {
@@ -427,10 +498,15 @@ ns_mesh_calc(struct xrt_device *xdev, uint32_t view, float u, float v, struct xr
 
 	switch (ns->config.distortion_type) {
 	case NS_DISTORTION_TYPE_GEOMETRIC_3D: {
+		struct ns_3d_eye *eye = &ns->config.dist_3d.eyes[view];
 		struct xrt_vec2 uv = {u, v};
 		struct xrt_vec2 warped_uv = {0.0f, 0.0f};
 
-		ns_3d_display_uv_to_render_uv(uv, &warped_uv, &ns->config.dist_3d.eyes[view]);
+		if (eye->lut != NULL) {
+			ns_3d_lut_sample(eye->lut, u, v, &warped_uv);
+		} else {
+			ns_3d_display_uvs_to_render_uvs(&uv, &warped_uv, 1, eye);
+		}
 
 		result->r.x = warped_uv.x;
 		result->r.y = warped_uv.y;
@@ -538,6 +614,9 @@ ns_hmd_create(const cJSON *config_json)
 	uint64_t end;
 
 	start = os_monotonic_get_ns();
+	if (ns->config.distortion_type == NS_DISTORTION_TYPE_GEOMETRIC_3D) {
+		ns_3d_build_luts(ns);
+	}
 	u_distortion_mesh_fill_in_compute(&ns->base);
 	end = os_monotonic_get_ns();
 
@@ -41,6 +41,15 @@ extern "C" {
  */
 struct ns_3d_optical_system;
 
+/*!
+ * Size of the per eye lookup table the 3D distortion is sampled from, one more
+ * than a power of two so that the vertices of the distortion mesh land exactly
+ * on its samples.
+ *
+ * @ingroup drv_ns
+ */
+#define NS_3D_LUT_DIM 129
+
 /*!
  * Distortion information about an eye parsed from the configuration file.
  *
@@ -63,6 +72,9 @@ struct ns_3d_eye
 	struct xrt_matrix_4x4 world_to_screen_space;
 
 	struct ns_optical_system *optical_system;
+
+	//! Solved render UVs on a @ref NS_3D_LUT_DIM square grid, NULL until built.
+	struct xrt_vec2 *lut;
 };
 
 struct ns_3d_values
@@ -140,6 +152,15 @@ ns_hmd(struct xrt_device *xdev)
 void
 ns_3d_display_uv_to_render_uv(struct xrt_vec2 in, struct xrt_vec2 *out, struct ns_3d_eye *eye);
 
+/*!
+ * Batched version of @ref ns_3d_display_uv_to_render_uv, solves all of the
+ * UVs from scratch many at a time, much faster for large numbers of UVs.
+ *
+ * @ingroup drv_ns
+ */
+void
+ns_3d_display_uvs_to_render_uvs(const struct xrt_vec2 *in, struct xrt_vec2 *out, uint32_t count, struct ns_3d_eye *eye);
+
 struct ns_optical_system *
 ns_3d_create_optical_system(struct ns_3d_eye *eye);
 
@@ -1,4 +1,4 @@
-// Copyright 2019-2022, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -7,15 +7,14 @@
  * @ingroup drv_opengloves
  */
 
-#include <string>
-#include <stdexcept>
-
-#include <map>
 #include "util/u_logging.h"
 
 #include "alpha_encoding.h"
 #include "encoding.h"
 
+#include <cstring>
+#include <cstdio>
+
 enum opengloves_alpha_encoding_key
 {
 	OPENGLOVES_ALPHA_ENCODING_FinThumb,
@@ -80,17 +79,15 @@ enum opengloves_alpha_encoding_key
 	OPENGLOVES_ALPHA_ENCODING_MAX
 };
 
-#define OPENGLOVES_ALPHA_ENCODING_VAL_IN_MAP_E_0
-
-static const std::string opengloves_alpha_encoding_key_characters = "ABCDEFGHIJKLMNOPQRSTUVWXYZ()";
+static_assert(OPENGLOVES_ALPHA_ENCODING_MAX <= OPENGLOVES_ALPHA_DECODER_MAX_KEYS, "Too many keys for the decoder");
 
-static bool
-opengloves_alpha_encoding_is_key_character(const char character)
+struct opengloves_alpha_encoding_key_string
 {
-	return opengloves_alpha_encoding_key_characters.find(character) != std::string::npos;
-}
+	const char *str;
+	enum opengloves_alpha_encoding_key key;
+};
 
-static const std::map<std::string, int> opengloves_alpha_encoding_input_key_string{
+static const struct opengloves_alpha_encoding_key_string opengloves_alpha_encoding_input_keys[] = {
     {"A", OPENGLOVES_ALPHA_ENCODING_FinThumb},         // whole thumb curl (default curl value for thumb joints)
     {"(AB)", OPENGLOVES_ALPHA_ENCODING_FinSplayThumb}, // whole thumb splay thumb joint 3 (doesn't exist, but keeps
                                                        // consistency with the other fingers
@@ -137,138 +134,232 @@ static const std::map<std::string, int> opengloves_alpha_encoding_input_key_stri
     {"N", OPENGLOVES_ALPHA_ENCODING_BtnMenu},             // system button pressed (opens SteamVR menu)
     {"O", OPENGLOVES_ALPHA_ENCODING_BtnCalib},            // calibration button
     {"P", OPENGLOVES_ALPHA_ENCODING_TrgValue},            // analog trigger value
-    {"", OPENGLOVES_ALPHA_ENCODING_MAX}                   // Junk key
 };
 
-static const std::map<int, std::string> opengloves_alpha_encoding_output_key_string{
-    {OPENGLOVES_ALPHA_ENCODING_FinThumb, "A"},  // thumb force feedback
-    {OPENGLOVES_ALPHA_ENCODING_FinIndex, "B"},  // index force feedback
-    {OPENGLOVES_ALPHA_ENCODING_FinMiddle, "C"}, // middle force feedback
-    {OPENGLOVES_ALPHA_ENCODING_FinRing, "D"},   // ring force feedback
-    {OPENGLOVES_ALPHA_ENCODING_FinPinky, "E"},  // pinky force feedback
+enum opengloves_alpha_decoder_state
+{
+	//! Skipping until a key character.
+	OPENGLOVES_ALPHA_DECODER_STATE_IDLE = 0,
+	//! Inside of a long key like "(AB)", long keys must always be enclosed in brackets.
+	OPENGLOVES_ALPHA_DECODER_STATE_LONG_KEY,
+	//! Reading the digits after a key.
+	OPENGLOVES_ALPHA_DECODER_STATE_VALUE,
 };
 
-static std::map<int, std::string>
-opengloves_alpha_encoding_parse_to_map(const std::string &str)
+static bool
+opengloves_alpha_encoding_is_key_character(const char character)
 {
-	std::map<int, std::string> result;
+	return (character >= 'A' && character <= 'Z') || character == '(' || character == ')';
+}
 
-	size_t i = 0;
-	while (i < str.length()) {
-		// Advance until we get an alphabetic character (no point in looking at values that don't have a key
-		// associated with them)
+static bool
+opengloves_alpha_encoding_is_digit(const char character)
+{
+	return character >= '0' && character <= '9';
+}
 
-		if (str[i] >= 0 && opengloves_alpha_encoding_is_key_character(str[i])) {
-			std::string key = {str[i]};
-			i++;
-
-			// we're going to be parsing a "long key", i.e. (AB) for thumb finger splay. Long keys must
-			// always be enclosed in brackets
-			if (key[0] == '(') {
-				while (str[i] >= 0 && opengloves_alpha_encoding_is_key_character(str[i]) &&
-				       i < str.length()) {
-					key += str[i];
-					i++;
-				}
-			}
+static void
+opengloves_alpha_decoder_reset_packet(struct opengloves_alpha_decoder *dec)
+{
+	dec->state = OPENGLOVES_ALPHA_DECODER_STATE_IDLE;
+	dec->present = 0;
+	dec->has_value = 0;
+}
+
+//! Records the key that was just read, the last value wins if a key is repeated.
+static void
+opengloves_alpha_decoder_finish_key(struct opengloves_alpha_decoder *dec)
+{
+	dec->state = OPENGLOVES_ALPHA_DECODER_STATE_IDLE;
 
-			std::string value;
-			while (str[i] >= 0 && isdigit(str[i]) && i < str.length()) {
-				value += str[i];
-				i++;
+	if (dec->key_len <= OPENGLOVES_ALPHA_DECODER_MAX_KEY_LEN) {
+		for (const auto &entry : opengloves_alpha_encoding_input_keys) {
+			if (strlen(entry.str) != dec->key_len || memcmp(entry.str, dec->key, dec->key_len) != 0) {
+				continue;
 			}
 
 			// Even if the value is empty we still want to use the key, it means that we have a button that
 			// is pressed (it only appears in the packet if it is)
-			if (opengloves_alpha_encoding_input_key_string.find(key) !=
-			    opengloves_alpha_encoding_input_key_string.end())
-				result.insert_or_assign(opengloves_alpha_encoding_input_key_string.at(key), value);
-			else
-				U_LOG_W("Unable to insert key: %s into input map as it was not found", key.c_str());
-		} else
-			i++;
+			uint64_t bit = UINT64_C(1) << entry.key;
+			dec->present |= bit;
+			dec->values[entry.key] = dec->value;
+			if (dec->value_has_digits) {
+				dec->has_value |= bit;
+			} else {
+				dec->has_value &= ~bit;
+			}
+			return;
+		}
+	}
+
+	int len = (int)(dec->key_len < OPENGLOVES_ALPHA_DECODER_MAX_KEY_LEN ? dec->key_len
+	                                                                    : OPENGLOVES_ALPHA_DECODER_MAX_KEY_LEN);
+	U_LOG_W("Unable to insert key: %.*s into input map as it was not found", len, dec->key);
+}
+
+static bool
+opengloves_alpha_decoder_get(const struct opengloves_alpha_decoder *dec, int key, float *out_value)
+{
+	if ((dec->has_value & (UINT64_C(1) << key)) == 0) {
+		return false;
 	}
 
-	return result;
+	*out_value = (float)dec->values[key];
+	return true;
 }
 
+static bool
+opengloves_alpha_decoder_is_present(const struct opengloves_alpha_decoder *dec, int key)
+{
+	return (dec->present & (UINT64_C(1) << key)) != 0;
+}
+
+//! Analog keys without a value are malformed and ignored, keeping the previous value.
+static void
+opengloves_alpha_decoder_apply(const struct opengloves_alpha_decoder *dec, struct opengloves_input *out)
+{
+	float value = 0.0f;
+
+	// five fingers, 2 (curl + splay)
+	for (int i = 0; i < 5; i++) {
+		int enum_position = i * 2;
+		// curls
+		if (opengloves_alpha_decoder_get(dec, enum_position, &value)) {
+			for (int j = 0; j < 4; j++) {
+				out->flexion[i][j] = value / OPENGLOVES_ENCODING_MAX_ANALOG_VALUE;
+			}
+		}
+
+		// splay
+		if (opengloves_alpha_decoder_get(dec, enum_position + 1, &value)) {
+			out->splay[i] = (value / OPENGLOVES_ENCODING_MAX_ANALOG_VALUE - 0.5f) * 2.0f;
+		}
+	}
+
+	int current_finger_joint = OPENGLOVES_ALPHA_ENCODING_FinJointThumb0;
+	for (int i = 0; i < 5; i++) {
+		for (int j = 0; j < 4; j++) {
+			// individual joint curls, or use the curl of the previous joint
+			out->flexion[i][j] = opengloves_alpha_decoder_get(dec, current_finger_joint, &value)
+			                         ? value / OPENGLOVES_ENCODING_MAX_ANALOG_VALUE
+			                         : out->flexion[i][j > 0 ? j - 1 : 0];
+			current_finger_joint++;
+		}
+	}
+
+	// joysticks
+	if (opengloves_alpha_decoder_get(dec, OPENGLOVES_ALPHA_ENCODING_JoyX, &value)) {
+		out->joysticks.main.x = 2 * value / OPENGLOVES_ENCODING_MAX_ANALOG_VALUE - 1;
+	}
+	if (opengloves_alpha_decoder_get(dec, OPENGLOVES_ALPHA_ENCODING_JoyY, &value)) {
+		out->joysticks.main.y = 2 * value / OPENGLOVES_ENCODING_MAX_ANALOG_VALUE - 1;
+	}
+	out->joysticks.main.pressed = opengloves_alpha_decoder_is_present(dec, OPENGLOVES_ALPHA_ENCODING_JoyBtn);
+
+	if (opengloves_alpha_decoder_get(dec, OPENGLOVES_ALPHA_ENCODING_TrgValue, &value)) {
+		out->buttons.trigger.value = value / OPENGLOVES_ENCODING_MAX_ANALOG_VALUE;
+	}
+	out->buttons.trigger.pressed = opengloves_alpha_decoder_is_present(dec, OPENGLOVES_ALPHA_ENCODING_BtnTrg);
+
+	out->buttons.A.pressed = opengloves_alpha_decoder_is_present(dec, OPENGLOVES_ALPHA_ENCODING_BtnA);
+	out->buttons.B.pressed = opengloves_alpha_decoder_is_present(dec, OPENGLOVES_ALPHA_ENCODING_BtnB);
+	out->gestures.grab.activated = opengloves_alpha_decoder_is_present(dec, OPENGLOVES_ALPHA_ENCODING_GesGrab);
+	out->gestures.pinch.activated = opengloves_alpha_decoder_is_present(dec, OPENGLOVES_ALPHA_ENCODING_GesPinch);
+	out->buttons.menu.pressed = opengloves_alpha_decoder_is_present(dec, OPENGLOVES_ALPHA_ENCODING_BtnMenu);
+}
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
 
 void
-opengloves_alpha_encoding_decode(const char *data, struct opengloves_input *out)
+opengloves_alpha_decoder_init(struct opengloves_alpha_decoder *dec)
 {
-	std::map<int, std::string> input_map = opengloves_alpha_encoding_parse_to_map(data);
-
-	try {
-		// five fingers, 2 (curl + splay)
-		for (int i = 0; i < 5; i++) {
-			int enum_position = i * 2;
-			// curls
-			if (input_map.find(enum_position) != input_map.end()) {
-				float fin_curl_value = std::stof(input_map.at(enum_position));
-				std::fill(std::begin(out->flexion[i]), std::begin(out->flexion[i]) + 4,
-				          fin_curl_value / OPENGLOVES_ENCODING_MAX_ANALOG_VALUE);
+	memset(dec, 0, sizeof(*dec));
+	opengloves_alpha_decoder_reset_packet(dec);
+}
+
+bool
+opengloves_alpha_decoder_push(struct opengloves_alpha_decoder *dec,
+                              const char *data,
+                              size_t size,
+                              size_t *out_consumed,
+                              struct opengloves_input *inout)
+{
+	for (size_t i = 0; i < size; i++) {
+		const char c = data[i];
+
+		// Never part of a packet.
+		if (c == '\0') {
+			continue;
+		}
+
+		if (c == '\n') {
+			if (dec->state != OPENGLOVES_ALPHA_DECODER_STATE_IDLE) {
+				opengloves_alpha_decoder_finish_key(dec);
 			}
 
-			// splay
-			if (input_map.find(enum_position + 1) != input_map.end())
-				out->splay[i] =
-				    (std::stof(input_map.at(enum_position + 1)) / OPENGLOVES_ENCODING_MAX_ANALOG_VALUE -
-				     0.5f) *
-				    2.0f;
+			opengloves_alpha_decoder_apply(dec, inout);
+			opengloves_alpha_decoder_reset_packet(dec);
+
+			*out_consumed = i + 1;
+			return true;
 		}
 
-		int current_finger_joint = OPENGLOVES_ALPHA_ENCODING_FinJointThumb0;
-		for (int i = 0; i < 5; i++) {
-			for (int j = 0; j < 4; j++) {
-				// individual joint curls
-				out->flexion[i][j] = input_map.find(current_finger_joint) != input_map.end()
-				                         ? (std::stof(input_map.at(current_finger_joint)) /
-				                            OPENGLOVES_ENCODING_MAX_ANALOG_VALUE)
-				                         // use the curl of the previous joint
-				                         : out->flexion[i][j > 0 ? j - 1 : 0];
-				current_finger_joint++;
+		if (dec->state == OPENGLOVES_ALPHA_DECODER_STATE_LONG_KEY) {
+			if (opengloves_alpha_encoding_is_key_character(c)) {
+				// Too long keys are counted but not stored, they never match.
+				if (dec->key_len < OPENGLOVES_ALPHA_DECODER_MAX_KEY_LEN) {
+					dec->key[dec->key_len] = c;
+				}
+				dec->key_len++;
+				continue;
 			}
+			dec->state = OPENGLOVES_ALPHA_DECODER_STATE_VALUE;
 		}
 
-		// joysticks
-		if (input_map.find(OPENGLOVES_ALPHA_ENCODING_JoyX) != input_map.end())
-			out->joysticks.main.x = 2 * std::stof(input_map.at(OPENGLOVES_ALPHA_ENCODING_JoyX)) /
-			                            OPENGLOVES_ENCODING_MAX_ANALOG_VALUE -
-			                        1;
-		if (input_map.find(OPENGLOVES_ALPHA_ENCODING_JoyY) != input_map.end())
-			out->joysticks.main.y = 2 * std::stof(input_map.at(OPENGLOVES_ALPHA_ENCODING_JoyY)) /
-			                            OPENGLOVES_ENCODING_MAX_ANALOG_VALUE -
-			                        1;
-		out->joysticks.main.pressed = input_map.find(OPENGLOVES_ALPHA_ENCODING_JoyBtn) != input_map.end();
-
-	} catch (std::invalid_argument &e) {
-		U_LOG_E("Error parsing input string: %s", e.what());
-	}
+		if (dec->state == OPENGLOVES_ALPHA_DECODER_STATE_VALUE) {
+			if (opengloves_alpha_encoding_is_digit(c)) {
+				// Saturate, real values are at most four digits.
+				if (dec->value < UINT32_MAX / 10) {
+					dec->value = dec->value * 10 + (uint32_t)(c - '0');
+				}
+				dec->value_has_digits = true;
+				continue;
+			}
+			opengloves_alpha_decoder_finish_key(dec);
+		}
 
-	if (input_map.find(OPENGLOVES_ALPHA_ENCODING_TrgValue) != input_map.end())
-		out->buttons.trigger.value =
-		    std::stof(input_map.at(OPENGLOVES_ALPHA_ENCODING_TrgValue)) / OPENGLOVES_ENCODING_MAX_ANALOG_VALUE;
-	out->buttons.trigger.pressed = input_map.find(OPENGLOVES_ALPHA_ENCODING_BtnTrg) != input_map.end();
+		// Advance until we get a key character (no point in looking at values that don't have a key
+		// associated with them)
+		if (opengloves_alpha_encoding_is_key_character(c)) {
+			dec->key[0] = c;
+			dec->key_len = 1;
+			dec->value = 0;
+			dec->value_has_digits = false;
+			if (c == '(') {
+				dec->state = OPENGLOVES_ALPHA_DECODER_STATE_LONG_KEY;
+			} else {
+				dec->state = OPENGLOVES_ALPHA_DECODER_STATE_VALUE;
+			}
+		}
+	}
 
-	out->buttons.A.pressed = input_map.find(OPENGLOVES_ALPHA_ENCODING_BtnA) != input_map.end();
-	out->buttons.B.pressed = input_map.find(OPENGLOVES_ALPHA_ENCODING_BtnB) != input_map.end();
-	out->gestures.grab.activated = input_map.find(OPENGLOVES_ALPHA_ENCODING_GesGrab) != input_map.end();
-	out->gestures.pinch.activated = input_map.find(OPENGLOVES_ALPHA_ENCODING_GesPinch) != input_map.end();
-	out->buttons.menu.pressed = input_map.find(OPENGLOVES_ALPHA_ENCODING_BtnMenu) != input_map.end();
+	*out_consumed = size;
+	return false;
 }
 
 void
 opengloves_alpha_encoding_encode(const struct opengloves_output *output, char *out_buff)
 {
-	sprintf(out_buff, "%s%d%s%d%s%d%s%d%s%d\n",
-	        opengloves_alpha_encoding_output_key_string.at(OPENGLOVES_ALPHA_ENCODING_FinThumb).c_str(),
-	        (int)(output->force_feedback.thumb * 1000),
-	        opengloves_alpha_encoding_output_key_string.at(OPENGLOVES_ALPHA_ENCODING_FinIndex).c_str(),
-	        (int)(output->force_feedback.index * 1000),
-	        opengloves_alpha_encoding_output_key_string.at(OPENGLOVES_ALPHA_ENCODING_FinMiddle).c_str(),
-	        (int)(output->force_feedback.middle * 1000),
-	        opengloves_alpha_encoding_output_key_string.at(OPENGLOVES_ALPHA_ENCODING_FinRing).c_str(),
-	        (int)(output->force_feedback.ring * 1000),
-	        opengloves_alpha_encoding_output_key_string.at(OPENGLOVES_ALPHA_ENCODING_FinPinky).c_str(),
-	        (int)(output->force_feedback.little * 1000));
+	// thumb, index, middle, ring and pinky force feedback
+	sprintf(out_buff, "A%dB%dC%dD%dE%d\n",                  //
+	        (int)(output->force_feedback.thumb * 1000),   //
+	        (int)(output->force_feedback.index * 1000),   //
+	        (int)(output->force_feedback.middle * 1000),  //
+	        (int)(output->force_feedback.ring * 1000),    //
+	        (int)(output->force_feedback.little * 1000)); //
 }
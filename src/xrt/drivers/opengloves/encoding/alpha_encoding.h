@@ -1,4 +1,4 @@
-// Copyright 2019-2022, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -10,12 +10,65 @@
 #pragma once
 #include "encoding.h"
 
+#include <stdint.h>
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+//! Longest key of the alpha encoding, like "(AAB)", with some room to spare.
+#define OPENGLOVES_ALPHA_DECODER_MAX_KEY_LEN 8
+
+//! Room for all of the keys of the alpha encoding.
+#define OPENGLOVES_ALPHA_DECODER_MAX_KEYS 64
+
+/*!
+ * Incremental decoder for the alpha encoding, bytes are pushed straight from
+ * the receive buffer in chunks of any size and nothing is allocated.
+ *
+ * @ingroup drv_opengloves
+ */
+struct opengloves_alpha_decoder
+{
+	//! Internal state, @ref opengloves_alpha_decoder_state.
+	int state;
+
+	//! Key being read, not NUL terminated.
+	char key[OPENGLOVES_ALPHA_DECODER_MAX_KEY_LEN];
+	uint32_t key_len;
+
+	//! Value being read for the key.
+	uint32_t value;
+	bool value_has_digits;
+
+	//! Bit per key seen in the current packet.
+	uint64_t present;
+
+	//! Bit per key seen with a value in the current packet.
+	uint64_t has_value;
+
+	//! Values of the keys in the current packet.
+	uint32_t values[OPENGLOVES_ALPHA_DECODER_MAX_KEYS];
+};
+
 void
-opengloves_alpha_encoding_decode(const char *data, struct opengloves_input *out_kv);
+opengloves_alpha_decoder_init(struct opengloves_alpha_decoder *dec);
+
+/*!
+ * Pushes received bytes into the decoder, stops at the end of a packet and
+ * applies it on top of @p inout, analog values not in the packet are kept.
+ *
+ * @param[out] out_consumed How many bytes of @p data were used, push the rest again if a packet was finished.
+ *
+ * @return true if a packet was finished and @p inout updated.
+ */
+bool
+opengloves_alpha_decoder_push(struct opengloves_alpha_decoder *dec,
+                              const char *data,
+                              size_t size,
+                              size_t *out_consumed,
+                              struct opengloves_input *inout);
 
 void
 opengloves_alpha_encoding_encode(const struct opengloves_output *output, char *out_buff);
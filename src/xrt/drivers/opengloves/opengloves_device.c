@@ -1,4 +1,4 @@
-// Copyright 2019-2022, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -71,12 +71,16 @@ struct opengloves_device
 	struct os_thread_helper oth;
 	struct os_mutex lock;
 
-	struct opengloves_input *last_input;
+	//! Latest decoded input, protected by @p lock.
+	struct opengloves_input last_input;
 
 	enum xrt_hand hand;
 
 	struct u_hand_tracking hand_tracking;
 
+	//! Reuses the simulated joints between calls with the same finger values.
+	struct u_hand_sim_cache hand_sim;
+
 	enum u_logging_level log_level;
 };
 
@@ -97,40 +101,45 @@ opengloves_device_get_hand_tracking(struct xrt_device *xdev,
 
 	enum xrt_hand hand = od->hand;
 
+	struct opengloves_input input;
+	os_mutex_lock(&od->lock);
+	input = od->last_input;
+	os_mutex_unlock(&od->lock);
+
 	struct u_hand_tracking_values values = {.little =
 	                                            {
-	                                                .splay = od->last_input->splay[4],
+	                                                .splay = input.splay[4],
 	                                                .joint_count = 5,
 	                                            },
 	                                        .ring =
 	                                            {
-	                                                .splay = od->last_input->splay[3],
+	                                                .splay = input.splay[3],
 	                                                .joint_count = 5,
 	                                            },
 	                                        .middle =
 	                                            {
-	                                                .splay = od->last_input->splay[2],
+	                                                .splay = input.splay[2],
 	                                                .joint_count = 5,
 	                                            },
 	                                        .index =
 	                                            {
-	                                                .splay = od->last_input->splay[1],
+	                                                .splay = input.splay[1],
 	                                                .joint_count = 5,
 	                                            },
 	                                        .thumb = {
-	                                            .splay = od->last_input->splay[0],
+	                                            .splay = input.splay[0],
 	                                            .joint_count = 4,
 	                                        }};
 	// copy in the curls
-	memcpy(values.little.joint_curls, od->last_input->flexion[4], sizeof(od->last_input->flexion[4]));
-	memcpy(values.ring.joint_curls, od->last_input->flexion[3], sizeof(od->last_input->flexion[3]));
-	memcpy(values.middle.joint_curls, od->last_input->flexion[2], sizeof(od->last_input->flexion[2]));
-	memcpy(values.index.joint_curls, od->last_input->flexion[1], sizeof(od->last_input->flexion[1]));
-	memcpy(values.thumb.joint_curls, od->last_input->flexion[0], sizeof(od->last_input->flexion[0]));
+	memcpy(values.little.joint_curls, input.flexion[4], sizeof(input.flexion[4]));
+	memcpy(values.ring.joint_curls, input.flexion[3], sizeof(input.flexion[3]));
+	memcpy(values.middle.joint_curls, input.flexion[2], sizeof(input.flexion[2]));
+	memcpy(values.index.joint_curls, input.flexion[1], sizeof(input.flexion[1]));
+	memcpy(values.thumb.joint_curls, input.flexion[0], sizeof(input.flexion[0]));
 
 	struct xrt_space_relation ident;
 	m_space_relation_ident(&ident);
-	u_hand_sim_simulate_generic(&values, hand, &ident, out_joint_set);
+	u_hand_sim_simulate_generic_cached(&od->hand_sim, &values, hand, &ident, out_joint_set);
 
 	*out_timestamp_ns = requested_timestamp_ns;
 	out_joint_set->is_active = true;
@@ -145,16 +154,16 @@ opengloves_device_update_inputs(struct xrt_device *xdev)
 
 	os_mutex_lock(&od->lock);
 
-	od->base.inputs[OPENGLOVES_INPUT_INDEX_A_CLICK].value.boolean = od->last_input->buttons.A.pressed;
-	od->base.inputs[OPENGLOVES_INPUT_INDEX_B_CLICK].value.boolean = od->last_input->buttons.B.pressed;
+	od->base.inputs[OPENGLOVES_INPUT_INDEX_A_CLICK].value.boolean = od->last_input.buttons.A.pressed;
+	od->base.inputs[OPENGLOVES_INPUT_INDEX_B_CLICK].value.boolean = od->last_input.buttons.B.pressed;
 
-	od->base.inputs[OPENGLOVES_INPUT_INDEX_TRIGGER_CLICK].value.boolean = od->last_input->buttons.trigger.pressed;
-	od->base.inputs[OPENGLOVES_INPUT_INDEX_TRIGGER_VALUE].value.vec1.x = od->last_input->buttons.trigger.value;
+	od->base.inputs[OPENGLOVES_INPUT_INDEX_TRIGGER_CLICK].value.boolean = od->last_input.buttons.trigger.pressed;
+	od->base.inputs[OPENGLOVES_INPUT_INDEX_TRIGGER_VALUE].value.vec1.x = od->last_input.buttons.trigger.value;
 
-	od->base.inputs[OPENGLOVES_INPUT_INDEX_JOYSTICK_MAIN].value.vec2.x = od->last_input->joysticks.main.x;
-	od->base.inputs[OPENGLOVES_INPUT_INDEX_JOYSTICK_MAIN].value.vec2.y = od->last_input->joysticks.main.y;
+	od->base.inputs[OPENGLOVES_INPUT_INDEX_JOYSTICK_MAIN].value.vec2.x = od->last_input.joysticks.main.x;
+	od->base.inputs[OPENGLOVES_INPUT_INDEX_JOYSTICK_MAIN].value.vec2.y = od->last_input.joysticks.main.y;
 	od->base.inputs[OPENGLOVES_INPUT_INDEX_JOYSTICK_MAIN_CLICK].value.boolean =
-	    od->last_input->joysticks.main.pressed;
+	    od->last_input.joysticks.main.pressed;
 
 	os_mutex_unlock(&od->lock);
 
@@ -215,65 +224,61 @@ opengloves_device_destroy(struct xrt_device *xdev)
 	os_thread_helper_destroy(&od->oth);
 
 	os_mutex_destroy(&od->lock);
+	u_hand_sim_cache_fini(&od->hand_sim);
 
 	opengloves_communication_device_destory(od->ocd);
 
-	free(od->last_input);
 	free(od);
 }
 
 
 /*!
- * Reads the next packet from the device, finishing successfully when reaching a newline
- * Returns true if finished at a newline, or false if there was an error
+ * Main thread for reading data from the device, reads as much as is available
+ * and pushes it through the decoder so a packet costs a handful of syscalls
+ * instead of one per byte.
  */
-static bool
-opengloves_read_next_packet(struct opengloves_device *od, char *buffer, int buffer_len)
+static void *
+opengloves_run_thread(void *ptr)
 {
-	os_thread_helper_lock(&od->oth);
+	struct opengloves_device *od = (struct opengloves_device *)ptr;
 
-	char next_char = 0;
-	int i = 0;
-	do {
-		// try read one byte
-		int ret = opengloves_communication_device_read(od->ocd, &next_char, 1);
+	char buffer[OPENGLOVES_ENCODING_MAX_PACKET_SIZE];
+
+	struct opengloves_alpha_decoder decoder;
+	opengloves_alpha_decoder_init(&decoder);
+
+	// Decoded into on this thread, only copied out under the lock.
+	struct opengloves_input input = {0};
+
+	while (os_thread_helper_is_running(&od->oth)) {
+		int ret = opengloves_communication_device_read(od->ocd, buffer, sizeof(buffer));
 		if (ret < 0) {
 			OPENGLOVES_ERROR(od, "Failed to read from device! %s", strerror(ret));
-			os_thread_helper_unlock(&od->oth);
-			return false;
+			break;
 		}
 
-		if (next_char == 0 || next_char == '\n')
+		// Timed out, check if we should still be running.
+		if (ret == 0) {
 			continue;
+		}
 
-		buffer[i++] = next_char;
-	} while (next_char != '\n' && i < buffer_len);
-
-	// null terminate
-	buffer[i] = '\0';
-
-	OPENGLOVES_DEBUG(od, "%s -> len %i", buffer, i);
-
-	os_thread_helper_unlock(&od->oth);
-
-	return true;
-}
+		const char *data = buffer;
+		size_t size = (size_t)ret;
+		while (size > 0) {
+			size_t consumed = 0;
+			bool finished = opengloves_alpha_decoder_push(&decoder, data, size, &consumed, &input);
 
-/*!
- * Main thread for reading data from the device
- */
-static void *
-opengloves_run_thread(void *ptr)
-{
-	struct opengloves_device *od = (struct opengloves_device *)ptr;
+			data += consumed;
+			size -= consumed;
 
-	char buffer[OPENGLOVES_ENCODING_MAX_PACKET_SIZE];
+			if (!finished) {
+				continue;
+			}
 
-	while (opengloves_read_next_packet(od, buffer, OPENGLOVES_ENCODING_MAX_PACKET_SIZE) &&
-	       os_thread_helper_is_running(&od->oth)) {
-		os_mutex_lock(&od->lock);
-		opengloves_alpha_encoding_decode(buffer, od->last_input);
-		os_mutex_unlock(&od->lock);
+			os_mutex_lock(&od->lock);
+			od->last_input = input;
+			os_mutex_unlock(&od->lock);
+		}
 	}
 
 	return 0;
@@ -293,6 +298,7 @@ opengloves_device_create(struct opengloves_communication_device *ocd, enum xrt_h
 	od->ocd = ocd;
 	od->base.destroy = opengloves_device_destroy;
 	os_mutex_init(&od->lock);
+	u_hand_sim_cache_init(&od->hand_sim);
 
 	// hand tracking
 	od->base.get_hand_tracking = opengloves_device_get_hand_tracking;
@@ -304,7 +310,6 @@ opengloves_device_create(struct opengloves_communication_device *ocd, enum xrt_h
 
 	// inputs
 	od->base.update_inputs = opengloves_device_update_inputs;
-	od->last_input = U_TYPED_CALLOC(struct opengloves_input);
 
 	od->base.inputs[OPENGLOVES_INPUT_INDEX_A_CLICK].name = XRT_INPUT_INDEX_A_CLICK;
 	od->base.inputs[OPENGLOVES_INPUT_INDEX_B_CLICK].name = XRT_INPUT_INDEX_B_CLICK;
@@ -1,4 +1,4 @@
-// Copyright 2019-2020, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -13,6 +13,7 @@
 
 #include "os/os_threading.h"
 #include "os/os_hid.h"
+#include "os/os_hid_reactor.h"
 #include "os/os_time.h"
 
 #include "math/m_api.h"
@@ -55,10 +56,12 @@
 // clang-format off
 #define PSMV_TRACE(p, ...) U_LOG_XDEV_IFL_T(&p->base, p->log_level, __VA_ARGS__)
 #define PSMV_DEBUG(p, ...) U_LOG_XDEV_IFL_D(&p->base, p->log_level, __VA_ARGS__)
+#define PSMV_WARN(p, ...) U_LOG_XDEV_IFL_W(&p->base, p->log_level, __VA_ARGS__)
 #define PSMV_ERROR(p, ...) U_LOG_XDEV_IFL_E(&p->base, p->log_level, __VA_ARGS__)
 // clang-format on
 
 DEBUG_GET_ONCE_LOG_OPTION(psmv_log, "PSMV_LOG", U_LOGGING_WARN)
+DEBUG_GET_ONCE_BOOL_OPTION(psmv_hid_reactor, "PSMV_HID_REACTOR", true)
 
 /*!
  * Indices where each input is in the input list.
@@ -461,6 +464,15 @@ struct psmv_device
 
 	struct os_thread_helper oth;
 
+	/*!
+	 * When not NULL the input reports are read on the shared hid reactor
+	 * thread instead of @ref oth.
+	 */
+	struct os_hid_reactor_source *reactor_source;
+
+	//! Time of the previous report, only used on the reactor thread.
+	timepoint_ns reactor_then_ns;
+
 	struct
 	{
 		int64_t resend_time;
@@ -726,6 +738,40 @@ psmv_read_one_packet(struct psmv_device *psmv, uint8_t *buffer, size_t size)
 	return false;
 }
 
+static void
+psmv_handle_packet(struct psmv_device *psmv, uint8_t *buffer, timepoint_ns now_ns, time_duration_ns delta_ns)
+{
+	struct psmv_parsed_input input = {0};
+
+	int num = psmv_parse_input(psmv, buffer, &input);
+
+	// Lock last and the fusion.
+	os_mutex_lock(&psmv->lock);
+
+	// Make sure the leds stays on, also sends any new rumble value.
+	psmv_led_and_trigger_update_locked(psmv, now_ns);
+
+	// Copy to device.
+	psmv->last = input;
+
+	// Process the parsed data.
+	if (num == 2) {
+		// ZCM1
+		update_fusion(psmv, &input.samples[0], now_ns - (delta_ns / 2.0), (delta_ns / 2.0));
+		update_fusion(psmv, &input.samples[1], now_ns, (delta_ns / 2.0));
+		psmv->last_timestamp_ns = now_ns;
+	} else if (num == 1) {
+		// ZCM2
+		update_fusion(psmv, &input.sample, now_ns, delta_ns);
+		psmv->last_timestamp_ns = now_ns;
+	} else {
+		assert(false);
+	}
+
+	// Now done.
+	os_mutex_unlock(&psmv->lock);
+}
+
 static void *
 psmv_run_thread(void *ptr)
 {
@@ -738,8 +784,6 @@ psmv_run_thread(void *ptr)
 		struct psmv_input_zcm1 input;
 	} data;
 
-	struct psmv_parsed_input input = {0};
-
 	while (os_hid_read(psmv->hid, data.buffer, sizeof(data), 0) > 0) {
 		// Empty queue first
 	}
@@ -755,41 +799,67 @@ psmv_run_thread(void *ptr)
 
 		timepoint_ns now_ns = os_monotonic_get_ns();
 
-		int num = psmv_parse_input(psmv, data.buffer, &input);
-
 		time_duration_ns delta_ns = now_ns - then_ns;
 		then_ns = now_ns;
 
-		// Lock last and the fusion.
-		os_mutex_lock(&psmv->lock);
-
-		// Make sure the leds stays on.
-		psmv_led_and_trigger_update_locked(psmv, now_ns);
-
-		// Copy to device.
-		psmv->last = input;
-
-		// Process the parsed data.
-		if (num == 2) {
-			// ZCM1
-			update_fusion(psmv, &input.samples[0], now_ns - (delta_ns / 2.0), (delta_ns / 2.0));
-			update_fusion(psmv, &input.samples[1], now_ns, (delta_ns / 2.0));
-			psmv->last_timestamp_ns = now_ns;
-		} else if (num == 1) {
-			// ZCM2
-			update_fusion(psmv, &input.sample, now_ns, delta_ns);
-			psmv->last_timestamp_ns = now_ns;
-		} else {
-			assert(false);
-		}
-
-		// Now done.
-		os_mutex_unlock(&psmv->lock);
+		psmv_handle_packet(psmv, data.buffer, now_ns, delta_ns);
 	}
 
 	return NULL;
 }
 
+#ifdef XRT_OS_LINUX
+static void
+psmv_reactor_report(void *ptr, const uint8_t *data, size_t size, int64_t timestamp_ns)
+{
+	struct psmv_device *psmv = (struct psmv_device *)ptr;
+
+	// Same buffer as the thread, the parser reads it as a full report.
+	union {
+		uint8_t buffer[256];
+		struct psmv_input_zcm1 input;
+	} copy = {0};
+	memcpy(copy.buffer, data, size < sizeof(copy) ? size : sizeof(copy));
+
+	// The first package is only used to sync up, same as the thread.
+	if (psmv->reactor_then_ns == 0) {
+		psmv->reactor_then_ns = timestamp_ns;
+		return;
+	}
+
+	time_duration_ns delta_ns = timestamp_ns - psmv->reactor_then_ns;
+	psmv->reactor_then_ns = timestamp_ns;
+
+	psmv_handle_packet(psmv, copy.buffer, timestamp_ns, delta_ns);
+}
+
+static void
+psmv_reactor_error(void *ptr, int error)
+{
+	struct psmv_device *psmv = (struct psmv_device *)ptr;
+
+	PSMV_ERROR(psmv, "Failed to read device '%i'!", error);
+}
+
+static bool
+psmv_start_reactor(struct psmv_device *psmv)
+{
+	uint8_t buffer[256];
+	while (os_hid_read(psmv->hid, buffer, sizeof(buffer), 0) > 0) {
+		// Empty queue first
+	}
+
+	int ret = os_hid_reactor_add(psmv->hid, sizeof(buffer), psmv_reactor_report, psmv_reactor_error, psmv,
+	                             &psmv->reactor_source);
+	if (ret != 0) {
+		PSMV_WARN(psmv, "Could not use the hid reactor (%i), using a thread.", ret);
+		return false;
+	}
+
+	return true;
+}
+#endif
+
 static void
 psmv_get_fusion_pose(struct psmv_device *psmv,
                      enum xrt_input_name name,
@@ -828,6 +898,11 @@ psmv_device_destroy(struct xrt_device *xdev)
 {
 	struct psmv_device *psmv = psmv_device(xdev);
 
+#ifdef XRT_OS_LINUX
+	// No more callbacks after this.
+	os_hid_reactor_remove(&psmv->reactor_source);
+#endif
+
 	// Destroy the thread object.
 	os_thread_helper_destroy(&psmv->oth);
 
@@ -960,12 +1035,9 @@ psmv_device_set_output(struct xrt_device *xdev, enum xrt_output_name name, const
 	if (amp > 0) {
 		amp = amp_scale(psmv, value->vibration.amplitude);
 	}
+	// Sent by the device thread on the next packet, only the latest value is kept.
 	psmv->wants.rumble = psmv_clamp_zero_to_one_float_to_u8(amp);
 
-	// Resend if the rumble has been changed.
-	int64_t now = os_monotonic_get_ns();
-	psmv_led_and_trigger_update_locked(psmv, now);
-
 	os_mutex_unlock(&psmv->lock);
 	return XRT_SUCCESS;
 }
@@ -1247,11 +1319,20 @@ psmv_device_create(struct xrt_prober *xp, struct xrt_prober_device *xpdev, struc
 	// Send the first update package.
 	psmv_led_and_trigger_update(psmv, 1);
 
-	ret = os_thread_helper_start(&psmv->oth, psmv_run_thread, psmv);
-	if (ret != 0) {
-		PSMV_ERROR(psmv, "Failed to start thread!");
-		psmv_device_destroy(&psmv->base);
-		return NULL;
+	bool use_reactor = false;
+#ifdef XRT_OS_LINUX
+	if (debug_get_bool_option_psmv_hid_reactor()) {
+		use_reactor = psmv_start_reactor(psmv);
+	}
+#endif
+
+	if (!use_reactor) {
+		ret = os_thread_helper_start(&psmv->oth, psmv_run_thread, psmv);
+		if (ret != 0) {
+			PSMV_ERROR(psmv, "Failed to start thread!");
+			psmv_device_destroy(&psmv->base);
+			return NULL;
+		}
 	}
 
 	// Start the variable tracking now that everything is in place.
@@ -1,4 +1,4 @@
-// Copyright 2023, Collabora, Ltd.
+// Copyright 2023-2025, Collabora, Ltd.
 // Copyright 2023, Jarett Millard
 // SPDX-License-Identifier: BSL-1.0
 /*!
@@ -602,8 +602,10 @@ pssense_run_thread(void *ptr)
 			os_mutex_lock(&pssense->lock);
 			pssense->state = input_state;
 			pssense_update_fusion(pssense);
-			if (pssense->output.send_vibration &&
-			    pssense->state.timestamp_ns >= pssense->output.vibration_resend_timestamp_ns) {
+			// Outputs set by the app are only ever written from here, at the report rate.
+			if ((pssense->output.send_vibration &&
+			     pssense->state.timestamp_ns >= pssense->output.vibration_resend_timestamp_ns) ||
+			    pssense->output.send_trigger_feedback) {
 				pssense_send_output_report_locked(pssense);
 			}
 			os_mutex_unlock(&pssense->lock);
@@ -721,14 +723,13 @@ pssense_set_output(struct xrt_device *xdev, enum xrt_output_name name, const str
 		pssense->output.vibration_amplitude = vibration_amplitude;
 		pssense->output.vibration_mode = vibration_mode;
 		pssense->output.vibration_end_timestamp_ns = os_monotonic_get_ns() + value->vibration.duration_ns;
+		// Picked up by the next input report, later calls before then overwrite this one.
+		pssense->output.vibration_resend_timestamp_ns = 0;
 	}
 	if (send_trigger_feedback && trigger_feedback_mode != pssense->output.trigger_feedback_mode) {
 		pssense->output.send_trigger_feedback = true;
 		pssense->output.trigger_feedback_mode = trigger_feedback_mode;
 	}
-	if (pssense->output.send_vibration || pssense->output.send_trigger_feedback) {
-		pssense_send_output_report_locked(pssense);
-	}
 	os_mutex_unlock(&pssense->lock);
 
 	return XRT_SUCCESS;
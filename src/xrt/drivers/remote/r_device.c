@@ -1,4 +1,4 @@
-// Copyright 2020-2022, Collabora, Ltd.
+// Copyright 2020-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -46,6 +46,9 @@ r_device_destroy(struct xrt_device *xdev)
 	// Remove the variable tracking.
 	u_var_remove_root(rd);
 
+	m_relation_history_destroy(&rd->relation_hist);
+	u_hand_sim_cache_fini(&rd->hand_sim);
+
 	// Free this device with the helper.
 	u_device_free(&rd->base);
 }
@@ -97,21 +100,10 @@ r_device_update_inputs(struct xrt_device *xdev)
 	return XRT_SUCCESS;
 }
 
-static xrt_result_t
-r_device_get_tracked_pose(struct xrt_device *xdev,
-                          enum xrt_input_name name,
-                          int64_t at_timestamp_ns,
-                          struct xrt_space_relation *out_relation)
+static void
+latest_to_relation(struct r_device *rd, struct xrt_space_relation *out_relation)
 {
-	struct r_device *rd = r_device(xdev);
 	struct r_hub *r = rd->r;
-
-	if (name != XRT_INPUT_INDEX_AIM_POSE && name != XRT_INPUT_INDEX_GRIP_POSE &&
-	    name != XRT_INPUT_GENERIC_PALM_POSE) {
-		U_LOG_XDEV_UNSUPPORTED_INPUT(&rd->base, u_log_get_global_level(), name);
-		return XRT_ERROR_INPUT_UNSUPPORTED;
-	}
-
 	struct r_remote_controller_data *latest = rd->is_left ? &r->latest.left : &r->latest.right;
 
 	/*
@@ -133,6 +125,26 @@ r_device_get_tracked_pose(struct xrt_device *xdev,
 	} else {
 		out_relation->relation_flags = 0;
 	}
+}
+
+static xrt_result_t
+r_device_get_tracked_pose(struct xrt_device *xdev,
+                          enum xrt_input_name name,
+                          int64_t at_timestamp_ns,
+                          struct xrt_space_relation *out_relation)
+{
+	struct r_device *rd = r_device(xdev);
+
+	if (name != XRT_INPUT_INDEX_AIM_POSE && name != XRT_INPUT_INDEX_GRIP_POSE &&
+	    name != XRT_INPUT_GENERIC_PALM_POSE) {
+		U_LOG_XDEV_UNSUPPORTED_INPUT(&rd->base, u_log_get_global_level(), name);
+		return XRT_ERROR_INPUT_UNSUPPORTED;
+	}
+
+	if (m_relation_history_get(rd->relation_hist, at_timestamp_ns, out_relation) ==
+	    M_RELATION_HISTORY_RESULT_INVALID) {
+		latest_to_relation(rd, out_relation);
+	}
 
 	return XRT_SUCCESS;
 }
@@ -170,7 +182,7 @@ r_device_get_hand_tracking(struct xrt_device *xdev,
 
 	// Simulate the hand.
 	enum xrt_hand hand = rd->is_left ? XRT_HAND_LEFT : XRT_HAND_RIGHT;
-	u_hand_sim_simulate_for_valve_index_knuckles(&values, hand, &relation, out_value);
+	u_hand_sim_simulate_for_valve_index_knuckles_cached(&rd->hand_sim, &values, hand, &relation, out_value);
 
 	out_value->is_active = latest->hand_tracking_active;
 
@@ -209,6 +221,9 @@ r_device_create(struct r_hub *r, bool is_left)
 	rd->r = r;
 	rd->is_left = is_left;
 
+	m_relation_history_create(&rd->relation_hist);
+	u_hand_sim_cache_init(&rd->hand_sim);
+
 	// Print name.
 	snprintf(rd->base.str, sizeof(rd->base.str), "Remote %s Controller", is_left ? "Left" : "Right");
 	snprintf(rd->base.serial, sizeof(rd->base.str), "Remote %s Controller", is_left ? "Left" : "Right");
@@ -255,3 +270,18 @@ r_device_create(struct r_hub *r, bool is_left)
 
 	return &rd->base;
 }
+
+void
+r_device_push_latest(struct xrt_device *xdev, int64_t timestamp_ns)
+{
+	struct r_device *rd = r_device(xdev);
+
+	if (timestamp_ns < 0) {
+		m_relation_history_clear(rd->relation_hist);
+		return;
+	}
+
+	struct xrt_space_relation rel = XRT_SPACE_RELATION_ZERO;
+	latest_to_relation(rd, &rel);
+	m_relation_history_push(rd->relation_hist, &rel, timestamp_ns);
+}
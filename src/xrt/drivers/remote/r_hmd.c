@@ -44,6 +44,15 @@ copy_head_center_to_relation(struct r_hmd *rh, struct xrt_space_relation *out_re
 	    XRT_SPACE_RELATION_ORIENTATION_TRACKED_BIT | XRT_SPACE_RELATION_POSITION_TRACKED_BIT);
 }
 
+static inline void
+get_head_relation(struct r_hmd *rh, int64_t at_timestamp_ns, struct xrt_space_relation *out_relation)
+{
+	if (m_relation_history_get(rh->relation_hist, at_timestamp_ns, out_relation) ==
+	    M_RELATION_HISTORY_RESULT_INVALID) {
+		copy_head_center_to_relation(rh, out_relation);
+	}
+}
+
 static void
 r_hmd_destroy(struct xrt_device *xdev)
 {
@@ -52,6 +61,8 @@ r_hmd_destroy(struct xrt_device *xdev)
 	// Remove the variable tracking.
 	u_var_remove_root(rh);
 
+	m_relation_history_destroy(&rh->relation_hist);
+
 	// Free this device with the helper.
 	u_device_free(&rh->base);
 }
@@ -65,7 +76,7 @@ r_hmd_get_tracked_pose(struct xrt_device *xdev,
 	struct r_hmd *rh = r_hmd(xdev);
 
 	switch (name) {
-	case XRT_INPUT_GENERIC_HEAD_POSE: copy_head_center_to_relation(rh, out_relation); break;
+	case XRT_INPUT_GENERIC_HEAD_POSE: get_head_relation(rh, at_timestamp_ns, out_relation); break;
 	default:
 		U_LOG_XDEV_UNSUPPORTED_INPUT(&rh->base, u_log_get_global_level(), name);
 		return XRT_ERROR_INPUT_UNSUPPORTED;
@@ -98,7 +109,7 @@ r_hmd_get_view_poses(struct xrt_device *xdev,
 
 	assert(view_count <= ARRAY_SIZE(rh->r->latest.head.views));
 
-	copy_head_center_to_relation(rh, out_head_relation);
+	get_head_relation(rh, at_timestamp_ns, out_head_relation);
 
 	for (uint32_t i = 0; i < view_count; i++) {
 		out_poses[i] = rh->r->latest.head.views[i].pose;
@@ -139,6 +150,8 @@ r_hmd_create(struct r_hub *r)
 	rh->base.hmd->view_count = r->view_count;
 	rh->r = r;
 
+	m_relation_history_create(&rh->relation_hist);
+
 	// Print name.
 	snprintf(rh->base.str, sizeof(rh->base.str), "Remote HMD");
 	snprintf(rh->base.serial, sizeof(rh->base.serial), "Remote HMD");
@@ -178,3 +191,18 @@ r_hmd_create(struct r_hub *r)
 
 	return &rh->base;
 }
+
+void
+r_hmd_push_latest(struct xrt_device *xdev, int64_t timestamp_ns)
+{
+	struct r_hmd *rh = r_hmd(xdev);
+
+	if (timestamp_ns < 0) {
+		m_relation_history_clear(rh->relation_hist);
+		return;
+	}
+
+	struct xrt_space_relation rel = XRT_SPACE_RELATION_ZERO;
+	copy_head_center_to_relation(rh, &rel);
+	m_relation_history_push(rh->relation_hist, &rel, timestamp_ns);
+}
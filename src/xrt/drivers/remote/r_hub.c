@@ -14,7 +14,12 @@
 #include "util/u_debug.h"
 #include "util/u_space_overseer.h"
 
+#include "os/os_time.h"
+
+#include "math/m_clock_tracking.h"
+
 #include <stdio.h>
+#include <assert.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -57,6 +62,13 @@
  */
 
 DEBUG_GET_ONCE_LOG_OPTION(remote_log, "REMOTE_LOG", U_LOGGING_INFO)
+DEBUG_GET_ONCE_BOOL_OPTION(remote_udp, "REMOTE_UDP", false)
+
+//! Roughly how often updates arrive, used for the clock offset estimation.
+#define R_UPDATE_FREQUENCY 60.0f
+
+static_assert(sizeof(struct r_remote_data) % sizeof(uint64_t) == 0, "Must be a whole number of words");
+static_assert(R_REMOTE_DATA_WORD_COUNT <= 64, "Changed mask must be able to hold all words");
 
 #define R_TRACE(R, ...) U_LOG_IFL_T((R)->rc.log_level, __VA_ARGS__)
 #define R_DEBUG(R, ...) U_LOG_IFL_D((R)->rc.log_level, __VA_ARGS__)
@@ -91,18 +103,37 @@ socket_create(void)
 	return socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
 }
 
+static inline r_socket_t
+socket_create_udp(void)
+{
+	return socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+}
+
 static inline int
 socket_set_opt(r_socket_t id, int flag)
 {
 	return setsockopt(id, SOL_SOCKET, SO_REUSEADDR, (const char *)&flag, sizeof(flag));
 }
 
+static inline int
+socket_set_nodelay(r_socket_t id)
+{
+	int flag = 1;
+	return setsockopt(id, IPPROTO_TCP, TCP_NODELAY, (const char *)&flag, sizeof(flag));
+}
+
 static inline ssize_t
 socket_read(r_socket_t id, void *ptr, size_t size, size_t current)
 {
 	return recv(id, (char *)ptr, (int)(size - current), 0);
 }
 
+static inline ssize_t
+socket_read_from(r_socket_t id, void *ptr, size_t size, struct sockaddr_in *addr, socklen_t *addr_length)
+{
+	return recvfrom(id, (char *)ptr, (int)size, 0, (struct sockaddr *)addr, addr_length);
+}
+
 static inline ssize_t
 socket_write(r_socket_t id, void *ptr, size_t size, size_t current)
 {
@@ -123,18 +154,37 @@ socket_create(void)
 	return socket(AF_INET, SOCK_STREAM, 0);
 }
 
+static inline r_socket_t
+socket_create_udp(void)
+{
+	return socket(AF_INET, SOCK_DGRAM, 0);
+}
+
 static inline int
 socket_set_opt(r_socket_t id, int flag)
 {
 	return setsockopt(id, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
 }
 
+static inline int
+socket_set_nodelay(r_socket_t id)
+{
+	int flag = 1;
+	return setsockopt(id, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
 static inline ssize_t
 socket_read(r_socket_t id, void *ptr, size_t size, size_t current)
 {
 	return read(id, ptr, size - current);
 }
 
+static inline ssize_t
+socket_read_from(r_socket_t id, void *ptr, size_t size, struct sockaddr_in *addr, socklen_t *addr_length)
+{
+	return recvfrom(id, ptr, size, 0, (struct sockaddr *)addr, addr_length);
+}
+
 static inline ssize_t
 socket_write(r_socket_t id, void *ptr, size_t size, size_t current)
 {
@@ -144,12 +194,211 @@ socket_write(r_socket_t id, void *ptr, size_t size, size_t current)
 #endif // XRT_OS_UNIX
 
 
+/*
+ *
+ * Protocol functions.
+ *
+ */
+
+typedef void (*update_func_t)(void *ptr, const struct r_remote_data *data, int64_t timestamp_ns);
+
+static void
+reset_stream(struct r_remote_connection *rc)
+{
+	U_ZERO(&rc->tx_base);
+	U_ZERO(&rc->rx_base);
+	rc->tx_size = 0;
+	rc->tx_count = 0;
+}
+
+/*!
+ * Decode a whole packet and call @p func for every update in it, in order.
+ * Keyframe packets don't touch the stream state, as they may come out of
+ * band, stream packets are applied on top of @ref r_remote_connection::rx_base.
+ */
+static int
+decode_packet(struct r_remote_connection *rc,
+              const uint8_t *buffer,
+              size_t size,
+              bool require_keyframe,
+              update_func_t func,
+              void *ptr)
+{
+	struct r_remote_packet_header header;
+
+	if (size < sizeof(header)) {
+		RC_ERROR(rc, "Packet too small (%zu bytes)", size);
+		return -1;
+	}
+
+	memcpy(&header, buffer, sizeof(header));
+
+	if (header.magic != R_HEADER_VALUE) {
+		RC_ERROR(rc, "Protocol version mismatch (expected 0x%08" PRIx64 ", got 0x%08" PRIx64, R_HEADER_VALUE,
+		         header.magic);
+		return -1;
+	}
+
+	if (header.size != size || header.update_count > R_PACKET_MAX_UPDATES) {
+		RC_ERROR(rc, "Invalid packet (size %u of %zu, %u updates)", header.size, size, header.update_count);
+		return -1;
+	}
+
+	bool keyframe = (header.flags & R_PACKET_FLAG_KEYFRAME) != 0;
+	if (require_keyframe && !keyframe) {
+		RC_ERROR(rc, "Packet isn't a keyframe");
+		return -1;
+	}
+
+	uint64_t keyframe_words[R_REMOTE_DATA_WORD_COUNT] = {0};
+	uint64_t stream_words[R_REMOTE_DATA_WORD_COUNT];
+	memcpy(stream_words, &rc->rx_base, sizeof(stream_words));
+
+	uint64_t *words = keyframe ? keyframe_words : stream_words;
+	const uint64_t valid_mask = (UINT64_C(1) << (R_REMOTE_DATA_WORD_COUNT - 1) << 1) - 1;
+
+	size_t offset = sizeof(header);
+	for (uint32_t i = 0; i < header.update_count; i++) {
+		struct r_remote_update_header update;
+
+		if (size - offset < sizeof(update)) {
+			RC_ERROR(rc, "Truncated packet");
+			return -1;
+		}
+		memcpy(&update, buffer + offset, sizeof(update));
+		offset += sizeof(update);
+
+		if ((update.changed_mask & ~valid_mask) != 0) {
+			RC_ERROR(rc, "Invalid changed mask 0x%016" PRIx64, update.changed_mask);
+			return -1;
+		}
+
+		for (uint32_t w = 0; w < R_REMOTE_DATA_WORD_COUNT; w++) {
+			if ((update.changed_mask & (UINT64_C(1) << w)) == 0) {
+				continue;
+			}
+
+			if (size - offset < sizeof(uint64_t)) {
+				RC_ERROR(rc, "Truncated packet");
+				return -1;
+			}
+			memcpy(&words[w], buffer + offset, sizeof(uint64_t));
+			offset += sizeof(uint64_t);
+		}
+
+		struct r_remote_data data;
+		memcpy(&data, words, sizeof(data));
+
+		if (data.header != R_HEADER_VALUE) {
+			RC_ERROR(rc, "Protocol version mismatch (expected 0x%08" PRIx64 ", got 0x%08" PRIx64,
+			         R_HEADER_VALUE, data.header);
+			return -1;
+		}
+
+		func(ptr, &data, update.timestamp_ns);
+	}
+
+	if (offset != size) {
+		RC_ERROR(rc, "Trailing data in packet (%zu bytes)", size - offset);
+		return -1;
+	}
+
+	if (!keyframe) {
+		memcpy(&rc->rx_base, stream_words, sizeof(rc->rx_base));
+	}
+
+	return 0;
+}
+
+static void
+copy_update(void *ptr, const struct r_remote_data *data, int64_t timestamp_ns)
+{
+	*(struct r_remote_data *)ptr = *data;
+}
+
+static int
+read_all(struct r_remote_connection *rc, void *data, size_t size)
+{
+	size_t current = 0;
+
+	while (current < size) {
+		void *ptr = (uint8_t *)data + current;
+		ssize_t ret = socket_read(rc->fd, ptr, size, current);
+		if (ret < 0) {
+			RC_ERROR(rc, "read: %zi", ret);
+			return (int)ret;
+		}
+		if (ret > 0) {
+			current += (size_t)ret;
+		} else {
+			RC_INFO(rc, "Disconnected!");
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+write_all(struct r_remote_connection *rc, const void *data, size_t size)
+{
+	size_t current = 0;
+
+	while (current < size) {
+		void *ptr = (uint8_t *)data + current;
+
+		ssize_t ret = socket_write(rc->fd, ptr, size, current);
+		if (ret < 0) {
+			RC_ERROR(rc, "write: %zi", ret);
+			return (int)ret;
+		}
+		if (ret > 0) {
+			current += (size_t)ret;
+		} else {
+			RC_INFO(rc, "Disconnected!");
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+
 /*
  *
  * Helper functions.
  *
  */
 
+/*!
+ * Bind a datagram socket to the same port as the stream, failing to do so
+ * isn't fatal, updates then only come over the stream.
+ */
+static void
+setup_udp_fd(struct r_hub *r)
+{
+	struct sockaddr_in server_address = {0};
+
+	r_socket_t fd = socket_create_udp();
+	if (fd < 0) {
+		R_WARN(r, "UDP socket: " R_SOCKET_FMT, fd);
+		return;
+	}
+
+	server_address.sin_family = AF_INET;
+	server_address.sin_addr.s_addr = htonl(INADDR_ANY);
+	server_address.sin_port = htons(r->port);
+
+	int ret = bind(fd, (struct sockaddr *)&server_address, sizeof(server_address));
+	if (ret < 0) {
+		R_WARN(r, "UDP bind: %i", ret);
+		socket_close(fd);
+		return;
+	}
+
+	r->udp_fd = fd;
+}
+
 static r_socket_t
 setup_accept_fd(struct r_hub *r)
 {
@@ -197,6 +446,8 @@ setup_accept_fd(struct r_hub *r)
 
 	listen(r->accept_fd, 5);
 
+	setup_udp_fd(r);
+
 	return 0;
 cleanup:
 #if defined(XRT_OS_WINDOWS)
@@ -256,8 +507,8 @@ do_accept(struct r_hub *r)
 
 	r_socket_t conn_fd = ret;
 
-	int flags = 1;
-	ret = socket_set_opt(r->accept_fd, flags);
+	// Updates are small and latency sensitive, don't let Nagle hold them back.
+	ret = socket_set_nodelay(conn_fd);
 	if (ret < 0) {
 		R_ERROR(r, "setsockopt: " R_SOCKET_FMT, ret);
 		socket_close(conn_fd);
@@ -265,6 +516,10 @@ do_accept(struct r_hub *r)
 	}
 
 	r->rc.fd = conn_fd;
+	r->peer_addr = addr.sin_addr.s_addr;
+	r->last_update_ns = 0;
+	r->remote_to_local_ns = 0;
+	reset_stream(&r->rc);
 
 	R_INFO(r, "Connection received! " R_SOCKET_FMT, r->rc.fd);
 
@@ -272,11 +527,10 @@ do_accept(struct r_hub *r)
 }
 
 static ssize_t
-read_one(struct r_hub *r, struct r_remote_data *data)
+read_exact(struct r_hub *r, void *data, size_t size)
 {
 	struct r_remote_connection *rc = &r->rc;
 
-	const size_t size = sizeof(*data);
 	size_t current = 0;
 
 	while (current < size) {
@@ -305,6 +559,123 @@ read_one(struct r_hub *r, struct r_remote_data *data)
 	return 0;
 }
 
+static bool
+wait_for_connection_data(struct r_hub *r, bool *out_stream, bool *out_datagram)
+{
+	fd_set set;
+	int ret = 0;
+
+	r_socket_t max_fd = r->rc.fd > r->udp_fd ? r->rc.fd : r->udp_fd;
+
+	while (os_thread_helper_is_running(&r->oth) && ret == 0) {
+		// Select can modify timeout, reset each loop.
+		struct timeval timeout = {.tv_sec = 1, .tv_usec = 0};
+
+		// Reset each loop.
+		FD_ZERO(&set);
+		FD_SET(r->rc.fd, &set);
+		if (r->udp_fd >= 0) {
+			FD_SET(r->udp_fd, &set);
+		}
+
+		ret = select((int)max_fd + 1, &set, NULL, NULL, &timeout);
+	}
+
+	if (ret < 0) {
+		R_ERROR(r, "select: %i", ret);
+		return false;
+	} else if (ret == 0) {
+		return false;
+	}
+
+	*out_stream = FD_ISSET(r->rc.fd, &set);
+	*out_datagram = r->udp_fd >= 0 && FD_ISSET(r->udp_fd, &set);
+
+	return true;
+}
+
+static void
+apply_update(void *ptr, const struct r_remote_data *data, int64_t timestamp_ns)
+{
+	struct r_hub *r = (struct r_hub *)ptr;
+
+	// Datagrams can arrive out of order, or duplicated.
+	if (timestamp_ns <= r->last_update_ns) {
+		R_TRACE(r, "Dropping stale update %" PRId64 " (last %" PRId64 ")", timestamp_ns, r->last_update_ns);
+		return;
+	}
+	r->last_update_ns = timestamp_ns;
+
+	r->latest = *data;
+
+	// Move the sender's timestamp into our clock.
+	int64_t now_ns = (int64_t)os_monotonic_get_ns();
+	int64_t local_ns = m_clock_offset_a2b(R_UPDATE_FREQUENCY, timestamp_ns, now_ns, &r->remote_to_local_ns);
+
+	r_hmd_push_latest(r->base.xdevs[0], local_ns);
+	r_device_push_latest(r->base.xdevs[r->left_index], local_ns);
+	r_device_push_latest(r->base.xdevs[r->right_index], local_ns);
+}
+
+static int
+read_packet(struct r_hub *r)
+{
+	uint8_t buffer[R_PACKET_MAX_SIZE];
+	struct r_remote_packet_header header;
+
+	if (read_exact(r, &header, sizeof(header)) < 0) {
+		return -1;
+	}
+
+	if (header.magic != R_HEADER_VALUE || header.size < sizeof(header) || header.size > sizeof(buffer)) {
+		R_ERROR(r, "Invalid packet (magic 0x%08" PRIx64 ", size %u)", header.magic, header.size);
+		return -1;
+	}
+
+	memcpy(buffer, &header, sizeof(header));
+	if (read_exact(r, buffer + sizeof(header), header.size - sizeof(header)) < 0) {
+		return -1;
+	}
+
+	return decode_packet(&r->rc, buffer, header.size, false, apply_update, r);
+}
+
+static void
+read_datagram(struct r_hub *r)
+{
+	uint8_t buffer[R_PACKET_MAX_UDP_SIZE];
+	struct sockaddr_in addr = {0};
+	socklen_t addr_length = (socklen_t)sizeof(addr);
+
+	ssize_t ret = socket_read_from(r->udp_fd, buffer, sizeof(buffer), &addr, &addr_length);
+	if (ret <= 0) {
+		return;
+	}
+
+	// Only take updates from whoever is connected to the stream.
+	if (addr.sin_addr.s_addr != r->peer_addr) {
+		R_DEBUG(r, "Ignoring datagram from %s", inet_ntoa(addr.sin_addr));
+		return;
+	}
+
+	// Each datagram stands on its own, a bad one is logged and dropped.
+	decode_packet(&r->rc, buffer, (size_t)ret, true, apply_update, r);
+}
+
+static void
+disconnect(struct r_hub *r)
+{
+	if (r->rc.fd >= 0) {
+		socket_close(r->rc.fd);
+		r->rc.fd = -1;
+	}
+
+	// Let the devices go back to the latest data, which the UI can edit.
+	r_hmd_push_latest(r->base.xdevs[0], -1);
+	r_device_push_latest(r->base.xdevs[r->left_index], -1);
+	r_device_push_latest(r->base.xdevs[r->right_index], -1);
+}
+
 static void *
 run_thread(void *ptr)
 {
@@ -330,15 +701,23 @@ run_thread(void *ptr)
 		r_remote_connection_write_one(&r->rc, &r->latest);
 
 		while (true) {
-			struct r_remote_data data;
+			bool stream = false;
+			bool datagram = false;
 
-			ret = read_one(r, &data);
-			if (ret < 0) {
+			if (!wait_for_connection_data(r, &stream, &datagram)) {
 				break;
 			}
 
-			r->latest = data;
+			if (datagram) {
+				read_datagram(r);
+			}
+
+			if (stream && read_packet(r) < 0) {
+				break;
+			}
 		}
+
+		disconnect(r);
 	}
 
 	R_INFO(r, "Leaving thread");
@@ -387,6 +766,11 @@ r_hub_system_devices_destroy(struct xrt_system_devices *xsysd)
 		r->rc.fd = -1;
 	}
 
+	if (r->udp_fd >= 0) {
+		socket_close(r->udp_fd);
+		r->udp_fd = -1;
+	}
+
 	free(r);
 
 #if defined(XRT_OS_WINDOWS)
@@ -440,7 +824,9 @@ r_create_devices(uint16_t port,
 	r->port = port;
 	r->view_count = view_count;
 	r->accept_fd = -1;
+	r->udp_fd = -1;
 	r->rc.fd = -1;
+	r->rc.udp_fd = -1;
 
 	snprintf(r->origin.name, sizeof(r->origin.name), "Remote Simulator");
 
@@ -451,13 +837,6 @@ r_create_devices(uint16_t port,
 		return XRT_ERROR_ALLOCATION;
 	}
 
-	ret = os_thread_helper_start(&r->oth, run_thread, r);
-	if (ret != 0) {
-		R_ERROR(r, "Failed to start thread!");
-		r_hub_system_devices_destroy(&r->base);
-		return XRT_ERROR_ALLOCATION;
-	}
-
 
 	/*
 	 * Setup system devices.
@@ -477,6 +856,14 @@ r_create_devices(uint16_t port,
 	r->base.static_roles.hand_tracking.conforming.left = left;
 	r->base.static_roles.hand_tracking.conforming.right = right;
 
+	// Started after the devices exist, updates are pushed to them.
+	ret = os_thread_helper_start(&r->oth, run_thread, r);
+	if (ret != 0) {
+		R_ERROR(r, "Failed to start thread!");
+		r_hub_system_devices_destroy(&r->base);
+		return XRT_ERROR_ALLOCATION;
+	}
+
 
 	/*
 	 * Space overseer.
@@ -554,6 +941,8 @@ r_remote_connection_init(struct r_remote_connection *rc, const char *ip_addr, ui
 
 	// Set log level.
 	rc->log_level = debug_get_log_option_remote_log();
+	rc->udp_fd = -1;
+	reset_stream(rc);
 
 #if defined(XRT_OS_WINDOWS)
 	// Initialize Winsock.
@@ -618,8 +1007,28 @@ r_remote_connection_init(struct r_remote_connection *rc, const char *ip_addr, ui
 		goto cleanup;
 	}
 
+	ret = socket_set_nodelay(conn_fd);
+	if (ret < 0) {
+		RC_ERROR(rc, "Failed to set TCP_NODELAY: %i", ret);
+		socket_close(conn_fd);
+		goto cleanup;
+	}
+
 	rc->fd = conn_fd;
 
+	if (debug_get_bool_option_remote_udp()) {
+		// Connected so plain writes go to the hub, falls back to the stream on failure.
+		r_socket_t udp_fd = socket_create_udp();
+		if (udp_fd >= 0 && connect(udp_fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+			rc->udp_fd = udp_fd;
+		} else {
+			RC_WARN(rc, "Failed to setup UDP, sending updates over TCP");
+			if (udp_fd >= 0) {
+				socket_close(udp_fd);
+			}
+		}
+	}
+
 	return 0;
 
 cleanup:
@@ -632,60 +1041,132 @@ cleanup:
 int
 r_remote_connection_read_one(struct r_remote_connection *rc, struct r_remote_data *data)
 {
-	const size_t size = sizeof(*data);
-	size_t current = 0;
+	uint8_t buffer[R_PACKET_MAX_SIZE];
+	struct r_remote_packet_header header;
 
-	while (current < size) {
-		void *ptr = (uint8_t *)data + current;
-		ssize_t ret = socket_read(rc->fd, ptr, size, current);
-		if (ret < 0) {
-			RC_ERROR(rc, "read: %zi", ret);
-			return ret;
-		}
-		if (ret > 0) {
-			current += (size_t)ret;
-		} else {
-			RC_INFO(rc, "Disconnected!");
-			return -1;
-		}
+	int ret = read_all(rc, &header, sizeof(header));
+	if (ret < 0) {
+		return ret;
 	}
 
-	if (data->header != R_HEADER_VALUE) {
+	if (header.magic != R_HEADER_VALUE) {
 		RC_ERROR(rc, "Protocol version mismatch (expected 0x%08" PRIx64 ", got 0x%08" PRIx64, R_HEADER_VALUE,
-		         data->header);
+		         header.magic);
 		return -1;
 	}
 
-	return 0;
+	if (header.size < sizeof(header) || header.size > sizeof(buffer) || header.update_count == 0) {
+		RC_ERROR(rc, "Invalid packet (size %u, %u updates)", header.size, header.update_count);
+		return -1;
+	}
+
+	memcpy(buffer, &header, sizeof(header));
+	ret = read_all(rc, buffer + sizeof(header), header.size - sizeof(header));
+	if (ret < 0) {
+		return ret;
+	}
+
+	return decode_packet(rc, buffer, header.size, false, copy_update, data);
 }
 
 int
 r_remote_connection_write_one(struct r_remote_connection *rc, const struct r_remote_data *data)
 {
-	const size_t size = sizeof(*data);
-	size_t current = 0;
+	int ret = r_remote_connection_queue(rc, data, (int64_t)os_monotonic_get_ns());
+	if (ret < 0) {
+		return ret;
+	}
+
+	return r_remote_connection_flush(rc);
+}
 
+int
+r_remote_connection_queue(struct r_remote_connection *rc, const struct r_remote_data *data, int64_t timestamp_ns)
+{
 	if (data->header != R_HEADER_VALUE) {
 		RC_ERROR(rc, "Protocol version mismatch (expected 0x%08" PRIx64 ", got 0x%08" PRIx64, R_HEADER_VALUE,
 		         data->header);
 		return -1;
 	}
 
-	while (current < size) {
-		void *ptr = (uint8_t *)data + current;
+	const bool udp = rc->udp_fd >= 0;
+	const size_t limit = udp ? R_PACKET_MAX_UDP_SIZE : sizeof(rc->tx_buffer);
+	const size_t worst_case = sizeof(struct r_remote_update_header) + sizeof(*data);
 
-		ssize_t ret = socket_write(rc->fd, ptr, size, current);
+	if (rc->tx_count >= R_PACKET_MAX_UPDATES || (rc->tx_count > 0 && rc->tx_size + worst_case > limit)) {
+		int ret = r_remote_connection_flush(rc);
 		if (ret < 0) {
-			RC_ERROR(rc, "write: %zi", ret);
 			return ret;
 		}
-		if (ret > 0) {
-			current += (size_t)ret;
-		} else {
-			RC_INFO(rc, "Disconnected!");
-			return -1;
+	}
+
+	if (rc->tx_count == 0) {
+		rc->tx_size = sizeof(struct r_remote_packet_header);
+
+		// Datagrams can be lost, so every one of them starts from scratch.
+		if (udp) {
+			U_ZERO(&rc->tx_base);
 		}
 	}
 
+	uint64_t base_words[R_REMOTE_DATA_WORD_COUNT];
+	uint64_t words[R_REMOTE_DATA_WORD_COUNT];
+	memcpy(base_words, &rc->tx_base, sizeof(base_words));
+	memcpy(words, data, sizeof(words));
+
+	struct r_remote_update_header update = {
+	    .timestamp_ns = timestamp_ns,
+	    .changed_mask = 0,
+	};
+
+	uint8_t *out = rc->tx_buffer + rc->tx_size + sizeof(update);
+	for (uint32_t w = 0; w < R_REMOTE_DATA_WORD_COUNT; w++) {
+		if (words[w] == base_words[w]) {
+			continue;
+		}
+
+		update.changed_mask |= UINT64_C(1) << w;
+		memcpy(out, &words[w], sizeof(uint64_t));
+		out += sizeof(uint64_t);
+	}
+
+	memcpy(rc->tx_buffer + rc->tx_size, &update, sizeof(update));
+	rc->tx_size = (uint32_t)(out - rc->tx_buffer);
+	rc->tx_count++;
+	rc->tx_base = *data;
+
+	return 0;
+}
+
+int
+r_remote_connection_flush(struct r_remote_connection *rc)
+{
+	if (rc->tx_count == 0) {
+		return 0;
+	}
+
+	const bool udp = rc->udp_fd >= 0;
+	const struct r_remote_packet_header header = {
+	    .magic = R_HEADER_VALUE,
+	    .size = rc->tx_size,
+	    .update_count = rc->tx_count,
+	    .flags = udp ? R_PACKET_FLAG_KEYFRAME : 0,
+	};
+	memcpy(rc->tx_buffer, &header, sizeof(header));
+
+	const size_t size = rc->tx_size;
+	rc->tx_size = 0;
+	rc->tx_count = 0;
+
+	if (!udp) {
+		return write_all(rc, rc->tx_buffer, size);
+	}
+
+	ssize_t ret = socket_write(rc->udp_fd, rc->tx_buffer, size, 0);
+	if (ret < 0 || (size_t)ret != size) {
+		RC_ERROR(rc, "UDP write: %zi", ret);
+		return -1;
+	}
+
 	return 0;
 }
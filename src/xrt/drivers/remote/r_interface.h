@@ -66,7 +66,29 @@ typedef int r_socket_t;
  *
  * @ingroup drv_remote
  */
-#define R_HEADER_VALUE (*(uint64_t *)"mndrmt3\0")
+#define R_HEADER_VALUE (*(uint64_t *)"mndrmt4\0")
+
+/*!
+ * Most updates batched into one packet.
+ *
+ * @ingroup drv_remote
+ */
+#define R_PACKET_MAX_UPDATES 16
+
+/*!
+ * Largest packet sent over UDP, keeps datagrams below common MTUs.
+ *
+ * @ingroup drv_remote
+ */
+#define R_PACKET_MAX_UDP_SIZE 1200
+
+/*!
+ * The updates in the packet are not relative to earlier packets, the first
+ * one is relative to all zeros. Always set on UDP, where packets may be lost.
+ *
+ * @ingroup drv_remote
+ */
+#define R_PACKET_FLAG_KEYFRAME (1u << 0)
 
 /*!
  * Data per controller.
@@ -144,6 +166,62 @@ struct r_remote_data
 	struct r_remote_controller_data left, right;
 };
 
+/*!
+ * Header of every packet on the wire, followed by
+ * @ref r_remote_packet_header::update_count updates.
+ *
+ * Each update is a @ref r_remote_update_header followed by one 64 bit word
+ * for every bit set in @ref r_remote_update_header::changed_mask. Those
+ * words replace the words of the @ref r_remote_data the update is relative
+ * to, which is the previous update in the stream, or all zeros for the first
+ * update of a @ref R_PACKET_FLAG_KEYFRAME packet.
+ *
+ * @ingroup drv_remote
+ */
+struct r_remote_packet_header
+{
+	//! Always @ref R_HEADER_VALUE.
+	uint64_t magic;
+
+	//! Size of the whole packet in bytes, including this header.
+	uint32_t size;
+
+	uint16_t update_count;
+
+	//! Bitfield of R_PACKET_FLAG_* values.
+	uint16_t flags;
+};
+
+/*!
+ * Header of a single update in a packet, see @ref r_remote_packet_header.
+ *
+ * @ingroup drv_remote
+ */
+struct r_remote_update_header
+{
+	//! When the sender sampled this state, in the sender's monotonic clock.
+	int64_t timestamp_ns;
+
+	//! Which words of @ref r_remote_data follow.
+	uint64_t changed_mask;
+};
+
+/*!
+ * Number of 64 bit words in @ref r_remote_data.
+ *
+ * @ingroup drv_remote
+ */
+#define R_REMOTE_DATA_WORD_COUNT (sizeof(struct r_remote_data) / sizeof(uint64_t))
+
+/*!
+ * Largest possible packet, all updates with every word changed.
+ *
+ * @ingroup drv_remote
+ */
+#define R_PACKET_MAX_SIZE                                                                                              \
+	(sizeof(struct r_remote_packet_header) +                                                                       \
+	 R_PACKET_MAX_UPDATES * (sizeof(struct r_remote_update_header) + sizeof(struct r_remote_data)))
+
 /*!
  * Shared connection.
  *
@@ -156,6 +234,20 @@ struct r_remote_connection
 
 	//! Socket.
 	r_socket_t fd;
+
+	//! Optional datagram socket, updates are sent over it instead if valid.
+	r_socket_t udp_fd;
+
+	//! Last state sent on the stream, updates are encoded relative to it.
+	struct r_remote_data tx_base;
+
+	//! Last state received on the stream, updates are decoded relative to it.
+	struct r_remote_data rx_base;
+
+	//! Updates queued for @ref r_remote_connection_flush.
+	uint8_t tx_buffer[R_PACKET_MAX_SIZE];
+	uint32_t tx_size;
+	uint16_t tx_count;
 };
 
 /*!
@@ -171,19 +263,48 @@ r_create_devices(uint16_t port,
                  struct xrt_space_overseer **out_xso);
 
 /*!
- * Initializes and connects the connection.
+ * Initializes and connects the connection, the stream always uses TCP. If
+ * the @p REMOTE_UDP option is set updates are sent over UDP to the same port.
  *
  * @ingroup drv_remote
  */
 r_socket_t
 r_remote_connection_init(struct r_remote_connection *rc, const char *addr, uint16_t port);
 
+/*!
+ * Read one packet from the stream, @p data is set to the last update in it.
+ *
+ * @ingroup drv_remote
+ */
 int
 r_remote_connection_read_one(struct r_remote_connection *rc, struct r_remote_data *data);
 
+/*!
+ * Queue and immediately send a single update, timestamped now.
+ *
+ * @ingroup drv_remote
+ */
 int
 r_remote_connection_write_one(struct r_remote_connection *rc, const struct r_remote_data *data);
 
+/*!
+ * Queue an update sampled at @p timestamp_ns, it is only encoded as the
+ * difference to the previous one. Sends the queued updates first if the
+ * packet is full.
+ *
+ * @ingroup drv_remote
+ */
+int
+r_remote_connection_queue(struct r_remote_connection *rc, const struct r_remote_data *data, int64_t timestamp_ns);
+
+/*!
+ * Send all queued updates as one packet.
+ *
+ * @ingroup drv_remote
+ */
+int
+r_remote_connection_flush(struct r_remote_connection *rc);
+
 
 #ifdef __cplusplus
 }
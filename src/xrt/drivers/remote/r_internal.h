@@ -1,4 +1,4 @@
-// Copyright 2020-2022, Collabora, Ltd.
+// Copyright 2020-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -17,7 +17,10 @@
 
 #include "os/os_threading.h"
 
+#include "math/m_relation_history.h"
+
 #include "util/u_hand_tracking.h"
+#include "util/u_hand_simulation.h"
 
 
 #ifdef __cplusplus
@@ -49,6 +52,18 @@ struct r_hub
 	//! Incoming connection socket.
 	r_socket_t accept_fd;
 
+	//! Datagram socket bound to the same port, receives updates.
+	r_socket_t udp_fd;
+
+	//! Address of the connected peer, only datagrams from it are accepted.
+	uint32_t peer_addr;
+
+	//! Sender timestamp of the last update applied, older ones are dropped.
+	int64_t last_update_ns;
+
+	//! Estimated offset from the sender's clock to ours.
+	int64_t remote_to_local_ns;
+
 	uint16_t port;
 	uint32_t view_count;
 
@@ -76,6 +91,9 @@ struct r_hmd
 	struct xrt_device base;
 
 	struct r_hub *r;
+
+	//! Head poses with remote timestamps, if empty the latest data is used.
+	struct m_relation_history *relation_hist;
 };
 
 /*!
@@ -91,6 +109,12 @@ struct r_device
 
 	struct u_hand_tracking hand_tracking;
 
+	//! Reuses the simulated joints between calls with the same curls.
+	struct u_hand_sim_cache hand_sim;
+
+	//! Controller poses with remote timestamps, if empty the latest data is used.
+	struct m_relation_history *relation_hist;
+
 	bool is_left;
 };
 
@@ -98,9 +122,23 @@ struct r_device
 struct xrt_device *
 r_hmd_create(struct r_hub *r);
 
+/*!
+ * Record the head pose of the hub's latest data as sampled at @p timestamp_ns,
+ * pass a negative timestamp to forget all recorded poses.
+ */
+void
+r_hmd_push_latest(struct xrt_device *xdev, int64_t timestamp_ns);
+
 struct xrt_device *
 r_device_create(struct r_hub *r, bool is_left);
 
+/*!
+ * Record the controller pose of the hub's latest data as sampled at
+ * @p timestamp_ns, pass a negative timestamp to forget all recorded poses.
+ */
+void
+r_device_push_latest(struct xrt_device *xdev, int64_t timestamp_ns);
+
 
 #ifdef __cplusplus
 }
@@ -29,6 +29,8 @@
 #include "os/os_hid.h"
 #include "os/os_time.h"
 
+#include "util/u_device_cache.h"
+
 #include "xrt/xrt_defines.h"
 
 #include "rift_s.h"
@@ -261,6 +263,30 @@ rift_s_read_firmware_block(struct os_hid_device *dev, uint8_t block_id, char **d
 	if (block_len < 0xC || block_len == 0xFFFFFFFF)
 		return -1; /* Invalid block */
 
+	/* The header checksum changes with the contents, so a cached copy
+	 * matching it lets us skip reading the block 56 bytes at a time. */
+	uint8_t fingerprint[13];
+	fingerprint[0] = block_id;
+	memcpy(fingerprint + 1, buf + 8, 12);
+
+	char cache_name[32];
+	snprintf(cache_name, sizeof(cache_name), "rift_s_fw_block_%02x", block_id);
+
+	uint64_t cache_key = 0;
+	bool use_cache = u_device_cache_make_key(NULL, fingerprint, sizeof(fingerprint), &cache_key);
+	if (use_cache) {
+		void *cached = NULL;
+		size_t cached_size = 0;
+		if (u_device_cache_load(cache_key, cache_name, &cached, &cached_size)) {
+			if (cached_size == block_len) {
+				*data_out = (char *)cached;
+				*len_out = block_len;
+				return 0;
+			}
+			free(cached);
+		}
+	}
+
 #if 0
 	uint64_t checksum = *(uint64_t *)(buf + 8);
 	printf ("FW Block %02x Header. Checksum(?) %08lx len %d\n", block_id, checksum, block_len);
@@ -301,6 +327,10 @@ rift_s_read_firmware_block(struct os_hid_device *dev, uint8_t block_id, char **d
 		else
 			rift_s_hexdump_buffer (label, outbuf, total_read);
 #endif
+
+		if (use_cache) {
+			u_device_cache_store(cache_key, cache_name, outbuf, block_len);
+		}
 	}
 
 	*data_out = (char *)(outbuf);
@@ -29,9 +29,7 @@
 #include "util/u_trace_marker.h"
 #include "util/u_var.h"
 
-#ifdef XRT_OS_LINUX
-#include "util/u_linux.h"
-#endif
+#include "util/u_thread_policy.h"
 
 
 
@@ -278,10 +276,8 @@ rokid_usb_thread(void *ptr)
 	U_TRACE_SET_THREAD_NAME("Rokid USB thread");
 	struct rokid_hmd *rokid = ptr;
 
-#ifdef XRT_OS_LINUX
 	// Try to raise priority of this thread, so we don't miss packets under load
-	u_linux_try_to_set_realtime_priority_on_thread(U_LOGGING_INFO, "Rokid USB thread");
-#endif
+	u_thread_policy_apply(U_LOGGING_INFO, OS_THREAD_ROLE_IMU, "Rokid USB thread");
 
 	int last_libusb_result = LIBUSB_SUCCESS;
 
@@ -1,4 +1,4 @@
-// Copyright 2020-2023, Collabora, Ltd.
+// Copyright 2020-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -43,6 +43,21 @@ enum simulated_movement
 	SIMULATED_MOVEMENT_STATIONARY,
 };
 
+/*!
+ * What kind of device @ref simulated_stress_create should create.
+ *
+ * @ingroup drv_simulated
+ */
+enum simulated_stress_kind
+{
+	//! A Vive tracker with all its inputs.
+	SIMULATED_STRESS_TRACKER,
+	//! A hand tracker providing both unobstructed hands.
+	SIMULATED_STRESS_HANDS,
+	//! A body tracker providing the XR_FB_body_tracking joints.
+	SIMULATED_STRESS_BODY,
+};
+
 /*!
  * Return the logging level that we want for the simulated related code.
  *
@@ -88,6 +103,20 @@ simulated_create_controller(enum xrt_device_name name,
                             const struct xrt_pose *center,
                             struct xrt_tracking_origin *origin);
 
+/*!
+ * Create a device for stress testing, it moves and changes its inputs on its
+ * own thread at @p rate_hz, pushing poses through a @ref m_relation_history
+ * like a real driver. The @p index offsets the motion between devices.
+ *
+ * @ingroup drv_simulated
+ */
+struct xrt_device *
+simulated_stress_create(enum simulated_stress_kind kind,
+                        uint32_t index,
+                        uint32_t rate_hz,
+                        const struct xrt_pose *center,
+                        struct xrt_tracking_origin *origin);
+
 
 #ifdef __cplusplus
 }
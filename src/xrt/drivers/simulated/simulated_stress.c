@@ -0,0 +1,509 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Simulated devices for stress testing the service with many devices.
+ * @ingroup drv_simulated
+ */
+
+#include "xrt/xrt_device.h"
+
+#include "os/os_time.h"
+#include "os/os_threading.h"
+
+#include "math/m_api.h"
+#include "math/m_mathinclude.h"
+#include "math/m_relation_history.h"
+
+#include "util/u_var.h"
+#include "util/u_misc.h"
+#include "util/u_time.h"
+#include "util/u_device.h"
+#include "util/u_logging.h"
+#include "util/u_hand_tracking.h"
+#include "util/u_hand_simulation.h"
+
+#include "simulated_interface.h"
+
+#include <stdio.h>
+#include <assert.h>
+
+
+/*
+ *
+ * Structs and defines.
+ *
+ */
+
+//! Enough for the largest input list below.
+#define SIMULATED_STRESS_MAX_INPUTS (16)
+
+//! How far apart the hands are from the center of the hand tracker.
+#define SIMULATED_STRESS_HAND_OFFSET (0.15f)
+
+//! Length of one bone of the placeholder body skeleton.
+#define SIMULATED_STRESS_BONE_LENGTH (0.025f)
+
+/*!
+ * A device that moves and changes its inputs on its own thread at a fixed
+ * rate, the same way a real driver gets data from the hardware.
+ *
+ * @implements xrt_device
+ */
+struct simulated_stress_device
+{
+	struct xrt_device base;
+
+	enum simulated_stress_kind kind;
+
+	struct xrt_pose center;
+
+	//! Offsets the motion so all devices don't move in lockstep.
+	double phase;
+
+	//! Rate the thread samples the motion and inputs at.
+	uint32_t rate_hz;
+
+	//! Pushed to by the thread.
+	struct m_relation_history *relation_hist;
+
+	struct os_thread_helper oth;
+
+	//! Latest input values from the thread, copied to the inputs in update_inputs.
+	struct
+	{
+		struct os_mutex mutex;
+		int64_t timestamp_ns;
+		union xrt_input_value values[SIMULATED_STRESS_MAX_INPUTS];
+	} pending;
+
+	//! Number of samples pushed by the thread.
+	uint64_t sample_count;
+};
+
+
+/*
+ *
+ * Helper functions.
+ *
+ */
+
+static inline struct simulated_stress_device *
+simulated_stress_device(struct xrt_device *xdev)
+{
+	return (struct simulated_stress_device *)xdev;
+}
+
+static const char *
+kind_to_str(enum simulated_stress_kind kind)
+{
+	switch (kind) {
+	case SIMULATED_STRESS_TRACKER: return "Tracker";
+	case SIMULATED_STRESS_HANDS: return "Hand Tracker";
+	case SIMULATED_STRESS_BODY: return "Body Tracker";
+	default: assert(false); return NULL;
+	}
+}
+
+/*!
+ * Slow figure eight with some turning, roughly how a tracker on a person
+ * moves, with the matching velocities.
+ */
+static void
+compute_motion(const struct simulated_stress_device *ssd, int64_t timestamp_ns, struct xrt_space_relation *out_rel)
+{
+	const double w = 2.0 * M_PI * 0.25; // Quarter of a loop per second.
+	double t = time_ns_to_s(timestamp_ns) * w + ssd->phase;
+
+	struct xrt_vec3 offset = {
+	    (float)(0.10 * sin(t)),
+	    (float)(0.05 * sin(2.0 * t)),
+	    (float)(0.03 * cos(t)),
+	};
+	struct xrt_vec3 linear_velocity = {
+	    (float)(0.10 * w * cos(t)),
+	    (float)(0.05 * 2.0 * w * cos(2.0 * t)),
+	    (float)(-0.03 * w * sin(t)),
+	};
+
+	float yaw = (float)(0.4 * sin(t));
+	struct xrt_vec3 up = {0.0f, 1.0f, 0.0f};
+	struct xrt_quat rot;
+	math_quat_from_angle_vector(yaw, &up, &rot);
+
+	struct xrt_pose pose = ssd->center;
+	math_quat_rotate(&pose.orientation, &rot, &pose.orientation);
+	math_vec3_accum(&offset, &pose.position);
+
+	out_rel->pose = pose;
+	out_rel->linear_velocity = linear_velocity;
+	out_rel->angular_velocity = (struct xrt_vec3){0.0f, (float)(0.4 * w * cos(t)), 0.0f};
+	out_rel->relation_flags = (enum xrt_space_relation_flags)(
+	    XRT_SPACE_RELATION_ORIENTATION_VALID_BIT | XRT_SPACE_RELATION_POSITION_VALID_BIT |
+	    XRT_SPACE_RELATION_ORIENTATION_TRACKED_BIT | XRT_SPACE_RELATION_POSITION_TRACKED_BIT |
+	    XRT_SPACE_RELATION_LINEAR_VELOCITY_VALID_BIT | XRT_SPACE_RELATION_ANGULAR_VELOCITY_VALID_BIT);
+}
+
+//! Buttons get pressed every couple of seconds and the analog inputs sweep.
+static void
+compute_inputs(struct simulated_stress_device *ssd, int64_t timestamp_ns)
+{
+	double t = time_ns_to_s(timestamp_ns) + ssd->phase;
+
+	os_mutex_lock(&ssd->pending.mutex);
+	ssd->pending.timestamp_ns = timestamp_ns;
+
+	for (uint32_t i = 0; i < ssd->base.input_count; i++) {
+		union xrt_input_value *v = &ssd->pending.values[i];
+		double ti = t + i * 0.3;
+
+		switch (XRT_GET_INPUT_TYPE(ssd->base.inputs[i].name)) {
+		case XRT_INPUT_TYPE_BOOLEAN: v->boolean = fmod(ti, 2.0) < 0.5; break;
+		case XRT_INPUT_TYPE_VEC1_ZERO_TO_ONE: v->vec1.x = (float)(0.5 + 0.5 * sin(ti)); break;
+		case XRT_INPUT_TYPE_VEC1_MINUS_ONE_TO_ONE: v->vec1.x = (float)sin(ti); break;
+		case XRT_INPUT_TYPE_VEC2_MINUS_ONE_TO_ONE:
+			v->vec2.x = (float)cos(ti);
+			v->vec2.y = (float)sin(ti);
+			break;
+		default: break;
+		}
+	}
+
+	os_mutex_unlock(&ssd->pending.mutex);
+}
+
+static void *
+run_thread(void *ptr)
+{
+	struct simulated_stress_device *ssd = (struct simulated_stress_device *)ptr;
+	os_thread_helper_name(&ssd->oth, "Simulated Stress");
+
+	const int64_t period_ns = (int64_t)U_TIME_1S_IN_NS / ssd->rate_hz;
+	int64_t next_ns = os_monotonic_get_ns();
+
+	os_thread_helper_lock(&ssd->oth);
+	while (os_thread_helper_is_running_locked(&ssd->oth)) {
+		os_thread_helper_unlock(&ssd->oth);
+
+		int64_t now_ns = os_monotonic_get_ns();
+
+		struct xrt_space_relation rel;
+		compute_motion(ssd, now_ns, &rel);
+		m_relation_history_push(ssd->relation_hist, &rel, now_ns);
+		compute_inputs(ssd, now_ns);
+		ssd->sample_count++;
+
+		// Don't try to catch up if we fell behind, like hardware wouldn't.
+		next_ns += period_ns;
+		if (next_ns < now_ns) {
+			next_ns = now_ns + period_ns;
+		}
+		os_nanosleep(next_ns - now_ns);
+
+		os_thread_helper_lock(&ssd->oth);
+	}
+	os_thread_helper_unlock(&ssd->oth);
+
+	return NULL;
+}
+
+
+/*
+ *
+ * Member functions.
+ *
+ */
+
+static void
+simulated_stress_destroy(struct xrt_device *xdev)
+{
+	struct simulated_stress_device *ssd = simulated_stress_device(xdev);
+
+	os_thread_helper_destroy(&ssd->oth);
+
+	u_var_remove_root(ssd);
+
+	m_relation_history_destroy(&ssd->relation_hist);
+	os_mutex_destroy(&ssd->pending.mutex);
+
+	u_device_free(&ssd->base);
+}
+
+static xrt_result_t
+simulated_stress_update_inputs(struct xrt_device *xdev)
+{
+	struct simulated_stress_device *ssd = simulated_stress_device(xdev);
+
+	os_mutex_lock(&ssd->pending.mutex);
+	for (uint32_t i = 0; i < xdev->input_count; i++) {
+		xdev->inputs[i].timestamp = ssd->pending.timestamp_ns;
+		xdev->inputs[i].value = ssd->pending.values[i];
+	}
+	os_mutex_unlock(&ssd->pending.mutex);
+
+	return XRT_SUCCESS;
+}
+
+static xrt_result_t
+simulated_stress_get_tracked_pose(struct xrt_device *xdev,
+                                  enum xrt_input_name name,
+                                  int64_t at_timestamp_ns,
+                                  struct xrt_space_relation *out_relation)
+{
+	struct simulated_stress_device *ssd = simulated_stress_device(xdev);
+
+	if (name != XRT_INPUT_VIVE_TRACKER_GRIP_POSE && name != XRT_INPUT_GENERIC_TRACKER_POSE) {
+		U_LOG_XDEV_UNSUPPORTED_INPUT(&ssd->base, u_log_get_global_level(), name);
+		return XRT_ERROR_INPUT_UNSUPPORTED;
+	}
+
+	m_relation_history_get(ssd->relation_hist, at_timestamp_ns, out_relation);
+
+	return XRT_SUCCESS;
+}
+
+static xrt_result_t
+simulated_stress_get_hand_tracking(struct xrt_device *xdev,
+                                   enum xrt_input_name name,
+                                   int64_t desired_timestamp_ns,
+                                   struct xrt_hand_joint_set *out_value,
+                                   int64_t *out_timestamp_ns)
+{
+	struct simulated_stress_device *ssd = simulated_stress_device(xdev);
+
+	enum xrt_hand hand;
+	float side;
+	switch (name) {
+	case XRT_INPUT_HT_UNOBSTRUCTED_LEFT:
+		hand = XRT_HAND_LEFT;
+		side = -1.0f;
+		break;
+	case XRT_INPUT_HT_UNOBSTRUCTED_RIGHT:
+		hand = XRT_HAND_RIGHT;
+		side = 1.0f;
+		break;
+	default:
+		U_LOG_XDEV_UNSUPPORTED_INPUT(&ssd->base, u_log_get_global_level(), name);
+		return XRT_ERROR_INPUT_UNSUPPORTED;
+	}
+
+	struct xrt_space_relation root;
+	m_relation_history_get(ssd->relation_hist, desired_timestamp_ns, &root);
+	root.pose.position.x += side * SIMULATED_STRESS_HAND_OFFSET;
+
+	// Open and close the hand.
+	float curl = (float)(0.5 + 0.5 * sin(time_ns_to_s(desired_timestamp_ns) + ssd->phase));
+	struct u_hand_tracking_curl_values values = {
+	    .little = curl,
+	    .ring = curl,
+	    .middle = curl,
+	    .index = curl,
+	    .thumb = curl,
+	};
+
+	u_hand_sim_simulate_for_valve_index_knuckles(&values, hand, &root, out_value);
+	out_value->is_active = true;
+	*out_timestamp_ns = desired_timestamp_ns;
+
+	return XRT_SUCCESS;
+}
+
+/*!
+ * Just a column of joints, the hierarchy is not meant to look like a body only
+ * to have the same amount of data as a real body tracker.
+ */
+static xrt_result_t
+simulated_stress_get_body_skeleton(struct xrt_device *xdev,
+                                   enum xrt_input_name body_tracking_type,
+                                   struct xrt_body_skeleton *out_value)
+{
+	if (body_tracking_type != XRT_INPUT_FB_BODY_TRACKING) {
+		return XRT_ERROR_NOT_IMPLEMENTED;
+	}
+
+	for (int32_t i = 0; i < XRT_BODY_JOINT_COUNT_FB; i++) {
+		struct xrt_body_skeleton_joint_fb *joint = &out_value->body_skeleton_fb.joints[i];
+		joint->pose = (struct xrt_pose)XRT_POSE_IDENTITY;
+		joint->pose.position.y = i * SIMULATED_STRESS_BONE_LENGTH;
+		joint->joint = i;
+		joint->parent_joint = i == 0 ? XRT_BODY_JOINT_NONE_FB : i - 1;
+	}
+
+	return XRT_SUCCESS;
+}
+
+static xrt_result_t
+simulated_stress_get_body_joints(struct xrt_device *xdev,
+                                 enum xrt_input_name body_tracking_type,
+                                 int64_t desired_timestamp_ns,
+                                 struct xrt_body_joint_set *out_value)
+{
+	struct simulated_stress_device *ssd = simulated_stress_device(xdev);
+
+	if (body_tracking_type != XRT_INPUT_FB_BODY_TRACKING) {
+		return XRT_ERROR_NOT_IMPLEMENTED;
+	}
+
+	struct xrt_space_relation body;
+	m_relation_history_get(ssd->relation_hist, desired_timestamp_ns, &body);
+
+	struct xrt_body_joint_set_fb *set = &out_value->body_joint_set_fb;
+	for (int32_t i = 0; i < XRT_BODY_JOINT_COUNT_FB; i++) {
+		struct xrt_space_relation *rel = &set->joint_locations[i].relation;
+		*rel = body;
+		rel->pose.position.y += i * SIMULATED_STRESS_BONE_LENGTH;
+	}
+
+	set->base.sample_time_ns = desired_timestamp_ns;
+	set->base.confidence = 1.0f;
+	set->base.skeleton_changed_count = 0;
+	set->base.is_active = true;
+	out_value->body_pose = body;
+
+	return XRT_SUCCESS;
+}
+
+
+/*
+ *
+ * Various data driven arrays.
+ *
+ */
+
+static enum xrt_input_name tracker_inputs_array[] = {
+    XRT_INPUT_VIVE_TRACKER_SYSTEM_CLICK,   XRT_INPUT_VIVE_TRACKER_MENU_CLICK,
+    XRT_INPUT_VIVE_TRACKER_TRIGGER_CLICK,  XRT_INPUT_VIVE_TRACKER_SQUEEZE_CLICK,
+    XRT_INPUT_VIVE_TRACKER_TRIGGER_VALUE,  XRT_INPUT_VIVE_TRACKER_TRACKPAD,
+    XRT_INPUT_VIVE_TRACKER_TRACKPAD_CLICK, XRT_INPUT_VIVE_TRACKER_TRACKPAD_TOUCH,
+    XRT_INPUT_VIVE_TRACKER_GRIP_POSE,
+};
+
+static enum xrt_input_name hands_inputs_array[] = {
+    XRT_INPUT_HT_UNOBSTRUCTED_LEFT,
+    XRT_INPUT_HT_UNOBSTRUCTED_RIGHT,
+};
+
+static enum xrt_input_name body_inputs_array[] = {
+    XRT_INPUT_FB_BODY_TRACKING,
+};
+
+
+/*
+ *
+ * 'Exported' functions.
+ *
+ */
+
+struct xrt_device *
+simulated_stress_create(enum simulated_stress_kind kind,
+                        uint32_t index,
+                        uint32_t rate_hz,
+                        const struct xrt_pose *center,
+                        struct xrt_tracking_origin *origin)
+{
+	const enum u_device_alloc_flags flags = U_DEVICE_ALLOC_TRACKING_NONE;
+	enum xrt_input_name *inputs = NULL;
+	uint32_t input_count = 0;
+
+	switch (kind) {
+	case SIMULATED_STRESS_TRACKER:
+		inputs = tracker_inputs_array;
+		input_count = ARRAY_SIZE(tracker_inputs_array);
+		break;
+	case SIMULATED_STRESS_HANDS:
+		inputs = hands_inputs_array;
+		input_count = ARRAY_SIZE(hands_inputs_array);
+		break;
+	case SIMULATED_STRESS_BODY:
+		inputs = body_inputs_array;
+		input_count = ARRAY_SIZE(body_inputs_array);
+		break;
+	default: assert(false); return NULL;
+	}
+	assert(input_count <= SIMULATED_STRESS_MAX_INPUTS);
+	assert(rate_hz > 0);
+
+	// Allocate.
+	struct simulated_stress_device *ssd =
+	    U_DEVICE_ALLOCATE(struct simulated_stress_device, flags, input_count, 0);
+	ssd->base.update_inputs = simulated_stress_update_inputs;
+	ssd->base.get_tracked_pose = simulated_stress_get_tracked_pose;
+	ssd->base.get_hand_tracking = u_device_ni_get_hand_tracking;
+	ssd->base.get_view_poses = u_device_ni_get_view_poses;
+	ssd->base.set_output = u_device_ni_set_output;
+	ssd->base.destroy = simulated_stress_destroy;
+	ssd->base.tracking_origin = origin;
+	ssd->base.supported.orientation_tracking = true;
+	ssd->base.supported.position_tracking = true;
+
+	switch (kind) {
+	case SIMULATED_STRESS_TRACKER:
+		ssd->base.name = XRT_DEVICE_VIVE_TRACKER_GEN3;
+		ssd->base.device_type = XRT_DEVICE_TYPE_GENERIC_TRACKER;
+		break;
+	case SIMULATED_STRESS_HANDS:
+		ssd->base.name = XRT_DEVICE_HAND_TRACKER;
+		ssd->base.device_type = XRT_DEVICE_TYPE_HAND_TRACKER;
+		ssd->base.get_hand_tracking = simulated_stress_get_hand_tracking;
+		ssd->base.supported.hand_tracking = true;
+		break;
+	case SIMULATED_STRESS_BODY:
+		ssd->base.name = XRT_DEVICE_FB_BODY_TRACKING;
+		ssd->base.device_type = XRT_DEVICE_TYPE_BODY_TRACKER;
+		ssd->base.get_body_skeleton = simulated_stress_get_body_skeleton;
+		ssd->base.get_body_joints = simulated_stress_get_body_joints;
+		ssd->base.supported.body_tracking = true;
+		break;
+	default: assert(false); break;
+	}
+
+	snprintf(ssd->base.str, sizeof(ssd->base.str), "%s %u (Simulated Stress)", kind_to_str(kind), index);
+	snprintf(ssd->base.serial, sizeof(ssd->base.serial), "Simulated Stress %s %u", kind_to_str(kind), index);
+
+	for (uint32_t i = 0; i < input_count; i++) {
+		ssd->base.inputs[i].name = inputs[i];
+	}
+
+	ssd->kind = kind;
+	ssd->center = *center;
+	ssd->phase = index * 0.7;
+	ssd->rate_hz = rate_hz;
+
+	int ret = os_mutex_init(&ssd->pending.mutex);
+	if (ret != 0) {
+		U_LOG_E("Failed to init mutex!");
+		u_device_free(&ssd->base);
+		return NULL;
+	}
+
+	ret = os_thread_helper_init(&ssd->oth);
+	if (ret != 0) {
+		U_LOG_E("Failed to init thread helper!");
+		os_mutex_destroy(&ssd->pending.mutex);
+		u_device_free(&ssd->base);
+		return NULL;
+	}
+
+	m_relation_history_create(&ssd->relation_hist);
+
+	// Have a pose before anybody asks for it.
+	int64_t now_ns = os_monotonic_get_ns();
+	struct xrt_space_relation rel;
+	compute_motion(ssd, now_ns, &rel);
+	m_relation_history_push(ssd->relation_hist, &rel, now_ns);
+	compute_inputs(ssd, now_ns);
+
+	u_var_add_root(ssd, ssd->base.str, true);
+	u_var_add_pose(ssd, &ssd->center, "center");
+	u_var_add_ro_u32(ssd, &ssd->rate_hz, "rate_hz");
+	u_var_add_ro_u64(ssd, &ssd->sample_count, "sample_count");
+
+	ret = os_thread_helper_start(&ssd->oth, run_thread, ssd);
+	if (ret != 0) {
+		U_LOG_E("Failed to start thread!");
+		simulated_stress_destroy(&ssd->base);
+		return NULL;
+	}
+
+	return &ssd->base;
+}
@@ -289,7 +289,8 @@ Device::~Device()
 
 Device::Device(const DeviceBuilder &builder) : xrt_device({}), ctx(builder.ctx), driver(builder.driver)
 {
-	m_relation_history_create(&relation_hist);
+	// Poses are pushed from the driver's thread at IMU rate and read from many threads, keep reads lock free.
+	m_relation_history_create_with_mode(&relation_hist, M_RELATION_HISTORY_MODE_SEQLOCK);
 	std::strncpy(this->serial, builder.serial, XRT_DEVICE_NAME_LEN - 1);
 	this->serial[XRT_DEVICE_NAME_LEN - 1] = 0;
 	this->tracking_origin = ctx.get();
@@ -609,7 +610,6 @@ ControllerDevice::set_haptic_handle(vr::VRInputComponentHandle_t handle)
 xrt_result_t
 Device::update_inputs()
 {
-	std::lock_guard<std::mutex> lock(frame_mutex);
 	ctx->maybe_run_frame(++current_frame);
 	return XRT_SUCCESS;
 }
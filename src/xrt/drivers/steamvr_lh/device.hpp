@@ -15,6 +15,7 @@
 #include <array>
 #include <optional>
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 
@@ -118,9 +119,7 @@ protected:
 
 private:
 	vr::ITrackedDeviceServerDriver *driver;
-	uint64_t current_frame{0};
-
-	std::mutex frame_mutex;
+	std::atomic<uint64_t> current_frame{0};
 
 	void
 	init_chaperone(const std::string &steam_install);
@@ -51,6 +51,8 @@ private:
 	BlockQueue blockqueue;
 	Paths paths;
 
+	//! Serializes @ref run_frame calls from the devices' update_inputs.
+	std::mutex frame_mut;
 	uint64_t current_frame{0};
 
 	std::vector<vr::VRInputComponentHandle_t> handles;
@@ -294,6 +294,7 @@ Context::run_frame()
 void
 Context::maybe_run_frame(uint64_t new_frame)
 {
+	std::lock_guard lk(frame_mut);
 	if (new_frame > current_frame) {
 		++current_frame;
 		run_frame();
@@ -396,21 +397,22 @@ Context::add_haptic_event(vr::VREvent_HapticVibration_t event)
 bool
 Context::PollNextEvent(vr::VREvent_t *pEvent, uint32_t uncbVREvent)
 {
-	if (!events.empty()) {
-		assert(sizeof(vr::VREvent_t) == uncbVREvent);
-		Event e;
-		{
-			std::lock_guard lk(event_queue_mut);
-			e = events.front();
-			events.pop_front();
+	assert(sizeof(vr::VREvent_t) == uncbVREvent);
+	Event e;
+	{
+		std::lock_guard lk(event_queue_mut);
+		if (events.empty()) {
+			return false;
 		}
-		*pEvent = e.inner;
-		using float_sec = std::chrono::duration<float>;
-		float_sec event_age = std::chrono::steady_clock::now() - e.insert_time;
-		pEvent->eventAgeSeconds = event_age.count();
-		return true;
+		e = events.front();
+		events.pop_front();
 	}
-	return false;
+
+	*pEvent = e.inner;
+	using float_sec = std::chrono::duration<float>;
+	float_sec event_age = std::chrono::steady_clock::now() - e.insert_time;
+	pEvent->eventAgeSeconds = event_age.count();
+	return true;
 }
 
 void
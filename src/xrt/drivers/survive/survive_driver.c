@@ -1,4 +1,4 @@
-// Copyright 2019-2023, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -64,6 +64,9 @@
 //! excl HMD we support 16 devices (controllers, trackers, ...)
 #define MAX_TRACKED_DEVICE_COUNT 16
 
+//! Max events drained from libsurvive before pending poses are pushed.
+#define MAX_EVENTS_PER_TICK 64
+
 DEBUG_GET_ONCE_BOOL_OPTION(survive_disable_hand_emulation, "SURVIVE_DISABLE_HAND_EMULATION", false)
 DEBUG_GET_ONCE_BOOL_OPTION(survive_default_ipd, "SURVIVE_DEFAULT_IPD", false)
 DEBUG_GET_ONCE_FLOAT_OPTION(survive_timecode_offset_ms, "SURVIVE_TIMECODE_OFFSET_MS", 0.0)
@@ -153,6 +156,9 @@ struct survive_device
 			uint64_t curl_ts[XRT_FINGER_COUNT];
 			struct u_hand_tracking hand_tracking;
 
+			//! Reuses the simulated joints between calls with the same curls.
+			struct u_hand_sim_cache hand_sim;
+
 			struct vive_controller_config config;
 		} ctrl;
 	};
@@ -190,6 +196,9 @@ survive_device_destroy(struct xrt_device *xdev)
 		vive_config_teardown(&survive->hmd.config);
 		survive->sys->hmd = NULL;
 	}
+	if (survive->device_type == DEVICE_TYPE_CONTROLLER) {
+		u_hand_sim_cache_fini(&survive->ctrl.hand_sim);
+	}
 	for (int i = 0; i < MAX_TRACKED_DEVICE_COUNT; i++) {
 		if (survive == survive->sys->controllers[i]) {
 			survive->sys->controllers[i] = NULL;
@@ -503,7 +512,8 @@ survive_controller_get_hand_tracking(struct xrt_device *xdev,
 	m_relation_history_get(survive->relation_hist, at_timestamp_ns, &hand_relation);
 
 
-	u_hand_sim_simulate_for_valve_index_knuckles(&values, hand, &hand_relation, out_value);
+	u_hand_sim_simulate_for_valve_index_knuckles_cached(&survive->ctrl.hand_sim, &values, hand, &hand_relation,
+	                                                    out_value);
 
 
 	struct xrt_relation_chain chain = {0};
@@ -1094,6 +1104,7 @@ _create_controller_device(struct survive_system *sys,
 	struct survive_device *survive = U_DEVICE_ALLOCATE(struct survive_device, flags, inputs, outputs);
 	survive->ctrl.config = *config;
 	m_relation_history_create(&survive->relation_hist);
+	u_hand_sim_cache_init(&survive->ctrl.hand_sim);
 
 	sys->controllers[idx] = survive;
 	survive->sys = sys;
@@ -1314,11 +1325,42 @@ add_connected_devices(struct survive_system *ss)
 	return true;
 }
 
+/*!
+ * Latest pose event of one device, pose events are coalesced per device for
+ * every batch of events drained from libsurvive.
+ */
+struct survive_pending_pose
+{
+	struct survive_device *survive;
+	struct SurviveSimplePoseUpdatedEvent event;
+};
+
+static void
+_queue_pose_event(struct survive_pending_pose *pending,
+                  size_t *pending_count,
+                  struct survive_device *survive,
+                  const struct SurviveSimplePoseUpdatedEvent *e)
+{
+	for (size_t i = 0; i < *pending_count; i++) {
+		if (pending[i].survive == survive) {
+			pending[i].event = *e;
+			return;
+		}
+	}
+
+	pending[*pending_count].survive = survive;
+	pending[*pending_count].event = *e;
+	(*pending_count)++;
+}
+
 static void *
 run_event_thread(void *ptr)
 {
 	struct survive_system *ss = (struct survive_system *)ptr;
 
+	// HMD plus all controllers and trackers.
+	struct survive_pending_pose pending[MAX_TRACKED_DEVICE_COUNT + 1];
+
 	os_thread_helper_lock(&ss->event_thread);
 	while (os_thread_helper_is_running_locked(&ss->event_thread)) {
 		os_thread_helper_unlock(&ss->event_thread);
@@ -1327,9 +1369,51 @@ run_event_thread(void *ptr)
 		struct SurviveSimpleEvent event = {0};
 		survive_simple_wait_for_event(ss->ctx, &event);
 
-		os_mutex_lock(&ss->lock);
-		_process_event(ss, &event);
-		os_mutex_unlock(&ss->lock);
+		/*
+		 * Drain everything libsurvive has queued up. The lock is only
+		 * needed for the inputs and the device list, and devices are
+		 * only added on this thread, so looking them up for the pose
+		 * events is done without it.
+		 */
+		size_t pending_count = 0;
+		bool locked = false;
+		int event_count = 0;
+
+		do {
+			if (event.event_type == SurviveSimpleEventType_PoseUpdateEvent) {
+				const struct SurviveSimplePoseUpdatedEvent *e =
+				    survive_simple_get_pose_updated_event(&event);
+
+				struct survive_device *event_device = get_device_by_object(ss, e->object);
+				if (event_device == NULL) {
+					U_LOG_IFL_E(ss->log_level, "Event for unknown object not handled");
+					continue;
+				}
+
+				_queue_pose_event(pending, &pending_count, event_device, e);
+				continue;
+			}
+
+			if (event.event_type == SurviveSimpleEventType_None) {
+				continue;
+			}
+
+			if (!locked) {
+				os_mutex_lock(&ss->lock);
+				locked = true;
+			}
+			_process_event(ss, &event);
+		} while (++event_count < MAX_EVENTS_PER_TICK &&
+		         survive_simple_next_event(ss->ctx, &event) != SurviveSimpleEventType_None);
+
+		if (locked) {
+			os_mutex_unlock(&ss->lock);
+		}
+
+		// The relation history has its own locking.
+		for (size_t i = 0; i < pending_count; i++) {
+			_process_pose_event(pending[i].survive, &pending[i].event);
+		}
 
 		// Just keep swimming.
 		os_thread_helper_lock(&ss->event_thread);
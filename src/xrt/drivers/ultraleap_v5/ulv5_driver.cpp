@@ -9,6 +9,7 @@
 
 #include "ulv5_interface.h"
 #include "util/u_device.h"
+#include "util/u_misc.h"
 #include "util/u_var.h"
 #include "util/u_debug.h"
 #include "math/m_space.h"
@@ -19,6 +20,8 @@
 
 #include "LeapC.h"
 
+#include <algorithm>
+
 DEBUG_GET_ONCE_LOG_OPTION(ulv5_log, "ULV5_LOG", U_LOGGING_INFO)
 
 #define ULV5_TRACE(ulv5d, ...) U_LOG_XDEV_IFL_T(&ulv5d->base, ulv5d->log_level, __VA_ARGS__)
@@ -62,6 +65,40 @@ static const enum xrt_space_relation_flags valid_flags = (enum xrt_space_relatio
     XRT_SPACE_RELATION_POSITION_VALID_BIT | XRT_SPACE_RELATION_POSITION_TRACKED_BIT);
 
 
+//! Number of tracking events kept per hand, power of two.
+#define ULV5_HISTORY_SIZE 8
+
+//! How far ahead of the newest tracking event hands are predicted.
+#define ULV5_MAX_PREDICTION_NS (50 * U_TIME_1MS_IN_NS)
+
+struct ulv5_hand_sample
+{
+	int64_t timestamp_ns;
+	struct xrt_hand_joint_set joint_set;
+};
+
+/*!
+ * One entry in the hand history, @p seq is odd while the polling thread is
+ * writing it so readers can detect torn copies and retry.
+ */
+struct ulv5_hand_slot
+{
+	xrt_atomic_s32_t seq;
+	struct ulv5_hand_sample sample;
+};
+
+/*!
+ * Lock-free history of the latest tracking events for one hand, written only
+ * by the polling thread.
+ */
+struct ulv5_hand_history
+{
+	struct ulv5_hand_slot slots[ULV5_HISTORY_SIZE];
+
+	//! Number of published samples, the newest is in slot (count - 1).
+	xrt_atomic_s32_t count;
+};
+
 struct ulv5_device
 {
 	struct xrt_device base;
@@ -74,9 +111,7 @@ struct ulv5_device
 
 	struct os_thread_helper oth;
 
-	struct xrt_hand_joint_set joint_set[2];
-
-	bool hand_exists[2];
+	struct ulv5_hand_history history[2];
 
 	// LEAP_CONNECTION *leap_connection;
 };
@@ -87,6 +122,146 @@ ulv5_device(struct xrt_device *xdev)
 	return (struct ulv5_device *)xdev;
 }
 
+
+/*
+ *
+ * Hand history.
+ *
+ */
+
+static inline struct ulv5_hand_slot *
+history_slot(struct ulv5_hand_history *h, uint32_t index)
+{
+	return &h->slots[index % ULV5_HISTORY_SIZE];
+}
+
+static void
+history_publish(struct ulv5_hand_history *h, const struct ulv5_hand_sample *sample)
+{
+	// Only the polling thread writes, so no need to load this atomically.
+	uint32_t count = (uint32_t)h->count;
+	struct ulv5_hand_slot *slot = history_slot(h, count);
+
+	xrt_atomic_s32_inc_return(&slot->seq);
+	xrt_atomic_thread_fence();
+
+	slot->sample = *sample;
+
+	xrt_atomic_thread_fence();
+	xrt_atomic_s32_inc_return(&slot->seq);
+
+	xrt_atomic_s32_store_release(&h->count, (int32_t)(count + 1));
+}
+
+static bool
+history_read(struct ulv5_hand_history *h, uint32_t index, struct ulv5_hand_sample *out_sample)
+{
+	struct ulv5_hand_slot *slot = history_slot(h, index);
+
+	// The writer only holds a slot for the duration of a copy, a few retries are plenty.
+	for (int i = 0; i < 4; i++) {
+		int32_t before = xrt_atomic_s32_load_acquire(&slot->seq);
+		if ((before & 1) != 0) {
+			continue;
+		}
+
+		*out_sample = slot->sample;
+
+		xrt_atomic_thread_fence();
+		if (xrt_atomic_s32_load_acquire(&slot->seq) == before) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*!
+ * Interpolates, or extrapolates for @p t larger than one, every joint from
+ * @p a to @p b.
+ */
+static void
+interpolate_joint_sets(struct xrt_hand_joint_set *a,
+                       struct xrt_hand_joint_set *b,
+                       float t,
+                       struct xrt_hand_joint_set *out_set)
+{
+	*out_set = *b;
+
+	for (int i = 0; i < XRT_HAND_JOINT_COUNT; i++) {
+		struct xrt_hand_joint_value *ja = &a->values.hand_joint_set_default[i];
+		struct xrt_hand_joint_value *jb = &b->values.hand_joint_set_default[i];
+		struct xrt_hand_joint_value *jo = &out_set->values.hand_joint_set_default[i];
+
+		m_space_relation_interpolate(&ja->relation, &jb->relation, t, jb->relation.relation_flags,
+		                             &jo->relation);
+		jo->radius = ja->radius + (jb->radius - ja->radius) * t;
+	}
+}
+
+/*!
+ * Gets the hand at @p at_timestamp_ns, interpolating between the two events
+ * around it or predicting from the newest two, up to @ref ULV5_MAX_PREDICTION_NS.
+ */
+static bool
+history_get(struct ulv5_hand_history *h,
+            int64_t at_timestamp_ns,
+            struct xrt_hand_joint_set *out_set,
+            int64_t *out_timestamp_ns)
+{
+	uint32_t count = (uint32_t)xrt_atomic_s32_load_acquire(&h->count);
+	if (count == 0) {
+		return false;
+	}
+
+	// The oldest slot might be the one being written next.
+	uint32_t available = std::min<uint32_t>(count, ULV5_HISTORY_SIZE - 1);
+
+	struct ulv5_hand_sample newer;
+	struct ulv5_hand_sample older;
+	if (!history_read(h, count - 1, &newer)) {
+		return false;
+	}
+
+	bool have_older = false;
+	for (uint32_t i = 2; i <= available; i++) {
+		if (!history_read(h, count - i, &older)) {
+			break;
+		}
+
+		// Predicting, or found the events around the requested time.
+		if (at_timestamp_ns >= newer.timestamp_ns || older.timestamp_ns <= at_timestamp_ns) {
+			have_older = true;
+			break;
+		}
+
+		newer = older;
+	}
+
+	int64_t span_ns = have_older ? newer.timestamp_ns - older.timestamp_ns : 0;
+	if (span_ns <= 0 || !newer.joint_set.is_active || !older.joint_set.is_active) {
+		*out_set = newer.joint_set;
+		*out_timestamp_ns = newer.timestamp_ns;
+		return true;
+	}
+
+	int64_t target_ns = std::min<int64_t>(at_timestamp_ns, newer.timestamp_ns + ULV5_MAX_PREDICTION_NS);
+	target_ns = std::max(target_ns, older.timestamp_ns);
+
+	float t = (float)(target_ns - older.timestamp_ns) / (float)span_ns;
+	interpolate_joint_sets(&older.joint_set, &newer.joint_set, t, out_set);
+	*out_timestamp_ns = target_ns;
+
+	return true;
+}
+
+
+/*
+ *
+ * Device functions.
+ *
+ */
+
 static xrt_result_t
 ulv5_device_get_hand_tracking(struct xrt_device *xdev,
                               enum xrt_input_name name,
@@ -103,22 +278,15 @@ ulv5_device_get_hand_tracking(struct xrt_device *xdev,
 
 	bool hand_index = (name == XRT_INPUT_HT_UNOBSTRUCTED_RIGHT); // 0 if left, 1 if right.
 
-	bool hand_valid = ulv5d->hand_exists[hand_index];
+	if (!history_get(&ulv5d->history[hand_index], at_timestamp_ns, out_value, out_timestamp_ns)) {
+		U_ZERO(out_value);
+		*out_timestamp_ns = at_timestamp_ns;
+	}
 
-	os_thread_helper_lock(&ulv5d->oth);
-	memcpy(out_value, &ulv5d->joint_set[hand_index], sizeof(struct xrt_hand_joint_set));
-	hand_valid = ulv5d->hand_exists[hand_index];
-	os_thread_helper_unlock(&ulv5d->oth);
 	m_space_relation_ident(&out_value->hand_pose);
-
-	if (hand_valid) {
-		out_value->is_active = true;
+	if (out_value->is_active) {
 		out_value->hand_pose.relation_flags = valid_flags;
-	} else {
-		out_value->is_active = false;
 	}
-	// still a lie...
-	*out_timestamp_ns = at_timestamp_ns;
 
 	return XRT_SUCCESS;
 }
@@ -162,11 +330,10 @@ ulv5_process_joint(LEAP_VECTOR joint_pos,
 }
 
 static void
-ulv5_process_hand(LEAP_HAND hand, struct ulv5_device *ulv5d, int handedness)
+ulv5_process_hand(LEAP_HAND hand, struct xrt_hand_joint_set *out_joint_set)
 {
-	struct xrt_hand_joint_set joint_set;
 // gives access to individual joints of the joint_set
-#define joint_set(y) &joint_set.values.hand_joint_set_default[XRT_HAND_JOINT_##y]
+#define joint_set(y) &out_joint_set->values.hand_joint_set_default[XRT_HAND_JOINT_##y]
 
 	ulv5_process_joint(hand.palm.position, hand.palm.orientation, hand.palm.width, joint_set(PALM));
 	// wrist is the next_joint of the arm
@@ -224,11 +391,9 @@ ulv5_process_hand(LEAP_HAND hand, struct ulv5_device *ulv5d, int handedness)
 	                   joint_set(LITTLE_DISTAL));
 	ulv5_process_joint(hand.pinky.distal.next_joint, hand.pinky.distal.rotation, hand.pinky.distal.width,
 	                   joint_set(LITTLE_TIP));
+#undef joint_set
 
-	// copy over to ulv5d joint set
-	os_thread_helper_lock(&ulv5d->oth);
-	memcpy(&ulv5d->joint_set[handedness], &joint_set, sizeof(struct xrt_hand_joint_set));
-	os_thread_helper_unlock(&ulv5d->oth);
+	out_joint_set->is_active = true;
 }
 
 static void *
@@ -283,11 +448,20 @@ leap_input_loop(void *ptr_to_xdev)
 			uint32_t num_hands = tracking_event->nHands;
 			LEAP_HAND *hands = tracking_event->pHands;
 
+			// Leap timestamps are in microseconds of the LeapGetNow clock.
+			int64_t age_ns = (LeapGetNow() - tracking_event->info.timestamp) * 1000;
+
+			// Both hands are published for every event, hands not in it are inactive.
+			struct ulv5_hand_sample samples[2] = {};
+			samples[0].timestamp_ns = samples[1].timestamp_ns = (int64_t)os_monotonic_get_ns() - age_ns;
+
 			for (uint32_t i = 0; i < num_hands; i++) {
 				int handedness = hands[i].type;
-				ulv5_process_hand(hands[i], ulv5d, handedness);
-				ulv5d->hand_exists[handedness] = true;
+				ulv5_process_hand(hands[i], &samples[handedness].joint_set);
 			}
+
+			history_publish(&ulv5d->history[0], &samples[0]);
+			history_publish(&ulv5d->history[1], &samples[1]);
 		}
 	}
 
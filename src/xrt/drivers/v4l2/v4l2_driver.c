@@ -17,6 +17,7 @@
 #include "util/u_format.h"
 #include "util/u_logging.h"
 #include "util/u_trace_marker.h"
+#include "util/u_thread_policy.h"
 
 #include "v4l2_interface.h"
 #include "v4l2_driver.h"
@@ -58,6 +59,7 @@
 
 DEBUG_GET_ONCE_LOG_OPTION(v4l2_log, "V4L2_LOG", U_LOGGING_WARN)
 DEBUG_GET_ONCE_NUM_OPTION(v4l2_exposure_absolute, "V4L2_EXPOSURE_ABSOLUTE", 10)
+DEBUG_GET_ONCE_BOOL_OPTION(v4l2_export_dmabuf, "V4L2_EXPORT_DMABUF", false)
 
 /*!
  * Streaming thread entrypoint
@@ -300,6 +302,42 @@ v4l2_setup_mmap_buffer(struct v4l2_fs *vid, struct v4l2_frame *vf, struct v4l2_b
 	return 0;
 }
 
+/*!
+ * Export a mmap buffer as a DMABUF so it can be imported by GPU consumers,
+ * see @ref xrt_frame::graphics_buffer. Failure is not fatal, the frame is
+ * still available through the mmap.
+ */
+static void
+v4l2_export_dmabuf(struct v4l2_fs *vid, struct v4l2_frame *vf, struct v4l2_buffer *v_buf)
+{
+	struct v4l2_exportbuffer v_expbuf = {
+	    .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+	    .index = v_buf->index,
+	    .flags = O_RDONLY | O_CLOEXEC,
+	};
+
+	if (ioctl(vid->fd, VIDIOC_EXPBUF, &v_expbuf) < 0) {
+		V4L2_DEBUG(vid, "info: Driver can not export buffer %u as DMABUF.", v_buf->index);
+		return;
+	}
+
+	vf->base.graphics_buffer.valid = true;
+	vf->base.graphics_buffer.handle = v_expbuf.fd;
+	vf->base.graphics_buffer.size = v_buf->length;
+}
+
+static void
+v4l2_close_dmabuf(struct v4l2_frame *vf)
+{
+	if (!vf->base.graphics_buffer.valid) {
+		return;
+	}
+
+	close(vf->base.graphics_buffer.handle);
+	vf->base.graphics_buffer.valid = false;
+	vf->base.graphics_buffer.handle = XRT_GRAPHICS_BUFFER_HANDLE_INVALID;
+}
+
 static int
 v4l2_setup_userptr_buffer(struct v4l2_fs *vid, struct v4l2_frame *vf, struct v4l2_buffer *v_buf)
 {
@@ -636,6 +674,10 @@ v4l2_fs_destroy(struct v4l2_fs *vid)
 		vid->num_descriptors = 0;
 	}
 
+	for (uint32_t i = 0; i < NUM_V4L2_BUFFERS; i++) {
+		v4l2_close_dmabuf(&vid->frames[i]);
+	}
+
 	vid->capture.mmap = false;
 	if (vid->capture.userptr) {
 		vid->capture.userptr = false;
@@ -731,6 +773,8 @@ v4l2_fs_mainloop(void *ptr)
 	struct xrt_fs *xfs = (struct xrt_fs *)ptr;
 	struct v4l2_fs *vid = v4l2_fs(xfs);
 
+	u_thread_policy_apply(vid->log_level, OS_THREAD_ROLE_CAMERA, "V4L2");
+
 	V4L2_DEBUG(vid, "info: Thread enter!");
 
 	if (vid->fd == -1) {
@@ -748,7 +792,11 @@ v4l2_fs_mainloop(void *ptr)
 	v_bufrequest.count = NUM_V4L2_BUFFERS;
 	v_bufrequest.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 
-	if (v4l2_try_userptr(vid, &v_bufrequest) != 0 && v4l2_try_mmap(vid, &v_bufrequest) != 0) {
+	// Only kernel allocated buffers can be exported as DMABUF, so try mmap first then.
+	bool export_dmabuf = debug_get_bool_option_v4l2_export_dmabuf();
+	if (export_dmabuf && v4l2_try_mmap(vid, &v_bufrequest) == 0) {
+		V4L2_DEBUG(vid, "info: Using mmap buffers to export DMABUFs.");
+	} else if (v4l2_try_userptr(vid, &v_bufrequest) != 0 && v4l2_try_mmap(vid, &v_bufrequest) != 0) {
 		V4L2_ERROR(vid, "error: Driver does not support mmap or userptr.");
 		return NULL;
 	}
@@ -777,6 +825,13 @@ v4l2_fs_mainloop(void *ptr)
 			return NULL;
 		}
 
+		// From a previous stream start.
+		v4l2_close_dmabuf(vf);
+
+		if (vid->capture.mmap && export_dmabuf) {
+			v4l2_export_dmabuf(vid, vf, v_buf);
+		}
+
 		// Silence valgrind.
 		memset(vf->mem, 0, v_buf->length);
 
@@ -837,6 +892,7 @@ v4l2_fs_mainloop(void *ptr)
 		xf->size = v_buf.bytesused - desc->offset;
 		xf->source_id = vid->base.source_id;
 		xf->source_sequence = v_buf.sequence;
+		xf->graphics_buffer.offset = desc->offset;
 
 		if ((v_buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) != 0) {
 			xf->timestamp = os_timeval_to_ns(&v_buf.timestamp);
@@ -1,5 +1,5 @@
 // Copyright 2016 Philipp Zabel
-// Copyright 2020-2023, Collabora, Ltd.
+// Copyright 2020-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -172,6 +172,7 @@ vive_controller_device_destroy(struct xrt_device *xdev)
 
 	// Now that the thread is not running we can destroy the lock.
 	os_mutex_destroy(&d->lock);
+	u_hand_sim_cache_fini(&d->hand_sim);
 
 	os_mutex_destroy(&d->fusion.mutex);
 	m_relation_history_destroy(&d->fusion.relation_hist);
@@ -402,7 +403,7 @@ vive_controller_get_hand_tracking(struct xrt_device *xdev,
 	struct xrt_space_relation hand_relation;
 	get_pose(d, name, requested_timestamp_ns, &hand_relation);
 
-	u_hand_sim_simulate_for_valve_index_knuckles(&values, hand, &hand_relation, out_value);
+	u_hand_sim_simulate_for_valve_index_knuckles_cached(&d->hand_sim, &values, hand, &hand_relation, out_value);
 
 	// This is the truth - we pose-predicted or interpolated all the way up to `at_timestamp_ns`.
 	*out_timestamp_ns = requested_timestamp_ns;
@@ -500,8 +501,10 @@ vive_controller_device_set_output(struct xrt_device *xdev,
 	}
 
 	if (value->vibration.amplitude > 0.01) {
+		// Coalesced, only the latest pulse is sent by the controller thread.
 		os_mutex_lock(&d->lock);
-		vive_controller_haptic_pulse(d, value);
+		d->haptic.value = *value;
+		d->haptic.pending = true;
 		os_mutex_unlock(&d->lock);
 	}
 
@@ -968,6 +971,20 @@ vive_controller_device_update(struct vive_controller_device *d)
 	return true;
 }
 
+static void
+vive_controller_flush_haptic(struct vive_controller_device *d)
+{
+	os_mutex_lock(&d->lock);
+	bool pending = d->haptic.pending;
+	struct xrt_output_value value = d->haptic.value;
+	d->haptic.pending = false;
+	os_mutex_unlock(&d->lock);
+
+	if (pending) {
+		vive_controller_haptic_pulse(d, &value);
+	}
+}
+
 static void *
 vive_controller_run_thread(void *ptr)
 {
@@ -982,6 +999,8 @@ vive_controller_run_thread(void *ptr)
 	while (os_thread_helper_is_running_locked(&d->controller_thread)) {
 		os_thread_helper_unlock(&d->controller_thread);
 
+		vive_controller_flush_haptic(d);
+
 		if (!vive_controller_device_update(d)) {
 			return NULL;
 		}
@@ -1063,7 +1082,9 @@ vive_controller_create(struct os_hid_device *controller_hid, enum watchman_gen w
 	d->watchman_gen = watchman_gen;
 
 	m_imu_3dof_init(&d->fusion.i3dof, M_IMU_3DOF_USE_GRAVITY_DUR_20MS);
-	m_relation_history_create(&d->fusion.relation_hist);
+	// 3DoF, only ever has orientation.
+	m_relation_history_create_with_layout(&d->fusion.relation_hist, M_RELATION_HISTORY_MODE_MUTEX,
+	                                      M_RELATION_HISTORY_LAYOUT_ORIENTATION);
 	int ret = os_mutex_init(&d->fusion.mutex);
 	if (ret != 0) {
 		VIVE_ERROR(d, "Failed to init 3dof mutex");
@@ -1096,6 +1117,7 @@ vive_controller_create(struct os_hid_device *controller_hid, enum watchman_gen w
 
 	// Have to init before destroy is called.
 	os_mutex_init(&d->lock);
+	u_hand_sim_cache_init(&d->hand_sim);
 	os_thread_helper_init(&d->controller_thread);
 
 	if (vive_get_imu_range_report(d->controller_hid, &d->config.imu.gyro_range, &d->config.imu.acc_range) != 0) {
@@ -1,4 +1,4 @@
-// Copyright 2020, Collabora, Ltd.
+// Copyright 2020-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -18,6 +18,7 @@
 #include "math/m_imu_3dof.h"
 #include "util/u_logging.h"
 #include "util/u_hand_tracking.h"
+#include "util/u_hand_simulation.h"
 #include "vive/vive_config.h"
 
 
@@ -51,6 +52,16 @@ struct vive_controller_device
 	struct os_thread_helper controller_thread;
 	struct os_mutex lock;
 
+	/*!
+	 * Latest haptic pulse set by the app, protected by @ref lock and sent
+	 * from @ref controller_thread so set_output never blocks on the device.
+	 */
+	struct
+	{
+		bool pending;
+		struct xrt_output_value value;
+	} haptic;
+
 	struct
 	{
 		timepoint_ns last_sample_ts_ns;
@@ -75,6 +86,9 @@ struct vive_controller_device
 		struct m_relation_history *relation_hist;
 	} fusion;
 
+	//! Index controller finger tracking, reuses the joints between calls with the same curls.
+	struct u_hand_sim_cache hand_sim;
+
 	struct
 	{
 		struct xrt_vec3 acc;
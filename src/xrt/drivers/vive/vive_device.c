@@ -19,9 +19,7 @@
 #include "util/u_time.h"
 #include "util/u_trace_marker.h"
 
-#ifdef XRT_OS_LINUX
-#include "util/u_linux.h"
-#endif
+#include "util/u_thread_policy.h"
 
 #include "math/m_api.h"
 #include "math/m_predict.h"
@@ -408,6 +406,8 @@ update_imu(struct vive_device *d, const void *buffer)
 	const struct vive_imu_report *report = buffer;
 	const struct vive_imu_sample *sample = report->sample;
 	uint8_t last_seq = d->imu.sequence;
+	struct vive_source_imu_packet packets[3];
+	uint32_t packet_count = 0;
 	int i;
 	int j;
 
@@ -528,7 +528,16 @@ update_imu(struct vive_device *d, const void *buffer)
 		assert(j > 0);
 		uint32_t age = j <= 0 ? 0 : (uint32_t)(j - 1);
 
-		vive_source_push_imu_packet(d->source, age, d->imu.last_sample_ts_ns, raw_accel, raw_gyro);
+		packets[packet_count++] = (struct vive_source_imu_packet){
+		    .age = age,
+		    .t = d->imu.last_sample_ts_ns,
+		    .accel = raw_accel,
+		    .gyro = raw_gyro,
+		};
+	}
+
+	if (packet_count > 0) {
+		vive_source_push_imu_packets(d->source, packets, packet_count);
 	}
 }
 
@@ -887,10 +896,8 @@ vive_sensors_run_thread(void *ptr)
 	U_TRACE_SET_THREAD_NAME("Vive: Sensors");
 	os_thread_helper_name(&d->sensors_thread, "Vive: Sensors");
 
-#ifdef XRT_OS_LINUX
 	// Try to raise priority of this thread.
-	u_linux_try_to_set_realtime_priority_on_thread(d->log_level, "Vive: Sensors");
-#endif
+	u_thread_policy_apply(d->log_level, OS_THREAD_ROLE_IMU, "Vive: Sensors");
 
 	/*
 	 * We want to drain all old packets to avoid old ones,
@@ -1,4 +1,4 @@
-// Copyright 2022-2023, Collabora, Ltd.
+// Copyright 2022-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -15,11 +15,12 @@
 
 #include "math/m_clock_tracking.h"
 
-#include "util/u_deque.h"
 #include "util/u_logging.h"
+#include "util/u_timestamp_ring.h"
 #include "util/u_trace_marker.h"
 
 #include "vive.h"
+#include "vive_source.h"
 
 
 /*!
@@ -43,10 +44,9 @@ struct vive_source
 	bool waiting_for_first_nonempty_frame;    //!< Whether the first good frame has been received
 
 	// Frame timestamps
-	struct u_deque_timepoint_ns frame_timestamps; //! Queue of yet unused frame hw timestamps
-	struct os_mutex frame_timestamps_lock;        //! Lock for accessing frame_timestamps
-	uint32_t last_frame_ticks;                    //! Last frame timestamp in device ticks
-	timepoint_ns last_frame_ts_ns;                //! Last frame timestamp in device nanoseconds
+	struct u_timestamp_ring frame_timestamps; //! Yet unused frame hw timestamps, lock-free
+	uint32_t last_frame_ticks;                //! Last frame timestamp in device ticks
+	timepoint_ns last_frame_ts_ns;            //! Last frame timestamp in device nanoseconds
 
 	// Clock offsets
 	time_duration_ns hw2mono; //!< Estimated offset from IMU to monotonic clock
@@ -70,48 +70,24 @@ vive_source_try_convert_v4l2_timestamp(struct vive_source *vs, struct xrt_frame
 	}
 	vs->timestamps_have_been_zero_until_now = false;
 
-	struct u_deque_timepoint_ns vive_timestamps = vs->frame_timestamps;
-	struct os_mutex *vive_timestamps_lock = &vs->frame_timestamps_lock;
-
 	timepoint_ns v4l2_ts = xf->timestamp;
 
-	size_t vive_ts_count = u_deque_timepoint_ns_size(vive_timestamps);
-	if (vive_ts_count == 0) { // This seems to happen in some runs
-		// This code assumes vive_timestamps will always be populated before v4l2
+	// Find the vive timestamp that would be closer to xf->timestamp in v4l2 clock, discards missed frames
+	timepoint_ns vive_timestamp = 0;
+	time_duration_ns period = U_TIME_1S_IN_NS / CAMERA_FREQUENCY;
+	timepoint_ns hw_ts_est = v4l2_ts - vs->hw2v4l2;
+	bool found = u_timestamp_ring_take_closest(&vs->frame_timestamps, hw_ts_est, period, &vive_timestamp, NULL);
+	if (!found) { // This seems to happen in some runs
+		// This code assumes frame_timestamps will always be populated before v4l2
 		// receives a frame, thus if we reach this, this assumption has failed.
 		// As a fallback we'll use the v4l2 timestamp corrected to monotonic clock.
 		VIVE_TRACE(vs, "No vive timestamps available for this v4l2 frame, will use v4l2 timestamp");
-		timepoint_ns hw_ts = v4l2_ts - vs->hw2v4l2;
-		xf->timestamp = hw_ts + vs->hw2mono;
+		xf->timestamp = hw_ts_est + vs->hw2mono;
 		return true;
 	}
 
-	os_mutex_lock(vive_timestamps_lock);
-
-	// Find i in vive_timestamps that would be closer to xf->timestamp in v4l2 clock
-	int closer_i = -1;
-	timepoint_ns vive_ts = -1;
-	time_duration_ns min_distance = INT64_MAX;
-	for (size_t i = 0; i < vive_ts_count; i++) {
-		vive_ts = u_deque_timepoint_ns_at(vive_timestamps, i);
-		timepoint_ns v4l2_ts_est = vive_ts + vs->hw2v4l2;
-		time_duration_ns distance = llabs(v4l2_ts_est - v4l2_ts);
-		if (distance < min_distance) {
-			closer_i = i;
-			min_distance = distance;
-		}
-	}
-
-	// Discard missed frames and set vive_timestamp to use in this frame
-	timepoint_ns vive_timestamp = 0;
-	for (; closer_i >= 0; closer_i--) {
-		u_deque_timepoint_ns_pop_front(vive_timestamps, &vive_timestamp);
-	}
-
-	os_mutex_unlock(vive_timestamps_lock);
-
 	// Our estimate is within a reasonable time distance
-	assert(min_distance < U_TIME_1S_IN_NS / CAMERA_FREQUENCY || vs->waiting_for_first_nonempty_frame);
+	assert(llabs(vive_timestamp - hw_ts_est) < period || vs->waiting_for_first_nonempty_frame);
 	vs->waiting_for_first_nonempty_frame = false;
 
 	// Update estimate of hw2v4l2 clock offset, only used for matching timestamps
@@ -156,6 +132,23 @@ vive_source_receive_imu_sample(struct xrt_imu_sink *sink, struct xrt_imu_sample
 	}
 }
 
+static void
+vive_source_receive_imu_samples(struct xrt_imu_sink *sink, struct xrt_imu_sample *samples, uint32_t count)
+{
+	struct vive_source *vs = container_of(sink, struct vive_source, imu_sink);
+
+	for (uint32_t i = 0; i < count; i++) {
+		timepoint_ns ts = samples[i].timestamp_ns;
+		struct xrt_vec3_f64 a = samples[i].accel_m_s2;
+		struct xrt_vec3_f64 w = samples[i].gyro_rad_secs;
+		VIVE_TRACE(vs, "imu t=%" PRId64 " a=(%f %f %f) w=(%f %f %f)", ts, a.x, a.y, a.z, w.x, w.y, w.z);
+	}
+
+	if (vs->out_sinks.imu) {
+		xrt_sink_push_imu_batch(vs->out_sinks.imu, samples, count);
+	}
+}
+
 static void
 vive_source_node_break_apart(struct xrt_frame_node *node)
 {}
@@ -164,9 +157,6 @@ static void
 vive_source_node_destroy(struct xrt_frame_node *node)
 {
 	struct vive_source *vs = container_of(node, struct vive_source, node);
-	os_mutex_destroy(&vs->frame_timestamps_lock);
-	u_deque_timepoint_ns_destroy(&vs->frame_timestamps);
-
 	free(vs);
 }
 
@@ -186,6 +176,7 @@ vive_source_create(struct xrt_frame_context *xfctx)
 	// Setup sinks
 	vs->sbs_sink.push_frame = vive_source_receive_sbs_frame;
 	vs->imu_sink.push_imu = vive_source_receive_imu_sample;
+	vs->imu_sink.push_imu_batch = vive_source_receive_imu_samples;
 	vs->in_sinks.cam_count = 1;
 	vs->in_sinks.cams[0] = &vs->sbs_sink;
 	vs->in_sinks.imu = &vs->imu_sink;
@@ -193,9 +184,6 @@ vive_source_create(struct xrt_frame_context *xfctx)
 	vs->timestamps_have_been_zero_until_now = true;
 	vs->waiting_for_first_nonempty_frame = true;
 
-	vs->frame_timestamps = u_deque_timepoint_ns_create();
-	os_mutex_init(&vs->frame_timestamps_lock);
-
 	// Setup node
 	struct xrt_frame_node *xfn = &vs->node;
 	xfn->break_apart = vive_source_node_break_apart;
@@ -207,8 +195,13 @@ vive_source_create(struct xrt_frame_context *xfctx)
 	return vs;
 }
 
-void
-vive_source_push_imu_packet(struct vive_source *vs, uint32_t age, timepoint_ns t, struct xrt_vec3 a, struct xrt_vec3 g)
+static void
+make_imu_sample(struct vive_source *vs,
+                uint32_t age,
+                timepoint_ns t,
+                struct xrt_vec3 a,
+                struct xrt_vec3 g,
+                struct xrt_imu_sample *out_sample)
 {
 	/*
 	 * We want the samples to be on sometime in the past, not future. This
@@ -242,15 +235,12 @@ vive_source_push_imu_packet(struct vive_source *vs, uint32_t age, timepoint_ns t
 	t = m_clock_offset_a2b(IMU_FREQUENCY, t, sample_point, &vs->hw2mono);
 
 	// Finished sample.
-	struct xrt_imu_sample sample = {
+	*out_sample = (struct xrt_imu_sample){
 	    .timestamp_ns = t,
 	    .accel_m_s2 = (struct xrt_vec3_f64){a.x, a.y, a.z},
 	    .gyro_rad_secs = (struct xrt_vec3_f64){g.x, g.y, g.z},
 	};
 
-	// Push it out!
-	xrt_sink_push_imu(&vs->imu_sink, &sample);
-
 	// Only do this if we are really debugging stuff.
 #ifdef XRT_FEATURE_TRACING
 	timepoint_ns diff_ns = t - (now_ns - age_diff_ns);
@@ -273,11 +263,44 @@ vive_source_push_imu_packet(struct vive_source *vs, uint32_t age, timepoint_ns t
 #endif
 }
 
+void
+vive_source_push_imu_packet(struct vive_source *vs, uint32_t age, timepoint_ns t, struct xrt_vec3 a, struct xrt_vec3 g)
+{
+	struct xrt_imu_sample sample;
+	make_imu_sample(vs, age, t, a, g, &sample);
+
+	// Push it out!
+	xrt_sink_push_imu(&vs->imu_sink, &sample);
+}
+
+void
+vive_source_push_imu_packets(struct vive_source *vs, const struct vive_source_imu_packet *packets, uint32_t count)
+{
+	// A report has at most three samples, this covers it in one go.
+	struct xrt_imu_sample samples[8];
+
+	while (count > 0) {
+		uint32_t n = count < ARRAY_SIZE(samples) ? count : ARRAY_SIZE(samples);
+
+		for (uint32_t i = 0; i < n; i++) {
+			const struct vive_source_imu_packet *p = &packets[i];
+			make_imu_sample(vs, p->age, p->t, p->accel, p->gyro, &samples[i]);
+		}
+
+		xrt_sink_push_imu_batch(&vs->imu_sink, samples, n);
+
+		packets += n;
+		count -= n;
+	}
+}
+
 void
 vive_source_push_frame_ticks(struct vive_source *vs, timepoint_ns ticks)
 {
 	ticks_to_ns(ticks, &vs->last_frame_ticks, &vs->last_frame_ts_ns);
-	u_deque_timepoint_ns_push_back(vs->frame_timestamps, vs->last_frame_ts_ns);
+	if (!u_timestamp_ring_push(&vs->frame_timestamps, vs->last_frame_ts_ns)) {
+		VIVE_TRACE(vs, "Frame timestamp dropped, no v4l2 frames are being received");
+	}
 }
 
 void
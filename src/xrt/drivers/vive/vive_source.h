@@ -27,9 +27,25 @@ extern "C" {
 struct vive_source *
 vive_source_create(struct xrt_frame_context *xfctx);
 
+//! A raw IMU sample as read from the device, see @ref vive_source_push_imu_packets.
+struct vive_source_imu_packet
+{
+	uint32_t age;
+	timepoint_ns t;
+	struct xrt_vec3 accel;
+	struct xrt_vec3 gyro;
+};
+
 void
 vive_source_push_imu_packet(struct vive_source *vs, uint32_t age, timepoint_ns t, struct xrt_vec3 a, struct xrt_vec3 g);
 
+/*!
+ * Push all the new samples from one report, oldest first, they are sent
+ * downstream as a single batch.
+ */
+void
+vive_source_push_imu_packets(struct vive_source *vs, const struct vive_source_imu_packet *packets, uint32_t count);
+
 void
 vive_source_push_frame_ticks(struct vive_source *vs, timepoint_ns ticks);
 
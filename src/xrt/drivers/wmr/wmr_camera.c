@@ -21,6 +21,7 @@
 #include "util/u_var.h"
 #include "util/u_sink.h"
 #include "util/u_frame.h"
+#include "util/u_frame_pool.h"
 #include "util/u_trace_marker.h"
 
 #include "wmr_config.h"
@@ -112,6 +113,13 @@ struct wmr_camera
 
 	struct libusb_transfer *xfers[NUM_XFERS];
 
+	/*!
+	 * Pooled frames that the transfers receive directly into, the pixel
+	 * data is compacted in place and handed downstream as a ROI of it.
+	 */
+	struct xrt_frame *xfer_frames[NUM_XFERS];
+	struct u_frame_pool *frame_pool;
+
 	struct wmr_camera_expgain
 	{
 		bool manual_control; //!< Whether to control exp/gain manually or with aeg
@@ -293,6 +301,31 @@ set_active(struct wmr_camera *cam, bool active)
 	return send_buffer_to_device(cam, (uint8_t *)&cmd, sizeof(cmd));
 }
 
+/*!
+ * Get a pooled frame big enough to receive a whole transfer into, this is
+ * taller than the actual image to also fit the slice headers and the footer.
+ */
+static void
+create_xfer_frame(struct wmr_camera *cam, struct xrt_frame **out_frame)
+{
+	uint32_t rows = (uint32_t)((cam->xfer_size + cam->frame_width - 1) / cam->frame_width);
+
+	u_frame_pool_create_frame(cam->frame_pool, XRT_FORMAT_L8, cam->frame_width, rows, out_frame);
+}
+
+static struct xrt_frame **
+get_xfer_frame(struct wmr_camera *cam, struct libusb_transfer *xfer)
+{
+	for (int i = 0; i < NUM_XFERS; i++) {
+		if (cam->xfers[i] == xfer) {
+			return &cam->xfer_frames[i];
+		}
+	}
+
+	assert(false);
+	return NULL;
+}
+
 static void LIBUSB_CALL
 img_xfer_cb(struct libusb_transfer *xfer)
 {
@@ -314,19 +347,25 @@ img_xfer_cb(struct libusb_transfer *xfer)
 
 	WMR_CAM_TRACE(cam, "Camera transfer complete - %d bytes of %d", xfer->actual_length, xfer->length);
 
-	/* Convert the output into frames and send them off to debug / tracking */
+	/*
+	 * The transfer landed directly in a pooled frame, strip the slice
+	 * headers by compacting the pixel data in place towards the start of
+	 * the buffer, the frame pushed downstream is a ROI of that.
+	 */
+	struct xrt_frame **full_ptr = get_xfer_frame(cam, xfer);
 	struct xrt_frame *xf = NULL;
 
 	/* There's always one extra line of pixels with exposure info */
-	u_frame_create_one_off(XRT_FORMAT_L8, cam->frame_width, cam->frame_height + 1, &xf);
+	struct xrt_rect image_roi = {.extent = {.w = cam->frame_width, .h = cam->frame_height + 1}};
+	u_frame_create_roi(*full_ptr, image_roi, &xf);
 
 	const uint8_t *src = xfer->buffer;
 
-	uint8_t *dst = xf->data;
+	uint8_t *dst = xfer->buffer;
 	size_t dst_remain = xf->size;
 	const size_t chunk_size = 0x6000 - 32;
 
-	DRV_TRACE_BEGIN(copy_to_frame);
+	DRV_TRACE_BEGIN(compact_in_place);
 	while (dst_remain >= 0x20) {
 		const size_t to_copy = dst_remain > chunk_size ? chunk_size : dst_remain;
 
@@ -345,12 +384,13 @@ img_xfer_cb(struct libusb_transfer *xfer)
 		}
 		src += 0x20;
 
-		memcpy(dst, src, to_copy);
+		// Regions overlap, destination is always behind the source.
+		memmove(dst, src, to_copy);
 		src += to_copy;
 		dst += to_copy;
 		dst_remain -= to_copy;
 	}
-	DRV_TRACE_END(copy_to_frame);
+	DRV_TRACE_END(compact_in_place);
 
 	/* There should be exactly a 26 byte footer left over if we completely consumed the right amount of data */
 	if (xfer->buffer + cam->frame_xfer_size - src != 26) {
@@ -358,7 +398,7 @@ img_xfer_cb(struct libusb_transfer *xfer)
 		goto drop_frame;
 	}
 
-	/* Footer contains:
+	/* Footer contains, it is past the compacted data so hasn't been overwritten:
 	 * __le64 start_ts; - 100ns unit timestamp, from same clock as video_timestamps on the IMU feed
 	 * __le64 end_ts;   - 100ns unit timestamp, always about 111000 * 100ns later than start_ts ~= 90Hz
 	 * __le16 ctr1;     - Counter that increments by 88, but sometimes by 96, and wraps at 16384
@@ -428,7 +468,19 @@ img_xfer_cb(struct libusb_transfer *xfer)
 		}
 	}
 
+	/*
+	 * Downstream might still be holding on to the frame, receive the next
+	 * one into a fresh frame from the pool. When the old one is released
+	 * it goes back to the pool, so this doesn't allocate in steady state.
+	 */
+	xrt_frame_reference(&xf, NULL);
+	xrt_frame_reference(full_ptr, NULL);
+	create_xfer_frame(cam, full_ptr);
+	xfer->buffer = (*full_ptr)->data;
+	goto out;
+
 drop_frame:
+	// Nobody else got to see this frame, keep receiving into it.
 	xrt_frame_reference(&xf, NULL);
 
 out:
@@ -515,6 +567,9 @@ wmr_camera_open(struct wmr_camera_open_config *config)
 		ceg->aeg = u_autoexpgain_create(U_AEG_STRATEGY_TRACKING, enable_aeg, frame_delay);
 	}
 
+	// The transfers hold one frame each, keep some spare for those held downstream.
+	u_frame_pool_create("Frame pool: WMR camera", NUM_XFERS, &cam->frame_pool);
+
 	u_sink_debug_init(&cam->debug_sinks[WMR_DEBUG_SINK_SLAM]);
 	u_sink_debug_init(&cam->debug_sinks[WMR_DEBUG_SINK_CONTROLLER]);
 	u_var_add_root(cam, "WMR Camera", true);
@@ -590,6 +645,10 @@ wmr_camera_free(struct wmr_camera *cam)
 			cam->xfers[i] = NULL;
 		}
 
+		for (i = 0; i < NUM_XFERS; i++) {
+			xrt_frame_reference(&cam->xfer_frames[i], NULL);
+		}
+
 		libusb_exit(cam->ctx);
 		cam->ctx = NULL;
 	}
@@ -598,6 +657,7 @@ wmr_camera_free(struct wmr_camera *cam)
 	u_var_remove_root(cam);
 	u_sink_debug_destroy(&cam->debug_sinks[WMR_DEBUG_SINK_SLAM]);
 	u_sink_debug_destroy(&cam->debug_sinks[WMR_DEBUG_SINK_CONTROLLER]);
+	u_frame_pool_destroy(&cam->frame_pool);
 
 	free(cam);
 }
@@ -630,11 +690,14 @@ wmr_camera_start(struct wmr_camera *cam)
 	}
 
 	for (int i = 0; i < NUM_XFERS; i++) {
-		uint8_t *recv_buf = malloc(cam->xfer_size);
+		// The frame owns the buffer, the transfer must not free it.
+		if (cam->xfer_frames[i] == NULL) {
+			create_xfer_frame(cam, &cam->xfer_frames[i]);
+		}
+		uint8_t *recv_buf = cam->xfer_frames[i]->data;
 
 		libusb_fill_bulk_transfer(cam->xfers[i], cam->dev, LIBUSB_ENDPOINT_IN | 5, recv_buf, cam->xfer_size,
 		                          img_xfer_cb, cam, 0);
-		cam->xfers[i]->flags |= LIBUSB_TRANSFER_FREE_BUFFER;
 
 		res = libusb_submit_transfer(cam->xfers[i]);
 		if (res < 0) {
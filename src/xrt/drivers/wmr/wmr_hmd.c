@@ -38,9 +38,7 @@
 #include "util/u_distortion_mesh.h"
 #include "util/u_sink.h"
 
-#ifdef XRT_OS_LINUX
-#include "util/u_linux.h"
-#endif
+#include "util/u_thread_policy.h"
 
 #include "tracking/t_tracking.h"
 
@@ -454,24 +452,22 @@ hololens_handle_sensors_all(struct wmr_hmd *wh, const unsigned char *buffer, int
 		math_quat_rotate_vec3(&wh->config.sensors.transforms.P_oxr_acc.orientation, ca, ca);
 	}
 
-	// Fusion tracking
-	os_mutex_lock(&wh->fusion.mutex);
+	timepoint_ns ts[IMU_SAMPLES_PER_PACKET];
+	uint64_t fusion_ts[IMU_SAMPLES_PER_PACKET];
 	for (int i = 0; i < IMU_SAMPLES_PER_PACKET; i++) {
-		m_imu_3dof_update(                                              //
-		    &wh->fusion.i3dof,                                          //
-		    wh->packet.gyro_timestamp[i] * WMR_MS_HOLOLENS_NS_PER_TICK, //
-		    &calib_accel[i],                                            //
-		    &calib_gyro[i]);                                            //
+		ts[i] = wh->packet.gyro_timestamp[i] * WMR_MS_HOLOLENS_NS_PER_TICK;
+		fusion_ts[i] = (uint64_t)ts[i];
 	}
+
+	// Fusion tracking
+	os_mutex_lock(&wh->fusion.mutex);
+	m_imu_3dof_update_batch(&wh->fusion.i3dof, fusion_ts, calib_accel, calib_gyro, IMU_SAMPLES_PER_PACKET);
 	wh->fusion.last_imu_timestamp_ns = now_ns;
 	wh->fusion.last_angular_velocity = calib_gyro[3];
 	os_mutex_unlock(&wh->fusion.mutex);
 
 	// SLAM tracking
-	for (int i = 0; i < IMU_SAMPLES_PER_PACKET; i++) {
-		timepoint_ns t = wh->packet.gyro_timestamp[i] * WMR_MS_HOLOLENS_NS_PER_TICK;
-		wmr_source_push_imu_packet(wh->tracking.source, t, raw_accel[i], raw_gyro[i]);
-	}
+	wmr_source_push_imu_packets(wh->tracking.source, ts, raw_accel, raw_gyro, IMU_SAMPLES_PER_PACKET);
 }
 
 static void
@@ -664,10 +660,8 @@ wmr_run_thread(void *ptr)
 	U_TRACE_SET_THREAD_NAME("WMR: USB-HMD");
 	os_thread_helper_name(&wh->oth, "WMR: USB-HMD");
 
-#ifdef XRT_OS_LINUX
 	// Try to raise priority of this thread.
-	u_linux_try_to_set_realtime_priority_on_thread(wh->log_level, "WMR: USB-HMD");
-#endif
+	u_thread_policy_apply(wh->log_level, OS_THREAD_ROLE_IMU, "WMR: USB-HMD");
 
 
 	os_thread_helper_lock(&wh->oth);
@@ -1613,6 +1607,154 @@ wmr_hmd_fill_slam_calibration(struct wmr_hmd *wh)
 	wmr_hmd_fill_slam_cams_calibration(wh);
 }
 
+
+/*
+ *
+ * Passthrough.
+ *
+ */
+
+//! Angles further out than this are not worth spending the undistortion map's resolution on.
+#define WMR_PASSTHROUGH_MAX_ANGLE_RAD (70.0f * (float)M_PI / 180.0f)
+
+//! Tangent angles covered by the camera image, found by walking the image border.
+static struct xrt_fov
+wmr_hmd_passthrough_fov(const struct t_camera_model_params *model, struct xrt_size size)
+{
+	const float max_tan = tanf(WMR_PASSTHROUGH_MAX_ANGLE_RAD);
+	const int steps = 32;
+
+	float min_x = 0.f, max_x = 0.f, min_y = 0.f, max_y = 0.f;
+
+	for (int i = 0; i <= steps; i++) {
+		float t = (float)i / (float)steps;
+		float edge_x[4] = {t * size.w, t * size.w, 0.f, (float)size.w};
+		float edge_y[4] = {0.f, (float)size.h, t * size.h, t * size.h};
+
+		for (int k = 0; k < 4; k++) {
+			float x, y, z;
+			if (!t_camera_models_unproject_and_flip(model, edge_x[k], edge_y[k], &x, &y, &z)) {
+				continue;
+			}
+
+			// Sideways or behind, as far out as we go.
+			float forward = fmaxf(-z, 0.0001f);
+			float tan_x = CLAMP(x / forward, -max_tan, max_tan);
+			float tan_y = CLAMP(y / forward, -max_tan, max_tan);
+
+			min_x = fminf(min_x, tan_x);
+			max_x = fmaxf(max_x, tan_x);
+			min_y = fminf(min_y, tan_y);
+			max_y = fmaxf(max_y, tan_y);
+		}
+	}
+
+	struct xrt_fov fov = {
+	    .angle_left = atanf(min_x),
+	    .angle_right = atanf(max_x),
+	    .angle_up = atanf(max_y),
+	    .angle_down = atanf(min_y),
+	};
+
+	return fov;
+}
+
+static xrt_result_t
+wmr_hmd_get_passthrough_camera_info(struct xrt_device *xdev, struct xrt_passthrough_camera_info *out_info)
+{
+	struct wmr_hmd *wh = wmr_hmd(xdev);
+
+	*out_info = wh->passthrough.info;
+
+	return XRT_SUCCESS;
+}
+
+static xrt_result_t
+wmr_hmd_set_passthrough_camera_sink(struct xrt_device *xdev, uint32_t camera_index, struct xrt_frame_sink *sink)
+{
+	struct wmr_hmd *wh = wmr_hmd(xdev);
+
+	if (camera_index >= wh->passthrough.info.camera_count) {
+		return XRT_ERROR_FEATURE_NOT_SUPPORTED;
+	}
+
+	wmr_source_set_passthrough_sink(wh->tracking.source, camera_index, sink);
+
+	return XRT_SUCCESS;
+}
+
+static bool
+wmr_hmd_project_passthrough_camera(struct xrt_device *xdev,
+                                   uint32_t camera_index,
+                                   const struct xrt_vec3 *direction,
+                                   struct xrt_vec2 *out_uv)
+{
+	struct wmr_hmd *wh = wmr_hmd(xdev);
+
+	if (camera_index >= wh->passthrough.info.camera_count || direction->z >= 0.f) {
+		return false;
+	}
+
+	const struct t_camera_model_params *model = &wh->passthrough.models[camera_index];
+	struct xrt_size size = wh->passthrough.sizes[camera_index];
+
+	float x, y;
+	if (!t_camera_models_flip_and_project(model, direction->x, direction->y, direction->z, &x, &y)) {
+		return false;
+	}
+
+	// Pixel centers are on whole pixels.
+	out_uv->x = (x + 0.5f) / (float)size.w;
+	out_uv->y = (y + 0.5f) / (float)size.h;
+
+	return out_uv->x >= 0.f && out_uv->x <= 1.f && out_uv->y >= 0.f && out_uv->y <= 1.f;
+}
+
+/*!
+ * The first two tracking cameras look forward on all known headsets, use them
+ * for passthrough, the images are the same as the ones given to SLAM.
+ */
+static void
+wmr_hmd_setup_passthrough(struct wmr_hmd *wh)
+{
+	uint32_t count = MIN((uint32_t)wh->config.slam_cam_count, 2);
+	if (count == 0 || wh->tracking.source == NULL) {
+		return;
+	}
+
+	const struct xrt_pose P_oxr_wmr = {{.x = 1.0, .y = 0.0, .z = 0.0, .w = 0.0}, XRT_VEC3_ZERO};
+	const struct xrt_pose *P_ht0_me = &wh->config.sensors.transforms.P_ht0_me; // In OpenXR coordinates.
+
+	for (uint32_t i = 0; i < count; i++) {
+		struct t_camera_calibration calib = wmr_hmd_get_cam_calib(wh, (int)i);
+		struct t_camera_model_params *model = &wh->passthrough.models[i];
+
+		t_camera_model_params_from_t_camera_calibration(&calib, model);
+		wh->passthrough.sizes[i] = calib.image_size_pixels;
+		wh->passthrough.info.cameras[i].fov = wmr_hmd_passthrough_fov(model, calib.image_size_pixels);
+
+		if (i == 0) {
+			wh->passthrough.info.cameras[i].pose_in_head = *P_ht0_me;
+			continue;
+		}
+
+		// Express P_c0_ci in OpenXR coordinates through a sandwich product, P_oxr_wmr is its own inverse.
+		struct xrt_pose P_c0_ci;
+		math_pose_invert(&wh->config.tcams[i]->pose, &P_c0_ci);
+		math_pose_transform(&P_c0_ci, &P_oxr_wmr, &P_c0_ci);
+		math_pose_transform(&P_oxr_wmr, &P_c0_ci, &P_c0_ci);
+
+		math_pose_transform(P_ht0_me, &P_c0_ci, &wh->passthrough.info.cameras[i].pose_in_head);
+	}
+
+	wh->passthrough.info.camera_count = count;
+
+	wh->base.get_passthrough_camera_info = wmr_hmd_get_passthrough_camera_info;
+	wh->base.set_passthrough_camera_sink = wmr_hmd_set_passthrough_camera_sink;
+	wh->base.project_passthrough_camera = wmr_hmd_project_passthrough_camera;
+	wh->base.supported.passthrough_camera = true;
+}
+
 static void
 wmr_hmd_switch_hmd_tracker(void *wh_ptr)
 {
@@ -2110,6 +2252,7 @@ wmr_hmd_create(enum wmr_headset_type hmd_type,
 
 	// Switch on data streams on the HMD (only cameras for now as IMU is not yet integrated into wmr_source)
 	wh->tracking.source = wmr_source_create(&wh->tracking.xfctx, dev_holo, wh->config);
+	wmr_hmd_setup_passthrough(wh);
 
 	struct xrt_slam_sinks sinks = {0};
 	struct xrt_device *hand_device = NULL;
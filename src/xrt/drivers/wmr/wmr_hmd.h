@@ -15,6 +15,7 @@
 #pragma once
 
 #include "tracking/t_tracking.h"
+#include "tracking/t_camera_models.h"
 #include "xrt/xrt_device.h"
 #include "xrt/xrt_frame.h"
 #include "xrt/xrt_prober.h"
@@ -162,6 +163,18 @@ struct wmr_hmd
 		bool imu2me;
 	} tracking;
 
+	//! Tracking cameras used for passthrough, set at start.
+	struct
+	{
+		struct xrt_passthrough_camera_info info;
+
+		//! Distortion model of each camera.
+		struct t_camera_model_params models[XRT_MAX_VIEWS];
+
+		//! Size of each camera image.
+		struct xrt_size sizes[XRT_MAX_VIEWS];
+	} passthrough;
+
 	//! Whether to track the HMD with 6dof SLAM or fallback to the `fusion` 3dof tracker
 	bool slam_over_3dof;
 
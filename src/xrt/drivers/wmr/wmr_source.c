@@ -14,6 +14,7 @@
 #include "math/m_api.h"
 #include "math/m_clock_tracking.h"
 #include "math/m_filter_fifo.h"
+#include "os/os_threading.h"
 #include "util/u_debug.h"
 #include "util/u_sink.h"
 #include "util/u_var.h"
@@ -74,8 +75,16 @@ struct wmr_source
 	bool is_running;              //!< Whether the device is streaming
 	bool first_imu_received;      //!< Don't send frames until first IMU sample
 	timepoint_ns last_imu_ns;     //!< Last timepoint received.
-	time_duration_ns hw2mono;     //!< Estimated offset from IMU to monotonic clock
-	time_duration_ns cam_hw2mono; //!< Caches hw2mono for use in the full frame bundle
+	time_duration_ns cam_hw2mono; //!< Caches the offset from hw to monotonic for the full frame bundle
+
+	//! Estimated mapping from the hardware clock to monotonic, shared by the IMU and cameras.
+	struct m_clock_time_domain *time_domain;
+
+	//! Protects @ref passthrough_sinks, held while pushing so a sink is never used after being removed.
+	struct os_mutex passthrough_lock;
+
+	//! Sinks for passthrough, get the same frames as the tracking.
+	struct xrt_frame_sink *passthrough_sinks[WMR_MAX_CAMERAS];
 };
 
 /*
@@ -88,8 +97,9 @@ struct wmr_source
 	static void receive_cam##cam_id(struct xrt_frame_sink *sink, struct xrt_frame *xf)                             \
 	{                                                                                                              \
 		struct wmr_source *ws = container_of(sink, struct wmr_source, cam_sinks[cam_id]);                      \
-		if (cam_id == 0) {                                                                                     \
-			ws->cam_hw2mono = ws->hw2mono;                                                                 \
+		timepoint_ns mono_ts;                                                                                  \
+		if (cam_id == 0 && m_clock_time_domain_to_local(ws->time_domain, xf->timestamp, &mono_ts)) {           \
+			ws->cam_hw2mono = mono_ts - xf->timestamp;                                                     \
 		}                                                                                                      \
 		xf->timestamp += ws->cam_hw2mono;                                                                      \
 		WMR_TRACE(ws, "cam" #cam_id " img t=%" PRId64 " source_t=%" PRId64, xf->timestamp,                     \
@@ -98,6 +108,11 @@ struct wmr_source
 		if (ws->out_sinks.cams[cam_id] && ws->first_imu_received) {                                            \
 			xrt_sink_push_frame(ws->out_sinks.cams[cam_id], xf);                                           \
 		}                                                                                                      \
+		os_mutex_lock(&ws->passthrough_lock);                                                                  \
+		if (ws->passthrough_sinks[cam_id] && ws->first_imu_received) {                                         \
+			xrt_sink_push_frame(ws->passthrough_sinks[cam_id], xf);                                        \
+		}                                                                                                      \
+		os_mutex_unlock(&ws->passthrough_lock);                                                                \
 	}
 
 DEFINE_RECEIVE_CAM(0)
@@ -113,17 +128,17 @@ void (*receive_cam[WMR_MAX_CAMERAS])(struct xrt_frame_sink *, struct xrt_frame *
     receive_cam3, //
 };
 
-static void
-receive_imu_sample(struct xrt_imu_sink *sink, struct xrt_imu_sample *s)
+//! Convert the sample to the monotonic clock in place, returns false if it should be dropped.
+static bool
+convert_imu_sample(struct wmr_source *ws, struct xrt_imu_sample *s)
 {
-	struct wmr_source *ws = container_of(sink, struct wmr_source, imu_sink);
-
-	// Convert hardware timestamp into monotonic clock. Update offset estimate hw2mono.
+	// Convert hardware timestamp into monotonic clock. Update the estimate of the hardware clock.
 	// Note this is only done with IMU samples as they have the smallest USB transmission time.
-	const float IMU_FREQ = 250.f; //!< @todo use 1000 if "average_imus" is false
 	timepoint_ns now_hw = s->timestamp_ns;
 	timepoint_ns now_mono = (timepoint_ns)os_monotonic_get_ns();
-	timepoint_ns ts = m_clock_offset_a2b(IMU_FREQ, now_hw, now_mono, &ws->hw2mono);
+	timepoint_ns ts = now_mono;
+	m_clock_time_domain_push(ws->time_domain, now_mono, now_hw);
+	m_clock_time_domain_to_local(ws->time_domain, now_hw, &ts);
 
 	/*
 	 * Check if the timepoint does time travel, we get one or two
@@ -132,7 +147,7 @@ receive_imu_sample(struct xrt_imu_sink *sink, struct xrt_imu_sample *s)
 	if (ws->last_imu_ns > ts) {
 		WMR_WARN(ws, "Received sample from the past, new: %" PRIu64 ", last: %" PRIu64 ", diff: %" PRIu64, ts,
 		         s->timestamp_ns, ts - s->timestamp_ns);
-		return;
+		return false;
 	}
 
 	ws->first_imu_received = true;
@@ -149,11 +164,45 @@ receive_imu_sample(struct xrt_imu_sink *sink, struct xrt_imu_sample *s)
 	m_ff_vec3_f32_push(ws->gyro_ff, &gyro, ts);
 	m_ff_vec3_f32_push(ws->accel_ff, &accel, ts);
 
+	return true;
+}
+
+static void
+receive_imu_sample(struct xrt_imu_sink *sink, struct xrt_imu_sample *s)
+{
+	struct wmr_source *ws = container_of(sink, struct wmr_source, imu_sink);
+
+	if (!convert_imu_sample(ws, s)) {
+		return;
+	}
+
 	if (ws->out_sinks.imu) {
 		xrt_sink_push_imu(ws->out_sinks.imu, s);
 	}
 }
 
+static void
+receive_imu_samples(struct xrt_imu_sink *sink, struct xrt_imu_sample *samples, uint32_t count)
+{
+	struct wmr_source *ws = container_of(sink, struct wmr_source, imu_sink);
+
+	// Compact the accepted samples in place so they can be forwarded as one batch.
+	uint32_t kept = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		if (!convert_imu_sample(ws, &samples[i])) {
+			continue;
+		}
+		if (kept != i) {
+			samples[kept] = samples[i];
+		}
+		kept++;
+	}
+
+	if (ws->out_sinks.imu && kept > 0) {
+		xrt_sink_push_imu_batch(ws->out_sinks.imu, samples, kept);
+	}
+}
+
 
 /*
  *
@@ -282,6 +331,8 @@ wmr_source_node_destroy(struct xrt_frame_node *node)
 	if (ws->camera != NULL) { // It could be null if XRT_HAVE_LIBUSB is not defined
 		wmr_camera_free(ws->camera);
 	}
+	m_clock_time_domain_unref(&ws->time_domain);
+	os_mutex_destroy(&ws->passthrough_lock);
 	free(ws);
 }
 
@@ -320,6 +371,7 @@ wmr_source_create(struct xrt_frame_context *xfctx, struct xrt_prober_device *dev
 		ws->cam_sinks[i].push_frame = receive_cam[i];
 	}
 	ws->imu_sink.push_imu = receive_imu_sample;
+	ws->imu_sink.push_imu_batch = receive_imu_samples;
 
 	ws->in_sinks.cam_count = cfg.tcam_count;
 	for (int i = 0; i < cfg.tcam_count; i++) {
@@ -327,6 +379,13 @@ wmr_source_create(struct xrt_frame_context *xfctx, struct xrt_prober_device *dev
 	}
 	ws->in_sinks.imu = &ws->imu_sink;
 
+	// About four seconds of IMU samples, anything else on the headset clock can share it.
+	char domain_name[64];
+	(void)snprintf(domain_name, sizeof(domain_name), "wmr/%p", (void *)dev_holo);
+	ws->time_domain = m_clock_time_domain_ref(domain_name, 1000);
+
+	os_mutex_init(&ws->passthrough_lock);
+
 	struct wmr_camera_open_config options = {
 	    .dev_holo = dev_holo,
 	    .tcam_confs = cfg.tcams,
@@ -376,3 +435,47 @@ wmr_source_push_imu_packet(struct xrt_fs *xfs, timepoint_ns t, struct xrt_vec3 a
 	struct xrt_imu_sample sample = {.timestamp_ns = t, .accel_m_s2 = accel_f64, .gyro_rad_secs = gyro_f64};
 	xrt_sink_push_imu(&ws->imu_sink, &sample);
 }
+
+void
+wmr_source_push_imu_packets(struct xrt_fs *xfs,
+                            const timepoint_ns *ts,
+                            const struct xrt_vec3 *accel,
+                            const struct xrt_vec3 *gyro,
+                            uint32_t count)
+{
+	DRV_TRACE_MARKER();
+	struct wmr_source *ws = wmr_source_from_xfs(xfs);
+
+	// Packets hold four samples, this covers it in one go.
+	struct xrt_imu_sample samples[8];
+
+	while (count > 0) {
+		uint32_t n = count < ARRAY_SIZE(samples) ? count : ARRAY_SIZE(samples);
+
+		for (uint32_t i = 0; i < n; i++) {
+			samples[i] = (struct xrt_imu_sample){
+			    .timestamp_ns = ts[i],
+			    .accel_m_s2 = {accel[i].x, accel[i].y, accel[i].z},
+			    .gyro_rad_secs = {gyro[i].x, gyro[i].y, gyro[i].z},
+			};
+		}
+
+		xrt_sink_push_imu_batch(&ws->imu_sink, samples, n);
+
+		ts += n;
+		accel += n;
+		gyro += n;
+		count -= n;
+	}
+}
+
+void
+wmr_source_set_passthrough_sink(struct xrt_fs *xfs, uint32_t cam_index, struct xrt_frame_sink *sink)
+{
+	struct wmr_source *ws = wmr_source_from_xfs(xfs);
+	assert(cam_index < WMR_MAX_CAMERAS);
+
+	os_mutex_lock(&ws->passthrough_lock);
+	ws->passthrough_sinks[cam_index] = sink;
+	os_mutex_unlock(&ws->passthrough_lock);
+}
@@ -37,6 +37,21 @@ wmr_source_create(struct xrt_frame_context *xfctx, struct xrt_prober_device *dev
 void
 wmr_source_push_imu_packet(struct xrt_fs *xfs, timepoint_ns t, struct xrt_vec3 accel, struct xrt_vec3 gyro);
 
+//! Push all samples of a packet at once, they are sent downstream as a single batch.
+void
+wmr_source_push_imu_packets(struct xrt_fs *xfs,
+                            const timepoint_ns *ts,
+                            const struct xrt_vec3 *accel,
+                            const struct xrt_vec3 *gyro,
+                            uint32_t count);
+
+/*!
+ * Also push the frames of one camera to @p sink, used for passthrough. Pass
+ * NULL to stop, once this returns the old sink is not pushed to anymore.
+ */
+void
+wmr_source_set_passthrough_sink(struct xrt_fs *xfs, uint32_t cam_index, struct xrt_frame_sink *sink);
+
 /*!
  * @}
  */
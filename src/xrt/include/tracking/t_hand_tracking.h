@@ -111,6 +111,14 @@ struct t_hand_tracking_create_info
 {
 	struct t_camera_extra_info cams_info;   //!< Extra camera info
 	struct xrt_hand_masks_sink *masks_sink; //!< Optional sink to stream hand bounding boxes to
+
+	/*!
+	 * Optional, trackers that load their models in the background call
+	 * this from their loading thread once they can produce hands, until
+	 * then all hands are reported as not active.
+	 */
+	void (*ready_cb)(void *userdata);
+	void *ready_userdata; //!< Passed to @ref ready_cb
 };
 
 /*!
@@ -160,6 +160,42 @@ xrt_atomic_s32_cmpxchg(xrt_atomic_s32_t *p, int32_t old_, int32_t new_)
 #error "compiler not supported"
 #endif
 }
+static inline int32_t
+xrt_atomic_s32_load_acquire(xrt_atomic_s32_t *p)
+{
+#if defined(__GNUC__)
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+	int32_t ret = *p;
+	MemoryBarrier();
+	return ret;
+#else
+#error "compiler not supported"
+#endif
+}
+static inline void
+xrt_atomic_s32_store_release(xrt_atomic_s32_t *p, int32_t value)
+{
+#if defined(__GNUC__)
+	__atomic_store_n(p, value, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+	MemoryBarrier();
+	*p = value;
+#else
+#error "compiler not supported"
+#endif
+}
+static inline void
+xrt_atomic_thread_fence(void)
+{
+#if defined(__GNUC__)
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+	MemoryBarrier();
+#else
+#error "compiler not supported"
+#endif
+}
 
 #ifdef _MSC_VER
 typedef intptr_t ssize_t;
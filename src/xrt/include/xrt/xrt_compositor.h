@@ -481,6 +481,11 @@ struct xrt_layer_frame_data
 	//! alignas for 32 bit client support, see @ref ipc-design
 	XRT_ALIGNAS(8) int64_t frame_id;
 	int64_t display_time_ns;
+	/*!
+	 * When the head pose used to render the views of this frame was
+	 * sampled, used to estimate the motion-to-photon latency, 0 if unknown.
+	 */
+	int64_t pose_sample_time_ns;
 	enum xrt_blend_mode env_blend_mode;
 };
 
@@ -2356,6 +2361,38 @@ struct xrt_system_compositor_info
 
 struct xrt_system_compositor;
 
+/*!
+ * Frame timing statistics of one client/session of a multi compositor, the
+ * times are filtered over the recent frames and the counts are totals since
+ * the session was created.
+ */
+struct xrt_compositor_frame_stats
+{
+	//! Time between the app waking up from xrWaitFrame and calling xrBeginFrame.
+	int64_t cpu_time_ns;
+	//! Time between xrBeginFrame and xrEndFrame.
+	int64_t draw_time_ns;
+	//! Time between xrEndFrame and the GPU completing the frame.
+	int64_t gpu_time_ns;
+	//! Time between the app waking up and the frame being displayed.
+	int64_t latency_ns;
+
+	//! Frames completed by the GPU.
+	uint64_t completed_frame_count;
+	//! Completed frames that were done later than predicted.
+	uint64_t missed_frame_count;
+	//! Frames discarded by the app.
+	uint64_t discarded_frame_count;
+
+	/*!
+	 * Advised scale of the recommended image size, 1 when the GPU has
+	 * headroom and lower when the app's and the compositor's GPU work don't
+	 * fit in the frame. The app renders a smaller imageRect of its
+	 * swapchains to follow it.
+	 */
+	float resolution_scale;
+};
+
 /*!
  * @interface xrt_multi_compositor_control
  * Special functions to control multi session/clients.
@@ -2410,6 +2447,21 @@ struct xrt_multi_compositor_control
 	                                               struct xrt_compositor *xc,
 	                                               float from_display_refresh_rate_hz,
 	                                               float to_display_refresh_rate_hz);
+
+	/*!
+	 * Get the frame timing statistics of this client/session.
+	 */
+	xrt_result_t (*get_frame_stats)(struct xrt_system_compositor *xsc,
+	                                struct xrt_compositor *xc,
+	                                struct xrt_compositor_frame_stats *out_stats);
+
+	/*!
+	 * Keep the native compositor's session, and with it the target, alive
+	 * when the last client session stops, so that the next one starts
+	 * without having to recreate it. When disabled the session is ended as
+	 * soon as there are no client sessions.
+	 */
+	xrt_result_t (*set_warm_standby)(struct xrt_system_compositor *xsc, bool enabled);
 };
 
 /*!
@@ -2586,6 +2638,48 @@ xrt_syscomp_notify_display_refresh_changed(struct xrt_system_compositor *xsc,
 	                                                 to_display_refresh_rate_hz);
 }
 
+/*!
+ * @copydoc xrt_multi_compositor_control::get_frame_stats
+ *
+ * Helper for calling through the function pointer.
+ *
+ * If the system compositor @p xsc does not implement @ref xrt_multi_composition_control,
+ * or doesn't keep statistics, this returns @ref XRT_ERROR_MULTI_SESSION_NOT_IMPLEMENTED.
+ *
+ * @public @memberof xrt_system_compositor
+ */
+static inline xrt_result_t
+xrt_syscomp_get_frame_stats(struct xrt_system_compositor *xsc,
+                            struct xrt_compositor *xc,
+                            struct xrt_compositor_frame_stats *out_stats)
+{
+	if (xsc->xmcc == NULL || xsc->xmcc->get_frame_stats == NULL) {
+		return XRT_ERROR_MULTI_SESSION_NOT_IMPLEMENTED;
+	}
+
+	return xsc->xmcc->get_frame_stats(xsc, xc, out_stats);
+}
+
+/*!
+ * @copydoc xrt_multi_compositor_control::set_warm_standby
+ *
+ * Helper for calling through the function pointer.
+ *
+ * If the system compositor @p xsc does not implement @ref xrt_multi_composition_control,
+ * or doesn't support warm standby, this returns @ref XRT_ERROR_MULTI_SESSION_NOT_IMPLEMENTED.
+ *
+ * @public @memberof xrt_system_compositor
+ */
+static inline xrt_result_t
+xrt_syscomp_set_warm_standby(struct xrt_system_compositor *xsc, bool enabled)
+{
+	if (xsc->xmcc == NULL || xsc->xmcc->set_warm_standby == NULL) {
+		return XRT_ERROR_MULTI_SESSION_NOT_IMPLEMENTED;
+	}
+
+	return xsc->xmcc->set_warm_standby(xsc, enabled);
+}
+
 /*!
  * @copydoc xrt_system_compositor::create_native_compositor
  *
@@ -22,6 +22,7 @@ extern "C" {
 #endif
 
 struct xrt_tracking;
+struct xrt_frame_sink;
 
 #define XRT_DEVICE_NAME_LEN 256
 
@@ -242,6 +243,27 @@ struct xrt_output_limits
 	float haptic_pcm_sample_rate;
 };
 
+/*!
+ * The cameras of a device that can be used for passthrough, they are given to
+ * the compositor which reprojects them into the views.
+ *
+ * @ingroup xrt_iface
+ */
+struct xrt_passthrough_camera_info
+{
+	//! Number of cameras, view i uses camera i, all views share it if only one.
+	uint32_t camera_count;
+
+	struct
+	{
+		//! Pose of the camera in the head space, -Z forward and +Y up.
+		struct xrt_pose pose_in_head;
+
+		//! Tangent angles covered by the camera image.
+		struct xrt_fov fov;
+	} cameras[XRT_MAX_VIEWS];
+};
+
 /*!
  * Static data of supported features of the @ref xrt_device this struct sits on.
  *
@@ -266,6 +288,7 @@ struct xrt_device_supported
 	bool body_tracking_calibration;
 	bool battery_status;
 	bool brightness_control;
+	bool passthrough_camera;
 
 	bool planes;
 	enum xrt_plane_detection_capability_flags_ext plane_capability_flags;
@@ -665,6 +688,50 @@ struct xrt_device
 	 */
 	xrt_result_t (*set_brightness)(struct xrt_device *xdev, float brightness, bool relative);
 
+	/*!
+	 * Get the cameras that can be used for passthrough.
+	 *
+	 * @param[in] xdev      The device.
+	 * @param[out] out_info The cameras.
+	 *
+	 * @see xrt_device_supported::passthrough_camera
+	 */
+	xrt_result_t (*get_passthrough_camera_info)(struct xrt_device *xdev,
+	                                            struct xrt_passthrough_camera_info *out_info);
+
+	/*!
+	 * Start pushing the frames of a passthrough camera to the given sink,
+	 * the frames are timestamped in the monotonic clock.
+	 *
+	 * @param[in] xdev         The device.
+	 * @param[in] camera_index Index of the camera.
+	 * @param[in] sink         Where to push the frames, NULL stops pushing.
+	 *
+	 * @see xrt_device_supported::passthrough_camera
+	 */
+	xrt_result_t (*set_passthrough_camera_sink)(struct xrt_device *xdev,
+	                                            uint32_t camera_index,
+	                                            struct xrt_frame_sink *sink);
+
+	/*!
+	 * Project a direction into the image of a passthrough camera, including
+	 * its lens distortion, used by the compositor to build the lookup that
+	 * undistorts the camera images.
+	 *
+	 * @param[in] xdev         The device.
+	 * @param[in] camera_index Index of the camera.
+	 * @param[in] direction    Direction in the camera space, -Z forward and +Y up.
+	 * @param[out] out_uv      Normalized coordinates in the camera image.
+	 *
+	 * @return false if the direction does not land in the camera image.
+	 *
+	 * @see xrt_device_supported::passthrough_camera
+	 */
+	bool (*project_passthrough_camera)(struct xrt_device *xdev,
+	                                   uint32_t camera_index,
+	                                   const struct xrt_vec3 *direction,
+	                                   struct xrt_vec2 *out_uv);
+
 	/*!
 	 * Enable the feature for this device.
 	 *
@@ -1021,6 +1088,48 @@ xrt_device_set_brightness(struct xrt_device *xdev, float brightness, bool relati
 	return xdev->set_brightness(xdev, brightness, relative);
 }
 
+/*!
+ * Helper function for @ref xrt_device::get_passthrough_camera_info.
+ *
+ * @copydoc xrt_device::get_passthrough_camera_info
+ *
+ * @public @memberof xrt_device
+ */
+static inline xrt_result_t
+xrt_device_get_passthrough_camera_info(struct xrt_device *xdev, struct xrt_passthrough_camera_info *out_info)
+{
+	return xdev->get_passthrough_camera_info(xdev, out_info);
+}
+
+/*!
+ * Helper function for @ref xrt_device::set_passthrough_camera_sink.
+ *
+ * @copydoc xrt_device::set_passthrough_camera_sink
+ *
+ * @public @memberof xrt_device
+ */
+static inline xrt_result_t
+xrt_device_set_passthrough_camera_sink(struct xrt_device *xdev, uint32_t camera_index, struct xrt_frame_sink *sink)
+{
+	return xdev->set_passthrough_camera_sink(xdev, camera_index, sink);
+}
+
+/*!
+ * Helper function for @ref xrt_device::project_passthrough_camera.
+ *
+ * @copydoc xrt_device::project_passthrough_camera
+ *
+ * @public @memberof xrt_device
+ */
+static inline bool
+xrt_device_project_passthrough_camera(struct xrt_device *xdev,
+                                      uint32_t camera_index,
+                                      const struct xrt_vec3 *direction,
+                                      struct xrt_vec2 *out_uv)
+{
+	return xdev->project_passthrough_camera(xdev, camera_index, direction, out_uv);
+}
+
 /*!
  * Helper function for @ref xrt_device::begin_feature.
  *
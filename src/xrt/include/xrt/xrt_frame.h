@@ -1,4 +1,4 @@
-// Copyright 2019, Collabora, Ltd.
+// Copyright 2019-2024, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "xrt/xrt_defines.h"
+#include "xrt/xrt_handles.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -40,6 +41,29 @@ struct xrt_frame
 	int64_t source_timestamp;
 	uint64_t source_sequence; //!< sequence id
 	uint64_t source_id;       //!< Which @ref xrt_fs this frame originated from.
+
+	/*!
+	 * Optional graphics buffer that holds the same pixels as @ref data,
+	 * such as a DMABUF exported by a capture driver, so GPU consumers can
+	 * import the frame without a copy through the CPU.
+	 *
+	 * The handle is owned by the producer and only valid while the frame is
+	 * referenced, consumers that keep an import around must duplicate it.
+	 * Frames created by copying, like @ref u_frame_clone, don't have one.
+	 */
+	struct
+	{
+		//! Is @ref handle set, zero initialised frames don't have one.
+		bool valid;
+
+		xrt_graphics_buffer_handle_t handle;
+
+		//! Offset of the first pixel of @ref data in the buffer.
+		size_t offset;
+
+		//! Total size of the buffer.
+		size_t size;
+	} graphics_buffer;
 };
 
 
@@ -193,6 +193,13 @@ struct xrt_plane_detections_ext
 
 	//! Continuous array of polygon vertices of all polygons for all planes of a query.
 	struct xrt_vec2 *vertices;
+
+	/*!
+	 * Revision of the contents, changes whenever they do, so that whoever
+	 * fills this in can skip doing so if it already has them. Zero means
+	 * unknown, which is what @ref xrt_plane_detections_ext_clear leaves.
+	 */
+	uint64_t revision;
 };
 
 /*!
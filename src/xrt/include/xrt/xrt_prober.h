@@ -151,7 +151,10 @@ struct xrt_prober
 
 	/*!
 	 * Locks the prober list of probed devices and returns it.
-	 * While locked, calling @ref xrt_prober::probe is forbidden. Not thread safe.
+	 * While locked, calling @ref xrt_prober::probe is forbidden. The list
+	 * may be locked by several threads at the same time, as happens when
+	 * the builders are estimated in parallel, each lock must be paired with
+	 * a call to @ref xrt_prober::unlock_list.
 	 *
 	 * See @ref xrt_prober::probe for more detailed expected usage.
 	 *
@@ -163,7 +166,7 @@ struct xrt_prober
 
 	/*!
 	 * Unlocks the list, allowing for @ref xrt_prober::probe to be called.
-	 * Takes a pointer to the list pointer and clears it. Not thread safe.
+	 * Takes a pointer to the list pointer and clears it.
 	 * See @ref xrt_prober::probe for more detailed expected usage.
 	 *
 	 * @see xrt_prober::probe, xrt_prober::lock_list
@@ -345,6 +345,28 @@ struct xrt_system_devices
 	 */
 	xrt_result_t (*feature_dec)(struct xrt_system_devices *xsysd, enum xrt_device_feature_type type);
 
+	/*!
+	 * Get the poses of several devices at the same time, lets systems whose
+	 * devices share a tracking backend answer all of them from one snapshot.
+	 *
+	 * Optional, may be NULL in which case each device is queried in turn,
+	 * code consuming this interface should use
+	 * @ref xrt_system_devices_get_tracked_poses.
+	 *
+	 * @param xsysd           Pointer to self
+	 * @param count           Number of poses to get.
+	 * @param xdevs           Devices to query, @p count elements.
+	 * @param names           Pose input of each device, @p count elements.
+	 * @param at_timestamp_ns Time to get the poses at, shared by all devices.
+	 * @param[out] out_relations The relations, @p count elements.
+	 */
+	xrt_result_t (*get_tracked_poses)(struct xrt_system_devices *xsysd,
+	                                  uint32_t count,
+	                                  struct xrt_device *const *xdevs,
+	                                  const enum xrt_input_name *names,
+	                                  int64_t at_timestamp_ns,
+	                                  struct xrt_space_relation *out_relations);
+
 	/*!
 	 * Destroy all the devices that are owned by this system devices.
 	 *
@@ -394,6 +416,39 @@ xrt_system_devices_feature_dec(struct xrt_system_devices *xsysd, enum xrt_device
 	return xsysd->feature_dec(xsysd, type);
 }
 
+/*!
+ * @copydoc xrt_system_devices::get_tracked_poses
+ *
+ * Helper for calling through the function pointer, falls back to calling
+ * @ref xrt_device_get_tracked_pose for each device.
+ *
+ * @public @memberof xrt_system_devices
+ */
+static inline xrt_result_t
+xrt_system_devices_get_tracked_poses(struct xrt_system_devices *xsysd,
+                                     uint32_t count,
+                                     struct xrt_device *const *xdevs,
+                                     const enum xrt_input_name *names,
+                                     int64_t at_timestamp_ns,
+                                     struct xrt_space_relation *out_relations)
+{
+	if (xsysd->get_tracked_poses != NULL) {
+		return xsysd->get_tracked_poses(xsysd, count, xdevs, names, at_timestamp_ns, out_relations);
+	}
+
+	const struct xrt_space_relation zero = XRT_SPACE_RELATION_ZERO;
+	xrt_result_t ret = XRT_SUCCESS;
+	for (uint32_t i = 0; i < count; i++) {
+		xrt_result_t xret = xrt_device_get_tracked_pose(xdevs[i], names[i], at_timestamp_ns, &out_relations[i]);
+		if (xret != XRT_SUCCESS) {
+			out_relations[i] = zero;
+			ret = xret;
+		}
+	}
+
+	return ret;
+}
+
 /*!
  * Destroy an xrt_system_devices and owned devices - helper function.
  *
@@ -171,6 +171,14 @@ struct xrt_imu_sink
 	 * Push an IMU sample into the sink
 	 */
 	void (*push_imu)(struct xrt_imu_sink *, struct xrt_imu_sample *sample);
+
+	/*!
+	 * Push several IMU samples at once, in timestamp order, devices often
+	 * deliver a handful of samples per packet. Like with @ref push_imu the
+	 * sink may modify the samples. Optional, if NULL the samples are pushed
+	 * one by one through @ref push_imu.
+	 */
+	void (*push_imu_batch)(struct xrt_imu_sink *, struct xrt_imu_sample *samples, uint32_t count);
 };
 
 /*!
@@ -314,6 +322,20 @@ xrt_sink_push_imu(struct xrt_imu_sink *sink, struct xrt_imu_sample *sample)
 	sink->push_imu(sink, sample);
 }
 
+//! @public @memberof xrt_imu_sink
+static inline void
+xrt_sink_push_imu_batch(struct xrt_imu_sink *sink, struct xrt_imu_sample *samples, uint32_t count)
+{
+	if (sink->push_imu_batch != NULL) {
+		sink->push_imu_batch(sink, samples, count);
+		return;
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		sink->push_imu(sink, &samples[i]);
+	}
+}
+
 //! @public @memberof xrt_pose_sink
 static inline void
 xrt_sink_push_pose(struct xrt_pose_sink *sink, struct xrt_pose_sample *sample)
@@ -50,6 +50,10 @@
  */
 
 struct xrt_compositor_native;
+struct ipc_ring;
+
+//! Max bytes of async commands queued before they are sent on their own.
+#define IPC_ASYNC_QUEUE_SIZE 2048
 
 
 /*!
@@ -62,8 +66,28 @@ struct ipc_connection
 	struct ipc_shared_memory *ism;
 	xrt_shmem_handle_t ism_handle;
 
+	//! Size of the mapping of @ref ism, see @ref ipc_shared_memory::size.
+	size_t ism_size;
+
 	struct os_mutex mutex;
 
+	/*!
+	 * Index of this client in the per client arrays of the shared memory,
+	 * UINT32_MAX if the service didn't give us one.
+	 */
+	uint32_t shared_client_index;
+
+	//! Optional shared memory channel for calls without handles, NULL if not used.
+	struct ipc_ring *ring;
+	xrt_shmem_handle_t ring_handle;
+
+	/*!
+	 * Async commands not yet sent, with room for the command that is sent
+	 * together with them. Guarded by @ref mutex.
+	 */
+	uint8_t async_queue[IPC_ASYNC_QUEUE_SIZE + IPC_BUF_SIZE];
+	uint32_t async_queue_size;
+
 #ifdef XRT_OS_ANDROID
 	struct ipc_client_android *ica;
 #endif // XRT_OS_ANDROID
@@ -76,6 +100,44 @@ struct ipc_connection
  *
  */
 
+/*!
+ * Send a command and wait for its reply, over the ring if it has been set up
+ * and over the socket otherwise. Must be called with the connection mutex held.
+ *
+ * @param ipc_c      IPC connection
+ * @param msg        Command to send.
+ * @param msg_size   Size of the command.
+ * @param out_reply  Receives the reply.
+ * @param reply_size Expected size of the reply.
+ */
+xrt_result_t
+ipc_client_send_and_receive(
+    struct ipc_connection *ipc_c, const void *msg, size_t msg_size, void *out_reply, size_t reply_size);
+
+/*!
+ * Tell the service that the next command comes over the socket and send any
+ * queued async commands ahead of it, must be called with the connection mutex
+ * held before sending anything on the socket.
+ *
+ * @param ipc_c IPC connection
+ */
+xrt_result_t
+ipc_client_begin_socket_command(struct ipc_connection *ipc_c);
+
+/*!
+ * Queue a command that isn't replied to, it is sent together with the next
+ * command that is. Must be called with the connection mutex held.
+ *
+ * @param ipc_c    IPC connection
+ * @param msg      Command to queue.
+ * @param msg_size Size of the command.
+ *
+ * @return The first failure of an earlier async command not yet reported, or
+ *         a failure to send the queue.
+ */
+xrt_result_t
+ipc_client_queue_async(struct ipc_connection *ipc_c, const void *msg, size_t msg_size);
+
 /*!
  * Create an IPC client system compositor.
  *
@@ -19,6 +19,7 @@
 #include "util/u_misc.h"
 #include "util/u_wait.h"
 #include "util/u_handles.h"
+#include "util/u_index_fifo.h"
 #include "util/u_trace_marker.h"
 #include "util/u_limited_unique_id.h"
 
@@ -36,6 +37,10 @@
 #include <errno.h>
 #include <assert.h>
 
+#ifdef XRT_OS_LINUX
+#include "shared/ipc_futex.h"
+#endif
+
 #ifdef XRT_GRAPHICS_SYNC_HANDLE_IS_FD
 #include <unistd.h>
 #endif
@@ -97,6 +102,15 @@ struct ipc_client_swapchain
 	struct ipc_client_compositor *icc;
 
 	uint32_t id;
+
+	/*!
+	 * Released images in the order they will be acquired, the service's
+	 * swapchain hands them out in the same order so no call is needed.
+	 */
+	struct u_index_fifo fifo;
+
+	//! Release state published by the service, NULL if not available.
+	struct ipc_shared_swapchain *iss;
 };
 
 /*!
@@ -182,6 +196,30 @@ ipc_compositor_swapchain_destroy(struct xrt_swapchain *xsc)
 	free(xsc);
 }
 
+#ifdef XRT_OS_LINUX
+/*!
+ * Sleep until the service has checked the released image, returns the new
+ * state or @ref IPC_SHARED_IMAGE_STATE_RELEASED if @p until_ns passed.
+ */
+static int32_t
+wait_for_image_check(struct ipc_shared_swapchain *iss, uint32_t index, int64_t until_ns)
+{
+	while (true) {
+		// Read before the state, so that a change in between isn't missed.
+		int32_t seq = xrt_atomic_s32_load_acquire(&iss->release_seq);
+
+		int32_t state = xrt_atomic_s32_load_acquire(&iss->image_states[index]);
+		if (state != IPC_SHARED_IMAGE_STATE_RELEASED || os_monotonic_get_ns() >= until_ns) {
+			return state;
+		}
+
+		xrt_atomic_s32_inc_return(&iss->client_waiting);
+		ipc_futex_wait_until(&iss->release_seq, seq, until_ns);
+		xrt_atomic_s32_dec_return(&iss->client_waiting);
+	}
+}
+#endif
+
 static xrt_result_t
 ipc_compositor_swapchain_wait_image(struct xrt_swapchain *xsc, int64_t timeout_ns, uint32_t index)
 {
@@ -189,6 +227,35 @@ ipc_compositor_swapchain_wait_image(struct xrt_swapchain *xsc, int64_t timeout_n
 	struct ipc_client_compositor *icc = ics->icc;
 	xrt_result_t xret;
 
+	int32_t state = IPC_SHARED_IMAGE_STATE_IN_USE;
+	if (ics->iss != NULL && index < XRT_MAX_SWAPCHAIN_IMAGES) {
+		state = xrt_atomic_s32_load_acquire(&ics->iss->image_states[index]);
+	}
+
+#ifdef XRT_OS_LINUX
+	/*
+	 * The service checks the image when it gets the release, that is
+	 * usually done by now, if not sleep on the swapchain rather than
+	 * queueing a call behind it.
+	 */
+	int64_t start_ns = os_monotonic_get_ns();
+	if (state == IPC_SHARED_IMAGE_STATE_RELEASED) {
+		state = wait_for_image_check(ics->iss, index, start_ns + timeout_ns);
+	}
+#endif
+
+	if (state == IPC_SHARED_IMAGE_STATE_READY) {
+		return XRT_SUCCESS;
+	}
+
+#ifdef XRT_OS_LINUX
+	timeout_ns -= os_monotonic_get_ns() - start_ns;
+	if (timeout_ns < 0) {
+		timeout_ns = 0;
+	}
+#endif
+
+	// Still in use by the service, or not checked yet, let it do the wait.
 	xret = ipc_call_swapchain_wait_image(icc->ipc_c, ics->id, timeout_ns, index);
 	IPC_CHK_ALWAYS_RET(icc->ipc_c, xret, "ipc_call_swapchain_wait_image");
 }
@@ -197,11 +264,13 @@ static xrt_result_t
 ipc_compositor_swapchain_acquire_image(struct xrt_swapchain *xsc, uint32_t *out_index)
 {
 	struct ipc_client_swapchain *ics = ipc_client_swapchain(xsc);
-	struct ipc_client_compositor *icc = ics->icc;
-	xrt_result_t xret;
 
-	xret = ipc_call_swapchain_acquire_image(icc->ipc_c, ics->id, out_index);
-	IPC_CHK_ALWAYS_RET(icc->ipc_c, xret, "ipc_call_swapchain_acquire_image");
+	// Returns negative on empty fifo.
+	if (u_index_fifo_pop(&ics->fifo, out_index) < 0) {
+		return XRT_ERROR_NO_IMAGE_AVAILABLE;
+	}
+
+	return XRT_SUCCESS;
 }
 
 static xrt_result_t
@@ -211,10 +280,37 @@ ipc_compositor_swapchain_release_image(struct xrt_swapchain *xsc, uint32_t index
 	struct ipc_client_compositor *icc = ics->icc;
 	xrt_result_t xret;
 
+	if (index >= XRT_MAX_SWAPCHAIN_IMAGES || u_index_fifo_push(&ics->fifo, index) < 0) {
+		return XRT_ERROR_NO_IMAGE_AVAILABLE;
+	}
+
+	// Before the call, the service sets the state once it has checked it.
+	if (ics->iss != NULL) {
+		xrt_atomic_s32_store_release(&ics->iss->image_states[index], IPC_SHARED_IMAGE_STATE_RELEASED);
+	}
+
 	xret = ipc_call_swapchain_release_image(icc->ipc_c, ics->id, index);
 	IPC_CHK_ALWAYS_RET(icc->ipc_c, xret, "ipc_call_swapchain_release_image");
 }
 
+/*!
+ * Setup the parts of the swapchain that live on the client side, the images
+ * start out released in order just like on the service.
+ */
+static void
+swapchain_init_client_state(struct ipc_client_swapchain *ics)
+{
+	struct ipc_connection *ipc_c = ics->icc->ipc_c;
+
+	if (ipc_c->shared_client_index < ipc_c->ism->max_clients && ics->id < IPC_MAX_CLIENT_SWAPCHAINS) {
+		uint32_t index = ipc_c->shared_client_index * IPC_MAX_CLIENT_SWAPCHAINS + ics->id;
+		ics->iss = &ipc_shared_swapchains(ipc_c->ism)[index];
+	}
+
+	for (uint32_t i = 0; i < ics->base.base.image_count; i++) {
+		u_index_fifo_push(&ics->fifo, i);
+	}
+}
 
 /*
  *
@@ -300,6 +396,7 @@ swapchain_server_create(struct ipc_client_compositor *icc,
 	ics->base.limited_unique_id = u_limited_unique_id_get();
 	ics->icc = icc;
 	ics->id = handle;
+	swapchain_init_client_state(ics);
 
 	for (uint32_t i = 0; i < image_count; i++) {
 		ics->base.images[i].handle = remote_handles[i];
@@ -357,6 +454,7 @@ swapchain_server_import(struct ipc_client_compositor *icc,
 	ics->base.limited_unique_id = u_limited_unique_id_get();
 	ics->icc = icc;
 	ics->id = id;
+	swapchain_init_client_state(ics);
 
 	// The handles were copied in the IPC call so we can reuse them here.
 	for (uint32_t i = 0; i < image_count; i++) {
@@ -519,6 +617,36 @@ ipc_compositor_end_session(struct xrt_compositor *xc)
 	IPC_CHK_ALWAYS_RET(icc->ipc_c, xret, "ipc_call_session_end");
 }
 
+#ifdef XRT_OS_LINUX
+/*!
+ * Sleep until @p wake_up_time_ns, or until the service bumps the frame wake
+ * word away from @p seq. The client sleeps by itself so the wake up isn't
+ * delayed by the service's scheduling.
+ */
+static void
+wait_for_frame_wake(struct ipc_shared_frame_wake *wake, int32_t seq, int64_t wake_up_time_ns)
+{
+	// Same margin as u_wait_until, better a little early than late.
+	int64_t until_ns = wake_up_time_ns - (int64_t)U_WAIT_MEASURED_SCHEDULER_LATENCY_NS;
+
+	while (true) {
+		int64_t now_ns = (int64_t)os_monotonic_get_ns();
+		if (time_is_less_then_or_within_range(wake_up_time_ns, now_ns, U_TIME_1MS_IN_NS)) {
+			return;
+		}
+
+		if (xrt_atomic_s32_load_acquire(&wake->wake_seq) != seq) {
+			return;
+		}
+
+		// Full barrier, pairs with the one in the service.
+		xrt_atomic_s32_inc_return(&wake->client_waiting);
+		ipc_futex_wait_until(&wake->wake_seq, seq, until_ns);
+		xrt_atomic_s32_dec_return(&wake->client_waiting);
+	}
+}
+#endif
+
 static xrt_result_t
 ipc_compositor_wait_frame(struct xrt_compositor *xc,
                           int64_t *out_frame_id,
@@ -534,6 +662,18 @@ ipc_compositor_wait_frame(struct xrt_compositor *xc,
 	int64_t predicted_display_time = 0;
 	int64_t predicted_display_period = 0;
 
+#ifdef XRT_OS_LINUX
+	struct ipc_connection *ipc_c = icc->ipc_c;
+	struct ipc_shared_frame_wake *wake = NULL;
+	int32_t wake_seq = 0;
+
+	// Read before predicting, so that a wake up in between isn't missed.
+	if (ipc_c->shared_client_index < ipc_c->ism->max_clients) {
+		wake = &ipc_shared_frame_wakes(ipc_c->ism)[ipc_c->shared_client_index];
+		wake_seq = xrt_atomic_s32_load_acquire(&wake->wake_seq);
+	}
+#endif
+
 	xret = ipc_call_compositor_predict_frame( //
 	    icc->ipc_c,                           // Connection
 	    &frame_id,                            // Frame id
@@ -543,7 +683,15 @@ ipc_compositor_wait_frame(struct xrt_compositor *xc,
 	IPC_CHK_AND_RET(icc->ipc_c, xret, "ipc_call_compositor_predict_frame");
 
 	// Wait until the given wake up time.
+#ifdef XRT_OS_LINUX
+	if (wake != NULL) {
+		wait_for_frame_wake(wake, wake_seq, wake_up_time_ns);
+	} else {
+		u_wait_until(&icc->sleeper, wake_up_time_ns);
+	}
+#else
 	u_wait_until(&icc->sleeper, wake_up_time_ns);
+#endif
 
 	// Signal that we woke up.
 	xret = ipc_call_compositor_wait_woke(icc->ipc_c, frame_id);
@@ -573,7 +721,7 @@ ipc_compositor_layer_begin(struct xrt_compositor *xc, const struct xrt_layer_fra
 	struct ipc_client_compositor *icc = ipc_client_compositor(xc);
 
 	struct ipc_shared_memory *ism = icc->ipc_c->ism;
-	struct ipc_layer_slot *slot = &ism->slots[icc->layers.slot_id];
+	struct ipc_layer_slot *slot = &ipc_shared_slots(ism)[icc->layers.slot_id];
 
 	slot->data = *data;
 
@@ -591,7 +739,7 @@ ipc_compositor_layer_projection(struct xrt_compositor *xc,
 	assert(data->type == XRT_LAYER_PROJECTION);
 
 	struct ipc_shared_memory *ism = icc->ipc_c->ism;
-	struct ipc_layer_slot *slot = &ism->slots[icc->layers.slot_id];
+	struct ipc_layer_slot *slot = &ipc_shared_slots(ism)[icc->layers.slot_id];
 	struct ipc_layer_entry *layer = &slot->layers[icc->layers.layer_count];
 	layer->xdev_id = 0; //! @todo Real id.
 	layer->data = *data;
@@ -617,7 +765,7 @@ ipc_compositor_layer_projection_depth(struct xrt_compositor *xc,
 	assert(data->type == XRT_LAYER_PROJECTION_DEPTH);
 
 	struct ipc_shared_memory *ism = icc->ipc_c->ism;
-	struct ipc_layer_slot *slot = &ism->slots[icc->layers.slot_id];
+	struct ipc_layer_slot *slot = &ipc_shared_slots(ism)[icc->layers.slot_id];
 	struct ipc_layer_entry *layer = &slot->layers[icc->layers.layer_count];
 	struct ipc_client_swapchain *xscn[XRT_MAX_VIEWS];
 	struct ipc_client_swapchain *d_xscn[XRT_MAX_VIEWS];
@@ -651,7 +799,7 @@ handle_layer(struct xrt_compositor *xc,
 	assert(data->type == type);
 
 	struct ipc_shared_memory *ism = icc->ipc_c->ism;
-	struct ipc_layer_slot *slot = &ism->slots[icc->layers.slot_id];
+	struct ipc_layer_slot *slot = &ipc_shared_slots(ism)[icc->layers.slot_id];
 	struct ipc_layer_entry *layer = &slot->layers[icc->layers.layer_count];
 	struct ipc_client_swapchain *ics = ipc_client_swapchain(xsc);
 
@@ -721,7 +869,7 @@ ipc_compositor_layer_passthrough(struct xrt_compositor *xc, struct xrt_device *x
 	assert(data->type == XRT_LAYER_PASSTHROUGH);
 
 	struct ipc_shared_memory *ism = icc->ipc_c->ism;
-	struct ipc_layer_slot *slot = &ism->slots[icc->layers.slot_id];
+	struct ipc_layer_slot *slot = &ipc_shared_slots(ism)[icc->layers.slot_id];
 	struct ipc_layer_entry *layer = &slot->layers[icc->layers.layer_count];
 
 	layer->xdev_id = 0; //! @todo Real id.
@@ -742,7 +890,7 @@ ipc_compositor_layer_commit(struct xrt_compositor *xc, xrt_graphics_sync_handle_
 	bool valid_sync = xrt_graphics_sync_handle_is_valid(sync_handle);
 
 	struct ipc_shared_memory *ism = icc->ipc_c->ism;
-	struct ipc_layer_slot *slot = &ism->slots[icc->layers.slot_id];
+	struct ipc_layer_slot *slot = &ipc_shared_slots(ism)[icc->layers.slot_id];
 
 	// Last bit of data to put in the shared memory area.
 	slot->layer_count = icc->layers.layer_count;
@@ -781,7 +929,7 @@ ipc_compositor_layer_commit_with_semaphore(struct xrt_compositor *xc,
 	xrt_result_t xret;
 
 	struct ipc_shared_memory *ism = icc->ipc_c->ism;
-	struct ipc_layer_slot *slot = &ism->slots[icc->layers.slot_id];
+	struct ipc_layer_slot *slot = &ipc_shared_slots(ism)[icc->layers.slot_id];
 
 	// Last bit of data to put in the shared memory area.
 	slot->layer_count = icc->layers.layer_count;
@@ -1114,6 +1262,9 @@ ipc_client_create_system_compositor(struct ipc_connection *ipc_c,
 	c->ipc_c = ipc_c;
 	c->xina = xina;
 
+	// Each client has its own slot in the shared memory.
+	c->layers.slot_id = ipc_c->shared_client_index;
+
 
 #ifdef IPC_USE_LOOPBACK_IMAGE_ALLOCATOR
 	c->loopback_xina.images_allocate = ipc_compositor_images_allocate;
@@ -1,4 +1,4 @@
-// Copyright 2020-2024, Collabora, Ltd.
+// Copyright 2020-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -27,6 +27,7 @@
 #include "util/u_system_helpers.h"
 
 #include "shared/ipc_utils.h"
+#include "shared/ipc_shmem.h"
 #include "shared/ipc_protocol.h"
 #include "client/ipc_client_connection.h"
 
@@ -54,7 +55,23 @@
 #include "android/ipc_client_android.h"
 #endif // XRT_OS_ANDROID
 
+#ifdef XRT_OS_LINUX
+#include "shared/ipc_ring.h"
+#include "os/os_time.h"
+#endif
+
+#include <assert.h>
+#include <string.h>
+
+#ifdef XRT_OS_LINUX
+static_assert(IPC_ASYNC_QUEUE_SIZE + IPC_BUF_SIZE <= IPC_RING_COMMAND_SIZE,
+              "The queued async commands and one more must fit in the ring");
+#endif
+
 DEBUG_GET_ONCE_BOOL_OPTION(ipc_ignore_version, "IPC_IGNORE_VERSION", false)
+#ifdef XRT_OS_LINUX
+DEBUG_GET_ONCE_BOOL_OPTION(ipc_shm_ring, "IPC_SHM_RING", false)
+#endif
 
 #ifdef XRT_OS_ANDROID
 
@@ -89,11 +106,20 @@ ipc_client_socket_connect(struct ipc_connection *ipc_c, struct _JavaVM *vm, void
 
 #elif defined(XRT_OS_WINDOWS)
 
+static HANDLE
+ipc_open_pipe(const char *pipe_name)
+{
+	// All I/O on the pipe is overlapped, see ipc_message_channel_windows.cpp.
+	DWORD flags = FILE_FLAG_OVERLAPPED;
+
+	return CreateFileA(pipe_name, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, flags, NULL);
+}
+
 #if defined(NO_XRT_SERVICE_LAUNCH) || !defined(XRT_SERVICE_EXECUTABLE)
 static HANDLE
 ipc_connect_pipe(struct ipc_connection *ipc_c, const char *pipe_name)
 {
-	HANDLE pipe_inst = CreateFileA(pipe_name, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+	HANDLE pipe_inst = ipc_open_pipe(pipe_name);
 	if (pipe_inst == INVALID_HANDLE_VALUE) {
 		DWORD err = GetLastError();
 		IPC_ERROR(ipc_c, "Connect to %s failed: %d %s", pipe_name, err, ipc_winerror(err));
@@ -105,7 +131,7 @@ ipc_connect_pipe(struct ipc_connection *ipc_c, const char *pipe_name)
 static HANDLE
 ipc_connect_pipe(struct ipc_connection *ipc_c, const char *pipe_name)
 {
-	HANDLE pipe_inst = CreateFileA(pipe_name, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+	HANDLE pipe_inst = ipc_open_pipe(pipe_name);
 	if (pipe_inst != INVALID_HANDLE_VALUE) {
 		return pipe_inst;
 	}
@@ -154,7 +180,7 @@ ipc_connect_pipe(struct ipc_connection *ipc_c, const char *pipe_name)
 	IPC_INFO(ipc_c, "Launched %s (pid %d)... Waiting for %s...", service_path, pi.dwProcessId, pipe_name);
 	CloseHandle(pi.hThread);
 	for (int i = 0;; i++) {
-		pipe_inst = CreateFileA(pipe_name, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+		pipe_inst = ipc_open_pipe(pipe_name);
 		if (pipe_inst != INVALID_HANDLE_VALUE) {
 			IPC_INFO(ipc_c, "Connected to %s after %d msec on try %d!", pipe_name, i * 100, i + 1);
 			break;
@@ -256,6 +282,48 @@ ipc_client_socket_connect(struct ipc_connection *ipc_c)
 #endif
 
 
+static bool
+ipc_client_check_shm_section(const struct ipc_shared_section *section, size_t elem_size, size_t size)
+{
+	return section->offset >= sizeof(struct ipc_shared_memory) && //
+	       section->offset <= size &&                            //
+	       section->count <= (size - section->offset) / elem_size;
+}
+
+/*!
+ * Make sure that all sections are inside of the mapping, so the getters in
+ * @ref ipc_protocol.h can be used without checking.
+ */
+static bool
+ipc_client_check_shm_sections(const struct ipc_shared_memory *ism, size_t size)
+{
+	uint32_t max_clients = ism->max_clients;
+
+	return ipc_client_check_shm_section(&ism->inputs, sizeof(struct xrt_input), size) &&                    //
+	       ipc_client_check_shm_section(&ism->outputs, sizeof(struct xrt_output), size) &&                  //
+	       ipc_client_check_shm_section(&ism->binding_profiles,                                             //
+	                                    sizeof(struct ipc_shared_binding_profile), size) &&                 //
+	       ipc_client_check_shm_section(&ism->input_pairs, sizeof(struct xrt_binding_input_pair), size) &&  //
+	       ipc_client_check_shm_section(&ism->output_pairs, sizeof(struct xrt_binding_output_pair), size) && //
+	       ipc_client_check_shm_section(&ism->slots, sizeof(struct ipc_layer_slot), size) &&                //
+	       ipc_client_check_shm_section(&ism->space_snapshots,                                              //
+	                                    sizeof(struct ipc_shared_space_snapshot), size) &&                  //
+	       ipc_client_check_shm_section(&ism->client_io_active, sizeof(bool), size) &&                      //
+	       ipc_client_check_shm_section(&ism->async_results, sizeof(xrt_atomic_s32_t), size) &&             //
+	       ipc_client_check_shm_section(&ism->hand_trackers,                                                //
+	                                    sizeof(struct ipc_shared_hand_tracker), size) &&                    //
+	       ipc_client_check_shm_section(&ism->frame_wakes, sizeof(struct ipc_shared_frame_wake), size) &&   //
+	       ipc_client_check_shm_section(&ism->body_face_trackers,                                           //
+	                                    sizeof(struct ipc_shared_body_face_tracker), size) &&               //
+	       ipc_client_check_shm_section(&ism->swapchains, sizeof(struct ipc_shared_swapchain), size) &&     //
+	       ism->slots.count == max_clients &&                                                               //
+	       ism->space_snapshots.count == max_clients &&                                                     //
+	       ism->client_io_active.count == max_clients &&                                                    //
+	       ism->async_results.count == max_clients &&                                                       //
+	       ism->frame_wakes.count == max_clients &&                                                         //
+	       ism->swapchains.count == max_clients * IPC_MAX_CLIENT_SWAPCHAINS;
+}
+
 static xrt_result_t
 ipc_client_setup_shm(struct ipc_connection *ipc_c)
 {
@@ -270,24 +338,43 @@ ipc_client_setup_shm(struct ipc_connection *ipc_c)
 	}
 
 	/*
-	 * Now map it.
+	 * Map the header first to find out how big the whole thing is.
 	 */
 
-	const size_t size = sizeof(struct ipc_shared_memory);
+	xret = ipc_shmem_map(ipc_c->ism_handle, sizeof(struct ipc_shared_memory), (void **)&ipc_c->ism);
+	if (xret != XRT_SUCCESS) {
+		IPC_ERROR(ipc_c, "Failed to mmap shm!");
+		return xret;
+	}
+
+	// Checked even when ignoring the git tag, the layout must match.
+	uint32_t version = ipc_c->ism->version;
+	size_t size = ipc_c->ism->size;
 
-#ifdef XRT_OS_WINDOWS
-	DWORD access = FILE_MAP_READ | FILE_MAP_WRITE;
+	ipc_shmem_unmap((void **)&ipc_c->ism, sizeof(struct ipc_shared_memory));
 
-	ipc_c->ism = MapViewOfFile(ipc_c->ism_handle, access, 0, 0, size);
-#else
-	const int flags = MAP_SHARED;
-	const int access = PROT_READ | PROT_WRITE;
+	if (version != IPC_SHARED_MEMORY_VERSION || size < sizeof(struct ipc_shared_memory)) {
+		IPC_ERROR(ipc_c, "Shared memory version %u (%zu bytes) does not match ours %u", version, size,
+		          IPC_SHARED_MEMORY_VERSION);
+		return XRT_ERROR_IPC_FAILURE;
+	}
 
-	ipc_c->ism = mmap(NULL, size, access, flags, ipc_c->ism_handle, 0);
-#endif
+	/*
+	 * Now map all of it.
+	 */
 
-	if (ipc_c->ism == NULL) {
+	xret = ipc_shmem_map(ipc_c->ism_handle, size, (void **)&ipc_c->ism);
+	if (xret != XRT_SUCCESS) {
 		IPC_ERROR(ipc_c, "Failed to mmap shm!");
+		return xret;
+	}
+
+	ipc_c->ism_size = size;
+
+	if (!ipc_client_check_shm_sections(ipc_c->ism, size)) {
+		IPC_ERROR(ipc_c, "Shared memory sections out of bounds!");
+		ipc_shmem_unmap((void **)&ipc_c->ism, size);
+		ipc_c->ism_size = 0;
 		return XRT_ERROR_IPC_FAILURE;
 	}
 
@@ -336,6 +423,85 @@ ipc_client_describe_client(struct ipc_connection *ipc_c, const struct xrt_applic
 	return XRT_SUCCESS;
 }
 
+#ifdef XRT_OS_LINUX
+static xrt_result_t
+ipc_client_setup_ring(struct ipc_connection *ipc_c)
+{
+	xrt_shmem_handle_t handle = XRT_SHMEM_HANDLE_INVALID;
+	struct ipc_ring *ring = NULL;
+
+	xrt_result_t xret = ipc_call_instance_get_ring_fd(ipc_c, &handle, 1);
+	if (xret != XRT_SUCCESS) {
+		// Not fatal, without it everything goes over the socket.
+		IPC_WARN(ipc_c, "Service didn't give us a ring, using the socket for all calls.");
+		return XRT_SUCCESS;
+	}
+
+	// The service only reads the socket when told to on the ring from now on.
+	xret = ipc_shmem_map(handle, sizeof(struct ipc_ring), (void **)&ring);
+	if (xret != XRT_SUCCESS) {
+		IPC_ERROR(ipc_c, "Failed to map the ring!");
+		close(handle);
+		return xret;
+	}
+
+	ipc_c->ring = ring;
+	ipc_c->ring_handle = handle;
+
+	IPC_DEBUG(ipc_c, "Using the shared memory ring for calls without handles.");
+
+	return XRT_SUCCESS;
+}
+
+static bool
+ipc_client_service_hung_up(struct ipc_connection *ipc_c)
+{
+	char c;
+	return recv(ipc_c->imc.ipc_handle, &c, sizeof(c), MSG_PEEK | MSG_DONTWAIT) == 0;
+}
+
+static xrt_result_t
+ipc_client_ring_call(
+    struct ipc_connection *ipc_c, const void *data, uint32_t size, void *out_reply, uint32_t reply_size)
+{
+	int32_t seq = ipc_ring_client_post(ipc_c->ring, data, size);
+
+	// Wake up every now and then to check that the service is still there.
+	while (!ipc_ring_client_wait_reply(ipc_c->ring, seq, 100 * U_TIME_1MS_IN_NS)) {
+		if (ipc_client_service_hung_up(ipc_c)) {
+			IPC_ERROR(ipc_c, "Service disconnected while waiting for a reply!");
+			return XRT_ERROR_IPC_FAILURE;
+		}
+	}
+
+	if (!ipc_ring_client_read_reply(ipc_c->ring, out_reply, reply_size)) {
+		IPC_ERROR(ipc_c, "Reply on the ring has the wrong size!");
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	return XRT_SUCCESS;
+}
+#endif
+
+#ifndef XRT_OS_WINDOWS
+//! Sends the queued async commands on their own, when there is no room for more.
+static xrt_result_t
+ipc_client_flush_async_queue(struct ipc_connection *ipc_c)
+{
+	uint32_t size = ipc_c->async_queue_size;
+	ipc_c->async_queue_size = 0;
+
+#ifdef XRT_OS_LINUX
+	if (ipc_c->ring != NULL) {
+		// Replied to with an empty reply.
+		return ipc_client_ring_call(ipc_c, ipc_c->async_queue, size, NULL, 0);
+	}
+#endif
+
+	return ipc_send(&ipc_c->imc, ipc_c->async_queue, size);
+}
+#endif
+
 
 /*
  *
@@ -361,6 +527,7 @@ ipc_client_connection_init(struct ipc_connection *ipc_c,
 		U_LOG_E("Failed to init mutex!");
 		return XRT_ERROR_IPC_FAILURE;
 	}
+	os_mutex_set_name(&ipc_c->mutex, "ipc_connection::mutex");
 
 	// Connect the service.
 #ifdef XRT_OS_ANDROID
@@ -398,12 +565,31 @@ ipc_client_connection_init(struct ipc_connection *ipc_c,
 		goto err_fini; // Already logged.
 	}
 
-	// Do this last.
 	xret = ipc_client_describe_client(ipc_c, &i_info->app_info);
 	if (xret != XRT_SUCCESS) {
 		goto err_fini; // Already logged.
 	}
 
+	// Needed for the layer slot, also used to read per client data directly from the shared memory.
+	xret = ipc_call_instance_get_shared_client_index(ipc_c, &ipc_c->shared_client_index);
+	if (xret == XRT_SUCCESS && ipc_c->shared_client_index >= ipc_c->ism->max_clients) {
+		IPC_ERROR(ipc_c, "Invalid shared client index %u", ipc_c->shared_client_index);
+		xret = XRT_ERROR_IPC_FAILURE;
+	}
+	if (xret != XRT_SUCCESS) {
+		ipc_c->shared_client_index = UINT32_MAX;
+		goto err_fini; // Already logged.
+	}
+
+#ifdef XRT_OS_LINUX
+	if (debug_get_bool_option_ipc_shm_ring()) {
+		xret = ipc_client_setup_ring(ipc_c);
+		if (xret != XRT_SUCCESS) {
+			goto err_fini; // Already logged.
+		}
+	}
+#endif
+
 	return XRT_SUCCESS;
 
 err_fini:
@@ -418,6 +604,11 @@ ipc_client_connection_fini(struct ipc_connection *ipc_c)
 	if (ipc_c->ism_handle != XRT_SHMEM_HANDLE_INVALID) {
 		/// @todo how to tear down the shared memory?
 	}
+#ifdef XRT_OS_LINUX
+	if (ipc_c->ring != NULL) {
+		ipc_shmem_destroy(&ipc_c->ring_handle, (void **)&ipc_c->ring, sizeof(struct ipc_ring));
+	}
+#endif
 	ipc_message_channel_close(&ipc_c->imc);
 	os_mutex_destroy(&ipc_c->mutex);
 
@@ -425,3 +616,84 @@ ipc_client_connection_fini(struct ipc_connection *ipc_c)
 	ipc_client_android_destroy(&(ipc_c->ica));
 #endif
 }
+
+xrt_result_t
+ipc_client_send_and_receive(
+    struct ipc_connection *ipc_c, const void *msg, size_t msg_size, void *out_reply, size_t reply_size)
+{
+	const void *data = msg;
+	size_t size = msg_size;
+
+	// Send the queued async commands together with this one, there is always room for it.
+	if (ipc_c->async_queue_size > 0) {
+		assert(msg_size <= IPC_BUF_SIZE);
+		memcpy(&ipc_c->async_queue[ipc_c->async_queue_size], msg, msg_size);
+		data = ipc_c->async_queue;
+		size = ipc_c->async_queue_size + msg_size;
+		ipc_c->async_queue_size = 0;
+	}
+
+#ifdef XRT_OS_LINUX
+	if (ipc_c->ring != NULL) {
+		return ipc_client_ring_call(ipc_c, data, (uint32_t)size, out_reply, (uint32_t)reply_size);
+	}
+#endif
+
+	xrt_result_t xret = ipc_send(&ipc_c->imc, data, size);
+	if (xret != XRT_SUCCESS) {
+		return xret;
+	}
+
+	return ipc_receive(&ipc_c->imc, out_reply, reply_size);
+}
+
+xrt_result_t
+ipc_client_begin_socket_command(struct ipc_connection *ipc_c)
+{
+#ifdef XRT_OS_LINUX
+	if (ipc_c->ring != NULL) {
+		// Not replied to, the service reads the socket until a command that is.
+		ipc_ring_client_post(ipc_c->ring, NULL, 0);
+	}
+#endif
+
+	if (ipc_c->async_queue_size == 0) {
+		return XRT_SUCCESS;
+	}
+
+	uint32_t size = ipc_c->async_queue_size;
+	ipc_c->async_queue_size = 0;
+
+	return ipc_send(&ipc_c->imc, ipc_c->async_queue, size);
+}
+
+xrt_result_t
+ipc_client_queue_async(struct ipc_connection *ipc_c, const void *msg, size_t msg_size)
+{
+	xrt_result_t xret = XRT_SUCCESS;
+
+#ifdef XRT_OS_WINDOWS
+	// Every command must be its own pipe message, so only skip waiting for the reply.
+	xret = ipc_send(&ipc_c->imc, msg, msg_size);
+#else
+	if (ipc_c->async_queue_size + msg_size > IPC_ASYNC_QUEUE_SIZE) {
+		xret = ipc_client_flush_async_queue(ipc_c);
+	}
+
+	memcpy(&ipc_c->async_queue[ipc_c->async_queue_size], msg, msg_size);
+	ipc_c->async_queue_size += (uint32_t)msg_size;
+#endif
+
+	if (xret != XRT_SUCCESS) {
+		return xret;
+	}
+
+	// Report the failure of an earlier async command, the service only sets it if we have cleared it.
+	xrt_atomic_s32_t *async_result = &ipc_shared_async_results(ipc_c->ism)[ipc_c->shared_client_index];
+	int32_t result = xrt_atomic_s32_load_acquire(async_result);
+	if (result != XRT_SUCCESS) {
+		xrt_atomic_s32_cmpxchg(async_result, result, XRT_SUCCESS);
+	}
+
+	return (xrt_result_t)result;
+}
@@ -10,6 +10,11 @@
 #include "xrt/xrt_defines.h"
 #include "xrt/xrt_space.h"
 
+#include "math/m_space.h"
+
+#include "util/u_debug.h"
+
+#include "shared/ipc_seqlock.h"
 #include "shared/ipc_message_channel.h"
 
 #include "client/ipc_client.h"
@@ -19,6 +24,8 @@
 #include "ipc_client_generated.h"
 
 
+DEBUG_GET_ONCE_BOOL_OPTION(ipc_space_snapshot, "IPC_SPACE_SNAPSHOT", true)
+
 struct ipc_client_space
 {
 	struct xrt_space base;
@@ -35,6 +42,12 @@ struct ipc_client_space_overseer
 	struct ipc_connection *ipc_c;
 
 	struct xrt_reference ref_space_use[XRT_SPACE_REFERENCE_TYPE_COUNT];
+
+	/*!
+	 * Index into @ref ipc_shared_memory::space_snapshots for this client,
+	 * UINT32_MAX if snapshots are not used.
+	 */
+	uint32_t snapshot_index;
 };
 
 
@@ -57,6 +70,143 @@ ipc_client_space_overseer(struct xrt_space_overseer *xso)
 }
 
 
+/*!
+ * Interpolate the relation of a single space in the root space from the
+ * snapshot samples, @p at_timestamp_ns must be within the sampled range.
+ */
+static void
+interpolate_sample(struct xrt_space_relation samples[IPC_SPACE_SNAPSHOT_SAMPLE_COUNT],
+                   const int64_t timestamps_ns[IPC_SPACE_SNAPSHOT_SAMPLE_COUNT],
+                   int64_t at_timestamp_ns,
+                   struct xrt_space_relation *out_relation)
+{
+	uint32_t i = 1;
+	while (i < IPC_SPACE_SNAPSHOT_SAMPLE_COUNT - 1 && timestamps_ns[i] < at_timestamp_ns) {
+		i++;
+	}
+
+	int64_t before_ns = timestamps_ns[i - 1];
+	int64_t after_ns = timestamps_ns[i];
+
+	if (at_timestamp_ns == before_ns) {
+		*out_relation = samples[i - 1];
+		return;
+	}
+	if (at_timestamp_ns == after_ns) {
+		*out_relation = samples[i];
+		return;
+	}
+
+	float t = (float)(at_timestamp_ns - before_ns) / (float)(after_ns - before_ns);
+	enum xrt_space_relation_flags flags =
+	    (enum xrt_space_relation_flags)(samples[i - 1].relation_flags & samples[i].relation_flags);
+
+	*out_relation = (struct xrt_space_relation)XRT_SPACE_RELATION_ZERO;
+	m_space_relation_interpolate(&samples[i - 1], &samples[i], t, flags, out_relation);
+}
+
+/*!
+ * Try to locate @p space_id in @p base_space_id using the shared memory
+ * snapshot published by the service each frame, no IPC calls are made.
+ * Returns false if the snapshot can not be used, in which case the caller
+ * needs to ask the service.
+ */
+static bool
+try_locate_from_snapshot(struct ipc_client_space_overseer *icspo,
+                         uint32_t base_space_id,
+                         const struct xrt_pose *base_offset,
+                         int64_t at_timestamp_ns,
+                         uint32_t space_id,
+                         const struct xrt_pose *offset,
+                         struct xrt_space_relation *out_relation)
+{
+	struct ipc_shared_memory *ism = icspo->ipc_c->ism;
+
+	if (icspo->snapshot_index >= ism->max_clients) {
+		return false;
+	}
+	if (base_space_id >= IPC_MAX_SNAPSHOT_SPACES || space_id >= IPC_MAX_SNAPSHOT_SPACES) {
+		return false;
+	}
+
+	struct ipc_shared_space_snapshot *snap = &ipc_shared_space_snapshots(ism)[icspo->snapshot_index];
+
+	int64_t timestamps_ns[IPC_SPACE_SNAPSHOT_SAMPLE_COUNT];
+	struct xrt_space_relation base_samples[IPC_SPACE_SNAPSHOT_SAMPLE_COUNT];
+	struct xrt_space_relation space_samples[IPC_SPACE_SNAPSHOT_SAMPLE_COUNT];
+	bool consistent = false;
+
+	for (uint32_t tries = 0; tries < IPC_SEQLOCK_READ_TRIES && !consistent; tries++) {
+		int32_t gen = 0;
+		if (!ipc_seqlock_read_begin(&snap->generation, &gen)) {
+			continue;
+		}
+
+		if (snap->epoch != xrt_atomic_s32_load_acquire(&ism->space_snapshot_epoch) ||
+		    !snap->valid[base_space_id] || !snap->valid[space_id]) {
+			// Only trust the result if it wasn't torn.
+			if (ipc_seqlock_read_end(&snap->generation, gen)) {
+				return false;
+			}
+			continue;
+		}
+
+		for (uint32_t k = 0; k < IPC_SPACE_SNAPSHOT_SAMPLE_COUNT; k++) {
+			timestamps_ns[k] = snap->timestamps_ns[k];
+			base_samples[k] = snap->relations[base_space_id][k];
+			space_samples[k] = snap->relations[space_id][k];
+		}
+
+		consistent = ipc_seqlock_read_end(&snap->generation, gen);
+	}
+
+	if (!consistent) {
+		return false;
+	}
+
+	// Only interpolate, never extrapolate, the service does that better.
+	if (at_timestamp_ns < timestamps_ns[0] || at_timestamp_ns > timestamps_ns[IPC_SPACE_SNAPSHOT_SAMPLE_COUNT - 1]) {
+		return false;
+	}
+
+	struct xrt_relation_chain xrc = {0};
+
+	m_relation_chain_push_pose_if_not_identity(&xrc, offset);
+
+	// Same shortcut as the service, a space located in itself is only the offsets.
+	if (base_space_id != space_id) {
+		struct xrt_space_relation space_rel;
+		struct xrt_space_relation base_rel;
+
+		interpolate_sample(space_samples, timestamps_ns, at_timestamp_ns, &space_rel);
+		interpolate_sample(base_samples, timestamps_ns, at_timestamp_ns, &base_rel);
+
+		m_relation_chain_push_relation(&xrc, &space_rel);
+		m_relation_chain_push_inverted_relation(&xrc, &base_rel);
+	}
+
+	m_relation_chain_push_inverted_pose_if_not_identity(&xrc, base_offset);
+
+	if (xrc.step_count == 0) {
+		// A space chain with zero steps is always valid, same as the service.
+		out_relation->pose = (struct xrt_pose)XRT_POSE_IDENTITY;
+		out_relation->linear_velocity = (struct xrt_vec3)XRT_VEC3_ZERO;
+		out_relation->angular_velocity = (struct xrt_vec3)XRT_VEC3_ZERO;
+		out_relation->relation_flags =                     //
+		    XRT_SPACE_RELATION_ORIENTATION_VALID_BIT |     //
+		    XRT_SPACE_RELATION_ORIENTATION_TRACKED_BIT |   //
+		    XRT_SPACE_RELATION_POSITION_VALID_BIT |        //
+		    XRT_SPACE_RELATION_POSITION_TRACKED_BIT |      //
+		    XRT_SPACE_RELATION_LINEAR_VELOCITY_VALID_BIT | //
+		    XRT_SPACE_RELATION_ANGULAR_VELOCITY_VALID_BIT;
+	} else {
+		m_relation_chain_resolve(&xrc, out_relation);
+	}
+
+	return true;
+}
+
+
 /*
  *
  * Space member functions.
@@ -145,6 +295,17 @@ locate_space(struct xrt_space_overseer *xso,
 	struct ipc_client_space *icsp_base_space = ipc_client_space(base_space);
 	struct ipc_client_space *icsp_space = ipc_client_space(space);
 
+	if (try_locate_from_snapshot( //
+	        icspo,                //
+	        icsp_base_space->id,  //
+	        base_offset,          //
+	        at_timestamp_ns,      //
+	        icsp_space->id,       //
+	        offset,               //
+	        out_relation)) {      //
+		return XRT_SUCCESS;
+	}
+
 	xret = ipc_call_space_locate_space( //
 	    icspo->ipc_c,                   //
 	    icsp_base_space->id,            //
@@ -173,6 +334,27 @@ locate_spaces(struct xrt_space_overseer *xso,
 
 	struct ipc_client_space *icsp_base_space = ipc_client_space(base_space);
 
+	// Fast path, all of the spaces can be located from the snapshot.
+	bool all_located = true;
+	for (uint32_t i = 0; i < space_count && all_located; i++) {
+		if (spaces[i] == NULL) {
+			out_relations[i] = (struct xrt_space_relation)XRT_SPACE_RELATION_ZERO;
+			continue;
+		}
+
+		all_located = try_locate_from_snapshot( //
+		    icspo,                              //
+		    icsp_base_space->id,                //
+		    base_offset,                        //
+		    at_timestamp_ns,                    //
+		    ipc_client_space(spaces[i])->id,    //
+		    &offsets[i],                        //
+		    &out_relations[i]);                 //
+	}
+	if (all_located) {
+		return XRT_SUCCESS;
+	}
+
 	uint32_t *space_ids = U_TYPED_ARRAY_CALLOC(uint32_t, space_count);
 	if (space_ids == NULL) {
 		IPC_ERROR(ipc_c, "Failed to allocate space_ids");
@@ -375,6 +557,11 @@ ipc_client_space_overseer_create(struct ipc_connection *ipc_c)
 	icspo->base.set_reference_space_offset = set_reference_space_offset;
 	icspo->base.destroy = destroy;
 	icspo->ipc_c = ipc_c;
+	icspo->snapshot_index = UINT32_MAX;
+
+	if (debug_get_bool_option_ipc_space_snapshot()) {
+		icspo->snapshot_index = ipc_c->shared_client_index;
+	}
 
 #define CREATE(NAME)                                                                                                   \
 	do {                                                                                                           \
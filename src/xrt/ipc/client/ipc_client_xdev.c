@@ -1,4 +1,4 @@
-// Copyright 2020-2024, Collabora, Ltd.
+// Copyright 2020-2025, Collabora, Ltd.
 // Copyright 2025, NVIDIA CORPORATION.
 // SPDX-License-Identifier: BSL-1.0
 /*!
@@ -15,18 +15,376 @@
 #include "os/os_time.h"
 
 #include "math/m_api.h"
+#include "math/m_space.h"
+#include "math/m_predict.h"
 
 #include "util/u_var.h"
 #include "util/u_misc.h"
+#include "util/u_time.h"
 #include "util/u_debug.h"
 #include "util/u_device.h"
 
 #include "client/ipc_client.h"
 #include "client/ipc_client_connection.h"
 #include "client/ipc_client_xdev.h"
+#include "shared/ipc_seqlock.h"
 #include "ipc_client_generated.h"
 
 
+/*!
+ * How far past the latest published hand joints we predict locally, further
+ * than that it's better to let the driver do it.
+ */
+#define HAND_TRACKING_MAX_PREDICT_NS (50 * U_TIME_1MS_IN_NS)
+
+//! Same as @ref HAND_TRACKING_MAX_PREDICT_NS but for published face and body samples.
+#define BODY_FACE_TRACKING_MAX_AGE_NS (50 * U_TIME_1MS_IN_NS)
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+static void
+read_published_inputs(struct ipc_client_xdev *icx)
+{
+	struct ipc_connection *ipc_c = icx->ipc_c;
+	struct ipc_shared_memory *ism = ipc_c->ism;
+	struct ipc_shared_device *isdev = &ism->isdevs[icx->device_id];
+	struct xrt_input *src = &ipc_shared_inputs(ism)[isdev->first_input_index];
+	struct xrt_input *tmp = icx->published_scratch;
+	struct xrt_input *dst = icx->base.inputs;
+	uint32_t count = icx->base.input_count;
+	bool consistent = false;
+	int32_t gen = 0;
+
+	// Same rules as the service uses on the non-published path.
+	bool io_active = ipc_shared_client_io_active(ism)[ipc_c->shared_client_index] && isdev->io_active;
+
+	// The service only bumps the generation when an input changed.
+	if (icx->published.valid && icx->published.io_active == io_active &&
+	    xrt_atomic_s32_load_acquire(&isdev->input_generation) == icx->published.generation) {
+		return;
+	}
+
+	for (uint32_t tries = 0; tries < IPC_SEQLOCK_READ_TRIES && !consistent; tries++) {
+		if (!ipc_seqlock_read_begin(&isdev->input_generation, &gen)) {
+			continue;
+		}
+
+		memcpy(tmp, src, sizeof(struct xrt_input) * count);
+
+		consistent = ipc_seqlock_read_end(&isdev->input_generation, gen);
+	}
+
+	// Keep the last state, the service is probably stuck or gone.
+	if (!consistent) {
+		IPC_TRACE(ipc_c, "Failed to read inputs of device %u", icx->device_id);
+		return;
+	}
+
+	icx->published.valid = true;
+	icx->published.generation = gen;
+	icx->published.io_active = io_active;
+
+	if (io_active) {
+		memcpy(dst, tmp, sizeof(struct xrt_input) * count);
+		return;
+	}
+
+	memset(dst, 0, sizeof(struct xrt_input) * count);
+
+	for (uint32_t i = 0; i < count; i++) {
+		dst[i].name = tmp[i].name;
+
+		// Special case the rotation of the head.
+		if (dst[i].name == XRT_INPUT_GENERIC_HEAD_POSE) {
+			dst[i].active = tmp[i].active;
+		}
+	}
+}
+
+static struct ipc_shared_hand_tracker *
+find_hand_tracker(struct ipc_client_xdev *icx, enum xrt_input_name name)
+{
+	struct ipc_shared_memory *ism = icx->ipc_c->ism;
+
+	// Only published together with the inputs.
+	if (icx->published_scratch == NULL) {
+		return NULL;
+	}
+
+	for (uint32_t i = 0; i < ism->hand_trackers.count; i++) {
+		struct ipc_shared_hand_tracker *ist = &ipc_shared_hand_trackers(ism)[i];
+		if (ist->device_id == icx->device_id && ist->name == name) {
+			return ist;
+		}
+	}
+
+	return NULL;
+}
+
+static void
+interpolate_hand_joint_set(struct xrt_hand_joint_set *a,
+                           struct xrt_hand_joint_set *b,
+                           float t,
+                           struct xrt_hand_joint_set *out_value)
+{
+	// Nothing to blend with if the hand was lost or found in between, take the closest.
+	if (!a->is_active || !b->is_active) {
+		*out_value = t < 0.5f ? *a : *b;
+		return;
+	}
+
+	U_ZERO(out_value);
+
+	for (uint32_t i = 0; i < XRT_HAND_JOINT_COUNT; i++) {
+		struct xrt_hand_joint_value *ja = &a->values.hand_joint_set_default[i];
+		struct xrt_hand_joint_value *jb = &b->values.hand_joint_set_default[i];
+		struct xrt_hand_joint_value *out = &out_value->values.hand_joint_set_default[i];
+
+		enum xrt_space_relation_flags flags =
+		    (enum xrt_space_relation_flags)(ja->relation.relation_flags & jb->relation.relation_flags);
+		m_space_relation_interpolate(&ja->relation, &jb->relation, t, flags, &out->relation);
+		out->radius = ja->radius + (jb->radius - ja->radius) * t;
+	}
+
+	enum xrt_space_relation_flags flags =
+	    (enum xrt_space_relation_flags)(a->hand_pose.relation_flags & b->hand_pose.relation_flags);
+	m_space_relation_interpolate(&a->hand_pose, &b->hand_pose, t, flags, &out_value->hand_pose);
+	out_value->is_active = true;
+}
+
+static void
+predict_hand_joint_set(const struct xrt_hand_joint_set *value, int64_t delta_ns, struct xrt_hand_joint_set *out_value)
+{
+	double delta_s = time_ns_to_s(delta_ns);
+
+	*out_value = *value;
+	if (!value->is_active || delta_ns == 0) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < XRT_HAND_JOINT_COUNT; i++) {
+		m_predict_relation(&value->values.hand_joint_set_default[i].relation, delta_s,
+		                   &out_value->values.hand_joint_set_default[i].relation);
+	}
+
+	m_predict_relation(&value->hand_pose, delta_s, &out_value->hand_pose);
+}
+
+/*!
+ * Get the joints at @p at_timestamp_ns from the published samples, returns
+ * false if the time isn't covered by them and the service needs to be asked.
+ */
+static bool
+read_published_hand_tracking(struct ipc_shared_hand_tracker *ist,
+                             int64_t at_timestamp_ns,
+                             struct xrt_hand_joint_set *out_value,
+                             int64_t *out_timestamp_ns)
+{
+	// Big, but a lot cheaper than a round trip.
+	struct ipc_shared_hand_tracker tmp;
+	bool consistent = false;
+
+	for (uint32_t tries = 0; tries < IPC_SEQLOCK_READ_TRIES && !consistent; tries++) {
+		int32_t gen = 0;
+		if (!ipc_seqlock_read_begin(&ist->generation, &gen)) {
+			continue;
+		}
+
+		memcpy(&tmp, ist, sizeof(tmp));
+
+		consistent = ipc_seqlock_read_end(&ist->generation, gen);
+	}
+
+	if (!consistent || tmp.sample_count == 0) {
+		return false;
+	}
+
+	uint32_t available = tmp.sample_count;
+	if (available > IPC_HAND_TRACKER_SAMPLE_COUNT) {
+		available = IPC_HAND_TRACKER_SAMPLE_COUNT;
+	}
+
+	uint32_t latest = (tmp.sample_count - 1) % IPC_HAND_TRACKER_SAMPLE_COUNT;
+	int64_t latest_ns = tmp.timestamps_ns[latest];
+
+	if (at_timestamp_ns >= latest_ns) {
+		int64_t delta_ns = at_timestamp_ns - latest_ns;
+		if (delta_ns > HAND_TRACKING_MAX_PREDICT_NS) {
+			return false;
+		}
+
+		predict_hand_joint_set(&tmp.values[latest], delta_ns, out_value);
+		*out_timestamp_ns = at_timestamp_ns;
+		return true;
+	}
+
+	// Walk back from the latest sample to the pair that covers the time.
+	for (uint32_t i = 1; i < available; i++) {
+		uint32_t after = (tmp.sample_count - i) % IPC_HAND_TRACKER_SAMPLE_COUNT;
+		uint32_t before = (tmp.sample_count - i - 1) % IPC_HAND_TRACKER_SAMPLE_COUNT;
+		int64_t before_ns = tmp.timestamps_ns[before];
+		int64_t after_ns = tmp.timestamps_ns[after];
+
+		if (at_timestamp_ns < before_ns) {
+			continue;
+		}
+
+		float t = (float)(at_timestamp_ns - before_ns) / (float)(after_ns - before_ns);
+		interpolate_hand_joint_set(&tmp.values[before], &tmp.values[after], t, out_value);
+		*out_timestamp_ns = at_timestamp_ns;
+		return true;
+	}
+
+	// Older than what we have.
+	return false;
+}
+
+static struct ipc_shared_body_face_tracker *
+find_body_face_tracker(struct ipc_client_xdev *icx, enum xrt_input_name name)
+{
+	struct ipc_shared_memory *ism = icx->ipc_c->ism;
+
+	// Only published together with the inputs.
+	if (icx->published_scratch == NULL) {
+		return NULL;
+	}
+
+	for (uint32_t i = 0; i < ism->body_face_trackers.count; i++) {
+		struct ipc_shared_body_face_tracker *ist = &ipc_shared_body_face_trackers(ism)[i];
+		if (ist->device_id == icx->device_id && ist->name == name) {
+			return ist;
+		}
+	}
+
+	return NULL;
+}
+
+/*!
+ * Copy the latest published face or body sample, only the @p max_size bytes
+ * at most that the input's type uses rather than the whole union. The body
+ * pose is copied to @p out_body_pose if not NULL. Returns false if there is
+ * no consistent sample.
+ */
+static bool
+read_published_body_face(struct ipc_shared_body_face_tracker *ist,
+                         void *out_value,
+                         size_t max_size,
+                         struct xrt_space_relation *out_body_pose,
+                         int64_t *out_timestamp_ns,
+                         bool *out_active)
+{
+	// Set by the service at startup, but this is shared memory.
+	size_t size = ist->value_size < max_size ? ist->value_size : max_size;
+	const void *src = out_body_pose != NULL ? (const void *)&ist->body : (const void *)&ist->face;
+
+	for (uint32_t tries = 0; tries < IPC_SEQLOCK_READ_TRIES; tries++) {
+		int32_t gen = 0;
+		if (!ipc_seqlock_read_begin(&ist->generation, &gen)) {
+			continue;
+		}
+
+		uint32_t sample_count = ist->sample_count;
+		*out_timestamp_ns = ist->timestamp_ns;
+		*out_active = ist->active;
+		memcpy(out_value, src, size);
+		if (out_body_pose != NULL) {
+			*out_body_pose = ist->body.body_pose;
+		}
+
+		if (ipc_seqlock_read_end(&ist->generation, gen)) {
+			return sample_count > 0;
+		}
+	}
+
+	return false;
+}
+
+static bool
+read_published_face_tracking(struct ipc_shared_body_face_tracker *ist,
+                             int64_t at_timestamp_ns,
+                             struct xrt_facial_expression_set *out_value)
+{
+	int64_t timestamp_ns = 0;
+	bool active = false;
+	if (!read_published_body_face(ist, out_value, sizeof(*out_value), NULL, &timestamp_ns, &active)) {
+		return false;
+	}
+
+	// Weights can't be predicted, use the sample if it's close enough to the time asked for.
+	int64_t delta_ns = at_timestamp_ns - timestamp_ns;
+	return !active || (delta_ns >= -BODY_FACE_TRACKING_MAX_AGE_NS && delta_ns <= BODY_FACE_TRACKING_MAX_AGE_NS);
+}
+
+static bool
+read_published_body_joints(struct ipc_shared_body_face_tracker *ist,
+                           int64_t at_timestamp_ns,
+                           struct xrt_body_joint_set *out_value)
+{
+	int64_t timestamp_ns = 0;
+	bool active = false;
+	if (!read_published_body_face(ist, out_value, offsetof(struct xrt_body_joint_set, body_pose),
+	                              &out_value->body_pose, &timestamp_ns, &active)) {
+		return false;
+	}
+
+	if (!active) {
+		return true;
+	}
+
+	int64_t delta_ns = at_timestamp_ns - timestamp_ns;
+	if (delta_ns < 0 || delta_ns > BODY_FACE_TRACKING_MAX_AGE_NS) {
+		return false;
+	}
+
+	if (delta_ns == 0) {
+		return true;
+	}
+
+	uint32_t joint_count = 0;
+	struct xrt_body_joint_location_fb *joints = NULL;
+	if (ist->name == XRT_INPUT_FB_BODY_TRACKING) {
+		joint_count = XRT_BODY_JOINT_COUNT_FB;
+		joints = out_value->body_joint_set_fb.joint_locations;
+	} else if (ist->name == XRT_INPUT_META_FULL_BODY_TRACKING) {
+		joint_count = XRT_FULL_BODY_JOINT_COUNT_META;
+		joints = out_value->full_body_joint_set_meta.joint_locations;
+	} else {
+		return false;
+	}
+
+	double delta_s = time_ns_to_s(delta_ns);
+	for (uint32_t i = 0; i < joint_count; i++) {
+		struct xrt_space_relation rel = joints[i].relation;
+		m_predict_relation(&rel, delta_s, &joints[i].relation);
+	}
+
+	struct xrt_space_relation body_pose = out_value->body_pose;
+	m_predict_relation(&body_pose, delta_s, &out_value->body_pose);
+	out_value->base_body_joint_set_meta.sample_time_ns = at_timestamp_ns;
+
+	return true;
+}
+
+//! Forget the cached skeleton if the joints say it has changed.
+static void
+check_body_skeleton_changed(struct ipc_client_xdev *icx,
+                            enum xrt_input_name body_tracking_type,
+                            const struct xrt_body_joint_set *value)
+{
+	uint32_t changed_count = value->base_body_joint_set_meta.skeleton_changed_count;
+
+	if (icx->body_skeleton.name == body_tracking_type && icx->body_skeleton.changed_count != changed_count) {
+		icx->body_skeleton.valid = false;
+		icx->body_skeleton.changed_count = changed_count;
+	}
+}
+
+
 /*
  *
  * Functions from xrt_device.
@@ -38,6 +396,12 @@ ipc_client_xdev_update_inputs(struct xrt_device *xdev)
 {
 	struct ipc_client_xdev *icx = ipc_client_xdev(xdev);
 
+	// No need to talk to the service, it keeps the inputs up to date.
+	if (icx->published_scratch != NULL) {
+		read_published_inputs(icx);
+		return XRT_SUCCESS;
+	}
+
 	xrt_result_t xret = ipc_call_device_update_input(icx->ipc_c, icx->device_id);
 	IPC_CHK_ALWAYS_RET(icx->ipc_c, xret, "ipc_call_device_update_input");
 }
@@ -68,6 +432,11 @@ ipc_client_xdev_get_hand_tracking(struct xrt_device *xdev,
 {
 	struct ipc_client_xdev *icx = ipc_client_xdev(xdev);
 
+	struct ipc_shared_hand_tracker *ist = find_hand_tracker(icx, name);
+	if (ist != NULL && read_published_hand_tracking(ist, at_timestamp_ns, out_value, out_timestamp_ns)) {
+		return XRT_SUCCESS;
+	}
+
 	xrt_result_t xret = ipc_call_device_get_hand_tracking( //
 	    icx->ipc_c,                                        //
 	    icx->device_id,                                    //
@@ -86,6 +455,11 @@ ipc_client_xdev_get_face_tracking(struct xrt_device *xdev,
 {
 	struct ipc_client_xdev *icx = ipc_client_xdev(xdev);
 
+	struct ipc_shared_body_face_tracker *ist = find_body_face_tracker(icx, facial_expression_type);
+	if (ist != NULL && read_published_face_tracking(ist, at_timestamp_ns, out_value)) {
+		return XRT_SUCCESS;
+	}
+
 	xrt_result_t xret = ipc_call_device_get_face_tracking( //
 	    icx->ipc_c,                                        //
 	    icx->device_id,                                    //
@@ -102,12 +476,27 @@ ipc_client_xdev_get_body_skeleton(struct xrt_device *xdev,
 {
 	struct ipc_client_xdev *icx = ipc_client_xdev(xdev);
 
+	if (icx->body_skeleton.valid && icx->body_skeleton.name == body_tracking_type) {
+		*out_value = icx->body_skeleton.value;
+		return XRT_SUCCESS;
+	}
+
 	xrt_result_t xret = ipc_call_device_get_body_skeleton( //
 	    icx->ipc_c,                                        //
 	    icx->device_id,                                    //
 	    body_tracking_type,                                //
 	    out_value);                                        //
-	IPC_CHK_ALWAYS_RET(icx->ipc_c, xret, "ipc_call_device_get_body_skeleton");
+	IPC_CHK_WITH_RET(icx->ipc_c, xret, "ipc_call_device_get_body_skeleton", xret);
+
+	// Keeps the changed count seen from the joints if the type is the same.
+	if (icx->body_skeleton.name != body_tracking_type) {
+		icx->body_skeleton.name = body_tracking_type;
+		icx->body_skeleton.changed_count = 0;
+	}
+	icx->body_skeleton.value = *out_value;
+	icx->body_skeleton.valid = true;
+
+	return XRT_SUCCESS;
 }
 
 static xrt_result_t
@@ -118,13 +507,23 @@ ipc_client_xdev_get_body_joints(struct xrt_device *xdev,
 {
 	struct ipc_client_xdev *icx = ipc_client_xdev(xdev);
 
+	struct ipc_shared_body_face_tracker *ist = find_body_face_tracker(icx, body_tracking_type);
+	if (ist != NULL && read_published_body_joints(ist, desired_timestamp_ns, out_value)) {
+		check_body_skeleton_changed(icx, body_tracking_type, out_value);
+		return XRT_SUCCESS;
+	}
+
 	xrt_result_t xret = ipc_call_device_get_body_joints( //
 	    icx->ipc_c,                                      //
 	    icx->device_id,                                  //
 	    body_tracking_type,                              //
 	    desired_timestamp_ns,                            //
 	    out_value);                                      //
-	IPC_CHK_ALWAYS_RET(icx->ipc_c, xret, "ipc_call_device_get_body_joints");
+	IPC_CHK_WITH_RET(icx->ipc_c, xret, "ipc_call_device_get_body_joints", xret);
+
+	check_body_skeleton_changed(icx, body_tracking_type, out_value);
+
+	return XRT_SUCCESS;
 }
 
 static xrt_result_t
@@ -299,21 +698,43 @@ ipc_client_xdev_get_plane_detections_ext(struct xrt_device *xdev,
 
 	ipc_client_connection_lock(ipc_c);
 
-	xrt_result_t xret = ipc_send_device_get_plane_detections_ext_locked(ipc_c, icx->device_id, plane_detection_id);
+	// Lets the service skip sending the contents if we already have them.
+	uint64_t known_revision = out_detections->revision;
+
+	xrt_result_t xret = ipc_send_device_get_plane_detections_ext_locked( //
+	    ipc_c,                                                           //
+	    icx->device_id,                                                  //
+	    plane_detection_id,                                              //
+	    known_revision);                                                 //
 	IPC_CHK_WITH_GOTO(icx->ipc_c, xret, "ipc_send_device_get_plane_detections_ext_locked", out);
 
 	// in this case, size == count
 	uint32_t location_size = 0;
 	uint32_t polygon_size = 0;
 	uint32_t vertex_size = 0;
-
-	xret = ipc_receive_device_get_plane_detections_ext_locked(ipc_c, &location_size, &polygon_size, &vertex_size);
+	uint64_t revision = 0;
+
+	xret = ipc_receive_device_get_plane_detections_ext_locked( //
+	    ipc_c,                                                 //
+	    &location_size,                                        //
+	    &polygon_size,                                         //
+	    &vertex_size,                                          //
+	    &revision);                                            //
 	IPC_CHK_WITH_GOTO(icx->ipc_c, xret, "ipc_receive_device_get_plane_detections_ext_locked", out);
 
+	// Unchanged, nothing else is sent.
+	if (known_revision != 0 && revision == known_revision) {
+		goto out;
+	}
+
+	// Only set once everything has been received.
+	out_detections->revision = 0;
+
 
 	// With no locations, the service won't send anything else
 	if (location_size < 1) {
 		out_detections->location_count = 0;
+		out_detections->revision = revision;
 		goto out;
 	}
 
@@ -375,6 +796,8 @@ ipc_client_xdev_get_plane_detections_ext(struct xrt_device *xdev,
 		IPC_CHK_WITH_GOTO(icx->ipc_c, xret, "ipc_receive(4)", out);
 	}
 
+	out_detections->revision = revision;
+
 out:
 	ipc_client_connection_unlock(ipc_c);
 	return xret;
@@ -438,15 +861,22 @@ ipc_client_xdev_init(struct ipc_client_xdev *icx,
 	snprintf(icx->base.str, XRT_DEVICE_NAME_LEN, "%s", isdev->str);
 	snprintf(icx->base.serial, XRT_DEVICE_NAME_LEN, "%s", isdev->serial);
 
-	// Setup inputs, by pointing directly to the shared memory.
+	// Setup inputs, if published by the service we read a copy of them.
 	assert(isdev->input_count > 0);
-	icx->base.inputs = &ism->inputs[isdev->first_input_index];
 	icx->base.input_count = isdev->input_count;
+	if (ism->inputs_published && ipc_c->shared_client_index < ism->max_clients) {
+		icx->base.inputs = U_TYPED_ARRAY_CALLOC(struct xrt_input, isdev->input_count);
+		icx->published_scratch = U_TYPED_ARRAY_CALLOC(struct xrt_input, isdev->input_count);
+		read_published_inputs(icx);
+	} else {
+		// Otherwise point directly to the shared memory.
+		icx->base.inputs = &ipc_shared_inputs(ism)[isdev->first_input_index];
+	}
 
 	// Setup outputs, if any point directly into the shared memory.
 	icx->base.output_count = isdev->output_count;
 	if (isdev->output_count > 0) {
-		icx->base.outputs = &ism->outputs[isdev->first_output_index];
+		icx->base.outputs = &ipc_shared_outputs(ism)[isdev->first_output_index];
 	} else {
 		icx->base.outputs = NULL;
 	}
@@ -461,15 +891,15 @@ ipc_client_xdev_init(struct ipc_client_xdev *icx,
 	for (size_t i = 0; i < isdev->binding_profile_count; i++) {
 		struct xrt_binding_profile *xbp = &icx->base.binding_profiles[i];
 		struct ipc_shared_binding_profile *isbp =
-		    &ism->binding_profiles[isdev->first_binding_profile_index + i];
+		    &ipc_shared_binding_profiles(ism)[isdev->first_binding_profile_index + i];
 
 		xbp->name = isbp->name;
 		if (isbp->input_count > 0) {
-			xbp->inputs = &ism->input_pairs[isbp->first_input_index];
+			xbp->inputs = &ipc_shared_input_pairs(ism)[isbp->first_input_index];
 			xbp->input_count = isbp->input_count;
 		}
 		if (isbp->output_count > 0) {
-			xbp->outputs = &ism->output_pairs[isbp->first_output_index];
+			xbp->outputs = &ipc_shared_output_pairs(ism)[isbp->first_output_index];
 			xbp->output_count = isbp->output_count;
 		}
 	}
@@ -478,6 +908,13 @@ ipc_client_xdev_init(struct ipc_client_xdev *icx,
 void
 ipc_client_xdev_fini(struct ipc_client_xdev *icx)
 {
+	// We own the inputs only if they are copies of the published inputs.
+	if (icx->published_scratch != NULL) {
+		free(icx->base.inputs);
+		free(icx->published_scratch);
+		icx->published_scratch = NULL;
+	}
+
 	// We do not own these, so don't free them.
 	icx->base.inputs = NULL;
 	icx->base.outputs = NULL;
@@ -33,6 +33,33 @@ struct ipc_client_xdev
 	struct ipc_connection *ipc_c;
 
 	uint32_t device_id;
+
+	/*!
+	 * Set if the service publishes inputs into the shared memory, then
+	 * @ref xrt_device::inputs is our own copy and this is where a coherent
+	 * copy is read to before it is handed out.
+	 */
+	struct xrt_input *published_scratch;
+
+	//! What @ref xrt_device::inputs was last read from, to skip reading when nothing changed.
+	struct
+	{
+		bool valid;
+		bool io_active;
+		int32_t generation;
+	} published;
+
+	/*!
+	 * The last body skeleton got from the service, it only changes together
+	 * with the skeleton_changed_count of the body joints.
+	 */
+	struct
+	{
+		bool valid;
+		enum xrt_input_name name;
+		uint32_t changed_count;
+		struct xrt_body_skeleton value;
+	} body_skeleton;
 };
 
 /*!
@@ -1,4 +1,4 @@
-// Copyright 2020-2023, Collabora, Ltd.
+// Copyright 2020-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -13,11 +13,13 @@
 
 #include "xrt/xrt_compiler.h"
 #include "xrt/xrt_limits.h"
+#include "xrt/xrt_plane_detector.h"
 #include "xrt/xrt_space.h"
 #include "xrt/xrt_system.h"
 
 #include "os/os_threading.h"
 
+#include "util/u_time.h"
 #include "util/u_logging.h"
 
 #include "shared/ipc_protocol.h"
@@ -56,12 +58,13 @@ extern "C" {
  */
 
 #define IPC_MAX_CLIENT_SEMAPHORES 8
-#define IPC_MAX_CLIENT_SWAPCHAINS (XRT_MAX_LAYERS * 2)
 #define IPC_MAX_CLIENT_SPACES 128
 
 struct xrt_instance;
 struct xrt_compositor;
 struct xrt_compositor_native;
+struct ipc_ring;
+struct ipc_record_writer;
 
 
 /*!
@@ -76,6 +79,9 @@ struct ipc_swapchain_data
 	uint64_t format;
 	uint32_t image_count;
 
+	//! Sum of the sizes of the images, 0 if the allocator doesn't report them.
+	uint64_t memory_size;
+
 	bool active;
 };
 
@@ -107,6 +113,9 @@ struct ipc_client_state
 	//! Data for the swapchains.
 	struct ipc_swapchain_data swapchain_data[IPC_MAX_CLIENT_SWAPCHAINS];
 
+	//! Total memory of all of the client's swapchains.
+	uint64_t swapchain_memory_size;
+
 	//! Number of compositor semaphores in use by client
 	uint32_t compositor_semaphore_count;
 
@@ -156,7 +165,31 @@ struct ipc_client_state
 	//! Array of xrt_devices with plane_detection_size entries.
 	struct xrt_device **plane_detection_xdev;
 
+	/*!
+	 * The plane detections last sent to the client, the payload is skipped
+	 * when it asks for them again and already has this revision.
+	 */
+	struct
+	{
+		uint64_t plane_detection_id;
+		uint64_t revision;
+		struct xrt_plane_detections_ext detections;
+	} plane_detections_sent;
+
 	int server_thread_index;
+
+	//! Shared memory channel set up by the client, NULL if it only uses the socket.
+	struct ipc_ring *ring;
+	xrt_shmem_handle_t ring_handle;
+
+	//! Sequence number of the ring command being dispatched.
+	int32_t ring_seq;
+
+	//! Should the reply of the command being dispatched go on the ring.
+	bool reply_on_ring;
+
+	//! Records the calls of this client to a file, NULL unless IPC_RECORD is set.
+	struct ipc_record_writer *recorder;
 };
 
 enum ipc_thread_state
@@ -172,8 +205,67 @@ struct ipc_thread
 	struct os_thread thread;
 	volatile enum ipc_thread_state state;
 	volatile struct ipc_client_state ics;
+
+	//! The client is served by the mainloop dispatcher, @ref thread is not used.
+	bool dispatched;
+};
+
+
+//! How far apart display times may be for clients to share view poses.
+#define IPC_VIEW_POSE_CACHE_TOLERANCE_NS (U_TIME_1MS_IN_NS)
+
+//! View poses older than this are predicted again, so they use newer tracking data.
+#define IPC_VIEW_POSE_CACHE_MAX_AGE_NS (4 * U_TIME_1MS_IN_NS)
+
+/*!
+ * The latest view poses gotten from a device, clients asking for about the
+ * same display time get these instead of the device predicting them again.
+ *
+ * @ingroup ipc_server
+ */
+struct ipc_view_pose_cache
+{
+	//! Protects all other fields, held while asking the device.
+	struct os_mutex mutex;
+
+	bool valid;
+
+	//! When the poses were gotten from the device.
+	int64_t gotten_ns;
+
+	//! Arguments the poses were gotten with.
+	int64_t at_timestamp_ns;
+	uint32_t view_count;
+	struct xrt_vec3 default_eye_relation;
+
+	struct xrt_space_relation head_relation;
+	struct xrt_fov fovs[IPC_MAX_RAW_VIEWS];
+	struct xrt_pose poses[IPC_MAX_RAW_VIEWS];
 };
 
+//! Number of @ref xrt_visibility_mask_type values, which start at one.
+#define IPC_VISIBILITY_MASK_TYPE_COUNT (3)
+
+/*!
+ * Visibility masks gotten from a device, kept until the FOV of the view they
+ * were made for changes since clients ask for them again and again.
+ *
+ * @ingroup ipc_server
+ */
+struct ipc_visibility_mask_cache
+{
+	//! Protects the entries.
+	struct os_mutex mutex;
+
+	struct
+	{
+		//! FOV of the view when @p mask was made.
+		struct xrt_fov fov;
+
+		//! Owned by the cache, NULL if not gotten yet.
+		struct xrt_visibility_mask *mask;
+	} entries[XRT_MAX_VIEWS][IPC_VISIBILITY_MASK_TYPE_COUNT];
+};
 
 /*!
  *
@@ -185,8 +277,44 @@ struct ipc_device
 
 	//! Is the IO suppressed for this device.
 	bool io_active;
+
+	//! Only valid if @p xdev is not NULL.
+	struct ipc_view_pose_cache view_pose_cache;
+
+	//! Only valid if @p xdev is not NULL.
+	struct ipc_visibility_mask_cache visibility_mask_cache;
 };
 
+#if (defined(XRT_OS_LINUX) && !defined(XRT_OS_ANDROID)) || defined(XRT_DOXYGEN)
+//! Max number of worker threads of the client dispatcher.
+#define IPC_MAX_DISPATCH_WORKERS 8
+
+/*!
+ * A client that has a command, or has hung up, waiting for a worker.
+ *
+ * @ingroup ipc_server
+ */
+struct ipc_dispatch_entry
+{
+	volatile struct ipc_client_state *ics;
+
+	//! The epoll events, zero if queued because the dispatcher is stopping.
+	uint32_t events;
+};
+
+/*!
+ * FIFO of clients waiting for a worker, a client is queued at most once.
+ *
+ * @ingroup ipc_server
+ */
+struct ipc_dispatch_queue
+{
+	struct ipc_dispatch_entry entries[IPC_MAX_CLIENTS];
+	uint32_t head;
+	uint32_t count;
+};
+#endif
+
 /*!
  * Platform-specific mainloop object for the IPC server.
  *
@@ -282,6 +410,54 @@ struct ipc_server_mainloop
 	//! The socket filename we bound to, if any.
 	char *socket_filename;
 
+	/*!
+	 * Serves all clients from a small pool of worker threads instead of
+	 * one thread per client, enabled with IPC_DISPATCH_THREADS.
+	 */
+	struct
+	{
+		//! Number of worker threads, zero if the dispatcher is disabled.
+		uint32_t worker_count;
+
+		//! All client sockets, armed with EPOLLONESHOT.
+		int epoll_fd;
+
+		//! Waits on @ref epoll_fd and queues the clients that are ready.
+		struct os_thread thread;
+
+		struct os_thread workers[IPC_MAX_DISPATCH_WORKERS];
+
+		//! Protects all fields below.
+		struct os_mutex mutex;
+
+		//! Signalled when a client is queued or the dispatcher stops.
+		struct os_cond cond;
+
+		//! Set from the first client, used to notice the server stopping.
+		struct ipc_server *server;
+
+		//! Cleared when stopping, no client is re-armed after that.
+		bool running;
+
+		//! Set once the dispatcher thread has queued all idle clients for shutdown.
+		bool stopped;
+
+		//! Registered clients, indexed by server_thread_index.
+		volatile struct ipc_client_state *clients[IPC_MAX_CLIENTS];
+
+		//! Is the client queued or being handled by a worker.
+		bool busy[IPC_MAX_CLIENTS];
+
+		//! Clients with a compositor, these submit frames.
+		struct ipc_dispatch_queue frame_queue;
+
+		//! All other clients.
+		struct ipc_dispatch_queue control_queue;
+
+		//! Number of workers handling clients from @ref control_queue.
+		uint32_t control_busy_count;
+	} dispatch;
+
 	/*! @} */
 
 #define XRT_IPC_GOT_IMPL
@@ -299,6 +475,15 @@ struct ipc_server_mainloop
 	//! Name of the Pipe that we accept connections on.
 	char *pipe_name;
 
+	//! Overlapped ConnectNamedPipe on @ref pipe_handle, valid while @ref connect_pending.
+	OVERLAPPED connect_overlapped;
+
+	//! Signalled when a client connects to @ref pipe_handle.
+	HANDLE connect_event;
+
+	//! Is a ConnectNamedPipe in flight.
+	bool connect_pending;
+
 	/*! @} */
 
 #define XRT_IPC_GOT_IMPL
@@ -325,6 +510,18 @@ ipc_server_mainloop_deinit(struct ipc_server_mainloop *ml);
 int
 ipc_server_mainloop_init(struct ipc_server_mainloop *ml);
 
+#if (defined(XRT_OS_LINUX) && !defined(XRT_OS_ANDROID)) || defined(XRT_DOXYGEN)
+/*!
+ * Hand a newly connected client over to the dispatcher, called with the
+ * global state lock held.
+ *
+ * @return false if the dispatcher is disabled, the client needs a thread then.
+ * @public @memberof ipc_server_mainloop
+ */
+bool
+ipc_server_mainloop_add_client(struct ipc_server_mainloop *ml, volatile struct ipc_client_state *ics);
+#endif
+
 /*!
  * @brief Poll the mainloop.
  *
@@ -366,6 +563,9 @@ struct ipc_server
 	struct ipc_shared_memory *ism;
 	xrt_shmem_handle_t ism_handle;
 
+	//! Size of the shared memory mapping, see @ref ipc_shared_memory::size.
+	size_t ism_size;
+
 	struct ipc_server_mainloop ml;
 
 	// Is the mainloop supposed to run.
@@ -385,13 +585,46 @@ struct ipc_server
 
 	enum u_logging_level log_level;
 
-	struct ipc_thread threads[IPC_MAX_CLIENTS];
+	//! Max number of clients, set at startup, at most @ref IPC_MAX_CLIENTS.
+	uint32_t max_clients;
 
-	volatile uint32_t current_slot_index;
+	//! One thread for each client, @ref max_clients of them.
+	struct ipc_thread *threads;
 
 	//! Generator for IDs.
 	uint32_t id_generator;
 
+	/*!
+	 * Thread that continuously publishes the inputs of all devices into the
+	 * shared memory, see @ref ipc_shared_memory::inputs_published.
+	 */
+	struct
+	{
+		struct os_thread_helper oth;
+
+		//! Time between each publish, zero if publishing is disabled.
+		uint64_t interval_ns;
+	} input_publisher;
+
+	/*!
+	 * Warm standby keeps the native compositor session, and with it the
+	 * target, as well as any device features used by clients alive after
+	 * the last client is gone, so the next client starts quickly.
+	 */
+	struct
+	{
+		bool enabled;
+
+		//! Features the server has kept in use, protected by the global state lock.
+		bool device_feature_used[XRT_DEVICE_FEATURE_MAX_ENUM];
+	} warm_standby;
+
+	//! Share view poses between clients, see @ref ipc_view_pose_cache.
+	struct
+	{
+		bool enabled;
+	} view_pose_cache;
+
 	struct
 	{
 		int active_client_index;
@@ -413,6 +646,48 @@ struct ipc_server
 xrt_result_t
 ipc_server_get_client_app_state(struct ipc_server *s, uint32_t client_id, struct ipc_app_state *out_ias);
 
+/*!
+ * Get the frame timing statistics of a client, zeroed if the client has no
+ * session yet.
+ *
+ * @ingroup ipc_server
+ */
+xrt_result_t
+ipc_server_get_client_frame_stats(struct ipc_server *s,
+                                  uint32_t client_id,
+                                  struct xrt_compositor_frame_stats *out_stats);
+
+/*!
+ * Get the view poses of a device, shared between clients asking for about the
+ * same display time, see @ref ipc_view_pose_cache. Same arguments as
+ * @ref xrt_device_get_view_poses, @p view_count is at most @ref IPC_MAX_RAW_VIEWS.
+ *
+ * @ingroup ipc_server
+ */
+xrt_result_t
+ipc_server_get_view_poses(struct ipc_server *s,
+                          uint32_t device_id,
+                          const struct xrt_vec3 *default_eye_relation,
+                          int64_t at_timestamp_ns,
+                          uint32_t view_count,
+                          struct xrt_space_relation *out_head_relation,
+                          struct xrt_fov *out_fovs,
+                          struct xrt_pose *out_poses);
+
+/*!
+ * Get a copy of the visibility mask of a device view, made once and then
+ * kept until the FOV of the view changes, see @ref ipc_visibility_mask_cache.
+ * The caller frees @p out_mask.
+ *
+ * @ingroup ipc_server
+ */
+xrt_result_t
+ipc_server_get_visibility_mask(struct ipc_server *s,
+                               uint32_t device_id,
+                               enum xrt_visibility_mask_type type,
+                               uint32_t view_index,
+                               struct xrt_visibility_mask **out_mask);
+
 /*!
  * Set the new active client.
  *
@@ -461,6 +736,54 @@ ipc_server_update_state(struct ipc_server *s);
 void *
 ipc_server_client_thread(void *_ics);
 
+/*!
+ * Send the reply of the command being dispatched, goes on the client's ring if
+ * the command came from there and over the socket otherwise.
+ *
+ * @ingroup ipc_server
+ */
+xrt_result_t
+ipc_server_send_reply(volatile struct ipc_client_state *ics, const void *data, size_t size);
+
+/*!
+ * Async calls are not replied to, a failure is instead stored in the shared
+ * memory for the client to report from a later async call.
+ *
+ * @ingroup ipc_server
+ */
+void
+ipc_server_record_async_result(volatile struct ipc_client_state *ics, xrt_result_t result);
+
+/*!
+ * Wake the client up if it sleeps in wait frame, it then returns from the wait
+ * straight away. Used when the frame it waits for will never come.
+ *
+ * @ingroup ipc_server
+ */
+void
+ipc_server_client_wake_frame(volatile struct ipc_client_state *ics);
+
+#ifndef XRT_OS_WINDOWS
+/*!
+ * Read and dispatch one command, used by the mainloop dispatcher instead of
+ * @ref ipc_server_client_thread.
+ *
+ * @return false if the client should be disconnected.
+ * @ingroup ipc_server
+ */
+bool
+ipc_server_client_dispatch_one(volatile struct ipc_client_state *ics);
+
+/*!
+ * Disconnects a client served by the mainloop dispatcher and frees its slot,
+ * the fd must already be removed from any epoll set.
+ *
+ * @ingroup ipc_server
+ */
+void
+ipc_server_client_shutdown_dispatched(volatile struct ipc_client_state *ics);
+#endif
+
 /*!
  * This destroys the native compositor for this client and any extra objects
  * created from it, like all of the swapchains.
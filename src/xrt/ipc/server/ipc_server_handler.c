@@ -1,4 +1,4 @@
-// Copyright 2020-2024, Collabora, Ltd.
+// Copyright 2020-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -10,11 +10,15 @@
  */
 
 #include "util/u_misc.h"
+#include "util/u_debug.h"
 #include "util/u_handles.h"
 #include "util/u_pretty_print.h"
-#include "util/u_visibility_mask.h"
 #include "util/u_trace_marker.h"
 
+#include "shared/ipc_shmem.h"
+#include "shared/ipc_seqlock.h"
+#include "shared/ipc_record.h"
+
 #include "server/ipc_server.h"
 #include "ipc_server_generated.h"
 #include "xrt/xrt_device.h"
@@ -24,6 +28,16 @@
 #include <unistd.h>
 #endif
 
+#ifdef XRT_OS_LINUX
+#include "util/u_linux.h"
+#include "shared/ipc_ring.h"
+#include "shared/ipc_futex.h"
+#endif
+
+
+DEBUG_GET_ONCE_OPTION(ipc_record, "IPC_RECORD", NULL)
+DEBUG_GET_ONCE_NUM_OPTION(client_swapchain_budget_mb, "IPC_CLIENT_SWAPCHAIN_BUDGET_MB", 0)
+
 
 /*
  *
@@ -31,6 +45,60 @@
  *
  */
 
+/*!
+ * Start recording the calls of this client if asked to, one file per client
+ * in the directory given by IPC_RECORD, replay them with monado-ipc-replay.
+ */
+static void
+start_recording(volatile struct ipc_client_state *ics)
+{
+	const char *dir = debug_get_option_ipc_record();
+	if (dir == NULL || ics->recorder != NULL) {
+		return;
+	}
+
+	char path[1024];
+	snprintf(path, sizeof(path), "%s/client-%u.ipcrec", dir, ics->client_state.id);
+
+	struct ipc_record_writer *writer = NULL;
+	if (ipc_record_writer_create(path, &writer) != XRT_SUCCESS) {
+		return;
+	}
+
+	IPC_INFO(ics->server, "Recording client '%s' to '%s'", ics->client_state.info.application_name, path);
+
+	ics->recorder = writer;
+}
+
+static inline void
+record(volatile struct ipc_client_state *ics, enum ipc_record_type type, const void *data, uint32_t size)
+{
+	if (ics->recorder == NULL) {
+		return;
+	}
+
+	ipc_record_write(ics->recorder, type, data, size, NULL, 0);
+}
+
+static void
+record_layer_sync(volatile struct ipc_client_state *ics,
+                  const struct ipc_layer_slot *slot,
+                  const struct xrt_layer_frame_data *data,
+                  uint32_t layer_count)
+{
+	if (ics->recorder == NULL) {
+		return;
+	}
+
+	struct ipc_record_layer_sync rec = {
+	    .data = *data,
+	    .layer_count = layer_count,
+	};
+
+	ipc_record_write(ics->recorder, IPC_RECORD_LAYER_SYNC, &rec, sizeof(rec), slot->layers,
+	                 rec.layer_count * sizeof(struct ipc_layer_entry));
+}
+
 static xrt_result_t
 validate_device_id(volatile struct ipc_client_state *ics, int64_t device_id, struct xrt_device **out_device)
 {
@@ -78,6 +146,169 @@ validate_origin_id(volatile struct ipc_client_state *ics, int64_t origin_id, str
 	return XRT_SUCCESS;
 }
 
+static inline volatile struct ipc_shared_space_snapshot *
+get_space_snapshot(volatile struct ipc_client_state *ics)
+{
+	if (ics->server_thread_index < 0 || (uint32_t)ics->server_thread_index >= ics->server->max_clients) {
+		return NULL;
+	}
+
+	return &ipc_shared_space_snapshots(ics->server->ism)[ics->server_thread_index];
+}
+
+static inline struct ipc_shared_swapchain *
+get_shared_swapchain(volatile struct ipc_client_state *ics, uint32_t id)
+{
+	if (ics->server_thread_index < 0 || (uint32_t)ics->server_thread_index >= ics->server->max_clients ||
+	    id >= IPC_MAX_CLIENT_SWAPCHAINS) {
+		return NULL;
+	}
+
+	uint32_t index = (uint32_t)ics->server_thread_index * IPC_MAX_CLIENT_SWAPCHAINS + id;
+
+	return &ipc_shared_swapchains(ics->server->ism)[index];
+}
+
+/*!
+ * Publish the state of an image to the client, waking it if it's sleeping on
+ * the swapchain, same as @ref ipc_server_client_wake_frame.
+ */
+static void
+publish_image_state(volatile struct ipc_client_state *ics,
+                    uint32_t id,
+                    uint32_t index,
+                    enum ipc_shared_image_state state)
+{
+	struct ipc_shared_swapchain *iss = get_shared_swapchain(ics, id);
+	if (iss == NULL || index >= XRT_MAX_SWAPCHAIN_IMAGES) {
+		return;
+	}
+
+	xrt_atomic_s32_store_release(&iss->image_states[index], (int32_t)state);
+
+	// Full barrier, the client either sees the new value or we see it waiting.
+	xrt_atomic_s32_inc_return(&iss->release_seq);
+
+#ifdef XRT_OS_LINUX
+	if (xrt_atomic_s32_load_acquire(&iss->client_waiting) != 0) {
+		ipc_futex_wake(&iss->release_seq);
+	}
+#endif
+}
+
+/*!
+ * Each client has its own slot, the client doesn't touch it from the layer
+ * sync call until the reply, that hands it back. The service reads each used
+ * layer out of it once, never the whole slot, see @ref _update_layers.
+ */
+static inline struct ipc_layer_slot *
+get_layer_slot(volatile struct ipc_client_state *ics, uint32_t slot_id)
+{
+	if (ics->server_thread_index < 0 || slot_id != (uint32_t)ics->server_thread_index) {
+		IPC_ERROR(ics->server, "Invalid slot_id %u for client %i", slot_id, ics->server_thread_index);
+		return NULL;
+	}
+
+	return &ipc_shared_slots(ics->server->ism)[slot_id];
+}
+
+/*!
+ * Called when anything changes how spaces relate to each other outside of
+ * tracking, makes all clients ignore their current space snapshots.
+ */
+static void
+invalidate_space_snapshots(volatile struct ipc_client_state *ics)
+{
+	xrt_atomic_s32_inc_return(&ics->server->ism->space_snapshot_epoch);
+}
+
+static void
+clear_space_snapshot_entry(volatile struct ipc_client_state *ics, uint32_t space_id)
+{
+	volatile struct ipc_shared_space_snapshot *snap = get_space_snapshot(ics);
+	if (snap == NULL || space_id >= IPC_MAX_SNAPSHOT_SPACES) {
+		return;
+	}
+
+	ipc_seqlock_write_begin(&snap->generation);
+	snap->valid[space_id] = false;
+	ipc_seqlock_write_end(&snap->generation);
+}
+
+/*!
+ * Locate all of the client's spaces in the root space around the predicted
+ * display time and publish them to the client's snapshot.
+ */
+static void
+update_space_snapshot(volatile struct ipc_client_state *ics,
+                      int64_t predicted_display_time_ns,
+                      int64_t predicted_display_period_ns)
+{
+	IPC_TRACE_MARKER();
+
+	volatile struct ipc_shared_space_snapshot *snap = get_space_snapshot(ics);
+	struct xrt_space_overseer *xso = ics->server->xso;
+	struct xrt_space *root = xso->semantic.root;
+	if (snap == NULL || root == NULL) {
+		return;
+	}
+
+	// Read before locating so a concurrent recenter makes this stale.
+	int32_t epoch = xrt_atomic_s32_load_acquire(&ics->server->ism->space_snapshot_epoch);
+
+	int64_t timestamps_ns[IPC_SPACE_SNAPSHOT_SAMPLE_COUNT];
+	for (uint32_t i = 0; i < IPC_SPACE_SNAPSHOT_SAMPLE_COUNT; i++) {
+		// One period before to one period after the display time.
+		timestamps_ns[i] = predicted_display_time_ns + ((int64_t)i - 1) * predicted_display_period_ns;
+	}
+
+	struct xrt_space *spaces[IPC_MAX_SNAPSHOT_SPACES];
+	struct xrt_pose offsets[IPC_MAX_SNAPSHOT_SPACES];
+	struct xrt_space_relation relations[IPC_SPACE_SNAPSHOT_SAMPLE_COUNT][IPC_MAX_SNAPSHOT_SPACES];
+	uint32_t highest = 0;
+
+	for (uint32_t i = 0; i < IPC_MAX_SNAPSHOT_SPACES; i++) {
+		spaces[i] = (struct xrt_space *)ics->xspcs[i];
+		offsets[i] = (struct xrt_pose)XRT_POSE_IDENTITY;
+		if (spaces[i] != NULL) {
+			highest = i + 1;
+		}
+	}
+
+	for (uint32_t k = 0; k < IPC_SPACE_SNAPSHOT_SAMPLE_COUNT; k++) {
+		xrt_result_t xret = xrt_space_overseer_locate_spaces( //
+		    xso,                                              //
+		    root,                                             //
+		    &offsets[0],                                      //
+		    timestamps_ns[k],                                 //
+		    spaces,                                           //
+		    highest,                                          //
+		    offsets,                                          //
+		    relations[k]);                                    //
+		if (xret != XRT_SUCCESS) {
+			return;
+		}
+	}
+
+	ipc_seqlock_write_begin(&snap->generation);
+
+	snap->epoch = epoch;
+	for (uint32_t k = 0; k < IPC_SPACE_SNAPSHOT_SAMPLE_COUNT; k++) {
+		snap->timestamps_ns[k] = timestamps_ns[k];
+	}
+	for (uint32_t i = 0; i < IPC_MAX_SNAPSHOT_SPACES; i++) {
+		snap->valid[i] = i < highest && spaces[i] != NULL;
+		if (!snap->valid[i]) {
+			continue;
+		}
+		for (uint32_t k = 0; k < IPC_SPACE_SNAPSHOT_SAMPLE_COUNT; k++) {
+			snap->relations[i][k] = relations[k][i];
+		}
+	}
+
+	ipc_seqlock_write_end(&snap->generation);
+}
+
 static xrt_result_t
 validate_swapchain_state(volatile struct ipc_client_state *ics, uint32_t *out_index)
 {
@@ -99,11 +330,45 @@ validate_swapchain_state(volatile struct ipc_client_state *ics, uint32_t *out_in
 	return XRT_SUCCESS;
 }
 
+static uint64_t
+get_images_memory_size(const struct xrt_image_native *images, uint32_t image_count)
+{
+	uint64_t size = 0;
+	for (uint32_t i = 0; i < image_count; i++) {
+		size += images[i].size;
+	}
+
+	return size;
+}
+
+/*!
+ * Refuses swapchains that would take the client over the budget set with
+ * IPC_CLIENT_SWAPCHAIN_BUDGET_MB, so one leaking app can't make the whole
+ * system page video memory.
+ */
+static xrt_result_t
+check_swapchain_budget(volatile struct ipc_client_state *ics, uint64_t memory_size)
+{
+	uint64_t budget = (uint64_t)debug_get_num_option_client_swapchain_budget_mb() * 1024 * 1024;
+	if (budget == 0 || ics->swapchain_memory_size + memory_size <= budget) {
+		return XRT_SUCCESS;
+	}
+
+	IPC_WARN(ics->server,
+	         "Client '%s' is over its swapchain budget, %" PRIu64 "MB in %u swapchains + %" PRIu64 "MB > %" PRIu64
+	         "MB, refusing the swapchain!",
+	         ics->client_state.info.application_name, ics->swapchain_memory_size / (1024 * 1024),
+	         ics->swapchain_count, memory_size / (1024 * 1024), budget / (1024 * 1024));
+
+	return XRT_ERROR_ALLOCATION;
+}
+
 static void
 set_swapchain_info(volatile struct ipc_client_state *ics,
                    uint32_t index,
                    const struct xrt_swapchain_create_info *info,
-                   struct xrt_swapchain *xsc)
+                   struct xrt_swapchain *xsc,
+                   uint64_t memory_size)
 {
 	ics->xscs[index] = xsc;
 	ics->swapchain_data[index].active = true;
@@ -111,6 +376,17 @@ set_swapchain_info(volatile struct ipc_client_state *ics,
 	ics->swapchain_data[index].height = info->height;
 	ics->swapchain_data[index].format = info->format;
 	ics->swapchain_data[index].image_count = xsc->image_count;
+	ics->swapchain_data[index].memory_size = memory_size;
+	ics->swapchain_memory_size += memory_size;
+
+	// All images start out ready, the id might have been used before.
+	struct ipc_shared_swapchain *iss = get_shared_swapchain(ics, index);
+	if (iss != NULL) {
+		for (uint32_t i = 0; i < XRT_MAX_SWAPCHAIN_IMAGES; i++) {
+			xrt_atomic_s32_store_release(&iss->image_states[i], IPC_SHARED_IMAGE_STATE_READY);
+		}
+		xrt_atomic_s32_store_release(&iss->client_waiting, 0);
+	}
 }
 
 static xrt_result_t
@@ -307,6 +583,46 @@ ipc_handle_instance_get_shm_fd(volatile struct ipc_client_state *ics,
 	return XRT_SUCCESS;
 }
 
+xrt_result_t
+ipc_handle_instance_get_ring_fd(volatile struct ipc_client_state *ics,
+                                uint32_t max_handle_capacity,
+                                xrt_shmem_handle_t *out_handles,
+                                uint32_t *out_handle_count)
+{
+	IPC_TRACE_MARKER();
+
+	assert(max_handle_capacity >= 1);
+
+	*out_handle_count = 0;
+
+#ifdef XRT_OS_LINUX
+	// The mainloop dispatcher only waits on sockets.
+	if (ics->server->threads[ics->server_thread_index].dispatched || ics->ring != NULL) {
+		return XRT_ERROR_FEATURE_NOT_SUPPORTED;
+	}
+
+	xrt_shmem_handle_t handle = XRT_SHMEM_HANDLE_INVALID;
+	struct ipc_ring *ring = NULL;
+
+	xrt_result_t xret = ipc_shmem_create(sizeof(struct ipc_ring), &handle, (void **)&ring);
+	if (xret != XRT_SUCCESS) {
+		IPC_ERROR(ics->server, "Failed to create ring shared memory");
+		return xret;
+	}
+
+	// Picked up by the client thread after this call has been replied to.
+	ics->ring = ring;
+	ics->ring_handle = handle;
+
+	out_handles[0] = handle;
+	*out_handle_count = 1;
+
+	return XRT_SUCCESS;
+#else
+	return XRT_ERROR_FEATURE_NOT_SUPPORTED;
+#endif
+}
+
 xrt_result_t
 ipc_handle_instance_describe_client(volatile struct ipc_client_state *ics,
                                     const struct ipc_client_description *client_desc)
@@ -346,6 +662,29 @@ ipc_handle_instance_describe_client(volatile struct ipc_client_state *ics,
 	// Log the pretty message.
 	IPC_INFO(ics->server, "%s", sink.buffer);
 
+	// Describing itself is the first thing a client does.
+	start_recording(ics);
+
+	return XRT_SUCCESS;
+}
+
+xrt_result_t
+ipc_handle_instance_get_shared_client_index(volatile struct ipc_client_state *ics, uint32_t *out_index)
+{
+	volatile struct ipc_shared_space_snapshot *snap = get_space_snapshot(ics);
+	if (snap == NULL) {
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	// Might contain spaces from a previous client using the same slot.
+	ipc_seqlock_write_begin(&snap->generation);
+	for (uint32_t i = 0; i < IPC_MAX_SNAPSHOT_SPACES; i++) {
+		snap->valid[i] = false;
+	}
+	ipc_seqlock_write_end(&snap->generation);
+
+	*out_index = (uint32_t)ics->server_thread_index;
+
 	return XRT_SUCCESS;
 }
 
@@ -393,6 +732,12 @@ ipc_handle_session_create(volatile struct ipc_client_state *ics,
 	                      ics->client_state.session_focused);
 	xrt_syscomp_set_z_order(ics->server->xsysc, ics->xc, ics->client_state.z_order);
 
+	struct ipc_record_session_create rec = {
+	    .xsi = *xsi,
+	    .create_native_compositor = create_native_compositor,
+	};
+	record(ics, IPC_RECORD_SESSION_CREATE, &rec, sizeof(rec));
+
 	return XRT_SUCCESS;
 }
 
@@ -436,6 +781,8 @@ ipc_handle_session_begin(volatile struct ipc_client_state *ics)
 	    .meta_body_tracking_calibration_enabled = ics->client_state.info.meta_body_tracking_calibration_enabled,
 	};
 
+	record(ics, IPC_RECORD_SESSION_BEGIN, NULL, 0);
+
 	return xrt_comp_begin_session(ics->xc, &begin_session_info);
 }
 
@@ -454,7 +801,14 @@ ipc_handle_session_end(volatile struct ipc_client_state *ics)
 		return XRT_ERROR_IPC_COMPOSITOR_NOT_CREATED;
 	}
 
-	return xrt_comp_end_session(ics->xc);
+	record(ics, IPC_RECORD_SESSION_END, NULL, 0);
+
+	xrt_result_t xret = xrt_comp_end_session(ics->xc);
+
+	// No more frames for this session, don't keep a client thread in wait frame.
+	ipc_server_client_wake_frame(ics);
+
+	return xret;
 }
 
 xrt_result_t
@@ -467,6 +821,8 @@ ipc_handle_session_destroy(volatile struct ipc_client_state *ics)
 		return XRT_ERROR_IPC_SESSION_NOT_CREATED;
 	}
 
+	record(ics, IPC_RECORD_SESSION_DESTROY, NULL, 0);
+
 	ipc_server_client_destroy_session_and_compositor(ics);
 
 	return XRT_SUCCESS;
@@ -505,7 +861,19 @@ ipc_handle_space_create_semantic_ids(volatile struct ipc_client_state *ics,
 	CREATE(unbounded);
 
 #undef CREATE
-	return create_localspace(ics, out_local_id, out_local_floor_id);
+	xrt_result_t xret = create_localspace(ics, out_local_id, out_local_floor_id);
+
+	struct ipc_record_semantic_ids rec = {
+	    .root_id = *out_root_id,
+	    .view_id = *out_view_id,
+	    .local_id = *out_local_id,
+	    .local_floor_id = *out_local_floor_id,
+	    .stage_id = *out_stage_id,
+	    .unbounded_id = *out_unbounded_id,
+	};
+	record(ics, IPC_RECORD_SPACE_CREATE_SEMANTIC_IDS, &rec, sizeof(rec));
+
+	return xret;
 }
 
 xrt_result_t
@@ -543,6 +911,13 @@ ipc_handle_space_create_offset(volatile struct ipc_client_state *ics,
 
 	*out_space_id = space_id;
 
+	struct ipc_record_space_create_offset rec = {
+	    .parent_id = parent_id,
+	    .id = space_id,
+	    .offset = *offset,
+	};
+	record(ics, IPC_RECORD_SPACE_CREATE_OFFSET, &rec, sizeof(rec));
+
 	return XRT_SUCCESS;
 }
 
@@ -577,6 +952,13 @@ ipc_handle_space_create_pose(volatile struct ipc_client_state *ics,
 
 	*out_space_id = space_id;
 
+	struct ipc_record_space_create_pose rec = {
+	    .xdev_id = xdev_id,
+	    .id = space_id,
+	    .name = name,
+	};
+	record(ics, IPC_RECORD_SPACE_CREATE_POSE, &rec, sizeof(rec));
+
 	return xret;
 }
 
@@ -608,6 +990,15 @@ ipc_handle_space_locate_space(volatile struct ipc_client_state *ics,
 		return xret;
 	}
 
+	struct ipc_record_locate_space rec = {
+	    .base_space_id = base_space_id,
+	    .space_id = space_id,
+	    .base_offset = *base_offset,
+	    .offset = *offset,
+	    .at_delta_ns = at_timestamp - os_monotonic_get_ns(),
+	};
+	record(ics, IPC_RECORD_SPACE_LOCATE_SPACE, &rec, sizeof(rec));
+
 	return xrt_space_overseer_locate_space( //
 	    xso,                                //
 	    base_space,                         //
@@ -748,6 +1139,14 @@ ipc_handle_space_locate_device(volatile struct ipc_client_state *ics,
 		return xret;
 	}
 
+	struct ipc_record_locate_device rec = {
+	    .base_space_id = base_space_id,
+	    .xdev_id = xdev_id,
+	    .base_offset = *base_offset,
+	    .at_delta_ns = at_timestamp - os_monotonic_get_ns(),
+	};
+	record(ics, IPC_RECORD_SPACE_LOCATE_DEVICE, &rec, sizeof(rec));
+
 	return xrt_space_overseer_locate_device( //
 	    xso,                                 //
 	    base_space,                          //
@@ -772,10 +1171,16 @@ ipc_handle_space_destroy(volatile struct ipc_client_state *ics, uint32_t space_i
 	assert(xs != NULL);
 	xs = NULL;
 
+	struct ipc_record_space rec = {.id = space_id};
+	record(ics, IPC_RECORD_SPACE_DESTROY, &rec, sizeof(rec));
+
 	// Remove volatile
 	struct xrt_space **xs_ptr = (struct xrt_space **)&ics->xspcs[space_id];
 	xrt_space_reference(xs_ptr, NULL);
 
+	// The id might be reused for a different space.
+	clear_space_snapshot_entry(ics, space_id);
+
 	if (space_id == ics->local_space_index) {
 		struct xrt_space **xslocal_ptr =
 		    (struct xrt_space **)&ics->server->xso->localspace[ics->local_space_overseer_index];
@@ -853,7 +1258,10 @@ ipc_handle_space_recenter_local_spaces(volatile struct ipc_client_state *ics)
 {
 	struct xrt_space_overseer *xso = ics->server->xso;
 
-	return xrt_space_overseer_recenter_local_spaces(xso);
+	xrt_result_t xret = xrt_space_overseer_recenter_local_spaces(xso);
+	invalidate_space_snapshots(ics);
+
+	return xret;
 }
 
 xrt_result_t
@@ -881,7 +1289,10 @@ ipc_handle_space_set_tracking_origin_offset(volatile struct ipc_client_state *ic
 	if (xret != XRT_SUCCESS) {
 		return xret;
 	}
-	return xrt_space_overseer_set_tracking_origin_offset(xso, xto, offset);
+	xret = xrt_space_overseer_set_tracking_origin_offset(xso, xto, offset);
+	invalidate_space_snapshots(ics);
+
+	return xret;
 }
 
 xrt_result_t
@@ -899,7 +1310,11 @@ ipc_handle_space_set_reference_space_offset(volatile struct ipc_client_state *ic
                                             const struct xrt_pose *offset)
 {
 	struct xrt_space_overseer *xso = ics->server->xso;
-	return xrt_space_overseer_set_reference_space_offset(xso, type, offset);
+
+	xrt_result_t xret = xrt_space_overseer_set_reference_space_offset(xso, type, offset);
+	invalidate_space_snapshots(ics);
+
+	return xret;
 }
 
 xrt_result_t
@@ -936,13 +1351,24 @@ ipc_handle_compositor_predict_frame(volatile struct ipc_client_state *ics,
 	ipc_server_activate_session(ics);
 
 	int64_t gpu_time_ns = 0;
-	return xrt_comp_predict_frame(        //
-	    ics->xc,                          //
-	    out_frame_id,                     //
-	    out_wake_up_time_ns,              //
-	    &gpu_time_ns,                     //
-	    out_predicted_display_time_ns,    //
-	    out_predicted_display_period_ns); //
+	xrt_result_t xret = xrt_comp_predict_frame( //
+	    ics->xc,                                //
+	    out_frame_id,                           //
+	    out_wake_up_time_ns,                    //
+	    &gpu_time_ns,                           //
+	    out_predicted_display_time_ns,          //
+	    out_predicted_display_period_ns);       //
+	if (xret != XRT_SUCCESS) {
+		return xret;
+	}
+
+	// Lets the client locate spaces for this frame without calling us.
+	update_space_snapshot(ics, *out_predicted_display_time_ns, *out_predicted_display_period_ns);
+
+	struct ipc_record_frame rec = {.frame_id = *out_frame_id};
+	record(ics, IPC_RECORD_PREDICT_FRAME, &rec, sizeof(rec));
+
+	return XRT_SUCCESS;
 }
 
 xrt_result_t
@@ -954,6 +1380,9 @@ ipc_handle_compositor_wait_woke(volatile struct ipc_client_state *ics, int64_t f
 		return XRT_ERROR_IPC_SESSION_NOT_CREATED;
 	}
 
+	struct ipc_record_frame rec = {.frame_id = frame_id};
+	record(ics, IPC_RECORD_WAIT_WOKE, &rec, sizeof(rec));
+
 	return xrt_comp_mark_frame(ics->xc, frame_id, XRT_COMPOSITOR_FRAME_POINT_WOKE, os_monotonic_get_ns());
 }
 
@@ -966,6 +1395,9 @@ ipc_handle_compositor_begin_frame(volatile struct ipc_client_state *ics, int64_t
 		return XRT_ERROR_IPC_SESSION_NOT_CREATED;
 	}
 
+	struct ipc_record_frame rec = {.frame_id = frame_id};
+	record(ics, IPC_RECORD_BEGIN_FRAME, &rec, sizeof(rec));
+
 	return xrt_comp_begin_frame(ics->xc, frame_id);
 }
 
@@ -978,6 +1410,9 @@ ipc_handle_compositor_discard_frame(volatile struct ipc_client_state *ics, int64
 		return XRT_ERROR_IPC_SESSION_NOT_CREATED;
 	}
 
+	struct ipc_record_frame rec = {.frame_id = frame_id};
+	record(ics, IPC_RECORD_DISCARD_FRAME, &rec, sizeof(rec));
+
 	return xrt_comp_discard_frame(ics->xc, frame_id);
 }
 
@@ -1024,10 +1459,20 @@ ipc_handle_compositor_set_performance_level(volatile struct ipc_client_state *ic
 	return xrt_comp_set_performance_level(ics->xc, domain, level);
 }
 
+static struct xrt_swapchain *
+get_layer_swapchain(volatile struct ipc_client_state *ics, uint32_t id)
+{
+	if (id >= IPC_MAX_CLIENT_SWAPCHAINS) {
+		return NULL;
+	}
+
+	return ics->xscs[id];
+}
+
 static bool
 _update_projection_layer(struct xrt_compositor *xc,
                          volatile struct ipc_client_state *ics,
-                         volatile struct ipc_layer_entry *layer,
+                         const struct ipc_layer_entry *layer,
                          uint32_t i)
 {
 	// xdev
@@ -1044,8 +1489,7 @@ _update_projection_layer(struct xrt_compositor *xc,
 
 	struct xrt_swapchain *xcs[XRT_MAX_VIEWS];
 	for (uint32_t k = 0; k < view_count; k++) {
-		const uint32_t xsci = layer->swapchain_ids[k];
-		xcs[k] = ics->xscs[xsci];
+		xcs[k] = get_layer_swapchain(ics, layer->swapchain_ids[k]);
 		if (xcs[k] == NULL) {
 			U_LOG_E("Invalid swap chain for projection layer!");
 			return false;
@@ -1053,8 +1497,7 @@ _update_projection_layer(struct xrt_compositor *xc,
 	}
 
 
-	// Cast away volatile.
-	struct xrt_layer_data *data = (struct xrt_layer_data *)&layer->data;
+	const struct xrt_layer_data *data = &layer->data;
 
 	xrt_comp_layer_projection(xc, xdev, xcs, data);
 
@@ -1064,14 +1507,13 @@ _update_projection_layer(struct xrt_compositor *xc,
 static bool
 _update_projection_layer_depth(struct xrt_compositor *xc,
                                volatile struct ipc_client_state *ics,
-                               volatile struct ipc_layer_entry *layer,
+                               const struct ipc_layer_entry *layer,
                                uint32_t i)
 {
 	// xdev
 	uint32_t xdevi = layer->xdev_id;
 
-	// Cast away volatile.
-	struct xrt_layer_data *data = (struct xrt_layer_data *)&layer->data;
+	const struct xrt_layer_data *data = &layer->data;
 
 	struct xrt_device *xdev = NULL;
 	GET_XDEV_OR_RETURN(ics, xdevi, xdev);
@@ -1084,11 +1526,8 @@ _update_projection_layer_depth(struct xrt_compositor *xc,
 	struct xrt_swapchain *d_xcs[XRT_MAX_VIEWS];
 
 	for (uint32_t j = 0; j < data->view_count; j++) {
-		int xsci = layer->swapchain_ids[j];
-		int d_xsci = layer->swapchain_ids[j + data->view_count];
-
-		xcs[j] = ics->xscs[xsci];
-		d_xcs[j] = ics->xscs[d_xsci];
+		xcs[j] = get_layer_swapchain(ics, layer->swapchain_ids[j]);
+		d_xcs[j] = get_layer_swapchain(ics, layer->swapchain_ids[j + data->view_count]);
 		if (xcs[j] == NULL || d_xcs[j] == NULL) {
 			U_LOG_E("Invalid swap chain for projection layer #%u!", i);
 			return false;
@@ -1103,19 +1542,18 @@ _update_projection_layer_depth(struct xrt_compositor *xc,
 static bool
 do_single(struct xrt_compositor *xc,
           volatile struct ipc_client_state *ics,
-          volatile struct ipc_layer_entry *layer,
+          const struct ipc_layer_entry *layer,
           uint32_t i,
           const char *name,
           struct xrt_device **out_xdev,
           struct xrt_swapchain **out_xcs,
-          struct xrt_layer_data **out_data)
+          const struct xrt_layer_data **out_data)
 {
 	uint32_t device_id = layer->xdev_id;
-	uint32_t sci = layer->swapchain_ids[0];
 
 	struct xrt_device *xdev = NULL;
 	GET_XDEV_OR_RETURN(ics, device_id, xdev);
-	struct xrt_swapchain *xcs = ics->xscs[sci];
+	struct xrt_swapchain *xcs = get_layer_swapchain(ics, layer->swapchain_ids[0]);
 
 	if (xcs == NULL) {
 		U_LOG_E("Invalid swapchain for layer #%u, '%s'!", i, name);
@@ -1127,8 +1565,7 @@ do_single(struct xrt_compositor *xc,
 		return false;
 	}
 
-	// Cast away volatile.
-	struct xrt_layer_data *data = (struct xrt_layer_data *)&layer->data;
+	const struct xrt_layer_data *data = &layer->data;
 
 	*out_xdev = xdev;
 	*out_xcs = xcs;
@@ -1140,12 +1577,12 @@ do_single(struct xrt_compositor *xc,
 static bool
 _update_quad_layer(struct xrt_compositor *xc,
                    volatile struct ipc_client_state *ics,
-                   volatile struct ipc_layer_entry *layer,
+                   const struct ipc_layer_entry *layer,
                    uint32_t i)
 {
 	struct xrt_device *xdev;
 	struct xrt_swapchain *xcs;
-	struct xrt_layer_data *data;
+	const struct xrt_layer_data *data;
 
 	if (!do_single(xc, ics, layer, i, "quad", &xdev, &xcs, &data)) {
 		return false;
@@ -1159,12 +1596,12 @@ _update_quad_layer(struct xrt_compositor *xc,
 static bool
 _update_cube_layer(struct xrt_compositor *xc,
                    volatile struct ipc_client_state *ics,
-                   volatile struct ipc_layer_entry *layer,
+                   const struct ipc_layer_entry *layer,
                    uint32_t i)
 {
 	struct xrt_device *xdev;
 	struct xrt_swapchain *xcs;
-	struct xrt_layer_data *data;
+	const struct xrt_layer_data *data;
 
 	if (!do_single(xc, ics, layer, i, "cube", &xdev, &xcs, &data)) {
 		return false;
@@ -1178,12 +1615,12 @@ _update_cube_layer(struct xrt_compositor *xc,
 static bool
 _update_cylinder_layer(struct xrt_compositor *xc,
                        volatile struct ipc_client_state *ics,
-                       volatile struct ipc_layer_entry *layer,
+                       const struct ipc_layer_entry *layer,
                        uint32_t i)
 {
 	struct xrt_device *xdev;
 	struct xrt_swapchain *xcs;
-	struct xrt_layer_data *data;
+	const struct xrt_layer_data *data;
 
 	if (!do_single(xc, ics, layer, i, "cylinder", &xdev, &xcs, &data)) {
 		return false;
@@ -1197,12 +1634,12 @@ _update_cylinder_layer(struct xrt_compositor *xc,
 static bool
 _update_equirect1_layer(struct xrt_compositor *xc,
                         volatile struct ipc_client_state *ics,
-                        volatile struct ipc_layer_entry *layer,
+                        const struct ipc_layer_entry *layer,
                         uint32_t i)
 {
 	struct xrt_device *xdev;
 	struct xrt_swapchain *xcs;
-	struct xrt_layer_data *data;
+	const struct xrt_layer_data *data;
 
 	if (!do_single(xc, ics, layer, i, "equirect1", &xdev, &xcs, &data)) {
 		return false;
@@ -1216,12 +1653,12 @@ _update_equirect1_layer(struct xrt_compositor *xc,
 static bool
 _update_equirect2_layer(struct xrt_compositor *xc,
                         volatile struct ipc_client_state *ics,
-                        volatile struct ipc_layer_entry *layer,
+                        const struct ipc_layer_entry *layer,
                         uint32_t i)
 {
 	struct xrt_device *xdev;
 	struct xrt_swapchain *xcs;
-	struct xrt_layer_data *data;
+	const struct xrt_layer_data *data;
 
 	if (!do_single(xc, ics, layer, i, "equirect2", &xdev, &xcs, &data)) {
 		return false;
@@ -1235,7 +1672,7 @@ _update_equirect2_layer(struct xrt_compositor *xc,
 static bool
 _update_passthrough_layer(struct xrt_compositor *xc,
                           volatile struct ipc_client_state *ics,
-                          volatile struct ipc_layer_entry *layer,
+                          const struct ipc_layer_entry *layer,
                           uint32_t i)
 {
 	// xdev
@@ -1249,21 +1686,34 @@ _update_passthrough_layer(struct xrt_compositor *xc,
 		return false;
 	}
 
-	// Cast away volatile.
-	struct xrt_layer_data *data = (struct xrt_layer_data *)&layer->data;
+	const struct xrt_layer_data *data = &layer->data;
 
 	xrt_comp_layer_passthrough(xc, xdev, data);
 
 	return true;
 }
 
+/*!
+ * Each used layer is copied out of the slot once, the copy is what is both
+ * validated and handed to the compositor, so the client can't change it in
+ * between. The unused part of the slot is never touched.
+ */
 static bool
-_update_layers(volatile struct ipc_client_state *ics, struct xrt_compositor *xc, struct ipc_layer_slot *slot)
+_update_layers(volatile struct ipc_client_state *ics,
+               struct xrt_compositor *xc,
+               const struct ipc_layer_slot *slot,
+               uint32_t layer_count)
 {
 	IPC_TRACE_MARKER();
 
-	for (uint32_t i = 0; i < slot->layer_count; i++) {
-		volatile struct ipc_layer_entry *layer = &slot->layers[i];
+	for (uint32_t i = 0; i < layer_count; i++) {
+		const struct ipc_layer_entry copy = slot->layers[i];
+		const struct ipc_layer_entry *layer = &copy;
+
+		if (layer->data.view_count > XRT_MAX_VIEWS) {
+			U_LOG_E("Invalid view count %u for layer #%u!", layer->data.view_count, i);
+			return false;
+		}
 
 		switch (layer->data.type) {
 		case XRT_LAYER_PROJECTION:
@@ -1326,8 +1776,16 @@ ipc_handle_compositor_layer_sync(volatile struct ipc_client_state *ics,
 		return XRT_ERROR_IPC_SESSION_NOT_CREATED;
 	}
 
-	struct ipc_shared_memory *ism = ics->server->ism;
-	struct ipc_layer_slot *slot = &ism->slots[slot_id];
+	struct ipc_layer_slot *slot = get_layer_slot(ics, slot_id);
+	uint32_t layer_count = slot != NULL ? slot->layer_count : 0;
+	if (slot == NULL || layer_count > IPC_MAX_LAYERS) {
+		for (uint32_t i = 0; i < handle_count; i++) {
+			xrt_graphics_sync_handle_t tmp = handles[i];
+			u_graphics_sync_unref(&tmp);
+		}
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
 	xrt_graphics_sync_handle_t sync_handle = XRT_GRAPHICS_SYNC_HANDLE_INVALID;
 
 	// If we have one or more save the first handle.
@@ -1342,31 +1800,25 @@ ipc_handle_compositor_layer_sync(volatile struct ipc_client_state *ics,
 		u_graphics_sync_unref(&tmp);
 	}
 
-	// Copy current slot data.
-	struct ipc_layer_slot copy = *slot;
+	// Only the header, the layers are read one by one.
+	struct xrt_layer_frame_data data = slot->data;
+
+	record_layer_sync(ics, slot, &data, layer_count);
 
 
 	/*
 	 * Transfer data to underlying compositor.
 	 */
 
-	xrt_comp_layer_begin(ics->xc, &copy.data);
+	xrt_comp_layer_begin(ics->xc, &data);
 
-	_update_layers(ics, ics->xc, &copy);
+	_update_layers(ics, ics->xc, slot, layer_count);
 
 	xrt_comp_layer_commit(ics->xc, sync_handle);
 
 
-	/*
-	 * Manage shared state.
-	 */
-
-	os_mutex_lock(&ics->server->global_state.lock);
-
-	*out_free_slot_id = (ics->server->current_slot_index + 1) % IPC_MAX_SLOTS;
-	ics->server->current_slot_index = *out_free_slot_id;
-
-	os_mutex_unlock(&ics->server->global_state.lock);
+	// The compositor has its own copy, the client can fill it in again.
+	*out_free_slot_id = slot_id;
 
 	return XRT_SUCCESS;
 }
@@ -1394,11 +1846,21 @@ ipc_handle_compositor_layer_sync_with_semaphore(volatile struct ipc_client_state
 
 	struct xrt_compositor_semaphore *xcsem = ics->xcsems[semaphore_id];
 
-	struct ipc_shared_memory *ism = ics->server->ism;
-	struct ipc_layer_slot *slot = &ism->slots[slot_id];
+	struct ipc_layer_slot *slot = get_layer_slot(ics, slot_id);
+	if (slot == NULL) {
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	uint32_t layer_count = slot->layer_count;
+	if (layer_count > IPC_MAX_LAYERS) {
+		IPC_ERROR(ics->server, "Invalid layer count %u", layer_count);
+		return XRT_ERROR_IPC_FAILURE;
+	}
 
-	// Copy current slot data.
-	struct ipc_layer_slot copy = *slot;
+	// Only the header, the layers are read one by one.
+	struct xrt_layer_frame_data data = slot->data;
+
+	record_layer_sync(ics, slot, &data, layer_count);
 
 
 
@@ -1406,23 +1868,15 @@ ipc_handle_compositor_layer_sync_with_semaphore(volatile struct ipc_client_state
 	 * Transfer data to underlying compositor.
 	 */
 
-	xrt_comp_layer_begin(ics->xc, &copy.data);
+	xrt_comp_layer_begin(ics->xc, &data);
 
-	_update_layers(ics, ics->xc, &copy);
+	_update_layers(ics, ics->xc, slot, layer_count);
 
 	xrt_comp_layer_commit_with_semaphore(ics->xc, xcsem, semaphore_value);
 
 
-	/*
-	 * Manage shared state.
-	 */
-
-	os_mutex_lock(&ics->server->global_state.lock);
-
-	*out_free_slot_id = (ics->server->current_slot_index + 1) % IPC_MAX_SLOTS;
-	ics->server->current_slot_index = *out_free_slot_id;
-
-	os_mutex_unlock(&ics->server->global_state.lock);
+	// The compositor has its own copy, the client can fill it in again.
+	*out_free_slot_id = slot_id;
 
 	return XRT_SUCCESS;
 }
@@ -1479,6 +1933,17 @@ ipc_handle_compositor_set_thread_hint(volatile struct ipc_client_state *ics,
 		return XRT_ERROR_IPC_SESSION_NOT_CREATED;
 	}
 
+#if defined(XRT_OS_LINUX) && !defined(XRT_OS_ANDROID)
+	/*
+	 * The compositor changes the scheduling of the thread, don't let a
+	 * client touch other processes. Only a hint so not an error.
+	 */
+	if (!u_linux_is_thread_of_process(ics->client_state.pid, (pid_t)thread_id)) {
+		IPC_WARN(ics->server, "Thread %u is not a thread of client pid %i", thread_id, ics->client_state.pid);
+		return XRT_SUCCESS;
+	}
+#endif
+
 	return xrt_comp_set_thread_hint(ics->xc, hint, thread_id);
 }
 
@@ -1505,7 +1970,7 @@ ipc_handle_system_get_clients(volatile struct ipc_client_state *_ics, struct ipc
 	os_mutex_lock(&s->global_state.lock);
 
 	uint32_t count = 0;
-	for (uint32_t i = 0; i < IPC_MAX_CLIENTS; i++) {
+	for (uint32_t i = 0; i < s->max_clients; i++) {
 
 		volatile struct ipc_client_state *ics = &s->threads[i].ics;
 
@@ -1543,6 +2008,28 @@ ipc_handle_system_get_client_info(volatile struct ipc_client_state *_ics,
 	return ipc_server_get_client_app_state(s, client_id, out_ias);
 }
 
+xrt_result_t
+ipc_handle_system_get_client_frame_stats(volatile struct ipc_client_state *_ics,
+                                         uint32_t client_id,
+                                         struct xrt_compositor_frame_stats *out_stats)
+{
+	struct ipc_server *s = _ics->server;
+
+	return ipc_server_get_client_frame_stats(s, client_id, out_stats);
+}
+
+xrt_result_t
+ipc_handle_system_get_lock_stats(volatile struct ipc_client_state *_ics,
+                                 uint32_t index,
+                                 struct ipc_lock_stats *out_stats)
+{
+	// Empty unless the service is built with XRT_FEATURE_LOCK_PROFILING.
+	U_ZERO(out_stats);
+	out_stats->count = os_lock_stats_get(index, &out_stats->stats);
+
+	return XRT_SUCCESS;
+}
+
 xrt_result_t
 ipc_handle_system_set_primary_client(volatile struct ipc_client_state *_ics, uint32_t client_id)
 {
@@ -1581,6 +2068,7 @@ ipc_handle_system_toggle_io_device(volatile struct ipc_client_state *ics, uint32
 	struct ipc_device *idev = &ics->server->idevs[device_id];
 
 	idev->io_active = !idev->io_active;
+	ics->server->ism->isdevs[device_id].io_active = idev->io_active;
 
 	return XRT_SUCCESS;
 }
@@ -1633,15 +2121,23 @@ ipc_handle_swapchain_create(volatile struct ipc_client_state *ics,
 		return xret;
 	}
 
+	struct xrt_swapchain_native *xscn = (struct xrt_swapchain_native *)xsc;
+	uint64_t memory_size = get_images_memory_size(xscn->images, xsc->image_count);
+
+	xret = check_swapchain_budget(ics, memory_size);
+	if (xret != XRT_SUCCESS) {
+		xrt_swapchain_reference(&xsc, NULL);
+		return xret;
+	}
+
 	// It's now safe to increment the number of swapchains.
 	ics->swapchain_count++;
 
 	IPC_TRACE(ics->server, "Created swapchain %d.", index);
 
-	set_swapchain_info(ics, index, info, xsc);
+	set_swapchain_info(ics, index, info, xsc, memory_size);
 
 	// return our result to the caller.
-	struct xrt_swapchain_native *xscn = (struct xrt_swapchain_native *)xsc;
 
 	// Limit checking
 	assert(xsc->image_count <= XRT_MAX_SWAPCHAIN_IMAGES);
@@ -1664,6 +2160,12 @@ ipc_handle_swapchain_create(volatile struct ipc_client_state *ics,
 		out_handles[i] = xscn->images[i].handle;
 	}
 
+	struct ipc_record_swapchain_create rec = {
+	    .info = *info,
+	    .id = index,
+	};
+	record(ics, IPC_RECORD_SWAPCHAIN_CREATE, &rec, sizeof(rec));
+
 	return XRT_SUCCESS;
 }
 
@@ -1699,6 +2201,14 @@ ipc_handle_swapchain_import(volatile struct ipc_client_state *ics,
 #endif
 	}
 
+	// The client allocated the memory, but it's still taken from the same pool.
+	uint64_t memory_size = get_images_memory_size(xins, handle_count);
+
+	xret = check_swapchain_budget(ics, memory_size);
+	if (xret != XRT_SUCCESS) {
+		return xret;
+	}
+
 	// create the swapchain
 	struct xrt_swapchain *xsc = NULL;
 	xret = xrt_comp_import_swapchain(ics->xc, info, xins, handle_count, &xsc);
@@ -1711,7 +2221,7 @@ ipc_handle_swapchain_import(volatile struct ipc_client_state *ics,
 
 	IPC_TRACE(ics->server, "Created swapchain %d.", index);
 
-	set_swapchain_info(ics, index, info, xsc);
+	set_swapchain_info(ics, index, info, xsc, memory_size);
 	*out_id = index;
 
 	return XRT_SUCCESS;
@@ -1728,23 +2238,19 @@ ipc_handle_swapchain_wait_image(volatile struct ipc_client_state *ics, uint32_t
 	uint32_t sc_index = id;
 	struct xrt_swapchain *xsc = ics->xscs[sc_index];
 
-	return xrt_swapchain_wait_image(xsc, timeout_ns, index);
-}
+	struct ipc_record_swapchain_wait_image rec = {
+	    .id = id,
+	    .index = index,
+	    .timeout_ns = timeout_ns,
+	};
+	record(ics, IPC_RECORD_SWAPCHAIN_WAIT_IMAGE, &rec, sizeof(rec));
 
-xrt_result_t
-ipc_handle_swapchain_acquire_image(volatile struct ipc_client_state *ics, uint32_t id, uint32_t *out_index)
-{
-	if (ics->xc == NULL) {
-		return XRT_ERROR_IPC_SESSION_NOT_CREATED;
+	xrt_result_t xret = xrt_swapchain_wait_image(xsc, timeout_ns, index);
+	if (xret == XRT_SUCCESS) {
+		publish_image_state(ics, id, index, IPC_SHARED_IMAGE_STATE_READY);
 	}
 
-	//! @todo Look up the index.
-	uint32_t sc_index = id;
-	struct xrt_swapchain *xsc = ics->xscs[sc_index];
-
-	xrt_swapchain_acquire_image(xsc, out_index);
-
-	return XRT_SUCCESS;
+	return xret;
 }
 
 xrt_result_t
@@ -1758,9 +2264,29 @@ ipc_handle_swapchain_release_image(volatile struct ipc_client_state *ics, uint32
 	uint32_t sc_index = id;
 	struct xrt_swapchain *xsc = ics->xscs[sc_index];
 
-	xrt_swapchain_release_image(xsc, index);
+	struct ipc_record_swapchain_image rec = {
+	    .id = id,
+	    .index = index,
+	};
+	record(ics, IPC_RECORD_SWAPCHAIN_RELEASE_IMAGE, &rec, sizeof(rec));
 
-	return XRT_SUCCESS;
+	/*
+	 * The client picks the images itself, in the same order as the
+	 * swapchain hands them out, acquire here to keep it in step.
+	 */
+	uint32_t acquired = 0;
+	xrt_result_t xret = xrt_swapchain_acquire_image(xsc, &acquired);
+	if (xret != XRT_SUCCESS || acquired != index) {
+		IPC_WARN(ics->server, "Client released image %u of swapchain %u, expected %u", index, id, acquired);
+	}
+
+	xret = xrt_swapchain_release_image(xsc, index);
+
+	// Only check, if it's still in use the client asks us to wait on it.
+	bool ready = xrt_swapchain_wait_image(xsc, 0, index) == XRT_SUCCESS;
+	publish_image_state(ics, id, index, ready ? IPC_SHARED_IMAGE_STATE_READY : IPC_SHARED_IMAGE_STATE_IN_USE);
+
+	return xret;
 }
 
 xrt_result_t
@@ -1772,8 +2298,13 @@ ipc_handle_swapchain_destroy(volatile struct ipc_client_state *ics, uint32_t id)
 
 	ics->swapchain_count--;
 
+	struct ipc_record_swapchain rec = {.id = id};
+	record(ics, IPC_RECORD_SWAPCHAIN_DESTROY, &rec, sizeof(rec));
+
 	// Drop our reference, does NULL checking. Cast away volatile.
 	xrt_swapchain_reference((struct xrt_swapchain **)&ics->xscs[id], NULL);
+	ics->swapchain_memory_size -= ics->swapchain_data[id].memory_size;
+	ics->swapchain_data[id].memory_size = 0;
 	ics->swapchain_data[id].active = false;
 
 	return XRT_SUCCESS;
@@ -1822,6 +2353,7 @@ ipc_handle_compositor_semaphore_create(volatile struct ipc_client_state *ics,
 
 	// Set it directly, no need to use reference here.
 	ics->xcsems[id] = xcsem;
+	ics->compositor_semaphore_count++;
 
 	// Set out parameters.
 	*out_id = id;
@@ -1868,6 +2400,11 @@ ipc_handle_device_update_input(volatile struct ipc_client_state *ics, uint32_t i
 	struct xrt_device *xdev = idev->xdev;
 	struct ipc_shared_device *isdev = &ism->isdevs[device_id];
 
+	// The publisher thread keeps the inputs up to date, clients apply IO state.
+	if (ism->inputs_published) {
+		return XRT_SUCCESS;
+	}
+
 	// Update inputs.
 	xrt_result_t xret = xrt_device_update_inputs(xdev);
 	if (xret != XRT_SUCCESS) {
@@ -1877,7 +2414,7 @@ ipc_handle_device_update_input(volatile struct ipc_client_state *ics, uint32_t i
 
 	// Copy data into the shared memory.
 	struct xrt_input *src = xdev->inputs;
-	struct xrt_input *dst = &ism->inputs[isdev->first_input_index];
+	struct xrt_input *dst = &ipc_shared_inputs(ism)[isdev->first_input_index];
 	size_t size = sizeof(struct xrt_input) * isdev->input_count;
 
 	bool io_active = ics->io_active && idev->io_active;
@@ -1905,7 +2442,7 @@ find_input(volatile struct ipc_client_state *ics, uint32_t device_id, enum xrt_i
 {
 	struct ipc_shared_memory *ism = ics->server->ism;
 	struct ipc_shared_device *isdev = &ism->isdevs[device_id];
-	struct xrt_input *io = &ism->inputs[isdev->first_input_index];
+	struct xrt_input *io = &ipc_shared_inputs(ism)[isdev->first_input_index];
 
 	for (uint32_t i = 0; i < isdev->input_count; i++) {
 		if (io[i].name == name) {
@@ -2000,8 +2537,10 @@ ipc_handle_device_get_view_poses(volatile struct ipc_client_state *ics,
 	struct xrt_fov fovs[IPC_MAX_RAW_VIEWS];
 	struct xrt_pose poses[IPC_MAX_RAW_VIEWS];
 
-	reply.result = xrt_device_get_view_poses( //
-	    xdev,                                 //
+	// Shared with other clients asking for the same frame.
+	reply.result = ipc_server_get_view_poses( //
+	    s,                                    //
+	    device_id,                            //
 	    fallback_eye_relation,                //
 	    at_timestamp_ns,                      //
 	    view_count,                           //
@@ -2056,8 +2595,16 @@ ipc_handle_device_get_view_poses_2(volatile struct ipc_client_state *ics,
 	uint32_t device_id = id;
 	struct xrt_device *xdev = NULL;
 	GET_XDEV_OR_RETURN(ics, device_id, xdev);
-	return xrt_device_get_view_poses( //
-	    xdev,                         //
+
+	if (view_count == 0 || view_count > XRT_MAX_VIEWS) {
+		IPC_ERROR(ics->server, "Client asked for zero or too many views! (%u)", view_count);
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	// Shared with other clients asking for the same frame.
+	return ipc_server_get_view_poses( //
+	    ics->server,                  //
+	    device_id,                    //
 	    default_eye_relation,         //
 	    at_timestamp_ns,              //
 	    view_count,                   //
@@ -2181,10 +2728,43 @@ ipc_handle_device_get_plane_detection_state_ext(volatile struct ipc_client_state
 	return XRT_SUCCESS;
 }
 
+static bool
+plane_detections_equal(const struct xrt_plane_detections_ext *a, const struct xrt_plane_detections_ext *b)
+{
+	// Sizes are the counts as both were filled in from zero.
+	if (a->location_count != b->location_count || a->polygon_info_size != b->polygon_info_size ||
+	    a->vertex_size != b->vertex_size) {
+		return false;
+	}
+
+	// Field by field, the struct has padding.
+	for (uint32_t i = 0; i < a->location_count; i++) {
+		const struct xrt_plane_detector_location_ext *la = &a->locations[i];
+		const struct xrt_plane_detector_location_ext *lb = &b->locations[i];
+
+		if (la->planeId != lb->planeId || la->orientation != lb->orientation ||
+		    la->semantic_type != lb->semantic_type || la->polygon_buffer_count != lb->polygon_buffer_count ||
+		    memcmp(&la->relation, &lb->relation, sizeof(la->relation)) != 0 ||
+		    memcmp(&la->extents, &lb->extents, sizeof(la->extents)) != 0) {
+			return false;
+		}
+	}
+
+	return (a->location_count == 0 ||
+	        memcmp(a->polygon_info_start_index, b->polygon_info_start_index,
+	               sizeof(uint32_t) * a->location_count) == 0) &&
+	       (a->polygon_info_size == 0 ||
+	        memcmp(a->polygon_infos, b->polygon_infos,
+	               sizeof(struct xrt_plane_polygon_info_ext) * a->polygon_info_size) == 0) &&
+	       (a->vertex_size == 0 ||
+	        memcmp(a->vertices, b->vertices, sizeof(struct xrt_vec2) * a->vertex_size) == 0);
+}
+
 xrt_result_t
 ipc_handle_device_get_plane_detections_ext(volatile struct ipc_client_state *ics,
                                            uint32_t id,
-                                           uint64_t plane_detection_id)
+                                           uint64_t plane_detection_id,
+                                           uint64_t known_revision)
 
 {
 	struct ipc_message_channel *imc = (struct ipc_message_channel *)&ics->imc;
@@ -2206,10 +2786,39 @@ ipc_handle_device_get_plane_detections_ext(volatile struct ipc_client_state *ics
 		return xret;
 	}
 
+	/*
+	 * Apps query the same results again and again, not least because of
+	 * the two call idiom, keep what was sent last and give it a new
+	 * revision only when it changes.
+	 */
+	struct xrt_plane_detections_ext *sent =
+	    (struct xrt_plane_detections_ext *)&ics->plane_detections_sent.detections;
+	if (ics->plane_detections_sent.plane_detection_id != plane_detection_id ||
+	    ics->plane_detections_sent.revision == 0 || !plane_detections_equal(sent, &out)) {
+		// Take ownership of the new arrays.
+		xrt_plane_detections_ext_clear(sent);
+		*sent = out;
+		U_ZERO(&out);
+
+		ics->plane_detections_sent.plane_detection_id = plane_detection_id;
+		ics->plane_detections_sent.revision++;
+	}
+
 	reply.result = XRT_SUCCESS;
-	reply.location_size = out.location_count; // because we initialized to 0, now size == count
-	reply.polygon_size = out.polygon_info_size;
-	reply.vertex_size = out.vertex_size;
+	reply.revision = ics->plane_detections_sent.revision;
+
+	// The client already has this revision, only send the reply.
+	if (known_revision == reply.revision) {
+		xret = ipc_send(imc, &reply, sizeof(reply));
+		if (xret != XRT_SUCCESS) {
+			IPC_ERROR(s, "Failed to send reply!");
+		}
+		goto out;
+	}
+
+	reply.location_size = sent->location_count; // because we initialized to 0, now size == count
+	reply.polygon_size = sent->polygon_info_size;
+	reply.vertex_size = sent->vertex_size;
 
 	xret = ipc_send(imc, &reply, sizeof(reply));
 	if (xret != XRT_SUCCESS) {
@@ -2219,32 +2828,32 @@ ipc_handle_device_get_plane_detections_ext(volatile struct ipc_client_state *ics
 
 	// send expected contents
 
-	if (out.location_count > 0) {
-		xret =
-		    ipc_send(imc, out.locations, sizeof(struct xrt_plane_detector_location_ext) * out.location_count);
+	if (sent->location_count > 0) {
+		xret = ipc_send(imc, sent->locations,
+		                sizeof(struct xrt_plane_detector_location_ext) * sent->location_count);
 		if (xret != XRT_SUCCESS) {
 			IPC_ERROR(s, "Failed to send locations!");
 			goto out;
 		}
 
-		xret = ipc_send(imc, out.polygon_info_start_index, sizeof(uint32_t) * out.location_count);
+		xret = ipc_send(imc, sent->polygon_info_start_index, sizeof(uint32_t) * sent->location_count);
 		if (xret != XRT_SUCCESS) {
 			IPC_ERROR(s, "Failed to send locations!");
 			goto out;
 		}
 	}
 
-	if (out.polygon_info_size > 0) {
-		xret =
-		    ipc_send(imc, out.polygon_infos, sizeof(struct xrt_plane_polygon_info_ext) * out.polygon_info_size);
+	if (sent->polygon_info_size > 0) {
+		xret = ipc_send(imc, sent->polygon_infos,
+		                sizeof(struct xrt_plane_polygon_info_ext) * sent->polygon_info_size);
 		if (xret != XRT_SUCCESS) {
 			IPC_ERROR(s, "Failed to send polygon_infos!");
 			goto out;
 		}
 	}
 
-	if (out.vertex_size > 0) {
-		xret = ipc_send(imc, out.vertices, sizeof(struct xrt_vec2) * out.vertex_size);
+	if (sent->vertex_size > 0) {
+		xret = ipc_send(imc, sent->vertices, sizeof(struct xrt_vec2) * sent->vertex_size);
 		if (xret != XRT_SUCCESS) {
 			IPC_ERROR(s, "Failed to send vertices!");
 			goto out;
@@ -2377,19 +2986,15 @@ ipc_handle_device_get_visibility_mask(volatile struct ipc_client_state *ics,
 	struct ipc_server *s = ics->server;
 	xrt_result_t xret;
 
-	// @todo verify
 	struct xrt_device *xdev = NULL;
 	GET_XDEV_OR_RETURN(ics, device_id, xdev);
+
+	// Made once and shared with all clients.
 	struct xrt_visibility_mask *mask = NULL;
-	if (xdev->get_visibility_mask) {
-		xret = xrt_device_get_visibility_mask(xdev, type, view_index, &mask);
-		if (xret != XRT_SUCCESS) {
-			IPC_ERROR(s, "Failed to get visibility mask");
-			return xret;
-		}
-	} else {
-		struct xrt_fov fov = xdev->hmd->distortion.fov[view_index];
-		u_visibility_mask_get_default(type, &fov, &mask);
+	xret = ipc_server_get_visibility_mask(s, device_id, type, view_index, &mask);
+	if (xret != XRT_SUCCESS) {
+		IPC_ERROR(s, "Failed to get visibility mask");
+		return xret;
 	}
 
 	if (mask == NULL) {
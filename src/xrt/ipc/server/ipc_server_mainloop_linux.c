@@ -20,6 +20,7 @@
 #include "util/u_misc.h"
 #include "util/u_debug.h"
 #include "util/u_trace_marker.h"
+#include "util/u_thread_policy.h"
 #include "util/u_file.h"
 
 #include "shared/ipc_shmem.h"
@@ -55,6 +56,14 @@
  */
 DEBUG_GET_ONCE_BOOL_OPTION(skip_stdin, "XRT_NO_STDIN", false)
 
+/*
+ * "IPC_DISPATCH_THREADS" serves all clients from this many worker threads
+ * instead of one thread per client, zero keeps the thread per client. Some
+ * commands block for as long as the client asks, like waiting on a swapchain
+ * image, so this is opt-in for now.
+ */
+DEBUG_GET_ONCE_NUM_OPTION(dispatch_threads, "IPC_DISPATCH_THREADS", 0)
+
 /*
  *
  * Static functions.
@@ -227,6 +236,338 @@ handle_listen(struct ipc_server *vs, struct ipc_server_mainloop *ml)
 #define NUM_POLL_EVENTS 8
 #define NO_SLEEP 0
 
+
+/*
+ *
+ * Client dispatcher.
+ *
+ */
+
+static bool
+dispatch_queue_push(struct ipc_dispatch_queue *q, volatile struct ipc_client_state *ics, uint32_t events)
+{
+	if (q->count >= ARRAY_SIZE(q->entries)) {
+		return false;
+	}
+
+	uint32_t index = (q->head + q->count) % ARRAY_SIZE(q->entries);
+	q->entries[index].ics = ics;
+	q->entries[index].events = events;
+	q->count++;
+
+	return true;
+}
+
+static bool
+dispatch_queue_pop(struct ipc_dispatch_queue *q, struct ipc_dispatch_entry *out_entry)
+{
+	if (q->count == 0) {
+		return false;
+	}
+
+	*out_entry = q->entries[q->head];
+	q->head = (q->head + 1) % ARRAY_SIZE(q->entries);
+	q->count--;
+
+	return true;
+}
+
+//! Must be called with the dispatch mutex held.
+static void
+dispatch_queue_client_locked(struct ipc_server_mainloop *ml, volatile struct ipc_client_state *ics, uint32_t events)
+{
+	int index = ics->server_thread_index;
+	assert(index >= 0 && index < IPC_MAX_CLIENTS);
+	assert(!ml->dispatch.busy[index]);
+
+	// Clients with a compositor are on the frame critical path.
+	struct ipc_dispatch_queue *q = ics->xc != NULL ? &ml->dispatch.frame_queue : &ml->dispatch.control_queue;
+
+	// Can't fail, a client is only ever queued once.
+	bool bret = dispatch_queue_push(q, ics, events);
+	assert(bret);
+	(void)bret;
+
+	ml->dispatch.busy[index] = true;
+}
+
+/*!
+ * Frame clients are always taken first, control clients are never allowed to
+ * take up the last worker so there is always one free for a frame client.
+ */
+static bool
+dispatch_take_locked(struct ipc_server_mainloop *ml, struct ipc_dispatch_entry *out_entry, bool *out_control)
+{
+	if (dispatch_queue_pop(&ml->dispatch.frame_queue, out_entry)) {
+		*out_control = false;
+		return true;
+	}
+
+	uint32_t control_limit = ml->dispatch.worker_count > 1 ? ml->dispatch.worker_count - 1 : 1;
+	if (ml->dispatch.control_busy_count < control_limit &&
+	    dispatch_queue_pop(&ml->dispatch.control_queue, out_entry)) {
+		ml->dispatch.control_busy_count++;
+		*out_control = true;
+		return true;
+	}
+
+	return false;
+}
+
+static void
+dispatch_rearm(struct ipc_server_mainloop *ml, volatile struct ipc_client_state *ics)
+{
+	struct epoll_event ev = {0};
+	ev.events = EPOLLIN | EPOLLONESHOT;
+	ev.data.ptr = (void *)ics;
+
+	int ret = epoll_ctl(ml->dispatch.epoll_fd, EPOLL_CTL_MOD, ics->imc.ipc_handle, &ev);
+	if (ret < 0) {
+		U_LOG_E("epoll_ctl(EPOLL_CTL_MOD) failed '%i'", ret);
+	}
+}
+
+static void
+dispatch_handle_client(struct ipc_server_mainloop *ml, struct ipc_dispatch_entry *entry)
+{
+	volatile struct ipc_client_state *ics = entry->ics;
+	int index = ics->server_thread_index;
+	bool keep = false;
+
+	if ((entry->events & EPOLLHUP) != 0) {
+		IPC_INFO(ics->server, "Client disconnected.");
+	} else if ((entry->events & EPOLLERR) != 0) {
+		IPC_ERROR(ics->server, "Error on client socket, disconnecting client.");
+	} else if (entry->events != 0) {
+		keep = ipc_server_client_dispatch_one(ics);
+	}
+
+	os_mutex_lock(&ml->dispatch.mutex);
+	keep = keep && ml->dispatch.running;
+	if (keep) {
+		// Re-armed with the lock held so the client isn't queued before it is idle.
+		dispatch_rearm(ml, ics);
+	} else {
+		ml->dispatch.clients[index] = NULL;
+	}
+	ml->dispatch.busy[index] = false;
+	os_mutex_unlock(&ml->dispatch.mutex);
+
+	if (keep) {
+		return;
+	}
+
+	epoll_ctl(ml->dispatch.epoll_fd, EPOLL_CTL_DEL, ics->imc.ipc_handle, NULL);
+
+	// After this the slot might be reused by a new client straight away.
+	ipc_server_client_shutdown_dispatched(ics);
+}
+
+static void *
+dispatch_worker_thread(void *ptr)
+{
+	U_TRACE_SET_THREAD_NAME("IPC Worker");
+	u_thread_policy_apply(U_LOGGING_INFO, OS_THREAD_ROLE_IPC, "IPC Worker");
+
+	struct ipc_server_mainloop *ml = (struct ipc_server_mainloop *)ptr;
+	struct ipc_dispatch_entry entry;
+	bool control = false;
+
+	os_mutex_lock(&ml->dispatch.mutex);
+
+	while (true) {
+		if (!dispatch_take_locked(ml, &entry, &control)) {
+			if (ml->dispatch.stopped && ml->dispatch.frame_queue.count == 0 &&
+			    ml->dispatch.control_queue.count == 0) {
+				break;
+			}
+
+			os_cond_wait(&ml->dispatch.cond, &ml->dispatch.mutex);
+			continue;
+		}
+
+		os_mutex_unlock(&ml->dispatch.mutex);
+
+		dispatch_handle_client(ml, &entry);
+
+		os_mutex_lock(&ml->dispatch.mutex);
+
+		if (control) {
+			// Another control client might be waiting for this worker.
+			ml->dispatch.control_busy_count--;
+			os_cond_signal(&ml->dispatch.cond);
+		}
+	}
+
+	os_mutex_unlock(&ml->dispatch.mutex);
+
+	return NULL;
+}
+
+static void *
+dispatch_thread(void *ptr)
+{
+	U_TRACE_SET_THREAD_NAME("IPC Dispatch");
+	u_thread_policy_apply(U_LOGGING_INFO, OS_THREAD_ROLE_IPC, "IPC Dispatch");
+
+	struct ipc_server_mainloop *ml = (struct ipc_server_mainloop *)ptr;
+	struct epoll_event events[NUM_POLL_EVENTS];
+
+	while (true) {
+		const int half_a_second_ms = 500;
+
+		// Times out to notice the server stopping.
+		int ret = epoll_wait(ml->dispatch.epoll_fd, events, NUM_POLL_EVENTS, half_a_second_ms);
+		if (ret < 0 && errno != EINTR) {
+			U_LOG_E("epoll_wait failed with '%i', stopping dispatcher.", ret);
+		}
+
+		os_mutex_lock(&ml->dispatch.mutex);
+
+		struct ipc_server *s = ml->dispatch.server;
+		if (ret < 0 && errno != EINTR) {
+			ml->dispatch.running = false;
+		}
+		if (s != NULL && !s->running) {
+			ml->dispatch.running = false;
+		}
+
+		if (!ml->dispatch.running) {
+			break;
+		}
+
+		for (int i = 0; i < ret; i++) {
+			dispatch_queue_client_locked(ml, events[i].data.ptr, events[i].events);
+		}
+
+		if (ret > 0) {
+			os_cond_broadcast(&ml->dispatch.cond);
+		}
+
+		os_mutex_unlock(&ml->dispatch.mutex);
+	}
+
+	// Clients being handled are shut down by their worker, queue all idle ones.
+	for (uint32_t i = 0; i < IPC_MAX_CLIENTS; i++) {
+		if (ml->dispatch.clients[i] != NULL && !ml->dispatch.busy[i]) {
+			dispatch_queue_client_locked(ml, ml->dispatch.clients[i], 0);
+		}
+	}
+
+	ml->dispatch.stopped = true;
+	os_cond_broadcast(&ml->dispatch.cond);
+	os_mutex_unlock(&ml->dispatch.mutex);
+
+	return NULL;
+}
+
+//! Stops and joins the dispatcher thread and the first @p started_workers workers.
+static void
+stop_dispatch(struct ipc_server_mainloop *ml, uint32_t started_workers)
+{
+	os_mutex_lock(&ml->dispatch.mutex);
+	ml->dispatch.running = false;
+	os_mutex_unlock(&ml->dispatch.mutex);
+
+	// Notices within its timeout, then queues all idle clients for the workers.
+	os_thread_join(&ml->dispatch.thread);
+
+	for (uint32_t i = 0; i < started_workers; i++) {
+		os_thread_join(&ml->dispatch.workers[i]);
+	}
+}
+
+static void
+destroy_dispatch(struct ipc_server_mainloop *ml)
+{
+	os_thread_destroy(&ml->dispatch.thread);
+	for (uint32_t i = 0; i < ml->dispatch.worker_count; i++) {
+		os_thread_destroy(&ml->dispatch.workers[i]);
+	}
+
+	os_cond_destroy(&ml->dispatch.cond);
+	os_mutex_destroy(&ml->dispatch.mutex);
+	close(ml->dispatch.epoll_fd);
+	ml->dispatch.epoll_fd = -1;
+	ml->dispatch.worker_count = 0;
+}
+
+static int
+init_dispatch(struct ipc_server_mainloop *ml)
+{
+	int64_t count = debug_get_num_option_dispatch_threads();
+	if (count <= 0) {
+		return 0;
+	}
+	if (count > IPC_MAX_DISPATCH_WORKERS) {
+		U_LOG_W("IPC_DISPATCH_THREADS=%lld too large, using %u", (long long)count, IPC_MAX_DISPATCH_WORKERS);
+		count = IPC_MAX_DISPATCH_WORKERS;
+	}
+
+	int ret = epoll_create1(EPOLL_CLOEXEC);
+	if (ret < 0) {
+		U_LOG_E("epoll_create1 failed '%i'", ret);
+		return ret;
+	}
+
+	ml->dispatch.epoll_fd = ret;
+	ml->dispatch.running = true;
+	ml->dispatch.stopped = false;
+
+	ret = os_mutex_init(&ml->dispatch.mutex);
+	if (ret < 0) {
+		close(ml->dispatch.epoll_fd);
+		return ret;
+	}
+
+	ret = os_cond_init(&ml->dispatch.cond);
+	if (ret < 0) {
+		os_mutex_destroy(&ml->dispatch.mutex);
+		close(ml->dispatch.epoll_fd);
+		return ret;
+	}
+
+	os_thread_init(&ml->dispatch.thread);
+	for (int64_t i = 0; i < count; i++) {
+		os_thread_init(&ml->dispatch.workers[i]);
+	}
+
+	ml->dispatch.worker_count = (uint32_t)count;
+
+	ret = os_thread_start(&ml->dispatch.thread, dispatch_thread, ml);
+	if (ret != 0) {
+		U_LOG_E("Failed to start dispatch thread '%i'", ret);
+		destroy_dispatch(ml);
+		return -1;
+	}
+
+	for (uint32_t i = 0; i < ml->dispatch.worker_count; i++) {
+		ret = os_thread_start(&ml->dispatch.workers[i], dispatch_worker_thread, ml);
+		if (ret != 0) {
+			U_LOG_E("Failed to start dispatch worker '%i'", ret);
+			stop_dispatch(ml, i);
+			destroy_dispatch(ml);
+			return -1;
+		}
+	}
+
+	U_LOG_I("Serving clients with %u dispatch worker(s).", ml->dispatch.worker_count);
+
+	return 0;
+}
+
+static void
+deinit_dispatch(struct ipc_server_mainloop *ml)
+{
+	if (ml->dispatch.worker_count == 0) {
+		return;
+	}
+
+	// Waits for all clients to be shut down.
+	stop_dispatch(ml, ml->dispatch.worker_count);
+	destroy_dispatch(ml);
+}
+
 /*
  *
  * Exported functions
@@ -280,9 +621,50 @@ ipc_server_mainloop_init(struct ipc_server_mainloop *ml)
 		ipc_server_mainloop_deinit(ml);
 		return ret;
 	}
+
+	ret = init_dispatch(ml);
+	if (ret < 0) {
+		ipc_server_mainloop_deinit(ml);
+		return ret;
+	}
+
 	return 0;
 }
 
+bool
+ipc_server_mainloop_add_client(struct ipc_server_mainloop *ml, volatile struct ipc_client_state *ics)
+{
+	if (ml->dispatch.worker_count == 0) {
+		return false;
+	}
+
+	int index = ics->server_thread_index;
+	assert(index >= 0 && index < IPC_MAX_CLIENTS);
+
+	IPC_INFO(ics->server, "Client %u connected", ics->client_state.id);
+
+	os_mutex_lock(&ml->dispatch.mutex);
+
+	ml->dispatch.server = ics->server;
+	ml->dispatch.clients[index] = ics;
+	ml->dispatch.busy[index] = false;
+
+	struct epoll_event ev = {0};
+	ev.events = EPOLLIN | EPOLLONESHOT;
+	ev.data.ptr = (void *)ics;
+
+	int ret = epoll_ctl(ml->dispatch.epoll_fd, EPOLL_CTL_ADD, ics->imc.ipc_handle, &ev);
+	if (ret < 0) {
+		U_LOG_E("epoll_ctl(client) failed '%i', queueing for disconnect.", ret);
+		dispatch_queue_client_locked(ml, ics, EPOLLERR);
+		os_cond_signal(&ml->dispatch.cond);
+	}
+
+	os_mutex_unlock(&ml->dispatch.mutex);
+
+	return true;
+}
+
 void
 ipc_server_mainloop_deinit(struct ipc_server_mainloop *ml)
 {
@@ -291,6 +673,8 @@ ipc_server_mainloop_deinit(struct ipc_server_mainloop *ml)
 	if (ml == NULL) {
 		return;
 	}
+
+	deinit_dispatch(ml);
 	if (ml->listen_socket > 0) {
 		// Close socket on exit
 		close(ml->listen_socket);
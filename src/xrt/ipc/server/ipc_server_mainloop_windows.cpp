@@ -124,8 +124,9 @@ create_pipe_instance(struct ipc_server_mainloop *ml, bool first)
 		lpsa = &sa;
 	}
 
-	DWORD dwOpenMode = PIPE_ACCESS_DUPLEX;
-	DWORD dwPipeMode = PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_NOWAIT | PIPE_REJECT_REMOTE_CLIENTS;
+	// All I/O is overlapped, both connecting and on the channel, see ipc_message_channel_windows.cpp.
+	DWORD dwOpenMode = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED;
+	DWORD dwPipeMode = PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS;
 
 	if (first) {
 		dwOpenMode |= FILE_FLAG_FIRST_PIPE_INSTANCE;
@@ -188,21 +189,54 @@ create_another_pipe_instance(struct ipc_server *vs, struct ipc_server_mainloop *
 static void
 handle_connected_client(struct ipc_server *vs, struct ipc_server_mainloop *ml)
 {
-	DWORD mode = PIPE_READMODE_MESSAGE | PIPE_WAIT;
-	BOOL bRet;
+	// Call into the generic client connected handling code.
+	ipc_server_handle_client_connected(vs, ml->pipe_handle);
 
-	bRet = SetNamedPipeHandleState(ml->pipe_handle, &mode, nullptr, nullptr);
-	if (bRet) {
-		// Call into the generic client connected handling code.
-		ipc_server_handle_client_connected(vs, ml->pipe_handle);
+	// Create another pipe to wait on.
+	create_another_pipe_instance(vs, ml);
+}
 
-		// Create another pipe to wait on.
-		create_another_pipe_instance(vs, ml);
+static void
+start_connect(struct ipc_server *vs, struct ipc_server_mainloop *ml)
+{
+	ml->connect_overlapped = {};
+	ml->connect_overlapped.hEvent = ml->connect_event;
+
+	// Always returns FALSE when overlapped.
+	if (ConnectNamedPipe(ml->pipe_handle, &ml->connect_overlapped)) {
+		DWORD err = GetLastError();
+		U_LOG_E("ConnectNamedPipe unexpected return TRUE treating as failure: %d %s", err, ipc_winerror(err));
+		ipc_server_handle_failure(vs);
+		return;
+	}
+
+	switch (DWORD err = GetLastError()) {
+	case ERROR_IO_PENDING: ml->connect_pending = true; return;
+	case ERROR_PIPE_CONNECTED: handle_connected_client(vs, ml); return;
+	default:
+		U_LOG_E("ConnectNamedPipe failed: %d %s", err, ipc_winerror(err));
+		ipc_server_handle_failure(vs);
+		return;
+	}
+}
+
+static void
+check_connect(struct ipc_server *vs, struct ipc_server_mainloop *ml)
+{
+	DWORD len;
+	if (GetOverlappedResult(ml->pipe_handle, &ml->connect_overlapped, &len, FALSE)) {
+		ml->connect_pending = false;
+		handle_connected_client(vs, ml);
 		return;
 	}
 
 	DWORD err = GetLastError();
-	U_LOG_E("SetNamedPipeHandleState(PIPE_READMODE_MESSAGE | PIPE_WAIT) failed: %d %s", err, ipc_winerror(err));
+	if (err == ERROR_IO_INCOMPLETE) {
+		return; // Still listening.
+	}
+
+	ml->connect_pending = false;
+	U_LOG_E("ConnectNamedPipe failed: %d %s", err, ipc_winerror(err));
 	ipc_server_handle_failure(vs);
 }
 
@@ -231,20 +265,11 @@ ipc_server_mainloop_poll(struct ipc_server *vs, struct ipc_server_mainloop *ml)
 		return; // Errors already logged.
 	}
 
-	if (ConnectNamedPipe(ml->pipe_handle, nullptr)) {
-		DWORD err = GetLastError();
-		U_LOG_E("ConnectNamedPipe unexpected return TRUE treating as failure: %d %s", err, ipc_winerror(err));
-		ipc_server_handle_failure(vs);
-		return;
+	if (!ml->connect_pending) {
+		start_connect(vs, ml);
 	}
-
-	switch (DWORD err = GetLastError()) {
-	case ERROR_PIPE_LISTENING: return;
-	case ERROR_PIPE_CONNECTED: handle_connected_client(vs, ml); return;
-	default:
-		U_LOG_E("ConnectNamedPipe failed: %d %s", err, ipc_winerror(err));
-		ipc_server_handle_failure(vs);
-		return;
+	if (ml->connect_pending) {
+		check_connect(vs, ml);
 	}
 }
 
@@ -255,6 +280,15 @@ ipc_server_mainloop_init(struct ipc_server_mainloop *ml)
 
 	ml->pipe_handle = INVALID_HANDLE_VALUE;
 	ml->pipe_name = nullptr;
+	ml->connect_pending = false;
+
+	// Manual reset, ConnectNamedPipe resets it when it starts.
+	ml->connect_event = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+	if (ml->connect_event == nullptr) {
+		DWORD err = GetLastError();
+		U_LOG_E("CreateEventA failed: %d %s", err, ipc_winerror(err));
+		return -1;
+	}
 
 	constexpr char pipe_prefix[] = "\\\\.\\pipe\\";
 	constexpr int prefix_len = sizeof(pipe_prefix) - 1;
@@ -290,10 +324,21 @@ ipc_server_mainloop_deinit(struct ipc_server_mainloop *ml)
 {
 	IPC_TRACE_MARKER();
 
+	if (ml->connect_pending) {
+		// The overlapped struct must stay valid until the cancel has completed.
+		DWORD len;
+		CancelIoEx(ml->pipe_handle, &ml->connect_overlapped);
+		GetOverlappedResult(ml->pipe_handle, &ml->connect_overlapped, &len, TRUE);
+		ml->connect_pending = false;
+	}
 	if (ml->pipe_handle != INVALID_HANDLE_VALUE) {
 		CloseHandle(ml->pipe_handle);
 		ml->pipe_handle = INVALID_HANDLE_VALUE;
 	}
+	if (ml->connect_event != nullptr) {
+		CloseHandle(ml->connect_event);
+		ml->connect_event = nullptr;
+	}
 	if (ml->pipe_name) {
 		free(ml->pipe_name);
 		ml->pipe_name = nullptr;
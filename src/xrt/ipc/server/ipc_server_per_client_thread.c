@@ -1,4 +1,4 @@
-// Copyright 2020-2023, Collabora, Ltd.
+// Copyright 2020-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -10,8 +10,11 @@
 
 #include "util/u_misc.h"
 #include "util/u_trace_marker.h"
+#include "util/u_thread_policy.h"
 
 #include "shared/ipc_utils.h"
+#include "shared/ipc_shmem.h"
+#include "shared/ipc_record.h"
 #include "server/ipc_server.h"
 #include "ipc_server_generated.h"
 
@@ -28,6 +31,11 @@
 
 #endif // XRT_OS_WINDOWS
 
+#ifdef XRT_OS_LINUX
+#include "shared/ipc_ring.h"
+#include "shared/ipc_futex.h"
+#endif
+
 
 /*
  *
@@ -70,6 +78,13 @@ common_shutdown(volatile struct ipc_client_state *ics)
 
 	ipc_message_channel_close((struct ipc_message_channel *)&ics->imc);
 
+#ifdef XRT_OS_LINUX
+	if (ics->ring != NULL) {
+		// Cast away volatile.
+		ipc_shmem_destroy((xrt_shmem_handle_t *)&ics->ring_handle, (void **)&ics->ring, sizeof(struct ipc_ring));
+	}
+#endif
+
 	ics->server->threads[ics->server_thread_index].state = IPC_THREAD_STOPPING;
 	ics->server_thread_index = -1;
 	memset((void *)&ics->client_state, 0, sizeof(struct ipc_app_state));
@@ -87,6 +102,9 @@ common_shutdown(volatile struct ipc_client_state *ics)
 	// If the session hasn't been stopped, destroy the compositor.
 	ipc_server_client_destroy_session_and_compositor(ics);
 
+	// Cast away volatile, does NULL checking.
+	ipc_record_writer_destroy((struct ipc_record_writer **)&ics->recorder);
+
 	// Make sure undestroyed spaces are unreferenced
 	for (uint32_t i = 0; i < IPC_MAX_CLIENT_SPACES; i++) {
 		// Cast away volatile.
@@ -123,8 +141,20 @@ common_shutdown(volatile struct ipc_client_state *ics)
 			continue;
 		}
 
-		xrt_system_devices_feature_dec(ics->server->xsysd, (enum xrt_device_feature_type)i);
 		ics->device_feature_used[i] = false;
+
+		// On warm standby the server takes over the first use of each feature, keeping it running.
+		bool keep = false;
+		if (ics->server->warm_standby.enabled) {
+			os_mutex_lock(&ics->server->global_state.lock);
+			keep = !ics->server->warm_standby.device_feature_used[i];
+			ics->server->warm_standby.device_feature_used[i] = true;
+			os_mutex_unlock(&ics->server->global_state.lock);
+		}
+
+		if (!keep) {
+			xrt_system_devices_feature_dec(ics->server->xsysd, (enum xrt_device_feature_type)i);
+		}
 	}
 
 	// Make sure undestroyed plane detections are cleaned up
@@ -137,6 +167,9 @@ common_shutdown(volatile struct ipc_client_state *ics)
 	ics->plane_detection_xdev = NULL;
 	ics->plane_detection_size = 0;
 	ics->plane_detection_count = 0;
+	xrt_plane_detections_ext_clear((struct xrt_plane_detections_ext *)&ics->plane_detections_sent.detections);
+	ics->plane_detections_sent.plane_detection_id = 0;
+	ics->plane_detections_sent.revision = 0;
 
 	// Should we stop the server when a client disconnects?
 	if (ics->server->exit_on_disconnect) {
@@ -190,10 +223,188 @@ setup_epoll(volatile struct ipc_client_state *ics)
 	return epoll_fd;
 }
 
+/*!
+ * Reads one command from the socket and dispatches it, returns false if the
+ * client should be disconnected, the reason has then already been logged.
+ */
+static bool
+handle_one_command(volatile struct ipc_client_state *ics, enum ipc_command *out_cmd)
+{
+	// Peek the first 4 bytes to get the command type
+	enum ipc_command cmd;
+	ssize_t len = recv(ics->imc.ipc_handle, &cmd, sizeof(cmd), MSG_PEEK);
+	if (len != sizeof(cmd)) {
+		IPC_ERROR(ics->server, "Invalid command received.");
+		return false;
+	}
+
+	size_t cmd_size = ipc_command_size(cmd);
+	if (cmd_size == 0) {
+		IPC_ERROR(ics->server, "Invalid command size.");
+		return false;
+	}
+
+	*out_cmd = cmd;
+
+	// Read the whole command now that we know its size
+	uint8_t buf[IPC_BUF_SIZE] = {0};
+
+	len = recv(ics->imc.ipc_handle, &buf, cmd_size, 0);
+	if (len != (ssize_t)cmd_size) {
+		IPC_ERROR(ics->server, "Invalid packet received, disconnecting client.");
+		return false;
+	}
+
+	// Check the first 4 bytes of the message and dispatch.
+	ipc_command_t *ipc_command = (ipc_command_t *)buf;
+
+	IPC_TRACE_BEGIN(ipc_dispatch);
+	xrt_result_t result = ipc_dispatch(ics, ipc_command);
+	IPC_TRACE_END(ipc_dispatch);
+
+	if (result != XRT_SUCCESS) {
+		IPC_ERROR(ics->server, "During packet handling, disconnecting client.");
+		return false;
+	}
+
+	return true;
+}
+
+#ifdef XRT_OS_LINUX
+static bool
+client_hung_up(volatile struct ipc_client_state *ics)
+{
+	char c;
+	return recv(ics->imc.ipc_handle, &c, sizeof(c), MSG_PEEK | MSG_DONTWAIT) == 0;
+}
+
+/*!
+ * After the empty ring command the client sends any queued async commands and
+ * then one command that is replied to over the socket.
+ */
+static bool
+handle_socket_commands(volatile struct ipc_client_state *ics)
+{
+	enum ipc_command cmd = IPC_ERR;
+
+	do {
+		if (!handle_one_command(ics, &cmd)) {
+			return false;
+		}
+	} while (ipc_command_is_async(cmd));
+
+	return true;
+}
+
+/*!
+ * Dispatches the commands posted on the ring, any async commands and then at
+ * most one command that is replied to. Returns false if the client should be
+ * disconnected, the reason has then already been logged.
+ */
+static bool
+handle_one_ring_command(volatile struct ipc_client_state *ics, int32_t seq)
+{
+	uint8_t buf[IPC_RING_COMMAND_SIZE] = {0};
+	uint32_t size = 0;
+
+	if (!ipc_ring_service_read_command(ics->ring, buf, sizeof(buf), &size)) {
+		IPC_ERROR(ics->server, "Invalid ring command size, disconnecting client.");
+		return false;
+	}
+
+	// The client sends the next commands over the socket, it is replied to there.
+	if (size == 0) {
+		return handle_socket_commands(ics);
+	}
+
+	uint32_t offset = 0;
+	bool replied = false;
+
+	while (offset < size) {
+		ipc_command_t *ipc_command = (ipc_command_t *)&buf[offset];
+		uint32_t remaining = size - offset;
+
+		size_t cmd_size = remaining >= sizeof(*ipc_command) ? ipc_command_size(*ipc_command) : 0;
+		if (cmd_size == 0 || cmd_size > remaining || !ipc_command_allowed_on_ring(*ipc_command)) {
+			IPC_ERROR(ics->server, "Invalid ring command received, disconnecting client.");
+			return false;
+		}
+
+		// Only the last command may be replied to.
+		bool is_async = ipc_command_is_async(*ipc_command);
+		if (!is_async && offset + cmd_size != size) {
+			IPC_ERROR(ics->server, "Ring command after a synchronous one, disconnecting client.");
+			return false;
+		}
+
+		ics->ring_seq = seq;
+		ics->reply_on_ring = !is_async;
+
+		IPC_TRACE_BEGIN(ipc_dispatch);
+		xrt_result_t result = ipc_dispatch(ics, ipc_command);
+		IPC_TRACE_END(ipc_dispatch);
+
+		ics->reply_on_ring = false;
+
+		if (result != XRT_SUCCESS) {
+			IPC_ERROR(ics->server, "During packet handling, disconnecting client.");
+			return false;
+		}
+
+		replied = !is_async;
+		offset += (uint32_t)cmd_size;
+	}
+
+	// The client waits for this even if there was nothing to reply to.
+	if (!replied) {
+		ipc_ring_service_reply(ics->ring, seq, NULL, 0);
+	}
+
+	return true;
+}
+
+/*!
+ * Once the client has set up the ring every command is first posted there, so
+ * the socket is only read when the ring says so.
+ */
+static void
+ring_loop(volatile struct ipc_client_state *ics)
+{
+	const uint64_t half_a_second_ns = 500 * U_TIME_1MS_IN_NS;
+
+	// Freshly created and zeroed, the client might already have posted the first command.
+	int32_t last_seq = 0;
+
+	while (ics->server->running) {
+		if (!ipc_ring_service_wait_command(ics->ring, last_seq, half_a_second_ns)) {
+			// Timed out, the socket tells us if the client went away.
+			if (client_hung_up(ics)) {
+				IPC_INFO(ics->server, "Client disconnected.");
+				break;
+			}
+			continue;
+		}
+
+		// Calls are synchronous, so there is only ever one new command.
+		int32_t seq = xrt_atomic_s32_load_acquire(&ics->ring->command_seq);
+		if (seq != last_seq + 1) {
+			IPC_ERROR(ics->server, "Ring command out of sequence, disconnecting client.");
+			break;
+		}
+		last_seq = seq;
+
+		if (!handle_one_ring_command(ics, seq)) {
+			break;
+		}
+	}
+}
+#endif // XRT_OS_LINUX
+
 static void
 client_loop(volatile struct ipc_client_state *ics)
 {
 	U_TRACE_SET_THREAD_NAME("IPC Client");
+	u_thread_policy_apply(ics->server->log_level, OS_THREAD_ROLE_IPC, "IPC Client");
 
 	IPC_INFO(ics->server, "Client %u connected", ics->client_state.id);
 
@@ -230,40 +441,18 @@ client_loop(volatile struct ipc_client_state *ics)
 			break;
 		}
 
-		// Peek the first 4 bytes to get the command type
-		enum ipc_command cmd;
-		ssize_t len = recv(ics->imc.ipc_handle, &cmd, sizeof(cmd), MSG_PEEK);
-		if (len != sizeof(cmd)) {
-			IPC_ERROR(ics->server, "Invalid command received.");
+		enum ipc_command cmd = IPC_ERR;
+		if (!handle_one_command(ics, &cmd)) {
 			break;
 		}
 
-		size_t cmd_size = ipc_command_size(cmd);
-		if (cmd_size == 0) {
-			IPC_ERROR(ics->server, "Invalid command size.");
-			break;
-		}
-
-		// Read the whole command now that we know its size
-		uint8_t buf[IPC_BUF_SIZE] = {0};
-
-		len = recv(ics->imc.ipc_handle, &buf, cmd_size, 0);
-		if (len != (ssize_t)cmd_size) {
-			IPC_ERROR(ics->server, "Invalid packet received, disconnecting client.");
-			break;
-		}
-
-		// Check the first 4 bytes of the message and dispatch.
-		ipc_command_t *ipc_command = (ipc_command_t *)buf;
-
-		IPC_TRACE_BEGIN(ipc_dispatch);
-		xrt_result_t result = ipc_dispatch(ics, ipc_command);
-		IPC_TRACE_END(ipc_dispatch);
-
-		if (result != XRT_SUCCESS) {
-			IPC_ERROR(ics->server, "During packet handling, disconnecting client.");
+#ifdef XRT_OS_LINUX
+		// The client has switched to the ring, stays there until it disconnects.
+		if (ics->ring != NULL) {
+			ring_loop(ics);
 			break;
 		}
+#endif
 	}
 
 	close(epoll_fd);
@@ -291,6 +480,7 @@ static void
 client_loop(volatile struct ipc_client_state *ics)
 {
 	U_TRACE_SET_THREAD_NAME("IPC Client");
+	u_thread_policy_apply(ics->server->log_level, OS_THREAD_ROLE_IPC, "IPC Client");
 
 	IPC_INFO(ics->server, "Client connected");
 
@@ -369,6 +559,8 @@ ipc_server_client_destroy_session_and_compositor(volatile struct ipc_client_stat
 	os_mutex_lock(&ics->server->global_state.lock);
 
 	ics->swapchain_count = 0;
+	ics->swapchain_memory_size = 0;
+	ics->compositor_semaphore_count = 0;
 
 	// Destroy all swapchains now.
 	for (uint32_t j = 0; j < IPC_MAX_CLIENT_SWAPCHAINS; j++) {
@@ -386,6 +578,9 @@ ipc_server_client_destroy_session_and_compositor(volatile struct ipc_client_stat
 
 	os_mutex_unlock(&ics->server->global_state.lock);
 
+	// Don't leave the client sleeping in wait frame for a compositor that is gone.
+	ipc_server_client_wake_frame(ics);
+
 	// Cast away volatile.
 	xrt_comp_destroy((struct xrt_compositor **)&ics->xc);
 
@@ -402,3 +597,73 @@ ipc_server_client_thread(void *_ics)
 
 	return NULL;
 }
+
+xrt_result_t
+ipc_server_send_reply(volatile struct ipc_client_state *ics, const void *data, size_t size)
+{
+#ifdef XRT_OS_LINUX
+	if (ics->reply_on_ring) {
+		if (!ipc_ring_service_reply(ics->ring, ics->ring_seq, data, (uint32_t)size)) {
+			IPC_ERROR(ics->server, "Reply too large for the ring: %zu", size);
+			return XRT_ERROR_IPC_FAILURE;
+		}
+		return XRT_SUCCESS;
+	}
+#endif
+
+	return ipc_send((struct ipc_message_channel *)&ics->imc, data, size);
+}
+
+void
+ipc_server_record_async_result(volatile struct ipc_client_state *ics, xrt_result_t result)
+{
+	if (result == XRT_SUCCESS) {
+		return;
+	}
+
+	IPC_WARN(ics->server, "Async call failed: %d", result);
+
+	// Only keep the first failure until the client has picked it up.
+	xrt_atomic_s32_t *async_result = &ipc_shared_async_results(ics->server->ism)[ics->server_thread_index];
+	xrt_atomic_s32_cmpxchg(async_result, XRT_SUCCESS, result);
+}
+
+void
+ipc_server_client_wake_frame(volatile struct ipc_client_state *ics)
+{
+	struct ipc_shared_frame_wake *wake = &ipc_shared_frame_wakes(ics->server->ism)[ics->server_thread_index];
+
+	// Full barrier, the client either sees the new value or we see it waiting.
+	xrt_atomic_s32_inc_return(&wake->wake_seq);
+
+#ifdef XRT_OS_LINUX
+	if (xrt_atomic_s32_load_acquire(&wake->client_waiting) != 0) {
+		ipc_futex_wake(&wake->wake_seq);
+	}
+#endif
+}
+
+#ifndef XRT_OS_WINDOWS
+
+bool
+ipc_server_client_dispatch_one(volatile struct ipc_client_state *ics)
+{
+	enum ipc_command cmd = IPC_ERR;
+	return handle_one_command(ics, &cmd);
+}
+
+void
+ipc_server_client_shutdown_dispatched(volatile struct ipc_client_state *ics)
+{
+	struct ipc_server *s = ics->server;
+	int32_t index = ics->server_thread_index;
+
+	common_shutdown(ics);
+
+	// There is no thread to join, the slot can be reused once all is cleaned up.
+	os_mutex_lock(&s->global_state.lock);
+	s->threads[index].state = IPC_THREAD_READY;
+	os_mutex_unlock(&s->global_state.lock);
+}
+
+#endif // !XRT_OS_WINDOWS
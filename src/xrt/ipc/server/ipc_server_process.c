@@ -1,4 +1,4 @@
-// Copyright 2020-2024, Collabora, Ltd.
+// Copyright 2020-2025, Collabora, Ltd.
 // Copyright 2024-2025, NVIDIA CORPORATION.
 // SPDX-License-Identifier: BSL-1.0
 /*!
@@ -27,10 +27,13 @@
 #include "util/u_process.h"
 #include "util/u_debug_gui.h"
 #include "util/u_pretty_print.h"
+#include "util/u_visibility_mask.h"
 
 #include "util/u_git_tag.h"
+#include "util/u_lock_stats.h"
 
 #include "shared/ipc_shmem.h"
+#include "shared/ipc_seqlock.h"
 #include "server/ipc_server.h"
 #include "server/ipc_server_interface.h"
 
@@ -59,6 +62,10 @@
 DEBUG_GET_ONCE_BOOL_OPTION(exit_on_disconnect, "IPC_EXIT_ON_DISCONNECT", false)
 DEBUG_GET_ONCE_BOOL_OPTION(exit_when_idle, "IPC_EXIT_WHEN_IDLE", false)
 DEBUG_GET_ONCE_NUM_OPTION(exit_when_idle_delay_ms, "IPC_EXIT_WHEN_IDLE_DELAY_MS", 5000)
+DEBUG_GET_ONCE_BOOL_OPTION(warm_standby, "IPC_WARM_STANDBY", false)
+DEBUG_GET_ONCE_BOOL_OPTION(view_pose_cache, "IPC_VIEW_POSE_CACHE", true)
+DEBUG_GET_ONCE_NUM_OPTION(input_publish_interval_us, "IPC_INPUT_PUBLISH_INTERVAL_US", 2000)
+DEBUG_GET_ONCE_NUM_OPTION(client_limit, "IPC_CLIENT_LIMIT", IPC_DEFAULT_CLIENT_LIMIT)
 DEBUG_GET_ONCE_LOG_OPTION(ipc_log, "IPC_LOG", U_LOGGING_INFO)
 
 
@@ -92,6 +99,11 @@ init_idev(struct ipc_device *idev, struct xrt_device *xdev)
 	if (xdev != NULL) {
 		idev->io_active = true;
 		idev->xdev = xdev;
+		idev->view_pose_cache.valid = false;
+		os_mutex_init(&idev->view_pose_cache.mutex);
+		os_mutex_set_name(&idev->view_pose_cache.mutex, "ipc_server.view_pose_cache");
+		U_ZERO(&idev->visibility_mask_cache.entries);
+		os_mutex_init(&idev->visibility_mask_cache.mutex);
 	} else {
 		idev->io_active = false;
 	}
@@ -100,6 +112,17 @@ init_idev(struct ipc_device *idev, struct xrt_device *xdev)
 static void
 teardown_idev(struct ipc_device *idev)
 {
+	if (idev->xdev != NULL) {
+		os_mutex_destroy(&idev->view_pose_cache.mutex);
+
+		for (uint32_t i = 0; i < XRT_MAX_VIEWS; i++) {
+			for (uint32_t k = 0; k < IPC_VISIBILITY_MASK_TYPE_COUNT; k++) {
+				free(idev->visibility_mask_cache.entries[i][k].mask);
+				idev->visibility_mask_cache.entries[i][k].mask = NULL;
+			}
+		}
+		os_mutex_destroy(&idev->visibility_mask_cache.mutex);
+	}
 	idev->io_active = false;
 }
 
@@ -125,6 +148,236 @@ teardown_idevs(struct ipc_server *s)
 }
 
 
+/*
+ *
+ * Input publisher functions.
+ *
+ */
+
+static void
+publish_device_inputs(struct ipc_server *s, uint32_t device_id)
+{
+	struct ipc_shared_memory *ism = s->ism;
+	struct ipc_shared_device *isdev = &ism->isdevs[device_id];
+	struct xrt_device *xdev = s->idevs[device_id].xdev;
+
+	if (xdev == NULL || isdev->input_count == 0) {
+		return;
+	}
+
+	xrt_result_t xret = xrt_device_update_inputs(xdev);
+	if (xret != XRT_SUCCESS) {
+		// Clients keep the last published state, called too often to warn.
+		IPC_TRACE(s, "Failed to update inputs of '%s'", xdev->str);
+		return;
+	}
+
+	struct xrt_input *src = xdev->inputs;
+	struct xrt_input *dst = &ipc_shared_inputs(ism)[isdev->first_input_index];
+	uint32_t count = isdev->input_count;
+
+	/*
+	 * Most devices get new data slower than we publish, only we write the
+	 * shared copy so it can be compared against without the seqlock. When
+	 * nothing changed the generation stays the same and clients skip it.
+	 */
+	uint32_t first = 0;
+	while (first < count && memcmp(&dst[first], &src[first], sizeof(struct xrt_input)) == 0) {
+		first++;
+	}
+	if (first == count) {
+		return;
+	}
+
+	ipc_seqlock_write_begin(&isdev->input_generation);
+	for (uint32_t i = first; i < count; i++) {
+		if (memcmp(&dst[i], &src[i], sizeof(struct xrt_input)) != 0) {
+			dst[i] = src[i];
+		}
+	}
+	ipc_seqlock_write_end(&isdev->input_generation);
+}
+
+static void
+publish_hand_trackers(struct ipc_server *s)
+{
+	struct ipc_shared_memory *ism = s->ism;
+	struct ipc_shared_hand_tracker *trackers = ipc_shared_hand_trackers(ism);
+	int64_t now_ns = (int64_t)os_monotonic_get_ns();
+
+	for (uint32_t i = 0; i < ism->hand_trackers.count; i++) {
+		struct ipc_shared_hand_tracker *ist = &trackers[i];
+		struct xrt_device *xdev = s->idevs[ist->device_id].xdev;
+
+		struct xrt_hand_joint_set value;
+		int64_t timestamp_ns = 0;
+		xrt_result_t xret = xrt_device_get_hand_tracking(xdev, ist->name, now_ns, &value, &timestamp_ns);
+		if (xret != XRT_SUCCESS) {
+			IPC_TRACE(s, "Failed to get hand tracking of '%s'", xdev->str);
+			continue;
+		}
+
+		// Drivers return the same sample until they have a new one, clients need increasing timestamps.
+		uint32_t latest = (ist->sample_count - 1) % IPC_HAND_TRACKER_SAMPLE_COUNT;
+		if (ist->sample_count > 0 && timestamp_ns <= ist->timestamps_ns[latest]) {
+			continue;
+		}
+
+		uint32_t index = ist->sample_count % IPC_HAND_TRACKER_SAMPLE_COUNT;
+
+		ipc_seqlock_write_begin(&ist->generation);
+		ist->timestamps_ns[index] = timestamp_ns;
+		ist->values[index] = value;
+		ist->sample_count++;
+		ipc_seqlock_write_end(&ist->generation);
+	}
+}
+
+//! Bytes of the face or body set used by @p name, 0 for inputs that aren't published.
+static uint32_t
+body_face_value_size(enum xrt_input_name name)
+{
+	switch (name) {
+	case XRT_INPUT_HTC_EYE_FACE_TRACKING: return sizeof(struct xrt_facial_eye_expression_set_htc);
+	case XRT_INPUT_HTC_LIP_FACE_TRACKING: return sizeof(struct xrt_facial_lip_expression_set_htc);
+	case XRT_INPUT_FB_FACE_TRACKING2_AUDIO:
+	case XRT_INPUT_FB_FACE_TRACKING2_VISUAL: return sizeof(struct xrt_facial_expression_set2_fb);
+	case XRT_INPUT_FB_BODY_TRACKING: return sizeof(struct xrt_body_joint_set_fb);
+	case XRT_INPUT_META_FULL_BODY_TRACKING: return sizeof(struct xrt_full_body_joint_set_meta);
+	default: return 0;
+	}
+}
+
+static void
+get_face_sample_state(enum xrt_input_name name,
+                      const struct xrt_facial_expression_set *value,
+                      int64_t *out_timestamp_ns,
+                      bool *out_active)
+{
+	if (name == XRT_INPUT_FB_FACE_TRACKING2_AUDIO || name == XRT_INPUT_FB_FACE_TRACKING2_VISUAL) {
+		*out_timestamp_ns = (int64_t)value->face_expression_set2_fb.sample_time_ns;
+		*out_active = value->face_expression_set2_fb.is_valid;
+	} else {
+		*out_timestamp_ns = value->base_expression_set_htc.sample_time_ns;
+		*out_active = value->base_expression_set_htc.is_active;
+	}
+}
+
+static void
+publish_body_face_trackers(struct ipc_server *s)
+{
+	struct ipc_shared_memory *ism = s->ism;
+	struct ipc_shared_body_face_tracker *trackers = ipc_shared_body_face_trackers(ism);
+	int64_t now_ns = (int64_t)os_monotonic_get_ns();
+
+	for (uint32_t i = 0; i < ism->body_face_trackers.count; i++) {
+		struct ipc_shared_body_face_tracker *ist = &trackers[i];
+		struct xrt_device *xdev = s->idevs[ist->device_id].xdev;
+		bool is_body = XRT_GET_INPUT_TYPE(ist->name) == XRT_INPUT_TYPE_BODY_TRACKING;
+
+		struct xrt_facial_expression_set face;
+		struct xrt_body_joint_set body;
+		int64_t timestamp_ns = 0;
+		bool active = false;
+		xrt_result_t xret;
+
+		if (is_body) {
+			xret = xrt_device_get_body_joints(xdev, ist->name, now_ns, &body);
+			timestamp_ns = body.base_body_joint_set_meta.sample_time_ns;
+			active = body.base_body_joint_set_meta.is_active;
+		} else {
+			xret = xrt_device_get_face_tracking(xdev, ist->name, now_ns, &face);
+			get_face_sample_state(ist->name, &face, &timestamp_ns, &active);
+		}
+
+		if (xret != XRT_SUCCESS) {
+			IPC_TRACE(s, "Failed to get face or body tracking of '%s'", xdev->str);
+			continue;
+		}
+
+		// Only new samples or tracking being lost or found, so clients can skip unchanged ones.
+		if (ist->sample_count > 0 && timestamp_ns <= ist->timestamp_ns && active == ist->active) {
+			continue;
+		}
+
+		ipc_seqlock_write_begin(&ist->generation);
+		ist->timestamp_ns = timestamp_ns;
+		ist->active = active;
+		if (is_body) {
+			ist->body = body;
+		} else {
+			ist->face = face;
+		}
+		ist->sample_count++;
+		ipc_seqlock_write_end(&ist->generation);
+	}
+}
+
+static int
+input_publisher_loop(struct ipc_server *s)
+{
+	struct os_thread_helper *oth = &s->input_publisher.oth;
+
+	U_TRACE_SET_THREAD_NAME("IPC Input Publisher");
+	os_thread_helper_name(oth, "IPC Input Publisher");
+
+	struct os_precise_sleeper sleeper = {0};
+	os_precise_sleeper_init(&sleeper);
+
+	os_thread_helper_lock(oth);
+
+	while (os_thread_helper_is_running_locked(oth)) {
+		// Lock order is publisher then global state, see client connected.
+		os_mutex_lock(&s->global_state.lock);
+		uint32_t client_count = s->global_state.connected_client_count;
+		os_mutex_unlock(&s->global_state.lock);
+
+		// No need to poll the devices if nobody is listening.
+		if (client_count == 0) {
+			os_thread_helper_wait_locked(oth);
+			continue;
+		}
+
+		os_thread_helper_unlock(oth);
+
+		for (uint32_t i = 0; i < s->ism->isdev_count; i++) {
+			publish_device_inputs(s, i);
+		}
+
+		publish_hand_trackers(s);
+		publish_body_face_trackers(s);
+
+		os_precise_sleeper_nanosleep(&sleeper, (int32_t)s->input_publisher.interval_ns);
+
+		os_thread_helper_lock(oth);
+	}
+
+	os_thread_helper_unlock(oth);
+
+	os_precise_sleeper_deinit(&sleeper);
+
+	return 0;
+}
+
+static void *
+input_publisher_thread(void *ptr)
+{
+	return (void *)(intptr_t)input_publisher_loop((struct ipc_server *)ptr);
+}
+
+static void
+input_publisher_wake_up(struct ipc_server *s)
+{
+	if (s->input_publisher.interval_ns == 0) {
+		return;
+	}
+
+	os_thread_helper_lock(&s->input_publisher.oth);
+	os_thread_helper_signal_locked(&s->input_publisher.oth);
+	os_thread_helper_unlock(&s->input_publisher.oth);
+}
+
+
 /*
  *
  * Static functions.
@@ -195,6 +448,20 @@ teardown_all(struct ipc_server *s)
 {
 	u_var_remove_root(s);
 
+	// Uses the devices and shared memory, so stop it first.
+	os_thread_helper_destroy(&s->input_publisher.oth);
+
+	// Shuts down any clients served by the dispatcher, they use the compositor.
+	ipc_server_mainloop_deinit(&s->ml);
+
+	// All clients are gone, let go of the features kept for warm standby.
+	for (uint32_t i = 0; i < ARRAY_SIZE(s->warm_standby.device_feature_used); i++) {
+		if (s->warm_standby.device_feature_used[i]) {
+			xrt_system_devices_feature_dec(s->xsysd, (enum xrt_device_feature_type)i);
+			s->warm_standby.device_feature_used[i] = false;
+		}
+	}
+
 	xrt_syscomp_destroy(&s->xsysc);
 
 	teardown_idevs(s);
@@ -205,11 +472,12 @@ teardown_all(struct ipc_server *s)
 
 	xrt_instance_destroy(&s->xinst);
 
-	ipc_server_mainloop_deinit(&s->ml);
-
 	u_process_destroy(s->process);
 
-	ipc_shmem_destroy(&s->ism_handle, (void **)&s->ism, sizeof(struct ipc_shared_memory));
+	ipc_shmem_destroy(&s->ism_handle, (void **)&s->ism, s->ism_size);
+
+	free(s->threads);
+	s->threads = NULL;
 
 	// Destroyed last.
 	os_mutex_destroy(&s->global_state.lock);
@@ -255,7 +523,7 @@ handle_binding(struct ipc_shared_memory *ism,
 	// Copy the initial state and also count the number in input_pairs.
 	uint32_t input_pair_start = input_pair_index;
 	for (size_t k = 0; k < xbp->input_count; k++) {
-		ism->input_pairs[input_pair_index++] = xbp->inputs[k];
+		ipc_shared_input_pairs(ism)[input_pair_index++] = xbp->inputs[k];
 	}
 
 	// Setup the 'offsets' and number of input_pairs.
@@ -267,7 +535,7 @@ handle_binding(struct ipc_shared_memory *ism,
 	// Copy the initial state and also count the number in outputs.
 	uint32_t output_pair_start = output_pair_index;
 	for (size_t k = 0; k < xbp->output_count; k++) {
-		ism->output_pairs[output_pair_index++] = xbp->outputs[k];
+		ipc_shared_output_pairs(ism)[output_pair_index++] = xbp->outputs[k];
 	}
 
 	// Setup the 'offsets' and number of output_pairs.
@@ -280,17 +548,94 @@ handle_binding(struct ipc_shared_memory *ism,
 	*output_pair_index_ptr = output_pair_index;
 }
 
+/*!
+ * Places a section of @p count elements of @p elem_size at the end of the
+ * mapping, keeping every section aligned.
+ */
+static void
+layout_section(struct ipc_shared_section *section, size_t elem_size, uint32_t count, size_t *size_ptr)
+{
+	size_t offset = *size_ptr;
+	offset = (offset + IPC_SHARED_SECTION_ALIGNMENT - 1) & ~(size_t)(IPC_SHARED_SECTION_ALIGNMENT - 1);
+
+	section->offset = (uint32_t)offset;
+	section->count = count;
+
+	*size_ptr = offset + elem_size * count;
+}
+
 XRT_CHECK_RESULT static xrt_result_t
 init_shm(struct ipc_server *s)
 {
-	const size_t size = sizeof(struct ipc_shared_memory);
 	xrt_shmem_handle_t handle;
 
+	// Count everything that goes into the sections first.
+	uint32_t input_count = 0;
+	uint32_t output_count = 0;
+	uint32_t binding_count = 0;
+	uint32_t input_pair_count = 0;
+	uint32_t output_pair_count = 0;
+	uint32_t hand_tracker_count = 0;
+	uint32_t body_face_tracker_count = 0;
+
+	for (size_t i = 0; i < XRT_SYSTEM_MAX_DEVICES; i++) {
+		struct xrt_device *xdev = s->idevs[i].xdev;
+		if (xdev == NULL) {
+			continue;
+		}
+
+		input_count += (uint32_t)xdev->input_count;
+
+		for (size_t k = 0; k < xdev->input_count; k++) {
+			if (XRT_GET_INPUT_TYPE(xdev->inputs[k].name) == XRT_INPUT_TYPE_HAND_TRACKING) {
+				hand_tracker_count++;
+			}
+			if (body_face_value_size(xdev->inputs[k].name) > 0) {
+				body_face_tracker_count++;
+			}
+		}
+		output_count += (uint32_t)xdev->output_count;
+		binding_count += (uint32_t)xdev->binding_profile_count;
+
+		for (size_t k = 0; k < xdev->binding_profile_count; k++) {
+			input_pair_count += (uint32_t)xdev->binding_profiles[k].input_count;
+			output_pair_count += (uint32_t)xdev->binding_profiles[k].output_count;
+		}
+	}
+
+	// Sections go after the header, the header is written to the mapping below.
+	struct ipc_shared_memory layout = {0};
+	size_t size = sizeof(struct ipc_shared_memory);
+
+	layout_section(&layout.inputs, sizeof(struct xrt_input), input_count, &size);
+	layout_section(&layout.outputs, sizeof(struct xrt_output), output_count, &size);
+	layout_section(&layout.binding_profiles, sizeof(struct ipc_shared_binding_profile), binding_count, &size);
+	layout_section(&layout.input_pairs, sizeof(struct xrt_binding_input_pair), input_pair_count, &size);
+	layout_section(&layout.output_pairs, sizeof(struct xrt_binding_output_pair), output_pair_count, &size);
+	layout_section(&layout.slots, sizeof(struct ipc_layer_slot), s->max_clients, &size);
+	layout_section(&layout.space_snapshots, sizeof(struct ipc_shared_space_snapshot), s->max_clients, &size);
+	layout_section(&layout.client_io_active, sizeof(bool), s->max_clients, &size);
+	layout_section(&layout.async_results, sizeof(xrt_atomic_s32_t), s->max_clients, &size);
+	layout_section(&layout.hand_trackers, sizeof(struct ipc_shared_hand_tracker), hand_tracker_count, &size);
+	layout_section(&layout.frame_wakes, sizeof(struct ipc_shared_frame_wake), s->max_clients, &size);
+	layout_section(&layout.body_face_trackers, sizeof(struct ipc_shared_body_face_tracker), body_face_tracker_count,
+	               &size);
+	layout_section(&layout.swapchains, sizeof(struct ipc_shared_swapchain),
+	               s->max_clients * IPC_MAX_CLIENT_SWAPCHAINS, &size);
+
+	if (size > UINT32_MAX) {
+		IPC_ERROR(s, "Shared memory too large (%zu bytes)", size);
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
 	xrt_result_t xret = ipc_shmem_create(size, &handle, (void **)&s->ism);
 	IPC_CHK_AND_RET(s, xret, "ipc_shmem_create");
 
 	// we have a filehandle, we will pass this to our client
 	s->ism_handle = handle;
+	s->ism_size = size;
+
+	IPC_INFO(s, "Shared memory is %zu bytes for %u clients", size, s->max_clients);
 
 
 	/*
@@ -302,6 +647,23 @@ init_shm(struct ipc_server *s)
 	uint32_t count = 0;
 	struct ipc_shared_memory *ism = s->ism;
 
+	ism->version = IPC_SHARED_MEMORY_VERSION;
+	ism->size = (uint32_t)size;
+	ism->max_clients = s->max_clients;
+	ism->inputs = layout.inputs;
+	ism->outputs = layout.outputs;
+	ism->binding_profiles = layout.binding_profiles;
+	ism->input_pairs = layout.input_pairs;
+	ism->output_pairs = layout.output_pairs;
+	ism->slots = layout.slots;
+	ism->space_snapshots = layout.space_snapshots;
+	ism->client_io_active = layout.client_io_active;
+	ism->async_results = layout.async_results;
+	ism->hand_trackers = layout.hand_trackers;
+	ism->frame_wakes = layout.frame_wakes;
+	ism->body_face_trackers = layout.body_face_trackers;
+	ism->swapchains = layout.swapchains;
+
 	ism->startup_timestamp = os_monotonic_get_ns();
 
 	// Setup the tracking origins.
@@ -330,6 +692,8 @@ init_shm(struct ipc_server *s)
 	uint32_t binding_index = 0;
 	uint32_t input_pair_index = 0;
 	uint32_t output_pair_index = 0;
+	uint32_t hand_tracker_index = 0;
+	uint32_t body_face_tracker_index = 0;
 
 	for (size_t i = 0; i < XRT_SYSTEM_MAX_DEVICES; i++) {
 		struct xrt_device *xdev = s->idevs[i].xdev;
@@ -346,6 +710,7 @@ init_shm(struct ipc_server *s)
 		// Copy information.
 		isdev->device_type = xdev->device_type;
 		isdev->supported = xdev->supported;
+		isdev->io_active = s->idevs[i].io_active;
 
 		// Setup the tracking origin.
 		isdev->tracking_origin_index = (uint32_t)-1;
@@ -366,7 +731,7 @@ init_shm(struct ipc_server *s)
 		// Bindings
 		uint32_t binding_start = binding_index;
 		for (size_t k = 0; k < xdev->binding_profile_count; k++) {
-			handle_binding(ism, &xdev->binding_profiles[k], &ism->binding_profiles[binding_index++],
+			handle_binding(ism, &xdev->binding_profiles[k], &ipc_shared_binding_profiles(ism)[binding_index++],
 			               &input_pair_index, &output_pair_index);
 		}
 
@@ -379,7 +744,7 @@ init_shm(struct ipc_server *s)
 		// Copy the initial state and also count the number in inputs.
 		uint32_t input_start = input_index;
 		for (size_t k = 0; k < xdev->input_count; k++) {
-			ism->inputs[input_index++] = xdev->inputs[k];
+			ipc_shared_inputs(ism)[input_index++] = xdev->inputs[k];
 		}
 
 		// Setup the 'offsets' and number of inputs.
@@ -388,10 +753,35 @@ init_shm(struct ipc_server *s)
 			isdev->first_input_index = input_start;
 		}
 
+		// Hand tracking inputs get their joints published, if the publisher runs.
+		for (size_t k = 0; k < xdev->input_count; k++) {
+			if (XRT_GET_INPUT_TYPE(xdev->inputs[k].name) != XRT_INPUT_TYPE_HAND_TRACKING) {
+				continue;
+			}
+
+			struct ipc_shared_hand_tracker *ist = &ipc_shared_hand_trackers(ism)[hand_tracker_index++];
+			ist->device_id = count - 1;
+			ist->name = xdev->inputs[k].name;
+		}
+
+		// Same for the face and body tracking inputs we know the layout of.
+		for (size_t k = 0; k < xdev->input_count; k++) {
+			uint32_t value_size = body_face_value_size(xdev->inputs[k].name);
+			if (value_size == 0) {
+				continue;
+			}
+
+			struct ipc_shared_body_face_tracker *ist =
+			    &ipc_shared_body_face_trackers(ism)[body_face_tracker_index++];
+			ist->device_id = count - 1;
+			ist->name = xdev->inputs[k].name;
+			ist->value_size = value_size;
+		}
+
 		// Copy the initial state and also count the number in outputs.
 		uint32_t output_start = output_index;
 		for (size_t k = 0; k < xdev->output_count; k++) {
-			ism->outputs[output_index++] = xdev->outputs[k];
+			ipc_shared_outputs(ism)[output_index++] = xdev->outputs[k];
 		}
 
 		// Setup the 'offsets' and number of outputs.
@@ -446,9 +836,8 @@ init_server_state(struct ipc_server *s)
 	s->global_state.active_client_index = -1; // we start off with no active client.
 	s->global_state.last_active_client_index = -1;
 	s->global_state.connected_client_count = 0; // No clients connected initially
-	s->current_slot_index = 0;
 
-	for (uint32_t i = 0; i < IPC_MAX_CLIENTS; i++) {
+	for (uint32_t i = 0; i < s->max_clients; i++) {
 		volatile struct ipc_client_state *ics = &s->threads[i].ics;
 		ics->server = s;
 		ics->server_thread_index = -1;
@@ -471,6 +860,15 @@ init_all(struct ipc_server *s, enum u_logging_level log_level)
 		// Do not call teardown_all here, os_mutex_destroy will assert.
 		return XRT_ERROR_SYNC_PRIMITIVE_CREATION_FAILED;
 	}
+	os_mutex_set_name(&s->global_state.lock, "ipc_server::global_state.lock");
+
+	// This should never fail.
+	ret = os_thread_helper_init(&s->input_publisher.oth);
+	if (ret < 0) {
+		IPC_ERROR(s, "Input publisher thread helper failed to init!");
+		os_mutex_destroy(&s->global_state.lock);
+		return XRT_ERROR_SYNC_PRIMITIVE_CREATION_FAILED;
+	}
 
 	s->process = u_process_create_if_not_running();
 	if (!s->process) {
@@ -487,12 +885,30 @@ init_all(struct ipc_server *s, enum u_logging_level log_level)
 	uint64_t delay_ms = debug_get_num_option_exit_when_idle_delay_ms();
 	s->exit_when_idle_delay_ns = delay_ms * U_TIME_1MS_IN_NS;
 
+	// All per client state is sized by this, including the shared memory.
+	int64_t client_limit = debug_get_num_option_client_limit();
+	if (client_limit < 1 || client_limit > IPC_MAX_CLIENTS) {
+		IPC_WARN(s, "IPC_CLIENT_LIMIT=%lld out of range, clamping to [1, %u]", (long long)client_limit,
+		         IPC_MAX_CLIENTS);
+		client_limit = client_limit < 1 ? 1 : IPC_MAX_CLIENTS;
+	}
+	s->max_clients = (uint32_t)client_limit;
+	s->threads = U_TYPED_ARRAY_CALLOC(struct ipc_thread, s->max_clients);
+
 	xret = xrt_instance_create(NULL, &s->xinst);
 	IPC_CHK_WITH_GOTO(s, xret, "xrt_instance_create", error);
 
 	xret = xrt_instance_create_system(s->xinst, &s->xsys, &s->xsysd, &s->xso, &s->xsysc);
 	IPC_CHK_WITH_GOTO(s, xret, "xrt_instance_create_system", error);
 
+	s->warm_standby.enabled = debug_get_bool_option_warm_standby();
+	if (s->warm_standby.enabled && s->xsysc != NULL &&
+	    xrt_syscomp_set_warm_standby(s->xsysc, true) != XRT_SUCCESS) {
+		IPC_WARN(s, "Compositor doesn't support warm standby, only keeping device features in use.");
+	}
+
+	s->view_pose_cache.enabled = debug_get_bool_option_view_pose_cache();
+
 	// Always succeeds.
 	init_idevs(s);
 	init_tracking_origins(s);
@@ -509,12 +925,30 @@ init_all(struct ipc_server *s, enum u_logging_level log_level)
 	// Never fails, do this second last.
 	init_server_state(s);
 
+	// Zero disables it, clients then ask for updates over the channel.
+	int64_t interval_us = debug_get_num_option_input_publish_interval_us();
+	s->input_publisher.interval_ns = interval_us > 0 ? (uint64_t)interval_us * 1000 : 0;
+	if (s->input_publisher.interval_ns > 0) {
+		ret = os_thread_helper_start(&s->input_publisher.oth, input_publisher_thread, s);
+		if (ret < 0) {
+			xret = XRT_ERROR_THREADING_INIT_FAILURE;
+		}
+		IPC_CHK_WITH_GOTO(s, xret, "os_thread_helper_start", error);
+
+		s->ism->inputs_published = true;
+	}
+
 	u_var_add_root(s, "IPC Server", false);
 	u_var_add_log_level(s, &s->log_level, "Log level");
 	u_var_add_bool(s, &s->exit_on_disconnect, "exit_on_disconnect");
 	u_var_add_bool(s, &s->exit_when_idle, "exit_when_idle");
 	u_var_add_u64(s, &s->exit_when_idle_delay_ns, "exit_when_idle_delay_ns");
+	u_var_add_ro_text(s, s->warm_standby.enabled ? "on" : "off", "warm_standby");
 	u_var_add_bool(s, (bool *)&s->running, "running");
+	u_var_add_gui_header(s, NULL, "View pose cache");
+	u_var_add_bool(s, &s->view_pose_cache.enabled, "Enabled");
+
+	u_lock_stats_add_vars();
 
 	return XRT_SUCCESS;
 
@@ -611,7 +1045,7 @@ handle_focused_client_events(volatile struct ipc_client_state *ics, int active_i
 static void
 flush_state_to_all_clients_locked(struct ipc_server *s)
 {
-	for (uint32_t i = 0; i < IPC_MAX_CLIENTS; i++) {
+	for (uint32_t i = 0; i < s->max_clients; i++) {
 		volatile struct ipc_client_state *ics = &s->threads[i].ics;
 
 		// Not running?
@@ -656,7 +1090,7 @@ update_server_state_locked(struct ipc_server *s)
 	int fallback_active_application = -1;
 
 	// do we have a fallback application?
-	for (uint32_t i = 0; i < IPC_MAX_CLIENTS; i++) {
+	for (uint32_t i = 0; i < s->max_clients; i++) {
 		volatile struct ipc_client_state *ics = &s->threads[i].ics;
 		if (ics->client_state.session_overlay == false && ics->server_thread_index >= 0 &&
 		    ics->client_state.session_active) {
@@ -696,7 +1130,7 @@ find_client_locked(struct ipc_server *s, uint32_t client_id)
 		return NULL;
 	}
 
-	for (uint32_t i = 0; i < IPC_MAX_CLIENTS; i++) {
+	for (uint32_t i = 0; i < s->max_clients; i++) {
 		volatile struct ipc_client_state *ics = &s->threads[i].ics;
 
 		// Is this the client we are looking for?
@@ -728,6 +1162,9 @@ get_client_app_state_locked(struct ipc_server *s, uint32_t client_id, struct ipc
 
 	struct ipc_app_state ias = ics->client_state;
 	ias.io_active = ics->io_active;
+	ias.swapchain_count = ics->swapchain_count;
+	ias.semaphore_count = ics->compositor_semaphore_count;
+	ias.swapchain_memory_size = ics->swapchain_memory_size;
 
 	// @todo: track this data in the ipc_client_state struct
 	ias.primary_application = false;
@@ -744,6 +1181,24 @@ get_client_app_state_locked(struct ipc_server *s, uint32_t client_id, struct ipc
 	return XRT_SUCCESS;
 }
 
+static xrt_result_t
+get_client_frame_stats_locked(struct ipc_server *s, uint32_t client_id, struct xrt_compositor_frame_stats *out_stats)
+{
+	volatile struct ipc_client_state *ics = find_client_locked(s, client_id);
+	if (ics == NULL) {
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	// Client hasn't created a session yet, nothing to report.
+	if (ics->xc == NULL) {
+		U_ZERO(out_stats);
+		return XRT_SUCCESS;
+	}
+
+	// Cast away volatile.
+	return xrt_syscomp_get_frame_stats(s->xsysc, (struct xrt_compositor *)ics->xc, out_stats);
+}
+
 static xrt_result_t
 set_active_client_locked(struct ipc_server *s, uint32_t client_id)
 {
@@ -771,6 +1226,7 @@ toggle_io_client_locked(struct ipc_server *s, uint32_t client_id)
 	}
 
 	ics->io_active = !ics->io_active;
+	ipc_shared_client_io_active(s->ism)[ics->server_thread_index] = ics->io_active;
 
 	return XRT_SUCCESS;
 }
@@ -792,6 +1248,141 @@ ipc_server_get_client_app_state(struct ipc_server *s, uint32_t client_id, struct
 	return xret;
 }
 
+xrt_result_t
+ipc_server_get_client_frame_stats(struct ipc_server *s,
+                                  uint32_t client_id,
+                                  struct xrt_compositor_frame_stats *out_stats)
+{
+	os_mutex_lock(&s->global_state.lock);
+	xrt_result_t xret = get_client_frame_stats_locked(s, client_id, out_stats);
+	os_mutex_unlock(&s->global_state.lock);
+
+	return xret;
+}
+
+xrt_result_t
+ipc_server_get_view_poses(struct ipc_server *s,
+                          uint32_t device_id,
+                          const struct xrt_vec3 *default_eye_relation,
+                          int64_t at_timestamp_ns,
+                          uint32_t view_count,
+                          struct xrt_space_relation *out_head_relation,
+                          struct xrt_fov *out_fovs,
+                          struct xrt_pose *out_poses)
+{
+	struct xrt_device *xdev = s->idevs[device_id].xdev;
+	struct ipc_view_pose_cache *vpc = &s->idevs[device_id].view_pose_cache;
+	xrt_result_t xret = XRT_SUCCESS;
+
+	assert(view_count <= IPC_MAX_RAW_VIEWS);
+
+	if (!s->view_pose_cache.enabled) {
+		return xrt_device_get_view_poses( //
+		    xdev,                         //
+		    default_eye_relation,         //
+		    at_timestamp_ns,              //
+		    view_count,                   //
+		    out_head_relation,            //
+		    out_fovs,                     //
+		    out_poses);                   //
+	}
+
+	// Held while asking the device, so clients racing for the same frame wait and then hit.
+	os_mutex_lock(&vpc->mutex);
+
+	int64_t now_ns = os_monotonic_get_ns();
+	int64_t diff_ns = at_timestamp_ns - vpc->at_timestamp_ns;
+
+	bool hit = vpc->valid && vpc->view_count == view_count &&
+	           diff_ns <= IPC_VIEW_POSE_CACHE_TOLERANCE_NS && diff_ns >= -IPC_VIEW_POSE_CACHE_TOLERANCE_NS &&
+	           now_ns - vpc->gotten_ns <= IPC_VIEW_POSE_CACHE_MAX_AGE_NS &&
+	           vpc->default_eye_relation.x == default_eye_relation->x &&
+	           vpc->default_eye_relation.y == default_eye_relation->y &&
+	           vpc->default_eye_relation.z == default_eye_relation->z;
+
+	if (!hit) {
+		xret = xrt_device_get_view_poses( //
+		    xdev,                         //
+		    default_eye_relation,         //
+		    at_timestamp_ns,              //
+		    view_count,                   //
+		    &vpc->head_relation,          //
+		    vpc->fovs,                    //
+		    vpc->poses);                  //
+
+		// Don't keep anything from a failed call.
+		vpc->valid = xret == XRT_SUCCESS;
+		vpc->gotten_ns = now_ns;
+		vpc->at_timestamp_ns = at_timestamp_ns;
+		vpc->view_count = view_count;
+		vpc->default_eye_relation = *default_eye_relation;
+	}
+
+	if (xret == XRT_SUCCESS) {
+		*out_head_relation = vpc->head_relation;
+		memcpy(out_fovs, vpc->fovs, sizeof(struct xrt_fov) * view_count);
+		memcpy(out_poses, vpc->poses, sizeof(struct xrt_pose) * view_count);
+	}
+
+	os_mutex_unlock(&vpc->mutex);
+
+	return xret;
+}
+
+xrt_result_t
+ipc_server_get_visibility_mask(struct ipc_server *s,
+                               uint32_t device_id,
+                               enum xrt_visibility_mask_type type,
+                               uint32_t view_index,
+                               struct xrt_visibility_mask **out_mask)
+{
+	struct xrt_device *xdev = s->idevs[device_id].xdev;
+	struct ipc_visibility_mask_cache *vmc = &s->idevs[device_id].visibility_mask_cache;
+	xrt_result_t xret = XRT_SUCCESS;
+
+	if (xdev->hmd == NULL || view_index >= XRT_MAX_VIEWS || type < XRT_VISIBILITY_MASK_TYPE_HIDDEN_TRIANGLE_MESH ||
+	    type > XRT_VISIBILITY_MASK_TYPE_LINE_LOOP) {
+		IPC_ERROR(s, "Invalid visibility mask request (view: %u, type: %u)", view_index, (uint32_t)type);
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	os_mutex_lock(&vmc->mutex);
+
+	struct xrt_fov fov = xdev->hmd->distortion.fov[view_index];
+	struct xrt_visibility_mask **cached = &vmc->entries[view_index][type - 1].mask;
+	struct xrt_fov *cached_fov = &vmc->entries[view_index][type - 1].fov;
+
+	// Masks are made from the FOV, so a new FOV means a new mask.
+	if (*cached != NULL && memcmp(cached_fov, &fov, sizeof(fov)) != 0) {
+		free(*cached);
+		*cached = NULL;
+	}
+
+	if (*cached == NULL) {
+		if (xdev->get_visibility_mask) {
+			xret = xrt_device_get_visibility_mask(xdev, type, view_index, cached);
+		} else {
+			u_visibility_mask_get_default(type, &fov, cached);
+		}
+		*cached_fov = fov;
+	}
+
+	struct xrt_visibility_mask *mask = NULL;
+	if (xret == XRT_SUCCESS && *cached != NULL) {
+		size_t size = xrt_visibility_mask_get_size(*cached);
+		mask = U_CALLOC_WITH_CAST(struct xrt_visibility_mask, size);
+		if (mask != NULL) {
+			memcpy(mask, *cached, size);
+		}
+	}
+
+	os_mutex_unlock(&vmc->mutex);
+
+	*out_mask = mask;
+
+	return xret;
+}
+
 xrt_result_t
 ipc_server_set_active_client(struct ipc_server *s, uint32_t client_id)
 {
@@ -902,8 +1493,14 @@ ipc_server_handle_client_connected(struct ipc_server *vs, xrt_ipc_handle_t ipc_h
 
 	// find the next free thread in our array (server_thread_index is -1)
 	// and have it handle this connection
-	for (uint32_t i = 0; i < IPC_MAX_CLIENTS; i++) {
+	for (uint32_t i = 0; i < vs->max_clients; i++) {
 		volatile struct ipc_client_state *_cs = &vs->threads[i].ics;
+
+		// A dispatched client is still being cleaned up by a worker.
+		if (vs->threads[i].dispatched && vs->threads[i].state == IPC_THREAD_STOPPING) {
+			continue;
+		}
+
 		if (_cs->server_thread_index < 0) {
 			ics = _cs;
 			cs_index = i;
@@ -932,7 +1529,7 @@ ipc_server_handle_client_connected(struct ipc_server *vs, xrt_ipc_handle_t ipc_h
 		return;
 	}
 
-	if (it->state != IPC_THREAD_READY) {
+	if (it->state != IPC_THREAD_READY && !it->dispatched) {
 		os_thread_join(&it->thread);
 		os_thread_destroy(&it->thread);
 		it->state = IPC_THREAD_READY;
@@ -953,16 +1550,39 @@ ipc_server_handle_client_connected(struct ipc_server *vs, xrt_ipc_handle_t ipc_h
 	ics->server = vs;
 	ics->server_thread_index = cs_index;
 	ics->io_active = true;
+	ipc_shared_client_io_active(vs->ism)[cs_index] = true;
+	xrt_atomic_s32_store_release(&ipc_shared_async_results(vs->ism)[cs_index], XRT_SUCCESS);
+	xrt_atomic_s32_store_release(&ipc_shared_frame_wakes(vs->ism)[cs_index].client_waiting, 0);
 
 	ics->plane_detection_size = 0;
 	ics->plane_detection_count = 0;
 	ics->plane_detection_ids = NULL;
 	ics->plane_detection_xdev = NULL;
+	U_ZERO((struct xrt_plane_detections_ext *)&ics->plane_detections_sent.detections);
+	ics->plane_detections_sent.plane_detection_id = 0;
+	ics->plane_detections_sent.revision = 0;
+
+#if defined(XRT_OS_LINUX) && !defined(XRT_OS_ANDROID)
+	// Served by the pool of dispatch workers if enabled.
+	it->dispatched = true;
+	it->state = IPC_THREAD_RUNNING;
+	if (!ipc_server_mainloop_add_client(&vs->ml, ics)) {
+		it->dispatched = false;
+		it->state = IPC_THREAD_STARTING;
+	}
+#else
+	it->dispatched = false;
+#endif
 
-	os_thread_start(&it->thread, ipc_server_client_thread, (void *)ics);
+	if (!it->dispatched) {
+		os_thread_start(&it->thread, ipc_server_client_thread, (void *)ics);
+	}
 
 	// Unlock when we are done.
 	os_mutex_unlock(&vs->global_state.lock);
+
+	// Must not hold the global state lock, see the publisher loop.
+	input_publisher_wake_up(vs);
 }
 
 xrt_result_t
@@ -0,0 +1,82 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Futex helpers for words in memory shared between processes.
+ * @ingroup ipc_shared
+ */
+
+#pragma once
+
+#include "xrt/xrt_compiler.h"
+#include "xrt/xrt_config_os.h"
+
+#ifndef XRT_OS_LINUX
+#error "Futexes are only available on Linux"
+#endif
+
+#include <time.h>
+#include <limits.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*!
+ * Wake everybody sleeping on @p word.
+ *
+ * @ingroup ipc_shared
+ */
+static inline void
+ipc_futex_wake(xrt_atomic_s32_t *word)
+{
+	// Not private, the word lives in memory shared between processes.
+	syscall(SYS_futex, (int32_t *)word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/*!
+ * Sleep while @p word is @p value for at most @p timeout_ns, returns straight
+ * away if the value has already changed. Can return early for any reason.
+ *
+ * @ingroup ipc_shared
+ */
+static inline void
+ipc_futex_wait(xrt_atomic_s32_t *word, int32_t value, uint64_t timeout_ns)
+{
+	struct timespec ts = {
+	    .tv_sec = (time_t)(timeout_ns / 1000000000),
+	    .tv_nsec = (long)(timeout_ns % 1000000000),
+	};
+
+	syscall(SYS_futex, (int32_t *)word, FUTEX_WAIT, value, &ts, NULL, 0);
+}
+
+/*!
+ * Sleep while @p word is @p value until the absolute CLOCK_MONOTONIC time
+ * @p until_ns, same as @ref os_monotonic_get_ns. Being absolute it doesn't
+ * drift when the thread is preempted before going to sleep. Can return early
+ * for any reason.
+ *
+ * @ingroup ipc_shared
+ */
+static inline void
+ipc_futex_wait_until(xrt_atomic_s32_t *word, int32_t value, int64_t until_ns)
+{
+	struct timespec ts = {
+	    .tv_sec = (time_t)(until_ns / 1000000000),
+	    .tv_nsec = (long)(until_ns % 1000000000),
+	};
+
+	// The bitset variant takes an absolute CLOCK_MONOTONIC timeout.
+	syscall(SYS_futex, (int32_t *)word, FUTEX_WAIT_BITSET, value, &ts, NULL, FUTEX_BITSET_MATCH_ANY);
+}
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -11,6 +11,7 @@
 
 #include <xrt/xrt_handles.h>
 #include <xrt/xrt_results.h>
+#include <xrt/xrt_config_os.h>
 
 #include <stddef.h>
 #include <stdbool.h>
@@ -30,6 +31,14 @@ struct ipc_message_channel
 {
 	xrt_ipc_handle_t ipc_handle;
 	enum u_logging_level log_level;
+
+#if defined(XRT_OS_WINDOWS) || defined(XRT_DOXYGEN)
+	/*!
+	 * Signalled when overlapped I/O on @ref ipc_handle completes, created
+	 * on first use and closed with the channel.
+	 */
+	HANDLE io_event;
+#endif
 };
 
 /*!
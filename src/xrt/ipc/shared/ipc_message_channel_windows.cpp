@@ -44,6 +44,12 @@
 #define IPC_WARN(d, ...) U_LOG_IFL_W(d->log_level, __VA_ARGS__)
 #define IPC_ERROR(d, ...) U_LOG_IFL_E(d->log_level, __VA_ARGS__)
 
+/*!
+ * How many times we poll an overlapped operation before sleeping on its event,
+ * replies to most calls arrive well before a sleeping thread would be woken.
+ */
+#define IPC_OVERLAPPED_SPIN_COUNT 4000
+
 
 /*
  *
@@ -87,6 +93,42 @@ open_target_process_dup_handle(struct ipc_message_channel *imc)
 	return h;
 }
 
+static HANDLE
+get_io_event(struct ipc_message_channel *imc)
+{
+	if (imc->io_event == NULL) {
+		// Manual reset, ReadFile and WriteFile reset it when they start.
+		imc->io_event = CreateEventA(NULL, TRUE, FALSE, NULL);
+		if (imc->io_event == NULL) {
+			DWORD err = GetLastError();
+			IPC_ERROR(imc, "CreateEventA failed: %d %s", err, ipc_winerror(err));
+		}
+	}
+
+	return imc->io_event;
+}
+
+/*!
+ * Wait for an overlapped operation on the pipe that didn't complete straight
+ * away, spins a bit first as the other side in most cases answers quickly.
+ */
+static bool
+wait_overlapped(struct ipc_message_channel *imc, OVERLAPPED *ov, const char *what)
+{
+	for (uint32_t i = 0; i < IPC_OVERLAPPED_SPIN_COUNT && !HasOverlappedIoCompleted(ov); i++) {
+		YieldProcessor();
+	}
+
+	DWORD len;
+	if (!GetOverlappedResult(imc->ipc_handle, ov, &len, TRUE)) {
+		DWORD err = GetLastError();
+		IPC_ERROR(imc, "%s on pipe %p failed: %d %s", what, imc->ipc_handle, err, ipc_winerror(err));
+		return false;
+	}
+
+	return true;
+}
+
 
 /*
  *
@@ -101,30 +143,59 @@ ipc_message_channel_close(struct ipc_message_channel *imc)
 		CloseHandle(imc->ipc_handle);
 		imc->ipc_handle = INVALID_HANDLE_VALUE;
 	}
+	if (imc->io_event != NULL) {
+		CloseHandle(imc->io_event);
+		imc->io_event = NULL;
+	}
 }
 
 xrt_result_t
 ipc_send(struct ipc_message_channel *imc, const void *data, size_t size)
 {
-	DWORD len;
-	if (!WriteFile(imc->ipc_handle, data, DWORD(size), &len, NULL)) {
-		DWORD err = GetLastError();
+	HANDLE event = get_io_event(imc);
+	if (event == NULL) {
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	// The pipe is opened for overlapped I/O on both ends.
+	OVERLAPPED ov = {};
+	ov.hEvent = event;
+
+	if (WriteFile(imc->ipc_handle, data, DWORD(size), NULL, &ov)) {
+		return XRT_SUCCESS;
+	}
+
+	DWORD err = GetLastError();
+	if (err != ERROR_IO_PENDING) {
 		IPC_ERROR(imc, "WriteFile on pipe %p failed: %d %s", imc->ipc_handle, err, ipc_winerror(err));
 		return XRT_ERROR_IPC_FAILURE;
 	}
-	return XRT_SUCCESS;
+
+	return wait_overlapped(imc, &ov, "WriteFile") ? XRT_SUCCESS : XRT_ERROR_IPC_FAILURE;
 }
 
 xrt_result_t
 ipc_receive(struct ipc_message_channel *imc, void *out_data, size_t size)
 {
-	DWORD len;
-	if (!ReadFile(imc->ipc_handle, out_data, DWORD(size), &len, NULL)) {
-		DWORD err = GetLastError();
+	HANDLE event = get_io_event(imc);
+	if (event == NULL) {
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	OVERLAPPED ov = {};
+	ov.hEvent = event;
+
+	if (ReadFile(imc->ipc_handle, out_data, DWORD(size), NULL, &ov)) {
+		return XRT_SUCCESS;
+	}
+
+	DWORD err = GetLastError();
+	if (err != ERROR_IO_PENDING) {
 		IPC_ERROR(imc, "ReadFile from pipe %p failed: %d %s", imc->ipc_handle, err, ipc_winerror(err));
 		return XRT_ERROR_IPC_FAILURE;
 	}
-	return XRT_SUCCESS;
+
+	return wait_overlapped(imc, &ov, "ReadFile") ? XRT_SUCCESS : XRT_ERROR_IPC_FAILURE;
 }
 
 
@@ -1,4 +1,4 @@
-// Copyright 2020-2024 Collabora, Ltd.
+// Copyright 2020-2025 Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -25,6 +25,8 @@
 #include "xrt/xrt_tracking.h"
 #include "xrt/xrt_config_build.h"
 
+#include "os/os_threading.h"
+
 #include <assert.h>
 #include <sys/types.h>
 
@@ -35,14 +37,21 @@
 #define IPC_MAX_FORMATS 32 // max formats our server-side compositor supports
 #define IPC_MAX_DEVICES 8  // max number of devices we will map using shared mem
 #define IPC_MAX_LAYERS XRT_MAX_LAYERS
-#define IPC_MAX_SLOTS 128
-#define IPC_MAX_CLIENTS 8
-#define IPC_MAX_RAW_VIEWS 32 // Max views that we can get, artificial limit.
+#define IPC_MAX_CLIENT_SWAPCHAINS (XRT_MAX_LAYERS * 2)
+#define IPC_MAX_CLIENTS 64         // hard upper limit, the service picks its limit at startup
+#define IPC_DEFAULT_CLIENT_LIMIT 8 // default for the service's client limit
+#define IPC_MAX_RAW_VIEWS 32       // Max views that we can get, artificial limit.
 #define IPC_EVENT_QUEUE_SIZE 32
 
-#define IPC_SHARED_MAX_INPUTS 1024
-#define IPC_SHARED_MAX_OUTPUTS 128
-#define IPC_SHARED_MAX_BINDINGS 64
+//! Bump when the layout of @ref ipc_shared_memory or its sections change.
+#define IPC_SHARED_MEMORY_VERSION 6
+
+//! Alignment of each section in the shared memory.
+#define IPC_SHARED_SECTION_ALIGNMENT 64
+
+#define IPC_MAX_SNAPSHOT_SPACES 128 // Same as IPC_MAX_CLIENT_SPACES.
+#define IPC_SPACE_SNAPSHOT_SAMPLE_COUNT 3
+#define IPC_HAND_TRACKER_SAMPLE_COUNT 4 // Must be a power of two.
 
 // example: v21.0.0-560-g586d33b5
 #define IPC_VERSION_NAME_LEN 64
@@ -137,9 +146,18 @@ struct ipc_shared_device
 
 	//! The supported fields.
 	struct xrt_device_supported supported;
+
+	/*!
+	 * Sequence lock for this device's inputs in @ref ipc_shared_memory::inputs,
+	 * odd while the service is writing, see @ref ipc_seqlock.h.
+	 */
+	xrt_atomic_s32_t input_generation;
+
+	//! Is the IO suppressed for this device, mirrored from the service.
+	bool io_active;
 };
 
-static_assert(sizeof(struct ipc_shared_device) == 568,
+static_assert(sizeof(struct ipc_shared_device) == 576,
               "invalid structure size, maybe different 32/64 bits sizes or padding");
 
 /*!
@@ -183,19 +201,215 @@ struct ipc_layer_slot
 	struct ipc_layer_entry layers[IPC_MAX_LAYERS];
 };
 
-static_assert(sizeof(struct ipc_layer_slot) == IPC_MAX_LAYERS * sizeof(struct ipc_layer_entry) + 32,
+static_assert(sizeof(struct ipc_layer_slot) == IPC_MAX_LAYERS * sizeof(struct ipc_layer_entry) + 40,
+              "invalid structure size, maybe different 32/64 bits sizes or padding");
+
+/*!
+ * Per client snapshot of where all of the client's spaces are in the root
+ * space, sampled at a few times around the predicted display time of the
+ * current frame. This lets the client locate spaces without a round trip to
+ * the service, by interpolating between the samples.
+ *
+ * Written only by the thread serving the client, read by the client using the
+ * @ref generation sequence lock and @ref epoch, see @ref ipc_seqlock.h.
+ *
+ * @ingroup ipc
+ */
+struct ipc_shared_space_snapshot
+{
+	//! Sequence lock, odd while the service is writing.
+	xrt_atomic_s32_t generation;
+
+	/*!
+	 * Value of @ref ipc_shared_memory::space_snapshot_epoch when this
+	 * snapshot was taken, if they differ the snapshot is stale.
+	 */
+	int32_t epoch;
+
+	//! Sample times, monotonically increasing, all zero if never written.
+	int64_t timestamps_ns[IPC_SPACE_SNAPSHOT_SAMPLE_COUNT];
+
+	//! Is the space with this id in the snapshot.
+	bool valid[IPC_MAX_SNAPSHOT_SPACES];
+
+	//! Relation of each space in the root space, indexed by space id.
+	struct xrt_space_relation relations[IPC_MAX_SNAPSHOT_SPACES][IPC_SPACE_SNAPSHOT_SAMPLE_COUNT];
+};
+
+static_assert(sizeof(struct ipc_shared_space_snapshot) == 21664,
+              "invalid structure size, maybe different 32/64 bits sizes or padding");
+
+/*!
+ * The latest joint sets of one hand tracking input of a device, kept up to date
+ * by the input publisher of the service. This lets the client interpolate
+ * between or predict from the samples without a round trip to the service.
+ *
+ * Written only by the input publisher, read by the clients using the
+ * @ref generation sequence lock, see @ref ipc_seqlock.h.
+ *
+ * @ingroup ipc
+ */
+struct ipc_shared_hand_tracker
+{
+	//! Sequence lock, odd while the service is writing.
+	xrt_atomic_s32_t generation;
+
+	//! Index of the device in @ref ipc_shared_memory::isdevs.
+	uint32_t device_id;
+
+	//! The hand tracking input of the device.
+	enum xrt_input_name name;
+
+	/*!
+	 * Number of samples written so far, the latest one is at
+	 * `(sample_count - 1) % IPC_HAND_TRACKER_SAMPLE_COUNT`.
+	 */
+	uint32_t sample_count;
+
+	//! Timestamps of the samples as given by the device, always increasing.
+	int64_t timestamps_ns[IPC_HAND_TRACKER_SAMPLE_COUNT];
+
+	//! Joint sets in the device's space, without the tracking origin offset.
+	struct xrt_hand_joint_set values[IPC_HAND_TRACKER_SAMPLE_COUNT];
+};
+
+static_assert(sizeof(struct ipc_shared_hand_tracker) == 6528,
+              "invalid structure size, maybe different 32/64 bits sizes or padding");
+
+/*!
+ * The latest sample of one face or body tracking input of a device, kept up
+ * to date by the input publisher of the service, see
+ * @ref ipc_shared_hand_tracker. Only republished when the device has a new
+ * sample or the tracking state changes.
+ *
+ * The sets are unions of all the face or body tracking types, clients only
+ * copy the @ref value_size bytes used by this input's type.
+ *
+ * @ingroup ipc
+ */
+struct ipc_shared_body_face_tracker
+{
+	//! Sequence lock, odd while the service is writing.
+	xrt_atomic_s32_t generation;
+
+	//! Index of the device in @ref ipc_shared_memory::isdevs.
+	uint32_t device_id;
+
+	//! The face or body tracking input of the device.
+	enum xrt_input_name name;
+
+	//! Bytes at the start of @ref face or @ref body used by @ref name.
+	uint32_t value_size;
+
+	//! Number of samples written so far.
+	uint32_t sample_count;
+
+	//! Is the face or body currently tracked.
+	bool active;
+
+	//! Timestamp of the sample as given by the device.
+	int64_t timestamp_ns;
+
+	union {
+		struct xrt_facial_expression_set face;
+
+		//! Joints in the device's space, without the tracking origin offset.
+		struct xrt_body_joint_set body;
+	};
+};
+
+static_assert(sizeof(struct ipc_shared_body_face_tracker) == 4816,
+              "invalid structure size, maybe different 32/64 bits sizes or padding");
+
+/*!
+ * Per client word the client sleeps on in wait frame until the wake up time
+ * the service predicted, the service bumps it to wake the client early. Only
+ * used on Linux where futexes work between processes.
+ *
+ * @ingroup ipc
+ */
+struct ipc_shared_frame_wake
+{
+	//! Bumped by the service to wake the client, futex word.
+	xrt_atomic_s32_t wake_seq;
+
+	//! Non-zero while the client sleeps on @ref wake_seq.
+	xrt_atomic_s32_t client_waiting;
+};
+
+static_assert(sizeof(struct ipc_shared_frame_wake) == 8,
+              "invalid structure size, maybe different 32/64 bits sizes or padding");
+
+/*!
+ * State of one image of a swapchain in @ref ipc_shared_swapchain.
+ *
+ * @ingroup ipc
+ */
+enum ipc_shared_image_state
+{
+	//! Not used by the service, waiting on it doesn't need a call.
+	IPC_SHARED_IMAGE_STATE_READY = 0,
+
+	//! Released by the client, the service hasn't checked it yet.
+	IPC_SHARED_IMAGE_STATE_RELEASED = 1,
+
+	//! Still used by the service when checked, waiting on it needs a call.
+	IPC_SHARED_IMAGE_STATE_IN_USE = 2,
+};
+
+/*!
+ * Per swapchain release state, lets the client wait on an image without a
+ * call when the service has already found it to be ready. The client sets
+ * the image to @ref IPC_SHARED_IMAGE_STATE_RELEASED before sending the
+ * release, the service checks the image when it handles the release.
+ *
+ * @ingroup ipc
+ */
+struct ipc_shared_swapchain
+{
+	//! Bumped by the service whenever it changes @ref image_states, futex word.
+	xrt_atomic_s32_t release_seq;
+
+	//! Non-zero while the client sleeps on @ref release_seq.
+	xrt_atomic_s32_t client_waiting;
+
+	//! One @ref ipc_shared_image_state per image.
+	xrt_atomic_s32_t image_states[XRT_MAX_SWAPCHAIN_IMAGES];
+};
+
+static_assert(sizeof(struct ipc_shared_swapchain) == 40,
+              "invalid structure size, maybe different 32/64 bits sizes or padding");
+
+/*!
+ * A variable sized array placed after @ref ipc_shared_memory in the same
+ * mapping, sized by the service at startup.
+ *
+ * @ingroup ipc
+ */
+struct ipc_shared_section
+{
+	//! Offset in bytes from the start of @ref ipc_shared_memory.
+	uint32_t offset;
+
+	//! Number of elements in the section.
+	uint32_t count;
+};
+
+static_assert(sizeof(struct ipc_shared_section) == 8,
               "invalid structure size, maybe different 32/64 bits sizes or padding");
 
 /*!
- * A big struct that contains all data that is shared to a client, no pointers
- * allowed in this. To get the inputs of a device you go:
+ * The header of the memory that is shared to a client, no pointers allowed in
+ * this. The arrays that depend on the number of devices, inputs and clients
+ * follow it in the same mapping as @ref ipc_shared_section, the total size of
+ * the mapping is given by @ref size. To get the inputs of a device you go:
  *
  * ```C++
  * struct xrt_input *
  * helper(struct ipc_shared_memory *ism, uint32_t device_id, uint32_t input)
  * {
  * 	uint32_t index = ism->isdevs[device_id]->first_input_index + input;
- * 	return &ism->inputs[index];
+ * 	return &ipc_shared_inputs(ism)[index];
  * }
  * ```
  *
@@ -208,6 +422,15 @@ struct ipc_shared_memory
 	 */
 	char u_git_tag[IPC_VERSION_NAME_LEN];
 
+	//! Always @ref IPC_SHARED_MEMORY_VERSION, checked even if the git tag check is ignored.
+	uint32_t version;
+
+	//! Size in bytes of the whole mapping, this header and all sections.
+	uint32_t size;
+
+	//! The client limit of the service, all per client sections have this many elements.
+	uint32_t max_clients;
+
 	/*!
 	 * Number of elements in @ref itracks that are populated/valid.
 	 */
@@ -286,23 +509,123 @@ struct ipc_shared_memory
 		uint32_t blend_mode_count;
 	} hmd;
 
-	struct xrt_input inputs[IPC_SHARED_MAX_INPUTS];
+	//! Array of struct xrt_input, for all devices.
+	struct ipc_shared_section inputs;
 
-	struct xrt_output outputs[IPC_SHARED_MAX_OUTPUTS];
+	//! Array of struct xrt_output, for all devices.
+	struct ipc_shared_section outputs;
 
-	struct ipc_shared_binding_profile binding_profiles[IPC_SHARED_MAX_BINDINGS];
-	struct xrt_binding_input_pair input_pairs[IPC_SHARED_MAX_INPUTS];
-	struct xrt_binding_output_pair output_pairs[IPC_SHARED_MAX_OUTPUTS];
+	//! Array of struct ipc_shared_binding_profile, for all devices.
+	struct ipc_shared_section binding_profiles;
 
-	struct ipc_layer_slot slots[IPC_MAX_SLOTS];
+	//! Array of struct xrt_binding_input_pair, for all binding profiles.
+	struct ipc_shared_section input_pairs;
+
+	//! Array of struct xrt_binding_output_pair, for all binding profiles.
+	struct ipc_shared_section output_pairs;
+
+	/*!
+	 * Array of struct ipc_layer_slot, one per client indexed by the index
+	 * returned from the instance_get_shared_client_index call.
+	 */
+	struct ipc_shared_section slots;
 
 	uint64_t startup_timestamp;
 	struct xrt_plane_detector_begin_info_ext plane_begin_info_ext;
+
+	/*!
+	 * Bumped by the service whenever something that changes the relations
+	 * between spaces outside of tracking happens, like a recenter or a
+	 * change of reference space or tracking origin offsets.
+	 */
+	xrt_atomic_s32_t space_snapshot_epoch;
+
+	/*!
+	 * Array of struct ipc_shared_space_snapshot, one per client indexed by
+	 * the index returned from the instance_get_shared_client_index call.
+	 */
+	struct ipc_shared_section space_snapshots;
+
+	/*!
+	 * Set if the service continuously publishes the state of all devices
+	 * into @ref inputs, clients then read them directly instead of asking
+	 * for an update. Each device is guarded by
+	 * @ref ipc_shared_device::input_generation.
+	 */
+	bool inputs_published;
+
+	/*!
+	 * Array of bool, is the IO active for each client, indexed by the index
+	 * returned from the instance_get_shared_client_index call.
+	 */
+	struct ipc_shared_section client_io_active;
+
+	/*!
+	 * Array of xrt_atomic_s32_t, the first failed result of an async call
+	 * for each client, indexed like @ref client_io_active. Set by the
+	 * service and cleared by the client when it reports the error.
+	 */
+	struct ipc_shared_section async_results;
+
+	/*!
+	 * Array of struct ipc_shared_hand_tracker, one per hand tracking input
+	 * of all devices. Only written to if @ref inputs_published is set.
+	 */
+	struct ipc_shared_section hand_trackers;
+
+	/*!
+	 * Array of struct ipc_shared_frame_wake, one per client indexed like
+	 * @ref client_io_active.
+	 */
+	struct ipc_shared_section frame_wakes;
+
+	/*!
+	 * Array of struct ipc_shared_body_face_tracker, one per face or body
+	 * tracking input of all devices. Only written to if
+	 * @ref inputs_published is set.
+	 */
+	struct ipc_shared_section body_face_trackers;
+
+	/*!
+	 * Array of struct ipc_shared_swapchain, @ref IPC_MAX_CLIENT_SWAPCHAINS
+	 * per client indexed by swapchain id, clients are ordered like
+	 * @ref client_io_active.
+	 */
+	struct ipc_shared_section swapchains;
 };
 
-static_assert(sizeof(struct ipc_shared_memory) == 6500056,
+static_assert(sizeof(struct ipc_shared_memory) == 30032,
               "invalid structure size, maybe different 32/64 bits sizes or padding");
 
+#define IPC_SHARED_SECTION_GETTER(NAME, TYPE)                                                                          \
+	static inline TYPE *ipc_shared_##NAME(struct ipc_shared_memory *ism)                                           \
+	{                                                                                                              \
+		return (TYPE *)((uint8_t *)ism + ism->NAME.offset);                                                    \
+	}
+
+/*!
+ * @name Section getters
+ * Get the arrays placed after @ref ipc_shared_memory, the offsets are only
+ * validated by the client when mapping the shared memory.
+ * @{
+ */
+IPC_SHARED_SECTION_GETTER(inputs, struct xrt_input)
+IPC_SHARED_SECTION_GETTER(outputs, struct xrt_output)
+IPC_SHARED_SECTION_GETTER(binding_profiles, struct ipc_shared_binding_profile)
+IPC_SHARED_SECTION_GETTER(input_pairs, struct xrt_binding_input_pair)
+IPC_SHARED_SECTION_GETTER(output_pairs, struct xrt_binding_output_pair)
+IPC_SHARED_SECTION_GETTER(slots, struct ipc_layer_slot)
+IPC_SHARED_SECTION_GETTER(space_snapshots, struct ipc_shared_space_snapshot)
+IPC_SHARED_SECTION_GETTER(client_io_active, bool)
+IPC_SHARED_SECTION_GETTER(async_results, xrt_atomic_s32_t)
+IPC_SHARED_SECTION_GETTER(hand_trackers, struct ipc_shared_hand_tracker)
+IPC_SHARED_SECTION_GETTER(frame_wakes, struct ipc_shared_frame_wake)
+IPC_SHARED_SECTION_GETTER(body_face_trackers, struct ipc_shared_body_face_tracker)
+IPC_SHARED_SECTION_GETTER(swapchains, struct ipc_shared_swapchain)
+//! @}
+
+#undef IPC_SHARED_SECTION_GETTER
+
 /*!
  * Initial info from a client when it connects.
  */
@@ -321,7 +644,7 @@ struct ipc_client_list
 	uint32_t id_count;
 };
 
-static_assert(sizeof(struct ipc_client_list) == 36,
+static_assert(sizeof(struct ipc_client_list) == 260,
               "invalid structure size, maybe different 32/64 bits sizes or padding");
 
 /*!
@@ -343,9 +666,34 @@ struct ipc_app_state
 	uint32_t z_order;
 	pid_t pid;
 	struct xrt_application_info info;
+
+	//! Number of swapchains and compositor semaphores the client has alive.
+	uint32_t swapchain_count;
+	uint32_t semaphore_count;
+
+	//! Memory used by the images of the client's swapchains, in bytes.
+	XRT_ALIGNAS(8) uint64_t swapchain_memory_size;
+};
+
+static_assert(sizeof(struct ipc_app_state) == 176,
+              "invalid structure size, maybe different 32/64 bits sizes or padding");
+
+
+/*!
+ * Statistics of the locks sharing a name in the service, see @ref os_lock_stats.
+ *
+ * @ingroup ipc
+ */
+struct ipc_lock_stats
+{
+	//! Number of lock names the service has statistics for.
+	uint32_t count;
+
+	//! The statistics at the requested index, zeroed if it is out of range.
+	XRT_ALIGNAS(8) struct os_lock_stats stats;
 };
 
-static_assert(sizeof(struct ipc_app_state) == 160,
+static_assert(sizeof(struct ipc_lock_stats) == 120,
               "invalid structure size, maybe different 32/64 bits sizes or padding");
 
 
@@ -0,0 +1,143 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Reader and writer for recorded IPC sessions.
+ * @ingroup ipc_shared
+ */
+
+#include "os/os_time.h"
+
+#include "util/u_misc.h"
+#include "util/u_logging.h"
+
+#include "shared/ipc_record.h"
+
+
+/*
+ *
+ * Writer.
+ *
+ */
+
+xrt_result_t
+ipc_record_writer_create(const char *path, struct ipc_record_writer **out_writer)
+{
+	FILE *file = fopen(path, "wb");
+	if (file == NULL) {
+		U_LOG_E("Could not create IPC recording '%s'", path);
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	struct ipc_record_file_header header = {
+	    .magic = IPC_RECORD_MAGIC,
+	    .version = IPC_RECORD_VERSION,
+	    .layer_entry_size = sizeof(struct ipc_layer_entry),
+	};
+
+	if (fwrite(&header, sizeof(header), 1, file) != 1) {
+		U_LOG_E("Could not write IPC recording header to '%s'", path);
+		fclose(file);
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	struct ipc_record_writer *writer = U_TYPED_CALLOC(struct ipc_record_writer);
+	writer->file = file;
+	writer->start_ns = os_monotonic_get_ns();
+
+	*out_writer = writer;
+
+	return XRT_SUCCESS;
+}
+
+void
+ipc_record_write(struct ipc_record_writer *writer,
+                 enum ipc_record_type type,
+                 const void *data,
+                 uint32_t size,
+                 const void *extra,
+                 uint32_t extra_size)
+{
+	struct ipc_record_header header = {
+	    .type = (uint16_t)type,
+	    .size = size + extra_size,
+	    .timestamp_ns = os_monotonic_get_ns() - writer->start_ns,
+	};
+
+	// Buffered by stdio, only hits the disk every few kilobytes.
+	fwrite(&header, sizeof(header), 1, writer->file);
+	if (size > 0) {
+		fwrite(data, size, 1, writer->file);
+	}
+	if (extra_size > 0) {
+		fwrite(extra, extra_size, 1, writer->file);
+	}
+}
+
+void
+ipc_record_writer_destroy(struct ipc_record_writer **writer_ptr)
+{
+	struct ipc_record_writer *writer = *writer_ptr;
+	if (writer == NULL) {
+		return;
+	}
+
+	fclose(writer->file);
+	free(writer);
+
+	*writer_ptr = NULL;
+}
+
+
+/*
+ *
+ * Reader.
+ *
+ */
+
+xrt_result_t
+ipc_record_reader_open(const char *path, FILE **out_file)
+{
+	FILE *file = fopen(path, "rb");
+	if (file == NULL) {
+		U_LOG_E("Could not open IPC recording '%s'", path);
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	struct ipc_record_file_header header = {0};
+	if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != IPC_RECORD_MAGIC) {
+		U_LOG_E("'%s' is not an IPC recording", path);
+		fclose(file);
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	if (header.version != IPC_RECORD_VERSION || header.layer_entry_size != sizeof(struct ipc_layer_entry)) {
+		U_LOG_E("'%s' was recorded by an incompatible version (%u, %u)", path, header.version,
+		        header.layer_entry_size);
+		fclose(file);
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	*out_file = file;
+
+	return XRT_SUCCESS;
+}
+
+bool
+ipc_record_read(FILE *file, struct ipc_record_header *out_header, void *buffer, size_t buffer_size)
+{
+	if (fread(out_header, sizeof(*out_header), 1, file) != 1) {
+		return false;
+	}
+
+	if (out_header->size > buffer_size) {
+		U_LOG_E("Record of type %u too large (%u > %zu)", out_header->type, out_header->size, buffer_size);
+		return false;
+	}
+
+	if (out_header->size > 0 && fread(buffer, out_header->size, 1, file) != 1) {
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,268 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  File format and reader/writer for recorded IPC sessions.
+ * @ingroup ipc_shared
+ */
+
+#pragma once
+
+#include "xrt/xrt_compositor.h"
+#include "xrt/xrt_session.h"
+
+#include "shared/ipc_protocol.h"
+
+#include <stdio.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*
+ *
+ * File format.
+ *
+ */
+
+//! "MIPC" in little endian.
+#define IPC_RECORD_MAGIC 0x4350494d
+
+/*!
+ * Bumped whenever the records or any of the structs they embed change, the
+ * file is only meant to be replayed against the same build of Monado.
+ */
+#define IPC_RECORD_VERSION 3
+
+/*!
+ * Start of every recording file.
+ *
+ * @ingroup ipc_shared
+ */
+struct ipc_record_file_header
+{
+	uint32_t magic;
+	uint32_t version;
+	//! Sanity check that the embedded structs match.
+	uint32_t layer_entry_size;
+	uint32_t reserved;
+};
+
+/*!
+ * The calls that are recorded, each with the payload struct that follows its
+ * @ref ipc_record_header.
+ *
+ * @ingroup ipc_shared
+ */
+enum ipc_record_type
+{
+	IPC_RECORD_SESSION_CREATE = 1,            //!< @ref ipc_record_session_create
+	IPC_RECORD_SESSION_BEGIN = 2,             //!< No payload.
+	IPC_RECORD_SESSION_END = 3,               //!< No payload.
+	IPC_RECORD_SESSION_DESTROY = 4,           //!< No payload.
+	IPC_RECORD_SPACE_CREATE_SEMANTIC_IDS = 5, //!< @ref ipc_record_semantic_ids
+	IPC_RECORD_SPACE_LOCATE_SPACE = 6,        //!< @ref ipc_record_locate_space
+	IPC_RECORD_SPACE_LOCATE_DEVICE = 7,       //!< @ref ipc_record_locate_device
+	IPC_RECORD_PREDICT_FRAME = 8,             //!< @ref ipc_record_frame
+	IPC_RECORD_WAIT_WOKE = 9,                 //!< @ref ipc_record_frame
+	IPC_RECORD_BEGIN_FRAME = 10,              //!< @ref ipc_record_frame
+	IPC_RECORD_DISCARD_FRAME = 11,            //!< @ref ipc_record_frame
+	IPC_RECORD_LAYER_SYNC = 12,               //!< @ref ipc_record_layer_sync
+	IPC_RECORD_SWAPCHAIN_CREATE = 13,         //!< @ref ipc_record_swapchain_create
+	IPC_RECORD_SWAPCHAIN_DESTROY = 14,        //!< @ref ipc_record_swapchain
+	IPC_RECORD_SWAPCHAIN_WAIT_IMAGE = 15,     //!< @ref ipc_record_swapchain_wait_image
+	IPC_RECORD_SWAPCHAIN_RELEASE_IMAGE = 17,  //!< @ref ipc_record_swapchain_image
+	IPC_RECORD_SPACE_CREATE_OFFSET = 18,      //!< @ref ipc_record_space_create_offset
+	IPC_RECORD_SPACE_CREATE_POSE = 19,        //!< @ref ipc_record_space_create_pose
+	IPC_RECORD_SPACE_DESTROY = 20,            //!< @ref ipc_record_space
+};
+
+/*!
+ * Precedes every record's payload.
+ *
+ * @ingroup ipc_shared
+ */
+struct ipc_record_header
+{
+	uint16_t type; //!< @ref ipc_record_type
+	uint16_t reserved;
+	//! Size of the payload following this header.
+	uint32_t size;
+	//! When the call was made, relative to the start of the recording.
+	int64_t timestamp_ns;
+};
+
+struct ipc_record_session_create
+{
+	struct xrt_session_info xsi;
+	bool create_native_compositor;
+};
+
+//! The ids the service handed out, used to remap later records.
+struct ipc_record_semantic_ids
+{
+	uint32_t root_id;
+	uint32_t view_id;
+	uint32_t local_id;
+	uint32_t local_floor_id;
+	uint32_t stage_id;
+	uint32_t unbounded_id;
+};
+
+struct ipc_record_space_create_offset
+{
+	uint32_t parent_id;
+	uint32_t id; //!< The id the service handed out.
+	struct xrt_pose offset;
+};
+
+struct ipc_record_space_create_pose
+{
+	uint32_t xdev_id;
+	uint32_t id; //!< The id the service handed out.
+	enum xrt_input_name name;
+};
+
+struct ipc_record_space
+{
+	uint32_t id;
+};
+
+struct ipc_record_locate_space
+{
+	uint32_t base_space_id;
+	uint32_t space_id;
+	struct xrt_pose base_offset;
+	struct xrt_pose offset;
+	//! Requested time relative to when the call was made, usually in the future.
+	int64_t at_delta_ns;
+};
+
+struct ipc_record_locate_device
+{
+	uint32_t base_space_id;
+	uint32_t xdev_id;
+	struct xrt_pose base_offset;
+	//! Requested time relative to when the call was made, usually in the future.
+	int64_t at_delta_ns;
+};
+
+struct ipc_record_frame
+{
+	int64_t frame_id;
+};
+
+/*!
+ * The layers are written after this struct, only @p layer_count of them to
+ * keep the recording compact.
+ */
+struct ipc_record_layer_sync
+{
+	struct xrt_layer_frame_data data;
+	uint32_t layer_count;
+	uint32_t reserved;
+};
+
+struct ipc_record_swapchain_create
+{
+	struct xrt_swapchain_create_info info;
+	uint32_t id; //!< The id the service handed out.
+};
+
+struct ipc_record_swapchain
+{
+	uint32_t id;
+};
+
+struct ipc_record_swapchain_wait_image
+{
+	uint32_t id;
+	uint32_t index;
+	int64_t timeout_ns;
+};
+
+struct ipc_record_swapchain_image
+{
+	uint32_t id;
+	uint32_t index;
+};
+
+
+/*
+ *
+ * Writer.
+ *
+ */
+
+/*!
+ * Writes records of one client's calls to a file, not thread safe, only the
+ * thread serving the client writes to it.
+ *
+ * @ingroup ipc_shared
+ */
+struct ipc_record_writer
+{
+	FILE *file;
+	int64_t start_ns;
+};
+
+/*!
+ * Create the file at @p path and write the file header.
+ *
+ * @ingroup ipc_shared
+ */
+xrt_result_t
+ipc_record_writer_create(const char *path, struct ipc_record_writer **out_writer);
+
+/*!
+ * Write one record, @p extra is written directly after @p data and may be
+ * NULL, used for variable sized records.
+ *
+ * @ingroup ipc_shared
+ */
+void
+ipc_record_write(struct ipc_record_writer *writer,
+                 enum ipc_record_type type,
+                 const void *data,
+                 uint32_t size,
+                 const void *extra,
+                 uint32_t extra_size);
+
+/*!
+ * Flush and close the file, frees the writer and sets the pointer to NULL.
+ *
+ * @ingroup ipc_shared
+ */
+void
+ipc_record_writer_destroy(struct ipc_record_writer **writer_ptr);
+
+
+/*
+ *
+ * Reader.
+ *
+ */
+
+/*!
+ * Open a recording and check the file header.
+ *
+ * @ingroup ipc_shared
+ */
+xrt_result_t
+ipc_record_reader_open(const char *path, FILE **out_file);
+
+/*!
+ * Read the next record, returns false at the end of the file or if the
+ * payload doesn't fit in @p buffer.
+ *
+ * @ingroup ipc_shared
+ */
+bool
+ipc_record_read(FILE *file, struct ipc_record_header *out_header, void *buffer, size_t buffer_size);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,251 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Shared memory command/reply channel with futex wake-ups.
+ * @ingroup ipc_shared
+ */
+
+#pragma once
+
+#include "xrt/xrt_compiler.h"
+#include "xrt/xrt_config_os.h"
+
+#ifndef XRT_OS_LINUX
+#error "The IPC ring needs futexes, only available on Linux"
+#endif
+
+#include "shared/ipc_futex.h"
+
+#include <string.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//! Max size of a command written to the ring, with any queued async commands in front of it.
+#define IPC_RING_COMMAND_SIZE 4096
+
+//! Max size of a reply written to the ring.
+#define IPC_RING_REPLY_SIZE 8192
+
+/*!
+ * How many times a side polls the sequence number before sleeping, most
+ * replies arrive within a couple of microseconds.
+ */
+#define IPC_RING_SPIN_COUNT 256
+
+/*!
+ * Channel for calls that don't pass any handles, mapped by both the client and
+ * the service. Calls are synchronous so there is only ever one command in
+ * flight, that makes it a ring of depth one with a sequence number on each
+ * side. A command with a size of zero tells the service that the next command
+ * comes over the socket instead. Async commands queued by the client are put in
+ * front of the command, a command made up of only async commands is replied to
+ * with an empty reply.
+ *
+ * @ingroup ipc_shared
+ */
+struct ipc_ring
+{
+	//! Bumped by the client for each command, futex word.
+	xrt_atomic_s32_t command_seq;
+
+	//! Set to the sequence number of the command replied to, futex word.
+	xrt_atomic_s32_t reply_seq;
+
+	//! Non-zero while the service sleeps on @ref command_seq.
+	xrt_atomic_s32_t service_waiting;
+
+	//! Non-zero while the client sleeps on @ref reply_seq.
+	xrt_atomic_s32_t client_waiting;
+
+	uint32_t command_size;
+	uint32_t reply_size;
+
+	uint8_t command[IPC_RING_COMMAND_SIZE];
+	uint8_t reply[IPC_RING_REPLY_SIZE];
+};
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+/*!
+ * Wait for @p word to not be @p value, @p waiting tells the other side that it
+ * needs to wake us.
+ */
+static inline bool
+ipc_ring_wait_for_change(xrt_atomic_s32_t *word, int32_t value, xrt_atomic_s32_t *waiting, uint64_t timeout_ns)
+{
+	for (uint32_t i = 0; i < IPC_RING_SPIN_COUNT; i++) {
+		if (xrt_atomic_s32_load_acquire(word) != value) {
+			return true;
+		}
+	}
+
+	// Full barrier, pairs with the one in ipc_ring_publish.
+	xrt_atomic_s32_inc_return(waiting);
+
+	if (xrt_atomic_s32_load_acquire(word) == value) {
+		ipc_futex_wait(word, value, timeout_ns);
+	}
+
+	xrt_atomic_s32_dec_return(waiting);
+
+	return xrt_atomic_s32_load_acquire(word) != value;
+}
+
+//! Store @p value into @p word and wake the other side if it sleeps.
+static inline void
+ipc_ring_publish(xrt_atomic_s32_t *word, int32_t value, xrt_atomic_s32_t *waiting)
+{
+	xrt_atomic_s32_store_release(word, value);
+
+	// Full barrier, the other side either sees the new value or we see it waiting.
+	xrt_atomic_thread_fence();
+
+	if (xrt_atomic_s32_load_acquire(waiting) != 0) {
+		ipc_futex_wake(word);
+	}
+}
+
+
+/*
+ *
+ * Client side.
+ *
+ */
+
+/*!
+ * Write a command and wake the service, returns the sequence number to wait
+ * for with @ref ipc_ring_client_wait_reply. Passing a @p size of zero tells
+ * the service to read the next command from the socket, it is not replied to.
+ *
+ * @ingroup ipc_shared
+ */
+static inline int32_t
+ipc_ring_client_post(struct ipc_ring *ring, const void *data, uint32_t size)
+{
+	int32_t seq = ring->command_seq + 1;
+
+	if (size > 0) {
+		memcpy(ring->command, data, size);
+	}
+	ring->command_size = size;
+
+	ipc_ring_publish(&ring->command_seq, seq, &ring->service_waiting);
+
+	return seq;
+}
+
+/*!
+ * Wait for the reply to command @p seq, returns false on timeout.
+ *
+ * @ingroup ipc_shared
+ */
+static inline bool
+ipc_ring_client_wait_reply(struct ipc_ring *ring, int32_t seq, uint64_t timeout_ns)
+{
+	int32_t value = xrt_atomic_s32_load_acquire(&ring->reply_seq);
+	if (value == seq) {
+		return true;
+	}
+
+	ipc_ring_wait_for_change(&ring->reply_seq, value, &ring->client_waiting, timeout_ns);
+
+	return xrt_atomic_s32_load_acquire(&ring->reply_seq) == seq;
+}
+
+/*!
+ * Copy out the reply, returns false if it isn't the expected size.
+ *
+ * @ingroup ipc_shared
+ */
+static inline bool
+ipc_ring_client_read_reply(struct ipc_ring *ring, void *out_data, uint32_t size)
+{
+	if (ring->reply_size != size) {
+		return false;
+	}
+
+	if (size > 0) {
+		memcpy(out_data, ring->reply, size);
+	}
+
+	return true;
+}
+
+
+/*
+ *
+ * Service side.
+ *
+ */
+
+/*!
+ * Wait for the client to post the command after @p last_seq, returns false on
+ * timeout.
+ *
+ * @ingroup ipc_shared
+ */
+static inline bool
+ipc_ring_service_wait_command(struct ipc_ring *ring, int32_t last_seq, uint64_t timeout_ns)
+{
+	return ipc_ring_wait_for_change(&ring->command_seq, last_seq, &ring->service_waiting, timeout_ns);
+}
+
+/*!
+ * Copy out the command posted by the client, the size is zero if the command
+ * is on the socket. The client can write anything into the shared memory so
+ * returns false if the size is larger than @p max_size.
+ *
+ * @ingroup ipc_shared
+ */
+static inline bool
+ipc_ring_service_read_command(struct ipc_ring *ring, void *out_data, uint32_t max_size, uint32_t *out_size)
+{
+	uint32_t size = ring->command_size;
+	if (size > max_size || size > IPC_RING_COMMAND_SIZE) {
+		return false;
+	}
+
+	if (size > 0) {
+		memcpy(out_data, ring->command, size);
+	}
+	*out_size = size;
+
+	return true;
+}
+
+/*!
+ * Write the reply to command @p seq and wake the client.
+ *
+ * @ingroup ipc_shared
+ */
+static inline bool
+ipc_ring_service_reply(struct ipc_ring *ring, int32_t seq, const void *data, uint32_t size)
+{
+	if (size > IPC_RING_REPLY_SIZE) {
+		return false;
+	}
+
+	if (size > 0) {
+		memcpy(ring->reply, data, size);
+	}
+	ring->reply_size = size;
+
+	ipc_ring_publish(&ring->reply_seq, seq, &ring->client_waiting);
+
+	return true;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
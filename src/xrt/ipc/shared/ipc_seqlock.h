@@ -0,0 +1,83 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Sequence lock helpers for data published through shared memory.
+ * @ingroup ipc_shared
+ */
+
+#pragma once
+
+#include "xrt/xrt_compiler.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*!
+ * How many times a reader retries before giving up, the writer might have
+ * died half way through a write so readers must never wait for it forever.
+ *
+ * @ingroup ipc_shared
+ */
+#define IPC_SEQLOCK_READ_TRIES 16
+
+/*!
+ * Mark the start of a write, the sequence number becomes odd. There must only
+ * be one writer at a time for a given sequence number.
+ *
+ * @ingroup ipc_shared
+ */
+static inline void
+ipc_seqlock_write_begin(xrt_atomic_s32_t *seq)
+{
+	int32_t value = *seq;
+	xrt_atomic_s32_store_release(seq, value + 1);
+	xrt_atomic_thread_fence();
+}
+
+/*!
+ * Mark the end of a write, the sequence number becomes even again and the
+ * written data is published to readers.
+ *
+ * @ingroup ipc_shared
+ */
+static inline void
+ipc_seqlock_write_end(xrt_atomic_s32_t *seq)
+{
+	int32_t value = *seq;
+	xrt_atomic_s32_store_release(seq, value + 1);
+}
+
+/*!
+ * Start a read, returns false if a writer is currently active.
+ *
+ * @ingroup ipc_shared
+ */
+static inline bool
+ipc_seqlock_read_begin(xrt_atomic_s32_t *seq, int32_t *out_value)
+{
+	int32_t value = xrt_atomic_s32_load_acquire(seq);
+	*out_value = value;
+	return (value & 1) == 0;
+}
+
+/*!
+ * Finish a read, returns true if the data read since the matching
+ * @ref ipc_seqlock_read_begin is consistent and can be used.
+ *
+ * @ingroup ipc_shared
+ */
+static inline bool
+ipc_seqlock_read_end(xrt_atomic_s32_t *seq, int32_t value)
+{
+	xrt_atomic_thread_fence();
+	return xrt_atomic_s32_load_acquire(seq) == value;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -49,6 +49,33 @@ ipc_shmem_create(size_t size, xrt_shmem_handle_t *out_handle, void **out_map)
 	return XRT_SUCCESS;
 }
 
+#elif defined(XRT_OS_LINUX)
+
+// Impl for non-Android Linux, anonymous so several regions can be created at the same time.
+xrt_result_t
+ipc_shmem_create(size_t size, xrt_shmem_handle_t *out_handle, void **out_map)
+{
+	*out_handle = -1;
+	int fd = memfd_create("monado_shm", MFD_CLOEXEC);
+	if (fd < 0) {
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	if (ftruncate(fd, size) < 0) {
+		close(fd);
+		return XRT_ERROR_IPC_FAILURE;
+	}
+
+	xrt_result_t result = ipc_shmem_map(fd, size, out_map);
+	if (result != XRT_SUCCESS) {
+		close(fd);
+		return result;
+	}
+
+	*out_handle = fd;
+	return XRT_SUCCESS;
+}
+
 #elif defined(XRT_OS_UNIX)
 
 #define MONADO_SHMEM_NAME "/monado_shm"
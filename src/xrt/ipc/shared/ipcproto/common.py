@@ -287,6 +287,11 @@ class Call:
         """Decide whether this call needs a msg struct."""
         return self.in_args or self.in_handles
 
+    @property
+    def allowed_on_ring(self):
+        """Decide whether this call can go over the shared memory ring."""
+        return not (self.varlen or self.in_handles or self.out_handles)
+
     def __init__(self, name, data):
         """Construct a call from call name and call data dictionary."""
         self.id = None
@@ -296,6 +301,7 @@ class Call:
         self.in_handles = None
         self.out_handles = None
         self.varlen = False
+        self.is_async = False
         for key, val in data.items():
             if key == 'id':
                 self.id = val
@@ -309,12 +315,18 @@ class Call:
                 self.in_handles = HandleType(val)
             elif key == 'varlen':
                 self.varlen = val
+            elif key == 'async':
+                self.is_async = val
             else:
                 raise RuntimeError("Unrecognized key")
         if not self.id:
             self.id = "IPC_" + name.upper()
         if self.varlen and (self.in_handles or self.out_handles):
             raise Exception("Can not have handles with varlen functions")
+        if self.is_async and not self.allowed_on_ring:
+            raise Exception("Can not have handles or varlen with async functions")
+        if self.is_async and self.out_args:
+            raise Exception("Can not have out arguments with async functions")
 
 
 class Proto:
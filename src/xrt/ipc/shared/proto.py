@@ -29,7 +29,12 @@ def write_send_definition(f, call):
 
     write_msg_struct(f, call, '\t')
 
-    write_msg_send(f, 'xrt_result_t ret', indent="\t")
+    f.write("\n\t// The variable length data follows on the socket")
+    write_invocation(f, 'xrt_result_t ret', 'ipc_client_begin_socket_command', ('ipc_c',), indent="\t")
+    f.write(';')
+    write_result_handler(f, 'ret', None, indent="\t")
+
+    write_msg_send(f, 'ret', indent="\t")
 
     f.write("\n\treturn ret;\n}\n")
 
@@ -63,6 +68,25 @@ def write_call_definition(f, call):
     f.write("\tIPC_TRACE(ipc_c, \"Calling " + call.name + "\");\n\n")
 
     write_msg_struct(f, call, '\t')
+
+    if call.is_async:
+        f.write("""
+\t// Keeps the queued commands in order.
+\tos_mutex_lock(&ipc_c->mutex);
+
+\t// Not waited for, sent with the next call that is""")
+        write_invocation(
+            f,
+            'xrt_result_t ret',
+            'ipc_client_queue_async',
+            ('ipc_c', '&_msg', 'sizeof(_msg)'),
+            indent="\t"
+        )
+        f.write(";\n")
+        f.write("\n\tos_mutex_unlock(&ipc_c->mutex);")
+        f.write("\n\treturn ret;\n}\n")
+        return
+
     write_reply_struct(f, call, '\t')
 
     f.write("""
@@ -71,8 +95,37 @@ def write_call_definition(f, call):
 """)
     cleanup = "os_mutex_unlock(&ipc_c->mutex);"
 
+    if call.allowed_on_ring:
+        f.write("\n\t// Goes over the ring if there is one")
+        write_invocation(
+            f,
+            'xrt_result_t ret',
+            'ipc_client_send_and_receive',
+            (
+                'ipc_c',
+                '&_msg',
+                'sizeof(_msg)',
+                '&_reply',
+                'sizeof(_reply)'
+                ),
+            indent="\t"
+        )
+        f.write(';')
+        write_result_handler(f, 'ret', cleanup, indent="\t")
+
+        for arg in call.out_args:
+            f.write("\t*out_" + arg.name + " = _reply." + arg.name + ";\n")
+        f.write("\n\t" + cleanup)
+        f.write("\n\treturn _reply.result;\n}\n")
+        return
+
+    f.write("\n\t// Handles can only be sent over the socket")
+    write_invocation(f, 'xrt_result_t ret', 'ipc_client_begin_socket_command', ('ipc_c',), indent="\t")
+    f.write(';')
+    write_result_handler(f, 'ret', cleanup, indent="\t")
+
     # Prepare initial sending
-    write_msg_send(f, 'xrt_result_t ret', indent="\t")
+    write_msg_send(f, 'ret', indent="\t")
     write_result_handler(f, 'ret', cleanup, indent="\t")
 
     if call.in_handles:
@@ -218,9 +271,24 @@ def generate_client_c(file, p):
 #include "client/ipc_client.h"
 #include "ipc_protocol_generated.h"
 
+#ifdef XRT_OS_LINUX
+#include "shared/ipc_ring.h"
+#endif
+
 
 \n''')
 
+    # Everything sent over the ring must fit in it.
+    f.write("#ifdef XRT_OS_LINUX\n")
+    for call in p.calls:
+        if not call.allowed_on_ring:
+            continue
+        if call.needs_msg_struct:
+            f.write("static_assert(sizeof(struct ipc_%s_msg) <= IPC_RING_COMMAND_SIZE, \"Too large for the ring\");\n" % call.name)
+        if call.out_args:
+            f.write("static_assert(sizeof(struct ipc_%s_reply) <= IPC_RING_REPLY_SIZE, \"Too large for the ring\");\n" % call.name)
+    f.write("#endif\n\n")
+
     # Loop over all of the calls.
     for call in p.calls:
         if call.varlen:
@@ -270,6 +338,8 @@ def generate_server_c(file, p):
     f.write('''
 #include "xrt/xrt_limits.h"
 
+#include "util/u_trace_marker.h"
+
 #include "shared/ipc_protocol.h"
 #include "shared/ipc_utils.h"
 
@@ -290,7 +360,9 @@ ipc_dispatch(volatile struct ipc_client_state *ics, ipc_command_t *ipc_command)
         f.write("\tcase " + call.id + ": {\n")
 
         f.write("\t\tIPC_TRACE(ics->server, \"Dispatching " + call.name +
-                "\");\n\n")
+                "\");\n")
+        # Handler and reply time for each call, shows up in traces.
+        f.write("\t\tIPC_TRACE_IDENT(" + call.name + ");\n\n")
 
         if call.needs_msg_struct:
             f.write(
@@ -299,6 +371,8 @@ ipc_dispatch(volatile struct ipc_client_state *ics, ipc_command_t *ipc_command)
 
         if call.varlen:
             f.write("\t\t// No return arguments")
+        elif call.is_async:
+            f.write("\t\t// Async, no reply is sent")
         elif call.out_args:
             f.write("\t\tstruct ipc_%s_reply reply = {0};\n" % call.name)
         else:
@@ -385,6 +459,8 @@ ipc_dispatch(volatile struct ipc_client_state *ics, ipc_command_t *ipc_command)
         return_target = 'reply.result'
         if call.varlen:
             return_target = 'xrt_result_t xret'
+        elif call.is_async:
+            return_target = 'xrt_result_t result'
 
         write_invocation(f, return_target, 'ipc_handle_' +
                          call.name, args, indent="\t\t")
@@ -393,7 +469,15 @@ ipc_dispatch(volatile struct ipc_client_state *ics, ipc_command_t *ipc_command)
         # TODO do we check reply.result and
         # error out before replying if it's not success?
 
-        if not call.varlen:
+        if call.is_async:
+            f.write("\n\t\t// Failures are reported by a later call, don't disconnect.\n")
+            f.write("\t\tipc_server_record_async_result(ics, result);\n")
+            f.write("\t\txrt_result_t xret = XRT_SUCCESS;")
+        elif call.allowed_on_ring:
+            write_invocation(f, 'xrt_result_t xret', 'ipc_server_send_reply',
+                             ("ics", "&reply", "sizeof(reply)"), indent="\t\t")
+            f.write(";")
+        elif not call.varlen:
             func = 'ipc_send'
             args = ["(struct ipc_message_channel *)&ics->imc",
                     "&reply",
@@ -433,6 +517,44 @@ ipc_command_size(const enum ipc_command cmd)
 \t}
 }
 
+''')
+
+    f.write('''
+bool
+ipc_command_allowed_on_ring(const enum ipc_command cmd)
+{
+\tswitch (cmd) {
+''')
+
+    for call in p.calls:
+        if call.allowed_on_ring:
+            f.write("\tcase " + call.id + ":\n")
+
+    f.write('''\t\treturn true;
+\tdefault:
+\t\treturn false;
+\t}
+}
+
+''')
+
+    f.write('''
+bool
+ipc_command_is_async(const enum ipc_command cmd)
+{
+\tswitch (cmd) {
+''')
+
+    for call in p.calls:
+        if call.is_async:
+            f.write("\tcase " + call.id + ":\n")
+
+    f.write('''\t\treturn true;
+\tdefault:
+\t\treturn false;
+\t}
+}
+
 ''')
 
     f.close()
@@ -482,6 +604,26 @@ def generate_server_header(file, p):
     )
     f.write(";\n")
 
+    write_decl(
+        f,
+        "bool",
+        "ipc_command_allowed_on_ring",
+        [
+            "const enum ipc_command cmd"
+        ]
+    )
+    f.write(";\n")
+
+    write_decl(
+        f,
+        "bool",
+        "ipc_command_is_async",
+        [
+            "const enum ipc_command cmd"
+        ]
+    )
+    f.write(";\n")
+
     for call in p.calls:
         call.write_handler_decl(f)
         f.write(";\n")
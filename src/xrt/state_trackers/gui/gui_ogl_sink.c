@@ -1,4 +1,4 @@
-// Copyright 2019-2023, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -18,8 +18,13 @@
 
 #include <pthread.h>
 #include <limits.h>
+#include <string.h>
+#include <assert.h>
 
 
+//! Number of upload buffers, written in turns so we never wait on the previous upload.
+#define GUI_OGL_SINK_PBO_COUNT (2)
+
 /*!
  * An @ref xrt_frame_sink that shows sunk frames in the GUI.
  * @implements xrt_frame_sink
@@ -32,11 +37,23 @@ struct gui_ogl_sink
 	struct xrt_frame_sink sink;
 	struct xrt_frame_node node;
 
+	//! Latest frame, replaced by newer ones until the GUI thread takes it.
 	struct xrt_frame *frame;
 
 	pthread_mutex_t mutex;
 
 	bool running;
+
+	//! Pixel unpack buffers that the frames are streamed through.
+	GLuint pbos[GUI_OGL_SINK_PBO_COUNT];
+	uint32_t next_pbo;
+
+	//! The texture storage is only reallocated when these change.
+	struct
+	{
+		GLint w, h;
+		enum xrt_format format;
+	} storage;
 };
 
 static void
@@ -49,6 +66,10 @@ push_frame(struct xrt_frame_sink *xs, struct xrt_frame *xf)
 
 	// If we are in the process of shutting down, don't take the reference.
 	if (s->running) {
+		// The GUI thread didn't get to the previous one, skip it.
+		if (s->frame != NULL) {
+			s->tex.dropped++;
+		}
 		xrt_frame_reference(&s->frame, xf);
 	}
 
@@ -75,6 +96,7 @@ destroy(struct xrt_frame_node *node)
 {
 	struct gui_ogl_sink *s = container_of(node, struct gui_ogl_sink, node);
 
+	glDeleteBuffers(GUI_OGL_SINK_PBO_COUNT, s->pbos);
 	glDeleteTextures(1, &s->tex.id);
 
 	pthread_mutex_destroy(&s->mutex);
@@ -83,32 +105,74 @@ destroy(struct xrt_frame_node *node)
 }
 
 static void
-update_r8g8b8x8(struct gui_ogl_sink *s, GLint w, GLint h, GLint stride, uint8_t *data)
+ensure_storage(struct gui_ogl_sink *s, GLint w, GLint h, enum xrt_format format)
 {
-	glBindTexture(GL_TEXTURE_2D, s->tex.id);
-	glPixelStorei(GL_UNPACK_ROW_LENGTH, stride / 4);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-	glBindTexture(GL_TEXTURE_2D, 0);
-}
+	if (s->storage.w == w && s->storage.h == h && s->storage.format == format) {
+		return;
+	}
 
-static void
-update_r8g8b8(struct gui_ogl_sink *s, GLint w, GLint h, GLint stride, uint8_t *data)
-{
-	glBindTexture(GL_TEXTURE_2D, s->tex.id);
-	glPixelStorei(GL_UNPACK_ROW_LENGTH, stride / 3);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLint swizzle_rgba[] = {GL_RED, GL_GREEN, GL_BLUE, GL_ONE};
+	GLint swizzle_l8[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+
+	switch (format) {
+	case XRT_FORMAT_R8G8B8:
+	case XRT_FORMAT_R8G8B8A8:
+	case XRT_FORMAT_R8G8B8X8:
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle_rgba);
+		break;
+	case XRT_FORMAT_L8:
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, w, h, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+		glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle_l8);
+		break;
+	default: assert(false);
+	}
+
+	s->storage.w = w;
+	s->storage.h = h;
+	s->storage.format = format;
 }
 
+/*!
+ * Copies the frame into the next buffer and streams the texture from it, the
+ * copy is done by the GPU later so the GUI thread doesn't stall on it.
+ */
 static void
-update_l8(struct gui_ogl_sink *s, GLint w, GLint h, GLint stride, uint8_t *data)
+upload(struct gui_ogl_sink *s, struct xrt_frame *frame, GLenum gl_format, GLint bytes_per_pixel)
 {
+	GLint w = (GLint)frame->width;
+	GLint h = (GLint)frame->height;
+	GLint stride = (GLint)frame->stride;
+	GLsizeiptr size = (GLsizeiptr)stride * (h - 1) + (GLsizeiptr)w * bytes_per_pixel;
+
+	GLuint pbo = s->pbos[s->next_pbo];
+	s->next_pbo = (s->next_pbo + 1) % GUI_OGL_SINK_PBO_COUNT;
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+
+	// Orphan the old storage, if the GPU is still reading it the driver hands us a new one.
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+	void *ptr = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (ptr == NULL) {
+		U_LOG_E("Failed to map pixel unpack buffer!");
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		return;
+	}
+
+	memcpy(ptr, frame->data, size);
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
 	glBindTexture(GL_TEXTURE_2D, s->tex.id);
-	glPixelStorei(GL_UNPACK_ROW_LENGTH, stride);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, w, h, 0, GL_RED, GL_UNSIGNED_BYTE, data);
-	GLint swizzleMask[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
-	glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzleMask);
+	ensure_storage(s, w, h, frame->format);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, stride / bytes_per_pixel);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, gl_format, GL_UNSIGNED_BYTE, NULL);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
 	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 }
 
 void
@@ -149,8 +213,6 @@ gui_ogl_sink_update(struct gui_ogl_texture *tex)
 
 	GLint w = frame->width;
 	GLint h = frame->height;
-	GLint stride = (GLint)frame->stride;
-	uint8_t *data = frame->data;
 
 	if (tex->w != (uint32_t)w || tex->h != (uint32_t)h) {
 		tex->w = w;
@@ -165,10 +227,10 @@ gui_ogl_sink_update(struct gui_ogl_texture *tex)
 	tex->seq = frame->source_sequence;
 
 	switch (frame->format) {
-	case XRT_FORMAT_R8G8B8: update_r8g8b8(s, w, h, stride, data); break;
+	case XRT_FORMAT_R8G8B8: upload(s, frame, GL_RGB, 3); break;
 	case XRT_FORMAT_R8G8B8A8:
-	case XRT_FORMAT_R8G8B8X8: update_r8g8b8x8(s, w, h, stride, data); break;
-	case XRT_FORMAT_L8: update_l8(s, w, h, stride, data); break;
+	case XRT_FORMAT_R8G8B8X8: upload(s, frame, GL_RGBA, 4); break;
+	case XRT_FORMAT_L8: upload(s, frame, GL_RED, 1); break;
 	default: break;
 	}
 
@@ -208,6 +270,8 @@ gui_ogl_sink_create(const char *name, struct xrt_frame_context *xfctx, struct xr
 
 	glBindTexture(GL_TEXTURE_2D, 0);
 
+	glGenBuffers(GUI_OGL_SINK_PBO_COUNT, s->pbos);
+
 	xrt_frame_context_add(xfctx, &s->node);
 
 	*out_sink = &s->sink;
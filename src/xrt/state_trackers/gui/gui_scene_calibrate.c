@@ -186,6 +186,9 @@ render_progress(struct calibration_scene *cs)
 	float capture_completion = ((float)cs->status.num_collected) / (float)cs->params.num_collect_total;
 	igText("Overall progress: %i of %i frames captured", cs->status.num_collected, cs->params.num_collect_total);
 	igProgressBar(capture_completion, progress_dims, NULL);
+	if (cs->status.num_dropped > 0) {
+		igText("Dropped %i camera frames while busy", cs->status.num_dropped);
+	}
 
 #else
 	// Unused
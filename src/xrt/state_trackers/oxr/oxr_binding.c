@@ -21,6 +21,9 @@
 #include <stdio.h>
 
 
+static bool
+ends_with(const char *str, const char *suffix);
+
 static void
 setup_paths(struct oxr_logger *log,
             struct oxr_instance *inst,
@@ -115,12 +118,9 @@ interaction_profile_find_or_create_in_instance(struct oxr_logger *log,
 
 	struct profile_template *templ = NULL;
 
+	// The template paths were cached at instance creation, no need to hash them again.
 	for (size_t x = 0; x < OXR_BINDINGS_PROFILE_TEMPLATE_COUNT; x++) {
-		XrPath t_path = XR_NULL_PATH;
-
-		oxr_path_get_or_create(log, inst, profile_templates[x].path, strlen(profile_templates[x].path),
-		                       &t_path);
-		if (t_path == path) {
+		if (profile_templates[x].path_cache == path) {
 			templ = &profile_templates[x];
 			break;
 		}
@@ -158,6 +158,16 @@ interaction_profile_find_or_create_in_instance(struct oxr_logger *log,
 
 		b->localized_name = t->localized_name;
 		setup_paths(log, inst, t->paths, &b->paths, &b->path_count);
+
+		// So suggesting bindings doesn't need to do string compares on every path.
+		for (uint32_t y = 0; t->paths[y] != NULL; y++) {
+			if (ends_with(t->paths[y], "click")) {
+				b->component_flags |= OXR_BINDING_COMPONENT_CLICK;
+			}
+			if (ends_with(t->paths[y], "value")) {
+				b->component_flags |= OXR_BINDING_COMPONENT_VALUE;
+			}
+		}
 		b->input = t->input;
 		b->dpad_activate = t->dpad_activate;
 		b->output = t->output;
@@ -226,7 +236,7 @@ try_add_by_component(struct oxr_logger *log,
                      size_t binding_count,
                      XrPath path,
                      struct oxr_action *act,
-                     const char **components,
+                     const enum oxr_binding_component_flags *components,
                      size_t component_count)
 {
 	for (uint32_t component_index = 0; component_index < component_count; component_index++) {
@@ -238,10 +248,12 @@ try_add_by_component(struct oxr_logger *log,
 		for (size_t i = 0; i < binding_count; i++) {
 			struct oxr_binding *b = &bindings[i];
 
-			bool path_found = false;
 			// search for path and component together and only add to the first found binding that has both
-			bool component_found = false;
+			if ((b->component_flags & components[component_index]) == 0) {
+				continue;
+			}
 
+			bool path_found = false;
 			uint32_t preferred_path_index;
 			for (uint32_t y = 0; y < b->path_count; y++) {
 				if (b->paths[y] == path) {
@@ -250,17 +262,9 @@ try_add_by_component(struct oxr_logger *log,
 					// selected /click, /value, etc. if it did not
 					preferred_path_index = y;
 				}
-
-				const char *str;
-				size_t len;
-				oxr_path_get_string(log, inst, b->paths[y], &str, &len);
-				if (ends_with(str, components[component_index])) {
-					component_found = true;
-				}
 			}
 
-
-			if (!(path_found && component_found)) {
+			if (!path_found) {
 				continue;
 			}
 
@@ -331,11 +335,17 @@ add_act_key_to_matching_bindings(struct oxr_logger *log,
 	// check if we need to select a child, e.g. suggested str is */trigger for a bool action, or */trigger for a
 	// float action
 	if (xr_act_type == XR_ACTION_TYPE_BOOLEAN_INPUT && !ends_with(str, "/click") && !ends_with(str, "/touch")) {
-		const char *components[2] = {"click", "value"};
+		const enum oxr_binding_component_flags components[2] = {
+		    OXR_BINDING_COMPONENT_CLICK,
+		    OXR_BINDING_COMPONENT_VALUE,
+		};
 		added = try_add_by_component(log, inst, bindings, binding_count, path, act, components, 2);
 	} else if (xr_act_type == XR_ACTION_TYPE_FLOAT_INPUT && !ends_with(str, "/value") &&
 	           !ends_with(str, "/click")) {
-		const char *components[2] = {"value", "click"};
+		const enum oxr_binding_component_flags components[2] = {
+		    OXR_BINDING_COMPONENT_VALUE,
+		    OXR_BINDING_COMPONENT_CLICK,
+		};
 		added = try_add_by_component(log, inst, bindings, binding_count, path, act, components, 2);
 	}
 
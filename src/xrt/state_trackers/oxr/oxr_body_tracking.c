@@ -194,18 +194,20 @@ oxr_locate_body_joints_fb(struct oxr_logger *log,
 	locations->confidence = body_joint_set_fb->confidence;
 	locations->skeletonChangedCount = body_joint_set_fb->skeleton_changed_count;
 
+	// Transform all joints into the base space in one go.
+	struct xrt_space_relation results[XRT_FULL_BODY_JOINT_COUNT_META];
+	for (size_t joint_index = 0; joint_index < body_joint_count; ++joint_index) {
+		results[joint_index] = src_body_joints[joint_index].relation;
+	}
+	m_space_relation_apply_array(&T_base_body, results, results, body_joint_count);
+
 	for (size_t joint_index = 0; joint_index < body_joint_count; ++joint_index) {
 		const struct xrt_body_joint_location_fb *src_joint = &src_body_joints[joint_index];
 		XrBodyJointLocationFB *dst_joint = &locations->jointLocations[joint_index];
 
 		dst_joint->locationFlags = xrt_to_xr_space_location_flags(src_joint->relation.relation_flags);
 
-		struct xrt_space_relation result;
-		struct xrt_relation_chain chain = {0};
-		m_relation_chain_push_relation(&chain, &src_joint->relation);
-		m_relation_chain_push_relation(&chain, &T_base_body);
-		m_relation_chain_resolve(&chain, &result);
-		OXR_XRT_POSE_TO_XRPOSEF(result.pose, dst_joint->pose);
+		OXR_XRT_POSE_TO_XRPOSEF(results[joint_index].pose, dst_joint->pose);
 	}
 
 #ifdef OXR_HAVE_META_body_tracking_calibration
@@ -18,20 +18,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-
-
-/*
- *
- * Struct and defines.
- *
- */
-
-struct oxr_event
-{
-	struct oxr_event *next;
-	size_t length;
-	XrResult result;
-};
+#include <assert.h>
 
 
 /*
@@ -40,83 +27,99 @@ struct oxr_event
  *
  */
 
-void
+static void
 lock(struct oxr_instance *inst)
 {
 	os_mutex_lock(&inst->event.mutex);
 }
 
-void
+static void
 unlock(struct oxr_instance *inst)
 {
 	os_mutex_unlock(&inst->event.mutex);
 }
 
-void *
+static void *
 oxr_event_extra(struct oxr_event *event)
 {
-	return &event[1];
+	return event->data.bytes;
 }
 
-struct oxr_event *
-pop(struct oxr_instance *inst)
+static struct oxr_event *
+get_slot(struct oxr_instance *inst, uint32_t index)
 {
-	struct oxr_event *ret = inst->event.next;
-	if (ret == NULL) {
-		return NULL;
-	}
+	return &inst->event.slots[(inst->event.head + index) % OXR_MAX_EVENT_COUNT];
+}
 
-	inst->event.next = ret->next;
-	ret->next = NULL;
+//! Must be called with the lock held after the queue has changed.
+static void
+update_pending(struct oxr_instance *inst)
+{
+	int32_t pending = (int32_t)inst->event.count + (inst->event.lost_count > 0 ? 1 : 0);
+	xrt_atomic_s32_store_release(&inst->event.pending, pending);
+}
+
+static void
+push(struct oxr_instance *inst, const struct oxr_event *event)
+{
+	lock(inst);
 
-	if (ret == inst->event.last) {
-		inst->event.last = NULL;
+	if (inst->event.count >= OXR_MAX_EVENT_COUNT) {
+		// Drop the event, the app is told with XrEventDataEventsLost.
+		inst->event.lost_count++;
+	} else {
+		*get_slot(inst, inst->event.count) = *event;
+		inst->event.count++;
 	}
 
-	return ret;
+	update_pending(inst);
+
+	unlock(inst);
 }
 
-void
-push(struct oxr_instance *inst, struct oxr_event *event)
+static bool
+pop(struct oxr_instance *inst, struct oxr_event *out_event)
 {
-	struct oxr_event *last = inst->event.last;
-	if (last != NULL) {
-		last->next = event;
-	}
-	inst->event.last = event;
+	lock(inst);
 
-	if (inst->event.next == NULL) {
-		inst->event.next = event;
-	}
-}
+	bool ret = true;
+	if (inst->event.lost_count > 0) {
+		// Report lost events first, they are older than anything queued.
+		XrEventDataEventsLost *lost = oxr_event_extra(out_event);
 
-#define ALLOC(log, inst, event, extra)                                                                                 \
-	do {                                                                                                           \
-		XrResult ret = oxr_event_alloc(log, inst, sizeof(**extra), event);                                     \
-		if (ret != XR_SUCCESS) {                                                                               \
-			return ret;                                                                                    \
-		}                                                                                                      \
-		*((void **)extra) = oxr_event_extra(*event);                                                           \
-	} while (false)
+		U_ZERO(lost);
+		lost->type = XR_TYPE_EVENT_DATA_EVENTS_LOST;
+		lost->lostEventCount = inst->event.lost_count;
 
-static XrResult
-oxr_event_alloc(struct oxr_logger *log, struct oxr_instance *inst, size_t size, struct oxr_event **out_event)
-{
-	struct oxr_event *event = U_CALLOC_WITH_CAST(struct oxr_event, sizeof(struct oxr_event) + size);
+		out_event->length = sizeof(*lost);
+		out_event->result = XR_SUCCESS;
+
+		inst->event.lost_count = 0;
+	} else if (inst->event.count > 0) {
+		*out_event = *get_slot(inst, 0);
 
-	if (event == NULL) {
-		return oxr_error(log, XR_ERROR_RUNTIME_FAILURE, "Out of memory");
+		inst->event.head = (inst->event.head + 1) % OXR_MAX_EVENT_COUNT;
+		inst->event.count--;
+	} else {
+		ret = false;
 	}
 
-	event->next = NULL;
-	event->length = size;
-	event->result = XR_SUCCESS;
+	update_pending(inst);
 
-	*out_event = event;
+	unlock(inst);
 
-	return XR_SUCCESS;
+	return ret;
 }
 
+#define ALLOC(event, extra)                                                                                            \
+	do {                                                                                                           \
+		static_assert(sizeof(**extra) <= OXR_MAX_EVENT_SIZE, "Event too large for OXR_MAX_EVENT_SIZE");        \
+		U_ZERO(event);                                                                                         \
+		(event)->length = sizeof(**extra);                                                                     \
+		(event)->result = XR_SUCCESS;                                                                          \
+		*((void **)extra) = oxr_event_extra(event);                                                            \
+	} while (false)
+
 static bool
 is_session_link_to_event(struct oxr_event *event, XrSession session)
 {
@@ -154,20 +157,18 @@ oxr_event_push_XrEventDataSessionStateChanged(struct oxr_logger *log,
 {
 	struct oxr_instance *inst = sess->sys->inst;
 	XrEventDataSessionStateChanged *changed;
-	struct oxr_event *event = NULL;
+	struct oxr_event event;
 
-	ALLOC(log, inst, &event, &changed);
+	ALLOC(&event, &changed);
 
 	changed->type = XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED;
 	changed->session = oxr_session_to_openxr(sess);
 	changed->state = state;
 	changed->time = time;
 
-	event->result = XR_SUCCESS;
+	event.result = XR_SUCCESS;
 
-	lock(inst);
-	push(inst, event);
-	unlock(inst);
+	push(inst, &event);
 
 	return XR_SUCCESS;
 }
@@ -177,16 +178,14 @@ oxr_event_push_XrEventDataInteractionProfileChanged(struct oxr_logger *log, stru
 {
 	struct oxr_instance *inst = sess->sys->inst;
 	XrEventDataInteractionProfileChanged *changed;
-	struct oxr_event *event = NULL;
+	struct oxr_event event;
 
-	ALLOC(log, inst, &event, &changed);
+	ALLOC(&event, &changed);
 
 	changed->type = XR_TYPE_EVENT_DATA_INTERACTION_PROFILE_CHANGED;
 	changed->session = oxr_session_to_openxr(sess);
 
-	lock(inst);
-	push(inst, event);
-	unlock(inst);
+	push(inst, &event);
 
 	return XR_SUCCESS;
 }
@@ -201,9 +200,9 @@ oxr_event_push_XrEventDataReferenceSpaceChangePending(struct oxr_logger *log,
 {
 	struct oxr_instance *inst = sess->sys->inst;
 	XrEventDataReferenceSpaceChangePending *pending;
-	struct oxr_event *event = NULL;
+	struct oxr_event event;
 
-	ALLOC(log, inst, &event, &pending);
+	ALLOC(&event, &pending);
 
 	pending->type = XR_TYPE_EVENT_DATA_REFERENCE_SPACE_CHANGE_PENDING;
 	pending->session = oxr_session_to_openxr(sess);
@@ -211,11 +210,9 @@ oxr_event_push_XrEventDataReferenceSpaceChangePending(struct oxr_logger *log,
 	pending->changeTime = changeTime;
 	pending->poseValid = poseValid;
 	pending->poseInPreviousSpace = *poseInPreviousSpace;
-	event->result = XR_SUCCESS;
+	event.result = XR_SUCCESS;
 
-	lock(inst);
-	push(inst, event);
-	unlock(inst);
+	push(inst, &event);
 
 	return XR_SUCCESS;
 }
@@ -229,16 +226,14 @@ oxr_event_push_XrEventDataDisplayRefreshRateChangedFB(struct oxr_logger *log,
 {
 	struct oxr_instance *inst = sess->sys->inst;
 	XrEventDataDisplayRefreshRateChangedFB *changed;
-	struct oxr_event *event = NULL;
+	struct oxr_event event;
 
-	ALLOC(log, inst, &event, &changed);
+	ALLOC(&event, &changed);
 	changed->type = XR_TYPE_EVENT_DATA_DISPLAY_REFRESH_RATE_CHANGED_FB;
 	changed->fromDisplayRefreshRate = fromDisplayRefreshRate;
 	changed->toDisplayRefreshRate = toDisplayRefreshRate;
-	event->result = XR_SUCCESS;
-	lock(inst);
-	push(inst, event);
-	unlock(inst);
+	event.result = XR_SUCCESS;
+	push(inst, &event);
 
 	return XR_SUCCESS;
 }
@@ -252,16 +247,14 @@ oxr_event_push_XrEventDataMainSessionVisibilityChangedEXTX(struct oxr_logger *lo
 {
 	struct oxr_instance *inst = sess->sys->inst;
 	XrEventDataMainSessionVisibilityChangedEXTX *changed;
-	struct oxr_event *event = NULL;
+	struct oxr_event event;
 
-	ALLOC(log, inst, &event, &changed);
+	ALLOC(&event, &changed);
 	changed->type = XR_TYPE_EVENT_DATA_MAIN_SESSION_VISIBILITY_CHANGED_EXTX;
 	changed->flags = 0;
 	changed->visible = visible;
-	event->result = XR_SUCCESS;
-	lock(inst);
-	push(inst, event);
-	unlock(inst);
+	event.result = XR_SUCCESS;
+	push(inst, &event);
 
 	return XR_SUCCESS;
 }
@@ -279,18 +272,16 @@ oxr_event_push_XrEventDataPerfSettingsEXTX(struct oxr_logger *log,
 {
 	struct oxr_instance *inst = sess->sys->inst;
 	XrEventDataPerfSettingsEXT *changed;
-	struct oxr_event *event = NULL;
+	struct oxr_event event;
 
-	ALLOC(log, inst, &event, &changed);
+	ALLOC(&event, &changed);
 	changed->type = XR_TYPE_EVENT_DATA_PERF_SETTINGS_EXT;
 	changed->domain = xrt_perf_domain_to_xr(domain);
 	changed->subDomain = xrt_perf_sub_domain_to_xr(subDomain);
 	changed->fromLevel = xrt_perf_notify_level_to_xr(fromLevel);
 	changed->toLevel = xrt_perf_notify_level_to_xr(toLevel);
-	event->result = XR_SUCCESS;
-	lock(inst);
-	push(inst, event);
-	unlock(inst);
+	event.result = XR_SUCCESS;
+	push(inst, &event);
 
 	return XR_SUCCESS;
 }
@@ -304,15 +295,13 @@ oxr_event_push_XrEventDataPassthroughStateChangedFB(struct oxr_logger *log,
 {
 	struct oxr_instance *inst = sess->sys->inst;
 	XrEventDataPassthroughStateChangedFB *changed;
-	struct oxr_event *event = NULL;
+	struct oxr_event event;
 
-	ALLOC(log, inst, &event, &changed);
+	ALLOC(&event, &changed);
 	changed->type = XR_TYPE_EVENT_DATA_PASSTHROUGH_STATE_CHANGED_FB;
 	changed->flags = flags;
-	event->result = XR_SUCCESS;
-	lock(inst);
-	push(inst, event);
-	unlock(inst);
+	event.result = XR_SUCCESS;
+	push(inst, &event);
 
 	return XR_SUCCESS;
 }
@@ -327,17 +316,15 @@ oxr_event_push_XrEventDataVisibilityMaskChangedKHR(struct oxr_logger *log,
 {
 	struct oxr_instance *inst = sess->sys->inst;
 	XrEventDataVisibilityMaskChangedKHR *changed;
-	struct oxr_event *event = NULL;
+	struct oxr_event event;
 
-	ALLOC(log, inst, &event, &changed);
+	ALLOC(&event, &changed);
 	changed->type = XR_TYPE_EVENT_DATA_VISIBILITY_MASK_CHANGED_KHR;
 	changed->session = oxr_session_to_openxr(sess);
 	changed->viewConfigurationType = viewConfigurationType;
 	changed->viewIndex = viewIndex;
-	event->result = XR_SUCCESS;
-	lock(inst);
-	push(inst, event);
-	unlock(inst);
+	event.result = XR_SUCCESS;
+	push(inst, &event);
 
 	return XR_SUCCESS;
 }
@@ -349,16 +336,14 @@ oxr_event_push_XrEventDataUserPresenceChangedEXT(struct oxr_logger *log, struct
 {
 	struct oxr_instance *inst = sess->sys->inst;
 	XrEventDataUserPresenceChangedEXT *changed;
-	struct oxr_event *event = NULL;
+	struct oxr_event event;
 
-	ALLOC(log, inst, &event, &changed);
+	ALLOC(&event, &changed);
 	changed->type = XR_TYPE_EVENT_DATA_USER_PRESENCE_CHANGED_EXT;
 	changed->session = oxr_session_to_openxr(sess);
 	changed->isUserPresent = isUserPresent;
-	event->result = XR_SUCCESS;
-	lock(inst);
-	push(inst, event);
-	unlock(inst);
+	event.result = XR_SUCCESS;
+	push(inst, &event);
 
 	return XR_SUCCESS;
 }
@@ -372,24 +357,22 @@ oxr_event_remove_session_events(struct oxr_logger *log, struct oxr_session *sess
 
 	lock(inst);
 
-	struct oxr_event *e = inst->event.next;
-	while (e != NULL) {
-		struct oxr_event *cur = e;
-		e = e->next;
-
-		if (!is_session_link_to_event(cur, session)) {
+	// Compact the ring, keeping the order of the remaining events.
+	uint32_t kept = 0;
+	for (uint32_t i = 0; i < inst->event.count; i++) {
+		struct oxr_event *e = get_slot(inst, i);
+		if (is_session_link_to_event(e, session)) {
 			continue;
 		}
 
-		if (cur == inst->event.next) {
-			inst->event.next = cur->next;
+		if (kept != i) {
+			*get_slot(inst, kept) = *e;
 		}
-
-		if (cur == inst->event.last) {
-			inst->event.last = NULL;
-		}
-		free(cur);
+		kept++;
 	}
+	inst->event.count = kept;
+
+	update_pending(inst);
 
 	unlock(inst);
 
@@ -411,17 +394,17 @@ oxr_poll_event(struct oxr_logger *log, struct oxr_instance *inst, XrEventDataBuf
 		sess = sess->next;
 	}
 
-	lock(inst);
-	struct oxr_event *event = pop(inst);
-	unlock(inst);
+	// Common case, nothing queued so no need to take the lock.
+	if (xrt_atomic_s32_load_acquire(&inst->event.pending) <= 0) {
+		return XR_EVENT_UNAVAILABLE;
+	}
 
-	if (event == NULL) {
+	struct oxr_event event;
+	if (!pop(inst, &event)) {
 		return XR_EVENT_UNAVAILABLE;
 	}
 
-	ret = event->result;
-	memcpy(eventData, oxr_event_extra(event), event->length);
-	free(event);
+	memcpy(eventData, oxr_event_extra(&event), event.length);
 
-	return ret;
+	return event.result;
 }
@@ -33,6 +33,13 @@
 #include <assert.h>
 
 
+/*!
+ * Max number of attached action sets for which the bound input index is used,
+ * one bit per action set in @ref oxr_action_input::bound_act_sets_mask.
+ */
+#define OXR_INPUT_INDEX_MAX_ACTION_SETS (64)
+
+
 /*
  *
  * Pre declare functions.
@@ -948,13 +955,13 @@ oxr_get_action_set_priority(const struct oxr_action_set_ref *act_set_ref,
 }
 
 static bool
-oxr_input_supressed(struct oxr_session *sess,
-                    uint32_t countActionSets,
-                    const XrActiveActionSet *actionSets,
-                    struct oxr_subaction_paths *subaction_path,
-                    struct oxr_action_attachment *act_attached,
-                    struct oxr_action_input *action_input,
-                    const XrActiveActionSetPrioritiesEXT *active_priorities)
+oxr_input_supressed_slow(struct oxr_session *sess,
+                         uint32_t countActionSets,
+                         const XrActiveActionSet *actionSets,
+                         struct oxr_subaction_paths *subaction_path,
+                         struct oxr_action_attachment *act_attached,
+                         struct oxr_action_input *action_input,
+                         const XrActiveActionSetPrioritiesEXT *active_priorities)
 {
 	struct oxr_action_set_ref *act_set_ref = act_attached->act_set_attached->act_set_ref;
 	uint32_t priority = oxr_get_action_set_priority(act_set_ref, active_priorities);
@@ -1007,6 +1014,59 @@ oxr_input_supressed(struct oxr_session *sess,
 	return false;
 }
 
+/*!
+ * Same as @ref oxr_input_supressed_slow but uses the index built by
+ * @ref oxr_session_build_input_index and the priorities and sub-action paths
+ * stored on the action set attachments for the current sync.
+ */
+static bool
+oxr_input_supressed(struct oxr_session *sess,
+                    uint32_t countActionSets,
+                    const XrActiveActionSet *actionSets,
+                    struct oxr_subaction_paths *subaction_path,
+                    struct oxr_action_attachment *act_attached,
+                    struct oxr_action_input *action_input,
+                    const XrActiveActionSetPrioritiesEXT *active_priorities)
+{
+	if (sess->action_set_attachment_count > OXR_INPUT_INDEX_MAX_ACTION_SETS) {
+		return oxr_input_supressed_slow(sess, countActionSets, actionSets, subaction_path, act_attached,
+		                                action_input, active_priorities);
+	}
+
+	struct oxr_action_set_attachment *act_set_attached = act_attached->act_set_attached;
+	size_t own_index = act_set_attached - sess->act_set_attachments;
+
+	// Only action sets that also have this input bound, skipping our own.
+	uint64_t mask = action_input->bound_act_sets_mask & ~(UINT64_C(1) << own_index);
+
+	for (size_t i = 0; mask != 0; i++, mask >>= 1) {
+		if ((mask & 1) == 0) {
+			continue;
+		}
+
+		struct oxr_action_set_attachment *other_act_set_attached = &sess->act_set_attachments[i];
+
+		/* input may be suppressed by action set with higher prio */
+		if (other_act_set_attached->requested_priority <= act_set_attached->requested_priority) {
+			continue;
+		}
+
+		/* Not synced action sets have no requested subaction paths. */
+		bool relevant_subactionpath = other_act_set_attached->requested_subaction_paths.any;
+
+#define ACCUMULATE_PATHS(X)                                                                                            \
+	relevant_subactionpath |= (other_act_set_attached->requested_subaction_paths.X && subaction_path->X);
+		OXR_FOR_EACH_SUBACTION_PATH(ACCUMULATE_PATHS)
+#undef ACCUMULATE_PATHS
+
+		if (relevant_subactionpath) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 static bool
 oxr_input_combine_input(struct oxr_session *sess,
                         uint32_t countActionSets,
@@ -1035,6 +1095,11 @@ oxr_input_combine_input(struct oxr_session *sess,
 		struct oxr_action_input *action_input = &(inputs[i]);
 		struct xrt_input *input = action_input->input;
 
+		// Inactive inputs are skipped anyway, so check that first.
+		if (!input->active) {
+			continue;
+		}
+
 		// suppress input if it is also bound to action in set with
 		// higher priority
 		if (oxr_input_supressed(sess, countActionSets, actionSets, subaction_path, act_attached, action_input,
@@ -1042,11 +1107,7 @@ oxr_input_combine_input(struct oxr_session *sess,
 			continue;
 		}
 
-		if (input->active) {
-			any_active = true;
-		} else {
-			continue;
-		}
+		any_active = true;
 
 		struct oxr_input_value_tagged raw_input = {
 		    .type = XRT_GET_INPUT_TYPE(input->name),
@@ -1726,6 +1787,15 @@ oxr_session_get_action_attachment(struct oxr_session *sess,
                                   uint32_t act_key,
                                   struct oxr_action_attachment **out_act_attached)
 {
+	// Fast path, a single indexed read.
+	if (sess->act_attachments_by_index != NULL) {
+		uint32_t index = act_key - sess->act_attachments_key_base;
+		if (index < sess->act_attachments_index_count && sess->act_attachments_by_index[index] != NULL) {
+			*out_act_attached = sess->act_attachments_by_index[index];
+		}
+		return;
+	}
+
 	void *ptr = NULL;
 
 	int ret = u_hashmap_int_find(sess->act_attachments_by_key, act_key, &ptr);
@@ -1766,6 +1836,152 @@ oxr_clone_profiles_to_session(struct oxr_logger *log, struct oxr_instance *inst,
 	}
 }
 
+struct oxr_bound_path_entry
+{
+	XrPath path;
+	uint64_t mask;
+};
+
+static int
+oxr_bound_path_entry_cmp(const void *a, const void *b)
+{
+	XrPath pa = ((const struct oxr_bound_path_entry *)a)->path;
+	XrPath pb = ((const struct oxr_bound_path_entry *)b)->path;
+
+	return pa < pb ? -1 : (pa > pb ? 1 : 0);
+}
+
+/*!
+ * Collects all bound inputs of all attached actions, with one entry for the
+ * action set each is bound in. Returns the number of inputs, pass NULL to
+ * only count them.
+ *
+ * @private @memberof oxr_session
+ */
+static size_t
+oxr_session_collect_bound_inputs(struct oxr_session *sess,
+                                 struct oxr_bound_path_entry *out_entries,
+                                 struct oxr_action_input **out_inputs)
+{
+	size_t count = 0;
+
+	for (size_t i = 0; i < sess->action_set_attachment_count; i++) {
+		struct oxr_action_set_attachment *act_set_attached = &sess->act_set_attachments[i];
+
+		for (size_t k = 0; k < act_set_attached->action_attachment_count; k++) {
+			struct oxr_action_attachment *act_attached = &act_set_attached->act_attachments[k];
+
+#define COLLECT_INPUTS(X)                                                                                              \
+	for (size_t n = 0; n < act_attached->X.input_count; n++) {                                                     \
+		if (out_entries != NULL) {                                                                             \
+			out_entries[count].path = act_attached->X.inputs[n].bound_path;                                \
+			out_entries[count].mask = UINT64_C(1) << i;                                                    \
+			out_inputs[count] = &act_attached->X.inputs[n];                                                \
+		}                                                                                                      \
+		count++;                                                                                               \
+	}
+			OXR_FOR_EACH_SUBACTION_PATH(COLLECT_INPUTS)
+#undef COLLECT_INPUTS
+		}
+	}
+
+	return count;
+}
+
+/*!
+ * Build @ref oxr_action_input::bound_act_sets_mask for all bound inputs, needs
+ * to be called every time the bindings change.
+ *
+ * @private @memberof oxr_session
+ */
+static void
+oxr_session_build_input_index(struct oxr_session *sess)
+{
+	if (sess->action_set_attachment_count > OXR_INPUT_INDEX_MAX_ACTION_SETS) {
+		return; // Falls back to the slow path.
+	}
+
+	size_t count = oxr_session_collect_bound_inputs(sess, NULL, NULL);
+	if (count == 0) {
+		return;
+	}
+
+	struct oxr_bound_path_entry *entries = U_TYPED_ARRAY_CALLOC(struct oxr_bound_path_entry, count);
+	struct oxr_bound_path_entry *merged = U_TYPED_ARRAY_CALLOC(struct oxr_bound_path_entry, count);
+	struct oxr_action_input **inputs = U_TYPED_ARRAY_CALLOC(struct oxr_action_input *, count);
+	oxr_session_collect_bound_inputs(sess, entries, inputs);
+
+	// Sort on path and merge the masks of equal paths.
+	memcpy(merged, entries, sizeof(*entries) * count);
+	qsort(merged, count, sizeof(*merged), oxr_bound_path_entry_cmp);
+
+	size_t merged_count = 0;
+	for (size_t i = 0; i < count; i++) {
+		if (merged_count > 0 && merged[merged_count - 1].path == merged[i].path) {
+			merged[merged_count - 1].mask |= merged[i].mask;
+		} else {
+			merged[merged_count++] = merged[i];
+		}
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		struct oxr_bound_path_entry *found =
+		    bsearch(&entries[i], merged, merged_count, sizeof(*merged), oxr_bound_path_entry_cmp);
+		assert(found != NULL);
+		inputs[i]->bound_act_sets_mask = found->mask;
+	}
+
+	free(entries);
+	free(merged);
+	free(inputs);
+}
+
+/*!
+ * Build @ref oxr_session::act_attachments_by_index, action keys are handed out
+ * in order so the keys of the attached actions are nearly always a dense range.
+ * Falls back to the hashmap if they are too spread out.
+ *
+ * @private @memberof oxr_session
+ */
+static void
+oxr_session_build_action_lookup(struct oxr_session *sess)
+{
+	uint32_t min_key = UINT32_MAX;
+	uint32_t max_key = 0;
+	size_t count = 0;
+
+	for (size_t i = 0; i < sess->action_set_attachment_count; i++) {
+		struct oxr_action_set_attachment *act_set_attached = &sess->act_set_attachments[i];
+		for (size_t k = 0; k < act_set_attached->action_attachment_count; k++) {
+			uint32_t act_key = act_set_attached->act_attachments[k].act_key;
+			if (act_key < min_key) {
+				min_key = act_key;
+			}
+			if (act_key > max_key) {
+				max_key = act_key;
+			}
+			count++;
+		}
+	}
+
+	if (count == 0 || max_key - min_key >= count * 4 + 64) {
+		return;
+	}
+
+	sess->act_attachments_key_base = min_key;
+	sess->act_attachments_index_count = max_key - min_key + 1;
+	sess->act_attachments_by_index =
+	    U_TYPED_ARRAY_CALLOC(struct oxr_action_attachment *, sess->act_attachments_index_count);
+
+	for (size_t i = 0; i < sess->action_set_attachment_count; i++) {
+		struct oxr_action_set_attachment *act_set_attached = &sess->act_set_attachments[i];
+		for (size_t k = 0; k < act_set_attached->action_attachment_count; k++) {
+			struct oxr_action_attachment *act_attached = &act_set_attached->act_attachments[k];
+			sess->act_attachments_by_index[act_attached->act_key - min_key] = act_attached;
+		}
+	}
+}
+
 XrResult
 oxr_session_attach_action_sets(struct oxr_logger *log,
                                struct oxr_session *sess,
@@ -1814,6 +2030,9 @@ oxr_session_attach_action_sets(struct oxr_logger *log,
 		}
 	}
 
+	oxr_session_build_action_lookup(sess);
+	oxr_session_build_input_index(sess);
+
 #define POPULATE_PROFILE(X)                                                                                            \
 	sess->X = XR_NULL_PATH;                                                                                        \
 	if (profiles.X != NULL) {                                                                                      \
@@ -1839,6 +2058,8 @@ oxr_session_update_action_bindings(struct oxr_logger *log, struct oxr_session *s
 		}
 	}
 
+	oxr_session_build_input_index(sess);
+
 #define POPULATE_PROFILE(X)                                                                                            \
 	sess->X = XR_NULL_PATH;                                                                                        \
 	if (profiles.X != NULL) {                                                                                      \
@@ -1875,6 +2096,9 @@ oxr_action_sync_data(struct oxr_logger *log,
 	// Synchronize outputs to this time.
 	int64_t now = time_state_get_now(sess->sys->inst->timekeeping);
 
+	// Devices get new data and action spaces might get bound to other devices.
+	oxr_session_locate_cache_invalidate(sess);
+
 	// Loop over all xdev devices.
 	for (size_t i = 0; i < sess->sys->xsysd->xdev_count; i++) {
 		if (sess->sys->xsysd->xdevs[i]) {
@@ -1907,6 +2131,8 @@ oxr_action_sync_data(struct oxr_logger *log,
 		bool any_action_with_subactionpath = subaction_paths.any;
 
 		oxr_subaction_paths_accumulate(&(act_set_attached->requested_subaction_paths), &subaction_paths);
+		act_set_attached->requested_priority =
+		    oxr_get_action_set_priority(act_set_attached->act_set_ref, activePriorities);
 
 		/* check if we have at least one action for requested subactionpath */
 		for (uint32_t k = 0; k < act_set_attached->action_attachment_count; k++) {
@@ -143,15 +143,12 @@ oxr_input_transform_init_bool_to_vec1(struct oxr_input_transform *transform,
 	return true;
 }
 
-bool
-oxr_input_transform_process(struct oxr_input_transform *transform,
-                            size_t transform_count,
-                            const struct oxr_input_value_tagged *input,
-                            struct oxr_input_value_tagged *out)
+static bool
+interpret_chain(struct oxr_input_transform *transform,
+                size_t transform_count,
+                const struct oxr_input_value_tagged *input,
+                struct oxr_input_value_tagged *out)
 {
-	if (transform == NULL) {
-		return false;
-	}
 	struct oxr_input_value_tagged data = *input;
 	for (size_t i = 0; i < transform_count; ++i) {
 		struct oxr_input_transform *xform = &(transform[i]);
@@ -253,6 +250,48 @@ oxr_input_transform_process(struct oxr_input_transform *transform,
 	return true;
 }
 
+bool
+oxr_input_transform_process(struct oxr_input_transform *transform,
+                            size_t transform_count,
+                            const struct oxr_input_value_tagged *input,
+                            struct oxr_input_value_tagged *out)
+{
+	if (transform == NULL || transform_count == 0) {
+		return false;
+	}
+
+	// The threshold and bool to vec1 data lives on the last transform.
+	const struct oxr_input_transform *last = &transform[transform_count - 1];
+	const union xrt_input_value *value = &input->value;
+	struct oxr_input_value_tagged data = *input;
+
+	switch (transform->fused) {
+	case INPUT_TRANSFORM_FUSED_IDENTITY: break;
+	case INPUT_TRANSFORM_FUSED_VEC2_GET_X: data.value.vec1.x = value->vec2.x; break;
+	case INPUT_TRANSFORM_FUSED_VEC2_GET_Y: data.value.vec1.x = value->vec2.y; break;
+	case INPUT_TRANSFORM_FUSED_THRESHOLD:
+		data.value.boolean = (value->vec1.x > last->data.threshold.threshold) != last->data.threshold.invert;
+		break;
+	case INPUT_TRANSFORM_FUSED_VEC2_X_THRESHOLD:
+		data.value.boolean = (value->vec2.x > last->data.threshold.threshold) != last->data.threshold.invert;
+		break;
+	case INPUT_TRANSFORM_FUSED_VEC2_Y_THRESHOLD:
+		data.value.boolean = (value->vec2.y > last->data.threshold.threshold) != last->data.threshold.invert;
+		break;
+	case INPUT_TRANSFORM_FUSED_BOOL_TO_VEC1:
+		data.value.vec1.x =
+		    value->boolean ? last->data.bool_to_vec1.true_val : last->data.bool_to_vec1.false_val;
+		break;
+	case INPUT_TRANSFORM_FUSED_NONE:
+	default: return interpret_chain(transform, transform_count, input, out);
+	}
+
+	data.type = transform->chain_result_type;
+	*out = data;
+
+	return true;
+}
+
 static bool
 ends_with(const char *str, const char *suffix)
 {
@@ -338,6 +377,49 @@ extend_transform_array(struct oxr_logger *log,
 	return false;
 }
 
+/*!
+ * Flatten a chain into a single operation stored on the first transform, chains
+ * that can't be flattened are left to be walked by @ref interpret_chain.
+ */
+static void
+fuse_chain(struct oxr_input_transform *transforms, size_t transform_count)
+{
+	enum oxr_input_transform_type types[2] = {INPUT_TRANSFORM_INVALID, INPUT_TRANSFORM_INVALID};
+	size_t type_count = 0;
+
+	for (size_t i = 0; i < transform_count; i++) {
+		if (transforms[i].type == INPUT_TRANSFORM_IDENTITY) {
+			continue;
+		}
+		if (type_count >= ARRAY_SIZE(types)) {
+			return;
+		}
+		types[type_count++] = transforms[i].type;
+	}
+
+	enum oxr_input_transform_fused fused = INPUT_TRANSFORM_FUSED_NONE;
+	if (type_count == 0) {
+		fused = INPUT_TRANSFORM_FUSED_IDENTITY;
+	} else if (type_count == 1) {
+		switch (types[0]) {
+		case INPUT_TRANSFORM_VEC2_GET_X: fused = INPUT_TRANSFORM_FUSED_VEC2_GET_X; break;
+		case INPUT_TRANSFORM_VEC2_GET_Y: fused = INPUT_TRANSFORM_FUSED_VEC2_GET_Y; break;
+		case INPUT_TRANSFORM_THRESHOLD: fused = INPUT_TRANSFORM_FUSED_THRESHOLD; break;
+		case INPUT_TRANSFORM_BOOL_TO_VEC1: fused = INPUT_TRANSFORM_FUSED_BOOL_TO_VEC1; break;
+		default: break;
+		}
+	} else if (types[1] == INPUT_TRANSFORM_THRESHOLD) {
+		switch (types[0]) {
+		case INPUT_TRANSFORM_VEC2_GET_X: fused = INPUT_TRANSFORM_FUSED_VEC2_X_THRESHOLD; break;
+		case INPUT_TRANSFORM_VEC2_GET_Y: fused = INPUT_TRANSFORM_FUSED_VEC2_Y_THRESHOLD; break;
+		default: break;
+		}
+	}
+
+	transforms[0].fused = fused;
+	transforms[0].chain_result_type = transforms[transform_count - 1].result_type;
+}
+
 struct oxr_input_transform *
 oxr_input_transform_clone_chain(struct oxr_input_transform *transforms, size_t transform_count)
 {
@@ -373,6 +455,7 @@ oxr_input_transform_create_chain(struct oxr_logger *log,
 
 	if (identity) {
 		// No transform needed, just return identity to keep this alive.
+		fuse_chain(chain, 1);
 		*out_transform_count = 1;
 		*out_transforms = oxr_input_transform_clone_chain(chain, 1);
 		oxr_slog(slog, "\t\t\tUsing identity transform for input.\n");
@@ -406,6 +489,8 @@ oxr_input_transform_create_chain(struct oxr_logger *log,
 		current_xform = new_xform;
 	}
 
+	fuse_chain(chain, transform_count);
+
 	*out_transform_count = transform_count;
 	*out_transforms = oxr_input_transform_clone_chain(chain, transform_count);
 
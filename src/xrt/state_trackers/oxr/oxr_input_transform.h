@@ -92,6 +92,40 @@ enum oxr_input_transform_type
 	INPUT_TRANSFORM_DPAD,
 };
 
+/*!
+ * A whole transform chain flattened into a single operation, worked out once
+ * when the chain is created so that processing doesn't have to walk it.
+ *
+ * Stored in the first transform of the chain.
+ * @see oxr_input_transform::fused
+ */
+enum oxr_input_transform_fused
+{
+	//! Not flattened, walk the chain (also used for stateful transforms like dpad).
+	INPUT_TRANSFORM_FUSED_NONE = 0,
+
+	//! Only identity transforms, the input is passed through.
+	INPUT_TRANSFORM_FUSED_IDENTITY,
+
+	//! Get the X component of a 2D float input.
+	INPUT_TRANSFORM_FUSED_VEC2_GET_X,
+
+	//! Get the Y component of a 2D float input.
+	INPUT_TRANSFORM_FUSED_VEC2_GET_Y,
+
+	//! Threshold a 1D float input.
+	INPUT_TRANSFORM_FUSED_THRESHOLD,
+
+	//! Threshold the X component of a 2D float input.
+	INPUT_TRANSFORM_FUSED_VEC2_X_THRESHOLD,
+
+	//! Threshold the Y component of a 2D float input.
+	INPUT_TRANSFORM_FUSED_VEC2_Y_THRESHOLD,
+
+	//! Convert a bool to a 1D float input.
+	INPUT_TRANSFORM_FUSED_BOOL_TO_VEC1,
+};
+
 struct oxr_input_transform;
 /*!
  * Data required for INPUT_TRANSFORM_THRESHOLD
@@ -153,6 +187,18 @@ struct oxr_input_transform
 	//! The type output by this transform.
 	enum xrt_input_type result_type;
 
+	/*!
+	 * Only valid on the first transform of a chain, the flattened
+	 * operation for the whole chain.
+	 */
+	enum oxr_input_transform_fused fused;
+
+	/*!
+	 * Only valid on the first transform of a chain, the type output by
+	 * the last transform.
+	 */
+	enum xrt_input_type chain_result_type;
+
 	union {
 		/*!
 		 * Populated when oxr_input_transform::type is
@@ -39,7 +39,9 @@
 
 DEBUG_GET_ONCE_BOOL_OPTION(no_printing, "OXR_NO_PRINTING", false)
 DEBUG_GET_ONCE_BOOL_OPTION(no_printing_stderr, "OXR_NO_PRINTING_STDERR", DEFAULT_NO_STDERR)
+#ifdef XRT_FEATURE_OPENXR_ENTRYPOINT_TRACE
 DEBUG_GET_ONCE_BOOL_OPTION(entrypoints, "OXR_DEBUG_ENTRYPOINTS", false)
+#endif
 DEBUG_GET_ONCE_BOOL_OPTION(break_on_error, "OXR_BREAK_ON_ERROR", false)
 
 
@@ -141,6 +143,7 @@ do_print(struct oxr_logger *logger, const char *fmt, const char *prefix, va_list
 	do_output(buf);
 }
 
+#ifdef XRT_FEATURE_OPENXR_ENTRYPOINT_TRACE
 static void
 do_print_func(const char *api_func_name)
 {
@@ -148,6 +151,7 @@ do_print_func(const char *api_func_name)
 	u_truncate_snprintf(buf, sizeof(buf), "%s\n", api_func_name);
 	do_output(buf);
 }
+#endif
 
 
 /*
@@ -156,22 +160,21 @@ do_print_func(const char *api_func_name)
  *
  */
 
+#ifdef XRT_FEATURE_OPENXR_ENTRYPOINT_TRACE
+int32_t oxr_log_entrypoints_state = -1;
+
 void
-oxr_log_init(struct oxr_logger *logger, const char *api_func_name)
+oxr_log_entrypoint(const char *api_func_name)
 {
-	if (debug_get_bool_option_entrypoints()) {
-		do_print_func(api_func_name);
+	if (oxr_log_entrypoints_state < 0) {
+		oxr_log_entrypoints_state = debug_get_bool_option_entrypoints() ? 1 : 0;
 	}
 
-	logger->inst = NULL;
-	logger->api_func_name = api_func_name;
-}
-
-void
-oxr_log_set_instance(struct oxr_logger *logger, struct oxr_instance *inst)
-{
-	logger->inst = inst;
+	if (oxr_log_entrypoints_state > 0) {
+		do_print_func(api_func_name);
+	}
 }
+#endif
 
 void
 oxr_log(struct oxr_logger *logger, const char *fmt, ...)
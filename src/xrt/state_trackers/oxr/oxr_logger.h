@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include "xrt/xrt_config_build.h"
+
 #include "util/u_pretty_print.h"
 
 
@@ -48,10 +50,44 @@ struct oxr_logger
  * @{
  */
 
+#ifdef XRT_FEATURE_OPENXR_ENTRYPOINT_TRACE
+/*!
+ * Cached value of OXR_DEBUG_ENTRYPOINTS, negative until it has been read.
+ */
+extern int32_t oxr_log_entrypoints_state;
+
+/*!
+ * Print the entrypoint name if OXR_DEBUG_ENTRYPOINTS is set, reads the option
+ * the first time it is called.
+ */
 void
-oxr_log_init(struct oxr_logger *logger, const char *api_func_name);
-void
-oxr_log_set_instance(struct oxr_logger *logger, struct oxr_instance *inst);
+oxr_log_entrypoint(const char *api_func_name);
+#endif
+
+/*!
+ * Set up a logger for an API call. Inline and only two stores, so it can be
+ * used on every call: entrypoint tracing costs a single load when disabled,
+ * and nothing at all when built without XRT_FEATURE_OPENXR_ENTRYPOINT_TRACE.
+ */
+static inline void
+oxr_log_init(struct oxr_logger *logger, const char *api_func_name)
+{
+#ifdef XRT_FEATURE_OPENXR_ENTRYPOINT_TRACE
+	if (oxr_log_entrypoints_state != 0) {
+		oxr_log_entrypoint(api_func_name);
+	}
+#endif
+
+	logger->inst = NULL;
+	logger->api_func_name = api_func_name;
+}
+
+static inline void
+oxr_log_set_instance(struct oxr_logger *logger, struct oxr_instance *inst)
+{
+	logger->inst = inst;
+}
+
 void
 oxr_log(struct oxr_logger *logger, const char *fmt, ...) XRT_PRINTF_FORMAT(2, 3);
 void
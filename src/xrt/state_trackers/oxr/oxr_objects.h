@@ -134,6 +134,10 @@ struct oxr_plane_detector_ext;
 
 #define XRT_MAX_HANDLE_CHILDREN 256
 #define OXR_MAX_BINDINGS_PER_ACTION 32
+#define OXR_SESSION_SPACE_CACHE_SIZE 16
+#define OXR_SESSION_VIEW_CACHE_SIZE 4
+#define OXR_MAX_EVENT_COUNT 64
+#define OXR_MAX_EVENT_SIZE 128
 
 struct time_state;
 
@@ -839,6 +843,38 @@ oxr_session_locate_views(struct oxr_logger *log,
 XrResult
 oxr_session_frame_wait(struct oxr_logger *log, struct oxr_session *sess, XrFrameState *frameState);
 
+/*!
+ * Looks up a relation located earlier this frame for the given spaces and time.
+ *
+ * @see oxr_session::locate_cache
+ */
+bool
+oxr_session_locate_cache_get_space(struct oxr_session *sess,
+                                   const struct oxr_space *spc,
+                                   const struct oxr_space *baseSpc,
+                                   XrTime time,
+                                   struct xrt_space_relation *out_relation);
+
+/*!
+ * Stores a located relation for the given spaces and time.
+ *
+ * @see oxr_session::locate_cache
+ */
+void
+oxr_session_locate_cache_put_space(struct oxr_session *sess,
+                                   const struct oxr_space *spc,
+                                   const struct oxr_space *baseSpc,
+                                   XrTime time,
+                                   const struct xrt_space_relation *relation);
+
+/*!
+ * Drops all cached relations and views, called when tracking data might have changed.
+ *
+ * @see oxr_session::locate_cache
+ */
+void
+oxr_session_locate_cache_invalidate(struct oxr_session *sess);
+
 XrResult
 oxr_session_frame_begin(struct oxr_logger *log, struct oxr_session *sess);
 
@@ -1448,28 +1484,34 @@ oxr_swapchain_d3d12_create(struct oxr_logger *,
  */
 struct oxr_handle_base
 {
+	/*
+	 * The debug magic and state are checked by every API call that takes
+	 * this handle, keep them together at the start so the check touches a
+	 * single cache line instead of having to skip past @ref children.
+	 */
+
 	//! Magic (per-handle-type) value for debugging.
 	uint64_t debug;
 
 	/*!
-	 * Pointer to this object's parent handle holder, if any.
+	 * Current handle state.
 	 */
-	struct oxr_handle_base *parent;
+	enum oxr_handle_state state;
 
 	/*!
-	 * Array of children, if any.
+	 * Destroy the object this handle refers to.
 	 */
-	struct oxr_handle_base *children[XRT_MAX_HANDLE_CHILDREN];
+	oxr_handle_destroyer destroy;
 
 	/*!
-	 * Current handle state.
+	 * Pointer to this object's parent handle holder, if any.
 	 */
-	enum oxr_handle_state state;
+	struct oxr_handle_base *parent;
 
 	/*!
-	 * Destroy the object this handle refers to.
+	 * Array of children, if any.
 	 */
-	oxr_handle_destroyer destroy;
+	struct oxr_handle_base *children[XRT_MAX_HANDLE_CHILDREN];
 };
 
 /*!
@@ -1661,6 +1703,26 @@ struct oxr_extension_status
 };
 #undef MAKE_EXT_STATUS
 
+/*!
+ * A queued event, lives in the fixed pool of the instance event queue.
+ *
+ * @see oxr_instance::event
+ */
+struct oxr_event
+{
+	//! Size of the XrEventData* struct stored in @ref data.
+	size_t length;
+
+	//! Returned from xrPollEvent when this event is delivered.
+	XrResult result;
+
+	union {
+		XrEventDataBaseHeader base;
+		uint64_t align;
+		uint8_t bytes[OXR_MAX_EVENT_SIZE];
+	} data;
+};
+
 /*!
  * Main object that ties everything together.
  *
@@ -1700,7 +1762,15 @@ struct oxr_instance
 	} action_sets;
 
 	//! Path store, for looking up paths.
-	struct u_hashset *path_store;
+	struct
+	{
+		//! Open addressing table of path ids, length is a power of two.
+		uint32_t *table;
+		//! Length of @ref table.
+		size_t table_length;
+		//! Arena blocks that the paths are allocated from.
+		struct oxr_path_block *blocks;
+	} path_store;
 	//! Mapping from ID to path.
 	struct oxr_path **path_array;
 	//! Total length of path array.
@@ -1708,12 +1778,27 @@ struct oxr_instance
 	//! Number of paths in the array (0 is always null).
 	size_t path_num;
 
-	// Event queue.
+	/*!
+	 * Event queue, a ring buffer over a fixed pool of events. Pushing and
+	 * removing is done under the mutex, @p pending is updated with release
+	 * semantics so xrPollEvent can check for an empty queue without locking.
+	 */
 	struct
 	{
 		struct os_mutex mutex;
-		struct oxr_event *last;
-		struct oxr_event *next;
+		struct oxr_event slots[OXR_MAX_EVENT_COUNT];
+
+		//! Index of the oldest queued event.
+		uint32_t head;
+
+		//! Number of queued events.
+		uint32_t count;
+
+		//! Events dropped because the queue was full, reported with XrEventDataEventsLost.
+		uint32_t lost_count;
+
+		//! Number of events xrPollEvent can deliver, including the lost event.
+		xrt_atomic_s32_t pending;
 	} event;
 
 	//! Interaction profile bindings that have been suggested by the client.
@@ -1779,6 +1864,29 @@ struct oxr_instance
 #endif // XRT_OS_ANDROID
 };
 
+/*!
+ * A relation located by xrLocateSpace, see @ref oxr_session::locate_cache.
+ */
+struct oxr_space_cache_entry
+{
+	const struct oxr_space *space;
+	const struct oxr_space *base_space;
+	XrTime time;
+	struct xrt_space_relation relation;
+};
+
+/*!
+ * Views located by xrLocateViews, see @ref oxr_session::locate_cache.
+ */
+struct oxr_view_cache_entry
+{
+	const struct oxr_space *base_space;
+	XrTime time;
+	XrViewStateFlags view_state_flags;
+	XrPosef poses[XRT_MAX_VIEWS];
+	XrFovf fovs[XRT_MAX_VIEWS];
+};
+
 /*!
  * Object that client program interact with.
  *
@@ -1872,6 +1980,16 @@ struct oxr_session
 	 */
 	struct u_hashmap_int *act_attachments_by_key;
 
+	/*!
+	 * Direct lookup table of action key to action attachment, built when
+	 * the action sets are attached and indexed by the action key minus
+	 * @p act_attachments_key_base. NULL if the keys were too spread out,
+	 * then @ref act_attachments_by_key is used.
+	 */
+	struct oxr_action_attachment **act_attachments_by_index;
+	uint32_t act_attachments_key_base;
+	uint32_t act_attachments_index_count;
+
 	/*!
 	 * Clone of all suggested binding profiles at the point of action set/session attachment.
 	 * @ref oxr_session_attach_action_sets
@@ -1917,6 +2035,34 @@ struct oxr_session
 	 * Used as reference for local space.  */
 	struct xrt_space_relation local_space_pure_relation;
 
+	/*!
+	 * Memo of located spaces and views, engines tend to locate the same
+	 * spaces at the same time from several systems each frame. Cleared on
+	 * xrWaitFrame and xrSyncActions, and when a space is destroyed.
+	 */
+	struct
+	{
+		struct os_mutex mutex;
+
+		//! Can be turned off with OXR_LOCATE_CACHE.
+		bool enabled;
+
+		struct oxr_space_cache_entry spaces[OXR_SESSION_SPACE_CACHE_SIZE];
+		uint32_t space_count;
+		uint32_t space_next;
+
+		struct oxr_view_cache_entry views[OXR_SESSION_VIEW_CACHE_SIZE];
+		uint32_t view_count;
+		uint32_t view_next;
+	} locate_cache;
+
+	/*!
+	 * When the head pose was last sampled by xrLocateViews, passed along
+	 * with the next submitted frame so the compositor can estimate the
+	 * motion-to-photon latency. Protected by the locate_cache mutex.
+	 */
+	int64_t views_sampled_ns;
+
 	bool has_lost;
 };
 
@@ -2040,6 +2186,16 @@ struct oxr_interaction_profile
 	struct oxr_dpad_state dpad_state;
 };
 
+/*!
+ * Components that any of the paths of a @ref oxr_binding ends with, used to
+ * pick a child when an app suggests a parent path like .../trigger.
+ */
+enum oxr_binding_component_flags
+{
+	OXR_BINDING_COMPONENT_CLICK = 1u << 0u,
+	OXR_BINDING_COMPONENT_VALUE = 1u << 1u,
+};
+
 /*!
  * Interaction profile binding state.
  */
@@ -2048,6 +2204,9 @@ struct oxr_binding
 	XrPath *paths;
 	uint32_t path_count;
 
+	//! Bitmask of @ref oxr_binding_component_flags, computed once at profile creation.
+	uint32_t component_flags;
+
 	//! Name presented to the user.
 	const char *localized_name;
 
@@ -2151,6 +2310,9 @@ struct oxr_action_set_attachment
 	//! Which sub-action paths are requested on the latest sync.
 	struct oxr_subaction_paths requested_subaction_paths;
 
+	//! Priority of this action set on the latest sync, including overrides.
+	uint32_t requested_priority;
+
 	//! An array of action attachments we own.
 	struct oxr_action_attachment *act_attachments;
 
@@ -2214,6 +2376,13 @@ struct oxr_action_input
 	struct oxr_input_transform *transforms;
 	size_t transform_count;
 	XrPath bound_path;
+
+	/*!
+	 * Bitmask of indices into @ref oxr_session::act_set_attachments of the
+	 * action sets that also have @ref bound_path bound, rebuilt whenever
+	 * the bindings change. Used to quickly find suppressed inputs.
+	 */
+	uint64_t bound_act_sets_mask;
 };
 
 /*!
@@ -2423,6 +2592,17 @@ struct oxr_swapchain
 		int index;
 	} released;
 
+	/*!
+	 * Last sub-image that passed the bounds checks in xrEndFrame, the size of
+	 * a swapchain never changes so the same sub-image doesn't need them again.
+	 */
+	struct
+	{
+		bool yes;
+		uint32_t image_array_index;
+		XrRect2Di rect;
+	} validated;
+
 	// Is this a static swapchain, needed for acquire semantics.
 	bool is_static;
 
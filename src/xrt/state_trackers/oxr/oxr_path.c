@@ -11,16 +11,22 @@
 #include <string.h>
 #include <stdlib.h>
 
-#include "math/m_api.h"
 #include "util/u_misc.h"
 
 #include "oxr_objects.h"
 #include "oxr_logger.h"
 
 
+//! Initial length of the lookup table, big enough for the paths cached at instance creation.
+#define OXR_PATH_TABLE_INITIAL_LENGTH (1024)
+
+//! Default size of an arena block that paths are allocated from.
+#define OXR_PATH_BLOCK_SIZE (16 * 1024)
+
 /*!
- * Internal representation of a path, item follows this struct in memory and
- * that in turn is followed by the string.
+ * Internal representation of a path, the string directly follows this struct
+ * in memory. Paths are never freed individually, they live in arena blocks
+ * owned by the instance until it is destroyed.
  *
  * @ingroup oxr_main
  */
@@ -29,6 +35,22 @@ struct oxr_path
 	uint64_t debug;
 	XrPath id;
 	void *attached;
+	uint64_t hash;
+	size_t length;
+	char c_str[];
+};
+
+/*!
+ * A block of memory that paths are bump allocated from.
+ *
+ * @ingroup oxr_main
+ */
+struct oxr_path_block
+{
+	struct oxr_path_block *next;
+	size_t used;
+	size_t size;
+	uint8_t data[];
 };
 
 
@@ -44,16 +66,92 @@ to_xr_path(struct oxr_path *path)
 	return path->id;
 }
 
-static inline struct u_hashset_item *
-get_item(struct oxr_path *path)
+/*!
+ * FNV-1a, cheap and doesn't allocate, the table only needs a good spread.
+ */
+static inline uint64_t
+hash_str(const char *str, size_t length)
 {
-	return (struct u_hashset_item *)&path[1];
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (size_t i = 0; i < length; i++) {
+		hash ^= (uint8_t)str[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
 }
 
-static inline struct oxr_path *
-from_item(struct u_hashset_item *item)
+static void *
+arena_alloc(struct oxr_instance *inst, size_t size)
 {
-	return &((struct oxr_path *)item)[-1];
+	// Keep every path aligned for its members.
+	size = (size + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+
+	struct oxr_path_block *block = inst->path_store.blocks;
+	if (block == NULL || block->size - block->used < size) {
+		size_t block_size = size > OXR_PATH_BLOCK_SIZE ? size : OXR_PATH_BLOCK_SIZE;
+
+		block = U_CALLOC_WITH_CAST(struct oxr_path_block, sizeof(struct oxr_path_block) + block_size);
+		if (block == NULL) {
+			return NULL;
+		}
+
+		block->size = block_size;
+		block->next = inst->path_store.blocks;
+		inst->path_store.blocks = block;
+	}
+
+	void *ptr = &block->data[block->used];
+	block->used += size;
+
+	return ptr;
+}
+
+/*!
+ * Returns the slot that either holds the path or is the empty slot where it
+ * should be inserted, the table is never full so this always terminates.
+ */
+static size_t
+find_slot(const struct oxr_instance *inst, const char *str, size_t length, uint64_t hash)
+{
+	const size_t mask = inst->path_store.table_length - 1;
+	size_t index = (size_t)hash & mask;
+
+	while (true) {
+		uint32_t id = inst->path_store.table[index];
+		if (id == XR_NULL_PATH) {
+			return index;
+		}
+
+		const struct oxr_path *path = inst->path_array[id];
+		if (path->hash == hash && path->length == length && memcmp(path->c_str, str, length) == 0) {
+			return index;
+		}
+
+		index = (index + 1) & mask;
+	}
+}
+
+static XrResult
+grow_table(struct oxr_logger *log, struct oxr_instance *inst)
+{
+	size_t new_length = inst->path_store.table_length * 2;
+	uint32_t *new_table = U_TYPED_ARRAY_CALLOC(uint32_t, new_length);
+	if (new_table == NULL) {
+		return oxr_error(log, XR_ERROR_RUNTIME_FAILURE, "Failed to grow path table");
+	}
+
+	free(inst->path_store.table);
+	inst->path_store.table = new_table;
+	inst->path_store.table_length = new_length;
+
+	// Reinsert everything, no paths are ever removed so no tombstones.
+	for (size_t id = 1; id < inst->path_num; id++) {
+		const struct oxr_path *path = inst->path_array[id];
+		size_t slot = find_slot(inst, path->c_str, path->length, path->hash);
+		new_table[slot] = (uint32_t)id;
+	}
+
+	return XR_SUCCESS;
 }
 
 
@@ -87,47 +185,45 @@ oxr_ensure_array_length(struct oxr_logger *log, struct oxr_instance *inst, XrPat
 }
 
 static XrResult
-oxr_allocate_path(
-    struct oxr_logger *log, struct oxr_instance *inst, const char *str, size_t length, struct oxr_path **out_path)
+oxr_allocate_path(struct oxr_logger *log,
+                  struct oxr_instance *inst,
+                  const char *str,
+                  size_t length,
+                  uint64_t hash,
+                  struct oxr_path **out_path)
 {
-	struct u_hashset_item *item = NULL;
 	struct oxr_path *path = NULL;
 	size_t size = 0;
-	int ret;
+	XrResult ret;
 
-	size += sizeof(struct oxr_path);       // Main path object.
-	size += sizeof(struct u_hashset_item); // Embedded hashset item.
-	size += length;                        // String.
-	size += 1;                             // Null terminate it.
+	// Keep the load factor at or below a half, before looking up the slot.
+	if ((inst->path_num + 1) * 2 > inst->path_store.table_length) {
+		ret = grow_table(log, inst);
+		if (ret != XR_SUCCESS) {
+			return ret;
+		}
+	}
 
-	// Now allocate and setup the path.
-	path = U_CALLOC_WITH_CAST(struct oxr_path, size);
+	size += sizeof(struct oxr_path); // Main path object.
+	size += length;                  // String.
+	size += 1;                       // Null terminate it.
+
+	// Now allocate and setup the path, the arena memory is zeroed.
+	path = arena_alloc(inst, size);
 	if (path == NULL) {
 		return oxr_error(log, XR_ERROR_RUNTIME_FAILURE, "Failed to allocate path");
 	}
 	path->debug = OXR_XR_DEBUG_PATH;
+	path->hash = hash;
+	path->length = length;
+	memcpy(path->c_str, str, length);
+	path->c_str[length] = '\0';
 
-	// Setup the item.
-	item = get_item(path);
-	item->hash = math_hash_string(str, length);
-	item->length = length;
-
-	// Yes a const cast! D:
-	char *store = (char *)item->c_str;
-	for (size_t i = 0; i < length; i++) {
-		store[i] = str[i];
-	}
-	store[length] = '\0';
-
-	// Insert and return.
-	ret = u_hashset_insert_item(inst->path_store, item);
-	if (ret) {
-		free(path);
-		return oxr_error(log, XR_ERROR_RUNTIME_FAILURE, "Failed to insert item");
-	}
+	size_t slot = find_slot(inst, str, length, hash);
 
 	oxr_ensure_array_length(log, inst, &path->id);
 	inst->path_array[path->id] = path;
+	inst->path_store.table[slot] = (uint32_t)path->id;
 
 	*out_path = path;
 
@@ -172,20 +268,19 @@ XrResult
 oxr_path_get_or_create(
     struct oxr_logger *log, struct oxr_instance *inst, const char *str, size_t length, XrPath *out_path)
 {
-	struct u_hashset_item *item;
 	struct oxr_path *path = NULL;
 	XrResult ret;
-	int h_ret;
 
 	// Look it up the instance path store.
-	h_ret = u_hashset_find_str(inst->path_store, str, length, &item);
-	if (h_ret == 0) {
-		*out_path = to_xr_path(from_item(item));
+	uint64_t hash = hash_str(str, length);
+	uint32_t id = inst->path_store.table[find_slot(inst, str, length, hash)];
+	if (id != XR_NULL_PATH) {
+		*out_path = id;
 		return XR_SUCCESS;
 	}
 
 	// Create the path since it was not found.
-	ret = oxr_allocate_path(log, inst, str, length, &path);
+	ret = oxr_allocate_path(log, inst, str, length, hash, &path);
 	if (ret != XR_SUCCESS) {
 		return ret;
 	}
@@ -198,17 +293,10 @@ oxr_path_get_or_create(
 XrResult
 oxr_path_only_get(struct oxr_logger *log, struct oxr_instance *inst, const char *str, size_t length, XrPath *out_path)
 {
-	struct u_hashset_item *item;
-	int h_ret;
-
-	// Look it up the instance path store.
-	h_ret = u_hashset_find_str(inst->path_store, str, length, &item);
-	if (h_ret == 0) {
-		*out_path = to_xr_path(from_item(item));
-		return XR_SUCCESS;
-	}
+	// Look it up the instance path store, XR_NULL_PATH if not found.
+	uint64_t hash = hash_str(str, length);
+	*out_path = inst->path_store.table[find_slot(inst, str, length, hash)];
 
-	*out_path = XR_NULL_PATH;
 	return XR_SUCCESS;
 }
 
@@ -221,27 +309,21 @@ oxr_path_get_string(
 		return XR_ERROR_PATH_INVALID;
 	}
 
-	*out_str = get_item(path)->c_str;
-	*out_length = get_item(path)->length;
+	*out_str = path->c_str;
+	*out_length = path->length;
 
 	return XR_SUCCESS;
 }
 
-void
-destroy_callback(struct u_hashset_item *item, void *priv)
-{
-	struct oxr_path *path = from_item(item);
-
-	free(path);
-}
-
 XrResult
 oxr_path_init(struct oxr_logger *log, struct oxr_instance *inst)
 {
-	int h_ret = u_hashset_create(&inst->path_store);
-	if (h_ret != 0) {
-		return oxr_error(log, XR_ERROR_RUNTIME_FAILURE, "Failed to create hashset");
+	inst->path_store.table = U_TYPED_ARRAY_CALLOC(uint32_t, OXR_PATH_TABLE_INITIAL_LENGTH);
+	if (inst->path_store.table == NULL) {
+		return oxr_error(log, XR_ERROR_RUNTIME_FAILURE, "Failed to create path table");
 	}
+	inst->path_store.table_length = OXR_PATH_TABLE_INITIAL_LENGTH;
+	inst->path_store.blocks = NULL;
 
 	size_t new_size = 64;
 	U_ARRAY_REALLOC_OR_FREE(inst->path_array, struct oxr_path *, new_size);
@@ -262,10 +344,14 @@ oxr_path_destroy(struct oxr_logger *log, struct oxr_instance *inst)
 	inst->path_num = 0;
 	inst->path_array_length = 0;
 
-	if (inst->path_store == NULL) {
-		return;
-	}
+	free(inst->path_store.table);
+	inst->path_store.table = NULL;
+	inst->path_store.table_length = 0;
 
-	u_hashset_clear_and_call_for_each(inst->path_store, destroy_callback, inst);
-	u_hashset_destroy(&inst->path_store);
+	// All paths live in the blocks.
+	while (inst->path_store.blocks != NULL) {
+		struct oxr_path_block *block = inst->path_store.blocks;
+		inst->path_store.blocks = block->next;
+		free(block);
+	}
 }
@@ -55,6 +55,7 @@
 DEBUG_GET_ONCE_NUM_OPTION(ipd, "OXR_DEBUG_IPD_MM", 63)
 DEBUG_GET_ONCE_NUM_OPTION(wait_frame_sleep, "OXR_DEBUG_WAIT_FRAME_EXTRA_SLEEP_MS", 0)
 DEBUG_GET_ONCE_BOOL_OPTION(frame_timing_spew, "OXR_FRAME_TIMING_SPEW", false)
+DEBUG_GET_ONCE_BOOL_OPTION(locate_cache, "OXR_LOCATE_CACHE", true)
 DEBUG_GET_ONCE_BOOL_OPTION(hand_tracking_prioritize_conforming, "OXR_HAND_TRACKING_PRIORITIZE_CONFORMING", false)
 
 
@@ -489,9 +490,12 @@ oxr_session_poll(struct oxr_logger *log, struct oxr_session *sess)
 			break;
 		case XRT_SESSION_EVENT_PERFORMANCE_CHANGE:
 #ifdef OXR_HAVE_EXT_performance_settings
-			oxr_event_push_XrEventDataPerfSettingsEXTX(
-			    log, sess, xse.performance.domain, xse.performance.sub_domain, xse.performance.from_level,
-			    xse.performance.to_level);
+			// Sent by the compositor whenever the GPU load changes, only for apps that asked for it.
+			if (sess->sys->inst->extensions.EXT_performance_settings) {
+				oxr_event_push_XrEventDataPerfSettingsEXTX(
+				    log, sess, xse.performance.domain, xse.performance.sub_domain,
+				    xse.performance.from_level, xse.performance.to_level);
+			}
 #endif // OXR_HAVE_EXT_performance_settings
 			break;
 		case XRT_SESSION_EVENT_PASSTHRU_STATE_CHANGE:
@@ -576,6 +580,136 @@ adjust_fov(const struct xrt_fov *original_fov, const struct xrt_quat *original_r
 	};
 }
 
+static bool
+locate_cache_get_views(struct oxr_session *sess,
+                       const struct oxr_space *baseSpc,
+                       XrTime time,
+                       uint32_t view_count,
+                       XrViewState *viewState,
+                       XrView *views)
+{
+	bool found = false;
+
+	if (!sess->locate_cache.enabled) {
+		return false;
+	}
+
+	os_mutex_lock(&sess->locate_cache.mutex);
+	for (uint32_t i = 0; i < sess->locate_cache.view_count; i++) {
+		const struct oxr_view_cache_entry *e = &sess->locate_cache.views[i];
+		if (e->base_space != baseSpc || e->time != time) {
+			continue;
+		}
+
+		for (uint32_t k = 0; k < view_count; k++) {
+			views[k].pose = e->poses[k];
+			views[k].fov = e->fovs[k];
+		}
+		viewState->viewStateFlags = e->view_state_flags;
+		found = true;
+		break;
+	}
+	os_mutex_unlock(&sess->locate_cache.mutex);
+
+	return found;
+}
+
+static void
+locate_cache_put_views(struct oxr_session *sess,
+                       const struct oxr_space *baseSpc,
+                       XrTime time,
+                       uint32_t view_count,
+                       const XrViewState *viewState,
+                       const XrView *views)
+{
+	if (!sess->locate_cache.enabled) {
+		return;
+	}
+
+	os_mutex_lock(&sess->locate_cache.mutex);
+	struct oxr_view_cache_entry *e = &sess->locate_cache.views[sess->locate_cache.view_next];
+	e->base_space = baseSpc;
+	e->time = time;
+	e->view_state_flags = viewState->viewStateFlags;
+	for (uint32_t k = 0; k < view_count; k++) {
+		e->poses[k] = views[k].pose;
+		e->fovs[k] = views[k].fov;
+	}
+
+	// Oldest entry is overwritten once full.
+	sess->locate_cache.view_next = (sess->locate_cache.view_next + 1) % OXR_SESSION_VIEW_CACHE_SIZE;
+	if (sess->locate_cache.view_count < OXR_SESSION_VIEW_CACHE_SIZE) {
+		sess->locate_cache.view_count++;
+	}
+	os_mutex_unlock(&sess->locate_cache.mutex);
+}
+
+bool
+oxr_session_locate_cache_get_space(struct oxr_session *sess,
+                                   const struct oxr_space *spc,
+                                   const struct oxr_space *baseSpc,
+                                   XrTime time,
+                                   struct xrt_space_relation *out_relation)
+{
+	bool found = false;
+
+	if (!sess->locate_cache.enabled) {
+		return false;
+	}
+
+	os_mutex_lock(&sess->locate_cache.mutex);
+	for (uint32_t i = 0; i < sess->locate_cache.space_count; i++) {
+		const struct oxr_space_cache_entry *e = &sess->locate_cache.spaces[i];
+		if (e->space != spc || e->base_space != baseSpc || e->time != time) {
+			continue;
+		}
+
+		*out_relation = e->relation;
+		found = true;
+		break;
+	}
+	os_mutex_unlock(&sess->locate_cache.mutex);
+
+	return found;
+}
+
+void
+oxr_session_locate_cache_put_space(struct oxr_session *sess,
+                                   const struct oxr_space *spc,
+                                   const struct oxr_space *baseSpc,
+                                   XrTime time,
+                                   const struct xrt_space_relation *relation)
+{
+	if (!sess->locate_cache.enabled) {
+		return;
+	}
+
+	os_mutex_lock(&sess->locate_cache.mutex);
+	struct oxr_space_cache_entry *e = &sess->locate_cache.spaces[sess->locate_cache.space_next];
+	e->space = spc;
+	e->base_space = baseSpc;
+	e->time = time;
+	e->relation = *relation;
+
+	// Oldest entry is overwritten once full.
+	sess->locate_cache.space_next = (sess->locate_cache.space_next + 1) % OXR_SESSION_SPACE_CACHE_SIZE;
+	if (sess->locate_cache.space_count < OXR_SESSION_SPACE_CACHE_SIZE) {
+		sess->locate_cache.space_count++;
+	}
+	os_mutex_unlock(&sess->locate_cache.mutex);
+}
+
+void
+oxr_session_locate_cache_invalidate(struct oxr_session *sess)
+{
+	os_mutex_lock(&sess->locate_cache.mutex);
+	sess->locate_cache.space_count = 0;
+	sess->locate_cache.space_next = 0;
+	sess->locate_cache.view_count = 0;
+	sess->locate_cache.view_next = 0;
+	os_mutex_unlock(&sess->locate_cache.mutex);
+}
+
 XrResult
 oxr_session_locate_views(struct oxr_logger *log,
                          struct oxr_session *sess,
@@ -609,6 +743,18 @@ oxr_session_locate_views(struct oxr_logger *log,
 		oxr_pp_space_indented(&slog, baseSpc, "viewLocateInfo->baseSpace");
 	}
 
+	// Already located this frame, same answer as last time.
+	if (locate_cache_get_views(sess, baseSpc, viewLocateInfo->displayTime, view_count, viewState, views)) {
+		if (print) {
+			oxr_slog(&slog, "\n\tReturning cached views");
+			oxr_log_slog(log, &slog);
+		} else {
+			oxr_slog_cancel(&slog);
+		}
+
+		return oxr_session_success_result(sess);
+	}
+
 	/*
 	 * Get head relation, fovs and view poses.
 	 */
@@ -628,6 +774,8 @@ oxr_session_locate_views(struct oxr_logger *log,
 	struct xrt_fov fovs[XRT_MAX_VIEWS] = {0};
 	struct xrt_pose poses[XRT_MAX_VIEWS] = {0};
 
+	int64_t sampled_ns = os_monotonic_get_ns();
+
 	xrt_result_t xret = xrt_device_get_view_poses( //
 	    xdev,                                      //
 	    &default_eye_relation,                     //
@@ -638,6 +786,10 @@ oxr_session_locate_views(struct oxr_logger *log,
 	    poses);
 	OXR_CHECK_XRET(log, sess, xret, xrt_device_get_view_poses);
 
+	os_mutex_lock(&sess->locate_cache.mutex);
+	sess->views_sampled_ns = sampled_ns;
+	os_mutex_unlock(&sess->locate_cache.mutex);
+
 	// The xdev pose in the base space.
 	struct xrt_space_relation T_base_xdev = XRT_SPACE_RELATION_ZERO;
 	XrResult ret = oxr_space_locate_device( //
@@ -740,6 +892,8 @@ oxr_session_locate_views(struct oxr_logger *log,
 		}
 	}
 
+	locate_cache_put_views(sess, baseSpc, viewLocateInfo->displayTime, view_count, viewState, views);
+
 	if (print) {
 		oxr_log_slog(log, &slog);
 	} else {
@@ -877,6 +1031,9 @@ oxr_session_frame_wait(struct oxr_logger *log, struct oxr_session *sess, XrFrame
 	sess->frame_id.waited = frame_id;
 	os_mutex_unlock(&sess->active_wait_frames_lock);
 
+	// New frame, new tracking data.
+	oxr_session_locate_cache_invalidate(sess);
+
 	frameState->shouldRender = should_render(sess->state);
 	frameState->predictedDisplayPeriod = predicted_display_period;
 	frameState->predictedDisplayTime = converted_time;
@@ -959,6 +1116,10 @@ oxr_session_destroy(struct oxr_logger *log, struct oxr_handle_base *hb)
 
 	oxr_session_binding_destroy_all(log, sess);
 
+	free(sess->act_attachments_by_index);
+	sess->act_attachments_by_index = NULL;
+	sess->act_attachments_index_count = 0;
+
 	for (size_t i = 0; i < sess->action_set_attachment_count; ++i) {
 		oxr_action_set_attachment_teardown(&sess->act_set_attachments[i]);
 	}
@@ -980,6 +1141,7 @@ oxr_session_destroy(struct oxr_logger *log, struct oxr_handle_base *hb)
 	os_precise_sleeper_deinit(&sess->sleeper);
 	oxr_frame_sync_fini(&sess->frame_sync);
 	os_mutex_destroy(&sess->active_wait_frames_lock);
+	os_mutex_destroy(&sess->locate_cache.mutex);
 
 	free(sess);
 
@@ -1015,6 +1177,9 @@ oxr_session_allocate_and_init(struct oxr_logger *log,
 	sess->frame_timing_spew = debug_get_bool_option_frame_timing_spew();
 	sess->frame_timing_wait_sleep_ms = debug_get_num_option_wait_frame_sleep();
 
+	os_mutex_init(&sess->locate_cache.mutex);
+	sess->locate_cache.enabled = debug_get_bool_option_locate_cache();
+
 	// Action system hashmaps.
 	u_hashmap_int_create(&sess->act_sets_attachments_by_key);
 	u_hashmap_int_create(&sess->act_attachments_by_key);
@@ -1419,18 +1584,22 @@ oxr_session_hand_joints(struct oxr_logger *log,
 	// We know we are active.
 	locations->isActive = true;
 
+	// Validated to be XR_HAND_JOINT_COUNT_EXT by the API function.
+	assert(locations->jointCount <= XRT_HAND_JOINT_COUNT);
+
+	// Transform all joints into the base space in one go.
+	struct xrt_space_relation results[XRT_HAND_JOINT_COUNT];
+	for (uint32_t i = 0; i < locations->jointCount; i++) {
+		results[i] = value.values.hand_joint_set_default[i].relation;
+	}
+	m_space_relation_apply_array(&T_base_hand, results, results, locations->jointCount);
+
 	for (uint32_t i = 0; i < locations->jointCount; i++) {
 		locations->jointLocations[i].locationFlags =
 		    xrt_to_xr_space_location_flags(value.values.hand_joint_set_default[i].relation.relation_flags);
 		locations->jointLocations[i].radius = value.values.hand_joint_set_default[i].radius;
 
-		struct xrt_space_relation r = value.values.hand_joint_set_default[i].relation;
-
-		struct xrt_space_relation result;
-		struct xrt_relation_chain chain = {0};
-		m_relation_chain_push_relation(&chain, &r);
-		m_relation_chain_push_relation(&chain, &T_base_hand);
-		m_relation_chain_resolve(&chain, &result);
+		struct xrt_space_relation result = results[i];
 
 		xrt_to_xr_pose(&result.pose, &locations->jointLocations[i].pose);
 
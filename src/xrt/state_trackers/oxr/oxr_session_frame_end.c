@@ -1,4 +1,4 @@
-// Copyright 2018-2021, Collabora, Ltd.
+// Copyright 2018-2025, Collabora, Ltd.
 // Copyright 2024-2025, NVIDIA CORPORATION.
 // SPDX-License-Identifier: BSL-1.0
 /*!
@@ -38,6 +38,9 @@
 #include <assert.h>
 
 
+DEBUG_GET_ONCE_BOOL_OPTION(full_layer_validation, "OXR_DEBUG_FULL_LAYER_VALIDATION", false)
+
+
 /*
  *
  * Helper functions and defines.
@@ -84,6 +87,90 @@ is_rect_out_of_bounds(const XrRect2Di *imageRect, struct oxr_swapchain *sc)
 	return false;
 }
 
+static bool
+sub_image_validated_before(const struct oxr_swapchain *sc, const XrSwapchainSubImage *sub_image)
+{
+	if (debug_get_bool_option_full_layer_validation() || !sc->validated.yes) {
+		return false;
+	}
+
+	return sc->validated.image_array_index == sub_image->imageArrayIndex &&       //
+	       sc->validated.rect.offset.x == sub_image->imageRect.offset.x &&         //
+	       sc->validated.rect.offset.y == sub_image->imageRect.offset.y &&         //
+	       sc->validated.rect.extent.width == sub_image->imageRect.extent.width && //
+	       sc->validated.rect.extent.height == sub_image->imageRect.extent.height;
+}
+
+static void
+mark_sub_image_validated(struct oxr_swapchain *sc, const XrSwapchainSubImage *sub_image)
+{
+	sc->validated.yes = true;
+	sc->validated.image_array_index = sub_image->imageArrayIndex;
+	sc->validated.rect = sub_image->imageRect;
+}
+
+/*!
+ * Verifies the parts of a sub-image that only depend on the swapchain, the
+ * per-frame checks like the released image are left to the caller. Swapchain
+ * sizes never change, so a sub-image that has already passed on this swapchain
+ * is not checked again.
+ *
+ * @p view_index is negative for layers without views, it and @p member are only
+ * used to name the sub-image in the error messages.
+ */
+static XrResult
+verify_sub_image_static(struct oxr_logger *log,
+                        struct oxr_swapchain *sc,
+                        const XrSwapchainSubImage *sub_image,
+                        uint32_t layer_index,
+                        int32_t view_index,
+                        const char *member,
+                        const char *layer_type)
+{
+	if (sub_image_validated_before(sc, sub_image)) {
+		return XR_SUCCESS;
+	}
+
+	char path[128];
+	if (view_index < 0) {
+		snprintf(path, sizeof(path), "frameEndInfo->layers[%u]->%s", layer_index, member);
+	} else {
+		snprintf(path, sizeof(path), "frameEndInfo->layers[%u]->views[%i]->%s", layer_index, view_index,
+		         member);
+	}
+
+	const XrRect2Di *rect = &sub_image->imageRect;
+
+	if (sc->array_layer_count <= sub_image->imageArrayIndex) {
+		return oxr_error(log, XR_ERROR_VALIDATION_FAILURE,
+		                 "(%s.imageArrayIndex == %u) Invalid swapchain array index for %s layer (%u).", path,
+		                 sub_image->imageArrayIndex, layer_type, sc->array_layer_count);
+	}
+
+	if (sc->face_count != 1) {
+		return oxr_error(log, XR_ERROR_VALIDATION_FAILURE,
+		                 "(%s.swapchain) Invalid swapchain face count (expected 1, got %u)", path,
+		                 sc->face_count);
+	}
+
+	if (is_rect_neg(rect)) {
+		return oxr_error(log, XR_ERROR_SWAPCHAIN_RECT_INVALID,
+		                 "(%s.imageRect.offset == {%i, %i}) has negative component(s)", path, rect->offset.x,
+		                 rect->offset.y);
+	}
+
+	if (is_rect_out_of_bounds(rect, sc)) {
+		return oxr_error(log, XR_ERROR_SWAPCHAIN_RECT_INVALID,
+		                 "(%s.imageRect == {{%i, %i}, {%u, %u}}) imageRect out of image bounds (%u, %u)", path,
+		                 rect->offset.x, rect->offset.y, rect->extent.width, rect->extent.height, sc->width,
+		                 sc->height);
+	}
+
+	mark_sub_image_validated(sc, sub_image);
+
+	return XR_SUCCESS;
+}
+
 static enum xrt_blend_mode
 convert_blend_mode(XrEnvironmentBlendMode blend_mode)
 {
@@ -436,18 +523,9 @@ verify_quad_layer(struct oxr_session *sess,
 		                 p->x, p->y, p->z);
 	}
 
-	if (sc->array_layer_count <= quad->subImage.imageArrayIndex) {
-		return oxr_error(log, XR_ERROR_VALIDATION_FAILURE,
-		                 "(frameEndInfo->layers[%u]->subImage.imageArrayIndex == %u) Invalid swapchain array "
-		                 "index for quad layer (%u).",
-		                 layer_index, quad->subImage.imageArrayIndex, sc->array_layer_count);
-	}
-
-	if (sc->face_count != 1) {
-		return oxr_error(log, XR_ERROR_VALIDATION_FAILURE,
-		                 "(frameEndInfo->layers[%u]->subImage.swapchain) Invalid swapchain face count "
-		                 "(expected 1, got %u)",
-		                 layer_index, sc->face_count);
+	ret = verify_sub_image_static(log, sc, &quad->subImage, layer_index, -1, "subImage", "quad");
+	if (ret != XR_SUCCESS) {
+		return ret;
 	}
 
 	if (!sc->released.yes) {
@@ -462,22 +540,6 @@ verify_quad_layer(struct oxr_session *sess,
 		                 layer_index);
 	}
 
-	if (is_rect_neg(&quad->subImage.imageRect)) {
-		return oxr_error(
-		    log, XR_ERROR_SWAPCHAIN_RECT_INVALID,
-		    "(frameEndInfo->layers[%u]->subImage.imageRect.offset == {%i, %i}) has negative component(s)",
-		    layer_index, quad->subImage.imageRect.offset.x, quad->subImage.imageRect.offset.y);
-	}
-
-	if (is_rect_out_of_bounds(&quad->subImage.imageRect, sc)) {
-		return oxr_error(log, XR_ERROR_SWAPCHAIN_RECT_INVALID,
-		                 "(frameEndInfo->layers[%u]->subImage.imageRect == {{%i, %i}, {%u, %u}}) imageRect out "
-		                 "of image bounds (%u, %u)",
-		                 layer_index, quad->subImage.imageRect.offset.x, quad->subImage.imageRect.offset.y,
-		                 quad->subImage.imageRect.extent.width, quad->subImage.imageRect.extent.height,
-		                 sc->width, sc->height);
-	}
-
 	return XR_SUCCESS;
 }
 
@@ -512,35 +574,10 @@ verify_depth_layer(struct xrt_compositor *xc,
 		                 layer_index, i);
 	}
 
-	if (sc->array_layer_count <= depth->subImage.imageArrayIndex) {
-		return oxr_error(log, XR_ERROR_VALIDATION_FAILURE,
-		                 "(frameEndInfo->layers[%u]->views[%i]->next<XrCompositionLayerDepthInfoKHR>.subImage."
-		                 "imageArrayIndex == %u) Invalid swapchain array index for projection layer (%u).",
-		                 layer_index, i, depth->subImage.imageArrayIndex, sc->array_layer_count);
-	}
-
-	if (sc->face_count != 1) {
-		return oxr_error(log, XR_ERROR_VALIDATION_FAILURE,
-		                 "(frameEndInfo->layers[%u]->subImage.swapchain) Invalid swapchain face count "
-		                 "(expected 1, got %u)",
-		                 layer_index, sc->face_count);
-	}
-
-	if (is_rect_neg(&depth->subImage.imageRect)) {
-		return oxr_error(log, XR_ERROR_SWAPCHAIN_RECT_INVALID,
-		                 "(frameEndInfo->layers[%u]->views[%i]->next<XrCompositionLayerDepthInfoKHR>.subImage."
-		                 "imageRect.offset == {%i, %i}) has negative component(s)",
-		                 layer_index, i, depth->subImage.imageRect.offset.x,
-		                 depth->subImage.imageRect.offset.y);
-	}
-
-	if (is_rect_out_of_bounds(&depth->subImage.imageRect, sc)) {
-		return oxr_error(log, XR_ERROR_SWAPCHAIN_RECT_INVALID,
-		                 "(frameEndInfo->layers[%u]->views[%i]->next<XrCompositionLayerDepthInfoKHR>.subImage."
-		                 "imageRect == {{%i, %i}, {%u, %u}}) imageRect out of image bounds (%u, %u)",
-		                 layer_index, i, depth->subImage.imageRect.offset.x, depth->subImage.imageRect.offset.y,
-		                 depth->subImage.imageRect.extent.width, depth->subImage.imageRect.extent.height,
-		                 sc->width, sc->height);
+	XrResult ret = verify_sub_image_static(log, sc, &depth->subImage, layer_index, (int32_t)i,
+	                                       "next<XrCompositionLayerDepthInfoKHR>.subImage", "projection");
+	if (ret != XR_SUCCESS) {
+		return ret;
 	}
 
 	if (depth->minDepth < 0.0f || depth->minDepth > 1.0f) {
@@ -571,7 +608,6 @@ verify_depth_layer(struct xrt_compositor *xc,
 		                 layer_index, i, depth->nearZ, depth->farZ);
 	}
 
-
 	return XR_SUCCESS;
 }
 #endif // OXR_HAVE_KHR_composition_layer_depth
@@ -684,38 +720,10 @@ verify_projection_layer(struct oxr_session *sess,
 			                 layer_index, i);
 		}
 
-		if (sc->array_layer_count <= view->subImage.imageArrayIndex) {
-			return oxr_error(log, XR_ERROR_VALIDATION_FAILURE,
-			                 "(frameEndInfo->layers[%u]->views[%i]->subImage."
-			                 "imageArrayIndex == %u) Invalid swapchain array "
-			                 "index for projection layer (%u).",
-			                 layer_index, i, view->subImage.imageArrayIndex, sc->array_layer_count);
-		}
-
-		if (sc->face_count != 1) {
-			return oxr_error(log, XR_ERROR_VALIDATION_FAILURE,
-			                 "(frameEndInfo->layers[%u]->views[%i]->subImage.swapchain) Invalid swapchain "
-			                 "face count (expected 1, got %u)",
-			                 layer_index, i, sc->face_count);
-		}
-
-		if (is_rect_neg(&view->subImage.imageRect)) {
-			return oxr_error(log, XR_ERROR_SWAPCHAIN_RECT_INVALID,
-			                 "(frameEndInfo->layers[%u]->views[%i]-"
-			                 ">subImage.imageRect.offset == {%i, "
-			                 "%i}) has negative component(s)",
-			                 layer_index, i, view->subImage.imageRect.offset.x,
-			                 view->subImage.imageRect.offset.y);
-		}
-
-		if (is_rect_out_of_bounds(&view->subImage.imageRect, sc)) {
-			return oxr_error(log, XR_ERROR_SWAPCHAIN_RECT_INVALID,
-			                 "(frameEndInfo->layers[%u]->views[%i]->subImage."
-			                 "imageRect == {{%i, %i}, {%u, %u}}) imageRect out "
-			                 "of image bounds (%u, %u)",
-			                 layer_index, i, view->subImage.imageRect.offset.x,
-			                 view->subImage.imageRect.offset.y, view->subImage.imageRect.extent.width,
-			                 view->subImage.imageRect.extent.height, sc->width, sc->height);
+		ret = verify_sub_image_static(log, sc, &view->subImage, layer_index, (int32_t)i, "subImage",
+		                              "projection");
+		if (ret != XR_SUCCESS) {
+			return ret;
 		}
 
 #ifdef OXR_HAVE_KHR_composition_layer_depth
@@ -858,18 +866,9 @@ verify_cylinder_layer(struct oxr_session *sess,
 		                 p->x, p->y, p->z);
 	}
 
-	if (sc->array_layer_count <= cylinder->subImage.imageArrayIndex) {
-		return oxr_error(log, XR_ERROR_VALIDATION_FAILURE,
-		                 "(frameEndInfo->layers[%u]->subImage.imageArrayIndex == %u) Invalid swapchain array "
-		                 "index for cylinder layer (%u).",
-		                 layer_index, cylinder->subImage.imageArrayIndex, sc->array_layer_count);
-	}
-
-	if (sc->face_count != 1) {
-		return oxr_error(log, XR_ERROR_VALIDATION_FAILURE,
-		                 "(frameEndInfo->layers[%u]->subImage.swapchain) Invalid swapchain face count "
-		                 "(expected 1, got %u)",
-		                 layer_index, sc->face_count);
+	ret = verify_sub_image_static(log, sc, &cylinder->subImage, layer_index, -1, "subImage", "cylinder");
+	if (ret != XR_SUCCESS) {
+		return ret;
 	}
 
 	if (!sc->released.yes) {
@@ -884,22 +883,6 @@ verify_cylinder_layer(struct oxr_session *sess,
 		                 layer_index);
 	}
 
-	if (is_rect_neg(&cylinder->subImage.imageRect)) {
-		return oxr_error(
-		    log, XR_ERROR_SWAPCHAIN_RECT_INVALID,
-		    "(frameEndInfo->layers[%u]->subImage.imageRect.offset == {%i, %i}) has negative component(s)",
-		    layer_index, cylinder->subImage.imageRect.offset.x, cylinder->subImage.imageRect.offset.y);
-	}
-
-	if (is_rect_out_of_bounds(&cylinder->subImage.imageRect, sc)) {
-		return oxr_error(log, XR_ERROR_SWAPCHAIN_RECT_INVALID,
-		                 "(frameEndInfo->layers[%u]->subImage.imageRect == {{%i, %i}, {%u, %u}}) imageRect out "
-		                 "of image bounds (%u, %u)",
-		                 layer_index, cylinder->subImage.imageRect.offset.x,
-		                 cylinder->subImage.imageRect.offset.y, cylinder->subImage.imageRect.extent.width,
-		                 cylinder->subImage.imageRect.extent.height, sc->width, sc->height);
-	}
-
 	if (cylinder->radius < 0.f) {
 		return oxr_error(log, XR_ERROR_VALIDATION_FAILURE,
 		                 "(frameEndInfo->layers[%u]->radius == %f) radius cannot be negative", layer_index,
@@ -968,18 +951,9 @@ verify_equirect1_layer(struct oxr_session *sess,
 		                 p->x, p->y, p->z);
 	}
 
-	if (sc->array_layer_count <= equirect->subImage.imageArrayIndex) {
-		return oxr_error(log, XR_ERROR_VALIDATION_FAILURE,
-		                 "(frameEndInfo->layers[%u]->subImage.imageArrayIndex == %u) Invalid swapchain array "
-		                 "index for equirect layer (%u).",
-		                 layer_index, equirect->subImage.imageArrayIndex, sc->array_layer_count);
-	}
-
-	if (sc->face_count != 1) {
-		return oxr_error(log, XR_ERROR_VALIDATION_FAILURE,
-		                 "(frameEndInfo->layers[%u]->subImage.swapchain) Invalid swapchain face count "
-		                 "(expected 1, got %u)",
-		                 layer_index, sc->face_count);
+	ret = verify_sub_image_static(log, sc, &equirect->subImage, layer_index, -1, "subImage", "equirect");
+	if (ret != XR_SUCCESS) {
+		return ret;
 	}
 
 	if (!sc->released.yes) {
@@ -994,22 +968,6 @@ verify_equirect1_layer(struct oxr_session *sess,
 		                 layer_index);
 	}
 
-	if (is_rect_neg(&equirect->subImage.imageRect)) {
-		return oxr_error(
-		    log, XR_ERROR_SWAPCHAIN_RECT_INVALID,
-		    "(frameEndInfo->layers[%u]->subImage.imageRect.offset == {%i, %i}) has negative component(s)",
-		    layer_index, equirect->subImage.imageRect.offset.x, equirect->subImage.imageRect.offset.y);
-	}
-
-	if (is_rect_out_of_bounds(&equirect->subImage.imageRect, sc)) {
-		return oxr_error(log, XR_ERROR_SWAPCHAIN_RECT_INVALID,
-		                 "(frameEndInfo->layers[%u]->subImage.imageRect == {{%i, %i}, {%u, %u}}) imageRect out "
-		                 "of image bounds (%u, %u)",
-		                 layer_index, equirect->subImage.imageRect.offset.x,
-		                 equirect->subImage.imageRect.offset.y, equirect->subImage.imageRect.extent.width,
-		                 equirect->subImage.imageRect.extent.height, sc->width, sc->height);
-	}
-
 	if (equirect->radius < .0f) {
 		return oxr_error(log, XR_ERROR_VALIDATION_FAILURE,
 		                 "(frameEndInfo->layers[%u]->radius == %f) radius out of bounds", layer_index,
@@ -1065,18 +1023,9 @@ verify_equirect2_layer(struct oxr_session *sess,
 		                 p->x, p->y, p->z);
 	}
 
-	if (sc->array_layer_count <= equirect->subImage.imageArrayIndex) {
-		return oxr_error(log, XR_ERROR_VALIDATION_FAILURE,
-		                 "(frameEndInfo->layers[%u]->subImage.imageArrayIndex == %u) Invalid swapchain array "
-		                 "index for equirect layer (%u).",
-		                 layer_index, equirect->subImage.imageArrayIndex, sc->array_layer_count);
-	}
-
-	if (sc->face_count != 1) {
-		return oxr_error(log, XR_ERROR_VALIDATION_FAILURE,
-		                 "(frameEndInfo->layers[%u]->subImage.swapchain) Invalid swapchain face count "
-		                 "(expected 1, got %u)",
-		                 layer_index, sc->face_count);
+	ret = verify_sub_image_static(log, sc, &equirect->subImage, layer_index, -1, "subImage", "equirect");
+	if (ret != XR_SUCCESS) {
+		return ret;
 	}
 
 	if (!sc->released.yes) {
@@ -1091,22 +1040,6 @@ verify_equirect2_layer(struct oxr_session *sess,
 		                 layer_index);
 	}
 
-	if (is_rect_neg(&equirect->subImage.imageRect)) {
-		return oxr_error(
-		    log, XR_ERROR_SWAPCHAIN_RECT_INVALID,
-		    "(frameEndInfo->layers[%u]->subImage.imageRect.offset == {%i, %i}) has negative component(s)",
-		    layer_index, equirect->subImage.imageRect.offset.x, equirect->subImage.imageRect.offset.y);
-	}
-
-	if (is_rect_out_of_bounds(&equirect->subImage.imageRect, sc)) {
-		return oxr_error(log, XR_ERROR_SWAPCHAIN_RECT_INVALID,
-		                 "(frameEndInfo->layers[%u]->subImage.imageRect == {{%i, %i}, {%u, %u}}) imageRect out "
-		                 "of image bounds (%u, %u)",
-		                 layer_index, equirect->subImage.imageRect.offset.x,
-		                 equirect->subImage.imageRect.offset.y, equirect->subImage.imageRect.extent.width,
-		                 equirect->subImage.imageRect.extent.height, sc->width, sc->height);
-	}
-
 	if (equirect->centralHorizontalAngle < .0f) {
 		return oxr_error(
 		    log, XR_ERROR_VALIDATION_FAILURE,
@@ -1795,9 +1728,16 @@ oxr_session_frame_end(struct oxr_logger *log, struct oxr_session *sess, const Xr
 	struct xrt_pose inv_offset = {0};
 	math_pose_invert(&xdev->tracking_origin->initial_offset, &inv_offset);
 
+	// Each sample is only used by one frame, a frame that didn't locate any views gets no latency estimate.
+	os_mutex_lock(&sess->locate_cache.mutex);
+	int64_t pose_sample_time_ns = sess->views_sampled_ns;
+	sess->views_sampled_ns = 0;
+	os_mutex_unlock(&sess->locate_cache.mutex);
+
 	struct xrt_layer_frame_data data = {
 	    .frame_id = sess->frame_id.begun,
 	    .display_time_ns = xrt_display_time_ns,
+	    .pose_sample_time_ns = pose_sample_time_ns,
 	    .env_blend_mode = blend_mode,
 	};
 
@@ -128,6 +128,9 @@ oxr_space_destroy(struct oxr_logger *log, struct oxr_handle_base *hb)
 {
 	struct oxr_space *spc = (struct oxr_space *)hb;
 
+	// A new space might get the same address.
+	oxr_session_locate_cache_invalidate(spc->sess);
+
 	// Unreference the reference space.
 	enum xrt_reference_space_type xtype = oxr_ref_space_to_xrt(spc->space_type);
 	if (xtype != XRT_SPACE_REFERENCE_TYPE_INVALID) {
@@ -342,7 +345,29 @@ oxr_spaces_locate(struct oxr_logger *log,
 	// Only fill this out if the above succeeded. Zero initialized means relation flags == 0.
 	struct xrt_space_relation *results = U_TYPED_ARRAY_CALLOC(struct xrt_space_relation, spc_count);
 
+	/*
+	 * Spaces already located this frame are taken from the session cache,
+	 * the rest are packed to the front of the arrays for a single call.
+	 */
+	uint32_t *miss_indices = U_TYPED_ARRAY_CALLOC(uint32_t, spc_count);
+	struct xrt_space_relation *miss_results = U_TYPED_ARRAY_CALLOC(struct xrt_space_relation, spc_count);
+	uint32_t miss_count = 0;
+
 	if (ret == XR_SUCCESS) {
+		for (uint32_t i = 0; i < spc_count; i++) {
+			if (xspcs[i] != NULL &&
+			    oxr_session_locate_cache_get_space(baseSpc->sess, spcs[i], baseSpc, time, &results[i])) {
+				continue;
+			}
+
+			xspcs[miss_count] = xspcs[i];
+			offsets[miss_count] = offsets[i];
+			miss_indices[miss_count] = i;
+			miss_count++;
+		}
+	}
+
+	if (ret == XR_SUCCESS && miss_count > 0) {
 		// Convert at_time to monotonic and give to device.
 		uint64_t at_timestamp_ns = time_state_ts_to_monotonic_ns(sys->inst->timekeeping, time);
 
@@ -353,10 +378,20 @@ oxr_spaces_locate(struct oxr_logger *log,
 		    &baseSpc->pose,                                      //
 		    at_timestamp_ns,                                     //
 		    xspcs,                                               //
-		    spc_count,                                           //
+		    miss_count,                                          //
 		    offsets,                                             //
-		    results);                                            //
-		if (xret != XRT_SUCCESS) {
+		    miss_results);                                       //
+		if (xret == XRT_SUCCESS) {
+			for (uint32_t k = 0; k < miss_count; k++) {
+				uint32_t i = miss_indices[k];
+				results[i] = miss_results[k];
+
+				// Inactive action spaces are not cached, same as xrLocateSpace.
+				if (xspcs[k] != NULL) {
+					oxr_session_locate_cache_put_space(baseSpc->sess, spcs[i], baseSpc, time, &results[i]);
+				}
+			}
+		} else {
 			//! @todo  results locationFlags should still be 0. But should this hard fail? goto "Print"?
 			oxr_warn(log, "Failed to locate spaces (%d)", xret);
 
@@ -434,6 +469,8 @@ oxr_spaces_locate(struct oxr_logger *log,
 		oxr_slog_cancel(&slog);
 	}
 
+	free(miss_indices);
+	free(miss_results);
 	free_spaces(&xspcs, &offsets, &results);
 
 	if (ret != XR_SUCCESS) {
@@ -481,7 +518,13 @@ oxr_space_locate(
 
 	// Only fill this out if the above succeeded.
 	struct xrt_space_relation result = XRT_SPACE_RELATION_ZERO;
+	bool cached = false;
 	if (xtarget != NULL && xbase != NULL) {
+		// Already located this frame?
+		cached = oxr_session_locate_cache_get_space(spc->sess, spc, baseSpc, time, &result);
+	}
+
+	if (xtarget != NULL && xbase != NULL && !cached) {
 		// Convert at_time to monotonic and give to device.
 		uint64_t at_timestamp_ns = time_state_ts_to_monotonic_ns(sys->inst->timekeeping, time);
 
@@ -494,6 +537,8 @@ oxr_space_locate(
 		    xtarget,                     //
 		    &spc->pose,                  //
 		    &result);                    //
+
+		oxr_session_locate_cache_put_space(spc->sess, spc, baseSpc, time, &result);
 	}
 
 
@@ -18,6 +18,7 @@
 #include "util/u_debug.h"
 #include "util/u_pretty_print.h"
 #include "util/u_trace_marker.h"
+#include "util/u_worker.h"
 
 #include "os/os_hid.h"
 #include "p_prober.h"
@@ -57,6 +58,8 @@ DEBUG_GET_ONCE_BOOL_OPTION(qwerty_combine, "QWERTY_COMBINE", false)
 DEBUG_GET_ONCE_OPTION(vf_path, "VF_PATH", NULL)
 DEBUG_GET_ONCE_OPTION(euroc_path, "EUROC_PATH", NULL)
 DEBUG_GET_ONCE_NUM_OPTION(rs_source_index, "RS_SOURCE_INDEX", -1)
+DEBUG_GET_ONCE_BOOL_OPTION(parallel_estimate, "PROBER_PARALLEL_ESTIMATE", false)
+DEBUG_GET_ONCE_BOOL_OPTION(always_rescan, "PROBER_ALWAYS_RESCAN", false)
 
 
 /*
@@ -455,6 +458,8 @@ initialize(struct prober *p, struct xrt_prober_entry_lists *lists)
 	p->json.file_loaded = false;
 	p->json.root = NULL;
 
+	os_mutex_init(&p->list_lock);
+
 	u_var_add_root((void *)p, "Prober", true);
 	u_var_add_log_level(p, &p->log_level, "Log level");
 
@@ -484,6 +489,14 @@ initialize(struct prober *p, struct xrt_prober_entry_lists *lists)
 	}
 #endif
 
+#ifdef XRT_HAVE_LIBUDEV
+	ret = p_udev_init(p);
+	if (ret != 0) {
+		teardown(p);
+		return -1;
+	}
+#endif
+
 	ret = p_tracking_init(p);
 	if (ret != 0) {
 		teardown(p);
@@ -617,6 +630,10 @@ teardown(struct prober *p)
 	p_libuvc_teardown(p);
 #endif
 
+#ifdef XRT_HAVE_LIBUDEV
+	p_udev_teardown(p);
+#endif
+
 #ifdef XRT_HAVE_LIBUSB
 	p_libusb_teardown(p);
 #endif
@@ -624,6 +641,8 @@ teardown(struct prober *p)
 	u_config_json_close(&p->json);
 
 	free(p->disabled_drivers);
+
+	os_mutex_destroy(&p->list_lock);
 }
 
 static void
@@ -880,6 +899,85 @@ print_system_devices(u_pp_delegate_t dg, struct xrt_system_devices *xsysd)
 #undef GET_XDEV
 }
 
+/*!
+ * Estimate results for all builders, filled in lazily when estimating
+ * sequentially or all at once when estimating in parallel.
+ */
+struct builder_estimates
+{
+	struct prober *p;
+	struct xrt_builder_estimate *estimates;
+	bool *done;
+};
+
+struct builder_estimate_task
+{
+	struct builder_estimates *be;
+	size_t index;
+};
+
+static void
+estimate_builder(struct builder_estimates *be, size_t index)
+{
+	struct prober *p = be->p;
+
+	be->estimates[index] = (struct xrt_builder_estimate){0};
+	xrt_builder_estimate_system(p->builders[index], p->json.root, &p->base, &be->estimates[index]);
+	be->done[index] = true;
+}
+
+static void
+estimate_builder_task(void *ptr)
+{
+	struct builder_estimate_task *task = (struct builder_estimate_task *)ptr;
+
+	estimate_builder(task->be, task->index);
+}
+
+/*!
+ * Run the estimate of every builder that takes part in automatic discovery
+ * on a worker pool, many of them do blocking I/O to read out config data.
+ * The results are stored per builder so selection order is unchanged.
+ */
+static void
+estimate_all_builders_parallel(struct builder_estimates *be)
+{
+	XRT_TRACE_MARKER();
+
+	struct prober *p = be->p;
+	struct builder_estimate_task *tasks = U_TYPED_ARRAY_CALLOC(struct builder_estimate_task, p->builder_count);
+
+	uint32_t thread_count = p->builder_count < 8 ? (uint32_t)p->builder_count : 8;
+	struct u_worker_thread_pool *pool = u_worker_thread_pool_create(thread_count, thread_count, "Prober");
+	struct u_worker_group *group = u_worker_group_create(pool);
+
+	for (size_t i = 0; i < p->builder_count; i++) {
+		if (p->builders[i]->exclude_from_automatic_discovery) {
+			continue;
+		}
+
+		tasks[i].be = be;
+		tasks[i].index = i;
+		u_worker_group_push(group, estimate_builder_task, &tasks[i]);
+	}
+
+	u_worker_group_wait_all(group);
+	u_worker_group_reference(&group, NULL);
+	u_worker_thread_pool_reference(&pool, NULL);
+
+	free(tasks);
+}
+
+static const struct xrt_builder_estimate *
+get_builder_estimate(struct builder_estimates *be, size_t index)
+{
+	if (!be->done[index]) {
+		estimate_builder(be, index);
+	}
+
+	return &be->estimates[index];
+}
+
 
 /*
  *
@@ -895,12 +993,31 @@ p_probe(struct xrt_prober *xp)
 	struct prober *p = (struct prober *)xp;
 	XRT_MAYBE_UNUSED int ret = 0;
 
-	if (p->list_locked) {
+	os_mutex_lock(&p->list_lock);
+	uint32_t list_lock_count = p->list_lock_count;
+	os_mutex_unlock(&p->list_lock);
+
+	if (list_lock_count != 0) {
 		return XRT_ERROR_PROBER_LIST_LOCKED;
 	}
 
+#ifdef XRT_HAVE_LIBUDEV
+	/*
+	 * Builders probe again after turning on devices, and reconnecting
+	 * controllers trigger probes too. Re-enumerating everything is slow,
+	 * so keep the list, and the pointers into it, when nothing changed.
+	 */
+	// Always drain the events, they are covered by the enumeration below.
+	bool changed = p_udev_has_changes(p);
+	if (p->probed && !changed && !debug_get_bool_option_always_rescan()) {
+		P_DEBUG(p, "No devices added or removed, keeping device list");
+		return XRT_SUCCESS;
+	}
+#endif
+
 	// Free old list first.
 	teardown_devices(p);
+	p->probed = false;
 
 #ifdef XRT_HAVE_LIBUDEV
 	ret = p_udev_probe(p);
@@ -926,6 +1043,8 @@ p_probe(struct xrt_prober *xp)
 	}
 #endif
 
+	p->probed = true;
+
 	return XRT_SUCCESS;
 }
 
@@ -934,10 +1053,6 @@ p_lock_list(struct xrt_prober *xp, struct xrt_prober_device ***out_devices, size
 {
 	struct prober *p = (struct prober *)xp;
 
-	if (p->list_locked) {
-		return XRT_ERROR_PROBER_LIST_LOCKED;
-	}
-
 	assert(out_devices != NULL);
 	assert(*out_devices == NULL);
 
@@ -947,7 +1062,9 @@ p_lock_list(struct xrt_prober *xp, struct xrt_prober_device ***out_devices, size
 		dev_list[i] = &p->devices[i].base;
 	}
 
-	p->list_locked = true;
+	os_mutex_lock(&p->list_lock);
+	p->list_lock_count++;
+	os_mutex_unlock(&p->list_lock);
 
 	*out_devices = dev_list;
 	*out_device_count = p->device_count;
@@ -960,13 +1077,16 @@ p_unlock_list(struct xrt_prober *xp, struct xrt_prober_device ***devices)
 {
 	struct prober *p = (struct prober *)xp;
 
-	if (!p->list_locked) {
+	os_mutex_lock(&p->list_lock);
+	if (p->list_lock_count == 0) {
+		os_mutex_unlock(&p->list_lock);
 		return XRT_ERROR_PROBER_LIST_NOT_LOCKED;
 	}
+	p->list_lock_count--;
+	os_mutex_unlock(&p->list_lock);
 
 	assert(devices != NULL);
 
-	p->list_locked = false;
 	free(*devices);
 	*devices = NULL;
 
@@ -1039,6 +1159,16 @@ p_create_system(struct xrt_prober *xp,
 	 * Estimate.
 	 */
 
+	struct builder_estimates be = {
+	    .p = p,
+	    .estimates = U_TYPED_ARRAY_CALLOC(struct xrt_builder_estimate, p->builder_count),
+	    .done = U_TYPED_ARRAY_CALLOC(bool, p->builder_count),
+	};
+
+	if (select == NULL && debug_get_bool_option_parallel_estimate()) {
+		estimate_all_builders_parallel(&be);
+	}
+
 	//! @todo Improve estimation selection logic.
 	if (select == NULL) {
 		for (size_t i = 0; i < p->builder_count; i++) {
@@ -1048,10 +1178,9 @@ p_create_system(struct xrt_prober *xp,
 				continue;
 			}
 
-			struct xrt_builder_estimate estimate = {0};
-			xrt_builder_estimate_system(xb, p->json.root, xp, &estimate);
+			const struct xrt_builder_estimate *estimate = get_builder_estimate(&be, i);
 
-			if (estimate.certain.head) {
+			if (estimate->certain.head) {
 				select = xb;
 				break;
 			}
@@ -1072,10 +1201,10 @@ p_create_system(struct xrt_prober *xp,
 				continue;
 			}
 
-			struct xrt_builder_estimate estimate = {0};
-			xrt_builder_estimate_system(xb, p->json.root, xp, &estimate);
+			// Already estimated by the loop above, no need to do the probing again.
+			const struct xrt_builder_estimate *estimate = get_builder_estimate(&be, i);
 
-			if (estimate.maybe.head) {
+			if (estimate->maybe.head) {
 				select = xb;
 				break;
 			}
@@ -1088,6 +1217,9 @@ p_create_system(struct xrt_prober *xp,
 		}
 	}
 
+	free(be.estimates);
+	free(be.done);
+
 	if (select != NULL) {
 		u_pp(dg, "\n\tUsing builder %s: %s", select->identifier, select->name);
 		xret = xrt_builder_open_system( //
@@ -18,6 +18,8 @@
 #include "util/u_logging.h"
 #include "util/u_config_json.h"
 
+#include "os/os_threading.h"
+
 #ifdef XRT_HAVE_LIBUSB
 #include <libusb.h>
 #endif
@@ -26,6 +28,11 @@
 #include <libuvc/libuvc.h>
 #endif
 
+#ifdef XRT_HAVE_LIBUDEV
+struct udev;
+struct udev_monitor;
+#endif
+
 #ifndef __KERNEL__
 #include <sys/types.h>
 #endif
@@ -139,9 +146,16 @@ struct prober
 	size_t builder_count;
 
 	/*!
-	 * Has the list been locked.
+	 * Protects @ref list_lock_count, the builders may lock the list from
+	 * multiple threads at the same time when estimating in parallel.
 	 */
-	bool list_locked;
+	struct os_mutex list_lock;
+
+	/*!
+	 * How many times the list is currently locked, the devices can not be
+	 * re-probed while this is not zero.
+	 */
+	uint32_t list_lock_count;
 
 #ifdef XRT_HAVE_LIBUSB
 	struct
@@ -152,6 +166,16 @@ struct prober
 	} usb;
 #endif
 
+#ifdef XRT_HAVE_LIBUDEV
+	struct
+	{
+		struct udev *udev;
+
+		//! Tells us if any device was added or removed since the last probe.
+		struct udev_monitor *monitor;
+	} udev;
+#endif
+
 #ifdef XRT_HAVE_LIBUVC
 	struct
 	{
@@ -167,6 +191,12 @@ struct prober
 	size_t device_count;
 	struct prober_device *devices;
 
+	/*!
+	 * Has the device list been fully enumerated, used to skip re-enumerating
+	 * when no devices have been added or removed.
+	 */
+	bool probed;
+
 	size_t num_entries;
 	struct xrt_prober_entry **entries;
 
@@ -321,6 +351,28 @@ p_libuvc_probe(struct prober *p);
  * @name udev
  * @{
  */
+/*!
+ * @private @memberof prober
+ */
+int
+p_udev_init(struct prober *p);
+
+/*!
+ * @private @memberof prober
+ */
+void
+p_udev_teardown(struct prober *p);
+
+/*!
+ * Drains all pending hotplug events, returns true if any device was added,
+ * removed or changed since the last call, or if hotplug monitoring is not
+ * available.
+ *
+ * @private @memberof prober
+ */
+bool
+p_udev_has_changes(struct prober *p);
+
 /*!
  * @private @memberof prober
  */
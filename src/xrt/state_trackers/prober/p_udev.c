@@ -1,4 +1,4 @@
-// Copyright 2019, Collabora, Ltd.
+// Copyright 2019-2024, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -118,22 +118,84 @@ p_udev_dump_device(struct udev_device *udev_dev, const char *name);
  */
 
 int
-p_udev_probe(struct prober *p)
+p_udev_init(struct prober *p)
 {
-	struct udev *udev = udev_new();
-	if (!udev) {
+	p->udev.udev = udev_new();
+	if (p->udev.udev == NULL) {
 		P_ERROR(p, "Can't create udev");
 		return -1;
 	}
 
+	/*
+	 * Listen to the same subsystems that we enumerate. Failing here is not
+	 * fatal, we just do a full enumeration on every probe. Use the "udev"
+	 * source so events only arrive after the udev database is updated,
+	 * the same database that the enumeration reads.
+	 */
+	struct udev_monitor *monitor = udev_monitor_new_from_netlink(p->udev.udev, "udev");
+	if (monitor == NULL) {
+		P_WARN(p, "Can't create udev monitor, hotplug detection disabled");
+		return 0;
+	}
+
+	if (udev_monitor_filter_add_match_subsystem_devtype(monitor, "usb", "usb_device") < 0 ||
+	    udev_monitor_filter_add_match_subsystem_devtype(monitor, "video4linux", NULL) < 0 ||
+	    udev_monitor_filter_add_match_subsystem_devtype(monitor, "hidraw", NULL) < 0 ||
+	    udev_monitor_enable_receiving(monitor) < 0) {
+		P_WARN(p, "Can't setup udev monitor, hotplug detection disabled");
+		udev_monitor_unref(monitor);
+		return 0;
+	}
+
+	p->udev.monitor = monitor;
+
+	return 0;
+}
+
+void
+p_udev_teardown(struct prober *p)
+{
+	if (p->udev.monitor != NULL) {
+		udev_monitor_unref(p->udev.monitor);
+		p->udev.monitor = NULL;
+	}
+
+	if (p->udev.udev != NULL) {
+		udev_unref(p->udev.udev);
+		p->udev.udev = NULL;
+	}
+}
+
+bool
+p_udev_has_changes(struct prober *p)
+{
+	if (p->udev.monitor == NULL) {
+		return true;
+	}
+
+	// The monitor socket is non-blocking, this returns NULL once there are no more events.
+	bool changed = false;
+	struct udev_device *dev = NULL;
+	while ((dev = udev_monitor_receive_device(p->udev.monitor)) != NULL) {
+		P_DEBUG(p, "Hotplug: %s %s", udev_device_get_action(dev), udev_device_get_syspath(dev));
+		udev_device_unref(dev);
+		changed = true;
+	}
+
+	return changed;
+}
+
+int
+p_udev_probe(struct prober *p)
+{
+	struct udev *udev = p->udev.udev;
+
 	p_udev_enumerate_usb(p, udev);
 
 	p_udev_enumerate_v4l2(p, udev);
 
 	p_udev_enumerate_hidraw(p, udev);
 
-	udev_unref(udev);
-
 	return 0;
 }
 
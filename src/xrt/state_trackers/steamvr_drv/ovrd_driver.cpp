@@ -14,6 +14,7 @@
 #include <cstring>
 #include <cassert>
 #include <array>
+#include <atomic>
 #include <thread>
 
 #include "math/m_api.h"
@@ -27,6 +28,7 @@ extern "C" {
 
 #include <math/m_space.h>
 #include "os/os_time.h"
+#include "util/u_time.h"
 #include "util/u_debug.h"
 #include "util/u_device.h"
 #include "util/u_builders.h"
@@ -54,6 +56,8 @@ DEBUG_GET_ONCE_BOOL_OPTION(emulate_index_controller, "STEAMVR_EMULATE_INDEX_CONT
 
 DEBUG_GET_ONCE_NUM_OPTION(scale_percentage, "XRT_COMPOSITOR_SCALE_PERCENTAGE", 140)
 
+DEBUG_GET_ONCE_NUM_OPTION(pose_update_hz, "STEAMVR_POSE_UPDATE_HZ", 1000)
+
 #define MODELNUM_LEN (XRT_DEVICE_NAME_LEN + 9) // "[Monado] "
 
 #define OPENVR_BONE_COUNT 31
@@ -710,22 +714,14 @@ public:
 		}
 	}
 
+	//! Called by the server driver's pose update thread with the relation of @ref GetPoseName.
 	void
-	PoseUpdateThreadFunction()
+	UpdatePose(const struct xrt_space_relation &rel)
 	{
-		ovrd_log("Starting controller pose update thread for %s\n", m_xdev->str);
-
-		while (m_poseUpdating) {
-			//! @todo figure out the best pose update rate
-			std::this_thread::sleep_for(std::chrono::milliseconds(1));
-
-			if (m_unObjectId != vr::k_unTrackedDeviceIndexInvalid) {
-				vr::VRServerDriverHost()->TrackedDevicePoseUpdated(m_unObjectId, GetPose(),
-				                                                   sizeof(vr::DriverPose_t));
-			}
+		if (m_unObjectId != vr::k_unTrackedDeviceIndexInvalid) {
+			vr::VRServerDriverHost()->TrackedDevicePoseUpdated(m_unObjectId, PoseFromRelation(rel),
+			                                                   sizeof(vr::DriverPose_t));
 		}
-
-		ovrd_log("Stopping controller pose update thread for %s\n", m_xdev->str);
 	}
 
 	vr::EVRInitError
@@ -805,12 +801,6 @@ public:
 
 		ovrd_log("Controller %d activated\n", m_unObjectId);
 
-		m_poseUpdateThread = new std::thread(&CDeviceDriver_Monado_Controller::PoseUpdateThreadFunction, this);
-		if (!m_poseUpdateThread) {
-			ovrd_log("Unable to create pose updated thread for %s\n", m_xdev->str);
-			return vr::VRInitError_Driver_Failed;
-		}
-
 		return vr::VRInitError_None;
 	}
 
@@ -818,8 +808,6 @@ public:
 	Deactivate()
 	{
 		ovrd_log("deactivate controller\n");
-		m_poseUpdating = false;
-		m_poseUpdateThread->join();
 		m_unObjectId = vr::k_unTrackedDeviceIndexInvalid;
 	}
 
@@ -849,13 +837,15 @@ public:
 	vr::DriverPose_t
 	GetPose()
 	{
-		// monado predicts pose "now", see xrt_device_get_tracked_pose
-		m_pose.poseTimeOffset = 0;
+		struct xrt_space_relation rel;
+		xrt_device_get_tracked_pose(m_xdev, GetPoseName(), os_monotonic_get_ns(), &rel);
 
-		m_pose.poseIsValid = true;
-		m_pose.result = vr::TrackingResult_Running_OK;
-		m_pose.deviceIsConnected = true;
+		return PoseFromRelation(rel);
+	}
 
+	enum xrt_input_name
+	GetPoseName()
+	{
 		enum xrt_input_name grip_name;
 
 		//! @todo better method to find grip name
@@ -878,10 +868,18 @@ public:
 			grip_name = XRT_INPUT_GENERIC_HEAD_POSE; // ???
 		}
 
-		timepoint_ns now_ns = os_monotonic_get_ns();
+		return grip_name;
+	}
 
-		struct xrt_space_relation rel;
-		xrt_device_get_tracked_pose(m_xdev, grip_name, now_ns, &rel);
+	vr::DriverPose_t
+	PoseFromRelation(struct xrt_space_relation rel)
+	{
+		// monado predicts pose "now", see xrt_device_get_tracked_pose
+		m_pose.poseTimeOffset = 0;
+
+		m_pose.poseIsValid = true;
+		m_pose.result = vr::TrackingResult_Running_OK;
+		m_pose.deviceIsConnected = true;
 
 		struct xrt_pose *offset = &m_xdev->tracking_origin->initial_offset;
 
@@ -1071,9 +1069,6 @@ private:
 	bool m_handed_controller;
 
 	std::string m_input_profile;
-
-	bool m_poseUpdating = true;
-	std::thread *m_poseUpdateThread = NULL;
 };
 
 /*
@@ -1130,6 +1125,9 @@ public:
 	virtual void DebugRequest(const char *pchRequest, char *pchResponseBuffer, uint32_t unResponseBufferSize);
 	virtual vr::DriverPose_t GetPose();
 
+	vr::DriverPose_t PoseFromRelation(struct xrt_space_relation rel);
+	void UpdatePose(const struct xrt_space_relation &rel);
+
 	// IVRDisplayComponent
 	virtual void GetWindowBounds(int32_t *pnX, int32_t *pnY, uint32_t *pnWidth, uint32_t *pnHeight);
 	virtual bool IsDisplayOnDesktop();
@@ -1156,9 +1154,8 @@ private:
 	struct xrt_fov m_fovs[2];
 	struct xrt_pose m_view_pose[2];
 
-	bool m_poseUpdating = true;
-	std::thread *m_poseUpdateThread = NULL;
-	virtual void PoseUpdateThreadFunction();
+	//! Poses are only pushed between Activate and Deactivate.
+	std::atomic_bool m_active{false};
 
 	// clang-format on
 };
@@ -1182,18 +1179,14 @@ create_translation_rotation_matrix(struct xrt_pose *pose, struct vr::HmdMatrix34
 	res->m[2][3] = t.z;
 }
 
+//! Called by the server driver's pose update thread with the head pose relation.
 void
-CDeviceDriver_Monado::PoseUpdateThreadFunction()
+CDeviceDriver_Monado::UpdatePose(const struct xrt_space_relation &rel)
 {
-	ovrd_log("Starting HMD pose update thread\n");
-
-	while (m_poseUpdating) {
-		//! @todo figure out the best pose update rate
-		std::this_thread::sleep_for(std::chrono::milliseconds(1));
-		vr::VRServerDriverHost()->TrackedDevicePoseUpdated(m_trackedDeviceIndex, GetPose(),
+	if (m_active) {
+		vr::VRServerDriverHost()->TrackedDevicePoseUpdated(m_trackedDeviceIndex, PoseFromRelation(rel),
 		                                                   sizeof(vr::DriverPose_t));
 	}
-	ovrd_log("Stopping HMD pose update thread\n");
 }
 
 vr::EVRInitError
@@ -1234,12 +1227,7 @@ CDeviceDriver_Monado::Activate(vr::TrackedDeviceIndex_t unObjectId)
 
 	vr::VRServerDriverHost()->SetDisplayEyeToHead(m_trackedDeviceIndex, left, right);
 
-
-	m_poseUpdateThread = new std::thread(&CDeviceDriver_Monado::PoseUpdateThreadFunction, this);
-	if (!m_poseUpdateThread) {
-		ovrd_log("Unable to create pose updated thread for %s\n", m_xdev->str);
-		return vr::VRInitError_Driver_Failed;
-	}
+	m_active = true;
 
 	return vr::VRInitError_None;
 }
@@ -1247,8 +1235,7 @@ CDeviceDriver_Monado::Activate(vr::TrackedDeviceIndex_t unObjectId)
 void
 CDeviceDriver_Monado::Deactivate()
 {
-	m_poseUpdating = false;
-	m_poseUpdateThread->join();
+	m_active = false;
 	ovrd_log("Deactivate\n");
 }
 
@@ -1290,11 +1277,15 @@ HmdQuaternion_Init(double w, double x, double y, double z)
 vr::DriverPose_t
 CDeviceDriver_Monado::GetPose()
 {
-
-	timepoint_ns now_ns = os_monotonic_get_ns();
 	struct xrt_space_relation rel;
-	xrt_device_get_tracked_pose(m_xdev, XRT_INPUT_GENERIC_HEAD_POSE, now_ns, &rel);
+	xrt_device_get_tracked_pose(m_xdev, XRT_INPUT_GENERIC_HEAD_POSE, os_monotonic_get_ns(), &rel);
+
+	return PoseFromRelation(rel);
+}
 
+vr::DriverPose_t
+CDeviceDriver_Monado::PoseFromRelation(struct xrt_space_relation rel)
+{
 	struct xrt_pose *offset = &m_xdev->tracking_origin->initial_offset;
 
 	struct xrt_relation_chain chain = {};
@@ -1480,6 +1471,9 @@ public:
 	// clang-format on
 
 private:
+	void
+	PoseUpdateThreadFunction();
+
 	struct xrt_instance *m_xinst = NULL;
 	struct xrt_system *m_xsys = NULL;
 	struct xrt_system_devices *m_xsysd = NULL;
@@ -1489,6 +1483,13 @@ private:
 	CDeviceDriver_Monado *m_MonadoDeviceDriver = NULL;
 	CDeviceDriver_Monado_Controller *m_left = NULL;
 	CDeviceDriver_Monado_Controller *m_right = NULL;
+
+	/*!
+	 * A single thread pushes the poses of all devices, sampled at the same
+	 * time, instead of one polling thread per device.
+	 */
+	std::thread *m_poseUpdateThread = NULL;
+	std::atomic_bool m_poseUpdating{false};
 };
 
 CServerDriver_Monado g_serverDriverMonado;
@@ -1560,12 +1561,71 @@ CServerDriver_Monado::Init(vr::IVRDriverContext *pDriverContext)
 		ovrd_log("Added right Controller: %s\n", right_xdev->str);
 	}
 
+	m_poseUpdating = true;
+	m_poseUpdateThread = new std::thread(&CServerDriver_Monado::PoseUpdateThreadFunction, this);
+
 	return vr::VRInitError_None;
 }
 
+void
+CServerDriver_Monado::PoseUpdateThreadFunction()
+{
+	long hz = CLAMP(debug_get_num_option_pose_update_hz(), 10, 2000);
+	timepoint_ns period_ns = U_TIME_1S_IN_NS / hz;
+
+	ovrd_log("Starting pose update thread at %ld Hz\n", hz);
+
+	timepoint_ns next_ns = os_monotonic_get_ns();
+	while (m_poseUpdating) {
+		// Sleep to a fixed schedule, so the time spent updating doesn't lower the rate.
+		next_ns += period_ns;
+		timepoint_ns now_ns = os_monotonic_get_ns();
+		if (next_ns > now_ns) {
+			os_nanosleep(next_ns - now_ns);
+		} else {
+			// Fell behind, don't try to catch up with a burst of updates.
+			next_ns = now_ns;
+		}
+
+		// One query for all devices, sampled at the same time so their relative poses are consistent.
+		struct xrt_device *xdevs[3] = {m_xhmd};
+		enum xrt_input_name names[3] = {XRT_INPUT_GENERIC_HEAD_POSE};
+		uint32_t count = 1;
+		if (m_left) {
+			xdevs[count] = m_left->m_xdev;
+			names[count++] = m_left->GetPoseName();
+		}
+		if (m_right) {
+			xdevs[count] = m_right->m_xdev;
+			names[count++] = m_right->GetPoseName();
+		}
+
+		struct xrt_space_relation rels[3];
+		xrt_system_devices_get_tracked_poses(m_xsysd, count, xdevs, names, os_monotonic_get_ns(), rels);
+
+		m_MonadoDeviceDriver->UpdatePose(rels[0]);
+		count = 1;
+		if (m_left) {
+			m_left->UpdatePose(rels[count++]);
+		}
+		if (m_right) {
+			m_right->UpdatePose(rels[count++]);
+		}
+	}
+
+	ovrd_log("Stopping pose update thread\n");
+}
+
 void
 CServerDriver_Monado::Cleanup()
 {
+	if (m_poseUpdateThread != NULL) {
+		m_poseUpdating = false;
+		m_poseUpdateThread->join();
+		delete m_poseUpdateThread;
+		m_poseUpdateThread = NULL;
+	}
+
 	if (m_MonadoDeviceDriver != NULL) {
 		delete m_MonadoDeviceDriver;
 		m_MonadoDeviceDriver = NULL;
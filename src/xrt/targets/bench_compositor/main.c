@@ -0,0 +1,838 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Headless benchmark of the compositor's layer squasher and distortion.
+ *
+ * Drives the same @ref chl_frame_state code paths as the main compositor's
+ * renderer, with synthetic layers rendered into an offscreen target, so that
+ * renderer changes can be compared without a display or a running service.
+ *
+ * @ingroup comp_util
+ */
+
+#include "os/os_time.h"
+
+#include "util/u_misc.h"
+#include "util/u_time.h"
+#include "util/u_logging.h"
+#include "util/u_live_stats.h"
+#include "util/u_string_list.h"
+#include "util/u_pretty_print.h"
+
+#include "vk/vk_helpers.h"
+
+#include "render/render_interface.h"
+
+#include "util/comp_vulkan.h"
+#include "util/comp_scratch.h"
+#include "util/comp_swapchain.h"
+#include "util/comp_layer_accum.h"
+#include "util/comp_high_level_render.h"
+#include "util/comp_high_level_scratch.h"
+
+#include "xrt/xrt_device.h"
+
+#include "simulated/simulated_interface.h"
+
+#include <assert.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define P(...) fprintf(stdout, __VA_ARGS__)
+#define PE(...) fprintf(stderr, __VA_ARGS__)
+
+//! Format of the synthetic layers' swapchains and the scratch images.
+#define BENCH_FORMAT VK_FORMAT_R8G8B8A8_SRGB
+
+
+/*
+ *
+ * Vulkan extensions, the same ones as the null compositor.
+ *
+ */
+
+static const char *instance_extensions_common[] = {
+    VK_KHR_EXTERNAL_FENCE_CAPABILITIES_EXTENSION_NAME,      //
+    VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME,     //
+    VK_KHR_EXTERNAL_SEMAPHORE_CAPABILITIES_EXTENSION_NAME,  //
+    VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME, //
+};
+
+static const char *required_device_extensions[] = {
+    VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME,      //
+    VK_KHR_EXTERNAL_FENCE_EXTENSION_NAME,            //
+    VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME,           //
+    VK_KHR_EXTERNAL_SEMAPHORE_EXTENSION_NAME,        //
+    VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME, //
+
+// Platform version of "external_memory"
+#if defined(XRT_GRAPHICS_BUFFER_HANDLE_IS_FD)
+    VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME,
+
+#elif defined(XRT_GRAPHICS_BUFFER_HANDLE_IS_AHARDWAREBUFFER)
+    VK_ANDROID_EXTERNAL_MEMORY_ANDROID_HARDWARE_BUFFER_EXTENSION_NAME,
+    VK_KHR_SAMPLER_YCBCR_CONVERSION_EXTENSION_NAME,
+    VK_KHR_MAINTENANCE_1_EXTENSION_NAME,
+    VK_KHR_BIND_MEMORY_2_EXTENSION_NAME,
+    VK_EXT_QUEUE_FAMILY_FOREIGN_EXTENSION_NAME,
+
+#elif defined(XRT_GRAPHICS_BUFFER_HANDLE_IS_WIN32_HANDLE)
+    VK_KHR_EXTERNAL_MEMORY_WIN32_EXTENSION_NAME,
+
+#else
+#error "Need port!"
+#endif
+};
+
+static const char *optional_device_extensions[] = {
+#ifdef VK_KHR_image_format_list
+    VK_KHR_IMAGE_FORMAT_LIST_EXTENSION_NAME,
+#endif
+#ifdef VK_KHR_timeline_semaphore
+    VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME,
+#endif
+#ifdef VK_EXT_calibrated_timestamps
+    VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME,
+#endif
+};
+
+
+/*
+ *
+ * Structs.
+ *
+ */
+
+struct options
+{
+	uint32_t frames;
+	uint32_t warmup;
+
+	//! Number of each layer type submitted every frame.
+	uint32_t projection_count;
+	uint32_t quad_count;
+	uint32_t cylinder_count;
+	uint32_t equirect_count;
+
+	//! Width and height of the layers' swapchains.
+	uint32_t layer_size;
+
+	bool run_gfx;
+	bool run_cs;
+};
+
+/*!
+ * Everything the renderer needs, set up once and shared by both paths.
+ */
+struct bench
+{
+	struct vk_bundle vk;
+
+	struct xrt_device *xdev;
+
+	struct comp_swapchain_shared cscs;
+
+	struct render_shaders shaders;
+
+	struct render_resources nr;
+
+	struct chl_scratch scratch;
+
+	//! Offscreen stand-in for a @ref comp_target, like the debug image target.
+	struct
+	{
+		struct comp_scratch_single_images images;
+
+		VkExtent2D extent;
+
+		struct render_gfx_render_pass render_pass;
+
+		struct render_gfx_target_resources rtrs[COMP_SCRATCH_NUM_IMAGES];
+	} target;
+
+	//! Signalled when the GPU is done with a frame.
+	VkFence fence;
+
+	//! One swapchain per layer, only ever read from.
+	struct xrt_swapchain *xscs[XRT_MAX_LAYERS];
+
+	struct comp_layer layers[XRT_MAX_LAYERS];
+	uint32_t layer_count;
+
+	//! Fixed view state, the head doesn't move.
+	struct
+	{
+		uint32_t count;
+		struct xrt_fov fovs[XRT_MAX_VIEWS];
+		struct xrt_pose poses[XRT_MAX_VIEWS];
+		struct render_viewport_data viewports[XRT_MAX_VIEWS];
+		struct xrt_matrix_2x2 rots[XRT_MAX_VIEWS];
+	} views;
+
+	//! Memory of the images created by the benchmark.
+	VkDeviceSize image_memory;
+};
+
+struct path_stats
+{
+	struct u_live_stats_ns cpu;
+	struct u_live_stats_ns gpu;
+	struct u_live_stats_ns frame;
+	uint32_t failures;
+};
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+static VkDeviceSize
+get_image_memory(struct vk_bundle *vk, VkImage image)
+{
+	VkMemoryRequirements reqs = {0};
+	vk->vkGetImageMemoryRequirements(vk->device, image, &reqs);
+
+	return reqs.size;
+}
+
+static struct xrt_sub_image
+full_sub_image(uint32_t size)
+{
+	return (struct xrt_sub_image){
+	    .image_index = 0,
+	    .array_index = 0,
+	    .rect = {.offset = {0, 0}, .extent = {(int)size, (int)size}},
+	    .norm_rect = {.x = 0.0f, .y = 0.0f, .w = 1.0f, .h = 1.0f},
+	};
+}
+
+//! Spread the layers out in front of the viewer so they overlap partially.
+static struct xrt_pose
+layer_pose(uint32_t index)
+{
+	struct xrt_pose pose = XRT_POSE_IDENTITY;
+	pose.position.x = -1.0f + (float)(index % 5) * 0.5f;
+	pose.position.y = -0.5f + (float)((index / 5) % 3) * 0.5f;
+	pose.position.z = -2.0f;
+
+	return pose;
+}
+
+
+/*
+ *
+ * Init and fini.
+ *
+ */
+
+static bool
+init_vulkan(struct bench *b)
+{
+	struct vk_bundle *vk = &b->vk;
+
+	struct u_string_list *required_instance_ext_list =
+	    u_string_list_create_from_array(instance_extensions_common, ARRAY_SIZE(instance_extensions_common));
+
+	struct u_string_list *optional_instance_ext_list = u_string_list_create();
+
+	struct u_string_list *required_device_extension_list =
+	    u_string_list_create_from_array(required_device_extensions, ARRAY_SIZE(required_device_extensions));
+
+	struct u_string_list *optional_device_extension_list =
+	    u_string_list_create_from_array(optional_device_extensions, ARRAY_SIZE(optional_device_extensions));
+
+	struct comp_vulkan_arguments vk_args = {
+	    .get_instance_proc_address = vkGetInstanceProcAddr,
+	    .required_instance_version = VK_MAKE_VERSION(1, 0, 0),
+	    .required_instance_extensions = required_instance_ext_list,
+	    .optional_instance_extensions = optional_instance_ext_list,
+	    .required_device_extensions = required_device_extension_list,
+	    .optional_device_extensions = optional_device_extension_list,
+	    .log_level = U_LOGGING_WARN,
+	    .only_compute_queue = false, // Regular GFX
+	    .selected_gpu_index = -1,    // Auto
+	    .client_gpu_index = -1,      // Auto
+	    .timeline_semaphore = true,  // Flag is optional, not a hard requirement.
+	};
+
+	struct comp_vulkan_results vk_res = {0};
+	bool bundle_ret = comp_vulkan_init_bundle(vk, &vk_args, &vk_res);
+
+	u_string_list_destroy(&required_instance_ext_list);
+	u_string_list_destroy(&optional_instance_ext_list);
+	u_string_list_destroy(&required_device_extension_list);
+	u_string_list_destroy(&optional_device_extension_list);
+
+	if (!bundle_ret) {
+		PE("Failed to init Vulkan.\n");
+		return false;
+	}
+
+	if (comp_swapchain_shared_init(&b->cscs, vk) != XRT_SUCCESS) {
+		PE("comp_swapchain_shared_init failed.\n");
+		return false;
+	}
+
+	VkFenceCreateInfo fence_info = {
+	    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+	};
+
+	VkResult ret = vk->vkCreateFence(vk->device, &fence_info, NULL, &b->fence);
+	if (ret != VK_SUCCESS) {
+		PE("vkCreateFence: %s\n", vk_result_string(ret));
+		return false;
+	}
+
+	return true;
+}
+
+static bool
+init_renderer(struct bench *b)
+{
+	struct vk_bundle *vk = &b->vk;
+	struct xrt_hmd_parts *hmd = b->xdev->hmd;
+
+	if (!render_shaders_load(&b->shaders, vk)) {
+		PE("render_shaders_load failed.\n");
+		return false;
+	}
+
+	if (!render_resources_init(&b->nr, &b->shaders, vk, b->xdev)) {
+		PE("render_resources_init failed.\n");
+		return false;
+	}
+
+	// Needed by the compute path.
+	if (!render_distortion_images_ensure(&b->nr, vk, b->xdev, false)) {
+		PE("render_distortion_images_ensure failed.\n");
+		return false;
+	}
+
+	VkExtent2D scratch_extent = {hmd->views[0].display.w_pixels, hmd->views[0].display.h_pixels};
+
+	if (!chl_scratch_ensure(&b->scratch, &b->nr, b->nr.view_count, scratch_extent, BENCH_FORMAT)) {
+		PE("chl_scratch_ensure failed.\n");
+		return false;
+	}
+
+	// The layers never change, which would otherwise only squash them once.
+	b->scratch.cache.disabled = true;
+
+	for (uint32_t i = 0; i < b->nr.view_count; i++) {
+		for (uint32_t k = 0; k < COMP_SCRATCH_NUM_IMAGES; k++) {
+			b->image_memory += get_image_memory(vk, b->scratch.views[i].cssi.images[k].image);
+		}
+	}
+
+	return true;
+}
+
+static bool
+init_target(struct bench *b)
+{
+	struct vk_bundle *vk = &b->vk;
+	struct xrt_hmd_parts *hmd = b->xdev->hmd;
+
+	b->target.extent = (VkExtent2D){hmd->screens[0].w_pixels, hmd->screens[0].h_pixels};
+
+	// Mutable so the graphics path can render to the sRGB and compute to the unorm view.
+	if (!comp_scratch_single_images_ensure_mutable(&b->target.images, vk, b->target.extent)) {
+		PE("Failed to create the target images.\n");
+		return false;
+	}
+
+	bool bret = render_gfx_render_pass_init( //
+	    &b->target.render_pass,              // rgrp
+	    &b->nr,                              // r
+	    VK_FORMAT_R8G8B8A8_SRGB,             // format
+	    VK_ATTACHMENT_LOAD_OP_CLEAR,         // load_op
+	    VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);    // final_layout
+	if (!bret) {
+		PE("render_gfx_render_pass_init failed.\n");
+		return false;
+	}
+
+	for (uint32_t i = 0; i < COMP_SCRATCH_NUM_IMAGES; i++) {
+		bret = render_gfx_target_resources_init(  //
+		    &b->target.rtrs[i],                   // rtr
+		    &b->nr,                               // r
+		    &b->target.render_pass,               // rgrp
+		    b->target.images.images[i].srgb_view, // target
+		    b->target.extent);                    // extent
+		if (!bret) {
+			PE("render_gfx_target_resources_init failed.\n");
+			return false;
+		}
+
+		b->image_memory += get_image_memory(vk, b->target.images.images[i].image);
+	}
+
+	// Same layout as the distortion normally uses, both eyes side by side.
+	float scale_x = (float)b->target.extent.width / (float)hmd->screens[0].w_pixels;
+	float scale_y = (float)b->target.extent.height / (float)hmd->screens[0].h_pixels;
+
+	b->views.count = b->nr.view_count;
+	for (uint32_t i = 0; i < b->views.count; i++) {
+		const struct xrt_view *v = &hmd->views[i];
+
+		b->views.viewports[i] = (struct render_viewport_data){
+		    .x = (uint32_t)(v->viewport.x_pixels * scale_x),
+		    .y = (uint32_t)(v->viewport.y_pixels * scale_y),
+		    .w = (uint32_t)(v->viewport.w_pixels * scale_x),
+		    .h = (uint32_t)(v->viewport.h_pixels * scale_y),
+		};
+		b->views.rots[i] = v->rot;
+		b->views.fovs[i] = hmd->distortion.fov[i];
+
+		struct xrt_pose pose = XRT_POSE_IDENTITY;
+		pose.position.x = (i == 0 ? -0.063f : 0.063f) / 2.0f;
+		b->views.poses[i] = pose;
+	}
+
+	return true;
+}
+
+static bool
+add_layer(struct bench *b, enum xrt_layer_type type, uint32_t size)
+{
+	struct vk_bundle *vk = &b->vk;
+	uint32_t index = b->layer_count;
+
+	struct xrt_swapchain_create_info info = {
+	    .bits = XRT_SWAPCHAIN_USAGE_COLOR | XRT_SWAPCHAIN_USAGE_SAMPLED,
+	    .format = BENCH_FORMAT,
+	    .sample_count = 1,
+	    .width = size,
+	    .height = size,
+	    .face_count = 1,
+	    .array_size = 1,
+	    .mip_count = 1,
+	};
+
+	struct xrt_swapchain_create_properties xsccp = {0};
+	xrt_result_t xret = comp_swapchain_get_create_properties(&info, &xsccp);
+	if (xret == XRT_SUCCESS) {
+		xret = comp_swapchain_create(vk, &b->cscs, &info, &xsccp, &b->xscs[index]);
+	}
+	if (xret != XRT_SUCCESS) {
+		PE("Failed to create swapchain for layer %u.\n", index);
+		return false;
+	}
+
+	struct comp_swapchain *sc = comp_swapchain(b->xscs[index]);
+	for (uint32_t i = 0; i < sc->vkic.image_count; i++) {
+		b->image_memory += sc->vkic.images[i].size;
+	}
+
+	// Images are left with whatever they contain, only the rendering is measured.
+	struct comp_layer *layer = &b->layers[index];
+	U_ZERO(layer);
+
+	struct xrt_layer_data *data = &layer->data;
+	data->type = type;
+	data->name = XRT_INPUT_GENERIC_HEAD_POSE;
+	data->view_count = b->views.count;
+	data->color_scale = (struct xrt_colour_rgba_f32){1.0f, 1.0f, 1.0f, 1.0f};
+
+	struct xrt_sub_image sub = full_sub_image(size);
+	struct xrt_pose pose = layer_pose(index);
+
+	switch (type) {
+	case XRT_LAYER_PROJECTION:
+		for (uint32_t i = 0; i < b->views.count; i++) {
+			layer->sc_array[i] = b->xscs[index];
+			data->proj.v[i].sub = sub;
+			data->proj.v[i].fov = b->views.fovs[i];
+			data->proj.v[i].pose = b->views.poses[i];
+		}
+		break;
+	case XRT_LAYER_QUAD:
+		layer->sc_array[0] = b->xscs[index];
+		data->flags = XRT_LAYER_COMPOSITION_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
+		data->quad.visibility = XRT_LAYER_EYE_VISIBILITY_BOTH;
+		data->quad.sub = sub;
+		data->quad.pose = pose;
+		data->quad.size = (struct xrt_vec2){0.5f, 0.5f};
+		break;
+	case XRT_LAYER_CYLINDER:
+		layer->sc_array[0] = b->xscs[index];
+		data->flags = XRT_LAYER_COMPOSITION_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
+		data->cylinder.visibility = XRT_LAYER_EYE_VISIBILITY_BOTH;
+		data->cylinder.sub = sub;
+		data->cylinder.pose = pose;
+		data->cylinder.radius = 2.0f;
+		data->cylinder.central_angle = 0.5f;
+		data->cylinder.aspect_ratio = 1.0f;
+		break;
+	case XRT_LAYER_EQUIRECT2:
+		layer->sc_array[0] = b->xscs[index];
+		data->flags = XRT_LAYER_COMPOSITION_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
+		data->equirect2.visibility = XRT_LAYER_EYE_VISIBILITY_BOTH;
+		data->equirect2.sub = sub;
+		data->equirect2.pose = pose;
+		data->equirect2.radius = 3.0f;
+		data->equirect2.central_horizontal_angle = 1.0f;
+		data->equirect2.upper_vertical_angle = 0.5f;
+		data->equirect2.lower_vertical_angle = -0.5f;
+		break;
+	default: assert(false); break;
+	}
+
+	b->layer_count++;
+
+	return true;
+}
+
+static bool
+init_layers(struct bench *b, const struct options *opts)
+{
+	// Projection layers first, like most applications do.
+	const struct
+	{
+		enum xrt_layer_type type;
+		uint32_t count;
+	} mix[] = {
+	    {XRT_LAYER_PROJECTION, opts->projection_count},
+	    {XRT_LAYER_QUAD, opts->quad_count},
+	    {XRT_LAYER_CYLINDER, opts->cylinder_count},
+	    {XRT_LAYER_EQUIRECT2, opts->equirect_count},
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(mix); i++) {
+		for (uint32_t k = 0; k < mix[i].count; k++) {
+			if (!add_layer(b, mix[i].type, opts->layer_size)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static void
+fini(struct bench *b)
+{
+	struct vk_bundle *vk = &b->vk;
+
+	if (vk->device != VK_NULL_HANDLE) {
+		vk->vkDeviceWaitIdle(vk->device);
+	}
+
+	for (uint32_t i = 0; i < b->layer_count; i++) {
+		xrt_swapchain_reference(&b->xscs[i], NULL);
+	}
+
+	// Everything below is safe to call on what failed or was never created.
+	for (uint32_t i = 0; i < COMP_SCRATCH_NUM_IMAGES; i++) {
+		if (b->target.rtrs[i].r != NULL) {
+			render_gfx_target_resources_fini(&b->target.rtrs[i]);
+		}
+	}
+	if (b->target.render_pass.r != NULL) {
+		render_gfx_render_pass_fini(&b->target.render_pass);
+	}
+	if (b->nr.vk != NULL) {
+		comp_scratch_single_images_free(&b->target.images, vk);
+		chl_scratch_free_resources(&b->scratch, &b->nr);
+	}
+	comp_scratch_single_images_destroy(&b->target.images);
+	chl_scratch_fini(&b->scratch);
+
+	render_resources_fini(&b->nr);
+
+	if (vk->device != VK_NULL_HANDLE) {
+		render_shaders_fini(&b->shaders, vk);
+
+		if (b->fence != VK_NULL_HANDLE) {
+			vk->vkDestroyFence(vk->device, b->fence, NULL);
+		}
+
+		// Must be destroyed before Vulkan.
+		comp_swapchain_shared_garbage_collect(&b->cscs);
+		comp_swapchain_shared_destroy(&b->cscs, vk);
+
+		vk->vkDestroyDevice(vk->device, NULL);
+		vk->device = VK_NULL_HANDLE;
+	}
+
+	vk_deinit_mutex(vk);
+
+	if (vk->instance != VK_NULL_HANDLE) {
+		vk->vkDestroyInstance(vk->instance, NULL);
+		vk->instance = VK_NULL_HANDLE;
+	}
+
+	xrt_device_destroy(&b->xdev);
+}
+
+
+/*
+ *
+ * Frame.
+ *
+ */
+
+static VkResult
+submit_and_wait(struct bench *b, VkCommandBuffer cmd)
+{
+	struct vk_bundle *vk = &b->vk;
+	VkResult ret;
+
+	VkSubmitInfo submit_info = {
+	    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+	    .commandBufferCount = 1,
+	    .pCommandBuffers = &cmd,
+	};
+
+	// Only this thread uses the pool, which satisfies the _locked requirement.
+	ret = vk_cmd_submit_locked(vk, &vk->main_queue, 1, &submit_info, b->fence);
+	VK_CHK_AND_RET(ret, "vk_cmd_submit_locked");
+
+	ret = vk->vkWaitForFences(vk->device, 1, &b->fence, VK_TRUE, UINT64_MAX);
+	VK_CHK_AND_RET(ret, "vkWaitForFences");
+
+	ret = vk->vkResetFences(vk->device, 1, &b->fence);
+	VK_CHK_AND_RET(ret, "vkResetFences");
+
+	return VK_SUCCESS;
+}
+
+/*!
+ * Records and submits one frame, then waits for the GPU so every frame is
+ * measured on its own.
+ */
+static void
+do_frame(struct bench *b, bool use_compute, struct path_stats *stats)
+{
+	uint32_t frame_index = render_resources_next_frame(&b->nr);
+
+	uint32_t target_index = 0;
+	comp_scratch_single_images_get(&b->target.images, &target_index);
+	struct render_scratch_color_image *target = &b->target.images.images[target_index];
+
+	struct chl_frame_state frame_state;
+	chl_frame_state_init( //
+	    &frame_state,     //
+	    &b->nr,           //
+	    b->views.count,   //
+	    true,             // do_timewarp
+	    false,            // fast_path
+	    &b->scratch);     //
+
+	struct render_gfx render_g = {0};
+	struct render_compute render_c = {0};
+	VkCommandBuffer cmd = VK_NULL_HANDLE;
+
+	int64_t start_ns = os_monotonic_get_ns();
+
+	if (use_compute) {
+		render_compute_init(&render_c, &b->nr);
+
+		chl_frame_state_cs_default_pipeline( //
+		    &frame_state,                    //
+		    &render_c,                       //
+		    b->layers,                       //
+		    b->layer_count,                  //
+		    b->views.poses,                  // world_poses
+		    b->views.poses,                  // eye_poses
+		    b->views.fovs,                   //
+		    target->image,                   // target_image
+		    target->unorm_view,              // target_storage_view
+		    b->views.viewports);             // target_viewport_datas
+
+		cmd = render_c.frame->cmd;
+	} else {
+		render_gfx_init(&render_g, &b->nr);
+
+		chl_frame_state_gfx_default_pipeline( //
+		    &frame_state,                     //
+		    &render_g,                        //
+		    b->layers,                        //
+		    b->layer_count,                   //
+		    b->views.poses,                   // world_poses
+		    b->views.poses,                   // eye_poses
+		    b->views.fovs,                    //
+		    &b->target.rtrs[target_index],    // target_rtr
+		    b->views.viewports,               // target_viewport_datas
+		    b->views.rots);                   // vertex_rots
+
+		cmd = render_g.frame->cmd;
+	}
+
+	int64_t recorded_ns = os_monotonic_get_ns();
+
+	VkResult ret = submit_and_wait(b, cmd);
+
+	int64_t done_ns = os_monotonic_get_ns();
+
+	uint64_t gpu_ns = 0;
+	bool ok = ret == VK_SUCCESS && render_resources_get_duration(&b->nr, frame_index, &gpu_ns);
+
+	// Warm up frames are not measured.
+	if (stats != NULL && !ok) {
+		stats->failures++;
+	} else if (stats != NULL) {
+		u_ls_ns_add(&stats->cpu, (uint64_t)(recorded_ns - start_ns));
+		u_ls_ns_add(&stats->gpu, gpu_ns);
+		u_ls_ns_add(&stats->frame, (uint64_t)(done_ns - start_ns));
+	}
+
+	chl_frame_state_fini(&frame_state);
+	comp_scratch_single_images_done(&b->target.images);
+
+	if (use_compute) {
+		render_compute_fini(&render_c);
+	} else {
+		render_gfx_fini(&render_g);
+	}
+}
+
+static uint32_t
+run_path(struct bench *b, const struct options *opts, bool use_compute)
+{
+	const char *name = use_compute ? "compute" : "graphics";
+
+	struct path_stats *stats = U_TYPED_CALLOC(struct path_stats);
+	snprintf(stats->cpu.name, sizeof(stats->cpu.name), "cpu record");
+	snprintf(stats->gpu.name, sizeof(stats->gpu.name), "gpu");
+	snprintf(stats->frame.name, sizeof(stats->frame.name), "frame");
+
+	for (uint32_t i = 0; i < opts->warmup; i++) {
+		do_frame(b, use_compute, NULL);
+	}
+
+	for (uint32_t i = 0; i < opts->frames; i++) {
+		do_frame(b, use_compute, stats);
+	}
+
+	struct u_pp_sink_stack_only sink;
+	u_pp_delegate_t dg = u_pp_sink_stack_only_init(&sink);
+
+	u_ls_ns_print_header(dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_and_reset(&stats->cpu, dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_and_reset(&stats->gpu, dg);
+	u_pp(dg, "\n");
+	u_ls_ns_print_and_reset(&stats->frame, dg);
+
+	P("\n%s path, %u frames:\n%s\n", name, opts->frames, sink.buffer);
+
+	uint32_t failures = stats->failures;
+	if (failures > 0) {
+		PE("%u %s frames failed.\n", failures, name);
+	}
+
+	free(stats);
+
+	return failures;
+}
+
+
+/*
+ *
+ * Main.
+ *
+ */
+
+static void
+print_usage(void)
+{
+	PE("Usage: monado-bench-compositor [options]\n");
+	PE("    -n <count>: Number of measured frames per path (default 500)\n");
+	PE("    -w <count>: Number of warm up frames per path (default 50)\n");
+	PE("    -p <count>: Projection layers per frame (default 1)\n");
+	PE("    -q <count>: Quad layers per frame (default 2)\n");
+	PE("    -c <count>: Cylinder layers per frame (default 1)\n");
+	PE("    -e <count>: Equirect2 layers per frame (default 1)\n");
+	PE("    -s <size>:  Width and height of the layers' swapchains (default 1024)\n");
+	PE("    -m <path>:  Only run the 'gfx' or 'cs' path, both are run by default\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+	struct options opts = {
+	    .frames = 500,
+	    .warmup = 50,
+	    .projection_count = 1,
+	    .quad_count = 2,
+	    .cylinder_count = 1,
+	    .equirect_count = 1,
+	    .layer_size = 1024,
+	    .run_gfx = true,
+	    .run_cs = true,
+	};
+
+	int c;
+	while ((c = getopt(argc, argv, "n:w:p:q:c:e:s:m:h")) != -1) {
+		switch (c) {
+		case 'n': opts.frames = (uint32_t)atoi(optarg); break;
+		case 'w': opts.warmup = (uint32_t)atoi(optarg); break;
+		case 'p': opts.projection_count = (uint32_t)atoi(optarg); break;
+		case 'q': opts.quad_count = (uint32_t)atoi(optarg); break;
+		case 'c': opts.cylinder_count = (uint32_t)atoi(optarg); break;
+		case 'e': opts.equirect_count = (uint32_t)atoi(optarg); break;
+		case 's': opts.layer_size = (uint32_t)atoi(optarg); break;
+		case 'm':
+			opts.run_gfx = strcmp(optarg, "gfx") == 0;
+			opts.run_cs = strcmp(optarg, "cs") == 0;
+			break;
+		case 'h': print_usage(); return 0;
+		default: print_usage(); return 1;
+		}
+	}
+
+	uint64_t layer_count = (uint64_t)opts.projection_count + opts.quad_count + opts.cylinder_count +
+	                       opts.equirect_count;
+	if (layer_count > XRT_MAX_LAYERS || opts.frames == 0 || opts.layer_size == 0 ||
+	    (!opts.run_gfx && !opts.run_cs)) {
+		PE("At most %u layers, frames and size must be more than 0, path must be 'gfx' or 'cs'.\n",
+		   XRT_MAX_LAYERS);
+		return 1;
+	}
+
+	struct bench *b = U_TYPED_CALLOC(struct bench);
+	int ret = 0;
+
+	// Not safe to zero init, has mutexes.
+	chl_scratch_init(&b->scratch);
+	comp_scratch_single_images_init(&b->target.images);
+
+	struct xrt_pose center = XRT_POSE_IDENTITY;
+	b->xdev = simulated_hmd_create(SIMULATED_MOVEMENT_STATIONARY, &center);
+
+	if (!init_vulkan(b) || !init_renderer(b) || !init_target(b) || !init_layers(b, &opts)) {
+		fini(b);
+		free(b);
+		return 1;
+	}
+
+	VkPhysicalDeviceProperties pdp = {0};
+	b->vk.vkGetPhysicalDeviceProperties(b->vk.physical_device, &pdp);
+
+	P("Device: %s\n", pdp.deviceName);
+	P("Layers: %u projection, %u quad, %u cylinder, %u equirect2, %ux%u each\n", //
+	  opts.projection_count, opts.quad_count, opts.cylinder_count, opts.equirect_count, opts.layer_size,
+	  opts.layer_size);
+	P("Target: %ux%u, %u views\n", b->target.extent.width, b->target.extent.height, b->views.count);
+	P("Image memory: %.1f MiB\n", (double)b->image_memory / (1024.0 * 1024.0));
+
+	if (opts.run_gfx && run_path(b, &opts, false) > 0) {
+		ret = 1;
+	}
+	if (opts.run_cs && run_path(b, &opts, true) > 0) {
+		ret = 1;
+	}
+
+	fini(b);
+	free(b);
+
+	return ret;
+}
@@ -9,19 +9,53 @@
 #include "euroc/euroc_interface.h"
 #include "os/os_threading.h"
 #include "util/u_logging.h"
+#include "util/u_misc.h"
 #include "xrt/xrt_config_build.h"
 #include "xrt/xrt_config_have.h"
 #include "xrt/xrt_config_drivers.h"
 
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define P(...) fprintf(stderr, __VA_ARGS__)
 #define I(...) U_LOG(U_LOGGING_INFO, __VA_ARGS__)
 
 #if defined(XRT_FEATURE_SLAM) && defined(XRT_BUILD_DRIVER_EUROC)
 
+//! Max number of datasets run at the same time.
+#define MAX_JOBS 64
+
+//! Written to each output directory once its dataset has been fully run, used for resuming.
+#define RESULT_FILENAME "slambatch.csv"
+
+#define RESULT_HEADER "#dataset,wall_time [s],poses,poses_per_second,gt_errors,gt_rmse [mm],gt_max [mm]\n"
+
 static bool should_exit = false;
 
+//! Results of running one dataset.
+struct slambatch_result
+{
+	double wall_time_s;
+	uint64_t pose_count;
+	uint64_t gt_error_count;
+	double gt_rmse_mm;
+	double gt_max_mm;
+	bool done; //!< True if the dataset ran to completion or was resumed from a previous run
+};
+
+struct slambatch
+{
+	const char **args; //!< Triplets of dataset, SLAM config and output paths
+	int dataset_count;
+	bool resume;
+
+	struct os_mutex lock;
+	int next_dataset; //!< Next dataset a job should pick up, protected by @ref lock
+	struct slambatch_result *results;
+};
+
 static void *
 wait_for_exit_key(void *ptr)
 {
@@ -29,6 +63,220 @@ wait_for_exit_key(void *ptr)
 	should_exit = true;
 	return NULL;
 }
+
+static void
+make_path(char *out, size_t size, const char *dir, const char *filename)
+{
+	snprintf(out, size, "%s/%s", dir, filename);
+}
+
+//! Count the data rows of a CSV written by the SLAM tracker, skips the header.
+static uint64_t
+count_csv_rows(const char *path)
+{
+	FILE *file = fopen(path, "r");
+	if (file == NULL) {
+		return 0;
+	}
+
+	uint64_t rows = 0;
+	char line[512];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		rows += line[0] != '#' && line[0] != '\n' && strchr(line, '\n') != NULL;
+	}
+
+	fclose(file);
+	return rows;
+}
+
+//! Summarize the ground truth error CSV written by the SLAM tracker.
+static void
+read_gt_errors(const char *path, struct slambatch_result *res)
+{
+	FILE *file = fopen(path, "r");
+	if (file == NULL) {
+		return;
+	}
+
+	double sum_sq = 0;
+	char line[128];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		long long ts = 0;
+		double err_mm = 0;
+		if (line[0] == '#' || sscanf(line, "%lld,%lf", &ts, &err_mm) != 2) {
+			continue;
+		}
+
+		sum_sq += err_mm * err_mm;
+		res->gt_max_mm = fmax(res->gt_max_mm, err_mm);
+		res->gt_error_count++;
+	}
+
+	if (res->gt_error_count > 0) {
+		res->gt_rmse_mm = sqrt(sum_sq / (double)res->gt_error_count);
+	}
+
+	fclose(file);
+}
+
+static void
+write_result_row(FILE *file, const char *dataset_path, const struct slambatch_result *res)
+{
+	double poses_per_s = res->wall_time_s > 0 ? (double)res->pose_count / res->wall_time_s : 0;
+	fprintf(file, "%s,%.3f,%" PRIu64 ",%.1f,%" PRIu64 ",%.3f,%.3f\n", //
+	        dataset_path, res->wall_time_s, res->pose_count, poses_per_s, res->gt_error_count, res->gt_rmse_mm,
+	        res->gt_max_mm);
+}
+
+//! Read the result of a previous run of this dataset, returns false if there is none.
+static bool
+read_result(const char *output_path, struct slambatch_result *out_res)
+{
+	char path[1024];
+	make_path(path, sizeof(path), output_path, RESULT_FILENAME);
+
+	FILE *file = fopen(path, "r");
+	if (file == NULL) {
+		return false;
+	}
+
+	bool ok = false;
+	char line[1024];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		if (line[0] == '#') {
+			continue;
+		}
+
+		// The dataset path might contain commas, the numeric fields are the last six.
+		char *fields = line + strlen(line);
+		for (int commas = 0; commas < 6 && fields > line;) {
+			fields--;
+			commas += *fields == ',';
+		}
+
+		struct slambatch_result res = {0};
+		double pps = 0;
+		int matched = sscanf(fields, ",%lf,%" SCNu64 ",%lf,%" SCNu64 ",%lf,%lf", //
+		                     &res.wall_time_s, &res.pose_count, &pps, &res.gt_error_count, &res.gt_rmse_mm,
+		                     &res.gt_max_mm);
+		if (matched == 6) {
+			res.done = true;
+			*out_res = res;
+			ok = true;
+		}
+		break;
+	}
+
+	fclose(file);
+	return ok;
+}
+
+static void
+write_result(const char *dataset_path, const char *output_path, const struct slambatch_result *res)
+{
+	char path[1024];
+	make_path(path, sizeof(path), output_path, RESULT_FILENAME);
+
+	FILE *file = fopen(path, "w");
+	if (file == NULL) {
+		P("Could not write results to '%s'\n", path);
+		return;
+	}
+
+	fputs(RESULT_HEADER, file);
+	write_result_row(file, dataset_path, res);
+	fclose(file);
+}
+
+static void
+run_dataset(struct slambatch *sb, int i)
+{
+	const char *dataset_path = sb->args[i * 3];
+	const char *slam_config = sb->args[i * 3 + 1];
+	const char *output_path = sb->args[i * 3 + 2];
+	struct slambatch_result *res = &sb->results[i];
+
+	if (sb->resume && read_result(output_path, res)) {
+		I("Skipping dataset %d out of %d, already done: %s", i + 1, sb->dataset_count, dataset_path);
+		return;
+	}
+
+	I("Running dataset %d out of %d", i + 1, sb->dataset_count);
+	I("Dataset path: %s", dataset_path);
+	I("SLAM config path: %s", slam_config);
+	I("Output path: %s", output_path);
+
+	timepoint_ns start_time = os_monotonic_get_ns();
+	euroc_run_dataset(dataset_path, slam_config, output_path, &should_exit);
+	timepoint_ns end_time = os_monotonic_get_ns();
+
+	// An interrupted run has partial results, don't record it so that it's run again on resume.
+	if (should_exit) {
+		return;
+	}
+
+	char path[1024];
+	res->wall_time_s = (double)(end_time - start_time) / U_TIME_1S_IN_NS;
+	make_path(path, sizeof(path), output_path, "tracking.csv");
+	res->pose_count = count_csv_rows(path);
+	make_path(path, sizeof(path), output_path, "gt_error.csv");
+	read_gt_errors(path, res);
+	res->done = true;
+
+	write_result(dataset_path, output_path, res);
+
+	I("Dataset %d done in %.2fs", i + 1, res->wall_time_s);
+}
+
+static void *
+run_job(void *ptr)
+{
+	struct slambatch *sb = (struct slambatch *)ptr;
+
+	while (!should_exit) {
+		os_mutex_lock(&sb->lock);
+		int i = sb->next_dataset++;
+		os_mutex_unlock(&sb->lock);
+
+		if (i >= sb->dataset_count) {
+			break;
+		}
+
+		run_dataset(sb, i);
+	}
+
+	return NULL;
+}
+
+static void
+write_summary(struct slambatch *sb, const char *summary_path)
+{
+	FILE *file = fopen(summary_path, "w");
+	if (file == NULL) {
+		P("Could not write summary to '%s'\n", summary_path);
+		return;
+	}
+
+	fputs(RESULT_HEADER, file);
+	for (int i = 0; i < sb->dataset_count; i++) {
+		if (sb->results[i].done) {
+			write_result_row(file, sb->args[i * 3], &sb->results[i]);
+		}
+	}
+
+	fclose(file);
+}
+
+static void
+print_usage(const char *cmd, const char *subcmd)
+{
+	P("Batch evaluator of SLAM datasets.\n");
+	P("Usage: %s %s [options] [<euroc_path> <slam_config> <output_path>]...\n", cmd, subcmd);
+	P("Options:\n");
+	P("    -j <count>: Run this many datasets at the same time\n");
+	P("    -r: Resume, skip datasets that already have results in their output path\n");
+	P("    -s <path>: Write the results of all the datasets to this CSV, defaults to " RESULT_FILENAME "\n");
+}
 #endif
 
 int
@@ -46,31 +294,72 @@ cli_cmd_slambatch(int argc, const char **argv)
 	int nof_args = argc - 2;
 	const char **args = &argv[2];
 
-	if (nof_args == 0 || nof_args % 3 != 0) {
-		P("Batch evaluator of SLAM datasets.\n");
-		P("Usage: %s %s [<euroc_path> <slam_config> <output_path>]...\n", argv[0], argv[1]);
+	int job_count = 1;
+	bool resume = false;
+	const char *summary_path = RESULT_FILENAME;
+
+	// Options go before the dataset triplets.
+	while (nof_args > 0 && args[0][0] == '-') {
+		if (strcmp(args[0], "-r") == 0) {
+			resume = true;
+			nof_args--;
+			args++;
+		} else if (strcmp(args[0], "-j") == 0 && nof_args > 1) {
+			job_count = atoi(args[1]);
+			nof_args -= 2;
+			args += 2;
+		} else if (strcmp(args[0], "-s") == 0 && nof_args > 1) {
+			summary_path = args[1];
+			nof_args -= 2;
+			args += 2;
+		} else {
+			print_usage(argv[0], argv[1]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (nof_args == 0 || nof_args % 3 != 0 || job_count < 1 || job_count > MAX_JOBS) {
+		print_usage(argv[0], argv[1]);
 		return EXIT_FAILURE;
 	}
 
+	int nof_datasets = nof_args / 3;
+	if (job_count > nof_datasets) {
+		job_count = nof_datasets;
+	}
+
+	// Progress bars of parallel runs would overwrite each other.
+	if (job_count > 1) {
+		setenv("EUROC_PRINT_PROGRESS", "false", 0);
+	}
+
+	struct slambatch sb = {
+	    .args = args,
+	    .dataset_count = nof_datasets,
+	    .resume = resume,
+	    .results = U_TYPED_ARRAY_CALLOC(struct slambatch_result, nof_datasets),
+	};
+	os_mutex_init(&sb.lock);
+
 	// Allow pressing enter to quit the program by launching a new thread
 	struct os_thread_helper wfk_thread;
 	os_thread_helper_init(&wfk_thread);
 	os_thread_helper_start(&wfk_thread, wait_for_exit_key, NULL);
 
 	timepoint_ns start_time = os_monotonic_get_ns();
-	int nof_datasets = nof_args / 3;
-	for (int i = 0; i < nof_datasets && !should_exit; i++) {
-		const char *dataset_path = args[i * 3];
-		const char *slam_config = args[i * 3 + 1];
-		const char *output_path = args[i * 3 + 2];
-
-		I("Running dataset %d out of %d", i + 1, nof_datasets);
-		I("Dataset path: %s", dataset_path);
-		I("SLAM config path: %s", slam_config);
-		I("Output path: %s", output_path);
 
-		euroc_run_dataset(dataset_path, slam_config, output_path, &should_exit);
+	// The calling thread is the first job.
+	struct os_thread jobs[MAX_JOBS];
+	for (int i = 1; i < job_count; i++) {
+		os_thread_init(&jobs[i]);
+		os_thread_start(&jobs[i], run_job, &sb);
+	}
+	run_job(&sb);
+	for (int i = 1; i < job_count; i++) {
+		os_thread_join(&jobs[i]);
+		os_thread_destroy(&jobs[i]);
 	}
+
 	timepoint_ns end_time = os_monotonic_get_ns();
 
 	pthread_cancel(wfk_thread.thread);
@@ -78,7 +367,12 @@ cli_cmd_slambatch(int argc, const char **argv)
 	// Destroy also stops the thread.
 	os_thread_helper_destroy(&wfk_thread);
 
-	printf("Done in %.2fs.\n", (double)(end_time - start_time) / U_TIME_1S_IN_NS);
+	write_summary(&sb, summary_path);
+
+	os_mutex_destroy(&sb.lock);
+	free(sb.results);
+
+	printf("Done in %.2fs, results in %s.\n", (double)(end_time - start_time) / U_TIME_1S_IN_NS, summary_path);
 #endif
 	return EXIT_SUCCESS;
 }
@@ -1,4 +1,4 @@
-// Copyright 2022-2023, Collabora, Ltd.
+// Copyright 2022-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -435,8 +435,9 @@ valve_index_setup_visual_trackers(struct lighthouse_system *lhs,
 		LH_WARN("No visual trackers were set");
 		return false;
 	}
-	//! @todo Using a single slot queue is wrong for SLAM
-	u_sink_simple_queue_create(xfctx, entry_sbs_sink, &entry_sbs_sink);
+	// SLAM wants every frame so give it a few to catch up, hand tracking only wants the latest.
+	uint32_t queue_capacity = slam_enabled ? 4 : 1;
+	u_sink_ring_queue_create(xfctx, queue_capacity, U_SINK_RING_QUEUE_DROP_OLDEST, entry_sbs_sink, &entry_sbs_sink);
 
 	struct xrt_slam_sinks entry_sinks = {
 	    .cam_count = 1,
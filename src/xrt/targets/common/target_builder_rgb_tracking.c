@@ -1,4 +1,4 @@
-// Copyright 2022-2023, Collabora, Ltd.
+// Copyright 2022-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -154,8 +154,8 @@ setup_pipeline(struct xrt_prober *xp, struct build_state *build)
 	// The filter only supports yuv or yuyv formats.
 	u_sink_create_to_yuv_or_yuyv(build->xfctx, xsink, &xsink);
 
-	// Put a queue before it to multi-thread the filter.
-	u_sink_simple_queue_create(build->xfctx, xsink, &xsink);
+	// Put a queue before it to multi-thread the filter, only the latest frame is kept and the camera never blocks.
+	u_sink_ring_queue_create(build->xfctx, 1, U_SINK_RING_QUEUE_DROP_OLDEST, xsink, &xsink);
 
 	// Hardcoded quirk sink.
 	struct u_sink_quirk_params qp;
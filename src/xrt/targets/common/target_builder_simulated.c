@@ -1,4 +1,4 @@
-// Copyright 2022-2023, Collabora, Ltd.
+// Copyright 2022-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -30,6 +30,13 @@
 DEBUG_GET_ONCE_BOOL_OPTION(simulated_enabled, "SIMULATED_ENABLE", false)
 DEBUG_GET_ONCE_OPTION(simulated_left, "SIMULATED_LEFT", NULL)
 DEBUG_GET_ONCE_OPTION(simulated_right, "SIMULATED_RIGHT", NULL)
+DEBUG_GET_ONCE_NUM_OPTION(simulated_stress_trackers, "SIMULATED_STRESS_TRACKERS", 0)
+DEBUG_GET_ONCE_NUM_OPTION(simulated_stress_tracker_rate, "SIMULATED_STRESS_TRACKER_RATE", 1000)
+DEBUG_GET_ONCE_BOOL_OPTION(simulated_stress_hands, "SIMULATED_STRESS_HANDS", false)
+DEBUG_GET_ONCE_BOOL_OPTION(simulated_stress_body, "SIMULATED_STRESS_BODY", false)
+
+//! Hand and body tracking update at what a camera based tracker would do.
+#define SIMULATED_STRESS_CAMERA_RATE (60)
 
 
 /*
@@ -68,6 +75,79 @@ create_controller(const char *str,
 	return simulated_create_controller(name, type, center, origin);
 }
 
+/*!
+ * Spawns the stress test devices, trackers in a grid in front of the user and
+ * the hand and body trackers around the head.
+ */
+static void
+create_stress_devices(struct xrt_system_devices *xsysd,
+                      struct xrt_tracking_origin *origin,
+                      struct u_builder_roles_helper *ubrh)
+{
+	const struct xrt_pose hands_center = {XRT_QUAT_IDENTITY, {0.0f, 1.2f, -0.4f}};
+	const struct xrt_pose body_center = {XRT_QUAT_IDENTITY, {0.0f, 0.0f, 0.0f}};
+
+	if (debug_get_bool_option_simulated_stress_hands() && xsysd->xdev_count < XRT_SYSTEM_MAX_DEVICES) {
+		struct xrt_device *hands = simulated_stress_create( //
+		    SIMULATED_STRESS_HANDS,                         // kind
+		    0,                                              // index
+		    SIMULATED_STRESS_CAMERA_RATE,                   // rate_hz
+		    &hands_center,                                  // center
+		    origin);                                        // origin
+		if (hands != NULL) {
+			xsysd->xdevs[xsysd->xdev_count++] = hands;
+			ubrh->hand_tracking.unobstructed.left = hands;
+			ubrh->hand_tracking.unobstructed.right = hands;
+		}
+	}
+
+	if (debug_get_bool_option_simulated_stress_body() && xsysd->xdev_count < XRT_SYSTEM_MAX_DEVICES) {
+		struct xrt_device *body = simulated_stress_create( //
+		    SIMULATED_STRESS_BODY,                         // kind
+		    0,                                             // index
+		    SIMULATED_STRESS_CAMERA_RATE,                  // rate_hz
+		    &body_center,                                  // center
+		    origin);                                       // origin
+		if (body != NULL) {
+			xsysd->xdevs[xsysd->xdev_count++] = body;
+			xsysd->static_roles.body = body;
+		}
+	}
+
+	int64_t tracker_count = debug_get_num_option_simulated_stress_trackers();
+	int64_t rate_hz = debug_get_num_option_simulated_stress_tracker_rate();
+	if (rate_hz <= 0) {
+		U_LOG_W("SIMULATED_STRESS_TRACKER_RATE must be positive, using 1000");
+		rate_hz = 1000;
+	}
+
+	for (int64_t i = 0; i < tracker_count; i++) {
+		if (xsysd->xdev_count >= XRT_SYSTEM_MAX_DEVICES) {
+			U_LOG_W("Only created %u of %u stress trackers, out of device slots", (uint32_t)i,
+			        (uint32_t)tracker_count);
+			break;
+		}
+
+		// Rows of eight trackers, 25cm apart.
+		struct xrt_pose center = XRT_POSE_IDENTITY;
+		center.position.x = ((float)(i % 8) - 3.5f) * 0.25f;
+		center.position.y = 0.5f + (float)(i / 8) * 0.25f;
+		center.position.z = -1.5f;
+
+		struct xrt_device *tracker = simulated_stress_create( //
+		    SIMULATED_STRESS_TRACKER,                         // kind
+		    (uint32_t)i,                                      // index
+		    (uint32_t)rate_hz,                                // rate_hz
+		    &center,                                          // center
+		    origin);                                          // origin
+		if (tracker == NULL) {
+			break;
+		}
+
+		xsysd->xdevs[xsysd->xdev_count++] = tracker;
+	}
+}
+
 
 /*
  *
@@ -127,6 +207,9 @@ simulated_open_system_impl(struct xrt_builder *xb,
 		xsysd->xdevs[xsysd->xdev_count++] = right;
 	}
 
+	// Only creates anything if any of the stress options are set.
+	create_stress_devices(xsysd, head->tracking_origin, ubrh);
+
 	// Assign to role(s).
 	ubrh->head = head;
 	ubrh->left = left;
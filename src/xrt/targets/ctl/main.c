@@ -7,7 +7,10 @@
  * @ingroup ipc
  */
 
+#include "os/os_time.h"
+
 #include "util/u_file.h"
+#include "util/u_time.h"
 
 #include "client/ipc_client.h"
 #include "client/ipc_client_connection.h"
@@ -31,6 +34,7 @@ typedef enum op_mode
 	MODE_RECENTER,
 	MODE_GET_BRIGHTNESS,
 	MODE_SET_BRIGHTNESS,
+	MODE_TOP,
 } op_mode_t;
 
 
@@ -92,6 +96,66 @@ get_mode(struct ipc_connection *ipc_c)
 	return 0;
 }
 
+int
+top_mode(struct ipc_connection *ipc_c)
+{
+	while (true) {
+		struct ipc_client_list clients;
+
+		xrt_result_t r = ipc_call_system_get_clients(ipc_c, &clients);
+		if (r != XRT_SUCCESS) {
+			PE("Failed to get client list.\n");
+			return 1;
+		}
+
+		// Clear the screen and move the cursor to the top left.
+		P("\033[H\033[2J");
+		P("%4s %8s %8s %8s %8s %10s %8s %8s %8s %6s  %s\n", //
+		  "id", "cpu", "draw", "gpu", "latency", "completed", "missed", "discard", "mem", "scale", "name");
+
+		for (uint32_t i = 0; i < clients.id_count; i++) {
+			uint32_t id = clients.ids[i];
+
+			struct ipc_app_state cs;
+			r = ipc_call_system_get_client_info(ipc_c, id, &cs);
+			if (r != XRT_SUCCESS) {
+				// The client might have gone away since we got the list.
+				continue;
+			}
+
+			struct xrt_compositor_frame_stats stats = {0};
+			r = ipc_call_system_get_client_frame_stats(ipc_c, id, &stats);
+			if (r == XRT_ERROR_MULTI_SESSION_NOT_IMPLEMENTED) {
+				PE("Frame statistics are not supported by this compositor.\n");
+				return 1;
+			}
+			if (r != XRT_SUCCESS) {
+				continue;
+			}
+
+			P("%4u %8.2f %8.2f %8.2f %8.2f %10" PRIu64 " %8" PRIu64 " %8" PRIu64 " %8.1f %6.2f  %s\n",
+			  id,                                                       //
+			  time_ns_to_ms_f(stats.cpu_time_ns),                        //
+			  time_ns_to_ms_f(stats.draw_time_ns),                       //
+			  time_ns_to_ms_f(stats.gpu_time_ns),                        //
+			  time_ns_to_ms_f(stats.latency_ns),                         //
+			  stats.completed_frame_count,                              //
+			  stats.missed_frame_count,                                 //
+			  stats.discarded_frame_count,                              //
+			  (double)cs.swapchain_memory_size / (1024.0 * 1024.0),     //
+			  (double)stats.resolution_scale,                           //
+			  cs.info.application_name);
+		}
+
+		P("\nTimes in ms, counters since session start, swapchain memory in MB, advised resolution scale.\n");
+		fflush(stdout);
+
+		os_nanosleep(U_TIME_1S_IN_NS);
+	}
+
+	return 0;
+}
+
 int
 set_primary(struct ipc_connection *ipc_c, int client_id)
 {
@@ -232,6 +296,7 @@ enum LongOptions
 	OPTION_DEVICE = 1,
 	OPTION_GET_BRIGHTNESS,
 	OPTION_SET_BRIGHTNESS,
+	OPTION_TOP,
 };
 
 int
@@ -249,6 +314,7 @@ main(int argc, char *argv[])
 	    {"device", required_argument, NULL, OPTION_DEVICE},
 	    {"get-brightness", no_argument, NULL, OPTION_GET_BRIGHTNESS},
 	    {"set-brightness", required_argument, NULL, OPTION_SET_BRIGHTNESS},
+	    {"top", no_argument, NULL, OPTION_TOP},
 	    {NULL, 0, NULL, 0},
 	};
 
@@ -282,6 +348,10 @@ main(int argc, char *argv[])
 			op_mode = MODE_SET_BRIGHTNESS;
 			break;
 		}
+		case OPTION_TOP: {
+			op_mode = MODE_TOP;
+			break;
+		}
 		case '?':
 			if (optopt == 's') {
 				PE("Option -s requires an id to set.\n");
@@ -295,6 +365,7 @@ main(int argc, char *argv[])
 				   "primary device\n");
 				PE("    --get-brightness: Get current display brightness in percent\n");
 				PE("    --set-brightness <[+-]brightness[%%]>: Set display brightness\n");
+				PE("    --top: Continuously show frame timing statistics of all clients\n");
 			} else {
 				PE("Option `\\x%x' unknown.\n", optopt);
 			}
@@ -324,6 +395,7 @@ main(int argc, char *argv[])
 	case MODE_RECENTER: exit(recenter_local_spaces(&ipc_c)); break;
 	case MODE_GET_BRIGHTNESS: exit(get_brightness(&ipc_c, device_val)); break;
 	case MODE_SET_BRIGHTNESS: exit(set_brightness(&ipc_c, device_val, brightness)); break;
+	case MODE_TOP: exit(top_mode(&ipc_c)); break;
 	default: P("Unrecognised operation mode.\n"); exit(1);
 	}
 
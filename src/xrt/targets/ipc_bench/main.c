@@ -0,0 +1,462 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Measures the round trip latency and throughput of IPC calls.
+ * @ingroup ipc
+ */
+
+#include "os/os_time.h"
+#include "os/os_threading.h"
+
+#include "util/u_misc.h"
+
+#include "client/ipc_client.h"
+#include "client/ipc_client_connection.h"
+
+#include "ipc_client_generated.h"
+#include "xrt/xrt_results.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define P(...) fprintf(stdout, __VA_ARGS__)
+#define PE(...) fprintf(stderr, __VA_ARGS__)
+
+#define MAX_CLIENTS IPC_MAX_CLIENTS
+#define NS_PER_US 1000.0
+
+
+/*
+ *
+ * Structs.
+ *
+ */
+
+/*!
+ * One synthetic client, has its own connection to the service.
+ */
+struct bench_client
+{
+	struct ipc_connection ipc_c;
+
+	struct os_thread thread;
+
+	//! Looked up at connection time, used as call arguments.
+	uint32_t root_space_id;
+	uint32_t device_id;
+	enum xrt_input_name pose_name;
+	uint32_t client_id;
+
+	//! The benchmark being run and where the samples go.
+	const struct bench *bench;
+	uint64_t *samples;
+	uint32_t sample_count;
+
+	uint32_t failures;
+};
+
+typedef xrt_result_t (*bench_func_t)(struct bench_client *bc);
+
+struct bench
+{
+	const char *name;
+	bench_func_t func;
+};
+
+struct options
+{
+	uint32_t client_count;
+	uint32_t iterations;
+	uint32_t warmup;
+	const char *filter;
+};
+
+
+/*
+ *
+ * Benchmarked calls, only ones without side effects on the service.
+ *
+ */
+
+static xrt_result_t
+bench_instance_get_shared_client_index(struct bench_client *bc)
+{
+	uint32_t index;
+	return ipc_call_instance_get_shared_client_index(&bc->ipc_c, &index);
+}
+
+static xrt_result_t
+bench_system_get_properties(struct bench_client *bc)
+{
+	struct xrt_system_properties properties;
+	return ipc_call_system_get_properties(&bc->ipc_c, &properties);
+}
+
+static xrt_result_t
+bench_system_get_clients(struct bench_client *bc)
+{
+	struct ipc_client_list clients;
+	return ipc_call_system_get_clients(&bc->ipc_c, &clients);
+}
+
+static xrt_result_t
+bench_system_get_client_info(struct bench_client *bc)
+{
+	struct ipc_app_state ias;
+	return ipc_call_system_get_client_info(&bc->ipc_c, bc->client_id, &ias);
+}
+
+static xrt_result_t
+bench_system_devices_get_roles(struct bench_client *bc)
+{
+	struct xrt_system_roles roles;
+	return ipc_call_system_devices_get_roles(&bc->ipc_c, &roles);
+}
+
+static xrt_result_t
+bench_space_get_tracking_origin_offset(struct bench_client *bc)
+{
+	struct xrt_pose offset;
+	return ipc_call_space_get_tracking_origin_offset(&bc->ipc_c, 0, &offset);
+}
+
+static xrt_result_t
+bench_space_locate_space(struct bench_client *bc)
+{
+	struct xrt_pose identity = XRT_POSE_IDENTITY;
+	struct xrt_space_relation relation;
+	return ipc_call_space_locate_space( //
+	    &bc->ipc_c,                     //
+	    bc->root_space_id,              //
+	    &identity,                      //
+	    os_monotonic_get_ns(),          //
+	    bc->root_space_id,              //
+	    &identity,                      //
+	    &relation);                     //
+}
+
+static xrt_result_t
+bench_space_locate_device(struct bench_client *bc)
+{
+	struct xrt_pose identity = XRT_POSE_IDENTITY;
+	struct xrt_space_relation relation;
+	return ipc_call_space_locate_device( //
+	    &bc->ipc_c,                      //
+	    bc->root_space_id,               //
+	    &identity,                       //
+	    os_monotonic_get_ns(),           //
+	    bc->device_id,                   //
+	    &relation);                      //
+}
+
+static xrt_result_t
+bench_device_update_input(struct bench_client *bc)
+{
+	return ipc_call_device_update_input(&bc->ipc_c, bc->device_id);
+}
+
+static xrt_result_t
+bench_device_get_tracked_pose(struct bench_client *bc)
+{
+	struct xrt_space_relation relation;
+	return ipc_call_device_get_tracked_pose( //
+	    &bc->ipc_c,                          //
+	    bc->device_id,                       //
+	    bc->pose_name,                       //
+	    os_monotonic_get_ns(),               //
+	    &relation);                          //
+}
+
+static xrt_result_t
+bench_device_get_battery_status(struct bench_client *bc)
+{
+	bool present, charging;
+	float charge;
+	ipc_call_device_get_battery_status(&bc->ipc_c, bc->device_id, &present, &charging, &charge);
+
+	// Not all devices support it, we only care about the round trip.
+	return XRT_SUCCESS;
+}
+
+/*!
+ * Async calls are only queued, so include the call that sends them to get the
+ * full cost.
+ */
+static xrt_result_t
+bench_space_mark_ref_space_in_use_async(struct bench_client *bc)
+{
+	xrt_result_t xret = ipc_call_space_mark_ref_space_in_use(&bc->ipc_c, XRT_SPACE_REFERENCE_TYPE_LOCAL);
+	if (xret != XRT_SUCCESS) {
+		return xret;
+	}
+
+	xret = ipc_call_space_unmark_ref_space_in_use(&bc->ipc_c, XRT_SPACE_REFERENCE_TYPE_LOCAL);
+	if (xret != XRT_SUCCESS) {
+		return xret;
+	}
+
+	return bench_instance_get_shared_client_index(bc);
+}
+
+#define BENCH(NAME) {#NAME, bench_##NAME}
+
+static const struct bench benches[] = {
+    BENCH(instance_get_shared_client_index),
+    BENCH(system_get_properties),
+    BENCH(system_get_clients),
+    BENCH(system_get_client_info),
+    BENCH(system_devices_get_roles),
+    BENCH(space_get_tracking_origin_offset),
+    BENCH(space_locate_space),
+    BENCH(space_locate_device),
+    BENCH(device_update_input),
+    BENCH(device_get_tracked_pose),
+    BENCH(device_get_battery_status),
+    BENCH(space_mark_ref_space_in_use_async),
+};
+
+#undef BENCH
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+static int
+compare_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static double
+percentile_us(const uint64_t *sorted, uint32_t count, double p)
+{
+	uint32_t index = (uint32_t)(p * (double)(count - 1) + 0.5);
+	return (double)sorted[index] / NS_PER_US;
+}
+
+static bool
+connect_client(struct bench_client *bc, uint32_t index)
+{
+	struct xrt_instance_info info = {0};
+	snprintf(info.app_info.application_name, sizeof(info.app_info.application_name), "monado-ipc-bench-%u", index);
+
+	xrt_result_t xret = ipc_client_connection_init(&bc->ipc_c, U_LOGGING_WARN, &info);
+	if (xret != XRT_SUCCESS) {
+		PE("Client %u failed to connect: %d\n", index, xret);
+		return false;
+	}
+
+	uint32_t view, local, local_floor, stage, unbounded;
+	xret = ipc_call_space_create_semantic_ids( //
+	    &bc->ipc_c,                            //
+	    &bc->root_space_id,                    //
+	    &view,                                 //
+	    &local,                                //
+	    &local_floor,                          //
+	    &stage,                                //
+	    &unbounded);                           //
+	if (xret != XRT_SUCCESS) {
+		PE("Client %u failed to get semantic spaces: %d\n", index, xret);
+		ipc_client_connection_fini(&bc->ipc_c);
+		return false;
+	}
+
+	// Any client id will do, the call costs the same.
+	struct ipc_client_list clients;
+	xret = ipc_call_system_get_clients(&bc->ipc_c, &clients);
+	if (xret == XRT_SUCCESS && clients.id_count > 0) {
+		bc->client_id = clients.ids[0];
+	}
+
+	// Use the first device with a pose input, normally the head.
+	struct ipc_shared_memory *ism = bc->ipc_c.ism;
+	bc->pose_name = XRT_INPUT_GENERIC_HEAD_POSE;
+	for (uint32_t i = 0; i < ism->isdev_count; i++) {
+		const struct ipc_shared_device *isdev = &ism->isdevs[i];
+		const struct xrt_input *inputs = &ipc_shared_inputs(ism)[isdev->first_input_index];
+
+		for (uint32_t k = 0; k < isdev->input_count; k++) {
+			if (XRT_GET_INPUT_TYPE(inputs[k].name) == XRT_INPUT_TYPE_POSE) {
+				bc->device_id = i;
+				bc->pose_name = inputs[k].name;
+				return true;
+			}
+		}
+	}
+
+	return true;
+}
+
+static void *
+client_thread(void *ptr)
+{
+	struct bench_client *bc = (struct bench_client *)ptr;
+
+	for (uint32_t i = 0; i < bc->sample_count; i++) {
+		uint64_t start_ns = os_monotonic_get_ns();
+		xrt_result_t xret = bc->bench->func(bc);
+		uint64_t end_ns = os_monotonic_get_ns();
+
+		if (xret != XRT_SUCCESS) {
+			bc->failures++;
+		}
+
+		bc->samples[i] = end_ns - start_ns;
+	}
+
+	return NULL;
+}
+
+static void
+run_bench(struct bench_client *clients, const struct options *opts, const struct bench *bench, uint64_t *samples)
+{
+	// Warm up caches and any lazily created state on the service.
+	for (uint32_t i = 0; i < opts->client_count; i++) {
+		for (uint32_t k = 0; k < opts->warmup; k++) {
+			bench->func(&clients[i]);
+		}
+	}
+
+	for (uint32_t i = 0; i < opts->client_count; i++) {
+		clients[i].bench = bench;
+		clients[i].samples = &samples[(size_t)i * opts->iterations];
+		clients[i].sample_count = opts->iterations;
+		clients[i].failures = 0;
+		os_thread_init(&clients[i].thread);
+	}
+
+	uint64_t start_ns = os_monotonic_get_ns();
+
+	uint32_t started = 0;
+	for (; started < opts->client_count; started++) {
+		if (os_thread_start(&clients[started].thread, client_thread, &clients[started]) != 0) {
+			PE("Failed to start thread %u\n", started);
+			break;
+		}
+	}
+
+	for (uint32_t i = 0; i < started; i++) {
+		os_thread_join(&clients[i].thread);
+		os_thread_destroy(&clients[i].thread);
+	}
+
+	uint64_t duration_ns = os_monotonic_get_ns() - start_ns;
+
+	uint32_t count = started * opts->iterations;
+	uint32_t failures = 0;
+	for (uint32_t i = 0; i < started; i++) {
+		failures += clients[i].failures;
+	}
+
+	if (count == 0) {
+		return;
+	}
+
+	qsort(samples, count, sizeof(*samples), compare_u64);
+
+	double calls_per_s = (double)count / ((double)duration_ns / (double)U_TIME_1S_IN_NS);
+
+	P("%-36s %10.2f %10.2f %10.2f %10.2f %12.0f %8u\n", //
+	  bench->name,                                      //
+	  percentile_us(samples, count, 0.5),               //
+	  percentile_us(samples, count, 0.99),              //
+	  percentile_us(samples, count, 0.999),             //
+	  (double)samples[count - 1] / NS_PER_US,           //
+	  calls_per_s,                                      //
+	  failures);                                        //
+}
+
+static void
+print_usage(void)
+{
+	PE("Usage: monado-ipc-bench [options]\n");
+	PE("    -c <count>: Number of synthetic clients, each on its own thread and connection (default 1)\n");
+	PE("    -n <count>: Number of calls per client for each benchmark (default 10000)\n");
+	PE("    -w <count>: Number of warm up calls per client (default 100)\n");
+	PE("    -b <name>:  Only run benchmarks whose name contains this\n");
+	PE("    -l:         List the benchmarks\n");
+	PE("Service side handler times are in the 'ipc' trace category, see XRT_TRACING.\n");
+}
+
+
+/*
+ *
+ * Main.
+ *
+ */
+
+int
+main(int argc, char *argv[])
+{
+	struct options opts = {
+	    .client_count = 1,
+	    .iterations = 10000,
+	    .warmup = 100,
+	    .filter = NULL,
+	};
+
+	int c;
+	while ((c = getopt(argc, argv, "c:n:w:b:lh")) != -1) {
+		switch (c) {
+		case 'c': opts.client_count = (uint32_t)atoi(optarg); break;
+		case 'n': opts.iterations = (uint32_t)atoi(optarg); break;
+		case 'w': opts.warmup = (uint32_t)atoi(optarg); break;
+		case 'b': opts.filter = optarg; break;
+		case 'l':
+			for (size_t i = 0; i < ARRAY_SIZE(benches); i++) {
+				P("%s\n", benches[i].name);
+			}
+			return 0;
+		case 'h': print_usage(); return 0;
+		default: print_usage(); return 1;
+		}
+	}
+
+	if (opts.client_count == 0 || opts.client_count > MAX_CLIENTS || opts.iterations == 0) {
+		PE("Client count must be between 1 and %u, and iterations more than 0.\n", MAX_CLIENTS);
+		return 1;
+	}
+
+	struct bench_client *clients = U_TYPED_ARRAY_CALLOC(struct bench_client, opts.client_count);
+	uint64_t *samples = U_TYPED_ARRAY_CALLOC(uint64_t, (size_t)opts.client_count * opts.iterations);
+	int ret = 0;
+
+	uint32_t connected = 0;
+	for (; connected < opts.client_count; connected++) {
+		if (!connect_client(&clients[connected], connected)) {
+			// Already cleaned up and logged.
+			ret = 1;
+			goto out;
+		}
+	}
+
+	P("%u client(s), %u calls per client, latency in microseconds\n\n", opts.client_count, opts.iterations);
+	P("%-36s %10s %10s %10s %10s %12s %8s\n", "call", "p50", "p99", "p99.9", "max", "calls/s", "failed");
+
+	for (size_t i = 0; i < ARRAY_SIZE(benches); i++) {
+		if (opts.filter != NULL && strstr(benches[i].name, opts.filter) == NULL) {
+			continue;
+		}
+
+		run_bench(clients, &opts, &benches[i], samples);
+	}
+
+out:
+	for (uint32_t i = 0; i < connected; i++) {
+		ipc_client_connection_fini(&clients[i].ipc_c);
+	}
+
+	free(samples);
+	free(clients);
+
+	return ret;
+}
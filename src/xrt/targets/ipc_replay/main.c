@@ -0,0 +1,547 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief  Replays a recorded IPC session against the service.
+ * @ingroup ipc
+ */
+
+#include "os/os_time.h"
+
+#include "util/u_misc.h"
+#include "util/u_handles.h"
+
+#include "shared/ipc_record.h"
+
+#include "client/ipc_client.h"
+#include "client/ipc_client_connection.h"
+
+#include "ipc_client_generated.h"
+#include "xrt/xrt_results.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define P(...) fprintf(stdout, __VA_ARGS__)
+#define PE(...) fprintf(stderr, __VA_ARGS__)
+
+//! Same limits as the service puts on each client.
+#define MAX_SPACES 128
+#define MAX_SWAPCHAINS (XRT_MAX_LAYERS * 2)
+
+//! Big enough for a layer sync with every layer used.
+#define MAX_RECORD_SIZE (sizeof(struct ipc_record_layer_sync) + sizeof(struct ipc_layer_entry) * IPC_MAX_LAYERS)
+
+
+/*
+ *
+ * Structs.
+ *
+ */
+
+struct options
+{
+	const char *path;
+	uint32_t loops;
+	bool fast;
+};
+
+/*!
+ * State of one replay, the ids the service hands out during the replay might
+ * differ from the recorded ones so they are remapped.
+ */
+struct replay
+{
+	struct ipc_connection ipc_c;
+	const struct options *opts;
+
+	uint32_t space_map[MAX_SPACES];
+	uint32_t swapchain_map[MAX_SWAPCHAINS];
+
+	//! Frame the service last predicted, recorded frame ids are replaced by it.
+	int64_t frame_id;
+	int64_t wake_up_time_ns;
+
+	//! Recorded and replayed time of the last woke, the calls in a frame keep their recorded timing from it.
+	int64_t recorded_woke_ns;
+	int64_t replayed_woke_ns;
+
+	//! Where the next layer sync is written, starts out as our shared client index.
+	uint32_t slot_id;
+
+	//! Statistics.
+	uint64_t frame_count;
+	uint64_t call_count;
+	uint64_t failure_count;
+	uint64_t skip_count;
+	int64_t first_frame_ns;
+	int64_t last_frame_ns;
+};
+
+
+/*
+ *
+ * Helpers.
+ *
+ */
+
+static void
+reset_maps(struct replay *r)
+{
+	for (uint32_t i = 0; i < ARRAY_SIZE(r->space_map); i++) {
+		r->space_map[i] = UINT32_MAX;
+	}
+	for (uint32_t i = 0; i < ARRAY_SIZE(r->swapchain_map); i++) {
+		r->swapchain_map[i] = UINT32_MAX;
+	}
+}
+
+static void
+map_space(struct replay *r, uint32_t recorded, uint32_t replayed)
+{
+	if (recorded < ARRAY_SIZE(r->space_map)) {
+		r->space_map[recorded] = replayed;
+	}
+}
+
+static bool
+lookup_space(struct replay *r, uint32_t recorded, uint32_t *out_id)
+{
+	if (recorded >= ARRAY_SIZE(r->space_map) || r->space_map[recorded] == UINT32_MAX) {
+		return false;
+	}
+
+	*out_id = r->space_map[recorded];
+
+	return true;
+}
+
+static bool
+lookup_swapchain(struct replay *r, uint32_t recorded, uint32_t *out_id)
+{
+	if (recorded >= ARRAY_SIZE(r->swapchain_map) || r->swapchain_map[recorded] == UINT32_MAX) {
+		return false;
+	}
+
+	*out_id = r->swapchain_map[recorded];
+
+	return true;
+}
+
+//! Keep the recorded spacing of the calls made within a frame.
+static void
+wait_for_recorded_time(struct replay *r, int64_t recorded_ns)
+{
+	if (r->opts->fast || r->recorded_woke_ns == 0 || recorded_ns <= r->recorded_woke_ns) {
+		return;
+	}
+
+	int64_t target_ns = r->replayed_woke_ns + (recorded_ns - r->recorded_woke_ns);
+	int64_t now_ns = os_monotonic_get_ns();
+	if (target_ns > now_ns) {
+		os_nanosleep(target_ns - now_ns);
+	}
+}
+
+static void
+check(struct replay *r, xrt_result_t xret, const char *what)
+{
+	r->call_count++;
+
+	if (xret != XRT_SUCCESS) {
+		r->failure_count++;
+		PE("%s failed: %d\n", what, xret);
+	}
+}
+
+
+/*
+ *
+ * Replaying.
+ *
+ */
+
+static void
+replay_semantic_ids(struct replay *r, const struct ipc_record_semantic_ids *rec)
+{
+	struct ipc_record_semantic_ids ids;
+	xrt_result_t xret = ipc_call_space_create_semantic_ids( //
+	    &r->ipc_c,                                          //
+	    &ids.root_id,                                       //
+	    &ids.view_id,                                       //
+	    &ids.local_id,                                      //
+	    &ids.local_floor_id,                                //
+	    &ids.stage_id,                                      //
+	    &ids.unbounded_id);                                 //
+	check(r, xret, "space_create_semantic_ids");
+	if (xret != XRT_SUCCESS) {
+		return;
+	}
+
+	map_space(r, rec->root_id, ids.root_id);
+	map_space(r, rec->view_id, ids.view_id);
+	map_space(r, rec->local_id, ids.local_id);
+	map_space(r, rec->local_floor_id, ids.local_floor_id);
+	map_space(r, rec->stage_id, ids.stage_id);
+	map_space(r, rec->unbounded_id, ids.unbounded_id);
+}
+
+static void
+replay_create_offset(struct replay *r, const struct ipc_record_space_create_offset *rec)
+{
+	uint32_t parent_id, id;
+	if (!lookup_space(r, rec->parent_id, &parent_id)) {
+		r->skip_count++;
+		return;
+	}
+
+	xrt_result_t xret = ipc_call_space_create_offset(&r->ipc_c, parent_id, &rec->offset, &id);
+	check(r, xret, "space_create_offset");
+	if (xret == XRT_SUCCESS) {
+		map_space(r, rec->id, id);
+	}
+}
+
+static void
+replay_create_pose(struct replay *r, const struct ipc_record_space_create_pose *rec)
+{
+	uint32_t id;
+	xrt_result_t xret = ipc_call_space_create_pose(&r->ipc_c, rec->xdev_id, rec->name, &id);
+	check(r, xret, "space_create_pose");
+	if (xret == XRT_SUCCESS) {
+		map_space(r, rec->id, id);
+	}
+}
+
+static void
+replay_space_destroy(struct replay *r, const struct ipc_record_space *rec)
+{
+	uint32_t id;
+	if (!lookup_space(r, rec->id, &id)) {
+		r->skip_count++;
+		return;
+	}
+
+	check(r, ipc_call_space_destroy(&r->ipc_c, id), "space_destroy");
+	r->space_map[rec->id] = UINT32_MAX;
+}
+
+static void
+replay_locate_space(struct replay *r, const struct ipc_record_locate_space *rec)
+{
+	uint32_t base_id, id;
+	if (!lookup_space(r, rec->base_space_id, &base_id) || !lookup_space(r, rec->space_id, &id)) {
+		r->skip_count++;
+		return;
+	}
+
+	struct xrt_space_relation relation;
+	xrt_result_t xret = ipc_call_space_locate_space( //
+	    &r->ipc_c,                                   //
+	    base_id,                                     //
+	    &rec->base_offset,                           //
+	    os_monotonic_get_ns() + rec->at_delta_ns,    //
+	    id,                                          //
+	    &rec->offset,                                //
+	    &relation);                                  //
+	check(r, xret, "space_locate_space");
+}
+
+static void
+replay_locate_device(struct replay *r, const struct ipc_record_locate_device *rec)
+{
+	uint32_t base_id;
+	if (!lookup_space(r, rec->base_space_id, &base_id)) {
+		r->skip_count++;
+		return;
+	}
+
+	struct xrt_space_relation relation;
+	xrt_result_t xret = ipc_call_space_locate_device( //
+	    &r->ipc_c,                                    //
+	    base_id,                                      //
+	    &rec->base_offset,                            //
+	    os_monotonic_get_ns() + rec->at_delta_ns,     //
+	    rec->xdev_id,                                 //
+	    &relation);                                   //
+	check(r, xret, "space_locate_device");
+}
+
+static void
+replay_predict_frame(struct replay *r)
+{
+	int64_t predicted_display_time_ns, predicted_display_period_ns;
+	xrt_result_t xret = ipc_call_compositor_predict_frame( //
+	    &r->ipc_c,                                         //
+	    &r->frame_id,                                      //
+	    &r->wake_up_time_ns,                               //
+	    &predicted_display_time_ns,                        //
+	    &predicted_display_period_ns);                     //
+	check(r, xret, "compositor_predict_frame");
+	if (xret != XRT_SUCCESS) {
+		return;
+	}
+
+	// Like the client compositor, sleep until the service wants us to wake up.
+	int64_t now_ns = os_monotonic_get_ns();
+	if (r->wake_up_time_ns > now_ns) {
+		os_nanosleep(r->wake_up_time_ns - now_ns);
+	}
+}
+
+static void
+replay_wait_woke(struct replay *r, int64_t recorded_ns)
+{
+	check(r, ipc_call_compositor_wait_woke(&r->ipc_c, r->frame_id), "compositor_wait_woke");
+
+	r->recorded_woke_ns = recorded_ns;
+	r->replayed_woke_ns = os_monotonic_get_ns();
+}
+
+static void
+replay_layer_sync(struct replay *r, const struct ipc_record_layer_sync *rec)
+{
+	const struct ipc_layer_entry *layers = (const struct ipc_layer_entry *)(rec + 1);
+	struct ipc_layer_slot *slot = &ipc_shared_slots(r->ipc_c.ism)[r->slot_id];
+
+	slot->data = rec->data;
+	slot->data.frame_id = r->frame_id;
+	slot->data.pose_sample_time_ns = 0; // No poses are sampled when replaying.
+	slot->layer_count = 0;
+
+	for (uint32_t i = 0; i < rec->layer_count && i < IPC_MAX_LAYERS; i++) {
+		struct ipc_layer_entry entry = layers[i];
+
+		// The images are never written, the service just composites whatever is in them.
+		bool ok = true;
+		for (uint32_t k = 0; k < ARRAY_SIZE(entry.swapchain_ids); k++) {
+			uint32_t *id = &entry.swapchain_ids[k];
+			if (*id != UINT32_MAX && !lookup_swapchain(r, *id, id)) {
+				ok = false;
+			}
+		}
+
+		if (!ok) {
+			r->skip_count++;
+			continue;
+		}
+
+		slot->layers[slot->layer_count++] = entry;
+	}
+
+	xrt_result_t xret = ipc_call_compositor_layer_sync(&r->ipc_c, r->slot_id, NULL, 0, &r->slot_id);
+	check(r, xret, "compositor_layer_sync");
+
+	int64_t now_ns = os_monotonic_get_ns();
+	if (r->frame_count == 0) {
+		r->first_frame_ns = now_ns;
+	}
+	r->last_frame_ns = now_ns;
+	r->frame_count++;
+}
+
+static void
+replay_swapchain_create(struct replay *r, const struct ipc_record_swapchain_create *rec)
+{
+	xrt_graphics_buffer_handle_t handles[XRT_MAX_SWAPCHAIN_IMAGES];
+	uint32_t id, image_count;
+	uint64_t size;
+	bool use_dedicated_allocation;
+
+	xrt_result_t xret = ipc_call_swapchain_create( //
+	    &r->ipc_c,                                 //
+	    &rec->info,                                //
+	    &id,                                       //
+	    &image_count,                              //
+	    &size,                                     //
+	    &use_dedicated_allocation,                 //
+	    handles,                                   //
+	    XRT_MAX_SWAPCHAIN_IMAGES);                 //
+	check(r, xret, "swapchain_create");
+	if (xret != XRT_SUCCESS) {
+		return;
+	}
+
+	// Dummy content, we never touch the images.
+	for (uint32_t i = 0; i < image_count; i++) {
+		u_graphics_buffer_unref(&handles[i]);
+	}
+
+	if (rec->id < ARRAY_SIZE(r->swapchain_map)) {
+		r->swapchain_map[rec->id] = id;
+	}
+}
+
+static void
+replay_record(struct replay *r, const struct ipc_record_header *header, const void *data)
+{
+	uint32_t id;
+
+#define PAYLOAD(TYPE) ((const struct TYPE *)data)
+#define SWAPCHAIN_OR_SKIP(ID)                                                                                          \
+	if (!lookup_swapchain(r, ID, &id)) {                                                                           \
+		r->skip_count++;                                                                                       \
+		break;                                                                                                 \
+	}
+
+	switch ((enum ipc_record_type)header->type) {
+	case IPC_RECORD_SESSION_CREATE:
+		check(r,
+		      ipc_call_session_create(&r->ipc_c, &PAYLOAD(ipc_record_session_create)->xsi,
+		                              PAYLOAD(ipc_record_session_create)->create_native_compositor),
+		      "session_create");
+		break;
+	case IPC_RECORD_SESSION_BEGIN: check(r, ipc_call_session_begin(&r->ipc_c), "session_begin"); break;
+	case IPC_RECORD_SESSION_END: check(r, ipc_call_session_end(&r->ipc_c), "session_end"); break;
+	case IPC_RECORD_SESSION_DESTROY: check(r, ipc_call_session_destroy(&r->ipc_c), "session_destroy"); break;
+	case IPC_RECORD_SPACE_CREATE_SEMANTIC_IDS: replay_semantic_ids(r, PAYLOAD(ipc_record_semantic_ids)); break;
+	case IPC_RECORD_SPACE_CREATE_OFFSET: replay_create_offset(r, PAYLOAD(ipc_record_space_create_offset)); break;
+	case IPC_RECORD_SPACE_CREATE_POSE: replay_create_pose(r, PAYLOAD(ipc_record_space_create_pose)); break;
+	case IPC_RECORD_SPACE_DESTROY: replay_space_destroy(r, PAYLOAD(ipc_record_space)); break;
+	case IPC_RECORD_SPACE_LOCATE_SPACE: replay_locate_space(r, PAYLOAD(ipc_record_locate_space)); break;
+	case IPC_RECORD_SPACE_LOCATE_DEVICE: replay_locate_device(r, PAYLOAD(ipc_record_locate_device)); break;
+	case IPC_RECORD_PREDICT_FRAME: replay_predict_frame(r); break;
+	case IPC_RECORD_WAIT_WOKE: replay_wait_woke(r, header->timestamp_ns); break;
+	case IPC_RECORD_BEGIN_FRAME:
+		check(r, ipc_call_compositor_begin_frame(&r->ipc_c, r->frame_id), "compositor_begin_frame");
+		break;
+	case IPC_RECORD_DISCARD_FRAME:
+		check(r, ipc_call_compositor_discard_frame(&r->ipc_c, r->frame_id), "compositor_discard_frame");
+		break;
+	case IPC_RECORD_LAYER_SYNC: replay_layer_sync(r, PAYLOAD(ipc_record_layer_sync)); break;
+	case IPC_RECORD_SWAPCHAIN_CREATE: replay_swapchain_create(r, PAYLOAD(ipc_record_swapchain_create)); break;
+	case IPC_RECORD_SWAPCHAIN_DESTROY:
+		SWAPCHAIN_OR_SKIP(PAYLOAD(ipc_record_swapchain)->id);
+		check(r, ipc_call_swapchain_destroy(&r->ipc_c, id), "swapchain_destroy");
+		r->swapchain_map[PAYLOAD(ipc_record_swapchain)->id] = UINT32_MAX;
+		break;
+	case IPC_RECORD_SWAPCHAIN_WAIT_IMAGE:
+		SWAPCHAIN_OR_SKIP(PAYLOAD(ipc_record_swapchain_wait_image)->id);
+		check(r,
+		      ipc_call_swapchain_wait_image(&r->ipc_c, id, PAYLOAD(ipc_record_swapchain_wait_image)->timeout_ns,
+		                                    PAYLOAD(ipc_record_swapchain_wait_image)->index),
+		      "swapchain_wait_image");
+		break;
+	case IPC_RECORD_SWAPCHAIN_RELEASE_IMAGE:
+		SWAPCHAIN_OR_SKIP(PAYLOAD(ipc_record_swapchain_image)->id);
+		check(r,
+		      ipc_call_swapchain_release_image(&r->ipc_c, id, PAYLOAD(ipc_record_swapchain_image)->index),
+		      "swapchain_release_image");
+		break;
+	default: PE("Unknown record type %u, skipping\n", header->type); break;
+	}
+
+#undef SWAPCHAIN_OR_SKIP
+#undef PAYLOAD
+}
+
+static bool
+replay_file(struct replay *r)
+{
+	FILE *file = NULL;
+	xrt_result_t xret = ipc_record_reader_open(r->opts->path, &file);
+	if (xret != XRT_SUCCESS) {
+		return false;
+	}
+
+	// Aligned for the payload structs.
+	static uint64_t buffer[MAX_RECORD_SIZE / sizeof(uint64_t) + 1];
+	struct ipc_record_header header;
+
+	while (ipc_record_read(file, &header, buffer, sizeof(buffer))) {
+		wait_for_recorded_time(r, header.timestamp_ns);
+		replay_record(r, &header, buffer);
+	}
+
+	fclose(file);
+
+	return true;
+}
+
+static void
+print_usage(void)
+{
+	PE("Usage: monado-ipc-replay [options] <recording>\n");
+	PE("    -n <count>: Replay the recording this many times (default 1)\n");
+	PE("    -f:         Don't keep the recorded timing of the calls within a frame\n");
+	PE("Record a client by starting the service with IPC_RECORD=<directory>.\n");
+}
+
+
+/*
+ *
+ * Main.
+ *
+ */
+
+int
+main(int argc, char *argv[])
+{
+	struct options opts = {
+	    .loops = 1,
+	};
+
+	int c;
+	while ((c = getopt(argc, argv, "n:fh")) != -1) {
+		switch (c) {
+		case 'n': opts.loops = (uint32_t)strtoul(optarg, NULL, 10); break;
+		case 'f': opts.fast = true; break;
+		case 'h':
+		default: print_usage(); return c == 'h' ? 0 : 1;
+		}
+	}
+
+	if (optind != argc - 1 || opts.loops == 0) {
+		print_usage();
+		return 1;
+	}
+	opts.path = argv[optind];
+
+	int ret = 0;
+	for (uint32_t loop = 0; loop < opts.loops; loop++) {
+		struct replay *r = U_TYPED_CALLOC(struct replay);
+		r->opts = &opts;
+		reset_maps(r);
+
+		struct xrt_instance_info info = {0};
+		snprintf(info.app_info.application_name, sizeof(info.app_info.application_name), "monado-ipc-replay");
+
+		xrt_result_t xret = ipc_client_connection_init(&r->ipc_c, U_LOGGING_WARN, &info);
+		if (xret != XRT_SUCCESS) {
+			PE("Failed to connect: %d\n", xret);
+			free(r);
+			return 1;
+		}
+
+		// Each client has its own slot in the shared memory.
+		r->slot_id = r->ipc_c.shared_client_index;
+
+		if (!replay_file(r)) {
+			ret = 1;
+		}
+
+		double duration_s = (double)(r->last_frame_ns - r->first_frame_ns) / (double)U_TIME_1S_IN_NS;
+		double fps = r->frame_count > 1 && duration_s > 0 ? (double)(r->frame_count - 1) / duration_s : 0;
+
+		P("Loop %u: %" PRIu64 " frames at %.2f fps, %" PRIu64 " calls, %" PRIu64 " failed, %" PRIu64
+		  " skipped\n",
+		  loop + 1,         //
+		  r->frame_count,   //
+		  fps,              //
+		  r->call_count,    //
+		  r->failure_count, //
+		  r->skip_count);   //
+
+		if (r->failure_count > 0) {
+			ret = 1;
+		}
+
+		ipc_client_connection_fini(&r->ipc_c);
+		free(r);
+	}
+
+	return ret;
+}
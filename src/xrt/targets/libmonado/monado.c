@@ -1,4 +1,4 @@
-// Copyright 2019-2024, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -24,6 +24,7 @@
 #include "ipc_client_generated.h"
 
 #include <limits.h>
+#include <string.h>
 #include <stdint.h>
 #include <assert.h>
 
@@ -249,6 +250,77 @@ mnd_root_get_client_state(mnd_root_t *root, uint32_t client_id, uint32_t *out_fl
 	return MND_SUCCESS;
 }
 
+mnd_result_t
+mnd_root_get_client_frame_stats(mnd_root_t *root, uint32_t client_id, mnd_client_frame_stats_t *out_stats)
+{
+	CHECK_NOT_NULL(root);
+	CHECK_CLIENT_ID(client_id);
+	CHECK_NOT_NULL(out_stats);
+
+	struct xrt_compositor_frame_stats stats = {0};
+	xrt_result_t xret = ipc_call_system_get_client_frame_stats(&root->ipc_c, client_id, &stats);
+	switch (xret) {
+	case XRT_SUCCESS: break;
+	case XRT_ERROR_MULTI_SESSION_NOT_IMPLEMENTED:
+		PE("Frame statistics are not supported by this compositor");
+		return MND_ERROR_UNSUPPORTED_OPERATION;
+	case XRT_ERROR_IPC_FAILURE: PE("Connection error!"); return MND_ERROR_OPERATION_FAILED;
+	default: PE("Failed to get frame stats for client id: %u.", client_id); return MND_ERROR_OPERATION_FAILED;
+	}
+
+	out_stats->cpu_time_ns = stats.cpu_time_ns;
+	out_stats->draw_time_ns = stats.draw_time_ns;
+	out_stats->gpu_time_ns = stats.gpu_time_ns;
+	out_stats->latency_ns = stats.latency_ns;
+	out_stats->completed_frame_count = stats.completed_frame_count;
+	out_stats->missed_frame_count = stats.missed_frame_count;
+	out_stats->discarded_frame_count = stats.discarded_frame_count;
+
+	return MND_SUCCESS;
+}
+
+mnd_result_t
+mnd_root_get_client_resolution_scale(mnd_root_t *root, uint32_t client_id, float *out_scale)
+{
+	CHECK_NOT_NULL(root);
+	CHECK_CLIENT_ID(client_id);
+	CHECK_NOT_NULL(out_scale);
+
+	struct xrt_compositor_frame_stats stats = {0};
+	xrt_result_t xret = ipc_call_system_get_client_frame_stats(&root->ipc_c, client_id, &stats);
+	switch (xret) {
+	case XRT_SUCCESS: break;
+	case XRT_ERROR_MULTI_SESSION_NOT_IMPLEMENTED:
+		PE("Resolution scale is not supported by this compositor");
+		return MND_ERROR_UNSUPPORTED_OPERATION;
+	case XRT_ERROR_IPC_FAILURE: PE("Connection error!"); return MND_ERROR_OPERATION_FAILED;
+	default: PE("Failed to get resolution scale for client id: %u.", client_id); return MND_ERROR_OPERATION_FAILED;
+	}
+
+	*out_scale = stats.resolution_scale;
+
+	return MND_SUCCESS;
+}
+
+mnd_result_t
+mnd_root_get_client_memory_stats(mnd_root_t *root, uint32_t client_id, mnd_client_memory_stats_t *out_stats)
+{
+	CHECK_NOT_NULL(root);
+	CHECK_CLIENT_ID(client_id);
+	CHECK_NOT_NULL(out_stats);
+
+	mnd_result_t mret = get_client_info(root, client_id);
+	if (mret < 0) {
+		return mret; // Prints error.
+	}
+
+	out_stats->swapchain_memory_size = root->app_state.swapchain_memory_size;
+	out_stats->swapchain_count = root->app_state.swapchain_count;
+	out_stats->semaphore_count = root->app_state.semaphore_count;
+
+	return MND_SUCCESS;
+}
+
 mnd_result_t
 mnd_root_set_client_primary(mnd_root_t *root, uint32_t client_id)
 {
@@ -652,3 +724,52 @@ mnd_root_set_device_brightness(mnd_root_t *root, uint32_t device_index, float br
 	default: PE("Internal error, shouldn't get here"); return MND_ERROR_OPERATION_FAILED;
 	}
 }
+
+mnd_result_t
+mnd_root_get_lock_stats_count(mnd_root_t *root, uint32_t *out_count)
+{
+	CHECK_NOT_NULL(root);
+	CHECK_NOT_NULL(out_count);
+
+	struct ipc_lock_stats ils = {0};
+	xrt_result_t xret = ipc_call_system_get_lock_stats(&root->ipc_c, 0, &ils);
+	if (xret != XRT_SUCCESS) {
+		PE("Failed to get lock stats count.");
+		return MND_ERROR_OPERATION_FAILED;
+	}
+
+	*out_count = ils.count;
+
+	return MND_SUCCESS;
+}
+
+mnd_result_t
+mnd_root_get_lock_stats(mnd_root_t *root, uint32_t index, mnd_lock_stats_t *out_stats)
+{
+	CHECK_NOT_NULL(root);
+	CHECK_NOT_NULL(out_stats);
+
+	struct ipc_lock_stats ils = {0};
+	xrt_result_t xret = ipc_call_system_get_lock_stats(&root->ipc_c, index, &ils);
+	if (xret != XRT_SUCCESS) {
+		PE("Failed to get lock stats for index: %u.", index);
+		return MND_ERROR_OPERATION_FAILED;
+	}
+
+	if (index >= ils.count) {
+		PE("Invalid lock stats index (%u)", index);
+		return MND_ERROR_INVALID_VALUE;
+	}
+
+	const struct os_lock_stats *stats = &ils.stats;
+	static_assert(sizeof(out_stats->name) == sizeof(stats->name), "Lock name sizes differ");
+	memcpy(out_stats->name, stats->name, sizeof(out_stats->name));
+	out_stats->lock_count = stats->lock_count;
+	out_stats->contended_count = stats->contended_count;
+	out_stats->wait_total_ns = stats->wait_total_ns;
+	out_stats->wait_max_ns = stats->wait_max_ns;
+	out_stats->hold_total_ns = stats->hold_total_ns;
+	out_stats->hold_max_ns = stats->hold_max_ns;
+
+	return MND_SUCCESS;
+}
@@ -1,4 +1,4 @@
-// Copyright 2019-2023, Collabora, Ltd.
+// Copyright 2019-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -25,9 +25,9 @@ extern "C" {
 //! Major version of the API.
 #define MND_API_VERSION_MAJOR 1
 //! Minor version of the API.
-#define MND_API_VERSION_MINOR 5
+#define MND_API_VERSION_MINOR 9
 //! Patch version of the API.
-#define MND_API_VERSION_PATCH 1
+#define MND_API_VERSION_PATCH 0
 
 /*!
  * Result codes for operations, negative are errors, zero or positives are
@@ -116,6 +116,70 @@ typedef enum mnd_reference_space_type
 	MND_SPACE_REFERENCE_TYPE_UNBOUNDED,
 } mnd_reference_space_type_t;
 
+/*!
+ * Frame timing statistics of a client, the times are smoothed over the last
+ * frames and the counters are totals since the session started.
+ *
+ * Supported in version 1.6 and above.
+ */
+typedef struct mnd_client_frame_stats
+{
+	//! Time the app spends between waking up from wait frame and begin frame.
+	int64_t cpu_time_ns;
+	//! Time the app spends between begin frame and end frame.
+	int64_t draw_time_ns;
+	//! Time between end frame and the app's GPU work completing.
+	int64_t gpu_time_ns;
+	//! Time from waking up from wait frame to the predicted display time.
+	int64_t latency_ns;
+	//! Number of frames the app completed.
+	uint64_t completed_frame_count;
+	//! Number of completed frames that missed their predicted display time.
+	uint64_t missed_frame_count;
+	//! Number of frames the app discarded.
+	uint64_t discarded_frame_count;
+} mnd_client_frame_stats_t;
+
+/*!
+ * Graphics resources a client has alive in the service.
+ *
+ * Supported in version 1.7 and above.
+ */
+typedef struct mnd_client_memory_stats
+{
+	//! Memory used by the images of all of the client's swapchains, in bytes.
+	uint64_t swapchain_memory_size;
+	//! Number of swapchains the client has created and not destroyed.
+	uint32_t swapchain_count;
+	//! Number of compositor semaphores the client has created and not destroyed.
+	uint32_t semaphore_count;
+} mnd_client_memory_stats_t;
+
+/*!
+ * Wait and hold times of the locks in the service that share a name, only
+ * collected when the service is built with XRT_FEATURE_LOCK_PROFILING. The
+ * counters are totals since the first lock with the name was taken.
+ *
+ * Supported in version 1.9 and above.
+ */
+typedef struct mnd_lock_stats
+{
+	//! Name given to the locks.
+	char name[64];
+	//! Number of times one of the locks was taken.
+	uint64_t lock_count;
+	//! How many of those had to wait for another thread to release it.
+	uint64_t contended_count;
+	//! Total time spent waiting on contended locks.
+	uint64_t wait_total_ns;
+	//! Longest single wait.
+	uint64_t wait_max_ns;
+	//! Total time the locks were held.
+	uint64_t hold_total_ns;
+	//! Longest time a lock was held at once.
+	uint64_t hold_max_ns;
+} mnd_lock_stats_t;
+
 /*
  *
  * Functions
@@ -220,6 +284,60 @@ mnd_root_get_client_name(mnd_root_t *root, uint32_t client_id, const char **out_
 mnd_result_t
 mnd_root_get_client_state(mnd_root_t *root, uint32_t client_id, uint32_t *out_flags);
 
+/*!
+ * Get the frame timing statistics of the client with the given ID, all values
+ * are zero if the client hasn't created a session yet.
+ *
+ * Supported in version 1.6 and above.
+ *
+ * @param root           The libmonado state.
+ * @param client_id      ID of client to retrieve statistics from.
+ * @param[out] out_stats Pointer to populate with the statistics.
+ *
+ * @pre Called @ref mnd_root_update_client_list at least once
+ *
+ * @return MND_SUCCESS on success
+ */
+mnd_result_t
+mnd_root_get_client_frame_stats(mnd_root_t *root, uint32_t client_id, mnd_client_frame_stats_t *out_stats);
+
+/*!
+ * Get the swapchain memory and other graphics resources used by the client
+ * with the given ID, all values are zero if the client hasn't created a
+ * session yet.
+ *
+ * Supported in version 1.7 and above.
+ *
+ * @param root           The libmonado state.
+ * @param client_id      ID of client to retrieve statistics from.
+ * @param[out] out_stats Pointer to populate with the statistics.
+ *
+ * @pre Called @ref mnd_root_update_client_list at least once
+ *
+ * @return MND_SUCCESS on success
+ */
+mnd_result_t
+mnd_root_get_client_memory_stats(mnd_root_t *root, uint32_t client_id, mnd_client_memory_stats_t *out_stats);
+
+/*!
+ * Get the scale of the recommended render resolution the compositor advises
+ * for the client with the given ID. It is 1 while there is GPU headroom and
+ * goes down when the client's and the compositor's GPU work doesn't fit in
+ * the frame, the app follows it by rendering to a smaller image rect.
+ *
+ * Supported in version 1.8 and above.
+ *
+ * @param root           The libmonado state.
+ * @param client_id      ID of client to retrieve the scale for.
+ * @param[out] out_scale Pointer to populate with the scale.
+ *
+ * @pre Called @ref mnd_root_update_client_list at least once
+ *
+ * @return MND_SUCCESS on success
+ */
+mnd_result_t
+mnd_root_get_client_resolution_scale(mnd_root_t *root, uint32_t client_id, float *out_scale);
+
 /*!
  * Set the client at the given index as "primary".
  *
@@ -526,6 +644,35 @@ mnd_root_get_device_brightness(mnd_root_t *root, uint32_t device_index, float *o
 mnd_result_t
 mnd_root_set_device_brightness(mnd_root_t *root, uint32_t device_index, float brightness, bool relative);
 
+/*!
+ * Get the number of lock names the service has statistics for, this is zero
+ * if the service was built without XRT_FEATURE_LOCK_PROFILING. More names can
+ * show up over time, but they are never removed.
+ *
+ * Supported in version 1.9 and above.
+ *
+ * @param root           The libmonado state.
+ * @param[out] out_count Pointer to populate with the number of lock names.
+ *
+ * @return MND_SUCCESS on success
+ */
+mnd_result_t
+mnd_root_get_lock_stats_count(mnd_root_t *root, uint32_t *out_count);
+
+/*!
+ * Get the statistics of the locks with the name at the given index.
+ *
+ * Supported in version 1.9 and above.
+ *
+ * @param root           The libmonado state.
+ * @param index          Index of the lock name, less than the count from @ref mnd_root_get_lock_stats_count.
+ * @param[out] out_stats Pointer to populate with the statistics.
+ *
+ * @return MND_SUCCESS on success
+ */
+mnd_result_t
+mnd_root_get_lock_stats(mnd_root_t *root, uint32_t index, mnd_lock_stats_t *out_stats);
+
 #ifdef __cplusplus
 }
 #endif
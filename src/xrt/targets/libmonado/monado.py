@@ -151,6 +151,27 @@ class Monado:
 
         return self.flags_ptr[0]
 
+    def get_client_frame_stats(self, client_id):
+        stats_ptr = self.ffi.new("mnd_client_frame_stats_t *")
+        ret = self.lib.mnd_root_get_client_frame_stats(self.root, client_id, stats_ptr)
+        if ret != 0:
+            raise Exception(f"get_client_frame_stats failed: {ret}")
+        return stats_ptr[0]
+
+    def get_client_memory_stats(self, client_id):
+        stats_ptr = self.ffi.new("mnd_client_memory_stats_t *")
+        ret = self.lib.mnd_root_get_client_memory_stats(self.root, client_id, stats_ptr)
+        if ret != 0:
+            raise Exception(f"get_client_memory_stats failed: {ret}")
+        return stats_ptr[0]
+
+    def get_client_resolution_scale(self, client_id):
+        scale_ptr = self.ffi.new("float *")
+        ret = self.lib.mnd_root_get_client_resolution_scale(self.root, client_id, scale_ptr)
+        if ret != 0:
+            raise Exception(f"get_client_resolution_scale failed: {ret}")
+        return scale_ptr[0]
+
     def snapshot_client(self, index):
         ident = self.get_client_id_at_index(index)
         name = self.get_client_name(ident)
@@ -235,3 +256,18 @@ class Monado:
         ret = self.lib.mnd_root_set_device_brightness(self.root, index, brightness, relative)
         if ret != 0:
             raise Exception(f"set_device_brightness failed: {ret}")
+
+    def get_lock_stats(self):
+        count_ptr = self.ffi.new("uint32_t *")
+        ret = self.lib.mnd_root_get_lock_stats_count(self.root, count_ptr)
+        if ret != 0:
+            raise Exception(f"get_lock_stats_count failed: {ret}")
+
+        stats = []
+        for index in range(count_ptr[0]):
+            stats_ptr = self.ffi.new("mnd_lock_stats_t *")
+            ret = self.lib.mnd_root_get_lock_stats(self.root, index, stats_ptr)
+            if ret != 0:
+                raise Exception(f"get_lock_stats failed: {ret}")
+            stats.append(stats_ptr[0])
+        return stats
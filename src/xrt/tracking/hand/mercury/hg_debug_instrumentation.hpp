@@ -34,6 +34,7 @@ struct hg_tuneable_values
 	struct u_var_draggable_f32 opt_smooth_factor;
 	struct u_var_draggable_f32 max_hand_dist;
 	struct u_var_draggable_f32 min_detection_confidence;
+	struct u_var_draggable_f32 min_tracking_confidence;
 	bool scribble_predictions_into_next_frame = false;
 	bool scribble_keypoint_model_outputs = false;
 	bool scribble_optimizer_outputs = true;
@@ -44,6 +45,11 @@ struct hg_tuneable_values
 	bool enable_pose_predicted_input = true;
 	bool enable_framerate_based_smoothing = false;
 
+	// While one hand is tracked confidently, only look for the other one every this many frames.
+	int32_t detection_interval_one_hand = 3;
+	// Once no hands have been seen for a while, only run the detection model every this many frames.
+	int32_t detection_interval_idle = 2;
+
 	// Stuff that's only really useful for dataset playback:
 	bool detection_model_in_both_views = false;
 };
@@ -154,29 +154,35 @@ map_ranges(T value, T from_low, T from_high, T to_low, T to_high)
 	return (value - from_low) * (to_high - to_low) / (from_high - from_low) + to_low;
 }
 
+/*!
+ * Nearest neighbour remap of the whole output, every pixel is written so there
+ * is no need to clear it first. Works on raw row pointers, and a single
+ * unsigned compare per coordinate catches both negative and too large values,
+ * which keeps the inner loop branch free enough for the compiler to vectorize.
+ */
 void
 naive_remap(OutputSizedArray<int16_t> &image_x,
             OutputSizedArray<int16_t> &image_y,
             cv::Mat &input,
             Eigen::Map<OutputSizedArray<uint8_t>> &output)
 {
-	output = 0;
+	const uint8_t *data = input.data;
+	const size_t step = input.step[0];
+	const uint32_t cols = (uint32_t)input.cols;
+	const uint32_t rows = (uint32_t)input.rows;
 
 	for (int y = 0; y < wsize; y++) {
+		const int16_t *row_x = &image_x(y, 0);
+		const int16_t *row_y = &image_y(y, 0);
+		uint8_t *out = &output(y, 0);
+
 		for (int x = 0; x < wsize; x++) {
-			if (image_y(y, x) < 0) {
-				continue;
-			}
-			if (image_y(y, x) >= input.rows) {
-				continue;
-			}
-			if (image_x(y, x) < 0) {
-				continue;
-			}
-			if (image_x(y, x) >= input.cols) {
-				continue;
-			}
-			output(y, x) = input.at<uint8_t>(image_y(y, x), image_x(y, x));
+			// Negative values wrap around to large unsigned values.
+			uint32_t ix = (uint32_t)(int32_t)row_x[x];
+			uint32_t iy = (uint32_t)(int32_t)row_y[x];
+
+			bool inside = ix < cols && iy < rows;
+			out[x] = inside ? data[iy * step + ix] : 0;
 		}
 	}
 }
@@ -263,6 +263,30 @@ normalizeGrayscaleImage(cv::Mat &data_in, cv::Mat &data_out)
 	return true;
 }
 
+DEBUG_GET_ONCE_OPTION(mercury_ort_provider, "MERCURY_ORT_EXECUTION_PROVIDER", nullptr)
+
+static void
+append_execution_provider(HandTracking *hgt, onnx_wrap *wrap, OrtSessionOptions *opts)
+{
+	const char *provider = debug_get_option_mercury_ort_provider();
+	if (provider == nullptr) {
+		return;
+	}
+
+#if ORT_API_VERSION >= 13
+	// Not fatal, ORT falls back to the CPU provider.
+	OrtStatus *status = wrap->api->SessionOptionsAppendExecutionProvider(opts, provider, nullptr, nullptr, 0);
+	if (status != nullptr) {
+		HG_WARN(hgt, "Could not use execution provider '%s': %s", provider,
+		        wrap->api->GetErrorMessage(status));
+		wrap->api->ReleaseStatus(status);
+	}
+#else
+	(void)opts;
+	HG_WARN(hgt, "Execution provider '%s' requested, but ONNX Runtime is too old to select it.", provider);
+#endif
+}
+
 void
 setup_ort_api(HandTracking *hgt, onnx_wrap *wrap, std::filesystem::path path)
 {
@@ -271,8 +295,10 @@ setup_ort_api(HandTracking *hgt, onnx_wrap *wrap, std::filesystem::path path)
 
 	ORT(CreateSessionOptions(&opts));
 
+	// TODO review options, config for threads?
 	ORT(SetSessionGraphOptimizationLevel(opts, ORT_ENABLE_ALL));
 	ORT(SetIntraOpNumThreads(opts, 1));
+	append_execution_provider(hgt, wrap, opts);
 
 	ORT(CreateEnv(ORT_LOGGING_LEVEL_FATAL, "monado_ht", &wrap->env));
 
@@ -294,7 +320,7 @@ setup_model_image_input(HandTracking *hgt, onnx_wrap *wrap, const char *name, in
 	inputimg.dimensions[3] = w;
 	inputimg.num_dimensions = 4;
 	size_t data_size = w * h * sizeof(float);
-	inputimg.data = (float *)malloc(data_size);
+	inputimg.data = (float *)calloc(1, data_size);
 
 	ORT(CreateTensorWithDataAsOrtValue(wrap->meminfo,                       //
 	                                   inputimg.data,                       //
@@ -312,6 +338,155 @@ setup_model_image_input(HandTracking *hgt, onnx_wrap *wrap, const char *name, in
 	wrap->wraps.push_back(inputimg);
 }
 
+/*!
+ * Run the model once (which also warms it up) to learn the output shapes, then
+ * preallocate the outputs and bind them together with the inputs, so each run
+ * neither allocates output tensors nor looks up the inputs by name.
+ *
+ * Leaves @p wrap->binding null if any output is not a float tensor with at most
+ * four dimensions.
+ */
+static void
+setup_io_binding(HandTracking *hgt, onnx_wrap *wrap, const char *const *output_names, size_t output_count)
+{
+	std::vector<const OrtValue *> inputs = {};
+	std::vector<const char *> input_names = {};
+	for (model_input_wrap &in : wrap->wraps) {
+		inputs.push_back(in.tensor);
+		input_names.push_back(in.name);
+	}
+
+	std::vector<OrtValue *> output_tensors(output_count, nullptr);
+	ORT(Run(wrap->session, nullptr, input_names.data(), inputs.data(), inputs.size(), output_names, output_count,
+	        output_tensors.data()));
+
+	bool can_bind = true;
+	for (size_t i = 0; i < output_count; i++) {
+		OrtTensorTypeAndShapeInfo *info = nullptr;
+		ORT(GetTensorTypeAndShape(output_tensors[i], &info));
+
+		model_input_wrap out = {};
+		out.name = output_names[i];
+		ONNXTensorElementDataType type = ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED;
+		ORT(GetTensorElementType(info, &type));
+		ORT(GetDimensionsCount(info, &out.num_dimensions));
+
+		if (type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT || out.num_dimensions > ARRAY_SIZE(out.dimensions)) {
+			can_bind = false;
+		} else {
+			ORT(GetDimensions(info, out.dimensions, out.num_dimensions));
+		}
+
+		size_t element_count = 0;
+		ORT(GetTensorShapeElementCount(info, &element_count));
+		wrap->api->ReleaseTensorTypeAndShapeInfo(info);
+		wrap->api->ReleaseValue(output_tensors[i]);
+
+		if (!can_bind) {
+			continue;
+		}
+
+		size_t data_size = element_count * sizeof(float);
+		out.data = (float *)calloc(1, data_size);
+
+		ORT(CreateTensorWithDataAsOrtValue(wrap->meminfo,                       //
+		                                   out.data,                            //
+		                                   data_size,                           //
+		                                   out.dimensions,                      //
+		                                   out.num_dimensions,                  //
+		                                   ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, //
+		                                   &out.tensor));
+		wrap->outputs.push_back(out);
+	}
+
+	if (!can_bind) {
+		for (model_input_wrap &out : wrap->outputs) {
+			wrap->api->ReleaseValue(out.tensor);
+			free(out.data);
+		}
+		wrap->outputs.clear();
+		return;
+	}
+
+	ORT(CreateIoBinding(wrap->session, &wrap->binding));
+	for (model_input_wrap &in : wrap->wraps) {
+		ORT(BindInput(wrap->binding, in.name, in.tensor));
+	}
+	for (model_input_wrap &out : wrap->outputs) {
+		ORT(BindOutput(wrap->binding, out.name, out.tensor));
+	}
+}
+
+/*!
+ * Run the model, with the preallocated bound outputs if possible. The outputs
+ * must be given back with @ref release_model_outputs.
+ */
+static void
+run_model(HandTracking *hgt,
+          onnx_wrap *wrap,
+          const char *const *input_names,
+          const OrtValue *const *inputs,
+          size_t input_count,
+          const char *const *output_names,
+          size_t output_count,
+          OrtValue **output_tensors)
+{
+	if (wrap->binding != nullptr) {
+		assert(wrap->outputs.size() == output_count);
+		ORT(RunWithBinding(wrap->session, nullptr, wrap->binding));
+		for (size_t i = 0; i < output_count; i++) {
+			output_tensors[i] = wrap->outputs[i].tensor;
+		}
+		return;
+	}
+
+	ORT(Run(wrap->session, nullptr, input_names, inputs, input_count, output_names, output_count,
+	        output_tensors));
+}
+
+static void
+release_model_outputs(onnx_wrap *wrap, OrtValue **output_tensors, size_t output_count)
+{
+	// Bound outputs are owned by the wrap.
+	if (wrap->binding != nullptr) {
+		return;
+	}
+
+	for (size_t i = 0; i < output_count; i++) {
+		wrap->api->ReleaseValue(output_tensors[i]);
+	}
+}
+
+/*!
+ * Run the model a few more times on its zeroed inputs, on top of the run done
+ * by @ref setup_io_binding, so ONNX Runtime's lazy allocations and kernel
+ * selection are done before the first real frame.
+ */
+static void
+warm_up_model(HandTracking *hgt, onnx_wrap *wrap, const char *const *output_names, size_t output_count)
+{
+	XRT_TRACE_MARKER();
+
+	constexpr int kWarmUpRuns = 2;
+
+	std::vector<const OrtValue *> inputs = {};
+	std::vector<const char *> input_names = {};
+	for (model_input_wrap &in : wrap->wraps) {
+		inputs.push_back(in.tensor);
+		input_names.push_back(in.name);
+	}
+
+	std::vector<OrtValue *> output_tensors(output_count, nullptr);
+	for (int i = 0; i < kWarmUpRuns; i++) {
+		run_model(hgt, wrap, input_names.data(), inputs.data(), inputs.size(), output_names, output_count,
+		          output_tensors.data());
+		release_model_outputs(wrap, output_tensors.data(), output_count);
+	}
+}
+
+static const char *detection_output_names[] = {"hand_exists", "cx", "cy", "size"};
+static const char *keypoint_output_names[] = {"heatmap_xy", "heatmap_depth", "scalar_extras", "curls"};
+
 void
 init_hand_detection(HandTracking *hgt, onnx_wrap *wrap)
 {
@@ -324,6 +499,9 @@ init_hand_detection(HandTracking *hgt, onnx_wrap *wrap)
 	setup_ort_api(hgt, wrap, path);
 
 	setup_model_image_input(hgt, wrap, "inputImg", kDetectionInputSize, kDetectionInputSize);
+
+	setup_io_binding(hgt, wrap, detection_output_names, ARRAY_SIZE(detection_output_names));
+	warm_up_model(hgt, wrap, detection_output_names, ARRAY_SIZE(detection_output_names));
 }
 
 
@@ -358,14 +536,14 @@ run_hand_detection(void *ptr)
 	const char *input_names[] = {wrap->wraps[0].name};
 
 	OrtValue *output_tensors[] = {nullptr, nullptr, nullptr, nullptr};
-	const char *output_names[] = {"hand_exists", "cx", "cy", "size"};
+	const char **output_names = detection_output_names;
 
 	{
 		XRT_TRACE_IDENT(model);
 		static_assert(ARRAY_SIZE(input_names) == ARRAY_SIZE(inputs));
-		static_assert(ARRAY_SIZE(output_names) == ARRAY_SIZE(output_tensors));
-		ORT(Run(wrap->session, nullptr, input_names, inputs, ARRAY_SIZE(input_names), output_names,
-		        ARRAY_SIZE(output_names), output_tensors));
+		static_assert(ARRAY_SIZE(detection_output_names) == ARRAY_SIZE(output_tensors));
+		run_model(hgt, wrap, input_names, inputs, ARRAY_SIZE(input_names), output_names,
+		          ARRAY_SIZE(output_tensors), output_tensors);
 	}
 
 	float *hand_exists = nullptr;
@@ -424,9 +602,7 @@ run_hand_detection(void *ptr)
 		}
 	}
 
-	for (size_t i = 0; i < ARRAY_SIZE(output_tensors); i++) {
-		wrap->api->ReleaseValue(output_tensors[i]);
-	}
+	release_model_outputs(wrap, output_tensors, ARRAY_SIZE(output_tensors));
 }
 
 void
@@ -440,24 +616,7 @@ init_keypoint_estimation(HandTracking *hgt, onnx_wrap *wrap)
 	wrap->wraps.clear();
 
 
-	wrap->api = OrtGetApiBase()->GetApi(ORT_API_VERSION);
-
-
-	OrtSessionOptions *opts = nullptr;
-	ORT(CreateSessionOptions(&opts));
-
-	// TODO review options, config for threads?
-	ORT(SetSessionGraphOptimizationLevel(opts, ORT_ENABLE_ALL));
-	ORT(SetIntraOpNumThreads(opts, 1));
-
-
-	ORT(CreateEnv(ORT_LOGGING_LEVEL_FATAL, "monado_ht", &wrap->env));
-
-	ORT(CreateCpuMemoryInfo(OrtArenaAllocator, OrtMemTypeDefault, &wrap->meminfo));
-
-	// HG_DEBUG(this->device, "Loading hand detection model from file '%s'", path.c_str());
-	ORT(CreateSession(wrap->env, path.c_str(), opts, &wrap->session));
-	assert(wrap->session != NULL);
+	setup_ort_api(hgt, wrap, path);
 
 	// size_t input_size = wrap->input_shape[0] * wrap->input_shape[1] * wrap->input_shape[2] *
 	// wrap->input_shape[3];
@@ -472,7 +631,7 @@ init_keypoint_estimation(HandTracking *hgt, onnx_wrap *wrap)
 		inputimg.dimensions[3] = 128;
 		inputimg.num_dimensions = 4;
 
-		inputimg.data = (float *)malloc(128 * 128 * sizeof(float)); // SORRY IM BUSY
+		inputimg.data = (float *)calloc(1, 128 * 128 * sizeof(float)); // SORRY IM BUSY
 
 
 
@@ -499,7 +658,7 @@ init_keypoint_estimation(HandTracking *hgt, onnx_wrap *wrap)
 		inputimg.dimensions[1] = 42;
 		inputimg.num_dimensions = 2;
 
-		inputimg.data = (float *)malloc(1 * 42 * sizeof(float)); // SORRY IM BUSY
+		inputimg.data = (float *)calloc(1, 1 * 42 * sizeof(float)); // SORRY IM BUSY
 
 
 
@@ -524,7 +683,7 @@ init_keypoint_estimation(HandTracking *hgt, onnx_wrap *wrap)
 		inputimg.dimensions[0] = 1;
 		inputimg.num_dimensions = 1;
 
-		inputimg.data = (float *)malloc(1 * sizeof(float)); // SORRY IM BUSY
+		inputimg.data = (float *)calloc(1, 1 * sizeof(float)); // SORRY IM BUSY
 
 
 
@@ -543,8 +702,8 @@ init_keypoint_estimation(HandTracking *hgt, onnx_wrap *wrap)
 		wrap->wraps.push_back(inputimg);
 	}
 
-
-	wrap->api->ReleaseSessionOptions(opts);
+	setup_io_binding(hgt, wrap, keypoint_output_names, ARRAY_SIZE(keypoint_output_names));
+	warm_up_model(hgt, wrap, keypoint_output_names, ARRAY_SIZE(keypoint_output_names));
 }
 
 enum xrt_hand_joint joints_ml_to_xr[21]{
@@ -777,14 +936,14 @@ run_keypoint_estimation(void *ptr)
 	const char *input_names[] = {wrap->wraps[0].name, wrap->wraps[1].name, wrap->wraps[2].name};
 
 	OrtValue *output_tensors[] = {nullptr, nullptr, nullptr, nullptr};
-	const char *output_names[] = {"heatmap_xy", "heatmap_depth", "scalar_extras", "curls"};
+	const char **output_names = keypoint_output_names;
 
 	{
 		XRT_TRACE_IDENT(model);
 		assert(ARRAY_SIZE(input_names) == ARRAY_SIZE(inputs));
-		assert(ARRAY_SIZE(output_names) == ARRAY_SIZE(output_tensors));
-		ORT(Run(wrap->session, nullptr, input_names, inputs, ARRAY_SIZE(input_names), output_names,
-		        ARRAY_SIZE(output_names), output_tensors));
+		static_assert(ARRAY_SIZE(keypoint_output_names) == ARRAY_SIZE(output_tensors));
+		run_model(hgt, wrap, input_names, inputs, ARRAY_SIZE(input_names), output_names,
+		          ARRAY_SIZE(output_tensors), output_tensors);
 	}
 
 	// To here
@@ -966,20 +1125,26 @@ run_keypoint_estimation(void *ptr)
 		}
 	}
 
-	for (size_t i = 0; i < ARRAY_SIZE(output_tensors); i++) {
-		wrap->api->ReleaseValue(output_tensors[i]);
-	}
+	release_model_outputs(wrap, output_tensors, ARRAY_SIZE(output_tensors));
 }
 
 void
 release_onnx_wrap(onnx_wrap *wrap)
 {
+	if (wrap->binding != nullptr) {
+		wrap->api->ReleaseIoBinding(wrap->binding);
+		wrap->binding = nullptr;
+	}
 	wrap->api->ReleaseMemoryInfo(wrap->meminfo);
 	wrap->api->ReleaseSession(wrap->session);
 	for (model_input_wrap &a : wrap->wraps) {
 		wrap->api->ReleaseValue(a.tensor);
 		free(a.data);
 	}
+	for (model_input_wrap &a : wrap->outputs) {
+		wrap->api->ReleaseValue(a.tensor);
+		free(a.data);
+	}
 	wrap->api->ReleaseEnv(wrap->env);
 }
 
@@ -16,6 +16,8 @@
 #include "util/u_hand_tracking.h"
 #include "math/m_vec2.h"
 #include "util/u_misc.h"
+#include "util/u_time.h"
+#include "os/os_time.h"
 #include "xrt/xrt_defines.h"
 #include "xrt/xrt_frame.h"
 #include "xrt/xrt_tracking.h"
@@ -30,6 +32,7 @@ namespace xrt::tracking::hand::mercury {
 DEBUG_GET_ONCE_LOG_OPTION(mercury_log, "MERCURY_LOG", U_LOGGING_WARN)
 DEBUG_GET_ONCE_BOOL_OPTION(mercury_optimize_hand_size, "MERCURY_optimize_hand_size", true)
 DEBUG_GET_ONCE_FLOAT_OPTION(mercury_min_detection_confidence, "MERCURY_MIN_DETECTION_CONFIDENCE", 0.3)
+DEBUG_GET_ONCE_NUM_OPTION(mercury_detection_interval, "MERCURY_DETECTION_INTERVAL", 3)
 
 // Flags to tell state tracker that these are indeed valid joints
 static const enum xrt_space_relation_flags valid_flags_ht = (enum xrt_space_relation_flags)(
@@ -491,6 +494,49 @@ dispatch_and_process_hand_detections(struct HandTracking *hgt)
 	}
 }
 
+/*!
+ * Decides if the detection model runs this frame. Reacquiring a hand quickly
+ * matters most when none are tracked, so the model only runs less often when
+ * one hand is confidently tracked, or when no hands have been seen for a while.
+ */
+static bool
+should_run_hand_detection(struct HandTracking *hgt)
+{
+	hg_tuneable_values &tv = hgt->tuneable_values;
+
+	if (tv.always_run_detection_model) {
+		return true;
+	}
+
+	int num_tracked = (int)hgt->last_frame_hand_detected[0] + (int)hgt->last_frame_hand_detected[1];
+
+	// Nothing to look for, the detection model doesn't replace tracked hands.
+	if (num_tracked == 2) {
+		return false;
+	}
+
+	// Hand size estimation wants new hands found in both views as soon as possible.
+	if (hgt->refinement.optimizing) {
+		return true;
+	}
+
+	int32_t interval = 1;
+	if (num_tracked == 1) {
+		int tracked_idx = hgt->last_frame_hand_detected[0] ? 0 : 1;
+		if (hgt->tracking_confidence[tracked_idx] >= tv.min_tracking_confidence.val) {
+			interval = tv.detection_interval_one_hand;
+		}
+	} else if (hgt->frames_without_hands > tv.num_frames_before_display) {
+		interval = tv.detection_interval_idle;
+	}
+
+	if (interval <= 1) {
+		return true;
+	}
+
+	return (hgt->detection_schedule_counter++ % (uint64_t)interval) == 0;
+}
+
 void
 hand_joint_set_to_eigen_21(const xrt_hand_joint_set &set, Eigen::Array<float, 3, 21> &out)
 {
@@ -637,6 +683,26 @@ hand_too_far(struct HandTracking *hgt, xrt_hand_joint_set &set)
 	return (m_vec3_len(dp) > hgt->tuneable_values.max_hand_dist.val);
 }
 
+static void
+run_kinematic_optimizer(void *ptr)
+{
+	struct kinematic_optimizer_run_info &inf = *(struct kinematic_optimizer_run_info *)ptr;
+	struct HandTracking *hgt = inf.hgt;
+	int hand_idx = inf.hand_idx;
+
+	lm::optimizer_run(hgt->kinematic_hands[hand_idx],                  //
+	                  hgt->keypoint_outputs[hand_idx],                 //
+	                  !hgt->last_frame_hand_detected[hand_idx],        //
+	                  inf.smoothing_factor,                            //
+	                  inf.optimize_hand_size,                          //
+	                  hgt->target_hand_size,                           //
+	                  hgt->refinement.hand_size_refinement_schedule_y, //
+	                  hgt->tuneable_values.amt_use_depth.val,          //
+	                  *inf.out_set,                                    //
+	                  inf.out_hand_size,                               //
+	                  inf.out_reprojection_error);
+}
+
 void
 scribble_image_boundary(struct HandTracking *hgt)
 {
@@ -672,6 +738,11 @@ HandTracking::HandTracking()
 
 HandTracking::~HandTracking()
 {
+	// The models are released right below.
+	if (this->model_loader.joinable()) {
+		this->model_loader.join();
+	}
+
 	u_sink_debug_destroy(&this->debug_sink_ann);
 	u_sink_debug_destroy(&this->debug_sink_model);
 
@@ -711,6 +782,14 @@ HandTracking::cCallbackProcess(struct t_hand_tracking_sync *ht_sync,
 
 	hgt->current_frame_timestamp = left_frame->timestamp;
 
+	// Hand tracking is not available yet, the models are still loading.
+	if (!hgt->models_ready.load(std::memory_order_acquire)) {
+		out_left_hand->is_active = false;
+		out_right_hand->is_active = false;
+		*out_timestamp_ns = hgt->current_frame_timestamp;
+		return;
+	}
+
 	struct xrt_hand_joint_set *out_xrt_hands[2] = {out_left_hand, out_right_hand};
 
 
@@ -803,8 +882,7 @@ HandTracking::cCallbackProcess(struct t_hand_tracking_sync *ht_sync,
 
 
 	// Every now and then if we're not already tracking both hands, try to detect new hands.
-	bool saw_both_hands_last_frame = hgt->last_frame_hand_detected[0] && hgt->last_frame_hand_detected[1];
-	if (!saw_both_hands_last_frame) {
+	if (should_run_hand_detection(hgt)) {
 		dispatch_and_process_hand_detections(hgt);
 	}
 
@@ -880,7 +958,9 @@ HandTracking::cCallbackProcess(struct t_hand_tracking_sync *ht_sync,
 	int num_hands = 0;
 	float avg_hand_size = 0;
 
-	// Dispatch the optimizers!
+	struct kinematic_optimizer_run_info optimizer_infos[2] = {};
+
+	// Dispatch the optimizers! The two hands are independent, so solve them at the same time.
 	for (int hand_idx = 0; hand_idx < 2; hand_idx++) {
 
 
@@ -919,11 +999,6 @@ HandTracking::cCallbackProcess(struct t_hand_tracking_sync *ht_sync,
 			}
 		}
 
-		struct xrt_hand_joint_set *put_in_set = out_xrt_hands[hand_idx];
-
-		lm::KinematicHandLM *hand = hgt->kinematic_hands[hand_idx];
-
-		float reprojection_error_threshold = hgt->tuneable_values.max_reprojection_error.val;
 		float smoothing_factor = hgt->tuneable_values.opt_smooth_factor.val;
 
 		if (hgt->last_frame_hand_detected[hand_idx]) {
@@ -935,29 +1010,30 @@ HandTracking::cCallbackProcess(struct t_hand_tracking_sync *ht_sync,
 				double diff_d = time_ns_to_s(diff);
 				smoothing_factor = hgt->tuneable_values.opt_smooth_factor.val * (1 / 60.0f) / diff_d;
 			}
-		} else {
-			reprojection_error_threshold = hgt->tuneable_values.max_reprojection_error.val;
 		}
 
+		struct kinematic_optimizer_run_info &inf = optimizer_infos[hand_idx];
+		inf.hgt = hgt;
+		inf.hand_idx = hand_idx;
+		inf.active = true;
+		inf.smoothing_factor = smoothing_factor;
+		inf.optimize_hand_size = optimize_hand_size;
+		inf.out_set = out_xrt_hands[hand_idx];
+		u_worker_group_push(hgt->group, run_kinematic_optimizer, &inf);
+	}
+	u_worker_group_wait_all(hgt->group);
 
+	for (int hand_idx = 0; hand_idx < 2; hand_idx++) {
+		struct kinematic_optimizer_run_info &inf = optimizer_infos[hand_idx];
+		if (!inf.active) {
+			continue;
+		}
 
-		float out_hand_size;
-
-		//!@todo optimize: We can have one of these on each thread
-		float reprojection_error;
-		lm::optimizer_run(hand,                                     //
-		                  hgt->keypoint_outputs[hand_idx],          //
-		                  !hgt->last_frame_hand_detected[hand_idx], //
-		                  smoothing_factor,
-		                  optimize_hand_size,                              //
-		                  hgt->target_hand_size,                           //
-		                  hgt->refinement.hand_size_refinement_schedule_y, //
-		                  hgt->tuneable_values.amt_use_depth.val,
-		                  *put_in_set,   //
-		                  out_hand_size, //
-		                  reprojection_error);
-
+		struct xrt_hand_joint_set *put_in_set = inf.out_set;
 
+		float reprojection_error_threshold = hgt->tuneable_values.max_reprojection_error.val;
+		float out_hand_size = inf.out_hand_size;
+		float reprojection_error = inf.out_reprojection_error;
 
 		if (reprojection_error > reprojection_error_threshold) {
 			HG_DEBUG(hgt, "Reprojection error above threshold!");
@@ -975,9 +1051,11 @@ HandTracking::cCallbackProcess(struct t_hand_tracking_sync *ht_sync,
 		avg_hand_size += out_hand_size;
 		num_hands++;
 
+		float confidence = hand_confidence_value(reprojection_error, hgt->keypoint_outputs[hand_idx]);
+		hgt->tracking_confidence[hand_idx] = confidence;
+
 		if (!any_hands_are_only_visible_in_one_view) {
-			hgt->refinement.hand_size_refinement_schedule_x +=
-			    hand_confidence_value(reprojection_error, hgt->keypoint_outputs[hand_idx]);
+			hgt->refinement.hand_size_refinement_schedule_x += confidence;
 		}
 
 		u_hand_joints_apply_joint_width(put_in_set);
@@ -1021,6 +1099,7 @@ HandTracking::cCallbackProcess(struct t_hand_tracking_sync *ht_sync,
 		    hgt->hand_seen_before[hand_idx] || hgt->this_frame_hand_detected[hand_idx];
 
 		if (!hgt->last_frame_hand_detected[hand_idx]) {
+			hgt->tracking_confidence[hand_idx] = 0.0f;
 			hgt->views[0].regions_of_interest_this_frame[hand_idx].found = false;
 			hgt->views[1].regions_of_interest_this_frame[hand_idx].found = false;
 			hgt->history_hands[hand_idx].clear();
@@ -1028,6 +1107,12 @@ HandTracking::cCallbackProcess(struct t_hand_tracking_sync *ht_sync,
 		}
 	}
 
+	if (hgt->last_frame_hand_detected[0] || hgt->last_frame_hand_detected[1]) {
+		hgt->frames_without_hands = 0;
+	} else {
+		hgt->frames_without_hands++;
+	}
+
 	// estimators next frame. Also, if next frame's hand will be outside of the camera's field of view, mark it as
 	// inactive this frame. This stops issues where our hand detector detects hands that are slightly too close to
 	// the edge, causing flickery hands.
@@ -1077,6 +1162,31 @@ HandTracking::cCallbackDestroy(t_hand_tracking_sync *ht_sync)
 	delete ht_ptr;
 }
 
+static void
+load_models(HandTracking *hgt)
+{
+	U_TRACE_SET_THREAD_NAME("Hand Tracking: Models");
+
+	int64_t start_ns = os_monotonic_get_ns();
+
+	init_hand_detection(hgt, &hgt->views[0].detection);
+	init_hand_detection(hgt, &hgt->views[1].detection);
+
+	init_keypoint_estimation(hgt, &hgt->views[0].keypoint[0]);
+	init_keypoint_estimation(hgt, &hgt->views[0].keypoint[1]);
+
+	init_keypoint_estimation(hgt, &hgt->views[1].keypoint[0]);
+	init_keypoint_estimation(hgt, &hgt->views[1].keypoint[1]);
+
+	hgt->models_ready.store(true, std::memory_order_release);
+
+	HG_DEBUG(hgt, "Models loaded and warmed up in %.1fms", time_ns_to_ms_f(os_monotonic_get_ns() - start_ns));
+
+	if (hgt->ready_cb != nullptr) {
+		hgt->ready_cb(hgt->ready_userdata);
+	}
+}
+
 } // namespace xrt::tracking::hand::mercury
 
 
@@ -1121,14 +1231,9 @@ t_hand_tracking_sync_mercury_create(struct t_stereo_camera_calibration *calib,
 	hgt->views[0].camera_info = extra_camera_info.views[0];
 	hgt->views[1].camera_info = extra_camera_info.views[1];
 
-	init_hand_detection(hgt, &hgt->views[0].detection);
-	init_hand_detection(hgt, &hgt->views[1].detection);
+	hgt->ready_cb = create_info.ready_cb;
+	hgt->ready_userdata = create_info.ready_userdata;
 
-	init_keypoint_estimation(hgt, &hgt->views[0].keypoint[0]);
-	init_keypoint_estimation(hgt, &hgt->views[0].keypoint[1]);
-
-	init_keypoint_estimation(hgt, &hgt->views[1].keypoint[0]);
-	init_keypoint_estimation(hgt, &hgt->views[1].keypoint[1]);
 	hgt->keypoint_estimation_run_func = xrt::tracking::hand::mercury::run_keypoint_estimation;
 
 	hgt->views[0].view = 0;
@@ -1221,6 +1326,13 @@ t_hand_tracking_sync_mercury_create(struct t_stereo_camera_calibration *calib,
 	hgt->tuneable_values.min_detection_confidence.step = 0.01f;
 	hgt->tuneable_values.min_detection_confidence.val = debug_get_float_option_mercury_min_detection_confidence();
 
+	hgt->tuneable_values.min_tracking_confidence.max = 1.0f;
+	hgt->tuneable_values.min_tracking_confidence.min = 0.0f;
+	hgt->tuneable_values.min_tracking_confidence.step = 0.01f;
+	hgt->tuneable_values.min_tracking_confidence.val = 0.1f;
+
+	hgt->tuneable_values.detection_interval_one_hand = (int32_t)debug_get_num_option_mercury_detection_interval();
+
 	u_var_add_draggable_f32(hgt, &hgt->tuneable_values.amt_use_depth, "Amount to use depth prediction");
 
 
@@ -1237,6 +1349,12 @@ t_hand_tracking_sync_mercury_create(struct t_stereo_camera_calibration *calib,
 	u_var_add_draggable_f32(hgt, &hgt->tuneable_values.opt_smooth_factor, "Optimizer smoothing factor");
 	u_var_add_draggable_f32(hgt, &hgt->tuneable_values.max_hand_dist, "Max hand distance");
 	u_var_add_draggable_f32(hgt, &hgt->tuneable_values.min_detection_confidence, "Min detection confidence");
+	u_var_add_draggable_f32(hgt, &hgt->tuneable_values.min_tracking_confidence,
+	                        "Min tracking confidence (For running the detection model less often)");
+	u_var_add_i32(hgt, &hgt->tuneable_values.detection_interval_one_hand,
+	              "Run detection model every N frames while one hand is tracked");
+	u_var_add_i32(hgt, &hgt->tuneable_values.detection_interval_idle,
+	              "Run detection model every N frames while no hands are seen");
 
 	u_var_add_i32(hgt, &hgt->tuneable_values.max_num_outside_view,
 	              "max allowed number of hand joints outside view");
@@ -1262,6 +1380,9 @@ t_hand_tracking_sync_mercury_create(struct t_stereo_camera_calibration *calib,
 	u_var_add_sink_debug(hgt, &hgt->debug_sink_ann, "Annotated camera feeds");
 	u_var_add_sink_debug(hgt, &hgt->debug_sink_model, "Model inputs and outputs");
 
+	// Everything else is set up, creating the sessions can take a while so don't block the caller on it.
+	hgt->model_loader = std::thread(load_models, hgt);
+
 	HG_DEBUG(hgt, "Hand Tracker initialized!");
 
 	return &hgt->base;
@@ -42,6 +42,9 @@
 #include <string.h>
 #include <stdint.h>
 
+#include <atomic>
+#include <thread>
+
 #include <opencv2/opencv.hpp>
 #include <onnxruntime_c_api.h>
 
@@ -161,6 +164,12 @@ struct onnx_wrap
 	OrtSession *session = nullptr;
 
 	std::vector<model_input_wrap> wraps = {};
+
+	//! Preallocated output tensors, only used if @p binding is set.
+	std::vector<model_input_wrap> outputs = {};
+
+	//! Binds the inputs and outputs once, null if the outputs could not be preallocated.
+	OrtIoBinding *binding = nullptr;
 };
 
 // Multipurpose.
@@ -220,6 +229,22 @@ struct ht_view
 };
 
 
+// One hand's kinematic optimizer run, so both hands can be solved on the worker pool at once.
+struct kinematic_optimizer_run_info
+{
+	HandTracking *hgt;
+	int hand_idx;
+	bool active;
+
+	bool optimize_hand_size;
+	float smoothing_factor;
+
+	struct xrt_hand_joint_set *out_set;
+	float out_hand_size;
+	float out_reprojection_error;
+};
+
+
 struct hand_size_refinement
 {
 	int num_hands;
@@ -284,6 +309,16 @@ public:
 
 	char models_folder[1024];
 
+	//! Creates the ONNX Runtime sessions and warms them up, so creating the tracker doesn't block on it.
+	std::thread model_loader;
+
+	//! Set by @ref model_loader once all models are loaded, no hands are reported before that.
+	std::atomic<bool> models_ready = {false};
+
+	//! Called by @ref model_loader when done, from @ref t_hand_tracking_create_info.
+	void (*ready_cb)(void *userdata) = nullptr;
+	void *ready_userdata = nullptr;
+
 	enum u_logging_level log_level = U_LOGGING_INFO;
 
 	lm::KinematicHandLM *kinematic_hands[2];
@@ -321,6 +356,13 @@ public:
 
 	int detection_counter = 0;
 
+	// Confidence of each hand's last tracked frame, from the keypoint confidences and the reprojection error.
+	float tracking_confidence[2] = {0.0f, 0.0f};
+
+	// Frames since any hand was tracked, and frames the detection model could have run on, used to schedule it.
+	uint64_t frames_without_hands = 0;
+	uint64_t detection_schedule_counter = 0;
+
 	struct hand_size_refinement refinement = {};
 	float target_hand_size = STANDARD_HAND_SIZE;
 
@@ -530,6 +530,8 @@ struct KinematicHandLM
 	bool use_stability = false;
 	bool optimize_hand_size = true;
 	bool is_right = false;
+	// Use the hand-derived Jacobian for the projection residuals instead of autodiff, see project_joint.
+	bool use_analytic_jacobian = true;
 	float smoothing_factor;
 	int num_observation_views = 0;
 	one_frame_input *observation = nullptr;
@@ -57,6 +57,13 @@ optimizer_run(KinematicHandLM *hand,
               float &out_hand_size,
               float &out_reprojection_error);
 
+/*!
+ * Choose between the hand-derived Jacobian for the projection residuals (the default) and pushing autodiff jets
+ * through them. Both should converge to the same hand; this exists so the two can be compared.
+ */
+void
+optimizer_set_analytic_jacobian(KinematicHandLM *hand, bool use_analytic_jacobian);
+
 // Destructor
 void
 optimizer_destroy(KinematicHandLM **hand);
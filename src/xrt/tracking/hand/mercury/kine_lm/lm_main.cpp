@@ -440,19 +440,98 @@ calc_joint_rel_camera(const Vec3<T> &model_joint_pos,
 	UnitQuaternionRotatePoint(after_orientation, out_position, out_position);
 }
 
+template <typename T>
+static inline void
+project_joint_autodiff(const Vec3<T> &model_joint_pos_rel_camera_, Vec2<T> &out_stereographic, T &out_norm)
+{
+	out_norm = model_joint_pos_rel_camera_.norm();
+
+	Vec3<T> model_joint_pos_rel_camera = model_joint_pos_rel_camera_;
+	normalize_vector_inplace(model_joint_pos_rel_camera);
+	unit_vector_stereographic_projection(model_joint_pos_rel_camera, out_stereographic);
+}
+
+// Plain scalars and anything else that isn't a Jet: nothing to gain, always take the generic path.
+template <typename T>
+static inline void
+project_joint(const Vec3<T> &model_joint_pos_rel_camera,
+              bool use_analytic_jacobian,
+              Vec2<T> &out_stereographic,
+              T &out_norm)
+{
+	(void)use_analytic_jacobian;
+	project_joint_autodiff(model_joint_pos_rel_camera, out_stereographic, out_norm);
+}
+
+/*!
+ * Stereographic direction and distance of a camera-relative joint, with the derivative part worked out by hand.
+ *
+ * Pushing jets through normalize_vector_inplace and unit_vector_stereographic_projection costs a sqrt, four
+ * divisions and a pile of multiplications, each over the whole derivative vector. Here we evaluate on the real parts
+ * only and then apply the 3x3 chain rule once: each output's derivative is a linear combination of the three input
+ * derivative vectors.
+ *
+ * With r = |p| and d = r - p.z, the projection is s = (p.x / d, p.y / d) and d(d)/dp = p / r - (0, 0, 1), so
+ * ds.x/dp = ((1, 0, 0) - s.x * d(d)/dp) / d and likewise for s.y. d(r)/dp is just p / r.
+ */
+template <int N>
+static inline void
+project_joint(const Vec3<ceres::Jet<HandScalar, N>> &model_joint_pos_rel_camera,
+              bool use_analytic_jacobian,
+              Vec2<ceres::Jet<HandScalar, N>> &out_stereographic,
+              ceres::Jet<HandScalar, N> &out_norm)
+{
+	const HandScalar x = model_joint_pos_rel_camera.x.a;
+	const HandScalar y = model_joint_pos_rel_camera.y.a;
+	const HandScalar z = model_joint_pos_rel_camera.z.a;
+
+	const HandScalar r = sqrt(x * x + y * y + z * z);
+
+	// The degenerate case has its own special handling, let that code deal with it.
+	if (!use_analytic_jacobian || r <= FLT_EPSILON) {
+		project_joint_autodiff(model_joint_pos_rel_camera, out_stereographic, out_norm);
+		return;
+	}
+
+	const HandScalar inv_r = HandScalar(1) / r;
+	const HandScalar nx = x * inv_r;
+	const HandScalar ny = y * inv_r;
+	const HandScalar nz = z * inv_r;
+
+	// Same expressions as the generic path, so the real parts match it.
+	const HandScalar one_minus_nz = HandScalar(1) - nz;
+	const HandScalar sx = nx / one_minus_nz;
+	const HandScalar sy = ny / one_minus_nz;
+
+	const HandScalar inv_d = inv_r / one_minus_nz;
+	const HandScalar dd_z = nz - HandScalar(1);
+
+	const auto &vx = model_joint_pos_rel_camera.x.v;
+	const auto &vy = model_joint_pos_rel_camera.y.v;
+	const auto &vz = model_joint_pos_rel_camera.z.v;
+
+	out_stereographic.x.a = sx;
+	out_stereographic.x.v = ((HandScalar(1) - sx * nx) * inv_d) * vx + //
+	                        (-sx * ny * inv_d) * vy +                  //
+	                        (-sx * dd_z * inv_d) * vz;
+
+	out_stereographic.y.a = sy;
+	out_stereographic.y.v = (-sy * nx * inv_d) * vx +                  //
+	                        ((HandScalar(1) - sy * ny) * inv_d) * vy + //
+	                        (-sy * dd_z * inv_d) * vz;
+
+	out_norm.a = r;
+	out_norm.v = nx * vx + ny * vy + nz * vz;
+}
+
 template <typename T>
 static void
-diff_stereographic(const Vec3<T> &model_joint_pos_rel_camera_,
+diff_stereographic(const Vec2<T> &stereographic_model_dir,
                    const vec2_5 &observed_ray_sg,
                    const HandScalar confidence_xy,
                    const HandScalar stereographic_radius,
                    ResidualHelper<T> &helper)
 {
-	Vec3<T> model_joint_pos_rel_camera = model_joint_pos_rel_camera_;
-	normalize_vector_inplace(model_joint_pos_rel_camera);
-	Vec2<T> stereographic_model_dir;
-	unit_vector_stereographic_projection(model_joint_pos_rel_camera, stereographic_model_dir);
-
 	helper.AddValue((stereographic_model_dir.x - (T)(observed_ray_sg.pos_2d.x * stereographic_radius)) *
 	                confidence_xy);
 	helper.AddValue((stereographic_model_dir.y - (T)(observed_ray_sg.pos_2d.y * stereographic_radius)) *
@@ -543,11 +622,19 @@ CostFunctor_PositionsPart(const OptimizerHand<T> &hand,
 		cjrc(state, hand, translations_absolute, view, model_joints_rel_camera);
 		MLOutput2D &out = state.observation->views[view].keypoints_in_scaled_stereographic;
 
-		T middlepxmdepth = model_joints_rel_camera[Joint21::INDX_PXM].norm();
+		Vec2<T> model_joints_stereographic[21];
+		T model_joints_depth[21];
+
+		for (int i = 0; i < 21; i++) {
+			project_joint(model_joints_rel_camera[i], state.use_analytic_jacobian,
+			              model_joints_stereographic[i], model_joints_depth[i]);
+		}
+
+		T middlepxmdepth = model_joints_depth[Joint21::INDX_PXM];
 
 		for (int i = 0; i < 21; i++) {
 
-			diff_stereographic<T>(model_joints_rel_camera[i],                                          //
+			diff_stereographic<T>(model_joints_stereographic[i],                                       //
 			                      state.observation->views[view].keypoints_in_scaled_stereographic[i], //
 			                      out[i].confidence_xy,                                                //
 			                      stereographic_radius,                                                //
@@ -558,7 +645,7 @@ CostFunctor_PositionsPart(const OptimizerHand<T> &hand,
 				continue;
 			}
 			// depth part!
-			T rel_depth = model_joints_rel_camera[i].norm() - middlepxmdepth;
+			T rel_depth = model_joints_depth[i] - middlepxmdepth;
 			rel_depth /= hand.hand_size;
 
 
@@ -1118,6 +1205,12 @@ optimizer_create(xrt_pose left_in_right, bool is_right, u_logging_level log_leve
 	*out_kinematic_hand = hand;
 }
 
+void
+optimizer_set_analytic_jacobian(KinematicHandLM *hand, bool use_analytic_jacobian)
+{
+	hand->use_analytic_jacobian = use_analytic_jacobian;
+}
+
 void
 optimizer_destroy(KinematicHandLM **hand)
 {
@@ -17,6 +17,7 @@
 #include "util/u_debug.h"
 #include "util/u_logging.h"
 #include "util/u_trace_marker.h"
+#include "util/u_thread_policy.h"
 
 #include "tracking/t_hand_tracking.h"
 
@@ -36,7 +37,15 @@ struct ht_async_impl
 
 	struct t_hand_tracking_sync *provider;
 
-	struct xrt_frame *frames[2];
+	//! Left frame waiting for its right frame, protected by the mainloop lock.
+	struct xrt_frame *incoming_left;
+
+	/*!
+	 * Next stereo pair to process, protected by the mainloop lock. Filled
+	 * while the tracker is busy so work on it starts as soon as the current
+	 * pair is done, instead of idling until the next pair arrives.
+	 */
+	struct xrt_frame *pending[2];
 
 	bool use_prediction;
 	struct u_var_draggable_f32 prediction_offset_ms;
@@ -60,8 +69,6 @@ struct ht_async_impl
 	// cond is so that we can wake up the mainloop at certain times;
 	// running is so we can stop the thread when Monado exits
 	struct os_thread_helper mainloop;
-
-	volatile bool hand_tracking_work_active;
 };
 
 
@@ -81,6 +88,7 @@ static void *
 ht_async_mainloop(void *ptr)
 {
 	U_TRACE_SET_THREAD_NAME("Hand Tracking: Async");
+	u_thread_policy_apply(U_LOGGING_INFO, OS_THREAD_ROLE_TRACKING, "Hand Tracking: Async");
 
 	struct ht_async_impl *hta = (struct ht_async_impl *)ptr;
 
@@ -88,8 +96,8 @@ ht_async_mainloop(void *ptr)
 
 	while (os_thread_helper_is_running_locked(&hta->mainloop)) {
 
-		// No new frame, wait.
-		if (hta->frames[0] == NULL && hta->frames[1] == NULL) {
+		// No new frames, wait.
+		if (hta->pending[0] == NULL || hta->pending[1] == NULL) {
 			os_thread_helper_wait_locked(&hta->mainloop);
 
 			/*
@@ -100,6 +108,11 @@ ht_async_mainloop(void *ptr)
 			continue;
 		}
 
+		// Take over the references, the sinks can queue up the next pair.
+		struct xrt_frame *frames[2] = {hta->pending[0], hta->pending[1]};
+		hta->pending[0] = NULL;
+		hta->pending[1] = NULL;
+
 		os_thread_helper_unlock(&hta->mainloop);
 
 
@@ -109,14 +122,14 @@ ht_async_mainloop(void *ptr)
 
 		t_ht_sync_process(            //
 		    hta->provider,            //
-		    hta->frames[0],           //
-		    hta->frames[1],           //
+		    frames[0],                //
+		    frames[1],                //
 		    &hta->working.hands[0],   //
 		    &hta->working.hands[1],   //
 		    &hta->working.timestamp); //
 
-		xrt_frame_reference(&hta->frames[0], NULL);
-		xrt_frame_reference(&hta->frames[1], NULL);
+		xrt_frame_reference(&frames[0], NULL);
+		xrt_frame_reference(&frames[1], NULL);
 
 
 		/*
@@ -149,8 +162,6 @@ ht_async_mainloop(void *ptr)
 			    hta->working.timestamp);       //
 		}
 
-		hta->hand_tracking_work_active = false;
-
 		// Have to lock it again.
 		os_thread_helper_lock(&hta->mainloop);
 	}
@@ -172,17 +183,12 @@ ht_async_receive_left(struct xrt_frame_sink *sink, struct xrt_frame *frame)
 {
 	struct ht_async_impl *hta = ht_async_impl(container_of(sink, struct t_hand_tracking_async, left));
 
-	// See comment in ht_async_receive_right.
-	if (hta->hand_tracking_work_active) {
-		// Throw away this frame
-		return;
-	}
+	os_thread_helper_lock(&hta->mainloop);
 
-	// Ensure a strict left then right order of frames.
-	assert(hta->frames[0] == NULL);
+	// Keep onto this frame until the right frame arrives, replaces any unpaired left frame.
+	xrt_frame_reference(&hta->incoming_left, frame);
 
-	// Keep onto this frame.
-	xrt_frame_reference(&hta->frames[0], frame);
+	os_thread_helper_unlock(&hta->mainloop);
 }
 
 static void
@@ -190,28 +196,24 @@ ht_async_receive_right(struct xrt_frame_sink *sink, struct xrt_frame *frame)
 {
 	struct ht_async_impl *hta = ht_async_impl(container_of(sink, struct t_hand_tracking_async, right));
 
-	/*
-	 * Throw away this frame - either the hand tracking work is running now,
-	 * or it was a very short time ago, and ht_async_receive_left threw away
-	 * its frame or there's some other bug where left isn't pushed before
-	 * right.
-	 */
-	if (hta->hand_tracking_work_active || hta->frames[0] == NULL) {
+	os_thread_helper_lock(&hta->mainloop);
+
+	// Throw away this frame, there is no left frame to pair it with.
+	if (hta->incoming_left == NULL) {
+		os_thread_helper_unlock(&hta->mainloop);
 		return;
 	}
 
-	// Just to check the above.
-	assert(hta->frames[0] != NULL);
-	assert(hta->frames[1] == NULL);
-
-	// Keep onto this frame.
-	xrt_frame_reference(&hta->frames[1], frame);
-
-	// We have both frames, now work is active.
-	hta->hand_tracking_work_active = true;
+	/*
+	 * Replace any pair the mainloop hasn't picked up yet, the newest pair
+	 * is always the most useful one. Moves the left reference over.
+	 */
+	xrt_frame_reference(&hta->pending[0], NULL);
+	hta->pending[0] = hta->incoming_left;
+	hta->incoming_left = NULL;
+	xrt_frame_reference(&hta->pending[1], frame);
 
 	// Wake up the worker thread.
-	os_thread_helper_lock(&hta->mainloop);
 	os_thread_helper_signal_locked(&hta->mainloop);
 	os_thread_helper_unlock(&hta->mainloop);
 }
@@ -240,6 +242,11 @@ ht_async_destroy(struct xrt_frame_node *node)
 	os_thread_helper_destroy(&hta->mainloop);
 	os_mutex_destroy(&hta->present.mutex);
 
+	// The thread is stopped, drop any frames that never got processed.
+	xrt_frame_reference(&hta->incoming_left, NULL);
+	xrt_frame_reference(&hta->pending[0], NULL);
+	xrt_frame_reference(&hta->pending[1], NULL);
+
 	t_ht_sync_destroy(&hta->provider);
 
 	for (int i = 0; i < 2; i++) {
@@ -0,0 +1,87 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Batch IoU and non-maximum suppression tests.
+ */
+
+#include <util/u_box_iou.hpp>
+
+#include "catch_amalgamated.hpp"
+
+#include <vector>
+
+
+using namespace xrt::auxiliary::util::box_iou;
+
+TEST_CASE("boxIOUBatch")
+{
+	std::vector<Box> boxes = {
+	    Box(0.0f, 0.0f, 2.0f),         // Reference.
+	    Box(0.0f, 0.0f, 2.0f),         // Same.
+	    Box(1.0f, 0.0f, 2.0f),         // Half overlapping.
+	    Box(5.0f, 5.0f, 2.0f),         // Apart.
+	    Box(0.5f, -0.25f, 1.0f, 3.0f), // Odd shape.
+	};
+
+	BoxBatch batch = {};
+	for (const Box &box : boxes) {
+		batch.push_back(box);
+	}
+	REQUIRE(batch.size() == boxes.size());
+
+	std::vector<float> iou(boxes.size(), -1.0f);
+	boxIOUBatch(batch, 0, 1, iou.data());
+
+	// Before first is not touched.
+	CHECK(iou[0] == -1.0f);
+	CHECK(iou[1] == Catch::Approx(1.0f));
+	CHECK(iou[3] == 0.0f);
+
+	for (size_t i = 1; i < boxes.size(); i++) {
+		CHECK(iou[i] == Catch::Approx(boxIOU(boxes[0], boxes[i])));
+	}
+}
+
+TEST_CASE("nonMaximumSuppression")
+{
+	std::vector<size_t> kept = {};
+
+	SECTION("Empty")
+	{
+		nonMaximumSuppression({}, {}, 0.5f, 10, kept);
+		CHECK(kept.empty());
+	}
+
+	std::vector<Box> boxes = {
+	    Box(0.0f, 0.0f, 2.0f),  // 0
+	    Box(0.1f, 0.0f, 2.0f),  // 1, overlaps 0.
+	    Box(10.0f, 0.0f, 2.0f), // 2
+	    Box(10.0f, 0.2f, 2.0f), // 3, overlaps 2.
+	    Box(20.0f, 0.0f, 2.0f), // 4
+	};
+	std::vector<float> scores = {0.8f, 0.9f, 0.3f, 0.7f, 0.5f};
+
+	SECTION("Keeps the best of each cluster")
+	{
+		nonMaximumSuppression(boxes, scores, 0.5f, 10, kept);
+		REQUIRE(kept.size() == 3);
+		CHECK(kept[0] == 1);
+		CHECK(kept[1] == 3);
+		CHECK(kept[2] == 4);
+	}
+
+	SECTION("Stops at max kept")
+	{
+		nonMaximumSuppression(boxes, scores, 0.5f, 2, kept);
+		REQUIRE(kept.size() == 2);
+		CHECK(kept[0] == 1);
+		CHECK(kept[1] == 3);
+	}
+
+	SECTION("Threshold of one keeps everything")
+	{
+		nonMaximumSuppression(boxes, scores, 1.0f, 10, kept);
+		CHECK(kept.size() == boxes.size());
+	}
+}
@@ -0,0 +1,115 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Clock skew tracker tests.
+ */
+
+#include <math/m_clock_tracking.h>
+
+#include "catch_amalgamated.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+
+
+//! Remote clock that runs 50 ppm fast and has a large offset.
+static timepoint_ns
+remote_from_local(timepoint_ns local_ts)
+{
+	return 123456789000 + local_ts + local_ts / 20000;
+}
+
+//! Transmission delays of up to a millisecond, mostly small.
+static time_duration_ns
+delay(uint32_t &seed)
+{
+	seed = seed * 1664525 + 1013904223;
+	uint32_t r = (seed >> 8) % 1000;
+	return (time_duration_ns)(r * r) / 1000 * U_TIME_1MS_IN_NS / 1000;
+}
+
+TEST_CASE("m_clock_rls_skew_tracker")
+{
+	struct m_clock_rls_skew_tracker *t = m_clock_rls_skew_tracker_alloc(500);
+	REQUIRE(t != nullptr);
+
+	timepoint_ns out = 0;
+	CHECK_FALSE(m_clock_rls_skew_tracker_to_local(t, 0, &out));
+	CHECK_FALSE(m_clock_rls_skew_tracker_to_remote(t, 0, &out));
+
+	uint32_t seed = 1;
+	timepoint_ns local_ts = U_TIME_1S_IN_NS;
+
+	// Ten seconds of 1 kHz samples.
+	for (int i = 0; i < 10000; i++) {
+		local_ts += U_TIME_1MS_IN_NS;
+		m_clock_rls_skew_tracker_push(t, local_ts + delay(seed), remote_from_local(local_ts));
+	}
+
+	SECTION("Converts to local time")
+	{
+		// A bit into the future, checks that the drift is tracked.
+		timepoint_ns expected = local_ts + 100 * U_TIME_1MS_IN_NS;
+		REQUIRE(m_clock_rls_skew_tracker_to_local(t, remote_from_local(expected), &out));
+		CHECK(std::llabs(out - expected) < U_TIME_1MS_IN_NS / 2);
+	}
+
+	SECTION("Converts to remote time")
+	{
+		REQUIRE(m_clock_rls_skew_tracker_to_remote(t, local_ts, &out));
+		CHECK(std::llabs(out - remote_from_local(local_ts)) < U_TIME_1MS_IN_NS / 2);
+	}
+
+	SECTION("Restarts on clock jumps")
+	{
+		timepoint_ns jumped = local_ts + U_TIME_1S_IN_NS;
+		m_clock_rls_skew_tracker_push(t, local_ts + U_TIME_1MS_IN_NS, jumped);
+		REQUIRE(m_clock_rls_skew_tracker_to_local(t, jumped, &out));
+		CHECK(out == local_ts + U_TIME_1MS_IN_NS);
+	}
+
+	SECTION("Reset")
+	{
+		m_clock_rls_skew_tracker_reset(t);
+		CHECK_FALSE(m_clock_rls_skew_tracker_to_local(t, 0, &out));
+	}
+
+	m_clock_rls_skew_tracker_destroy(t);
+}
+
+TEST_CASE("m_clock_time_domain")
+{
+	struct m_clock_time_domain *imu = m_clock_time_domain_ref("test-device", 100);
+	struct m_clock_time_domain *cam = m_clock_time_domain_ref("test-device", 100);
+	struct m_clock_time_domain *other = m_clock_time_domain_ref("other-device", 100);
+	REQUIRE(imu != nullptr);
+	REQUIRE(other != nullptr);
+
+	// Same name, same clock.
+	CHECK(imu == cam);
+	CHECK(imu != other);
+
+	m_clock_time_domain_push(imu, 2000, 1000);
+
+	timepoint_ns out = 0;
+	REQUIRE(m_clock_time_domain_to_local(cam, 1500, &out));
+	CHECK(out == 2500);
+	CHECK_FALSE(m_clock_time_domain_to_local(other, 1500, &out));
+
+	m_clock_time_domain_unref(&cam);
+	CHECK(cam == nullptr);
+
+	// Still alive through the other reference.
+	REQUIRE(m_clock_time_domain_to_remote(imu, 2500, &out));
+	CHECK(out == 1500);
+
+	m_clock_time_domain_unref(&imu);
+	m_clock_time_domain_unref(&other);
+
+	// The last reference is gone, a new domain starts without an estimate.
+	imu = m_clock_time_domain_ref("test-device", 100);
+	REQUIRE(imu != nullptr);
+	CHECK_FALSE(m_clock_time_domain_to_local(imu, 1500, &out));
+	m_clock_time_domain_unref(&imu);
+}
@@ -0,0 +1,118 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief One Euro filter array tests.
+ */
+
+#include "math/m_api.h"
+#include "math/m_filter_one_euro.h"
+
+#include "util/u_time.h"
+
+#include "catch_amalgamated.hpp"
+
+#include <cmath>
+#include <vector>
+
+
+// Both hands, plus a few so the count is not a multiple of the SIMD width.
+static constexpr uint32_t Count = 55;
+static constexpr uint64_t InitialTime = 12345;
+static constexpr uint64_t StepSize = U_TIME_1MS_IN_NS * 11;
+
+static xrt_vec3
+make_vec3(uint32_t i, uint32_t step)
+{
+	float t = (float)step * 0.1f + (float)i;
+	return {std::sin(t), std::cos(t * 0.5f), (float)i * 0.01f + (float)(step % 3) * 0.002f};
+}
+
+static xrt_quat
+make_quat(uint32_t i, uint32_t step)
+{
+	xrt_vec3 axis = {1.0f, (float)i * 0.1f, 0.5f};
+	math_vec3_normalize(&axis);
+
+	xrt_quat q;
+	math_quat_from_angle_vector(std::sin((float)step * 0.2f + (float)i), &axis, &q);
+	return q;
+}
+
+TEST_CASE("m_filter_euro_vec3_array")
+{
+	std::vector<m_filter_euro_vec3> single(Count);
+	for (auto &f : single) {
+		m_filter_euro_vec3_init(&f, M_EURO_FILTER_HEAD_TRACKING_FCMIN, M_EURO_FILTER_HEAD_TRACKING_FCMIN_D,
+		                        M_EURO_FILTER_HEAD_TRACKING_BETA);
+	}
+
+	m_filter_euro_vec3_array array = {};
+	m_filter_euro_vec3_array_init(&array, Count, M_EURO_FILTER_HEAD_TRACKING_FCMIN,
+	                              M_EURO_FILTER_HEAD_TRACKING_FCMIN_D, M_EURO_FILTER_HEAD_TRACKING_BETA);
+
+	std::vector<xrt_vec3> in(Count);
+	std::vector<xrt_vec3> out(Count);
+
+	for (uint32_t step = 0; step < 50; step++) {
+		uint64_t ts = InitialTime + StepSize * step;
+		for (uint32_t i = 0; i < Count; i++) {
+			in[i] = make_vec3(i, step);
+		}
+
+		m_filter_euro_vec3_array_run(&array, ts, in.data(), out.data());
+
+		for (uint32_t i = 0; i < Count; i++) {
+			xrt_vec3 expected;
+			m_filter_euro_vec3_run(&single[i], ts, &in[i], &expected);
+
+			CAPTURE(step, i);
+			CHECK(out[i].x == Catch::Approx(expected.x).margin(0.0001));
+			CHECK(out[i].y == Catch::Approx(expected.y).margin(0.0001));
+			CHECK(out[i].z == Catch::Approx(expected.z).margin(0.0001));
+		}
+	}
+
+	m_filter_euro_vec3_array_fini(&array);
+	CHECK(array.prev_y[0] == nullptr);
+}
+
+TEST_CASE("m_filter_euro_quat_array")
+{
+	std::vector<m_filter_euro_quat> single(Count);
+	for (auto &f : single) {
+		m_filter_euro_quat_init(&f, M_EURO_FILTER_HEAD_TRACKING_FCMIN, M_EURO_FILTER_HEAD_TRACKING_FCMIN_D,
+		                        M_EURO_FILTER_HEAD_TRACKING_BETA);
+	}
+
+	m_filter_euro_quat_array array = {};
+	m_filter_euro_quat_array_init(&array, Count, M_EURO_FILTER_HEAD_TRACKING_FCMIN,
+	                              M_EURO_FILTER_HEAD_TRACKING_FCMIN_D, M_EURO_FILTER_HEAD_TRACKING_BETA);
+
+	std::vector<xrt_quat> data(Count);
+
+	for (uint32_t step = 0; step < 50; step++) {
+		uint64_t ts = InitialTime + StepSize * step;
+		for (uint32_t i = 0; i < Count; i++) {
+			data[i] = make_quat(i, step);
+		}
+
+		std::vector<xrt_quat> in = data;
+
+		// In place.
+		m_filter_euro_quat_array_run(&array, ts, data.data(), data.data());
+
+		for (uint32_t i = 0; i < Count; i++) {
+			xrt_quat expected;
+			m_filter_euro_quat_run(&single[i], ts, &in[i], &expected);
+
+			CAPTURE(step, i);
+			CHECK(data[i].x == Catch::Approx(expected.x).margin(0.00001));
+			CHECK(data[i].y == Catch::Approx(expected.y).margin(0.00001));
+			CHECK(data[i].z == Catch::Approx(expected.z).margin(0.00001));
+			CHECK(data[i].w == Catch::Approx(expected.w).margin(0.00001));
+		}
+	}
+
+	m_filter_euro_quat_array_fini(&array);
+}
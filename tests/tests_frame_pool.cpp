@@ -0,0 +1,70 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Frame pool tests.
+ */
+
+#include <util/u_frame_pool.h>
+
+#include "catch_amalgamated.hpp"
+
+
+TEST_CASE("u_frame_pool")
+{
+	u_frame_pool *pool = nullptr;
+	u_frame_pool_create("test", 2, &pool);
+	REQUIRE(pool != nullptr);
+
+	SECTION("reuses matching frames")
+	{
+		xrt_frame *xf = nullptr;
+		u_frame_pool_create_frame(pool, XRT_FORMAT_L8, 64, 32, &xf);
+		REQUIRE(xf != nullptr);
+		CHECK(xf->width == 64);
+		CHECK(xf->height == 32);
+		CHECK(xf->stride >= 64);
+		CHECK(xf->size >= 64 * 32);
+
+		xf->timestamp = 42;
+		uint8_t *data = xf->data;
+		xrt_frame_reference(&xf, nullptr);
+
+		u_frame_pool_create_frame(pool, XRT_FORMAT_L8, 64, 32, &xf);
+		CHECK(xf->data == data);
+		CHECK(xf->timestamp == 0);
+		CHECK(xf->reference.count == 1);
+		xrt_frame_reference(&xf, nullptr);
+	}
+
+	SECTION("does not reuse other formats or sizes")
+	{
+		xrt_frame *a = nullptr;
+		xrt_frame *b = nullptr;
+		xrt_frame *c = nullptr;
+		u_frame_pool_create_frame(pool, XRT_FORMAT_L8, 64, 32, &a);
+		u_frame_pool_create_frame(pool, XRT_FORMAT_R8G8B8, 64, 32, &b);
+		CHECK(b->format == XRT_FORMAT_R8G8B8);
+		CHECK(b->size >= 64 * 32 * 3);
+
+		xrt_frame_reference(&a, nullptr);
+		u_frame_pool_create_frame(pool, XRT_FORMAT_L8, 32, 32, &c);
+		CHECK(c->width == 32);
+
+		xrt_frame_reference(&b, nullptr);
+		xrt_frame_reference(&c, nullptr);
+	}
+
+	SECTION("frames outlive the pool")
+	{
+		xrt_frame *xf = nullptr;
+		u_frame_pool_create_frame(pool, XRT_FORMAT_L8, 16, 16, &xf);
+		u_frame_pool_destroy(&pool);
+		CHECK(pool == nullptr);
+
+		xf->data[0] = 1;
+		xrt_frame_reference(&xf, nullptr);
+	}
+
+	u_frame_pool_destroy(&pool);
+}
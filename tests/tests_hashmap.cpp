@@ -0,0 +1,249 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief u_hashmap_int and u_hashset tests.
+ */
+
+#include <util/u_hashmap.h>
+#include <util/u_hashset.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+
+
+static void *
+to_value(uint64_t v)
+{
+	return (void *)(uintptr_t)(v + 1);
+}
+
+TEST_CASE("u_hashmap_int")
+{
+	u_hashmap_int *hmi = nullptr;
+	REQUIRE(u_hashmap_int_create(&hmi) == 0);
+	REQUIRE(hmi != nullptr);
+	CHECK(u_hashmap_int_empty(hmi));
+
+	void *out = nullptr;
+	CHECK(u_hashmap_int_find(hmi, 0, &out) == -1);
+
+	SECTION("insert, overwrite and erase")
+	{
+		CHECK(u_hashmap_int_insert(hmi, 42, to_value(1)) == 0);
+		CHECK_FALSE(u_hashmap_int_empty(hmi));
+		CHECK(u_hashmap_int_find(hmi, 42, &out) == 0);
+		CHECK(out == to_value(1));
+
+		CHECK(u_hashmap_int_insert(hmi, 42, to_value(2)) == 0);
+		CHECK(u_hashmap_int_find(hmi, 42, &out) == 0);
+		CHECK(out == to_value(2));
+
+		CHECK(u_hashmap_int_erase(hmi, 42) == 0);
+		CHECK(u_hashmap_int_find(hmi, 42, &out) == -1);
+		CHECK(u_hashmap_int_empty(hmi));
+
+		// Erasing something not in the map is fine.
+		CHECK(u_hashmap_int_erase(hmi, 42) == 0);
+	}
+
+	SECTION("matches std::unordered_map with random operations")
+	{
+		std::unordered_map<uint64_t, void *> ref;
+		std::mt19937_64 rng(1234);
+
+		for (int i = 0; i < 20000; i++) {
+			// Small key range so we get plenty of hits, collisions and erases.
+			uint64_t key = rng() % 512;
+			switch (rng() % 3) {
+			case 0:
+			case 1:
+				u_hashmap_int_insert(hmi, key, to_value(i));
+				ref[key] = to_value(i);
+				break;
+			default:
+				u_hashmap_int_erase(hmi, key);
+				ref.erase(key);
+				break;
+			}
+		}
+
+		for (uint64_t key = 0; key < 512; key++) {
+			auto search = ref.find(key);
+			int ret = u_hashmap_int_find(hmi, key, &out);
+			if (search == ref.end()) {
+				CHECK(ret == -1);
+			} else {
+				CHECK(ret == 0);
+				CHECK(out == search->second);
+			}
+		}
+
+		std::map<uint64_t, void *> seen;
+		u_hashmap_int_for_each(
+		    hmi,
+		    [](const uint64_t key, const void *value, void *priv) {
+			    auto &s = *static_cast<std::map<uint64_t, void *> *>(priv);
+			    s[key] = const_cast<void *>(value);
+		    },
+		    &seen);
+		CHECK(seen == std::map<uint64_t, void *>(ref.begin(), ref.end()));
+	}
+
+	SECTION("clear and call for each")
+	{
+		for (uint64_t i = 0; i < 100; i++) {
+			u_hashmap_int_insert(hmi, i << 32, to_value(i));
+		}
+
+		size_t count = 0;
+		u_hashmap_int_clear_and_call_for_each(
+		    hmi, [](void *, void *priv) { (*static_cast<size_t *>(priv))++; }, &count);
+		CHECK(count == 100);
+		CHECK(u_hashmap_int_empty(hmi));
+
+		// Still usable after clearing.
+		CHECK(u_hashmap_int_insert(hmi, 7, to_value(7)) == 0);
+		CHECK(u_hashmap_int_find(hmi, 7, &out) == 0);
+	}
+
+	u_hashmap_int_destroy(&hmi);
+	CHECK(hmi == nullptr);
+}
+
+TEST_CASE("u_hashset")
+{
+	u_hashset *hs = nullptr;
+	REQUIRE(u_hashset_create(&hs) == 0);
+	REQUIRE(hs != nullptr);
+
+	u_hashset_item *item = nullptr;
+	u_hashset_item *found = nullptr;
+
+	CHECK(u_hashset_find_c_str(hs, "left", &found) == -1);
+
+	REQUIRE(u_hashset_create_and_insert_str_c(hs, "left", &item) == 0);
+	REQUIRE(item != nullptr);
+	CHECK(item->length == 4);
+	CHECK(std::string(item->c_str()) == "left");
+
+	CHECK(u_hashset_find_c_str(hs, "left", &found) == 0);
+	CHECK(found == item);
+
+	// Lengths are respected, not just the null terminator.
+	CHECK(u_hashset_find_str(hs, "leftover", 4, &found) == 0);
+	CHECK(found == item);
+	CHECK(u_hashset_find_c_str(hs, "lef", &found) == -1);
+
+	// Can't create the same string twice.
+	u_hashset_item *dup = nullptr;
+	CHECK(u_hashset_create_and_insert_str_c(hs, "left", &dup) == -1);
+
+	for (int i = 0; i < 200; i++) {
+		std::string str = "/user/hand/" + std::to_string(i);
+		u_hashset_item *tmp = nullptr;
+		CHECK(u_hashset_create_and_insert_str(hs, str.c_str(), str.size(), &tmp) == 0);
+	}
+	for (int i = 0; i < 200; i += 2) {
+		std::string str = "/user/hand/" + std::to_string(i);
+		CHECK(u_hashset_find_str(hs, str.c_str(), str.size(), &found) == 0);
+		CHECK(u_hashset_erase_str(hs, str.c_str(), str.size()) == 0);
+		free(found);
+	}
+	for (int i = 0; i < 200; i++) {
+		std::string str = "/user/hand/" + std::to_string(i);
+		CHECK(u_hashset_find_str(hs, str.c_str(), str.size(), &found) == ((i % 2) == 0 ? -1 : 0));
+	}
+
+	CHECK(u_hashset_erase_item(hs, item) == 0);
+	CHECK(u_hashset_find_c_str(hs, "left", &found) == -1);
+	free(item);
+
+	size_t count = 0;
+	u_hashset_clear_and_call_for_each(
+	    hs,
+	    [](u_hashset_item *it, void *priv) {
+		    (*static_cast<size_t *>(priv))++;
+		    free(it);
+	    },
+	    &count);
+	CHECK(count == 100);
+
+	u_hashset_destroy(&hs);
+	CHECK(hs == nullptr);
+}
+
+// Hidden by default, run with: tests_hashmap "[benchmark]"
+TEST_CASE("u_hashmap_int lookup", "[.][benchmark]")
+{
+	// Typical handle and path counts, and a big one that doesn't fit in the cache.
+	const size_t Count = GENERATE(64, 4096, 100000);
+	const std::string suffix = " " + std::to_string(Count) + " entries";
+
+	std::vector<uint64_t> keys(Count);
+	std::mt19937_64 rng(42);
+	for (uint64_t &key : keys) {
+		key = rng();
+	}
+
+	BENCHMARK("insert u_hashmap_int" + suffix)
+	{
+		u_hashmap_int *hmi = nullptr;
+		u_hashmap_int_create(&hmi);
+		for (uint64_t key : keys) {
+			u_hashmap_int_insert(hmi, key, to_value(key));
+		}
+		u_hashmap_int_destroy(&hmi);
+		return hmi;
+	};
+
+	BENCHMARK("insert std::unordered_map" + suffix)
+	{
+		std::unordered_map<uint64_t, void *> ref;
+		for (uint64_t key : keys) {
+			ref[key] = to_value(key);
+		}
+		return ref.size();
+	};
+
+	u_hashmap_int *hmi = nullptr;
+	u_hashmap_int_create(&hmi);
+	std::unordered_map<uint64_t, void *> ref;
+	for (uint64_t key : keys) {
+		u_hashmap_int_insert(hmi, key, to_value(key));
+		ref[key] = to_value(key);
+	}
+
+	// Look up in a different order than inserted, node based maps otherwise get sequential memory access.
+	std::shuffle(keys.begin(), keys.end(), rng);
+
+	BENCHMARK("find u_hashmap_int" + suffix)
+	{
+		uintptr_t sum = 0;
+		void *out = nullptr;
+		for (uint64_t key : keys) {
+			u_hashmap_int_find(hmi, key, &out);
+			sum += (uintptr_t)out;
+		}
+		return sum;
+	};
+
+	BENCHMARK("find std::unordered_map" + suffix)
+	{
+		uintptr_t sum = 0;
+		for (uint64_t key : keys) {
+			sum += (uintptr_t)ref.find(key)->second;
+		}
+		return sum;
+	};
+
+	u_hashmap_int_destroy(&hmi);
+}
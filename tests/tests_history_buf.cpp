@@ -1,4 +1,4 @@
-// Copyright 2021, Collabora, Ltd.
+// Copyright 2021-2025, Collabora, Ltd.
 // SPDX-License-Identifier: BSL-1.0
 /*!
  * @file
@@ -10,6 +10,9 @@
 #include <util/u_time.h>
 #include <util/u_template_historybuf.hpp>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 
 using xrt::auxiliary::util::HistoryBuffer;
@@ -31,7 +34,9 @@ TEST_CASE("m_relation_history")
 {
 	m_relation_history *rh = nullptr;
 
-	m_relation_history_create(&rh);
+	auto mode = GENERATE(M_RELATION_HISTORY_MODE_MUTEX, M_RELATION_HISTORY_MODE_SEQLOCK);
+	auto layout = GENERATE(M_RELATION_HISTORY_LAYOUT_FULL, M_RELATION_HISTORY_LAYOUT_COMPACT);
+	m_relation_history_create_with_layout(&rh, mode, layout);
 	SECTION("empty buffer")
 	{
 		xrt_space_relation out_relation = XRT_SPACE_RELATION_ZERO;
@@ -121,6 +126,179 @@ TEST_CASE("m_relation_history")
 	m_relation_history_destroy(&rh);
 }
 
+TEST_CASE("m_relation_history_layouts")
+{
+	m_relation_history *rh = nullptr;
+
+	constexpr int64_t T0 = 20 * (int64_t)U_TIME_1S_IN_NS;
+
+	xrt_space_relation relation = XRT_SPACE_RELATION_ZERO;
+	relation.relation_flags = XRT_SPACE_RELATION_BITMASK_ALL;
+	relation.pose.position = {1.f, 2.f, 3.f};
+	relation.pose.orientation = {0.f, 0.70710678f, 0.f, 0.70710678f};
+	relation.linear_velocity = {0.5f, -1.25f, 100.f};
+	relation.angular_velocity = {-3.f, 0.f, 7.5f};
+
+	xrt_space_relation out_relation = XRT_SPACE_RELATION_ZERO;
+	int64_t out_time = 0;
+
+	SECTION("compact quantizes velocities")
+	{
+		m_relation_history_create_with_layout(&rh, M_RELATION_HISTORY_MODE_MUTEX,
+		                                      M_RELATION_HISTORY_LAYOUT_COMPACT);
+		CHECK(m_relation_history_push(rh, &relation, T0));
+		CHECK(m_relation_history_get(rh, T0, &out_relation) == M_RELATION_HISTORY_RESULT_EXACT);
+
+		CHECK(out_relation.relation_flags == relation.relation_flags);
+		CHECK(out_relation.pose.position.y == relation.pose.position.y);
+		CHECK(out_relation.pose.orientation.w == relation.pose.orientation.w);
+		CHECK(out_relation.linear_velocity.x == Catch::Approx(0.5f).margin(0.001));
+		CHECK(out_relation.linear_velocity.y == Catch::Approx(-1.25f).margin(0.001));
+		// Out of range, clamped.
+		CHECK(out_relation.linear_velocity.z == Catch::Approx(32.f).margin(0.001));
+		CHECK(out_relation.angular_velocity.x == Catch::Approx(-3.f).margin(0.002));
+		CHECK(out_relation.angular_velocity.z == Catch::Approx(7.5f).margin(0.002));
+	}
+
+	SECTION("orientation only")
+	{
+		m_relation_history_create_with_layout(&rh, M_RELATION_HISTORY_MODE_SEQLOCK,
+		                                      M_RELATION_HISTORY_LAYOUT_ORIENTATION);
+		CHECK(m_relation_history_push(rh, &relation, T0));
+		CHECK_FALSE(m_relation_history_push(rh, &relation, T0));
+		CHECK(m_relation_history_get_latest(rh, &out_time, &out_relation));
+		CHECK(out_time == T0);
+
+		CHECK(out_relation.relation_flags == (XRT_SPACE_RELATION_ORIENTATION_VALID_BIT |
+		                                      XRT_SPACE_RELATION_ORIENTATION_TRACKED_BIT |
+		                                      XRT_SPACE_RELATION_ANGULAR_VELOCITY_VALID_BIT));
+		CHECK(out_relation.pose.orientation.y == relation.pose.orientation.y);
+		CHECK(out_relation.pose.position.x == 0.f);
+		CHECK(out_relation.linear_velocity.y == 0.f);
+		CHECK(out_relation.angular_velocity.z == Catch::Approx(7.5f).margin(0.002));
+
+		// Interpolates orientations just like the full layout.
+		relation.pose.orientation = {0.f, 0.f, 0.f, 1.f};
+		CHECK(m_relation_history_push(rh, &relation, T0 + (int64_t)U_TIME_1S_IN_NS));
+		CHECK(m_relation_history_get(rh, T0 + U_TIME_1S_IN_NS / 2, &out_relation) ==
+		      M_RELATION_HISTORY_RESULT_INTERPOLATED);
+		CHECK(out_relation.pose.orientation.y > 0.f);
+		CHECK(out_relation.pose.orientation.y < 0.70710678f);
+		CHECK(m_relation_history_get_size(rh) == 2);
+	}
+
+	m_relation_history_destroy(&rh);
+}
+
+
+static void
+push_position(m_relation_history *rh, float x, int64_t timestamp)
+{
+	xrt_space_relation relation = XRT_SPACE_RELATION_ZERO;
+	relation.relation_flags = (xrt_space_relation_flags)( //
+	    XRT_SPACE_RELATION_POSITION_VALID_BIT |           //
+	    XRT_SPACE_RELATION_ORIENTATION_VALID_BIT);        //
+	relation.pose.position.x = x;
+	m_relation_history_push(rh, &relation, timestamp);
+}
+
+TEST_CASE("m_relation_history concurrent writer")
+{
+	m_relation_history *rh = nullptr;
+
+	auto mode = GENERATE(M_RELATION_HISTORY_MODE_MUTEX, M_RELATION_HISTORY_MODE_SEQLOCK);
+	m_relation_history_create_with_mode(&rh, mode);
+
+	// Position x is always the timestamp in seconds, so any interpolated value is checkable.
+	constexpr int64_t T0 = 20 * (int64_t)U_TIME_1S_IN_NS;
+	constexpr int64_t Step = U_TIME_1MS_IN_NS;
+	constexpr int Count = 20000;
+
+	push_position(rh, (float)time_ns_to_s(T0), T0);
+
+	std::atomic<bool> done{false};
+	std::thread writer([&] {
+		for (int i = 1; i < Count; i++) {
+			int64_t ts = T0 + i * Step;
+			push_position(rh, (float)time_ns_to_s(ts), ts);
+		}
+		done = true;
+	});
+
+	int bad = 0;
+	int reads = 0;
+	while (!done || reads == 0) {
+		int64_t latest_ts = 0;
+		xrt_space_relation latest = XRT_SPACE_RELATION_ZERO;
+		if (!m_relation_history_get_latest(rh, &latest_ts, &latest) ||
+		    latest.pose.position.x != (float)time_ns_to_s(latest_ts)) {
+			bad++;
+		}
+
+		xrt_space_relation out = XRT_SPACE_RELATION_ZERO;
+		int64_t at = latest_ts - Step / 2;
+		if (m_relation_history_get(rh, at, &out) == M_RELATION_HISTORY_RESULT_INTERPOLATED &&
+		    std::abs(out.pose.position.x - (float)time_ns_to_s(at)) > 1e-3f) {
+			bad++;
+		}
+		reads++;
+	}
+	writer.join();
+
+	CHECK(bad == 0);
+	CHECK(m_relation_history_get_size(rh) == 4096);
+
+	m_relation_history_destroy(&rh);
+}
+
+// Hidden by default, run with: tests_history_buf "[benchmark]"
+TEST_CASE("m_relation_history contention", "[.][benchmark]")
+{
+	auto mode = GENERATE(M_RELATION_HISTORY_MODE_MUTEX, M_RELATION_HISTORY_MODE_SEQLOCK);
+	const char *name = mode == M_RELATION_HISTORY_MODE_SEQLOCK ? "seqlock" : "mutex";
+
+	m_relation_history *rh = nullptr;
+	m_relation_history_create_with_mode(&rh, mode);
+
+	constexpr int64_t T0 = 20 * (int64_t)U_TIME_1S_IN_NS;
+	constexpr int64_t Step = U_TIME_1MS_IN_NS;
+	for (int i = 0; i < 4096; i++) {
+		push_position(rh, (float)i, T0 + i * Step);
+	}
+
+	// One tracking thread pushing at a high rate plus a few other readers, like the compositor and IPC.
+	std::atomic<bool> stop{false};
+	std::atomic<int64_t> latest{T0 + 4095 * Step};
+	std::vector<std::thread> threads;
+	threads.emplace_back([&] {
+		for (int64_t i = 4096; !stop; i++) {
+			push_position(rh, (float)i, T0 + i * Step);
+			latest = T0 + i * Step;
+		}
+	});
+	for (int i = 0; i < 3; i++) {
+		threads.emplace_back([&] {
+			xrt_space_relation out;
+			while (!stop) {
+				m_relation_history_get(rh, latest - Step / 2, &out);
+			}
+		});
+	}
+
+	BENCHMARK(std::string("m_relation_history_get ") + name)
+	{
+		xrt_space_relation out;
+		return m_relation_history_get(rh, latest - Step / 2, &out);
+	};
+
+	stop = true;
+	for (auto &t : threads) {
+		t.join();
+	}
+
+	m_relation_history_destroy(&rh);
+}
+
 
 TEST_CASE("RelationHistory")
 {
@@ -391,6 +569,28 @@ TEST_CASE("u_template_historybuf")
 		CHECK(buffer.end() == std::find(buffer.begin(), buffer.end(), 5));
 
 		CHECK(++(buffer.begin()) == std::lower_bound(buffer.begin(), buffer.end(), 1));
+
+		CHECK(buffer.lower_bound_index(-1) == 0);
+		CHECK(buffer.lower_bound_index(0) == 0);
+		CHECK(buffer.lower_bound_index(1) == 1);
+		CHECK(buffer.lower_bound_index(2) == 1);
+		CHECK(buffer.lower_bound_index(4) == 2);
+		CHECK(buffer.lower_bound_index(5) == 3);
+	}
+
+	SECTION("lower_bound_index after wrapping")
+	{
+		// Wrap around several times so the oldest element is not at the start of the storage.
+		for (int i = 0; i < 17; i++) {
+			buffer.push_back(i * 2);
+		}
+		REQUIRE(buffer.size() == 4);
+
+		for (int value = 20; value <= 34; value++) {
+			CAPTURE(value);
+			auto it = std::lower_bound(buffer.begin(), buffer.end(), value);
+			CHECK(buffer.lower_bound_index(value) == (size_t)(it - buffer.begin()));
+		}
 	}
 }
 
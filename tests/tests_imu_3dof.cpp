@@ -0,0 +1,80 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief IMU 3dof fusion tests.
+ */
+
+#include <math/m_imu_3dof.h>
+#include <math/m_api.h>
+
+#include "catch_amalgamated.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+
+#define NUM_SAMPLES (4 * 2000)
+#define SAMPLES_PER_PACKET 4
+
+struct sample
+{
+	uint64_t timestamp_ns;
+	struct xrt_vec3 accel;
+	struct xrt_vec3 gyro;
+};
+
+//! Tilted resting device that is picked up and turned around now and then.
+static struct sample
+make_sample(int i)
+{
+	const float g = 9.82f;
+	const float tilt = 0.2f;
+
+	struct sample s = {};
+	s.timestamp_ns = 1000000000ull + (uint64_t)i * 1000000ull;
+	s.accel = {g * std::sin(tilt), g * std::cos(tilt), 0.0f};
+	if ((i / 1000) % 3 == 1) {
+		s.gyro = {0.0f, 0.5f * std::sin((float)i * 0.01f), 0.2f};
+	}
+
+	return s;
+}
+
+TEST_CASE("m_imu_3dof_update_batch")
+{
+	int flags = GENERATE(0, M_IMU_3DOF_USE_GRAVITY_DUR_20MS, M_IMU_3DOF_USE_GRAVITY_DUR_300MS);
+
+	struct m_imu_3dof single;
+	struct m_imu_3dof batch;
+	m_imu_3dof_init(&single, flags);
+	m_imu_3dof_init(&batch, flags);
+
+	for (int i = 0; i < NUM_SAMPLES; i += SAMPLES_PER_PACKET) {
+		uint64_t timestamps_ns[SAMPLES_PER_PACKET];
+		struct xrt_vec3 accels[SAMPLES_PER_PACKET];
+		struct xrt_vec3 gyros[SAMPLES_PER_PACKET];
+
+		for (int k = 0; k < SAMPLES_PER_PACKET; k++) {
+			struct sample s = make_sample(i + k);
+			m_imu_3dof_update(&single, s.timestamp_ns, &s.accel, &s.gyro);
+
+			timestamps_ns[k] = s.timestamp_ns;
+			accels[k] = s.accel;
+			gyros[k] = s.gyro;
+		}
+
+		m_imu_3dof_update_batch(&batch, timestamps_ns, accels, gyros, SAMPLES_PER_PACKET);
+	}
+
+	CHECK(batch.last.timestamp_ns == single.last.timestamp_ns);
+	CHECK(batch.grav.error_angle == Catch::Approx(single.grav.error_angle).margin(0.001));
+
+	// Same orientation, up to rounding.
+	struct xrt_quat diff;
+	math_quat_unrotate(&single.rot, &batch.rot, &diff);
+	CHECK(std::fabs(diff.w) == Catch::Approx(1.0f).margin(0.0001));
+
+	m_imu_3dof_close(&single);
+	m_imu_3dof_close(&batch);
+}
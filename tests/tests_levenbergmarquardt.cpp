@@ -25,16 +25,10 @@
 
 using namespace xrt::tracking::hand::mercury;
 
-TEST_CASE("LevenbergMarquardt")
+static void
+fill_fake_observation(one_frame_input &input)
 {
-	// This does very little at the moment:
-	// * It will explode if any floating point exceptions are generated
-	// * You should run it with `valgrind --track-origins=yes` (and compile without optimizations so that origin
-	// tracking works well) to see if we are using any uninitialized values.
-
-	fetestexcept(FE_ALL_EXCEPT);
-
-	struct one_frame_input input = {};
+	input = {};
 
 	for (int view = 0; view < 2; view++) {
 		input.views[view].active = true;
@@ -57,6 +51,19 @@ TEST_CASE("LevenbergMarquardt")
 			input.views[view].keypoints_in_scaled_stereographic[i].confidence_xy = 1.0f;
 		}
 	}
+}
+
+TEST_CASE("LevenbergMarquardt")
+{
+	// This does very little at the moment:
+	// * It will explode if any floating point exceptions are generated
+	// * You should run it with `valgrind --track-origins=yes` (and compile without optimizations so that origin
+	// tracking works well) to see if we are using any uninitialized values.
+
+	fetestexcept(FE_ALL_EXCEPT);
+
+	struct one_frame_input input = {};
+	fill_fake_observation(input);
 
 	lm::KinematicHandLM *hand;
 
@@ -84,3 +91,146 @@ TEST_CASE("LevenbergMarquardt")
 	CHECK(std::isfinite(out_reprojection_error));
 	CHECK(std::isfinite(out_hand_size));
 }
+
+// Model keypoint order, see Joint21.
+static const enum xrt_hand_joint joints_21[21] = {
+    XRT_HAND_JOINT_WRIST,
+
+    XRT_HAND_JOINT_THUMB_METACARPAL,
+    XRT_HAND_JOINT_THUMB_PROXIMAL,
+    XRT_HAND_JOINT_THUMB_DISTAL,
+    XRT_HAND_JOINT_THUMB_TIP,
+
+    XRT_HAND_JOINT_INDEX_PROXIMAL,
+    XRT_HAND_JOINT_INDEX_INTERMEDIATE,
+    XRT_HAND_JOINT_INDEX_DISTAL,
+    XRT_HAND_JOINT_INDEX_TIP,
+
+    XRT_HAND_JOINT_MIDDLE_PROXIMAL,
+    XRT_HAND_JOINT_MIDDLE_INTERMEDIATE,
+    XRT_HAND_JOINT_MIDDLE_DISTAL,
+    XRT_HAND_JOINT_MIDDLE_TIP,
+
+    XRT_HAND_JOINT_RING_PROXIMAL,
+    XRT_HAND_JOINT_RING_INTERMEDIATE,
+    XRT_HAND_JOINT_RING_DISTAL,
+    XRT_HAND_JOINT_RING_TIP,
+
+    XRT_HAND_JOINT_LITTLE_PROXIMAL,
+    XRT_HAND_JOINT_LITTLE_INTERMEDIATE,
+    XRT_HAND_JOINT_LITTLE_DISTAL,
+    XRT_HAND_JOINT_LITTLE_TIP,
+};
+
+// Project a solved hand back into both views, so we have an observation with a well defined minimum.
+static void
+fill_observation_from_hand(const xrt_hand_joint_set &hand,
+                           float hand_size,
+                           const xrt_pose &left_in_right,
+                           one_frame_input &input)
+{
+	fill_fake_observation(input);
+
+	for (int view = 0; view < 2; view++) {
+		one_frame_one_view &v = input.views[view];
+		xrt_vec3 pos[21];
+
+		for (int i = 0; i < 21; i++) {
+			pos[i] = hand.values.hand_joint_set_default[joints_21[i]].relation.pose.position;
+			if (view == 1) {
+				math_pose_transform_point(&left_in_right, &pos[i], &pos[i]);
+			}
+		}
+
+		float indx_pxm_depth = m_vec3_len(pos[Joint21::INDX_PXM]);
+
+		for (int i = 0; i < 21; i++) {
+			xrt_vec3 dir = m_vec3_normalize(pos[i]);
+
+			v.keypoints_in_scaled_stereographic[i].pos_2d.x = dir.x / (1 - dir.z) / v.stereographic_radius;
+			v.keypoints_in_scaled_stereographic[i].pos_2d.y = dir.y / (1 - dir.z) / v.stereographic_radius;
+			v.keypoints_in_scaled_stereographic[i].depth_relative_to_midpxm =
+			    (m_vec3_len(pos[i]) - indx_pxm_depth) / hand_size;
+		}
+	}
+}
+
+static double
+run_frames(bool use_analytic_jacobian,
+           const xrt_pose &left_in_right,
+           const one_frame_input &observation,
+           int num_frames,
+           xrt_hand_joint_set &out,
+           float &out_hand_size,
+           float &out_reprojection_error)
+{
+	lm::KinematicHandLM *hand;
+
+	lm::optimizer_create(left_in_right, false, U_LOGGING_WARN, &hand);
+	lm::optimizer_set_analytic_jacobian(hand, use_analytic_jacobian);
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < num_frames; i++) {
+		// The optimizer mutates the observation.
+		struct one_frame_input input = observation;
+
+		lm::optimizer_run(hand,          //
+		                  input,         //
+		                  i == 0,        //
+		                  2.0f,          //
+		                  false,         //
+		                  0.09,          //
+		                  0.5,           //
+		                  0.5f,          //
+		                  out,           //
+		                  out_hand_size, //
+		                  out_reprojection_error);
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	lm::optimizer_destroy(&hand);
+
+	return std::chrono::duration<double, std::milli>(end - start).count() / num_frames;
+}
+
+TEST_CASE("LevenbergMarquardtAnalyticJacobian")
+{
+	constexpr int num_frames = 10;
+
+	xrt_pose left_in_right = XRT_POSE_IDENTITY;
+	left_in_right.position.x = 0.1;
+
+	// Get some plausible hand out of the optimizer, then use that as ground truth.
+	xrt_hand_joint_set truth = {};
+	float truth_hand_size = 0.0f;
+	float truth_error = 0.0f;
+	struct one_frame_input observation = {};
+	fill_fake_observation(observation);
+	run_frames(true, left_in_right, observation, num_frames, truth, truth_hand_size, truth_error);
+	fill_observation_from_hand(truth, truth_hand_size, left_in_right, observation);
+
+	xrt_hand_joint_set autodiff = {};
+	xrt_hand_joint_set analytic = {};
+	float hand_size = 0.0f;
+	float autodiff_error = 0.0f;
+	float analytic_error = 0.0f;
+
+	double autodiff_ms =
+	    run_frames(false, left_in_right, observation, num_frames, autodiff, hand_size, autodiff_error);
+	double analytic_ms =
+	    run_frames(true, left_in_right, observation, num_frames, analytic, hand_size, analytic_error);
+
+	U_LOG_I("Per frame: autodiff %f ms, analytic %f ms", autodiff_ms, analytic_ms);
+	U_LOG_I("Reprojection error: autodiff %f, analytic %f", autodiff_error, analytic_error);
+
+	REQUIRE(std::isfinite(analytic_error));
+	CHECK(analytic_error == Catch::Approx(autodiff_error).epsilon(0.01).margin(1e-4));
+
+	for (int i = 0; i < XRT_HAND_JOINT_COUNT; i++) {
+		xrt_vec3 a = autodiff.values.hand_joint_set_default[i].relation.pose.position;
+		xrt_vec3 b = analytic.values.hand_joint_set_default[i].relation.pose.position;
+
+		// Both paths should land on the same hand, to well under a millimeter.
+		CHECK(m_vec3_len(m_vec3_sub(a, b)) < 0.0005f);
+	}
+}
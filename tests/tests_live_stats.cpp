@@ -0,0 +1,99 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief u_live_stats_ns tests.
+ */
+
+#include <util/u_live_stats.h>
+#include <util/u_time.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+
+
+TEST_CASE("u_live_stats_ns")
+{
+	// Big struct, keep it off the stack.
+	auto uls = std::make_unique<u_live_stats_ns>();
+
+	uint64_t median = 1, mean = 1, worst = 1;
+
+	SECTION("empty")
+	{
+		CHECK(u_ls_ns_get_percentile(uls.get(), 50.0) == 0);
+		u_ls_ns_get_and_reset(uls.get(), &median, &mean, &worst);
+		CHECK(median == 0);
+		CHECK(mean == 0);
+		CHECK(worst == 0);
+	}
+
+	SECTION("small values are exact")
+	{
+		for (uint64_t v = 1; v <= 9; v++) {
+			CHECK_FALSE(u_ls_ns_add(uls.get(), v));
+		}
+		CHECK(u_ls_ns_get_percentile(uls.get(), 0.0) == 1);
+		CHECK(u_ls_ns_get_percentile(uls.get(), 100.0) == 9);
+
+		u_ls_ns_get_and_reset(uls.get(), &median, &mean, &worst);
+		CHECK(median == 5);
+		CHECK(mean == 5);
+		CHECK(worst == 9);
+		CHECK(uls->value_count == 0);
+	}
+
+	SECTION("full after value count")
+	{
+		for (uint32_t i = 0; i < U_LIVE_STATS_VALUE_COUNT - 1; i++) {
+			CHECK_FALSE(u_ls_ns_add(uls.get(), U_TIME_1MS_IN_NS));
+		}
+		CHECK(u_ls_ns_add(uls.get(), U_TIME_1MS_IN_NS));
+
+		// Keeps accepting values.
+		CHECK(u_ls_ns_add(uls.get(), U_TIME_1MS_IN_NS));
+		CHECK(uls->value_count == U_LIVE_STATS_VALUE_COUNT + 1);
+	}
+
+	SECTION("percentiles match sorting within precision")
+	{
+		std::mt19937_64 rng(5);
+		std::lognormal_distribution<double> dist(15.0, 0.5); // Around 3ms with a long tail.
+
+		std::vector<uint64_t> values;
+		for (int i = 0; i < 10000; i++) {
+			uint64_t v = (uint64_t)dist(rng);
+			values.push_back(v);
+			u_ls_ns_add(uls.get(), v);
+		}
+		std::sort(values.begin(), values.end());
+
+		for (double p : {1.0, 25.0, 50.0, 90.0, 99.0, 99.9}) {
+			uint64_t expected = values[(size_t)(p / 100.0 * values.size())];
+			uint64_t got = u_ls_ns_get_percentile(uls.get(), p);
+			CHECK((double)got == Catch::Approx((double)expected).epsilon(0.01));
+		}
+
+		uint64_t sum = 0;
+		for (uint64_t v : values) {
+			sum += v;
+		}
+
+		u_ls_ns_get_and_reset(uls.get(), &median, &mean, &worst);
+		CHECK(mean == sum / values.size());
+		CHECK(worst == values.back());
+	}
+
+	SECTION("huge values go in the last bucket")
+	{
+		u_ls_ns_add(uls.get(), UINT64_MAX / 2);
+		u_ls_ns_add(uls.get(), 10);
+		CHECK(u_ls_ns_get_percentile(uls.get(), 100.0) == UINT64_MAX / 2);
+		CHECK(u_ls_ns_get_percentile(uls.get(), 0.0) == 10);
+	}
+}
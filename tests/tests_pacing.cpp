@@ -17,6 +17,7 @@
 #include <sstream>
 #include <iomanip>
 #include <queue>
+#include <vector>
 
 using namespace std::chrono_literals;
 using namespace std::chrono;
@@ -402,3 +403,190 @@ TEST_CASE("u_pacing_compositor_fake")
 	}
 	u_pc_destroy(&upc);
 }
+
+namespace {
+
+struct AppFrameResult
+{
+	int64_t wake_up_time_ns{0};
+	int64_t predicted_display_time_ns{0};
+	int64_t predicted_display_period_ns{0};
+	int64_t gpu_done_ns{0};
+};
+
+//! One frame of app timings, like the deltas in a u_metrics session frame.
+struct AppFrameTimings
+{
+	unanoseconds cpu;
+	unanoseconds draw;
+	unanoseconds gpu;
+};
+
+} // namespace
+
+// Matches the default U_PACING_APP_MIN_MARGIN_MS, no extra compositor time is given.
+static constexpr unanoseconds appMargin(2ms);
+
+static AppFrameResult
+doAppFrame(u_pacing_app *upa, MockClock &clock, unanoseconds app_period, AppFrameTimings const &timings)
+{
+	// The compositor tells us about the next display time, displays at multiples of the period.
+	int64_t next_display_ns = clock.now() - (clock.now() % app_period.count()) + app_period.count();
+	u_pa_info(upa, next_display_ns, app_period.count(), 0);
+
+	AppFrameResult result;
+	int64_t frame_id = 0;
+	u_pa_predict(upa, clock.now(), &frame_id, &result.wake_up_time_ns, &result.predicted_display_time_ns,
+	             &result.predicted_display_period_ns);
+	CHECK(result.predicted_display_time_ns > clock.now());
+
+	clock.advance_to(std::max(result.wake_up_time_ns, clock.now()));
+	u_pa_mark_point(upa, frame_id, U_TIMING_POINT_WAKE_UP, clock.now());
+
+	clock.advance(timings.cpu);
+	u_pa_mark_point(upa, frame_id, U_TIMING_POINT_BEGIN, clock.now());
+
+	clock.advance(timings.draw);
+	u_pa_mark_delivered(upa, frame_id, clock.now(), result.predicted_display_time_ns);
+
+	clock.advance(timings.gpu);
+	u_pa_mark_gpu_done(upa, frame_id, clock.now());
+	result.gpu_done_ns = clock.now();
+
+	return result;
+}
+
+static int64_t
+doAppFrame(u_pacing_app *upa, MockClock &clock, unanoseconds app_period, unanoseconds gpu_time)
+{
+	return doAppFrame(upa, clock, app_period, {1ms, 1ms, gpu_time}).predicted_display_period_ns;
+}
+
+//! Replays a trace of app timings, returns the number of frames that missed the compositor.
+static int
+replayAppTrace(u_pacing_app *upa,
+               MockClock &clock,
+               unanoseconds app_period,
+               std::vector<AppFrameTimings> const &trace,
+               unanoseconds &out_last_lead_time)
+{
+	int missed = 0;
+
+	for (auto const &timings : trace) {
+		AppFrameResult result = doAppFrame(upa, clock, app_period, timings);
+		if (result.gpu_done_ns > result.predicted_display_time_ns - appMargin.count()) {
+			missed++;
+		}
+
+		out_last_lead_time = unanoseconds(result.predicted_display_time_ns - result.wake_up_time_ns);
+	}
+
+	return missed;
+}
+
+//! Deterministic app timings with uniform jitter on the GPU time.
+static std::vector<AppFrameTimings>
+makeAppTrace(size_t count, unanoseconds gpu_min, unanoseconds gpu_max)
+{
+	std::vector<AppFrameTimings> trace;
+	uint32_t state = 1;
+	for (size_t i = 0; i < count; ++i) {
+		state = state * 1664525u + 1013904223u; // LCG
+		auto range = (gpu_max - gpu_min).count();
+		auto gpu = gpu_min + unanoseconds((int64_t)(state >> 8) % (range + 1));
+		trace.push_back({500us, 1ms, gpu});
+	}
+	return trace;
+}
+
+TEST_CASE("u_pacing_app_period")
+{
+	static constexpr unanoseconds app_period(11ms);
+
+	MockClock clock;
+	clock.advance(1s);
+
+	u_pacing_app_factory *upaf = nullptr;
+	REQUIRE(XRT_SUCCESS == u_pa_factory_create(&upaf));
+	u_pacing_app *upa = nullptr;
+	u_paf_create(upaf, &upa);
+	REQUIRE(upa != nullptr);
+
+	SECTION("Fast app runs at display rate")
+	{
+		for (int i = 0; i < 100; ++i) {
+			CHECK(doAppFrame(upa, clock, app_period, 3ms) == app_period.count());
+		}
+	}
+
+	SECTION("App on the edge sticks to half rate")
+	{
+		// Get over the edge.
+		for (int i = 0; i < 20; ++i) {
+			doAppFrame(upa, clock, app_period, 13ms);
+		}
+
+		// Jitter around the display period, should not bounce between rates.
+		for (int i = 0; i < 200; ++i) {
+			auto gpu_time = (i % 2) == 0 ? 10ms : 12ms;
+			CHECK(doAppFrame(upa, clock, app_period, gpu_time) == 2 * app_period.count());
+		}
+
+		// Once it is comfortably fast again it goes back up.
+		int64_t period_ns = 0;
+		for (int i = 0; i < 200; ++i) {
+			period_ns = doAppFrame(upa, clock, app_period, 3ms);
+		}
+		CHECK(period_ns == app_period.count());
+	}
+
+	u_pa_destroy(&upa);
+	u_paf_destroy(&upaf);
+}
+
+TEST_CASE("u_pacing_app_replay")
+{
+	static constexpr unanoseconds app_period(11ms);
+
+	MockClock clock;
+	clock.advance(1s);
+
+	u_pacing_app_factory *upaf = nullptr;
+	REQUIRE(XRT_SUCCESS == u_pa_factory_create(&upaf));
+	u_pacing_app *upa = nullptr;
+	u_paf_create(upaf, &upa);
+	REQUIRE(upa != nullptr);
+
+	unanoseconds lead_time{0};
+
+	SECTION("Stable app gets little extra latency")
+	{
+		auto trace = makeAppTrace(300, 4ms, 4ms);
+
+		// Let the estimates settle.
+		replayAppTrace(upa, clock, app_period, {trace.begin(), trace.begin() + 50}, lead_time);
+
+		int missed = replayAppTrace(upa, clock, app_period, {trace.begin() + 50, trace.end()}, lead_time);
+		CHECK(missed == 0);
+
+		// Once settled only the app time plus margin, with some slack for the filtering.
+		CHECK(lead_time < 500us + 1ms + 4ms + appMargin + 200us);
+	}
+
+	SECTION("Jittery app rarely misses")
+	{
+		auto trace = makeAppTrace(1000, 2ms, 8ms);
+
+		// Let the estimates settle.
+		replayAppTrace(upa, clock, app_period, {trace.begin(), trace.begin() + 50}, lead_time);
+
+		int missed = replayAppTrace(upa, clock, app_period, {trace.begin() + 50, trace.end()}, lead_time);
+		INFO(missed);
+
+		// Default target is 2%, uniform jitter isn't normal so allow some more.
+		CHECK(missed < 950 * 5 / 100);
+	}
+
+	u_pa_destroy(&upa);
+	u_paf_destroy(&upaf);
+}
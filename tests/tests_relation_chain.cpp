@@ -237,3 +237,103 @@ TEST_CASE("Relation Chain Flags")
 		TEST_FLAGS(XRT_SPACE_RELATION_POSITION_VALID_BIT, VNT, ONLY_POSITION, P);
 	}
 }
+
+
+/*
+ *
+ * Batch apply
+ *
+ */
+
+static void
+check_relation_approx(const xrt_space_relation &a, const xrt_space_relation &b)
+{
+	CHECK(a.relation_flags == b.relation_flags);
+	CHECK(a.pose.position.x == Catch::Approx(b.pose.position.x).margin(0.0001));
+	CHECK(a.pose.position.y == Catch::Approx(b.pose.position.y).margin(0.0001));
+	CHECK(a.pose.position.z == Catch::Approx(b.pose.position.z).margin(0.0001));
+	CHECK(a.pose.orientation.x == Catch::Approx(b.pose.orientation.x).margin(0.0001));
+	CHECK(a.pose.orientation.y == Catch::Approx(b.pose.orientation.y).margin(0.0001));
+	CHECK(a.pose.orientation.z == Catch::Approx(b.pose.orientation.z).margin(0.0001));
+	CHECK(a.pose.orientation.w == Catch::Approx(b.pose.orientation.w).margin(0.0001));
+	CHECK(a.linear_velocity.x == Catch::Approx(b.linear_velocity.x).margin(0.0001));
+	CHECK(a.linear_velocity.y == Catch::Approx(b.linear_velocity.y).margin(0.0001));
+	CHECK(a.linear_velocity.z == Catch::Approx(b.linear_velocity.z).margin(0.0001));
+	CHECK(a.angular_velocity.x == Catch::Approx(b.angular_velocity.x).margin(0.0001));
+	CHECK(a.angular_velocity.y == Catch::Approx(b.angular_velocity.y).margin(0.0001));
+	CHECK(a.angular_velocity.z == Catch::Approx(b.angular_velocity.z).margin(0.0001));
+}
+
+TEST_CASE("Relation Apply Array")
+{
+	xrt_space_relation base = {
+	    XRT_SPACE_RELATION_BITMASK_ALL,
+	    {{0.0f, 0.38268343f, 0.0f, 0.92387953f}, {1.0f, 2.0f, 3.0f}},
+	    {0.5f, 0.0f, -0.25f},
+	    {0.0f, 1.0f, 0.5f},
+	};
+
+	// More than one chunk, with a mix of flags.
+	constexpr uint32_t count = 70;
+	xrt_space_relation in[count];
+	for (uint32_t i = 0; i < count; i++) {
+		float f = (float)i;
+		xrt_space_relation r = {
+		    XRT_SPACE_RELATION_BITMASK_ALL,
+		    {{0.0f, 0.0f, 0.0f, 1.0f}, {f * 0.1f, -f * 0.05f, 0.2f}},
+		    {0.1f, f * 0.01f, 0.0f},
+		    {f * 0.02f, 0.0f, -0.3f},
+		};
+		math_quat_from_angle_vector(f * 0.1f, &r.pose.position, &r.pose.orientation);
+		math_quat_normalize(&r.pose.orientation);
+
+		switch (i % 5) {
+		case 1: r = kSpaceRelationOnlyOrientation; break;
+		case 2: r = kSpaceRelationOnlyPosition; break;
+		case 3: r = kSpaceRelationNotValid; break;
+		default: break;
+		}
+
+		in[i] = r;
+	}
+
+	SECTION("Matches chain resolve")
+	{
+		xrt_space_relation out[count];
+		m_space_relation_apply_array(&base, in, out, count);
+
+		for (uint32_t i = 0; i < count; i++) {
+			xrt_relation_chain xrc{};
+			m_relation_chain_push_relation(&xrc, &in[i]);
+			m_relation_chain_push_relation(&xrc, &base);
+
+			xrt_space_relation expected;
+			m_relation_chain_resolve(&xrc, &expected);
+
+			CAPTURE(i);
+			check_relation_approx(out[i], expected);
+		}
+	}
+
+	SECTION("In place")
+	{
+		xrt_space_relation out[count];
+		m_space_relation_apply_array(&base, in, out, count);
+
+		m_space_relation_apply_array(&base, in, in, count);
+		for (uint32_t i = 0; i < count; i++) {
+			CAPTURE(i);
+			check_relation_approx(in[i], out[i]);
+		}
+	}
+
+	SECTION("Base without pose")
+	{
+		xrt_space_relation out[count];
+		m_space_relation_apply_array(&kSpaceRelationNotValid, in, out, count);
+
+		for (uint32_t i = 0; i < count; i++) {
+			CHECK(out[i].relation_flags == XRT_SPACE_RELATION_BITMASK_NONE);
+		}
+	}
+}
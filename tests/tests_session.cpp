@@ -0,0 +1,104 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief u_session event queue tests.
+ */
+
+#include <util/u_session.h>
+
+#include <thread>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+
+
+static union xrt_session_event
+make_event(int64_t id)
+{
+	union xrt_session_event xse = {};
+	xse.ref_change.event_type = XRT_SESSION_EVENT_REFERENCE_SPACE_CHANGE_PENDING;
+	xse.ref_change.timestamp_ns = id;
+	return xse;
+}
+
+TEST_CASE("u_session_events")
+{
+	struct u_session *us = u_session_create(NULL);
+	REQUIRE(us != nullptr);
+
+	union xrt_session_event xse;
+
+	SECTION("Empty")
+	{
+		u_session_event_pop(us, &xse);
+		CHECK(xse.type == XRT_SESSION_EVENT_NONE);
+	}
+
+	SECTION("In order past the ring size")
+	{
+		const int64_t count = U_SESSION_EVENT_RING_SIZE * 3;
+		for (int64_t i = 0; i < count; i++) {
+			union xrt_session_event in = make_event(i);
+			u_session_event_push(us, &in);
+		}
+
+		// Interleave pushes while draining the overflow.
+		for (int64_t i = 0; i < count * 2; i++) {
+			u_session_event_pop(us, &xse);
+			REQUIRE(xse.type == XRT_SESSION_EVENT_REFERENCE_SPACE_CHANGE_PENDING);
+			CHECK(xse.ref_change.timestamp_ns == i);
+
+			union xrt_session_event in = make_event(count + i);
+			u_session_event_push(us, &in);
+		}
+
+		for (int64_t i = count * 2; i < count * 3; i++) {
+			u_session_event_pop(us, &xse);
+			CHECK(xse.ref_change.timestamp_ns == i);
+		}
+
+		u_session_event_pop(us, &xse);
+		CHECK(xse.type == XRT_SESSION_EVENT_NONE);
+	}
+
+	SECTION("Concurrent producers")
+	{
+		const int thread_count = 4;
+		const int64_t per_thread = 1000;
+
+		std::vector<std::thread> threads;
+		for (int t = 0; t < thread_count; t++) {
+			threads.emplace_back([us, t, per_thread] {
+				for (int64_t i = 0; i < per_thread; i++) {
+					union xrt_session_event in = make_event(t * per_thread + i);
+					u_session_event_push(us, &in);
+				}
+			});
+		}
+
+		// Every producer's events come out in the order they were pushed.
+		std::vector<int64_t> next(thread_count, 0);
+		int64_t popped = 0;
+		while (popped < thread_count * per_thread) {
+			u_session_event_pop(us, &xse);
+			if (xse.type == XRT_SESSION_EVENT_NONE) {
+				std::this_thread::yield();
+				continue;
+			}
+
+			int64_t id = xse.ref_change.timestamp_ns;
+			int t = (int)(id / per_thread);
+			REQUIRE(id % per_thread == next[t]);
+			next[t]++;
+			popped++;
+		}
+
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+	}
+
+	struct xrt_session *xs = &us->base;
+	xrt_session_destroy(&xs);
+}
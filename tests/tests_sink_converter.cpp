@@ -0,0 +1,138 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Frame conversion kernel tests and benchmarks.
+ */
+
+#include <util/u_sink_converter_simd.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+
+
+static std::vector<uint8_t>
+make_random(size_t size, uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> dist(0, 255);
+
+	std::vector<uint8_t> data(size);
+	for (auto &v : data) {
+		v = (uint8_t)dist(rng);
+	}
+
+	return data;
+}
+
+static std::vector<const u_sink_converter_funcs *>
+get_simd_funcs()
+{
+	std::vector<const u_sink_converter_funcs *> ret;
+	for (auto simd : {U_SINK_CONVERTER_SIMD_SSE41, U_SINK_CONVERTER_SIMD_AVX2, U_SINK_CONVERTER_SIMD_NEON}) {
+		const u_sink_converter_funcs *funcs = u_sink_converter_simd_get_funcs(simd);
+		if (funcs != nullptr) {
+			ret.push_back(funcs);
+		}
+	}
+	return ret;
+}
+
+TEST_CASE("u_sink_converter_simd")
+{
+	const u_sink_converter_funcs *scalar = u_sink_converter_simd_get_funcs(U_SINK_CONVERTER_SIMD_SCALAR);
+	REQUIRE(scalar != nullptr);
+	REQUIRE(u_sink_converter_simd_get_best_funcs() != nullptr);
+
+	// Covers no SIMD iterations, exact multiples and tails.
+	const uint32_t w = GENERATE(2u, 16u, 18u, 46u, 1280u);
+
+	std::vector<uint8_t> src0 = make_random(w * 2, 1);
+	std::vector<uint8_t> src1 = make_random(w * 2, 2);
+	std::vector<uint8_t> expected(w * 3);
+	std::vector<uint8_t> actual(w * 3);
+
+	for (const u_sink_converter_funcs *funcs : get_simd_funcs()) {
+		INFO("funcs: " << funcs->name << " w: " << w);
+
+		SECTION(std::string("yuyv422_to_r8g8b8 ") + funcs->name)
+		{
+			scalar->yuyv422_to_r8g8b8(src0.data(), expected.data(), w);
+			funcs->yuyv422_to_r8g8b8(src0.data(), actual.data(), w);
+			CHECK(expected == actual);
+		}
+
+		SECTION(std::string("uyvy422_to_r8g8b8 ") + funcs->name)
+		{
+			scalar->uyvy422_to_r8g8b8(src0.data(), expected.data(), w);
+			funcs->uyvy422_to_r8g8b8(src0.data(), actual.data(), w);
+			CHECK(expected == actual);
+		}
+
+		SECTION(std::string("yuyv422_to_l8 ") + funcs->name)
+		{
+			scalar->yuyv422_to_l8(src0.data(), expected.data(), w);
+			funcs->yuyv422_to_l8(src0.data(), actual.data(), w);
+			CHECK(expected == actual);
+		}
+
+		SECTION(std::string("l8_to_r8g8b8 ") + funcs->name)
+		{
+			scalar->l8_to_r8g8b8(src0.data(), expected.data(), w);
+			funcs->l8_to_r8g8b8(src0.data(), actual.data(), w);
+			CHECK(expected == actual);
+		}
+
+		SECTION(std::string("bayer_gr8_to_r8g8b8 ") + funcs->name)
+		{
+			scalar->bayer_gr8_to_r8g8b8(src0.data(), src1.data(), expected.data(), w);
+			funcs->bayer_gr8_to_r8g8b8(src0.data(), src1.data(), actual.data(), w);
+			CHECK(expected == actual);
+		}
+	}
+}
+
+// Hidden by default, run with: tests_sink_converter "[benchmark]"
+TEST_CASE("u_sink_converter_simd_benchmark", "[.][benchmark]")
+{
+	// One 1280x800 camera frame.
+	const uint32_t w = 1280;
+	const uint32_t h = 800;
+
+	std::vector<uint8_t> src = make_random(w * h * 2, 3);
+	std::vector<uint8_t> dst(w * h * 3);
+
+	std::vector<const u_sink_converter_funcs *> all = get_simd_funcs();
+	all.insert(all.begin(), u_sink_converter_simd_get_funcs(U_SINK_CONVERTER_SIMD_SCALAR));
+
+	for (const u_sink_converter_funcs *funcs : all) {
+		BENCHMARK(std::string("yuyv422_to_r8g8b8 ") + funcs->name)
+		{
+			for (uint32_t y = 0; y < h; y++) {
+				funcs->yuyv422_to_r8g8b8(&src[y * w * 2], &dst[y * w * 3], w);
+			}
+			return dst[0];
+		};
+
+		BENCHMARK(std::string("l8_to_r8g8b8 ") + funcs->name)
+		{
+			for (uint32_t y = 0; y < h; y++) {
+				funcs->l8_to_r8g8b8(&src[y * w], &dst[y * w * 3], w);
+			}
+			return dst[0];
+		};
+
+		BENCHMARK(std::string("bayer_gr8_to_r8g8b8 ") + funcs->name)
+		{
+			for (uint32_t y = 0; y < h / 2; y++) {
+				const uint8_t *src0 = &src[(y * 2) * w * 2];
+				const uint8_t *src1 = &src[(y * 2 + 1) * w * 2];
+				funcs->bayer_gr8_to_r8g8b8(src0, src1, &dst[y * w * 3], w);
+			}
+			return dst[0];
+		};
+	}
+}
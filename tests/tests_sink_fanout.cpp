@@ -0,0 +1,120 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Fan-out sink tests.
+ */
+
+#include <util/u_sink.h>
+#include <util/u_frame.h>
+#include <os/os_time.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+
+
+namespace {
+
+struct test_sink
+{
+	xrt_frame_sink base = {};
+
+	//! Consumer blocks until this is set.
+	std::atomic<bool> open{true};
+
+	std::atomic<uint32_t> count{0};
+	std::atomic<uint64_t> last{0};
+	std::vector<uint64_t> timestamps;
+
+	test_sink()
+	{
+		base.push_frame = push;
+	}
+
+	static void
+	push(xrt_frame_sink *xfs, xrt_frame *xf)
+	{
+		test_sink *s = reinterpret_cast<test_sink *>(xfs);
+		while (!s->open.load()) {
+			std::this_thread::yield();
+		}
+		s->timestamps.push_back(xf->timestamp);
+		s->last = xf->timestamp;
+		s->count++;
+	}
+
+	void
+	wait_for_last(uint64_t timestamp)
+	{
+		for (int i = 0; i < 1000 && (count.load() == 0 || last.load() != timestamp); i++) {
+			os_nanosleep(U_TIME_1MS_IN_NS);
+		}
+	}
+};
+
+void
+push_frame(xrt_frame_sink *xfs, uint64_t timestamp)
+{
+	xrt_frame *xf = nullptr;
+	u_frame_create_one_off(XRT_FORMAT_L8, 4, 4, &xf);
+	xf->timestamp = timestamp;
+	xrt_sink_push_frame(xfs, xf);
+	xrt_frame_reference(&xf, nullptr);
+}
+
+} // namespace
+
+
+TEST_CASE("u_sink_fanout")
+{
+	xrt_frame_context xfctx = {};
+	test_sink tracker;
+	test_sink debug;
+	xrt_frame_sink *xfs = nullptr;
+
+	SECTION("direct branches get every frame")
+	{
+		u_sink_fanout_branch branches[2] = {
+		    {&tracker.base, 0, U_SINK_RING_QUEUE_DROP_OLDEST},
+		    {&debug.base, 0, U_SINK_RING_QUEUE_DROP_OLDEST},
+		};
+		REQUIRE(u_sink_fanout_create(&xfctx, branches, 2, &xfs));
+
+		for (uint64_t i = 0; i < 10; i++) {
+			push_frame(xfs, i);
+		}
+
+		xrt_frame_context_destroy_nodes(&xfctx);
+		CHECK(tracker.count.load() == 10);
+		CHECK(debug.count.load() == 10);
+	}
+
+	SECTION("a stalled queued branch doesn't hold up the others")
+	{
+		u_sink_fanout_branch branches[2] = {
+		    {&tracker.base, 0, U_SINK_RING_QUEUE_DROP_OLDEST},
+		    {&debug.base, 2, U_SINK_RING_QUEUE_DROP_OLDEST},
+		};
+		REQUIRE(u_sink_fanout_create(&xfctx, branches, 2, &xfs));
+
+		debug.open = false;
+		for (uint64_t i = 0; i < 10; i++) {
+			push_frame(xfs, i);
+		}
+
+		// All pushed on this thread while the debug branch is stuck.
+		CHECK(tracker.count.load() == 10);
+
+		// Drop oldest, so the debug branch ends on the latest frame.
+		debug.open = true;
+		debug.wait_for_last(9);
+
+		xrt_frame_context_destroy_nodes(&xfctx);
+		REQUIRE(debug.timestamps.size() >= 1);
+		CHECK(debug.timestamps.size() < 10);
+		CHECK(debug.timestamps.back() == 9);
+	}
+}
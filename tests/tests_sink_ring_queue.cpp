@@ -0,0 +1,173 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief Ring queue sink tests.
+ */
+
+#include <util/u_sink.h>
+#include <util/u_frame.h>
+#include <os/os_time.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+
+
+namespace {
+
+void
+push_frame(xrt_frame_sink *xfs, uint64_t timestamp)
+{
+	xrt_frame *xf = nullptr;
+	u_frame_create_one_off(XRT_FORMAT_L8, 4, 4, &xf);
+	xf->timestamp = timestamp;
+	xrt_sink_push_frame(xfs, xf);
+	xrt_frame_reference(&xf, nullptr);
+}
+
+struct test_sink
+{
+	xrt_frame_sink base = {};
+
+	//! Consumer blocks until this is set.
+	std::atomic<bool> open{true};
+
+	//! Set when the consumer has received a frame and is blocking on @ref open.
+	std::atomic<bool> blocked{false};
+
+	std::atomic<uint32_t> count{0};
+	std::vector<uint64_t> timestamps;
+
+	test_sink()
+	{
+		base.push_frame = push;
+	}
+
+	static void
+	push(xrt_frame_sink *xfs, xrt_frame *xf)
+	{
+		test_sink *s = reinterpret_cast<test_sink *>(xfs);
+		while (!s->open.load()) {
+			s->blocked = true;
+			std::this_thread::yield();
+		}
+		s->timestamps.push_back(xf->timestamp);
+		s->count++;
+	}
+
+	void
+	wait_for(uint32_t n)
+	{
+		for (int i = 0; i < 1000 && count.load() < n; i++) {
+			os_nanosleep(U_TIME_1MS_IN_NS);
+		}
+	}
+
+	//! Makes the queue thread hold frame 0 so the ring is empty and nothing drains it.
+	void
+	stall(xrt_frame_sink *xfs)
+	{
+		open = false;
+		push_frame(xfs, 0);
+		for (int i = 0; i < 1000 && !blocked.load(); i++) {
+			os_nanosleep(U_TIME_1MS_IN_NS);
+		}
+		REQUIRE(blocked.load());
+	}
+};
+
+} // namespace
+
+
+TEST_CASE("u_sink_ring_queue")
+{
+	xrt_frame_context xfctx = {};
+	test_sink sink;
+	xrt_frame_sink *xfs = nullptr;
+
+	SECTION("delivers frames in order")
+	{
+		REQUIRE(u_sink_ring_queue_create(&xfctx, 4, U_SINK_RING_QUEUE_DROP_NEWEST, &sink.base, &xfs));
+
+		for (uint64_t i = 0; i < 100; i++) {
+			push_frame(xfs, i);
+			sink.wait_for((uint32_t)i + 1);
+		}
+
+		xrt_frame_context_destroy_nodes(&xfctx);
+		REQUIRE(sink.timestamps.size() == 100);
+		for (uint64_t i = 0; i < 100; i++) {
+			CHECK(sink.timestamps[i] == i);
+		}
+	}
+
+	SECTION("drop newest keeps the first frames")
+	{
+		REQUIRE(u_sink_ring_queue_create(&xfctx, 2, U_SINK_RING_QUEUE_DROP_NEWEST, &sink.base, &xfs));
+
+		// Frames 1 and 2 fill the ring, 3 to 5 are dropped.
+		sink.stall(xfs);
+		for (uint64_t i = 1; i < 6; i++) {
+			push_frame(xfs, i);
+		}
+		CHECK(u_sink_ring_queue_get_dropped(xfs) == 3);
+
+		sink.open = true;
+		sink.wait_for(3);
+
+		CHECK(u_sink_ring_queue_get_dropped(xfs) == 3);
+		xrt_frame_context_destroy_nodes(&xfctx);
+		REQUIRE(sink.timestamps == std::vector<uint64_t>{0, 1, 2});
+	}
+
+	SECTION("drop oldest keeps the latest frames")
+	{
+		REQUIRE(u_sink_ring_queue_create(&xfctx, 2, U_SINK_RING_QUEUE_DROP_OLDEST, &sink.base, &xfs));
+
+		// Frames 3 to 5 each overwrite the oldest queued frame, leaving 4 and 5.
+		sink.stall(xfs);
+		for (uint64_t i = 1; i < 6; i++) {
+			push_frame(xfs, i);
+		}
+		CHECK(u_sink_ring_queue_get_dropped(xfs) == 3);
+
+		sink.open = true;
+		sink.wait_for(3);
+
+		CHECK(u_sink_ring_queue_get_dropped(xfs) == 3);
+		xrt_frame_context_destroy_nodes(&xfctx);
+		REQUIRE(sink.timestamps == std::vector<uint64_t>{0, 4, 5});
+	}
+
+	SECTION("multiple producers")
+	{
+		const uint32_t Total = 4 * 1000;
+
+		REQUIRE(u_sink_ring_queue_create(&xfctx, 8, U_SINK_RING_QUEUE_DROP_OLDEST, &sink.base, &xfs));
+
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; t++) {
+			threads.emplace_back([xfs] {
+				for (uint64_t i = 0; i < 1000; i++) {
+					push_frame(xfs, i);
+				}
+			});
+		}
+		for (auto &t : threads) {
+			t.join();
+		}
+
+		// Every frame is either delivered or counted as dropped, wait for the ring to drain.
+		for (int i = 0; i < 1000 && sink.count.load() + u_sink_ring_queue_get_dropped(xfs) < Total; i++) {
+			os_nanosleep(U_TIME_1MS_IN_NS);
+		}
+		CHECK(sink.count.load() + u_sink_ring_queue_get_dropped(xfs) == Total);
+
+		// Teardown must release every frame still queued.
+		xrt_frame_context_destroy_nodes(&xfctx);
+		CHECK(sink.count.load() > 0);
+	}
+}
@@ -0,0 +1,60 @@
+// Copyright 2025, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief u_timestamp_ring tests.
+ */
+
+#include <util/u_timestamp_ring.h>
+
+#include "catch_amalgamated.hpp"
+
+
+static constexpr int64_t period = 18'500'000;
+
+TEST_CASE("u_timestamp_ring")
+{
+	struct u_timestamp_ring tr = {};
+	int64_t ts = 0;
+	uint32_t counter = 0;
+
+	SECTION("Empty")
+	{
+		CHECK_FALSE(u_timestamp_ring_take_closest(&tr, 0, period, &ts, &counter));
+	}
+
+	SECTION("Matches with jitter and skips missed frames")
+	{
+		for (int64_t i = 0; i < 10; i++) {
+			REQUIRE(u_timestamp_ring_push(&tr, 1000 + i * period + (i % 2 == 0 ? 1 : -1) * period / 5));
+		}
+
+		REQUIRE(u_timestamp_ring_take_closest(&tr, 1000 + 3 * period, period, &ts, &counter));
+		CHECK(counter == 3);
+
+		// Frame 4 was missed.
+		REQUIRE(u_timestamp_ring_take_closest(&tr, 1000 + 5 * period + period / 3, period, &ts, &counter));
+		CHECK(counter == 5);
+
+		// Older than anything left, gives the oldest.
+		REQUIRE(u_timestamp_ring_take_closest(&tr, 0, period, &ts, &counter));
+		CHECK(counter == 6);
+
+		// Newer than anything left, drains the ring.
+		REQUIRE(u_timestamp_ring_take_closest(&tr, 1000 + 100 * period, period, &ts, &counter));
+		CHECK(counter == 9);
+		CHECK_FALSE(u_timestamp_ring_take_closest(&tr, 0, period, &ts, &counter));
+	}
+
+	SECTION("Drops when full")
+	{
+		for (int64_t i = 0; i < U_TIMESTAMP_RING_SIZE; i++) {
+			REQUIRE(u_timestamp_ring_push(&tr, i * period));
+		}
+		CHECK_FALSE(u_timestamp_ring_push(&tr, U_TIMESTAMP_RING_SIZE * period));
+
+		REQUIRE(u_timestamp_ring_take_closest(&tr, 2 * period, period, &ts, &counter));
+		CHECK(ts == 2 * period);
+		CHECK(u_timestamp_ring_push(&tr, U_TIMESTAMP_RING_SIZE * period));
+	}
+}
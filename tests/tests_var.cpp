@@ -0,0 +1,88 @@
+// Copyright 2024, Collabora, Ltd.
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @file
+ * @brief u_var snapshot tests.
+ */
+
+#include <util/u_var.h>
+#include <util/u_time.h>
+
+#include <cstdint>
+#include <string>
+
+#include "catch_amalgamated.hpp"
+
+
+struct tracked
+{
+	int32_t counter;
+	uint64_t frames;
+	float ratio;
+	struct u_var_draggable_f32 gain;
+	struct xrt_vec3 position;
+	const char *text;
+};
+
+TEST_CASE("u_var_snapshot")
+{
+	u_var_force_on();
+
+	tracked t = {};
+	t.counter = -3;
+	t.frames = UINT64_MAX;
+	t.ratio = 0.5f;
+	t.gain.val = 2.0f;
+	t.text = "hello";
+
+	u_var_add_root(&t, "Tracked", false);
+	u_var_add_i32(&t, &t.counter, "Counter");
+	u_var_add_ro_u64(&t, &t.frames, "Frames");
+	u_var_add_vec3_f32(&t, &t.position, "Position");
+	u_var_add_ro_text(&t, t.text, "Text");
+	u_var_add_f32(&t, &t.ratio, "Ratio");
+	u_var_add_draggable_f32(&t, &t.gain, "Gain");
+
+	u_var_snapshot *snapshot = nullptr;
+	REQUIRE(u_var_snapshot_create(U_TIME_1MS_IN_NS, &snapshot) == 0);
+	REQUIRE(snapshot != nullptr);
+
+	// Only the numeric ones.
+	REQUIRE(u_var_snapshot_get_count(snapshot) == 4);
+
+	const char *root_name = nullptr;
+	const char *name = nullptr;
+	u_var_kind kind = {};
+	REQUIRE(u_var_snapshot_get_info(snapshot, 1, &root_name, &name, &kind));
+	CHECK(std::string(root_name) == "Tracked");
+	CHECK(std::string(name) == "Frames");
+	CHECK(kind == U_VAR_KIND_RO_U64);
+	CHECK_FALSE(u_var_snapshot_get_info(snapshot, 4, &root_name, &name, &kind));
+
+	int64_t now = 10 * U_TIME_1MS_IN_NS;
+	REQUIRE(u_var_snapshot_sample(snapshot, now) == U_VAR_SNAPSHOT_SAMPLED);
+
+	int64_t timestamp_ns = 0;
+	const u_var_snapshot_value *values = u_var_snapshot_get_values(snapshot, &timestamp_ns);
+	CHECK(timestamp_ns == now);
+	CHECK(values[0].i == -3);
+	CHECK(values[1].u == UINT64_MAX);
+	CHECK(values[2].f == 0.5);
+	CHECK(values[3].f == 2.0);
+
+	// Respects the period.
+	t.counter = 7;
+	CHECK(u_var_snapshot_sample(snapshot, now + U_TIME_1MS_IN_NS / 2) == U_VAR_SNAPSHOT_NOT_DUE);
+	CHECK(values[0].i == -3);
+	CHECK(u_var_snapshot_sample(snapshot, now + U_TIME_1MS_IN_NS) == U_VAR_SNAPSHOT_SAMPLED);
+	CHECK(values[0].i == 7);
+
+	// Removing the root makes the snapshot stale, it must not read the variables anymore.
+	uint64_t generation = u_var_get_generation();
+	u_var_remove_root(&t);
+	CHECK(u_var_get_generation() != generation);
+	CHECK(u_var_snapshot_sample(snapshot, now + 2 * U_TIME_1MS_IN_NS) == U_VAR_SNAPSHOT_STALE);
+
+	u_var_snapshot_destroy(&snapshot);
+	CHECK(snapshot == nullptr);
+}
@@ -10,8 +10,11 @@
 
 #include "catch_amalgamated.hpp"
 
-#include <thread>
+#include <atomic>
 #include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace std::chrono_literals;
 
@@ -130,3 +133,88 @@ TEST_CASE("TaskCollection")
 		CHECK(calledA[2]);
 	}
 }
+
+static void
+count_task(void *ptr)
+{
+	static_cast<std::atomic<uint32_t> *>(ptr)->fetch_add(1);
+}
+
+static void
+busy_task(void *ptr)
+{
+	// Roughly a few microseconds of work.
+	volatile uint32_t v = 0;
+	for (uint32_t i = 0; i < 2000; i++) {
+		v = v + i;
+	}
+	count_task(ptr);
+}
+
+TEST_CASE("u_worker_group many tasks")
+{
+	u_worker_thread_pool *pool = u_worker_thread_pool_create(3, 4, "Test");
+	REQUIRE(pool != nullptr);
+
+	constexpr uint32_t kGroups = 4;
+	constexpr uint32_t kTasks = 1000;
+	std::atomic<uint32_t> counts[kGroups] = {};
+	uint32_t done[kGroups] = {};
+
+	// More tasks than fit in the deques, from several threads at once.
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < kGroups; i++) {
+		threads.emplace_back([&, i] {
+			u_worker_group *group = u_worker_group_create(pool);
+			for (uint32_t k = 0; k < kTasks; k++) {
+				auto priority = (k % 3) == 0 ? U_WORKER_PRIORITY_HIGH : U_WORKER_PRIORITY_NORMAL;
+				u_worker_group_push_with_priority(group, count_task, &counts[i], priority);
+			}
+			u_worker_group_wait_all(group);
+			done[i] = counts[i].load();
+			u_worker_group_reference(&group, nullptr);
+		});
+	}
+
+	for (auto &t : threads) {
+		t.join();
+	}
+
+	// Catch2 assertions are not thread safe, check here.
+	for (uint32_t i = 0; i < kGroups; i++) {
+		CHECK(done[i] == kTasks);
+	}
+
+	u_worker_thread_pool_reference(&pool, nullptr);
+}
+
+// Hidden by default, run with: tests_worker "[benchmark]"
+TEST_CASE("u_worker_group throughput", "[.][benchmark]")
+{
+	u_worker_thread_pool *pool = u_worker_thread_pool_create(3, 4, "Bench");
+	REQUIRE(pool != nullptr);
+
+	for (uint32_t group_count : {1u, 4u}) {
+		BENCHMARK("1000 tasks per group, groups: " + std::to_string(group_count))
+		{
+			std::atomic<uint32_t> count{0};
+			std::vector<std::thread> threads;
+			for (uint32_t i = 0; i < group_count; i++) {
+				threads.emplace_back([&] {
+					u_worker_group *group = u_worker_group_create(pool);
+					for (uint32_t k = 0; k < 1000; k++) {
+						u_worker_group_push(group, busy_task, &count);
+					}
+					u_worker_group_wait_all(group);
+					u_worker_group_reference(&group, nullptr);
+				});
+			}
+			for (auto &t : threads) {
+				t.join();
+			}
+			return count.load();
+		};
+	}
+
+	u_worker_thread_pool_reference(&pool, nullptr);
+}